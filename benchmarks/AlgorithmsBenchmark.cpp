@@ -0,0 +1,252 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include "BenchmarkMeshes.h"
+
+#include <pmp/algorithms/Heap.h>
+#include <pmp/algorithms/SurfaceGeodesic.h>
+#include <pmp/algorithms/SurfaceRemeshing.h>
+#include <pmp/algorithms/SurfaceSimplification.h>
+#include <pmp/algorithms/TriangleKdTree.h>
+
+#include <algorithm>
+#include <random>
+
+using namespace pmp;
+
+//=============================================================================
+
+static void BM_TriangleKdTreeBuild(benchmark::State& state)
+{
+    SurfaceMesh mesh = sphere(int(state.range(0)));
+    for (auto _ : state)
+    {
+        TriangleKdTree tree(mesh, 0);
+        benchmark::DoNotOptimize(&tree);
+    }
+    set_faces_processed(state, mesh.n_faces());
+}
+BENCHMARK(BM_TriangleKdTreeBuild)->PMP_MESH_SIZES;
+
+//-----------------------------------------------------------------------------
+
+// nearest point queries slightly off the surface, in vertex order
+static void BM_TriangleKdTreeNearest(benchmark::State& state)
+{
+    SurfaceMesh mesh = sphere(int(state.range(0)));
+    TriangleKdTree tree(mesh, 0);
+    std::vector<Point> points;
+    for (auto v : mesh.vertices())
+        points.push_back(1.01 * mesh.position(v));
+
+    LoopCounters counters;
+    for (auto _ : state)
+        for (const auto& p : points)
+            benchmark::DoNotOptimize(tree.nearest(p));
+    counters.report(state);
+
+    state.SetItemsProcessed(int64_t(state.iterations()) *
+                            int64_t(points.size()));
+}
+BENCHMARK(BM_TriangleKdTreeNearest)->PMP_MESH_SIZES;
+
+//-----------------------------------------------------------------------------
+
+// decimate to 10 percent of the vertices
+static void BM_Simplification(benchmark::State& state)
+{
+    const SurfaceMesh original = torus(int(state.range(0)));
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        SurfaceMesh mesh = original;
+        state.ResumeTiming();
+
+        SurfaceSimplification ss(mesh);
+        ss.initialize(10.0);
+        ss.simplify(original.n_vertices() / 10);
+    }
+    set_faces_processed(state, original.n_faces());
+}
+BENCHMARK(BM_Simplification)->PMP_MESH_SIZES->Unit(benchmark::kMillisecond);
+
+//-----------------------------------------------------------------------------
+
+// the argument pairs (size, heap arity) for each of the given sizes
+template <int... Sizes>
+static void heap_arities(benchmark::internal::Benchmark* b)
+{
+    for (int size : {Sizes...})
+        for (int arity : {2, 4, 8})
+            b->Args({size, arity});
+}
+
+// simplification with a priority queue of the given arity
+static void BM_SimplificationHeapArity(benchmark::State& state)
+{
+    const SurfaceMesh original = torus(int(state.range(0)));
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        SurfaceMesh mesh = original;
+        state.ResumeTiming();
+
+        SurfaceSimplification ss(mesh);
+        ss.set_heap_arity(unsigned(state.range(1)));
+        ss.initialize(10.0);
+        ss.simplify(original.n_vertices() / 10);
+    }
+    set_faces_processed(state, original.n_faces());
+}
+BENCHMARK(BM_SimplificationHeapArity)
+    ->Apply(heap_arities<512>)
+    ->Unit(benchmark::kMillisecond);
+
+//-----------------------------------------------------------------------------
+
+// heap interface reading keys from an array, like the vertex priorities
+class BenchmarkHeapInterface
+{
+public:
+    BenchmarkHeapInterface(std::vector<float>& keys, std::vector<int>& pos)
+        : keys_(keys), pos_(pos)
+    {
+    }
+
+    float key(Vertex v) { return keys_[v.idx()]; }
+    bool less(Vertex v0, Vertex v1)
+    {
+        return keys_[v0.idx()] < keys_[v1.idx()];
+    }
+    bool greater(Vertex v0, Vertex v1) { return less(v1, v0); }
+    int get_heap_position(Vertex v) { return pos_[v.idx()]; }
+    void set_heap_position(Vertex v, int pos) { pos_[v.idx()] = pos; }
+
+private:
+    std::vector<float>& keys_;
+    std::vector<int>& pos_;
+};
+
+// insert n entries, update each once in random order, and pop all
+template <class Queue>
+static void heap_workload(benchmark::State& state, Queue& queue,
+                          std::vector<float>& keys)
+{
+    const size_t n = keys.size();
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> key(0, 1);
+    std::vector<Vertex> order;
+    for (size_t i = 0; i < n; ++i)
+        order.push_back(Vertex(IndexType(i)));
+    std::shuffle(order.begin(), order.end(), rng);
+
+    for (auto _ : state)
+    {
+        for (auto v : order)
+        {
+            keys[v.idx()] = key(rng);
+            queue.insert(v);
+        }
+        for (auto v : order)
+        {
+            keys[v.idx()] = key(rng);
+            queue.update(v);
+        }
+        while (!queue.empty())
+            queue.pop_front();
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(n));
+}
+
+static void BM_BinaryHeap(benchmark::State& state)
+{
+    std::vector<float> keys(state.range(0));
+    std::vector<int> pos(keys.size(), -1);
+    Heap<Vertex, BenchmarkHeapInterface> queue(
+        BenchmarkHeapInterface(keys, pos));
+    heap_workload(state, queue, keys);
+}
+BENCHMARK(BM_BinaryHeap)->RangeMultiplier(16)->Range(1 << 12, 1 << 20);
+
+static void BM_DaryHeap(benchmark::State& state)
+{
+    std::vector<float> keys(state.range(0));
+    std::vector<int> pos(keys.size(), -1);
+    DaryHeap<Vertex, BenchmarkHeapInterface> queue(
+        BenchmarkHeapInterface(keys, pos), unsigned(state.range(1)));
+    heap_workload(state, queue, keys);
+}
+BENCHMARK(BM_DaryHeap)->Apply(heap_arities<1 << 12, 1 << 16, 1 << 20>);
+
+//-----------------------------------------------------------------------------
+
+// geodesic distances from one vertex to the whole mesh
+static void BM_Geodesic(benchmark::State& state)
+{
+    SurfaceMesh mesh = sphere(int(state.range(0)));
+    SurfaceGeodesic geodesic(mesh);
+    geodesic.set_heap_arity(unsigned(state.range(1)));
+    const std::vector<Vertex> seed(1, Vertex(0));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(geodesic.compute(seed));
+    state.SetItemsProcessed(int64_t(state.iterations()) *
+                            int64_t(mesh.n_vertices()));
+}
+BENCHMARK(BM_Geodesic)
+    ->Apply(heap_arities<128, 512>)
+    ->Unit(benchmark::kMillisecond);
+
+//-----------------------------------------------------------------------------
+
+// one iteration of uniform remeshing at the mean edge length
+static void BM_UniformRemeshing(benchmark::State& state)
+{
+    const SurfaceMesh original = sphere(int(state.range(0)));
+    Scalar l(0);
+    for (auto e : original.edges())
+        l += original.edge_length(e);
+    l /= (Scalar)original.n_edges();
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        SurfaceMesh mesh = original;
+        state.ResumeTiming();
+
+        SurfaceRemeshing(mesh).uniform_remeshing(l, 1);
+    }
+    set_faces_processed(state, original.n_faces());
+}
+BENCHMARK(BM_UniformRemeshing)
+    ->PMP_MESH_SIZES->Unit(benchmark::kMillisecond);
+
+//-----------------------------------------------------------------------------
+
+// adaptive remeshing of a pmp-data model, as in the remeshing app
+static void BM_AdaptiveRemeshingBunny(benchmark::State& state)
+{
+    SurfaceMesh original;
+    if (!read_data(state, original, "off/bunny_adaptive.off"))
+        return;
+    const Scalar bb = original.bounds().size();
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        SurfaceMesh mesh = original;
+        state.ResumeTiming();
+
+        SurfaceRemeshing(mesh).adaptive_remeshing(0.001 * bb, 0.100 * bb,
+                                                  0.001 * bb, 1);
+    }
+    set_faces_processed(state, original.n_faces());
+}
+BENCHMARK(BM_AdaptiveRemeshingBunny)->Unit(benchmark::kMillisecond);
+
+//=============================================================================
@@ -0,0 +1,161 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <benchmark/benchmark.h>
+
+#include <pmp/MemoryUsage.h>
+#include <pmp/PerfCounters.h>
+#include <pmp/SurfaceMesh.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+//=============================================================================
+
+// mesh sizes: the number of segments n of the generated meshes, a torus
+// has 2 n^2 triangles
+#define PMP_MESH_SIZES RangeMultiplier(4)->Range(32, 512)
+
+//! the vertex positions and triangle indices of a torus with n x n segments
+inline void torus_indices(int n, std::vector<pmp::Point>& points,
+                          std::vector<pmp::IndexType>& indices)
+{
+    const double pi = 3.14159265358979323846;
+    points.clear();
+    indices.clear();
+    for (int i = 0; i < n; ++i)
+    {
+        const double u = 2.0 * pi * i / n;
+        for (int j = 0; j < n; ++j)
+        {
+            const double v = 2.0 * pi * j / n;
+            const double r = 1.0 + 0.3 * cos(v);
+            points.push_back(pmp::Point(r * cos(u), r * sin(u), 0.3 * sin(v)));
+        }
+    }
+    for (int i = 0; i < n; ++i)
+    {
+        for (int j = 0; j < n; ++j)
+        {
+            const pmp::IndexType v00 = i * n + j;
+            const pmp::IndexType v10 = ((i + 1) % n) * n + j;
+            const pmp::IndexType v01 = i * n + (j + 1) % n;
+            const pmp::IndexType v11 = ((i + 1) % n) * n + (j + 1) % n;
+            indices.insert(indices.end(), {v00, v10, v11, v00, v11, v01});
+        }
+    }
+}
+
+//! a torus with n x n segments, i.e., 2 n^2 triangles
+inline pmp::SurfaceMesh torus(int n)
+{
+    std::vector<pmp::Point> points;
+    std::vector<pmp::IndexType> indices;
+    torus_indices(n, points, indices);
+    pmp::SurfaceMesh mesh;
+    mesh.build_from_indices(points, indices);
+    return mesh;
+}
+
+//! a latitude-longitude unit sphere with n segments around and n / 2 from
+//! pole to pole
+inline pmp::SurfaceMesh sphere(int n)
+{
+    const double pi = 3.14159265358979323846;
+    const int m = std::max(2, n / 2);
+    pmp::SurfaceMesh mesh;
+    auto north = mesh.add_vertex(pmp::Point(0, 0, 1));
+    for (int i = 1; i < m; ++i)
+    {
+        const double theta = pi * i / m;
+        for (int j = 0; j < n; ++j)
+        {
+            const double phi = 2.0 * pi * j / n;
+            mesh.add_vertex(pmp::Point(sin(theta) * cos(phi),
+                                       sin(theta) * sin(phi), cos(theta)));
+        }
+    }
+    auto south = mesh.add_vertex(pmp::Point(0, 0, -1));
+
+    auto ring = [&](int i, int j) { return pmp::Vertex(1 + i * n + j % n); };
+    for (int j = 0; j < n; ++j)
+    {
+        mesh.add_triangle(north, ring(0, j), ring(0, j + 1));
+        mesh.add_triangle(south, ring(m - 2, j + 1), ring(m - 2, j));
+    }
+    for (int i = 0; i + 1 < m - 1; ++i)
+    {
+        for (int j = 0; j < n; ++j)
+        {
+            mesh.add_triangle(ring(i, j), ring(i + 1, j), ring(i + 1, j + 1));
+            mesh.add_triangle(ring(i, j), ring(i + 1, j + 1), ring(i, j + 1));
+        }
+    }
+    return mesh;
+}
+
+//! read \p filename from pmp-data, skips the benchmark if that fails
+inline bool read_data(benchmark::State& state, pmp::SurfaceMesh& mesh,
+                      const char* filename)
+{
+    if (!mesh.read(std::string("pmp-data/") + filename))
+    {
+        state.SkipWithError("cannot read mesh from pmp-data");
+        return false;
+    }
+    return true;
+}
+
+//! report the number of faces processed per second
+inline void set_faces_processed(benchmark::State& state, size_t n_faces)
+{
+    state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(n_faces));
+    state.counters["faces"] = double(n_faces);
+}
+
+//! \brief Hardware counters of the benchmark loop, see pmp::PerfCounters.
+//! \details Counts the calling thread from construction, i.e., right before
+//! the loop, to report(), which adds the events per iteration and the
+//! resident set size to the counters of the benchmark. Reports nothing if
+//! the counters are not available. Work on other threads is not counted.
+class LoopCounters
+{
+public:
+    LoopCounters() : start_(counters_.read()) {}
+
+    void report(benchmark::State& state) const
+    {
+        if (!counters_.is_available())
+            return;
+        const pmp::PerfCounters::Values counts = counters_.read() - start_;
+        const double n = double(std::max<int64_t>(state.iterations(), 1));
+        auto set = [&](const char* name, int64_t count) {
+            if (count >= 0)
+                state.counters[name] = double(count) / n;
+        };
+        set("cycles", counts.cycles);
+        set("instructions", counts.instructions);
+        set("llc_misses", counts.llc_misses);
+        set("branch_misses", counts.branch_misses);
+        if (counts.cycles > 0 && counts.instructions >= 0)
+            state.counters["ipc"] = counts.ipc();
+        state.counters["rss"] = benchmark::Counter(
+            double(pmp::MemoryUsage::current_size()),
+            benchmark::Counter::kDefaults, benchmark::Counter::kIs1024);
+    }
+
+private:
+    pmp::PerfCounters counters_;
+    pmp::PerfCounters::Values start_;
+};
+
+//=============================================================================
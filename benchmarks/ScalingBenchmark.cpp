@@ -0,0 +1,95 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+// throughput versus mesh size and number of threads, on meshes of up to
+// 16M faces generated by SurfaceFactory
+
+#include "BenchmarkMeshes.h"
+
+#include <pmp/Parallel.h>
+#include <pmp/algorithms/SurfaceFactory.h>
+#include <pmp/algorithms/SurfaceNormals.h>
+#include <pmp/algorithms/SurfaceSmoothing.h>
+
+#include <thread>
+
+using namespace pmp;
+
+//=============================================================================
+
+// the argument pairs (faces, threads) for 64K to 16M faces and powers of two
+// up to the number of cores
+static void faces_and_threads(benchmark::internal::Benchmark* b)
+{
+    const int cores = int(std::max(1u, std::thread::hardware_concurrency()));
+    for (int faces = 1 << 16; faces <= 1 << 24; faces *= 4)
+    {
+        for (int threads = 1; threads < cores; threads *= 2)
+            b->Args({faces, threads});
+        b->Args({faces, cores});
+    }
+}
+
+// use state.range(1) threads for the current benchmark
+static void set_threads(benchmark::State& state)
+{
+    set_num_threads(unsigned(state.range(1)));
+    state.counters["threads"] = double(state.range(1));
+}
+
+//-----------------------------------------------------------------------------
+
+static void BM_IcosphereGeneration(benchmark::State& state)
+{
+    set_threads(state);
+    size_t n_faces = 0;
+    for (auto _ : state)
+    {
+        SurfaceMesh mesh = SurfaceFactory::icosphere(size_t(state.range(0)));
+        n_faces = mesh.n_faces();
+    }
+    set_faces_processed(state, n_faces);
+    set_num_threads(0);
+}
+BENCHMARK(BM_IcosphereGeneration)
+    ->Apply(faces_and_threads)
+    ->Unit(benchmark::kMillisecond);
+
+//-----------------------------------------------------------------------------
+
+static void BM_VertexNormalsScaling(benchmark::State& state)
+{
+    set_threads(state);
+    SurfaceMesh mesh = SurfaceFactory::terrain(size_t(state.range(0)));
+    for (auto _ : state)
+        SurfaceNormals::compute_vertex_normals(mesh);
+    set_faces_processed(state, mesh.n_faces());
+    set_num_threads(0);
+}
+BENCHMARK(BM_VertexNormalsScaling)
+    ->Apply(faces_and_threads)
+    ->Unit(benchmark::kMillisecond);
+
+//-----------------------------------------------------------------------------
+
+static void BM_ExplicitSmoothingScaling(benchmark::State& state)
+{
+    set_threads(state);
+    SurfaceMesh mesh = SurfaceFactory::torus(size_t(state.range(0)));
+    SurfaceSmoothing smoothing(mesh);
+    for (auto _ : state)
+        smoothing.explicit_smoothing(1);
+    set_faces_processed(state, mesh.n_faces());
+    set_num_threads(0);
+}
+BENCHMARK(BM_ExplicitSmoothingScaling)
+    ->Apply(faces_and_threads)
+    ->Unit(benchmark::kMillisecond);
+
+//=============================================================================
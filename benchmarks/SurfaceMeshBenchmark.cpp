@@ -0,0 +1,126 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include "BenchmarkMeshes.h"
+
+using namespace pmp;
+
+//=============================================================================
+
+// one add_face() per triangle
+static void BM_AddFace(benchmark::State& state)
+{
+    std::vector<Point> points;
+    std::vector<IndexType> indices;
+    torus_indices(int(state.range(0)), points, indices);
+
+    for (auto _ : state)
+    {
+        SurfaceMesh mesh;
+        mesh.reserve(points.size(), 3 * points.size(), 2 * points.size());
+        for (const auto& p : points)
+            mesh.add_vertex(p);
+        for (size_t i = 0; i < indices.size(); i += 3)
+            mesh.add_triangle(Vertex(indices[i]), Vertex(indices[i + 1]),
+                              Vertex(indices[i + 2]));
+        benchmark::DoNotOptimize(mesh.n_faces());
+    }
+    set_faces_processed(state, indices.size() / 3);
+}
+BENCHMARK(BM_AddFace)->PMP_MESH_SIZES;
+
+//-----------------------------------------------------------------------------
+
+// bulk construction, as used by the file readers
+static void BM_BuildFromIndices(benchmark::State& state)
+{
+    std::vector<Point> points;
+    std::vector<IndexType> indices;
+    torus_indices(int(state.range(0)), points, indices);
+
+    for (auto _ : state)
+    {
+        SurfaceMesh mesh;
+        mesh.build_from_indices(points, indices);
+        benchmark::DoNotOptimize(mesh.n_faces());
+    }
+    set_faces_processed(state, indices.size() / 3);
+}
+BENCHMARK(BM_BuildFromIndices)->PMP_MESH_SIZES;
+
+//-----------------------------------------------------------------------------
+
+// sum of the neighbor positions of all vertices
+static void BM_VertexCirculator(benchmark::State& state)
+{
+    SurfaceMesh mesh = torus(int(state.range(0)));
+    LoopCounters counters;
+    for (auto _ : state)
+    {
+        Point sum(0, 0, 0);
+        for (auto v : mesh.vertices())
+            for (auto vv : mesh.vertices(v))
+                sum += mesh.position(vv);
+        benchmark::DoNotOptimize(sum);
+    }
+    counters.report(state);
+    set_faces_processed(state, mesh.n_faces());
+}
+BENCHMARK(BM_VertexCirculator)->PMP_MESH_SIZES;
+
+//-----------------------------------------------------------------------------
+
+// number of faces around all vertices
+static void BM_FaceCirculator(benchmark::State& state)
+{
+    SurfaceMesh mesh = torus(int(state.range(0)));
+    LoopCounters counters;
+    for (auto _ : state)
+    {
+        size_t n = 0;
+        for (auto v : mesh.vertices())
+            for (auto f : mesh.faces(v))
+            {
+                benchmark::DoNotOptimize(f);
+                ++n;
+            }
+        benchmark::DoNotOptimize(n);
+    }
+    counters.report(state);
+    set_faces_processed(state, mesh.n_faces());
+}
+BENCHMARK(BM_FaceCirculator)->PMP_MESH_SIZES;
+
+//-----------------------------------------------------------------------------
+
+// remove every other ring of faces
+static void BM_GarbageCollection(benchmark::State& state)
+{
+    const int n = int(state.range(0));
+    const SurfaceMesh original = torus(n);
+    size_t n_faces = 0;
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        SurfaceMesh mesh = original;
+        for (auto f : mesh.faces())
+            if ((f.idx() / (2 * n)) % 2 == 0)
+                mesh.delete_face(f);
+        n_faces = mesh.n_faces();
+        state.ResumeTiming();
+
+        mesh.garbage_collection();
+        benchmark::DoNotOptimize(mesh.n_faces());
+    }
+    set_faces_processed(state, n_faces);
+}
+BENCHMARK(BM_GarbageCollection)->PMP_MESH_SIZES;
+
+//=============================================================================
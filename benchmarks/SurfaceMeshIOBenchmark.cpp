@@ -0,0 +1,97 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include "BenchmarkMeshes.h"
+
+#include <cstdio>
+#include <string>
+
+using namespace pmp;
+
+//=============================================================================
+
+// read a generated torus written in the format ext
+static void read_torus(benchmark::State& state, const char* ext, bool binary)
+{
+    const SurfaceMesh original = torus(int(state.range(0)));
+    const std::string filename = std::string("benchmark_torus") +
+                                 (binary ? "_binary." : ".") + ext;
+    IOFlags flags;
+    flags.use_binary = binary;
+    if (!original.write(filename, flags))
+    {
+        state.SkipWithError("cannot write mesh");
+        return;
+    }
+
+    SurfaceMesh mesh;
+    for (auto _ : state)
+    {
+        if (!mesh.read(filename))
+        {
+            state.SkipWithError("cannot read mesh");
+            break;
+        }
+    }
+    set_faces_processed(state, original.n_faces());
+    remove(filename.c_str());
+}
+
+static void BM_ReadOFF(benchmark::State& state)
+{
+    read_torus(state, "off", false);
+}
+BENCHMARK(BM_ReadOFF)->PMP_MESH_SIZES;
+
+static void BM_ReadOFFBinary(benchmark::State& state)
+{
+    read_torus(state, "off", true);
+}
+BENCHMARK(BM_ReadOFFBinary)->PMP_MESH_SIZES;
+
+static void BM_ReadOBJ(benchmark::State& state)
+{
+    read_torus(state, "obj", false);
+}
+BENCHMARK(BM_ReadOBJ)->PMP_MESH_SIZES;
+
+static void BM_ReadPLYBinary(benchmark::State& state)
+{
+    read_torus(state, "ply", true);
+}
+BENCHMARK(BM_ReadPLYBinary)->PMP_MESH_SIZES;
+
+static void BM_ReadSTLBinary(benchmark::State& state)
+{
+    read_torus(state, "stl", true);
+}
+BENCHMARK(BM_ReadSTLBinary)->PMP_MESH_SIZES;
+
+static void BM_ReadPMP(benchmark::State& state)
+{
+    read_torus(state, "pmp", false);
+}
+BENCHMARK(BM_ReadPMP)->PMP_MESH_SIZES;
+
+//-----------------------------------------------------------------------------
+
+// read models of pmp-data
+static void BM_ReadData(benchmark::State& state, const char* filename)
+{
+    SurfaceMesh mesh;
+    for (auto _ : state)
+        if (!read_data(state, mesh, filename))
+            break;
+    set_faces_processed(state, mesh.n_faces());
+}
+BENCHMARK_CAPTURE(BM_ReadData, bunny, "off/bunny_adaptive.off");
+BENCHMARK_CAPTURE(BM_ReadData, icosahedron_stl,
+                  "stl/icosahedron_binary.stl");
+
+//=============================================================================
@@ -16,20 +16,25 @@
 #include <pmp/algorithms/SurfaceRemeshing.h>
 #include <pmp/algorithms/SurfaceCurvature.h>
 #include <pmp/algorithms/SurfaceGeodesic.h>
+#include <pmp/algorithms/SurfaceSmoothing.h>
 #include <pmp/algorithms/HoleFilling.h>
 
 #include <imgui.h>
 
+#include <algorithm>
+#include <chrono>
+
 //=============================================================================
 
 MeshProcessingViewer::MeshProcessingViewer(const char* title, int width, int height)
-    : MeshViewer(title, width, height),
-      smoother_(mesh_)
+    : MeshViewer(title, width, height), max_undo_levels_(20)
 {
     set_draw_mode("Hidden Line");
 
     // add help items
     add_help_item("O", "Flip mesh orientation", 5);
+    add_help_item("Ctrl+Z", "Undo last operation", 6);
+    add_help_item("Ctrl+Y", "Redo last operation", 7);
 }
 
 //----------------------------------------------------------------------------
@@ -43,7 +48,9 @@ void MeshProcessingViewer::keyboard(int key, int scancode, int action, int mods)
     {
         case GLFW_KEY_O: // change face orientation
         {
-            SurfaceMeshGL new_mesh;
+            if (job_)
+                break;
+            SurfaceMesh new_mesh;
             for (auto v : mesh_.vertices())
             {
                 new_mesh.add_vertex(mesh_.position(v));
@@ -58,8 +65,25 @@ void MeshProcessingViewer::keyboard(int key, int scancode, int action, int mods)
                 std::reverse(vertices.begin(), vertices.end());
                 new_mesh.add_face(vertices);
             }
-            mesh_ = new_mesh;
-            update_mesh();
+            replace_mesh(std::move(new_mesh), "Flip Orientation", false);
+            break;
+        }
+
+        case GLFW_KEY_Z: // undo
+        {
+            if (ctrl_pressed())
+                restore(undo_, redo_);
+            else
+                MeshViewer::keyboard(key, scancode, action, mods);
+            break;
+        }
+
+        case GLFW_KEY_Y: // redo
+        {
+            if (ctrl_pressed())
+                restore(redo_, undo_);
+            else
+                MeshViewer::keyboard(key, scancode, action, mods);
             break;
         }
 
@@ -73,6 +97,165 @@ void MeshProcessingViewer::keyboard(int key, int scancode, int action, int mods)
 
 //----------------------------------------------------------------------------
 
+void MeshProcessingViewer::start_job(const char* name,
+                                     const Operation& operation,
+                                     bool positions_only,
+                                     const std::function<void()>& finish)
+{
+    if (job_)
+        return;
+
+    job_.reset(new Job);
+    Job* job = job_.get();
+    job->name = name;
+    job->mesh.assign_shared(mesh_);
+    job->progress = -1.0f;
+    job->cancelled = false;
+    job->positions_only = positions_only;
+    job->finish = finish;
+
+#ifdef __EMSCRIPTEN__
+    // no threads, run the operation right away
+    std::promise<void> done;
+    operation(job->mesh, *job);
+    done.set_value();
+    job->result = done.get_future();
+#else
+    job->result = std::async(std::launch::async, [operation, job]() {
+        operation(job->mesh, *job);
+    });
+#endif
+}
+
+//----------------------------------------------------------------------------
+
+void MeshProcessingViewer::do_processing()
+{
+    MeshViewer::do_processing();
+
+    auto is_ready = [](const Job& job) {
+        return job.result.wait_for(std::chrono::seconds(0)) ==
+               std::future_status::ready;
+    };
+
+    // forget cancelled jobs once they returned
+    cancelled_jobs_.erase(
+        std::remove_if(cancelled_jobs_.begin(), cancelled_jobs_.end(),
+                       [&](const std::unique_ptr<Job>& job) {
+                           return is_ready(*job);
+                       }),
+        cancelled_jobs_.end());
+
+    if (!job_ || !is_ready(*job_))
+        return;
+
+    std::unique_ptr<Job> job = std::move(job_);
+    try
+    {
+        job->result.get();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << job->name << " failed: " << e.what() << std::endl;
+        return;
+    }
+
+    // swap in the result and update the buffers
+    replace_mesh(std::move(job->mesh), job->name, job->positions_only);
+    if (job->finish)
+        job->finish();
+}
+
+//----------------------------------------------------------------------------
+
+void MeshProcessingViewer::replace_mesh(SurfaceMesh&& mesh,
+                                        const std::string& name,
+                                        bool positions_only)
+{
+    // a new operation discards the undone ones
+    redo_.clear();
+    undo_.emplace_back();
+    undo_.back().name = name;
+    undo_.back().positions_only = positions_only;
+    undo_.back().mesh = std::move(static_cast<SurfaceMesh&>(mesh_));
+    if (undo_.size() > max_undo_levels_)
+        undo_.erase(undo_.begin());
+
+    static_cast<SurfaceMesh&>(mesh_) = std::move(mesh);
+    if (positions_only)
+        update_mesh_positions();
+    else
+        update_mesh();
+}
+
+//----------------------------------------------------------------------------
+
+void MeshProcessingViewer::restore(std::vector<Snapshot>& from,
+                                   std::vector<Snapshot>& to)
+{
+    if (job_ || from.empty())
+        return;
+
+    // the current mesh is the state on the other side of the operation
+    Snapshot& snapshot = from.back();
+    to.emplace_back();
+    to.back().name = snapshot.name;
+    to.back().positions_only = snapshot.positions_only;
+    to.back().mesh = std::move(static_cast<SurfaceMesh&>(mesh_));
+
+    static_cast<SurfaceMesh&>(mesh_) = std::move(snapshot.mesh);
+    const bool positions_only = snapshot.positions_only;
+    from.pop_back();
+    if (positions_only)
+        update_mesh_positions();
+    else
+        update_mesh();
+}
+
+//----------------------------------------------------------------------------
+
+void MeshProcessingViewer::process_undo_imgui()
+{
+    if (undo_.empty() && redo_.empty())
+        return;
+
+    if (!undo_.empty())
+    {
+        const std::string label = "Undo " + undo_.back().name;
+        if (ImGui::Button(label.c_str()))
+            restore(undo_, redo_);
+    }
+    if (!redo_.empty())
+    {
+        const std::string label = "Redo " + redo_.back().name;
+        if (ImGui::Button(label.c_str()))
+            restore(redo_, undo_);
+    }
+
+    ImGui::Spacing();
+    ImGui::Spacing();
+}
+
+//----------------------------------------------------------------------------
+
+void MeshProcessingViewer::process_job_imgui()
+{
+    ImGui::Text("%s", job_->name.c_str());
+
+    // the operations that cannot report their progress show an empty bar
+    const float progress = job_->progress;
+    ImGui::ProgressBar(progress < 0.0f ? 0.0f : progress, ImVec2(200, 0),
+                       progress < 0.0f ? "running" : nullptr);
+
+    if (ImGui::Button("Cancel"))
+    {
+        job_->cancelled = true;
+        cancelled_jobs_.push_back(std::move(job_));
+    }
+}
+
+//----------------------------------------------------------------------------
+
 void MeshProcessingViewer::process_imgui()
 {
     MeshViewer::process_imgui();
@@ -80,34 +263,51 @@ void MeshProcessingViewer::process_imgui()
     ImGui::Spacing();
     ImGui::Spacing();
 
+    // one operation at a time, the others wait for it
+    if (job_)
+    {
+        process_job_imgui();
+        return;
+    }
+
+    process_undo_imgui();
+
     if (ImGui::CollapsingHeader("Curvature"))
     {
-        if (ImGui::Button("Mean Curvature"))
-        {
-            SurfaceCurvature analyzer(mesh_);
-            analyzer.analyze_tensor(1, true);
-            analyzer.mean_curvature_to_texture_coordinates();
+        auto show_curvature = [this]() {
             mesh_.use_cold_warm_texture();
-            update_mesh();
             set_draw_mode("Texture");
+        };
+
+        if (ImGui::Button("Mean Curvature"))
+        {
+            start_job("Mean Curvature",
+                      [](SurfaceMesh& mesh, Job&) {
+                          SurfaceCurvature analyzer(mesh);
+                          analyzer.analyze_tensor(1, true);
+                          analyzer.mean_curvature_to_texture_coordinates();
+                      },
+                      false, show_curvature);
         }
         if (ImGui::Button("Gauss Curvature"))
         {
-            SurfaceCurvature analyzer(mesh_);
-            analyzer.analyze_tensor(1, true);
-            analyzer.gauss_curvature_to_texture_coordinates();
-            mesh_.use_cold_warm_texture();
-            update_mesh();
-            set_draw_mode("Texture");
+            start_job("Gauss Curvature",
+                      [](SurfaceMesh& mesh, Job&) {
+                          SurfaceCurvature analyzer(mesh);
+                          analyzer.analyze_tensor(1, true);
+                          analyzer.gauss_curvature_to_texture_coordinates();
+                      },
+                      false, show_curvature);
         }
         if (ImGui::Button("Abs. Max. Curvature"))
         {
-            SurfaceCurvature analyzer(mesh_);
-            analyzer.analyze_tensor(1, true);
-            analyzer.max_curvature_to_texture_coordinates();
-            mesh_.use_cold_warm_texture();
-            update_mesh();
-            set_draw_mode("Texture");
+            start_job("Abs. Max. Curvature",
+                      [](SurfaceMesh& mesh, Job&) {
+                          SurfaceCurvature analyzer(mesh);
+                          analyzer.analyze_tensor(1, true);
+                          analyzer.max_curvature_to_texture_coordinates();
+                      },
+                      false, show_curvature);
         }
     }
 
@@ -123,8 +323,17 @@ void MeshProcessingViewer::process_imgui()
 
         if (ImGui::Button("Explicit Smoothing"))
         {
-            smoother_.explicit_smoothing(iterations);
-            update_mesh();
+            const int n = iterations;
+            start_job("Explicit Smoothing",
+                      [n](SurfaceMesh& mesh, Job& job) {
+                          SurfaceSmoothing smoother(mesh);
+                          for (int i = 0; i < n && !job.cancelled; ++i)
+                          {
+                              smoother.explicit_smoothing(1);
+                              job.progress = float(i + 1) / n;
+                          }
+                      },
+                      true);
         }
 
         ImGui::Spacing();
@@ -139,8 +348,11 @@ void MeshProcessingViewer::process_imgui()
         if (ImGui::Button("Implicit Smoothing"))
         {
             Scalar dt = timestep * radius_ * radius_;
-            smoother_.implicit_smoothing(dt);
-            update_mesh();
+            start_job("Implicit Smoothing",
+                      [dt](SurfaceMesh& mesh, Job&) {
+                          SurfaceSmoothing(mesh).implicit_smoothing(dt);
+                      },
+                      true);
         }
     }
 
@@ -166,10 +378,30 @@ void MeshProcessingViewer::process_imgui()
 
         if (ImGui::Button("Decimate it!"))
         {
-            SurfaceSimplification ss(mesh_);
-            ss.initialize(aspect_ratio, 0.0, 0.0, normal_deviation, 0.0);
-            ss.simplify(mesh_.n_vertices() * 0.01 * target_percentage);
-            update_mesh();
+            const int ar = aspect_ratio;
+            const int nd = normal_deviation;
+            const unsigned int target =
+                mesh_.n_vertices() * 0.01 * target_percentage;
+            start_job("Decimation", [ar, nd, target](SurfaceMesh& mesh,
+                                                     Job& job) {
+                SurfaceSimplification ss(mesh);
+                ss.initialize(ar, 0.0, 0.0, nd, 0.0);
+
+                // simplify in slices of time to report the progress
+                SurfaceSimplification::StopCriteria criteria;
+                criteria.n_vertices = target;
+                criteria.max_seconds = 0.2;
+                const unsigned int n0 = mesh.n_vertices();
+                unsigned int n = n0;
+                while (n > target && !job.cancelled)
+                {
+                    ss.simplify(criteria);
+                    if (mesh.n_vertices() == n)
+                        break; // no legal collapse left
+                    n = mesh.n_vertices();
+                    job.progress = float(n0 - n) / float(n0 - target);
+                }
+            });
         }
     }
 
@@ -180,14 +412,16 @@ void MeshProcessingViewer::process_imgui()
     {
         if (ImGui::Button("Loop Subdivision"))
         {
-            SurfaceSubdivision(mesh_).loop();
-            update_mesh();
+            start_job("Loop Subdivision", [](SurfaceMesh& mesh, Job&) {
+                SurfaceSubdivision(mesh).loop();
+            });
         }
 
         if (ImGui::Button("Sqrt(3) Subdivision"))
         {
-            SurfaceSubdivision(mesh_).sqrt3();
-            update_mesh();
+            start_job("Sqrt(3) Subdivision", [](SurfaceMesh& mesh, Job&) {
+                SurfaceSubdivision(mesh).sqrt3();
+            });
         }
     }
 
@@ -198,23 +432,25 @@ void MeshProcessingViewer::process_imgui()
     {
         if (ImGui::Button("Adaptive Remeshing"))
         {
-            auto bb = mesh_.bounds().size();
-            SurfaceRemeshing(mesh_).adaptive_remeshing(
-                0.001 * bb,  // min length
-                1.0 * bb,    // max length
-                0.001 * bb); // approx. error
-            update_mesh();
+            start_job("Adaptive Remeshing", [](SurfaceMesh& mesh, Job&) {
+                auto bb = mesh.bounds().size();
+                SurfaceRemeshing(mesh).adaptive_remeshing(
+                    0.001 * bb,  // min length
+                    1.0 * bb,    // max length
+                    0.001 * bb); // approx. error
+            });
         }
 
         if (ImGui::Button("Uniform Remeshing"))
         {
-            Scalar l(0);
-            for (auto eit : mesh_.edges())
-                l += distance(mesh_.position(mesh_.vertex(eit, 0)),
-                              mesh_.position(mesh_.vertex(eit, 1)));
-            l /= (Scalar)mesh_.n_edges();
-            SurfaceRemeshing(mesh_).uniform_remeshing(l);
-            update_mesh();
+            start_job("Uniform Remeshing", [](SurfaceMesh& mesh, Job&) {
+                Scalar l(0);
+                for (auto eit : mesh.edges())
+                    l += distance(mesh.position(mesh.vertex(eit, 0)),
+                                  mesh.position(mesh.vertex(eit, 1)));
+                l /= (Scalar)mesh.n_edges();
+                SurfaceRemeshing(mesh).uniform_remeshing(l);
+            });
         }
     }
 
@@ -225,46 +461,47 @@ void MeshProcessingViewer::process_imgui()
     {
         if (ImGui::Button("Close smallest hole"))
         {
-            // find smallest hole
-            Halfedge      hmin;
-            unsigned int  lmin(mesh_.n_halfedges());
-            for (auto h: mesh_.halfedges())
-            {
-                if (mesh_.is_boundary(h))
+            start_job("Hole Filling", [](SurfaceMesh& mesh, Job&) {
+                // find smallest hole
+                Halfedge      hmin;
+                unsigned int  lmin(mesh.n_halfedges());
+                for (auto h: mesh.halfedges())
                 {
-                    Scalar l(0);
-                    Halfedge hh=h;
-                    do 
+                    if (mesh.is_boundary(h))
                     {
-                        ++l;
-                        if (!mesh_.is_manifold(mesh_.to_vertex(hh)))
+                        Scalar l(0);
+                        Halfedge hh=h;
+                        do
                         {
-                            l += 123456;
-                            break;
+                            ++l;
+                            if (!mesh.is_manifold(mesh.to_vertex(hh)))
+                            {
+                                l += 123456;
+                                break;
+                            }
+                            hh = mesh.next_halfedge(hh);
                         }
-                        hh = mesh_.next_halfedge(hh);
-                    }
-                    while (hh != h);
+                        while (hh != h);
 
-                    if (l < lmin)
-                    {
-                        lmin=l;
-                        hmin=h;
+                        if (l < lmin)
+                        {
+                            lmin=l;
+                            hmin=h;
+                        }
                     }
                 }
-            }
 
-            // close smallest hole
-            if (hmin.is_valid())
-            {
-                HoleFilling hf(mesh_);
-                hf.fill_hole(hmin);
-                update_mesh();
-            }
-            else
-            {
-                std::cerr << "No manifold boundary loop found\n";
-            }
+                // close smallest hole
+                if (hmin.is_valid())
+                {
+                    HoleFilling hf(mesh);
+                    hf.fill_hole(hmin);
+                }
+                else
+                {
+                    std::cerr << "No manifold boundary loop found\n";
+                }
+            });
         }
     }
 }
@@ -280,21 +517,26 @@ void MeshProcessingViewer::mouse(int button, int action, int mods)
         double x, y;
         cursor_pos(x, y);
         Vertex v = pick_vertex(x, y);
-        if (mesh_.is_valid(v))
+        if (mesh_.is_valid(v) && !job_)
         {
-            // setup seed
-            std::vector<Vertex> seed;
-            seed.push_back(v);
-
-            // compute geodesic distance
-            SurfaceGeodesic geodist(mesh_);
-            geodist.compute(seed);
-
-            // setup texture coordinates for visualization
-            geodist.distance_to_texture_coordinates();
-            mesh_.use_checkerboard_texture();
-            update_mesh();
-            set_draw_mode("Texture");
+            start_job("Geodesic Distance",
+                      [v](SurfaceMesh& mesh, Job&) {
+                          // setup seed
+                          std::vector<Vertex> seed;
+                          seed.push_back(v);
+
+                          // compute geodesic distance
+                          SurfaceGeodesic geodist(mesh);
+                          geodist.compute(seed);
+
+                          // setup texture coordinates for visualization
+                          geodist.distance_to_texture_coordinates();
+                      },
+                      false,
+                      [this]() {
+                          mesh_.use_checkerboard_texture();
+                          set_draw_mode("Texture");
+                      });
         }
     }
     else
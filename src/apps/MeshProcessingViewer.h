@@ -10,7 +10,13 @@
 //=============================================================================
 
 #include <pmp/visualization/MeshViewer.h>
-#include <pmp/algorithms/SurfaceSmoothing.h>
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
 
 using namespace pmp;
 
@@ -32,9 +38,66 @@ protected:
     //! draw the scene in different draw modes
     virtual void process_imgui() override;
 
+    //! take over the mesh of a finished job
+    void do_processing() override;
+
 private:
-    // smoother has to remember cotan weights, hence it global member
-    SurfaceSmoothing smoother_;
+    // an operation running on a copy of the mesh in the background
+    struct Job
+    {
+        std::string name;
+        SurfaceMesh mesh;
+        std::atomic<float> progress; // in [0,1], negative if unknown
+        std::atomic<bool> cancelled;
+        bool positions_only;          // only the vertex positions change
+        std::function<void()> finish; // called after the mesh was swapped in
+        std::future<void> result;
+    };
+
+    // an operation on the copy of the mesh, which should set the progress
+    // and return early when cancelled if it can
+    typedef std::function<void(SurfaceMesh&, Job&)> Operation;
+
+    // run operation on a copy of the mesh on a worker thread, the result
+    // replaces the mesh when it is done. only one job runs at a time.
+    void start_job(const char* name, const Operation& operation,
+                   bool positions_only = false,
+                   const std::function<void()>& finish = nullptr);
+
+    // show the progress of the running job and a button to cancel it
+    void process_job_imgui();
+
+    std::unique_ptr<Job> job_;
+
+    // cancelled jobs still running, their results are discarded
+    std::vector<std::unique_ptr<Job>> cancelled_jobs_;
+
+    // a mesh before or after an operation, for undo and redo. jobs start
+    // from a copy that shares the connectivity with the mesh, see
+    // SurfaceMesh::assign_shared(), which is only copied once the
+    // connectivity changes. hence a level of an operation that keeps the
+    // connectivity costs about the size of the other properties.
+    struct Snapshot
+    {
+        std::string name;    // the operation
+        bool positions_only; // the operation only moved vertices
+        SurfaceMesh mesh;
+    };
+
+    // replace the mesh by the result of an operation, keeping the old one
+    // to undo it
+    void replace_mesh(SurfaceMesh&& mesh, const std::string& name,
+                      bool positions_only);
+
+    // replace the mesh by the last snapshot of from, which is moved to to
+    void restore(std::vector<Snapshot>& from, std::vector<Snapshot>& to);
+
+    // show the buttons to undo and redo the last operations
+    void process_undo_imgui();
+
+    std::vector<Snapshot> undo_;
+    std::vector<Snapshot> redo_;
+    size_t max_undo_levels_;
 };
 
 //=============================================================================
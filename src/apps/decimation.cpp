@@ -22,12 +22,16 @@ public:
 
 protected:
     virtual void process_imgui();
+
+private:
+    ProgressiveMesh progressive_mesh_;
+    int level_of_detail_;
 };
 
 //=============================================================================
 
 Viewer::Viewer(const char* title, int width, int height)
-    : MeshViewer(title, width, height)
+    : MeshViewer(title, width, height), level_of_detail_(0)
 {
     set_draw_mode("Hidden Line");
     crease_angle_ = 0.0;
@@ -64,8 +68,35 @@ void Viewer::process_imgui()
             SurfaceSimplification ss(mesh_);
             ss.initialize(aspect_ratio, 0.0, 0.0, normal_deviation, 0.0);
             ss.simplify(mesh_.n_vertices() * 0.01 * target_percentage);
+            progressive_mesh_.clear();
+            update_mesh();
+        }
+
+        // record the collapses to scrub through the levels of detail
+        if (ImGui::Button("Progressive Mesh"))
+        {
+            SurfaceSimplification ss(mesh_);
+            ss.initialize(aspect_ratio, 0.0, 0.0, normal_deviation, 0.0);
+            SurfaceSimplification::StopCriteria criteria;
+            criteria.n_vertices = mesh_.n_vertices() * 0.01 * target_percentage;
+            ss.simplify(criteria, progressive_mesh_);
+            level_of_detail_ = progressive_mesh_.n_vertices();
             update_mesh();
         }
+
+        if (progressive_mesh_.max_vertices())
+        {
+            ImGui::PushItemWidth(100);
+            if (ImGui::SliderInt("Vertices", &level_of_detail_,
+                                 int(progressive_mesh_.min_vertices()),
+                                 int(progressive_mesh_.max_vertices())))
+            {
+                progressive_mesh_.set_n_vertices(level_of_detail_);
+                progressive_mesh_.extract(mesh_);
+                update_mesh();
+            }
+            ImGui::PopItemWidth();
+        }
     }
 }
 
@@ -63,19 +63,19 @@ void Viewer::process_imgui()
         {
             SurfaceFairing fair(mesh_);
             fair.minimize_area();
-            update_mesh();
+            update_mesh_positions();
         }
         if (ImGui::Button("Minimize Curvature"))
         {
             SurfaceFairing fair(mesh_);
             fair.minimize_curvature();
-            update_mesh();
+            update_mesh_positions();
         }
         if (ImGui::Button("Minimize Curvature Variation"))
         {
             SurfaceFairing fair(mesh_);
             fair.fair(3);
-            update_mesh();
+            update_mesh_positions();
         }
     }
 }
@@ -0,0 +1,215 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/SurfaceMesh.h>
+#include <pmp/Parallel.h>
+#include <pmp/Timer.h>
+#include <pmp/algorithms/SurfaceGeodesic.h>
+#include <pmp/algorithms/TriangleKdTree.h>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+using namespace pmp;
+
+//=============================================================================
+
+void usage_and_exit()
+{
+    std::cerr << "Usage:\nmbench [-r <repetitions>] [-k] [-g] <input> "
+                 "[<input> ...]\n\n"
+              << "Measures the read throughput of mesh files with one thread "
+                 "and with all threads.\n\nOptions\n"
+              << " -r:  number of repetitions, the fastest one is reported\n"
+              << " -k:  also measure TriangleKdTree nearest point queries\n"
+              << " -g:  also measure SurfaceGeodesic distances from the first "
+                 "vertex\n"
+              << "\n";
+    exit(1);
+}
+
+//----------------------------------------------------------------------------
+
+// fastest read time of filename in ms, or a negative value on failure
+double time_read(const char* filename, int repetitions, SurfaceMesh& mesh)
+{
+    double best = -1.0;
+    for (int i = 0; i < repetitions; ++i)
+    {
+        Timer timer;
+        timer.start();
+        if (!mesh.read(filename))
+            return -1.0;
+        timer.stop();
+        if (best < 0.0 || timer.elapsed() < best)
+            best = timer.elapsed();
+    }
+    return best;
+}
+
+//----------------------------------------------------------------------------
+
+// fastest time in ms for nearest point queries at the mesh vertices, either
+// one by one or batched
+double time_nearest(SurfaceMesh& mesh, int repetitions, bool batched)
+{
+    // the tree as built by SurfaceRemeshing
+    TriangleKdTree tree(mesh, 0);
+
+    // query slightly off the surface, in vertex order
+    const Scalar offset = 0.001 * mesh.bounds().size();
+    std::vector<Point> points;
+    points.reserve(mesh.n_vertices());
+    for (auto v : mesh.vertices())
+        points.push_back(mesh.position(v) + Point(offset));
+
+    double best = -1.0;
+    for (int i = 0; i < repetitions; ++i)
+    {
+        Timer timer;
+        timer.start();
+        if (batched)
+        {
+            tree.nearest(points);
+        }
+        else
+        {
+            for (const auto& p : points)
+                tree.nearest(p);
+        }
+        timer.stop();
+        if (best < 0.0 || timer.elapsed() < best)
+            best = timer.elapsed();
+    }
+    return best;
+}
+
+//----------------------------------------------------------------------------
+
+// fastest time in ms for the geodesic distances of all vertices to the first
+// one, without the setup of virtual edges
+double time_geodesic(SurfaceMesh& mesh, int repetitions)
+{
+    SurfaceGeodesic geodesic(mesh);
+    const std::vector<Vertex> seed(1, *mesh.vertices_begin());
+
+    double best = -1.0;
+    for (int i = 0; i < repetitions; ++i)
+    {
+        Timer timer;
+        timer.start();
+        geodesic.compute(seed);
+        timer.stop();
+        if (best < 0.0 || timer.elapsed() < best)
+            best = timer.elapsed();
+    }
+    return best;
+}
+
+//----------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+    int repetitions = 3;
+    bool kd_tree = false;
+    bool geodesic = false;
+
+    // parse command line parameters
+    int c;
+    while ((c = getopt(argc, argv, "r:kg")) != -1)
+    {
+        switch (c)
+        {
+            case 'r':
+                repetitions = std::max(1, atoi(optarg));
+                break;
+
+            case 'k':
+                kd_tree = true;
+                break;
+
+            case 'g':
+                geodesic = true;
+                break;
+
+            default:
+                usage_and_exit();
+        }
+    }
+
+    if (optind == argc)
+    {
+        usage_and_exit();
+    }
+
+    const unsigned int threads = num_threads();
+    std::cout << std::fixed << std::setprecision(1);
+
+    for (int i = optind; i < argc; ++i)
+    {
+        const char* input = argv[i];
+
+        struct stat st;
+        if (stat(input, &st) != 0)
+        {
+            std::cerr << "cannot open \"" << input << "\"\n";
+            continue;
+        }
+        const double mb = st.st_size / (1024.0 * 1024.0);
+
+        SurfaceMesh mesh;
+        set_num_threads(1);
+        const double serial = time_read(input, repetitions, mesh);
+        set_num_threads(threads);
+        const double parallel = time_read(input, repetitions, mesh);
+        if (serial < 0.0 || parallel < 0.0)
+        {
+            std::cerr << "cannot read mesh \"" << input << "\"\n";
+            continue;
+        }
+
+        std::cout << input << ": " << mb << " MB, " << mesh.n_vertices()
+                  << " vertices, " << mesh.n_faces() << " faces\n"
+                  << "  1 thread:  " << serial << " ms, "
+                  << 1000.0 * mb / serial << " MB/s\n"
+                  << "  " << threads << " threads: " << parallel << " ms, "
+                  << 1000.0 * mb / parallel << " MB/s\n";
+
+        if (kd_tree && mesh.is_triangle_mesh())
+        {
+            set_num_threads(1);
+            const double single = time_nearest(mesh, repetitions, false);
+            set_num_threads(threads);
+            const double batched = time_nearest(mesh, repetitions, true);
+            const double queries = mesh.n_vertices();
+
+            std::cout << "  nearest, 1 thread:  " << single << " ms, "
+                      << queries / single << " k queries/s\n"
+                      << "  nearest, batched:   " << batched << " ms, "
+                      << queries / batched << " k queries/s\n";
+        }
+
+        if (geodesic && mesh.n_vertices() > 0)
+        {
+            const double geodesic_time = time_geodesic(mesh, repetitions);
+            std::cout << "  geodesic distances: " << geodesic_time << " ms, "
+                      << mesh.n_vertices() / geodesic_time
+                      << " k vertices/s\n";
+        }
+    }
+
+    exit(0);
+}
+
+//=============================================================================
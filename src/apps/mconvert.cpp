@@ -8,31 +8,261 @@
 //=============================================================================
 
 #include <pmp/SurfaceMesh.h>
+#include <pmp/SurfaceMeshStream.h>
+#include <pmp/PointWelder.h>
+#include <pmp/Timer.h>
+
+#include <dirent.h>
+#include <glob.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
 using namespace pmp;
 
 //=============================================================================
 
 void usage_and_exit()
 {
-    std::cerr << "Usage:\nmconvert [-b] -i <input> -o <output>\n\nOptions\n"
-              << " -b:  write binary format\n"
-              << "\n";
+    std::cerr
+        << "Usage:\nmconvert [-b] [-s | -m] [-j <threads>] -i <input> "
+           "[-i <input> ...] -o <output> [<input> ...]\n\n"
+        << "An input is a mesh file, a directory of mesh files, or a quoted "
+           "glob pattern.\nSeveral inputs are converted in parallel, their "
+           "output is a template where\n{name} is replaced by the input file "
+           "name without extension and {dir} by\nits directory, e.g., -o "
+           "\"out/{name}.ply\".\n\n"
+        << "Options\n"
+        << " -b:  write binary format\n"
+        << " -s:  stream the mesh with bounded memory, keeping only "
+           "positions and faces\n"
+        << " -m:  never stream, build the mesh and keep all attributes\n"
+        << " -j:  number of files converted in parallel, default all cores\n"
+        << "\nSTL inputs and XYZ outputs are streamed unless -m is given, "
+           "STL vertices are\nwelded.\n"
+        << "\n";
     exit(1);
 }
 
 //----------------------------------------------------------------------------
 
+//! lower case extension of filename, without a .gz or .zst suffix
+std::string extension(const std::string& filename)
+{
+    std::string name = filename;
+    for (int i = 0; i < 2; ++i)
+    {
+        std::string::size_type dot = name.rfind('.');
+        if (dot == std::string::npos)
+            return "";
+        std::string ext = name.substr(dot + 1);
+        std::transform(ext.begin(), ext.end(), ext.begin(), tolower);
+        if (ext != "gz" && ext != "zst")
+            return ext;
+        name = name.substr(0, dot);
+    }
+    return "";
+}
+
+//----------------------------------------------------------------------------
+
+bool is_mesh_file(const std::string& filename)
+{
+    static const char* formats[] = {"off", "obj", "stl",  "ply",
+                                    "pmp", "pmpz", "xyz", "agi"};
+    const std::string ext = extension(filename);
+    for (auto f : formats)
+        if (ext == f)
+            return true;
+    return false;
+}
+
+//----------------------------------------------------------------------------
+
+//! add the files of input, a file, a directory, or a glob pattern
+void expand_input(const std::string& input, std::vector<std::string>& files)
+{
+    struct stat st;
+    if (stat(input.c_str(), &st) == 0)
+    {
+        if (!S_ISDIR(st.st_mode))
+        {
+            files.push_back(input);
+            return;
+        }
+
+        // the mesh files of the directory, sorted
+        std::vector<std::string> entries;
+        if (DIR* dir = opendir(input.c_str()))
+        {
+            while (dirent* entry = readdir(dir))
+            {
+                const std::string path = input + "/" + entry->d_name;
+                if (is_mesh_file(path) && stat(path.c_str(), &st) == 0 &&
+                    S_ISREG(st.st_mode))
+                    entries.push_back(path);
+            }
+            closedir(dir);
+        }
+        std::sort(entries.begin(), entries.end());
+        files.insert(files.end(), entries.begin(), entries.end());
+        return;
+    }
+
+    glob_t matches;
+    if (glob(input.c_str(), 0, nullptr, &matches) == 0)
+    {
+        for (size_t i = 0; i < matches.gl_pathc; ++i)
+            files.push_back(matches.gl_pathv[i]);
+    }
+    else
+    {
+        // let the conversion report the missing file
+        files.push_back(input);
+    }
+    globfree(&matches);
+}
+
+//----------------------------------------------------------------------------
+
+//! the output file of input for the template output
+std::string output_name(const std::string& output, const std::string& input)
+{
+    std::string dir = ".", name = input;
+    std::string::size_type slash = input.find_last_of('/');
+    if (slash != std::string::npos)
+    {
+        dir = input.substr(0, slash);
+        name = input.substr(slash + 1);
+    }
+
+    // strip a compression suffix and the extension
+    for (int i = 0; i < 2; ++i)
+    {
+        std::string::size_type dot = name.rfind('.');
+        if (dot == std::string::npos)
+            break;
+        std::string ext = name.substr(dot + 1);
+        std::transform(ext.begin(), ext.end(), ext.begin(), tolower);
+        name = name.substr(0, dot);
+        if (ext != "gz" && ext != "zst")
+            break;
+    }
+
+    std::string result = output;
+    for (auto& replacement : {std::make_pair(std::string("{name}"), name),
+                              std::make_pair(std::string("{dir}"), dir)})
+    {
+        std::string::size_type pos;
+        while ((pos = result.find(replacement.first)) != std::string::npos)
+            result.replace(pos, replacement.first.size(), replacement.second);
+    }
+    return result;
+}
+
+//----------------------------------------------------------------------------
+
+//! merges the coincident vertices of a streamed triangle soup, e.g., STL
+class WeldingSink : public SurfaceMeshSink
+{
+public:
+    explicit WeldingSink(SurfaceMeshSink& sink) : sink_(sink) {}
+
+    bool begin(size_t n_vertices, size_t n_faces) override
+    {
+        // the number of welded vertices is not known in advance
+        (void)n_vertices;
+        return sink_.begin(0, n_faces);
+    }
+
+    bool vertices(const std::vector<Point>& points) override
+    {
+        new_points_.clear();
+        for (const auto& p : points)
+        {
+            const size_t n = welder_.size();
+            const IndexType idx = welder_.insert(p);
+            if (idx == n)
+                new_points_.push_back(p);
+            map_.push_back(idx);
+        }
+        return new_points_.empty() || sink_.vertices(new_points_);
+    }
+
+    bool faces(const std::vector<IndexType>& indices,
+               const std::vector<IndexType>& face_sizes) override
+    {
+        welded_.resize(indices.size());
+        for (size_t i = 0; i < indices.size(); ++i)
+        {
+            if (indices[i] >= map_.size())
+                return false;
+            welded_[i] = map_[indices[i]];
+        }
+        return sink_.faces(welded_, face_sizes);
+    }
+
+    bool end() override { return sink_.end(); }
+
+private:
+    SurfaceMeshSink& sink_;
+    PointWelder welder_;
+    std::vector<IndexType> map_; // streamed vertex to welded vertex
+    std::vector<Point> new_points_;
+    std::vector<IndexType> welded_;
+};
+
+//----------------------------------------------------------------------------
+
+//! convert input to output, returns an error message on failure
+std::string convert(const std::string& input, const std::string& output,
+                    const IOFlags& flags, bool stream)
+{
+    // convert without building the mesh
+    if (stream)
+    {
+        SurfaceMeshStreamWriter writer(output, flags);
+        bool ok;
+        if (extension(input) == "stl")
+        {
+            WeldingSink welder(writer);
+            ok = read_stream(input, welder);
+        }
+        else
+            ok = read_stream(input, writer);
+        return ok ? "" : "cannot convert mesh \"" + input + "\"";
+    }
+
+    // load input mesh
+    SurfaceMesh mesh;
+    if (!mesh.read(input))
+        return "cannot read mesh \"" + input + "\"";
+
+    // write output mesh
+    if (!mesh.write(output, flags))
+        return "cannot write mesh \"" + output + "\"";
+
+    return "";
+}
+
+//----------------------------------------------------------------------------
+
 int main(int argc, char** argv)
 {
     bool binary = false;
-    const char* input = nullptr;
+    bool stream = false;
+    bool build = false;
+    unsigned int n_threads = std::thread::hardware_concurrency();
+    std::vector<std::string> inputs;
     const char* output = nullptr;
 
     // parse command line parameters
     int c;
-    while ((c = getopt(argc, argv, "bi:o:")) != -1)
+    while ((c = getopt(argc, argv, "bsmj:i:o:")) != -1)
     {
         switch (c)
         {
@@ -40,8 +270,20 @@ int main(int argc, char** argv)
                 binary = true;
                 break;
 
+            case 's':
+                stream = true;
+                break;
+
+            case 'm':
+                build = true;
+                break;
+
+            case 'j':
+                n_threads = atoi(optarg);
+                break;
+
             case 'i':
-                input = optarg;
+                inputs.push_back(optarg);
                 break;
 
             case 'o':
@@ -52,31 +294,94 @@ int main(int argc, char** argv)
                 usage_and_exit();
         }
     }
+    for (int i = optind; i < argc; ++i)
+        inputs.push_back(argv[i]);
 
     // we need input and output mesh
-    if (!input || !output)
+    if (inputs.empty() || !output || (stream && build))
     {
         usage_and_exit();
     }
 
-    // load input mesh
-    SurfaceMesh mesh;
-    if (!mesh.read(input))
+    std::vector<std::string> files;
+    for (const auto& input : inputs)
+        expand_input(input, files);
+
+    // several files need an output template
+    const std::string templ = output;
+    const bool batch = files.size() > 1;
+    if (batch && templ.find("{name}") == std::string::npos)
     {
-        std::cerr << "cannot read mesh \"" << input << "\"\n";
+        std::cerr << "the output \"" << templ
+                  << "\" has to contain {name} for several inputs\n";
         exit(1);
     }
 
-    // write output mesh
     IOFlags flags;
     flags.use_binary = binary;
-    if (!mesh.write(output, flags))
+
+    // positions and faces suffice for STL inputs and XYZ outputs
+    const std::string output_ext = extension(templ);
+    const bool can_stream = output_ext == "off" || output_ext == "obj" ||
+                            output_ext == "ply" || output_ext == "xyz";
+    auto use_stream = [&](const std::string& input) {
+        return stream || (!build && can_stream &&
+                          (extension(input) == "stl" || output_ext == "xyz"));
+    };
+
+    Timer timer;
+    timer.start();
+
+    // convert the files on a pool of workers
+    std::atomic<size_t> next(0);
+    std::atomic<size_t> n_failed(0);
+    std::atomic<size_t> bytes(0);
+    std::mutex cerr_mutex;
+    auto worker = [&]() {
+        size_t i;
+        while ((i = next++) < files.size())
+        {
+            const std::string& input = files[i];
+            const std::string error = convert(
+                input, output_name(templ, input), flags, use_stream(input));
+            if (!error.empty())
+            {
+                ++n_failed;
+                std::lock_guard<std::mutex> lock(cerr_mutex);
+                std::cerr << error << "\n";
+                continue;
+            }
+
+            struct stat st;
+            if (stat(input.c_str(), &st) == 0)
+                bytes += size_t(st.st_size);
+        }
+    };
+
+    n_threads = std::max(1u, std::min(n_threads, (unsigned int)files.size()));
+    std::vector<std::thread> workers;
+    for (unsigned int i = 1; i < n_threads; ++i)
+        workers.emplace_back(worker);
+    worker();
+    for (auto& w : workers)
+        w.join();
+
+    timer.stop();
+
+    // throughput summary of batches
+    if (batch)
     {
-        std::cerr << "cannot write mesh \"" << output << "\"\n";
-        exit(1);
+        const double seconds = 1e-3 * timer.elapsed();
+        const double megabytes = bytes / (1024.0 * 1024.0);
+        std::cout << files.size() - n_failed << " of " << files.size()
+                  << " files converted on " << n_threads << " threads in "
+                  << timer << "\n";
+        if (seconds > 0.0)
+            std::cout << files.size() / seconds << " files/s, "
+                      << megabytes / seconds << " MB/s read\n";
     }
 
-    exit(0);
+    exit(n_failed ? 1 : 0);
 }
 
 //=============================================================================
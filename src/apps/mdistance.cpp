@@ -0,0 +1,105 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/SurfaceMesh.h>
+#include <pmp/Timer.h>
+#include <pmp/algorithms/SurfaceDistance.h>
+
+#include <unistd.h>
+
+#include <cstdlib>
+#include <iostream>
+
+using namespace pmp;
+
+//=============================================================================
+
+void usage_and_exit()
+{
+    std::cerr << "Usage:\nmdistance [-s <spacing>] <mesh A> <mesh B>\n\n"
+              << "Reports the distances from A to B, from B to A and the "
+                 "symmetric Hausdorff distance of two triangle meshes.\n\n"
+              << "Options\n"
+              << " -s:  sample spacing relative to the bounding box diagonal "
+                 "of A, default 0.001\n"
+              << "\n";
+    exit(1);
+}
+
+//----------------------------------------------------------------------------
+
+void print(const char* name, const DistanceStatistics& d)
+{
+    std::cout << name << ": max " << d.max << ", mean " << d.mean << ", rms "
+              << d.rms << ", " << d.n_samples << " samples\n";
+}
+
+//----------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+    Scalar spacing = 0.001;
+
+    // parse command line parameters
+    int c;
+    while ((c = getopt(argc, argv, "s:")) != -1)
+    {
+        switch (c)
+        {
+            case 's':
+                spacing = Scalar(atof(optarg));
+                break;
+
+            default:
+                usage_and_exit();
+        }
+    }
+
+    if (argc - optind != 2)
+    {
+        usage_and_exit();
+    }
+
+    SurfaceMesh a, b;
+    if (!a.read(argv[optind]))
+    {
+        std::cerr << "cannot read mesh \"" << argv[optind] << "\"\n";
+        exit(1);
+    }
+    if (!b.read(argv[optind + 1]))
+    {
+        std::cerr << "cannot read mesh \"" << argv[optind + 1] << "\"\n";
+        exit(1);
+    }
+    if (!a.is_triangle_mesh() || !b.is_triangle_mesh())
+    {
+        std::cerr << "both meshes have to be triangle meshes\n";
+        exit(1);
+    }
+
+    const Scalar diagonal = a.bounds().size();
+    std::cout << "bounding box diagonal of A: " << diagonal << "\n";
+
+    Timer timer;
+    timer.start();
+    const DistanceStatistics ab =
+        SurfaceDistance(b).distance(a, spacing * diagonal);
+    const DistanceStatistics ba =
+        SurfaceDistance(a).distance(b, spacing * diagonal);
+    timer.stop();
+
+    print("A to B   ", ab);
+    print("B to A   ", ba);
+    print("symmetric", symmetric_distance(ab, ba));
+    std::cout << "time: " << timer.elapsed() << " ms\n";
+
+    exit(0);
+}
+
+//=============================================================================
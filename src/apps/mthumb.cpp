@@ -0,0 +1,116 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/visualization/OffscreenRenderer.h>
+#include <pmp/Timer.h>
+
+#include <unistd.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace pmp;
+
+//=============================================================================
+
+void usage_and_exit()
+{
+    std::cerr << "Usage:\nmthumb [-s <size>] [-m <draw mode>] [-o <dir>] "
+                 "<mesh> ...\n\n"
+              << "Renders a PNG thumbnail <mesh>.png of each mesh without a "
+                 "window, using EGL on headless machines.\n\n"
+              << "Options\n"
+              << " -s:  width and height in pixels, default 256\n"
+              << " -m:  draw mode, e.g. \"Hidden Line\", default \"Smooth "
+                 "Shading\"\n"
+              << " -o:  output directory, default next to each mesh\n"
+              << "\n";
+    exit(1);
+}
+
+//----------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+    int size = 256;
+    std::string draw_mode = "Smooth Shading";
+    std::string directory;
+
+    // parse command line parameters
+    int c;
+    while ((c = getopt(argc, argv, "s:m:o:")) != -1)
+    {
+        switch (c)
+        {
+            case 's':
+                size = atoi(optarg);
+                break;
+
+            case 'm':
+                draw_mode = optarg;
+                break;
+
+            case 'o':
+                directory = optarg;
+                break;
+
+            default:
+                usage_and_exit();
+        }
+    }
+
+    if (optind == argc || size <= 0)
+    {
+        usage_and_exit();
+    }
+
+    // one context, shaders, and buffers for all meshes
+    OffscreenRenderer renderer(size, size);
+    if (!renderer.is_valid())
+    {
+        std::cerr << "cannot create an OpenGL context\n";
+        exit(1);
+    }
+    renderer.set_draw_mode(draw_mode);
+
+    Timer timer;
+    timer.start();
+    int n_rendered = 0;
+    for (int i = optind; i < argc; ++i)
+    {
+        std::string output = std::string(argv[i]) + ".png";
+        if (!directory.empty())
+        {
+            size_t slash = output.find_last_of("/\\");
+            if (slash != std::string::npos)
+                output = output.substr(slash + 1);
+            output = directory + "/" + output;
+        }
+
+        if (!renderer.render(argv[i]))
+        {
+            std::cerr << "cannot read mesh \"" << argv[i] << "\"\n";
+            continue;
+        }
+        if (!renderer.write_png(output.c_str()))
+        {
+            std::cerr << "cannot write \"" << output << "\"\n";
+            continue;
+        }
+        ++n_rendered;
+    }
+    timer.stop();
+
+    std::cout << n_rendered << " thumbnails in " << timer << "\n";
+
+    return n_rendered == argc - optind ? 0 : 1;
+}
+
+//=============================================================================
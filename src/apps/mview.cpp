@@ -15,10 +15,16 @@ int main(int argc, char **argv)
 {
 #ifndef __EMSCRIPTEN__
     pmp::MeshViewer viewer("MeshViewer", 800, 600);
-    if (argc > 1)
-        viewer.load_mesh(argv[1]);
     if (argc > 2)
+    {
+        viewer.load_mesh(argv[1]);
         viewer.load_texture(argv[2], GL_SRGB8);
+    }
+    else if (argc > 1)
+    {
+        // show a preview of large meshes while they are read
+        viewer.load_mesh_async(argv[1]);
+    }
     return viewer.run();
 #else
     pmp::MeshViewer viewer("MeshViewer", 800, 600, false);
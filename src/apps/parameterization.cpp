@@ -25,6 +25,14 @@ protected:
     virtual void draw(const std::string& _draw_mode) override;
 
 private:
+    // the vertex texture coordinates are drawn only without "h:tex"
+    void remove_halfedge_tex()
+    {
+        auto htex = mesh_.get_halfedge_property<TexCoord>("h:tex");
+        if (htex)
+            mesh_.remove_halfedge_property(htex);
+    }
+
     SurfaceParameterization param_;
 };
 
@@ -51,6 +59,7 @@ void Viewer::process_imgui()
         if (ImGui::Button("Discrete Harmonic Param"))
         {
             param_.harmonic();
+            remove_halfedge_tex();
             mesh_.use_checkerboard_texture();
             set_draw_mode("Texture");
             update_mesh();
@@ -60,6 +69,16 @@ void Viewer::process_imgui()
         if (ImGui::Button("Least Squares Conformal Map"))
         {
             param_.lscm();
+            remove_halfedge_tex();
+            mesh_.use_checkerboard_texture();
+            set_draw_mode("Texture");
+            update_mesh();
+        }
+
+        ImGui::Spacing();
+        if (ImGui::Button("Texture Atlas"))
+        {
+            param_.atlas();
             mesh_.use_checkerboard_texture();
             set_draw_mode("Texture");
             update_mesh();
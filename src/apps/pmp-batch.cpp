@@ -0,0 +1,392 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/SurfaceMesh.h>
+#include <pmp/MemoryUsage.h>
+#include <pmp/Timer.h>
+#include <pmp/algorithms/SurfaceFairing.h>
+#include <pmp/algorithms/SurfaceRemeshing.h>
+#include <pmp/algorithms/SurfaceSimplification.h>
+#include <pmp/algorithms/SurfaceSmoothing.h>
+
+#include <getopt.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+using namespace pmp;
+
+//=============================================================================
+
+void usage_and_exit()
+{
+    std::cerr
+        << "Usage:\npmp-batch [options] <operation> ... <mesh> ...\n\n"
+        << "Applies the operations in the given order to each mesh and "
+           "prints the time\nand memory of each stage as JSON.\n\n"
+        << "Operations\n"
+        << " --simplify <n>[%]        decimate to n vertices or n percent "
+           "of the vertices\n"
+        << " --remesh uniform|adaptive  isotropic remeshing with the mean "
+           "edge length or\n"
+        << "                          adaptive remeshing relative to the "
+           "bounding box\n"
+        << " --smooth <iterations>    explicit Laplacian smoothing\n"
+        << " --implicit-smooth <dt>   implicit Laplacian smoothing with time "
+           "step dt\n"
+        << " --fair <k>               minimize the k-th order energy, 1 area, "
+           "2 curvature\n"
+        << "\nOptions\n"
+        << " -o, --output <template>  write the results, {name} and {dir} "
+           "are replaced by\n"
+        << "                          the input file name without extension "
+           "and its directory,\n"
+        << "                          e.g., \"out/{name}.ply\"\n"
+        << " -b, --binary             write binary formats\n"
+        << " -j, --jobs <n>           number of meshes processed in parallel, "
+           "default 1\n"
+        << "\n";
+    exit(1);
+}
+
+//----------------------------------------------------------------------------
+
+//! an operation of the chain
+struct Operation
+{
+    std::string name;
+    std::string argument;
+};
+
+//! the measurements of a stage
+struct Stage
+{
+    std::string name;
+    double ms;
+    size_t n_vertices, n_faces;
+    size_t memory;      // resident set size of the process after the stage
+    size_t mesh_memory; // bytes allocated by the mesh after the stage
+};
+
+//! the result of processing a mesh
+struct Result
+{
+    std::string input, output, error;
+    std::vector<Stage> stages;
+};
+
+//----------------------------------------------------------------------------
+
+//! the output file of input for the template output
+std::string output_name(const std::string& output, const std::string& input)
+{
+    std::string dir = ".", name = input;
+    std::string::size_type slash = input.find_last_of('/');
+    if (slash != std::string::npos)
+    {
+        dir = input.substr(0, slash);
+        name = input.substr(slash + 1);
+    }
+
+    // strip a compression suffix and the extension
+    for (int i = 0; i < 2; ++i)
+    {
+        std::string::size_type dot = name.rfind('.');
+        if (dot == std::string::npos)
+            break;
+        std::string ext = name.substr(dot + 1);
+        std::transform(ext.begin(), ext.end(), ext.begin(), tolower);
+        name = name.substr(0, dot);
+        if (ext != "gz" && ext != "zst")
+            break;
+    }
+
+    std::string result = output;
+    for (auto& replacement : {std::make_pair(std::string("{name}"), name),
+                              std::make_pair(std::string("{dir}"), dir)})
+    {
+        std::string::size_type pos;
+        while ((pos = result.find(replacement.first)) != std::string::npos)
+            result.replace(pos, replacement.first.size(), replacement.second);
+    }
+    return result;
+}
+
+//----------------------------------------------------------------------------
+
+//! apply op to mesh, returns an error message on failure
+std::string apply(const Operation& op, SurfaceMesh& mesh)
+{
+    if (op.name != "smooth" && !mesh.is_triangle_mesh())
+        return op.name + " requires a triangle mesh";
+
+    if (op.name == "simplify")
+    {
+        const double n = atof(op.argument.c_str());
+        const bool percent = op.argument.back() == '%';
+        const double target = percent ? 0.01 * n * mesh.n_vertices() : n;
+        if (target <= 0.0)
+            return "invalid target \"" + op.argument + "\"";
+
+        SurfaceSimplification ss(mesh);
+        ss.initialize(10.0, 0.0, 0.0, 180.0); // defaults of the decimation app
+        ss.simplify((unsigned int)target);
+    }
+    else if (op.name == "remesh")
+    {
+        if (op.argument == "uniform")
+        {
+            Scalar l(0);
+            for (auto e : mesh.edges())
+                l += mesh.edge_length(e);
+            l /= (Scalar)mesh.n_edges();
+            SurfaceRemeshing(mesh).uniform_remeshing(l);
+        }
+        else if (op.argument == "adaptive")
+        {
+            auto bb = mesh.bounds().size();
+            SurfaceRemeshing(mesh).adaptive_remeshing(0.001 * bb, // min length
+                                                      0.100 * bb, // max length
+                                                      0.001 * bb); // error
+        }
+        else
+            return "unknown remeshing \"" + op.argument + "\"";
+    }
+    else if (op.name == "smooth")
+    {
+        const int iterations = atoi(op.argument.c_str());
+        if (iterations <= 0)
+            return "invalid iterations \"" + op.argument + "\"";
+        SurfaceSmoothing(mesh).explicit_smoothing(iterations);
+    }
+    else if (op.name == "implicit-smooth")
+    {
+        const Scalar timestep = Scalar(atof(op.argument.c_str()));
+        if (timestep <= 0)
+            return "invalid time step \"" + op.argument + "\"";
+        SurfaceSmoothing(mesh).implicit_smoothing(timestep);
+    }
+    else if (op.name == "fair")
+    {
+        const int k = atoi(op.argument.c_str());
+        if (k <= 0)
+            return "invalid order \"" + op.argument + "\"";
+        SurfaceFairing(mesh).fair(k);
+    }
+
+    return "";
+}
+
+//----------------------------------------------------------------------------
+
+//! read input, apply the operations, and write the result
+Result process(const std::string& input, const std::vector<Operation>& ops,
+               const std::string& output, const IOFlags& flags)
+{
+    Result result;
+    result.input = input;
+
+    SurfaceMesh mesh;
+    Timer timer;
+    auto stage = [&](const std::string& name) {
+        timer.stop();
+        result.stages.push_back({name, timer.elapsed(), mesh.n_vertices(),
+                                 mesh.n_faces(),
+                                 MemoryUsage::current_size(),
+                                 mesh.memory_stats().capacity()});
+    };
+
+    timer.start();
+    if (!mesh.read(input))
+    {
+        result.error = "cannot read mesh";
+        return result;
+    }
+    stage("read");
+
+    for (const auto& op : ops)
+    {
+        timer.start();
+        result.error = apply(op, mesh);
+        if (!result.error.empty())
+            return result;
+        stage(op.name);
+    }
+
+    if (!output.empty())
+    {
+        result.output = output_name(output, input);
+        timer.start();
+        if (!mesh.write(result.output, flags))
+        {
+            result.error = "cannot write mesh";
+            return result;
+        }
+        stage("write");
+    }
+
+    return result;
+}
+
+//----------------------------------------------------------------------------
+
+std::string json_string(const std::string& s)
+{
+    std::string result = "\"";
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\')
+            result += '\\';
+        if (c >= ' ')
+            result += c;
+    }
+    return result + "\"";
+}
+
+//----------------------------------------------------------------------------
+
+void print_json(const std::vector<Result>& results, unsigned int n_jobs,
+                double ms)
+{
+    std::ostringstream os;
+    os << "{\n  \"jobs\": " << n_jobs << ",\n  \"files\": [";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const Result& r = results[i];
+        os << (i ? "," : "") << "\n    {\"input\": " << json_string(r.input);
+        if (!r.output.empty())
+            os << ", \"output\": " << json_string(r.output);
+        if (!r.error.empty())
+            os << ", \"error\": " << json_string(r.error);
+        os << ",\n     \"stages\": [";
+        for (size_t j = 0; j < r.stages.size(); ++j)
+        {
+            const Stage& s = r.stages[j];
+            os << (j ? "," : "") << "\n      {\"name\": "
+               << json_string(s.name) << ", \"ms\": " << s.ms
+               << ", \"vertices\": " << s.n_vertices
+               << ", \"faces\": " << s.n_faces
+               << ", \"memory\": " << s.memory
+               << ", \"mesh_memory\": " << s.mesh_memory << "}";
+        }
+        os << "]}";
+    }
+    os << "\n  ],\n  \"ms\": " << ms
+       << ",\n  \"max_memory\": " << MemoryUsage::max_size() << "\n}\n";
+    std::cout << os.str();
+}
+
+//----------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+    std::vector<Operation> ops;
+    std::string output;
+    IOFlags flags;
+    unsigned int n_jobs = 1;
+
+    const option options[] = {
+        {"simplify", required_argument, nullptr, 's'},
+        {"remesh", required_argument, nullptr, 'r'},
+        {"smooth", required_argument, nullptr, 'm'},
+        {"implicit-smooth", required_argument, nullptr, 'i'},
+        {"fair", required_argument, nullptr, 'f'},
+        {"output", required_argument, nullptr, 'o'},
+        {"binary", no_argument, nullptr, 'b'},
+        {"jobs", required_argument, nullptr, 'j'},
+        {nullptr, 0, nullptr, 0}};
+
+    // parse command line parameters, keeping the order of the operations
+    int c, index;
+    while ((c = getopt_long(argc, argv, "o:bj:", options, &index)) != -1)
+    {
+        switch (c)
+        {
+            case 's':
+            case 'r':
+            case 'm':
+            case 'i':
+            case 'f':
+                ops.push_back({options[index].name, optarg});
+                break;
+
+            case 'o':
+                output = optarg;
+                break;
+
+            case 'b':
+                flags.use_binary = true;
+                break;
+
+            case 'j':
+                n_jobs = atoi(optarg);
+                break;
+
+            default:
+                usage_and_exit();
+        }
+    }
+
+    std::vector<std::string> inputs(argv + optind, argv + argc);
+    if (inputs.empty() || n_jobs == 0)
+    {
+        usage_and_exit();
+    }
+
+    // several files need an output template
+    if (inputs.size() > 1 && !output.empty() &&
+        output.find("{name}") == std::string::npos)
+    {
+        std::cerr << "the output \"" << output
+                  << "\" has to contain {name} for several inputs\n";
+        exit(1);
+    }
+
+    Timer timer;
+    timer.start();
+
+    // process the files on a bounded pool of workers
+    std::vector<Result> results(inputs.size());
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        size_t i;
+        while ((i = next++) < inputs.size())
+            results[i] = process(inputs[i], ops, output, flags);
+    };
+
+    n_jobs = std::min(n_jobs, (unsigned int)inputs.size());
+    std::vector<std::thread> workers;
+    for (unsigned int i = 1; i < n_jobs; ++i)
+        workers.emplace_back(worker);
+    worker();
+    for (auto& w : workers)
+        w.join();
+
+    timer.stop();
+    print_json(results, n_jobs, timer.elapsed());
+
+    bool ok = true;
+    for (const auto& r : results)
+    {
+        if (!r.error.empty())
+        {
+            std::cerr << r.input << ": " << r.error << "\n";
+            ok = false;
+        }
+    }
+
+    exit(ok ? 0 : 1);
+}
+
+//=============================================================================
@@ -0,0 +1,133 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/SurfaceMesh.h>
+#include <pmp/distributed/DistributedSurfaceMesh.h>
+
+#include <mpi.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <iostream>
+
+using namespace pmp;
+
+//=============================================================================
+
+void usage_and_exit(int rank)
+{
+    if (rank == 0)
+        std::cerr << "Usage:\nmpirun -n <processes> pmp-mpi [-i <iterations>] "
+                     "[-u] [-h <halo>] <input> <output>\n\n"
+                  << "Smooths a mesh distributed over the MPI processes.\n\n"
+                  << "Options\n"
+                  << " -i:  number of smoothing iterations, default 10\n"
+                  << " -u:  use the uniform Laplacian instead of cotangents\n"
+                  << " -h:  number of halo rings, default 1\n"
+                  << "\n";
+    MPI_Finalize();
+    exit(1);
+}
+
+//----------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+    MPI_Init(&argc, &argv);
+
+    int exit_code = 0;
+    {
+        DistributedSurfaceMesh distributed;
+        const int rank = distributed.rank();
+
+        unsigned int iterations = 10;
+        unsigned int halo = 1;
+        bool uniform = false;
+
+        // parse command line parameters
+        int c;
+        while ((c = getopt(argc, argv, "i:uh:")) != -1)
+        {
+            switch (c)
+            {
+                case 'i':
+                    iterations = atoi(optarg);
+                    break;
+
+                case 'u':
+                    uniform = true;
+                    break;
+
+                case 'h':
+                    halo = atoi(optarg);
+                    break;
+
+                default:
+                    usage_and_exit(rank);
+            }
+        }
+
+        if (argc - optind != 2 || halo == 0)
+        {
+            usage_and_exit(rank);
+        }
+
+        // all processes stop if the mesh cannot be read
+        SurfaceMesh mesh;
+        int ok = 1;
+        if (rank == 0 && !mesh.read(argv[optind]))
+        {
+            std::cerr << "cannot read mesh \"" << argv[optind] << "\"\n";
+            ok = 0;
+        }
+        MPI_Bcast(&ok, 1, MPI_INT, 0, MPI_COMM_WORLD);
+        if (!ok)
+        {
+            MPI_Finalize();
+            exit(1);
+        }
+
+        double start = MPI_Wtime();
+        int part_ok = distributed.scatter(mesh, halo);
+        MPI_Allreduce(MPI_IN_PLACE, &part_ok, 1, MPI_INT, MPI_MIN,
+                      MPI_COMM_WORLD);
+        if (!part_ok)
+        {
+            if (rank == 0)
+                std::cerr << "cannot distribute the mesh\n";
+            MPI_Finalize();
+            exit(1);
+        }
+        const double scatter_time = MPI_Wtime() - start;
+
+        start = MPI_Wtime();
+        distributed.explicit_smoothing(iterations, uniform);
+        const double smoothing_time = MPI_Wtime() - start;
+
+        distributed.gather_positions(mesh);
+
+        if (rank == 0)
+        {
+            std::cout << distributed.size() << " processes, scatter "
+                      << scatter_time << " s, smoothing " << smoothing_time
+                      << " s\n";
+            if (!mesh.write(argv[optind + 1]))
+            {
+                std::cerr << "cannot write mesh \"" << argv[optind + 1]
+                          << "\"\n";
+                exit_code = 1;
+            }
+        }
+    }
+
+    MPI_Finalize();
+    exit(exit_code);
+}
+
+//=============================================================================
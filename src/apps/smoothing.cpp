@@ -76,7 +76,7 @@ void Viewer::process_imgui()
         if (ImGui::Button("Explicit Smoothing"))
         {
             smoother_.explicit_smoothing(iterations, uniform_laplace);
-            update_mesh();
+            update_mesh_positions();
         }
 
         ImGui::Spacing();
@@ -94,7 +94,7 @@ void Viewer::process_imgui()
             Scalar dt =
                 uniform_laplace ? timestep : timestep * radius_ * radius_;
             smoother_.implicit_smoothing(dt, uniform_laplace);
-            update_mesh();
+            update_mesh_positions();
         }
     }
 }
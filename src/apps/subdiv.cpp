@@ -23,6 +23,15 @@ public:
 
 protected:
     virtual void process_imgui();
+
+private:
+#ifndef __EMSCRIPTEN__
+    //! upload the limit patches if they are shown
+    void update_limit();
+
+    int limit_scheme_;
+    int limit_level_;
+#endif
 };
 
 //=============================================================================
@@ -30,11 +39,34 @@ protected:
 Viewer::Viewer(const char* title, int width, int height, bool showgui)
     : MeshViewer(title, width, height, showgui)
 {
+#ifndef __EMSCRIPTEN__
+    // preview of the limit surface tessellated on the GPU
+    if (SurfaceMeshGL::is_tessellation_supported())
+        add_draw_mode("Limit Surface");
+    limit_scheme_ = 0;
+    limit_level_ = 3;
+#endif
     set_draw_mode("Hidden Line");
 }
 
 //=============================================================================
 
+#ifndef __EMSCRIPTEN__
+void Viewer::update_limit()
+{
+    if (draw_mode_names_[draw_mode_] != "Limit Surface")
+        return;
+
+    mesh_.set_tessellation_level(1u << limit_level_);
+    if (!mesh_.update_limit_patches(limit_scheme_ == 0
+                                        ? SurfaceLimitEvaluation::Loop
+                                        : SurfaceLimitEvaluation::CatmullClark))
+        set_draw_mode("Hidden Line");
+}
+#endif
+
+//=============================================================================
+
 void Viewer::process_imgui()
 {
     MeshViewer::process_imgui();
@@ -61,12 +93,18 @@ void Viewer::process_imgui()
         {
             mesh_.triangulate();
             update_mesh();
+#ifndef __EMSCRIPTEN__
+            update_limit();
+#endif
         }
 
         if (ImGui::Button("Loop Subdivision"))
         {
             SurfaceSubdivision(mesh_).loop();
             update_mesh();
+#ifndef __EMSCRIPTEN__
+            update_limit();
+#endif
         }
 
         //if (ImGui::Button("Sqrt(3) Subdivision"))
@@ -79,8 +117,36 @@ void Viewer::process_imgui()
         {
             SurfaceSubdivision(mesh_).catmull_clark();
             update_mesh();
+#ifndef __EMSCRIPTEN__
+            update_limit();
+#endif
         }
     }
+
+#ifndef __EMSCRIPTEN__
+    if (SurfaceMeshGL::is_tessellation_supported() &&
+        ImGui::CollapsingHeader("Limit Surface"))
+    {
+        // the control mesh is uploaded once, the levels only change the
+        // tessellation on the GPU
+        bool changed = false;
+        changed |= ImGui::RadioButton("Loop", &limit_scheme_, 0);
+        ImGui::SameLine();
+        changed |= ImGui::RadioButton("Catmull-Clark", &limit_scheme_, 1);
+        ImGui::PushItemWidth(100);
+        if (ImGui::SliderInt("Levels", &limit_level_, 0, 6))
+            mesh_.set_tessellation_level(1u << limit_level_);
+        ImGui::PopItemWidth();
+
+        if (ImGui::Button("Show Limit Surface"))
+        {
+            set_draw_mode("Limit Surface");
+            changed = true;
+        }
+        if (changed)
+            update_limit();
+    }
+#endif
 }
 
 //=============================================================================
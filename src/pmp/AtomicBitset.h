@@ -0,0 +1,121 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \addtogroup core core
+//!@{
+
+//! \brief A set of bits that can be modified by several threads at once.
+//! \details The bits are packed into 64-bit words that are modified by
+//! atomic operations, so threads may set and reset arbitrary bits
+//! concurrently, e.g., to mark or claim mesh elements within parallel_for().
+//! Unlike Flag properties, bits of neighboring elements can be written
+//! without conflicts. resize() and clear() must not run concurrently with
+//! other operations. Usage:
+//! \code
+//! AtomicBitset claimed(mesh.vertices_size());
+//! parallel_for(mesh.faces(), [&](Face f) {
+//!     for (auto v : mesh.vertices(f))
+//!         if (!claimed.test_and_set(v.idx()))
+//!             process(v); // runs exactly once for each vertex
+//! });
+//! \endcode
+class AtomicBitset
+{
+public:
+    //! construct with \p n bits that are not set
+    explicit AtomicBitset(size_t n = 0) : size_(0) { resize(n); }
+
+    //! resize to \p n bits that are not set
+    void resize(size_t n)
+    {
+        size_ = n;
+        words_.reset(new std::atomic<std::uint64_t>[n_words()]);
+        clear();
+    }
+
+    //! the number of bits
+    size_t size() const { return size_; }
+
+    //! reset all bits
+    void clear()
+    {
+        for (size_t i = 0; i < n_words(); ++i)
+            words_[i].store(0, std::memory_order_relaxed);
+    }
+
+    //! is bit \p i set?
+    bool test(size_t i) const
+    {
+        assert(i < size_);
+        return (words_[i >> 6].load(std::memory_order_acquire) & mask(i)) !=
+               0;
+    }
+
+    //! set bit \p i
+    void set(size_t i)
+    {
+        assert(i < size_);
+        words_[i >> 6].fetch_or(mask(i), std::memory_order_acq_rel);
+    }
+
+    //! reset bit \p i
+    void reset(size_t i)
+    {
+        assert(i < size_);
+        words_[i >> 6].fetch_and(~mask(i), std::memory_order_acq_rel);
+    }
+
+    //! \brief Set bit \p i and return whether it was set before.
+    //! \details Of several threads setting the same bit, exactly one gets
+    //! false.
+    bool test_and_set(size_t i)
+    {
+        assert(i < size_);
+        return (words_[i >> 6].fetch_or(mask(i), std::memory_order_acq_rel) &
+                mask(i)) != 0;
+    }
+
+    //! the number of set bits
+    size_t count() const
+    {
+        size_t n = 0;
+        for (size_t i = 0; i < n_words(); ++i)
+            for (auto w = words_[i].load(std::memory_order_acquire); w;
+                 w &= w - 1)
+                ++n;
+        return n;
+    }
+
+private:
+    size_t n_words() const { return (size_ + 63) >> 6; }
+
+    static std::uint64_t mask(size_t i) { return std::uint64_t(1) << (i & 63); }
+
+    std::unique_ptr<std::atomic<std::uint64_t>[]> words_;
+    size_t size_;
+};
+
+//!@}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
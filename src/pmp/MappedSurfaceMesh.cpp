@@ -0,0 +1,238 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/MappedSurfaceMesh.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+namespace {
+
+// header of page-aligned .pmp files, see SurfaceMeshIO::write_pmp()
+const char pmp_magic[4] = {'p', 'm', 'p', '\xff'};
+const unsigned char pmp_page_aligned = 1;
+const size_t pmp_n_blocks = 5;
+const size_t pmp_header_size = 8 + 3 * 8 + pmp_n_blocks * 8;
+
+uint64_t read_uint64(const char* p)
+{
+    uint64_t x;
+    memcpy(&x, p, sizeof(x));
+    return x;
+}
+
+} // namespace
+
+//=============================================================================
+
+MappedSurfaceMesh::MappedSurfaceMesh()
+    : data_(nullptr),
+      size_(0),
+      mapped_(false),
+      n_vertices_(0),
+      n_edges_(0),
+      n_faces_(0),
+      vconn_(nullptr),
+      hconn_(nullptr),
+      fconn_(nullptr),
+      points_(nullptr),
+      texcoords_(nullptr)
+{
+}
+
+//-----------------------------------------------------------------------------
+
+MappedSurfaceMesh::~MappedSurfaceMesh()
+{
+    close();
+}
+
+//-----------------------------------------------------------------------------
+
+bool MappedSurfaceMesh::open(const std::string& filename)
+{
+    close();
+
+#ifndef _WIN32
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED)
+        return false;
+
+    data_ = (char*)p;
+    size_ = st.st_size;
+    mapped_ = true;
+#else
+    FILE* in = fopen(filename.c_str(), "rb");
+    if (!in)
+        return false;
+    char chunk[1 << 16];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), in)) > 0)
+        buffer_.insert(buffer_.end(), chunk, chunk + n);
+    fclose(in);
+    if (buffer_.empty())
+        return false;
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+#endif
+
+    // check header
+    if (size_ < pmp_header_size || memcmp(data_, pmp_magic, 4) != 0 ||
+        (unsigned char)data_[7] != pmp_page_aligned)
+    {
+        std::cerr << "MappedSurfaceMesh: " << filename
+                  << " is not a page-aligned .pmp file" << std::endl;
+        close();
+        return false;
+    }
+    if ((unsigned char)data_[4] != sizeof(IndexType) ||
+        (unsigned char)data_[5] != sizeof(Scalar))
+    {
+        std::cerr << "MappedSurfaceMesh: index or scalar type of " << filename
+                  << " does not match, use SurfaceMesh::read()" << std::endl;
+        close();
+        return false;
+    }
+
+    const bool has_htex = data_[6] != 0;
+    const uint64_t nv = read_uint64(data_ + 8);
+    const uint64_t ne = read_uint64(data_ + 16);
+    const uint64_t nf = read_uint64(data_ + 24);
+
+    // check that the blocks are within the file. the counts are checked
+    // before they are multiplied, such that forged counts cannot wrap.
+    const uint64_t counts[pmp_n_blocks] = {nv, ne, nf, nv, has_htex ? ne : 0};
+    const uint64_t element_sizes[pmp_n_blocks] = {
+        sizeof(IndexType), 4 * 2 * sizeof(IndexType), sizeof(IndexType),
+        sizeof(Point), 2 * sizeof(TexCoord)};
+    uint64_t sizes[pmp_n_blocks];
+    const char* blocks[pmp_n_blocks];
+    for (size_t i = 0; i < pmp_n_blocks; ++i)
+    {
+        const uint64_t offset = read_uint64(data_ + 32 + 8 * i);
+        sizes[i] = counts[i] * element_sizes[i];
+        if (counts[i] > size_ / element_sizes[i] || offset > size_ ||
+            sizes[i] > size_ - offset)
+        {
+            std::cerr << "MappedSurfaceMesh: " << filename << " is truncated"
+                      << std::endl;
+            close();
+            return false;
+        }
+        blocks[i] = sizes[i] ? data_ + offset : nullptr;
+    }
+
+    n_vertices_ = nv;
+    n_edges_ = ne;
+    n_faces_ = nf;
+    vconn_ = (const IndexType*)blocks[0];
+    hconn_ = (const IndexType*)blocks[1];
+    fconn_ = (const IndexType*)blocks[2];
+    points_ = (const Point*)blocks[3];
+    texcoords_ = (const TexCoord*)blocks[4];
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void MappedSurfaceMesh::close()
+{
+#ifndef _WIN32
+    if (mapped_)
+        munmap(data_, size_);
+#endif
+    buffer_.clear();
+    data_ = nullptr;
+    size_ = 0;
+    mapped_ = false;
+
+    n_vertices_ = n_edges_ = n_faces_ = 0;
+    vconn_ = hconn_ = fconn_ = nullptr;
+    points_ = nullptr;
+    texcoords_ = nullptr;
+}
+
+//-----------------------------------------------------------------------------
+
+void MappedSurfaceMesh::copy_to(SurfaceMesh& mesh) const
+{
+    mesh.clear();
+    if (!is_open())
+        return;
+
+    mesh.vprops_.resize(n_vertices());
+    mesh.hprops_.resize(n_halfedges());
+    mesh.eprops_.resize(n_edges());
+    mesh.fprops_.resize(n_faces());
+    ++mesh.topology_version_;
+
+    if (n_vertices())
+    {
+        memcpy((void*)mesh.vconn_.data(), vconn_,
+               n_vertices() * sizeof(SurfaceMesh::VertexConnectivity));
+        memcpy((void*)mesh.vpoint_.data(), points_,
+               n_vertices() * sizeof(Point));
+    }
+#ifdef PMP_NO_PREV_HALFEDGE
+    // skip the previous halfedges stored in the file
+    for (size_t i = 0; i < n_halfedges(); ++i)
+    {
+        auto& conn = mesh.hconn_[Halfedge(static_cast<IndexType>(i))];
+        conn.face_ = Face(hconn_[4 * i]);
+        conn.vertex_ = Vertex(hconn_[4 * i + 1]);
+        conn.next_halfedge_ = Halfedge(hconn_[4 * i + 2]);
+    }
+#else
+    if (n_halfedges())
+        memcpy((void*)mesh.hconn_.data(), hconn_,
+               n_halfedges() * sizeof(SurfaceMesh::HalfedgeConnectivity));
+#endif
+    if (n_faces())
+        memcpy((void*)mesh.fconn_.data(), fconn_,
+               n_faces() * sizeof(SurfaceMesh::FaceConnectivity));
+
+    if (texcoords_ && n_halfedges())
+    {
+        auto htex = mesh.halfedge_property<TexCoord>("h:tex");
+        memcpy((void*)htex.data(), texcoords_,
+               n_halfedges() * sizeof(TexCoord));
+    }
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -0,0 +1,140 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <pmp/SurfaceMesh.h>
+
+#include <string>
+#include <vector>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \brief Read-only, zero-copy access to a mesh stored in a .pmp file.
+//! \details Maps a .pmp file written by SurfaceMesh::write() into memory
+//! instead of reading it. Connectivity and positions are accessed directly
+//! in the mapped pages, so opening takes constant time and only the pages
+//! that are touched are loaded from disk. This suits tools that inspect
+//! large meshes. To modify the mesh, promote it to a SurfaceMesh with
+//! copy_to(), which copies the arrays once.
+//!
+//! Only files whose index and scalar widths match the current build can be
+//! mapped; use SurfaceMesh::read() to convert other files. On platforms
+//! without \c mmap the file is read into memory instead. Usage:
+//! \code
+//! MappedSurfaceMesh mapped;
+//! if (mapped.open("large.pmp"))
+//!     for (IndexType i = 0; i < mapped.n_vertices(); ++i)
+//!         bb += mapped.position(Vertex(i));
+//! \endcode
+class MappedSurfaceMesh
+{
+public:
+    MappedSurfaceMesh();
+    ~MappedSurfaceMesh();
+
+    // the mapping cannot be copied
+    MappedSurfaceMesh(const MappedSurfaceMesh&) = delete;
+    MappedSurfaceMesh& operator=(const MappedSurfaceMesh&) = delete;
+
+    //! map the .pmp file \p filename. returns false if the file cannot be
+    //! opened or has an incompatible layout.
+    bool open(const std::string& filename);
+
+    //! unmap the file
+    void close();
+
+    //! returns whether a file is mapped
+    bool is_open() const { return data_ != nullptr; }
+
+    //! \name Element counts
+    //!@{
+
+    size_t n_vertices() const { return n_vertices_; }
+    size_t n_halfedges() const { return 2 * n_edges_; }
+    size_t n_edges() const { return n_edges_; }
+    size_t n_faces() const { return n_faces_; }
+
+    //!@}
+    //! \name Connectivity and geometry
+    //!@{
+
+    //! an outgoing halfedge of vertex \p v
+    Halfedge halfedge(Vertex v) const { return Halfedge(vconn_[v.idx()]); }
+
+    //! a halfedge of face \p f
+    Halfedge halfedge(Face f) const { return Halfedge(fconn_[f.idx()]); }
+
+    //! the face incident to \p h, invalid for boundary halfedges
+    Face face(Halfedge h) const { return Face(hconn_[4 * h.idx()]); }
+
+    //! the vertex \p h points to
+    Vertex to_vertex(Halfedge h) const
+    {
+        return Vertex(hconn_[4 * h.idx() + 1]);
+    }
+
+    //! the next halfedge within the face (or boundary) of \p h
+    Halfedge next_halfedge(Halfedge h) const
+    {
+        return Halfedge(hconn_[4 * h.idx() + 2]);
+    }
+
+    //! the previous halfedge within the face (or boundary) of \p h
+    Halfedge prev_halfedge(Halfedge h) const
+    {
+        return Halfedge(hconn_[4 * h.idx() + 3]);
+    }
+
+    //! the opposite halfedge of \p h
+    Halfedge opposite_halfedge(Halfedge h) const
+    {
+        return Halfedge((h.idx() & 1) ? h.idx() - 1 : h.idx() + 1);
+    }
+
+    //! the position of vertex \p v
+    const Point& position(Vertex v) const { return points_[v.idx()]; }
+
+    //! the array of all vertex positions
+    const Point* positions() const { return points_; }
+
+    //! the per-halfedge texture coordinates, or nullptr if there are none
+    const TexCoord* texcoords() const { return texcoords_; }
+
+    //!@}
+
+    //! \brief copy the mapped mesh into \p mesh for modification.
+    void copy_to(SurfaceMesh& mesh) const;
+
+private:
+    // the mapped or read file
+    char* data_;
+    size_t size_;
+    bool mapped_;
+    std::vector<char> buffer_;
+
+    size_t n_vertices_;
+    size_t n_edges_;
+    size_t n_faces_;
+
+    // the data blocks of the file
+    const IndexType* vconn_;
+    const IndexType* hconn_;
+    const IndexType* fconn_;
+    const Point* points_;
+    const TexCoord* texcoords_;
+};
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -10,11 +10,25 @@
 #pragma once
 //=============================================================================
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <assert.h>
 #include <limits>
 
+// SIMD instructions for vec3a and float 4x4 matrices, unless PMP_NO_SIMD is
+// defined. Emscripten builds with -msimd128 -msse2 translate the SSE path to
+// WebAssembly SIMD.
+#if !defined(PMP_NO_SIMD) && \
+    (defined(__SSE2__) || defined(_M_X64) || \
+     (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define PMP_SIMD_SSE
+#include <emmintrin.h>
+#elif !defined(PMP_NO_SIMD) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define PMP_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
 //=============================================================================
 
 namespace pmp {
@@ -323,6 +337,76 @@ Matrix<Scalar, M, N> operator*(const Matrix<Scalar, M, K>& m1,
 
 //-----------------------------------------------------------------------------
 
+//! \brief 4x4 float matrix-matrix multiplication, e.g., of the viewer's
+//! transformations.
+//! \details Uses SIMD instructions if available. The products are summed in
+//! the same order as by the generic multiplication.
+inline Matrix<float, 4, 4> operator*(const Matrix<float, 4, 4>& m1,
+                                     const Matrix<float, 4, 4>& m2)
+{
+    Matrix<float, 4, 4> m;
+    const float* a = m1.data();
+    for (int j = 0; j < 4; ++j)
+    {
+        const float* b = m2.data() + 4 * j;
+#if defined(PMP_SIMD_SSE)
+        __m128 c = _mm_mul_ps(_mm_loadu_ps(a), _mm_set1_ps(b[0]));
+        for (int k = 1; k < 4; ++k)
+            c = _mm_add_ps(c, _mm_mul_ps(_mm_loadu_ps(a + 4 * k),
+                                         _mm_set1_ps(b[k])));
+        _mm_storeu_ps(m.data() + 4 * j, c);
+#elif defined(PMP_SIMD_NEON)
+        float32x4_t c = vmulq_n_f32(vld1q_f32(a), b[0]);
+        for (int k = 1; k < 4; ++k)
+            c = vaddq_f32(c, vmulq_n_f32(vld1q_f32(a + 4 * k), b[k]));
+        vst1q_f32(m.data() + 4 * j, c);
+#else
+        for (int i = 0; i < 4; ++i)
+        {
+            float c = a[i] * b[0];
+            for (int k = 1; k < 4; ++k)
+                c += a[4 * k + i] * b[k];
+            m(i, j) = c;
+        }
+#endif
+    }
+    return m;
+}
+
+//-----------------------------------------------------------------------------
+
+//! \brief 4x4 float matrix-vector multiplication.
+//! \details Uses SIMD instructions if available.
+inline Matrix<float, 4, 1> operator*(const Matrix<float, 4, 4>& m,
+                                     const Matrix<float, 4, 1>& v)
+{
+    Matrix<float, 4, 1> result;
+    const float* a = m.data();
+#if defined(PMP_SIMD_SSE)
+    __m128 c = _mm_mul_ps(_mm_loadu_ps(a), _mm_set1_ps(v[0]));
+    for (int k = 1; k < 4; ++k)
+        c = _mm_add_ps(c,
+                       _mm_mul_ps(_mm_loadu_ps(a + 4 * k), _mm_set1_ps(v[k])));
+    _mm_storeu_ps(result.data(), c);
+#elif defined(PMP_SIMD_NEON)
+    float32x4_t c = vmulq_n_f32(vld1q_f32(a), v[0]);
+    for (int k = 1; k < 4; ++k)
+        c = vaddq_f32(c, vmulq_n_f32(vld1q_f32(a + 4 * k), v[k]));
+    vst1q_f32(result.data(), c);
+#else
+    for (int i = 0; i < 4; ++i)
+    {
+        float c = a[i] * v[0];
+        for (int k = 1; k < 4; ++k)
+            c += a[4 * k + i] * v[k];
+        result[i] = c;
+    }
+#endif
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+
 //! component-wise multiplication
 template <typename Scalar, int M, int N>
 Matrix<Scalar, M, N> cmult(const Matrix<Scalar, M, N>& m1,
@@ -1146,6 +1230,291 @@ inline Vector<Scalar, 3> cross(const Vector<Scalar, 3>& v0,
                              v0[0] * v1[1] - v0[1] * v1[0]);
 }
 
+
+//== SIMD VECTORS =============================================================
+
+//! \brief A 3D float vector padded to 16 bytes for SIMD instructions.
+//! \details The arithmetic uses SSE or NEON instructions if available, see
+//! PMP_NO_SIMD, and scalar code otherwise. The results are the same as for
+//! vec3, since the components are combined in the same order, unless the
+//! compiler fuses multiplications and additions of vec3. The unused
+//! fourth component is kept zero. Arrays of vec3a, e.g., in a
+//! VertexProperty<vec3a>, are 16-byte aligned, such that kernels working on
+//! them load each vector with a single instruction. Convert from and to
+//! vec3 or dvec3 where a kernel reads or writes the mesh:
+//! \code
+//! vec3a n = cross(vec3a(p1) - vec3a(p0), vec3a(p2) - vec3a(p0));
+//! Normal normal = normalize(n).to_vector<Scalar>();
+//! \endcode
+class alignas(16) vec3a
+{
+public:
+    //! the scalar type of the vector
+    typedef float value_type;
+
+    //! construct the zero vector
+    vec3a() : data_{0, 0, 0, 0} {}
+
+    //! construct from three components
+    vec3a(float x, float y, float z) : data_{x, y, z, 0} {}
+
+    //! construct from a 3D vector of another scalar type
+    template <typename Scalar>
+    explicit vec3a(const Vector<Scalar, 3>& v)
+        : data_{float(v[0]), float(v[1]), float(v[2]), 0}
+    {
+    }
+
+    //! convert to a 3D vector of scalar type \c Scalar
+    template <typename Scalar>
+    Vector<Scalar, 3> to_vector() const
+    {
+        return Vector<Scalar, 3>(data_[0], data_[1], data_[2]);
+    }
+
+    //! access the i'th component
+    float& operator[](unsigned int i)
+    {
+        assert(i < 3);
+        return data_[i];
+    }
+
+    //! const-access the i'th component
+    float operator[](unsigned int i) const
+    {
+        assert(i < 3);
+        return data_[i];
+    }
+
+    //! const-access as an aligned array of four floats
+    const float* data() const { return data_; }
+
+    //! add other vector to this vector
+    vec3a& operator+=(const vec3a& v)
+    {
+#if defined(PMP_SIMD_SSE)
+        _mm_store_ps(data_,
+                     _mm_add_ps(_mm_load_ps(data_), _mm_load_ps(v.data_)));
+#elif defined(PMP_SIMD_NEON)
+        vst1q_f32(data_, vaddq_f32(vld1q_f32(data_), vld1q_f32(v.data_)));
+#else
+        for (int i = 0; i < 3; ++i)
+            data_[i] += v.data_[i];
+#endif
+        return *this;
+    }
+
+    //! subtract other vector from this vector
+    vec3a& operator-=(const vec3a& v)
+    {
+#if defined(PMP_SIMD_SSE)
+        _mm_store_ps(data_,
+                     _mm_sub_ps(_mm_load_ps(data_), _mm_load_ps(v.data_)));
+#elif defined(PMP_SIMD_NEON)
+        vst1q_f32(data_, vsubq_f32(vld1q_f32(data_), vld1q_f32(v.data_)));
+#else
+        for (int i = 0; i < 3; ++i)
+            data_[i] -= v.data_[i];
+#endif
+        return *this;
+    }
+
+    //! multiply this vector by scalar
+    vec3a& operator*=(float s)
+    {
+#if defined(PMP_SIMD_SSE)
+        _mm_store_ps(data_, _mm_mul_ps(_mm_load_ps(data_), _mm_set1_ps(s)));
+#elif defined(PMP_SIMD_NEON)
+        vst1q_f32(data_, vmulq_n_f32(vld1q_f32(data_), s));
+#else
+        for (int i = 0; i < 3; ++i)
+            data_[i] *= s;
+#endif
+        return *this;
+    }
+
+    //! divide this vector by scalar
+    vec3a& operator/=(float s)
+    {
+        for (int i = 0; i < 3; ++i)
+            data_[i] /= s;
+        return *this;
+    }
+
+    //! component-wise comparison
+    bool operator==(const vec3a& v) const
+    {
+        return data_[0] == v.data_[0] && data_[1] == v.data_[1] &&
+               data_[2] == v.data_[2];
+    }
+
+    //! component-wise comparison
+    bool operator!=(const vec3a& v) const { return !(*this == v); }
+
+    //! compute the dot product of two vectors
+    friend float dot(const vec3a& v0, const vec3a& v1)
+    {
+#if defined(PMP_SIMD_SSE)
+        const __m128 m =
+            _mm_mul_ps(_mm_load_ps(v0.data_), _mm_load_ps(v1.data_));
+        __m128 s =
+            _mm_add_ss(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 1, 1, 1)));
+        s = _mm_add_ss(s, _mm_movehl_ps(m, m));
+        return _mm_cvtss_f32(s);
+#elif defined(PMP_SIMD_NEON)
+        const float32x4_t m =
+            vmulq_f32(vld1q_f32(v0.data_), vld1q_f32(v1.data_));
+        return vgetq_lane_f32(m, 0) + vgetq_lane_f32(m, 1) +
+               vgetq_lane_f32(m, 2);
+#else
+        return v0.data_[0] * v1.data_[0] + v0.data_[1] * v1.data_[1] +
+               v0.data_[2] * v1.data_[2];
+#endif
+    }
+
+    //! compute the cross product of two vectors
+    friend vec3a cross(const vec3a& v0, const vec3a& v1)
+    {
+        vec3a result;
+#if defined(PMP_SIMD_SSE)
+        // (v0 * v1.yzx - v0.yzx * v1).yzx
+        const __m128 a = _mm_load_ps(v0.data_);
+        const __m128 b = _mm_load_ps(v1.data_);
+        const __m128 t =
+            _mm_sub_ps(_mm_mul_ps(a, yzx(b)), _mm_mul_ps(yzx(a), b));
+        _mm_store_ps(result.data_, yzx(t));
+#elif defined(PMP_SIMD_NEON)
+        const float32x4_t a = vld1q_f32(v0.data_);
+        const float32x4_t b = vld1q_f32(v1.data_);
+        const float32x4_t t =
+            vsubq_f32(vmulq_f32(a, yzx(b)), vmulq_f32(yzx(a), b));
+        vst1q_f32(result.data_, yzx(t));
+#else
+        const float* a = v0.data_;
+        const float* b = v1.data_;
+        result.data_[0] = a[1] * b[2] - a[2] * b[1];
+        result.data_[1] = a[2] * b[0] - a[0] * b[2];
+        result.data_[2] = a[0] * b[1] - a[1] * b[0];
+#endif
+        return result;
+    }
+
+    //! return component-wise minimum
+    friend vec3a min(const vec3a& v0, const vec3a& v1)
+    {
+        vec3a result;
+#if defined(PMP_SIMD_SSE)
+        // operands swapped to return v0 for equal components, as std::min
+        _mm_store_ps(result.data_, _mm_min_ps(_mm_load_ps(v1.data_),
+                                              _mm_load_ps(v0.data_)));
+#else
+        for (int i = 0; i < 3; ++i)
+            result.data_[i] = std::min(v0.data_[i], v1.data_[i]);
+#endif
+        return result;
+    }
+
+    //! return component-wise maximum
+    friend vec3a max(const vec3a& v0, const vec3a& v1)
+    {
+        vec3a result;
+#if defined(PMP_SIMD_SSE)
+        _mm_store_ps(result.data_, _mm_max_ps(_mm_load_ps(v1.data_),
+                                              _mm_load_ps(v0.data_)));
+#else
+        for (int i = 0; i < 3; ++i)
+            result.data_[i] = std::max(v0.data_[i], v1.data_[i]);
+#endif
+        return result;
+    }
+
+private:
+#if defined(PMP_SIMD_SSE)
+    // the components in the order y, z, x, w
+    static __m128 yzx(__m128 v)
+    {
+        return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 0, 2, 1));
+    }
+#elif defined(PMP_SIMD_NEON)
+    // the components in the order y, z, x, w
+    static float32x4_t yzx(float32x4_t v)
+    {
+        const float32x4_t r = vextq_f32(v, v, 1); // y, z, w, x
+        return vcombine_f32(vget_low_f32(r), vrev64_f32(vget_high_f32(r)));
+    }
+#endif
+
+    float data_[4];
+};
+
+//! vector addition: v0 + v1
+inline vec3a operator+(const vec3a& v0, const vec3a& v1)
+{
+    return vec3a(v0) += v1;
+}
+
+//! vector subtraction: v0 - v1
+inline vec3a operator-(const vec3a& v0, const vec3a& v1)
+{
+    return vec3a(v0) -= v1;
+}
+
+//! vector negation: -v
+inline vec3a operator-(const vec3a& v)
+{
+    return vec3a() -= v;
+}
+
+//! scalar multiplication of vector: v*s
+inline vec3a operator*(const vec3a& v, float s)
+{
+    return vec3a(v) *= s;
+}
+
+//! scalar multiplication of vector: s*v
+inline vec3a operator*(float s, const vec3a& v)
+{
+    return vec3a(v) *= s;
+}
+
+//! divide vector by scalar: v/s
+inline vec3a operator/(const vec3a& v, float s)
+{
+    return vec3a(v) /= s;
+}
+
+//! compute the squared Euclidean norm of a vector
+inline float sqrnorm(const vec3a& v)
+{
+    return dot(v, v);
+}
+
+//! compute the Euclidean norm of a vector
+inline float norm(const vec3a& v)
+{
+    return std::sqrt(sqrnorm(v));
+}
+
+//! return a normalized copy of a vector
+inline vec3a normalize(const vec3a& v)
+{
+    float n = norm(v);
+    n = (n > std::numeric_limits<float>::min()) ? float(1.0 / n) : 0.0f;
+    return v * n;
+}
+
+//! compute the Euclidean distance between two points
+inline float distance(const vec3a& v0, const vec3a& v1)
+{
+    return norm(v0 - v1);
+}
+
+//! output a vector by printing its space-separated components
+inline std::ostream& operator<<(std::ostream& os, const vec3a& v)
+{
+    return os << v[0] << " " << v[1] << " " << v[2];
+}
+
 //=============================================================================
 //!@}
 //=============================================================================
@@ -45,7 +45,7 @@ public:
 
 //-----------------------------------------------------------------------------
 
-size_t MemoryUsage::max_size()
+inline size_t MemoryUsage::max_size()
 {
 #if defined(_WIN32)
 
@@ -70,7 +70,7 @@ size_t MemoryUsage::max_size()
 
 //-----------------------------------------------------------------------------
 
-size_t MemoryUsage::current_size()
+inline size_t MemoryUsage::current_size()
 {
 #if defined(_WIN32)
 
@@ -0,0 +1,164 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/Parallel.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#elif defined(__EMSCRIPTEN_PTHREADS__)
+// Emscripten has no OpenMP, the web build uses the pthreads of its workers
+#define PMP_STD_THREADS
+#include <atomic>
+#include <thread>
+#include <vector>
+#endif
+
+#include <algorithm>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+namespace detail {
+
+// splits the loop into tasks if called from a TaskGraph or Pipeline task, see
+// TaskGraph.cpp
+bool task_parallel_for(size_t n,
+                       const std::function<void(size_t, size_t)>& body,
+                       size_t grain_size);
+
+} // namespace detail
+
+namespace {
+
+// number of threads requested by the user, 0 means default
+unsigned int requested_threads = 0;
+
+// the mode of parallel_reduce()
+Reduction reduction_mode = Reduction::Deterministic;
+
+#ifdef PMP_STD_THREADS
+// whether the calling thread runs a chunk of a parallel loop
+thread_local bool in_parallel = false;
+#endif
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+void set_num_threads(unsigned int n)
+{
+    requested_threads = n;
+}
+
+//-----------------------------------------------------------------------------
+
+unsigned int num_threads()
+{
+#ifdef _OPENMP
+    if (requested_threads)
+        return requested_threads;
+    return std::max(1, omp_get_max_threads());
+#elif defined(PMP_STD_THREADS)
+    if (requested_threads)
+        return requested_threads;
+    return std::max(1u, std::thread::hardware_concurrency());
+#else
+    return 1;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+void set_reduction(Reduction mode)
+{
+    reduction_mode = mode;
+}
+
+//-----------------------------------------------------------------------------
+
+Reduction reduction()
+{
+    return reduction_mode;
+}
+
+//-----------------------------------------------------------------------------
+
+void parallel_for_chunks(size_t n,
+                         const std::function<void(size_t, size_t)>& body,
+                         size_t grain_size)
+{
+    if (n == 0)
+        return;
+
+    const size_t nt = num_threads();
+    grain_size = std::max(grain_size, size_t(1));
+
+    // tasks share the threads of their scheduler instead of starting more
+    if (detail::task_parallel_for(n, body, grain_size))
+        return;
+
+#ifdef _OPENMP
+    const bool serial = (nt < 2 || n <= grain_size || omp_in_parallel());
+#elif defined(PMP_STD_THREADS)
+    const bool serial = (nt < 2 || n <= grain_size || in_parallel);
+#else
+    const bool serial = true;
+#endif
+
+    if (serial)
+    {
+        body(0, n);
+        return;
+    }
+
+    // a few chunks per thread for load balancing
+    const size_t n_chunks = std::min((n + grain_size - 1) / grain_size, 8 * nt);
+    const size_t chunk_size = (n + n_chunks - 1) / n_chunks;
+    const long long n_chunks_ll = static_cast<long long>(n_chunks);
+
+#ifdef PMP_STD_THREADS
+    // the threads, including the calling one, fetch chunks until none is left
+    std::atomic<long long> next_chunk(0);
+    auto worker = [&]() {
+        in_parallel = true;
+        for (long long c = next_chunk++; c < n_chunks_ll; c = next_chunk++)
+        {
+            const size_t b = static_cast<size_t>(c) * chunk_size;
+            const size_t e = std::min(n, b + chunk_size);
+            if (b < e)
+                body(b, e);
+        }
+        in_parallel = false;
+    };
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < std::min(nt, n_chunks); ++t)
+        threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads)
+        thread.join();
+#else
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) num_threads(static_cast<int>(nt))
+#endif
+    for (long long c = 0; c < n_chunks_ll; ++c)
+    {
+        const size_t b = static_cast<size_t>(c) * chunk_size;
+        const size_t e = std::min(n, b + chunk_size);
+        if (b < e)
+            body(b, e);
+    }
+#endif
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -0,0 +1,238 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <pmp/SurfaceMesh.h>
+
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \addtogroup core core
+//!@{
+
+//! \brief Set the number of threads used by parallel_for().
+//! \details A value of 0 restores the default, i.e., one thread per hardware
+//! core. A value of 1 gives deterministic serial execution in index order.
+//! Without OpenMP support all loops run serially.
+void set_num_threads(unsigned int n);
+
+//! \brief Get the number of threads used by parallel_for().
+unsigned int num_threads();
+
+//! \brief Split the index range [0,n) into chunks and call
+//! \c body(begin,end) for each of them, possibly from several threads.
+//! \details Loops with less than \c grain_size elements, or loops started
+//! from within another parallel region, are executed serially.
+void parallel_for_chunks(size_t n,
+                         const std::function<void(size_t, size_t)>& body,
+                         size_t grain_size = 1024);
+
+//! \brief Call \c f(i) for every index \c i in [begin,end) in parallel.
+template <class Function>
+void parallel_for(size_t begin, size_t end, Function f)
+{
+    if (end <= begin)
+        return;
+    parallel_for_chunks(end - begin, [&](size_t b, size_t e) {
+        for (size_t i = begin + b; i < begin + e; ++i)
+            f(i);
+    });
+}
+
+//! \brief How parallel_reduce() combines the partial results of its chunks.
+enum class Reduction
+{
+    //! Chunks of a fixed size, independent of the number of threads, whose
+    //! results are added in a fixed binary tree. The result is bitwise equal
+    //! on any number of threads and machine.
+    Deterministic,
+    //! One partial result per chunk of parallel_for_chunks(), added in the
+    //! order the chunks finish. Fewer additions, but the rounding varies
+    //! between runs.
+    Fast
+};
+
+//! \brief Set the mode of parallel_reduce(), the default is
+//! Reduction::Deterministic.
+void set_reduction(Reduction mode);
+
+//! \brief Get the mode of parallel_reduce().
+Reduction reduction();
+
+//! \brief Sum up \c chunk(begin,end) over chunks of the index range [0,n).
+//! \details \c chunk returns the sum of the elements in [begin,end), which
+//! it has to add up in index order for deterministic results. \c T needs to
+//! support \c += and \p zero has to be its neutral element. In the
+//! deterministic mode, the chunks have \p grain_size elements.
+//! \sa set_reduction()
+template <class T, class Function>
+T parallel_reduce(size_t n, const T& zero, Function chunk,
+                  size_t grain_size = 1024)
+{
+    grain_size = std::max(grain_size, size_t(1));
+
+    if (reduction() == Reduction::Fast)
+    {
+        T sum = zero;
+        std::mutex mutex;
+        parallel_for_chunks(
+            n,
+            [&](size_t b, size_t e) {
+                const T s = chunk(b, e);
+                std::lock_guard<std::mutex> lock(mutex);
+                sum += s;
+            },
+            grain_size);
+        return sum;
+    }
+
+    const size_t n_chunks = (n + grain_size - 1) / grain_size;
+    if (n_chunks == 0)
+        return zero;
+    std::vector<T> partial(n_chunks, zero);
+    parallel_for_chunks(
+        n_chunks,
+        [&](size_t b, size_t e) {
+            for (size_t c = b; c < e; ++c)
+                partial[c] = chunk(c * grain_size,
+                                   std::min(n, (c + 1) * grain_size));
+        },
+        1);
+
+    // pairwise, which also bounds the rounding error by the tree's depth
+    for (size_t step = 1; step < n_chunks; step *= 2)
+        for (size_t c = 0; c + step < n_chunks; c += 2 * step)
+            partial[c] += partial[c + step];
+    return partial[0];
+}
+
+//! \cond PRIVATE
+namespace detail {
+
+template <class HandleType, class Container, class Function>
+void parallel_for_handles(const Container& container, Function f)
+{
+    const auto begin = container.begin();
+    const auto end = container.end();
+    const SurfaceMesh* mesh = begin.mesh();
+    if (!mesh || begin == end)
+        return;
+
+    const size_t first = (*begin).idx();
+    const size_t last = (*end).idx();
+
+    parallel_for_chunks(last - first, [&](size_t b, size_t e) {
+        for (size_t i = first + b; i < first + e; ++i)
+        {
+            HandleType h(static_cast<IndexType>(i));
+            if (!mesh->is_deleted(h))
+                f(h);
+        }
+    });
+}
+
+template <class HandleType, class Container, class T, class Function>
+T parallel_reduce_handles(const Container& container, const T& zero,
+                          Function f)
+{
+    const auto begin = container.begin();
+    const auto end = container.end();
+    const SurfaceMesh* mesh = begin.mesh();
+    if (!mesh || begin == end)
+        return zero;
+
+    const size_t first = (*begin).idx();
+    const size_t last = (*end).idx();
+
+    return parallel_reduce(last - first, zero, [&](size_t b, size_t e) {
+        T sum = zero;
+        for (size_t i = first + b; i < first + e; ++i)
+        {
+            HandleType h(static_cast<IndexType>(i));
+            if (!mesh->is_deleted(h))
+                sum += f(h);
+        }
+        return sum;
+    });
+}
+
+} // namespace detail
+//! \endcond
+
+//! \brief Call \c f(v) for each (non-deleted) vertex in parallel.
+//! \details Usage: \code parallel_for(mesh.vertices(), [&](Vertex v) { ... });
+//! \endcode \c f must only write data associated with \c v.
+template <class Function>
+void parallel_for(const SurfaceMesh::VertexContainer& vertices, Function f)
+{
+    detail::parallel_for_handles<Vertex>(vertices, f);
+}
+
+//! \brief Call \c f(h) for each (non-deleted) halfedge in parallel.
+template <class Function>
+void parallel_for(const SurfaceMesh::HalfedgeContainer& halfedges, Function f)
+{
+    detail::parallel_for_handles<Halfedge>(halfedges, f);
+}
+
+//! \brief Call \c f(e) for each (non-deleted) edge in parallel.
+template <class Function>
+void parallel_for(const SurfaceMesh::EdgeContainer& edges, Function f)
+{
+    detail::parallel_for_handles<Edge>(edges, f);
+}
+
+//! \brief Call \c f(f) for each (non-deleted) face in parallel.
+template <class Function>
+void parallel_for(const SurfaceMesh::FaceContainer& faces, Function f)
+{
+    detail::parallel_for_handles<Face>(faces, f);
+}
+
+//! \brief Sum up \c f(v) over all (non-deleted) vertices in parallel.
+//! \details Usage: \code Scalar sum = parallel_reduce(mesh.vertices(),
+//! Scalar(0), [&](Vertex v) { return weight[v]; }); \endcode
+//! \sa parallel_reduce(size_t, const T&, Function, size_t)
+template <class T, class Function>
+T parallel_reduce(const SurfaceMesh::VertexContainer& vertices, const T& zero,
+                  Function f)
+{
+    return detail::parallel_reduce_handles<Vertex>(vertices, zero, f);
+}
+
+//! \brief Sum up \c f(e) over all (non-deleted) edges in parallel.
+template <class T, class Function>
+T parallel_reduce(const SurfaceMesh::EdgeContainer& edges, const T& zero,
+                  Function f)
+{
+    return detail::parallel_reduce_handles<Edge>(edges, zero, f);
+}
+
+//! \brief Sum up \c f(f) over all (non-deleted) faces in parallel.
+template <class T, class Function>
+T parallel_reduce(const SurfaceMesh::FaceContainer& faces, const T& zero,
+                  Function f)
+{
+    return detail::parallel_reduce_handles<Face>(faces, zero, f);
+}
+
+//!@}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -0,0 +1,169 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/PerfCounters.h>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+namespace {
+
+// the fields of Values in the order of the events
+int64_t PerfCounters::Values::*const fields[] = {
+    &PerfCounters::Values::cycles, &PerfCounters::Values::instructions,
+    &PerfCounters::Values::llc_misses, &PerfCounters::Values::branch_misses};
+
+const int n_events = 4;
+
+#if defined(__linux__)
+
+const uint64_t events[n_events] = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+
+// open a hardware event of the calling thread, in the group of leader
+int open_event(uint64_t config, int leader)
+{
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = config;
+    attr.disabled = (leader == -1);
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                       PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return int(syscall(__NR_perf_event_open, &attr, 0, -1, leader, 0));
+}
+
+#endif
+
+} // namespace
+
+//=============================================================================
+
+PerfCounters::Values PerfCounters::Values::operator-(const Values& rhs) const
+{
+    Values result;
+    for (auto field : fields)
+        if (this->*field >= 0 && rhs.*field >= 0)
+            result.*field = this->*field - rhs.*field;
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+
+PerfCounters::Values& PerfCounters::Values::operator+=(const Values& rhs)
+{
+    for (auto field : fields)
+        this->*field =
+            (this->*field >= 0 && rhs.*field >= 0) ? this->*field + rhs.*field
+                                                   : -1;
+    return *this;
+}
+
+//=============================================================================
+
+// the file descriptors of the events, the first opened one is the leader,
+// whose group is read at once
+struct PerfCounters::Group
+{
+    int fd[n_events];
+    int leader = -1;
+};
+
+//-----------------------------------------------------------------------------
+
+PerfCounters::PerfCounters() : group_(new Group)
+{
+    for (int i = 0; i < n_events; ++i)
+        group_->fd[i] = -1;
+
+#if defined(__linux__)
+    // events the CPU does not provide, e.g., in a virtual machine, are left
+    // out of the group
+    for (int i = 0; i < n_events; ++i)
+    {
+        group_->fd[i] = open_event(events[i], group_->leader);
+        if (group_->leader == -1)
+            group_->leader = group_->fd[i];
+    }
+
+    if (group_->leader != -1)
+    {
+        ioctl(group_->leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(group_->leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+PerfCounters::~PerfCounters()
+{
+#if defined(__linux__)
+    for (int i = 0; i < n_events; ++i)
+        if (group_->fd[i] != -1)
+            close(group_->fd[i]);
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+bool PerfCounters::is_available() const
+{
+    return group_->leader != -1;
+}
+
+//-----------------------------------------------------------------------------
+
+PerfCounters::Values PerfCounters::read() const
+{
+    Values values;
+
+#if defined(__linux__)
+    if (group_->leader == -1)
+        return values;
+
+    // the number of events, the times enabled and running, and the counts
+    // in the order the events were added to the group
+    uint64_t data[3 + n_events];
+    const ssize_t size = ::read(group_->leader, data, sizeof(data));
+    if (size < ssize_t(3 * sizeof(uint64_t)) ||
+        size < ssize_t((3 + data[0]) * sizeof(uint64_t)))
+        return values;
+
+    // extrapolate the counts while multiplexed with other groups
+    const double scale =
+        (data[2] > 0 && data[2] < data[1]) ? double(data[1]) / double(data[2])
+                                           : 1.0;
+    uint64_t k = 0;
+    for (int i = 0; i < n_events && k < data[0]; ++i)
+        if (group_->fd[i] != -1)
+            values.*fields[i] = int64_t(double(data[3 + k++]) * scale);
+#endif
+
+    return values;
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -0,0 +1,93 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <cstdint>
+#include <memory>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \addtogroup core core
+//!@{
+
+//! \brief Hardware performance counters of the calling thread.
+//! \details Counts CPU cycles, retired instructions, last-level cache
+//! misses, and branch mispredictions of the thread that constructs it, in
+//! user space only, from construction on. Uses the perf_event interface of
+//! Linux. On other systems, if the kernel does not permit it (see
+//! /proc/sys/kernel/perf_event_paranoid), or in virtual machines without a
+//! performance monitoring unit, is_available() is false. Events the CPU
+//! does not provide read as -1. If the kernel multiplexes the counters,
+//! the counts are extrapolated from the time they were running. Usage:
+//! \code
+//! PerfCounters counters;
+//! auto start = counters.read();
+//! SurfaceNormals::compute_vertex_normals(mesh);
+//! auto counts = counters.read() - start;
+//! \endcode
+class PerfCounters
+{
+public:
+    //! the counts of the events, -1 for events not counted
+    struct Values
+    {
+        int64_t cycles = -1;
+        int64_t instructions = -1;
+        int64_t llc_misses = -1;
+        int64_t branch_misses = -1;
+
+        //! \brief The counts of \p rhs subtracted.
+        //! \details Events not counted by either stay -1.
+        Values operator-(const Values& rhs) const;
+
+        //! add the counts of \p rhs, of events counted by both
+        Values& operator+=(const Values& rhs);
+
+        //! \brief Instructions per cycle.
+        //! \return 0 if either is not counted
+        double ipc() const
+        {
+            return (cycles > 0 && instructions >= 0)
+                       ? double(instructions) / double(cycles)
+                       : 0.0;
+        }
+    };
+
+    //! open the counters of the calling thread
+    PerfCounters();
+
+    //! close the counters
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    //! could any of the counters be opened?
+    bool is_available() const;
+
+    //! \brief The counts since construction.
+    //! \details Must be called on the thread that constructed the counters.
+    //! All counts are -1 if is_available() is false.
+    Values read() const;
+
+private:
+    struct Group;
+    std::unique_ptr<Group> group_;
+};
+
+//!@}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
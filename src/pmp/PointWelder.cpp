@@ -0,0 +1,213 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/PointWelder.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+namespace {
+
+// bit pattern of x, such that -0 and +0 agree
+int64_t bits(Scalar x)
+{
+    x += Scalar(0);
+    int64_t b = 0;
+    memcpy(&b, &x, sizeof(x));
+    return b;
+}
+
+// grid coordinate of x for cell size eps, clamped to avoid overflow
+int64_t grid(Scalar x, Scalar eps)
+{
+    const double max_coordinate = 4e18;
+    const double c = std::floor(double(x) / double(eps));
+    return int64_t(std::max(-max_coordinate, std::min(max_coordinate, c)));
+}
+
+} // namespace
+
+//=============================================================================
+
+PointWelder::PointWelder(Scalar eps) : eps_(std::max(Scalar(0), eps)) {}
+
+//-----------------------------------------------------------------------------
+
+PointWelder::Cell PointWelder::cell(const Point& p) const
+{
+    Cell c;
+    if (eps_ == 0)
+    {
+        c.x = bits(p[0]);
+        c.y = bits(p[1]);
+        c.z = bits(p[2]);
+    }
+    else
+    {
+        c.x = grid(p[0], eps_);
+        c.y = grid(p[1], eps_);
+        c.z = grid(p[2], eps_);
+    }
+    return c;
+}
+
+//-----------------------------------------------------------------------------
+
+uint64_t PointWelder::hash(const Cell& c)
+{
+    uint64_t h = uint64_t(c.x) * 0x9e3779b97f4a7c15ull ^
+                 uint64_t(c.y) * 0xc2b2ae3d27d4eb4full ^
+                 uint64_t(c.z) * 0x165667b19e3779f9ull;
+    h ^= h >> 31;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 32;
+    return h;
+}
+
+//-----------------------------------------------------------------------------
+
+size_t PointWelder::find(const Cell& c) const
+{
+    const size_t mask = table_.size() - 1;
+    size_t i = hash(c) & mask;
+    while (table_[i] != PMP_MAX_INDEX && !(cell(points_[table_[i]]) == c))
+        i = (i + 1) & mask;
+    return i;
+}
+
+//-----------------------------------------------------------------------------
+
+void PointWelder::rehash(size_t n)
+{
+    table_.assign(n, PMP_MAX_INDEX);
+    for (size_t i = 0; i < points_.size(); ++i)
+        table_[find(cell(points_[i]))] = IndexType(i);
+}
+
+//-----------------------------------------------------------------------------
+
+void PointWelder::reserve(size_t n)
+{
+    points_.reserve(n);
+
+    // keep the load factor below one half
+    size_t slots = 16;
+    while (slots < 2 * n)
+        slots *= 2;
+    if (slots > table_.size())
+        rehash(slots);
+}
+
+//-----------------------------------------------------------------------------
+
+void PointWelder::clear()
+{
+    points_.clear();
+    table_.clear();
+}
+
+//-----------------------------------------------------------------------------
+
+IndexType PointWelder::insert(const Point& p)
+{
+    if (2 * (points_.size() + 1) > table_.size())
+        rehash(std::max(size_t(16), 2 * table_.size()));
+
+    const Cell c = cell(p);
+    const size_t slot = find(c);
+
+    // a representative in the same cell is within the tolerance
+    if (table_[slot] != PMP_MAX_INDEX)
+        return table_[slot];
+
+    // otherwise check the neighboring cells
+    if (eps_ > 0)
+    {
+        for (int dx = -1; dx <= 1; ++dx)
+            for (int dy = -1; dy <= 1; ++dy)
+                for (int dz = -1; dz <= 1; ++dz)
+                {
+                    if (!dx && !dy && !dz)
+                        continue;
+                    const Cell n = {c.x + dx, c.y + dy, c.z + dz};
+                    const IndexType idx = table_[find(n)];
+                    if (idx == PMP_MAX_INDEX)
+                        continue;
+                    const Point d = points_[idx] - p;
+                    if (std::fabs(d[0]) <= eps_ && std::fabs(d[1]) <= eps_ &&
+                        std::fabs(d[2]) <= eps_)
+                        return idx;
+                }
+    }
+
+    const IndexType idx = IndexType(points_.size());
+    points_.push_back(p);
+    table_[slot] = idx;
+    return idx;
+}
+
+//=============================================================================
+
+size_t weld_vertices(SurfaceMesh& mesh, Scalar eps)
+{
+    PointWelder welder(eps);
+    welder.reserve(mesh.n_vertices());
+    std::vector<IndexType> ids(mesh.vertices_size());
+    for (auto v : mesh.vertices())
+        ids[v.idx()] = welder.insert(mesh.position(v));
+
+    const size_t removed = mesh.n_vertices() - welder.size();
+    if (!removed)
+        return 0;
+
+    // faces in terms of the welded vertices, without degenerate ones
+    std::vector<IndexType> indices;
+    std::vector<IndexType> face_sizes;
+    indices.reserve(mesh.halfedges_size());
+    face_sizes.reserve(mesh.n_faces());
+    for (auto f : mesh.faces())
+    {
+        // collapse welded edges
+        const size_t begin = indices.size();
+        for (auto v : mesh.vertices(f))
+        {
+            const IndexType idx = ids[v.idx()];
+            if (indices.size() == begin || indices.back() != idx)
+                indices.push_back(idx);
+        }
+        if (indices.size() - begin > 1 && indices.back() == indices[begin])
+            indices.pop_back();
+
+        // remove faces with less than three or repeated vertices
+        bool degenerate = indices.size() - begin < 3;
+        for (size_t i = begin; !degenerate && i < indices.size(); ++i)
+            degenerate = std::find(indices.begin() + i + 1, indices.end(),
+                                   indices[i]) != indices.end();
+
+        if (degenerate)
+            indices.resize(begin);
+        else
+            face_sizes.push_back(IndexType(indices.size() - begin));
+    }
+
+    mesh.build_from_indices(welder.points(), indices, face_sizes);
+
+    return removed;
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -0,0 +1,103 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <pmp/SurfaceMesh.h>
+
+#include <cstdint>
+#include <vector>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \addtogroup core core
+//!@{
+
+//! \brief Merge coincident points of a point stream, e.g., a triangle soup.
+//! \details Each inserted point is either identified with a previously
+//! inserted representative or becomes a new representative itself.
+//! Representatives are numbered in the order of insertion. The lookup uses a
+//! flat open-addressing hash table, so inserting n points takes O(n)
+//! expected time and one index per table slot of memory.
+//!
+//! With a tolerance \c eps of zero, only points with identical coordinates
+//! are merged. Otherwise, a point is merged with the first representative
+//! that differs by at most \c eps in each coordinate, which makes the result
+//! depend on the insertion order. Usage:
+//! \code
+//! PointWelder welder;
+//! for (auto p : soup)
+//!     indices.push_back(welder.insert(p));
+//! mesh.build_from_indices(welder.points(), indices);
+//! \endcode
+class PointWelder
+{
+public:
+    //! construct with tolerance \p eps
+    explicit PointWelder(Scalar eps = 0);
+
+    //! \brief Insert point \p p.
+    //! \return the index of the representative of \p p
+    IndexType insert(const Point& p);
+
+    //! reserve memory for \p n representatives
+    void reserve(size_t n);
+
+    //! remove all points
+    void clear();
+
+    //! the number of representatives
+    size_t size() const { return points_.size(); }
+
+    //! the representatives in the order of insertion
+    const std::vector<Point>& points() const { return points_; }
+
+private:
+    // integer coordinates of the grid cell containing a point
+    struct Cell
+    {
+        int64_t x, y, z;
+        bool operator==(const Cell& c) const
+        {
+            return x == c.x && y == c.y && z == c.z;
+        }
+    };
+
+    Cell cell(const Point& p) const;
+    static uint64_t hash(const Cell& c);
+
+    // find the slot of cell c, or the empty slot where it belongs
+    size_t find(const Cell& c) const;
+
+    // resize the table to n slots, n has to be a power of two
+    void rehash(size_t n);
+
+    Scalar eps_;
+    std::vector<Point> points_;
+    std::vector<IndexType> table_; // point index or PMP_MAX_INDEX
+};
+
+//! \brief Merge vertices whose positions differ by at most \p eps in each
+//! coordinate.
+//! \details Rebuilds the mesh from its welded vertex positions and faces,
+//! see PointWelder. Welded edges are collapsed, and faces left with less
+//! than three or with repeated vertices are removed. Vertex positions are
+//! kept, all other properties are discarded.
+//! \return the number of removed vertices
+size_t weld_vertices(SurfaceMesh& mesh, Scalar eps = 0);
+
+//!@}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -0,0 +1,388 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/Profiler.h>
+#include <pmp/MemoryUsage.h>
+#include <pmp/PerfCounters.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+namespace {
+
+typedef std::chrono::steady_clock steady_clock;
+
+// bound for the number of zones recorded per thread
+const size_t max_zones = 1 << 22;
+
+// a recorded zone
+struct Zone
+{
+    const char* name;
+    double start;    // us since the start of the profiler
+    double duration; // us, negative while open
+    int depth;       // number of enclosing zones
+};
+
+// the hardware counters of a recorded zone
+struct ZoneCounts
+{
+    bool counted = false;
+    PerfCounters::Values values; // at the start while open
+    size_t rss = 0;              // bytes at the end
+};
+
+// the zones recorded by a thread
+struct ThreadLog
+{
+    int id;
+    std::vector<Zone> zones;
+    std::vector<size_t> open; // indices of the open zones
+
+    // the counters of the thread, opened on first use, and the counts of
+    // the zones, up to the last zone recorded with counters
+    std::unique_ptr<PerfCounters> counters;
+    std::vector<ZoneCounts> counts;
+};
+
+// the state shared by all threads
+struct State
+{
+    State()
+        : start(steady_clock::now()), enabled(false), counters_enabled(false)
+    {
+    }
+
+    steady_clock::time_point start;
+    std::atomic<bool> enabled;
+    std::atomic<bool> counters_enabled;
+    std::mutex mutex; // protects logs
+    std::vector<std::unique_ptr<ThreadLog>> logs;
+};
+
+State& state()
+{
+    static State s;
+    return s;
+}
+
+// the log of the calling thread, registered on first use
+ThreadLog& thread_log()
+{
+    thread_local ThreadLog* log = nullptr;
+    if (!log)
+    {
+        State& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.logs.emplace_back(new ThreadLog);
+        log = s.logs.back().get();
+        log->id = int(s.logs.size()) - 1;
+    }
+    return *log;
+}
+
+double now()
+{
+    return std::chrono::duration<double, std::micro>(steady_clock::now() -
+                                                     state().start)
+        .count();
+}
+
+std::string json_string(const char* s)
+{
+    std::string result = "\"";
+    for (; *s; ++s)
+    {
+        if (*s == '"' || *s == '\\')
+            result += '\\';
+        if (*s >= ' ')
+            result += *s;
+    }
+    return result + "\"";
+}
+
+// a count in a short form, e.g., 1.5M
+std::string short_count(int64_t count)
+{
+    const char* suffixes[] = {"", "k", "M", "G", "T"};
+    double c = double(count);
+    int i = 0;
+    while (c >= 1000.0 && i < 4)
+    {
+        c /= 1000.0;
+        ++i;
+    }
+    std::ostringstream os;
+    os << std::setprecision(3) << c << suffixes[i];
+    return os.str();
+}
+
+#ifdef PMP_ENABLE_PROFILING
+// record from program start to exit if PMP_TRACE names a trace file
+struct TraceFromEnvironment
+{
+    TraceFromEnvironment()
+    {
+        state();
+        if (const char* filename = getenv("PMP_TRACE"))
+        {
+            filename_ = filename;
+            Profiler::set_enabled(true);
+        }
+        if (const char* counters = getenv("PMP_PERF_COUNTERS"))
+            Profiler::set_counters_enabled(std::string(counters) == "1");
+    }
+
+    ~TraceFromEnvironment()
+    {
+        if (!filename_.empty() && !Profiler::write_trace(filename_))
+            std::cerr << "Profiler: cannot write " << filename_ << std::endl;
+    }
+
+    std::string filename_;
+} trace_from_environment;
+#endif
+
+} // namespace
+
+//=============================================================================
+
+void Profiler::set_enabled(bool b)
+{
+    state().enabled = b;
+}
+
+//-----------------------------------------------------------------------------
+
+bool Profiler::is_enabled()
+{
+    return state().enabled.load(std::memory_order_relaxed);
+}
+
+//-----------------------------------------------------------------------------
+
+void Profiler::set_counters_enabled(bool b)
+{
+    state().counters_enabled = b;
+}
+
+//-----------------------------------------------------------------------------
+
+bool Profiler::are_counters_enabled()
+{
+    return state().counters_enabled.load(std::memory_order_relaxed);
+}
+
+//-----------------------------------------------------------------------------
+
+void Profiler::begin(const char* name)
+{
+    ThreadLog& log = thread_log();
+    if (log.zones.size() < max_zones)
+    {
+        log.open.push_back(log.zones.size());
+        log.zones.push_back({name, now(), -1.0, int(log.open.size()) - 1});
+
+        if (are_counters_enabled())
+        {
+            if (!log.counters)
+                log.counters.reset(new PerfCounters);
+            if (log.counters->is_available())
+            {
+                // read last, to leave out the recording
+                log.counts.resize(log.zones.size());
+                log.counts.back().counted = true;
+                log.counts.back().values = log.counters->read();
+            }
+        }
+    }
+    else
+    {
+        // keep the nesting balanced without recording
+        log.open.push_back(max_zones);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void Profiler::end()
+{
+    ThreadLog& log = thread_log();
+    if (log.open.empty())
+        return;
+    const size_t i = log.open.back();
+    log.open.pop_back();
+    if (i < log.zones.size())
+    {
+        if (i < log.counts.size() && log.counts[i].counted)
+        {
+            ZoneCounts& counts = log.counts[i];
+            counts.values = log.counters->read() - counts.values;
+            counts.rss = MemoryUsage::current_size();
+        }
+        log.zones[i].duration = now() - log.zones[i].start;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void Profiler::clear()
+{
+    State& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    for (auto& log : s.logs)
+    {
+        log->zones.clear();
+        log->open.clear();
+        log->counts.clear();
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+bool Profiler::write_trace(const std::string& filename)
+{
+    std::ofstream ofs(filename);
+    if (!ofs)
+        return false;
+
+    State& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+
+    ofs << "{\"traceEvents\":[";
+    bool first = true;
+    for (const auto& log : s.logs)
+    {
+        for (size_t i = 0; i < log->zones.size(); ++i)
+        {
+            // skip zones that are still open
+            const Zone& zone = log->zones[i];
+            if (zone.duration < 0.0)
+                continue;
+            ofs << (first ? "\n" : ",\n") << "{\"name\":"
+                << json_string(zone.name)
+                << ",\"ph\":\"X\",\"pid\":0,\"tid\":" << log->id
+                << ",\"ts\":" << zone.start << ",\"dur\":" << zone.duration;
+            if (i < log->counts.size() && log->counts[i].counted)
+            {
+                const ZoneCounts& counts = log->counts[i];
+                ofs << ",\"args\":{\"cycles\":" << counts.values.cycles
+                    << ",\"instructions\":" << counts.values.instructions
+                    << ",\"llc_misses\":" << counts.values.llc_misses
+                    << ",\"branch_misses\":" << counts.values.branch_misses
+                    << ",\"rss\":" << counts.rss << "}";
+            }
+            ofs << "}";
+            first = false;
+        }
+    }
+    ofs << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    return bool(ofs);
+}
+
+//-----------------------------------------------------------------------------
+
+void Profiler::print_summary(std::ostream& os)
+{
+    struct Total
+    {
+        size_t calls = 0;
+        double us = 0.0;
+        int depth = 0;
+        const char* name = nullptr;
+
+        // the sums of the zones with counters
+        size_t counted = 0;
+        PerfCounters::Values values;
+        size_t rss = 0;
+    };
+
+    // accumulate the zones of all threads by their path of enclosing zones
+    std::map<std::string, Total> totals;
+    {
+        State& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        for (const auto& log : s.logs)
+        {
+            std::vector<std::string> paths;
+            for (size_t i = 0; i < log->zones.size(); ++i)
+            {
+                const Zone& zone = log->zones[i];
+                paths.resize(zone.depth);
+                // separate by a character sorting before all names
+                const std::string path =
+                    (zone.depth ? paths.back() + '\1' : "") + zone.name;
+                paths.push_back(path);
+                if (zone.duration < 0.0)
+                    continue;
+
+                Total& total = totals[path];
+                total.depth = zone.depth;
+                total.name = zone.name;
+                ++total.calls;
+                total.us += zone.duration;
+
+                if (i < log->counts.size() && log->counts[i].counted)
+                {
+                    const ZoneCounts& counts = log->counts[i];
+                    if (total.counted++)
+                        total.values += counts.values;
+                    else
+                        total.values = counts.values;
+                    total.rss = std::max(total.rss, counts.rss);
+                }
+            }
+        }
+    }
+
+    // the map is sorted by path, i.e., each zone follows its parent
+    for (const auto& t : totals)
+    {
+        const Total& total = t.second;
+        os << std::string(2 * total.depth, ' ') << total.name << ": "
+           << 1e-3 * total.us << " ms, " << total.calls
+           << (total.calls == 1 ? " call" : " calls");
+        if (total.counted)
+        {
+            const PerfCounters::Values& v = total.values;
+            if (v.cycles > 0 && v.instructions >= 0)
+                os << ", " << std::setprecision(3) << v.ipc()
+                   << std::setprecision(6) << " IPC";
+            if (v.instructions >= 0)
+                os << ", " << short_count(v.instructions) << " instructions";
+            if (v.llc_misses >= 0)
+                os << ", " << short_count(v.llc_misses) << " LLC misses";
+            if (v.branch_misses >= 0)
+                os << ", " << short_count(v.branch_misses)
+                   << " branch misses";
+            os << ", " << short_count(int64_t(total.rss)) << "B RSS";
+        }
+        os << "\n";
+    }
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -0,0 +1,134 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <iostream>
+#include <string>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \addtogroup core core
+//!@{
+
+//! \brief Hierarchical profiling of scoped zones.
+//! \details Zones are marked by PMP_PROFILE_ZONE() and nest like the scopes
+//! they are placed in. Each thread records its zones into a buffer of its
+//! own, so recording takes no locks. The recorded zones can be written as a
+//! trace in the Chrome trace event format, e.g., for chrome://tracing or
+//! Perfetto, or summarized per zone.
+//!
+//! With set_counters_enabled(true), each zone also records the hardware
+//! events of PerfCounters on its thread and the resident set size of
+//! MemoryUsage at its end. They are printed by print_summary() and stored
+//! as arguments of the zones in the trace. Reading the counters costs a
+//! system call per zone boundary, so fine-grained zones should be profiled
+//! without them.
+//!
+//! The zones of the library are compiled in only if pmp is built with the
+//! CMake option PMP_ENABLE_PROFILING, which defines the macro of the same
+//! name. Recording starts with set_enabled(true), or at program start if the
+//! environment variable PMP_TRACE names a trace file, which is then written
+//! at program exit. The environment variable PMP_PERF_COUNTERS=1 enables
+//! the counters at program start. Usage:
+//! \code
+//! Profiler::set_enabled(true);
+//! SurfaceRemeshing(mesh).adaptive_remeshing(min, max, error);
+//! Profiler::write_trace("trace.json");
+//! Profiler::print_summary(std::cout);
+//! \endcode
+class Profiler
+{
+public:
+    //! enable or disable recording, disabling keeps the recorded zones
+    static void set_enabled(bool b);
+
+    //! is recording enabled?
+    static bool is_enabled();
+
+    //! \brief Enable or disable the hardware counters of the zones.
+    //! \details Applies to zones opened afterwards. Zones are recorded
+    //! without counters if PerfCounters::is_available() is false.
+    static void set_counters_enabled(bool b);
+
+    //! are the hardware counters of the zones enabled?
+    static bool are_counters_enabled();
+
+    //! \brief Remove all recorded zones.
+    //! \details Must not be called while zones are open.
+    static void clear();
+
+    //! \brief Write the recorded zones to \p filename.
+    //! \details The file is in the JSON trace event format, one track per
+    //! thread. Should be called while no zones are recorded.
+    static bool write_trace(const std::string& filename);
+
+    //! \brief Print the number of calls and total time of each zone.
+    //! \details Zones are identified by their path of enclosing zones and
+    //! printed as a tree. Zones recorded with counters add their total
+    //! instructions per cycle, instructions, last-level cache misses, branch
+    //! mispredictions, and the largest resident set size at their end.
+    static void print_summary(std::ostream& os = std::cout);
+
+    //! open zone \p name on the calling thread, see ProfileZone
+    static void begin(const char* name);
+
+    //! close the zone last opened on the calling thread
+    static void end();
+};
+
+//! \brief A profiling zone that is open from construction to destruction.
+//! \details Use PMP_PROFILE_ZONE() to create one. \p name has to be a string
+//! literal, it is stored by pointer.
+class ProfileZone
+{
+public:
+    explicit ProfileZone(const char* name)
+        : open_(Profiler::is_enabled())
+    {
+        if (open_)
+            Profiler::begin(name);
+    }
+
+    ~ProfileZone()
+    {
+        if (open_)
+            Profiler::end();
+    }
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    bool open_;
+};
+
+//!@}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
+
+#define PMP_PROFILE_CONCAT_(a, b) a##b
+#define PMP_PROFILE_CONCAT(a, b) PMP_PROFILE_CONCAT_(a, b)
+
+//! \brief Profile the rest of the enclosing scope as zone \p name.
+//! \details Expands to nothing unless PMP_ENABLE_PROFILING is defined.
+#ifdef PMP_ENABLE_PROFILING
+#define PMP_PROFILE_ZONE(name)                                                 \
+    ::pmp::ProfileZone PMP_PROFILE_CONCAT(pmp_profile_zone_, __LINE__)(name)
+#else
+#define PMP_PROFILE_ZONE(name)
+#endif
+
+//=============================================================================
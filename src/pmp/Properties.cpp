@@ -0,0 +1,89 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/Properties.h>
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+namespace {
+
+typedef std::unordered_map<std::string, size_t> NameIndices;
+
+// the interned names. interning copies the current table, so readers can
+// use it without locking. the old tables are kept for readers still using
+// them, which costs little since only property keys intern names.
+struct NameTable
+{
+    std::mutex mutex;
+    std::vector<std::unique_ptr<const NameIndices>> tables;
+    std::atomic<const NameIndices*> current{nullptr};
+};
+
+NameTable& name_table()
+{
+    static NameTable table;
+    return table;
+}
+
+size_t find_index(const NameIndices* indices, const std::string& name)
+{
+    if (indices)
+    {
+        auto it = indices->find(name);
+        if (it != indices->end())
+            return it->second;
+    }
+    return size_t(-1);
+}
+
+} // namespace
+
+//=============================================================================
+
+size_t property_name_index(const std::string& name)
+{
+    const size_t found = find_property_name_index(name);
+    if (found != size_t(-1))
+        return found;
+
+    NameTable& table = name_table();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    const NameIndices* current = table.current.load();
+    size_t index = find_index(current, name);
+    if (index != size_t(-1))
+        return index;
+
+    std::unique_ptr<NameIndices> indices(
+        current ? new NameIndices(*current) : new NameIndices);
+    index = indices->size();
+    (*indices)[name] = index;
+    table.current.store(indices.get(), std::memory_order_release);
+    table.tables.push_back(std::move(indices));
+    return index;
+}
+
+//-----------------------------------------------------------------------------
+
+size_t find_property_name_index(const std::string& name)
+{
+    return find_index(name_table().current.load(std::memory_order_acquire),
+                      name);
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -10,24 +10,43 @@
 #pragma once
 //=============================================================================
 
+#include <pmp/Types.h>
+
 #include <algorithm>
 #include <string>
 #include <typeinfo>
 #include <vector>
 #include <cassert>
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <type_traits>
+#include <utility>
 
 //== NAMESPACE ================================================================
 
 namespace pmp {
 
+//! Interns the property name \c name and returns its process-wide unique
+//! index. Calls with equal names return the same index. Thread-safe.
+//! Interned names are kept until the process ends, hence only PropertyKey
+//! interns names, which are meant to be long-lived constants.
+size_t property_name_index(const std::string& name);
+
+//! Returns the index of \c name if it has been interned by
+//! property_name_index(), otherwise size_t(-1). Thread-safe and lock-free.
+size_t find_property_name_index(const std::string& name);
+
 //== CLASS DEFINITION =========================================================
 
 class BasePropertyArray
 {
 public:
     //! Default constructor
-    BasePropertyArray(const std::string& name) : name_(name) {}
+    BasePropertyArray(const std::string& name)
+        : name_(name), name_index_(find_property_name_index(name))
+    {
+    }
 
     //! Destructor.
     virtual ~BasePropertyArray() {}
@@ -47,17 +66,50 @@ public:
     //! Let two elements swap their storage place.
     virtual void swap(size_t i0, size_t i1) = 0;
 
+    //! Set element \c i to the default value.
+    virtual void reset_element(size_t i) = 0;
+
+    //! Remove all elements \c i with \c keep[i]==false, keeping the order of
+    //! the remaining ones.
+    virtual void compact(const std::vector<bool>& keep) = 0;
+
+    //! Replace the elements by the ones at \c indices: element
+    //! \c i*stride+k becomes the former element \c indices[i]*stride+k.
+    virtual void gather(const std::vector<IndexType>& indices,
+                        size_t stride) = 0;
+
     //! Return a deep copy of self.
     virtual BasePropertyArray* clone() const = 0;
 
+    //! Return a copy of self holding only the elements at \c indices.
+    virtual BasePropertyArray* clone(
+        const std::vector<IndexType>& indices) const = 0;
+
     //! Return the type_info of the property
     virtual const std::type_info& type() = 0;
 
+    //! Return the number of bytes used by the elements.
+    virtual size_t memory_size() const = 0;
+
+    //! Return the number of bytes allocated for the elements.
+    virtual size_t memory_capacity() const = 0;
+
     //! Return the name of the property
     const std::string& name() const { return name_; }
 
+    //! Return the index of the name, see find_property_name_index()
+    size_t name_index() const { return name_index_; }
+
 protected:
+    //! Rename the property
+    void rename(const std::string& name)
+    {
+        name_ = name;
+        name_index_ = find_property_name_index(name);
+    }
+
     std::string name_;
+    size_t name_index_;
 };
 
 //== CLASS DEFINITION =========================================================
@@ -76,6 +128,15 @@ public:
     {
     }
 
+private:
+    // takes name and name index of rhs, but none of its elements
+    PropertyArray(const PropertyArray<T>& rhs, const T& t)
+        : BasePropertyArray(rhs), value_(t)
+    {
+    }
+
+public:
+
 public: // virtual interface of BasePropertyArray
     virtual void reserve(size_t n) { data_.reserve(n); }
 
@@ -92,22 +153,76 @@ public: // virtual interface of BasePropertyArray
         data_[i1] = d;
     }
 
+    virtual void reset_element(size_t i) { data_[i] = value_; }
+
+    virtual void compact(const std::vector<bool>& keep)
+    {
+        assert(keep.size() == data_.size());
+        size_t j = 0;
+        for (size_t i = 0; i < data_.size(); ++i)
+        {
+            if (keep[i])
+            {
+                if (i != j)
+                    data_[j] = std::move(data_[i]);
+                ++j;
+            }
+        }
+        data_.resize(j, value_);
+    }
+
+    virtual void gather(const std::vector<IndexType>& indices, size_t stride)
+    {
+        VectorType result;
+        result.reserve(std::max(data_.capacity(), indices.size() * stride));
+        append(indices, stride, result, IsTriviallyCopyable());
+        data_.swap(result);
+    }
+
     virtual BasePropertyArray* clone() const
     {
-        PropertyArray<T>* p = new PropertyArray<T>(name_, value_);
+        PropertyArray<T>* p = new PropertyArray<T>(*this, value_);
         p->data_ = data_;
         return p;
     }
 
+    virtual BasePropertyArray* clone(
+        const std::vector<IndexType>& indices) const
+    {
+        PropertyArray<T>* p = new PropertyArray<T>(*this, value_);
+        p->data_.reserve(indices.size());
+        append(indices, 1, p->data_, IsTriviallyCopyable());
+        return p;
+    }
+
     virtual const std::type_info& type() { return typeid(T); }
 
+    virtual size_t memory_size() const { return data_.size() * sizeof(T); }
+
+    virtual size_t memory_capacity() const
+    {
+        return data_.capacity() * sizeof(T);
+    }
+
 public:
+    //! Re-initialize a recycled array: rename it and fill \c n elements with
+    //! the new default value \c t, re-using the allocated storage.
+    void reset(const std::string& name, const T& t, size_t n)
+    {
+        rename(name);
+        value_ = t;
+        data_.assign(n, t);
+    }
+
     //! Get pointer to array (does not work for T==bool)
     const T* data() const { return &data_[0]; }
 
     //! Get reference to the underlying vector
     std::vector<T>& vector() { return data_; }
 
+    //! Get const reference to the underlying vector
+    const std::vector<T>& vector() const { return data_; }
+
     //! Access the i'th element. No range check is performed!
     reference operator[](size_t idx)
     {
@@ -123,6 +238,32 @@ public:
     }
 
 private:
+    // elements that can be copied as raw memory. bool is stored as bits.
+    typedef std::integral_constant<bool,
+                                   std::is_trivially_copyable<T>::value &&
+                                       !std::is_same<T, bool>::value>
+        IsTriviallyCopyable;
+
+    // append the blocks of stride elements at indices to result
+    void append(const std::vector<IndexType>& indices, size_t stride,
+                VectorType& result, std::true_type) const
+    {
+        const size_t n = result.size();
+        result.resize(n + indices.size() * stride);
+        T* dst = result.data() + n;
+        for (size_t i = 0; i < indices.size(); ++i, dst += stride)
+            std::memcpy(dst, data_.data() + indices[i] * stride,
+                        stride * sizeof(T));
+    }
+
+    void append(const std::vector<IndexType>& indices, size_t stride,
+                VectorType& result, std::false_type) const
+    {
+        for (size_t i = 0; i < indices.size(); ++i)
+            for (size_t k = 0; k < stride; ++k)
+                result.push_back(data_[indices[i] * stride + k]);
+    }
+
     VectorType data_;
     ValueType value_;
 };
@@ -135,6 +276,31 @@ inline const bool* PropertyArray<bool>::data() const
     return nullptr;
 }
 
+// bool properties are stored as bits
+template <>
+inline size_t PropertyArray<bool>::memory_size() const
+{
+    return (data_.size() + 7) / 8;
+}
+
+template <>
+inline size_t PropertyArray<bool>::memory_capacity() const
+{
+    return (data_.capacity() + 7) / 8;
+}
+
+//! \brief The memory of a property array in bytes.
+//! \details Only the array itself is counted, not memory owned by its
+//! elements, e.g., by properties of type std::vector.
+struct PropertyMemory
+{
+    std::string name;
+    size_t size;     //!< bytes used by the elements
+    size_t capacity; //!< bytes allocated, including reserved elements
+    bool shared;     //!< shared with another container, see share()
+    bool recycled;   //!< removed but kept for re-use, see begin_recycling()
+};
+
 //== CLASS DEFINITION =========================================================
 
 template <class T>
@@ -178,6 +344,12 @@ public:
         return parray_->vector();
     }
 
+    const std::vector<T>& vector() const
+    {
+        assert(parray_ != nullptr);
+        return parray_->vector();
+    }
+
 private:
     PropertyArray<T>& array()
     {
@@ -197,17 +369,60 @@ private:
 
 //== CLASS DEFINITION =========================================================
 
+//! \brief A property name resolved once for fast repeated lookups.
+//! \details Constructing a key interns its name, see property_name_index().
+//! Retrieving a property through a key is a constant-time table lookup
+//! instead of a comparison with the names of all properties. Keys do not
+//! refer to a specific container and can be shared between meshes and
+//! threads, typically as static constants. Properties added before the key
+//! of their name existed are found by their name instead.
+template <class T>
+class PropertyKey
+{
+public:
+    explicit PropertyKey(const std::string& name)
+        : name_(name), index_(property_name_index(name))
+    {
+    }
+
+    //! the name of the property
+    const std::string& name() const { return name_; }
+
+    //! the index of the name, see property_name_index()
+    size_t index() const { return index_; }
+
+private:
+    std::string name_;
+    size_t index_;
+};
+
+//== CLASS DEFINITION =========================================================
+
 class PropertyContainer
 {
 public:
     // default constructor
-    PropertyContainer() : size_(0) {}
+    PropertyContainer()
+        : size_(0), capacity_(0), growth_factor_(2), recycling_(0)
+    {
+    }
 
     // destructor (deletes all property arrays)
     virtual ~PropertyContainer() { clear(); }
 
     // copy constructor: performs deep copy of property arrays
-    PropertyContainer(const PropertyContainer& rhs) { operator=(rhs); }
+    PropertyContainer(const PropertyContainer& rhs)
+        : capacity_(0), growth_factor_(2), recycling_(0)
+    {
+        operator=(rhs);
+    }
+
+    // move constructor: takes over the property arrays of rhs
+    PropertyContainer(PropertyContainer&& rhs)
+        : size_(0), capacity_(0), growth_factor_(2), recycling_(0)
+    {
+        operator=(std::move(rhs));
+    }
 
     // assignment: performs deep copy of property arrays
     PropertyContainer& operator=(const PropertyContainer& rhs)
@@ -216,13 +431,83 @@ public:
         {
             clear();
             parrays_.resize(rhs.n_properties());
-            size_ = rhs.size();
+            size_ = capacity_ = rhs.size();
+            growth_factor_ = rhs.growth_factor_;
             for (size_t i = 0; i < parrays_.size(); ++i)
-                parrays_[i] = rhs.parrays_[i]->clone();
+                parrays_[i] = ArrayPointer(rhs.parrays_[i]->clone());
+            slots_ = rhs.slots_;
+        }
+        return *this;
+    }
+
+    // move assignment: takes over the property arrays of rhs, which is
+    // left empty
+    PropertyContainer& operator=(PropertyContainer&& rhs)
+    {
+        if (this != &rhs)
+        {
+            clear();
+            parrays_.swap(rhs.parrays_);
+            slots_.swap(rhs.slots_);
+            recycled_.swap(rhs.recycled_);
+            size_ = rhs.size_;
+            capacity_ = rhs.capacity_;
+            growth_factor_ = rhs.growth_factor_;
+            rhs.size_ = rhs.capacity_ = 0;
         }
         return *this;
     }
 
+    // copy the property arrays of rhs, but share (instead of copy) the
+    // arrays named in shared_names. use unshare() before modifying them.
+    void share(const PropertyContainer& rhs,
+               const std::vector<std::string>& shared_names)
+    {
+        if (this == &rhs)
+            return;
+
+        clear();
+        parrays_.resize(rhs.n_properties());
+        size_ = capacity_ = rhs.size();
+        growth_factor_ = rhs.growth_factor_;
+        for (size_t i = 0; i < parrays_.size(); ++i)
+        {
+            const std::string& name = rhs.parrays_[i]->name();
+            if (std::find(shared_names.begin(), shared_names.end(), name) !=
+                shared_names.end())
+                parrays_[i] = rhs.parrays_[i];
+            else
+                parrays_[i] = ArrayPointer(rhs.parrays_[i]->clone());
+        }
+        slots_ = rhs.slots_;
+    }
+
+    // replace arrays that are shared with another container by private
+    // copies. returns whether any array was copied.
+    bool unshare()
+    {
+        bool copied = false;
+        for (size_t i = 0; i < parrays_.size(); ++i)
+        {
+            if (parrays_[i].use_count() > 1)
+            {
+                parrays_[i] = ArrayPointer(parrays_[i]->clone());
+                parrays_[i]->reserve(capacity_);
+                copied = true;
+            }
+        }
+        return copied;
+    }
+
+    // is the array named name shared with another container?
+    bool is_shared(const std::string& name) const
+    {
+        for (size_t i = 0; i < parrays_.size(); ++i)
+            if (parrays_[i]->name() == name)
+                return parrays_[i].use_count() > 1;
+        return false;
+    }
+
     // returns the current size of the property arrays
     size_t size() const { return size_; }
 
@@ -254,10 +539,28 @@ public:
             }
         }
 
+        // re-use a recycled array of the same type
+        for (size_t i = 0; i < recycled_.size(); ++i)
+        {
+            if (recycled_[i]->type() == typeid(T))
+            {
+                ArrayPointer a = recycled_[i];
+                recycled_.erase(recycled_.begin() + i);
+                PropertyArray<T>* p = static_cast<PropertyArray<T>*>(a.get());
+                p->reset(name, t, size_);
+                p->reserve(capacity_);
+                parrays_.push_back(a);
+                update_slots();
+                return Property<T>(p);
+            }
+        }
+
         // otherwise add the property
         PropertyArray<T>* p = new PropertyArray<T>(name, t);
+        p->reserve(capacity_);
         p->resize(size_);
-        parrays_.push_back(p);
+        parrays_.push_back(ArrayPointer(p));
+        update_slots();
         return Property<T>(p);
     }
 
@@ -276,11 +579,22 @@ public:
     {
         for (size_t i = 0; i < parrays_.size(); ++i)
             if (parrays_[i]->name() == name)
-                return Property<T>(
-                    dynamic_cast<PropertyArray<T>*>(parrays_[i]));
+                return cast<T>(parrays_[i].get());
         return Property<T>();
     }
 
+    // get a property by its key. returns invalid property if it does not
+    // exist. takes constant time if the property exists and was added after
+    // the key was constructed.
+    template <class T>
+    Property<T> get(const PropertyKey<T>& key) const
+    {
+        const size_t k = key.index();
+        if (k < slots_.size() && slots_[k])
+            return cast<T>(parrays_[slots_[k] - 1].get());
+        return get<T>(key.name());
+    }
+
     // returns a property if it exists, otherwise it creates it first.
     template <class T>
     Property<T> get_or_add(const std::string& name, const T t = T())
@@ -291,6 +605,16 @@ public:
         return p;
     }
 
+    // returns a property if it exists, otherwise it creates it first.
+    template <class T>
+    Property<T> get_or_add(const PropertyKey<T>& key, const T t = T())
+    {
+        Property<T> p = get(key);
+        if (!p)
+            p = add<T>(key.name(), t);
+        return p;
+    }
+
     // get the type of property by its name. returns typeid(void) if it does not exist.
     const std::type_info& get_type(const std::string& name)
     {
@@ -304,14 +628,16 @@ public:
     template <class T>
     void remove(Property<T>& h)
     {
-        std::vector<BasePropertyArray*>::iterator it = parrays_.begin(),
-                                                  end = parrays_.end();
+        std::vector<ArrayPointer>::iterator it = parrays_.begin(),
+                                            end = parrays_.end();
         for (; it != end; ++it)
         {
-            if (*it == h.parray_)
+            if (it->get() == h.parray_)
             {
-                delete *it;
+                if (recycling_ && it->use_count() == 1)
+                    recycled_.push_back(*it);
                 parrays_.erase(it);
+                update_slots();
                 h.reset();
                 break;
             }
@@ -321,37 +647,108 @@ public:
     // delete all properties
     void clear()
     {
-        for (size_t i = 0; i < parrays_.size(); ++i)
-            delete parrays_[i];
         parrays_.clear();
+        slots_.clear();
+        size_ = capacity_ = 0;
+        free_recycled();
+    }
+
+    // remove all elements and the properties not named in keep, keeping the
+    // allocated memory of the remaining arrays. the removed arrays are
+    // recycled, see begin_recycling().
+    void clear_elements(const std::vector<std::string>& keep)
+    {
+        std::vector<ArrayPointer> kept;
+        for (size_t i = 0; i < parrays_.size(); ++i)
+        {
+            const ArrayPointer& a = parrays_[i];
+            if (std::find(keep.begin(), keep.end(), a->name()) != keep.end())
+                kept.push_back(a);
+            else if (recycling_ && a.use_count() == 1)
+                recycled_.push_back(a);
+        }
+        parrays_.swap(kept);
+        update_slots();
+        for (size_t i = 0; i < parrays_.size(); ++i)
+            parrays_[i]->resize(0);
         size_ = 0;
     }
 
-    // reserve memory for n entries in all arrays
-    void reserve(size_t n) const
+    // keep removed property arrays for re-use by add() until the matching
+    // end_recycling(). calls can be nested.
+    void begin_recycling() { ++recycling_; }
+
+    // end recycling, frees the recycled arrays when the outermost
+    // recycling scope ends
+    void end_recycling()
+    {
+        assert(recycling_ > 0);
+        if (--recycling_ == 0)
+            free_recycled();
+    }
+
+    // returns the memory of all property arrays, including recycled ones
+    std::vector<PropertyMemory> memory() const
+    {
+        std::vector<PropertyMemory> result;
+        for (const auto& a : parrays_)
+            result.push_back({a->name(), a->memory_size(),
+                              a->memory_capacity(), a.use_count() > 1,
+                              false});
+        for (const auto& a : recycled_)
+            result.push_back({a->name(), a->memory_size(),
+                              a->memory_capacity(), false, true});
+        return result;
+    }
+
+    // reserve memory for at least n entries in all arrays. the capacity
+    // grows at least by the growth factor, such that repeated calls with
+    // increasing n take amortized constant time per entry.
+    void reserve(size_t n)
     {
+        if (n <= capacity_)
+            return;
+        const size_t grown = size_t(capacity_ * growth_factor_);
+        capacity_ = std::max(n, grown);
         for (size_t i = 0; i < parrays_.size(); ++i)
-            parrays_[i]->reserve(n);
+            parrays_[i]->reserve(capacity_);
+    }
+
+    // returns the number of entries memory is reserved for
+    size_t capacity() const { return capacity_; }
+
+    // set the factor by which the capacity grows when it is exceeded
+    void set_growth_factor(float factor)
+    {
+        assert(factor > 1.0f);
+        growth_factor_ = factor;
     }
 
+    // returns the factor by which the capacity grows
+    float growth_factor() const { return growth_factor_; }
+
     // resize all arrays to size n
     void resize(size_t n)
     {
+        reserve(n);
         for (size_t i = 0; i < parrays_.size(); ++i)
             parrays_[i]->resize(n);
         size_ = n;
     }
 
     // free unused space in all arrays
-    void free_memory() const
+    void free_memory()
     {
         for (size_t i = 0; i < parrays_.size(); ++i)
             parrays_[i]->free_memory();
+        capacity_ = size_;
     }
 
     // add a new element to each vector
     void push_back()
     {
+        if (size_ == capacity_)
+            reserve(size_ + 1);
         for (size_t i = 0; i < parrays_.size(); ++i)
             parrays_[i]->push_back();
         ++size_;
@@ -364,9 +761,100 @@ public:
             parrays_[i]->swap(i0, i1);
     }
 
+    // set element i to the default value in all arrays
+    void reset_element(size_t i) const
+    {
+        for (size_t j = 0; j < parrays_.size(); ++j)
+            parrays_[j]->reset_element(i);
+    }
+
+    // remove elements i with keep[i]==false in all arrays, n is the number
+    // of remaining elements
+    void compact(const std::vector<bool>& keep, size_t n)
+    {
+        for (size_t i = 0; i < parrays_.size(); ++i)
+            parrays_[i]->compact(keep);
+        size_ = n;
+    }
+
+    // replace the elements of all arrays by the blocks of stride elements
+    // at indices, see BasePropertyArray::gather()
+    void gather(const std::vector<IndexType>& indices, size_t stride = 1)
+    {
+        for (size_t i = 0; i < parrays_.size(); ++i)
+            parrays_[i]->gather(indices, stride);
+        size_ = indices.size() * stride;
+        capacity_ = std::max(capacity_, size_);
+    }
+
+    // add the arrays of src that this container does not have and that are
+    // not named in skip, holding copies of the elements of src at indices.
+    // the number of indices has to match size().
+    void copy_missing(const PropertyContainer& src,
+                      const std::vector<IndexType>& indices,
+                      const std::vector<std::string>& skip)
+    {
+        assert(indices.size() == size_);
+        for (size_t i = 0; i < src.parrays_.size(); ++i)
+        {
+            const std::string& name = src.parrays_[i]->name();
+            if (exists(name) ||
+                std::find(skip.begin(), skip.end(), name) != skip.end())
+                continue;
+            ArrayPointer a(src.parrays_[i]->clone(indices));
+            a->reserve(capacity_);
+            parrays_.push_back(a);
+        }
+        update_slots();
+    }
+
 private:
-    std::vector<BasePropertyArray*> parrays_;
+    // arrays are reference counted, since they can be shared between
+    // containers, see share()
+    typedef std::shared_ptr<BasePropertyArray> ArrayPointer;
+
+    // delete all recycled arrays
+    void free_recycled() { recycled_.clear(); }
+
+    // returns the array as a property of type T, or an invalid property if
+    // the types do not match
+    template <class T>
+    static Property<T> cast(BasePropertyArray* a)
+    {
+        if (a->type() == typeid(T))
+            return Property<T>(static_cast<PropertyArray<T>*>(a));
+        return Property<T>();
+    }
+
+    // rebuild the table from name indices to arrays
+    void update_slots()
+    {
+        slots_.clear();
+        for (size_t i = 0; i < parrays_.size(); ++i)
+        {
+            const size_t k = parrays_[i]->name_index();
+            if (k == size_t(-1))
+                continue;
+            if (k >= slots_.size())
+                slots_.resize(k + 1, 0);
+            slots_[k] = i + 1;
+        }
+    }
+
+    std::vector<ArrayPointer> parrays_;
     size_t size_;
+
+    // the number of entries reserved in all arrays, see reserve()
+    size_t capacity_;
+    float growth_factor_;
+
+    // position+1 of the array for each interned name index, 0 if there is
+    // none. see property_name_index()
+    std::vector<size_t> slots_;
+
+    // removed arrays kept for re-use, see begin_recycling()
+    std::vector<ArrayPointer> recycled_;
+    unsigned int recycling_;
 };
 
 //=============================================================================
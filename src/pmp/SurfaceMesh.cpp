@@ -10,8 +10,13 @@
 
 #include <pmp/SurfaceMesh.h>
 #include <pmp/SurfaceMeshIO.h>
+#include <pmp/Parallel.h>
 
+#include <algorithm>
 #include <cmath>
+#include <istream>
+#include <limits>
+#include <ostream>
 
 //== NAMESPACE ================================================================
 
@@ -30,14 +35,18 @@ SurfaceMesh::SurfaceMesh()
     hconn_ = add_halfedge_property<HalfedgeConnectivity>("h:connectivity");
     fconn_ = add_face_property<FaceConnectivity>("f:connectivity");
 
-    vdeleted_ = add_vertex_property<bool>("v:deleted", false);
-    edeleted_ = add_edge_property<bool>("e:deleted", false);
-    fdeleted_ = add_face_property<bool>("f:deleted", false);
+    vdeleted_ = add_vertex_property<Flag>("v:deleted", false);
+    edeleted_ = add_edge_property<Flag>("e:deleted", false);
+    fdeleted_ = add_face_property<Flag>("f:deleted", false);
 
     deleted_vertices_ = 0;
     deleted_edges_ = 0;
     deleted_faces_ = 0;
     has_garbage_ = false;
+    topology_version_ = 0;
+    shared_connectivity_ = false;
+    recycle_elements_ = false;
+    free_lists_valid_ = false;
 }
 
 //-----------------------------------------------------------------------------
@@ -63,9 +72,9 @@ SurfaceMesh& SurfaceMesh::operator=(const SurfaceMesh& rhs)
         hconn_ = halfedge_property<HalfedgeConnectivity>("h:connectivity");
         fconn_ = face_property<FaceConnectivity>("f:connectivity");
 
-        vdeleted_ = vertex_property<bool>("v:deleted");
-        edeleted_ = edge_property<bool>("e:deleted");
-        fdeleted_ = face_property<bool>("f:deleted");
+        vdeleted_ = vertex_property<Flag>("v:deleted");
+        edeleted_ = edge_property<Flag>("e:deleted");
+        fdeleted_ = face_property<Flag>("f:deleted");
 
         // how many elements are deleted?
         deleted_vertices_ = rhs.deleted_vertices_;
@@ -73,6 +82,9 @@ SurfaceMesh& SurfaceMesh::operator=(const SurfaceMesh& rhs)
         deleted_faces_ = rhs.deleted_faces_;
 
         has_garbage_ = rhs.has_garbage_;
+        shared_connectivity_ = false;
+        ++topology_version_;
+        elements_replaced();
     }
 
     return *this;
@@ -80,6 +92,209 @@ SurfaceMesh& SurfaceMesh::operator=(const SurfaceMesh& rhs)
 
 //-----------------------------------------------------------------------------
 
+SurfaceMesh& SurfaceMesh::operator=(SurfaceMesh&& rhs)
+{
+    if (this != &rhs)
+    {
+        // take over the property arrays
+        oprops_ = std::move(rhs.oprops_);
+        vprops_ = std::move(rhs.vprops_);
+        hprops_ = std::move(rhs.hprops_);
+        eprops_ = std::move(rhs.eprops_);
+        fprops_ = std::move(rhs.fprops_);
+
+        // property handles point to the moved arrays and stay valid
+        vpoint_ = rhs.vpoint_;
+        vconn_ = rhs.vconn_;
+        hconn_ = rhs.hconn_;
+        fconn_ = rhs.fconn_;
+
+        vdeleted_ = rhs.vdeleted_;
+        edeleted_ = rhs.edeleted_;
+        fdeleted_ = rhs.fdeleted_;
+
+        deleted_vertices_ = rhs.deleted_vertices_;
+        deleted_edges_ = rhs.deleted_edges_;
+        deleted_faces_ = rhs.deleted_faces_;
+
+        has_garbage_ = rhs.has_garbage_;
+        shared_connectivity_ = rhs.shared_connectivity_.load();
+        ++topology_version_;
+        elements_replaced();
+
+        gc_vertex_map_.swap(rhs.gc_vertex_map_);
+        gc_edge_map_.swap(rhs.gc_edge_map_);
+        gc_face_map_.swap(rhs.gc_face_map_);
+
+        // leave rhs as a valid, empty mesh
+        rhs.clear();
+    }
+
+    return *this;
+}
+
+//-----------------------------------------------------------------------------
+
+SurfaceMesh& SurfaceMesh::assign_shared(const SurfaceMesh& rhs)
+{
+    if (this != &rhs)
+    {
+        // share connectivity and deleted flags, copy everything else
+        const std::vector<std::string> vshared = {"v:connectivity",
+                                                  "v:deleted"};
+        const std::vector<std::string> hshared = {"h:connectivity"};
+        const std::vector<std::string> eshared = {"e:deleted"};
+        const std::vector<std::string> fshared = {"f:connectivity",
+                                                  "f:deleted"};
+
+        oprops_ = rhs.oprops_;
+        vprops_.share(rhs.vprops_, vshared);
+        hprops_.share(rhs.hprops_, hshared);
+        eprops_.share(rhs.eprops_, eshared);
+        fprops_.share(rhs.fprops_, fshared);
+
+        // property handles contain pointers, have to be reassigned
+        vpoint_ = vertex_property<Point>("v:point");
+        vconn_ = vertex_property<VertexConnectivity>("v:connectivity");
+        hconn_ = halfedge_property<HalfedgeConnectivity>("h:connectivity");
+        fconn_ = face_property<FaceConnectivity>("f:connectivity");
+
+        vdeleted_ = vertex_property<Flag>("v:deleted");
+        edeleted_ = edge_property<Flag>("e:deleted");
+        fdeleted_ = face_property<Flag>("f:deleted");
+
+        deleted_vertices_ = rhs.deleted_vertices_;
+        deleted_edges_ = rhs.deleted_edges_;
+        deleted_faces_ = rhs.deleted_faces_;
+        has_garbage_ = rhs.has_garbage_;
+        ++topology_version_;
+        elements_replaced();
+
+        // both meshes have to copy before changing the connectivity
+        shared_connectivity_ = true;
+        rhs.shared_connectivity_ = true;
+    }
+
+    return *this;
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMesh::unshare_connectivity()
+{
+    vprops_.unshare();
+    hprops_.unshare();
+    eprops_.unshare();
+    fprops_.unshare();
+
+    vconn_ = get_vertex_property<VertexConnectivity>("v:connectivity");
+    hconn_ = get_halfedge_property<HalfedgeConnectivity>("h:connectivity");
+    fconn_ = get_face_property<FaceConnectivity>("f:connectivity");
+
+    vdeleted_ = get_vertex_property<Flag>("v:deleted");
+    edeleted_ = get_edge_property<Flag>("e:deleted");
+    fdeleted_ = get_face_property<Flag>("f:deleted");
+
+    shared_connectivity_ = false;
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMesh::begin_journal()
+{
+    assert(!reservation_);
+    journal_.reset(new Journal);
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMesh::end_journal() { journal_.reset(); }
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMesh::clear_journal()
+{
+    assert(journal_);
+    journal_->changes = ChangeJournal();
+    journal_->vertex_slot.clear();
+    journal_->edge_slot.clear();
+    journal_->face_slot.clear();
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMesh::elements_replaced()
+{
+    if (journal_)
+    {
+        clear_journal();
+        journal_->changes.reset = true;
+    }
+    free_lists_valid_ = false;
+}
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+// add change c of element h to list, listing each element only once
+template <class Handle>
+void add_change(std::vector<std::pair<Handle, unsigned char>>& list,
+                std::vector<IndexType>& slot, Handle h, unsigned char c)
+{
+    if (slot.size() <= h.idx())
+        slot.resize(h.idx() + 1, 0);
+    if (slot[h.idx()])
+    {
+        list[slot[h.idx()] - 1].second |= c;
+    }
+    else
+    {
+        list.emplace_back(h, c);
+        slot[h.idx()] = list.size();
+    }
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMesh::record(Vertex v, unsigned char c)
+{
+    if (v.is_valid())
+        add_change(journal_->changes.vertices, journal_->vertex_slot, v, c);
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMesh::record(Edge e, unsigned char c)
+{
+    add_change(journal_->changes.edges, journal_->edge_slot, e, c);
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMesh::record(Face f, unsigned char c)
+{
+    if (f.is_valid())
+        add_change(journal_->changes.faces, journal_->face_slot, f, c);
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMesh::record_halfedge(Halfedge h, Vertex v)
+{
+    if (!h.is_valid())
+        return;
+    const auto& conn = hconn_[h];
+    record(conn.vertex_, ChangeJournal::Modified);
+    record(v, ChangeJournal::Modified);
+    record(edge(h), ChangeJournal::Modified);
+    record(conn.face_, ChangeJournal::Modified);
+}
+
+//-----------------------------------------------------------------------------
+
 SurfaceMesh& SurfaceMesh::assign(const SurfaceMesh& rhs)
 {
     if (this != &rhs)
@@ -98,9 +313,9 @@ SurfaceMesh& SurfaceMesh::assign(const SurfaceMesh& rhs)
         hconn_ = add_halfedge_property<HalfedgeConnectivity>("h:connectivity");
         fconn_ = add_face_property<FaceConnectivity>("f:connectivity");
 
-        vdeleted_ = add_vertex_property<bool>("v:deleted", false);
-        edeleted_ = add_edge_property<bool>("e:deleted", false);
-        fdeleted_ = add_face_property<bool>("f:deleted", false);
+        vdeleted_ = add_vertex_property<Flag>("v:deleted", false);
+        edeleted_ = add_edge_property<Flag>("e:deleted", false);
+        fdeleted_ = add_face_property<Flag>("f:deleted", false);
 
         // copy properties from other mesh
         vpoint_.array() = rhs.vpoint_.array();
@@ -123,6 +338,9 @@ SurfaceMesh& SurfaceMesh::assign(const SurfaceMesh& rhs)
         deleted_edges_ = rhs.deleted_edges_;
         deleted_faces_ = rhs.deleted_faces_;
         has_garbage_ = rhs.has_garbage_;
+        shared_connectivity_ = false;
+        ++topology_version_;
+        elements_replaced();
     }
 
     return *this;
@@ -146,6 +364,45 @@ bool SurfaceMesh::write(const std::string& filename, const IOFlags& flags) const
 
 //-----------------------------------------------------------------------------
 
+bool SurfaceMesh::read(const char* data, size_t size, const std::string& format,
+                       const IOFlags& flags)
+{
+    return SurfaceMeshIO::read(*this, data, size, format, flags);
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMesh::read(std::istream& is, const std::string& format,
+                       const IOFlags& flags)
+{
+    auto read_function = [&is](char* buffer, size_t size) {
+        is.read(buffer, std::streamsize(size));
+        return size_t(is.gcount());
+    };
+    return SurfaceMeshIO::read(*this, read_function, format, flags);
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMesh::write(std::vector<char>& data, const std::string& format,
+                        const IOFlags& flags) const
+{
+    return SurfaceMeshIO::write(*this, data, format, flags);
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMesh::write(std::ostream& os, const std::string& format,
+                        const IOFlags& flags) const
+{
+    auto write_function = [&os](const char* data, size_t size) {
+        return bool(os.write(data, std::streamsize(size)));
+    };
+    return SurfaceMeshIO::write(*this, write_function, format, flags);
+}
+
+//-----------------------------------------------------------------------------
+
 void SurfaceMesh::clear()
 {
     // remove all properties
@@ -164,32 +421,68 @@ void SurfaceMesh::clear()
     vconn_    = add_vertex_property<VertexConnectivity>("v:connectivity");
     hconn_    = add_halfedge_property<HalfedgeConnectivity>("h:connectivity");
     fconn_    = add_face_property<FaceConnectivity>("f:connectivity");
-    vdeleted_ = add_vertex_property<bool>("v:deleted", false);
-    edeleted_ = add_edge_property<bool>("e:deleted", false);
-    fdeleted_ = add_face_property<bool>("f:deleted", false);
+    vdeleted_ = add_vertex_property<Flag>("v:deleted", false);
+    edeleted_ = add_edge_property<Flag>("e:deleted", false);
+    fdeleted_ = add_face_property<Flag>("f:deleted", false);
 
     // set initial status (as in constructor)
     deleted_vertices_ = 0;
     deleted_edges_    = 0;
     deleted_faces_    = 0;
     has_garbage_      = false;
+    shared_connectivity_ = false;
+    ++topology_version_;
+    elements_replaced();
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMesh::reset()
+{
+    if (shared_connectivity_)
+    {
+        clear();
+        return;
+    }
+
+    // the standard properties, as in the constructor
+    oprops_.clear_elements({});
+    oprops_.resize(1);
+    vprops_.clear_elements({"v:point", "v:connectivity", "v:deleted"});
+    hprops_.clear_elements({"h:connectivity"});
+    eprops_.clear_elements({"e:deleted"});
+    fprops_.clear_elements({"f:connectivity", "f:deleted"});
+
+    deleted_vertices_ = 0;
+    deleted_edges_ = 0;
+    deleted_faces_ = 0;
+    has_garbage_ = false;
+    ++topology_version_;
+    elements_replaced();
 }
 
 //-----------------------------------------------------------------------------
 
 void SurfaceMesh::free_memory()
 {
+    detach_connectivity();
     vprops_.free_memory();
     oprops_.free_memory();
     hprops_.free_memory();
     eprops_.free_memory();
     fprops_.free_memory();
+
+    std::vector<bool>().swap(gc_keep_);
+    std::vector<IndexType>().swap(gc_vertex_map_);
+    std::vector<IndexType>().swap(gc_edge_map_);
+    std::vector<IndexType>().swap(gc_face_map_);
 }
 
 //-----------------------------------------------------------------------------
 
 void SurfaceMesh::reserve(size_t nvertices, size_t nedges, size_t nfaces)
 {
+    detach_connectivity();
     oprops_.reserve(1);
     vprops_.reserve(nvertices);
     hprops_.reserve(2 * nedges);
@@ -199,29 +492,358 @@ void SurfaceMesh::reserve(size_t nvertices, size_t nedges, size_t nfaces)
 
 //-----------------------------------------------------------------------------
 
-void SurfaceMesh::property_stats() const
+void SurfaceMesh::set_growth_factor(float factor)
+{
+    oprops_.set_growth_factor(factor);
+    vprops_.set_growth_factor(factor);
+    hprops_.set_growth_factor(factor);
+    eprops_.set_growth_factor(factor);
+    fprops_.set_growth_factor(factor);
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMesh::begin_reservation(size_t nvertices, size_t nedges,
+                                    size_t nfaces)
+{
+    assert(!reservation_);
+    assert(!journal_);
+
+    if (vertices_size() + nvertices >= PMP_MAX_INDEX - 1 ||
+        halfedges_size() + 2 * nedges >= PMP_MAX_INDEX - 1 ||
+        faces_size() + nfaces >= PMP_MAX_INDEX - 1)
+    {
+        std::cerr << "begin_reservation: cannot reserve elements, max. index "
+                     "reached"
+                  << std::endl;
+        return false;
+    }
+
+    detach_connectivity();
+    ++topology_version_;
+
+    reservation_.reset(
+        new Reservation(vertices_size(), edges_size(), faces_size()));
+    Reservation& r = *reservation_;
+    r.end_vertex = r.begin_vertex + nvertices;
+    r.end_edge = r.begin_edge + nedges;
+    r.end_face = r.begin_face + nfaces;
+    r.had_garbage = has_garbage_;
+
+    // the reserved elements count as deleted until they are allocated
+    vprops_.resize(r.end_vertex);
+    eprops_.resize(r.end_edge);
+    hprops_.resize(2 * r.end_edge);
+    fprops_.resize(r.end_face);
+    for (IndexType i = r.begin_vertex; i < r.end_vertex; ++i)
+        vdeleted_[Vertex(i)] = true;
+    for (IndexType i = r.begin_edge; i < r.end_edge; ++i)
+        edeleted_[Edge(i)] = true;
+    for (IndexType i = r.begin_face; i < r.end_face; ++i)
+        fdeleted_[Face(i)] = true;
+    deleted_vertices_ += nvertices;
+    deleted_edges_ += nedges;
+    deleted_faces_ += nfaces;
+    if (nvertices || nedges || nfaces)
+        has_garbage_ = true;
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMesh::end_reservation()
+{
+    assert(reservation_);
+    const Reservation& r = *reservation_;
+
+    // all reserved elements were counted as deleted, the allocated ones
+    // are not deleted anymore, and the unused ones are removed. since the
+    // elements are allocated in order, the unused ones are at the end.
+    deleted_vertices_ -= r.end_vertex - r.begin_vertex;
+    deleted_edges_ -= r.end_edge - r.begin_edge;
+    deleted_faces_ -= r.end_face - r.begin_face;
+    has_garbage_ = r.had_garbage;
+
+    const IndexType nv = std::min<IndexType>(r.next_vertex, r.end_vertex);
+    const IndexType ne = std::min<IndexType>(r.next_edge, r.end_edge);
+    const IndexType nf = std::min<IndexType>(r.next_face, r.end_face);
+    vprops_.resize(nv);
+    eprops_.resize(ne);
+    hprops_.resize(2 * ne);
+    fprops_.resize(nf);
+
+    reservation_.reset();
+    ++topology_version_;
+}
+
+//-----------------------------------------------------------------------------
+
+Vertex SurfaceMesh::new_reserved_vertex()
+{
+    const IndexType i = reservation_->next_vertex++;
+    if (i >= reservation_->end_vertex)
+    {
+        std::cerr << "new_vertex: cannot allocate vertex, reservation "
+                     "exhausted"
+                  << std::endl;
+        return Vertex();
+    }
+    vdeleted_[Vertex(i)] = false;
+    return Vertex(i);
+}
+
+//-----------------------------------------------------------------------------
+
+Halfedge SurfaceMesh::new_reserved_edge(Vertex start, Vertex end)
+{
+    const IndexType i = reservation_->next_edge++;
+    if (i >= reservation_->end_edge)
+    {
+        std::cerr << "new_edge: cannot allocate edge, reservation exhausted"
+                  << std::endl;
+        return Halfedge();
+    }
+    edeleted_[Edge(i)] = false;
+
+    Halfedge h0(2 * i);
+    Halfedge h1(2 * i + 1);
+
+    set_vertex(h0, end);
+    set_vertex(h1, start);
+
+    return h0;
+}
+
+//-----------------------------------------------------------------------------
+
+Face SurfaceMesh::new_reserved_face()
+{
+    const IndexType i = reservation_->next_face++;
+    if (i >= reservation_->end_face)
+    {
+        std::cerr << "new_face: cannot allocate face, reservation exhausted"
+                  << std::endl;
+        return Face();
+    }
+    fdeleted_[Face(i)] = false;
+    return Face(i);
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMesh::set_element_recycling(bool b)
+{
+    recycle_elements_ = b;
+    free_lists_valid_ = false;
+    std::vector<Vertex>().swap(free_vertices_);
+    std::vector<Edge>().swap(free_edges_);
+    std::vector<Face>().swap(free_faces_);
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMesh::rebuild_free_lists()
+{
+    free_vertices_.clear();
+    free_edges_.clear();
+    free_faces_.clear();
+    for (IndexType i = 0; i < vertices_size(); ++i)
+        if (vdeleted_[Vertex(i)])
+            free_vertices_.push_back(Vertex(i));
+    for (IndexType i = 0; i < edges_size(); ++i)
+        if (edeleted_[Edge(i)])
+            free_edges_.push_back(Edge(i));
+    for (IndexType i = 0; i < faces_size(); ++i)
+        if (fdeleted_[Face(i)])
+            free_faces_.push_back(Face(i));
+    free_lists_valid_ = true;
+}
+
+//-----------------------------------------------------------------------------
+
+Vertex SurfaceMesh::recycle_vertex()
+{
+    if (!free_lists_valid_)
+        rebuild_free_lists();
+    while (!free_vertices_.empty())
+    {
+        const Vertex v = free_vertices_.back();
+        free_vertices_.pop_back();
+        if (v.idx() >= vertices_size() || !vdeleted_[v])
+            continue;
+
+        detach_connectivity();
+        vprops_.reset_element(v.idx());
+        --deleted_vertices_;
+        has_garbage_ = deleted_vertices_ || deleted_edges_ || deleted_faces_;
+        ++topology_version_;
+        if (journal_)
+            record(v, ChangeJournal::Created);
+        return v;
+    }
+    return Vertex();
+}
+
+//-----------------------------------------------------------------------------
+
+Halfedge SurfaceMesh::recycle_edge()
+{
+    if (!free_lists_valid_)
+        rebuild_free_lists();
+    while (!free_edges_.empty())
+    {
+        const Edge e = free_edges_.back();
+        free_edges_.pop_back();
+        if (e.idx() >= edges_size() || !edeleted_[e])
+            continue;
+
+        detach_connectivity();
+        eprops_.reset_element(e.idx());
+        hprops_.reset_element(2 * e.idx());
+        hprops_.reset_element(2 * e.idx() + 1);
+        --deleted_edges_;
+        has_garbage_ = deleted_vertices_ || deleted_edges_ || deleted_faces_;
+        ++topology_version_;
+        return halfedge(e, 0);
+    }
+    return Halfedge();
+}
+
+//-----------------------------------------------------------------------------
+
+Face SurfaceMesh::recycle_face()
+{
+    if (!free_lists_valid_)
+        rebuild_free_lists();
+    while (!free_faces_.empty())
+    {
+        const Face f = free_faces_.back();
+        free_faces_.pop_back();
+        if (f.idx() >= faces_size() || !fdeleted_[f])
+            continue;
+
+        detach_connectivity();
+        fprops_.reset_element(f.idx());
+        --deleted_faces_;
+        has_garbage_ = deleted_vertices_ || deleted_edges_ || deleted_faces_;
+        ++topology_version_;
+        if (journal_)
+            record(f, ChangeJournal::Created);
+        return f;
+    }
+    return Face();
+}
+
+//-----------------------------------------------------------------------------
+
+SurfaceMesh::MemoryStats SurfaceMesh::memory_stats() const
+{
+    MemoryStats stats;
+    stats.object_properties = oprops_.memory();
+    stats.vertex_properties = vprops_.memory();
+    stats.halfedge_properties = hprops_.memory();
+    stats.edge_properties = eprops_.memory();
+    stats.face_properties = fprops_.memory();
+
+    // the share of n_deleted out of n elements in the used properties
+    auto deleted = [](const std::vector<PropertyMemory>& props,
+                      size_t n_deleted, size_t n) {
+        size_t bytes = 0;
+        if (n)
+            for (const auto& p : props)
+                if (!p.recycled)
+                    bytes += size_t(double(p.size) * n_deleted / n);
+        return bytes;
+    };
+    stats.deleted =
+        deleted(stats.vertex_properties, deleted_vertices_, vertices_size()) +
+        deleted(stats.halfedge_properties, 2 * deleted_edges_,
+                halfedges_size()) +
+        deleted(stats.edge_properties, deleted_edges_, edges_size()) +
+        deleted(stats.face_properties, deleted_faces_, faces_size());
+
+    stats.connectivity = 0;
+    for (const auto* props :
+         {&stats.vertex_properties, &stats.halfedge_properties,
+          &stats.face_properties})
+        for (const auto& p : *props)
+            if (!p.recycled && (p.name == "v:connectivity" ||
+                                p.name == "h:connectivity" ||
+                                p.name == "f:connectivity"))
+                stats.connectivity += p.size;
+
+    stats.helpers =
+        (gc_keep_.capacity() + add_face_is_new_.capacity() +
+         add_face_needs_adjust_.capacity() + 7) / 8 +
+        (gc_vertex_map_.capacity() + gc_edge_map_.capacity() +
+         gc_face_map_.capacity()) * sizeof(IndexType) +
+        add_face_vertices_.capacity() * sizeof(Vertex) +
+        add_face_halfedges_.capacity() * sizeof(Halfedge) +
+        add_face_next_cache_.capacity() * sizeof(NextCacheEntry);
+
+    return stats;
+}
+
+//-----------------------------------------------------------------------------
+
+size_t SurfaceMesh::MemoryStats::size() const
 {
-    std::vector<std::string> props;
+    size_t bytes = 0;
+    for (const auto* props : {&object_properties, &vertex_properties,
+                              &halfedge_properties, &edge_properties,
+                              &face_properties})
+        for (const auto& p : *props)
+            if (!p.recycled)
+                bytes += p.size;
+    return bytes;
+}
 
-    std::cout << "point properties:\n";
-    props = vertex_properties();
-    for (const auto& prop : props)
-        std::cout << "\t" << prop << std::endl;
+//-----------------------------------------------------------------------------
 
-    std::cout << "halfedge properties:\n";
-    props = halfedge_properties();
-    for (const auto& prop : props)
-        std::cout << "\t" << prop << std::endl;
+size_t SurfaceMesh::MemoryStats::capacity() const
+{
+    size_t bytes = helpers;
+    for (const auto* props : {&object_properties, &vertex_properties,
+                              &halfedge_properties, &edge_properties,
+                              &face_properties})
+        for (const auto& p : *props)
+            bytes += p.capacity;
+    return bytes;
+}
 
-    std::cout << "edge properties:\n";
-    props = edge_properties();
-    for (const auto& prop : props)
-        std::cout << "\t" << prop << std::endl;
+//-----------------------------------------------------------------------------
 
-    std::cout << "face properties:\n";
-    props = face_properties();
-    for (const auto& prop : props)
-        std::cout << "\t" << prop << std::endl;
+void SurfaceMesh::property_stats() const
+{
+    const MemoryStats stats = memory_stats();
+
+    auto print = [](const char* title,
+                    const std::vector<PropertyMemory>& props) {
+        std::cout << title << ":\n";
+        for (const auto& p : props)
+        {
+            std::cout << "\t" << p.name << ": " << p.size << " bytes";
+            if (p.capacity != p.size)
+                std::cout << ", " << p.capacity << " allocated";
+            if (p.shared)
+                std::cout << ", shared";
+            if (p.recycled)
+                std::cout << ", recycled";
+            std::cout << std::endl;
+        }
+    };
+
+    print("object properties", stats.object_properties);
+    print("point properties", stats.vertex_properties);
+    print("halfedge properties", stats.halfedge_properties);
+    print("edge properties", stats.edge_properties);
+    print("face properties", stats.face_properties);
+
+    std::cout << "connectivity: " << stats.connectivity << " bytes\n";
+    std::cout << "deleted elements: " << stats.deleted << " bytes\n";
+    std::cout << "total: " << stats.size() << " bytes, " << stats.capacity()
+              << " allocated" << std::endl;
 }
 
 //-----------------------------------------------------------------------------
@@ -462,33 +1084,345 @@ Face SurfaceMesh::add_face(const std::vector<Vertex>& vertices)
                     break;
             }
 
-            // set inner link
-            nextCache.emplace_back(innerPrev, innerNext);
+            // set inner link
+            nextCache.emplace_back(innerPrev, innerNext);
+        }
+        else
+            needsAdjust[ii] = (halfedge(v) == innerNext);
+
+        // set face handle
+        set_face(halfedges[i], f);
+    }
+
+    // process next halfedge cache
+    NextCache::const_iterator ncIt(nextCache.begin()), ncEnd(nextCache.end());
+    for (; ncIt != ncEnd; ++ncIt)
+    {
+        set_next_halfedge(ncIt->first, ncIt->second);
+    }
+
+    // adjust vertices' halfedge handle
+    for (i = 0; i < n; ++i)
+    {
+        if (needsAdjust[i])
+        {
+            adjust_outgoing_halfedge(vertices[i]);
+        }
+    }
+
+    return f;
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMesh::add_faces(const std::vector<IndexType>& indices,
+                            const std::vector<IndexType>& face_sizes)
+{
+    const size_t nv = vertices_size();
+    const size_t n_input = face_sizes.empty() ? indices.size() / 3
+                                              : face_sizes.size();
+    bool ok = true;
+
+    if (face_sizes.empty() && indices.size() % 3)
+    {
+        std::cerr << "SurfaceMesh::add_faces: number of indices is not a "
+                     "multiple of three\n";
+        ok = false;
+    }
+
+    // collect corners of valid faces
+    std::vector<IndexType> corners;
+    std::vector<IndexType> face_start;
+    corners.reserve(indices.size());
+    face_start.reserve(n_input + 1);
+
+    size_t offset = 0;
+    for (size_t i = 0; i < n_input; ++i)
+    {
+        const size_t n = face_sizes.empty() ? 3 : face_sizes[i];
+        const size_t begin = offset;
+        offset += n;
+
+        bool valid = (n >= 3 && offset <= indices.size());
+        for (size_t j = begin; valid && j < offset; ++j)
+        {
+            if (indices[j] >= nv)
+                valid = false;
+            for (size_t k = begin; valid && k < j; ++k)
+                if (indices[k] == indices[j])
+                    valid = false;
+        }
+
+        if (!valid)
+        {
+            std::cerr << "SurfaceMesh::add_faces: skipping invalid face " << i
+                      << "\n";
+            ok = false;
+            continue;
+        }
+
+        face_start.push_back(corners.size());
+        corners.insert(corners.end(), indices.begin() + begin,
+                       indices.begin() + offset);
+    }
+    face_start.push_back(corners.size());
+
+    // fast path for meshes without connectivity
+    if (halfedges_size() == 0 && faces_size() == 0 &&
+        build_connectivity(corners, face_start))
+    {
+        elements_replaced();
+        return ok;
+    }
+
+    // otherwise add one face after the other
+    std::vector<Vertex> vertices;
+    for (size_t i = 0; i + 1 < face_start.size(); ++i)
+    {
+        vertices.clear();
+        for (size_t j = face_start[i]; j < face_start[i + 1]; ++j)
+            vertices.push_back(Vertex(corners[j]));
+        if (!add_face(vertices).is_valid())
+            ok = false;
+    }
+
+    return ok;
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMesh::build_from_indices(const std::vector<Point>& positions,
+                                     const std::vector<IndexType>& indices,
+                                     const std::vector<IndexType>& face_sizes)
+{
+    clear();
+
+    vprops_.resize(positions.size());
+    parallel_for(0, positions.size(),
+                 [&](size_t i) { vpoint_[Vertex(IndexType(i))] = positions[i]; });
+    ++topology_version_;
+
+    return add_faces(indices, face_sizes);
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMesh::build_connectivity(const std::vector<IndexType>& corners,
+                                     const std::vector<IndexType>& face_start)
+{
+    const IndexType invalid = PMP_MAX_INDEX;
+    const size_t nv = vertices_size();
+    const size_t nf = face_start.size() - 1;
+    const size_t nc = corners.size();
+
+    if (nc == 0)
+        return true;
+
+    // a corner c is the halfedge from corners[c] to corners[next(c)]
+    std::vector<IndexType> corner_face(nc);
+    parallel_for(0, nf, [&](size_t f) {
+        for (IndexType c = face_start[f]; c < face_start[f + 1]; ++c)
+            corner_face[c] = IndexType(f);
+    });
+
+    auto next = [&](IndexType c) {
+        return (c + 1 == face_start[corner_face[c] + 1])
+                   ? face_start[corner_face[c]]
+                   : c + 1;
+    };
+#ifndef PMP_NO_PREV_HALFEDGE
+    auto prev = [&](IndexType c) {
+        return (c == face_start[corner_face[c]])
+                   ? face_start[corner_face[c] + 1] - 1
+                   : c - 1;
+    };
+#endif
+    auto from = [&](IndexType c) { return corners[c]; };
+    auto to = [&](IndexType c) { return corners[next(c)]; };
+
+    // bucket corners by their smaller vertex (stable in corner order)
+    std::vector<IndexType> bucket_start(nv + 1, 0);
+    for (IndexType c = 0; c < nc; ++c)
+        ++bucket_start[std::min(from(c), to(c)) + 1];
+    for (size_t v = 0; v < nv; ++v)
+        bucket_start[v + 1] += bucket_start[v];
+
+    std::vector<IndexType> bucket(nc);
+    {
+        std::vector<IndexType> fill(bucket_start.begin(),
+                                    bucket_start.end() - 1);
+        for (IndexType c = 0; c < nc; ++c)
+            bucket[fill[std::min(from(c), to(c))]++] = c;
+    }
+
+    // sort buckets by larger vertex and find the twin of each corner
+    std::vector<IndexType> twin(nc, invalid);
+    std::vector<char> complex(nv, 0);
+
+    parallel_for(0, nv, [&](size_t v) {
+        const auto begin = bucket.begin() + bucket_start[v];
+        const auto end = bucket.begin() + bucket_start[v + 1];
+        std::sort(begin, end, [&](IndexType a, IndexType b) {
+            const IndexType ma = std::max(from(a), to(a));
+            const IndexType mb = std::max(from(b), to(b));
+            return ma < mb || (ma == mb && a < b);
+        });
+
+        for (auto it = begin; it != end;)
+        {
+            const IndexType m = std::max(from(*it), to(*it));
+            auto group_end = it + 1;
+            while (group_end != end && std::max(from(*group_end),
+                                                to(*group_end)) == m)
+                ++group_end;
+
+            const auto group_size = group_end - it;
+            if (group_size == 2 && from(it[0]) != from(it[1]))
+            {
+                twin[it[0]] = it[1];
+                twin[it[1]] = it[0];
+            }
+            else if (group_size > 1)
+            {
+                complex[v] = 1; // complex edge
+            }
+            it = group_end;
         }
-        else
-            needsAdjust[ii] = (halfedge(v) == innerNext);
+    });
 
-        // set face handle
-        set_face(halfedges[i], f);
+    if (std::find(complex.begin(), complex.end(), 1) != complex.end())
+        return false;
+
+    // number edges in order of their first corner, as add_face() does
+    std::vector<IndexType> corner_halfedge(nc);
+    IndexType n_edges = 0;
+    for (IndexType c = 0; c < nc; ++c)
+    {
+        if (twin[c] == invalid || c < twin[c])
+            corner_halfedge[c] = 2 * n_edges++;
+        else
+            corner_halfedge[c] = corner_halfedge[twin[c]] + 1;
     }
 
-    // process next halfedge cache
-    NextCache::const_iterator ncIt(nextCache.begin()), ncEnd(nextCache.end());
-    for (; ncIt != ncEnd; ++ncIt)
+    // boundary halfedge leaving each vertex, has to be unique
+    std::vector<IndexType> boundary_out(nv, invalid);
+    for (IndexType c = 0; c < nc; ++c)
     {
-        set_next_halfedge(ncIt->first, ncIt->second);
+        if (twin[c] != invalid)
+            continue;
+        const IndexType v = to(c);
+        if (boundary_out[v] != invalid)
+            return false; // complex vertex
+        boundary_out[v] = corner_halfedge[c] ^ 1;
     }
 
-    // adjust vertices' halfedge handle
-    for (i = 0; i < n; ++i)
+    // build connectivity
+    detach_connectivity();
+    ++topology_version_;
+
+    eprops_.resize(n_edges);
+    hprops_.resize(2 * n_edges);
+    fprops_.resize(nf);
+
+    parallel_for(0, nc, [&](size_t i) {
+        const IndexType c = IndexType(i);
+        auto& conn = hconn_[Halfedge(corner_halfedge[c])];
+        conn.vertex_ = Vertex(to(c));
+        conn.face_ = Face(corner_face[c]);
+        conn.next_halfedge_ = Halfedge(corner_halfedge[next(c)]);
+#ifndef PMP_NO_PREV_HALFEDGE
+        conn.prev_halfedge_ = Halfedge(corner_halfedge[prev(c)]);
+#endif
+
+        if (twin[c] == invalid)
+        {
+            auto& bconn = hconn_[Halfedge(corner_halfedge[c] ^ 1)];
+            bconn.vertex_ = Vertex(from(c));
+            bconn.face_ = Face();
+            bconn.next_halfedge_ = Halfedge(boundary_out[from(c)]);
+        }
+    });
+
+#ifndef PMP_NO_PREV_HALFEDGE
+    // the previous halfedge of each boundary halfedge
+    parallel_for(0, nc, [&](size_t c) {
+        if (twin[c] == invalid)
+        {
+            const Halfedge b(corner_halfedge[c] ^ 1);
+            hconn_[hconn_[b].next_halfedge_].prev_halfedge_ = b;
+        }
+    });
+#endif
+
+    parallel_for(0, nf, [&](size_t f) {
+        fconn_[Face(IndexType(f))].halfedge_ =
+            Halfedge(corner_halfedge[face_start[f + 1] - 1]);
+    });
+
+    // outgoing halfedge per vertex, a boundary one if possible
+    std::vector<IndexType> n_outgoing(nv, 0);
+    for (IndexType c = 0; c < nc; ++c)
     {
-        if (needsAdjust[i])
+        const IndexType v = from(c);
+        if (!n_outgoing[v]++ && boundary_out[v] == invalid)
+            vconn_[Vertex(v)].halfedge_ = Halfedge(corner_halfedge[c]);
+    }
+
+    parallel_for(0, nv, [&](size_t i) {
+        const Vertex v(static_cast<IndexType>(i));
+        if (boundary_out[i] != invalid)
         {
-            adjust_outgoing_halfedge(vertices[i]);
+            vconn_[v].halfedge_ = Halfedge(boundary_out[i]);
+            ++n_outgoing[i];
+        }
+        else if (!n_outgoing[i])
+        {
+            vconn_[v].halfedge_ = Halfedge();
+        }
+
+        // all outgoing halfedges have to be reachable by rotation,
+        // otherwise the vertex joins several fans
+        if (n_outgoing[i])
+        {
+            const Halfedge start = vconn_[v].halfedge_;
+            Halfedge h = start;
+            IndexType n = 0;
+            do
+            {
+                ++n;
+                h = cw_rotated_halfedge(h);
+            } while (h != start && n <= n_outgoing[i]);
+            if (n != n_outgoing[i])
+                complex[i] = 1;
         }
+    });
+
+    if (std::find(complex.begin(), complex.end(), 1) != complex.end())
+    {
+        // roll back to the unconnected mesh
+        eprops_.resize(0);
+        hprops_.resize(0);
+        fprops_.resize(0);
+        for (size_t i = 0; i < nv; ++i)
+            vconn_[Vertex(IndexType(i))].halfedge_ = Halfedge();
+        return false;
     }
 
-    return f;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+HalfedgeProperty<Halfedge>
+SurfaceMesh::add_prev_halfedge_property(const std::string& name)
+{
+    auto prev = halfedge_property<Halfedge>(name);
+    parallel_for(0, halfedges_size(), [&](size_t i) {
+        const Halfedge h(static_cast<IndexType>(i));
+        if (!edeleted_[edge(h)])
+            prev[next_halfedge(h)] = h;
+    });
+    return prev;
 }
 
 //-----------------------------------------------------------------------------
@@ -545,54 +1479,492 @@ bool SurfaceMesh::is_quad_mesh() const
 
 //-----------------------------------------------------------------------------
 
-void SurfaceMesh::triangulate()
+void SurfaceMesh::triangulate(TriangulationMethod method)
+{
+    assert(!reservation_);
+
+    // each n-gon gets n-3 new edges and faces, numbered in face order
+    const size_t nf = faces_size();
+    std::vector<IndexType> first(nf + 1, 0);
+    parallel_for(0, nf, [&](size_t i) {
+        const Face f(static_cast<IndexType>(i));
+        if (!is_deleted(f))
+            first[i + 1] = std::max<IndexType>(valence(f), 3) - 3;
+    });
+    for (size_t i = 0; i < nf; ++i)
+        first[i + 1] += first[i];
+
+    const IndexType n_new = first[nf];
+    if (n_new == 0)
+        return;
+    if (halfedges_size() + 2 * size_t(n_new) >= PMP_MAX_INDEX - 1 ||
+        faces_size() + size_t(n_new) >= PMP_MAX_INDEX - 1)
+    {
+        std::cerr << "triangulate: cannot allocate elements, max. index "
+                     "reached"
+                  << std::endl;
+        return;
+    }
+
+    detach_connectivity();
+    const IndexType first_edge = edges_size();
+    const IndexType first_face = faces_size();
+    eprops_.resize(first_edge + n_new);
+    hprops_.resize(2 * (first_edge + n_new));
+    fprops_.resize(first_face + n_new);
+    ++topology_version_;
+
+    // the faces only modify their own halfedges and write them directly,
+    // recording in the journal is serial
+    auto triangulate_face = [&](size_t i) {
+        if (first[i + 1] != first[i])
+            triangulate(Face(static_cast<IndexType>(i)), method,
+                        first_edge + first[i], first_face + first[i]);
+    };
+    if (journal_)
+    {
+        for (size_t i = 0; i < nf; ++i)
+            triangulate_face(i);
+    }
+    else
+        parallel_for(0, nf, triangulate_face);
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMesh::triangulate(Face f, TriangulationMethod method)
 {
-    // The iterators will stay valid, even though new faces are added, because
-    // they are now implemented index-based instead of pointer-based.
-    auto fend = faces_end();
-    for (auto fit = faces_begin(); fit != fend; ++fit)
-        triangulate(*fit);
+    const size_t n = valence(f);
+    if (n <= 3)
+        return;
+    const IndexType n_new = n - 3;
+
+    IndexType first_edge, first_face;
+    if (reservation_)
+    {
+        Reservation& r = *reservation_;
+        first_edge = r.next_edge.fetch_add(n_new);
+        first_face = r.next_face.fetch_add(n_new);
+        if (first_edge + n_new > r.end_edge || first_face + n_new > r.end_face)
+        {
+            std::cerr << "triangulate: cannot allocate elements, reservation "
+                         "exhausted"
+                      << std::endl;
+            return;
+        }
+        for (IndexType i = 0; i < n_new; ++i)
+        {
+            edeleted_[Edge(first_edge + i)] = false;
+            fdeleted_[Face(first_face + i)] = false;
+        }
+    }
+    else
+    {
+        if (halfedges_size() + 2 * n_new >= PMP_MAX_INDEX - 1 ||
+            faces_size() + n_new >= PMP_MAX_INDEX - 1)
+        {
+            std::cerr << "triangulate: cannot allocate elements, max. index "
+                         "reached"
+                      << std::endl;
+            return;
+        }
+        detach_connectivity();
+        first_edge = edges_size();
+        first_face = faces_size();
+        eprops_.resize(first_edge + n_new);
+        hprops_.resize(2 * (first_edge + n_new));
+        fprops_.resize(first_face + n_new);
+        ++topology_version_;
+    }
+
+    triangulate(f, method, first_edge, first_face);
 }
 
 //-----------------------------------------------------------------------------
 
-void SurfaceMesh::triangulate(Face f)
+void SurfaceMesh::triangulate(Face f, TriangulationMethod method,
+                              IndexType first_edge, IndexType first_face)
 {
-    // Split an arbitrary face into triangles by connecting each vertex of \c f
-    // after its second to \c v .\c f will remain valid (it will become one of
-    // the triangles). The halfedge handles of the new triangles will point to
-    // the old halfedges.
+    // Split an arbitrary face into triangles by cutting off one corner after
+    // the other. \c f will remain valid (it will become the last triangle).
+    // The halfedge handles of the new triangles will point to the old
+    // halfedges.
+
+    // The connectivity is written directly instead of by the setters, since
+    // faces are triangulated concurrently, see triangulate(). The callers
+    // count the change of the topology_version_.
+
+    if (journal_)
+    {
+        for (auto h : halfedges(f))
+            record_halfedge(h, Vertex());
+        const IndexType n_new = valence(f) - 3;
+        for (IndexType i = 0; i < n_new; ++i)
+        {
+            record(Edge(first_edge + i), ChangeJournal::Created);
+            record(Face(first_face + i), ChangeJournal::Created);
+        }
+    }
+
+    auto link = [&](Halfedge h, Halfedge next, Face face) {
+        hconn_[h].next_halfedge_ = next;
+#ifndef PMP_NO_PREV_HALFEDGE
+        hconn_[next].prev_halfedge_ = h;
+#endif
+        hconn_[h].face_ = face;
+    };
+
+    auto cut = [&](Halfedge h0, Halfedge h1, IndexType i) {
+        // the new edge from the end of h1 to the start of h0
+        const Face new_f(first_face + i);
+        const Halfedge new_h(2 * (first_edge + i));
+        hconn_[new_h].vertex_ = from_vertex(h0);
+        hconn_[opposite_halfedge(new_h)].vertex_ = to_vertex(h1);
+
+        fconn_[new_f].halfedge_ = h0;
+        link(h0, h1, new_f);
+        link(h1, new_h, new_f);
+        link(new_h, h0, new_f);
+        return opposite_halfedge(new_h);
+    };
+
+    if (method == Fan)
+    {
+        // connect each vertex after the second to the start vertex
+        Halfedge baseH = halfedge(f);
+        const Vertex startV = from_vertex(baseH);
+        Halfedge nextH = next_halfedge(baseH);
+
+        IndexType i = 0;
+        while (to_vertex(next_halfedge(nextH)) != startV)
+        {
+            const Halfedge nextNextH(next_halfedge(nextH));
+            baseH = cut(baseH, nextH, i++);
+            nextH = nextNextH;
+        }
+        fconn_[f].halfedge_ = baseH; //the last face takes the handle baseH
+
+        link(next_halfedge(nextH), baseH, f);
+        link(baseH, nextH, f);
+        return;
+    }
 
-    Halfedge baseH = halfedge(f);
-    Vertex startV = from_vertex(baseH);
-    Halfedge nextH = next_halfedge(baseH);
+    // cut off the corner with the shortest diagonal until a triangle is left
+    std::vector<Halfedge> polygon;
+    for (auto h : halfedges(f))
+        polygon.push_back(h);
 
-    while (to_vertex(next_halfedge(nextH)) != startV)
+    IndexType i = 0;
+    while (polygon.size() > 3)
     {
-        Halfedge nextNextH(next_halfedge(nextH));
+        const size_t m = polygon.size();
+        size_t best = 0;
+        Scalar best_length = std::numeric_limits<Scalar>::max();
+        for (size_t j = 0; j < m; ++j)
+        {
+            const Scalar length =
+                sqrnorm(position(from_vertex(polygon[j])) -
+                        position(to_vertex(polygon[(j + 1) % m])));
+            if (length < best_length)
+            {
+                best = j;
+                best_length = length;
+            }
+        }
+
+        const size_t next = (best + 1) % m;
+        polygon[best] = cut(polygon[best], polygon[next], i++);
+        polygon.erase(polygon.begin() + next);
+    }
+
+    fconn_[f].halfedge_ = polygon[0];
+    for (size_t j = 0; j < 3; ++j)
+        link(polygon[j], polygon[(j + 1) % 3], f);
+}
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+// the number of corners of the faces, their index per halfedge, and the
+// first corner of each face
+size_t face_corners(const SurfaceMesh& mesh, std::vector<IndexType>& corner,
+                    std::vector<IndexType>& first_corner)
+{
+    const size_t nf = mesh.faces_size();
+    first_corner.assign(nf + 1, 0);
+    for (IndexType f = 0; f < nf; ++f)
+        first_corner[f + 1] = first_corner[f] + mesh.valence(Face(f));
+
+    corner.assign(mesh.halfedges_size(), PMP_MAX_INDEX);
+    parallel_for(mesh.faces(), [&](Face f) {
+        IndexType c = first_corner[f.idx()];
+        for (auto h : mesh.halfedges(f))
+            corner[h.idx()] = c++;
+    });
+
+    return first_corner[nf];
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMesh::subdivide_connectivity(bool quads)
+{
+    assert(!reservation_);
+
+    // the triangle split assumes three corners per face
+    if (!quads && !is_triangle_mesh())
+        return false;
+
+    if (has_garbage_)
+        garbage_collection();
+
+    const IndexType nv = vertices_size();
+    const IndexType ne = edges_size();
+    const IndexType nf = faces_size();
+    std::vector<IndexType> corner, first_corner;
+    const IndexType nc = face_corners(*this, corner, first_corner);
+
+    // the old connectivity
+    const std::vector<HalfedgeConnectivity> hconn = hconn_.vector();
+    auto hprev = add_prev_halfedge_property();
+    const std::vector<Halfedge> prevs = hprev.vector();
+    remove_halfedge_property(hprev);
+    const std::vector<VertexConnectivity> vconn = vconn_.vector();
+    const std::vector<FaceConnectivity> fconn = fconn_.vector();
+
+    // old halfedge i from a to b becomes a -> m = c1(i) and m -> b = c2(i),
+    // the edge of each corner c joins the vertices on the edges of its
+    // halfedge and the next one, or the first one and the face vertex
+    auto c1 = [](IndexType i) { return Halfedge(2 * i); };
+    auto c2 = [](IndexType i) { return Halfedge(2 * (i ^ 1) + 1); };
+    auto inner = [&](IndexType c) { return 2 * (2 * ne + c); };
+    const IndexType center = nv + ne;
+
+    detach_connectivity();
+    ++topology_version_;
+    elements_replaced();
+    vprops_.resize(nv + ne + (quads ? nf : 0));
+    hprops_.resize(0);
+    hprops_.resize(2 * (2 * ne + nc));
+    eprops_.resize(0);
+    eprops_.resize(2 * ne + nc);
+    fprops_.resize(0);
+    fprops_.resize(quads ? nc : nc + nf);
+
+    auto set = [&](Halfedge h, IndexType to, Face f, Halfedge prev,
+                   Halfedge next) {
+        HalfedgeConnectivity& conn = hconn_[h];
+        conn.vertex_ = Vertex(to);
+        conn.face_ = f;
+#ifndef PMP_NO_PREV_HALFEDGE
+        conn.prev_halfedge_ = prev;
+#else
+        (void)prev;
+#endif
+        conn.next_halfedge_ = next;
+    };
+
+    // faces, with the old halfedges h_0 ... h_n-1 ending in v_0 ... v_n-1
+    // and the vertices m_0 ... m_n-1 on their edges
+    parallel_for(0, nf, [&](size_t f) {
+        const IndexType begin = first_corner[f];
+        const IndexType n = first_corner[f + 1] - begin;
+        IndexType h[4];
+        std::vector<IndexType> polygon;
+        IndexType* halfedges = h;
+        if (n > 4)
+        {
+            polygon.resize(n);
+            halfedges = polygon.data();
+        }
+        halfedges[0] = fconn[f].halfedge_.idx();
+        for (IndexType k = 1; k < n; ++k)
+            halfedges[k] = hconn[halfedges[k - 1]].next_halfedge_.idx();
+
+        for (IndexType k = 0; k < n; ++k)
+        {
+            const IndexType i = halfedges[k];
+            const IndexType j = halfedges[(k + 1) % n];
+            const IndexType c = begin + k, d = begin + (k + 1) % n;
+            const Face q(c);
+            if (quads)
+            {
+                // the quad (v_k, m_k+1, center, m_k)
+                const Halfedge in(inner(d)), out(inner(c) + 1);
+                set(c2(i), hconn[i].vertex_.idx(), q, out, c1(j));
+                set(c1(j), nv + j / 2, q, c2(i), in);
+                set(in, center + f, q, c1(j), out);
+                set(out, nv + i / 2, q, in, c2(i));
+            }
+            else
+            {
+                // the triangle (v_k, m_k+1, m_k) and an edge of the center
+                // triangle (m_0, m_1, m_2)
+                const Halfedge in(inner(c)), out(inner(c) + 1);
+                set(c2(i), hconn[i].vertex_.idx(), q, in, c1(j));
+                set(c1(j), nv + j / 2, q, c2(i), in);
+                set(in, nv + i / 2, q, c1(j), c2(i));
+                const Face middle(nc + f);
+                const Halfedge prev(inner(begin + (k + 2) % 3) + 1);
+                set(out, nv + j / 2, middle, prev, Halfedge(inner(d) + 1));
+            }
+            fconn_[q].halfedge_ = c2(i);
+        }
+        if (!quads)
+            fconn_[Face(nc + f)].halfedge_ = Halfedge(inner(begin) + 1);
+    });
+
+    // the boundary halfedges
+    parallel_for(0, 2 * ne, [&](size_t i) {
+        if (hconn[i].face_.is_valid())
+            return;
+        const IndexType next = hconn[i].next_halfedge_.idx();
+        const IndexType prev = prevs[i].idx();
+        set(c1(i), nv + i / 2, Face(), c2(prev), c2(i));
+        set(c2(i), hconn[i].vertex_.idx(), Face(), c1(i), c1(next));
+    });
+
+    // an outgoing halfedge of each vertex, on the boundary if possible
+    parallel_for(0, nv, [&](size_t v) {
+        const Halfedge h = vconn[v].halfedge_;
+        vconn_[Vertex(v)].halfedge_ =
+            h.is_valid() ? c1(h.idx()) : Halfedge();
+    });
+    parallel_for(0, ne, [&](size_t e) {
+        const IndexType i =
+            hconn[2 * e + 1].face_.is_valid() ? 2 * e : 2 * e + 1;
+        vconn_[Vertex(nv + e)].halfedge_ = c2(i);
+    });
+    if (quads)
+        parallel_for(0, nf, [&](size_t f) {
+            vconn_[Vertex(center + f)].halfedge_ =
+                Halfedge(inner(first_corner[f]) + 1);
+        });
 
-        Face newF = new_face();
-        set_halfedge(newF, baseH);
+    return true;
+}
 
-        Halfedge newH = new_edge(to_vertex(nextH), startV);
+//-----------------------------------------------------------------------------
 
-        set_next_halfedge(baseH, nextH);
-        set_next_halfedge(nextH, newH);
-        set_next_halfedge(newH, baseH);
+bool SurfaceMesh::sqrt3_connectivity()
+{
+    assert(!reservation_);
+    if (has_garbage_)
+        garbage_collection();
 
-        set_face(baseH, newF);
-        set_face(nextH, newF);
-        set_face(newH, newF);
+    const IndexType nv = vertices_size();
+    const IndexType ne = edges_size();
+    const IndexType nf = faces_size();
 
-        baseH = opposite_halfedge(newH);
-        nextH = nextNextH;
+    // the flipped edges would not be unique
+    for (auto f : faces())
+    {
+        std::vector<Face> neighbors;
+        for (auto h : halfedges(f))
+        {
+            const Face g = face(opposite_halfedge(h));
+            if (g.is_valid())
+                neighbors.push_back(g);
+        }
+        std::sort(neighbors.begin(), neighbors.end());
+        if (std::adjacent_find(neighbors.begin(), neighbors.end()) !=
+                neighbors.end() ||
+            std::binary_search(neighbors.begin(), neighbors.end(), f))
+            return false;
     }
-    set_halfedge(f, baseH); //the last face takes the handle baseH
 
-    set_next_halfedge(baseH, nextH);
-    set_next_halfedge(next_halfedge(nextH), baseH);
+    std::vector<IndexType> corner, first_corner;
+    const IndexType nc = face_corners(*this, corner, first_corner);
+
+    const std::vector<HalfedgeConnectivity> hconn = hconn_.vector();
+    const std::vector<VertexConnectivity> vconn = vconn_.vector();
+    auto hprev = add_prev_halfedge_property();
+    const std::vector<Halfedge> prevs = hprev.vector();
+    remove_halfedge_property(hprev);
+
+    // the edge of corner c joins the face vertex to the end of its
+    // halfedge, spoke(c) points to the face vertex, spoke(c) ^ 1 away
+    auto spoke = [&](IndexType c) { return Halfedge(2 * (ne + c) + 1); };
+
+    detach_connectivity();
+    ++topology_version_;
+    elements_replaced();
+    vprops_.resize(nv + nf);
+    hprops_.resize(0);
+    hprops_.resize(2 * (ne + nc));
+    eprops_.resize(0);
+    eprops_.resize(ne + nc);
+    fprops_.resize(0);
+    fprops_.resize(nc);
+
+    auto set = [&](Halfedge h, IndexType to, Face f, Halfedge prev,
+                   Halfedge next) {
+        HalfedgeConnectivity& conn = hconn_[h];
+        conn.vertex_ = Vertex(to);
+        conn.face_ = f;
+#ifndef PMP_NO_PREV_HALFEDGE
+        conn.prev_halfedge_ = prev;
+#else
+        (void)prev;
+#endif
+        conn.next_halfedge_ = next;
+    };
+    auto away = [](Halfedge h) { return Halfedge(h.idx() ^ 1); };
+
+    // the halfedge i from a to b of face f becomes the triangle (a, c_g,
+    // c_f) if the opposite halfedge has face g, and (a, b, c_f) otherwise
+    parallel_for(0, 2 * ne, [&](size_t i) {
+        const Face f = hconn[i].face_;
+        const IndexType prev = prevs[i].idx();
+        if (!f.is_valid())
+        {
+            set(Halfedge(i), hconn[i].vertex_.idx(), Face(), prevs[i],
+                hconn[i].next_halfedge_);
+            return;
+        }
+
+        const Face q(corner[i]);
+        const Halfedge x(i), z = away(spoke(corner[prev]));
+        const Face g = hconn[i ^ 1].face_;
+        const IndexType a = hconn[prev].vertex_.idx();
+        if (g.is_valid())
+        {
+            const Halfedge y = spoke(corner[i ^ 1]);
+            set(y, nv + g.idx(), q, z, x);
+            set(x, nv + f.idx(), q, y, z);
+        }
+        else
+        {
+            const Halfedge y = spoke(corner[i]);
+            set(x, hconn[i].vertex_.idx(), q, z, y);
+            set(y, nv + f.idx(), q, x, z);
+        }
+        if (g.is_valid())
+            set(z, a, q, x, spoke(corner[i ^ 1]));
+        else
+            set(z, a, q, spoke(corner[i]), x);
+        fconn_[q].halfedge_ = z;
+    });
+
+    // an outgoing halfedge of each vertex, on the boundary if possible
+    parallel_for(0, nv, [&](size_t v) {
+        const Halfedge h = vconn[v].halfedge_;
+        Halfedge out;
+        if (h.is_valid())
+            out = hconn[h.idx()].face_.is_valid()
+                      ? spoke(corner[prevs[h.idx()].idx()])
+                      : h;
+        vconn_[Vertex(v)].halfedge_ = out;
+    });
+    parallel_for(0, nf, [&](size_t f) {
+        vconn_[Vertex(nv + f)].halfedge_ =
+            away(spoke(first_corner[f]));
+    });
 
-    set_face(baseH, f);
+    return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -986,6 +2358,7 @@ void SurfaceMesh::collapse(Halfedge h)
 
 void SurfaceMesh::remove_edge(Halfedge h)
 {
+    detach_connectivity();
     Halfedge hn = next_halfedge(h);
     Halfedge hp = prev_halfedge(h);
 
@@ -1024,9 +2397,9 @@ void SurfaceMesh::remove_edge(Halfedge h)
     set_halfedge(vo, Halfedge());
 
     // delete stuff
-    vdeleted_[vo] = true;
+    mark_deleted(vo);
     ++deleted_vertices_;
-    edeleted_[edge(h)] = true;
+    mark_deleted(edge(h));
     ++deleted_edges_;
     has_garbage_ = true;
 }
@@ -1035,6 +2408,7 @@ void SurfaceMesh::remove_edge(Halfedge h)
 
 void SurfaceMesh::remove_loop(Halfedge h)
 {
+    detach_connectivity();
     Halfedge h0 = h;
     Halfedge h1 = next_halfedge(h0);
 
@@ -1070,10 +2444,10 @@ void SurfaceMesh::remove_loop(Halfedge h)
     // delete stuff
     if (fh.is_valid())
     {
-        fdeleted_[fh] = true;
+        mark_deleted(fh);
         ++deleted_faces_;
     }
-    edeleted_[edge(h)] = true;
+    mark_deleted(edge(h));
     ++deleted_edges_;
     has_garbage_ = true;
 }
@@ -1085,6 +2459,8 @@ void SurfaceMesh::delete_vertex(Vertex v)
     if (is_deleted(v))
         return;
 
+    detach_connectivity();
+
     // collect incident faces
     std::vector<Face> incident_faces;
     incident_faces.reserve(6);
@@ -1099,9 +2475,10 @@ void SurfaceMesh::delete_vertex(Vertex v)
     // mark v as deleted if not yet done by delete_face()
     if (!vdeleted_[v])
     {
-        vdeleted_[v] = true;
+        mark_deleted(v);
         deleted_vertices_++;
         has_garbage_ = true;
+        ++topology_version_;
     }
 }
 
@@ -1112,6 +2489,8 @@ void SurfaceMesh::delete_edge(Edge e)
     if (is_deleted(e))
         return;
 
+    detach_connectivity();
+
     Face f0 = face(halfedge(e, 0));
     Face f1 = face(halfedge(e, 1));
 
@@ -1128,11 +2507,14 @@ void SurfaceMesh::delete_face(Face f)
     if (fdeleted_[f])
         return;
 
+    detach_connectivity();
+
     // mark face deleted
     if (!fdeleted_[f])
     {
-        fdeleted_[f] = true;
+        mark_deleted(f);
         deleted_faces_++;
+        ++topology_version_;
     }
 
     // boundary edges of face f to be deleted
@@ -1189,7 +2571,7 @@ void SurfaceMesh::delete_face(Face f)
             // mark edge deleted
             if (!edeleted_[*delit])
             {
-                edeleted_[*delit] = true;
+                mark_deleted(*delit);
                 deleted_edges_++;
             }
 
@@ -1200,7 +2582,7 @@ void SurfaceMesh::delete_face(Face f)
                 {
                     if (!vdeleted_[v0])
                     {
-                        vdeleted_[v0] = true;
+                        mark_deleted(v0);
                         deleted_vertices_++;
                     }
                 }
@@ -1215,7 +2597,7 @@ void SurfaceMesh::delete_face(Face f)
                 {
                     if (!vdeleted_[v1])
                     {
-                        vdeleted_[v1] = true;
+                        mark_deleted(v1);
                         deleted_vertices_++;
                     }
                 }
@@ -1235,145 +2617,334 @@ void SurfaceMesh::delete_face(Face f)
 
 //-----------------------------------------------------------------------------
 
+namespace {
+
+// Compute the order of the elements that remain after garbage_collection():
+// the deleted elements at the front are replaced by the last remaining ones,
+// such that as few elements as possible are moved. Entry i of map is the new
+// index of element i, or PMP_MAX_INDEX if it is deleted.
+void fill_holes(const std::vector<Flag>& deleted,
+                std::vector<IndexType>& order, std::vector<IndexType>& map)
+{
+    const size_t n = deleted.size();
+    order.clear();
+    map.assign(n, PMP_MAX_INDEX);
+
+    size_t i0 = 0, i1 = n;
+    while (true)
+    {
+        // keep the elements up to the first deleted one
+        while (i0 < i1 && !deleted[i0])
+            order.push_back(IndexType(i0++));
+
+        // and fill it with the last remaining one
+        while (i0 < i1 && deleted[i1 - 1])
+            --i1;
+        if (i0 >= i1)
+            break;
+        order.push_back(IndexType(--i1));
+        ++i0;
+    }
+
+    for (size_t i = 0; i < order.size(); ++i)
+        map[order[i]] = IndexType(i);
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
 void SurfaceMesh::garbage_collection()
 {
-    int i, i0, i1, nV(vertices_size()), nE(edges_size()), nH(halfedges_size()),
-        nF(faces_size());
+    detach_connectivity();
+    ++topology_version_;
+
+    // gather the remaining elements of all properties at once, the
+    // halfedges in pairs along with their edges
+    std::vector<IndexType> order, vmap, emap, fmap;
+    fill_holes(vdeleted_.vector(), order, vmap);
+    vprops_.gather(order);
+    fill_holes(edeleted_.vector(), order, emap);
+    eprops_.gather(order);
+    hprops_.gather(order, 2);
+    fill_holes(fdeleted_.vector(), order, fmap);
+    fprops_.gather(order);
+
+    remap_handles(vmap, emap, fmap);
 
-    Vertex v;
-    Halfedge h;
-    Face f;
-
-    // setup handle mapping
-    VertexProperty<Vertex> vmap =
-        add_vertex_property<Vertex>("v:garbage-collection");
-    HalfedgeProperty<Halfedge> hmap =
-        add_halfedge_property<Halfedge>("h:garbage-collection");
-    FaceProperty<Face> fmap = add_face_property<Face>("f:garbage-collection");
-    for (i = 0; i < nV; ++i)
-        vmap[Vertex(i)] = Vertex(i);
-    for (i = 0; i < nH; ++i)
-        hmap[Halfedge(i)] = Halfedge(i);
-    for (i = 0; i < nF; ++i)
-        fmap[Face(i)] = Face(i);
-
-    // remove deleted vertices
-    if (nV > 0)
-    {
-        i0 = 0;
-        i1 = nV - 1;
-
-        while (1)
-        {
-            // find first deleted and last un-deleted
-            while (!vdeleted_[Vertex(i0)] && i0 < i1)
-                ++i0;
-            while (vdeleted_[Vertex(i1)] && i0 < i1)
-                --i1;
-            if (i0 >= i1)
-                break;
+    vprops_.free_memory();
+    hprops_.free_memory();
+    eprops_.free_memory();
+    fprops_.free_memory();
+
+    deleted_vertices_ = deleted_edges_ = deleted_faces_ = 0;
+    has_garbage_ = false;
+    elements_replaced();
+}
+
+//-----------------------------------------------------------------------------
 
-            // swap
-            vprops_.swap(i0, i1);
-        };
+void SurfaceMesh::remap_handles(const std::vector<IndexType>& vmap,
+                                const std::vector<IndexType>& emap,
+                                const std::vector<IndexType>& fmap)
+{
+    auto hmap = [&](Halfedge h) {
+        return h.is_valid()
+                   ? Halfedge((emap[h.idx() >> 1] << 1) | (h.idx() & 1))
+                   : h;
+    };
+
+    parallel_for(0, vertices_size(), [&](size_t i) {
+        auto& conn = vconn_[Vertex(static_cast<IndexType>(i))];
+        conn.halfedge_ = hmap(conn.halfedge_);
+    });
+
+    parallel_for(0, halfedges_size(), [&](size_t i) {
+        auto& conn = hconn_[Halfedge(static_cast<IndexType>(i))];
+        if (conn.vertex_.is_valid())
+            conn.vertex_ = Vertex(vmap[conn.vertex_.idx()]);
+        conn.next_halfedge_ = hmap(conn.next_halfedge_);
+#ifndef PMP_NO_PREV_HALFEDGE
+        conn.prev_halfedge_ = hmap(conn.prev_halfedge_);
+#endif
+        if (conn.face_.is_valid())
+            conn.face_ = Face(fmap[conn.face_.idx()]);
+    });
+
+    parallel_for(0, faces_size(), [&](size_t i) {
+        auto& conn = fconn_[Face(static_cast<IndexType>(i))];
+        conn.halfedge_ = hmap(conn.halfedge_);
+    });
+}
+
+//-----------------------------------------------------------------------------
 
-        // remember new size
-        nV = vdeleted_[Vertex(i0)] ? i0 : i0 + 1;
+namespace {
+
+// Mark non-deleted elements in keep and compute their new indices in map.
+// Returns the number of remaining elements.
+size_t compaction_map(const std::vector<Flag>& deleted, std::vector<bool>& keep,
+                      std::vector<IndexType>& map)
+{
+    const size_t n = deleted.size();
+    keep.resize(n);
+    map.resize(n);
+
+    IndexType j = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        keep[i] = !deleted[i];
+        map[i] = keep[i] ? j++ : PMP_MAX_INDEX;
     }
+    return j;
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMesh::stable_garbage_collection()
+{
+    detach_connectivity();
+    ++topology_version_;
+
+    // vertices
+    const size_t nV = compaction_map(vdeleted_.vector(), gc_keep_,
+                                     gc_vertex_map_);
+    vprops_.compact(gc_keep_, nV);
+
+    // edges, and halfedges in pairs
+    const size_t nE = compaction_map(edeleted_.vector(), gc_keep_,
+                                     gc_edge_map_);
+    eprops_.compact(gc_keep_, nE);
 
-    // remove deleted edges
-    if (nE > 0)
+    gc_keep_.resize(2 * gc_edge_map_.size());
+    for (size_t i = 0; i < gc_edge_map_.size(); ++i)
+        gc_keep_[2 * i] = gc_keep_[2 * i + 1] =
+            (gc_edge_map_[i] != PMP_MAX_INDEX);
+    hprops_.compact(gc_keep_, 2 * nE);
+
+    // faces
+    const size_t nF = compaction_map(fdeleted_.vector(), gc_keep_,
+                                     gc_face_map_);
+    fprops_.compact(gc_keep_, nF);
+
+    remap_handles(gc_vertex_map_, gc_edge_map_, gc_face_map_);
+
+    deleted_vertices_ = deleted_edges_ = deleted_faces_ = 0;
+    has_garbage_ = false;
+    elements_replaced();
+}
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+// Check that order is a permutation of [0,n) and compute its inverse, i.e.,
+// the new index of each element. Returns false if order is invalid.
+template <class HandleType>
+bool invert_permutation(const std::vector<HandleType>& order, size_t n,
+                        std::vector<IndexType>& new_index)
+{
+    if (order.size() != n)
+        return false;
+
+    new_index.assign(n, PMP_MAX_INDEX);
+    for (size_t i = 0; i < n; ++i)
     {
-        i0 = 0;
-        i1 = nE - 1;
+        const IndexType j = order[i].idx();
+        if (j >= n || new_index[j] != PMP_MAX_INDEX)
+            return false;
+        new_index[j] = IndexType(i);
+    }
+    return true;
+}
 
-        while (1)
-        {
-            // find first deleted and last un-deleted
-            while (!edeleted_[Edge(i0)] && i0 < i1)
-                ++i0;
-            while (edeleted_[Edge(i1)] && i0 < i1)
-                --i1;
-            if (i0 >= i1)
-                break;
+// Move element order[i] to position i in all arrays of props at once. The
+// optional stride applies the same permutation to blocks of elements, e.g.,
+// to the two halfedges of an edge.
+template <class HandleType>
+void apply_permutation(PropertyContainer& props,
+                       const std::vector<HandleType>& order,
+                       size_t stride = 1)
+{
+    std::vector<IndexType> indices(order.size());
+    for (size_t i = 0; i < order.size(); ++i)
+        indices[i] = order[i].idx();
+    props.gather(indices, stride);
+}
 
-            // swap
-            eprops_.swap(i0, i1);
-            hprops_.swap(2 * i0, 2 * i1);
-            hprops_.swap(2 * i0 + 1, 2 * i1 + 1);
-        };
+} // namespace
 
-        // remember new size
-        nE = edeleted_[Edge(i0)] ? i0 : i0 + 1;
-        nH = 2 * nE;
+//-----------------------------------------------------------------------------
+
+void SurfaceMesh::permute_vertices(const std::vector<Vertex>& order)
+{
+    std::vector<IndexType> new_index;
+    if (!invert_permutation(order, vertices_size(), new_index))
+    {
+        std::cerr << "permute_vertices: order is not a permutation of all "
+                     "vertices"
+                  << std::endl;
+        return;
     }
 
-    // remove deleted faces
-    if (nF > 0)
+    detach_connectivity();
+    apply_permutation(vprops_, order);
+
+    for (size_t i = 0; i < halfedges_size(); ++i)
     {
-        i0 = 0;
-        i1 = nF - 1;
+        const Halfedge h(static_cast<IndexType>(i));
+        const Vertex v = to_vertex(h);
+        if (v.is_valid())
+            set_vertex(h, Vertex(new_index[v.idx()]));
+    }
 
-        while (1)
-        {
-            // find 1st deleted and last un-deleted
-            while (!fdeleted_[Face(i0)] && i0 < i1)
-                ++i0;
-            while (fdeleted_[Face(i1)] && i0 < i1)
-                --i1;
-            if (i0 >= i1)
-                break;
+    ++topology_version_;
+    elements_replaced();
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMesh::permute_edges(const std::vector<Edge>& order)
+{
+    std::vector<IndexType> new_index;
+    if (!invert_permutation(order, edges_size(), new_index))
+    {
+        std::cerr << "permute_edges: order is not a permutation of all edges"
+                  << std::endl;
+        return;
+    }
 
-            // swap
-            fprops_.swap(i0, i1);
-        };
+    detach_connectivity();
+    apply_permutation(eprops_, order);
+    apply_permutation(hprops_, order, 2);
 
-        // remember new size
-        nF = fdeleted_[Face(i0)] ? i0 : i0 + 1;
+    auto remap = [&](Halfedge h) {
+        return h.is_valid()
+                   ? Halfedge((new_index[h.idx() >> 1] << 1) | (h.idx() & 1))
+                   : h;
+    };
+
+    for (size_t i = 0; i < vertices_size(); ++i)
+    {
+        const Vertex v(static_cast<IndexType>(i));
+        set_halfedge(v, remap(halfedge(v)));
     }
 
-    // update vertex connectivity
-    for (i = 0; i < nV; ++i)
+    for (size_t i = 0; i < halfedges_size(); ++i)
     {
-        v = Vertex(i);
-        if (!is_isolated(v))
-            set_halfedge(v, hmap[halfedge(v)]);
+        auto& conn = hconn_[Halfedge(static_cast<IndexType>(i))];
+        conn.next_halfedge_ = remap(conn.next_halfedge_);
+#ifndef PMP_NO_PREV_HALFEDGE
+        conn.prev_halfedge_ = remap(conn.prev_halfedge_);
+#endif
     }
 
-    // update halfedge connectivity
-    for (i = 0; i < nH; ++i)
+    for (size_t i = 0; i < faces_size(); ++i)
     {
-        h = Halfedge(i);
-        set_vertex(h, vmap[to_vertex(h)]);
-        set_next_halfedge(h, hmap[next_halfedge(h)]);
-        if (!is_boundary(h))
-            set_face(h, fmap[face(h)]);
+        const Face f(static_cast<IndexType>(i));
+        set_halfedge(f, remap(halfedge(f)));
     }
 
-    // update handles of faces
-    for (i = 0; i < nF; ++i)
+    ++topology_version_;
+    elements_replaced();
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMesh::permute_faces(const std::vector<Face>& order)
+{
+    std::vector<IndexType> new_index;
+    if (!invert_permutation(order, faces_size(), new_index))
     {
-        f = Face(i);
-        set_halfedge(f, hmap[halfedge(f)]);
+        std::cerr << "permute_faces: order is not a permutation of all faces"
+                  << std::endl;
+        return;
     }
 
-    // remove handle maps
-    remove_vertex_property(vmap);
-    remove_halfedge_property(hmap);
-    remove_face_property(fmap);
+    detach_connectivity();
+    apply_permutation(fprops_, order);
 
-    // finally resize arrays
-    vprops_.resize(nV);
-    vprops_.free_memory();
-    hprops_.resize(nH);
-    hprops_.free_memory();
-    eprops_.resize(nE);
-    eprops_.free_memory();
-    fprops_.resize(nF);
-    fprops_.free_memory();
+    for (size_t i = 0; i < halfedges_size(); ++i)
+    {
+        const Halfedge h(static_cast<IndexType>(i));
+        const Face f = face(h);
+        if (f.is_valid())
+            set_face(h, Face(new_index[f.idx()]));
+    }
 
-    deleted_vertices_ = deleted_edges_ = deleted_faces_ = 0;
-    has_garbage_ = false;
+    ++topology_version_;
+    elements_replaced();
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMesh::copy_properties(const SurfaceMesh& src,
+                                  const std::vector<Vertex>& vertices,
+                                  const std::vector<Face>& faces)
+{
+    if (vertices.size() != vertices_size() || faces.size() != faces_size())
+    {
+        std::cerr << "copy_properties: not one element per element of the "
+                     "mesh"
+                  << std::endl;
+        return false;
+    }
+
+    std::vector<IndexType> indices(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i)
+        indices[i] = vertices[i].idx();
+    vprops_.copy_missing(src.vprops_, indices,
+                         {"v:point", "v:connectivity", "v:deleted"});
+
+    indices.resize(faces.size());
+    for (size_t i = 0; i < faces.size(); ++i)
+        indices[i] = faces[i].idx();
+    fprops_.copy_missing(src.fprops_, indices,
+                         {"f:connectivity", "f:deleted"});
+
+    return true;
 }
 
 //=============================================================================
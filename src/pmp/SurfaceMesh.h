@@ -14,16 +14,22 @@
 #include <pmp/Properties.h>
 #include <pmp/BoundingBox.h>
 
+#include <atomic>
+#include <iosfwd>
 #include <map>
+#include <memory>
+#include <utility>
 #include <vector>
 #include <limits>
 #include <numeric>
+#include <type_traits>
 
 //=============================================================================
 
 namespace pmp {
 
 class SurfaceMeshIO;
+class MappedSurfaceMesh;
 
 //=============================================================================
 
@@ -225,9 +231,84 @@ public:
     }
 };
 
+//! \brief A scalar property stored with 8 or 16 bits per element.
+//! \details Wraps a property of type std::uint8_t or std::uint16_t for
+//! handles of type \c Handle, e.g., Vertex. Values in [min, max] are mapped
+//! linearly to the integers of \c T and rounded, values outside of the range
+//! are clamped. This saves memory for large attribute channels like
+//! curvature or quality, whose precision is limited anyway. Usage:
+//! \code
+//! auto curv = mesh.add_vertex_property<std::uint16_t>("v:curv16");
+//! QuantizedProperty<Vertex, std::uint16_t> q(curv, -1, 1);
+//! q.set(v, 0.5);
+//! Scalar c = q[v]; // within q.step() / 2 of 0.5
+//! \endcode
+template <class Handle, class T>
+class QuantizedProperty
+{
+    static_assert(std::is_same<T, std::uint8_t>::value ||
+                      std::is_same<T, std::uint16_t>::value,
+                  "QuantizedProperty requires std::uint8_t or std::uint16_t");
+
+public:
+    //! an invalid property
+    QuantizedProperty() : min_(0), step_(0) {}
+
+    //! wrap property \p p storing values in [\p min, \p max]
+    QuantizedProperty(Property<T> p, Scalar min, Scalar max)
+        : property_(p),
+          min_(min),
+          step_((max - min) / std::numeric_limits<T>::max())
+    {
+    }
+
+    //! is the property valid?
+    operator bool() const { return bool(property_); }
+
+    //! the value of element \p h
+    Scalar operator[](Handle h) const
+    {
+        return min_ + step_ * property_[h.idx()];
+    }
+
+    //! set the value of element \p h to \p s, clamped to [min(), max()]
+    void set(Handle h, Scalar s)
+    {
+        const Scalar t = step_ > 0 ? (s - min_) / step_ : 0;
+        const Scalar n = std::numeric_limits<T>::max();
+        property_[h.idx()] = T(t <= 0 ? 0 : t >= n ? n : t + Scalar(0.5));
+    }
+
+    //! the smallest value that can be stored
+    Scalar min() const { return min_; }
+
+    //! the largest value that can be stored
+    Scalar max() const { return min_ + step_ * std::numeric_limits<T>::max(); }
+
+    //! the difference between consecutive values that can be stored
+    Scalar step() const { return step_; }
+
+    //! the underlying property of integers
+    Property<T>& property() { return property_; }
+
+private:
+    Property<T> property_;
+    Scalar min_;
+    Scalar step_;
+};
+
 //=============================================================================
 
-//! A halfedge data structure for polygonal meshes.
+//! \brief A halfedge data structure for polygonal meshes.
+//! \details Thread safety: const member functions, iterators, circulators,
+//! and reading properties never modify the mesh, not even internal caches.
+//! Any number of threads can therefore query a mesh concurrently, e.g., a
+//! single loaded mesh serving read-only requests, as long as no thread
+//! modifies it. This includes copying the mesh and using it as the source
+//! of assign_shared(). Changing the connectivity, positions, or properties,
+//! and adding or removing properties, requires exclusive access, except for
+//! the concurrent element creation of begin_reservation(). Algorithms taking
+//! a const mesh keep their scratch data outside of it.
 class SurfaceMesh
 {
 public:
@@ -250,6 +331,9 @@ public:
         //! get the vertex the iterator refers to
         Vertex operator*() const { return handle_; }
 
+        //! get the mesh the iterator refers to
+        const SurfaceMesh* mesh() const { return mesh_; }
+
         //! are two iterators equal?
         bool operator==(const VertexIterator& rhs) const
         {
@@ -308,6 +392,9 @@ public:
         //! get the halfedge the iterator refers to
         Halfedge operator*() const { return handle_; }
 
+        //! get the mesh the iterator refers to
+        const SurfaceMesh* mesh() const { return mesh_; }
+
         //! are two iterators equal?
         bool operator==(const HalfedgeIterator& rhs) const
         {
@@ -365,6 +452,9 @@ public:
         //! get the edge the iterator refers to
         Edge operator*() const { return handle_; }
 
+        //! get the mesh the iterator refers to
+        const SurfaceMesh* mesh() const { return mesh_; }
+
         //! are two iterators equal?
         bool operator==(const EdgeIterator& rhs) const
         {
@@ -422,6 +512,9 @@ public:
         //! get the face the iterator refers to
         Face operator*() const { return handle_; }
 
+        //! get the mesh the iterator refers to
+        const SurfaceMesh* mesh() const { return mesh_; }
+
         //! are two iterators equal?
         bool operator==(const FaceIterator& rhs) const
         {
@@ -918,14 +1011,52 @@ public:
 
     //! copy constructor: copies \c rhs to \c *this. performs a deep copy of all
     //! properties.
-    SurfaceMesh(const SurfaceMesh& rhs) { operator=(rhs); }
+    SurfaceMesh(const SurfaceMesh& rhs)
+        : topology_version_(0),
+          shared_connectivity_(false),
+          recycle_elements_(false),
+          free_lists_valid_(false)
+    {
+        operator=(rhs);
+    }
+
+    //! move constructor: takes over all properties of \c rhs, which is left
+    //! as an empty mesh. May throw std::bad_alloc, since the empty mesh
+    //! allocates its standard properties.
+    SurfaceMesh(SurfaceMesh&& rhs)
+        : topology_version_(0),
+          shared_connectivity_(false),
+          recycle_elements_(false),
+          free_lists_valid_(false)
+    {
+        operator=(std::move(rhs));
+    }
 
     //! assign \c rhs to \c *this. performs a deep copy of all properties.
     SurfaceMesh& operator=(const SurfaceMesh& rhs);
 
+    //! move \c rhs to \c *this without copying. \c rhs is left as an empty
+    //! mesh, see SurfaceMesh(SurfaceMesh&&).
+    SurfaceMesh& operator=(SurfaceMesh&& rhs);
+
     //! assign \c rhs to \c *this. does not copy custom properties.
     SurfaceMesh& assign(const SurfaceMesh& rhs);
 
+    //! \brief Copy \c rhs to \c *this, sharing its connectivity.
+    //! \details All properties are deep-copied, except the connectivity and
+    //! the deleted flags, which are shared between both meshes in a
+    //! copy-on-write manner: Both meshes get private copies as soon as one of
+    //! them changes its connectivity. This makes clones that only modify
+    //! vertex positions or other properties cheap.
+    SurfaceMesh& assign_shared(const SurfaceMesh& rhs);
+
+    //! returns whether the connectivity is currently shared with another
+    //! mesh, see assign_shared()
+    bool has_shared_connectivity() const
+    {
+        return hprops_.is_shared("h:connectivity");
+    }
+
     //!@}
     //! \name File IO
     //!@{
@@ -939,13 +1070,22 @@ public:
     //! OFF    | yes   | yes    | a / b   | a      | a / b
     //! OBJ    | yes   | no     | a       | no     | no
     //! STL    | yes   | yes    | no      | no     | no
-    //! PLY    | yes   | yes    | no      | no     | no
+    //! PLY    | yes   | yes    | a / b   | a / b  | a / b
     //! PMP    | no    | yes    | no      | no     | no
+    //! PMPZ   | no    | yes    | b       | no     | no
     //! XYZ    | yes   | no     | a       | no     | no
     //! AGI    | yes   | no     | a       | a      | no
     //!
     //! In addition, the OBJ and PMP formats support reading per-halfedge
-    //! texture coordinates.
+    //! texture coordinates. PLY files also provide the vertex quality as
+    //! \c v:quality and face colors as \c f:color. PMP files also restore further properties, see
+    //! write(). IOFlags::custom_properties selects which of them are loaded,
+    //! the others are not read from disk.
+    //!
+    //! Files compressed with gzip or zstd, e.g., \c mesh.obj.gz or
+    //! \c mesh.stl.zst, are decompressed into memory if pmp was built with
+    //! zlib or zstd. BGZF files and zstd files of several frames are
+    //! decompressed in parallel.
     bool read(const std::string& filename, const IOFlags& flags = IOFlags());
 
     //! \brief Write mesh to file \p filename controlled by \p flags
@@ -957,15 +1097,51 @@ public:
     //! OFF    | yes   | yes    | a       | a      | a
     //! OBJ    | yes   | no     | a       | no     | no
     //! STL    | yes   | yes    | no      | no     | no
-    //! PLY    | yes   | yes    | no      | no     | no
+    //! PLY    | yes   | yes    | a / b   | a / b  | a / b
     //! PMP    | no    | yes    | no      | no     | no
+    //! PMPZ   | no    | yes    | b       | no     | no
+    //! GLB    | no    | yes    | b       | b      | b
     //! XYZ    | yes   | no     | a       | no     | no
     //!
+    //! GLB files contain binary glTF 2.0 for viewers, e.g., in web browsers.
+    //! Faces are triangulated, and the vertices are split at corners with
+    //! different normals or halfedge texture coordinates, like for rendering
+    //! by SurfaceMeshGL. Normals are taken from \c v:normal if
+    //! IOFlags::use_vertex_normals is set, or computed as corner normals for
+    //! IOFlags::crease_angle otherwise.
+    //!
+    //! PMPZ is a compressed format for vertex positions, vertex normals, and
+    //! faces. Positions and normals are quantized to
+    //! IOFlags::quantization_bits bits (at most 16 for normals) or stored
+    //! losslessly, and the order of vertices and faces is not preserved.
+    //!
     //! In addition, the OBJ and PMP formats support writing per-halfedge
-    //! texture coordinates.
+    //! texture coordinates. PLY files can also store the vertex quality
+    //! and face colors, see IOFlags. PMP files also store all further properties
+    //! whose values are \c bool, \c int, <tt>unsigned int</tt>, \c float,
+    //! \c double, 2D or 3D float or double vectors, or element handles,
+    //! together with their names, element kinds, and types.
     bool write(const std::string& filename,
                const IOFlags& flags = IOFlags()) const;
 
+    //! \brief Read mesh from the \p size bytes at \p data.
+    //! \details \p format is the file extension that determines the file
+    //! type, e.g., \c "obj" or \c "ply.gz", see read().
+    bool read(const char* data, size_t size, const std::string& format,
+              const IOFlags& flags = IOFlags());
+
+    //! read mesh from stream \p is in \p format, see read()
+    bool read(std::istream& is, const std::string& format,
+              const IOFlags& flags = IOFlags());
+
+    //! write mesh to \p data in \p format, see write()
+    bool write(std::vector<char>& data, const std::string& format,
+               const IOFlags& flags = IOFlags()) const;
+
+    //! write mesh to stream \p os in \p format, see write()
+    bool write(std::ostream& os, const std::string& format,
+               const IOFlags& flags = IOFlags()) const;
+
     //!@}
     //! \name Add new elements by hand
     //!@{
@@ -985,6 +1161,30 @@ public:
     //! \sa add_triangle, add_face
     Face add_quad(Vertex v0, Vertex v1, Vertex v2, Vertex v3);
 
+    //! \brief Add many faces given by vertex indices at once.
+    //! \details Face \c i consists of the next \c face_sizes[i] entries of
+    //! \p indices. If \p face_sizes is empty, all faces are triangles. If
+    //! the mesh has no edges yet, the connectivity is built in bulk by
+    //! sorting the edges, which is much faster than calling add_face() for
+    //! each face. Otherwise, or if the input contains complex edges or
+    //! vertices, the faces are added one by one using add_face(), which
+    //! reports and skips faces that cannot be added. Faces with invalid or
+    //! repeated vertex indices are reported and skipped. If all faces are
+    //! added, the i-th face of the input becomes Face(i).
+    //! \return whether all faces were added
+    bool add_faces(const std::vector<IndexType>& indices,
+                   const std::vector<IndexType>& face_sizes =
+                       std::vector<IndexType>());
+
+    //! \brief Replace the mesh by the given vertex positions and faces.
+    //! \details Clears the mesh, adds a vertex for each entry of
+    //! \p positions, and adds the faces using add_faces().
+    //! \return whether all faces were added
+    bool build_from_indices(const std::vector<Point>& positions,
+                            const std::vector<IndexType>& indices,
+                            const std::vector<IndexType>& face_sizes =
+                                std::vector<IndexType>());
+
     //!@}
     //! \name Memory Management
     //!@{
@@ -1019,15 +1219,145 @@ public:
     //! clear mesh: remove all vertices, edges, faces
     void clear();
 
+    //! \brief Remove all elements and the non-standard properties, but keep
+    //! the allocated memory.
+    //! \details Unlike clear(), the property arrays of the standard
+    //! properties keep their capacity and their handles stay valid. The
+    //! removed properties are recycled if begin_property_recycling() is
+    //! active. Re-using a mesh this way avoids the allocations of
+    //! constructing a new one, e.g., for many small meshes, see
+    //! SurfaceMeshPool. Behaves like clear() if the connectivity is shared,
+    //! see assign_shared().
+    void reset();
+
     //! remove unused memory from vectors
     void free_memory();
 
-    //! reserve memory (mainly used in file readers)
+    //! \brief Reserve memory for \p nvertices vertices, \p nedges edges,
+    //! and \p nfaces faces.
+    //! \details Algorithms that create elements call this with the total
+    //! they expect to need, e.g., vertices_size() plus the number of edges
+    //! to split. If the reserved memory does not suffice, it grows by at
+    //! least growth_factor(), so repeated calls with slowly increasing
+    //! counts do not reallocate the property arrays each time.
     void reserve(size_t nvertices, size_t nedges, size_t nfaces);
 
+    //! \brief Set the factor by which reserved memory grows.
+    //! \details Applies to all element kinds. The default of 2 trades
+    //! memory for fewer reallocations, values closer to 1 waste less memory
+    //! on large meshes. Must be greater than 1.
+    void set_growth_factor(float factor);
+
+    //! the factor by which reserved memory grows, see set_growth_factor()
+    float growth_factor() const { return vprops_.growth_factor(); }
+
+    //! \brief Re-use the slots of deleted elements for new ones.
+    //! \details If enabled, new_vertex(), new_edge(), and new_face(), and
+    //! hence add_vertex(), add_face(), split(), and the like, take the most
+    //! recently deleted element of their kind, if any, instead of growing
+    //! the property arrays. All properties of a re-used element are reset to
+    //! their default values. Operators that interleave collapses and splits
+    //! thus keep the arrays at a constant size without calling
+    //! garbage_collection(). Note that handles of deleted elements may refer
+    //! to new elements afterwards, and that iterating over the elements
+    //! while creating new ones may visit them. Disabled by default.
+    void set_element_recycling(bool b);
+
+    //! whether deleted elements are re-used, see set_element_recycling()
+    bool element_recycling() const { return recycle_elements_; }
+
+    //! \brief Reserve elements to be created concurrently by several
+    //! threads.
+    //! \details Appends \p nvertices vertices, \p nedges edges, and \p
+    //! nfaces faces, which are marked as deleted until they are allocated.
+    //! Until end_reservation(), all new elements are taken from these blocks
+    //! by atomic counters instead of growing the property arrays. Hence
+    //! add_vertex() and operators that only create elements, like split()
+    //! and insert_vertex(), can run concurrently as long as the threads
+    //! modify disjoint regions, i.e., the modified faces and their vertices
+    //! are not shared. In the meantime, properties must not be added or
+    //! removed, elements must not be deleted, and add_face() must not be
+    //! called. The counts like n_vertices() and topology_version() do not
+    //! include the new elements before end_reservation(), and the indices of
+    //! the new elements depend on the order in which the threads allocate
+    //! them. Returns false and does nothing if the indices would exceed the
+    //! index type.
+    //! \sa ElementReservation
+    bool begin_reservation(size_t nvertices, size_t nedges, size_t nfaces);
+
+    //! \brief End the reservation started by begin_reservation().
+    //! \details Removes the reserved elements that were not allocated.
+    void end_reservation();
+
     //! remove deleted elements
     void garbage_collection();
 
+    //! \brief Remove deleted elements, preserving the order of the others.
+    //! \details Unlike garbage_collection(), which fills gaps by swapping in
+    //! elements from the end, each property array is compacted in a single
+    //! linear pass. Scratch buffers are kept in the mesh and reused by
+    //! subsequent calls, and the property arrays keep their capacity; call
+    //! free_memory() to release both. Afterwards, vertex_index_map(),
+    //! edge_index_map(), and face_index_map() provide the new index of each
+    //! old element, such that external arrays can be remapped.
+    void stable_garbage_collection();
+
+    //! \brief Returns the vertex index map of the last
+    //! stable_garbage_collection().
+    //! \details Entry \c i is the new index of the vertex that had index
+    //! \c i before, or PMP_MAX_INDEX if that vertex was removed.
+    const std::vector<IndexType>& vertex_index_map() const
+    {
+        return gc_vertex_map_;
+    }
+
+    //! \brief Returns the edge index map of the last
+    //! stable_garbage_collection().
+    //! \details Halfedge \c h is mapped to \c 2*map[h/2]+h%2.
+    //! \sa vertex_index_map()
+    const std::vector<IndexType>& edge_index_map() const
+    {
+        return gc_edge_map_;
+    }
+
+    //! \brief Returns the face index map of the last
+    //! stable_garbage_collection().
+    //! \sa vertex_index_map()
+    const std::vector<IndexType>& face_index_map() const
+    {
+        return gc_face_map_;
+    }
+
+    //! \brief Reorder the vertices such that \p order[i] becomes vertex \c i.
+    //! \details \p order has to contain each vertex (including deleted
+    //! ones) exactly once. All vertex properties are permuted and the
+    //! connectivity is updated accordingly. Vertex handles held outside the
+    //! mesh are invalidated.
+    //! \sa SurfaceReordering
+    void permute_vertices(const std::vector<Vertex>& order);
+
+    //! \brief Reorder the edges such that \p order[i] becomes edge \c i.
+    //! \details Works like permute_vertices(). The two halfedges of each
+    //! edge move together with the edge.
+    void permute_edges(const std::vector<Edge>& order);
+
+    //! \brief Reorder the faces such that \p order[i] becomes face \c i.
+    //! \details Works like permute_vertices().
+    void permute_faces(const std::vector<Face>& order);
+
+    //! \brief Copy the vertex and face properties of \p src that this mesh
+    //! does not have.
+    //! \details Vertex \c i receives the values of vertex \p vertices[i] of
+    //! \p src and face \c i those of face \p faces[i], e.g., to carry the
+    //! properties over to a mesh extracted from \p src. The values are copied
+    //! in bulk per property. Connectivity, positions, and deleted flags are
+    //! not copied.
+    //! \return false if the lists do not have one element per vertex and
+    //! face of this mesh
+    bool copy_properties(const SurfaceMesh& src,
+                         const std::vector<Vertex>& vertices,
+                         const std::vector<Face>& faces);
+
     //! returns whether vertex \c v is deleted
     //! \sa garbage_collection()
     bool is_deleted(Vertex v) const { return vdeleted_[v]; }
@@ -1058,6 +1388,80 @@ public:
     //! returns whether the face \p f is valid.
     bool is_valid(Face f) const { return f.idx() < faces_size(); }
 
+    //! \brief Returns a counter that changes whenever the connectivity changes.
+    //! \details The counter is incremented by all functions that add,
+    //! delete, or re-link elements, including the low-level setters and
+    //! garbage_collection(). Changing vertex positions or other properties
+    //! does not affect it. Use it to detect outdated connectivity caches.
+    //! Between begin_reservation() and end_reservation(), the changes are
+    //! counted once by end_reservation().
+    unsigned long topology_version() const { return topology_version_; }
+
+    //!@}
+    //! \name Change journal
+    //!@{
+
+    //! \brief The elements changed while a journal is recorded.
+    //! \sa begin_journal()
+    struct ChangeJournal
+    {
+        //! the kinds of changes, combined by bitwise or per element
+        enum Change
+        {
+            Created = 1,  //!< allocated
+            Deleted = 2,  //!< marked as deleted
+            Modified = 4, //!< connectivity of or around the element changed
+            Moved = 8     //!< position set by set_position()
+        };
+
+        //! the changed vertices, each listed once with its changes
+        std::vector<std::pair<Vertex, unsigned char>> vertices;
+
+        //! the changed edges, each listed once with its changes
+        std::vector<std::pair<Edge, unsigned char>> edges;
+
+        //! the changed faces, each listed once with its changes
+        std::vector<std::pair<Face, unsigned char>> faces;
+
+        //! \brief Whether all elements were renumbered or replaced.
+        //! \details Set by garbage collection, permutations, clear(),
+        //! assignments, and bulk construction, which also empty the lists.
+        //! Everything derived from the mesh has to be recomputed then.
+        bool reset = false;
+    };
+
+    //! \brief Start recording the changed elements.
+    //! \details Until end_journal(), the low-level connectivity setters,
+    //! the allocation and deletion of elements, and set_position() record
+    //! the affected elements in journal(). Hence all operators like
+    //! collapse(), split(), flip(), and insert_edge() are covered. A vertex
+    //! is modified if a halfedge pointing to it or its outgoing halfedge
+    //! changes, and an edge or a face if one of its halfedges changes.
+    //! Writing through position() or the "v:point" property is not
+    //! recorded. Recording is not thread-safe and cannot be combined with
+    //! begin_reservation(). The operators of the library that change the
+    //! connectivity from several threads, like triangulate(), do so one
+    //! element after the other while a journal is recorded. Consumers like
+    //! normal or buffer caches update the listed elements and call
+    //! clear_journal().
+    void begin_journal();
+
+    //! stop recording and discard the journal
+    void end_journal();
+
+    //! whether a journal is recorded
+    bool has_journal() const { return journal_ != nullptr; }
+
+    //! the journal recorded since begin_journal() or clear_journal()
+    const ChangeJournal& journal() const
+    {
+        assert(journal_);
+        return journal_->changes;
+    }
+
+    //! empty the journal and continue recording
+    void clear_journal();
+
     //!@}
     //! \name Low-level connectivity
     //!@{
@@ -1067,7 +1471,14 @@ public:
     Halfedge halfedge(Vertex v) const { return vconn_[v].halfedge_; }
 
     //! set the outgoing halfedge of vertex \c v to \c h
-    void set_halfedge(Vertex v, Halfedge h) { vconn_[v].halfedge_ = h; }
+    void set_halfedge(Vertex v, Halfedge h)
+    {
+        detach_connectivity();
+        vconn_[v].halfedge_ = h;
+        connectivity_changed();
+        if (journal_)
+            record(v, ChangeJournal::Modified);
+    }
 
     //! returns whether \c v is a boundary vertex
     bool is_boundary(Vertex v) const
@@ -1105,13 +1516,30 @@ public:
     }
 
     //! sets the vertex the halfedge \c h points to to \c v
-    inline void set_vertex(Halfedge h, Vertex v) { hconn_[h].vertex_ = v; }
+    inline void set_vertex(Halfedge h, Vertex v)
+    {
+        detach_connectivity();
+        if (journal_)
+            record_halfedge(h, v);
+        hconn_[h].vertex_ = v;
+        connectivity_changed();
+    }
 
     //! returns the face incident to halfedge \c h
     Face face(Halfedge h) const { return hconn_[h].face_; }
 
     //! sets the incident face to halfedge \c h to \c f
-    void set_face(Halfedge h, Face f) { hconn_[h].face_ = f; }
+    void set_face(Halfedge h, Face f)
+    {
+        detach_connectivity();
+        if (journal_)
+        {
+            record_halfedge(h, Vertex());
+            record(f, ChangeJournal::Modified);
+        }
+        hconn_[h].face_ = f;
+        connectivity_changed();
+    }
 
     //! returns the next halfedge within the incident face
     inline Halfedge next_halfedge(Halfedge h) const
@@ -1122,23 +1550,63 @@ public:
     //! sets the next halfedge of \c h within the face to \c nh
     inline void set_next_halfedge(Halfedge h, Halfedge nh)
     {
+        detach_connectivity();
+        if (journal_)
+            record_halfedge(h, Vertex());
         hconn_[h].next_halfedge_ = nh;
+#ifndef PMP_NO_PREV_HALFEDGE
         hconn_[nh].prev_halfedge_ = h;
+#endif
+        connectivity_changed();
     }
 
     //! sets the previous halfedge of \c h and the next halfedge of \c ph to \c nh
     inline void set_prev_halfedge(Halfedge h, Halfedge ph)
     {
+        detach_connectivity();
+        if (journal_)
+            record_halfedge(ph, Vertex());
+#ifndef PMP_NO_PREV_HALFEDGE
         hconn_[h].prev_halfedge_ = ph;
+#endif
         hconn_[ph].next_halfedge_ = h;
+        connectivity_changed();
     }
 
-    //! returns the previous halfedge within the incident face
+    //! \brief returns the previous halfedge within the incident face
+    //! \details If the library is built with \c PMP_NO_PREV_HALFEDGE, the
+    //! previous halfedges are not stored. They are found by walking around
+    //! the face of \c h instead, or around the start vertex of \c h for a
+    //! boundary halfedge, which takes a few steps for triangles and quads.
+    //! Use add_prev_halfedge_property() to look up many of them.
     inline Halfedge prev_halfedge(Halfedge h) const
     {
+#ifdef PMP_NO_PREV_HALFEDGE
+        if (!face(h).is_valid())
+        {
+            // rotate clockwise through the incoming halfedges
+            Halfedge p = opposite_halfedge(h);
+            while (next_halfedge(p) != h)
+                p = opposite_halfedge(next_halfedge(p));
+            return p;
+        }
+        Halfedge p = h;
+        for (Halfedge n = next_halfedge(h); n != h; n = next_halfedge(n))
+            p = n;
+        return p;
+#else
         return hconn_[h].prev_halfedge_;
+#endif
     }
 
+    //! \brief Store the previous halfedge of each halfedge in a property.
+    //! \details Finds all previous halfedges in one pass over the next
+    //! halfedges, for algorithms that need many of them when the library is
+    //! built with \c PMP_NO_PREV_HALFEDGE. The property is not updated by
+    //! topological operations, remove it after use.
+    HalfedgeProperty<Halfedge>
+    add_prev_halfedge_property(const std::string& name = "h:prev");
+
     //! returns the opposite halfedge of \c h
     inline Halfedge opposite_halfedge(Halfedge h) const
     {
@@ -1200,7 +1668,14 @@ public:
     Halfedge halfedge(Face f) const { return fconn_[f].halfedge_; }
 
     //! sets the halfedge of face \c f to \c h
-    void set_halfedge(Face f, Halfedge h) { fconn_[f].halfedge_ = h; }
+    void set_halfedge(Face f, Halfedge h)
+    {
+        detach_connectivity();
+        fconn_[f].halfedge_ = h;
+        connectivity_changed();
+        if (journal_)
+            record(f, ChangeJournal::Modified);
+    }
 
     //! returns whether \c f is a boundary face, i.e., it one of its edges is a boundary edge.
     bool is_boundary(Face f) const
@@ -1239,6 +1714,14 @@ public:
         return ObjectProperty<T>(oprops_.get<T>(name));
     }
 
+    //! get the object property of type \c T identified by \c key. takes
+    //! constant time, see PropertyKey.
+    template <class T>
+    ObjectProperty<T> get_object_property(const PropertyKey<T>& key) const
+    {
+        return ObjectProperty<T>(oprops_.get(key));
+    }
+
     //! if a object property of type \c T with name \c name exists, it is
     //! returned.  otherwise this property is added (with default value \c t)
     template <class T>
@@ -1247,6 +1730,15 @@ public:
         return ObjectProperty<T>(oprops_.get_or_add<T>(name, t));
     }
 
+    //! if a object property identified by \c key exists, it is returned.
+    //! otherwise this property is added (with default value \c t)
+    template <class T>
+    ObjectProperty<T> object_property(const PropertyKey<T>& key,
+                                      const T t = T())
+    {
+        return ObjectProperty<T>(oprops_.get_or_add(key, t));
+    }
+
     //! remove the object property \c p
     template <class T>
     void remove_object_property(ObjectProperty<T>& p)
@@ -1288,6 +1780,14 @@ public:
         return VertexProperty<T>(vprops_.get<T>(name));
     }
 
+    //! get the vertex property of type \c T identified by \c key. takes
+    //! constant time, see PropertyKey.
+    template <class T>
+    VertexProperty<T> get_vertex_property(const PropertyKey<T>& key) const
+    {
+        return VertexProperty<T>(vprops_.get(key));
+    }
+
     //! if a vertex property of type \c T with name \c name exists, it is
     //! returned. otherwise this property is added (with default value \c
     //! t)
@@ -1297,6 +1797,15 @@ public:
         return VertexProperty<T>(vprops_.get_or_add<T>(name, t));
     }
 
+    //! if a vertex property identified by \c key exists, it is returned.
+    //! otherwise this property is added (with default value \c t)
+    template <class T>
+    VertexProperty<T> vertex_property(const PropertyKey<T>& key,
+                                      const T t = T())
+    {
+        return VertexProperty<T>(vprops_.get_or_add(key, t));
+    }
+
     //! remove the vertex property \c p
     template <class T>
     void remove_vertex_property(VertexProperty<T>& p)
@@ -1341,6 +1850,14 @@ public:
         return HalfedgeProperty<T>(hprops_.get<T>(name));
     }
 
+    //! get the halfedge property of type \c T identified by \c key. takes
+    //! constant time, see PropertyKey.
+    template <class T>
+    HalfedgeProperty<T> get_halfedge_property(const PropertyKey<T>& key) const
+    {
+        return HalfedgeProperty<T>(hprops_.get(key));
+    }
+
     //! get the edge property named \c name of type \c T. returns an
     //! invalid VertexProperty if the property does not exist or if the
     //! type does not match.
@@ -1350,6 +1867,14 @@ public:
         return EdgeProperty<T>(eprops_.get<T>(name));
     }
 
+    //! get the edge property of type \c T identified by \c key. takes
+    //! constant time, see PropertyKey.
+    template <class T>
+    EdgeProperty<T> get_edge_property(const PropertyKey<T>& key) const
+    {
+        return EdgeProperty<T>(eprops_.get(key));
+    }
+
     //! if a halfedge property of type \c T with name \c name exists, it is
     //! returned.  otherwise this property is added (with default value \c
     //! t)
@@ -1360,6 +1885,15 @@ public:
         return HalfedgeProperty<T>(hprops_.get_or_add<T>(name, t));
     }
 
+    //! if a halfedge property identified by \c key exists, it is returned.
+    //! otherwise this property is added (with default value \c t)
+    template <class T>
+    HalfedgeProperty<T> halfedge_property(const PropertyKey<T>& key,
+                                          const T t = T())
+    {
+        return HalfedgeProperty<T>(hprops_.get_or_add(key, t));
+    }
+
     //! if an edge property of type \c T with name \c name exists, it is
     //! returned.  otherwise this property is added (with default value \c
     //! t)
@@ -1369,6 +1903,14 @@ public:
         return EdgeProperty<T>(eprops_.get_or_add<T>(name, t));
     }
 
+    //! if a edge property identified by \c key exists, it is returned.
+    //! otherwise this property is added (with default value \c t)
+    template <class T>
+    EdgeProperty<T> edge_property(const PropertyKey<T>& key, const T t = T())
+    {
+        return EdgeProperty<T>(eprops_.get_or_add(key, t));
+    }
+
     //! remove the halfedge property \c p
     template <class T>
     void remove_halfedge_property(HalfedgeProperty<T>& p)
@@ -1457,6 +1999,14 @@ public:
         return FaceProperty<T>(fprops_.get<T>(name));
     }
 
+    //! get the face property of type \c T identified by \c key. takes
+    //! constant time, see PropertyKey.
+    template <class T>
+    FaceProperty<T> get_face_property(const PropertyKey<T>& key) const
+    {
+        return FaceProperty<T>(fprops_.get(key));
+    }
+
     //! if a face property of type \c T with name \c name exists, it is
     //! returned.  otherwise this property is added (with default value \c t)
     template <class T>
@@ -1465,6 +2015,14 @@ public:
         return FaceProperty<T>(fprops_.get_or_add<T>(name, t));
     }
 
+    //! if a face property identified by \c key exists, it is returned.
+    //! otherwise this property is added (with default value \c t)
+    template <class T>
+    FaceProperty<T> face_property(const PropertyKey<T>& key, const T t = T())
+    {
+        return FaceProperty<T>(fprops_.get_or_add(key, t));
+    }
+
     //! remove the face property \c p
     template <class T>
     void remove_face_property(FaceProperty<T>& p)
@@ -1493,9 +2051,70 @@ public:
         return fprops_.properties();
     }
 
-    //! prints the names of all properties
+    //! \brief The memory of a mesh in bytes, see memory_stats().
+    //! \details Counts the property arrays of the mesh, including its
+    //! connectivity and the arrays of shared properties.
+    struct MemoryStats
+    {
+        std::vector<PropertyMemory> object_properties;
+        std::vector<PropertyMemory> vertex_properties;
+        std::vector<PropertyMemory> halfedge_properties;
+        std::vector<PropertyMemory> edge_properties;
+        std::vector<PropertyMemory> face_properties;
+
+        //! bytes used by the connectivity properties
+        size_t connectivity;
+
+        //! bytes used by deleted elements in all properties, freed by
+        //! garbage_collection()
+        size_t deleted;
+
+        //! bytes allocated for the helper data of add_face() and
+        //! stable_garbage_collection()
+        size_t helpers;
+
+        //! bytes used by all properties that are not recycled
+        size_t size() const;
+
+        //! bytes allocated for all properties and helper data
+        size_t capacity() const;
+    };
+
+    //! \brief Compute the memory used by the properties of the mesh.
+    //! \details Takes time linear in the number of properties, not in the
+    //! number of elements.
+    MemoryStats memory_stats() const;
+
+    //! prints the names and memory of all properties
     void property_stats() const;
 
+    //! \brief Start recycling the storage of removed properties.
+    //! \details Until the matching end_property_recycling(), removed
+    //! properties are not freed but re-used by properties of the same type
+    //! added later on. This avoids repeated allocations for temporary
+    //! properties that are added and removed in a loop. Calls can be nested.
+    //! \sa PropertyRecyclingScope
+    void begin_property_recycling()
+    {
+        oprops_.begin_recycling();
+        vprops_.begin_recycling();
+        hprops_.begin_recycling();
+        eprops_.begin_recycling();
+        fprops_.begin_recycling();
+    }
+
+    //! \brief End recycling of removed properties.
+    //! \details When the outermost recycling scope ends, the storage of
+    //! all recycled properties is freed.
+    void end_property_recycling()
+    {
+        oprops_.end_recycling();
+        vprops_.end_recycling();
+        hprops_.end_recycling();
+        eprops_.end_recycling();
+        fprops_.end_recycling();
+    }
+
     //!@}
     //! \name Iterators and circulators
     //!@{
@@ -1643,13 +2262,55 @@ public:
     //! each face, and therefore is not very efficient.
     bool is_quad_mesh() const;
 
-    //! triangulate the entire mesh, by calling triangulate(Face) for each face.
+    //! \brief How triangulate() splits polygons into triangles.
+    enum TriangulationMethod
+    {
+        //! connect the start vertex of the face's halfedge to all others
+        Fan,
+        //! repeatedly cut off the corner with the shortest diagonal, e.g.,
+        //! split non-planar quads along their shorter diagonal
+        ShortestDiagonal
+    };
+
+    //! \brief Triangulate the entire mesh.
+    //! \details Counts the new edges and faces first, allocates all of
+    //! them at once, and triangulates the faces in parallel. The new
+    //! elements get the same indices as by calling triangulate(Face) for
+    //! each face in order.
     //! \sa triangulate(Face)
-    void triangulate();
+    void triangulate(TriangulationMethod method = Fan);
 
     //! triangulate the face \c f.
     //! \sa triangulate()
-    void triangulate(Face f);
+    void triangulate(Face f, TriangulationMethod method = Fan);
+
+    //! \brief Split all edges and faces at once, as by a subdivision step.
+    //! \details Each edge e is split at the new vertex n_vertices() + e
+    //! into the edges 2 e and 2 e + 1. If \p quads is set, each face f is
+    //! split into one quad per corner around the new vertex n_vertices() +
+    //! n_edges() + f, otherwise each triangle is split into its three
+    //! corner triangles and a middle one. The corners are numbered face by
+    //! face, starting at halfedge(f), and corner c becomes face c. The
+    //! middle triangle of face f becomes face n + f, with n the total
+    //! number of corners. The connectivity is computed by index arithmetic, in
+    //! parallel. The old vertices keep their properties, all other
+    //! elements get default property values. Deleted elements are removed
+    //! first by garbage_collection(), the indices refer to the collected
+    //! mesh. A recorded journal is reset.
+    //! \return false, without changes, if \p quads is not set and the mesh
+    //! has faces other than triangles
+    //! \sa SurfaceSubdivision::set_bulk_refinement()
+    bool subdivide_connectivity(bool quads);
+
+    //! \brief Split all faces at once, as by a sqrt3 subdivision step.
+    //! \details Inserts the new vertex n_vertices() + f into each face f,
+    //! connects it to the corners, and flips the old interior edges, such
+    //! that each interior edge yields two triangles. The old vertices keep
+    //! their properties, all other elements get default property values,
+    //! see subdivide_connectivity().
+    //! \return false, without changes, if two faces share more than one
+    //! edge, since the flipped edges would not be unique
+    bool sqrt3_connectivity();
 
     //! returns whether collapsing the halfedge \c v0v1 is topologically legal.
     //! \attention This function is only valid for triangle meshes.
@@ -1744,11 +2405,22 @@ public:
     //! position of a vertex
     Point& position(Vertex v) { return vpoint_[v]; }
 
+    //! set the position of a vertex, recorded in the journal as moved
+    void set_position(Vertex v, const Point& p)
+    {
+        vpoint_[v] = p;
+        if (journal_)
+            record(v, ChangeJournal::Moved);
+    }
+
     //! vector of point positions, re-implemented from \c GeometryObject
     std::vector<Point>& positions() { return vpoint_.vector(); }
 
+    //! vector of point positions
+    const std::vector<Point>& positions() const { return vpoint_.vector(); }
+
     //! compute the bounding box of the object
-    BoundingBox bounds()
+    BoundingBox bounds() const
     {
         BoundingBox bb;
         for (auto p : positions())
@@ -1782,7 +2454,9 @@ private:
         Face face_;              //!< face incident to halfedge
         Vertex vertex_;          //!< vertex the halfedge points to
         Halfedge next_halfedge_; //!< next halfedge
+#ifndef PMP_NO_PREV_HALFEDGE
         Halfedge prev_halfedge_; //!< previous halfedge
+#endif
     };
 
     //! This type stores the face connectivity
@@ -1799,6 +2473,14 @@ private:
     //! allocate a new vertex, resize vertex properties accordingly.
     Vertex new_vertex()
     {
+        if (reservation_)
+            return new_reserved_vertex();
+        if (recycle_elements_ && deleted_vertices_)
+        {
+            const Vertex v = recycle_vertex();
+            if (v.is_valid())
+                return v;
+        }
         if (vertices_size() == PMP_MAX_INDEX - 1)
         {
             std::cerr
@@ -1806,7 +2488,11 @@ private:
                 << std::endl;
             return Vertex();
         }
+        detach_connectivity();
         vprops_.push_back();
+        connectivity_changed();
+        if (journal_)
+            record(Vertex(vertices_size() - 1), ChangeJournal::Created);
         return Vertex(vertices_size() - 1);
     }
 
@@ -1815,19 +2501,34 @@ private:
     {
         assert(start != end);
 
-        if (halfedges_size() == PMP_MAX_INDEX - 1)
+        if (reservation_)
+            return new_reserved_edge(start, end);
+
+        Halfedge h0;
+        if (recycle_elements_ && deleted_edges_)
+            h0 = recycle_edge();
+
+        if (!h0.is_valid())
         {
-            std::cerr << "new_edge: cannot allocate edge, max. index reached"
-                      << std::endl;
-            return Halfedge();
+            if (halfedges_size() == PMP_MAX_INDEX - 1)
+            {
+                std::cerr
+                    << "new_edge: cannot allocate edge, max. index reached"
+                    << std::endl;
+                return Halfedge();
+            }
+
+            detach_connectivity();
+            eprops_.push_back();
+            hprops_.push_back();
+            hprops_.push_back();
+            h0 = Halfedge(halfedges_size() - 2);
         }
 
-        eprops_.push_back();
-        hprops_.push_back();
-        hprops_.push_back();
+        Halfedge h1 = opposite_halfedge(h0);
 
-        Halfedge h0(halfedges_size() - 2);
-        Halfedge h1(halfedges_size() - 1);
+        if (journal_)
+            record(edge(h0), ChangeJournal::Created);
 
         set_vertex(h0, end);
         set_vertex(h1, start);
@@ -1838,6 +2539,14 @@ private:
     //! allocate a new face, resize face properties accordingly.
     Face new_face()
     {
+        if (reservation_)
+            return new_reserved_face();
+        if (recycle_elements_ && deleted_faces_)
+        {
+            const Face f = recycle_face();
+            if (f.is_valid())
+                return f;
+        }
         if (faces_size() == PMP_MAX_INDEX - 1)
         {
             std::cerr << "new_face: cannot allocate face, max. index reached"
@@ -1845,10 +2554,49 @@ private:
             return Face();
         }
 
+        detach_connectivity();
         fprops_.push_back();
+        connectivity_changed();
+        if (journal_)
+            record(Face(faces_size() - 1), ChangeJournal::Created);
         return Face(faces_size() - 1);
     }
 
+    //! triangulate \c f by the new edges and faces starting at
+    //! \c first_edge and \c first_face, which have to be allocated already
+    void triangulate(Face f, TriangulationMethod method, IndexType first_edge,
+                     IndexType first_face);
+
+    //! allocate a vertex reserved by begin_reservation(), thread-safe
+    Vertex new_reserved_vertex();
+
+    //! allocate an edge reserved by begin_reservation(), thread-safe
+    Halfedge new_reserved_edge(Vertex start, Vertex end);
+
+    //! allocate a face reserved by begin_reservation(), thread-safe
+    Face new_reserved_face();
+
+    // count a change of the connectivity. not counted while elements are
+    // created concurrently, end_reservation() counts them at once.
+    void connectivity_changed()
+    {
+        if (!reservation_)
+            ++topology_version_;
+    }
+
+    //! re-use a deleted vertex, returns an invalid handle if there is none
+    Vertex recycle_vertex();
+
+    //! re-use a deleted edge, returns its first halfedge or an invalid
+    //! handle if there is none
+    Halfedge recycle_edge();
+
+    //! re-use a deleted face, returns an invalid handle if there is none
+    Face recycle_face();
+
+    //! collect the deleted elements to be re-used
+    void rebuild_free_lists();
+
     //!@}
     //! \name Helper functions
     //!@{
@@ -1866,11 +2614,81 @@ private:
     //! are there any deleted entities?
     inline bool has_garbage() const { return has_garbage_; }
 
+    //! make sure the connectivity is not shared before changing it
+    inline void detach_connectivity()
+    {
+        if (shared_connectivity_)
+            unshare_connectivity();
+    }
+
+    //! replace shared connectivity by a private copy
+    void unshare_connectivity();
+
+    //! add change \c c of vertex \c v to the journal
+    void record(Vertex v, unsigned char c);
+
+    //! add change \c c of edge \c e to the journal
+    void record(Edge e, unsigned char c);
+
+    //! add change \c c of face \c f to the journal
+    void record(Face f, unsigned char c);
+
+    //! record the elements around halfedge \c h and the vertex \c v it
+    //! will point to as modified
+    void record_halfedge(Halfedge h, Vertex v);
+
+    //! reset the journal and the free lists, since all elements were
+    //! renumbered or replaced
+    void elements_replaced();
+
+    //! map the handles of the connectivity to the new element indices,
+    //! given per old element, after removing the deleted elements
+    void remap_handles(const std::vector<IndexType>& vmap,
+                       const std::vector<IndexType>& emap,
+                       const std::vector<IndexType>& fmap);
+
+    //! mark vertex \c v as deleted, without updating the counts
+    void mark_deleted(Vertex v)
+    {
+        vdeleted_[v] = true;
+        if (journal_)
+            record(v, ChangeJournal::Deleted);
+        if (recycle_elements_ && free_lists_valid_)
+            free_vertices_.push_back(v);
+    }
+
+    //! mark edge \c e as deleted, without updating the counts
+    void mark_deleted(Edge e)
+    {
+        edeleted_[e] = true;
+        if (journal_)
+            record(e, ChangeJournal::Deleted);
+        if (recycle_elements_ && free_lists_valid_)
+            free_edges_.push_back(e);
+    }
+
+    //! mark face \c f as deleted, without updating the counts
+    void mark_deleted(Face f)
+    {
+        fdeleted_[f] = true;
+        if (journal_)
+            record(f, ChangeJournal::Deleted);
+        if (recycle_elements_ && free_lists_valid_)
+            free_faces_.push_back(f);
+    }
+
+    //! Helper for add_faces(): build the connectivity of a mesh without
+    //! edges. Returns false (and leaves the mesh unchanged) for
+    //! non-manifold input.
+    bool build_connectivity(const std::vector<IndexType>& corners,
+                            const std::vector<IndexType>& face_start);
+
     //!@}
     //! \name Private members
     //!@{
 
     friend SurfaceMeshIO;
+    friend MappedSurfaceMesh;
 
     // property containers for each entity type and object
     PropertyContainer oprops_;
@@ -1888,9 +2706,9 @@ private:
     FaceProperty<FaceConnectivity> fconn_;
 
     // markers for deleted entities
-    VertexProperty<bool> vdeleted_;
-    EdgeProperty<bool> edeleted_;
-    FaceProperty<bool> fdeleted_;
+    VertexProperty<Flag> vdeleted_;
+    EdgeProperty<Flag> edeleted_;
+    FaceProperty<Flag> fdeleted_;
 
     // numbers of deleted entities
     IndexType deleted_vertices_;
@@ -1900,6 +2718,56 @@ private:
     // indicate garbage present
     bool has_garbage_;
 
+    // incremented on each change of the connectivity
+    unsigned long topology_version_;
+
+    // connectivity might be shared with another mesh, see assign_shared().
+    // set on the source of const assign_shared(), hence atomic.
+    mutable std::atomic<bool> shared_connectivity_;
+
+    // the blocks of elements reserved by begin_reservation()
+    struct Reservation
+    {
+        Reservation(IndexType v, IndexType e, IndexType f)
+            : next_vertex(v),
+              next_edge(e),
+              next_face(f),
+              begin_vertex(v),
+              begin_edge(e),
+              begin_face(f)
+        {
+        }
+
+        std::atomic<IndexType> next_vertex, next_edge, next_face;
+        IndexType begin_vertex, begin_edge, begin_face;
+        IndexType end_vertex, end_edge, end_face;
+        bool had_garbage; // has_garbage_ before the reservation
+    };
+    std::unique_ptr<Reservation> reservation_;
+
+    // the journal of begin_journal() and the position of each recorded
+    // element in its list plus one, zero if not listed yet
+    struct Journal
+    {
+        ChangeJournal changes;
+        std::vector<IndexType> vertex_slot, edge_slot, face_slot;
+    };
+    std::unique_ptr<Journal> journal_;
+
+    // the deleted elements re-used by set_element_recycling(), most
+    // recently deleted last, rebuilt from the deleted flags if not valid
+    bool recycle_elements_;
+    bool free_lists_valid_;
+    std::vector<Vertex> free_vertices_;
+    std::vector<Edge> free_edges_;
+    std::vector<Face> free_faces_;
+
+    // scratch data and index maps of stable_garbage_collection()
+    std::vector<bool> gc_keep_;
+    std::vector<IndexType> gc_vertex_map_;
+    std::vector<IndexType> gc_edge_map_;
+    std::vector<IndexType> gc_face_map_;
+
     // helper data for add_face()
     typedef std::pair<Halfedge, Halfedge> NextCacheEntry;
     typedef std::vector<NextCacheEntry> NextCache;
@@ -1912,6 +2780,73 @@ private:
     //!@}
 };
 
+//! \brief Recycle removed properties of a mesh within a scope.
+//! \details Calls SurfaceMesh::begin_property_recycling() on construction
+//! and SurfaceMesh::end_property_recycling() on destruction. Algorithms use
+//! it to serve their temporary properties from the storage of earlier ones.
+class PropertyRecyclingScope
+{
+public:
+    //! start recycling properties of \p mesh
+    PropertyRecyclingScope(SurfaceMesh& mesh) : mesh_(mesh)
+    {
+        mesh_.begin_property_recycling();
+    }
+
+    //! end recycling, frees the recycled storage
+    ~PropertyRecyclingScope() { mesh_.end_property_recycling(); }
+
+    PropertyRecyclingScope(const PropertyRecyclingScope&) = delete;
+    PropertyRecyclingScope& operator=(const PropertyRecyclingScope&) = delete;
+
+private:
+    SurfaceMesh& mesh_;
+};
+
+//! \brief Reserve elements of a mesh for concurrent creation within a scope.
+//! \details Calls SurfaceMesh::begin_reservation() on construction and
+//! SurfaceMesh::end_reservation() on destruction. Usage:
+//! \code
+//! // edges whose incident triangles do not share vertices
+//! std::vector<Edge> edges = ...;
+//! {
+//!     // a split creates a vertex, up to three edges, and two faces
+//!     const size_t n = edges.size();
+//!     ElementReservation reservation(mesh, n, 3 * n, 2 * n);
+//!     parallel_for(size_t(0), n, [&](size_t i) {
+//!         mesh.split(edges[i], mesh.add_vertex(midpoint(edges[i])));
+//!     });
+//! }
+//! \endcode
+class ElementReservation
+{
+public:
+    //! reserve \p nvertices vertices, \p nedges edges, and \p nfaces faces
+    //! of \p mesh
+    ElementReservation(SurfaceMesh& mesh, size_t nvertices, size_t nedges,
+                       size_t nfaces)
+        : mesh_(mesh), ok_(mesh.begin_reservation(nvertices, nedges, nfaces))
+    {
+    }
+
+    //! end the reservation, removes the unused elements
+    ~ElementReservation()
+    {
+        if (ok_)
+            mesh_.end_reservation();
+    }
+
+    //! did the reservation succeed?
+    operator bool() const { return ok_; }
+
+    ElementReservation(const ElementReservation&) = delete;
+    ElementReservation& operator=(const ElementReservation&) = delete;
+
+private:
+    SurfaceMesh& mesh_;
+    bool ok_;
+};
+
 //=============================================================================
 //!@}
 //=============================================================================
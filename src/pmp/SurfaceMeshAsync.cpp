@@ -0,0 +1,155 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/SurfaceMeshAsync.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+namespace {
+
+// the background thread running all jobs in order
+class IOThread
+{
+public:
+    static IOThread& instance()
+    {
+        static IOThread thread;
+        return thread;
+    }
+
+    void submit(std::function<void()> task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.push_back(std::move(task));
+        }
+        condition_.notify_one();
+    }
+
+    // completes all pending tasks
+    ~IOThread()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        condition_.notify_one();
+        thread_.join();
+    }
+
+private:
+    IOThread() : stop_(false), thread_([this]() { run(); }) {}
+
+    void run()
+    {
+        for (;;)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                condition_.wait(lock,
+                                [this]() { return stop_ || !tasks_.empty(); });
+                if (tasks_.empty())
+                    return;
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+            task();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::deque<std::function<void()>> tasks_;
+    bool stop_;
+    std::thread thread_; // started last
+};
+
+} // namespace
+
+//=============================================================================
+
+bool SurfaceMeshIOJob::is_ready() const
+{
+    return !result_.valid() || result_.wait_for(std::chrono::seconds(0)) ==
+                                   std::future_status::ready;
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMeshIOJob::wait()
+{
+    if (result_.valid())
+        ok_ = result_.get();
+    if (cancelled_)
+    {
+        mesh_.clear();
+        ok_ = false;
+    }
+    return ok_;
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMeshIOJob::submit(const std::shared_ptr<SurfaceMeshIOJob>& job,
+                              bool write)
+{
+    // std::function needs a copyable task
+    auto task = std::make_shared<std::packaged_task<bool()>>([job, write]() {
+        if (job->cancelled_)
+            return false;
+        if (!write)
+            return job->mesh_.read(job->filename_, job->flags_);
+
+        const bool ok = job->mesh_.write(job->filename_, job->flags_);
+        job->mesh_.clear();
+        return ok;
+    });
+    job->result_ = task->get_future();
+    IOThread::instance().submit([task]() { (*task)(); });
+}
+
+//=============================================================================
+
+std::shared_ptr<SurfaceMeshIOJob> read_async(const std::string& filename,
+                                             const IOFlags& flags)
+{
+    std::shared_ptr<SurfaceMeshIOJob> job(
+        new SurfaceMeshIOJob(filename, flags));
+    SurfaceMeshIOJob::submit(job, false);
+    return job;
+}
+
+//-----------------------------------------------------------------------------
+
+std::shared_ptr<SurfaceMeshIOJob> write_async(const SurfaceMesh& mesh,
+                                              const std::string& filename,
+                                              const IOFlags& flags)
+{
+    std::shared_ptr<SurfaceMeshIOJob> job(
+        new SurfaceMeshIOJob(filename, flags));
+    job->mesh_ = mesh;
+    SurfaceMeshIOJob::submit(job, true);
+    return job;
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -0,0 +1,102 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <pmp/SurfaceMesh.h>
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <string>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \addtogroup core core
+//!@{
+
+//! \brief A mesh file read or written in the background.
+//! \details Created by read_async() and write_async(). All jobs run one
+//! after another on a single background I/O thread in the order they were
+//! created, so a file written by write_async() can be read by a subsequent
+//! read_async(). Jobs still pending at program exit are completed. Usage:
+//! \code
+//! auto job = read_async("large.ply");
+//! while (!job->is_ready())
+//!     do_something_else();
+//! if (job->wait())
+//!     mesh = std::move(job->mesh());
+//! \endcode
+class SurfaceMeshIOJob
+{
+public:
+    //! whether the job has finished, does not block
+    bool is_ready() const;
+
+    //! \brief Wait until the job has finished.
+    //! \return whether reading or writing succeeded and the job was not
+    //! cancelled
+    bool wait();
+
+    //! \brief Cancel the job.
+    //! \details A job that has not started yet is skipped, and the mesh of a
+    //! read is discarded. A write that has already started is completed.
+    void cancel() { cancelled_ = true; }
+
+    //! whether cancel() was called
+    bool is_cancelled() const { return cancelled_; }
+
+    //! the mesh read by read_async(), valid after wait() returned true
+    SurfaceMesh& mesh() { return mesh_; }
+
+private:
+    friend std::shared_ptr<SurfaceMeshIOJob> read_async(const std::string&,
+                                                        const IOFlags&);
+    friend std::shared_ptr<SurfaceMeshIOJob>
+    write_async(const SurfaceMesh&, const std::string&, const IOFlags&);
+
+    SurfaceMeshIOJob(const std::string& filename, const IOFlags& flags)
+        : filename_(filename), flags_(flags), cancelled_(false), ok_(false)
+    {
+    }
+
+    // queue the job with the read or write task
+    static void submit(const std::shared_ptr<SurfaceMeshIOJob>& job,
+                       bool write);
+
+    std::string filename_;
+    IOFlags flags_;
+    SurfaceMesh mesh_; // the mesh read, or the snapshot to write
+    std::atomic<bool> cancelled_;
+    std::future<bool> result_;
+    bool ok_;
+};
+
+//! \brief Read the mesh file \p filename in the background.
+//! \details Like SurfaceMesh::read(), see SurfaceMeshIOJob.
+std::shared_ptr<SurfaceMeshIOJob> read_async(const std::string& filename,
+                                             const IOFlags& flags = IOFlags());
+
+//! \brief Write \p mesh to the file \p filename in the background.
+//! \details Like SurfaceMesh::write(), see SurfaceMeshIOJob. The mesh is
+//! copied before this function returns, so it can be modified or destroyed
+//! while the copy is written.
+std::shared_ptr<SurfaceMeshIOJob> write_async(const SurfaceMesh& mesh,
+                                              const std::string& filename,
+                                              const IOFlags& flags = IOFlags());
+
+//!@}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -0,0 +1,820 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+// The compressed .pmpz format of SurfaceMeshIO.
+//
+// Faces are stored in breadth-first order over the face adjacency, and
+// vertices are numbered in the order they first appear in a face. Each
+// corner is coded as 0 for a new vertex, or as the distance of its index to
+// the next new vertex index, which is small due to the traversal order.
+// Positions of new vertices follow their face. They are quantized to a grid
+// over the bounding box, or kept as they are, and predicted by parallelogram
+// prediction across a decoded edge if possible, or by a decoded vertex of
+// the face otherwise. All symbols are coded as variable-length integers by
+// an adaptive binary range coder.
+
+#include <pmp/SurfaceMeshIO.h>
+#include <pmp/BoundingBox.h>
+#include <pmp/Profiler.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+namespace {
+
+const char pmpz_magic[4] = {'p', 'm', 'z', '\xff'};
+const unsigned char pmpz_version = 1;
+
+// header flags
+const unsigned char pmpz_normals = 1;
+const unsigned char pmpz_triangles = 2;
+
+// the header of .pmpz files
+struct PmpzHeader
+{
+    char magic[4];
+    unsigned char version;
+    unsigned char flags;
+    unsigned char bits;         // bits per quantized coordinate, 0 = lossless
+    unsigned char scalar_bytes; // sizeof(Scalar) for lossless coordinates
+    uint64_t n_vertices;
+    uint64_t n_faces;
+    uint64_t payload_size;
+    double origin[3];
+    double scale;
+};
+
+// bits of the probabilities of the binary range coder
+const int probability_bits = 11;
+const uint16_t probability_half = 1 << (probability_bits - 1);
+const int adaptation_shift = 5;
+const uint32_t range_top = 1 << 24;
+
+class RangeEncoder
+{
+public:
+    explicit RangeEncoder(std::vector<unsigned char>& out)
+        : out_(out), low_(0), range_(0xffffffff), cache_(0), cache_size_(1)
+    {
+    }
+
+    void encode(uint16_t& p, int bit)
+    {
+        const uint32_t bound = (range_ >> probability_bits) * p;
+        if (!bit)
+        {
+            range_ = bound;
+            p += ((1 << probability_bits) - p) >> adaptation_shift;
+        }
+        else
+        {
+            low_ += bound;
+            range_ -= bound;
+            p -= p >> adaptation_shift;
+        }
+        while (range_ < range_top)
+        {
+            range_ <<= 8;
+            shift_low();
+        }
+    }
+
+    void flush()
+    {
+        for (int i = 0; i < 5; ++i)
+            shift_low();
+    }
+
+private:
+    void shift_low()
+    {
+        if (uint32_t(low_) < 0xff000000u || (low_ >> 32) != 0)
+        {
+            const unsigned char carry = (unsigned char)(low_ >> 32);
+            unsigned char byte = cache_;
+            do
+            {
+                out_.push_back((unsigned char)(byte + carry));
+                byte = 0xff;
+            } while (--cache_size_);
+            cache_ = (unsigned char)(low_ >> 24);
+        }
+        ++cache_size_;
+        low_ = (low_ & 0x00ffffff) << 8;
+    }
+
+    std::vector<unsigned char>& out_;
+    uint64_t low_;
+    uint32_t range_;
+    unsigned char cache_;
+    uint64_t cache_size_;
+};
+
+class RangeDecoder
+{
+public:
+    RangeDecoder(const unsigned char* begin, const unsigned char* end)
+        : p_(begin), end_(end), range_(0xffffffff), code_(0)
+    {
+        for (int i = 0; i < 5; ++i)
+            code_ = (code_ << 8) | next();
+    }
+
+    int decode(uint16_t& p)
+    {
+        const uint32_t bound = (range_ >> probability_bits) * p;
+        int bit;
+        if (code_ < bound)
+        {
+            range_ = bound;
+            p += ((1 << probability_bits) - p) >> adaptation_shift;
+            bit = 0;
+        }
+        else
+        {
+            code_ -= bound;
+            range_ -= bound;
+            p -= p >> adaptation_shift;
+            bit = 1;
+        }
+        while (range_ < range_top)
+        {
+            range_ <<= 8;
+            code_ = (code_ << 8) | next();
+        }
+        return bit;
+    }
+
+    // whether the decoder read beyond the end of the data
+    bool overrun() const { return p_ > end_ + 5; }
+
+private:
+    uint32_t next() { return p_ < end_ ? *p_++ : (++p_, 0); }
+
+    const unsigned char* p_;
+    const unsigned char* end_;
+    uint32_t range_;
+    uint32_t code_;
+};
+
+// adaptive probabilities of the bits of a byte, coded as a binary tree
+struct ByteModel
+{
+    ByteModel() { std::fill(p, p + 256, probability_half); }
+    uint16_t p[256];
+};
+
+// adaptive model of variable-length integers, with a separate model for the
+// first bytes
+struct VarintModel
+{
+    ByteModel bytes[3];
+};
+
+void encode_varint(RangeEncoder& encoder, VarintModel& model, uint64_t x)
+{
+    for (int k = 0;; ++k)
+    {
+        const unsigned int byte = (x & 0x7f) | (x > 0x7f ? 0x80 : 0);
+        ByteModel& m = model.bytes[std::min(k, 2)];
+        unsigned int node = 1;
+        for (int i = 7; i >= 0; --i)
+        {
+            const int bit = (byte >> i) & 1;
+            encoder.encode(m.p[node], bit);
+            node = 2 * node + bit;
+        }
+        x >>= 7;
+        if (!(byte & 0x80))
+            break;
+    }
+}
+
+uint64_t decode_varint(RangeDecoder& decoder, VarintModel& model)
+{
+    uint64_t x = 0;
+    for (int k = 0; k < 10; ++k)
+    {
+        ByteModel& m = model.bytes[std::min(k, 2)];
+        unsigned int node = 1;
+        for (int i = 0; i < 8; ++i)
+            node = 2 * node + decoder.decode(m.p[node]);
+        const unsigned int byte = node & 0xff;
+        x |= uint64_t(byte & 0x7f) << (7 * k);
+        if (!(byte & 0x80))
+            break;
+    }
+    return x;
+}
+
+inline uint64_t zigzag(int64_t x)
+{
+    return (uint64_t(x) << 1) ^ uint64_t(x >> 63);
+}
+
+inline int64_t unzigzag(uint64_t x)
+{
+    return int64_t(x >> 1) ^ -int64_t(x & 1);
+}
+
+inline uint64_t scalar_bits(Scalar x)
+{
+    uint64_t b = 0;
+    memcpy(&b, &x, sizeof(x));
+    return b;
+}
+
+inline Scalar bits_scalar(uint64_t b)
+{
+    Scalar x;
+    memcpy(&x, &b, sizeof(x));
+    return x;
+}
+
+// octahedral mapping of unit vectors to [-1,1]^2
+vec2 octahedral(Normal n)
+{
+    const Scalar l1 = std::fabs(n[0]) + std::fabs(n[1]) + std::fabs(n[2]);
+    if (l1 == 0)
+        return vec2(0, 0);
+    n /= l1;
+    if (n[2] < 0)
+    {
+        const Scalar x = n[0], y = n[1];
+        n[0] = (1 - std::fabs(y)) * (x < 0 ? -1 : 1);
+        n[1] = (1 - std::fabs(x)) * (y < 0 ? -1 : 1);
+    }
+    return vec2(n[0], n[1]);
+}
+
+Normal from_octahedral(Scalar u, Scalar v)
+{
+    Normal n(u, v, 1 - std::fabs(u) - std::fabs(v));
+    if (n[2] < 0)
+    {
+        n[0] = (1 - std::fabs(v)) * (u < 0 ? -1 : 1);
+        n[1] = (1 - std::fabs(u)) * (v < 0 ? -1 : 1);
+    }
+    const Scalar l = norm(n);
+    return l > 0 ? n / l : n;
+}
+
+// all adaptive models of the format, used by encoder and decoder alike
+struct PmpzModels
+{
+    VarintModel face_sizes;
+    VarintModel corners;
+    VarintModel coordinates[3];
+    VarintModel normals[3];
+    VarintModel n_isolated;
+};
+
+// the geometry coding state shared by encoder and decoder. positions are
+// given as integer codes, which are the quantized coordinates, or the bit
+// patterns of the coordinates for lossless coding.
+class PmpzGeometry
+{
+public:
+    PmpzGeometry(const PmpzHeader& header)
+        : bits_(header.bits), scale_(header.scale)
+    {
+        for (int i = 0; i < 3; ++i)
+            origin_[i] = header.origin[i];
+    }
+
+    bool lossless() const { return bits_ == 0; }
+
+    // integer codes of p
+    void quantize(const Point& p, int64_t code[3]) const
+    {
+        const int64_t max_code = (int64_t(1) << bits_) - 1;
+        for (int i = 0; i < 3; ++i)
+        {
+            if (lossless())
+                code[i] = int64_t(scalar_bits(p[i]));
+            else
+            {
+                const double c =
+                    std::floor((double(p[i]) - origin_[i]) * scale_ + 0.5);
+                code[i] = std::max(int64_t(0),
+                                   std::min(max_code, int64_t(c)));
+            }
+        }
+    }
+
+    // add a decoded vertex given by its codes
+    void add(const int64_t code[3])
+    {
+        Point p;
+        for (int i = 0; i < 3; ++i)
+        {
+            codes_.push_back(code[i]);
+            p[i] = lossless() ? bits_scalar(uint64_t(code[i]))
+                              : Scalar(origin_[i] + double(code[i]) / scale_);
+        }
+        points_.push_back(p);
+    }
+
+    const std::vector<Point>& points() const { return points_; }
+
+    // prediction from decoded vertices: a + b - c, or a if b is invalid
+    struct Prediction
+    {
+        IndexType a, b, c;
+    };
+
+    uint64_t encode_symbol(int i, int64_t code, const Prediction& p) const
+    {
+        if (lossless())
+            return uint64_t(code) ^ scalar_bits(predict_point(i, p));
+        return zigzag(code - predict_code(i, p));
+    }
+
+    int64_t decode_symbol(int i, uint64_t symbol, const Prediction& p) const
+    {
+        if (lossless())
+            return int64_t(symbol ^ scalar_bits(predict_point(i, p)));
+        return unzigzag(symbol) + predict_code(i, p);
+    }
+
+private:
+    int64_t predict_code(int i, const Prediction& p) const
+    {
+        if (p.a == PMP_MAX_INDEX)
+            return 0;
+        if (p.b == PMP_MAX_INDEX)
+            return codes_[3 * p.a + i];
+        return codes_[3 * p.a + i] + codes_[3 * p.b + i] - codes_[3 * p.c + i];
+    }
+
+    Scalar predict_point(int i, const Prediction& p) const
+    {
+        if (p.a == PMP_MAX_INDEX)
+            return 0;
+        if (p.b == PMP_MAX_INDEX)
+            return points_[p.a][i];
+        return points_[p.a][i] + points_[p.b][i] - points_[p.c][i];
+    }
+
+    unsigned int bits_;
+    double origin_[3];
+    double scale_;
+    std::vector<int64_t> codes_;
+    std::vector<Point> points_;
+};
+
+// maps directed edges of decoded triangles to their opposite vertex
+class OppositeVertices
+{
+public:
+    void add_triangle(IndexType v0, IndexType v1, IndexType v2)
+    {
+        map_[key(v0, v1)] = v2;
+        map_[key(v1, v2)] = v0;
+        map_[key(v2, v0)] = v1;
+    }
+
+    // the vertex opposite to the edge from v0 to v1, or PMP_MAX_INDEX
+    IndexType find(IndexType v0, IndexType v1) const
+    {
+        auto it = map_.find(key(v0, v1));
+        return it == map_.end() ? PMP_MAX_INDEX : it->second;
+    }
+
+private:
+    // keys may collide for 2^32 or more vertices, which only affects the
+    // prediction, since encoder and decoder see the same collisions
+    static uint64_t key(IndexType v0, IndexType v1)
+    {
+        return (uint64_t(v0) << 32) | uint64_t(v1);
+    }
+
+    std::unordered_map<uint64_t, IndexType> map_;
+};
+
+// choose the prediction of the new vertex at corner i of a face, where
+// decoded[j] tells whether corner j is decoded
+PmpzGeometry::Prediction predict(const std::vector<IndexType>& corners,
+                                 const std::vector<bool>& decoded, size_t i,
+                                 const OppositeVertices& opposite,
+                                 IndexType last)
+{
+    PmpzGeometry::Prediction p = {last, PMP_MAX_INDEX, PMP_MAX_INDEX};
+    const size_t n = corners.size();
+
+    // parallelogram across the edge a->b of the triangle a, b, v
+    if (n == 3 && decoded[(i + 1) % 3] && decoded[(i + 2) % 3])
+    {
+        const IndexType a = corners[(i + 1) % 3];
+        const IndexType b = corners[(i + 2) % 3];
+        const IndexType c = opposite.find(b, a);
+        if (c != PMP_MAX_INDEX)
+        {
+            p.a = a;
+            p.b = b;
+            p.c = c;
+            return p;
+        }
+    }
+
+    // otherwise a decoded vertex of the face
+    for (size_t j = 1; j < n; ++j)
+        if (decoded[(i + n - j) % n])
+        {
+            p.a = corners[(i + n - j) % n];
+            break;
+        }
+    return p;
+}
+
+// every binary decision of the decoder consumes more than 1/64 bit, since
+// the adapted probabilities stay below 2017/2048. a varint takes at least 8
+// decisions, so a payload of n bytes, including the bytes read beyond its end
+// until overrun(), holds fewer than 64 * (n + 10) varints.
+size_t max_varints(size_t payload_size)
+{
+    return 64 * (payload_size + 10);
+}
+
+// read n bytes in chunks, such that a corrupt n does not allocate more than
+// the file holds
+bool read_payload(FILE* in, uint64_t n, std::vector<unsigned char>& payload)
+{
+    const uint64_t chunk = 1 << 20;
+    while (payload.size() < n)
+    {
+        const size_t offset = payload.size();
+        const size_t size = size_t(std::min(chunk, n - offset));
+        payload.resize(offset + size);
+        if (fread(payload.data() + offset, 1, size, in) != size)
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+//=============================================================================
+
+bool SurfaceMeshIO::write_pmpz(const SurfaceMesh& mesh)
+{
+    auto normals = mesh.get_vertex_property<Normal>("v:normal");
+    const bool has_normals = normals && flags_.use_vertex_normals;
+
+    PmpzHeader header;
+    memcpy(header.magic, pmpz_magic, 4);
+    header.version = pmpz_version;
+    header.flags = has_normals ? pmpz_normals : 0;
+    header.bits = (unsigned char)std::min(flags_.quantization_bits, 30u);
+    header.scalar_bytes = sizeof(Scalar);
+    header.n_vertices = mesh.n_vertices();
+    header.n_faces = mesh.n_faces();
+
+    bool triangles = true;
+    for (auto f : mesh.faces())
+        if (mesh.valence(f) != 3)
+        {
+            triangles = false;
+            break;
+        }
+    if (triangles)
+        header.flags |= pmpz_triangles;
+
+    // quantization grid over the bounding box
+    BoundingBox bb;
+    for (auto v : mesh.vertices())
+        bb += mesh.position(v);
+    double extent = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+        header.origin[i] = bb.is_empty() ? 0.0 : double(bb.min()[i]);
+        if (!bb.is_empty())
+            extent = std::max(extent, double(bb.max()[i] - bb.min()[i]));
+    }
+    header.scale = header.bits && extent > 0
+                       ? double((uint64_t(1) << header.bits) - 1) / extent
+                       : 1.0;
+
+    std::vector<unsigned char> payload;
+    RangeEncoder encoder(payload);
+    PmpzModels models;
+    PmpzGeometry geometry(header);
+    OppositeVertices opposite;
+
+    // normals are quantized to the same number of bits, at most 16
+    const unsigned int normal_bits = std::min(16u, (unsigned int)header.bits);
+    const Scalar normal_scale = Scalar((1 << normal_bits) - 1) / 2;
+    int64_t last_normal[3] = {0, 0, 0};
+    auto encode_normal = [&](Vertex v) {
+        int64_t code[3] = {0, 0, 0};
+        const Normal& n = normals[v];
+        if (normal_bits)
+        {
+            const vec2 o = octahedral(n);
+            code[0] = int64_t(std::floor((o[0] + 1) * normal_scale + 0.5));
+            code[1] = int64_t(std::floor((o[1] + 1) * normal_scale + 0.5));
+        }
+        for (int i = 0; i < 3; ++i)
+        {
+            if (!normal_bits)
+                code[i] = int64_t(scalar_bits(n[i]));
+            else if (i == 2)
+                break;
+            encode_varint(encoder, models.normals[i],
+                          normal_bits ? zigzag(code[i] - last_normal[i])
+                                      : uint64_t(code[i] ^ last_normal[i]));
+            last_normal[i] = code[i];
+        }
+    };
+
+    std::vector<IndexType> id(mesh.vertices_size(), PMP_MAX_INDEX);
+    IndexType next_id = 0;
+
+    // traverse faces breadth-first
+    std::vector<bool> visited(mesh.faces_size(), false);
+    std::vector<Face> queue;
+    queue.reserve(mesh.n_faces());
+    std::vector<Vertex> face_vertices;
+    std::vector<IndexType> corners;
+    std::vector<bool> decoded;
+
+    for (auto seed : mesh.faces())
+    {
+        if (visited[seed.idx()])
+            continue;
+        visited[seed.idx()] = true;
+        queue.clear();
+        queue.push_back(seed);
+
+        for (size_t q = 0; q < queue.size(); ++q)
+        {
+            const Face f = queue[q];
+            for (auto h : mesh.halfedges(f))
+            {
+                const Face g = mesh.face(mesh.opposite_halfedge(h));
+                if (g.is_valid() && !visited[g.idx()])
+                {
+                    visited[g.idx()] = true;
+                    queue.push_back(g);
+                }
+            }
+
+            // connectivity
+            face_vertices.clear();
+            for (auto v : mesh.vertices(f))
+                face_vertices.push_back(v);
+            const size_t n = face_vertices.size();
+            if (!triangles)
+                encode_varint(encoder, models.face_sizes, n - 3);
+
+            corners.resize(n);
+            decoded.assign(n, true);
+            for (size_t i = 0; i < n; ++i)
+            {
+                const Vertex v = face_vertices[i];
+                if (id[v.idx()] == PMP_MAX_INDEX)
+                {
+                    id[v.idx()] = next_id++;
+                    decoded[i] = false;
+                    encode_varint(encoder, models.corners, 0);
+                }
+                else
+                    encode_varint(encoder, models.corners,
+                                  next_id - id[v.idx()]);
+                corners[i] = id[v.idx()];
+            }
+
+            // geometry of the new vertices
+            for (size_t i = 0; i < n; ++i)
+            {
+                if (decoded[i])
+                    continue;
+                const auto p = predict(corners, decoded, i, opposite,
+                                       corners[i] ? corners[i] - 1
+                                                  : PMP_MAX_INDEX);
+                int64_t code[3];
+                geometry.quantize(mesh.position(face_vertices[i]), code);
+                for (int k = 0; k < 3; ++k)
+                    encode_varint(encoder, models.coordinates[k],
+                                  geometry.encode_symbol(k, code[k], p));
+                geometry.add(code);
+                if (has_normals)
+                    encode_normal(face_vertices[i]);
+                decoded[i] = true;
+            }
+
+            if (n == 3)
+                opposite.add_triangle(corners[0], corners[1], corners[2]);
+        }
+    }
+
+    // isolated vertices are predicted by the previous vertex
+    encode_varint(encoder, models.n_isolated, mesh.n_vertices() - next_id);
+    for (auto v : mesh.vertices())
+    {
+        if (id[v.idx()] != PMP_MAX_INDEX)
+            continue;
+        const PmpzGeometry::Prediction p = {
+            next_id ? next_id - 1 : PMP_MAX_INDEX, PMP_MAX_INDEX,
+            PMP_MAX_INDEX};
+        id[v.idx()] = next_id++;
+        int64_t code[3];
+        geometry.quantize(mesh.position(v), code);
+        for (int k = 0; k < 3; ++k)
+            encode_varint(encoder, models.coordinates[k],
+                          geometry.encode_symbol(k, code[k], p));
+        geometry.add(code);
+        if (has_normals)
+            encode_normal(v);
+    }
+
+    encoder.flush();
+    header.payload_size = payload.size();
+
+    FILE* out = open_output("wb");
+    if (!out)
+        return false;
+    const bool ok =
+        fwrite(&header, sizeof(header), 1, out) == 1 &&
+        fwrite(payload.data(), 1, payload.size(), out) == payload.size();
+    fclose(out);
+    return ok;
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMeshIO::read_pmpz(SurfaceMesh& mesh)
+{
+    PMP_PROFILE_ZONE("SurfaceMeshIO::read_pmpz");
+
+    FILE* in = open_input("rb");
+    if (!in)
+        return false;
+
+    PmpzHeader header;
+    std::vector<unsigned char> payload;
+    bool ok = fread(&header, sizeof(header), 1, in) == 1 &&
+              memcmp(header.magic, pmpz_magic, 4) == 0 &&
+              header.version == pmpz_version && header.bits <= 30 &&
+              (header.bits || header.scalar_bytes == sizeof(Scalar));
+    if (ok)
+        ok = read_payload(in, header.payload_size, payload);
+    fclose(in);
+    if (!ok)
+    {
+        std::cerr << "read_pmpz: cannot read " << filename_ << std::endl;
+        return false;
+    }
+
+    // each face codes three corners and each vertex three coordinates at
+    // least, counts beyond that are corrupt
+    const size_t max_elements = max_varints(payload.size()) / 3;
+    if (header.n_vertices > max_elements || header.n_faces > max_elements)
+    {
+        std::cerr << "read_pmpz: " << filename_ << " is corrupt" << std::endl;
+        return false;
+    }
+
+    const bool triangles = (header.flags & pmpz_triangles) != 0;
+    const bool has_normals = (header.flags & pmpz_normals) != 0;
+    const size_t nv = header.n_vertices;
+    const size_t nf = header.n_faces;
+
+    RangeDecoder decoder(payload.data(), payload.data() + payload.size());
+    PmpzModels models;
+    PmpzGeometry geometry(header);
+    OppositeVertices opposite;
+
+    const unsigned int normal_bits = std::min(16u, (unsigned int)header.bits);
+    const Scalar normal_scale = Scalar((1 << normal_bits) - 1) / 2;
+    int64_t last_normal[3] = {0, 0, 0};
+    std::vector<Normal> normals;
+    auto decode_normal = [&]() {
+        for (int i = 0; i < (normal_bits ? 2 : 3); ++i)
+        {
+            const uint64_t symbol = decode_varint(decoder, models.normals[i]);
+            last_normal[i] = normal_bits
+                                 ? last_normal[i] + unzigzag(symbol)
+                                 : int64_t(symbol ^ uint64_t(last_normal[i]));
+        }
+        if (normal_bits)
+            normals.push_back(
+                from_octahedral(Scalar(last_normal[0]) / normal_scale - 1,
+                                Scalar(last_normal[1]) / normal_scale - 1));
+        else
+            normals.push_back(Normal(bits_scalar(uint64_t(last_normal[0])),
+                                     bits_scalar(uint64_t(last_normal[1])),
+                                     bits_scalar(uint64_t(last_normal[2]))));
+    };
+
+    std::vector<IndexType> indices, face_sizes;
+    indices.reserve(3 * nf);
+    if (!triangles)
+        face_sizes.reserve(nf);
+    std::vector<IndexType> corners;
+    std::vector<bool> decoded;
+    IndexType next_id = 0;
+    bool corrupt = false;
+
+    for (size_t f = 0; f < nf && !decoder.overrun() && !corrupt; ++f)
+    {
+        // connectivity
+        const size_t n =
+            triangles ? 3 : 3 + decode_varint(decoder, models.face_sizes);
+        if (n > nv)
+            break;
+        corners.resize(n);
+        decoded.assign(n, true);
+        for (size_t i = 0; i < n; ++i)
+        {
+            const uint64_t symbol = decode_varint(decoder, models.corners);
+            if (symbol == 0)
+            {
+                corners[i] = next_id++;
+                decoded[i] = false;
+            }
+            // earlier vertices only, whose geometry is decoded
+            else if (symbol <= next_id &&
+                     next_id - symbol < geometry.points().size())
+                corners[i] = IndexType(next_id - symbol);
+            else
+                corrupt = true;
+        }
+        if (corrupt)
+            break;
+
+        // geometry of the new vertices
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (decoded[i])
+                continue;
+            const auto p = predict(corners, decoded, i, opposite,
+                                   corners[i] ? corners[i] - 1 : PMP_MAX_INDEX);
+            int64_t code[3];
+            for (int k = 0; k < 3; ++k)
+                code[k] = geometry.decode_symbol(
+                    k, decode_varint(decoder, models.coordinates[k]), p);
+            geometry.add(code);
+            if (has_normals)
+                decode_normal();
+            decoded[i] = true;
+        }
+
+        if (n == 3)
+            opposite.add_triangle(corners[0], corners[1], corners[2]);
+
+        indices.insert(indices.end(), corners.begin(), corners.end());
+        if (!triangles)
+            face_sizes.push_back(IndexType(n));
+    }
+
+    // isolated vertices, unless a face left vertices without geometry
+    const size_t n_isolated =
+        corrupt ? 0 : decode_varint(decoder, models.n_isolated);
+    for (size_t i = 0; i < n_isolated && next_id < nv; ++i)
+    {
+        const PmpzGeometry::Prediction p = {
+            next_id ? next_id - 1 : PMP_MAX_INDEX, PMP_MAX_INDEX,
+            PMP_MAX_INDEX};
+        ++next_id;
+        int64_t code[3];
+        for (int k = 0; k < 3; ++k)
+            code[k] = geometry.decode_symbol(
+                k, decode_varint(decoder, models.coordinates[k]), p);
+        geometry.add(code);
+        if (has_normals)
+            decode_normal();
+    }
+
+    if (corrupt || decoder.overrun() || next_id != nv ||
+        (triangles ? indices.size() != 3 * nf : face_sizes.size() != nf))
+    {
+        std::cerr << "read_pmpz: " << filename_ << " is corrupt" << std::endl;
+        return false;
+    }
+
+    mesh.build_from_indices(geometry.points(), indices, face_sizes);
+    if (has_normals)
+        mesh.vertex_property<Normal>("v:normal").vector() = normals;
+
+    return true;
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
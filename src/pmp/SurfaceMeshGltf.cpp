@@ -0,0 +1,331 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+// The binary glTF 2.0 (.glb) writer of SurfaceMeshIO.
+//
+// Faces are triangulated as fans, and each corner gets a normal, texture
+// coordinate, and color like in SurfaceMeshGL::update_opengl_buffers().
+// Corners of a vertex with equal attributes share one glTF vertex, so the
+// vertex buffer is not larger than needed. Vertices are interleaved in one
+// buffer view, triangles are indexed by 16 or 32 bit integers.
+
+#include <pmp/SurfaceMeshIO.h>
+#include <pmp/algorithms/SurfaceNormals.h>
+#include <pmp/algorithms/SurfaceReordering.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+namespace {
+
+// attributes of a glTF vertex
+struct GltfVertex
+{
+    vec3 position;
+    vec3 normal;
+    vec2 texcoord;
+    vec3 color;
+
+    bool operator==(const GltfVertex& v) const
+    {
+        return position == v.position && normal == v.normal &&
+               texcoord == v.texcoord && color == v.color;
+    }
+};
+
+// glTF buffers are little-endian
+class LittleEndianBuffer
+{
+public:
+    LittleEndianBuffer()
+    {
+        const uint16_t one = 1;
+        unsigned char c;
+        memcpy(&c, &one, 1);
+        swap_ = c != 1;
+    }
+
+    template <class T>
+    void add(T value)
+    {
+        unsigned char bytes[sizeof(T)];
+        memcpy(bytes, &value, sizeof(T));
+        if (swap_)
+            std::reverse(bytes, bytes + sizeof(T));
+        data_.insert(data_.end(), bytes, bytes + sizeof(T));
+    }
+
+    void add(const std::string& s)
+    {
+        data_.insert(data_.end(), s.begin(), s.end());
+    }
+
+    // pad to a multiple of four bytes
+    void align(unsigned char padding)
+    {
+        while (data_.size() % 4)
+            data_.push_back(padding);
+    }
+
+    size_t size() const { return data_.size(); }
+    const std::vector<unsigned char>& data() const { return data_; }
+
+private:
+    std::vector<unsigned char> data_;
+    bool swap_;
+};
+
+} // namespace
+
+//=============================================================================
+
+bool SurfaceMeshIO::write_glb(const SurfaceMesh& mesh)
+{
+    if (!mesh.n_vertices())
+    {
+        std::cerr << "write_glb: the mesh is empty" << std::endl;
+        return false;
+    }
+
+    auto vnormals = mesh.get_vertex_property<Normal>("v:normal");
+    auto vtex = mesh.get_vertex_property<TexCoord>("v:tex");
+    auto htex = mesh.get_halfedge_property<TexCoord>("h:tex");
+    auto vcolors = mesh.get_vertex_property<Color>("v:color");
+
+    // compact normals and texture coordinates are decoded on access
+    auto vnormals16 = mesh.get_vertex_property<OctNormal>("v:normal");
+    auto vtex16 = mesh.get_vertex_property<TexCoord16>("v:tex");
+    auto htex16 = mesh.get_halfedge_property<TexCoord16>("h:tex");
+    auto vertex_normal = [&](Vertex v) -> Normal {
+        return vnormals ? vnormals[v] : Normal(vnormals16[v]);
+    };
+
+    const bool has_faces = mesh.n_faces() > 0;
+    const bool use_vnormals =
+        (vnormals || vnormals16) && flags_.use_vertex_normals;
+    const bool has_normals = has_faces || use_vnormals;
+    const bool use_htex = (htex || htex16) && flags_.use_halfedge_texcoords;
+    const bool has_texcoords =
+        has_faces &&
+        (use_htex || ((vtex || vtex16) && flags_.use_vertex_texcoords));
+    const bool has_colors = vcolors && flags_.use_vertex_colors;
+    auto texcoord = [&](Halfedge h) -> TexCoord {
+        if (use_htex)
+            return htex ? htex[h] : TexCoord(htex16[h]);
+        const Vertex v = mesh.to_vertex(h);
+        return vtex ? vtex[v] : TexCoord(vtex16[v]);
+    };
+
+    // normals are computed like in SurfaceMeshGL for the crease angle
+    const Scalar crease_angle =
+        std::max(Scalar(0), std::min(Scalar(180), flags_.crease_angle));
+    auto normal = [&](Halfedge h) -> Normal {
+        const Vertex v = mesh.to_vertex(h);
+        if (use_vnormals)
+            return vertex_normal(v);
+        if (crease_angle < 1)
+            return SurfaceNormals::compute_face_normal(mesh, mesh.face(h));
+        if (crease_angle > 170)
+            return SurfaceNormals::compute_vertex_normal(mesh, v);
+        return SurfaceNormals::compute_corner_normal(
+            mesh, h, Scalar(crease_angle / 180.0 * M_PI));
+    };
+
+    // the glTF vertices of each mesh vertex
+    std::vector<GltfVertex> vertices;
+    std::vector<std::vector<uint32_t>> copies(mesh.vertices_size());
+    auto add_vertex = [&](Vertex v, const GltfVertex& gv) -> uint32_t {
+        for (auto i : copies[v.idx()])
+            if (vertices[i] == gv)
+                return i;
+        copies[v.idx()].push_back(uint32_t(vertices.size()));
+        vertices.push_back(gv);
+        return uint32_t(vertices.size() - 1);
+    };
+
+    std::vector<uint32_t> indices;
+    if (has_faces)
+    {
+        indices.reserve(3 * mesh.n_faces());
+        std::vector<uint32_t> corners;
+        std::vector<Face> faces;
+        if (flags_.optimize_vertex_cache)
+            faces = SurfaceReordering::vertex_cache_face_order(mesh);
+        else
+            for (auto f : mesh.faces())
+                faces.push_back(f);
+        for (auto f : faces)
+        {
+            corners.clear();
+            for (auto h : mesh.halfedges(f))
+            {
+                const Vertex v = mesh.to_vertex(h);
+                GltfVertex gv = {vec3(mesh.position(v)), vec3(normal(h)),
+                                 vec2(0, 0), vec3(0, 0, 0)};
+                if (has_texcoords)
+                    gv.texcoord = vec2(texcoord(h));
+                if (has_colors)
+                    gv.color = vec3(vcolors[v]);
+                corners.push_back(add_vertex(v, gv));
+            }
+
+            // tessellate the face into triangles
+            for (size_t i = 2; i < corners.size(); ++i)
+            {
+                indices.push_back(corners[0]);
+                indices.push_back(corners[i - 1]);
+                indices.push_back(corners[i]);
+            }
+        }
+    }
+    else
+    {
+        // a point cloud
+        for (auto v : mesh.vertices())
+        {
+            GltfVertex gv = {vec3(mesh.position(v)), vec3(0, 0, 0),
+                             vec2(0, 0), vec3(0, 0, 0)};
+            if (use_vnormals)
+                gv.normal = vec3(vertex_normal(v));
+            if (has_colors)
+                gv.color = vec3(vcolors[v]);
+            vertices.push_back(gv);
+        }
+    }
+
+    // interleaved vertex buffer
+    const size_t stride = 12 + (has_normals ? 12 : 0) +
+                          (has_texcoords ? 8 : 0) + (has_colors ? 12 : 0);
+    vec3 pmin(0, 0, 0), pmax(0, 0, 0);
+    LittleEndianBuffer bin;
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        const GltfVertex& v = vertices[i];
+        pmin = i ? min(pmin, v.position) : v.position;
+        pmax = i ? max(pmax, v.position) : v.position;
+        for (int k = 0; k < 3; ++k)
+            bin.add(v.position[k]);
+        if (has_normals)
+            for (int k = 0; k < 3; ++k)
+                bin.add(v.normal[k]);
+        if (has_texcoords)
+            for (int k = 0; k < 2; ++k)
+                bin.add(v.texcoord[k]);
+        if (has_colors)
+            for (int k = 0; k < 3; ++k)
+                bin.add(v.color[k]);
+    }
+    const size_t vertex_bytes = bin.size();
+
+    // index buffer
+    const bool short_indices = vertices.size() <= 65535;
+    for (auto i : indices)
+    {
+        if (short_indices)
+            bin.add(uint16_t(i));
+        else
+            bin.add(i);
+    }
+    const size_t index_bytes = bin.size() - vertex_bytes;
+    bin.align(0);
+
+    // json description
+    std::ostringstream json;
+    json.precision(9);
+    json << "{\"asset\":{\"version\":\"2.0\",\"generator\":\"pmp-library\"},"
+         << "\"scene\":0,\"scenes\":[{\"nodes\":[0]}],"
+         << "\"nodes\":[{\"mesh\":0}],"
+         << "\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0";
+    int accessor = 1;
+    if (has_normals)
+        json << ",\"NORMAL\":" << accessor++;
+    if (has_texcoords)
+        json << ",\"TEXCOORD_0\":" << accessor++;
+    if (has_colors)
+        json << ",\"COLOR_0\":" << accessor++;
+    json << "}";
+    if (has_faces)
+        json << ",\"indices\":" << accessor << ",\"mode\":4";
+    else
+        json << ",\"mode\":0";
+    json << "}]}],";
+
+    json << "\"buffers\":[{\"byteLength\":" << bin.size() << "}],"
+         << "\"bufferViews\":[{\"buffer\":0,\"byteOffset\":0,\"byteLength\":"
+         << vertex_bytes << ",\"byteStride\":" << stride
+         << ",\"target\":34962}";
+    if (has_faces)
+        json << ",{\"buffer\":0,\"byteOffset\":" << vertex_bytes
+             << ",\"byteLength\":" << index_bytes << ",\"target\":34963}";
+    json << "],";
+
+    size_t offset = 0;
+    auto vertex_accessor = [&](const char* type, size_t bytes) {
+        json << ",{\"bufferView\":0,\"byteOffset\":" << offset
+             << ",\"componentType\":5126,\"count\":" << vertices.size()
+             << ",\"type\":\"" << type << "\"}";
+        offset += bytes;
+    };
+    json << "\"accessors\":[{\"bufferView\":0,\"byteOffset\":0,"
+         << "\"componentType\":5126,\"count\":" << vertices.size()
+         << ",\"type\":\"VEC3\",\"min\":[" << pmin[0] << "," << pmin[1] << ","
+         << pmin[2] << "],\"max\":[" << pmax[0] << "," << pmax[1] << ","
+         << pmax[2] << "]}";
+    offset = 12;
+    if (has_normals)
+        vertex_accessor("VEC3", 12);
+    if (has_texcoords)
+        vertex_accessor("VEC2", 8);
+    if (has_colors)
+        vertex_accessor("VEC3", 12);
+    if (has_faces)
+        json << ",{\"bufferView\":1,\"byteOffset\":0,\"componentType\":"
+             << (short_indices ? 5123 : 5125) << ",\"count\":" << indices.size()
+             << ",\"type\":\"SCALAR\"}";
+    json << "]}";
+
+    // chunks of the binary file
+    LittleEndianBuffer json_chunk;
+    json_chunk.add(json.str());
+    json_chunk.align(' ');
+
+    LittleEndianBuffer header;
+    header.add(uint32_t(0x46546C67)); // glTF
+    header.add(uint32_t(2));
+    header.add(uint32_t(12 + 8 + json_chunk.size() + 8 + bin.size()));
+    header.add(uint32_t(json_chunk.size()));
+    header.add(uint32_t(0x4E4F534A)); // JSON
+
+    LittleEndianBuffer bin_header;
+    bin_header.add(uint32_t(bin.size()));
+    bin_header.add(uint32_t(0x004E4942)); // BIN
+
+    FILE* out = open_output("wb");
+    if (!out)
+        return false;
+    bool ok = true;
+    for (auto chunk : {&header, &json_chunk, &bin_header, &bin})
+        ok = ok && fwrite(chunk->data().data(), 1, chunk->size(), out) ==
+                       chunk->size();
+    fclose(out);
+    return ok;
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
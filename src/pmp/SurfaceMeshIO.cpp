@@ -9,14 +9,30 @@
 //=============================================================================
 
 #include <pmp/SurfaceMeshIO.h>
+#include <pmp/SurfaceMeshStream.h>
+#include <pmp/Parallel.h>
+#include <pmp/Profiler.h>
+#include <pmp/PointWelder.h>
 
-#include <rply.h>
-
+#include <algorithm>
 #include <clocale>
+#include <cmath>
 #include <cfloat>
+#include <cstdlib>
 #include <fstream>
 #include <cstring>
 #include <cctype>
+#include <cstdint>
+#include <limits>
+#include <sstream>
+#include <type_traits>
+
+#ifdef PMP_HAS_ZLIB
+#include <zlib.h>
+#endif
+#ifdef PMP_HAS_ZSTD
+#include <zstd.h>
+#endif
 
 // helper function
 template <typename T>
@@ -53,6 +69,8 @@ bool SurfaceMeshIO::read(SurfaceMesh& mesh)
         return false;
     std::string ext = filename_.substr(dot + 1, filename_.length() - dot - 1);
     std::transform(ext.begin(), ext.end(), ext.begin(), tolower);
+    if (!decompress(ext))
+        return false;
 
     // extension determines reader
     if (ext == "off")
@@ -75,6 +93,10 @@ bool SurfaceMeshIO::read(SurfaceMesh& mesh)
     {
         return read_pmp(mesh);
     }
+    else if (ext == "pmpz")
+    {
+        return read_pmpz(mesh);
+    }
     else if (ext == "xyz")
     {
         return read_xyz(mesh);
@@ -92,6 +114,8 @@ bool SurfaceMeshIO::read(SurfaceMesh& mesh)
 
 bool SurfaceMeshIO::write(const SurfaceMesh& mesh)
 {
+    PMP_PROFILE_ZONE("SurfaceMeshIO::write");
+
     // extract file extension
     std::string::size_type dot(filename_.rfind("."));
     if (dot == std::string::npos)
@@ -120,6 +144,14 @@ bool SurfaceMeshIO::write(const SurfaceMesh& mesh)
     {
         return write_pmp(mesh);
     }
+    else if (ext == "pmpz")
+    {
+        return write_pmpz(mesh);
+    }
+    else if (ext == "glb")
+    {
+        return write_glb(mesh);
+    }
     else if (ext == "xyz")
     {
         return write_xyz(mesh);
@@ -131,365 +163,1118 @@ bool SurfaceMeshIO::write(const SurfaceMesh& mesh)
 
 //-----------------------------------------------------------------------------
 
-bool SurfaceMeshIO::read_obj(SurfaceMesh& mesh)
+bool SurfaceMeshIO::read(SurfaceMeshSink& sink, size_t batch_size)
 {
-    char s[200];
-    float x, y, z;
-    std::vector<Vertex> vertices;
-    std::vector<TexCoord> all_tex_coords; //individual texture coordinates
-    std::vector<int>
-        halfedge_tex_idx; //texture coordinates sorted for halfedges
-    HalfedgeProperty<TexCoord> tex_coords =
-        mesh.halfedge_property<TexCoord>("h:tex");
-    bool with_tex_coord = false;
+    PMP_PROFILE_ZONE("SurfaceMeshIO::read_stream");
 
-    // open file (in ASCII mode)
-    FILE* in = fopen(filename_.c_str(), "r");
+    std::setlocale(LC_NUMERIC, "C");
+
+    // extract file extension
+    std::string::size_type dot(filename_.rfind("."));
+    if (dot == std::string::npos)
+        return false;
+    std::string ext = filename_.substr(dot + 1, filename_.length() - dot - 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(), tolower);
+    if (!decompress(ext))
+        return false;
+
+    // extension determines reader
+    if (ext == "off")
+    {
+        return stream_off(sink, batch_size);
+    }
+    else if (ext == "obj")
+    {
+        return stream_obj(sink, batch_size);
+    }
+    else if (ext == "ply")
+    {
+        return stream_ply(sink, batch_size);
+    }
+    else if (ext == "stl")
+    {
+        return stream_stl(sink, batch_size);
+    }
+
+    // we didn't find a streaming reader
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+#if defined(PMP_HAS_ZLIB) || defined(PMP_HAS_ZSTD) || defined(_WIN32)
+
+// read the whole file
+bool read_file(const std::string& filename, std::vector<char>& data)
+{
+    FILE* in = fopen(filename.c_str(), "rb");
     if (!in)
         return false;
+    data.clear();
+    std::vector<char> block(1 << 20);
+    size_t n;
+    while ((n = fread(block.data(), 1, block.size(), in)) > 0)
+        data.insert(data.end(), block.data(), block.data() + n);
+    const bool ok = !ferror(in);
+    fclose(in);
+    return ok;
+}
 
-    // clear line once
-    memset(&s, 0, 200);
+#endif
 
-    // parse line by line (currently only supports vertex positions & faces
-    while (in && !feof(in) && fgets(s, 200, in))
-    {
-        // comment
-        if (s[0] == '#' || isspace(s[0]))
-            continue;
+#ifdef PMP_HAS_ZLIB
 
-        // vertex
-        else if (strncmp(s, "v ", 2) == 0)
-        {
-            if (sscanf(s, "v %f %f %f", &x, &y, &z))
-            {
-                mesh.add_vertex(Point(x, y, z));
-            }
-        }
+// inflate a gzip stream of one or more members
+bool inflate_gzip(const std::vector<char>& in, std::vector<char>& out)
+{
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (inflateInit2(&stream, 15 + 32) != Z_OK)
+        return false;
 
-        // normal
-        else if (strncmp(s, "vn ", 3) == 0)
+    // zlib counts in 32 bits, so large buffers are passed in chunks
+    const size_t chunk = size_t(1) << 30;
+    size_t in_pos = 0, out_pos = 0;
+    out.resize(std::max(size_t(1) << 16, 4 * in.size()));
+    int ret = Z_OK;
+    while (true)
+    {
+        if (out_pos == out.size())
+            out.resize(2 * out.size());
+        stream.next_in = (Bytef*)in.data() + in_pos;
+        stream.avail_in = uInt(std::min(chunk, in.size() - in_pos));
+        stream.next_out = (Bytef*)out.data() + out_pos;
+        stream.avail_out = uInt(std::min(chunk, out.size() - out_pos));
+        const uInt avail_in = stream.avail_in, avail_out = stream.avail_out;
+
+        ret = inflate(&stream, Z_NO_FLUSH);
+        in_pos += avail_in - stream.avail_in;
+        out_pos += avail_out - stream.avail_out;
+
+        if (ret == Z_STREAM_END)
         {
-            if (sscanf(s, "vn %f %f %f", &x, &y, &z))
-            {
-                // problematic as it can be either a vertex property when interpolated
-                // or a halfedge property for hard edges
-            }
+            // concatenated members
+            if (in_pos == in.size() || inflateReset(&stream) != Z_OK)
+                break;
         }
+        else if (ret == Z_BUF_ERROR && in_pos == in.size())
+            break; // truncated
+        else if (ret != Z_OK && ret != Z_BUF_ERROR)
+            break;
+    }
+    inflateEnd(&stream);
+    out.resize(out_pos);
+    return ret == Z_STREAM_END;
+}
 
-        // texture coordinate
-        else if (strncmp(s, "vt ", 3) == 0)
-        {
-            if (sscanf(s, "vt %f %f", &x, &y))
-            {
-                all_tex_coords.emplace_back(x, y);
-            }
-        }
+// the largest uncompressed size of a BGZF member, and the largest ratio of
+// uncompressed to compressed size deflate can reach
+const size_t bgzf_max_size = 1 << 16;
+const size_t deflate_max_ratio = 1032;
 
-        // face
-        else if (strncmp(s, "f ", 2) == 0)
-        {
-            int component(0), nv(0);
-            bool end_of_vertex(false);
-            char *p0, *p1(s + 1);
+// the members of a BGZF file, i.e., gzip members storing their size, as
+// written by bgzip. returns false for other gzip files, and for members
+// whose stored size is not plausible, which are inflated as a stream.
+bool bgzf_members(const std::vector<char>& in, std::vector<size_t>& offsets,
+                  std::vector<size_t>& sizes)
+{
+    const unsigned char* data = (const unsigned char*)in.data();
+    offsets.clear();
+    sizes.clear();
+    size_t pos = 0;
+    while (pos < in.size())
+    {
+        if (in.size() - pos < 26 || data[pos] != 0x1f ||
+            data[pos + 1] != 0x8b || data[pos + 2] != 8 ||
+            !(data[pos + 3] & 4) || data[pos + 10] != 6 ||
+            data[pos + 11] != 0 || data[pos + 12] != 'B' ||
+            data[pos + 13] != 'C' || data[pos + 14] != 2 ||
+            data[pos + 15] != 0)
+            return false;
+        const size_t block_size =
+            size_t(data[pos + 16] | data[pos + 17] << 8) + 1;
+        if (block_size < 26 || pos + block_size > in.size())
+            return false;
+        const unsigned char* isize = data + pos + block_size - 4;
+        const size_t size = size_t(isize[0]) | size_t(isize[1]) << 8 |
+                            size_t(isize[2]) << 16 | size_t(isize[3]) << 24;
+        if (size > bgzf_max_size || size > deflate_max_ratio * block_size)
+            return false;
+        offsets.push_back(pos);
+        sizes.push_back(size);
+        pos += block_size;
+    }
+    return offsets.size() > 1;
+}
 
-            vertices.clear();
-            halfedge_tex_idx.clear();
+// inflate the members of a BGZF file in parallel
+bool inflate_bgzf(const std::vector<char>& in,
+                  const std::vector<size_t>& offsets,
+                  const std::vector<size_t>& sizes, std::vector<char>& out)
+{
+    const size_t n = offsets.size();
+    std::vector<size_t> out_offsets(n + 1, 0);
+    for (size_t i = 0; i < n; ++i)
+        out_offsets[i + 1] = out_offsets[i] + sizes[i];
+    out.resize(out_offsets[n]);
+
+    std::vector<char> ok(n, 0);
+    parallel_for(0, n, [&](size_t i) {
+        const unsigned char* data = (const unsigned char*)in.data();
+        const size_t begin = offsets[i] + 18;
+        const size_t end = (i + 1 < n ? offsets[i + 1] : in.size()) - 8;
+
+        z_stream stream;
+        memset(&stream, 0, sizeof(stream));
+        if (inflateInit2(&stream, -15) != Z_OK)
+            return;
+        stream.next_in = (Bytef*)data + begin;
+        stream.avail_in = uInt(end - begin);
+        stream.next_out = (Bytef*)out.data() + out_offsets[i];
+        stream.avail_out = uInt(sizes[i]);
+        const int ret = inflate(&stream, Z_FINISH);
+        inflateEnd(&stream);
+
+        const unsigned char* c = data + end;
+        const uLong crc = uLong(c[0]) | uLong(c[1]) << 8 | uLong(c[2]) << 16 |
+                          uLong(c[3]) << 24;
+        ok[i] = ret == Z_STREAM_END && stream.avail_out == 0 &&
+                crc32(crc32(0, Z_NULL, 0),
+                      (const Bytef*)out.data() + out_offsets[i],
+                      uInt(sizes[i])) == crc;
+    });
+    return std::find(ok.begin(), ok.end(), 0) == ok.end();
+}
 
-            // skip white-spaces
-            while (*p1 == ' ')
-                ++p1;
+#endif
 
-            while (p1)
-            {
-                p0 = p1;
+#ifdef PMP_HAS_ZSTD
 
-                // overwrite next separator
+// decompress a zstd stream, frames of known, plausible size in parallel
+bool decompress_zstd(const std::vector<char>& in, std::vector<char>& out)
+{
+    std::vector<size_t> offsets, sizes, out_offsets(1, 0);
+    bool known_sizes = true;
+    for (size_t pos = 0; pos < in.size();)
+    {
+        const size_t n = ZSTD_findFrameCompressedSize(in.data() + pos,
+                                                      in.size() - pos);
+        if (ZSTD_isError(n))
+            return false;
+        const unsigned long long size =
+            ZSTD_getFrameContentSize(in.data() + pos, n);
+
+        // each block of at most ZSTD_BLOCKSIZE_MAX bytes takes four bytes at
+        // least, larger sizes are corrupt and must not be allocated
+        const unsigned long long max_size =
+            (unsigned long long)(n / 4 + 1) * ZSTD_BLOCKSIZE_MAX;
+        if (size == ZSTD_CONTENTSIZE_UNKNOWN ||
+            size == ZSTD_CONTENTSIZE_ERROR || size > max_size)
+            known_sizes = false;
+        offsets.push_back(pos);
+        sizes.push_back(n);
+        out_offsets.push_back(out_offsets.back() + size_t(size));
+        pos += n;
+    }
 
-                // skip '/', '\n', ' ', '\0', '\r' <-- don't forget Windows
-                while (*p1 != '/' && *p1 != '\r' && *p1 != '\n' && *p1 != ' ' &&
-                       *p1 != '\0')
-                    ++p1;
+    if (known_sizes)
+    {
+        out.resize(out_offsets.back());
+        std::vector<char> ok(offsets.size(), 0);
+        parallel_for(0, offsets.size(), [&](size_t i) {
+            const size_t capacity = out_offsets[i + 1] - out_offsets[i];
+            const size_t n =
+                ZSTD_decompress(out.data() + out_offsets[i], capacity,
+                                in.data() + offsets[i], sizes[i]);
+            ok[i] = !ZSTD_isError(n) && n == capacity;
+        });
+        return std::find(ok.begin(), ok.end(), 0) == ok.end();
+    }
 
-                // detect end of vertex
-                if (*p1 != '/')
-                {
-                    end_of_vertex = true;
-                }
+    // frames without sizes are decompressed as a stream
+    ZSTD_DStream* stream = ZSTD_createDStream();
+    if (!stream)
+        return false;
+    ZSTD_initDStream(stream);
+    ZSTD_inBuffer input = {in.data(), in.size(), 0};
+    out.resize(std::max(size_t(1) << 16, 4 * in.size()));
+    size_t out_pos = 0, ret = 0;
+    while (true)
+    {
+        if (out_pos == out.size())
+            out.resize(2 * out.size());
+        ZSTD_outBuffer output = {out.data() + out_pos, out.size() - out_pos,
+                                 0};
+        ret = ZSTD_decompressStream(stream, &output, &input);
+        out_pos += output.pos;
+
+        // done when all input is consumed and all output is flushed
+        if (ZSTD_isError(ret) ||
+            (input.pos == input.size && output.pos < output.size))
+            break;
+    }
+    ZSTD_freeDStream(stream);
+    out.resize(out_pos);
+    return !ZSTD_isError(ret) && ret == 0;
+}
 
-                // replace separator by '\0'
-                if (*p1 != '\0')
-                {
-                    *p1 = '\0';
-                    p1++; // point to next token
-                }
+#endif
 
-                // detect end of line and break
-                if (*p1 == '\0' || *p1 == '\n')
-                {
-                    p1 = nullptr;
-                }
+} // namespace
 
-                // read next vertex component
-                if (*p0 != '\0')
-                {
-                    switch (component)
-                    {
-                        case 0: // vertex
-                        {
-                            vertices.emplace_back(atoi(p0) - 1);
-                            break;
-                        }
-                        case 1: // texture coord
-                        {
-                            int idx = atoi(p0) - 1;
-                            halfedge_tex_idx.push_back(idx);
-                            with_tex_coord = true;
-                            break;
-                        }
-                        case 2: // normal
-                            break;
-                    }
-                }
+//-----------------------------------------------------------------------------
 
-                ++component;
+bool SurfaceMeshIO::decompress(std::string& ext)
+{
+    PMP_PROFILE_ZONE("SurfaceMeshIO::decompress");
+
+    if (ext != "gz" && ext != "zst")
+        return true;
+
+    std::vector<char> compressed;
+    bool ok = false;
+#if defined(PMP_HAS_ZLIB) || defined(PMP_HAS_ZSTD)
+    if (in_memory_)
+        compressed.assign(input_data_, input_data_ + input_size_);
+    else if (!read_file(filename_, compressed))
+        compressed.clear();
+#endif
+#ifdef PMP_HAS_ZLIB
+    if (ext == "gz" && !compressed.empty())
+    {
+        std::vector<size_t> offsets, sizes;
+        ok = bgzf_members(compressed, offsets, sizes)
+                 ? inflate_bgzf(compressed, offsets, sizes, data_)
+                 : inflate_gzip(compressed, data_);
+        if (!ok)
+            std::cerr << "read: corrupt gzip file " << filename_ << std::endl;
+    }
+#endif
+#ifdef PMP_HAS_ZSTD
+    if (ext == "zst" && !compressed.empty())
+    {
+        ok = decompress_zstd(compressed, data_);
+        if (!ok)
+            std::cerr << "read: corrupt zstd file " << filename_ << std::endl;
+    }
+#endif
+    if (compressed.empty() && !ok)
+    {
+        std::cerr << "read: cannot decompress " << filename_ << std::endl;
+        return false;
+    }
+    if (!ok)
+        return false;
+    in_memory_ = true;
+    input_data_ = data_.data();
+    input_size_ = data_.size();
+
+    // the extension of the compressed file determines the reader
+    const std::string name = filename_.substr(0, filename_.rfind('.'));
+    const std::string::size_type dot = name.rfind('.');
+    ext = dot == std::string::npos ? std::string() : name.substr(dot + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(), tolower);
+    return true;
+}
 
-                if (end_of_vertex)
-                {
-                    component = 0;
-                    nv++;
-                    end_of_vertex = false;
-                }
-            }
+//-----------------------------------------------------------------------------
 
-            Face f = mesh.add_face(vertices);
+FILE* SurfaceMeshIO::open_input(const char* mode) const
+{
+    if (!in_memory_)
+        return fopen(filename_.c_str(), mode);
 
-            // add texture coordinates
-            if (with_tex_coord)
-            {
-                SurfaceMesh::HalfedgeAroundFaceCirculator h_fit =
-                    mesh.halfedges(f);
-                SurfaceMesh::HalfedgeAroundFaceCirculator h_end = h_fit;
-                unsigned v_idx = 0;
-                do
-                {
-                    tex_coords[*h_fit] =
-                        all_tex_coords.at(halfedge_tex_idx.at(v_idx));
-                    ++v_idx;
-                    ++h_fit;
-                } while (h_fit != h_end);
-            }
-        }
-        // clear line
-        memset(&s, 0, 200);
+    // the readers parse the data from memory
+#ifdef _WIN32
+    FILE* in = tmpfile();
+    if (in)
+    {
+        fwrite(input_data_, 1, input_size_, in);
+        rewind(in);
     }
+    return in;
+#else
+    if (!input_size_)
+        return nullptr;
+    return fmemopen((void*)input_data_, input_size_, "rb");
+#endif
+}
+
+//-----------------------------------------------------------------------------
 
-    // if there are no textures, delete texture property!
-    if (!with_tex_coord)
+FILE* SurfaceMeshIO::open_output(const char* mode)
+{
+#ifndef _WIN32
+    if (to_memory_)
     {
-        mesh.remove_halfedge_property(tex_coords);
+        free(output_data_);
+        output_data_ = nullptr;
+        output_size_ = 0;
+        return open_memstream(&output_data_, &output_size_);
     }
+#endif
+    return fopen(filename_.c_str(), mode);
+}
 
-    fclose(in);
-    return true;
+//-----------------------------------------------------------------------------
+
+bool SurfaceMeshIO::read(SurfaceMesh& mesh, const char* data, size_t size,
+                         const std::string& format, const IOFlags& flags)
+{
+    SurfaceMeshIO reader("memory." + format, flags);
+    reader.in_memory_ = true;
+    reader.input_data_ = data;
+    reader.input_size_ = size;
+    return reader.read(mesh);
 }
 
 //-----------------------------------------------------------------------------
 
-bool SurfaceMeshIO::write_obj(const SurfaceMesh& mesh)
+bool SurfaceMeshIO::read(SurfaceMesh& mesh, const ReadFunction& read_function,
+                         const std::string& format, const IOFlags& flags)
 {
-    FILE* out = fopen(filename_.c_str(), "w");
-    if (!out)
-        return false;
+    std::vector<char> data;
+    const size_t block_size = 1 << 20;
+    size_t n;
+    do
+    {
+        data.resize(data.size() + block_size);
+        n = read_function(data.data() + data.size() - block_size, block_size);
+        data.resize(data.size() - block_size + std::min(n, block_size));
+    } while (n > 0);
+    return read(mesh, data.data(), data.size(), format, flags);
+}
 
-    // comment
-    fprintf(out, "# OBJ export from SurfaceMesh\n");
+//-----------------------------------------------------------------------------
 
-    //vertices
-    VertexProperty<Point> points = mesh.get_vertex_property<Point>("v:point");
-    for (SurfaceMesh::VertexIterator vit = mesh.vertices_begin();
-         vit != mesh.vertices_end(); ++vit)
+bool SurfaceMeshIO::write(const SurfaceMesh& mesh, std::vector<char>& data,
+                          const std::string& format, const IOFlags& flags)
+{
+    data.clear();
+#ifdef _WIN32
+    // without open_memstream(), write to a temporary file
+    const std::string filename =
+        std::string(std::tmpnam(nullptr)) + "." + format;
+    SurfaceMeshIO writer(filename, flags);
+    const bool ok = writer.write(mesh) && read_file(filename, data);
+    std::remove(filename.c_str());
+    return ok;
+#else
+    SurfaceMeshIO writer("memory." + format, flags);
+    writer.to_memory_ = true;
+    const bool ok = writer.write(mesh);
+    if (ok && writer.output_data_)
+        data.assign(writer.output_data_,
+                    writer.output_data_ + writer.output_size_);
+    free(writer.output_data_);
+    return ok;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMeshIO::write(const SurfaceMesh& mesh,
+                          const WriteFunction& write_function,
+                          const std::string& format, const IOFlags& flags)
+{
+    std::vector<char> data;
+    return write(mesh, data, format, flags) &&
+           write_function(data.data(), data.size());
+}
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+// read the rest of the file into text, terminated by a '\0'
+void read_text(FILE* in, std::vector<char>& text)
+{
+    const size_t block_size = 1 << 20;
+    size_t n = 0;
+    do
     {
-        const Point& p = points[*vit];
-        fprintf(out, "v %.10f %.10f %.10f\n", p[0], p[1], p[2]);
+        text.resize(text.size() + block_size);
+        n = fread(text.data() + text.size() - block_size, 1, block_size, in);
+        text.resize(text.size() - block_size + n);
+    } while (n == block_size);
+    text.push_back('\0');
+}
+
+// split the text [begin,end) into about n parts starting at line beginnings.
+// returns the n+1 (or less) part boundaries.
+std::vector<const char*> split_lines(const char* begin, const char* end,
+                                     size_t n)
+{
+    std::vector<const char*> parts(1, begin);
+    const size_t size = end - begin;
+    for (size_t i = 1; i < n; ++i)
+    {
+        const char* p = std::max(parts.back(), begin + i * size / n);
+        while (p < end && p[-1] != '\n')
+            ++p;
+        if (p < end && p > parts.back())
+            parts.push_back(p);
     }
+    parts.push_back(end);
+    return parts;
+}
 
-    //normals
-    VertexProperty<Point> normals = mesh.get_vertex_property<Point>("v:normal");
-    if (normals)
+// number of parts for parallel parsing of text with the given size
+size_t n_parts(size_t size)
+{
+    const size_t min_part_size = 1 << 20;
+    return std::max(size_t(1),
+                    std::min(size / min_part_size, size_t(8 * num_threads())));
+}
+
+inline bool is_blank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+inline void skip_blanks(const char*& p, const char* end)
+{
+    while (p < end && is_blank(*p))
+        ++p;
+}
+
+// returns the beginning of the next line
+inline const char* next_line(const char* p, const char* end)
+{
+    while (p < end && *p != '\n')
+        ++p;
+    return p < end ? p + 1 : end;
+}
+
+// parse an integer, skipping leading blanks
+inline bool parse_int(const char*& p, const char* end, long long& x)
+{
+    skip_blanks(p, end);
+    const char* s = p;
+    bool negative = false;
+    if (s < end && (*s == '-' || *s == '+'))
+        negative = (*s++ == '-');
+    if (s == end || !is_digit(*s))
+        return false;
+    long long v = 0;
+    while (s < end && is_digit(*s))
+        v = 10 * v + (*s++ - '0');
+    x = negative ? -v : v;
+    p = s;
+    return true;
+}
+
+// parse a floating point number, skipping leading blanks. numbers with at
+// most 19 significant digits and small exponents are converted exactly,
+// others are handed to strtod(), which requires the text to be terminated.
+inline bool parse_scalar(const char*& p, const char* end, Scalar& x)
+{
+    static const double powers[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                    1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                                    1e18, 1e19, 1e20, 1e21, 1e22};
+
+    skip_blanks(p, end);
+    const char* s = p;
+    bool negative = false;
+    if (s < end && (*s == '-' || *s == '+'))
+        negative = (*s++ == '-');
+
+    uint64_t mantissa = 0;
+    int digits = 0, exponent = 0;
+    bool valid = false;
+    for (; s < end && is_digit(*s); ++s, valid = true)
     {
-        for (SurfaceMesh::VertexIterator vit = mesh.vertices_begin();
-             vit != mesh.vertices_end(); ++vit)
+        if (digits < 19)
         {
-            const Point& p = normals[*vit];
-            fprintf(out, "vn %.10f %.10f %.10f\n", p[0], p[1], p[2]);
+            mantissa = 10 * mantissa + (*s - '0');
+            digits += (mantissa != 0);
         }
+        else
+            ++exponent;
     }
-
-    // optional texture coordinates
-    // do we have them?
-    std::vector<std::string> hprops = mesh.halfedge_properties();
-    bool with_tex_coord = false;
-    auto hpropEnd = hprops.end();
-    auto hpropStart = hprops.begin();
-    while (hpropStart != hpropEnd)
+    if (s < end && *s == '.')
     {
-        if (0 == (*hpropStart).compare("h:tex"))
+        for (++s; s < end && is_digit(*s); ++s, valid = true)
         {
-            with_tex_coord = true;
+            if (digits < 19)
+            {
+                mantissa = 10 * mantissa + (*s - '0');
+                digits += (mantissa != 0);
+                --exponent;
+            }
         }
-        ++hpropStart;
     }
-
-    //if so then add
-    if (with_tex_coord)
+    if (valid && s < end && (*s == 'e' || *s == 'E'))
     {
-        HalfedgeProperty<TexCoord> texCoord =
-            mesh.get_halfedge_property<TexCoord>("h:tex");
-        for (SurfaceMesh::HalfedgeIterator hit = mesh.halfedges_begin();
-             hit != mesh.halfedges_end(); ++hit)
+        const char* t = s + 1;
+        bool negative_exponent = false;
+        if (t < end && (*t == '-' || *t == '+'))
+            negative_exponent = (*t++ == '-');
+        if (t < end && is_digit(*t))
         {
-            const TexCoord& pt = texCoord[*hit];
-            fprintf(out, "vt %.10f %.10f \n", pt[0], pt[1]);
+            int e = 0;
+            for (; t < end && is_digit(*t); ++t)
+                e = std::min(10 * e + (*t - '0'), 100000);
+            exponent += negative_exponent ? -e : e;
+            s = t;
         }
+        else
+            valid = false;
     }
 
-    //faces
-    for (SurfaceMesh::FaceIterator fit = mesh.faces_begin();
-         fit != mesh.faces_end(); ++fit)
+    if (valid && mantissa < (uint64_t(1) << 53) && exponent >= -22 &&
+        exponent <= 22)
     {
-        fprintf(out, "f");
-        SurfaceMesh::VertexAroundFaceCirculator fvit = mesh.vertices(*fit),
-                                                fvend = fvit;
-        SurfaceMesh::HalfedgeAroundFaceCirculator fhit = mesh.halfedges(*fit);
-        do
-        {
-            if (with_tex_coord)
-            {
-                // write vertex index, texCoord index and normal index
-                fprintf(out, " %d/%d/%d", (*fvit).idx() + 1, (*fhit).idx() + 1,
-                        (*fvit).idx() + 1);
-                ++fhit;
-            }
-            else
-            {
-                // write vertex index and normal index
-                fprintf(out, " %d//%d", (*fvit).idx() + 1, (*fvit).idx() + 1);
-            }
-        } while (++fvit != fvend);
-        fprintf(out, "\n");
+        double v = double(mantissa);
+        v = exponent < 0 ? v / powers[-exponent] : v * powers[exponent];
+        x = Scalar(negative ? -v : v);
+        p = s;
+        return true;
     }
 
-    fclose(out);
+    // everything else, e.g., inf, nan, or long mantissas
+    if (p == end || !(*p == '-' || *p == '+' || *p == '.' || is_digit(*p) ||
+                      *p == 'i' || *p == 'I' || *p == 'n' || *p == 'N'))
+        return false;
+    char* e;
+    const double v = strtod(p, &e);
+    if (e == p || e > end)
+        return false;
+    x = Scalar(v);
+    p = e;
     return true;
 }
 
-//-----------------------------------------------------------------------------
-
-bool read_off_ascii(SurfaceMesh& mesh, FILE* in, const bool has_normals,
-                    const bool has_texcoords, const bool has_colors)
+// the elements parsed from a part of an OBJ file
+struct ObjPart
 {
-    char line[1000], *lp;
-    int nc;
-    unsigned int i, j, items, idx;
-    unsigned int nv, nf, ne;
-    float x, y, z, r, g, b;
-    Vertex v;
+    std::vector<Point> points;
+    std::vector<TexCoord> tex_coords;
 
-    // properties
-    VertexProperty<Normal> normals;
-    VertexProperty<TexCoord> texcoords;
-    VertexProperty<Color> colors;
-    if (has_normals)
-        normals = mesh.vertex_property<Normal>("v:normal");
-    if (has_texcoords)
-        texcoords = mesh.vertex_property<TexCoord>("v:tex");
-    if (has_colors)
-        colors = mesh.vertex_property<Color>("v:color");
+    // vertex and texture indices per corner, and the number of each per face
+    std::vector<long long> indices, tex_indices;
+    std::vector<IndexType> face_sizes, tex_sizes;
 
-    // #Vertice, #Faces, #Edges
-    items = fscanf(in, "%d %d %d\n", (int*)&nv, (int*)&nf, (int*)&ne);
-    PMP_ASSERT(items);
+    // corners using relative (negative) indices, which are relative to the
+    // number of elements before this part
+    std::vector<size_t> relative, tex_relative;
+};
 
-    mesh.reserve(nv, std::max(3 * nv, ne), nf);
+// convert a 1-based or negative OBJ index, n is the number of elements of
+// the part defined so far
+inline void add_obj_index(long long idx, size_t n, std::vector<long long>& out,
+                          std::vector<size_t>& relative)
+{
+    if (idx < 0)
+    {
+        relative.push_back(out.size());
+        out.push_back(static_cast<long long>(n) + idx);
+    }
+    else
+        out.push_back(idx - 1);
+}
 
-    // read vertices: pos [normal] [color] [texcoord]
-    for (i = 0; i < nv && !feof(in); ++i)
+void parse_obj(const char* p, const char* end, ObjPart& part)
+{
+    while (p < end)
     {
-        // read line
-        lp = fgets(line, 1000, in);
-        lp = line;
+        skip_blanks(p, end);
+        const char* line = p;
+        p = next_line(p, end);
 
-        // position
-        items = sscanf(lp, "%f %f %f%n", &x, &y, &z, &nc);
-        assert(items == 3);
-        v = mesh.add_vertex(Point(x, y, z));
-        lp += nc;
+        if (line + 1 >= p)
+            continue;
 
-        // normal
-        if (has_normals)
+        // vertex
+        if (line[0] == 'v' && is_blank(line[1]))
         {
-            if (sscanf(lp, "%f %f %f%n", &x, &y, &z, &nc) == 3)
+            Point x(0, 0, 0);
+            const char* s = line + 1;
+            for (int i = 0; i < 3 && parse_scalar(s, p, x[i]); ++i)
             {
-                normals[v] = Normal(x, y, z);
             }
-            lp += nc;
+            part.points.push_back(x);
         }
 
-        // color
-        if (has_colors)
+        // texture coordinate
+        else if (line[0] == 'v' && line[1] == 't' && is_blank(line[2]))
+        {
+            TexCoord t(0, 0);
+            const char* s = line + 2;
+            for (int i = 0; i < 2 && parse_scalar(s, p, t[i]); ++i)
+            {
+            }
+            part.tex_coords.push_back(t);
+        }
+
+        // face: v[/vt[/vn]] ...
+        else if (line[0] == 'f' && is_blank(line[1]))
         {
-            if (sscanf(lp, "%f %f %f%n", &r, &g, &b, &nc) == 3)
+            const char* s = line + 1;
+            size_t nv = 0, nt = 0;
+            long long idx;
+            while (parse_int(s, p, idx))
             {
-                if (r > 1.0f || g > 1.0f || b > 1.0f)
+                add_obj_index(idx, part.points.size(), part.indices,
+                              part.relative);
+                ++nv;
+                if (s < p && *s == '/')
                 {
-                    r /= 255.0f;
-                    g /= 255.0f;
-                    b /= 255.0f;
+                    ++s;
+                    if (parse_int(s, p, idx))
+                    {
+                        add_obj_index(idx, part.tex_coords.size(),
+                                      part.tex_indices, part.tex_relative);
+                        ++nt;
+                    }
+                    if (s < p && *s == '/')
+                    {
+                        ++s;
+                        parse_int(s, p, idx); // normal index, unused
+                    }
                 }
-                colors[v] = Color(r, g, b);
             }
-            lp += nc;
+            part.face_sizes.push_back(nv);
+            part.tex_sizes.push_back(nt);
         }
+    }
+}
 
-        // tex coord
-        if (has_texcoords)
+// append the indices of a part to out, resolving its relative indices by
+// the number of elements before the part. invalid indices are mapped to
+// PMP_MAX_INDEX.
+void merge_indices(const std::vector<long long>& indices,
+                   const std::vector<size_t>& relative, size_t n_before,
+                   size_t n_total, std::vector<IndexType>& out)
+{
+    const size_t offset = out.size();
+    for (auto idx : indices)
+        out.push_back(idx >= 0 && size_t(idx) < n_total ? IndexType(idx)
+                                                         : PMP_MAX_INDEX);
+    for (auto i : relative)
+    {
+        const long long idx = indices[i] + static_cast<long long>(n_before);
+        out[offset + i] = idx >= 0 && size_t(idx) < n_total ? IndexType(idx)
+                                                             : PMP_MAX_INDEX;
+    }
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMeshIO::read_obj(SurfaceMesh& mesh)
+{
+    PMP_PROFILE_ZONE("SurfaceMeshIO::read_obj");
+
+    // open file (in binary mode, line endings are handled by the parser)
+    FILE* in = open_input("rb");
+    if (!in)
+        return false;
+
+    std::vector<char> text;
+    read_text(in, text);
+    fclose(in);
+
+    // parse parts of the file in parallel
+    const char* begin = text.data();
+    const char* end = text.data() + text.size() - 1;
+    const std::vector<const char*> bounds =
+        split_lines(begin, end, n_parts(end - begin));
+    std::vector<ObjPart> parts(bounds.size() - 1);
+    parallel_for_chunks(
+        parts.size(),
+        [&](size_t b, size_t e) {
+            for (size_t i = b; i < e; ++i)
+                parse_obj(bounds[i], bounds[i + 1], parts[i]);
+        },
+        1);
+
+    // concatenate the parts
+    size_t n_points = 0, n_tex_coords = 0;
+    for (auto& part : parts)
+    {
+        n_points += part.points.size();
+        n_tex_coords += part.tex_coords.size();
+    }
+
+    std::vector<Point> points;
+    std::vector<TexCoord> all_tex_coords;
+    std::vector<IndexType> indices, face_sizes, halfedge_tex_idx, tex_sizes;
+    points.reserve(n_points);
+    all_tex_coords.reserve(n_tex_coords);
+    for (auto& part : parts)
+    {
+        merge_indices(part.indices, part.relative, points.size(), n_points,
+                      indices);
+        merge_indices(part.tex_indices, part.tex_relative,
+                      all_tex_coords.size(), n_tex_coords, halfedge_tex_idx);
+        points.insert(points.end(), part.points.begin(), part.points.end());
+        all_tex_coords.insert(all_tex_coords.end(), part.tex_coords.begin(),
+                              part.tex_coords.end());
+        face_sizes.insert(face_sizes.end(), part.face_sizes.begin(),
+                          part.face_sizes.end());
+        tex_sizes.insert(tex_sizes.end(), part.tex_sizes.begin(),
+                         part.tex_sizes.end());
+    }
+    parts.clear();
+
+    // build connectivity for all faces at once
+    mesh.build_from_indices(points, indices, face_sizes);
+
+    // add texture coordinates
+    if (!halfedge_tex_idx.empty())
+    {
+        auto tex_coords = mesh.halfedge_property<TexCoord>("h:tex");
+
+        size_t corner = 0, tex_corner = 0;
+        for (size_t i = 0; i < face_sizes.size(); ++i)
         {
-            items = sscanf(lp, "%f %f%n", &x, &y, &nc);
-            assert(items == 2);
-            texcoords[v][0] = x;
-            texcoords[v][1] = y;
-            lp += nc;
+            const size_t n = face_sizes[i];
+
+            // find the face by its halfedge pointing to the first vertex
+            Halfedge h;
+            const IndexType i0 = indices[corner];
+            const IndexType i1 = indices[corner + n - 1];
+            if (n && tex_sizes[i] == n && i0 < mesh.vertices_size() &&
+                i1 < mesh.vertices_size())
+                h = mesh.find_halfedge(Vertex(i1), Vertex(i0));
+
+            if (h.is_valid() && !mesh.is_boundary(h))
+            {
+                for (size_t j = 0; j < n; ++j)
+                {
+                    const IndexType t = halfedge_tex_idx[tex_corner + j];
+                    if (t < all_tex_coords.size())
+                        tex_coords[h] = all_tex_coords[t];
+                    h = mesh.next_halfedge(h);
+                }
+            }
+
+            corner += n;
+            tex_corner += tex_sizes[i];
         }
     }
 
-    // read faces: #N v[1] v[2] ... v[n-1]
-    std::vector<Vertex> vertices;
-    for (i = 0; i < nf; ++i)
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMeshIO::write_obj(const SurfaceMesh& mesh)
+{
+    FILE* out = open_output("w");
+    if (!out)
+        return false;
+
+    // comment
+    fprintf(out, "# OBJ export from SurfaceMesh\n");
+
+    //vertices
+    VertexProperty<Point> points = mesh.get_vertex_property<Point>("v:point");
+    for (SurfaceMesh::VertexIterator vit = mesh.vertices_begin();
+         vit != mesh.vertices_end(); ++vit)
     {
-        // read line
-        lp = fgets(line, 1000, in);
-        lp = line;
+        const Point& p = points[*vit];
+        fprintf(out, "v %.10f %.10f %.10f\n", p[0], p[1], p[2]);
+    }
 
-        // #vertices
-        items = sscanf(lp, "%d%n", (int*)&nv, &nc);
-        assert(items == 1);
-        vertices.resize(nv);
-        lp += nc;
+    //normals
+    VertexProperty<Point> normals = mesh.get_vertex_property<Point>("v:normal");
+    if (normals)
+    {
+        for (SurfaceMesh::VertexIterator vit = mesh.vertices_begin();
+             vit != mesh.vertices_end(); ++vit)
+        {
+            const Point& p = normals[*vit];
+            fprintf(out, "vn %.10f %.10f %.10f\n", p[0], p[1], p[2]);
+        }
+    }
 
-        // indices
-        for (j = 0; j < nv; ++j)
+    // optional texture coordinates
+    // do we have them?
+    std::vector<std::string> hprops = mesh.halfedge_properties();
+    bool with_tex_coord = false;
+    auto hpropEnd = hprops.end();
+    auto hpropStart = hprops.begin();
+    while (hpropStart != hpropEnd)
+    {
+        if (0 == (*hpropStart).compare("h:tex"))
         {
-            items = sscanf(lp, "%d%n", (int*)&idx, &nc);
-            assert(items == 1);
-            vertices[j] = Vertex(idx);
-            lp += nc;
+            with_tex_coord = true;
         }
-        if (vertices.size() == nv)
-            mesh.add_face(vertices);
-        else
+        ++hpropStart;
+    }
+
+    //if so then add
+    if (with_tex_coord)
+    {
+        HalfedgeProperty<TexCoord> texCoord =
+            mesh.get_halfedge_property<TexCoord>("h:tex");
+        for (SurfaceMesh::HalfedgeIterator hit = mesh.halfedges_begin();
+             hit != mesh.halfedges_end(); ++hit)
+        {
+            const TexCoord& pt = texCoord[*hit];
+            fprintf(out, "vt %.10f %.10f \n", pt[0], pt[1]);
+        }
+    }
+
+    //faces
+    for (SurfaceMesh::FaceIterator fit = mesh.faces_begin();
+         fit != mesh.faces_end(); ++fit)
+    {
+        fprintf(out, "f");
+        SurfaceMesh::VertexAroundFaceCirculator fvit = mesh.vertices(*fit),
+                                                fvend = fvit;
+        SurfaceMesh::HalfedgeAroundFaceCirculator fhit = mesh.halfedges(*fit);
+        do
+        {
+            if (with_tex_coord)
+            {
+                // write vertex index, texCoord index and normal index
+                fprintf(out, " %d/%d/%d", (*fvit).idx() + 1, (*fhit).idx() + 1,
+                        (*fvit).idx() + 1);
+                ++fhit;
+            }
+            else
+            {
+                // write vertex index and normal index
+                fprintf(out, " %d//%d", (*fvit).idx() + 1, (*fvit).idx() + 1);
+            }
+        } while (++fvit != fvend);
+        fprintf(out, "\n");
+    }
+
+    fclose(out);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+// the faces parsed from a part of an OFF file
+struct OffPart
+{
+    size_t first_line; // number of data lines before this part
+    std::vector<IndexType> indices, face_sizes;
+    std::vector<size_t> failed_faces;
+    size_t failed_vertex;
+};
+
+// skips blanks, returns whether the line at p contains data, i.e., is
+// neither empty nor a comment
+inline bool is_data_line(const char*& p, const char* end)
+{
+    skip_blanks(p, end);
+    return p < end && *p != '\n' && *p != '#';
+}
+
+// the signature of an OFF file: [ST][C][N][4][n]OFF [BINARY]
+struct OffHeader
+{
+    bool has_texcoords;
+    bool has_colors;
+    bool has_normals;
+    bool has_hcoords;
+    bool has_dim;
+    bool is_binary;
+};
+
+// parse the first line of an OFF file, returns false if it is no OFF file
+bool parse_off_header(const char* c, OffHeader& header)
+{
+    header.has_texcoords = (c[0] == 'S' && c[1] == 'T');
+    if (header.has_texcoords)
+        c += 2;
+    header.has_colors = (c[0] == 'C');
+    if (header.has_colors)
+        ++c;
+    header.has_normals = (c[0] == 'N');
+    if (header.has_normals)
+        ++c;
+    header.has_hcoords = (c[0] == '4');
+    if (header.has_hcoords)
+        ++c;
+    header.has_dim = (c[0] == 'n');
+    if (header.has_dim)
+        ++c;
+    if (strncmp(c, "OFF", 3) != 0)
+        return false;
+    header.is_binary = (c[3] != '\0' && strncmp(c + 4, "BINARY", 6) == 0);
+    return true;
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+bool read_off_ascii(SurfaceMesh& mesh, FILE* in, const bool has_normals,
+                    const bool has_texcoords, const bool has_colors)
+{
+    std::vector<char> text;
+    read_text(in, text);
+    const char* p = text.data();
+    const char* end = text.data() + text.size() - 1;
+
+    // #Vertice, #Faces, #Edges
+    while (p < end && !is_data_line(p, end))
+        p = next_line(p, end);
+    long long nv_in(0), nf_in(0), ne_in(0);
+    if (!parse_int(p, end, nv_in) || !parse_int(p, end, nf_in) || nv_in < 0 ||
+        nf_in < 0)
+    {
+        std::cerr << "OFF: fail to read header" << std::endl;
+        return false;
+    }
+    parse_int(p, end, ne_in);
+    p = next_line(p, end);
+    const size_t nv = nv_in, nf = nf_in;
+
+    // count data lines of each part in parallel
+    const std::vector<const char*> bounds =
+        split_lines(p, end, n_parts(end - p));
+    std::vector<OffPart> parts(bounds.size() - 1);
+    parallel_for_chunks(
+        parts.size(),
+        [&](size_t b, size_t e) {
+            for (size_t i = b; i < e; ++i)
+            {
+                size_t n = 0;
+                for (const char* q = bounds[i]; q < bounds[i + 1];
+                     q = next_line(q, bounds[i + 1]))
+                    n += is_data_line(q, bounds[i + 1]);
+                parts[i].first_line = n;
+            }
+        },
+        1);
+    size_t n_lines = 0;
+    for (auto& part : parts)
+    {
+        const size_t n = part.first_line;
+        part.first_line = n_lines;
+        n_lines += n;
+    }
+    if (n_lines < nv)
+    {
+        std::cerr << "OFF: unexpected end of file" << std::endl;
+        return false;
+    }
+
+    // vertices: pos [normal] [color] [texcoord], faces: #N v[1] ... v[N]
+    std::vector<Point> points(nv);
+    std::vector<Normal> normals(has_normals ? nv : 0);
+    std::vector<Color> colors(has_colors ? nv : 0);
+    std::vector<TexCoord> texcoords(has_texcoords ? nv : 0);
+
+    parallel_for_chunks(
+        parts.size(),
+        [&](size_t b, size_t e) {
+            for (size_t i = b; i < e; ++i)
+            {
+                OffPart& part = parts[i];
+                part.failed_vertex = PMP_MAX_INDEX;
+                size_t k = part.first_line;
+                const char* part_end = bounds[i + 1];
+                for (const char* q = bounds[i]; q < part_end && k < nv + nf;)
+                {
+                    const char* line_end = next_line(q, part_end);
+                    if (!is_data_line(q, line_end))
+                    {
+                        q = line_end;
+                        continue;
+                    }
+
+                    if (k < nv)
+                    {
+                        Point& x = points[k];
+                        bool ok = parse_scalar(q, line_end, x[0]) &&
+                                  parse_scalar(q, line_end, x[1]) &&
+                                  parse_scalar(q, line_end, x[2]);
+                        if (has_normals)
+                        {
+                            Normal& n = normals[k];
+                            parse_scalar(q, line_end, n[0]) &&
+                                parse_scalar(q, line_end, n[1]) &&
+                                parse_scalar(q, line_end, n[2]);
+                        }
+                        if (has_colors)
+                        {
+                            Color& c = colors[k];
+                            if (parse_scalar(q, line_end, c[0]) &&
+                                parse_scalar(q, line_end, c[1]) &&
+                                parse_scalar(q, line_end, c[2]) &&
+                                (c[0] > 1 || c[1] > 1 || c[2] > 1))
+                                c /= 255;
+                        }
+                        if (has_texcoords)
+                        {
+                            TexCoord& t = texcoords[k];
+                            ok = ok && parse_scalar(q, line_end, t[0]) &&
+                                 parse_scalar(q, line_end, t[1]);
+                        }
+                        if (!ok && part.failed_vertex == PMP_MAX_INDEX)
+                            part.failed_vertex = k;
+                    }
+                    else
+                    {
+                        long long n(0), idx(0), j(0);
+                        if (parse_int(q, line_end, n))
+                            for (; j < n && parse_int(q, line_end, idx); ++j)
+                                part.indices.push_back(IndexType(idx));
+                        if (n > 0 && j == n)
+                            part.face_sizes.push_back(IndexType(n));
+                        else
+                        {
+                            part.indices.resize(part.indices.size() - j);
+                            part.failed_faces.push_back(k - nv);
+                        }
+                    }
+
+                    ++k;
+                    q = line_end;
+                }
+            }
+        },
+        1);
+
+    // concatenate faces of all parts
+    std::vector<IndexType> indices, face_sizes;
+    for (auto& part : parts)
+    {
+        if (part.failed_vertex != PMP_MAX_INDEX)
+        {
+            std::cerr << "OFF: fail to read vertex " << part.failed_vertex
+                      << std::endl;
+            return false;
+        }
+        for (auto i : part.failed_faces)
             std::cerr << "OFF: fail to read face " << i << std::endl;
+        indices.insert(indices.end(), part.indices.begin(),
+                       part.indices.end());
+        face_sizes.insert(face_sizes.end(), part.face_sizes.begin(),
+                          part.face_sizes.end());
     }
+    parts.clear();
+
+    // build connectivity for all faces at once
+    mesh.build_from_indices(points, indices, face_sizes);
+
+    // properties
+    if (has_normals)
+        mesh.vertex_property<Normal>("v:normal").vector() = normals;
+    if (has_texcoords)
+        mesh.vertex_property<TexCoord>("v:tex").vector() = texcoords;
+    if (has_colors)
+        mesh.vertex_property<Color>("v:color").vector() = colors;
 
     return true;
 }
@@ -547,19 +1332,23 @@ bool read_off_binary(SurfaceMesh& mesh, FILE* in, const bool has_normals,
     }
 
     // read faces: #N v[1] v[2] ... v[n-1]
-    std::vector<Vertex> vertices;
+    std::vector<IndexType> indices, face_sizes;
+    indices.reserve(3 * nf);
+    face_sizes.reserve(nf);
     for (i = 0; i < nf; ++i)
     {
         tfread(in, nv);
-        vertices.resize(nv);
+        face_sizes.push_back(nv);
         for (j = 0; j < nv; ++j)
         {
             tfread(in, idx);
-            vertices[j] = Vertex(idx);
+            indices.push_back(idx);
         }
-        mesh.add_face(vertices);
     }
 
+    // build connectivity for all faces at once
+    mesh.add_faces(indices, face_sizes);
+
     return true;
 }
 
@@ -567,17 +1356,15 @@ bool read_off_binary(SurfaceMesh& mesh, FILE* in, const bool has_normals,
 
 bool SurfaceMeshIO::write_off_binary(const SurfaceMesh& mesh)
 {
-    FILE* out = fopen(filename_.c_str(), "w");
+    FILE* out = open_output("wb");
     if (!out)
         return false;
 
     fprintf(out, "OFF BINARY\n");
-    fclose(out);
     IndexType nv = (IndexType)mesh.n_vertices();
     IndexType nf = (IndexType)mesh.n_faces();
-    IndexType ne = 0;;
+    IndexType ne = 0;
 
-    out = fopen(filename_.c_str(), "ab");
     tfwrite(out, nv);
     tfwrite(out, nf);
     tfwrite(out, ne);
@@ -603,68 +1390,43 @@ bool SurfaceMeshIO::write_off_binary(const SurfaceMesh& mesh)
 
 bool SurfaceMeshIO::read_off(SurfaceMesh& mesh)
 {
+    PMP_PROFILE_ZONE("SurfaceMeshIO::read_off");
+
     char line[200];
-    bool has_texcoords = false;
-    bool has_normals = false;
-    bool has_colors = false;
-    bool has_hcoords = false;
-    bool has_dim = false;
-    bool is_binary = false;
 
     // open file (in ASCII mode)
-    FILE* in = fopen(filename_.c_str(), "r");
+    FILE* in = open_input("r");
     if (!in)
         return false;
 
     // read header: [ST][C][N][4][n]OFF BINARY
     char* c = fgets(line, 200, in);
     assert(c != nullptr);
-    c = line;
-    if (c[0] == 'S' && c[1] == 'T')
+    OffHeader header;
+    if (!c || !parse_off_header(line, header))
     {
-        has_texcoords = true;
-        c += 2;
-    }
-    if (c[0] == 'C')
+        fclose(in);
+        return false;
+    } // no OFF
+    const bool has_texcoords = header.has_texcoords;
+    const bool has_normals = header.has_normals;
+    const bool has_colors = header.has_colors;
+    const bool has_hcoords = header.has_hcoords;
+    const bool has_dim = header.has_dim;
+    const bool is_binary = header.is_binary;
+
+    // homogeneous coords, and vertex dimension != 3 are not supported
+    if (has_hcoords || has_dim)
     {
-        has_colors = true;
-        ++c;
-    }
-    if (c[0] == 'N')
-    {
-        has_normals = true;
-        ++c;
-    }
-    if (c[0] == '4')
-    {
-        has_hcoords = true;
-        ++c;
-    }
-    if (c[0] == 'n')
-    {
-        has_dim = true;
-        ++c;
-    }
-    if (strncmp(c, "OFF", 3) != 0)
-    {
-        fclose(in);
-        return false;
-    } // no OFF
-    if (strncmp(c + 4, "BINARY", 6) == 0)
-        is_binary = true;
-
-    // homogeneous coords, and vertex dimension != 3 are not supported
-    if (has_hcoords || has_dim)
-    {
-        fclose(in);
-        return false;
+        fclose(in);
+        return false;
     }
 
     // if binary: reopen file in binary mode
     if (is_binary)
     {
         fclose(in);
-        in = fopen(filename_.c_str(), "rb");
+        in = open_input("rb");
         c = fgets(line, 200, in);
         assert(c != nullptr);
     }
@@ -686,7 +1448,7 @@ bool SurfaceMeshIO::write_off(const SurfaceMesh& mesh)
     if (flags_.use_binary)
         return write_off_binary(mesh);
 
-    FILE* out = fopen(filename_.c_str(), "w");
+    FILE* out = open_output("w");
     if (!out)
         return false;
 
@@ -764,23 +1526,388 @@ bool SurfaceMeshIO::write_off(const SurfaceMesh& mesh)
 
 //-----------------------------------------------------------------------------
 
+namespace {
+
+// first bytes of .pmp files that record their index and scalar widths.
+// files without it use the widths of the reading build.
+const char pmp_magic[4] = {'p', 'm', 'p', '\xff'};
+
+// layouts of the data blocks following the header: packed directly after
+// the header, or each block starting at a multiple of pmp_page_size such that
+// the file can be memory-mapped, see MappedSurfaceMesh.
+const unsigned char pmp_packed = 0;
+const unsigned char pmp_page_aligned = 1;
+const uint64_t pmp_page_size = 4096;
+
+// number of data blocks: vertex, halfedge, face connectivity, points, and
+// texture coordinates
+const size_t pmp_n_blocks = 5;
+
+// number of elements converted at once
+const size_t pmp_chunk_size = 1 << 16;
+
+// seek to a 64-bit file offset
+bool seek(FILE* file, uint64_t offset)
+{
+#ifdef _WIN32
+    return _fseeki64(file, (__int64)offset, SEEK_SET) == 0;
+#else
+    return fseeko(file, (off_t)offset, SEEK_SET) == 0;
+#endif
+}
+
+// write zeros up to the next multiple of pmp_page_size, update offset
+void pad_to_page(FILE* file, uint64_t& offset)
+{
+    static const char zeros[pmp_page_size] = {0};
+    const uint64_t n = (pmp_page_size - offset % pmp_page_size) % pmp_page_size;
+    fwrite(zeros, 1, n, file);
+    offset += n;
+}
+
+// read n indices stored as S, map their invalid value to PMP_MAX_INDEX.
+// fails if an index does not fit into IndexType.
+template <class S>
+bool read_indices_as(FILE* in, IndexType* dst, size_t n)
+{
+    const S invalid = std::numeric_limits<S>::max();
+    std::vector<S> buffer(std::min(n, pmp_chunk_size));
+    for (size_t i = 0; i < n; i += buffer.size())
+    {
+        const size_t m = std::min(buffer.size(), n - i);
+        if (fread((char*)buffer.data(), sizeof(S), m, in) != m)
+            return false;
+        for (size_t j = 0; j < m; ++j)
+        {
+            if (buffer[j] == invalid)
+                dst[i + j] = PMP_MAX_INDEX;
+            else if (uint64_t(buffer[j]) >= uint64_t(PMP_MAX_INDEX))
+                return false;
+            else
+                dst[i + j] = IndexType(buffer[j]);
+        }
+    }
+    return true;
+}
+
+// read n indices stored with the given number of bytes
+bool read_indices(FILE* in, IndexType* dst, size_t n, unsigned int bytes)
+{
+    if (bytes == sizeof(IndexType))
+        return fread((char*)dst, sizeof(IndexType), n, in) == n;
+    if (bytes == 4)
+        return read_indices_as<uint32_t>(in, dst, n);
+    if (bytes == 8)
+        return read_indices_as<uint64_t>(in, dst, n);
+    return false;
+}
+
+// read n scalars stored as S
+template <class S>
+bool read_scalars_as(FILE* in, Scalar* dst, size_t n)
+{
+    std::vector<S> buffer(std::min(n, pmp_chunk_size));
+    for (size_t i = 0; i < n; i += buffer.size())
+    {
+        const size_t m = std::min(buffer.size(), n - i);
+        if (fread((char*)buffer.data(), sizeof(S), m, in) != m)
+            return false;
+        for (size_t j = 0; j < m; ++j)
+            dst[i + j] = Scalar(buffer[j]);
+    }
+    return true;
+}
+
+// read n scalars stored with the given number of bytes
+bool read_scalars(FILE* in, Scalar* dst, size_t n, unsigned int bytes)
+{
+    if (bytes == sizeof(Scalar))
+        return fread((char*)dst, sizeof(Scalar), n, in) == n;
+    if (bytes == 4)
+        return read_scalars_as<float>(in, dst, n);
+    if (bytes == 8)
+        return read_scalars_as<double>(in, dst, n);
+    return false;
+}
+
+
+// element kinds of properties stored in the property table
+enum PmpKind
+{
+    pmp_object = 0,
+    pmp_vertex = 1,
+    pmp_halfedge = 2,
+    pmp_edge = 3,
+    pmp_face = 4
+};
+
+// type ids of property values that can be stored, 0 means unsupported
+template <class T>
+struct PmpType
+{
+    static const unsigned char id = 0;
+};
+
+#define PMP_PROPERTY_TYPE(T, i)              \
+    template <>                              \
+    struct PmpType<T>                        \
+    {                                        \
+        static const unsigned char id = i;   \
+    }
+
+PMP_PROPERTY_TYPE(bool, 1);
+PMP_PROPERTY_TYPE(int, 2);
+PMP_PROPERTY_TYPE(unsigned int, 3);
+PMP_PROPERTY_TYPE(float, 4);
+PMP_PROPERTY_TYPE(double, 5);
+PMP_PROPERTY_TYPE(vec2, 6);
+PMP_PROPERTY_TYPE(vec3, 7);
+PMP_PROPERTY_TYPE(dvec2, 8);
+PMP_PROPERTY_TYPE(dvec3, 9);
+PMP_PROPERTY_TYPE(Vertex, 10);
+PMP_PROPERTY_TYPE(Halfedge, 11);
+PMP_PROPERTY_TYPE(Edge, 12);
+PMP_PROPERTY_TYPE(Face, 13);
+PMP_PROPERTY_TYPE(Flag, 14);
+PMP_PROPERTY_TYPE(std::uint8_t, 15);
+PMP_PROPERTY_TYPE(std::uint16_t, 16);
+PMP_PROPERTY_TYPE(OctNormal, 17);
+PMP_PROPERTY_TYPE(TexCoord16, 18);
+
+#undef PMP_PROPERTY_TYPE
+
+// a property to be written to the property table
+struct PmpBlock
+{
+    std::string name;
+    unsigned char kind;
+    unsigned char type;
+    uint32_t value_bytes;
+    uint64_t n;
+    const char* data;
+    std::vector<char> buffer; // converted data of bool properties
+
+    const char* bytes() const { return buffer.empty() ? data : buffer.data(); }
+};
+
+// properties that are part of the fixed data blocks or only used for
+// garbage collection
+bool is_builtin_property(const std::string& name)
+{
+    return name == "v:point" || name == "v:connectivity" ||
+           name == "h:connectivity" || name == "f:connectivity" ||
+           name == "v:deleted" || name == "e:deleted" ||
+           name == "f:deleted" || name == "h:tex";
+}
+
+// add property name of container to blocks if it has type T
+template <class T>
+bool add_block(const PropertyContainer& container, const std::string& name,
+               unsigned char kind, std::vector<PmpBlock>& blocks)
+{
+    Property<T> p = container.get<T>(name);
+    if (!p)
+        return false;
+
+    PmpBlock block;
+    block.name = name;
+    block.kind = kind;
+    block.type = PmpType<T>::id;
+    block.value_bytes = sizeof(T);
+    block.n = container.size();
+    block.data = block.n ? (const char*)p.data() : nullptr;
+    blocks.push_back(block);
+    return true;
+}
+
+// bool properties are stored as one byte per value
+template <>
+bool add_block<bool>(const PropertyContainer& container,
+                     const std::string& name, unsigned char kind,
+                     std::vector<PmpBlock>& blocks)
+{
+    Property<bool> p = container.get<bool>(name);
+    if (!p)
+        return false;
+
+    PmpBlock block;
+    block.name = name;
+    block.kind = kind;
+    block.type = PmpType<bool>::id;
+    block.value_bytes = 1;
+    block.n = container.size();
+    block.data = nullptr;
+    block.buffer.resize(block.n);
+    for (size_t i = 0; i < block.n; ++i)
+        block.buffer[i] = p[i] ? 1 : 0;
+    blocks.push_back(block);
+    return true;
+}
+
+// collect all properties of container with a supported type
+void add_blocks(const PropertyContainer& container, unsigned char kind,
+                std::vector<PmpBlock>& blocks)
+{
+    for (auto name : container.properties())
+    {
+        // compact "h:tex" is not part of the fixed data blocks
+        if (is_builtin_property(name) &&
+            (name != "h:tex" || container.get<TexCoord>(name)))
+            continue;
+        add_block<bool>(container, name, kind, blocks) ||
+            add_block<int>(container, name, kind, blocks) ||
+            add_block<unsigned int>(container, name, kind, blocks) ||
+            add_block<float>(container, name, kind, blocks) ||
+            add_block<double>(container, name, kind, blocks) ||
+            add_block<vec2>(container, name, kind, blocks) ||
+            add_block<vec3>(container, name, kind, blocks) ||
+            add_block<dvec2>(container, name, kind, blocks) ||
+            add_block<dvec3>(container, name, kind, blocks) ||
+            add_block<Vertex>(container, name, kind, blocks) ||
+            add_block<Halfedge>(container, name, kind, blocks) ||
+            add_block<Edge>(container, name, kind, blocks) ||
+            add_block<Face>(container, name, kind, blocks) ||
+            add_block<Flag>(container, name, kind, blocks) ||
+            add_block<std::uint8_t>(container, name, kind, blocks) ||
+            add_block<std::uint16_t>(container, name, kind, blocks) ||
+            add_block<OctNormal>(container, name, kind, blocks) ||
+            add_block<TexCoord16>(container, name, kind, blocks);
+    }
+}
+
+// read n values of type T into the property name of container
+template <class T>
+bool read_block(FILE* in, PropertyContainer& container,
+                const std::string& name, uint64_t n)
+{
+    Property<T> p = container.get_or_add<T>(name);
+    if (!p)
+        return false;
+    return fread((char*)p.vector().data(), sizeof(T), n, in) == n;
+}
+
+template <>
+bool read_block<bool>(FILE* in, PropertyContainer& container,
+                      const std::string& name, uint64_t n)
+{
+    Property<bool> p = container.get_or_add<bool>(name);
+    if (!p)
+        return false;
+    std::vector<char> buffer(n);
+    if (fread(buffer.data(), 1, n, in) != n)
+        return false;
+    for (size_t i = 0; i < n; ++i)
+        p[i] = buffer[i] != 0;
+    return true;
+}
+
+// read a property with type id type. returns false for unknown types.
+bool read_block(FILE* in, PropertyContainer& container,
+                const std::string& name, unsigned char type,
+                uint32_t value_bytes, uint64_t n)
+{
+#define PMP_READ_BLOCK(T)                                        \
+    if (type == PmpType<T>::id)                                  \
+        return (value_bytes == (std::is_same<T, bool>::value     \
+                                    ? 1                          \
+                                    : sizeof(T))) &&             \
+               read_block<T>(in, container, name, n)
+
+    PMP_READ_BLOCK(bool);
+    PMP_READ_BLOCK(int);
+    PMP_READ_BLOCK(unsigned int);
+    PMP_READ_BLOCK(float);
+    PMP_READ_BLOCK(double);
+    PMP_READ_BLOCK(vec2);
+    PMP_READ_BLOCK(vec3);
+    PMP_READ_BLOCK(dvec2);
+    PMP_READ_BLOCK(dvec3);
+    PMP_READ_BLOCK(Vertex);
+    PMP_READ_BLOCK(Halfedge);
+    PMP_READ_BLOCK(Edge);
+    PMP_READ_BLOCK(Face);
+    PMP_READ_BLOCK(Flag);
+    PMP_READ_BLOCK(std::uint8_t);
+    PMP_READ_BLOCK(std::uint16_t);
+    PMP_READ_BLOCK(OctNormal);
+    PMP_READ_BLOCK(TexCoord16);
+
+#undef PMP_READ_BLOCK
+    return false;
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
 bool SurfaceMeshIO::read_pmp(SurfaceMesh& mesh)
 {
+    PMP_PROFILE_ZONE("SurfaceMeshIO::read_pmp");
+
     // open file (in binary mode)
-    FILE* in = fopen(filename_.c_str(), "rb");
+    FILE* in = open_input("rb");
     if (!in)
         return false;
 
+    // widths of indices and scalars in the file
+    unsigned char index_bytes(sizeof(IndexType)), scalar_bytes(sizeof(Scalar));
+    unsigned char has_htex(0), layout(pmp_packed);
+
     // how many elements?
-    unsigned int nv(0), ne(0), nh(0), nf(0);
-    tfread(in, nv);
-    tfread(in, ne);
-    tfread(in, nf);
+    uint64_t nv(0), ne(0), nh(0), nf(0);
+
+    // file offsets of the data blocks and the property table, if page-aligned
+    uint64_t offsets[pmp_n_blocks] = {0};
+    uint64_t table_offset(0);
+
+    char magic[4];
+    if (fread(magic, 1, 4, in) == 4 && memcmp(magic, pmp_magic, 4) == 0)
+    {
+        tfread(in, index_bytes);
+        tfread(in, scalar_bytes);
+        tfread(in, has_htex);
+        tfread(in, layout);
+        tfread(in, nv);
+        tfread(in, ne);
+        tfread(in, nf);
+        if (layout == pmp_page_aligned)
+        {
+            for (size_t i = 0; i < pmp_n_blocks; ++i)
+                tfread(in, offsets[i]);
+            tfread(in, table_offset);
+        }
+        else if (layout != pmp_packed)
+        {
+            std::cerr << "read_pmp: unknown layout" << std::endl;
+            fclose(in);
+            return false;
+        }
+    }
+    else
+    {
+        // files written before the widths were recorded
+        rewind(in);
+        unsigned int n;
+        tfread(in, n);
+        nv = n;
+        tfread(in, n);
+        ne = n;
+        tfread(in, n);
+        nf = n;
+        bool htex;
+        tfread(in, htex);
+        has_htex = htex;
+    }
     nh = 2 * ne;
 
-    // texture coordinates?
-    bool has_htex(false);
-    tfread(in, has_htex);
+    if (nv >= PMP_MAX_INDEX || nh >= PMP_MAX_INDEX || nf >= PMP_MAX_INDEX)
+    {
+        std::cerr << "read_pmp: mesh is too large for the index type of this "
+                     "build"
+                  << std::endl;
+        fclose(in);
+        return false;
+    }
 
     // resize containers
     mesh.vprops_.resize(nv);
@@ -797,28 +1924,131 @@ bool SurfaceMeshIO::read_pmp(SurfaceMesh& mesh)
         mesh.face_property<SurfaceMesh::FaceConnectivity>("f:connectivity");
     auto point = mesh.vertex_property<Point>("v:point");
 
-    // read properties from file
-    size_t nvc = fread((char*)vconn.data(),
-                       sizeof(SurfaceMesh::VertexConnectivity), nv, in);
-    size_t nhc = fread((char*)hconn.data(),
-                       sizeof(SurfaceMesh::HalfedgeConnectivity), nh, in);
-    size_t nfc = fread((char*)fconn.data(),
-                       sizeof(SurfaceMesh::FaceConnectivity), nf, in);
-    size_t np = fread((char*)point.data(), sizeof(Point), nv, in);
-    PMP_ASSERT(nvc == nv);
-    PMP_ASSERT(nhc == nh);
-    PMP_ASSERT(nfc == nf);
-    PMP_ASSERT(np == nv);
+    // read properties from file, converting widths if necessary. files
+    // always store face, vertex, next, and previous halfedge.
+    const size_t vn = sizeof(SurfaceMesh::VertexConnectivity) / sizeof(IndexType);
+    const size_t hn = 4;
+    const size_t fn = sizeof(SurfaceMesh::FaceConnectivity) / sizeof(IndexType);
+#ifdef PMP_NO_PREV_HALFEDGE
+    std::vector<IndexType> hfile(hn * nh);
+    IndexType* hdata = hfile.data();
+#else
+    IndexType* hdata = (IndexType*)hconn.data();
+#endif
+    const bool aligned = (layout == pmp_page_aligned);
+    bool ok = (!aligned || seek(in, offsets[0])) &&
+              read_indices(in, (IndexType*)vconn.data(), vn * nv, index_bytes) &&
+              (!aligned || seek(in, offsets[1])) &&
+              read_indices(in, hdata, hn * nh, index_bytes) &&
+              (!aligned || seek(in, offsets[2])) &&
+              read_indices(in, (IndexType*)fconn.data(), fn * nf, index_bytes) &&
+              (!aligned || seek(in, offsets[3])) &&
+              read_scalars(in, (Scalar*)point.data(), 3 * nv, scalar_bytes);
+
+#ifdef PMP_NO_PREV_HALFEDGE
+    // drop the previous halfedges
+    for (size_t i = 0; ok && i < nh; ++i)
+    {
+        auto& conn = hconn[Halfedge(static_cast<IndexType>(i))];
+        conn.face_ = Face(hfile[hn * i]);
+        conn.vertex_ = Vertex(hfile[hn * i + 1]);
+        conn.next_halfedge_ = Halfedge(hfile[hn * i + 2]);
+    }
+#endif
 
     // read texture coordiantes
-    if (has_htex)
+    if (ok && has_htex)
     {
         auto htex = mesh.halfedge_property<TexCoord>("h:tex");
-        size_t nhtc = fread((char*)htex.data(), sizeof(TexCoord), nh, in);
-        PMP_ASSERT(nhtc == nh);
+        ok = (!aligned || seek(in, offsets[4])) &&
+             read_scalars(in, (Scalar*)htex.data(), 2 * nh, scalar_bytes);
     }
 
+    // read the requested entries of the property table
+    if (ok && table_offset && flags_.use_custom_properties)
+        ok = read_pmp_properties(in, mesh, table_offset);
+
     fclose(in);
+
+    if (!ok)
+    {
+        std::cerr << "read_pmp: failed to read " << filename_ << std::endl;
+        mesh.clear();
+    }
+    return ok;
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMeshIO::read_pmp_properties(FILE* in, SurfaceMesh& mesh,
+                                        uint64_t table_offset)
+{
+    struct Entry
+    {
+        std::string name;
+        unsigned char kind, type;
+        uint32_t value_bytes;
+        uint64_t n, offset;
+    };
+
+    // read the table
+    uint64_t n_entries(0);
+    if (!seek(in, table_offset) || fread(&n_entries, 8, 1, in) != 1)
+        return false;
+
+    std::vector<Entry> entries;
+    for (uint64_t i = 0; i < n_entries; ++i)
+    {
+        Entry e;
+        uint16_t length(0);
+        tfread(in, e.kind);
+        tfread(in, e.type);
+        tfread(in, length);
+        tfread(in, e.value_bytes);
+        tfread(in, e.n);
+        tfread(in, e.offset);
+        e.name.resize(length);
+        if (length && fread(&e.name[0], 1, length, in) != length)
+            return false;
+        entries.push_back(e);
+    }
+
+    // load the requested properties only
+    const std::vector<std::string>& names = flags_.custom_properties;
+    for (auto& e : entries)
+    {
+        if (!names.empty() &&
+            std::find(names.begin(), names.end(), e.name) == names.end())
+            continue;
+
+        PropertyContainer* container(nullptr);
+        switch (e.kind)
+        {
+            case pmp_object:
+                container = &mesh.oprops_;
+                break;
+            case pmp_vertex:
+                container = &mesh.vprops_;
+                break;
+            case pmp_halfedge:
+                container = &mesh.hprops_;
+                break;
+            case pmp_edge:
+                container = &mesh.eprops_;
+                break;
+            case pmp_face:
+                container = &mesh.fprops_;
+                break;
+        }
+
+        if (!container || container->size() != e.n || !seek(in, e.offset) ||
+            !read_block(in, *container, e.name, e.type, e.value_bytes, e.n))
+        {
+            std::cerr << "read_pmp: skipping property " << e.name
+                      << std::endl;
+        }
+    }
+
     return true;
 }
 
@@ -826,8 +2056,10 @@ bool SurfaceMeshIO::read_pmp(SurfaceMesh& mesh)
 
 bool SurfaceMeshIO::read_xyz(SurfaceMesh& mesh)
 {
+    PMP_PROFILE_ZONE("SurfaceMeshIO::read_xyz");
+
     // open file (in ASCII mode)
-    FILE* in = fopen(filename_.c_str(), "r");
+    FILE* in = open_input("r");
     if (!in)
         return false;
 
@@ -864,8 +2096,10 @@ bool SurfaceMeshIO::read_xyz(SurfaceMesh& mesh)
 // \todo remove duplication with read_xyz
 bool SurfaceMeshIO::read_agi(SurfaceMesh& mesh)
 {
+    PMP_PROFILE_ZONE("SurfaceMeshIO::read_agi");
+
     // open file (in ASCII mode)
-    FILE* in = fopen(filename_.c_str(), "r");
+    FILE* in = open_input("r");
     if (!in)
         return false;
 
@@ -902,7 +2136,7 @@ bool SurfaceMeshIO::read_agi(SurfaceMesh& mesh)
 bool SurfaceMeshIO::write_pmp(const SurfaceMesh& mesh)
 {
     // open file (in binary mode)
-    FILE* out = fopen(filename_.c_str(), "wb");
+    FILE* out = open_output("wb");
     if (!out)
         return false;
 
@@ -917,29 +2151,116 @@ bool SurfaceMeshIO::write_pmp(const SurfaceMesh& mesh)
     auto htex = mesh.get_halfedge_property<TexCoord>("h:tex");
 
     // how many elements?
-    unsigned int nv, ne, nh, nf;
+    uint64_t nv, ne, nh, nf;
     nv = mesh.n_vertices();
     ne = mesh.n_edges();
     nh = mesh.n_halfedges();
     nf = mesh.n_faces();
 
-    // write header
+#ifdef PMP_NO_PREV_HALFEDGE
+    // files always store face, vertex, next, and previous halfedge
+    std::vector<IndexType> hfile(4 * nh);
+    for (size_t i = 0; i < nh; ++i)
+    {
+        const Halfedge h(static_cast<IndexType>(i));
+        const IndexType next = hconn[h].next_halfedge_.idx();
+        hfile[4 * i] = hconn[h].face_.idx();
+        hfile[4 * i + 1] = hconn[h].vertex_.idx();
+        hfile[4 * i + 2] = next;
+        hfile[4 * next + 3] = h.idx();
+    }
+    const char* hdata = (const char*)hfile.data();
+#else
+    const char* hdata = (const char*)hconn.data();
+#endif
+
+    // sizes of the data blocks
+    const uint64_t sizes[pmp_n_blocks] = {
+        nv * sizeof(SurfaceMesh::VertexConnectivity),
+        nh * 4 * sizeof(IndexType),
+        nf * sizeof(SurfaceMesh::FaceConnectivity), nv * sizeof(Point),
+        htex ? nh * sizeof(TexCoord) : 0};
+
+    // further properties
+    std::vector<PmpBlock> blocks;
+    if (flags_.use_custom_properties)
+    {
+        add_blocks(mesh.oprops_, pmp_object, blocks);
+        add_blocks(mesh.vprops_, pmp_vertex, blocks);
+        add_blocks(mesh.hprops_, pmp_halfedge, blocks);
+        add_blocks(mesh.eprops_, pmp_edge, blocks);
+        add_blocks(mesh.fprops_, pmp_face, blocks);
+    }
+
+    // page-aligned offsets of the data blocks
+    const uint64_t header_size =
+        4 + 4 + 3 * sizeof(uint64_t) + (pmp_n_blocks + 1) * sizeof(uint64_t);
+    uint64_t offsets[pmp_n_blocks];
+    std::vector<uint64_t> block_offsets(blocks.size());
+    uint64_t offset = header_size;
+    for (size_t i = 0; i < pmp_n_blocks; ++i)
+    {
+        offset += (pmp_page_size - offset % pmp_page_size) % pmp_page_size;
+        offsets[i] = sizes[i] ? offset : 0;
+        offset += sizes[i];
+    }
+    for (size_t i = 0; i < blocks.size(); ++i)
+    {
+        offset += (pmp_page_size - offset % pmp_page_size) % pmp_page_size;
+        block_offsets[i] = offset;
+        offset += blocks[i].n * blocks[i].value_bytes;
+    }
+    const uint64_t table_offset = blocks.empty() ? 0 : offset;
+
+    // write header, recording the widths of indices and scalars
+    fwrite(pmp_magic, 1, 4, out);
+    tfwrite(out, (unsigned char)sizeof(IndexType));
+    tfwrite(out, (unsigned char)sizeof(Scalar));
+    tfwrite(out, (unsigned char)(htex ? 1 : 0));
+    tfwrite(out, pmp_page_aligned);
     tfwrite(out, nv);
     tfwrite(out, ne);
     tfwrite(out, nf);
-    tfwrite(out, (bool)htex);
+    tfwrite(out, offsets);
+    tfwrite(out, table_offset);
 
     // write properties to file
-    fwrite((char*)vconn.data(), sizeof(SurfaceMesh::VertexConnectivity), nv,
-           out);
-    fwrite((char*)hconn.data(), sizeof(SurfaceMesh::HalfedgeConnectivity), nh,
-           out);
-    fwrite((char*)fconn.data(), sizeof(SurfaceMesh::FaceConnectivity), nf, out);
-    fwrite((char*)point.data(), sizeof(Point), nv, out);
+    const char* data[pmp_n_blocks] = {
+        (const char*)vconn.data(), hdata,
+        (const char*)fconn.data(), (const char*)point.data(),
+        htex ? (const char*)htex.data() : nullptr};
+    offset = header_size;
+    for (size_t i = 0; i < pmp_n_blocks; ++i)
+    {
+        if (!sizes[i])
+            continue;
+        pad_to_page(out, offset);
+        fwrite(data[i], 1, sizes[i], out);
+        offset += sizes[i];
+    }
+
+    // write further properties and the table describing them
+    if (!blocks.empty())
+    {
+        for (auto& b : blocks)
+        {
+            pad_to_page(out, offset);
+            fwrite(b.bytes(), b.value_bytes, b.n, out);
+            offset += b.n * b.value_bytes;
+        }
 
-    // texture coordinates
-    if (htex)
-        fwrite((char*)htex.data(), sizeof(TexCoord), nh, out);
+        tfwrite(out, (uint64_t)blocks.size());
+        for (size_t i = 0; i < blocks.size(); ++i)
+        {
+            tfwrite(out, blocks[i].kind);
+            tfwrite(out, blocks[i].type);
+            tfwrite(out, (uint16_t)blocks[i].name.size());
+            tfwrite(out, blocks[i].value_bytes);
+            tfwrite(out, blocks[i].n);
+            tfwrite(out, block_offsets[i]);
+            fwrite(blocks[i].name.data(), 1, blocks[i].name.size(), out);
+        }
+    }
 
     fclose(out);
     return true;
@@ -947,170 +2268,788 @@ bool SurfaceMeshIO::write_pmp(const SurfaceMesh& mesh)
 
 //-----------------------------------------------------------------------------
 
-// helper to assemble vertex data
-static int vertexCallback(p_ply_argument argument)
-{
-    long idx;
-    void* pdata;
-    ply_get_argument_user_data(argument, &pdata, &idx);
-
-    auto* mesh = (pmp::SurfaceMesh*)pdata;
-    auto point = mesh->get_object_property<pmp::Point>("g:point");
-    point[0][idx] = ply_get_argument_value(argument);
+namespace {
 
-    if (idx == 2)
-        mesh->add_vertex(point[0]);
+// scalar types of PLY properties
+enum PlyType
+{
+    ply_int8,
+    ply_uint8,
+    ply_int16,
+    ply_uint16,
+    ply_int32,
+    ply_uint32,
+    ply_float32,
+    ply_float64,
+    ply_invalid
+};
 
-    return 1;
+PlyType ply_type(const std::string& name)
+{
+    if (name == "char" || name == "int8")
+        return ply_int8;
+    if (name == "uchar" || name == "uint8")
+        return ply_uint8;
+    if (name == "short" || name == "int16")
+        return ply_int16;
+    if (name == "ushort" || name == "uint16")
+        return ply_uint16;
+    if (name == "int" || name == "int32")
+        return ply_int32;
+    if (name == "uint" || name == "uint32")
+        return ply_uint32;
+    if (name == "float" || name == "float32")
+        return ply_float32;
+    if (name == "double" || name == "float64")
+        return ply_float64;
+    return ply_invalid;
 }
 
-//-----------------------------------------------------------------------------
-
-// helper to assemble face data
-static int faceCallback(p_ply_argument argument)
+size_t ply_size(PlyType type)
 {
-    long length, value_index;
-    void* pdata;
-    long idata;
-    ply_get_argument_user_data(argument, &pdata, &idata);
-    ply_get_argument_property(argument, nullptr, &length, &value_index);
-
-    auto* mesh = (pmp::SurfaceMesh*)pdata;
-    auto vertices =
-        mesh->get_object_property<std::vector<pmp::Vertex>>("g:vertices");
-
-    if (value_index == 0)
-        vertices[0].clear();
-
-    pmp::IndexType idx = (pmp::IndexType)ply_get_argument_value(argument);
-    vertices[0].push_back(pmp::Vertex(idx));
-
-    if (value_index == length - 1)
-        mesh->add_face(vertices[0]);
-
-    return 1;
+    static const size_t sizes[] = {1, 1, 2, 2, 4, 4, 4, 8, 0};
+    return sizes[type];
 }
 
-//-----------------------------------------------------------------------------
-
-bool SurfaceMeshIO::read_ply(SurfaceMesh& mesh)
+inline bool ply_is_integer(PlyType type)
 {
-    // add object properties to hold temporary data
-    auto point = mesh.add_object_property<Point>("g:point");
-    auto vertices = mesh.add_object_property<std::vector<Vertex>>("g:vertices");
-
-    // open file, read header
-    p_ply ply = ply_open(filename_.c_str(), nullptr, 0, nullptr);
-
-    if (!ply)
-        return false;
-
-    if (!ply_read_header(ply))
-        return false;
-
-    // setup callbacks for basic properties
-    ply_set_read_cb(ply, "vertex", "x", vertexCallback, &mesh, 0);
-    ply_set_read_cb(ply, "vertex", "y", vertexCallback, &mesh, 1);
-    ply_set_read_cb(ply, "vertex", "z", vertexCallback, &mesh, 2);
-
-    ply_set_read_cb(ply, "face", "vertex_indices", faceCallback, &mesh, 0);
-
-    // read the data
-    if (!ply_read(ply))
-        return false;
-
-    ply_close(ply);
-
-    // clean-up properties
-    mesh.remove_object_property(point);
-    mesh.remove_object_property(vertices);
-
-    return true;
+    return type < ply_float32;
 }
 
-//-----------------------------------------------------------------------------
+// the attribute a vertex or face property is read into
+enum PlyTarget
+{
+    ply_skip,
+    ply_x,
+    ply_y,
+    ply_z,
+    ply_nx,
+    ply_ny,
+    ply_nz,
+    ply_red,
+    ply_green,
+    ply_blue,
+    ply_quality,
+    ply_u,
+    ply_v,
+    ply_indices
+};
 
-bool SurfaceMeshIO::write_ply(const SurfaceMesh& mesh)
+struct PlyProperty
 {
-    e_ply_storage_mode mode = flags_.use_binary ? PLY_LITTLE_ENDIAN : PLY_ASCII;
-    p_ply ply = ply_create(filename_.c_str(), mode, nullptr, 0, nullptr);
+    std::string name;
+    PlyType type;       // value type
+    PlyType count_type; // type of the list length, ply_invalid for scalars
+    PlyTarget target;
+};
 
-    ply_add_comment(ply, "File written with pmp-library");
-    ply_add_element(ply, "vertex", mesh.n_vertices());
-    ply_add_scalar_property(ply, "x", PLY_FLOAT);
-    ply_add_scalar_property(ply, "y", PLY_FLOAT);
-    ply_add_scalar_property(ply, "z", PLY_FLOAT);
-    ply_add_element(ply, "face", mesh.n_faces());
-    ply_add_property(ply, "vertex_indices", PLY_LIST, PLY_UCHAR, PLY_INT);
-    ply_write_header(ply);
+struct PlyElement
+{
+    std::string name;
+    size_t count;
+    std::vector<PlyProperty> properties;
 
-    // write vertices
-    auto points = mesh.get_vertex_property<Point>("v:point");
-    for (auto v : mesh.vertices())
+    // record size if all properties are scalars, 0 otherwise
+    size_t record_size() const
     {
-        ply_write(ply, points[v][0]);
-        ply_write(ply, points[v][1]);
-        ply_write(ply, points[v][2]);
+        size_t size = 0;
+        for (const auto& p : properties)
+        {
+            if (p.count_type != ply_invalid)
+                return 0;
+            size += ply_size(p.type);
+        }
+        return size;
     }
+};
 
-    // write faces
-    for (auto f : mesh.faces())
+PlyTarget ply_target(const std::string& element, const std::string& name)
+{
+    if (element == "vertex")
     {
-        ply_write(ply, mesh.valence(f));
-        for (auto fv : mesh.vertices(f))
-            ply_write(ply, fv.idx());
+        if (name == "x")
+            return ply_x;
+        if (name == "y")
+            return ply_y;
+        if (name == "z")
+            return ply_z;
+        if (name == "nx")
+            return ply_nx;
+        if (name == "ny")
+            return ply_ny;
+        if (name == "nz")
+            return ply_nz;
+        if (name == "quality")
+            return ply_quality;
+        if (name == "u" || name == "s" || name == "texture_u")
+            return ply_u;
+        if (name == "v" || name == "t" || name == "texture_v")
+            return ply_v;
+    }
+    if (element == "face" &&
+        (name == "vertex_indices" || name == "vertex_index"))
+        return ply_indices;
+    if (element == "vertex" || element == "face")
+    {
+        if (name == "red" || name == "diffuse_red")
+            return ply_red;
+        if (name == "green" || name == "diffuse_green")
+            return ply_green;
+        if (name == "blue" || name == "diffuse_blue")
+            return ply_blue;
     }
+    return ply_skip;
+}
 
-    ply_close(ply);
-    return true;
+inline bool is_little_endian()
+{
+    const uint16_t one = 1;
+    unsigned char c;
+    memcpy(&c, &one, 1);
+    return c == 1;
 }
 
-//-----------------------------------------------------------------------------
+// read a header line without the line break
+bool read_header_line(FILE* in, std::string& line)
+{
+    line.clear();
+    int c;
+    while ((c = fgetc(in)) != EOF && c != '\n')
+        if (c != '\r')
+            line.push_back(char(c));
+    return c != EOF || !line.empty();
+}
 
-// helper class for STL reader
-class CmpVec
+// parse the PLY header, leaves the file at the beginning of the data
+bool read_ply_header(FILE* in, bool& binary, bool& swap,
+                     std::vector<PlyElement>& elements)
 {
-public:
-    CmpVec(float eps = FLT_MIN) : eps_(eps) {}
+    std::string line, keyword;
+    if (!read_header_line(in, line) || line != "ply")
+        return false;
 
-    bool operator()(const vec3& v0, const vec3& v1) const
+    bool has_format = false;
+    while (read_header_line(in, line))
     {
-        if (fabs(v0[0] - v1[0]) <= eps_)
+        std::istringstream words(line);
+        words >> keyword;
+
+        if (keyword == "format")
+        {
+            std::string format;
+            words >> format;
+            binary = format != "ascii";
+            if (format == "binary_little_endian")
+                swap = !is_little_endian();
+            else if (format == "binary_big_endian")
+                swap = is_little_endian();
+            else if (format != "ascii")
+                return false;
+            has_format = true;
+        }
+        else if (keyword == "element")
+        {
+            PlyElement element;
+            words >> element.name >> element.count;
+            if (!words)
+                return false;
+            elements.push_back(element);
+        }
+        else if (keyword == "property")
         {
-            if (fabs(v0[1] - v1[1]) <= eps_)
+            if (elements.empty())
+                return false;
+            PlyProperty property;
+            std::string type;
+            words >> type;
+            if (type == "list")
             {
-                return (v0[2] < v1[2] - eps_);
+                std::string count_type;
+                words >> count_type >> type;
+                property.count_type = ply_type(count_type);
+                if (property.count_type == ply_invalid ||
+                    !ply_is_integer(property.count_type))
+                    return false;
             }
             else
-                return (v0[1] < v1[1] - eps_);
+                property.count_type = ply_invalid;
+            property.type = ply_type(type);
+            words >> property.name;
+            if (!words || property.type == ply_invalid)
+                return false;
+            property.target = ply_target(elements.back().name, property.name);
+            if ((property.target == ply_indices) !=
+                (property.count_type != ply_invalid))
+                property.target = ply_skip;
+            elements.back().properties.push_back(property);
         }
-        else
-            return (v0[0] < v1[0] - eps_);
+        else if (keyword == "end_header")
+            return has_format;
     }
+    return false;
+}
 
-private:
-    float eps_;
-};
-
-//-----------------------------------------------------------------------------
-
-bool SurfaceMeshIO::read_stl(SurfaceMesh& mesh)
+// decode a binary value of the given type
+inline double ply_decode(const char* data, PlyType type, bool swap)
 {
-    char line[100], *c;
-    unsigned int i, nT(0);
-    vec3 p;
-    Vertex v;
-    std::vector<Vertex> vertices(3);
-    size_t n_items(0);
-
-    CmpVec comp(FLT_MIN);
-    std::map<vec3, Vertex, CmpVec> vMap(comp);
-    std::map<vec3, Vertex, CmpVec>::iterator vMapIt;
+    char bytes[8];
+    const size_t size = ply_size(type);
+    if (swap)
+        for (size_t i = 0; i < size; ++i)
+            bytes[i] = data[size - 1 - i];
+    else
+        memcpy(bytes, data, size);
 
-    // open file (in ASCII mode)
-    FILE* in = fopen(filename_.c_str(), "r");
-    if (!in)
-        return false;
+    switch (type)
+    {
+        case ply_int8:
+            return double(*(const int8_t*)bytes);
+        case ply_uint8:
+            return double(*(const uint8_t*)bytes);
+        case ply_int16:
+        {
+            int16_t x;
+            memcpy(&x, bytes, sizeof(x));
+            return double(x);
+        }
+        case ply_uint16:
+        {
+            uint16_t x;
+            memcpy(&x, bytes, sizeof(x));
+            return double(x);
+        }
+        case ply_int32:
+        {
+            int32_t x;
+            memcpy(&x, bytes, sizeof(x));
+            return double(x);
+        }
+        case ply_uint32:
+        {
+            uint32_t x;
+            memcpy(&x, bytes, sizeof(x));
+            return double(x);
+        }
+        case ply_float32:
+        {
+            float x;
+            memcpy(&x, bytes, sizeof(x));
+            return double(x);
+        }
+        case ply_float64:
+        {
+            double x;
+            memcpy(&x, bytes, sizeof(x));
+            return x;
+        }
+        default:
+            return 0.0;
+    }
+}
+
+// sequential access to the values of ASCII or binary PLY data
+class PlyCursor
+{
+public:
+    PlyCursor(const char* begin, const char* end, bool binary, bool swap)
+        : p_(begin), end_(end), binary_(binary), swap_(swap)
+    {
+    }
+
+    bool value(PlyType type, double& x)
+    {
+        if (binary_)
+        {
+            const size_t size = ply_size(type);
+            if (size_t(end_ - p_) < size)
+                return false;
+            x = ply_decode(p_, type, swap_);
+            p_ += size;
+            return true;
+        }
+
+        while (p_ < end_ && isspace((unsigned char)*p_))
+            ++p_;
+        if (ply_is_integer(type))
+        {
+            long long i;
+            if (!parse_int(p_, end_, i))
+                return false;
+            x = double(i);
+        }
+        else
+        {
+            Scalar s;
+            if (!parse_scalar(p_, end_, s))
+                return false;
+            x = double(s);
+        }
+        return true;
+    }
+
+    // skip n bytes of binary data
+    bool skip(size_t n)
+    {
+        if (size_t(end_ - p_) < n)
+            return false;
+        p_ += n;
+        return true;
+    }
+
+    const char* position() const { return p_; }
+
+private:
+    const char* p_;
+    const char* end_;
+    bool binary_;
+    bool swap_;
+};
+
+// the vertex attributes read from a PLY file
+struct PlyVertices
+{
+    std::vector<Point> points;
+    std::vector<Normal> normals;
+    std::vector<Color> colors;
+    std::vector<Scalar> quality;
+    std::vector<TexCoord> texcoords;
+
+    void resize(const PlyElement& element)
+    {
+        bool has[ply_indices] = {false};
+        for (const auto& p : element.properties)
+            has[p.target] = true;
+        points.resize(element.count, Point(0, 0, 0));
+        if (has[ply_nx] || has[ply_ny] || has[ply_nz])
+            normals.resize(element.count, Normal(0, 0, 0));
+        if (has[ply_red] || has[ply_green] || has[ply_blue])
+            colors.resize(element.count, Color(0, 0, 0));
+        if (has[ply_quality])
+            quality.resize(element.count, 0);
+        if (has[ply_u] || has[ply_v])
+            texcoords.resize(element.count, TexCoord(0, 0));
+    }
+
+    void set(size_t i, const PlyProperty& property, double x)
+    {
+        switch (property.target)
+        {
+            case ply_x:
+            case ply_y:
+            case ply_z:
+                points[i][property.target - ply_x] = Scalar(x);
+                break;
+            case ply_nx:
+            case ply_ny:
+            case ply_nz:
+                normals[i][property.target - ply_nx] = Scalar(x);
+                break;
+            case ply_red:
+            case ply_green:
+            case ply_blue:
+                colors[i][property.target - ply_red] =
+                    Scalar(ply_is_integer(property.type) ? x / 255.0 : x);
+                break;
+            case ply_quality:
+                quality[i] = Scalar(x);
+                break;
+            case ply_u:
+            case ply_v:
+                texcoords[i][property.target - ply_u] = Scalar(x);
+                break;
+            default:
+                break;
+        }
+    }
+};
+
+// read list or scalar property values that are not needed
+bool ply_skip_property(PlyCursor& cursor, const PlyProperty& property)
+{
+    double x;
+    size_t n = 1;
+    if (property.count_type != ply_invalid)
+    {
+        if (!cursor.value(property.count_type, x) || x < 0)
+            return false;
+        n = size_t(x);
+    }
+    for (size_t i = 0; i < n; ++i)
+        if (!cursor.value(property.type, x))
+            return false;
+    return true;
+}
+
+// write a binary value of the given type
+template <class T>
+inline char* ply_encode(char* p, T x)
+{
+    memcpy(p, &x, sizeof(x));
+    return p + sizeof(x);
+}
+
+inline unsigned char ply_color(Scalar c)
+{
+    return (unsigned char)std::min(255.0,
+                                   std::max(0.0, std::floor(255.0 * c + 0.5)));
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMeshIO::read_ply(SurfaceMesh& mesh)
+{
+    PMP_PROFILE_ZONE("SurfaceMeshIO::read_ply");
+
+    FILE* in = open_input("rb");
+    if (!in)
+        return false;
+
+    bool binary = false, swap = false;
+    std::vector<PlyElement> elements;
+    if (!read_ply_header(in, binary, swap, elements))
+    {
+        std::cerr << "read_ply: invalid header in " << filename_ << std::endl;
+        fclose(in);
+        return false;
+    }
+
+    // read all data at once
+    std::vector<char> data;
+    read_text(in, data);
+    fclose(in);
+    PlyCursor cursor(data.data(), data.data() + data.size() - 1, binary, swap);
+
+    PlyVertices vertices;
+    std::vector<IndexType> indices, face_sizes;
+    std::vector<Color> face_colors;
+    bool truncated = false;
+
+    for (const auto& element : elements)
+    {
+        const size_t record_size = binary ? element.record_size() : 0;
+
+        if (element.name == "vertex")
+        {
+            vertices.resize(element);
+
+            if (record_size)
+            {
+                // fixed-size records are decoded in parallel
+                const char* begin = cursor.position();
+                if (!cursor.skip(element.count * record_size))
+                {
+                    truncated = true;
+                    break;
+                }
+                parallel_for(0, element.count, [&](size_t i) {
+                    const char* p = begin + i * record_size;
+                    for (const auto& property : element.properties)
+                    {
+                        if (property.target != ply_skip)
+                            vertices.set(i, property,
+                                         ply_decode(p, property.type, swap));
+                        p += ply_size(property.type);
+                    }
+                });
+                continue;
+            }
+
+            double x = 0;
+            for (size_t i = 0; i < element.count && !truncated; ++i)
+                for (const auto& property : element.properties)
+                {
+                    if (property.count_type != ply_invalid)
+                        truncated = !ply_skip_property(cursor, property);
+                    else if (cursor.value(property.type, x))
+                        vertices.set(i, property, x);
+                    else
+                        truncated = true;
+                    if (truncated)
+                        break;
+                }
+        }
+        else if (element.name == "face")
+        {
+            face_sizes.reserve(element.count);
+            bool has_colors = false;
+            for (const auto& property : element.properties)
+                if (property.target >= ply_red && property.target <= ply_blue)
+                    has_colors = true;
+            if (has_colors)
+                face_colors.resize(element.count, Color(0, 0, 0));
+
+            double x = 0;
+            for (size_t i = 0; i < element.count && !truncated; ++i)
+                for (const auto& property : element.properties)
+                {
+                    if (property.target == ply_indices)
+                    {
+                        if (!cursor.value(property.count_type, x) || x < 0)
+                        {
+                            truncated = true;
+                            break;
+                        }
+                        const size_t n = size_t(x);
+                        for (size_t j = 0; j < n && !truncated; ++j)
+                        {
+                            truncated = !cursor.value(property.type, x);
+                            indices.push_back(x >= 0 ? IndexType(x)
+                                                     : PMP_MAX_INDEX);
+                        }
+                        face_sizes.push_back(IndexType(n));
+                    }
+                    else if (property.target >= ply_red &&
+                             property.target <= ply_blue)
+                    {
+                        truncated = !cursor.value(property.type, x);
+                        face_colors[i][property.target - ply_red] = Scalar(
+                            ply_is_integer(property.type) ? x / 255.0 : x);
+                    }
+                    else
+                        truncated = !ply_skip_property(cursor, property);
+                    if (truncated)
+                        break;
+                }
+        }
+        else if (record_size)
+        {
+            truncated = !cursor.skip(element.count * record_size);
+        }
+        else
+        {
+            for (size_t i = 0; i < element.count && !truncated; ++i)
+                for (size_t j = 0; j < element.properties.size() && !truncated;
+                     ++j)
+                    truncated = !ply_skip_property(cursor, element.properties[j]);
+        }
+
+        if (truncated)
+            break;
+    }
+
+    if (truncated)
+    {
+        std::cerr << "read_ply: " << filename_ << " is truncated" << std::endl;
+        return false;
+    }
+
+    // build connectivity for all faces at once
+    mesh.build_from_indices(vertices.points, indices, face_sizes);
+
+    // vertex attributes
+    if (!vertices.normals.empty())
+    {
+        auto normals = mesh.vertex_property<Normal>("v:normal");
+        normals.vector() = vertices.normals;
+    }
+    if (!vertices.colors.empty())
+    {
+        auto colors = mesh.vertex_property<Color>("v:color");
+        colors.vector() = vertices.colors;
+    }
+    if (!vertices.quality.empty())
+    {
+        auto quality = mesh.vertex_property<Scalar>("v:quality");
+        quality.vector() = vertices.quality;
+    }
+    if (!vertices.texcoords.empty())
+    {
+        auto texcoords = mesh.vertex_property<TexCoord>("v:tex");
+        texcoords.vector() = vertices.texcoords;
+    }
+
+    // face colors, if all faces could be added
+    if (!face_colors.empty() && mesh.faces_size() == face_colors.size())
+    {
+        auto colors = mesh.face_property<Color>("f:color");
+        colors.vector() = face_colors;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMeshIO::write_ply(const SurfaceMesh& mesh)
+{
+    FILE* out = open_output(flags_.use_binary ? "wb" : "w");
+    if (!out)
+        return false;
+
+    auto points = mesh.get_vertex_property<Point>("v:point");
+    auto normals = mesh.get_vertex_property<Normal>("v:normal");
+    auto colors = mesh.get_vertex_property<Color>("v:color");
+    auto quality = mesh.get_vertex_property<Scalar>("v:quality");
+    auto texcoords = mesh.get_vertex_property<TexCoord>("v:tex");
+    auto face_colors = mesh.get_face_property<Color>("f:color");
+
+    const bool has_normals = normals && flags_.use_vertex_normals;
+    const bool has_colors = colors && flags_.use_vertex_colors;
+    const bool has_quality = quality && flags_.use_vertex_quality;
+    const bool has_texcoords = texcoords && flags_.use_vertex_texcoords;
+    const bool has_face_colors = face_colors && flags_.use_face_colors;
+
+    // indices of the vertices in the file, skipping deleted ones
+    std::vector<IndexType> index(mesh.vertices_size(), PMP_MAX_INDEX);
+    IndexType n_vertices = 0;
+    for (auto v : mesh.vertices())
+        index[v.idx()] = n_vertices++;
+
+    size_t max_valence = 0;
+    for (auto f : mesh.faces())
+        max_valence = std::max(max_valence, size_t(mesh.valence(f)));
+    const bool large_faces = max_valence > 255;
+
+    // header
+    fprintf(out, "ply\nformat %s 1.0\n",
+            !flags_.use_binary
+                ? "ascii"
+                : (is_little_endian() ? "binary_little_endian"
+                                      : "binary_big_endian"));
+    fprintf(out, "comment File written with pmp-library\n");
+    fprintf(out, "element vertex %zu\n", mesh.n_vertices());
+    fprintf(out, "property float x\nproperty float y\nproperty float z\n");
+    if (has_normals)
+        fprintf(out,
+                "property float nx\nproperty float ny\nproperty float nz\n");
+    if (has_colors)
+        fprintf(out, "property uchar red\nproperty uchar green\n"
+                     "property uchar blue\n");
+    if (has_quality)
+        fprintf(out, "property float quality\n");
+    if (has_texcoords)
+        fprintf(out, "property float u\nproperty float v\n");
+    fprintf(out, "element face %zu\n", mesh.n_faces());
+    fprintf(out, "property list %s int vertex_indices\n",
+            large_faces ? "int" : "uchar");
+    if (has_face_colors)
+        fprintf(out, "property uchar red\nproperty uchar green\n"
+                     "property uchar blue\n");
+    fprintf(out, "end_header\n");
+
+    if (!flags_.use_binary)
+    {
+        for (auto v : mesh.vertices())
+        {
+            const Point& p = points[v];
+            fprintf(out, "%.9g %.9g %.9g", p[0], p[1], p[2]);
+            if (has_normals)
+            {
+                const Normal& n = normals[v];
+                fprintf(out, " %.9g %.9g %.9g", n[0], n[1], n[2]);
+            }
+            if (has_colors)
+            {
+                const Color& c = colors[v];
+                fprintf(out, " %d %d %d", ply_color(c[0]), ply_color(c[1]),
+                        ply_color(c[2]));
+            }
+            if (has_quality)
+                fprintf(out, " %.9g", quality[v]);
+            if (has_texcoords)
+            {
+                const TexCoord& t = texcoords[v];
+                fprintf(out, " %.9g %.9g", t[0], t[1]);
+            }
+            fprintf(out, "\n");
+        }
+
+        for (auto f : mesh.faces())
+        {
+            fprintf(out, "%zu", mesh.valence(f));
+            for (auto v : mesh.vertices(f))
+                fprintf(out, " %u", (unsigned int)index[v.idx()]);
+            if (has_face_colors)
+            {
+                const Color& c = face_colors[f];
+                fprintf(out, " %d %d %d", ply_color(c[0]), ply_color(c[1]),
+                        ply_color(c[2]));
+            }
+            fprintf(out, "\n");
+        }
+
+        fclose(out);
+        return true;
+    }
+
+    // binary vertex records are encoded in parallel and written at once
+    const size_t record_size = 12 + (has_normals ? 12 : 0) +
+                               (has_colors ? 3 : 0) + (has_quality ? 4 : 0) +
+                               (has_texcoords ? 8 : 0);
+    std::vector<char> buffer(mesh.n_vertices() * record_size);
+    parallel_for(mesh.vertices(), [&](Vertex v) {
+        char* p = buffer.data() + index[v.idx()] * record_size;
+        for (int i = 0; i < 3; ++i)
+            p = ply_encode(p, float(points[v][i]));
+        if (has_normals)
+            for (int i = 0; i < 3; ++i)
+                p = ply_encode(p, float(normals[v][i]));
+        if (has_colors)
+            for (int i = 0; i < 3; ++i)
+                p = ply_encode(p, ply_color(colors[v][i]));
+        if (has_quality)
+            p = ply_encode(p, float(quality[v]));
+        if (has_texcoords)
+            for (int i = 0; i < 2; ++i)
+                p = ply_encode(p, float(texcoords[v][i]));
+    });
+    fwrite(buffer.data(), 1, buffer.size(), out);
+
+    // faces are encoded into blocks of about 1 MB
+    const size_t block_size = 1 << 20;
+    buffer.clear();
+    buffer.reserve(block_size + 4 * (max_valence + 2));
+    for (auto f : mesh.faces())
+    {
+        const size_t end = buffer.size();
+        buffer.resize(end + 4 * (max_valence + 2));
+        char* p = buffer.data() + end;
+        const size_t valence = mesh.valence(f);
+        if (large_faces)
+            p = ply_encode(p, int32_t(valence));
+        else
+            p = ply_encode(p, uint8_t(valence));
+        for (auto v : mesh.vertices(f))
+            p = ply_encode(p, int32_t(index[v.idx()]));
+        if (has_face_colors)
+            for (int i = 0; i < 3; ++i)
+                p = ply_encode(p, ply_color(face_colors[f][i]));
+        buffer.resize(p - buffer.data());
+
+        if (buffer.size() >= block_size)
+        {
+            fwrite(buffer.data(), 1, buffer.size(), out);
+            buffer.clear();
+        }
+    }
+    fwrite(buffer.data(), 1, buffer.size(), out);
+
+    fclose(out);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMeshIO::read_stl(SurfaceMesh& mesh)
+{
+    PMP_PROFILE_ZONE("SurfaceMeshIO::read_stl");
+
+    char line[100], *c;
+    unsigned int i, nT(0);
+    vec3 p;
+    IndexType vertices[3];
+    std::vector<IndexType> indices; // vertex indices of all triangles
+    size_t n_items(0);
+
+    // merge the corners of the triangle soup
+    PointWelder welder;
+
+    // open file (in ASCII mode)
+    FILE* in = open_input("r");
+    if (!in)
+        return false;
 
     // ASCII or binary STL?
     c = fgets(line, 6, in);
@@ -1123,7 +3062,7 @@ bool SurfaceMeshIO::read_stl(SurfaceMesh& mesh)
     {
         // re-open file in binary mode
         fclose(in);
-        in = fopen(filename_.c_str(), "rb");
+        in = open_input("rb");
         if (!in)
             return false;
 
@@ -1134,40 +3073,40 @@ bool SurfaceMeshIO::read_stl(SurfaceMesh& mesh)
         // read number of triangles
         tfread(in, nT);
 
-        // read triangles
+        // closed meshes have about half as many vertices as triangles
+        welder.reserve(nT / 2);
+        indices.reserve(3 * size_t(nT));
+
+        // read triangles in blocks of records: normal, three corners, and
+        // two attribute bytes
+        const size_t record_size = 50;
+        std::vector<char> buffer(record_size * 4096);
         while (nT)
         {
-            // skip triangle normal
-            n_items = fread(line, 1, 12, in);
-            PMP_ASSERT(n_items > 0);
-            // triangle's vertices
-            for (i = 0; i < 3; ++i)
+            const size_t n = std::min(size_t(nT), size_t(4096));
+            if (fread(buffer.data(), record_size, n, in) != n)
             {
-                tfread(in, p);
+                std::cerr << "read_stl: file is truncated" << std::endl;
+                break;
+            }
 
-                // has vector been referenced before?
-                if ((vMapIt = vMap.find(p)) == vMap.end())
-                {
-                    // No : add vertex and remember idx/vector mapping
-                    v = mesh.add_vertex((Point)p);
-                    vertices[i] = v;
-                    vMap[p] = v;
-                }
-                else
+            for (size_t t = 0; t < n; ++t)
+            {
+                const char* record = buffer.data() + t * record_size;
+                for (i = 0; i < 3; ++i)
                 {
-                    // Yes : get index from map
-                    vertices[i] = vMapIt->second;
+                    memcpy(&p, record + 12 + 12 * i, sizeof(p));
+                    vertices[i] = welder.insert((Point)p);
                 }
-            }
 
-            // Add face only if it is not degenerated
-            if ((vertices[0] != vertices[1]) && (vertices[0] != vertices[2]) &&
-                (vertices[1] != vertices[2]))
-                mesh.add_face(vertices);
+                // Add face only if it is not degenerated
+                if ((vertices[0] != vertices[1]) &&
+                    (vertices[0] != vertices[2]) &&
+                    (vertices[1] != vertices[2]))
+                    indices.insert(indices.end(), vertices, vertices + 3);
+            }
 
-            n_items = fread(line, 1, 2, in);
-            PMP_ASSERT(n_items > 0);
-            --nT;
+            nT -= n;
         }
     }
 
@@ -1200,31 +3139,23 @@ bool SurfaceMeshIO::read_stl(SurfaceMesh& mesh)
                     // read x, y, z
                     sscanf(c + 6, "%f %f %f", &p[0], &p[1], &p[2]);
 
-                    // has vector been referenced before?
-                    if ((vMapIt = vMap.find(p)) == vMap.end())
-                    {
-                        // No : add vertex and remember idx/vector mapping
-                        v = mesh.add_vertex((Point)p);
-                        vertices[i] = v;
-                        vMap[p] = v;
-                    }
-                    else
-                    {
-                        // Yes : get index from map
-                        vertices[i] = vMapIt->second;
-                    }
+                    vertices[i] = welder.insert((Point)p);
                 }
 
                 // Add face only if it is not degenerated
                 if ((vertices[0] != vertices[1]) &&
                     (vertices[0] != vertices[2]) &&
                     (vertices[1] != vertices[2]))
-                    mesh.add_face(vertices);
+                    indices.insert(indices.end(), vertices, vertices + 3);
             }
         }
     }
 
     fclose(in);
+
+    // build connectivity for all triangles at once
+    mesh.build_from_indices(welder.points(), indices);
+
     return true;
 }
 
@@ -1245,30 +3176,27 @@ bool SurfaceMeshIO::write_stl(const SurfaceMesh& mesh)
         return false;
     }
 
-    std::ofstream ofs(filename_.c_str());
+    FILE* out = open_output("w");
+    if (!out)
+        return false;
     auto points = mesh.get_vertex_property<Point>("v:point");
 
-    ofs << "solid stl" << std::endl;
-    Normal n;
-    Point p;
-
+    fprintf(out, "solid stl\n");
     for (auto f : mesh.faces())
     {
-        n = fnormals[f];
-        ofs << "  facet normal ";
-        ofs << n[0] << " " << n[1] << " " << n[2] << std::endl;
-        ofs << "    outer loop" << std::endl;
+        const Normal& n = fnormals[f];
+        fprintf(out, "  facet normal %g %g %g\n", n[0], n[1], n[2]);
+        fprintf(out, "    outer loop\n");
         for (auto v : mesh.vertices(f))
         {
-            p = points[v];
-            ofs << "      vertex ";
-            ofs << p[0] << " " << p[1] << " " << p[2] << std::endl;
+            const Point& p = points[v];
+            fprintf(out, "      vertex %g %g %g\n", p[0], p[1], p[2]);
         }
-        ofs << "    endloop" << std::endl;
-        ofs << "  endfacet" << std::endl;
+        fprintf(out, "    endloop\n");
+        fprintf(out, "  endfacet\n");
     }
-    ofs << "endsolid" << std::endl;
-    ofs.close();
+    fprintf(out, "endsolid\n");
+    fclose(out);
     return true;
 }
 
@@ -1276,26 +3204,576 @@ bool SurfaceMeshIO::write_stl(const SurfaceMesh& mesh)
 
 bool SurfaceMeshIO::write_xyz(const SurfaceMesh& mesh)
 {
-    std::ofstream ofs(filename_);
-    if (!ofs)
+    FILE* out = open_output("w");
+    if (!out)
         return false;
 
     auto vnormal = mesh.get_vertex_property<Normal>("v:normal");
     for (auto v : mesh.vertices())
     {
-        ofs << mesh.position(v);
-        ofs << " ";
+        const Point& p = mesh.position(v);
+        fprintf(out, "%g %g %g ", p[0], p[1], p[2]);
         if (vnormal)
         {
-            ofs << vnormal[v];
+            const Normal& n = vnormal[v];
+            fprintf(out, "%g %g %g", n[0], n[1], n[2]);
         }
-        ofs << std::endl;
+        fprintf(out, "\n");
     }
 
-    ofs.close();
+    fclose(out);
     return true;
 }
 
+//-----------------------------------------------------------------------------
+
+namespace {
+
+// sequential buffered access to a file, reading blocks of 1 MB
+class FileBuffer
+{
+public:
+    explicit FileBuffer(FILE* in)
+        : in_(in), buffer_((1 << 20) + 1), begin_(0), end_(0), eof_(false)
+    {
+        buffer_[0] = '\0';
+    }
+
+    // returns the next n bytes and skips them, nullptr if the file ends
+    const char* read(size_t n)
+    {
+        if (!fill(n))
+            return nullptr;
+        const char* p = buffer_.data() + begin_;
+        begin_ += n;
+        return p;
+    }
+
+    // get the next line [begin,end) without the line break. the line is
+    // followed by '\n' or '\0'. returns false at the end of the file.
+    bool next_line(const char*& begin, const char*& end)
+    {
+        size_t searched = 0;
+        for (;;)
+        {
+            const char* b = buffer_.data() + begin_;
+            const char* e = (const char*)memchr(b + searched, '\n',
+                                                end_ - begin_ - searched);
+            if (e)
+            {
+                begin = b;
+                end = e;
+                begin_ = e + 1 - buffer_.data();
+                return true;
+            }
+            searched = end_ - begin_;
+            if (!fill(searched + 1))
+                break;
+        }
+
+        // last line without line break
+        if (begin_ == end_)
+            return false;
+        begin = buffer_.data() + begin_;
+        end = buffer_.data() + end_;
+        begin_ = end_;
+        return true;
+    }
+
+private:
+    // make sure that at least n bytes are buffered
+    bool fill(size_t n)
+    {
+        if (end_ - begin_ >= n)
+            return true;
+
+        memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+        end_ -= begin_;
+        begin_ = 0;
+        if (buffer_.size() < n + 1)
+            buffer_.resize(std::max(n + 1, 2 * buffer_.size()));
+        while (end_ < n && !eof_)
+        {
+            const size_t k =
+                fread(buffer_.data() + end_, 1, buffer_.size() - 1 - end_, in_);
+            eof_ = (k == 0);
+            end_ += k;
+        }
+        buffer_[end_] = '\0';
+        return end_ >= n;
+    }
+
+    FILE* in_;
+    std::vector<char> buffer_;
+    size_t begin_, end_;
+    bool eof_;
+};
+
+// collects vertices and faces and passes them in batches to a sink
+class StreamBatch
+{
+public:
+    StreamBatch(SurfaceMeshSink& sink, size_t batch_size)
+        : sink_(sink),
+          batch_size_(std::max(batch_size, size_t(1))),
+          n_vertices_(0)
+    {
+    }
+
+    // the number of vertices added so far
+    size_t n_vertices() const { return n_vertices_; }
+
+    bool add_vertex(const Point& p)
+    {
+        points_.push_back(p);
+        ++n_vertices_;
+        return points_.size() < batch_size_ || flush_vertices();
+    }
+
+    bool add_face(const IndexType* indices, size_t n)
+    {
+        indices_.insert(indices_.end(), indices, indices + n);
+        face_sizes_.push_back(IndexType(n));
+        return face_sizes_.size() < batch_size_ || flush_faces();
+    }
+
+    // pass the remaining vertices and faces
+    bool flush() { return flush_faces(); }
+
+private:
+    bool flush_vertices()
+    {
+        bool ok = points_.empty() || sink_.vertices(points_);
+        points_.clear();
+        return ok;
+    }
+
+    // faces refer to previous vertices, so these are passed first
+    bool flush_faces()
+    {
+        bool ok = flush_vertices() &&
+                  (face_sizes_.empty() || sink_.faces(indices_, face_sizes_));
+        indices_.clear();
+        face_sizes_.clear();
+        return ok;
+    }
+
+    SurfaceMeshSink& sink_;
+    size_t batch_size_;
+    size_t n_vertices_;
+    std::vector<Point> points_;
+    std::vector<IndexType> indices_, face_sizes_;
+};
+
+// values of ASCII or binary PLY records read from a file buffer
+class PlyStream
+{
+public:
+    PlyStream(FileBuffer& file, bool binary, bool swap)
+        : file_(file),
+          binary_(binary),
+          swap_(swap),
+          cursor_(nullptr, nullptr, false, false)
+    {
+    }
+
+    // start the next record, i.e., the next non-empty line of ASCII files
+    bool next_record()
+    {
+        if (binary_)
+            return true;
+        const char *begin, *end;
+        do
+        {
+            if (!file_.next_line(begin, end))
+                return false;
+            skip_blanks(begin, end);
+        } while (begin == end);
+        cursor_ = PlyCursor(begin, end, false, false);
+        return true;
+    }
+
+    bool value(PlyType type, double& x)
+    {
+        if (!binary_)
+            return cursor_.value(type, x);
+        const char* p = file_.read(ply_size(type));
+        if (!p)
+            return false;
+        x = ply_decode(p, type, swap_);
+        return true;
+    }
+
+private:
+    FileBuffer& file_;
+    bool binary_;
+    bool swap_;
+    PlyCursor cursor_;
+};
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMeshIO::stream_off(SurfaceMeshSink& sink, size_t batch_size)
+{
+    FILE* in = open_input("rb");
+    if (!in)
+        return false;
+
+    std::string line;
+    OffHeader header;
+    if (!read_header_line(in, line) || !parse_off_header(line.c_str(), header) ||
+        header.has_hcoords || header.has_dim ||
+        (header.is_binary && header.has_colors))
+    {
+        fclose(in);
+        return false;
+    }
+
+    FileBuffer file(in);
+    StreamBatch batch(sink, batch_size);
+    bool ok = true;
+
+    if (header.is_binary)
+    {
+        // #Vertice, #Faces, #Edges
+        const char* p = file.read(3 * sizeof(IndexType));
+        IndexType counts[3] = {0, 0, 0};
+        if (p)
+            memcpy(counts, p, sizeof(counts));
+        ok = p && sink.begin(counts[0], counts[1]);
+
+        // vertices: pos [normal] [texcoord]
+        const size_t record_size =
+            sizeof(Point) + (header.has_normals ? sizeof(Point) : 0) +
+            (header.has_texcoords ? sizeof(vec2) : 0);
+        for (IndexType i = 0; ok && i < counts[0]; ++i)
+        {
+            Point x;
+            ok = (p = file.read(record_size)) != nullptr;
+            if (ok)
+            {
+                memcpy(&x, p, sizeof(x));
+                ok = batch.add_vertex(x);
+            }
+        }
+
+        // faces: #N v[1] ... v[N]
+        for (IndexType i = 0; ok && i < counts[1]; ++i)
+        {
+            IndexType n = 0;
+            ok = (p = file.read(sizeof(n))) != nullptr;
+            if (ok)
+            {
+                memcpy(&n, p, sizeof(n));
+                ok = (p = file.read(n * sizeof(IndexType))) != nullptr;
+            }
+            if (ok)
+            {
+                std::vector<IndexType> indices(n);
+                memcpy(indices.data(), p, n * sizeof(IndexType));
+                ok = batch.add_face(indices.data(), n);
+            }
+        }
+    }
+    else
+    {
+        const char *p, *end;
+
+        // #Vertice, #Faces, #Edges
+        long long nv(0), nf(0);
+        ok = false;
+        while (file.next_line(p, end))
+            if (is_data_line(p, end))
+            {
+                ok = parse_int(p, end, nv) && parse_int(p, end, nf) &&
+                     nv >= 0 && nf >= 0;
+                break;
+            }
+        if (!ok)
+            std::cerr << "OFF: fail to read header" << std::endl;
+        ok = ok && sink.begin(size_t(nv), size_t(nf));
+
+        // vertices: pos [normal] [color] [texcoord], faces: #N v[1] ... v[N]
+        std::vector<IndexType> indices;
+        for (long long k = 0; ok && k < nv + nf;)
+        {
+            if (!file.next_line(p, end))
+            {
+                std::cerr << "OFF: unexpected end of file" << std::endl;
+                ok = false;
+                break;
+            }
+            if (!is_data_line(p, end))
+                continue;
+
+            if (k < nv)
+            {
+                Point x;
+                if (parse_scalar(p, end, x[0]) && parse_scalar(p, end, x[1]) &&
+                    parse_scalar(p, end, x[2]))
+                    ok = batch.add_vertex(x);
+                else
+                {
+                    std::cerr << "OFF: fail to read vertex " << k << std::endl;
+                    ok = false;
+                }
+            }
+            else
+            {
+                long long n(0), idx(0), j(0);
+                indices.clear();
+                if (parse_int(p, end, n))
+                    for (; j < n && parse_int(p, end, idx); ++j)
+                        indices.push_back(IndexType(idx));
+                if (n > 0 && j == n)
+                    ok = batch.add_face(indices.data(), indices.size());
+                else
+                    std::cerr << "OFF: fail to read face " << k - nv
+                              << std::endl;
+            }
+            ++k;
+        }
+    }
+
+    fclose(in);
+    if (header.is_binary && !ok)
+        std::cerr << "OFF: unexpected end of file" << std::endl;
+    return ok && batch.flush() && sink.end();
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMeshIO::stream_obj(SurfaceMeshSink& sink, size_t batch_size)
+{
+    FILE* in = open_input("rb");
+    if (!in)
+        return false;
+
+    FileBuffer file(in);
+    StreamBatch batch(sink, batch_size);
+    std::vector<IndexType> indices;
+    const char *p, *end;
+    bool ok = sink.begin(0, 0);
+
+    while (ok && file.next_line(p, end))
+    {
+        skip_blanks(p, end);
+        if (end - p < 2 || !is_blank(p[1]))
+            continue;
+
+        // vertex
+        if (p[0] == 'v')
+        {
+            Point x;
+            ++p;
+            if (parse_scalar(p, end, x[0]) && parse_scalar(p, end, x[1]) &&
+                parse_scalar(p, end, x[2]))
+                ok = batch.add_vertex(x);
+        }
+
+        // face: v[/vt[/vn]] ...
+        else if (p[0] == 'f')
+        {
+            long long idx;
+            ++p;
+            indices.clear();
+            while (parse_int(p, end, idx))
+            {
+                if (idx > 0)
+                    indices.push_back(IndexType(idx - 1));
+                else if (idx < 0)
+                    indices.push_back(IndexType(batch.n_vertices() + idx));
+                else
+                    indices.push_back(PMP_MAX_INDEX);
+
+                // skip texture and normal indices
+                while (p < end && !is_blank(*p))
+                    ++p;
+            }
+            if (!indices.empty())
+                ok = batch.add_face(indices.data(), indices.size());
+        }
+    }
+
+    fclose(in);
+    return ok && batch.flush() && sink.end();
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMeshIO::stream_ply(SurfaceMeshSink& sink, size_t batch_size)
+{
+    FILE* in = open_input("rb");
+    if (!in)
+        return false;
+
+    bool binary = false, swap = false;
+    std::vector<PlyElement> elements;
+    if (!read_ply_header(in, binary, swap, elements))
+    {
+        std::cerr << "read_ply: invalid header in " << filename_ << std::endl;
+        fclose(in);
+        return false;
+    }
+
+    size_t n_vertices = 0, n_faces = 0;
+    for (const auto& element : elements)
+    {
+        if (element.name == "vertex")
+            n_vertices = element.count;
+        else if (element.name == "face")
+            n_faces = element.count;
+    }
+
+    FileBuffer file(in);
+    PlyStream values(file, binary, swap);
+    StreamBatch batch(sink, batch_size);
+    std::vector<IndexType> indices;
+    bool ok = sink.begin(n_vertices, n_faces);
+    bool truncated = false;
+
+    for (size_t e = 0; ok && e < elements.size(); ++e)
+    {
+        const PlyElement& element = elements[e];
+        const bool is_vertex = element.name == "vertex";
+        const bool is_face = element.name == "face";
+
+        for (size_t i = 0; ok && i < element.count; ++i)
+        {
+            if (!values.next_record())
+            {
+                truncated = true;
+                break;
+            }
+
+            Point x(0, 0, 0);
+            indices.clear();
+            for (const auto& property : element.properties)
+            {
+                double value = 0;
+                size_t n = 1;
+                if (property.count_type != ply_invalid)
+                {
+                    truncated = !values.value(property.count_type, value) ||
+                                value < 0;
+                    n = size_t(value);
+                }
+                for (size_t j = 0; j < n && !truncated; ++j)
+                {
+                    truncated = !values.value(property.type, value);
+                    if (is_vertex && property.target >= ply_x &&
+                        property.target <= ply_z)
+                        x[property.target - ply_x] = Scalar(value);
+                    else if (is_face && property.target == ply_indices)
+                        indices.push_back(value >= 0 ? IndexType(value)
+                                                     : PMP_MAX_INDEX);
+                }
+                if (truncated)
+                    break;
+            }
+
+            if (truncated)
+                break;
+            if (is_vertex)
+                ok = batch.add_vertex(x);
+            else if (is_face)
+                ok = batch.add_face(indices.data(), indices.size());
+        }
+
+        if (truncated)
+        {
+            std::cerr << "read_ply: " << filename_ << " is truncated"
+                      << std::endl;
+            ok = false;
+        }
+    }
+
+    fclose(in);
+    return ok && batch.flush() && sink.end();
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMeshIO::stream_stl(SurfaceMeshSink& sink, size_t batch_size)
+{
+    FILE* in = open_input("rb");
+    if (!in)
+        return false;
+
+    // ASCII or binary STL?
+    char line[6] = {0};
+    const size_t n_read = fread(line, 1, 5, in);
+    const bool binary = n_read < 5 || ((strncmp(line, "SOLID", 5) != 0) &&
+                                       (strncmp(line, "solid", 5) != 0));
+    rewind(in);
+
+    FileBuffer file(in);
+    StreamBatch batch(sink, batch_size);
+    IndexType corners[3];
+    bool ok = true;
+
+    if (binary)
+    {
+        // skip dummy header, read number of triangles
+        const char* p = file.read(84);
+        uint32_t n_triangles = 0;
+        if (p)
+            memcpy(&n_triangles, p + 80, sizeof(n_triangles));
+        ok = p && sink.begin(3 * size_t(n_triangles), n_triangles);
+
+        // triangle soup: normal, three corners, and two attribute bytes
+        for (uint32_t t = 0; ok && t < n_triangles; ++t)
+        {
+            if (!(p = file.read(50)))
+            {
+                std::cerr << "read_stl: file is truncated" << std::endl;
+                ok = false;
+                break;
+            }
+            for (int i = 0; ok && i < 3; ++i)
+            {
+                vec3 x;
+                memcpy(&x, p + 12 + 12 * i, sizeof(x));
+                corners[i] = IndexType(batch.n_vertices());
+                ok = batch.add_vertex((Point)x);
+            }
+            ok = ok && batch.add_face(corners, 3);
+        }
+    }
+    else
+    {
+        const char *p, *end;
+        int n_corners = 0;
+        ok = sink.begin(0, 0);
+        while (ok && file.next_line(p, end))
+        {
+            while (p < end && isspace((unsigned char)*p))
+                ++p;
+            if (end - p < 6 || (strncmp(p, "vertex", 6) != 0 &&
+                                strncmp(p, "VERTEX", 6) != 0))
+                continue;
+
+            p += 6;
+            Point x;
+            if (!parse_scalar(p, end, x[0]) || !parse_scalar(p, end, x[1]) ||
+                !parse_scalar(p, end, x[2]))
+                continue;
+            corners[n_corners++] = IndexType(batch.n_vertices());
+            ok = batch.add_vertex(x);
+            if (ok && n_corners == 3)
+            {
+                ok = batch.add_face(corners, 3);
+                n_corners = 0;
+            }
+        }
+    }
+
+    fclose(in);
+    return ok && batch.flush() && sink.end();
+}
+
 //=============================================================================
 } // namespace pmp
 //=============================================================================
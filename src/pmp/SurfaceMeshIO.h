@@ -12,7 +12,11 @@
 
 #include <pmp/SurfaceMesh.h>
 
+#include <cstdint>
+#include <cstdio>
+#include <functional>
 #include <string>
+#include <vector>
 
 //=============================================================================
 
@@ -20,11 +24,20 @@ namespace pmp {
 
 //=============================================================================
 
+class SurfaceMeshSink;
+
 class SurfaceMeshIO
 {
 public:
     SurfaceMeshIO(const std::string& filename, const IOFlags& flags)
-        : filename_(filename), flags_(flags)
+        : filename_(filename),
+          flags_(flags),
+          in_memory_(false),
+          input_data_(nullptr),
+          input_size_(0),
+          to_memory_(false),
+          output_data_(nullptr),
+          output_size_(0)
     {
     }
 
@@ -32,26 +45,91 @@ public:
 
     bool write(const SurfaceMesh& mesh);
 
+    //! pass the file in batches to \p sink, see read_stream()
+    bool read(SurfaceMeshSink& sink, size_t batch_size);
+
+    //! \name Memory I/O
+    //! \details Read and write meshes without a file. \c format is the file
+    //! extension that determines the format, e.g., \c "obj" or \c "ply.gz".
+    //!@{
+
+    //! fills up to \c size bytes of \c buffer and returns their number,
+    //! zero at the end of the data
+    typedef std::function<size_t(char* buffer, size_t size)> ReadFunction;
+
+    //! consumes \c size bytes of \c data, returns false on failure
+    typedef std::function<bool(const char* data, size_t size)> WriteFunction;
+
+    //! read \p mesh from the \p size bytes at \p data
+    static bool read(SurfaceMesh& mesh, const char* data, size_t size,
+                     const std::string& format, const IOFlags& flags);
+
+    //! read \p mesh from the data returned by \p read_function
+    static bool read(SurfaceMesh& mesh, const ReadFunction& read_function,
+                     const std::string& format, const IOFlags& flags);
+
+    //! write \p mesh to \p data, replacing its contents
+    static bool write(const SurfaceMesh& mesh, std::vector<char>& data,
+                      const std::string& format, const IOFlags& flags);
+
+    //! write \p mesh by passing its data to \p write_function
+    static bool write(const SurfaceMesh& mesh,
+                      const WriteFunction& write_function,
+                      const std::string& format, const IOFlags& flags);
+
+    //!@}
+
 private:
+    // decompress .gz or .zst files into memory and replace ext by the
+    // extension of the compressed file
+    bool decompress(std::string& ext);
+
+    // open the input file or its data in memory for reading
+    FILE* open_input(const char* mode) const;
+
+    // open the output file or a buffer in memory for writing
+    FILE* open_output(const char* mode);
+
     bool read_off(SurfaceMesh& mesh);
     bool read_obj(SurfaceMesh& mesh);
     bool read_stl(SurfaceMesh& mesh);
     bool read_ply(SurfaceMesh& mesh);
     bool read_pmp(SurfaceMesh& mesh);
+    bool read_pmp_properties(FILE* in, SurfaceMesh& mesh,
+                             uint64_t table_offset);
+    bool read_pmpz(SurfaceMesh& mesh);
     bool read_xyz(SurfaceMesh& mesh);
     bool read_agi(SurfaceMesh& mesh);
 
+    bool stream_off(SurfaceMeshSink& sink, size_t batch_size);
+    bool stream_obj(SurfaceMeshSink& sink, size_t batch_size);
+    bool stream_ply(SurfaceMeshSink& sink, size_t batch_size);
+    bool stream_stl(SurfaceMeshSink& sink, size_t batch_size);
+
     bool write_off(const SurfaceMesh& mesh);
     bool write_off_binary(const SurfaceMesh& mesh);
     bool write_obj(const SurfaceMesh& mesh);
     bool write_stl(const SurfaceMesh& mesh);
     bool write_ply(const SurfaceMesh& mesh);
     bool write_pmp(const SurfaceMesh& mesh);
+    bool write_pmpz(const SurfaceMesh& mesh);
+    bool write_glb(const SurfaceMesh& mesh);
     bool write_xyz(const SurfaceMesh& mesh);
 
 private:
     std::string filename_;
     IOFlags flags_;
+
+    // input data in memory, decompressed or given by the caller
+    bool in_memory_;
+    std::vector<char> data_;
+    const char* input_data_;
+    size_t input_size_;
+
+    // output buffer in memory, from open_memstream()
+    bool to_memory_;
+    char* output_data_;
+    size_t output_size_;
 };
 
 //=============================================================================
@@ -0,0 +1,75 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/SurfaceMeshPool.h>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+SurfaceMeshPool::SurfaceMeshPool(size_t max_meshes) : max_meshes_(max_meshes)
+{
+}
+
+//-----------------------------------------------------------------------------
+
+std::unique_ptr<SurfaceMesh> SurfaceMeshPool::acquire()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!meshes_.empty())
+        {
+            std::unique_ptr<SurfaceMesh> mesh = std::move(meshes_.back());
+            meshes_.pop_back();
+            return mesh;
+        }
+    }
+
+    // the recycling lasts for the lifetime of the mesh
+    std::unique_ptr<SurfaceMesh> mesh(new SurfaceMesh);
+    mesh->begin_property_recycling();
+    return mesh;
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMeshPool::release(std::unique_ptr<SurfaceMesh> mesh)
+{
+    if (!mesh)
+        return;
+
+    // reset outside of the lock, such that threads do not wait for it
+    mesh->reset();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (meshes_.size() < max_meshes_)
+        meshes_.push_back(std::move(mesh));
+}
+
+//-----------------------------------------------------------------------------
+
+size_t SurfaceMeshPool::size() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return meshes_.size();
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMeshPool::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    meshes_.clear();
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -0,0 +1,70 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <pmp/SurfaceMesh.h>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \addtogroup core core
+//!@{
+
+//! \brief A thread-safe pool of meshes for processing many small meshes.
+//! \details acquire() returns an empty mesh, either a released one or a new
+//! one. release() resets the mesh, see SurfaceMesh::reset(), and keeps it
+//! for a later acquire(), such that its property arrays keep their memory.
+//! The meshes created by the pool recycle removed properties, see
+//! SurfaceMesh::begin_property_recycling(). Hence the temporary properties
+//! of algorithms like SurfaceSmoothing, SurfaceCurvature, or
+//! SurfaceSimplification re-use the memory of earlier runs as well. Usage:
+//! \code
+//! SurfaceMeshPool pool;
+//! auto mesh = pool.acquire();
+//! mesh->build_from_indices(points, indices);
+//! SurfaceCurvature(*mesh).analyze_tensor();
+//! pool.release(std::move(mesh));
+//! \endcode
+class SurfaceMeshPool
+{
+public:
+    //! construct a pool keeping at most \p max_meshes released meshes
+    explicit SurfaceMeshPool(size_t max_meshes = 64);
+
+    //! take an empty mesh from the pool, or create one if there is none
+    std::unique_ptr<SurfaceMesh> acquire();
+
+    //! return \p mesh to the pool, or delete it if the pool is full
+    void release(std::unique_ptr<SurfaceMesh> mesh);
+
+    //! the number of meshes waiting in the pool
+    size_t size() const;
+
+    //! delete the meshes waiting in the pool
+    void clear();
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<SurfaceMesh>> meshes_;
+    size_t max_meshes_;
+};
+
+//!@}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
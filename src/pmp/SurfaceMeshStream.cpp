@@ -0,0 +1,323 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/SurfaceMeshStream.h>
+#include <pmp/SurfaceMeshIO.h>
+
+#include <algorithm>
+#include <clocale>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+namespace {
+
+// number of vertices or face indices copied at once
+const size_t block_size = 1 << 16;
+
+inline bool is_little_endian()
+{
+    const uint16_t one = 1;
+    unsigned char c;
+    memcpy(&c, &one, 1);
+    return c == 1;
+}
+
+template <class T>
+inline bool write_raw(FILE* out, const T& t)
+{
+    return fwrite(&t, sizeof(t), 1, out) == 1;
+}
+
+template <class T>
+inline bool read_raw(FILE* in, T& t)
+{
+    return fread(&t, sizeof(t), 1, in) == 1;
+}
+
+} // namespace
+
+//=============================================================================
+
+bool read_stream(const std::string& filename, SurfaceMeshSink& sink,
+                 size_t batch_size)
+{
+    SurfaceMeshIO reader(filename, IOFlags());
+    return reader.read(sink, batch_size);
+}
+
+//=============================================================================
+
+SurfaceMeshStreamWriter::SurfaceMeshStreamWriter(const std::string& filename,
+                                                 const IOFlags& flags)
+    : filename_(filename),
+      flags_(flags),
+      vertices_(nullptr),
+      faces_(nullptr),
+      n_vertices_(0),
+      n_faces_(0),
+      max_valence_(0)
+{
+    // extract file extension
+    std::string::size_type dot(filename_.rfind("."));
+    if (dot != std::string::npos)
+        format_ = filename_.substr(dot + 1);
+    std::transform(format_.begin(), format_.end(), format_.begin(), tolower);
+}
+
+//-----------------------------------------------------------------------------
+
+SurfaceMeshStreamWriter::~SurfaceMeshStreamWriter()
+{
+    close();
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMeshStreamWriter::close()
+{
+    if (vertices_)
+        fclose(vertices_);
+    if (faces_)
+        fclose(faces_);
+    vertices_ = faces_ = nullptr;
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMeshStreamWriter::begin(size_t, size_t)
+{
+    close();
+    n_vertices_ = n_faces_ = max_valence_ = 0;
+
+    if (format_ != "off" && format_ != "obj" && format_ != "ply" &&
+        format_ != "xyz")
+    {
+        std::cerr << "SurfaceMeshStreamWriter: cannot stream to " << filename_
+                  << std::endl;
+        return false;
+    }
+
+    vertices_ = tmpfile();
+    faces_ = tmpfile();
+    if (!vertices_ || !faces_)
+    {
+        std::cerr << "SurfaceMeshStreamWriter: cannot create temporary files"
+                  << std::endl;
+        close();
+        return false;
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMeshStreamWriter::vertices(const std::vector<Point>& points)
+{
+    if (!vertices_)
+        return false;
+    n_vertices_ += points.size();
+    return fwrite(points.data(), sizeof(Point), points.size(), vertices_) ==
+           points.size();
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMeshStreamWriter::faces(const std::vector<IndexType>& indices,
+                                    const std::vector<IndexType>& face_sizes)
+{
+    if (!faces_)
+        return false;
+
+    // point clouds have no faces
+    if (format_ == "xyz")
+        return true;
+
+    // store #N v[1] ... v[N] for each face
+    std::vector<IndexType> data;
+    data.reserve(indices.size() + face_sizes.size());
+    size_t offset = 0;
+    for (auto n : face_sizes)
+    {
+        if (offset + n > indices.size())
+            return false;
+        data.push_back(n);
+        data.insert(data.end(), indices.begin() + offset,
+                    indices.begin() + offset + n);
+        offset += n;
+        max_valence_ = std::max(max_valence_, size_t(n));
+    }
+    n_faces_ += face_sizes.size();
+    return fwrite(data.data(), sizeof(IndexType), data.size(), faces_) ==
+           data.size();
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMeshStreamWriter::end()
+{
+    if (!vertices_ || !faces_)
+        return false;
+
+    std::setlocale(LC_NUMERIC, "C");
+
+    const bool binary = has_binary();
+    FILE* out = fopen(filename_.c_str(), binary ? "wb" : "w");
+    if (!out)
+        return false;
+
+    rewind(vertices_);
+    rewind(faces_);
+    const bool ok = write_header(out) && write_vertices(out) && write_faces(out);
+    fclose(out);
+    close();
+
+    if (!ok)
+        std::cerr << "SurfaceMeshStreamWriter: cannot write " << filename_
+                  << std::endl;
+    return ok;
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMeshStreamWriter::has_binary() const
+{
+    return flags_.use_binary && (format_ == "off" || format_ == "ply");
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMeshStreamWriter::write_header(FILE* out) const
+{
+    if (format_ == "off")
+    {
+        if (!flags_.use_binary)
+            return fprintf(out, "OFF\n%zu %zu 0\n", n_vertices_, n_faces_) > 0;
+
+        const IndexType counts[3] = {IndexType(n_vertices_),
+                                     IndexType(n_faces_), 0};
+        return fprintf(out, "OFF BINARY\n") > 0 && write_raw(out, counts);
+    }
+
+    if (format_ == "ply")
+    {
+        fprintf(out, "ply\nformat %s 1.0\n",
+                !flags_.use_binary
+                    ? "ascii"
+                    : (is_little_endian() ? "binary_little_endian"
+                                          : "binary_big_endian"));
+        fprintf(out, "comment File written with pmp-library\n");
+        fprintf(out, "element vertex %zu\n", n_vertices_);
+        fprintf(out, "property float x\nproperty float y\nproperty float z\n");
+        fprintf(out, "element face %zu\n", n_faces_);
+        fprintf(out, "property list %s int vertex_indices\n",
+                max_valence_ > 255 ? "int" : "uchar");
+        return fprintf(out, "end_header\n") > 0;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMeshStreamWriter::write_vertices(FILE* out) const
+{
+    const bool binary = has_binary();
+    std::vector<Point> points(block_size);
+    std::vector<float> coordinates;
+
+    for (size_t i = 0; i < n_vertices_; i += block_size)
+    {
+        const size_t n = std::min(block_size, n_vertices_ - i);
+        if (fread(points.data(), sizeof(Point), n, vertices_) != n)
+            return false;
+
+        if (binary && format_ == "off")
+        {
+            if (fwrite(points.data(), sizeof(Point), n, out) != n)
+                return false;
+        }
+        else if (binary)
+        {
+            coordinates.resize(3 * n);
+            for (size_t j = 0; j < n; ++j)
+                for (int k = 0; k < 3; ++k)
+                    coordinates[3 * j + k] = float(points[j][k]);
+            if (fwrite(coordinates.data(), sizeof(float), 3 * n, out) != 3 * n)
+                return false;
+        }
+        else
+        {
+            const char* format = format_ == "obj" ? "v %.10f %.10f %.10f\n"
+                                 : format_ == "ply" ? "%.9g %.9g %.9g\n"
+                                                    : "%.10f %.10f %.10f\n";
+            for (size_t j = 0; j < n; ++j)
+                fprintf(out, format, points[j][0], points[j][1],
+                        points[j][2]);
+        }
+    }
+
+    return !ferror(out);
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMeshStreamWriter::write_faces(FILE* out) const
+{
+    const bool binary = has_binary();
+    std::vector<IndexType> indices;
+
+    for (size_t i = 0; i < n_faces_; ++i)
+    {
+        IndexType n;
+        if (!read_raw(faces_, n))
+            return false;
+        indices.resize(n);
+        if (fread(indices.data(), sizeof(IndexType), n, faces_) != n)
+            return false;
+
+        if (binary && format_ == "off")
+        {
+            write_raw(out, n);
+            fwrite(indices.data(), sizeof(IndexType), n, out);
+        }
+        else if (binary)
+        {
+            if (max_valence_ > 255)
+                write_raw(out, int32_t(n));
+            else
+                write_raw(out, uint8_t(n));
+            for (auto idx : indices)
+                write_raw(out, int32_t(idx));
+        }
+        else
+        {
+            if (format_ == "obj")
+                fprintf(out, "f");
+            else
+                fprintf(out, "%u", (unsigned int)n);
+            const unsigned int base = format_ == "obj" ? 1 : 0;
+            for (auto idx : indices)
+                fprintf(out, " %u", (unsigned int)idx + base);
+            fprintf(out, "\n");
+        }
+    }
+
+    return !ferror(out);
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -0,0 +1,127 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <pmp/SurfaceMesh.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \addtogroup core core
+//!@{
+
+//! \brief Receives the vertices and faces of a mesh file in batches.
+//! \details Derive from this class and pass it to read_stream() to process
+//! meshes that do not fit into memory, e.g., for filtering, statistics, or
+//! format conversion. Vertices are numbered consecutively from zero in the
+//! order they are passed, and faces only refer to vertices passed before.
+//! Batches of vertices and faces may alternate, e.g., for OBJ files. All
+//! functions return whether reading should continue.
+class SurfaceMeshSink
+{
+public:
+    virtual ~SurfaceMeshSink() {}
+
+    //! \brief Called before the first batch.
+    //! \details The counts are taken from the file header, they are zero
+    //! for formats without counts, e.g., OBJ.
+    virtual bool begin(size_t n_vertices, size_t n_faces)
+    {
+        (void)n_vertices;
+        (void)n_faces;
+        return true;
+    }
+
+    //! the positions of the next vertices
+    virtual bool vertices(const std::vector<Point>& points) = 0;
+
+    //! \brief The next faces.
+    //! \details Face \c i consists of the next \c face_sizes[i] vertex
+    //! indices of \p indices, like in SurfaceMesh::add_faces().
+    virtual bool faces(const std::vector<IndexType>& indices,
+                       const std::vector<IndexType>& face_sizes) = 0;
+
+    //! Called after the last batch.
+    virtual bool end() { return true; }
+};
+
+//! \brief Read the vertex positions and faces of a mesh file in batches.
+//! \details Passes batches of at most \p batch_size vertices or faces to
+//! \p sink without building a SurfaceMesh, such that the memory used does
+//! not depend on the size of the file. Supports the OFF, OBJ, PLY, and STL
+//! formats. Further attributes are ignored. The triangles of STL files are
+//! passed as a soup with three separate vertices each, see weld_vertices().
+//! Compressed files, see SurfaceMesh::read(), are decompressed to memory as a
+//! whole first.
+//! \return false if the file cannot be read or the sink stops reading
+bool read_stream(const std::string& filename, SurfaceMeshSink& sink,
+                 size_t batch_size = 65536);
+
+//! \brief A sink that writes the streamed mesh to a file.
+//! \details Vertices and faces are buffered in temporary files and written
+//! to \c filename by end(), such that the memory used does not depend on the
+//! size of the mesh. Supports the OFF, OBJ, and PLY formats, and the
+//! IOFlags::use_binary option for OFF and PLY. XYZ files receive the vertex
+//! positions only. Usage:
+//! \code
+//! SurfaceMeshStreamWriter writer("output.ply", flags);
+//! read_stream("input.obj", writer);
+//! \endcode
+class SurfaceMeshStreamWriter : public SurfaceMeshSink
+{
+public:
+    //! write to \p filename, controlled by \p flags
+    SurfaceMeshStreamWriter(const std::string& filename,
+                            const IOFlags& flags = IOFlags());
+    ~SurfaceMeshStreamWriter();
+
+    // the temporary files cannot be copied
+    SurfaceMeshStreamWriter(const SurfaceMeshStreamWriter&) = delete;
+    SurfaceMeshStreamWriter& operator=(const SurfaceMeshStreamWriter&) =
+        delete;
+
+    bool begin(size_t n_vertices, size_t n_faces) override;
+    bool vertices(const std::vector<Point>& points) override;
+    bool faces(const std::vector<IndexType>& indices,
+               const std::vector<IndexType>& face_sizes) override;
+    bool end() override;
+
+private:
+    void close();
+    bool has_binary() const;
+    bool write_header(FILE* out) const;
+    bool write_vertices(FILE* out) const;
+    bool write_faces(FILE* out) const;
+
+    std::string filename_;
+    std::string format_;
+    IOFlags flags_;
+
+    // temporary files holding the raw vertices and faces
+    FILE* vertices_;
+    FILE* faces_;
+
+    size_t n_vertices_;
+    size_t n_faces_;
+    size_t max_valence_;
+};
+
+//!@}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -0,0 +1,410 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/TaskGraph.h>
+#include <pmp/Parallel.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+namespace {
+
+// Executes dynamically spawned tasks. Each worker pushes and pops tasks at
+// the back of its own deque, and idle workers steal from the front of the
+// others, which takes the oldest and therefore typically largest tasks. IO
+// tasks are queued separately for an extra thread.
+class Scheduler
+{
+public:
+    typedef std::function<void()> Function;
+
+    explicit Scheduler(size_t n_workers)
+        : workers_(std::max(n_workers, size_t(1))),
+          io_thread_(n_workers > 1), pending_(0), queued_(0), next_(0)
+    {
+        for (auto& w : workers_)
+            w.reset(new Worker);
+    }
+
+    size_t n_workers() const { return workers_.size(); }
+
+    // queue task f, called by any thread. The continuation \p then runs
+    // after f, even if f throws.
+    void spawn(Function f, TaskKind kind, Function then = Function());
+
+    // run all tasks spawned so far and their children, then return
+    void run();
+
+    // execute one task of the worker queues, return false if there is none
+    bool execute_one();
+
+    // the scheduler and worker index of the calling thread
+    static thread_local Scheduler* current;
+    static thread_local size_t current_worker;
+
+private:
+    struct Task
+    {
+        Function f, then;
+    };
+
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void work(size_t index);
+    void serve_io();
+    void execute(Task& task);
+    void finish_task();
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    bool io_thread_;
+    std::mutex io_mutex_;
+    std::deque<Task> io_tasks_;
+
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    std::atomic<size_t> pending_; // spawned but not finished
+    std::atomic<size_t> queued_;  // waiting in the worker queues
+    std::atomic<size_t> next_;    // round robin for non-worker threads
+
+    std::mutex error_mutex_;
+    std::exception_ptr error_;
+};
+
+thread_local Scheduler* Scheduler::current = nullptr;
+thread_local size_t Scheduler::current_worker = 0;
+
+void Scheduler::spawn(Function f, TaskKind kind, Function then)
+{
+    ++pending_;
+    Task task = {std::move(f), std::move(then)};
+    if (kind == TaskKind::IO && io_thread_)
+    {
+        std::lock_guard<std::mutex> lock(io_mutex_);
+        io_tasks_.push_back(std::move(task));
+    }
+    else
+    {
+        const size_t i = (current == this && current_worker < n_workers())
+                             ? current_worker
+                             : next_++ % n_workers();
+        std::lock_guard<std::mutex> lock(workers_[i]->mutex);
+        workers_[i]->tasks.push_back(std::move(task));
+        ++queued_;
+    }
+
+    // the lock orders the queue update before a sleeping thread re-checks
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+    }
+    wake_.notify_all();
+}
+
+bool Scheduler::execute_one()
+{
+    if (queued_ == 0)
+        return false;
+
+    // own tasks from the back, then steal from the front of the others
+    const size_t n = n_workers();
+    const size_t self = (current == this) ? current_worker : 0;
+    for (size_t k = 0; k < n; ++k)
+    {
+        Worker& w = *workers_[(self + k) % n];
+        std::unique_lock<std::mutex> lock(w.mutex);
+        if (w.tasks.empty())
+            continue;
+        Task task;
+        if (k == 0 && self < n)
+        {
+            task = std::move(w.tasks.back());
+            w.tasks.pop_back();
+        }
+        else
+        {
+            task = std::move(w.tasks.front());
+            w.tasks.pop_front();
+        }
+        --queued_;
+        lock.unlock();
+        execute(task);
+        return true;
+    }
+    return false;
+}
+
+void Scheduler::execute(Task& task)
+{
+    for (Function* f : {&task.f, &task.then})
+    {
+        if (!*f)
+            continue;
+        try
+        {
+            (*f)();
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(error_mutex_);
+            if (!error_)
+                error_ = std::current_exception();
+        }
+    }
+    finish_task();
+}
+
+void Scheduler::finish_task()
+{
+    if (--pending_ == 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+        }
+        wake_.notify_all();
+    }
+}
+
+void Scheduler::work(size_t index)
+{
+    Scheduler* previous = current;
+    const size_t previous_worker = current_worker;
+    current = this;
+    current_worker = index;
+    while (pending_ > 0)
+    {
+        if (!execute_one())
+        {
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            wake_.wait(lock,
+                       [&] { return pending_ == 0 || queued_ > 0; });
+        }
+    }
+    current = previous;
+    current_worker = previous_worker;
+}
+
+void Scheduler::serve_io()
+{
+    // parallel loops of IO tasks are distributed over the workers
+    current = this;
+    current_worker = n_workers();
+    while (true)
+    {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            wake_.wait(lock, [&] {
+                std::lock_guard<std::mutex> io_lock(io_mutex_);
+                return pending_ == 0 || !io_tasks_.empty();
+            });
+            std::lock_guard<std::mutex> io_lock(io_mutex_);
+            if (io_tasks_.empty())
+                break;
+            task = std::move(io_tasks_.front());
+            io_tasks_.pop_front();
+        }
+        execute(task);
+    }
+    current = nullptr;
+}
+
+void Scheduler::run()
+{
+    std::vector<std::thread> threads;
+    if (io_thread_)
+        threads.emplace_back(&Scheduler::serve_io, this);
+    for (size_t i = 1; i < n_workers(); ++i)
+        threads.emplace_back(&Scheduler::work, this, i);
+    work(0);
+    for (auto& t : threads)
+        t.join();
+
+    if (error_)
+        std::rethrow_exception(error_);
+}
+
+} // namespace
+
+//=============================================================================
+
+namespace detail {
+
+// parallel_for() from within a task: the chunks become tasks of the
+// scheduler, and the calling thread executes tasks until they are done
+bool task_parallel_for(size_t n,
+                       const std::function<void(size_t, size_t)>& body,
+                       size_t grain_size)
+{
+    Scheduler* scheduler = Scheduler::current;
+    if (!scheduler || scheduler->n_workers() < 2 || n <= grain_size)
+        return false;
+
+    const size_t n_chunks =
+        std::min((n + grain_size - 1) / grain_size, 4 * scheduler->n_workers());
+    const size_t chunk_size = (n + n_chunks - 1) / n_chunks;
+    std::atomic<size_t> remaining(n_chunks - 1);
+    for (size_t c = 1; c < n_chunks; ++c)
+    {
+        scheduler->spawn(
+            [&, c]() {
+                const size_t b = c * chunk_size;
+                const size_t e = std::min(n, b + chunk_size);
+                if (b < e)
+                    body(b, e);
+            },
+            TaskKind::Compute, [&]() { --remaining; });
+    }
+
+    // the chunks refer to this stack frame, wait for them before throwing
+    std::exception_ptr error;
+    try
+    {
+        body(0, std::min(n, chunk_size));
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+    }
+    while (remaining > 0)
+        if (!scheduler->execute_one())
+            std::this_thread::yield();
+    if (error)
+        std::rethrow_exception(error);
+    return true;
+}
+
+} // namespace detail
+
+//=============================================================================
+
+TaskGraph::Task TaskGraph::add(std::function<void()> f,
+                               const std::vector<Task>& dependencies,
+                               TaskKind kind)
+{
+    const Task task = tasks_.size();
+    Node node;
+    node.f = std::move(f);
+    node.kind = kind;
+    node.n_dependencies = dependencies.size();
+    for (auto d : dependencies)
+        tasks_[d].dependents.push_back(task);
+    tasks_.push_back(std::move(node));
+    return task;
+}
+
+//-----------------------------------------------------------------------------
+
+void TaskGraph::run()
+{
+    if (tasks_.empty())
+        return;
+
+    Scheduler scheduler(num_threads());
+    std::unique_ptr<std::atomic<size_t>[]> waiting(
+        new std::atomic<size_t>[tasks_.size()]);
+    for (size_t i = 0; i < tasks_.size(); ++i)
+        waiting[i] = tasks_[i].n_dependencies;
+
+    // a task spawns its dependents once it was the last of their dependencies
+    std::function<void(Task)> spawn = [&](Task t) {
+        scheduler.spawn(tasks_[t].f, tasks_[t].kind, [&, t]() {
+            for (auto d : tasks_[t].dependents)
+                if (--waiting[d] == 0)
+                    spawn(d);
+        });
+    };
+    for (Task t = 0; t < tasks_.size(); ++t)
+        if (tasks_[t].n_dependencies == 0)
+            spawn(t);
+    scheduler.run();
+}
+
+//=============================================================================
+
+Pipeline::Stage Pipeline::add_stage(std::function<void(size_t)> f,
+                                    const std::vector<Stage>& dependencies,
+                                    TaskKind kind)
+{
+    const Stage stage = stages_.size();
+    Node node;
+    node.f = std::move(f);
+    node.kind = kind;
+    node.n_dependencies = dependencies.size();
+    for (auto d : dependencies)
+        stages_[d].dependents.push_back(stage);
+    stages_.push_back(std::move(node));
+    return stage;
+}
+
+//-----------------------------------------------------------------------------
+
+void Pipeline::run(size_t n_items, size_t max_in_flight)
+{
+    if (stages_.empty() || n_items == 0)
+        return;
+
+    Scheduler scheduler(num_threads());
+    if (max_in_flight == 0)
+        max_in_flight = 2 * scheduler.n_workers();
+
+    // the stages waiting for dependencies, and the unfinished stages, of
+    // each item
+    const size_t n_stages = stages_.size();
+    std::unique_ptr<std::atomic<size_t>[]> waiting(
+        new std::atomic<size_t>[n_items * n_stages]);
+    std::unique_ptr<std::atomic<size_t>[]> unfinished(
+        new std::atomic<size_t>[n_items]);
+    std::atomic<size_t> next_item(0);
+
+    std::function<void()> start_item;
+    std::function<void(size_t, Stage)> spawn = [&](size_t i, Stage s) {
+        scheduler.spawn([&, i, s]() { stages_[s].f(i); }, stages_[s].kind,
+                        [&, i, s]() {
+                            for (auto d : stages_[s].dependents)
+                                if (--waiting[i * n_stages + d] == 0)
+                                    spawn(i, d);
+                            if (--unfinished[i] == 0)
+                                start_item();
+                        });
+    };
+    start_item = [&]() {
+        const size_t i = next_item++;
+        if (i >= n_items)
+            return;
+        unfinished[i] = n_stages;
+        for (Stage s = 0; s < n_stages; ++s)
+            waiting[i * n_stages + s] = stages_[s].n_dependencies;
+        for (Stage s = 0; s < n_stages; ++s)
+            if (stages_[s].n_dependencies == 0)
+                spawn(i, s);
+    };
+
+    for (size_t k = 0; k < std::min(max_in_flight, n_items); ++k)
+        start_item();
+    scheduler.run();
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
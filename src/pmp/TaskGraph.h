@@ -0,0 +1,144 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \addtogroup core core
+//!@{
+
+//! \brief Whether a task computes or waits for files.
+//! \details Compute tasks run on num_threads() worker threads that steal
+//! work from each other. IO tasks run on a separate thread, such that
+//! reading and writing overlaps with computation without occupying a core.
+enum class TaskKind
+{
+    Compute,
+    IO
+};
+
+//! \brief A graph of tasks executed by a work-stealing scheduler.
+//! \details A task starts as soon as all tasks it depends on have finished,
+//! so independent tasks run concurrently. parallel_for() called from within
+//! a task splits its loop into tasks of the same scheduler instead of
+//! starting further threads, such that nested parallelism does not
+//! oversubscribe the cores. Usage:
+//! \code
+//! TaskGraph graph;
+//! auto remesh = graph.add([&] { remeshing.uniform_remeshing(l); });
+//! auto curvature = graph.add([&] { curvature.analyze(); }, {remesh});
+//! auto features = graph.add([&] { features.detect_angle(a); }, {remesh});
+//! graph.add([&] { mesh.write(file); }, {curvature, features}, TaskKind::IO);
+//! graph.run();
+//! \endcode
+class TaskGraph
+{
+public:
+    //! the index of a task in the graph
+    typedef size_t Task;
+
+    //! \brief Add the task \p f that runs after the tasks \p dependencies.
+    //! \return the new task
+    Task add(std::function<void()> f,
+             const std::vector<Task>& dependencies = std::vector<Task>(),
+             TaskKind kind = TaskKind::Compute);
+
+    //! \brief Execute all tasks and wait until they have finished.
+    //! \details The calling thread takes part in the computation. The graph
+    //! can be run again. If tasks throw, the remaining tasks still run, and
+    //! the first exception is rethrown at the end.
+    void run();
+
+    //! the number of tasks
+    size_t size() const { return tasks_.size(); }
+
+    //! remove all tasks
+    void clear() { tasks_.clear(); }
+
+private:
+    struct Node
+    {
+        std::function<void()> f;
+        TaskKind kind;
+        std::vector<Task> dependents;
+        size_t n_dependencies;
+    };
+    std::vector<Node> tasks_;
+};
+
+//! \brief Run a graph of stages for many items, e.g., meshes, concurrently.
+//! \details Each item runs through all stages, where a stage starts after
+//! the stages it depends on have finished for the same item. Stages of
+//! different items are independent, so loading the next mesh overlaps with
+//! processing the current ones. At most \c max_in_flight items are started
+//! but not finished, which bounds the memory of the intermediate results.
+//! Items are started in increasing order. Usage:
+//! \code
+//! std::vector<SurfaceMesh> meshes(files.size());
+//! Pipeline pipeline;
+//! auto load = pipeline.add_stage(
+//!     [&](size_t i) { meshes[i].read(files[i]); }, {}, TaskKind::IO);
+//! auto smooth = pipeline.add_stage(
+//!     [&](size_t i) { SurfaceSmoothing(meshes[i]).explicit_smoothing(); },
+//!     {load});
+//! pipeline.add_stage(
+//!     [&](size_t i) {
+//!         meshes[i].write(outputs[i]);
+//!         meshes[i] = SurfaceMesh(); // free the memory
+//!     },
+//!     {smooth}, TaskKind::IO);
+//! pipeline.run(files.size(), 4);
+//! \endcode
+class Pipeline
+{
+public:
+    //! the index of a stage in the pipeline
+    typedef size_t Stage;
+
+    //! \brief Add the stage \p f, called as \c f(i) for each item \c i after
+    //! the stages \p dependencies of item \c i.
+    //! \return the new stage
+    Stage add_stage(std::function<void(size_t)> f,
+                    const std::vector<Stage>& dependencies =
+                        std::vector<Stage>(),
+                    TaskKind kind = TaskKind::Compute);
+
+    //! \brief Run all stages for the items 0, ..., \p n_items - 1.
+    //! \details A \p max_in_flight of 0 uses twice the number of threads.
+    //! Exceptions are handled as in TaskGraph::run().
+    void run(size_t n_items, size_t max_in_flight = 0);
+
+    //! the number of stages
+    size_t size() const { return stages_.size(); }
+
+private:
+    struct Node
+    {
+        std::function<void(size_t)> f;
+        TaskKind kind;
+        std::vector<Stage> dependents;
+        size_t n_dependencies;
+    };
+    std::vector<Node> stages_;
+};
+
+//!@}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
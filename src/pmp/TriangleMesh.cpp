@@ -0,0 +1,231 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/TriangleMesh.h>
+
+#include <iostream>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+TriangleMesh::TriangleMesh()
+{
+    update_handles();
+}
+
+//-----------------------------------------------------------------------------
+
+TriangleMesh& TriangleMesh::operator=(const TriangleMesh& rhs)
+{
+    if (this != &rhs)
+    {
+        // deep copy of property containers
+        vprops_ = rhs.vprops_;
+        hprops_ = rhs.hprops_;
+        fprops_ = rhs.fprops_;
+
+        // property handles contain pointers, have to be reassigned
+        update_handles();
+    }
+    return *this;
+}
+
+//-----------------------------------------------------------------------------
+
+void TriangleMesh::update_handles()
+{
+    vhalfedge_ = vertex_property<Halfedge>("v:connectivity");
+    hconn_ = halfedge_property<HalfedgeConnectivity>("h:connectivity");
+    vpoint_ = vertex_property<Point>("v:point");
+}
+
+//-----------------------------------------------------------------------------
+
+void TriangleMesh::clear()
+{
+    vprops_.clear();
+    hprops_.clear();
+    fprops_.clear();
+    vprops_.free_memory();
+    hprops_.free_memory();
+    fprops_.free_memory();
+
+    // add the standard properties back
+    update_handles();
+}
+
+//-----------------------------------------------------------------------------
+
+void TriangleMesh::resize(size_t nv, size_t nf)
+{
+    clear();
+    vprops_.resize(nv);
+    hprops_.resize(3 * nf);
+    fprops_.resize(nf);
+}
+
+//-----------------------------------------------------------------------------
+
+bool TriangleMesh::build_from_indices(const std::vector<Point>& positions,
+                                      const std::vector<IndexType>& indices)
+{
+    const size_t nv = positions.size();
+    const size_t nh = indices.size();
+    if (nh % 3 != 0)
+    {
+        std::cerr << "TriangleMesh::build_from_indices: number of indices "
+                     "is not a multiple of three\n";
+        clear();
+        return false;
+    }
+    for (size_t i = 0; i < nh; i += 3)
+    {
+        const IndexType a = indices[i], b = indices[i + 1], c = indices[i + 2];
+        if (a >= nv || b >= nv || c >= nv || a == b || b == c || c == a)
+        {
+            std::cerr << "TriangleMesh::build_from_indices: invalid triangle "
+                      << i / 3 << "\n";
+            clear();
+            return false;
+        }
+    }
+
+    resize(nv, nh / 3);
+    vpoint_.vector() = positions;
+    for (size_t i = 0; i < nh; ++i)
+        hconn_[Halfedge(i)].vertex_ = Vertex(indices[i]);
+
+    // the outgoing halfedges of each vertex, in compressed rows
+    std::vector<IndexType> offsets(nv + 1, 0);
+    for (auto h : halfedges())
+        ++offsets[from_vertex(h).idx() + 1];
+    for (size_t v = 0; v < nv; ++v)
+        offsets[v + 1] += offsets[v];
+    std::vector<IndexType> outgoing(nh);
+    {
+        std::vector<IndexType> fill(offsets.begin(), offsets.end() - 1);
+        for (auto h : halfedges())
+            outgoing[fill[from_vertex(h).idx()]++] = h.idx();
+    }
+
+    // pair each halfedge with an unpaired one running the other way
+    for (auto h : halfedges())
+    {
+        if (opposite_halfedge(h).is_valid())
+            continue;
+        const Vertex from = from_vertex(h);
+        const IndexType to = to_vertex(h).idx();
+        for (IndexType i = offsets[to]; i < offsets[to + 1]; ++i)
+        {
+            const Halfedge o(outgoing[i]);
+            if (to_vertex(o) == from && !opposite_halfedge(o).is_valid())
+            {
+                hconn_[h].opposite_ = o;
+                hconn_[o].opposite_ = h;
+                break;
+            }
+        }
+    }
+
+    update_vertex_halfedges();
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool TriangleMesh::assign(const SurfaceMesh& mesh)
+{
+    if (!mesh.is_triangle_mesh())
+    {
+        std::cerr << "TriangleMesh::assign: not a triangle mesh\n";
+        clear();
+        return false;
+    }
+
+    // number the vertices, skipping deleted ones
+    std::vector<IndexType> vertex_index(mesh.vertices_size(),
+                                        PMP_MAX_INDEX);
+    IndexType nv = 0;
+    for (auto v : mesh.vertices())
+        vertex_index[v.idx()] = nv++;
+
+    resize(nv, mesh.n_faces());
+    auto points = mesh.get_vertex_property<Point>("v:point");
+    for (auto v : mesh.vertices())
+        vpoint_[Vertex(vertex_index[v.idx()])] = points[v];
+
+    // map the halfedges of each face to its corners
+    std::vector<IndexType> corner(mesh.halfedges_size(), PMP_MAX_INDEX);
+    IndexType c = 0;
+    for (auto f : mesh.faces())
+    {
+        for (auto h : mesh.halfedges(f))
+        {
+            corner[h.idx()] = c;
+            hconn_[Halfedge(c)].vertex_ =
+                Vertex(vertex_index[mesh.to_vertex(h).idx()]);
+            ++c;
+        }
+    }
+
+    // boundary halfedges have no corner, leaving the opposite invalid
+    for (auto h : mesh.halfedges())
+    {
+        const IndexType o = corner[mesh.opposite_halfedge(h).idx()];
+        if (corner[h.idx()] != PMP_MAX_INDEX && o != PMP_MAX_INDEX)
+            hconn_[Halfedge(corner[h.idx()])].opposite_ = Halfedge(o);
+    }
+
+    update_vertex_halfedges();
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool TriangleMesh::to_surface_mesh(SurfaceMesh& mesh) const
+{
+    std::vector<Point> positions(vpoint_.data(),
+                                 vpoint_.data() + n_vertices());
+    std::vector<IndexType> indices(n_halfedges());
+    for (auto h : halfedges())
+        indices[h.idx()] = to_vertex(h).idx();
+    return mesh.build_from_indices(positions, indices);
+}
+
+//-----------------------------------------------------------------------------
+
+void TriangleMesh::update_vertex_halfedges()
+{
+    for (auto h : halfedges())
+    {
+        Halfedge& vh = vhalfedge_[from_vertex(h)];
+        if (!vh.is_valid() || is_boundary(h))
+            vh = h;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+unsigned int TriangleMesh::valence(Vertex v) const
+{
+    unsigned int count = 0;
+    for (auto h : halfedges(v))
+    {
+        PMP_ASSERT(h.is_valid());
+        ++count;
+    }
+    return count;
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
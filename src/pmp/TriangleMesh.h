@@ -0,0 +1,813 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <pmp/SurfaceMesh.h>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \addtogroup core core
+//!@{
+
+//! \brief A compact, static triangle mesh with implicit halfedges.
+//! \details The three halfedges of face \c f are 3f, 3f+1, and 3f+2, so the
+//! next and previous halfedge and the face of a halfedge follow from its
+//! index. Each halfedge only stores the vertex it points to and its opposite
+//! halfedge, and faces store no connectivity at all. Compared to the 16
+//! bytes per halfedge and 4 bytes per face of SurfaceMesh, this reduces the
+//! connectivity memory by more than half.
+//!
+//! There are no boundary halfedges: the halfedges of boundary edges have no
+//! opposite halfedge, see is_boundary(Halfedge). There are no edge handles
+//! either. The connectivity is built at once by build_from_indices() or
+//! assign() and cannot be changed afterwards, but positions and properties
+//! can. Vertex and face properties, iterators, and circulators are used as
+//! for SurfaceMesh:
+//! \code
+//! TriangleMesh tm;
+//! tm.assign(mesh);
+//! auto center = tm.add_face_property<Point>("f:center");
+//! for (auto f : tm.faces())
+//!     for (auto v : tm.vertices(f))
+//!         center[f] += tm.position(v) / 3;
+//! tm.to_surface_mesh(mesh);
+//! \endcode
+//! Vertices and faces keep their indices in both conversions, as long as
+//! the SurfaceMesh has no deleted elements, so further properties can be
+//! copied by index.
+class TriangleMesh
+{
+public:
+    //! \name Iterator types
+    //!@{
+
+    //! an iterator over all vertices, halfedges, or faces
+    template <class HandleT>
+    class HandleIterator
+    {
+    public:
+        //! construct from handle
+        explicit HandleIterator(HandleT h = HandleT()) : handle_(h) {}
+
+        //! get the handle the iterator refers to
+        HandleT operator*() const { return handle_; }
+
+        //! are two iterators equal?
+        bool operator==(const HandleIterator& rhs) const
+        {
+            return handle_ == rhs.handle_;
+        }
+
+        //! are two iterators different?
+        bool operator!=(const HandleIterator& rhs) const
+        {
+            return !operator==(rhs);
+        }
+
+        //! pre-increment iterator
+        HandleIterator& operator++()
+        {
+            handle_ = HandleT(handle_.idx() + 1);
+            return *this;
+        }
+
+        //! pre-decrement iterator
+        HandleIterator& operator--()
+        {
+            handle_ = HandleT(handle_.idx() - 1);
+            return *this;
+        }
+
+    private:
+        HandleT handle_;
+    };
+
+    //! iterates linearly over all vertices
+    typedef HandleIterator<Vertex> VertexIterator;
+
+    //! iterates linearly over all halfedges
+    typedef HandleIterator<Halfedge> HalfedgeIterator;
+
+    //! iterates linearly over all faces
+    typedef HandleIterator<Face> FaceIterator;
+
+    //!@}
+    //! \name Container types
+    //!@{
+
+    //! helper class for iterating through all elements using C++11
+    //! range-based for-loops
+    template <class Iterator>
+    class HandleContainer
+    {
+    public:
+        HandleContainer(Iterator begin, Iterator end)
+            : begin_(begin), end_(end)
+        {
+        }
+        Iterator begin() const { return begin_; }
+        Iterator end() const { return end_; }
+
+    private:
+        Iterator begin_, end_;
+    };
+
+    //! range of all vertices
+    typedef HandleContainer<VertexIterator> VertexContainer;
+
+    //! range of all halfedges
+    typedef HandleContainer<HalfedgeIterator> HalfedgeContainer;
+
+    //! range of all faces
+    typedef HandleContainer<FaceIterator> FaceContainer;
+
+    //!@}
+    //! \name Circulator types
+    //!@{
+
+    //! \brief Circulates counter-clockwise through the outgoing halfedges
+    //! of a vertex, one per incident face.
+    //! \details At a boundary vertex, the circulation starts at the halfedge
+    //! of a boundary edge, see halfedge(Vertex).
+    class HalfedgeAroundVertexCirculator
+    {
+    public:
+        //! default constructor
+        HalfedgeAroundVertexCirculator(const TriangleMesh* mesh = nullptr,
+                                       Vertex v = Vertex())
+            : mesh_(mesh)
+        {
+            if (mesh_ && v.is_valid())
+                start_ = halfedge_ = mesh_->halfedge(v);
+        }
+
+        //! are two circulators equal?
+        bool operator==(const HalfedgeAroundVertexCirculator& rhs) const
+        {
+            return halfedge_ == rhs.halfedge_;
+        }
+
+        //! are two circulators different?
+        bool operator!=(const HalfedgeAroundVertexCirculator& rhs) const
+        {
+            return !operator==(rhs);
+        }
+
+        //! pre-increment (rotate counter-clockwise)
+        HalfedgeAroundVertexCirculator& operator++()
+        {
+            assert(mesh_);
+            halfedge_ = mesh_->ccw_rotated_halfedge(halfedge_);
+            if (halfedge_ == start_)
+                halfedge_ = Halfedge();
+            return *this;
+        }
+
+        //! get the halfedge the circulator refers to
+        Halfedge operator*() const { return halfedge_; }
+
+        //! cast to bool: true if vertex is not isolated
+        operator bool() const { return start_.is_valid(); }
+
+        // helper for C++11 range-based for-loops
+        HalfedgeAroundVertexCirculator begin() const { return *this; }
+        // helper for C++11 range-based for-loops
+        HalfedgeAroundVertexCirculator end() const
+        {
+            return HalfedgeAroundVertexCirculator(mesh_);
+        }
+
+    private:
+        const TriangleMesh* mesh_;
+        Halfedge start_;
+        Halfedge halfedge_;
+    };
+
+    //! circulates counter-clockwise through the faces incident to a vertex
+    class FaceAroundVertexCirculator
+    {
+    public:
+        //! default constructor
+        FaceAroundVertexCirculator(const TriangleMesh* mesh = nullptr,
+                                   Vertex v = Vertex())
+            : mesh_(mesh), halfedges_(mesh, v)
+        {
+        }
+
+        //! are two circulators equal?
+        bool operator==(const FaceAroundVertexCirculator& rhs) const
+        {
+            return halfedges_ == rhs.halfedges_;
+        }
+
+        //! are two circulators different?
+        bool operator!=(const FaceAroundVertexCirculator& rhs) const
+        {
+            return !operator==(rhs);
+        }
+
+        //! pre-increment (rotate counter-clockwise)
+        FaceAroundVertexCirculator& operator++()
+        {
+            ++halfedges_;
+            return *this;
+        }
+
+        //! get the face the circulator refers to
+        Face operator*() const { return mesh_->face(*halfedges_); }
+
+        //! cast to bool: true if vertex is not isolated
+        operator bool() const { return bool(halfedges_); }
+
+        // helper for C++11 range-based for-loops
+        FaceAroundVertexCirculator begin() const { return *this; }
+        // helper for C++11 range-based for-loops
+        FaceAroundVertexCirculator end() const
+        {
+            return FaceAroundVertexCirculator(mesh_);
+        }
+
+    private:
+        const TriangleMesh* mesh_;
+        HalfedgeAroundVertexCirculator halfedges_;
+    };
+
+    //! \brief Circulates counter-clockwise through the one-ring neighbors of
+    //! a vertex.
+    //! \details At a boundary vertex, the last neighbor is the one across
+    //! the second boundary edge, which has no outgoing halfedge.
+    class VertexAroundVertexCirculator
+    {
+    public:
+        //! default constructor
+        VertexAroundVertexCirculator(const TriangleMesh* mesh = nullptr,
+                                     Vertex v = Vertex())
+            : mesh_(mesh), incoming_(false)
+        {
+            if (mesh_ && v.is_valid())
+                start_ = halfedge_ = mesh_->halfedge(v);
+        }
+
+        //! are two circulators equal?
+        bool operator==(const VertexAroundVertexCirculator& rhs) const
+        {
+            return halfedge_ == rhs.halfedge_ && incoming_ == rhs.incoming_;
+        }
+
+        //! are two circulators different?
+        bool operator!=(const VertexAroundVertexCirculator& rhs) const
+        {
+            return !operator==(rhs);
+        }
+
+        //! pre-increment (rotate counter-clockwise)
+        VertexAroundVertexCirculator& operator++()
+        {
+            assert(mesh_);
+            if (incoming_)
+            {
+                halfedge_ = Halfedge();
+                incoming_ = false;
+                return *this;
+            }
+            const Halfedge h = mesh_->ccw_rotated_halfedge(halfedge_);
+            if (!h.is_valid())
+            {
+                // continue with the incoming boundary halfedge
+                halfedge_ = mesh_->prev_halfedge(halfedge_);
+                incoming_ = true;
+            }
+            else
+            {
+                halfedge_ = (h == start_) ? Halfedge() : h;
+            }
+            return *this;
+        }
+
+        //! get the vertex the circulator refers to
+        Vertex operator*() const
+        {
+            assert(mesh_);
+            return incoming_ ? mesh_->from_vertex(halfedge_)
+                             : mesh_->to_vertex(halfedge_);
+        }
+
+        //! cast to bool: true if vertex is not isolated
+        operator bool() const { return start_.is_valid(); }
+
+        // helper for C++11 range-based for-loops
+        VertexAroundVertexCirculator begin() const { return *this; }
+        // helper for C++11 range-based for-loops
+        VertexAroundVertexCirculator end() const
+        {
+            return VertexAroundVertexCirculator(mesh_);
+        }
+
+    private:
+        const TriangleMesh* mesh_;
+        Halfedge start_;
+        Halfedge halfedge_;
+        bool incoming_; // halfedge_ is the incoming boundary halfedge
+    };
+
+    //! circulates through the three halfedges of a face
+    class HalfedgeAroundFaceCirculator
+    {
+    public:
+        //! default constructor
+        explicit HalfedgeAroundFaceCirculator(Halfedge h = Halfedge())
+            : halfedge_(h)
+        {
+        }
+
+        //! are two circulators equal?
+        bool operator==(const HalfedgeAroundFaceCirculator& rhs) const
+        {
+            return halfedge_ == rhs.halfedge_;
+        }
+
+        //! are two circulators different?
+        bool operator!=(const HalfedgeAroundFaceCirculator& rhs) const
+        {
+            return !operator==(rhs);
+        }
+
+        //! pre-increment
+        HalfedgeAroundFaceCirculator& operator++()
+        {
+            halfedge_ = Halfedge(halfedge_.idx() + 1);
+            return *this;
+        }
+
+        //! get the halfedge the circulator refers to
+        Halfedge operator*() const { return halfedge_; }
+
+        // helper for C++11 range-based for-loops
+        HalfedgeAroundFaceCirculator begin() const { return *this; }
+        // helper for C++11 range-based for-loops
+        HalfedgeAroundFaceCirculator end() const
+        {
+            return HalfedgeAroundFaceCirculator(Halfedge(
+                halfedge_.idx() - halfedge_.idx() % 3 + 3));
+        }
+
+    private:
+        Halfedge halfedge_;
+    };
+
+    //! circulates through the three vertices of a face
+    class VertexAroundFaceCirculator
+    {
+    public:
+        //! default constructor
+        VertexAroundFaceCirculator(const TriangleMesh* mesh = nullptr,
+                                   Halfedge h = Halfedge())
+            : mesh_(mesh), halfedges_(h)
+        {
+        }
+
+        //! are two circulators equal?
+        bool operator==(const VertexAroundFaceCirculator& rhs) const
+        {
+            return halfedges_ == rhs.halfedges_;
+        }
+
+        //! are two circulators different?
+        bool operator!=(const VertexAroundFaceCirculator& rhs) const
+        {
+            return !operator==(rhs);
+        }
+
+        //! pre-increment
+        VertexAroundFaceCirculator& operator++()
+        {
+            ++halfedges_;
+            return *this;
+        }
+
+        //! get the vertex the circulator refers to
+        Vertex operator*() const { return mesh_->to_vertex(*halfedges_); }
+
+        // helper for C++11 range-based for-loops
+        VertexAroundFaceCirculator begin() const { return *this; }
+        // helper for C++11 range-based for-loops
+        VertexAroundFaceCirculator end() const
+        {
+            return VertexAroundFaceCirculator(mesh_, *halfedges_.end());
+        }
+
+    private:
+        const TriangleMesh* mesh_;
+        HalfedgeAroundFaceCirculator halfedges_;
+    };
+
+    //!@}
+    //! \name Construction, destruction, assignment
+    //!@{
+
+    //! default constructor
+    TriangleMesh();
+
+    //! copy constructor: copies \p rhs to \p *this. performs a deep copy of
+    //! all properties.
+    TriangleMesh(const TriangleMesh& rhs) { operator=(rhs); }
+
+    //! assign \p rhs to \p *this. performs a deep copy of all properties.
+    TriangleMesh& operator=(const TriangleMesh& rhs);
+
+    //! \brief Replace the mesh by the given vertex positions and triangles.
+    //! \details Triangle \c i consists of the vertices \p indices[3i],
+    //! \p indices[3i+1], and \p indices[3i+2] and becomes Face(i). Edges
+    //! shared by more than two triangles are connected only between the
+    //! first two, the others become boundary edges. At vertices with
+    //! several fans of triangles, the circulators visit only one fan.
+    //! \return false, leaving the mesh empty, if \p indices contains invalid
+    //! or repeated vertex indices
+    bool build_from_indices(const std::vector<Point>& positions,
+                            const std::vector<IndexType>& indices);
+
+    //! \brief Replace the mesh by the triangles of \p mesh.
+    //! \details Copies the positions and the connectivity. The vertices and
+    //! faces are numbered in the order of \p mesh, skipping deleted ones.
+    //! \return false, leaving the mesh empty, if \p mesh is not a triangle
+    //! mesh
+    bool assign(const SurfaceMesh& mesh);
+
+    //! \brief Replace \p mesh by the vertices and triangles of this mesh.
+    //! \details Builds the connectivity of \p mesh in bulk, see
+    //! SurfaceMesh::build_from_indices(). Vertices and faces keep their
+    //! indices.
+    //! \return whether all triangles were added to \p mesh
+    bool to_surface_mesh(SurfaceMesh& mesh) const;
+
+    //! clear mesh: remove all vertices and faces
+    void clear();
+
+    //!@}
+    //! \name Memory management
+    //!@{
+
+    //! \return number of vertices in the mesh
+    size_t n_vertices() const { return vprops_.size(); }
+
+    //! \return number of halfedges in the mesh
+    size_t n_halfedges() const { return hprops_.size(); }
+
+    //! \return number of faces in the mesh
+    size_t n_faces() const { return fprops_.size(); }
+
+    //! \return true iff the mesh is empty, i.e., has no vertices
+    bool is_empty() const { return n_vertices() == 0; }
+
+    //! \return the bytes used by the connectivity of vertices and halfedges
+    size_t connectivity_memory() const
+    {
+        return n_vertices() * sizeof(Halfedge) +
+               n_halfedges() * sizeof(HalfedgeConnectivity);
+    }
+
+    //!@}
+    //! \name Low-level connectivity
+    //!@{
+
+    //! \return whether \p v is a valid vertex
+    bool is_valid(Vertex v) const { return v.idx() < n_vertices(); }
+
+    //! \return whether \p h is a valid halfedge
+    bool is_valid(Halfedge h) const { return h.idx() < n_halfedges(); }
+
+    //! \return whether \p f is a valid face
+    bool is_valid(Face f) const { return f.idx() < n_faces(); }
+
+    //! \return an outgoing halfedge of vertex \p v, for a boundary vertex
+    //! one of a boundary edge
+    Halfedge halfedge(Vertex v) const { return vhalfedge_[v]; }
+
+    //! \return whether \p v is a boundary vertex
+    bool is_boundary(Vertex v) const
+    {
+        const Halfedge h = halfedge(v);
+        return !(h.is_valid() && opposite_halfedge(h).is_valid());
+    }
+
+    //! \return whether \p v is isolated, i.e., not incident to any face
+    bool is_isolated(Vertex v) const { return !halfedge(v).is_valid(); }
+
+    //! \return whether the edge of \p h is a boundary edge, i.e., \p h has
+    //! no opposite halfedge
+    bool is_boundary(Halfedge h) const
+    {
+        return !opposite_halfedge(h).is_valid();
+    }
+
+    //! \return the vertex the halfedge \p h points to
+    Vertex to_vertex(Halfedge h) const { return hconn_[h].vertex_; }
+
+    //! \return the vertex the halfedge \p h emanates from
+    Vertex from_vertex(Halfedge h) const
+    {
+        return to_vertex(prev_halfedge(h));
+    }
+
+    //! \return the next halfedge within the face of \p h
+    Halfedge next_halfedge(Halfedge h) const
+    {
+        return Halfedge(h.idx() % 3 == 2 ? h.idx() - 2 : h.idx() + 1);
+    }
+
+    //! \return the previous halfedge within the face of \p h
+    Halfedge prev_halfedge(Halfedge h) const
+    {
+        return Halfedge(h.idx() % 3 == 0 ? h.idx() + 2 : h.idx() - 1);
+    }
+
+    //! \return the opposite halfedge of \p h, invalid if the edge of \p h
+    //! is a boundary edge
+    Halfedge opposite_halfedge(Halfedge h) const
+    {
+        return hconn_[h].opposite_;
+    }
+
+    //! \return the halfedge that is rotated counter-clockwise around the
+    //! start vertex of \p h, invalid at the boundary
+    Halfedge ccw_rotated_halfedge(Halfedge h) const
+    {
+        return opposite_halfedge(prev_halfedge(h));
+    }
+
+    //! \return the halfedge that is rotated clockwise around the start
+    //! vertex of \p h, invalid at the boundary
+    Halfedge cw_rotated_halfedge(Halfedge h) const
+    {
+        const Halfedge o = opposite_halfedge(h);
+        return o.is_valid() ? next_halfedge(o) : o;
+    }
+
+    //! \return the face of halfedge \p h
+    Face face(Halfedge h) const { return Face(h.idx() / 3); }
+
+    //! \return the first halfedge of face \p f, the one pointing to the
+    //! first vertex of \p f
+    Halfedge halfedge(Face f) const { return Halfedge(3 * f.idx()); }
+
+    //! \return the number of faces incident to \p v
+    unsigned int valence(Vertex v) const;
+
+    //!@}
+    //! \name Property handling
+    //!@{
+
+    //! add a vertex property of type \c T with name \c name and default
+    //! value \c t. returns an invalid property if the name exists.
+    template <class T>
+    VertexProperty<T> add_vertex_property(const std::string& name,
+                                          const T t = T())
+    {
+        return VertexProperty<T>(vprops_.add<T>(name, t));
+    }
+
+    //! get the vertex property named \c name of type \c T, invalid if the
+    //! property does not exist or if the type does not match
+    template <class T>
+    VertexProperty<T> get_vertex_property(const std::string& name) const
+    {
+        return VertexProperty<T>(vprops_.get<T>(name));
+    }
+
+    //! get or add the vertex property of type \c T named \c name
+    template <class T>
+    VertexProperty<T> vertex_property(const std::string& name, const T t = T())
+    {
+        return VertexProperty<T>(vprops_.get_or_add<T>(name, t));
+    }
+
+    //! remove the vertex property \c p
+    template <class T>
+    void remove_vertex_property(VertexProperty<T>& p)
+    {
+        vprops_.remove(p);
+    }
+
+    //! does the mesh have a vertex property with name \c name?
+    bool has_vertex_property(const std::string& name) const
+    {
+        return vprops_.exists(name);
+    }
+
+    //! add a halfedge property of type \c T with name \c name and default
+    //! value \c t. returns an invalid property if the name exists.
+    template <class T>
+    HalfedgeProperty<T> add_halfedge_property(const std::string& name,
+                                              const T t = T())
+    {
+        return HalfedgeProperty<T>(hprops_.add<T>(name, t));
+    }
+
+    //! get the halfedge property named \c name of type \c T, invalid if
+    //! the property does not exist or if the type does not match
+    template <class T>
+    HalfedgeProperty<T> get_halfedge_property(const std::string& name) const
+    {
+        return HalfedgeProperty<T>(hprops_.get<T>(name));
+    }
+
+    //! get or add the halfedge property of type \c T named \c name
+    template <class T>
+    HalfedgeProperty<T> halfedge_property(const std::string& name,
+                                          const T t = T())
+    {
+        return HalfedgeProperty<T>(hprops_.get_or_add<T>(name, t));
+    }
+
+    //! remove the halfedge property \c p
+    template <class T>
+    void remove_halfedge_property(HalfedgeProperty<T>& p)
+    {
+        hprops_.remove(p);
+    }
+
+    //! does the mesh have a halfedge property with name \c name?
+    bool has_halfedge_property(const std::string& name) const
+    {
+        return hprops_.exists(name);
+    }
+
+    //! add a face property of type \c T with name \c name and default
+    //! value \c t. returns an invalid property if the name exists.
+    template <class T>
+    FaceProperty<T> add_face_property(const std::string& name,
+                                      const T t = T())
+    {
+        return FaceProperty<T>(fprops_.add<T>(name, t));
+    }
+
+    //! get the face property named \c name of type \c T, invalid if the
+    //! property does not exist or if the type does not match
+    template <class T>
+    FaceProperty<T> get_face_property(const std::string& name) const
+    {
+        return FaceProperty<T>(fprops_.get<T>(name));
+    }
+
+    //! get or add the face property of type \c T named \c name
+    template <class T>
+    FaceProperty<T> face_property(const std::string& name, const T t = T())
+    {
+        return FaceProperty<T>(fprops_.get_or_add<T>(name, t));
+    }
+
+    //! remove the face property \c p
+    template <class T>
+    void remove_face_property(FaceProperty<T>& p)
+    {
+        fprops_.remove(p);
+    }
+
+    //! does the mesh have a face property with name \c name?
+    bool has_face_property(const std::string& name) const
+    {
+        return fprops_.exists(name);
+    }
+
+    //! \return the names of all vertex properties
+    std::vector<std::string> vertex_properties() const
+    {
+        return vprops_.properties();
+    }
+
+    //! \return the names of all halfedge properties
+    std::vector<std::string> halfedge_properties() const
+    {
+        return hprops_.properties();
+    }
+
+    //! \return the names of all face properties
+    std::vector<std::string> face_properties() const
+    {
+        return fprops_.properties();
+    }
+
+    //!@}
+    //! \name Iterators and circulators
+    //!@{
+
+    //! \return vertex container for C++11 range-based for-loops
+    VertexContainer vertices() const
+    {
+        return VertexContainer(VertexIterator(Vertex(0)),
+                               VertexIterator(Vertex(n_vertices())));
+    }
+
+    //! \return halfedge container for C++11 range-based for-loops
+    HalfedgeContainer halfedges() const
+    {
+        return HalfedgeContainer(HalfedgeIterator(Halfedge(0)),
+                                 HalfedgeIterator(Halfedge(n_halfedges())));
+    }
+
+    //! \return face container for C++11 range-based for-loops
+    FaceContainer faces() const
+    {
+        return FaceContainer(FaceIterator(Face(0)),
+                             FaceIterator(Face(n_faces())));
+    }
+
+    //! \return circulator for the vertices around vertex \p v
+    VertexAroundVertexCirculator vertices(Vertex v) const
+    {
+        return VertexAroundVertexCirculator(this, v);
+    }
+
+    //! \return circulator for the outgoing halfedges around vertex \p v
+    HalfedgeAroundVertexCirculator halfedges(Vertex v) const
+    {
+        return HalfedgeAroundVertexCirculator(this, v);
+    }
+
+    //! \return circulator for the faces around vertex \p v
+    FaceAroundVertexCirculator faces(Vertex v) const
+    {
+        return FaceAroundVertexCirculator(this, v);
+    }
+
+    //! \return circulator for the vertices of face \p f
+    VertexAroundFaceCirculator vertices(Face f) const
+    {
+        return VertexAroundFaceCirculator(this, halfedge(f));
+    }
+
+    //! \return circulator for the halfedges of face \p f
+    HalfedgeAroundFaceCirculator halfedges(Face f) const
+    {
+        return HalfedgeAroundFaceCirculator(halfedge(f));
+    }
+
+    //!@}
+    //! \name Geometry-related functions
+    //!@{
+
+    //! position of a vertex (read only)
+    const Point& position(Vertex v) const { return vpoint_[v]; }
+
+    //! position of a vertex
+    Point& position(Vertex v) { return vpoint_[v]; }
+
+    //! vector of point positions
+    std::vector<Point>& positions() { return vpoint_.vector(); }
+
+    //! compute the bounding box of the mesh
+    BoundingBox bounds() const
+    {
+        BoundingBox bb;
+        for (auto v : vertices())
+            bb += position(v);
+        return bb;
+    }
+
+    //!@}
+
+private:
+    // the connectivity of a halfedge, next, previous, and face are implicit
+    struct HalfedgeConnectivity
+    {
+        Vertex vertex_;     // vertex the halfedge points to
+        Halfedge opposite_; // invalid at the boundary
+    };
+
+    // set up the properties for nv vertices and nf faces
+    void resize(size_t nv, size_t nf);
+
+    // get the handles of the standard properties
+    void update_handles();
+
+    // connect the vertices to an outgoing halfedge, preferring boundary
+    // edges
+    void update_vertex_halfedges();
+
+    // property containers for each entity type
+    PropertyContainer vprops_;
+    PropertyContainer hprops_;
+    PropertyContainer fprops_;
+
+    // connectivity and positions
+    VertexProperty<Halfedge> vhalfedge_;
+    HalfedgeProperty<HalfedgeConnectivity> hconn_;
+    VertexProperty<Point> vpoint_;
+};
+
+//!@}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
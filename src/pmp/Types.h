@@ -11,6 +11,8 @@
 
 #include <pmp/MatVec.h>
 #include <cstdint> // for std::uint_least32_t
+#include <string>
+#include <vector>
 
 //=============================================================================
 
@@ -71,6 +73,115 @@ typedef std::uint_least32_t IndexType;
 #define PMP_MAX_INDEX UINT_LEAST32_MAX
 #endif
 
+//! \brief A bool stored in one byte.
+//! \details Properties of type bool are stored as bits by std::vector<bool>,
+//! which makes them slow to access, and concurrent writes to different
+//! elements may conflict. Use Flag properties for flags that are accessed
+//! often or written in parallel.
+class Flag
+{
+public:
+    //! construct from bool, false by default
+    Flag(bool b = false) : value_(b) {}
+
+    //! convert to bool
+    operator bool() const { return value_ != 0; }
+
+private:
+    unsigned char value_;
+};
+
+//! \brief A unit normal stored in two 16-bit integers.
+//! \details Uses the octahedral encoding: the normal is projected to the
+//! octahedron |x| + |y| + |z| = 1, whose lower half is folded over the
+//! upper one, and the resulting square is quantized. The angular error is
+//! below 0.005 degrees, at a third of the memory of a float Normal. Use it
+//! as the type of "v:normal" or "f:normal" properties to save memory. The
+//! values convert from and to Normal on access:
+//! \code
+//! auto normals = mesh.add_vertex_property<OctNormal>("v:normal");
+//! normals[v] = Normal(0, 0, 1);
+//! Normal n = normals[v];
+//! \endcode
+class OctNormal
+{
+public:
+    //! encode \p n, which does not need to be normalized
+    OctNormal(const Normal& n = Normal(0, 0, 1))
+    {
+        const Scalar l1 = std::abs(n[0]) + std::abs(n[1]) + std::abs(n[2]);
+        Scalar u = l1 > 0 ? n[0] / l1 : 0;
+        Scalar v = l1 > 0 ? n[1] / l1 : 0;
+        if (n[2] < 0)
+            fold(u, v);
+        x_ = quantize(u);
+        y_ = quantize(v);
+    }
+
+    //! decode to a unit normal
+    operator Normal() const
+    {
+        Scalar u = Scalar(x_) / 32767, v = Scalar(y_) / 32767;
+        const Scalar z = 1 - std::abs(u) - std::abs(v);
+        if (z < 0)
+            fold(u, v);
+        return normalize(Normal(u, v, z));
+    }
+
+    //! the encoded coordinate \p i, scaled to [-32767, 32767]
+    std::int16_t operator[](int i) const { return i ? y_ : x_; }
+
+private:
+    // reflect a point of the square at the edges of the octahedron
+    static void fold(Scalar& u, Scalar& v)
+    {
+        const Scalar fu = (1 - std::abs(v)) * (u < 0 ? -1 : 1);
+        const Scalar fv = (1 - std::abs(u)) * (v < 0 ? -1 : 1);
+        u = fu;
+        v = fv;
+    }
+
+    static std::int16_t quantize(Scalar x)
+    {
+        return std::int16_t(std::floor(
+            std::min(std::max(x, Scalar(-1)), Scalar(1)) * 32767 + 0.5));
+    }
+
+    std::int16_t x_, y_;
+};
+
+//! \brief A texture coordinate stored in two 16-bit integers.
+//! \details Quantizes coordinates in [0, 1] to 65536 steps, at half the
+//! memory of a float TexCoord. Coordinates outside [0, 1] are clamped. The
+//! values convert from and to TexCoord on access, like OctNormal.
+class TexCoord16
+{
+public:
+    //! encode \p t
+    TexCoord16(const TexCoord& t = TexCoord(0, 0))
+        : u_(quantize(t[0])), v_(quantize(t[1]))
+    {
+    }
+
+    //! decode to a texture coordinate
+    operator TexCoord() const
+    {
+        return TexCoord(Scalar(u_) / 65535, Scalar(v_) / 65535);
+    }
+
+    //! the encoded coordinate \p i, scaled to [0, 65535]
+    std::uint16_t operator[](int i) const { return i ? v_ : u_; }
+
+private:
+    static std::uint16_t quantize(Scalar x)
+    {
+        return std::uint16_t(std::floor(
+            std::min(std::max(x, Scalar(0)), Scalar(1)) * 65535 + 0.5));
+    }
+
+    std::uint16_t u_, v_;
+};
+
 //! Common IO flags for reading and writing
 struct IOFlags
 {
@@ -79,9 +190,21 @@ struct IOFlags
     bool use_vertex_normals = false;     //!< read / write vertex normals
     bool use_vertex_colors = false;      //!< read / write vertex colors
     bool use_vertex_texcoords = false;   //!< read / write vertex texcoords
+    bool use_vertex_quality = false;     //!< read / write vertex quality
     bool use_face_normals = false;       //!< read / write face normals
     bool use_face_colors = false;        //!< read / write face colors
     bool use_halfedge_texcoords = false; //!< read / write halfedge texcoords
+    bool use_custom_properties = true;   //!< read / write further properties
+                                         //!< (PMP only)
+    std::vector<std::string> custom_properties; //!< names of the properties
+                                                //!< to read, all if empty
+    unsigned int quantization_bits = 0; //!< bits per coordinate in PMPZ
+                                        //!< files, lossless if zero
+    Scalar crease_angle = 180; //!< crease angle in degrees of the corner
+                               //!< normals written to GLB files
+    bool optimize_vertex_cache = false; //!< write the triangles of GLB files
+                                        //!< in an order for the GPU vertex
+                                        //!< cache, see SurfaceReordering
 };
 
 //! @}
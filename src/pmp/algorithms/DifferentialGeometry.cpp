@@ -8,6 +8,7 @@
 //=============================================================================
 
 #include <pmp/algorithms/DifferentialGeometry.h>
+#include <pmp/Parallel.h>
 
 #include <limits>
 #include <cmath>
@@ -42,12 +43,8 @@ Scalar triangle_area(const SurfaceMesh& mesh, Face f)
 
 Scalar surface_area(const SurfaceMesh& mesh)
 {
-    Scalar area(0);
-    for (auto f: mesh.faces())
-    {
-        area += triangle_area(mesh, f);
-    }
-    return area;
+    return parallel_reduce(mesh.faces(), Scalar(0),
+                           [&](Face f) { return triangle_area(mesh, f); });
 }
 
 //-----------------------------------------------------------------------------
@@ -69,17 +66,15 @@ Point centroid(const SurfaceMesh& mesh, Face f)
 
 Point centroid(const SurfaceMesh& mesh)
 {
-    Point  center(0,0,0), c;
-    Scalar area(0), a;
-    for (auto f: mesh.faces())
-    {
-        a = triangle_area(mesh, f);
-        c = centroid(mesh, f);
-        area   += a;
-        center += a*c;
-    }
-    center /= area;
-    return center;
+    // the area-weighted centroids and the area in one reduction
+    typedef Vector<Scalar, 4> Moments;
+    const Moments sum =
+        parallel_reduce(mesh.faces(), Moments(0, 0, 0, 0), [&](Face f) {
+            const Scalar a = triangle_area(mesh, f);
+            const Point c = a * centroid(mesh, f);
+            return Moments(c[0], c[1], c[2], a);
+        });
+    return Point(sum[0], sum[1], sum[2]) / sum[3];
 }
     
 //-----------------------------------------------------------------------------
@@ -59,20 +59,40 @@ inline Scalar cotan(const Point& v0, const Point& v1)
     return clamp_cot(dot(v0, v1) / norm(cross(v0, v1)));
 }
 
+//! compute angle between two (un-normalized) SIMD vectors, see vec3a
+inline float angle(const vec3a& v0, const vec3a& v1)
+{
+    return std::atan2(norm(cross(v0, v1)), dot(v0, v1));
+}
+
+//! compute cotangent of angle between two (un-normalized) SIMD vectors
+inline float cotan(const vec3a& v0, const vec3a& v1)
+{
+    return float(clamp_cot(dot(v0, v1) / norm(cross(v0, v1))));
+}
+
 //! compute area of a triangle given by three points
 Scalar triangle_area(const Point& p0, const Point& p1, const Point& p2);
 
+//! \brief compute area of a triangle given by three SIMD vectors
+//! \details Gives the same result as for Point in single precision.
+inline float triangle_area(const vec3a& p0, const vec3a& p1, const vec3a& p2)
+{
+    return 0.5f * norm(cross(p1 - p0, p2 - p0));
+}
+
 //! compute area of triangle f
 Scalar triangle_area(const SurfaceMesh& mesh, Face f);
 
-//! surface area of the mesh (assumes triangular faces)
+//! surface area of the mesh (assumes triangular faces), summed up by
+//! parallel_reduce()
 Scalar surface_area(const SurfaceMesh& mesh);
 
 //! barycenter/centroid of a face
 Point centroid(const SurfaceMesh& mesh, Face f);
 
 //! barycenter/centroid of mesh, computed as area-weighted mean of vertices.
-//! assumes triangular faces.
+//! assumes triangular faces. summed up by parallel_reduce().
 Point centroid(const SurfaceMesh& mesh);
 
 //! compute the cotangent weight for edge e
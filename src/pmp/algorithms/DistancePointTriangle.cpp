@@ -8,6 +8,7 @@
 //=============================================================================
 
 #include <pmp/algorithms/DistancePointTriangle.h>
+#include <algorithm>
 #include <cfloat>
 #include <cmath>
 
@@ -17,13 +18,18 @@ namespace pmp {
 
 //=============================================================================
 
-Scalar dist_point_line_segment(const Point& p, const Point& v0, const Point& v1,
-                               Point& nearest_point)
+namespace {
+
+// The computations for Point and vec3a. S is the scalar type.
+
+template <class VectorType, class S = typename VectorType::value_type>
+S line_segment_distance(const VectorType& p, const VectorType& v0,
+                        const VectorType& v1, VectorType& nearest_point)
 {
-    Point d1(p - v0);
-    Point d2(v1 - v0);
-    Point min_v(v0);
-    Scalar t = dot(d2, d2);
+    VectorType d1(p - v0);
+    VectorType d2(v1 - v0);
+    VectorType min_v(v0);
+    S t = dot(d2, d2);
 
     if (t > FLT_MIN)
     {
@@ -38,32 +44,43 @@ Scalar dist_point_line_segment(const Point& p, const Point& v0, const Point& v1,
     return norm(d1);
 }
 
-//-----------------------------------------------------------------------------
-
-Scalar dist_point_triangle(const Point& p, const Point& v0, const Point& v1,
-                           const Point& v2, Point& nearest_point)
+template <class VectorType, class S = typename VectorType::value_type>
+void precompute(const VectorType& v0, const VectorType& v1,
+                const VectorType& v2, VectorType& v0v1, VectorType& v0v2,
+                VectorType& v1v2, VectorType& n, S& inv_d)
 {
-    Point v0v1 = v1 - v0;
-    Point v0v2 = v2 - v0;
-    Point n = cross(v0v1, v0v2); // not normalized !
-    Scalar d = sqrnorm(n);
+    v0v1 = v1 - v0;
+    v0v2 = v2 - v0;
+    v1v2 = v2;
+    v1v2 -= v1;
+    n = cross(v0v1, v0v2); // not normalized !
+    S d = sqrnorm(n);
+    inv_d = (std::fabs(d) < FLT_MIN) ? S(0) : S(1.0 / d);
+}
 
+// the edge vectors and the normal are modified
+template <class VectorType, class S = typename VectorType::value_type>
+S triangle_distance(const VectorType& p, const VectorType& v0,
+                    const VectorType& v1, const VectorType& v2,
+                    VectorType v0v1, VectorType v0v2, VectorType v1v2,
+                    VectorType n, S inv_d, VectorType& nearest_point)
+{
     // Check if the triangle is degenerated -> measure dist to line segments
-    if (fabs(d) < FLT_MIN)
+    if (inv_d == 0)
     {
-        Point q, qq;
-        Scalar d, dd(FLT_MAX);
+        VectorType q, qq;
+        S d, dd(FLT_MAX);
 
-        dd = dist_point_line_segment(p, v0, v1, qq);
+        dd = line_segment_distance(p, v0, v1, qq);
 
-        d = dist_point_line_segment(p, v1, v2, q);
+        d = line_segment_distance(p, v1, v2, q);
         if (d < dd)
         {
             dd = d;
             qq = q;
         }
 
-        d = dist_point_line_segment(p, v2, v0, q);
+        d = line_segment_distance(p, v2, v0, q);
         if (d < dd)
         {
             dd = d;
@@ -74,15 +91,12 @@ Scalar dist_point_triangle(const Point& p, const Point& v0, const Point& v1,
         return dd;
     }
 
-    Scalar inv_d = 1.0 / d;
-    Point v1v2 = v2;
-    v1v2 -= v1;
-    Point v0p = p;
+    VectorType v0p = p;
     v0p -= v0;
-    Point t = cross(v0p, n);
-    Scalar a = dot(t, v0v2) * -inv_d;
-    Scalar b = dot(t, v0v1) * inv_d;
-    Scalar s01, s02, s12;
+    VectorType t = cross(v0p, n);
+    S a = dot(t, v0v2) * -inv_d;
+    S b = dot(t, v0v1) * inv_d;
+    S s01, s02, s12;
 
     // Calculate the distance to an edge or a corner vertex
     if (a < 0)
@@ -222,6 +236,211 @@ Scalar dist_point_triangle(const Point& p, const Point& v0, const Point& v1,
     return norm(v0p);
 }
 
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+Scalar dist_point_line_segment(const Point& p, const Point& v0, const Point& v1,
+                               Point& nearest_point)
+{
+    return line_segment_distance(p, v0, v1, nearest_point);
+}
+
+//-----------------------------------------------------------------------------
+
+float dist_point_line_segment(const vec3a& p, const vec3a& v0,
+                              const vec3a& v1, vec3a& nearest_point)
+{
+    return line_segment_distance(p, v0, v1, nearest_point);
+}
+
+//-----------------------------------------------------------------------------
+
+PrecomputedTriangle::PrecomputedTriangle(const Point& x0, const Point& x1,
+                                         const Point& x2)
+    : v0(x0), v1(x1), v2(x2)
+{
+    precompute(v0, v1, v2, v0v1, v0v2, v1v2, n, inv_d);
+}
+
+//-----------------------------------------------------------------------------
+
+Scalar dist_point_triangle(const Point& p, const Point& v0, const Point& v1,
+                           const Point& v2, Point& nearest_point)
+{
+    return dist_point_triangle(p, PrecomputedTriangle(v0, v1, v2),
+                               nearest_point);
+}
+
+//-----------------------------------------------------------------------------
+
+Scalar dist_point_triangle(const Point& p, const PrecomputedTriangle& tri,
+                           Point& nearest_point)
+{
+    return triangle_distance(p, tri.v0, tri.v1, tri.v2, tri.v0v1, tri.v0v2,
+                             tri.v1v2, tri.n, tri.inv_d, nearest_point);
+}
+
+//-----------------------------------------------------------------------------
+
+float dist_point_triangle(const vec3a& p, const vec3a& v0, const vec3a& v1,
+                          const vec3a& v2, vec3a& nearest_point)
+{
+    vec3a v0v1, v0v2, v1v2, n;
+    float inv_d;
+    precompute(v0, v1, v2, v0v1, v0v2, v1v2, n, inv_d);
+    return triangle_distance(p, v0, v1, v2, v0v1, v0v2, v1v2, n, inv_d,
+                             nearest_point);
+}
+
+//=============================================================================
+
+void TriangleSoA::resize(size_t n)
+{
+    for (auto c : {&x0, &y0, &z0, &x1, &y1, &z1, &x2, &y2, &z2})
+        c->resize(n);
+}
+
+//-----------------------------------------------------------------------------
+
+void TriangleSoA::set(size_t i, const Point& v0, const Point& v1,
+                      const Point& v2)
+{
+    x0[i] = v0[0];
+    y0[i] = v0[1];
+    z0[i] = v0[2];
+    x1[i] = v1[0];
+    y1[i] = v1[1];
+    z1[i] = v1[2];
+    x2[i] = v2[0];
+    y2[i] = v2[1];
+    z2[i] = v2[2];
+}
+
+//-----------------------------------------------------------------------------
+
+Point TriangleSoA::corner(size_t i, int j) const
+{
+    switch (j)
+    {
+        case 0:
+            return Point(x0[i], y0[i], z0[i]);
+        case 1:
+            return Point(x1[i], y1[i], z1[i]);
+        default:
+            return Point(x2[i], y2[i], z2[i]);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+// squared distance of the point v + d to the segment from v to v + e
+inline Scalar sqr_dist_segment(Scalar dx, Scalar dy, Scalar dz, Scalar ex,
+                               Scalar ey, Scalar ez)
+{
+    const Scalar ee = ex * ex + ey * ey + ez * ez;
+    const Scalar de = dx * ex + dy * ey + dz * ez;
+
+    // clamp t to [0, 1] without conditionals
+    Scalar t = de / (ee > FLT_MIN ? ee : Scalar(FLT_MIN));
+    t = Scalar(0.5) * (std::fabs(t) - std::fabs(t - 1) + 1);
+
+    const Scalar x = dx - t * ex;
+    const Scalar y = dy - t * ey;
+    const Scalar z = dz - t * ez;
+    return x * x + y * y + z * z;
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+void sqr_dist_point_triangles(const Point& p, const TriangleSoA& triangles,
+                              size_t begin, size_t end, Scalar* sqr_dists)
+{
+    const Scalar px = p[0], py = p[1], pz = p[2];
+
+    // The distances to the plane and to the edges are selected in a second
+    // loop. Selecting them in the first one keeps the compiler from
+    // vectorizing it, since it would compute each of them conditionally.
+    const size_t chunk = 64;
+    Scalar planes[chunk], sides[chunk];
+
+    for (size_t first = begin; first < end; first += chunk)
+    {
+        const size_t n = std::min(chunk, end - first);
+        const Scalar* x0 = triangles.x0.data() + first;
+        const Scalar* y0 = triangles.y0.data() + first;
+        const Scalar* z0 = triangles.z0.data() + first;
+        const Scalar* x1 = triangles.x1.data() + first;
+        const Scalar* y1 = triangles.y1.data() + first;
+        const Scalar* z1 = triangles.z1.data() + first;
+        const Scalar* x2 = triangles.x2.data() + first;
+        const Scalar* y2 = triangles.y2.data() + first;
+        const Scalar* z2 = triangles.z2.data() + first;
+        Scalar* edges = sqr_dists + (first - begin);
+
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+        for (size_t i = 0; i < n; ++i)
+        {
+            // edges and (unnormalized) normal
+            const Scalar e0x = x1[i] - x0[i], e0y = y1[i] - y0[i],
+                         e0z = z1[i] - z0[i];
+            const Scalar e1x = x2[i] - x1[i], e1y = y2[i] - y1[i],
+                         e1z = z2[i] - z1[i];
+            const Scalar e2x = x0[i] - x2[i], e2y = y0[i] - y2[i],
+                         e2z = z0[i] - z2[i];
+            const Scalar nx = e2y * e0z - e2z * e0y;
+            const Scalar ny = e2z * e0x - e2x * e0z;
+            const Scalar nz = e2x * e0y - e2y * e0x;
+            const Scalar nn = nx * nx + ny * ny + nz * nz;
+
+            // p relative to the corners
+            const Scalar d0x = px - x0[i], d0y = py - y0[i],
+                         d0z = pz - z0[i];
+            const Scalar d1x = px - x1[i], d1y = py - y1[i],
+                         d1z = pz - z1[i];
+            const Scalar d2x = px - x2[i], d2y = py - y2[i],
+                         d2z = pz - z2[i];
+
+            // p projects into the triangle if it is on the inner side of all
+            // edges, i.e., dot(cross(e, d), n) > 0, which fails for
+            // degenerate triangles
+            const Scalar s0 = (e0y * d0z - e0z * d0y) * nx +
+                              (e0z * d0x - e0x * d0z) * ny +
+                              (e0x * d0y - e0y * d0x) * nz;
+            const Scalar s1 = (e1y * d1z - e1z * d1y) * nx +
+                              (e1z * d1x - e1x * d1z) * ny +
+                              (e1x * d1y - e1y * d1x) * nz;
+            const Scalar s2 = (e2y * d2z - e2z * d2y) * nx +
+                              (e2z * d2x - e2x * d2z) * ny +
+                              (e2x * d2y - e2y * d2x) * nz;
+            const Scalar s01 = s0 < s1 ? s0 : s1;
+            sides[i] = s01 < s2 ? s01 : s2;
+
+            const Scalar h = d0x * nx + d0y * ny + d0z * nz;
+            planes[i] = h * h / (nn > FLT_MIN ? nn : Scalar(FLT_MIN));
+
+            // otherwise the nearest point is on an edge
+            const Scalar a = sqr_dist_segment(d0x, d0y, d0z, e0x, e0y, e0z);
+            const Scalar b = sqr_dist_segment(d1x, d1y, d1z, e1x, e1y, e1z);
+            const Scalar c = sqr_dist_segment(d2x, d2y, d2z, e2x, e2y, e2z);
+            const Scalar ab = a < b ? a : b;
+            edges[i] = ab < c ? ab : c;
+        }
+
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+        for (size_t i = 0; i < n; ++i)
+            edges[i] = sides[i] > 0 ? planes[i] : edges[i];
+    }
+}
+
 //=============================================================================
 } // namespace pmp
 //=============================================================================
@@ -11,6 +11,8 @@
 
 #include <pmp/Types.h>
 
+#include <vector>
+
 //=============================================================================
 
 namespace pmp {
@@ -28,6 +30,65 @@ Scalar dist_point_line_segment(const Point& p, const Point& v0, const Point& v1,
 Scalar dist_point_triangle(const Point& p, const Point& v0, const Point& v1,
                            const Point& v2, Point& nearest_point);
 
+//! \brief Compute the distance of a point p to a line segment given by points
+//! (v0,v1) with SIMD vectors, see vec3a.
+//! \details Gives the same result as for Point in single precision.
+float dist_point_line_segment(const vec3a& p, const vec3a& v0,
+                              const vec3a& v1, vec3a& nearest_point);
+
+//! \brief Compute the distance of a point p to the triangle given by points
+//! (v0, v1, v2) with SIMD vectors, see vec3a.
+//! \details Gives the same result as for Point in single precision, e.g.,
+//! for kernels that keep their points in a VertexProperty<vec3a>.
+float dist_point_triangle(const vec3a& p, const vec3a& v0, const vec3a& v1,
+                          const vec3a& v2, vec3a& nearest_point);
+
+//! A triangle with precomputed edges and normal for repeated distance queries
+struct PrecomputedTriangle
+{
+    PrecomputedTriangle() {}
+    PrecomputedTriangle(const Point& x0, const Point& x1, const Point& x2);
+
+    Point v0, v1, v2;       //!< corners
+    Point v0v1, v0v2, v1v2; //!< edge vectors
+    Point n;                //!< unnormalized normal
+    Scalar inv_d;           //!< inverse squared norm of n, zero if degenerate
+};
+
+//! \brief Compute the distance of a point p to a precomputed triangle.
+//! \details Gives the same result as for the triangle's corners, but saves
+//! their setup when testing a triangle many times.
+Scalar dist_point_triangle(const Point& p, const PrecomputedTriangle& t,
+                           Point& nearest_point);
+
+//! Triangles stored as structure of arrays for sqr_dist_point_triangles()
+struct TriangleSoA
+{
+    //! the number of triangles
+    size_t size() const { return x0.size(); }
+
+    //! resize to \p n triangles
+    void resize(size_t n);
+
+    //! set the corners of triangle \p i
+    void set(size_t i, const Point& v0, const Point& v1, const Point& v2);
+
+    //! corner \p j of triangle \p i
+    Point corner(size_t i, int j) const;
+
+    //! coordinates of the corners
+    std::vector<Scalar> x0, y0, z0, x1, y1, z1, x2, y2, z2;
+};
+
+//! \brief Compute the squared distances of a point p to the triangles
+//! [begin, end) of \p triangles, stored in \p sqr_dists[0, end - begin).
+//! \details The computation is branch-free, which lets the compiler
+//! vectorize the loop over the triangles. The results agree with
+//! dist_point_triangle() up to rounding. Use the latter to compute the
+//! exact distance and nearest point of the closest candidates.
+void sqr_dist_point_triangles(const Point& p, const TriangleSoA& triangles,
+                              size_t begin, size_t end, Scalar* sqr_dists);
+
 //=============================================================================
 //! @}
 //=============================================================================
@@ -0,0 +1,89 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/algorithms/FarthestPointSampling.h>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+FarthestPointSampling::FarthestPointSampling(SurfaceMesh& mesh,
+                                             bool use_virtual_edges)
+    : mesh_(mesh),
+      geodesic_(mesh, use_virtual_edges),
+      distance_(mesh.vertices_size(), FLT_MAX),
+      label_(mesh.vertices_size(), PMP_MAX_INDEX)
+{
+    for (auto v : mesh.vertices())
+        farthest_.push(std::make_pair(Scalar(FLT_MAX), v.idx()));
+}
+
+//-----------------------------------------------------------------------------
+
+void FarthestPointSampling::add_sample(Vertex v)
+{
+    const IndexType label = IndexType(samples_.size());
+    samples_.push_back(v);
+
+    // the region where the new sample is nearest
+    geodesic_.compute_below(std::vector<Vertex>{v}, distance_, &reached_);
+    reached_.push_back(v);
+    for (auto w : reached_)
+    {
+        const Scalar d = geodesic_(w);
+        if (d < distance_[w.idx()])
+        {
+            distance_[w.idx()] = d;
+            label_[w.idx()] = label;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+Vertex FarthestPointSampling::farthest()
+{
+    // distances only decrease, so an entry is valid if it is up to date
+    while (!farthest_.empty())
+    {
+        const auto top = farthest_.top();
+        const Scalar d = distance_[top.second];
+        if (top.first == d)
+            return d > 0 ? Vertex(top.second) : Vertex();
+        farthest_.pop();
+        farthest_.push(std::make_pair(d, top.second));
+    }
+    return Vertex();
+}
+
+//-----------------------------------------------------------------------------
+
+void FarthestPointSampling::sample(unsigned int n, Vertex first)
+{
+    if (n && samples_.empty() && mesh_.is_valid(first) &&
+        !mesh_.is_deleted(first))
+    {
+        add_sample(first);
+        --n;
+    }
+
+    for (; n > 0; --n)
+    {
+        const Vertex v = farthest();
+        if (!v.is_valid())
+            break;
+        add_sample(v);
+    }
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -0,0 +1,91 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <pmp/SurfaceMesh.h>
+#include <pmp/algorithms/SurfaceGeodesic.h>
+
+#include <queue>
+#include <utility>
+#include <vector>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \addtogroup algorithms algorithms
+//! @{
+
+//=============================================================================
+
+//! \brief Farthest-point sampling of the vertices of a mesh by geodesic
+//! distance.
+//! \details Each new sample is the vertex farthest from the previous ones.
+//! The distances to the nearest sample are updated incrementally: a new
+//! sample propagates a SurfaceGeodesic front only where it lowers them, see
+//! SurfaceGeodesic::compute_below(), i.e., through its own geodesic Voronoi
+//! cell. The farthest vertex is kept in a max-heap with lazy updates. Adding
+//! a sample thus costs time proportional to its cell instead of the whole
+//! mesh, which makes thousands of samples affordable:
+//! \code
+//! FarthestPointSampling fps(mesh);
+//! fps.sample(1000);
+//! for (auto v : mesh.vertices())
+//!     region[v] = fps.label(v);
+//! \endcode
+class FarthestPointSampling
+{
+public:
+    //! construct with \p mesh, see SurfaceGeodesic for the virtual edges
+    FarthestPointSampling(SurfaceMesh& mesh, bool use_virtual_edges = true);
+
+    //! \brief Add \p v as the next sample.
+    void add_sample(Vertex v);
+
+    //! \brief Add \p n samples, each farthest from the previous ones.
+    //! \details Starts at \p first if there are no samples yet. Vertices
+    //! not connected to any sample are farthest, such that each component
+    //! gets a sample before any component gets a second one.
+    void sample(unsigned int n, Vertex first = Vertex(0));
+
+    //! the samples in the order they were added
+    const std::vector<Vertex>& samples() const { return samples_; }
+
+    //! the vertex farthest from the samples, invalid if there is none
+    Vertex farthest();
+
+    //! the geodesic distance of \p v to its nearest sample, FLT_MAX if none
+    Scalar distance(Vertex v) const { return distance_[v.idx()]; }
+
+    //! \brief The index of the nearest sample of \p v in samples().
+    //! \details These labels partition the mesh into the geodesic Voronoi
+    //! cells of the samples. PMP_MAX_INDEX if \p v is not reached.
+    IndexType label(Vertex v) const { return label_[v.idx()]; }
+
+private:
+    const SurfaceMesh& mesh_;
+    SurfaceGeodesic geodesic_;
+
+    std::vector<Vertex> samples_;
+    std::vector<Scalar> distance_;
+    std::vector<IndexType> label_;
+
+    // vertices by decreasing distance, with outdated entries
+    std::priority_queue<std::pair<Scalar, IndexType>> farthest_;
+    std::vector<Vertex> reached_;
+};
+
+//=============================================================================
+//! @}
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -0,0 +1,111 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/algorithms/GeometryCache.h>
+#include <pmp/algorithms/DifferentialGeometry.h>
+#include <pmp/algorithms/SurfaceNormals.h>
+#include <pmp/Parallel.h>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+namespace {
+
+// the cache registered with a mesh
+const PropertyKey<GeometryCache*> cache_key("geometry:cache");
+
+} // namespace
+
+//=============================================================================
+
+GeometryCache::GeometryCache(SurfaceMesh& mesh)
+    : mesh_(mesh), topology_version_(0)
+{
+    auto cache = mesh_.get_object_property(cache_key);
+    if (!cache)
+        cache = mesh_.add_object_property<GeometryCache*>(cache_key.name());
+    cache[0] = this;
+
+    compute();
+}
+
+//-----------------------------------------------------------------------------
+
+GeometryCache::~GeometryCache()
+{
+    auto cache = mesh_.get_object_property(cache_key);
+    if (cache && cache[0] == this)
+        mesh_.remove_object_property(cache);
+}
+
+//-----------------------------------------------------------------------------
+
+bool GeometryCache::is_valid() const
+{
+    return mesh_.topology_version() == topology_version_ &&
+           mesh_.positions() == positions_;
+}
+
+//-----------------------------------------------------------------------------
+
+void GeometryCache::update()
+{
+    if (!is_valid())
+        compute();
+}
+
+//-----------------------------------------------------------------------------
+
+const GeometryCache* GeometryCache::get(const SurfaceMesh& mesh)
+{
+    auto cache = mesh.get_object_property(cache_key);
+    if (!cache || !cache[0] || &cache[0]->mesh_ != &mesh ||
+        !cache[0]->is_valid())
+        return nullptr;
+    return cache[0];
+}
+
+//-----------------------------------------------------------------------------
+
+void GeometryCache::compute()
+{
+    topology_version_ = mesh_.topology_version();
+    positions_ = mesh_.positions();
+
+    // each quantity is only used by a single element, hence the passes
+    // evaluate the functions of DifferentialGeometry.h per element
+    cotan_.assign(mesh_.edges_size(), 0.0);
+    length_.assign(mesh_.edges_size(), 0);
+    parallel_for(mesh_.edges(), [&](Edge e) {
+        cotan_[e.idx()] = pmp::cotan_weight(mesh_, e);
+        length_[e.idx()] = mesh_.edge_length(e);
+    });
+
+    face_area_.assign(mesh_.faces_size(), 0);
+    face_normal_.assign(mesh_.faces_size(), Normal(0, 0, 0));
+    parallel_for(mesh_.faces(), [&](Face f) {
+        if (mesh_.valence(f) == 3)
+            face_area_[f.idx()] = triangle_area(mesh_, f);
+        face_normal_[f.idx()] = SurfaceNormals::compute_face_normal(mesh_, f);
+    });
+
+    voronoi_area_.assign(mesh_.vertices_size(), 0.0);
+    barycentric_area_.assign(mesh_.vertices_size(), 0.0);
+    parallel_for(mesh_.vertices(), [&](Vertex v) {
+        voronoi_area_[v.idx()] = pmp::voronoi_area(mesh_, v);
+        barycentric_area_[v.idx()] = pmp::voronoi_area_barycentric(mesh_, v);
+    });
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -0,0 +1,108 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <pmp/SurfaceMesh.h>
+
+#include <vector>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \addtogroup algorithms algorithms
+//!@{
+
+//! \brief Precomputed edge lengths, cotan weights, face areas, face normals
+//! and Voronoi areas of a mesh.
+//! \details The quantities are computed by parallel loops and match the
+//! functions of DifferentialGeometry.h and SurfaceNormals exactly. The cache
+//! registers itself with the mesh, such that SurfaceSmoothing,
+//! SurfaceFairing, SurfaceParameterization, SurfaceCurvature, and
+//! SurfaceFeatures use it instead of recomputing the weights from the
+//! positions while it is valid.
+//!
+//! The cache records SurfaceMesh::topology_version() and the vertex
+//! positions. Once either changes, is_valid() returns false, get() no longer
+//! returns the cache, and update() has to recompute it. The mesh has to
+//! outlive the cache. Usage:
+//! \code
+//! GeometryCache cache(mesh);
+//! SurfaceCurvature curvature(mesh);
+//! curvature.analyze(1); // uses the cache
+//! \endcode
+class GeometryCache
+{
+public:
+    //! compute the cache for \p mesh and register it with the mesh
+    GeometryCache(SurfaceMesh& mesh);
+
+    //! unregister the cache from the mesh
+    ~GeometryCache();
+
+    GeometryCache(const GeometryCache&) = delete;
+    GeometryCache& operator=(const GeometryCache&) = delete;
+
+    //! \brief Whether connectivity and positions are unchanged since the
+    //! last computation.
+    //! \details Compares all vertex positions, i.e., takes linear time.
+    bool is_valid() const;
+
+    //! recompute the cache, if it is not valid
+    void update();
+
+    //! the cotangent weight of edge \p e, see pmp::cotan_weight()
+    double cotan_weight(Edge e) const { return cotan_[e.idx()]; }
+
+    //! the length of edge \p e
+    Scalar edge_length(Edge e) const { return length_[e.idx()]; }
+
+    //! the area of triangle \p f, see pmp::triangle_area()
+    Scalar face_area(Face f) const { return face_area_[f.idx()]; }
+
+    //! the normal of face \p f, see SurfaceNormals::compute_face_normal()
+    Normal face_normal(Face f) const { return face_normal_[f.idx()]; }
+
+    //! the mixed Voronoi area of vertex \p v, see pmp::voronoi_area()
+    double voronoi_area(Vertex v) const { return voronoi_area_[v.idx()]; }
+
+    //! the barycentric Voronoi area of vertex \p v, see
+    //! pmp::voronoi_area_barycentric()
+    double voronoi_area_barycentric(Vertex v) const
+    {
+        return barycentric_area_[v.idx()];
+    }
+
+    //! \brief The valid cache registered with \p mesh.
+    //! \return nullptr if there is none or it is not valid
+    static const GeometryCache* get(const SurfaceMesh& mesh);
+
+private:
+    void compute();
+
+    SurfaceMesh& mesh_;
+    unsigned long topology_version_;
+    std::vector<Point> positions_; // the positions the cache is valid for
+
+    std::vector<double> cotan_;
+    std::vector<Scalar> length_;
+    std::vector<Scalar> face_area_;
+    std::vector<Normal> face_normal_;
+    std::vector<double> voronoi_area_;
+    std::vector<double> barycentric_area_;
+};
+
+//!@}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
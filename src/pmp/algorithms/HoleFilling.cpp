@@ -2,6 +2,12 @@
 
 #include <pmp/algorithms/HoleFilling.h>
 #include <pmp/algorithms/SurfaceFairing.h>
+#include <pmp/algorithms/SparseSolver.h>
+#include <pmp/Parallel.h>
+#include <pmp/Timer.h>
+
+#include <algorithm>
+#include <map>
 
 #include <Eigen/Dense>
 #include <Eigen/Sparse>
@@ -18,7 +24,8 @@ namespace pmp {
 
 HoleFilling::
 HoleFilling(SurfaceMesh& _mesh)
-  : mesh_(_mesh)
+  : mesh_(_mesh), first_vertex_(0), first_edge_(0),
+    fast_triangulation_(false)
 {
     points_  = mesh_.vertex_property<Point>("v:point");
 }
@@ -89,22 +96,32 @@ fill_hole(Halfedge _h)
     }
 
 
+    // trace hole
+    Triangulation t;
+    if (!trace_hole(_h, t.hole))
+    {
+        return false;
+    }
+    std::cout << t.hole.size() << " hole edges\n";
+
+
     bool ok = false;
 
 
     // lock vertices/edge that already exist, to be later able to
     // identify the filled-in vertices/edges
-    vlocked_ = mesh_.add_vertex_property<bool>("HoleFilling:vlocked", false);
-    elocked_ = mesh_.add_edge_property<bool>("HoleFilling:elocked", false);
-    for (auto v: mesh_.vertices())  vlocked_[v] = true;
-    for (auto e: mesh_.edges())     elocked_[e] = true;
+    lock_all();
 
 
     // first do minimal triangulation
-    if (triangulate_hole(_h))
+    if (triangulate_hole(t))
     {
+        add_triangles(t);
+
         // refine filled-in edges
+        hole_ = t.hole;
         refine();
+        mesh_.garbage_collection();
         ok = true;
     }
 
@@ -122,12 +139,158 @@ fill_hole(Halfedge _h)
 //-----------------------------------------------------------------------------
 
 
-bool
+std::vector<HoleFilling::HoleReport>
 HoleFilling::
-triangulate_hole(Halfedge _h)
+fill_all_holes(unsigned int _max_size)
 {
-    // trace hole
+    // keep the handles of the holes valid during refinement
+    mesh_.garbage_collection();
+
+
+    // find all holes in one pass
+    std::vector<HoleReport> reports;
+    auto visited = mesh_.add_halfedge_property<bool>("HoleFilling:visited", false);
+    for (auto h: mesh_.halfedges())
+    {
+        if (mesh_.is_boundary(h) && !visited[h])
+        {
+            HoleReport report;
+            report.halfedge = h;
+            report.n_edges  = 0;
+            report.filled   = false;
+            report.triangulation_time = report.refinement_time = 0.0;
+
+            Halfedge hh = h;
+            do
+            {
+                visited[hh] = true;
+                ++report.n_edges;
+            }
+            while ((hh = mesh_.next_halfedge(hh)) != h);
+
+            reports.push_back(report);
+        }
+    }
+    mesh_.remove_halfedge_property(visited);
+
+    std::stable_sort(reports.begin(), reports.end(),
+                     [](const HoleReport& a, const HoleReport& b)
+                     { return a.n_edges < b.n_edges; });
+
+
+    // minimal triangulations only read the mesh
+    std::vector<Triangulation> holes(reports.size());
+    std::vector<char> triangulated(reports.size(), false);
+    parallel_for(0, reports.size(), [&](size_t i) {
+        if (reports[i].n_edges > _max_size) return;
+        Timer timer;
+        timer.start();
+        triangulated[i] = (trace_hole(reports[i].halfedge, holes[i].hole) &&
+                           triangulate_hole(holes[i]));
+        reports[i].triangulation_time = timer.stop().elapsed();
+    });
+
+
+    // add and refine the holes one by one
+    lock_all();
+    for (size_t i=0; i<reports.size(); ++i)
+    {
+        if (triangulated[i])
+        {
+            Timer timer;
+            timer.start();
+            add_triangles(holes[i]);
+            hole_ = holes[i].hole;
+            refine();
+            lock_filled_in();
+            reports[i].refinement_time = timer.stop().elapsed();
+            reports[i].filled = true;
+        }
+    }
+
+
+    // clean up
     hole_.clear();
+    mesh_.remove_vertex_property(vlocked_);
+    mesh_.remove_edge_property(elocked_);
+    mesh_.garbage_collection();
+
+
+    return reports;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+HoleFilling::
+lock_all()
+{
+    vlocked_ = mesh_.vertex_property<bool>("HoleFilling:vlocked", false);
+    elocked_ = mesh_.edge_property<bool>("HoleFilling:elocked", false);
+    for (auto v: mesh_.vertices())  vlocked_[v] = true;
+    for (auto e: mesh_.edges())     elocked_[e] = true;
+
+    // garbage collection could move filled-in vertices/edges to the front
+    const bool garbage = (mesh_.n_vertices() != mesh_.vertices_size() ||
+                          mesh_.n_edges() != mesh_.edges_size());
+    first_vertex_ = garbage ? 0 : mesh_.vertices_size();
+    first_edge_   = garbage ? 0 : mesh_.edges_size();
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+HoleFilling::
+lock_filled_in()
+{
+    for (auto v: filled_in_vertices())  vlocked_[v] = true;
+    for (auto e: filled_in_edges())     elocked_[e] = true;
+
+    first_vertex_ = mesh_.vertices_size();
+    first_edge_   = mesh_.edges_size();
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+// Filled-in vertices/edges stay behind the locked ones: only they get
+// deleted, and garbage collection fills their gaps from the back.
+SurfaceMesh::VertexContainer
+HoleFilling::
+filled_in_vertices() const
+{
+    return SurfaceMesh::VertexContainer(
+        SurfaceMesh::VertexIterator(Vertex(first_vertex_), &mesh_),
+        mesh_.vertices_end());
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+SurfaceMesh::EdgeContainer
+HoleFilling::
+filled_in_edges() const
+{
+    return SurfaceMesh::EdgeContainer(
+        SurfaceMesh::EdgeIterator(Edge(first_edge_), &mesh_),
+        mesh_.edges_end());
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+bool
+HoleFilling::
+trace_hole(Halfedge _h, std::vector<Halfedge>& _hole) const
+{
+    _hole.clear();
     Halfedge h = _h;
     do
     {
@@ -138,19 +301,101 @@ triangulate_hole(Halfedge _h)
             return false;
         }
 
-        hole_.push_back(h);
+        _hole.push_back(h);
     }
     while ((h = mesh_.next_halfedge(h)) != _h);
-    const int n = hole_.size();
-    std::cout << n << " hole edges\n";
 
+    return true;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+bool
+HoleFilling::
+triangulate_hole(Triangulation& _t) const
+{
+    const int n = _t.hole.size();
+    std::vector<int> polygon(n);
+    for (int i=0; i<n; ++i)
+        polygon[i] = i;
+
+    _t.triangles.clear();
+    if (fast_triangulation_)
+    {
+        return triangulate_recursive(_t, polygon);
+    }
+    else
+    {
+        _t.polygon = polygon;
+        return triangulate_polygon(_t);
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+bool
+HoleFilling::
+triangulate_recursive(Triangulation& _t, const std::vector<int>& _polygon) const
+{
+    const int n = _polygon.size();
+
+    // find the shortest chord splitting the polygon in halves
+    int    amin = -1;
+    Scalar dmin = FLT_MAX;
+    if (n > (int)max_window())
+    {
+        for (int a=0; a<n/2; ++a)
+        {
+            const Vertex va = hole_vertex(_t, _polygon[a]);
+            const Vertex vb = hole_vertex(_t, _polygon[a+n/2]);
+            const Scalar d  = distance(points_[va], points_[vb]);
+            if (d < dmin && !is_interior_edge(va, vb))
+            {
+                dmin = d;
+                amin = a;
+            }
+        }
+    }
+
+    // small enough, or no valid chord
+    if (amin < 0)
+    {
+        _t.polygon = _polygon;
+        return triangulate_polygon(_t);
+    }
+
+    // both parts contain the chord
+    const int bmin = amin + n/2;
+    std::vector<int> first(_polygon.begin()+amin, _polygon.begin()+bmin+1);
+    std::vector<int> second(_polygon.begin()+bmin, _polygon.end());
+    second.insert(second.end(), _polygon.begin(), _polygon.begin()+amin+1);
+
+    return (triangulate_recursive(_t, first) &&
+            triangulate_recursive(_t, second));
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+bool
+HoleFilling::
+triangulate_polygon(Triangulation& _t) const
+{
+    const int n = _t.polygon.size();
+    auto& weight = _t.weight;
+    auto& index  = _t.index;
 
 
     // compute minimal triangulation by dynamic programming
-    weight_.clear();
-    weight_.resize(n, std::vector<Weight>(n, Weight()));
-    index_.clear();
-    index_.resize(n, std::vector<int>(n, 0));
+    weight.clear();
+    weight.resize(n, std::vector<Weight>(n, Weight()));
+    index.clear();
+    index.resize(n, std::vector<int>(n, 0));
 
     int i, j, m, k, imin;
     Weight w, wmin;
@@ -158,8 +403,8 @@ triangulate_hole(Halfedge _h)
     // initialize 2-gons
     for (i=0; i<n-1; ++i)
     {
-        weight_[i][i+1] = Weight(0,0);
-        index_[i][i+1]  = -1;
+        weight[i][i+1] = Weight(0,0);
+        index[i][i+1]  = -1;
     }
 
     // n-gons with n>2
@@ -175,7 +420,7 @@ triangulate_hole(Halfedge _h)
             // find best split i < m < i+j
             for (m=i+1; m<k; ++m)
             {
-                w = weight_[i][m] + compute_weight(i, m, k) + weight_[m][k];
+                w = weight[i][m] + compute_weight(_t, i, m, k) + weight[m][k];
                 if (w <  wmin)
                 {
                     wmin = w;
@@ -183,13 +428,14 @@ triangulate_hole(Halfedge _h)
                 }
             }
 
-            weight_[i][k] = wmin;
-            index_[i][k]  = imin;
+            weight[i][k] = wmin;
+            index[i][k]  = imin;
         }
     }
 
 
-    // now add triangles to mesh
+    // now collect triangles
+    bool ok = true;
     std::vector<ivec2> todo;
     todo.reserve(n);
     todo.push_back(ivec2(0,n-1));
@@ -200,11 +446,17 @@ triangulate_hole(Halfedge _h)
         int start = tri[0];
         int end   = tri[1];
         if (end-start < 2) continue;
-        int split = index_[start][end];
+        int split = index[start][end];
+        if (split < 0)
+        {
+            std::cerr << "[HoleFilling] No valid triangulation\n";
+            ok = false;
+            break;
+        }
 
-        mesh_.add_triangle(hole_vertex(start),
-                           hole_vertex(split),
-                           hole_vertex(end));
+        _t.triangles.push_back(ivec3(_t.polygon[start],
+                                     _t.polygon[split],
+                                     _t.polygon[end]));
 
         todo.push_back(ivec2(start,split));
         todo.push_back(ivec2(split,end));
@@ -212,11 +464,32 @@ triangulate_hole(Halfedge _h)
 
 
     // clean up
-    weight_.clear();
-    index_.clear();
+    weight.clear();
+    index.clear();
 
 
-    return true;
+    return ok;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+HoleFilling::
+add_triangles(const Triangulation& _t)
+{
+    // a triangulated n-gon has n-2 triangles and n-3 interior edges
+    const size_t nt = _t.triangles.size();
+    mesh_.reserve(mesh_.vertices_size(), mesh_.edges_size() + nt,
+                  mesh_.faces_size() + nt);
+
+    for (const ivec3& tri: _t.triangles)
+    {
+        mesh_.add_triangle(hole_vertex(_t, tri[0]),
+                           hole_vertex(_t, tri[1]),
+                           hole_vertex(_t, tri[2]));
+    }
 }
 
 
@@ -225,11 +498,13 @@ triangulate_hole(Halfedge _h)
 
 HoleFilling::Weight
 HoleFilling::
-compute_weight(int _i, int _j, int _k) const
+compute_weight(const Triangulation& _t, int _i, int _j, int _k) const
 {
-    const Vertex a = hole_vertex(_i);
-    const Vertex b = hole_vertex(_j);
-    const Vertex c = hole_vertex(_k);
+    const std::vector<int>& polygon = _t.polygon;
+    const int n = _t.hole.size();
+    const Vertex a = hole_vertex(_t, polygon[_i]);
+    const Vertex b = hole_vertex(_t, polygon[_j]);
+    const Vertex c = hole_vertex(_t, polygon[_k]);
     Vertex d;
 
 
@@ -249,21 +524,35 @@ compute_weight(int _i, int _j, int _k) const
 
     // compute dihedral angles with...
     Scalar angle(0);
-    const Point n = compute_normal(a, b, c);
-
-    // ...neighbor to (i,j)
-    d  = (_i+1 == _j) ? opposite_vertex(_j) : hole_vertex(index_[_i][_j]);
-    angle = std::max(angle, compute_angle(n, compute_normal(a, d, b)));
+    const Point n0 = compute_normal(a, b, c);
+
+    // ...neighbor to (i,j), none yet if it is a chord of a fast
+    // triangulation
+    if (_i+1 != _j)
+        d = hole_vertex(_t, polygon[_t.index[_i][_j]]);
+    else if ((polygon[_i]+1)%n == polygon[_j])
+        d = opposite_vertex(_t, polygon[_j]);
+    else
+        d = Vertex();
+    if (d.is_valid())
+        angle = std::max(angle, compute_angle(n0, compute_normal(a, d, b)));
 
     // ...neighbor to (j,k)
-    d  = (_j+1 == _k) ? opposite_vertex(_k) : hole_vertex(index_[_j][_k]);
-    angle = std::max(angle, compute_angle(n, compute_normal(b, d, c)));
+    if (_j+1 != _k)
+        d = hole_vertex(_t, polygon[_t.index[_j][_k]]);
+    else if ((polygon[_j]+1)%n == polygon[_k])
+        d = opposite_vertex(_t, polygon[_k]);
+    else
+        d = Vertex();
+    if (d.is_valid())
+        angle = std::max(angle, compute_angle(n0, compute_normal(b, d, c)));
 
     // ...neighbor to (k,i) if (k,i)==(n-1, 0)
-    if (_i==0 && _k+1==(int)hole_.size())
+    if (_i==0 && _k+1==(int)polygon.size() &&
+        (polygon[_k]+1)%n == polygon[0])
     {
-        d = opposite_vertex(0);
-        angle = std::max(angle, compute_angle(n, compute_normal(c, d, a)));
+        d = opposite_vertex(_t, polygon[0]);
+        angle = std::max(angle, compute_angle(n0, compute_normal(c, d, a)));
     }
 
 
@@ -286,7 +575,7 @@ refine()
     l=0.0;
     for (int i=0; i<n; ++i)
     {
-        l += distance( points_[hole_vertex(i)], points_[hole_vertex((i+1)%n)] );
+        l += distance( points_[mesh_.from_vertex(hole_[i])], points_[hole_vertex(i)] );
     }
     l /= (Scalar)n;
     lmin = 0.7 * l;
@@ -318,7 +607,22 @@ split_long_edges(const Scalar _lmax)
     {
         ok = true;
 
-        for (auto e: mesh_.edges())
+        // reserve for all splits of this pass at once
+        size_t n_long = 0;
+        for (auto e: filled_in_edges())
+        {
+            if (!elocked_[e] &&
+                distance(points_[mesh_.vertex(e, 0)],
+                         points_[mesh_.vertex(e, 1)]) > _lmax)
+                ++n_long;
+        }
+        if (n_long == 0)
+            break;
+        mesh_.reserve(mesh_.vertices_size() + n_long,
+                      mesh_.edges_size() + 3 * n_long,
+                      mesh_.faces_size() + 2 * n_long);
+
+        for (auto e: filled_in_edges())
         {
             if (!elocked_[e])
             {
@@ -352,7 +656,7 @@ collapse_short_edges(const Scalar _lmin)
     {
         ok = true;
 
-        for (auto e: mesh_.edges())
+        for (auto e: filled_in_edges())
         {
             if (!mesh_.is_deleted(e) && !elocked_[e])
             {
@@ -379,8 +683,6 @@ collapse_short_edges(const Scalar _lmin)
             }
         }
     }
-
-    mesh_.garbage_collection();
 }
 
 
@@ -404,7 +706,7 @@ flip_edges()
     {
         ok = true;
 
-        for (auto e: mesh_.edges())
+        for (auto e: filled_in_edges())
         {
             if (!elocked_[e])
             {
@@ -467,7 +769,7 @@ relaxation()
     // collect free vertices
     std::vector<Vertex>  vertices;
     vertices.reserve(mesh_.n_vertices());
-    for (auto v: mesh_.vertices())
+    for (auto v: filled_in_vertices())
     {
         if (!vlocked_[v])
         {
@@ -476,12 +778,17 @@ relaxation()
         }
     }
     const int n = vertices.size();
+    if (n == 0)
+    {
+        mesh_.remove_vertex_property(idx);
+        return;
+    }
 
 
     // collect constraints
     std::vector<Vertex>  constraints;
     constraints.reserve(mesh_.n_vertices());
-    for (auto v: mesh_.vertices())
+    for (auto v: filled_in_vertices())
     {
         if (!vlocked_[v])
         {
@@ -525,11 +832,22 @@ relaxation()
     A.setFromTriplets(triplets.begin(), triplets.end());
     SparseMatrix AtA = A.transpose() * A;
     Eigen::MatrixXd AtB = A.transpose() * B;
-    Eigen::SimplicialLDLT<SparseMatrix> solver(AtA);
-    Eigen::MatrixXd X = solver.solve(AtB);
-    if (solver.info() != Eigen::Success)
+
+    // AtA is symmetric, hence its compressed columns are its rows
+    AtA.makeCompressed();
+    CompressedRowMatrix M;
+    M.n_rows = M.n_columns = n;
+    M.offsets.assign(AtA.outerIndexPtr(), AtA.outerIndexPtr() + n + 1);
+    M.columns.assign(AtA.innerIndexPtr(), AtA.innerIndexPtr() + AtA.nonZeros());
+    M.values.assign(AtA.valuePtr(), AtA.valuePtr() + AtA.nonZeros());
+
+    SparseSolver solver;
+    std::vector<double> X;
+    if (!solver.compute(M) ||
+        !solver.solve(std::vector<double>(AtB.data(), AtB.data() + 3 * n), X))
     {
         std::cerr << "[HoleFilling] Solver failed\n";
+        mesh_.remove_vertex_property(idx);
         return;
     }
 
@@ -538,9 +856,9 @@ relaxation()
     for (int i=0; i<n; ++i)
     {
         Vertex v = vertices[i];
-        points_[v][0] = X(i,0);
-        points_[v][1] = X(i,1);
-        points_[v][2] = X(i,2);
+        points_[v][0] = X[i];
+        points_[v][1] = X[n+i];
+        points_[v][2] = X[2*n+i];
     }
 
 
@@ -556,17 +874,70 @@ void
 HoleFilling::
 fairing()
 {
-    // convert non-locked into selection
-    auto vsel = mesh_.add_vertex_property<bool>("v:selected");
-    for (auto v: mesh_.vertices())
-        vsel[v] = !vlocked_[v];
+    // The rows of the free vertices in the squared Laplacian only depend on
+    // the faces around them and around the hole vertices. Fair a copy of
+    // these faces to not visit the whole mesh.
+    std::vector<Face> faces;
+    for (auto v: filled_in_vertices())
+        if (!vlocked_[v])
+            for (auto f: mesh_.faces(v))
+                faces.push_back(f);
+    for (auto h: hole_)
+        for (auto f: mesh_.faces(mesh_.to_vertex(h)))
+            faces.push_back(f);
+    std::sort(faces.begin(), faces.end());
+    faces.erase(std::unique(faces.begin(), faces.end()), faces.end());
+
+    SurfaceMesh patch;
+    std::map<Vertex, Vertex> patch_vertex;
+    std::vector<Vertex> mesh_vertex;
+    bool ok = true;
+    for (auto f: faces)
+    {
+        std::vector<Vertex> vertices;
+        for (auto v: mesh_.vertices(f))
+        {
+            auto it = patch_vertex.find(v);
+            if (it == patch_vertex.end())
+            {
+                it = patch_vertex.insert(std::make_pair(v, patch.add_vertex(points_[v]))).first;
+                mesh_vertex.push_back(v);
+            }
+            vertices.push_back(it->second);
+        }
+        if (!patch.add_face(vertices).is_valid())
+        {
+            ok = false;
+            break;
+        }
+    }
 
-    // fair new vertices
-    SurfaceFairing fairing(mesh_);
-    fairing.minimize_curvature();
+    if (ok)
+    {
+        // fair new vertices of the copy
+        auto vsel = patch.add_vertex_property<bool>("v:selected", false);
+        for (auto v: patch.vertices())
+            vsel[v] = !vlocked_[mesh_vertex[v.idx()]];
 
-    // clean up
-    mesh_.remove_vertex_property(vsel);
+        SurfaceFairing fairing(patch);
+        fairing.minimize_curvature();
+
+        for (auto v: patch.vertices())
+            if (vsel[v])
+                points_[mesh_vertex[v.idx()]] = patch.position(v);
+    }
+    else
+    {
+        // the faces around the hole are not a manifold, fair the mesh
+        auto vsel = mesh_.add_vertex_property<bool>("v:selected", false);
+        for (auto v: filled_in_vertices())
+            vsel[v] = !vlocked_[v];
+
+        SurfaceFairing fairing(mesh_);
+        fairing.minimize_curvature();
+
+        mesh_.remove_vertex_property(vsel);
+    }
 }
 
 
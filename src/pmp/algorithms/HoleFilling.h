@@ -12,6 +12,7 @@
 #include <pmp/SurfaceMesh.h>
 #include <vector>
 #include <float.h>
+#include <limits.h>
 
 //=============================================================================
 
@@ -41,6 +42,37 @@ public:
     /// fill the hole specified by halfedge h
     bool fill_hole(Halfedge h);
 
+    /// the outcome of filling one hole by fill_all_holes()
+    struct HoleReport
+    {
+        Halfedge     halfedge;           ///< a boundary halfedge of the hole
+        unsigned int n_edges;            ///< the number of its edges
+        bool         filled;             ///< false if skipped or failed
+        double       triangulation_time; ///< in ms
+        double       refinement_time;    ///< refinement and fairing in ms
+    };
+
+    /// \brief Fill all holes of at most \p max_size edges.
+    /// \details The boundary loops are found in one pass over the
+    /// halfedges. The triangulations of all holes only read the mesh and are
+    /// computed in parallel, the holes are then added, refined, and faired
+    /// one by one, from the smallest to the largest. The refinement of a hole
+    /// only visits its own filled-in vertices and edges. Note that every
+    /// boundary loop counts as a hole, limit \p max_size to keep the outer
+    /// boundary of an open surface.
+    /// \return the reports of all holes in order of increasing size
+    std::vector<HoleReport> fill_all_holes(unsigned int max_size = UINT_MAX);
+
+    /// \brief Split holes of more than max_window() edges recursively along
+    /// short chords and triangulate each part optimally.
+    /// \details This takes time linear in the number of hole edges instead
+    /// of cubic, and memory quadratic in the window instead of the number of
+    /// hole edges. The result is optimal only within each part. Default is
+    /// false.
+    void set_fast_triangulation(bool fast) { fast_triangulation_ = fast; }
+
+    /// the size of the parts of holes in fast triangulation
+    static unsigned int max_window() { return 48; }
 
 
 private: //------------------------------------------------------ private types
@@ -66,13 +98,53 @@ private: //------------------------------------------------------ private types
 
 
 
+    // a hole and the dynamic program over a polygon of its vertices
+    struct Triangulation
+    {
+        // the boundary halfedges of the hole
+        std::vector<Halfedge> hole;
+
+        // the hole vertices of the polygon to triangulate
+        std::vector<int> polygon;
+
+        // the triangles found so far, as hole vertices
+        std::vector<ivec3> triangles;
+
+        // data for computing optimal triangulation of the polygon
+        std::vector< std::vector<Weight> > weight;
+        std::vector< std::vector<int> >    index;
+    };
+
+
+
 private: //-------------------------------------------------- private functions
 
-    // compute optimal triangulation of hole
-    bool triangulate_hole(Halfedge h);
+    // find the halfedges of the hole of h, false if it is non-manifold
+    bool trace_hole(Halfedge h, std::vector<Halfedge>& hole) const;
 
-    // compute the weight of the triangle (i,j,k).
-    Weight compute_weight(int i, int j, int k) const;
+    // compute the triangulation of a traced hole, optimal or fast
+    bool triangulate_hole(Triangulation& t) const;
+
+    // compute optimal triangulation of t.polygon
+    bool triangulate_polygon(Triangulation& t) const;
+
+    // split polygon along chords until it fits into max_window()
+    bool triangulate_recursive(Triangulation& t,
+                               const std::vector<int>& polygon) const;
+
+    // add the triangles of t to the mesh
+    void add_triangles(const Triangulation& t);
+
+    // compute the weight of the triangle (i,j,k) of t.polygon.
+    Weight compute_weight(const Triangulation& t, int i, int j, int k) const;
+
+    // lock existing vertices/edges, the ones added later are filled-in
+    void lock_all();
+    void lock_filled_in();
+
+    // the filled-in vertices/edges since the last lock
+    SurfaceMesh::VertexContainer filled_in_vertices() const;
+    SurfaceMesh::EdgeContainer   filled_in_edges() const;
 
     // refine triangulation (isotropic remeshing)
     void refine();
@@ -94,11 +166,19 @@ private: //--------------------------------------------------- helper functions
     }
 
 
-    // return vertex opposite edge (i-1,i)
-    Vertex opposite_vertex(unsigned int i) const
+    // return i'th vertex of the hole of t
+    Vertex hole_vertex(const Triangulation& t, unsigned int i) const
     {
-        assert(i<hole_.size());
-        return mesh_.to_vertex(mesh_.next_halfedge(mesh_.opposite_halfedge(hole_[i])));
+        assert(i < t.hole.size());
+        return mesh_.to_vertex(t.hole[i]);
+    }
+
+
+    // return vertex of t opposite edge (i-1,i)
+    Vertex opposite_vertex(const Triangulation& t, unsigned int i) const
+    {
+        assert(i<t.hole.size());
+        return mesh_.to_vertex(mesh_.next_halfedge(mesh_.opposite_halfedge(t.hole[i])));
     }
 
 
@@ -129,11 +209,13 @@ private: //------------------------------------------------------- private data
     VertexProperty<bool>   vlocked_;
     EdgeProperty<bool>     elocked_;
 
+    // the filled-in hole to refine
     std::vector<Halfedge>  hole_;
 
-    // data for computing optimal triangulation
-    std::vector< std::vector<Weight> >   weight_;
-    std::vector< std::vector<int> >      index_;
+    // the first filled-in vertex/edge
+    IndexType first_vertex_, first_edge_;
+
+    bool fast_triangulation_;
 };
 
 
@@ -0,0 +1,213 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/algorithms/LaplaceMatrix.h>
+#include <pmp/algorithms/DifferentialGeometry.h>
+#include <pmp/algorithms/GeometryCache.h>
+#include <pmp/Parallel.h>
+
+#include <algorithm>
+#include <utility>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+namespace {
+
+// turn per-row counts stored at offsets[i+1] into row offsets
+void prefix_sum(std::vector<int>& offsets)
+{
+    offsets[0] = 0;
+    for (size_t i = 1; i < offsets.size(); ++i)
+        offsets[i] += offsets[i - 1];
+}
+
+} // namespace
+
+//=============================================================================
+
+LaplaceMatrix::LaplaceMatrix(const SurfaceMesh& mesh)
+    : mesh_(mesh), adjacency_(mesh), has_pattern_(false)
+{
+}
+
+//-----------------------------------------------------------------------------
+
+void LaplaceMatrix::update_pattern()
+{
+    if (has_pattern_ && adjacency_.is_valid())
+        return;
+
+    adjacency_.update();
+    has_pattern_ = true;
+
+    // one entry per neighbor and one on the diagonal
+    const size_t n = mesh_.vertices_size();
+    matrix_.n_rows = matrix_.n_columns = int(n);
+    matrix_.offsets.assign(n + 1, 0);
+    parallel_for(mesh_.vertices(), [&](Vertex v) {
+        matrix_.offsets[v.idx() + 1] = int(adjacency_.valence(v)) + 1;
+    });
+    prefix_sum(matrix_.offsets);
+
+    const size_t nnz = matrix_.offsets[n];
+    matrix_.columns.resize(nnz);
+    matrix_.values.assign(nnz, 0.0);
+    entry_edges_.resize(nnz);
+
+    // sorted columns of each row
+    parallel_for(mesh_.vertices(), [&](Vertex v) {
+        auto neighbors = adjacency_.vertices(v);
+        auto edges = adjacency_.edges(v);
+
+        std::vector<std::pair<int, int>> row; // column, edge
+        row.reserve(neighbors.size() + 1);
+        row.emplace_back(int(v.idx()), -1);
+        for (size_t j = 0; j < neighbors.size(); ++j)
+            row.emplace_back(int(neighbors[j].idx()), int(edges[j].idx()));
+        std::sort(row.begin(), row.end());
+
+        int k = matrix_.offsets[v.idx()];
+        for (const auto& entry : row)
+        {
+            matrix_.columns[k] = entry.first;
+            entry_edges_[k] = entry.second;
+            ++k;
+        }
+    });
+}
+
+//-----------------------------------------------------------------------------
+
+void LaplaceMatrix::assemble(bool use_uniform_weights)
+{
+    std::vector<double> weights(mesh_.edges_size(), 1.0);
+    if (!use_uniform_weights)
+    {
+        const GeometryCache* cache = GeometryCache::get(mesh_);
+        parallel_for(mesh_.edges(), [&](Edge e) {
+            weights[e.idx()] = std::max(0.0, cache ? cache->cotan_weight(e)
+                                                   : cotan_weight(mesh_, e));
+        });
+    }
+    assemble(weights);
+}
+
+//-----------------------------------------------------------------------------
+
+void LaplaceMatrix::assemble(const std::vector<double>& edge_weights)
+{
+    update_pattern();
+
+    // refill the values, the diagonal balances the row
+    parallel_for(0, size_t(matrix_.n_rows), [&](size_t i) {
+        const int begin = matrix_.offsets[i], end = matrix_.offsets[i + 1];
+        double sum = 0.0;
+        int diagonal = begin;
+        for (int k = begin; k < end; ++k)
+        {
+            if (entry_edges_[k] < 0)
+            {
+                diagonal = k;
+                continue;
+            }
+            const double w = edge_weights[entry_edges_[k]];
+            matrix_.values[k] = -w;
+            sum += w;
+        }
+        if (begin < end)
+            matrix_.values[diagonal] = sum;
+    });
+}
+
+//-----------------------------------------------------------------------------
+
+void LaplaceMatrix::assemble_mass()
+{
+    const GeometryCache* cache = GeometryCache::get(mesh_);
+    mass_.assign(mesh_.vertices_size(), 0.0);
+    parallel_for(mesh_.vertices(), [&](Vertex v) {
+        mass_[v.idx()] =
+            cache ? cache->voronoi_area(v) : voronoi_area(mesh_, v);
+    });
+}
+
+//=============================================================================
+
+void extract(const CompressedRowMatrix& matrix, const std::vector<int>& rows,
+             const std::vector<int>& columns, CompressedRowMatrix& free,
+             CompressedRowMatrix& fixed)
+{
+    // the row of matrix for each row of the system
+    int n_rows = 0, n_columns = 0;
+    for (int i = 0; i < matrix.n_rows; ++i)
+        n_rows = std::max(n_rows, rows[i] + 1);
+    for (int j = 0; j < matrix.n_columns; ++j)
+        n_columns = std::max(n_columns, columns[j] + 1);
+    std::vector<int> source(n_rows, -1);
+    for (int i = 0; i < matrix.n_rows; ++i)
+        if (rows[i] >= 0)
+            source[rows[i]] = i;
+
+    free.n_rows = fixed.n_rows = n_rows;
+    free.n_columns = n_columns;
+    fixed.n_columns = matrix.n_columns;
+
+    // count the entries per row
+    free.offsets.assign(n_rows + 1, 0);
+    fixed.offsets.assign(n_rows + 1, 0);
+    parallel_for(0, size_t(n_rows), [&](size_t r) {
+        const int i = source[r];
+        if (i < 0)
+            return;
+        for (int k = matrix.offsets[i]; k < matrix.offsets[i + 1]; ++k)
+        {
+            if (columns[matrix.columns[k]] >= 0)
+                ++free.offsets[r + 1];
+            else
+                ++fixed.offsets[r + 1];
+        }
+    });
+    prefix_sum(free.offsets);
+    prefix_sum(fixed.offsets);
+
+    free.columns.resize(free.offsets[n_rows]);
+    free.values.resize(free.offsets[n_rows]);
+    fixed.columns.resize(fixed.offsets[n_rows]);
+    fixed.values.resize(fixed.offsets[n_rows]);
+
+    // copy the entries
+    parallel_for(0, size_t(n_rows), [&](size_t r) {
+        const int i = source[r];
+        if (i < 0)
+            return;
+        int a = free.offsets[r], b = fixed.offsets[r];
+        for (int k = matrix.offsets[i]; k < matrix.offsets[i + 1]; ++k)
+        {
+            const int c = matrix.columns[k];
+            if (columns[c] >= 0)
+            {
+                free.columns[a] = columns[c];
+                free.values[a++] = matrix.values[k];
+            }
+            else
+            {
+                fixed.columns[b] = c;
+                fixed.values[b++] = matrix.values[k];
+            }
+        }
+    });
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -0,0 +1,94 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <pmp/SurfaceMesh.h>
+#include <pmp/algorithms/SparseSolver.h>
+#include <pmp/algorithms/SurfaceAdjacency.h>
+
+#include <vector>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \addtogroup algorithms algorithms
+//!@{
+
+//! \brief Assembles the Laplace and mass matrices of a mesh.
+//! \details The matrix has one row and column per vertex index, rows of
+//! deleted vertices are empty. It is symmetric positive semi-definite: the
+//! entry of an edge is its negated weight and each diagonal entry is the
+//! sum of the weights of the incident edges. The matrix is assembled
+//! directly in compressed row storage and in parallel. Its sparsity pattern
+//! is kept as long as SurfaceMesh::topology_version() is unchanged, such
+//! that repeated assemblies only refill the values. Usage:
+//! \code
+//! LaplaceMatrix laplace(mesh);
+//! laplace.assemble();
+//! CompressedRowMatrix free, fixed;
+//! extract(laplace.matrix(), index, index, free, fixed);
+//! \endcode
+class LaplaceMatrix
+{
+public:
+    //! construct for \p mesh, which has to outlive the object
+    LaplaceMatrix(const SurfaceMesh& mesh);
+
+    //! \brief Assemble the cotan or the uniform Laplace matrix.
+    //! \details Negative cotan weights are clamped to zero. Uses the
+    //! GeometryCache of the mesh, if there is a valid one.
+    void assemble(bool use_uniform_weights = false);
+
+    //! assemble the Laplace matrix with the weights \p edge_weights[e.idx()]
+    void assemble(const std::vector<double>& edge_weights);
+
+    //! the Laplace matrix computed by assemble()
+    const CompressedRowMatrix& matrix() const { return matrix_; }
+
+    //! \brief Compute the lumped mass matrix, i.e., the mixed Voronoi area
+    //! of each vertex.
+    void assemble_mass();
+
+    //! the diagonal of the mass matrix computed by assemble_mass()
+    const std::vector<double>& mass() const { return mass_; }
+
+private:
+    // build the sparsity pattern, if the connectivity changed
+    void update_pattern();
+
+    const SurfaceMesh& mesh_;
+    SurfaceAdjacency adjacency_;
+    bool has_pattern_;
+
+    CompressedRowMatrix matrix_;
+    std::vector<int> entry_edges_; // the edge of each entry, -1 on diagonal
+
+    std::vector<double> mass_;
+};
+
+//! \brief Extract a linear system from \p matrix.
+//! \details \p rows[i] is the row of row i in the system, or -1 to skip it.
+//! \p columns[j] is the column of a free column j, or -1 for a fixed one.
+//! Both have one entry per row resp. column of \p matrix and increase with
+//! the index. The entries in free columns are stored in \p free, the ones
+//! in fixed columns in \p fixed, which keeps the columns of \p matrix, such
+//! that its product with the fixed values goes to the right-hand side.
+void extract(const CompressedRowMatrix& matrix, const std::vector<int>& rows,
+             const std::vector<int>& columns, CompressedRowMatrix& free,
+             CompressedRowMatrix& fixed);
+
+//!@}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -0,0 +1,275 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/algorithms/PointKdTree.h>
+#include <pmp/Parallel.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+PointKdTree::PointKdTree(const SurfaceMesh& mesh, unsigned int leaf_size)
+    : leaf_size_(std::max(leaf_size, 1u))
+{
+    auto points = mesh.get_vertex_property<Point>("v:point");
+    std::vector<Item> items;
+    items.reserve(mesh.n_vertices());
+    for (auto v : mesh.vertices())
+    {
+        items.push_back(Item{points[v], v.idx()});
+    }
+    if (items.empty())
+        return;
+
+    // build the top of the tree and collect large subtrees
+    task_size_ =
+        std::max(items.size() / (16 * num_threads()), size_t(1 << 16));
+    std::vector<Task> tasks;
+    nodes_.push_back(Node());
+    build_recurse(items, nodes_, 0, 0, IndexType(items.size()), &tasks);
+
+    // build the subtrees in parallel, each into its own nodes
+    std::vector<std::vector<Node>> subtrees(tasks.size());
+    parallel_for_chunks(
+        tasks.size(),
+        [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+            {
+                subtrees[i].push_back(Node());
+                build_recurse(items, subtrees[i], 0, tasks[i].begin,
+                              tasks[i].end, nullptr);
+            }
+        },
+        1);
+
+    // append the subtrees, their inner nodes refer to local indices
+    for (size_t i = 0; i < tasks.size(); ++i)
+    {
+        const IndexType offset = IndexType(nodes_.size()) - 1;
+        for (auto& node : subtrees[i])
+        {
+            if (node.n_points == 0)
+                node.index += offset;
+        }
+        nodes_[tasks[i].node] = subtrees[i][0];
+        nodes_.insert(nodes_.end(), subtrees[i].begin() + 1,
+                      subtrees[i].end());
+        std::vector<Node>().swap(subtrees[i]);
+    }
+
+    // the points in the order of the leaves
+    points_.resize(items.size());
+    indices_.resize(items.size());
+    parallel_for(size_t(0), items.size(), [&](size_t i) {
+        points_[i] = items[i].point;
+        indices_[i] = items[i].vertex;
+    });
+}
+
+//-----------------------------------------------------------------------------
+
+void PointKdTree::build_recurse(std::vector<Item>& items,
+                                std::vector<Node>& nodes, IndexType node,
+                                IndexType begin, IndexType end,
+                                std::vector<Task>* tasks) const
+{
+    const IndexType n = end - begin;
+
+    // defer large subtrees
+    if (tasks && n <= task_size_)
+    {
+        tasks->push_back(Task{node, begin, end});
+        return;
+    }
+
+    // split the widest extent of the bounding box
+    Point bmin = items[begin].point, bmax = bmin;
+    for (IndexType i = begin; i < end; ++i)
+    {
+        bmin = min(bmin, items[i].point);
+        bmax = max(bmax, items[i].point);
+    }
+    const Point extent = bmax - bmin;
+    int axis = 0;
+    if (extent[1] > extent[axis])
+        axis = 1;
+    if (extent[2] > extent[axis])
+        axis = 2;
+
+    if (n <= leaf_size_ || !(extent[axis] > 0))
+    {
+        nodes[node].index = begin;
+        nodes[node].n_points = n;
+        return;
+    }
+
+    // points left of the median are not above it, points right not below
+    const IndexType mid = begin + n / 2;
+    std::nth_element(items.begin() + begin, items.begin() + mid,
+                     items.begin() + end,
+                     [axis](const Item& a, const Item& b) {
+                         return a.point[axis] < b.point[axis];
+                     });
+
+    // children are stored consecutively
+    const IndexType child = IndexType(nodes.size());
+    nodes[node].split = items[mid].point[axis];
+    nodes[node].axis = (unsigned char)axis;
+    nodes[node].index = child;
+    nodes[node].n_points = 0;
+    nodes.push_back(Node());
+    nodes.push_back(Node());
+
+    build_recurse(items, nodes, child, begin, mid, tasks);
+    build_recurse(items, nodes, child + 1, mid, end, tasks);
+}
+
+//-----------------------------------------------------------------------------
+
+template <class LeafFunction>
+void PointKdTree::traverse(const Point& p, LeafFunction leaf) const
+{
+    if (nodes_.empty())
+        return;
+
+    // nodes still to visit and the squared distance to their splitting plane
+    std::pair<IndexType, Scalar> stack[64];
+    int top = 0;
+    stack[top++] = std::make_pair(IndexType(0), Scalar(0));
+    Scalar bound = FLT_MAX;
+
+    while (top > 0)
+    {
+        const auto entry = stack[--top];
+        if (entry.second > bound)
+            continue;
+
+        // descend to the leaf containing p, remember the far children
+        const Node* node = &nodes_[entry.first];
+        while (node->n_points == 0)
+        {
+            const Scalar d = p[node->axis] - node->split;
+            const IndexType first = node->index + (d <= 0 ? 0 : 1);
+            const IndexType second = node->index + (d <= 0 ? 1 : 0);
+            stack[top++] = std::make_pair(second, d * d);
+            node = &nodes_[first];
+        }
+
+        bound = leaf(*node);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+PointKdTree::Neighbor PointKdTree::nearest(const Point& p) const
+{
+    Neighbor result;
+    result.dist = FLT_MAX;
+    Scalar best = FLT_MAX;
+    IndexType best_index = PMP_MAX_INDEX;
+
+    traverse(p, [&](const Node& node) {
+        for (IndexType i = node.index; i < node.index + node.n_points; ++i)
+        {
+            const Scalar d = sqrnorm(points_[i] - p);
+            if (d < best)
+            {
+                best = d;
+                best_index = i;
+            }
+        }
+        return best;
+    });
+
+    if (best_index != PMP_MAX_INDEX)
+    {
+        result.vertex = Vertex(indices_[best_index]);
+        result.dist = std::sqrt(best);
+    }
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+
+std::vector<PointKdTree::Neighbor> PointKdTree::k_nearest(const Point& p,
+                                                          unsigned int k) const
+{
+    // max-heap of the squared distances and points found so far
+    std::vector<std::pair<Scalar, IndexType>> heap;
+    heap.reserve(k);
+
+    if (k > 0)
+    {
+        traverse(p, [&](const Node& node) {
+            for (IndexType i = node.index; i < node.index + node.n_points; ++i)
+            {
+                const Scalar d = sqrnorm(points_[i] - p);
+                if (heap.size() < k)
+                {
+                    heap.push_back(std::make_pair(d, i));
+                    std::push_heap(heap.begin(), heap.end());
+                }
+                else if (d < heap.front().first)
+                {
+                    std::pop_heap(heap.begin(), heap.end());
+                    heap.back() = std::make_pair(d, i);
+                    std::push_heap(heap.begin(), heap.end());
+                }
+            }
+            return heap.size() < k ? Scalar(FLT_MAX) : heap.front().first;
+        });
+    }
+
+    std::sort_heap(heap.begin(), heap.end());
+    std::vector<Neighbor> result(heap.size());
+    for (size_t i = 0; i < heap.size(); ++i)
+    {
+        result[i].vertex = Vertex(indices_[heap[i].second]);
+        result[i].dist = std::sqrt(heap[i].first);
+    }
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+
+std::vector<PointKdTree::Neighbor>
+PointKdTree::within_radius(const Point& p, Scalar radius) const
+{
+    std::vector<Neighbor> result;
+    const Scalar sqr_radius = radius * radius;
+    if (radius < 0)
+        return result;
+
+    traverse(p, [&](const Node& node) {
+        for (IndexType i = node.index; i < node.index + node.n_points; ++i)
+        {
+            const Scalar d = sqrnorm(points_[i] - p);
+            if (d <= sqr_radius)
+            {
+                Neighbor neighbor;
+                neighbor.vertex = Vertex(indices_[i]);
+                neighbor.dist = std::sqrt(d);
+                result.push_back(neighbor);
+            }
+        }
+        return sqr_radius;
+    });
+
+    return result;
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
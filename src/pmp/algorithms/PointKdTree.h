@@ -0,0 +1,105 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <pmp/SurfaceMesh.h>
+
+#include <vector>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \addtogroup algorithms algorithms
+//!@{
+
+//! \brief A k-d tree for the vertices of a mesh or point cloud.
+//! \details The tree copies the vertex positions in the order of its leaves,
+//! such that queries scan contiguous memory. It is built by median splits of
+//! the widest extent, partitioning in-place, with independent subtrees built
+//! in parallel. All queries only read the tree and are thread-safe.
+class PointKdTree
+{
+public:
+    //! construct with the (non-deleted) vertices of \p mesh
+    PointKdTree(const SurfaceMesh& mesh, unsigned int leaf_size = 16);
+
+    //! a vertex and its distance to the query point
+    struct Neighbor
+    {
+        Vertex vertex;
+        Scalar dist;
+    };
+
+    //! the vertex nearest to \p p, invalid for an empty tree
+    Neighbor nearest(const Point& p) const;
+
+    //! the \p k vertices nearest to \p p, sorted by distance
+    std::vector<Neighbor> k_nearest(const Point& p, unsigned int k) const;
+
+    //! \brief All vertices within distance \p radius of \p p.
+    //! \details The vertices are returned in no particular order.
+    std::vector<Neighbor> within_radius(const Point& p, Scalar radius) const;
+
+    //! the number of vertices in the tree
+    size_t size() const { return points_.size(); }
+
+private:
+    // inner nodes refer to their two consecutive children, leaves to a range
+    // of points
+    struct Node
+    {
+        Scalar split;       // splitting plane of inner nodes
+        IndexType index;    // first child of inner nodes, first leaf point
+        IndexType n_points; // number of points of leaves, 0 for inner nodes
+        unsigned char axis; // splitting axis of inner nodes
+    };
+
+    // a point and its vertex while building
+    struct Item
+    {
+        Point point;
+        IndexType vertex;
+    };
+
+    // a subtree to be built in parallel
+    struct Task
+    {
+        IndexType node;
+        IndexType begin, end;
+    };
+
+    // Recursive part of build(): sets up \p node for the points [begin,end),
+    // appending its descendants to \p nodes. Large subtrees are deferred to
+    // \p tasks if not null.
+    void build_recurse(std::vector<Item>& items, std::vector<Node>& nodes,
+                       IndexType node, IndexType begin, IndexType end,
+                       std::vector<Task>* tasks) const;
+
+    // visit the leaves that may contain points closer than the squared
+    // distance returned by \p leaf(node)
+    template <class LeafFunction>
+    void traverse(const Point& p, LeafFunction leaf) const;
+
+private:
+    std::vector<Node> nodes_;
+    std::vector<Point> points_;      // in the order of the leaves
+    std::vector<IndexType> indices_; // vertex of each point
+    unsigned int leaf_size_;
+    size_t task_size_;
+};
+
+//=============================================================================
+//!@}
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -0,0 +1,60 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/algorithms/PointLocation.h>
+#include <pmp/algorithms/BarycentricCoordinates.h>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+PointLocator::PointLocator(const SurfaceMesh& mesh) : mesh_(mesh), tree_(mesh)
+{
+}
+
+//-----------------------------------------------------------------------------
+
+void PointLocator::locate(const std::vector<Point>& points,
+                          PointLocations& locations) const
+{
+    assert(mesh_.n_faces() > 0);
+
+    const std::vector<TriangleKdTree::NearestNeighbor> nearest =
+        tree_.nearest(points);
+
+    const size_t n = points.size();
+    locations.faces.resize(n);
+    locations.vertices.resize(3 * n);
+    locations.weights.resize(3 * n);
+    locations.distances.resize(n);
+
+    parallel_for(size_t(0), n, [&](size_t i) {
+        const Face f = nearest[i].face;
+        locations.faces[i] = f;
+        locations.distances[i] = nearest[i].dist;
+
+        // the corners of the triangle of f in the tree
+        Vertex* v = &locations.vertices[3 * i];
+        auto vfit = mesh_.vertices(f);
+        for (int j = 0; j < 3; ++j, ++vfit)
+            v[j] = *vfit;
+
+        const Point b = barycentric_coordinates(
+            nearest[i].nearest, mesh_.position(v[0]), mesh_.position(v[1]),
+            mesh_.position(v[2]));
+        for (int j = 0; j < 3; ++j)
+            locations.weights[3 * i + j] = b[j];
+    });
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -0,0 +1,97 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <pmp/SurfaceMesh.h>
+#include <pmp/Parallel.h>
+#include <pmp/algorithms/TriangleKdTree.h>
+
+#include <vector>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \addtogroup algorithms algorithms
+//! @{
+
+//=============================================================================
+
+//! \brief The locations of points on a triangle mesh, stored as arrays.
+//! \details Location \c i is the point of the mesh nearest to query point
+//! \c i, given by its face, the three vertices of the face, and their
+//! barycentric coordinates.
+struct PointLocations
+{
+    //! the number of locations
+    size_t size() const { return faces.size(); }
+
+    std::vector<Face> faces;       //!< the face of each location
+    std::vector<Vertex> vertices;  //!< three vertices per location
+    std::vector<Scalar> weights;   //!< their barycentric coordinates
+    std::vector<Scalar> distances; //!< the distances to the query points
+};
+
+//! \brief Locate points on a triangle mesh and interpolate vertex properties
+//! there.
+//! \details The points are projected to the mesh by batched TriangleKdTree
+//! queries, and their barycentric coordinates are computed in parallel. The
+//! locations can be reused to interpolate any number of vertex properties,
+//! e.g., to transfer attributes to a remeshed surface:
+//! \code
+//! PointLocator locator(original);
+//! PointLocations locations;
+//! locator.locate(remeshed_points, locations);
+//! std::vector<TexCoord> texcoords;
+//! locator.interpolate(original.get_vertex_property<TexCoord>("v:tex"),
+//!                     locations, texcoords);
+//! \endcode
+class PointLocator
+{
+public:
+    //! build the search tree of the triangle mesh \p mesh
+    PointLocator(const SurfaceMesh& mesh);
+
+    //! \brief Locate the nearest point of the mesh to each of \p points.
+    //! \details Replaces \p locations. The mesh must have faces.
+    void locate(const std::vector<Point>& points,
+                PointLocations& locations) const;
+
+    //! \brief Interpolate the vertex property \p property at the
+    //! \p locations, in parallel.
+    //! \details Replaces \p values by one value per location. \c T has to
+    //! support multiplication by Scalar and addition, e.g., Scalar, Point,
+    //! Color, or TexCoord.
+    template <class T>
+    void interpolate(const VertexProperty<T>& property,
+                     const PointLocations& locations,
+                     std::vector<T>& values) const
+    {
+        values.resize(locations.size());
+        parallel_for(size_t(0), locations.size(), [&](size_t i) {
+            const Vertex* v = &locations.vertices[3 * i];
+            const Scalar* w = &locations.weights[3 * i];
+            values[i] = property[v[0]] * w[0] + property[v[1]] * w[1] +
+                        property[v[2]] * w[2];
+        });
+    }
+
+private:
+    const SurfaceMesh& mesh_;
+    TriangleKdTree tree_;
+};
+
+//=============================================================================
+//! @}
+//=============================================================================
+} // namespace pmp
+//=============================================================================
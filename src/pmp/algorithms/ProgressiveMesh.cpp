@@ -0,0 +1,428 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/algorithms/ProgressiveMesh.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+namespace {
+
+// the header of a progressive mesh file
+struct ProgressiveMeshHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint64_t n_base_vertices;
+    uint64_t n_base_faces;
+    uint64_t n_splits;
+};
+
+const char progressive_mesh_magic[4] = {'P', 'M', 'P', 'P'};
+
+template <class T>
+bool write_value(FILE* out, const T& value)
+{
+    return fwrite(&value, sizeof(T), 1, out) == 1;
+}
+
+template <class T>
+bool read_value(FILE* in, T& value)
+{
+    return fread(&value, sizeof(T), 1, in) == 1;
+}
+
+bool write_point(FILE* out, const Point& p)
+{
+    const float xyz[3] = {float(p[0]), float(p[1]), float(p[2])};
+    return fwrite(xyz, sizeof(float), 3, out) == 3;
+}
+
+bool read_point(FILE* in, Point& p)
+{
+    float xyz[3];
+    if (fread(xyz, sizeof(float), 3, in) != 3)
+        return false;
+    p = Point(xyz[0], xyz[1], xyz[2]);
+    return true;
+}
+
+} // namespace
+
+//=============================================================================
+
+ProgressiveMesh::ProgressiveMesh()
+{
+    clear();
+}
+
+//-----------------------------------------------------------------------------
+
+void ProgressiveMesh::clear()
+{
+    n_base_vertices_ = 0;
+    n_base_faces_ = 0;
+    level_ = 0;
+    positions_.clear();
+    indices_.clear();
+    splits_.clear();
+    split_corners_.clear();
+    collapses_.clear();
+    vertex_used_.clear();
+    face_used_.clear();
+}
+
+//-----------------------------------------------------------------------------
+
+size_t ProgressiveMesh::n_faces() const
+{
+    return level_ ? splits_[level_ - 1].n_faces : n_base_faces_;
+}
+
+//-----------------------------------------------------------------------------
+
+void ProgressiveMesh::set_n_vertices(size_t n)
+{
+    n = std::max(n, min_vertices());
+    n = std::min(n, max_vertices());
+    const size_t level = n - n_base_vertices_;
+
+    while (level_ < level)
+        split(level_++);
+    while (level_ > level)
+        unsplit(--level_);
+}
+
+//-----------------------------------------------------------------------------
+
+void ProgressiveMesh::split(size_t i)
+{
+    const VertexSplit& s = splits_[i];
+    const IndexType v0 = IndexType(n_base_vertices_ + i);
+    for (IndexType c = s.corners_begin; c < s.corners_end; ++c)
+        indices_[split_corners_[c]] = v0;
+}
+
+//-----------------------------------------------------------------------------
+
+void ProgressiveMesh::unsplit(size_t i)
+{
+    const VertexSplit& s = splits_[i];
+    for (IndexType c = s.corners_begin; c < s.corners_end; ++c)
+        indices_[split_corners_[c]] = s.v1;
+}
+
+//-----------------------------------------------------------------------------
+
+void ProgressiveMesh::extract(SurfaceMesh& mesh) const
+{
+    std::vector<Point> positions(positions_.begin(),
+                                 positions_.begin() + n_vertices());
+    std::vector<IndexType> indices(indices_.begin(),
+                                   indices_.begin() + 3 * n_faces());
+    mesh.build_from_indices(positions, indices);
+}
+
+//-----------------------------------------------------------------------------
+
+void ProgressiveMesh::begin(const SurfaceMesh& mesh)
+{
+    clear();
+
+    const size_t nv = mesh.vertices_size();
+    const size_t nf = mesh.faces_size();
+
+    positions_.resize(nv);
+    vertex_used_.resize(nv, false);
+    for (auto v : mesh.vertices())
+    {
+        positions_[v.idx()] = mesh.position(v);
+        vertex_used_[v.idx()] = true;
+    }
+
+    indices_.resize(3 * nf, PMP_MAX_INDEX);
+    face_used_.resize(nf, false);
+    for (auto f : mesh.faces())
+    {
+        IndexType* corner = &indices_[3 * f.idx()];
+        for (auto v : mesh.vertices(f))
+            *corner++ = v.idx();
+        face_used_[f.idx()] = true;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void ProgressiveMesh::add_collapse(Vertex v0, Vertex v1, Face fl, Face fr)
+{
+    Collapse c = {v0.idx(), v1.idx(), fl.idx(), fr.idx()};
+    collapses_.push_back(c);
+}
+
+//-----------------------------------------------------------------------------
+
+void ProgressiveMesh::end()
+{
+    const size_t nv = vertex_used_.size();
+    const size_t nf = face_used_.size();
+    const size_t n_collapses = collapses_.size();
+
+    // replay the collapses on the corners, see which corners of the
+    // remaining faces move from v0 to v1
+    std::vector<std::vector<IndexType>> vertex_corners(nv);
+    for (size_t k = 0; k < indices_.size(); ++k)
+        if (face_used_[k / 3])
+            vertex_corners[indices_[k]].push_back(IndexType(k));
+
+    std::vector<bool> face_alive(face_used_);
+    std::vector<bool> vertex_alive(vertex_used_);
+    std::vector<std::vector<IndexType>> moved(n_collapses);
+    for (size_t i = 0; i < n_collapses; ++i)
+    {
+        const Collapse& c = collapses_[i];
+        if (c.fl != PMP_MAX_INDEX)
+            face_alive[c.fl] = false;
+        if (c.fr != PMP_MAX_INDEX)
+            face_alive[c.fr] = false;
+        vertex_alive[c.v0] = false;
+
+        for (auto k : vertex_corners[c.v0])
+        {
+            if (face_alive[k / 3])
+            {
+                moved[i].push_back(k);
+                indices_[k] = c.v1;
+                vertex_corners[c.v1].push_back(k);
+            }
+        }
+        std::vector<IndexType>().swap(vertex_corners[c.v0]);
+    }
+    std::vector<std::vector<IndexType>>().swap(vertex_corners);
+
+    // the base mesh comes first, followed by the vertices and faces added
+    // by the vertex splits, which undo the collapses in reverse order
+    std::vector<IndexType> vertex_index(nv, PMP_MAX_INDEX);
+    std::vector<Point> positions;
+    for (size_t v = 0; v < nv; ++v)
+    {
+        if (vertex_alive[v])
+        {
+            vertex_index[v] = IndexType(positions.size());
+            positions.push_back(positions_[v]);
+        }
+    }
+    n_base_vertices_ = positions.size();
+
+    std::vector<IndexType> face_index(nf, PMP_MAX_INDEX);
+    IndexType n_faces = 0;
+    for (size_t f = 0; f < nf; ++f)
+        if (face_alive[f])
+            face_index[f] = n_faces++;
+    n_base_faces_ = n_faces;
+
+    splits_.resize(n_collapses);
+    for (size_t j = 0; j < n_collapses; ++j)
+    {
+        const Collapse& c = collapses_[n_collapses - 1 - j];
+        vertex_index[c.v0] = IndexType(positions.size());
+        positions.push_back(positions_[c.v0]);
+        if (c.fl != PMP_MAX_INDEX)
+            face_index[c.fl] = n_faces++;
+        if (c.fr != PMP_MAX_INDEX)
+            face_index[c.fr] = n_faces++;
+        splits_[j].n_faces = n_faces;
+    }
+
+    std::vector<IndexType> indices(3 * size_t(n_faces));
+    for (size_t k = 0; k < indices_.size(); ++k)
+        if (face_index[k / 3] != PMP_MAX_INDEX)
+            indices[3 * face_index[k / 3] + k % 3] = vertex_index[indices_[k]];
+
+    auto corner_index = [&](IndexType k) {
+        return 3 * face_index[k / 3] + k % 3;
+    };
+    for (size_t j = 0; j < n_collapses; ++j)
+    {
+        const size_t i = n_collapses - 1 - j;
+        splits_[j].v1 = vertex_index[collapses_[i].v1];
+        splits_[j].corners_begin = IndexType(split_corners_.size());
+        for (auto k : moved[i])
+            split_corners_.push_back(corner_index(k));
+        splits_[j].corners_end = IndexType(split_corners_.size());
+    }
+
+    positions_.swap(positions);
+    indices_.swap(indices);
+    level_ = 0;
+
+    // free memory of the recording
+    std::vector<Collapse>().swap(collapses_);
+    std::vector<bool>().swap(vertex_used_);
+    std::vector<bool>().swap(face_used_);
+}
+
+//-----------------------------------------------------------------------------
+
+bool ProgressiveMesh::write(const std::string& filename) const
+{
+    FILE* out = fopen(filename.c_str(), "wb");
+    if (!out)
+    {
+        std::cerr << "ProgressiveMesh::write: cannot open " << filename
+                  << std::endl;
+        return false;
+    }
+
+    ProgressiveMeshHeader header;
+    memcpy(header.magic, progressive_mesh_magic, 4);
+    header.version = 1;
+    header.n_base_vertices = n_base_vertices_;
+    header.n_base_faces = n_base_faces_;
+    header.n_splits = splits_.size();
+    bool ok = write_value(out, header);
+
+    // the base mesh in its coarsest state
+    std::vector<IndexType> indices(indices_);
+    for (size_t i = level_; i > 0; --i)
+    {
+        const VertexSplit& s = splits_[i - 1];
+        for (IndexType c = s.corners_begin; c < s.corners_end; ++c)
+            indices[split_corners_[c]] = s.v1;
+    }
+
+    for (size_t v = 0; ok && v < n_base_vertices_; ++v)
+        ok = write_point(out, positions_[v]);
+    for (size_t k = 0; ok && k < 3 * n_base_faces_; ++k)
+        ok = write_value(out, uint32_t(indices[k]));
+
+    // each split with the new vertex, its new faces, and its moved corners
+    size_t n_faces = n_base_faces_;
+    for (size_t i = 0; ok && i < splits_.size(); ++i)
+    {
+        const VertexSplit& s = splits_[i];
+        ok = write_point(out, positions_[n_base_vertices_ + i]) &&
+             write_value(out, uint32_t(s.v1)) &&
+             write_value(out, uint32_t(s.n_faces - n_faces));
+        for (size_t k = 3 * n_faces; ok && k < 3 * s.n_faces; ++k)
+            ok = write_value(out, uint32_t(indices[k]));
+        n_faces = s.n_faces;
+
+        ok = ok && write_value(out, uint32_t(s.corners_end - s.corners_begin));
+        for (IndexType c = s.corners_begin; ok && c < s.corners_end; ++c)
+            ok = write_value(out, uint32_t(split_corners_[c]));
+    }
+
+    fclose(out);
+    return ok;
+}
+
+//-----------------------------------------------------------------------------
+
+bool ProgressiveMesh::read(const std::string& filename)
+{
+    clear();
+
+    FILE* in = fopen(filename.c_str(), "rb");
+    if (!in)
+    {
+        std::cerr << "ProgressiveMesh::read: cannot open " << filename
+                  << std::endl;
+        return false;
+    }
+
+    ProgressiveMeshHeader header;
+    if (!read_value(in, header) ||
+        memcmp(header.magic, progressive_mesh_magic, 4) || header.version != 1)
+    {
+        std::cerr << "ProgressiveMesh::read: " << filename
+                  << " is not a progressive mesh" << std::endl;
+        fclose(in);
+        return false;
+    }
+
+    // the base mesh is required
+    bool ok = true;
+    positions_.resize(header.n_base_vertices);
+    indices_.resize(3 * header.n_base_faces);
+    for (auto& p : positions_)
+        ok = ok && read_point(in, p);
+    uint32_t index;
+    for (auto& k : indices_)
+    {
+        ok = ok && read_value(in, index) && index < positions_.size();
+        k = index;
+    }
+    if (!ok)
+    {
+        std::cerr << "ProgressiveMesh::read: " << filename
+                  << " has an incomplete base mesh" << std::endl;
+        clear();
+        fclose(in);
+        return false;
+    }
+    n_base_vertices_ = positions_.size();
+    n_base_faces_ = header.n_base_faces;
+
+    // read splits until the end of the file
+    for (uint64_t i = 0; i < header.n_splits; ++i)
+    {
+        const size_t n_indices = indices_.size();
+        const size_t n_corners = split_corners_.size();
+        const size_t n_vertices = positions_.size() + 1;
+
+        Point p;
+        uint32_t v1, n_new_faces, n_moved;
+        bool complete = read_point(in, p) && read_value(in, v1) &&
+                        v1 < n_vertices && read_value(in, n_new_faces) &&
+                        n_new_faces <= 2;
+        for (uint32_t k = 0; complete && k < 3 * n_new_faces; ++k)
+        {
+            complete = read_value(in, index) && index < n_vertices;
+            indices_.push_back(index);
+        }
+        complete = complete && read_value(in, n_moved);
+        for (uint32_t k = 0; complete && k < n_moved; ++k)
+        {
+            complete = read_value(in, index) && index < n_indices;
+            split_corners_.push_back(index);
+        }
+
+        // a truncated file ends with the last complete split
+        if (!complete)
+        {
+            indices_.resize(n_indices);
+            split_corners_.resize(n_corners);
+            break;
+        }
+
+        VertexSplit s;
+        s.v1 = v1;
+        s.n_faces = IndexType(indices_.size() / 3);
+        s.corners_begin = IndexType(n_corners);
+        s.corners_end = IndexType(split_corners_.size());
+        splits_.push_back(s);
+        positions_.push_back(p);
+    }
+
+    fclose(in);
+    return true;
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -0,0 +1,134 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <pmp/SurfaceMesh.h>
+
+#include <string>
+#include <vector>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \addtogroup algorithms algorithms
+//! @{
+
+//=============================================================================
+
+//! \brief A progressive mesh recorded by SurfaceSimplification.
+//! \details Stores the simplified base mesh and the sequence of vertex
+//! splits that inverts the halfedge collapses, see \cite hoppe_1996_progressive.
+//! Any level of detail between the base mesh and the input mesh can be
+//! reached by applying or undoing vertex splits, which only updates a few
+//! entries of the index buffer. Vertices and faces are ordered such that
+//! each level of detail uses a prefix of positions() and indices(), which
+//! suits rendering and progressive transmission. Usage:
+//! \code
+//! ProgressiveMesh pm;
+//! SurfaceSimplification ss(mesh);
+//! ss.initialize(5);
+//! ss.simplify(criteria, pm);
+//! pm.set_n_vertices(pm.max_vertices() / 2);
+//! pm.extract(mesh);
+//! \endcode
+class ProgressiveMesh
+{
+public:
+    ProgressiveMesh();
+
+    //! remove all levels of detail
+    void clear();
+
+    //! the number of vertices of the base mesh
+    size_t min_vertices() const { return n_base_vertices_; }
+
+    //! the number of vertices of the mesh before simplification
+    size_t max_vertices() const { return n_base_vertices_ + splits_.size(); }
+
+    //! the number of vertices of the current level of detail
+    size_t n_vertices() const { return n_base_vertices_ + level_; }
+
+    //! the number of triangles of the current level of detail
+    size_t n_faces() const;
+
+    //! \brief Refine or coarsen to \p n vertices.
+    //! \details \p n is clamped to [min_vertices(), max_vertices()]. Takes
+    //! time proportional to the number of vertex splits between the current
+    //! and the new level of detail.
+    void set_n_vertices(size_t n);
+
+    //! the vertex positions, the first n_vertices() are used
+    const std::vector<Point>& positions() const { return positions_; }
+
+    //! the triangles, the first n_faces() triples are used
+    const std::vector<IndexType>& indices() const { return indices_; }
+
+    //! replace \p mesh by the current level of detail
+    void extract(SurfaceMesh& mesh) const;
+
+    //! \brief Write the base mesh followed by the vertex splits.
+    //! \return false if the file cannot be written
+    bool write(const std::string& filename) const;
+
+    //! \brief Read a file written by write().
+    //! \details A truncated file, e.g., of a partial download, is read up to
+    //! its last complete vertex split. The level of detail is set to the
+    //! base mesh.
+    //! \return false if the file cannot be read or is invalid
+    bool read(const std::string& filename);
+
+private:
+    friend class SurfaceSimplification;
+
+    // the inverse of a halfedge collapse, v0 is the vertex it adds
+    struct VertexSplit
+    {
+        IndexType v1;             // the vertex split into v0 and v1
+        IndexType n_faces;        // the number of faces after the split
+        IndexType corners_begin;  // the corners changing from v1 to v0
+        IndexType corners_end;
+    };
+
+    // recording by SurfaceSimplification
+    void begin(const SurfaceMesh& mesh);
+    void add_collapse(Vertex v0, Vertex v1, Face fl, Face fr);
+    void end();
+
+    // apply or undo vertex split i
+    void split(size_t i);
+    void unsplit(size_t i);
+
+    size_t n_base_vertices_;
+    size_t n_base_faces_;
+    size_t level_; // the number of vertex splits applied
+
+    std::vector<Point> positions_;
+    std::vector<IndexType> indices_;
+    std::vector<VertexSplit> splits_;
+    std::vector<IndexType> split_corners_;
+
+    // the input mesh and its collapses while recording
+    struct Collapse
+    {
+        IndexType v0, v1, fl, fr;
+    };
+    std::vector<Collapse> collapses_;
+    std::vector<bool> vertex_used_;
+    std::vector<bool> face_used_;
+};
+
+//=============================================================================
+//! @}
+//=============================================================================
+} // namespace pmp
+//=============================================================================
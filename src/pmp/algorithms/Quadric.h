@@ -11,6 +11,8 @@
 
 #include <pmp/Types.h>
 
+#include <cmath>
+
 //=============================================================================
 
 namespace pmp {
@@ -20,14 +22,17 @@ namespace pmp {
 //! \addtogroup algorithms algorithms
 //!@{
 
-//! This class stores a quadric as a symmetrix 4x4 matrix. Used by the error
-//! quadric mesh decimation algorithms.
-class Quadric
+//! \brief This class stores a quadric as a symmetrix 4x4 matrix. Used by the
+//! error quadric mesh decimation algorithms.
+//! \details The entries are stored in \p Real precision, the computations
+//! are done in double precision.
+template <typename Real>
+class QuadricT
 {
 public: // clang-format off
 
     //! construct quadric from upper triangle of symmetrix 4x4 matrix
-    Quadric(double a, double b, double c, double d,
+    QuadricT(double a, double b, double c, double d,
             double e, double f, double g,
             double h, double i,
             double j)
@@ -38,24 +43,43 @@ public: // clang-format off
     {}
 
     //! constructor quadric from given plane equation: ax+by+cz+d=0
-    Quadric(double a=0.0, double b=0.0, double c=0.0, double d=0.0)
+    QuadricT(double a=0.0, double b=0.0, double c=0.0, double d=0.0)
         :  a_(a*a), b_(a*b), c_(a*c),  d_(a*d),
            e_(b*b), f_(b*c), g_(b*d),
            h_(c*c), i_(c*d),
            j_(d*d)
     {}
 
+    //! convert from a quadric of another precision
+    template <typename Other>
+    explicit QuadricT(const QuadricT<Other>& q)
+        : a_(q.a_), b_(q.b_), c_(q.c_), d_(q.d_),
+          e_(q.e_), f_(q.f_), g_(q.g_),
+          h_(q.h_), i_(q.i_),
+          j_(q.j_)
+    {}
+
     //! construct from point and normal specifying a plane
-    Quadric(const Normal& n, const Point& p)
+    QuadricT(const Normal& n, const Point& p)
     {
-        *this = Quadric(n[0], n[1], n[2], -dot(n,p));
+        *this = QuadricT(n[0], n[1], n[2], -dot(n,p));
     }
 
     //! set all matrix entries to zero
     void clear() { a_ = b_ = c_ = d_ = e_ = f_ = g_ = h_ = i_ = j_ = 0.0; }
 
+    //! add the quadric of the plane ax+by+cz+d=0, same as adding
+    //! Quadric(a,b,c,d) without the temporary
+    void add_plane(double a, double b, double c, double d)
+    {
+        a_ += a*a; b_ += a*b; c_ += a*c; d_ += a*d;
+        e_ += b*b; f_ += b*c; g_ += b*d;
+        h_ += c*c; i_ += c*d;
+        j_ += d*d;
+    }
+
     //! add given quadric to this quadric
-    Quadric& operator+=(const Quadric& q)
+    QuadricT& operator+=(const QuadricT& q)
     {
         a_ += q.a_; b_ += q.b_; c_ += q.c_; d_ += q.d_;
         e_ += q.e_; f_ += q.f_; g_ += q.g_;
@@ -65,7 +89,7 @@ public: // clang-format off
     }
 
     //! multiply quadric by a scalar
-    Quadric& operator*=(double s)
+    QuadricT& operator*=(double s)
     {
         a_ *= s; b_ *= s; c_ *= s;  d_ *= s;
         e_ *= s; f_ *= s; g_ *= s;
@@ -84,14 +108,47 @@ public: // clang-format off
             +  j_;
     }
 
+    //! \brief Compute the point \p p minimizing the quadric.
+    //! \return false if the minimizer is not unique, e.g., for the quadric
+    //! of a single plane
+    bool minimizer(Point& p) const
+    {
+        const double a(a_), b(b_), c(c_), d(d_), e(e_), f(f_), g(g_),
+                     h(h_), i(i_);
+
+        // solve A p = -b for the upper left 3x3 block A by Cramer's rule
+        const double det = a*(e*h - f*f) - b*(b*h - f*c)
+                         + c*(b*f - e*c);
+        const double scale = a*a + e*e + h*h;
+        if (std::fabs(det) <= 1e-6 * scale * std::sqrt(scale))
+            return false;
+
+        const double x = -(d*(e*h - f*f) - b*(g*h - f*i)
+                         + c*(g*f - e*i)) / det;
+        const double y = -(a*(g*h - i*f) - d*(b*h - f*c)
+                         + c*(b*i - g*c)) / det;
+        const double z = -(a*(e*i - f*g) - b*(b*i - g*c)
+                         + d*(b*f - e*c)) / det;
+        p = Point(x, y, z);
+        return true;
+    }
+
 private:
 
-    double a_, b_, c_, d_,
+    template <typename> friend class QuadricT;
+
+    Real a_, b_, c_, d_,
         e_, f_, g_,
         h_, i_,
         j_;
 }; // clang-format on
 
+//! a quadric in double precision
+typedef QuadricT<double> Quadric;
+
+//! a quadric in single precision, which needs half the memory
+typedef QuadricT<float> FloatQuadric;
+
 //=============================================================================
 //!@}
 //=============================================================================
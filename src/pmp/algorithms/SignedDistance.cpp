@@ -0,0 +1,216 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/algorithms/SignedDistance.h>
+#include <pmp/algorithms/BarycentricCoordinates.h>
+#include <pmp/algorithms/SurfaceNormals.h>
+#include <pmp/algorithms/TriangleKdTree.h>
+#include <pmp/BoundingBox.h>
+#include <pmp/Parallel.h>
+
+#include <algorithm>
+#include <cmath>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+namespace {
+
+// the angle-weighted pseudo-normals of the faces, edges, and vertices
+class PseudoNormals
+{
+public:
+    PseudoNormals(const SurfaceMesh& mesh) : mesh_(mesh)
+    {
+        faces_.resize(mesh.faces_size());
+        edges_.resize(mesh.edges_size(), Normal(0, 0, 0));
+        vertices_.resize(mesh.vertices_size());
+        parallel_for(mesh.faces(), [&](Face f) {
+            faces_[f.idx()] = SurfaceNormals::compute_face_normal(mesh, f);
+        });
+        parallel_for(mesh.edges(), [&](Edge e) {
+            for (int i = 0; i < 2; ++i)
+            {
+                const Face f = mesh.face(mesh.halfedge(e, i));
+                if (f.is_valid())
+                    edges_[e.idx()] += faces_[f.idx()];
+            }
+        });
+        parallel_for(mesh.vertices(), [&](Vertex v) {
+            vertices_[v.idx()] = SurfaceNormals::compute_vertex_normal(mesh, v);
+        });
+    }
+
+    // the sign of the distance of p to its nearest point q on face f
+    Scalar sign(const Point& p, Face f, const Point& q) const
+    {
+        // the corners, and the halfedges opposite to them
+        Vertex v[3];
+        Halfedge h[3];
+        Point x[3];
+        int j = 0;
+        for (auto hf : mesh_.halfedges(f))
+        {
+            v[j] = mesh_.to_vertex(hf);
+            x[j] = mesh_.position(v[j]);
+            h[(j + 1) % 3] = hf;
+            ++j;
+        }
+
+        // the feature q lies on
+        const Point b = barycentric_coordinates(q, x[0], x[1], x[2]);
+        const Scalar eps = 1e-5;
+        int n_zero = 0, nonzero = 0, zero = 0;
+        for (j = 0; j < 3; ++j)
+        {
+            if (b[j] < eps)
+            {
+                ++n_zero;
+                zero = j;
+            }
+            else
+                nonzero = j;
+        }
+
+        Normal n;
+        if (n_zero == 0)
+            n = faces_[f.idx()];
+        else if (n_zero == 1)
+            n = edges_[mesh_.edge(h[zero]).idx()];
+        else
+            n = vertices_[v[nonzero].idx()];
+        return dot(p - q, n) < 0 ? -1 : 1;
+    }
+
+private:
+    const SurfaceMesh& mesh_;
+    std::vector<Normal> faces_;
+    std::vector<Normal> edges_;
+    std::vector<Normal> vertices_;
+};
+
+} // namespace
+
+//=============================================================================
+
+Scalar SparseDistanceGrid::interpolate(const Point& p) const
+{
+    unsigned int i[3];
+    Scalar t[3];
+    for (int a = 0; a < 3; ++a)
+    {
+        const Scalar c = std::min(std::max((p[a] - origin[a]) / spacing,
+                                           Scalar(0)),
+                                  Scalar(resolution(a) - 1));
+        i[a] = std::min(unsigned(c), resolution(a) - 2);
+        t[a] = c - i[a];
+    }
+
+    Scalar result = 0;
+    for (int c = 0; c < 8; ++c)
+    {
+        const unsigned int d[3] = {c & 1u, (c >> 1) & 1u, (c >> 2) & 1u};
+        Scalar w = 1;
+        for (int a = 0; a < 3; ++a)
+            w *= d[a] ? t[a] : 1 - t[a];
+        result += w * value(i[0] + d[0], i[1] + d[1], i[2] + d[2]);
+    }
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+
+bool signed_distance_field(const SurfaceMesh& mesh, Scalar spacing,
+                           Scalar band, SparseDistanceGrid& grid)
+{
+    if (mesh.n_faces() == 0 || !(spacing > 0) || !(band > 0))
+        return false;
+
+    // the grid encloses the mesh with a margin of band
+    BoundingBox bb;
+    for (auto v : mesh.vertices())
+        bb += mesh.position(v);
+    const Scalar margin = band + spacing;
+    const unsigned int b = SparseDistanceGrid::brick_size;
+    size_t n_bricks = 1;
+    for (int a = 0; a < 3; ++a)
+    {
+        const double samples =
+            std::floor((bb.max()[a] - bb.min()[a] + 2 * margin) / spacing) +
+            1;
+        const double bricks = std::ceil(samples / b);
+        if (bricks * n_bricks > double(1u << 31))
+            return false;
+        grid.n_bricks[a] = static_cast<unsigned int>(bricks);
+        n_bricks *= grid.n_bricks[a];
+    }
+    grid.origin = bb.min() - Point(margin);
+    grid.spacing = spacing;
+    grid.band = band;
+
+    // the nearest triangles of the brick centers
+    const TriangleKdTree tree(mesh);
+    std::vector<Point> centers(n_bricks);
+    parallel_for(size_t(0), n_bricks, [&](size_t i) {
+        const size_t x = i % grid.n_bricks[0];
+        const size_t y = (i / grid.n_bricks[0]) % grid.n_bricks[1];
+        const size_t z = i / grid.n_bricks[0] / grid.n_bricks[1];
+        centers[i] = grid.origin +
+                     spacing * (Point(x, y, z) * Scalar(b) +
+                                Point(Scalar(b - 1) / 2));
+    });
+    const std::vector<TriangleKdTree::NearestNeighbor> nearest =
+        tree.nearest(centers);
+
+    // bricks within band of the surface store their samples
+    const PseudoNormals normals(mesh);
+    const Scalar half_diagonal = std::sqrt(Scalar(3)) * (b - 1) / 2 * spacing;
+    grid.bricks.assign(n_bricks, PMP_MAX_INDEX);
+    grid.inside.assign(n_bricks, 0);
+    std::vector<size_t> active;
+    for (size_t i = 0; i < n_bricks; ++i)
+    {
+        if (nearest[i].dist <= band + half_diagonal)
+        {
+            grid.bricks[i] = IndexType(active.size() * b * b * b);
+            active.push_back(i);
+        }
+        else
+        {
+            grid.inside[i] = normals.sign(centers[i], nearest[i].face,
+                                          nearest[i].nearest) < 0;
+        }
+    }
+
+    // the exact distances, brick by brick
+    grid.values.resize(active.size() * b * b * b);
+    parallel_for(size_t(0), active.size(), [&](size_t a) {
+        const size_t i = active[a];
+        const Point first = centers[i] - spacing * Point(Scalar(b - 1) / 2);
+        Scalar* values = &grid.values[grid.bricks[i]];
+        for (unsigned int z = 0; z < b; ++z)
+            for (unsigned int y = 0; y < b; ++y)
+                for (unsigned int x = 0; x < b; ++x)
+                {
+                    const Point p = first + spacing * Point(x, y, z);
+                    const TriangleKdTree::NearestNeighbor nn = tree.nearest(p);
+                    *values++ =
+                        normals.sign(p, nn.face, nn.nearest) * nn.dist;
+                }
+    });
+
+    return true;
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -0,0 +1,90 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <pmp/SurfaceMesh.h>
+
+#include <vector>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \addtogroup algorithms algorithms
+//! @{
+
+//=============================================================================
+
+//! \brief A sparse regular grid of signed distances.
+//! \details The samples are grouped into bricks of brick_size^3 samples.
+//! Only bricks near the surface store their samples, all others are entirely
+//! inside or outside, and their samples are -band or band.
+struct SparseDistanceGrid
+{
+    //! the number of samples along each edge of a brick
+    static const unsigned int brick_size = 8;
+
+    Point origin;                 //!< the position of sample (0,0,0)
+    Scalar spacing{0};            //!< the distance of adjacent samples
+    Scalar band{0};               //!< the width of the stored narrow band
+    unsigned int n_bricks[3]{};   //!< the number of bricks along each axis
+    std::vector<IndexType> bricks; //!< per brick, its first value or
+                                   //!< PMP_MAX_INDEX if it is empty
+    std::vector<char> inside;     //!< per brick, whether it is inside
+    std::vector<Scalar> values;   //!< the samples of the stored bricks
+
+    //! the number of samples along axis \p a
+    unsigned int resolution(int a) const { return n_bricks[a] * brick_size; }
+
+    //! \brief Return sample (\p i, \p j, \p k), which must be in the grid.
+    Scalar value(unsigned int i, unsigned int j, unsigned int k) const
+    {
+        const size_t b = brick(i / brick_size, j / brick_size, k / brick_size);
+        if (bricks[b] == PMP_MAX_INDEX)
+            return inside[b] ? -band : band;
+        return values[bricks[b] + (i % brick_size) +
+                      brick_size * ((j % brick_size) +
+                                    brick_size * (k % brick_size))];
+    }
+
+    //! \brief Interpolate the samples trilinearly at \p p.
+    //! \details Points outside the grid are clamped to it.
+    Scalar interpolate(const Point& p) const;
+
+    //! the index of brick (\p i, \p j, \p k)
+    size_t brick(unsigned int i, unsigned int j, unsigned int k) const
+    {
+        return i + size_t(n_bricks[0]) * (j + size_t(n_bricks[1]) * k);
+    }
+};
+
+//! \brief Compute the signed distance field of the triangle mesh \p mesh.
+//! \details Replaces \p grid by a grid with the given \p spacing that
+//! encloses the mesh with a margin of \p band. Distances are negative inside
+//! the mesh, which has to be closed and consistently oriented.
+//!
+//! A TriangleKdTree finds the nearest triangle of each brick center, which
+//! decides whether the brick is within \p band of the surface, and of each
+//! sample in these bricks. The samples are exact distances, computed in
+//! parallel over the bricks. Their sign is that of the angle-weighted
+//! pseudo-normal of the nearest face, edge, or vertex, which, unlike the
+//! face normal, is correct on both sides of edges and vertices.
+//! \return false if the mesh has no faces, \p spacing or \p band is not
+//! positive, or the grid would have more than 2^31 bricks
+bool signed_distance_field(const SurfaceMesh& mesh, Scalar spacing,
+                           Scalar band, SparseDistanceGrid& grid);
+
+//=============================================================================
+//! @}
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -0,0 +1,628 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/algorithms/SparseSolver.h>
+#include <pmp/Parallel.h>
+#include <pmp/Profiler.h>
+#include <pmp/Timer.h>
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+
+#include <algorithm>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+using SparseMatrix = Eigen::SparseMatrix<double>;
+using RowMatrix = Eigen::SparseMatrix<double, Eigen::RowMajor>;
+
+//=============================================================================
+
+namespace {
+
+SparseSolver::Method default_solver_method = SparseSolver::LDLT;
+
+// the refinement steps of MixedPrecisionLDLT before giving up
+const unsigned int max_refinements = 10;
+
+//-----------------------------------------------------------------------------
+
+// Smoothed aggregation multigrid, see Vaněk et al., "Algebraic multigrid
+// by smoothed aggregation for second and fourth order elliptic problems".
+// The coarse levels are built from the graph of the matrix and interpolate
+// its near kernel exactly, which has to include the linear functions for
+// the k-th powers of the Laplacian used by fairing. One V-cycle
+// preconditions conjugate gradients.
+class AggregationMultigrid
+{
+public:
+    // build the levels for A, whose near kernel has the columns of
+    // near_kernel
+    bool compute(const RowMatrix& A, const Eigen::MatrixXd& near_kernel);
+
+    // one V-cycle for A x = b, starting from zero
+    void precondition(const Eigen::VectorXd& b, Eigen::VectorXd& x) const
+    {
+        cycle(0, b, x);
+    }
+
+    // preconditioned conjugate gradients
+    bool solve(const Eigen::VectorXd& b, Eigen::VectorXd& x, double tolerance,
+               Eigen::Index& iterations, double& error) const;
+
+private:
+    struct Level
+    {
+        RowMatrix A; // empty on the finest level, see matrix()
+        RowMatrix P; // prolongation from the next coarser level
+        Eigen::VectorXd inverse_diagonal;
+        double omega; // damping of the Jacobi smoother
+    };
+
+    // the matrix of level l
+    const RowMatrix& matrix(size_t l) const
+    {
+        return l ? levels_[l].A : *fine_;
+    }
+
+    // group strongly connected rows of A, returns the number of groups
+    static int aggregate(const RowMatrix& A, std::vector<int>& aggregates);
+
+    // estimate the largest eigenvalue of D^-1 A
+    static double spectral_radius(const RowMatrix& A,
+                                  const Eigen::VectorXd& inverse_diagonal);
+
+    void cycle(size_t l, const Eigen::VectorXd& b, Eigen::VectorXd& x) const;
+
+    const RowMatrix* fine_ = nullptr; // the matrix of compute()
+    std::vector<Level> levels_;
+    Eigen::SimplicialLDLT<SparseMatrix> coarse_;
+};
+
+//-----------------------------------------------------------------------------
+
+bool AggregationMultigrid::compute(const RowMatrix& A,
+                                   const Eigen::MatrixXd& near_kernel)
+{
+    const Eigen::Index coarse_size = 1000;
+    const size_t max_levels = 25;
+
+    fine_ = &A;
+    levels_.clear();
+    Eigen::MatrixXd B = near_kernel;
+
+    // the node of each row, the rows of a node are aggregated together
+    std::vector<int> nodes(A.rows());
+    for (size_t i = 0; i < nodes.size(); ++i)
+        nodes[i] = int(i);
+    int n_nodes = A.rows();
+    RowMatrix next; // the matrix of the next level
+
+    while (levels_.size() < max_levels)
+    {
+        const bool is_fine = levels_.empty();
+        const RowMatrix& M = is_fine ? A : next;
+        if (M.rows() <= coarse_size)
+            break;
+
+        Level level;
+        level.inverse_diagonal = M.diagonal().cwiseInverse();
+        if (!level.inverse_diagonal.allFinite())
+            return false;
+        const double rho = spectral_radius(M, level.inverse_diagonal);
+        level.omega = 4.0 / (3.0 * rho);
+
+        // aggregate the graph of the nodes, stop if the coarsening stalls
+        std::vector<Eigen::Triplet<double>> triplets;
+        triplets.reserve(M.rows());
+        for (Eigen::Index i = 0; i < M.rows(); ++i)
+            triplets.emplace_back(i, nodes[i], 1.0);
+        RowMatrix S(M.rows(), n_nodes);
+        S.setFromTriplets(triplets.begin(), triplets.end());
+        const RowMatrix N =
+            RowMatrix(S.transpose()) * RowMatrix(M.cwiseAbs()) * S;
+        std::vector<int> aggregates;
+        const int n_aggregates = aggregate(N, aggregates);
+        if (n_aggregates > 0.8 * n_nodes)
+            break;
+
+        std::vector<std::vector<int>> rows(n_aggregates);
+        for (Eigen::Index i = 0; i < M.rows(); ++i)
+            rows[aggregates[nodes[i]]].push_back(int(i));
+
+        // tentative prolongation from the near kernel restricted to each
+        // aggregate, orthonormalized by Gram-Schmidt
+        const Eigen::Index m = B.cols();
+        const Eigen::VectorXd column_norms = B.colwise().norm();
+        triplets.clear();
+        std::vector<int> coarse_nodes;
+        std::vector<Eigen::RowVectorXd> coarse_kernel;
+        for (int a = 0; a < n_aggregates; ++a)
+        {
+            const std::vector<int>& r = rows[a];
+            Eigen::MatrixXd Q(r.size(), m);
+            for (size_t i = 0; i < r.size(); ++i)
+                Q.row(i) = B.row(r[i]);
+
+            Eigen::MatrixXd R = Eigen::MatrixXd::Zero(m, m);
+            Eigen::Index rank = 0;
+            for (Eigen::Index c = 0; c < m; ++c)
+            {
+                Eigen::VectorXd v = Q.col(c);
+                for (Eigen::Index j = 0; j < rank; ++j)
+                {
+                    R(j, c) = Q.col(j).dot(v);
+                    v -= R(j, c) * Q.col(j);
+                }
+                const double norm = v.norm();
+                if (norm > 1e-10 * column_norms[c] && norm > 0.0)
+                {
+                    Q.col(rank) = v / norm;
+                    R(rank, c) = norm;
+                    ++rank;
+                }
+            }
+
+            const int offset = coarse_nodes.size();
+            for (Eigen::Index j = 0; j < rank; ++j)
+            {
+                for (size_t i = 0; i < r.size(); ++i)
+                    triplets.emplace_back(r[i], offset + j, Q(i, j));
+                coarse_nodes.push_back(a);
+                coarse_kernel.push_back(R.row(j));
+            }
+        }
+        const int n_coarse = coarse_nodes.size();
+        RowMatrix P0(M.rows(), n_coarse);
+        P0.setFromTriplets(triplets.begin(), triplets.end());
+
+        // smooth the prolongation by one Jacobi step
+        const RowMatrix DA =
+            level.omega * level.inverse_diagonal.asDiagonal() * M;
+        level.P = P0 - RowMatrix(DA * P0);
+
+        // Galerkin coarse operator
+        RowMatrix coarse = RowMatrix(level.P.transpose()) * (M * level.P);
+        if (!is_fine)
+            level.A = std::move(next);
+        next = std::move(coarse);
+        levels_.push_back(std::move(level));
+
+        B.resize(n_coarse, m);
+        for (int i = 0; i < n_coarse; ++i)
+            B.row(i) = coarse_kernel[i];
+        nodes = std::move(coarse_nodes);
+        n_nodes = n_aggregates;
+    }
+
+    // the coarsest level is solved directly
+    Level coarsest;
+    if (!levels_.empty())
+        coarsest.A = std::move(next);
+    coarsest.omega = 0;
+    levels_.push_back(std::move(coarsest));
+    coarse_.compute(SparseMatrix(matrix(levels_.size() - 1)));
+    return coarse_.info() == Eigen::Success;
+}
+
+//-----------------------------------------------------------------------------
+
+int AggregationMultigrid::aggregate(const RowMatrix& A,
+                                    std::vector<int>& aggregates)
+{
+    // strong connections by their magnitude relative to the diagonal
+    const double theta = 0.08;
+    const Eigen::VectorXd d = A.diagonal().cwiseAbs();
+    auto is_strong = [&](Eigen::Index i, Eigen::Index j, double a) {
+        return i != j && a * a >= theta * theta * d[i] * d[j];
+    };
+
+    const Eigen::Index n = A.rows();
+    aggregates.assign(n, -1);
+    int n_aggregates = 0;
+
+    // rows whose strong neighbors are all free start an aggregate
+    for (Eigen::Index i = 0; i < n; ++i)
+    {
+        if (aggregates[i] >= 0)
+            continue;
+        bool is_free = true;
+        for (RowMatrix::InnerIterator it(A, i); it && is_free; ++it)
+            if (is_strong(i, it.col(), it.value()) &&
+                aggregates[it.col()] >= 0)
+                is_free = false;
+        if (!is_free)
+            continue;
+        aggregates[i] = n_aggregates;
+        for (RowMatrix::InnerIterator it(A, i); it; ++it)
+            if (is_strong(i, it.col(), it.value()))
+                aggregates[it.col()] = n_aggregates;
+        ++n_aggregates;
+    }
+
+    // remaining rows join the aggregate of a strong neighbor
+    const std::vector<int> initial = aggregates;
+    for (Eigen::Index i = 0; i < n; ++i)
+    {
+        if (aggregates[i] >= 0)
+            continue;
+        for (RowMatrix::InnerIterator it(A, i); it; ++it)
+            if (is_strong(i, it.col(), it.value()) && initial[it.col()] >= 0)
+            {
+                aggregates[i] = initial[it.col()];
+                break;
+            }
+        if (aggregates[i] < 0)
+            aggregates[i] = n_aggregates++;
+    }
+
+    return n_aggregates;
+}
+
+//-----------------------------------------------------------------------------
+
+double AggregationMultigrid::spectral_radius(
+    const RowMatrix& A, const Eigen::VectorXd& inverse_diagonal)
+{
+    // power iterations from a deterministic start vector
+    Eigen::VectorXd x(A.rows());
+    for (Eigen::Index i = 0; i < x.size(); ++i)
+        x[i] = 1.0 + 0.5 * std::sin(double(i));
+    x.normalize();
+
+    double rho = 1.0;
+    for (int i = 0; i < 15; ++i)
+    {
+        Eigen::VectorXd y = inverse_diagonal.cwiseProduct(A * x);
+        rho = y.norm();
+        if (rho == 0.0)
+            return 1.0;
+        x = y / rho;
+    }
+
+    // the estimate is from below
+    return 1.1 * rho;
+}
+
+//-----------------------------------------------------------------------------
+
+void AggregationMultigrid::cycle(size_t l, const Eigen::VectorXd& b,
+                                 Eigen::VectorXd& x) const
+{
+    const Level& level = levels_[l];
+    if (l + 1 == levels_.size())
+    {
+        x = coarse_.solve(b);
+        return;
+    }
+
+    // pre-smoothing
+    const RowMatrix& A = matrix(l);
+    const int n_smooth = 2;
+    x = level.omega * level.inverse_diagonal.cwiseProduct(b);
+    for (int i = 1; i < n_smooth; ++i)
+        x += level.omega * level.inverse_diagonal.cwiseProduct(b - A * x);
+
+    // coarse grid correction
+    const Eigen::VectorXd r = level.P.transpose() * (b - A * x);
+    Eigen::VectorXd e;
+    cycle(l + 1, r, e);
+    x += level.P * e;
+
+    // post-smoothing
+    for (int i = 0; i < n_smooth; ++i)
+        x += level.omega * level.inverse_diagonal.cwiseProduct(b - A * x);
+}
+
+//-----------------------------------------------------------------------------
+
+bool AggregationMultigrid::solve(const Eigen::VectorXd& b,
+                                 Eigen::VectorXd& x, double tolerance,
+                                 Eigen::Index& iterations,
+                                 double& error) const
+{
+    const RowMatrix& A = *fine_;
+    const Eigen::Index max_iterations = iterations;
+    iterations = 0;
+
+    const double b_norm = b.norm();
+    if (b_norm == 0.0)
+    {
+        x.setZero();
+        error = 0.0;
+        return true;
+    }
+
+    Eigen::VectorXd r = b - A * x;
+    error = r.norm() / b_norm;
+    if (error <= tolerance)
+        return true;
+
+    Eigen::VectorXd z, p, Ap;
+    precondition(r, z);
+    p = z;
+    double rz = r.dot(z);
+    while (iterations < max_iterations)
+    {
+        Ap = A * p;
+        const double alpha = rz / p.dot(Ap);
+        x += alpha * p;
+        r -= alpha * Ap;
+        ++iterations;
+
+        error = r.norm() / b_norm;
+        if (error <= tolerance)
+            return true;
+
+        precondition(r, z);
+        const double rz_next = r.dot(z);
+        p = z + (rz_next / rz) * p;
+        rz = rz_next;
+    }
+    return false;
+}
+
+} // namespace
+
+//=============================================================================
+
+struct SparseSolver::Solvers
+{
+    // the matrix in row-major order for the multithreaded products of the
+    // iterative methods and the residuals of the refinement
+    RowMatrix A;
+
+    Eigen::SimplicialLDLT<SparseMatrix> ldlt;
+    Eigen::SimplicialLDLT<Eigen::SparseMatrix<float>> ldlt_float;
+    Eigen::ConjugateGradient<RowMatrix, Eigen::Lower | Eigen::Upper> cg;
+    Eigen::ConjugateGradient<RowMatrix, Eigen::Lower | Eigen::Upper,
+                             Eigen::IncompleteCholesky<double>>
+        iccg;
+    Eigen::BiCGSTAB<RowMatrix> bicgstab;
+    AggregationMultigrid multigrid;
+};
+
+//=============================================================================
+
+void SparseSolver::set_default_method(Method method)
+{
+    default_solver_method = method;
+}
+
+//-----------------------------------------------------------------------------
+
+SparseSolver::Method SparseSolver::default_method()
+{
+    return default_solver_method;
+}
+
+//-----------------------------------------------------------------------------
+
+SparseSolver::SparseSolver(Method method)
+    : method_(method),
+      tolerance_(1e-10),
+      setup_time_(0),
+      solve_time_(0),
+      iterations_(0),
+      analyzed_(false),
+      factored_(false),
+      solvers_(new Solvers)
+{
+}
+
+//-----------------------------------------------------------------------------
+
+SparseSolver::~SparseSolver() = default;
+
+//-----------------------------------------------------------------------------
+
+bool SparseSolver::compute(const CompressedRowMatrix& matrix)
+{
+    const bool same_pattern = analyzed_ &&
+                              matrix.n_rows == matrix_.n_rows &&
+                              matrix.n_columns == matrix_.n_columns &&
+                              matrix.offsets == matrix_.offsets &&
+                              matrix.columns == matrix_.columns;
+    if (same_pattern && factored_ && matrix.values == matrix_.values)
+    {
+        setup_time_ = 0;
+        return true;
+    }
+
+    PMP_PROFILE_ZONE("SparseSolver::compute");
+    Timer timer;
+    timer.start();
+
+    matrix_ = matrix;
+    if (method_ != LDLT)
+        solvers_->A = Eigen::Map<const RowMatrix>(
+            matrix.n_rows, matrix.n_columns, matrix.values.size(),
+            matrix.offsets.data(), matrix.columns.data(),
+            matrix.values.data());
+
+    bool ok = true;
+    switch (method_)
+    {
+        case LDLT:
+        {
+            // the matrix is symmetric, hence its rows are its columns
+            const Eigen::Map<const SparseMatrix> A(
+                matrix.n_rows, matrix.n_columns, matrix.values.size(),
+                matrix.offsets.data(), matrix.columns.data(),
+                matrix.values.data());
+            if (!same_pattern)
+                solvers_->ldlt.analyzePattern(A);
+            solvers_->ldlt.factorize(A);
+            ok = solvers_->ldlt.info() == Eigen::Success;
+            break;
+        }
+        case ConjugateGradient:
+            solvers_->cg.compute(solvers_->A);
+            ok = solvers_->cg.info() == Eigen::Success;
+            break;
+        case IncompleteCholeskyCG:
+            solvers_->iccg.compute(solvers_->A);
+            ok = solvers_->iccg.info() == Eigen::Success;
+            break;
+        case BiCGSTAB:
+            solvers_->bicgstab.compute(solvers_->A);
+            ok = solvers_->bicgstab.info() == Eigen::Success;
+            break;
+        case Multigrid:
+        {
+            // the constant vector and the given near kernel
+            const int n = matrix.n_rows;
+            const int m = n && near_kernel_.size() % n == 0
+                              ? near_kernel_.size() / n
+                              : 0;
+            Eigen::MatrixXd B(n, 1 + m);
+            B.col(0).setOnes();
+            if (m)
+                B.rightCols(m) = Eigen::Map<const Eigen::MatrixXd>(
+                    near_kernel_.data(), n, m);
+            ok = solvers_->multigrid.compute(solvers_->A, B);
+            break;
+        }
+        case MixedPrecisionLDLT:
+        {
+            const Eigen::SparseMatrix<float> A =
+                SparseMatrix(solvers_->A).cast<float>();
+            if (!same_pattern)
+                solvers_->ldlt_float.analyzePattern(A);
+            solvers_->ldlt_float.factorize(A);
+            ok = solvers_->ldlt_float.info() == Eigen::Success;
+            break;
+        }
+    }
+
+    analyzed_ = true;
+    factored_ = ok;
+    setup_time_ = timer.stop().elapsed();
+    return ok;
+}
+
+//-----------------------------------------------------------------------------
+
+bool SparseSolver::solve(const std::vector<double>& b, std::vector<double>& x)
+{
+    solve_time_ = 0;
+    iterations_ = 0;
+
+    const int n = matrix_.n_rows;
+    if (!factored_ || !n || b.size() % n)
+        return false;
+
+    PMP_PROFILE_ZONE("SparseSolver::solve");
+    Timer timer;
+    timer.start();
+
+    const int k = b.size() / n;
+    const Eigen::Map<const Eigen::MatrixXd> B(b.data(), n, k);
+    if (x.size() != b.size())
+        x.assign(b.size(), 0.0);
+    Eigen::Map<Eigen::MatrixXd> X(x.data(), n, k);
+
+    Eigen::setNbThreads(int(num_threads()));
+
+    bool ok = true;
+    const RowMatrix& A = solvers_->A;
+    switch (method_)
+    {
+        case LDLT:
+            X = solvers_->ldlt.solve(B);
+            ok = solvers_->ldlt.info() == Eigen::Success;
+            break;
+
+        case ConjugateGradient:
+        case IncompleteCholeskyCG:
+        case BiCGSTAB:
+        case Multigrid:
+        {
+            // solve the right-hand sides concurrently, calling the Eigen
+            // iterations directly since the solvers keep their statistics
+            // in members
+            std::vector<Eigen::Index> iterations(k, 2 * A.cols());
+            std::vector<double> errors(k, tolerance_);
+            std::vector<char> converged(k, 1);
+            parallel_for_chunks(
+                k,
+                [&](size_t begin, size_t end) {
+                    for (size_t j = begin; j < end; ++j)
+                    {
+                        Eigen::VectorXd x = X.col(j);
+                        if (method_ == ConjugateGradient)
+                            Eigen::internal::conjugate_gradient(
+                                A, B.col(j), x,
+                                solvers_->cg.preconditioner(), iterations[j],
+                                errors[j]);
+                        else if (method_ == IncompleteCholeskyCG)
+                            Eigen::internal::conjugate_gradient(
+                                A, B.col(j), x,
+                                solvers_->iccg.preconditioner(),
+                                iterations[j], errors[j]);
+                        else if (method_ == Multigrid)
+                            converged[j] = solvers_->multigrid.solve(
+                                B.col(j), x, tolerance_, iterations[j],
+                                errors[j]);
+                        else
+                            converged[j] = Eigen::internal::bicgstab(
+                                A, B.col(j), x,
+                                solvers_->bicgstab.preconditioner(),
+                                iterations[j], errors[j]);
+                        X.col(j) = x;
+                    }
+                },
+                1);
+            for (int j = 0; j < k; ++j)
+            {
+                ok = ok && converged[j] && errors[j] <= tolerance_;
+                iterations_ = std::max(iterations_,
+                                       (unsigned int)iterations[j]);
+            }
+            break;
+        }
+
+        case MixedPrecisionLDLT:
+        {
+            // iterative refinement with the residual in double precision
+            const auto& ldlt = solvers_->ldlt_float;
+            const Eigen::ArrayXd threshold =
+                tolerance_ * B.colwise().norm().array();
+            X = ldlt.solve(B.cast<float>()).cast<double>();
+            ok = false;
+            for (;;)
+            {
+                const Eigen::MatrixXd R = B - A * X;
+                if ((R.colwise().norm().array() <= threshold.transpose())
+                        .all())
+                {
+                    ok = true;
+                    break;
+                }
+                if (iterations_ == max_refinements)
+                    break;
+                X += ldlt.solve(R.cast<float>()).cast<double>();
+                ++iterations_;
+            }
+            ok = ok && ldlt.info() == Eigen::Success;
+            break;
+        }
+    }
+
+    solve_time_ = timer.stop().elapsed();
+    return ok;
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
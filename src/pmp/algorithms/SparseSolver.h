@@ -0,0 +1,145 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <memory>
+#include <vector>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \addtogroup algorithms algorithms
+//!@{
+
+//! \brief A sparse matrix in compressed row storage.
+//! \details The column indices of each row are sorted, such that the arrays
+//! can be mapped to a compressed sparse matrix of a linear algebra library.
+struct CompressedRowMatrix
+{
+    CompressedRowMatrix() : n_rows(0), n_columns(0) {}
+
+    int n_rows;
+    int n_columns;
+    std::vector<int> offsets;   //!< where the entries of each row start
+    std::vector<int> columns;   //!< the column of each entry
+    std::vector<double> values; //!< the value of each entry
+};
+
+//! \brief Solves sparse symmetric positive definite linear systems.
+//! \details Used by SurfaceSmoothing, SurfaceFairing, SurfaceParameterization
+//! and HoleFilling, which take the method from default_method(). The
+//! iterative methods solve several right-hand sides concurrently and
+//! multiply with the matrix on num_threads() threads. MixedPrecisionLDLT
+//! stores the values of the factor in float and refines its solution in
+//! double precision until the tolerance is met, which needs a condition
+//! number well below 1e7, e.g., not for curvature minimizing fairing.
+//! Multigrid needs memory linear in the size of the matrix, unlike the
+//! fill-in of the factorizations, which suits fairing large regions.
+//! compute() keeps the symbolic analysis of the factorization while the
+//! sparsity pattern of the matrix is unchanged, and skips the setup if the
+//! matrix is unchanged. Usage:
+//! \code
+//! SparseSolver solver(SparseSolver::ConjugateGradient);
+//! if (solver.compute(A) && solver.solve(b, x))
+//!     std::cout << solver.setup_time() << solver.solve_time() << "\n";
+//! \endcode
+class SparseSolver
+{
+public:
+    //! the available methods
+    enum Method
+    {
+        LDLT,                 //!< sparse Cholesky factorization
+        ConjugateGradient,    //!< conjugate gradients, Jacobi preconditioner
+        IncompleteCholeskyCG, //!< conjugate gradients, incomplete Cholesky
+        BiCGSTAB,             //!< stabilized bi-conjugate gradients, Jacobi
+        MixedPrecisionLDLT,   //!< float Cholesky, refined in double
+        Multigrid             //!< conjugate gradients, algebraic multigrid
+    };
+
+    //! \brief Set the method used by the algorithms of the library.
+    //! \details The default is LDLT.
+    static void set_default_method(Method method);
+
+    //! the method used by the algorithms of the library
+    static Method default_method();
+
+    //! construct with solver \p method
+    explicit SparseSolver(Method method = default_method());
+
+    // destructor
+    ~SparseSolver();
+
+    //! the method of the solver
+    Method method() const { return method_; }
+
+    //! \brief Set the relative residual at which iterative methods and the
+    //! refinement of MixedPrecisionLDLT stop.
+    //! \details The default is 1e-10.
+    void set_tolerance(double tolerance) { tolerance_ = tolerance; }
+
+    //! \brief Set vectors that the matrix maps close to zero.
+    //! \details Used by Multigrid to build its coarse levels, e.g., the
+    //! coordinates of the vertices for powers of the Laplacian. \p vectors
+    //! stores them column by column, the constant vector is always used.
+    //! Takes effect at the next compute() with a changed matrix.
+    void set_near_kernel(const std::vector<double>& vectors)
+    {
+        near_kernel_ = vectors;
+    }
+
+    //! \brief Factor or precondition the square \p matrix.
+    //! \return false if the factorization failed
+    bool compute(const CompressedRowMatrix& matrix);
+
+    //! \brief Solve for the right-hand sides \p b.
+    //! \details \p b stores one or more right-hand sides column by column.
+    //! If \p x has the size of \p b, the iterative methods start from it.
+    //! \return false if compute() failed or the iteration did not converge
+    bool solve(const std::vector<double>& b, std::vector<double>& x);
+
+    //! the time in ms of the last compute(), zero if its matrix was reused
+    double setup_time() const { return setup_time_; }
+
+    //! the time in ms of the last solve()
+    double solve_time() const { return solve_time_; }
+
+    //! \brief The iterations of the last solve().
+    //! \details The maximum over the right-hand sides for the iterative
+    //! methods, the refinement steps for MixedPrecisionLDLT.
+    unsigned int iterations() const { return iterations_; }
+
+private:
+    // the Eigen solvers, kept out of the header
+    struct Solvers;
+
+    Method method_;
+    double tolerance_;
+    double setup_time_;
+    double solve_time_;
+    unsigned int iterations_;
+
+    // the matrix of the last analysis and factorization
+    CompressedRowMatrix matrix_;
+    std::vector<double> near_kernel_;
+    bool analyzed_;
+    bool factored_;
+
+    std::unique_ptr<Solvers> solvers_;
+};
+
+//!@}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -0,0 +1,105 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/algorithms/SurfaceAdjacency.h>
+#include <pmp/Parallel.h>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+namespace {
+
+// turn per-row counts stored at offsets[i+1] into row offsets
+void prefix_sum(std::vector<IndexType>& offsets)
+{
+    offsets[0] = 0;
+    for (size_t i = 1; i < offsets.size(); ++i)
+        offsets[i] += offsets[i - 1];
+}
+
+} // namespace
+
+//=============================================================================
+
+SurfaceAdjacency::SurfaceAdjacency(const SurfaceMesh& mesh) : mesh_(mesh)
+{
+    build();
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceAdjacency::update()
+{
+    if (!is_valid())
+        build();
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceAdjacency::build()
+{
+    topology_version_ = mesh_.topology_version();
+
+    // count row sizes
+    vv_offsets_.assign(mesh_.vertices_size() + 1, 0);
+    vf_offsets_.assign(mesh_.vertices_size() + 1, 0);
+    fv_offsets_.assign(mesh_.faces_size() + 1, 0);
+
+    parallel_for(mesh_.vertices(), [&](Vertex v) {
+        IndexType nv(0), nf(0);
+        for (auto h : mesh_.halfedges(v))
+        {
+            ++nv;
+            if (!mesh_.is_boundary(h))
+                ++nf;
+        }
+        vv_offsets_[v.idx() + 1] = nv;
+        vf_offsets_[v.idx() + 1] = nf;
+    });
+
+    parallel_for(mesh_.faces(), [&](Face f) {
+        fv_offsets_[f.idx() + 1] = mesh_.valence(f);
+    });
+
+    prefix_sum(vv_offsets_);
+    prefix_sum(vf_offsets_);
+    prefix_sum(fv_offsets_);
+
+    // fill rows
+    vv_indices_.resize(vv_offsets_.back());
+    ve_indices_.resize(vv_offsets_.back());
+    vf_indices_.resize(vf_offsets_.back());
+    fv_indices_.resize(fv_offsets_.back());
+
+    parallel_for(mesh_.vertices(), [&](Vertex v) {
+        IndexType iv = vv_offsets_[v.idx()];
+        IndexType jf = vf_offsets_[v.idx()];
+        for (auto h : mesh_.halfedges(v))
+        {
+            vv_indices_[iv] = mesh_.to_vertex(h);
+            ve_indices_[iv] = mesh_.edge(h);
+            ++iv;
+            if (!mesh_.is_boundary(h))
+                vf_indices_[jf++] = mesh_.face(h);
+        }
+    });
+
+    parallel_for(mesh_.faces(), [&](Face f) {
+        IndexType i = fv_offsets_[f.idx()];
+        for (auto v : mesh_.vertices(f))
+            fv_indices_[i++] = v;
+    });
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
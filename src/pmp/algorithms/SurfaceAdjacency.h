@@ -0,0 +1,144 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <pmp/SurfaceMesh.h>
+
+#include <vector>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \addtogroup algorithms algorithms
+//!@{
+
+//! \brief An immutable compressed-row snapshot of the mesh adjacency.
+//! \details Stores the vertex-vertex, vertex-edge, vertex-face, and
+//! face-vertex relations in flat offset/index arrays, such that read-only
+//! algorithms can traverse one-rings as contiguous ranges instead of
+//! following halfedge pointers. The neighbors of a vertex are listed in the
+//! order of SurfaceMesh::vertices(Vertex), and the i-th entry of edges(v)
+//! connects \c v to the i-th entry of vertices(v). Rows are indexed by the
+//! element indices of the mesh; deleted elements have empty rows.
+//!
+//! The snapshot records SurfaceMesh::topology_version() at construction
+//! time. Once the connectivity of the mesh changes, is_valid() returns false
+//! and the snapshot has to be rebuilt. Changing vertex positions does not
+//! invalidate it. Usage:
+//! \code
+//! SurfaceAdjacency adjacency(mesh);
+//! for (auto v : mesh.vertices())
+//!     for (auto vv : adjacency.vertices(v))
+//!         ...
+//! \endcode
+class SurfaceAdjacency
+{
+public:
+    //! A contiguous range of handles, usable in range-based for loops.
+    template <class HandleType>
+    class Range
+    {
+    public:
+        Range(const HandleType* begin, const HandleType* end)
+            : begin_(begin), end_(end)
+        {
+        }
+        const HandleType* begin() const { return begin_; }
+        const HandleType* end() const { return end_; }
+        size_t size() const { return end_ - begin_; }
+        bool empty() const { return begin_ == end_; }
+        const HandleType& operator[](size_t i) const { return begin_[i]; }
+
+    private:
+        const HandleType* begin_;
+        const HandleType* end_;
+    };
+
+    //! build the snapshot from the current connectivity of \p mesh
+    SurfaceAdjacency(const SurfaceMesh& mesh);
+
+    //! returns whether the connectivity of the mesh is unchanged since
+    //! construction
+    bool is_valid() const
+    {
+        return mesh_.topology_version() == topology_version_;
+    }
+
+    //! rebuild the snapshot, if the connectivity of the mesh changed
+    void update();
+
+    //! the neighbor vertices of \p v
+    Range<Vertex> vertices(Vertex v) const
+    {
+        return Range<Vertex>(vv_indices_.data() + vv_offsets_[v.idx()],
+                             vv_indices_.data() + vv_offsets_[v.idx() + 1]);
+    }
+
+    //! the incident edges of \p v, aligned with vertices(v)
+    Range<Edge> edges(Vertex v) const
+    {
+        return Range<Edge>(ve_indices_.data() + vv_offsets_[v.idx()],
+                           ve_indices_.data() + vv_offsets_[v.idx() + 1]);
+    }
+
+    //! the incident faces of \p v
+    Range<Face> faces(Vertex v) const
+    {
+        return Range<Face>(vf_indices_.data() + vf_offsets_[v.idx()],
+                           vf_indices_.data() + vf_offsets_[v.idx() + 1]);
+    }
+
+    //! the vertices of face \p f
+    Range<Vertex> vertices(Face f) const
+    {
+        return Range<Vertex>(fv_indices_.data() + fv_offsets_[f.idx()],
+                             fv_indices_.data() + fv_offsets_[f.idx() + 1]);
+    }
+
+    //! the number of neighbors of \p v
+    unsigned int valence(Vertex v) const
+    {
+        return vv_offsets_[v.idx() + 1] - vv_offsets_[v.idx()];
+    }
+
+    //! the number of vertices of face \p f
+    unsigned int valence(Face f) const
+    {
+        return fv_offsets_[f.idx() + 1] - fv_offsets_[f.idx()];
+    }
+
+private:
+    void build();
+
+    const SurfaceMesh& mesh_;
+    unsigned long topology_version_;
+
+    // vertex -> vertex and vertex -> edge, sharing the offsets
+    std::vector<IndexType> vv_offsets_;
+    std::vector<Vertex> vv_indices_;
+    std::vector<Edge> ve_indices_;
+
+    // vertex -> face
+    std::vector<IndexType> vf_offsets_;
+    std::vector<Face> vf_indices_;
+
+    // face -> vertex
+    std::vector<IndexType> fv_offsets_;
+    std::vector<Vertex> fv_indices_;
+};
+
+//=============================================================================
+//!@}
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -0,0 +1,275 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/algorithms/SurfaceClustering.h>
+
+#include <algorithm>
+#include <cmath>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+namespace {
+
+// computes the bounding box of the streamed vertices
+class BoundsSink : public SurfaceMeshSink
+{
+public:
+    BoundsSink() : bmin(0, 0, 0), bmax(0, 0, 0), empty(true) {}
+
+    bool vertices(const std::vector<Point>& points) override
+    {
+        for (const auto& p : points)
+        {
+            bmin = empty ? p : min(bmin, p);
+            bmax = empty ? p : max(bmax, p);
+            empty = false;
+        }
+        return true;
+    }
+
+    bool faces(const std::vector<IndexType>&,
+               const std::vector<IndexType>&) override
+    {
+        return true;
+    }
+
+    Point bmin, bmax;
+    bool empty;
+};
+
+} // namespace
+
+//=============================================================================
+
+SurfaceClustering::SurfaceClustering(const BoundingBox& bounds,
+                                     unsigned int resolution)
+{
+    BoundingBox bb = bounds;
+    origin_ = bb.min();
+
+    const Point extent = bb.is_empty() ? Point(0, 0, 0) : bb.max() - bb.min();
+    const Scalar length = std::max(extent[0], std::max(extent[1], extent[2]));
+    resolution = std::max(resolution, 1u);
+    cell_size_ = length > 0 ? length / resolution : Scalar(1);
+
+    for (int i = 0; i < 3; ++i)
+        resolution_[i] = std::min(
+            (unsigned long long)(extent[i] / cell_size_) + 1,
+            (unsigned long long)resolution);
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceClustering::begin(size_t n_vertices, size_t)
+{
+    points_.clear();
+    vertex_cluster_.clear();
+    cells_.clear();
+    cluster_cell_.clear();
+    clusters_.clear();
+    triangles_.clear();
+    edges_.clear();
+    mesh_.clear();
+
+    points_.reserve(n_vertices);
+    vertex_cluster_.reserve(n_vertices);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceClustering::vertices(const std::vector<Point>& points)
+{
+    for (const auto& p : points)
+    {
+        points_.push_back(p);
+        vertex_cluster_.push_back(cluster(p));
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceClustering::faces(const std::vector<IndexType>& indices,
+                              const std::vector<IndexType>& face_sizes)
+{
+    size_t offset = 0;
+    const size_t n_faces =
+        face_sizes.empty() ? indices.size() / 3 : face_sizes.size();
+    for (size_t i = 0; i < n_faces; ++i)
+    {
+        const size_t n = face_sizes.empty() ? 3 : face_sizes[i];
+        if (offset + n > indices.size())
+            break;
+
+        // tessellate the face into triangles
+        for (size_t j = 2; j < n; ++j)
+            add_triangle(indices[offset], indices[offset + j - 1],
+                         indices[offset + j]);
+        offset += n;
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceClustering::end()
+{
+    // one vertex for each cluster used by a triangle
+    std::vector<IndexType> vertex(clusters_.size(), PMP_MAX_INDEX);
+    std::vector<Point> positions;
+    for (auto& c : triangles_)
+    {
+        if (vertex[c] == PMP_MAX_INDEX)
+        {
+            vertex[c] = IndexType(positions.size());
+            positions.push_back(position(c));
+        }
+        c = vertex[c];
+    }
+
+    mesh_.build_from_indices(positions, triangles_);
+
+    // free memory
+    std::vector<Point>().swap(points_);
+    std::vector<IndexType>().swap(vertex_cluster_);
+    std::unordered_map<unsigned long long, IndexType>().swap(cells_);
+    std::vector<unsigned long long>().swap(cluster_cell_);
+    std::vector<Cluster>().swap(clusters_);
+    std::vector<IndexType>().swap(triangles_);
+    edges_.clear();
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+IndexType SurfaceClustering::cluster(const Point& p)
+{
+    unsigned long long cell = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+        const Scalar x = std::floor((p[i] - origin_[i]) / cell_size_);
+        const unsigned long long j =
+            x <= 0 ? 0
+                   : std::min((unsigned long long)x, resolution_[i] - 1);
+        cell = cell * resolution_[i] + j;
+    }
+
+    auto it = cells_.find(cell);
+    if (it != cells_.end())
+        return it->second;
+
+    const IndexType c = IndexType(clusters_.size());
+    cells_[cell] = c;
+    cluster_cell_.push_back(cell);
+    clusters_.push_back(Cluster());
+    return c;
+}
+
+//-----------------------------------------------------------------------------
+
+Point SurfaceClustering::position(IndexType c) const
+{
+    const Cluster& cluster = clusters_[c];
+    const Point mean(cluster.sum / double(cluster.count));
+
+    // the minimizer of the quadric, if it lies within the cell
+    Point p;
+    if (!cluster.quadric.minimizer(p))
+        return mean;
+
+    unsigned long long cell = cluster_cell_[c];
+    for (int i = 2; i >= 0; --i)
+    {
+        const Scalar lower =
+            origin_[i] + Scalar(cell % resolution_[i]) * cell_size_;
+        cell /= resolution_[i];
+        if (p[i] < lower || p[i] > lower + cell_size_)
+            return mean;
+    }
+    return p;
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceClustering::add_triangle(IndexType a, IndexType b, IndexType c)
+{
+    if (a >= points_.size() || b >= points_.size() || c >= points_.size())
+        return;
+
+    const IndexType ca = vertex_cluster_[a];
+    const IndexType cb = vertex_cluster_[b];
+    const IndexType cc = vertex_cluster_[c];
+
+    // the vertices contribute to their cluster's position
+    for (auto v : {a, b, c})
+    {
+        clusters_[vertex_cluster_[v]].sum += dvec3(points_[v]);
+        clusters_[vertex_cluster_[v]].count += 1;
+    }
+
+    // area weighted quadric of the triangle's plane
+    Normal n = cross(points_[b] - points_[a], points_[c] - points_[a]);
+    const Scalar area = norm(n);
+    if (area > 0)
+    {
+        Quadric q(n / area, points_[a]);
+        q *= 0.5 * area;
+        clusters_[ca].quadric += q;
+        if (cb != ca)
+            clusters_[cb].quadric += q;
+        if (cc != ca && cc != cb)
+            clusters_[cc].quadric += q;
+    }
+
+    // triangles within less than three cells degenerate
+    if (ca == cb || cb == cc || cc == ca)
+        return;
+
+    // avoid duplicate triangles and complex edges
+    const std::pair<IndexType, IndexType> e[3] = {
+        std::make_pair(ca, cb), std::make_pair(cb, cc),
+        std::make_pair(cc, ca)};
+    for (const auto& edge : e)
+        if (edges_.count(edge))
+            return;
+    for (const auto& edge : e)
+        edges_.insert(edge);
+
+    triangles_.push_back(ca);
+    triangles_.push_back(cb);
+    triangles_.push_back(cc);
+}
+
+//=============================================================================
+
+bool simplify_clustering(const std::string& filename, SurfaceMesh& mesh,
+                         unsigned int resolution)
+{
+    BoundsSink bounds;
+    if (!read_stream(filename, bounds))
+        return false;
+
+    SurfaceClustering clustering(BoundingBox(bounds.bmin, bounds.bmax),
+                                 resolution);
+    if (!read_stream(filename, clustering))
+        return false;
+
+    mesh = std::move(clustering.mesh());
+    return true;
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
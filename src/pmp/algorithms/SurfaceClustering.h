@@ -0,0 +1,130 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <pmp/BoundingBox.h>
+#include <pmp/SurfaceMesh.h>
+#include <pmp/SurfaceMeshStream.h>
+
+#include <pmp/algorithms/Quadric.h>
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \addtogroup algorithms algorithms
+//! @{
+
+//=============================================================================
+
+//! \brief Out-of-core mesh simplification by vertex clustering.
+//! \details Simplifies meshes that do not fit into memory while they are
+//! streamed by read_stream(). The bounding box is divided into a uniform
+//! grid of cubic cells, and all vertices within a cell are merged into one
+//! vertex placed at the minimum of the cell's error quadric. Triangles
+//! spanning three different cells are kept, all others degenerate. See
+//! \cite lindstrom_2000_out for details. Each cell is simplified
+//! independently, so there are no seams to be stitched. Besides the result,
+//! only the input positions and one cell index per input vertex are kept in
+//! memory, which is a small fraction of a SurfaceMesh of the input. The
+//! result can be further refined in memory by SurfaceSimplification. Usage:
+//! \code
+//! SurfaceClustering clustering(bounds, 1000);
+//! read_stream("scan.ply", clustering);
+//! SurfaceMesh& result = clustering.mesh();
+//! \endcode
+//! \sa simplify_clustering()
+class SurfaceClustering : public SurfaceMeshSink
+{
+public:
+    //! \brief Cluster the vertices within \p bounds.
+    //! \details The longest side of \p bounds is divided into \p resolution
+    //! cells. Vertices outside of \p bounds are assigned to the nearest cell.
+    SurfaceClustering(const BoundingBox& bounds, unsigned int resolution);
+
+    bool begin(size_t n_vertices, size_t n_faces) override;
+    bool vertices(const std::vector<Point>& points) override;
+    bool faces(const std::vector<IndexType>& indices,
+               const std::vector<IndexType>& face_sizes) override;
+    bool end() override;
+
+    //! the simplified mesh, built by end()
+    SurfaceMesh& mesh() { return mesh_; }
+
+private:
+    // the accumulated data of a cell
+    struct Cluster
+    {
+        Cluster() : sum(0, 0, 0), count(0) {}
+
+        Quadric quadric;
+        dvec3 sum;
+        size_t count;
+    };
+
+    // hash of a directed edge between two clusters
+    struct EdgeHash
+    {
+        size_t operator()(const std::pair<IndexType, IndexType>& e) const
+        {
+            return std::hash<IndexType>()(e.first) * 31 +
+                   std::hash<IndexType>()(e.second);
+        }
+    };
+
+    // the cluster of the cell containing p
+    IndexType cluster(const Point& p);
+
+    // the position of the vertex representing cluster c
+    Point position(IndexType c) const;
+
+    // add the triangle of the input vertices a, b, c
+    void add_triangle(IndexType a, IndexType b, IndexType c);
+
+    Point origin_;
+    Scalar cell_size_;
+    unsigned long long resolution_[3];
+
+    // the input positions and the cluster of each input vertex
+    std::vector<Point> points_;
+    std::vector<IndexType> vertex_cluster_;
+
+    // the clusters of the occupied cells
+    std::unordered_map<unsigned long long, IndexType> cells_;
+    std::vector<unsigned long long> cluster_cell_;
+    std::vector<Cluster> clusters_;
+
+    // the triangles between clusters, and their edges
+    std::vector<IndexType> triangles_;
+    std::unordered_set<std::pair<IndexType, IndexType>, EdgeHash> edges_;
+
+    SurfaceMesh mesh_;
+};
+
+//! \brief Simplify the mesh file \p filename into \p mesh by vertex
+//! clustering without loading it.
+//! \details Reads the file twice with read_stream(), first to compute its
+//! bounding box, then to cluster its vertices, see SurfaceClustering.
+//! \return false if the file cannot be read
+bool simplify_clustering(const std::string& filename, SurfaceMesh& mesh,
+                         unsigned int resolution);
+
+//=============================================================================
+//! @}
+//=============================================================================
+} // namespace pmp
+//=============================================================================
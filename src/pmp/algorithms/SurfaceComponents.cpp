@@ -0,0 +1,187 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/algorithms/SurfaceComponents.h>
+#include <pmp/Parallel.h>
+
+#include <atomic>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+namespace {
+
+typedef std::vector<std::atomic<IndexType>> Forest;
+
+// find the root of x, halving the path to it
+IndexType find(Forest& parent, IndexType x)
+{
+    IndexType p = parent[x].load();
+    while (p != x)
+    {
+        IndexType expected = p;
+        const IndexType grandparent = parent[p].load();
+        parent[x].compare_exchange_weak(expected, grandparent);
+        x = grandparent;
+        p = parent[x].load();
+    }
+    return x;
+}
+
+// link the roots of a and b, always the larger index below the smaller one,
+// such that each root is the smallest index of its tree
+void unite(Forest& parent, IndexType a, IndexType b)
+{
+    while (true)
+    {
+        a = find(parent, a);
+        b = find(parent, b);
+        if (a == b)
+            return;
+        if (a < b)
+            std::swap(a, b);
+        IndexType expected = a;
+        if (parent[a].compare_exchange_strong(expected, b))
+            return;
+    }
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+SurfaceComponents::SurfaceComponents(SurfaceMesh& mesh) : mesh_(mesh)
+{
+    vcomponent_ = mesh_.vertex_property<IndexType>("v:component");
+    fcomponent_ = mesh_.face_property<IndexType>("f:component");
+}
+
+//-----------------------------------------------------------------------------
+
+size_t SurfaceComponents::label()
+{
+    const size_t n = mesh_.vertices_size();
+    Forest parent(n);
+    parallel_for(0, n, [&](size_t i) { parent[i].store(IndexType(i)); });
+
+    parallel_for(mesh_.edges(), [&](Edge e) {
+        unite(parent, mesh_.vertex(e, 0).idx(), mesh_.vertex(e, 1).idx());
+    });
+
+    // number the roots in index order
+    std::vector<IndexType> id(n, PMP_MAX_INDEX);
+    IndexType n_components = 0;
+    for (auto v : mesh_.vertices())
+    {
+        if (parent[v.idx()].load() == v.idx())
+            id[v.idx()] = n_components++;
+    }
+
+    parallel_for(mesh_.vertices(), [&](Vertex v) {
+        vcomponent_[v] = id[find(parent, v.idx())];
+    });
+    parallel_for(mesh_.faces(), [&](Face f) {
+        fcomponent_[f] = vcomponent_[mesh_.to_vertex(mesh_.halfedge(f))];
+    });
+
+    n_faces_.assign(n_components, 0);
+    n_vertices_.assign(n_components, 0);
+    for (auto v : mesh_.vertices())
+        ++n_vertices_[vcomponent_[v]];
+    for (auto f : mesh_.faces())
+        ++n_faces_[fcomponent_[f]];
+
+    return n_components;
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceComponents::extract(IndexType c, SurfaceMesh& result) const
+{
+    std::vector<IndexType> local(mesh_.vertices_size(), PMP_MAX_INDEX);
+    std::vector<Vertex> vertices;
+    std::vector<Point> positions;
+    for (auto v : mesh_.vertices())
+    {
+        if (vcomponent_[v] == c)
+        {
+            local[v.idx()] = positions.size();
+            vertices.push_back(v);
+            positions.push_back(mesh_.position(v));
+        }
+    }
+
+    std::vector<Face> faces;
+    std::vector<IndexType> indices, face_sizes;
+    for (auto f : mesh_.faces())
+    {
+        if (fcomponent_[f] != c)
+            continue;
+        faces.push_back(f);
+        IndexType size = 0;
+        for (auto v : mesh_.vertices(f))
+        {
+            indices.push_back(local[v.idx()]);
+            ++size;
+        }
+        face_sizes.push_back(size);
+    }
+
+    if (!result.build_from_indices(positions, indices, face_sizes))
+    {
+        std::cerr << "SurfaceComponents: component " << c
+                  << " is not manifold" << std::endl;
+        return false;
+    }
+    result.copy_properties(mesh_, vertices, faces);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+size_t SurfaceComponents::delete_small_components(size_t min_faces)
+{
+    label();
+
+    std::vector<char> small(n_components(), 0);
+    size_t n_small = 0;
+    for (IndexType c = 0; c < n_components(); ++c)
+    {
+        if (n_faces_[c] < min_faces)
+        {
+            small[c] = 1;
+            ++n_small;
+        }
+    }
+    if (n_small == 0)
+        return 0;
+
+    // deleting the faces also deletes their then isolated vertices
+    for (auto f : mesh_.faces())
+    {
+        if (small[fcomponent_[f]])
+            mesh_.delete_face(f);
+    }
+    for (auto v : mesh_.vertices())
+    {
+        if (small[vcomponent_[v]])
+            mesh_.delete_vertex(v);
+    }
+    mesh_.garbage_collection();
+
+    label();
+    return n_small;
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
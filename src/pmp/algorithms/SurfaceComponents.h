@@ -0,0 +1,81 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <pmp/SurfaceMesh.h>
+
+#include <vector>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \addtogroup algorithms algorithms
+//! @{
+
+//=============================================================================
+
+//! \brief Label the connected components of a mesh.
+//! \details Vertices connected by edges are merged in parallel by a
+//! lock-free union-find. Components are numbered in the order of their
+//! smallest vertex index, independently of the number of threads, and stored
+//! in the properties "v:component" and "f:component". Isolated vertices form
+//! components without faces. Usage, e.g., to remove small floating pieces of
+//! a scan:
+//! \code
+//! SurfaceComponents components(mesh);
+//! components.delete_small_components(100);
+//! \endcode
+class SurfaceComponents
+{
+public:
+    //! Construct with the mesh to be analyzed.
+    SurfaceComponents(SurfaceMesh& mesh);
+
+    //! \brief Label the components.
+    //! \return the number of components
+    size_t label();
+
+    //! the number of components of the last label()
+    size_t n_components() const { return n_faces_.size(); }
+
+    //! the number of faces of component \p c
+    size_t n_faces(IndexType c) const { return n_faces_[c]; }
+
+    //! the number of vertices of component \p c
+    size_t n_vertices(IndexType c) const { return n_vertices_[c]; }
+
+    //! \brief Copy the faces of component \p c to \p result.
+    //! \details Replaces \p result. The vertices and faces keep the order of
+    //! their indices and their properties.
+    //! \return whether all faces could be added
+    bool extract(IndexType c, SurfaceMesh& result) const;
+
+    //! \brief Delete the components with less than \p min_faces faces.
+    //! \details Calls garbage_collection() once after deleting all of them
+    //! and labels the remaining components.
+    //! \return the number of deleted components
+    size_t delete_small_components(size_t min_faces);
+
+private:
+    SurfaceMesh& mesh_;
+    VertexProperty<IndexType> vcomponent_;
+    FaceProperty<IndexType> fcomponent_;
+    std::vector<size_t> n_faces_;
+    std::vector<size_t> n_vertices_;
+};
+
+//=============================================================================
+//! @}
+//=============================================================================
+} // namespace pmp
+//=============================================================================
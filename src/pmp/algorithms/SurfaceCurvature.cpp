@@ -8,8 +8,16 @@
 //=============================================================================
 
 #include <pmp/algorithms/SurfaceCurvature.h>
+#include <pmp/algorithms/GeometryCache.h>
+#include <pmp/algorithms/SurfaceAdjacency.h>
 #include <pmp/algorithms/SurfaceNormals.h>
 #include <pmp/MatVec.h>
+#include <pmp/Parallel.h>
+
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 //=============================================================================
 
@@ -17,6 +25,232 @@ namespace pmp {
 
 //=============================================================================
 
+namespace {
+
+// minimum and maximum curvature of an interior vertex v from its mean and
+// Gauss curvature, cotan(e) gives the cotan weight of edge e
+template <class CotanWeight>
+void mean_gauss_curvature(const SurfaceMesh& mesh, Vertex v, Scalar area,
+                          CotanWeight cotan, Scalar& kmin, Scalar& kmax)
+{
+    Point laplace(0.0);
+    Scalar sum_weights = 0.0;
+    Scalar sum_angles = 0.0;
+    const Point p0 = mesh.position(v);
+
+    // Laplace & angle sum
+    for (auto vh : mesh.halfedges(v))
+    {
+        Point p1 = mesh.position(mesh.to_vertex(vh));
+        Point p2 =
+            mesh.position(mesh.to_vertex(mesh.ccw_rotated_halfedge(vh)));
+
+        const Scalar weight = cotan(mesh.edge(vh));
+        sum_weights += weight;
+        laplace += weight * p1;
+
+        p1 -= p0;
+        p1.normalize();
+        p2 -= p0;
+        p2.normalize();
+        sum_angles += acos(clamp_cos(dot(p1, p2)));
+    }
+    laplace -= sum_weights * mesh.position(v);
+    laplace /= Scalar(2.0) * area;
+
+    const Scalar mean = Scalar(0.5) * norm(laplace);
+    const Scalar gauss = (2.0 * M_PI - sum_angles) / area;
+
+    const Scalar s = sqrt(std::max(Scalar(0.0), mean * mean - gauss));
+    kmin = mean - s;
+    kmax = mean + s;
+}
+
+// dihedralAngle*edge_length*edge*edge^T of edge e, normal(f) gives the
+// normal of face f
+template <class FaceNormal>
+dmat3 edge_tensor(const SurfaceMesh& mesh, Edge e, FaceNormal normal)
+{
+    dmat3 t(0.0);
+    auto h0 = mesh.halfedge(e, 0);
+    auto h1 = mesh.halfedge(e, 1);
+    auto f0 = mesh.face(h0);
+    auto f1 = mesh.face(h1);
+    if (f0.is_valid() && f1.is_valid())
+    {
+        const dvec3 n0 = normal(f0);
+        const dvec3 n1 = normal(f1);
+        dvec3 ev = (dvec3)mesh.position(mesh.to_vertex(h0));
+        ev -= (dvec3)mesh.position(mesh.to_vertex(h1));
+        double l = norm(ev);
+        ev /= l;
+        l *= 0.5; // only consider half of the edge (matchig Voronoi area)
+        const double beta = atan2(dot(cross(n0, n1), ev), dot(n0, n1));
+        ev *= sqrt(l);
+
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j)
+                t(i, j) = beta * ev[i] * ev[j];
+    }
+    return t;
+}
+
+// minimum and maximum curvature of vertex v from the curvature tensor of
+// its one-ring or two-ring, tensor(e) and area(v) give the edge tensors and
+// Voronoi areas
+template <class EdgeTensor, class VertexArea>
+void tensor_curvature(const SurfaceMesh& mesh, Vertex v,
+                      bool two_ring_neighborhood, EdgeTensor tensor,
+                      VertexArea area, double& kmin, double& kmax)
+{
+    double A = 0.0;
+    dmat3 t(0.0);
+
+    // accumulate tensor from dihedral angles around vertex vv
+    auto accumulate = [&](Vertex vv) {
+        for (auto hv : mesh.halfedges(vv))
+            t += tensor(mesh.edge(hv));
+        A += area(vv);
+    };
+
+    // one-ring or two-ring neighborhood?
+    accumulate(v);
+    if (two_ring_neighborhood)
+    {
+        for (auto vv : mesh.vertices(v))
+            accumulate(vv);
+    }
+
+    // normalize tensor by accumulated
+    t /= A;
+
+    // Eigen-decomposition
+    double eval1, eval2, eval3;
+    dvec3 evec1, evec2, evec3;
+    bool ok = symmetric_eigendecomposition(t, eval1, eval2, eval3, evec1,
+                                           evec2, evec3);
+    if (ok)
+    {
+        // curvature values:
+        //   normal vector -> eval with smallest absolute value
+        //   evals are sorted in decreasing order
+        const double a1 = fabs(eval1);
+        const double a2 = fabs(eval2);
+        const double a3 = fabs(eval3);
+        if (a1 < a2)
+        {
+            if (a1 < a3)
+            {
+                // e1 is normal
+                kmax = eval2;
+                kmin = eval3;
+            }
+            else
+            {
+                // e3 is normal
+                kmax = eval1;
+                kmin = eval2;
+            }
+        }
+        else
+        {
+            if (a2 < a3)
+            {
+                // e2 is normal
+                kmax = eval1;
+                kmin = eval3;
+            }
+            else
+            {
+                // e3 is normal
+                kmax = eval1;
+                kmin = eval2;
+            }
+        }
+    }
+}
+
+// the states of a memoized value
+enum : unsigned char
+{
+    Missing,
+    Computing,
+    Ready
+};
+
+// the value memoized in (kmin, kmax), computed by compute() if it is not
+// ready yet. The thread that claims the value computes and stores it, others
+// wait until it is ready, such that each value is computed only once. If
+// compute() throws, the value is released again, and a waiting thread claims
+// it. compute() must not wait for a value of the same kind, which the
+// smoothed values, depending only on the values before smoothing, do not.
+template <class Compute>
+Vector<Scalar, 2> memoize(std::atomic<unsigned char>& state, Scalar& kmin,
+                          Scalar& kmax, Compute compute)
+{
+    while (true)
+    {
+        unsigned char expected = Missing;
+        if (state.compare_exchange_strong(expected, Computing,
+                                          std::memory_order_acquire))
+        {
+            Vector<Scalar, 2> k;
+            try
+            {
+                k = compute();
+            }
+            catch (...)
+            {
+                state.store(Missing, std::memory_order_release);
+                throw;
+            }
+            kmin = k[0];
+            kmax = k[1];
+            state.store(Ready, std::memory_order_release);
+            return k;
+        }
+        if (expected == Ready)
+            return Vector<Scalar, 2>(kmin, kmax);
+        std::this_thread::yield();
+    }
+}
+
+} // namespace
+
+//=============================================================================
+
+// the settings of the lazy analysis and the memoized values, which are
+// claimed by an atomic state before they are computed, such that concurrent
+// queries neither compute nor write the same value twice
+struct SurfaceCurvature::LazyState
+{
+    LazyState(size_t n, unsigned int steps, bool use_tensor, bool two_ring)
+        : smoothing_steps(steps),
+          tensor(use_tensor),
+          two_ring_neighborhood(two_ring),
+          state(n),
+          raw_state(steps ? n : 0),
+          raw_curvature(steps ? n : 0)
+    {
+        for (auto& s : state)
+            s.store(Missing);
+        for (auto& s : raw_state)
+            s.store(Missing);
+    }
+
+    unsigned int smoothing_steps;
+    bool tensor;
+    bool two_ring_neighborhood;
+
+    // the final values are stored in the curvature properties, the values
+    // before smoothing only if there is smoothing
+    std::vector<std::atomic<unsigned char>> state;
+    std::vector<std::atomic<unsigned char>> raw_state;
+    std::vector<Curvature> raw_curvature;
+};
+
+//=============================================================================
+
 SurfaceCurvature::SurfaceCurvature(SurfaceMesh& mesh) : mesh_(mesh)
 {
     min_curvature_ = mesh_.add_vertex_property<Scalar>("curv:min");
@@ -35,82 +269,52 @@ SurfaceCurvature::~SurfaceCurvature()
 
 void SurfaceCurvature::analyze(unsigned int post_smoothing_steps)
 {
-    Scalar kmin, kmax, mean, gauss;
-    Scalar area, sum_angles;
-    Scalar weight, sum_weights;
-    Point p0, p1, p2, laplace;
+    lazy_.reset();
+    const GeometryCache* cache = GeometryCache::get(mesh_);
 
     // cotan weight per edge
     auto cotan = mesh_.add_edge_property<double>("curv:cotan");
-    for (auto e : mesh_.edges())
-        cotan[e] = cotan_weight(mesh_, e);
+    parallel_for(mesh_.edges(), [&](Edge e) {
+        cotan[e] = cache ? cache->cotan_weight(e) : cotan_weight(mesh_, e);
+    });
 
     // Voronoi area per vertex
     // Laplace per vertex
     // angle sum per vertex
     // -> mean, Gauss -> min, max curvature
-    for (auto v : mesh_.vertices())
-    {
-        kmin = kmax = 0.0;
+    parallel_for(mesh_.vertices(), [&](Vertex v) {
+        Scalar kmin = 0.0, kmax = 0.0;
 
         if (!mesh_.is_isolated(v) && !mesh_.is_boundary(v))
         {
-            laplace = Point(0.0);
-            sum_weights = 0.0;
-            sum_angles = 0.0;
-            p0 = mesh_.position(v);
-
             // Voronoi area
-            area = voronoi_area(mesh_, v);
-
-            // Laplace & angle sum
-            for (auto vh : mesh_.halfedges(v))
-            {
-                p1 = mesh_.position(mesh_.to_vertex(vh));
-                p2 = mesh_.position(
-                    mesh_.to_vertex(mesh_.ccw_rotated_halfedge(vh)));
-
-                weight = cotan[mesh_.edge(vh)];
-                sum_weights += weight;
-                laplace += weight * p1;
-
-                p1 -= p0;
-                p1.normalize();
-                p2 -= p0;
-                p2.normalize();
-                sum_angles += acos(clamp_cos(dot(p1, p2)));
-            }
-            laplace -= sum_weights * mesh_.position(v);
-            laplace /= Scalar(2.0) * area;
-
-            mean = Scalar(0.5) * norm(laplace);
-            gauss = (2.0 * M_PI - sum_angles) / area;
+            const Scalar area =
+                cache ? cache->voronoi_area(v) : voronoi_area(mesh_, v);
 
-            const Scalar s = sqrt(std::max(Scalar(0.0), mean * mean - gauss));
-            kmin = mean - s;
-            kmax = mean + s;
+            mean_gauss_curvature(mesh_, v, area,
+                                 [&](Edge e) { return Scalar(cotan[e]); },
+                                 kmin, kmax);
         }
 
         min_curvature_[v] = kmin;
         max_curvature_[v] = kmax;
-    }
+    });
 
     // boundary vertices: interpolate from interior neighbors
-    for (auto v : mesh_.vertices())
-    {
+    parallel_for(mesh_.vertices(), [&](Vertex v) {
         if (mesh_.is_boundary(v))
         {
-            kmin = kmax = sum_weights = 0.0;
+            Scalar kmin = 0.0, kmax = 0.0, sum_weights = 0.0;
 
             for (auto vh : mesh_.halfedges(v))
             {
-                v = mesh_.to_vertex(vh);
-                if (!mesh_.is_boundary(v))
+                const Vertex vv = mesh_.to_vertex(vh);
+                if (!mesh_.is_boundary(vv))
                 {
-                    weight = cotan[mesh_.edge(vh)];
+                    const Scalar weight = cotan[mesh_.edge(vh)];
                     sum_weights += weight;
-                    kmin += weight * min_curvature_[v];
-                    kmax += weight * max_curvature_[v];
+                    kmin += weight * min_curvature_[vv];
+                    kmax += weight * max_curvature_[vv];
                 }
             }
 
@@ -123,7 +327,7 @@ void SurfaceCurvature::analyze(unsigned int post_smoothing_steps)
             min_curvature_[v] = kmin;
             max_curvature_[v] = kmax;
         }
-    }
+    });
 
     // clean-up properties
     mesh_.remove_edge_property(cotan);
@@ -137,202 +341,301 @@ void SurfaceCurvature::analyze(unsigned int post_smoothing_steps)
 void SurfaceCurvature::analyze_tensor(unsigned int post_smoothing_steps,
                                       bool two_ring_neighborhood)
 {
+    lazy_.reset();
     auto area = mesh_.add_vertex_property<double>("curv:area", 0.0);
     auto normal = mesh_.add_face_property<dvec3>("curv:normal");
-    auto evec = mesh_.add_edge_property<dvec3>("curv:evec", dvec3(0, 0, 0));
-    auto angle = mesh_.add_edge_property<double>("curv:angle", 0.0);
+    auto tensor = mesh_.add_edge_property<dmat3>("curv:tensor", dmat3(0.0));
 
-    dvec3 p0, p1, n0, n1, ev;
-    double l, A, beta, a1, a2, a3;
-    dmat3 tensor;
+    // precompute Voronoi area per vertex
+    const GeometryCache* cache = GeometryCache::get(mesh_);
+    parallel_for(mesh_.vertices(), [&](Vertex v) {
+        area[v] = cache ? cache->voronoi_area(v) : voronoi_area(mesh_, v);
+    });
 
-    double eval1, eval2, eval3, kmin, kmax;
-    dvec3 evec1, evec2, evec3;
+    // precompute face normals
+    parallel_for(mesh_.faces(), [&](Face f) {
+        normal[f] = (dvec3)SurfaceNormals::compute_face_normal(mesh_, f);
+    });
 
-    std::vector<Vertex> neighborhood;
-    neighborhood.reserve(15);
+    // precompute dihedralAngle*edge_length*edge*edge^T per edge, such that
+    // the vertices only sum up the tensors of their incident edges
+    parallel_for(mesh_.edges(), [&](Edge e) {
+        tensor[e] = edge_tensor(mesh_, e, [&](Face f) { return normal[f]; });
+    });
 
-    // precompute Voronoi area per vertex
-    for (auto v : mesh_.vertices())
-    {
-        area[v] = voronoi_area(mesh_, v);
-    }
+    // compute curvature tensor for each vertex
+    parallel_for(mesh_.vertices(), [&](Vertex v) {
+        double kmin = 0.0;
+        double kmax = 0.0;
 
-    // precompute face normals
-    for (auto f : mesh_.faces())
+        if (!mesh_.is_isolated(v))
+        {
+            tensor_curvature(
+                mesh_, v, two_ring_neighborhood,
+                [&](Edge e) -> const dmat3& { return tensor[e]; },
+                [&](Vertex vv) { return area[vv]; }, kmin, kmax);
+        }
+
+        assert(kmin <= kmax);
+
+        min_curvature_[v] = kmin;
+        max_curvature_[v] = kmax;
+    });
+
+    // clean-up properties
+    mesh_.remove_vertex_property(area);
+    mesh_.remove_edge_property(tensor);
+    mesh_.remove_face_property(normal);
+
+    // smooth curvature values
+    smooth_curvatures(post_smoothing_steps);
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceCurvature::analyze_lazy(unsigned int post_smoothing_steps)
+{
+    lazy_.reset(new LazyState(mesh_.vertices_size(), post_smoothing_steps,
+                              false, false));
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceCurvature::analyze_tensor_lazy(unsigned int post_smoothing_steps,
+                                           bool two_ring_neighborhood)
+{
+    lazy_.reset(new LazyState(mesh_.vertices_size(), post_smoothing_steps,
+                              true, two_ring_neighborhood));
+}
+
+//-----------------------------------------------------------------------------
+
+SurfaceCurvature::Curvature SurfaceCurvature::lazy_curvature(Vertex v) const
+{
+    if (!lazy_->smoothing_steps)
+        return raw_curvature(v);
+
+    VertexProperty<Scalar> kmin(min_curvature_), kmax(max_curvature_);
+    return memoize(lazy_->state[v.idx()], kmin[v], kmax[v],
+                   [&]() { return compute_smoothed_curvature(v); });
+}
+
+//-----------------------------------------------------------------------------
+
+SurfaceCurvature::Curvature SurfaceCurvature::raw_curvature(Vertex v) const
+{
+    auto compute = [&]() { return compute_raw_curvature(v); };
+
+    // without smoothing, the final values are the ones before smoothing
+    if (!lazy_->smoothing_steps)
     {
-        normal[f] = (dvec3)SurfaceNormals::compute_face_normal(mesh_, f);
+        VertexProperty<Scalar> kmin(min_curvature_), kmax(max_curvature_);
+        return memoize(lazy_->state[v.idx()], kmin[v], kmax[v], compute);
     }
 
-    // precompute dihedralAngle*edge_length*edge per edge
-    for (auto e : mesh_.edges())
+    Curvature& k = lazy_->raw_curvature[v.idx()];
+    return memoize(lazy_->raw_state[v.idx()], k[0], k[1], compute);
+}
+
+//-----------------------------------------------------------------------------
+
+SurfaceCurvature::Curvature
+SurfaceCurvature::compute_raw_curvature(Vertex v) const
+{
+    const GeometryCache* cache = GeometryCache::get(mesh_);
+    auto cotan = [&](Edge e) {
+        return cache ? cache->cotan_weight(e) : cotan_weight(mesh_, e);
+    };
+    auto area = [&](Vertex vv) {
+        return cache ? cache->voronoi_area(vv) : voronoi_area(mesh_, vv);
+    };
+
+    if (lazy_->tensor)
     {
-        auto h0 = mesh_.halfedge(e, 0);
-        auto h1 = mesh_.halfedge(e, 1);
-        auto f0 = mesh_.face(h0);
-        auto f1 = mesh_.face(h1);
-        if (f0.is_valid() && f1.is_valid())
+        double kmin = 0.0, kmax = 0.0;
+        if (!mesh_.is_isolated(v))
         {
-            n0 = normal[f0];
-            n1 = normal[f1];
-            ev = (dvec3)mesh_.position(mesh_.to_vertex(h0));
-            ev -= (dvec3)mesh_.position(mesh_.to_vertex(h1));
-            l = norm(ev);
-            ev /= l;
-            l *= 0.5; // only consider half of the edge (matchig Voronoi area)
-            angle[e] = atan2(dot(cross(n0, n1), ev), dot(n0, n1));
-            evec[e] = sqrt(l) * ev;
+            auto normal = [&](Face f) {
+                return (dvec3)SurfaceNormals::compute_face_normal(mesh_, f);
+            };
+            tensor_curvature(
+                mesh_, v, lazy_->two_ring_neighborhood,
+                [&](Edge e) { return edge_tensor(mesh_, e, normal); }, area,
+                kmin, kmax);
         }
+        return Curvature(kmin, kmax);
     }
 
-    // compute curvature tensor for each vertex
-    for (auto v : mesh_.vertices())
+    Scalar kmin = 0.0, kmax = 0.0;
+    if (!mesh_.is_boundary(v))
     {
-        kmin = 0.0;
-        kmax = 0.0;
-
         if (!mesh_.is_isolated(v))
+            mean_gauss_curvature(
+                mesh_, v, area(v), [&](Edge e) { return Scalar(cotan(e)); },
+                kmin, kmax);
+        return Curvature(kmin, kmax);
+    }
+
+    // boundary vertices: interpolate from interior neighbors
+    Scalar sum_weights = 0.0;
+    for (auto vh : mesh_.halfedges(v))
+    {
+        const Vertex vv = mesh_.to_vertex(vh);
+        if (!mesh_.is_boundary(vv))
         {
-            // one-ring or two-ring neighborhood?
-            neighborhood.clear();
-            neighborhood.push_back(v);
-            if (two_ring_neighborhood)
-            {
-                for (auto vv : mesh_.vertices(v))
-                    neighborhood.push_back(vv);
-            }
+            const Scalar weight = cotan(mesh_.edge(vh));
+            const Curvature k = raw_curvature(vv);
+            sum_weights += weight;
+            kmin += weight * k[0];
+            kmax += weight * k[1];
+        }
+    }
+    if (sum_weights)
+    {
+        kmin /= sum_weights;
+        kmax /= sum_weights;
+    }
+    return Curvature(kmin, kmax);
+}
 
-            A = 0.0;
-            tensor = dmat3(0.0);
+//-----------------------------------------------------------------------------
 
-            // compute tensor over vertex neighborhood stored in vertices
-            for (auto nit : neighborhood)
-            {
-                // accumulate tensor from dihedral angles around vertices
-                for (auto hv : mesh_.halfedges(nit))
-                {
-                    auto ee = mesh_.edge(hv);
-                    ev = evec[ee];
-                    beta = angle[ee];
-                    for (int i = 0; i < 3; ++i)
-                        for (int j = 0; j < 3; ++j)
-                            tensor(i, j) += beta * ev[i] * ev[j];
-                }
+SurfaceCurvature::Curvature
+SurfaceCurvature::compute_smoothed_curvature(Vertex v) const
+{
+    const unsigned int steps = lazy_->smoothing_steps;
+    auto vfeature = mesh_.get_vertex_property<bool>("v:feature");
+    const GeometryCache* cache = GeometryCache::get(mesh_);
+
+    // the vertices up to the distance steps, the first ring_end[i] of them
+    // up to the distance i
+    std::vector<Vertex> vertices(1, v);
+    std::unordered_map<IndexType, size_t> index;
+    index[v.idx()] = 0;
+    std::vector<size_t> ring_end(1, 1);
+    for (unsigned int i = 0; i < steps; ++i)
+    {
+        for (size_t j = i ? ring_end[i - 1] : 0; j < ring_end[i]; ++j)
+            for (auto vv : mesh_.vertices(vertices[j]))
+                if (index.insert(std::make_pair(vv.idx(), vertices.size()))
+                        .second)
+                    vertices.push_back(vv);
+        ring_end.push_back(vertices.size());
+    }
 
-                // accumulate area
-                A += area[nit];
-            }
+    std::vector<Curvature> values, smoothed(vertices.size());
+    values.reserve(vertices.size());
+    for (auto vv : vertices)
+        values.push_back(raw_curvature(vv));
 
-            // normalize tensor by accumulated
-            tensor /= A;
+    // Jacobi iterations as in smooth_curvatures(), each one on one ring less
+    for (unsigned int i = 1; i <= steps; ++i)
+    {
+        for (size_t j = 0; j < ring_end[steps - i]; ++j)
+        {
+            const Vertex vv = vertices[j];
+            Curvature k = values[j];
 
-            // Eigen-decomposition
-            bool ok = symmetric_eigendecomposition(tensor, eval1, eval2, eval3,
-                                                   evec1, evec2, evec3);
-            if (ok)
+            // don't smooth feature vertices
+            if (!vfeature || !vfeature[vv])
             {
-                // curvature values:
-                //   normal vector -> eval with smallest absolute value
-                //   evals are sorted in decreasing order
-                a1 = fabs(eval1);
-                a2 = fabs(eval2);
-                a3 = fabs(eval3);
-                if (a1 < a2)
+                Scalar sum_weights = 0.0, smin = 0.0, smax = 0.0;
+                for (auto h : mesh_.halfedges(vv))
                 {
-                    if (a1 < a3)
-                    {
-                        // e1 is normal
-                        kmax = eval2;
-                        kmin = eval3;
-                    }
-                    else
-                    {
-                        // e3 is normal
-                        kmax = eval1;
-                        kmin = eval2;
-                    }
-                }
-                else
-                {
-                    if (a2 < a3)
-                    {
-                        // e2 is normal
-                        kmax = eval1;
-                        kmin = eval3;
-                    }
-                    else
-                    {
-                        // e3 is normal
-                        kmax = eval1;
-                        kmin = eval2;
-                    }
+                    const Vertex tv = mesh_.to_vertex(h);
+
+                    // don't consider feature vertices (high curvature)
+                    if (vfeature && vfeature[tv])
+                        continue;
+
+                    const Edge e = mesh_.edge(h);
+                    const Scalar weight = std::max(
+                        0.0, cache ? cache->cotan_weight(e)
+                                   : cotan_weight(mesh_, e));
+                    const Curvature& kt = values[index[tv.idx()]];
+                    sum_weights += weight;
+                    smin += weight * kt[0];
+                    smax += weight * kt[1];
                 }
-            }
-        }
 
-        assert(kmin <= kmax);
+                if (sum_weights)
+                    k = Curvature(smin / sum_weights, smax / sum_weights);
+            }
 
-        min_curvature_[v] = kmin;
-        max_curvature_[v] = kmax;
+            smoothed[j] = k;
+        }
+        std::swap(values, smoothed);
     }
 
-    // clean-up properties
-    mesh_.remove_vertex_property(area);
-    mesh_.remove_edge_property(evec);
-    mesh_.remove_edge_property(angle);
-    mesh_.remove_face_property(normal);
-
-    // smooth curvature values
-    smooth_curvatures(post_smoothing_steps);
+    return values[0];
 }
 
 //-----------------------------------------------------------------------------
 
 void SurfaceCurvature::smooth_curvatures(unsigned int iterations)
 {
-    Scalar kmin, kmax;
-    Scalar weight, sum_weights;
+    if (!iterations)
+        return;
 
     // properties
     auto vfeature = mesh_.get_vertex_property<bool>("v:feature");
     auto cotan = mesh_.add_edge_property<double>("curv:cotan");
 
     // cotan weight per edge
-    for (auto e : mesh_.edges())
-    {
-        cotan[e] = cotan_weight(mesh_, e);
-    }
+    const GeometryCache* cache = GeometryCache::get(mesh_);
+    parallel_for(mesh_.edges(), [&](Edge e) {
+        cotan[e] = cache ? cache->cotan_weight(e) : cotan_weight(mesh_, e);
+    });
+
+    // flat one-rings for the smoothing iterations
+    SurfaceAdjacency adjacency(mesh_);
+
+    // Jacobi iterations, such that the vertices can be smoothed in parallel
+    std::vector<Scalar> min_curvature(mesh_.vertices_size());
+    std::vector<Scalar> max_curvature(mesh_.vertices_size());
 
     for (unsigned int i = 0; i < iterations; ++i)
     {
-        for (auto v : mesh_.vertices())
-        {
+        parallel_for(mesh_.vertices(), [&](Vertex v) {
+            Scalar kmin = min_curvature_[v];
+            Scalar kmax = max_curvature_[v];
+
             // don't smooth feature vertices
-            if (vfeature && vfeature[v])
-                continue;
+            if (!vfeature || !vfeature[v])
+            {
+                Scalar sum_weights = 0.0, smin = 0.0, smax = 0.0;
 
-            kmin = kmax = sum_weights = 0.0;
+                auto neighbors = adjacency.vertices(v);
+                auto edges = adjacency.edges(v);
+                for (size_t j = 0; j < neighbors.size(); ++j)
+                {
+                    auto tv = neighbors[j];
 
-            for (auto vh : mesh_.halfedges(v))
-            {
-                auto tv = mesh_.to_vertex(vh);
+                    // don't consider feature vertices (high curvature)
+                    if (vfeature && vfeature[tv])
+                        continue;
 
-                // don't consider feature vertices (high curvature)
-                if (vfeature && vfeature[tv])
-                    continue;
+                    const Scalar weight = std::max(0.0, cotan[edges[j]]);
+                    sum_weights += weight;
+                    smin += weight * min_curvature_[tv];
+                    smax += weight * max_curvature_[tv];
+                }
 
-                weight = std::max(0.0, cotan_weight(mesh_, mesh_.edge(vh)));
-                sum_weights += weight;
-                kmin += weight * min_curvature_[tv];
-                kmax += weight * max_curvature_[tv];
+                if (sum_weights)
+                {
+                    kmin = smin / sum_weights;
+                    kmax = smax / sum_weights;
+                }
             }
 
-            if (sum_weights)
-            {
-                min_curvature_[v] = kmin / sum_weights;
-                max_curvature_[v] = kmax / sum_weights;
-            }
-        }
+            min_curvature[v.idx()] = kmin;
+            max_curvature[v.idx()] = kmax;
+        });
+
+        parallel_for(mesh_.vertices(), [&](Vertex v) {
+            min_curvature_[v] = min_curvature[v.idx()];
+            max_curvature_[v] = max_curvature[v.idx()];
+        });
     }
 
     // remove property
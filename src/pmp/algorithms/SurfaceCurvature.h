@@ -12,6 +12,8 @@
 #include <pmp/SurfaceMesh.h>
 #include <pmp/algorithms/DifferentialGeometry.h>
 
+#include <memory>
+
 //=============================================================================
 
 namespace pmp {
@@ -26,7 +28,9 @@ namespace pmp {
 //! \brief Compute per-vertex curvature (min,max,mean,Gaussian).
 
 //! \details Curvature values for boundary vertices are interpolated from their
-//! interior neighbors. Curvature values can be smoothed. See
+//! interior neighbors. Curvature values can be smoothed. The lazy variants
+//! of the analysis compute the curvature of a vertex when it is first
+//! queried, e.g., for a few samples of a large mesh. See
 //! \cite meyer_2003_discrete and \cite cohen-steiner_2003_restricted for
 //! details.
 class SurfaceCurvature
@@ -47,28 +51,46 @@ public:
     void analyze_tensor(unsigned int post_smoothing_steps = 0,
                         bool two_ring_neighborhood = false);
 
+    //! \brief Prepare the curvature of analyze() for queries of single
+    //! vertices.
+    //! \details Nothing is computed up front. The first query of a vertex
+    //! computes its curvature from the vertices in \p post_smoothing_steps
+    //! rings around it, the curvature of each vertex before smoothing is
+    //! computed only once. Queries can be issued concurrently from several
+    //! threads. The mesh must not be changed while queried, and analyze()
+    //! or analyze_tensor() end the lazy mode.
+    void analyze_lazy(unsigned int post_smoothing_steps = 0);
+
+    //! \brief Prepare the curvature of analyze_tensor() for queries of
+    //! single vertices, see analyze_lazy().
+    void analyze_tensor_lazy(unsigned int post_smoothing_steps = 0,
+                             bool two_ring_neighborhood = false);
+
     //! return mean curvature
     Scalar mean_curvature(Vertex v) const
     {
-        return 0.5 * (min_curvature_[v] + max_curvature_[v]);
+        const Curvature k = curvature(v);
+        return 0.5 * (k[0] + k[1]);
     }
 
     //! return Gaussian curvature
     Scalar gauss_curvature(Vertex v) const
     {
-        return min_curvature_[v] * max_curvature_[v];
+        const Curvature k = curvature(v);
+        return k[0] * k[1];
     }
 
     //! return minimum (signed) curvature
-    Scalar min_curvature(Vertex v) const { return min_curvature_[v]; }
+    Scalar min_curvature(Vertex v) const { return curvature(v)[0]; }
 
     //! return maximum (signed) curvature
-    Scalar max_curvature(Vertex v) const { return max_curvature_[v]; }
+    Scalar max_curvature(Vertex v) const { return curvature(v)[1]; }
 
     //! return maximum absolute curvature
     Scalar max_abs_curvature(Vertex v) const
     {
-        return std::max(fabs(min_curvature_[v]), fabs(max_curvature_[v]));
+        const Curvature k = curvature(v);
+        return std::max(fabs(k[0]), fabs(k[1]));
     }
 
     //! convert (precomputed) mean curvature to 1D texture coordinates
@@ -81,6 +103,29 @@ public:
     void max_curvature_to_texture_coordinates() const;
 
 private:
+    //! minimum and maximum curvature
+    typedef Vector<Scalar, 2> Curvature;
+
+    //! the curvature of v, computed first in lazy mode
+    Curvature curvature(Vertex v) const
+    {
+        if (lazy_)
+            return lazy_curvature(v);
+        return Curvature(min_curvature_[v], max_curvature_[v]);
+    }
+
+    //! the memoized curvature of v in lazy mode
+    Curvature lazy_curvature(Vertex v) const;
+
+    //! the memoized curvature of v before smoothing in lazy mode
+    Curvature raw_curvature(Vertex v) const;
+
+    //! compute the curvature of v before smoothing
+    Curvature compute_raw_curvature(Vertex v) const;
+
+    //! compute the smoothed curvature of v
+    Curvature compute_smoothed_curvature(Vertex v) const;
+
     //! smooth curvature values
     void smooth_curvatures(unsigned int iterations);
 
@@ -91,6 +136,10 @@ private:
     SurfaceMesh& mesh_;
     VertexProperty<Scalar> min_curvature_;
     VertexProperty<Scalar> max_curvature_;
+
+    //! the settings and state of the lazy mode, if active
+    struct LazyState;
+    std::unique_ptr<LazyState> lazy_;
 };
 
 //=============================================================================
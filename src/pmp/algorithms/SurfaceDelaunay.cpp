@@ -0,0 +1,122 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/algorithms/SurfaceDelaunay.h>
+#include <pmp/algorithms/DifferentialGeometry.h>
+#include <pmp/algorithms/SurfaceNormals.h>
+
+#include <cmath>
+#include <queue>
+#include <utility>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+SurfaceDelaunay::SurfaceDelaunay(SurfaceMesh& mesh)
+    : mesh_(mesh), max_dihedral_angle_(1.0)
+{
+    points_ = mesh_.vertex_property<Point>("v:point");
+    efeature_ = mesh_.get_edge_property<bool>("e:feature");
+}
+
+//-----------------------------------------------------------------------------
+
+Scalar SurfaceDelaunay::violation(Edge e) const
+{
+    if (mesh_.is_boundary(e))
+        return 0.0;
+
+    Scalar angles = 0.0;
+    for (int i = 0; i < 2; ++i)
+    {
+        const Halfedge h = mesh_.halfedge(e, i);
+        const Point& p0 = points_[mesh_.from_vertex(h)];
+        const Point& p1 = points_[mesh_.to_vertex(h)];
+        const Point& p2 = points_[mesh_.to_vertex(mesh_.next_halfedge(h))];
+        angles += angle(p0 - p2, p1 - p2);
+    }
+    return angles - Scalar(M_PI);
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceDelaunay::is_flippable(Edge e) const
+{
+    if (efeature_ && efeature_[e])
+        return false;
+    if (!mesh_.is_flip_ok(e))
+        return false;
+
+    const Normal n0 = SurfaceNormals::compute_face_normal(
+        mesh_, mesh_.face(mesh_.halfedge(e, 0)));
+    const Normal n1 = SurfaceNormals::compute_face_normal(
+        mesh_, mesh_.face(mesh_.halfedge(e, 1)));
+    return dot(n0, n1) >= std::cos(max_dihedral_angle_ / 180.0 * M_PI);
+}
+
+//-----------------------------------------------------------------------------
+
+unsigned int SurfaceDelaunay::flip_edges(unsigned int max_flips)
+{
+    if (!mesh_.is_triangle_mesh())
+    {
+        std::cerr << "Not a triangle mesh!" << std::endl;
+        return 0;
+    }
+
+    // The queue may hold outdated entries of an edge, only the one matching
+    // its current violation is valid. A flip only changes the angles of the
+    // edges of its two triangles, which are evaluated again.
+    std::vector<Scalar> queued(mesh_.edges_size(), 0.0);
+    std::priority_queue<std::pair<Scalar, IndexType>> queue;
+
+    auto enqueue = [&](Edge e) {
+        const Scalar v = violation(e);
+        queued[e.idx()] = v;
+        if (v > tolerance())
+            queue.push(std::make_pair(v, e.idx()));
+    };
+
+    for (auto e : mesh_.edges())
+        enqueue(e);
+
+    unsigned int n_flips = 0;
+    while (!queue.empty() && n_flips < max_flips)
+    {
+        const Scalar v = queue.top().first;
+        const Edge e(queue.top().second);
+        queue.pop();
+        if (queued[e.idx()] != v)
+            continue;
+        queued[e.idx()] = 0.0;
+
+        if (!is_flippable(e))
+            continue;
+
+        mesh_.flip(e);
+        ++n_flips;
+
+        for (int i = 0; i < 2; ++i)
+        {
+            const Halfedge h = mesh_.halfedge(e, i);
+            enqueue(mesh_.edge(mesh_.next_halfedge(h)));
+            enqueue(mesh_.edge(mesh_.prev_halfedge(h)));
+        }
+        enqueue(e);
+    }
+
+    return n_flips;
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
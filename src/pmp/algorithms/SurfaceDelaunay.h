@@ -0,0 +1,71 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <pmp/SurfaceMesh.h>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \addtogroup algorithms algorithms
+//! @{
+
+//=============================================================================
+
+//! \brief Flip the edges of a triangle mesh towards a Delaunay triangulation.
+//! \details An edge is Delaunay if the angles opposite to it sum to at most
+//! pi, i.e., if its cotangent weight is non-negative. The edges violating
+//! this most are flipped first, and only the edges of the flipped triangles
+//! are tested again. Since a flip changes the surface, only edges whose
+//! dihedral angle is below a threshold are flipped, and feature edges are
+//! kept. The cotan Laplacian of the result has fewer negative weights and
+//! is better conditioned.
+class SurfaceDelaunay
+{
+public:
+    //! Construct with the triangle mesh to be modified.
+    SurfaceDelaunay(SurfaceMesh& mesh);
+
+    //! \brief Only flip edges with dihedral angle below \p angle degrees.
+    //! \details The default of 1 degree keeps the surface nearly unchanged.
+    void set_max_dihedral_angle(Scalar angle) { max_dihedral_angle_ = angle; }
+
+    //! \brief Flip non-Delaunay edges, at most \p max_flips of them.
+    //! \return The number of flips performed.
+    unsigned int flip_edges(unsigned int max_flips = 1000000);
+
+    //! \brief The amount by which the angles opposite to \p e exceed pi.
+    //! \details Positive for non-Delaunay edges, zero for boundary edges.
+    Scalar violation(Edge e) const;
+
+    //! Is the edge \p e Delaunay up to a small tolerance?
+    bool is_delaunay(Edge e) const { return violation(e) <= tolerance(); }
+
+private:
+    // violations below this are considered cocircular, avoids cycling
+    static Scalar tolerance() { return 1e-5; }
+
+    // may \p e be flipped without changing the surface too much?
+    bool is_flippable(Edge e) const;
+
+    SurfaceMesh& mesh_;
+    VertexProperty<Point> points_;
+    EdgeProperty<bool> efeature_;
+    Scalar max_dihedral_angle_;
+};
+
+//=============================================================================
+//! @}
+//=============================================================================
+} // namespace pmp
+//=============================================================================
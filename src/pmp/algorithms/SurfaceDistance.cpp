@@ -0,0 +1,203 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/algorithms/SurfaceDistance.h>
+#include <pmp/Parallel.h>
+
+#include <algorithm>
+#include <cmath>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+namespace {
+
+// bounds the memory of the samples and their nearest neighbors
+const size_t chunk_size = 1 << 20;
+
+// running sums of the distances
+struct Sums
+{
+    Sums() : max(0), weight(0), sum(0), sqr_sum(0), n_samples(0) {}
+
+    Scalar max;
+    double weight, sum, sqr_sum;
+    size_t n_samples;
+};
+
+DistanceStatistics statistics(const Sums& sums)
+{
+    DistanceStatistics result;
+    result.max = sums.max;
+    result.mean = sums.weight > 0 ? Scalar(sums.sum / sums.weight) : 0;
+    result.rms =
+        sums.weight > 0 ? Scalar(std::sqrt(sums.sqr_sum / sums.weight)) : 0;
+    result.n_samples = sums.n_samples;
+    return result;
+}
+
+} // namespace
+
+//=============================================================================
+
+SurfaceDistance::SurfaceDistance(const SurfaceMesh& target) : tree_(target)
+{
+}
+
+//-----------------------------------------------------------------------------
+
+DistanceStatistics SurfaceDistance::distance(SurfaceMesh& source,
+                                             Scalar spacing) const
+{
+    auto points = source.get_vertex_property<Point>("v:point");
+    auto vdistance = source.vertex_property<Scalar>("v:distance");
+    Sums sums;
+
+    // the vertices
+    std::vector<Vertex> vertices;
+    std::vector<Point> samples;
+    auto v_it = source.vertices_begin(), v_end = source.vertices_end();
+    while (v_it != v_end)
+    {
+        vertices.clear();
+        samples.clear();
+        for (; v_it != v_end && vertices.size() < chunk_size; ++v_it)
+        {
+            vertices.push_back(*v_it);
+            samples.push_back(points[*v_it]);
+        }
+
+        const auto nearest = tree_.nearest(samples);
+        for (size_t i = 0; i < vertices.size(); ++i)
+        {
+            vdistance[vertices[i]] = nearest[i].dist;
+            sums.max = std::max(sums.max, nearest[i].dist);
+        }
+        if (source.n_faces() == 0)
+        {
+            for (const auto& n : nearest)
+            {
+                sums.weight += 1;
+                sums.sum += n.dist;
+                sums.sqr_sum += double(n.dist) * n.dist;
+            }
+        }
+    }
+
+    // the centroids of the subdivided triangles, n * n per triangle
+    std::vector<Point> corners;
+    std::vector<size_t> offsets;
+    std::vector<Scalar> weights;
+    std::vector<size_t> subdivisions;
+    auto f_it = source.faces_begin(), f_end = source.faces_end();
+    while (f_it != f_end)
+    {
+        corners.clear();
+        offsets.assign(1, 0);
+        weights.clear();
+        subdivisions.clear();
+        for (; f_it != f_end && offsets.back() < chunk_size; ++f_it)
+        {
+            auto fv = source.vertices(*f_it);
+            const Point p0 = points[*fv];
+            const Point p1 = points[*(++fv)];
+            const Point p2 = points[*(++fv)];
+            corners.push_back(p0);
+            corners.push_back(p1);
+            corners.push_back(p2);
+
+            const Scalar length =
+                std::sqrt(std::max(std::max(sqrnorm(p1 - p0), sqrnorm(p2 - p1)),
+                                   sqrnorm(p0 - p2)));
+            size_t n = 1;
+            if (spacing > 0)
+                n = std::max(size_t(std::ceil(length / spacing)), size_t(1));
+            subdivisions.push_back(n);
+            offsets.push_back(offsets.back() + n * n);
+            weights.push_back(Scalar(0.5) * norm(cross(p1 - p0, p2 - p0)) /
+                              Scalar(n * n));
+        }
+
+        // sub-triangle (i, j) of row i has corners on the barycentric grid
+        const size_t n_faces = weights.size();
+        samples.resize(offsets.back());
+        parallel_for(size_t(0), n_faces, [&](size_t f) {
+            const Point& p0 = corners[3 * f];
+            const Point d1 = corners[3 * f + 1] - p0;
+            const Point d2 = corners[3 * f + 2] - p0;
+            const size_t n = subdivisions[f];
+            size_t k = offsets[f];
+            for (size_t i = 0; i < n; ++i)
+            {
+                for (size_t j = 0; i + j < n; ++j)
+                {
+                    // the upward pointing sub-triangle
+                    const Scalar a = (Scalar(i) + Scalar(1) / 3) / n;
+                    const Scalar b = (Scalar(j) + Scalar(1) / 3) / n;
+                    samples[k++] = p0 + a * d1 + b * d2;
+
+                    // and the downward pointing one, if any
+                    if (i + j + 1 < n)
+                    {
+                        const Scalar c = (Scalar(i) + Scalar(2) / 3) / n;
+                        const Scalar d = (Scalar(j) + Scalar(2) / 3) / n;
+                        samples[k++] = p0 + c * d1 + d * d2;
+                    }
+                }
+            }
+        });
+
+        const auto nearest = tree_.nearest(samples);
+        for (size_t f = 0; f < n_faces; ++f)
+        {
+            for (size_t k = offsets[f]; k < offsets[f + 1]; ++k)
+            {
+                const double d = nearest[k].dist;
+                sums.max = std::max(sums.max, nearest[k].dist);
+                sums.weight += weights[f];
+                sums.sum += weights[f] * d;
+                sums.sqr_sum += weights[f] * d * d;
+            }
+        }
+        sums.n_samples += samples.size();
+    }
+
+    sums.n_samples += source.n_vertices();
+    return statistics(sums);
+}
+
+//=============================================================================
+
+DistanceStatistics symmetric_distance(const DistanceStatistics& ab,
+                                      const DistanceStatistics& ba)
+{
+    DistanceStatistics result;
+    result.max = std::max(ab.max, ba.max);
+    result.mean = (ab.mean + ba.mean) / 2;
+    result.rms = std::sqrt((ab.rms * ab.rms + ba.rms * ba.rms) / 2);
+    result.n_samples = ab.n_samples + ba.n_samples;
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+
+DistanceStatistics hausdorff_distance(SurfaceMesh& a, SurfaceMesh& b,
+                                      Scalar spacing)
+{
+    const DistanceStatistics ab = SurfaceDistance(b).distance(a, spacing);
+    const DistanceStatistics ba = SurfaceDistance(a).distance(b, spacing);
+    return symmetric_distance(ab, ba);
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
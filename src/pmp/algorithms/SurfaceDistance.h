@@ -0,0 +1,82 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <pmp/SurfaceMesh.h>
+#include <pmp/algorithms/TriangleKdTree.h>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \addtogroup algorithms algorithms
+//! @{
+
+//=============================================================================
+
+//! statistics of the distances from the samples of one surface to another
+struct DistanceStatistics
+{
+    Scalar max;       //!< the (one-sided) Hausdorff distance
+    Scalar mean;      //!< the area weighted mean distance
+    Scalar rms;       //!< the area weighted root mean square distance
+    size_t n_samples; //!< the number of samples
+};
+
+//! \brief Sampling-based distance from triangle meshes to a triangle mesh.
+//! \details The source mesh is sampled at its vertices and at the centroids
+//! of a regular subdivision of each triangle, and the samples are projected
+//! to the target mesh by batched TriangleKdTree queries, in parallel. The
+//! mean and RMS distances weight the triangle samples by their area. The
+//! maximum also includes the vertices. Usage:
+//! \code
+//! SurfaceDistance distance(input);
+//! DistanceStatistics error = distance.distance(decimated);
+//! \endcode
+//! \sa hausdorff_distance()
+class SurfaceDistance
+{
+public:
+    //! build the search tree of the triangle mesh \p target
+    SurfaceDistance(const SurfaceMesh& target);
+
+    //! \brief The distance from the triangle mesh \p source to the target.
+    //! \details Each triangle is subdivided such that its longest edge is
+    //! split into segments of at most \p spacing, or not at all if
+    //! \p spacing is zero. The distance of each vertex is stored in the
+    //! vertex property "v:distance" of \p source. A source without faces is
+    //! sampled at its vertices only, weighting them equally.
+    DistanceStatistics distance(SurfaceMesh& source, Scalar spacing = 0) const;
+
+private:
+    TriangleKdTree tree_;
+};
+
+//! \brief Combine the distances \p ab from a mesh to another and \p ba back.
+//! \details \c max is the maximum of both, \c mean and \c rms average both
+//! directions.
+DistanceStatistics symmetric_distance(const DistanceStatistics& ab,
+                                      const DistanceStatistics& ba);
+
+//! \brief The symmetric distance between the triangle meshes \p a and \p b.
+//! \details Combines the distances from \p a to \p b and from \p b to \p a
+//! by symmetric_distance(), such that \c max is the Hausdorff distance. Both
+//! meshes get the vertex property "v:distance", see
+//! SurfaceDistance::distance().
+DistanceStatistics hausdorff_distance(SurfaceMesh& a, SurfaceMesh& b,
+                                      Scalar spacing = 0);
+
+//=============================================================================
+//! @}
+//=============================================================================
+} // namespace pmp
+//=============================================================================
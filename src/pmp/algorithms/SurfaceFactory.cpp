@@ -0,0 +1,380 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/algorithms/SurfaceFactory.h>
+#include <pmp/Parallel.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+namespace {
+
+const double pi = 3.14159265358979323846;
+
+// a well-mixed 64 bit hash of x (splitmix64)
+uint64_t hash(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+// a uniform random number in [0,1) for element i, stream s, and seed
+double random(uint64_t i, uint64_t s, unsigned int seed)
+{
+    return double(hash(hash(i ^ (s << 48)) ^ seed) >> 11) /
+           double(uint64_t(1) << 53);
+}
+
+// the positions and triangles of a torus with n segments around the axis
+// and m around the tube
+void torus_indices(size_t n, size_t m, Scalar radius, Scalar thickness,
+                   std::vector<Point>& points,
+                   std::vector<IndexType>& indices)
+{
+    points.resize(n * m);
+    indices.resize(6 * n * m);
+    parallel_for(size_t(0), n, [&](size_t i) {
+        const double u = 2 * pi * i / n;
+        for (size_t j = 0; j < m; ++j)
+        {
+            const double v = 2 * pi * j / m;
+            const double r = radius + thickness * std::cos(v);
+            points[i * m + j] = Point(r * std::cos(u), r * std::sin(u),
+                                      thickness * std::sin(v));
+
+            const size_t i1 = (i + 1) % n, j1 = (j + 1) % m;
+            const IndexType v00 = IndexType(i * m + j);
+            const IndexType v10 = IndexType(i1 * m + j);
+            const IndexType v01 = IndexType(i * m + j1);
+            const IndexType v11 = IndexType(i1 * m + j1);
+            IndexType* t = &indices[6 * (i * m + j)];
+            t[0] = v00, t[1] = v10, t[2] = v11;
+            t[3] = v00, t[4] = v11, t[5] = v01;
+        }
+    });
+}
+
+// the segments around the axis and the tube for n_faces triangles
+void torus_segments(size_t n_faces, Scalar radius, Scalar thickness,
+                    size_t& n, size_t& m)
+{
+    const double cells = std::max(double(n_faces) / 2, 9.0);
+    const double ratio = std::max(double(radius / thickness), 1.0);
+    m = std::max(size_t(3), size_t(std::lround(std::sqrt(cells / ratio))));
+    n = std::max(size_t(3), size_t(std::lround(cells / m)));
+}
+
+// the positions and triangles of a regular grid of nx x ny cells over the
+// unit square
+void grid_indices(size_t nx, size_t ny, bool triangles,
+                  std::vector<Point>& points, std::vector<IndexType>& indices,
+                  std::vector<IndexType>& sizes)
+{
+    points.resize((nx + 1) * (ny + 1));
+    indices.resize((triangles ? 6 : 4) * nx * ny);
+    sizes.clear();
+    if (!triangles)
+        sizes.assign(nx * ny, 4);
+
+    parallel_for(size_t(0), ny + 1, [&](size_t j) {
+        for (size_t i = 0; i <= nx; ++i)
+            points[j * (nx + 1) + i] =
+                Point(Scalar(i) / nx, Scalar(j) / ny, 0);
+        if (j == ny)
+            return;
+        for (size_t i = 0; i < nx; ++i)
+        {
+            const IndexType v00 = IndexType(j * (nx + 1) + i);
+            const IndexType v10 = v00 + 1;
+            const IndexType v01 = v00 + IndexType(nx + 1);
+            const IndexType v11 = v01 + 1;
+            if (triangles)
+            {
+                IndexType* t = &indices[6 * (j * nx + i)];
+                t[0] = v00, t[1] = v10, t[2] = v11;
+                t[3] = v00, t[4] = v11, t[5] = v01;
+            }
+            else
+            {
+                IndexType* q = &indices[4 * (j * nx + i)];
+                q[0] = v00, q[1] = v10, q[2] = v11, q[3] = v01;
+            }
+        }
+    });
+}
+
+// smoothly interpolated random values at the integer points of the plane
+double value_noise(double x, double y, uint64_t octave, unsigned int seed)
+{
+    const double fx = std::floor(x), fy = std::floor(y);
+    const int64_t ix = int64_t(fx), iy = int64_t(fy);
+    double tx = x - fx, ty = y - fy;
+    tx = tx * tx * (3 - 2 * tx);
+    ty = ty * ty * (3 - 2 * ty);
+    auto corner = [&](int64_t i, int64_t j) {
+        const uint64_t key = uint64_t(i) * 0x9e3779b1u + uint64_t(j);
+        return 2 * random(key, octave, seed) - 1;
+    };
+    const double a = corner(ix, iy) + tx * (corner(ix + 1, iy) - corner(ix, iy));
+    const double b =
+        corner(ix, iy + 1) + tx * (corner(ix + 1, iy + 1) - corner(ix, iy + 1));
+    return a + ty * (b - a);
+}
+
+} // namespace
+
+//=============================================================================
+
+SurfaceMesh SurfaceFactory::icosphere(size_t n_faces)
+{
+    // the icosahedron
+    const Scalar g = Scalar((1 + std::sqrt(5.0)) / 2);
+    const Point corners[12] = {
+        Point(-1, g, 0), Point(1, g, 0),   Point(-1, -g, 0), Point(1, -g, 0),
+        Point(0, -1, g), Point(0, 1, g),   Point(0, -1, -g), Point(0, 1, -g),
+        Point(g, 0, -1), Point(g, 0, 1),   Point(-g, 0, -1), Point(-g, 0, 1)};
+    const IndexType faces[20][3] = {
+        {0, 11, 5}, {0, 5, 1},  {0, 1, 7},   {0, 7, 10}, {0, 10, 11},
+        {1, 5, 9},  {5, 11, 4}, {11, 10, 2}, {10, 7, 6}, {7, 1, 8},
+        {3, 9, 4},  {3, 4, 2},  {3, 2, 6},   {3, 6, 8},  {3, 8, 9},
+        {4, 9, 5},  {2, 4, 11}, {6, 2, 10},  {8, 6, 7},  {9, 8, 1}};
+
+    // the edges, and the edges of each face
+    std::vector<std::pair<IndexType, IndexType>> edges;
+    IndexType face_edges[20][3];
+    for (int f = 0; f < 20; ++f)
+        for (int i = 0; i < 3; ++i)
+        {
+            const IndexType a = faces[f][i], b = faces[f][(i + 1) % 3];
+            const auto e = std::make_pair(std::min(a, b), std::max(a, b));
+            auto it = std::find(edges.begin(), edges.end(), e);
+            face_edges[f][i] = IndexType(it - edges.begin());
+            if (it == edges.end())
+                edges.push_back(e);
+        }
+
+    // each face is split into k x k triangles by a lattice of k + 1 points
+    // per side, the corners come first, then k - 1 points per edge, then
+    // (k - 1) (k - 2) / 2 points per face
+    const size_t k = std::max(
+        size_t(1), size_t(std::lround(std::sqrt(double(n_faces) / 20))));
+    const size_t first_inner = 12 + 30 * (k - 1);
+    const size_t n_inner = (k - 1) * (k - 2) / 2;
+
+    // the point t steps from a towards b on their edge e
+    auto edge_point = [&](IndexType e, IndexType a, size_t t) -> IndexType {
+        if (t == 0)
+            return a;
+        if (t == k)
+            return edges[e].first == a ? edges[e].second : edges[e].first;
+        const size_t s = edges[e].first == a ? t : k - t;
+        return IndexType(12 + e * (k - 1) + s - 1);
+    };
+
+    // the lattice point a + i (b - a) / k + j (c - a) / k of face f
+    auto lattice = [&](size_t f, size_t i, size_t j) -> IndexType {
+        const IndexType* c = faces[f];
+        if (j == 0)
+            return edge_point(face_edges[f][0], c[0], i);
+        if (i + j == k)
+            return edge_point(face_edges[f][1], c[1], j);
+        if (i == 0)
+            return edge_point(face_edges[f][2], c[0], j);
+        const size_t row = (j - 1) * (k - 1) - (j - 1) * j / 2;
+        return IndexType(first_inner + f * n_inner + row + i - 1);
+    };
+
+    std::vector<Point> points(first_inner + 20 * n_inner);
+    for (int i = 0; i < 12; ++i)
+        points[i] = normalize(corners[i]);
+    parallel_for(size_t(0), edges.size(), [&](size_t e) {
+        const Point& a = corners[edges[e].first];
+        const Point& b = corners[edges[e].second];
+        for (size_t s = 1; s < k; ++s)
+            points[12 + e * (k - 1) + s - 1] =
+                normalize(a + (Scalar(s) / k) * (b - a));
+    });
+    parallel_for(size_t(0), size_t(20), [&](size_t f) {
+        const Point& a = corners[faces[f][0]];
+        const Point& b = corners[faces[f][1]];
+        const Point& c = corners[faces[f][2]];
+        for (size_t j = 1; j + 1 < k; ++j)
+            for (size_t i = 1; i + j < k; ++i)
+                points[lattice(f, i, j)] =
+                    normalize(a + (Scalar(i) / k) * (b - a) +
+                              (Scalar(j) / k) * (c - a));
+    });
+
+    // row j of a face has k - j upward and k - j - 1 downward triangles
+    std::vector<IndexType> indices(3 * 20 * k * k);
+    parallel_for(size_t(0), size_t(20 * k), [&](size_t r) {
+        const size_t f = r / k, j = r % k;
+        IndexType* tri = &indices[3 * (f * k * k + 2 * k * j - j * j)];
+        for (size_t i = 0; i + j < k; ++i)
+        {
+            *tri++ = lattice(f, i, j);
+            *tri++ = lattice(f, i + 1, j);
+            *tri++ = lattice(f, i, j + 1);
+            if (i + j + 1 < k)
+            {
+                *tri++ = lattice(f, i + 1, j);
+                *tri++ = lattice(f, i + 1, j + 1);
+                *tri++ = lattice(f, i, j + 1);
+            }
+        }
+    });
+
+    SurfaceMesh mesh;
+    mesh.build_from_indices(points, indices);
+    return mesh;
+}
+
+//-----------------------------------------------------------------------------
+
+SurfaceMesh SurfaceFactory::torus(size_t n_faces, Scalar radius,
+                                  Scalar thickness)
+{
+    size_t n, m;
+    torus_segments(n_faces, radius, thickness, n, m);
+    std::vector<Point> points;
+    std::vector<IndexType> indices;
+    torus_indices(n, m, radius, thickness, points, indices);
+    SurfaceMesh mesh;
+    mesh.build_from_indices(points, indices);
+    return mesh;
+}
+
+//-----------------------------------------------------------------------------
+
+SurfaceMesh SurfaceFactory::grid(size_t nx, size_t ny, bool triangles)
+{
+    SurfaceMesh mesh;
+    if (nx == 0 || ny == 0)
+        return mesh;
+    std::vector<Point> points;
+    std::vector<IndexType> indices, sizes;
+    grid_indices(nx, ny, triangles, points, indices, sizes);
+    mesh.build_from_indices(points, indices, sizes);
+    return mesh;
+}
+
+//-----------------------------------------------------------------------------
+
+SurfaceMesh SurfaceFactory::terrain(size_t n_faces, Scalar roughness,
+                                    unsigned int seed)
+{
+    const size_t n = std::max(
+        size_t(1), size_t(std::lround(std::sqrt(double(n_faces) / 2))));
+    std::vector<Point> points;
+    std::vector<IndexType> indices, sizes;
+    grid_indices(n, n, true, points, indices, sizes);
+
+    // octaves from 4 cells across down to the grid resolution
+    int octaves = 1;
+    while ((size_t(4) << octaves) < n)
+        ++octaves;
+    parallel_for(size_t(0), points.size(), [&](size_t i) {
+        Point& p = points[i];
+        double height = 0, amplitude = 0.2, frequency = 4;
+        for (int o = 0; o < octaves; ++o)
+        {
+            height += amplitude *
+                      value_noise(p[0] * frequency, p[1] * frequency, o, seed);
+            amplitude *= roughness;
+            frequency *= 2;
+        }
+        p[2] = Scalar(height);
+    });
+
+    SurfaceMesh mesh;
+    mesh.build_from_indices(points, indices);
+    return mesh;
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceFactory::polygon_soup(size_t n_faces, const SoupDefects& defects,
+                                  std::vector<Point>& points,
+                                  std::vector<IndexType>& indices,
+                                  unsigned int seed)
+{
+    size_t n, m;
+    torus_segments(n_faces, 1, Scalar(0.3), n, m);
+    torus_indices(n, m, 1, Scalar(0.3), points, indices);
+
+    // the defects of each face, decided independently of the others
+    const size_t n_triangles = indices.size() / 3;
+    enum Defect
+    {
+        Split = 1,
+        Flip = 2,
+        Fin = 4,
+        Degenerate = 8
+    };
+    std::vector<unsigned char> defect(n_triangles, 0);
+    parallel_for(size_t(0), n_triangles, [&](size_t f) {
+        if (random(f, 0, seed) < defects.split_vertices)
+            defect[f] |= Split;
+        if (random(f, 1, seed) < defects.flipped_faces)
+            defect[f] |= Flip;
+        if (random(f, 2, seed) < defects.non_manifold_edges)
+            defect[f] |= Fin;
+        if (random(f, 3, seed) < defects.degenerate_faces)
+            defect[f] |= Degenerate;
+    });
+
+    // defects adding vertices and faces are applied in order, such that
+    // the result does not depend on the number of threads
+    for (size_t f = 0; f < n_triangles; ++f)
+    {
+        if (!defect[f])
+            continue;
+        IndexType* t = &indices[3 * f];
+        if (defect[f] & Fin)
+        {
+            // a triangle over the first edge, pointing away from the face
+            const Point& a = points[t[0]];
+            const Point& b = points[t[1]];
+            const Point& c = points[t[2]];
+            const Point apex = (a + b) / 2 + cross(b - a, c - a) /
+                                                 (2 * norm(b - a) + 1e-20);
+            const IndexType v = IndexType(points.size());
+            points.push_back(apex);
+            const IndexType t0 = t[0], t1 = t[1];
+            indices.insert(indices.end(), {t1, t0, v});
+            t = &indices[3 * f];
+        }
+        if (defect[f] & Split)
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                const Point p = points[t[i]];
+                t[i] = IndexType(points.size());
+                points.push_back(p);
+            }
+        }
+        if (defect[f] & Flip)
+            std::swap(t[1], t[2]);
+        if (defect[f] & Degenerate)
+            t[2] = t[1];
+    }
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
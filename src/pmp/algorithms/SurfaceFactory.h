@@ -0,0 +1,96 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <pmp/SurfaceMesh.h>
+
+#include <vector>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \addtogroup algorithms algorithms
+//! @{
+
+//=============================================================================
+
+//! \brief Generate meshes of a given size procedurally.
+//! \details Meant for tests and benchmarks at sizes that no data set
+//! provides. The positions and indices are computed in parallel and the
+//! connectivity is built by SurfaceMesh::build_from_indices(), such that
+//! meshes with millions of faces take a fraction of a second. Meshes of a
+//! requested number of faces get the closest size their structure allows.
+class SurfaceFactory
+{
+public:
+    // delete default and copy constructor
+    SurfaceFactory() = delete;
+    SurfaceFactory(const SurfaceFactory&) = delete;
+
+    //! \brief A unit sphere made of triangles of nearly equal size.
+    //! \details Each face of an icosahedron is split into k x k triangles,
+    //! whose vertices are projected to the sphere. The mesh has 20 k^2
+    //! faces for the k that fits \p n_faces best.
+    static SurfaceMesh icosphere(size_t n_faces);
+
+    //! \brief A triangulated torus around the z-axis.
+    //! \details \p radius is the distance of the tube from the axis, and
+    //! \p thickness the radius of the tube. The segments around the axis
+    //! and around the tube are chosen for nearly square cells.
+    static SurfaceMesh torus(size_t n_faces, Scalar radius = 1,
+                             Scalar thickness = 0.3);
+
+    //! \brief The unit square in the xy-plane, divided into \p nx x \p ny
+    //! quads, or two triangles per quad if \p triangles is set.
+    static SurfaceMesh grid(size_t nx, size_t ny, bool triangles = false);
+
+    //! \brief A height field over the unit square.
+    //! \details The triangulated grid is displaced by fractal value noise.
+    //! Each octave doubles the frequency and scales the amplitude by
+    //! \p roughness. Equal \p seed give equal terrains, on any number of
+    //! threads.
+    static SurfaceMesh terrain(size_t n_faces, Scalar roughness = 0.5,
+                               unsigned int seed = 0);
+
+    //! the kinds of defects of polygon_soup(), as fractions of the faces
+    struct SoupDefects
+    {
+        //! faces with their own copies of their vertices, which opens
+        //! cracks along their edges
+        Scalar split_vertices = 0;
+        //! faces with reversed orientation
+        Scalar flipped_faces = 0;
+        //! extra faces attached to an edge of a face, which is then shared
+        //! by three faces
+        Scalar non_manifold_edges = 0;
+        //! faces with a repeated vertex
+        Scalar degenerate_faces = 0;
+    };
+
+    //! \brief A triangle soup of a torus with the given \p defects.
+    //! \details Replaces \p points and \p indices by the vertex positions
+    //! and the vertex indices of the triangles. Without defects, they form
+    //! a closed manifold mesh. Which faces are affected is decided by
+    //! \p seed. Meant for testing import and repair at scale, e.g., with
+    //! SurfaceMesh::build_from_indices() and PointWelder.
+    static void polygon_soup(size_t n_faces, const SoupDefects& defects,
+                             std::vector<Point>& points,
+                             std::vector<IndexType>& indices,
+                             unsigned int seed = 0);
+};
+
+//=============================================================================
+//! @}
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -9,6 +9,13 @@
 
 #include <pmp/algorithms/SurfaceFairing.h>
 #include <pmp/algorithms/DifferentialGeometry.h>
+#include <pmp/algorithms/GeometryCache.h>
+#include <pmp/algorithms/LaplaceMatrix.h>
+#include <pmp/algorithms/SparseSolver.h>
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
 
 #include <Eigen/Dense>
 #include <Eigen/Sparse>
@@ -19,20 +26,142 @@ namespace pmp {
 
 //=============================================================================
 
-using SparseMatrix = Eigen::SparseMatrix<double>;
-using Triplet = Eigen::Triplet<double>;
+using RowMatrix = Eigen::SparseMatrix<double, Eigen::RowMajor>;
 
 //=============================================================================
 
-SurfaceFairing::SurfaceFairing(SurfaceMesh& mesh) : mesh_(mesh)
+namespace {
+
+// map the compressed rows of a matrix to Eigen
+Eigen::Map<const RowMatrix> as_eigen(const CompressedRowMatrix& m)
+{
+    return Eigen::Map<const RowMatrix>(m.n_rows, m.n_columns,
+                                       m.values.size(), m.offsets.data(),
+                                       m.columns.data(), m.values.data());
+}
+
+// split the rows Lk of the free vertices into the columns of the free
+// vertices, L, and of the fixed ones, F. index[c] is the free vertex of
+// column c, or -1 if columns[c] is fixed.
+void split(RowMatrix& Lk, const std::vector<int>& index,
+           CompressedRowMatrix& L, CompressedRowMatrix& F)
+{
+    const unsigned int n = Lk.rows();
+    Lk.makeCompressed();
+
+    CompressedRowMatrix power;
+    power.n_rows = Lk.rows();
+    power.n_columns = Lk.cols();
+    power.offsets.assign(Lk.outerIndexPtr(), Lk.outerIndexPtr() + n + 1);
+    const int nnz = Lk.nonZeros();
+    power.columns.assign(Lk.innerIndexPtr(), Lk.innerIndexPtr() + nnz);
+    power.values.assign(Lk.valuePtr(), Lk.valuePtr() + nnz);
+
+    std::vector<int> identity(n);
+    std::iota(identity.begin(), identity.end(), 0);
+    extract(power, identity, index, L, F);
+}
+
+// the coordinates of the points of vertices, column by column
+std::vector<double> coordinates(const std::vector<Vertex>& vertices,
+                                const VertexProperty<Point>& points)
+{
+    const size_t n = vertices.size();
+    std::vector<double> X(3 * n);
+    for (size_t i = 0; i < n; ++i)
+        for (int j = 0; j < 3; ++j)
+            X[j * n + i] = points[vertices[i]][j];
+    return X;
+}
+
+// solve L X = -F P for the positions X of the free vertices, the rows of L,
+// with the solver computed for L. P are the positions of the vertices
+// columns of F.
+void substitute(SparseSolver& solver, const CompressedRowMatrix& F,
+                const std::vector<Vertex>& vertices,
+                const std::vector<Vertex>& columns,
+                VertexProperty<Point>& points)
+{
+    // B and X store the coordinates column by column
+    const unsigned int n = vertices.size();
+    std::vector<double> B(3 * n, 0.0), X = coordinates(vertices, points);
+    for (unsigned int i = 0; i < n; ++i)
+    {
+        for (int k = F.offsets[i]; k < F.offsets[i + 1]; ++k)
+        {
+            const Point& p = points[columns[F.columns[k]]];
+            for (int j = 0; j < 3; ++j)
+                B[j * n + i] -= F.values[k] * p[j];
+        }
+    }
+
+    if (!solver.solve(B, X))
+    {
+        std::cerr << "SurfaceFairing: Could not solve linear system\n";
+    }
+    else
+    {
+        for (unsigned int i = 0; i < n; ++i)
+        {
+            points[vertices[i]] = Point(X[i], X[n + i], X[2 * n + i]);
+        }
+    }
+}
+
+// solve Lk X = 0 for the positions of the free vertices, the rows of Lk.
+// index[c] is the free vertex of column c, or -1 if columns[c] is fixed.
+void solve(RowMatrix& Lk, const std::vector<int>& index,
+           const std::vector<Vertex>& vertices,
+           const std::vector<Vertex>& columns, VertexProperty<Point>& points,
+           unsigned int k)
+{
+    // locked vertices go to the right hand side
+    CompressedRowMatrix L, F;
+    split(Lk, index, L, F);
+
+    // the linear functions are in the near kernel of the powers of the
+    // Laplacian
+    SparseSolver solver;
+    if (k > 1)
+        solver.set_near_kernel(coordinates(vertices, points));
+    solver.compute(L);
+    substitute(solver, F, vertices, columns, points);
+}
+
+// all vertices of mesh, including deleted ones, in index order
+std::vector<Vertex> all_vertices(const SurfaceMesh& mesh)
+{
+    std::vector<Vertex> vertices;
+    vertices.reserve(mesh.vertices_size());
+    for (size_t i = 0; i < mesh.vertices_size(); ++i)
+        vertices.push_back(Vertex(i));
+    return vertices;
+}
+
+} // namespace
+
+//=============================================================================
+
+// the factorization of fair_persistent()
+struct SurfaceFairing::System
+{
+    unsigned long topology_version;
+    unsigned int k;
+    std::vector<Vertex> vertices; // the free vertices
+    CompressedRowMatrix fixed;    // their entries in the locked columns
+    SparseSolver solver;
+};
+
+//-----------------------------------------------------------------------------
+
+SurfaceFairing::SurfaceFairing(SurfaceMesh& mesh)
+    : mesh_(mesh), neighborhood_(mesh)
 {
     // get & add properties
     points_ = mesh_.vertex_property<Point>("v:point");
     vselected_ = mesh_.get_vertex_property<bool>("v:selected");
     vlocked_ = mesh_.add_vertex_property<bool>("fairing:locked");
     vweight_ = mesh_.add_vertex_property<double>("fairing:vweight");
-    eweight_ = mesh_.add_edge_property<double>("fairing:eweight");
-    idx_ = mesh_.add_vertex_property<int>("fairing:idx", -1);
 }
 
 //-----------------------------------------------------------------------------
@@ -42,24 +171,60 @@ SurfaceFairing::~SurfaceFairing()
     // remove properties
     mesh_.remove_vertex_property(vlocked_);
     mesh_.remove_vertex_property(vweight_);
-    mesh_.remove_edge_property(eweight_);
-    mesh_.remove_vertex_property(idx_);
 }
 
 //-----------------------------------------------------------------------------
 
 void SurfaceFairing::fair(unsigned int k)
 {
-    // compute cotan weights
-    for (auto v : mesh_.vertices())
-    {
-        vweight_[v] = 0.5 / voronoi_area(mesh_, v);
-    }
-    for (auto e : mesh_.edges())
+    std::vector<int> index;
+    const std::vector<Vertex> vertices = free_vertices(k, index);
+
+    CompressedRowMatrix L, F;
+    assemble(k, index, L, F);
+    SparseSolver solver;
+    if (k > 1)
+        solver.set_near_kernel(coordinates(vertices, points_));
+    solver.compute(L);
+    substitute(solver, F, vertices, all_vertices(mesh_), points_);
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceFairing::fair_persistent(unsigned int k)
+{
+    std::vector<int> index;
+    std::vector<Vertex> vertices = free_vertices(k, index);
+
+    // factor the system again only if it has changed
+    if (!system_ || system_->topology_version != mesh_.topology_version() ||
+        system_->k != k || system_->vertices != vertices)
     {
-        eweight_[e] = std::max(0.0, cotan_weight(mesh_, e));
+        system_.reset(new System);
+        system_->topology_version = mesh_.topology_version();
+        system_->k = k;
+        system_->vertices.swap(vertices);
+
+        CompressedRowMatrix L;
+        assemble(k, index, L, system_->fixed);
+        if (k > 1)
+            system_->solver.set_near_kernel(
+                coordinates(system_->vertices, points_));
+        system_->solver.compute(L);
     }
 
+    substitute(system_->solver, system_->fixed, system_->vertices,
+               all_vertices(mesh_), points_);
+}
+
+//-----------------------------------------------------------------------------
+
+std::vector<Vertex> SurfaceFairing::free_vertices(unsigned int k,
+                                                  std::vector<int>& index)
+{
+    for (auto v : mesh_.vertices())
+        vlocked_[v] = false;
+
     // check whether some vertices are selected
     bool no_selection = true;
     if (vselected_)
@@ -117,142 +282,126 @@ void SurfaceFairing::fair(unsigned int k)
     }
 
     // collect free vertices
+    index.assign(mesh_.vertices_size(), -1);
     std::vector<Vertex> vertices;
     vertices.reserve(mesh_.n_vertices());
     for (auto v : mesh_.vertices())
     {
         if (!vlocked_[v])
         {
-            idx_[v] = vertices.size();
+            index[v.idx()] = vertices.size();
             vertices.push_back(v);
         }
     }
+    return vertices;
+}
 
-    // construct matrix & rhs
-    const unsigned int n = vertices.size();
-    SparseMatrix A(n, n);
-    Eigen::MatrixXd B(n, 3);
-
-    std::map<Vertex, double> row;
-    std::vector<Triplet> triplets;
+//-----------------------------------------------------------------------------
 
-    for (unsigned int i = 0; i < n; ++i)
+void SurfaceFairing::assemble(unsigned int k, const std::vector<int>& index,
+                              CompressedRowMatrix& L, CompressedRowMatrix& F)
+{
+    // compute vertex weights
+    const GeometryCache* cache = GeometryCache::get(mesh_);
+    for (auto v : mesh_.vertices())
     {
-        B(i, 0) = 0.0;
-        B(i, 1) = 0.0;
-        B(i, 2) = 0.0;
-
-        setup_matrix_row(vertices[i], vweight_, eweight_, k, row);
-
-        for (auto r : row)
-        {
-            auto v = r.first;
-            auto w = r.second;
-
-            if (idx_[v] != -1)
-            {
-                triplets.emplace_back(i, idx_[v], w);
-            }
-            else
-            {
-                B(i, 0) -= w * points_[v][0];
-                B(i, 1) -= w * points_[v][1];
-                B(i, 2) -= w * points_[v][2];
-            }
-        }
+        vweight_[v] =
+            0.5 / (cache ? cache->voronoi_area(v) : voronoi_area(mesh_, v));
     }
 
-    A.setFromTriplets(triplets.begin(), triplets.end());
+    // the rows of the free vertices of the k-th power of the cotan
+    // Laplace matrix, L (D L)^(k-1) with D the vertex weights
+    LaplaceMatrix laplace(mesh_);
+    laplace.assemble();
 
-    // solve A*X = B
-    Eigen::SimplicialLDLT<SparseMatrix> solver(A);
-    Eigen::MatrixXd X = solver.solve(B);
+    std::vector<int> all(mesh_.vertices_size());
+    std::iota(all.begin(), all.end(), 0);
+    CompressedRowMatrix rows, none;
+    extract(laplace.matrix(), index, all, rows, none);
 
-    if (solver.info() != Eigen::Success)
-    {
-        std::cerr << "SurfaceFairing: Could not solve linear system\n";
-    }
-    else
+    RowMatrix Lk = as_eigen(rows);
+    if (k > 1)
     {
-        for (unsigned int i = 0; i < n; ++i)
-        {
-            auto v = vertices[i];
-            points_[v] = Point(X(idx_[v], 0), X(idx_[v], 1), X(idx_[v], 2));
-        }
+        Eigen::VectorXd d = Eigen::VectorXd::Zero(mesh_.vertices_size());
+        for (auto v : mesh_.vertices())
+            d[v.idx()] = vweight_[v];
+        const RowMatrix DL = d.asDiagonal() * as_eigen(laplace.matrix());
+        for (unsigned int i = 1; i < k; ++i)
+            Lk = Lk * DL;
     }
+    split(Lk, index, L, F);
 }
 
 //-----------------------------------------------------------------------------
 
-struct Triple
-{
-    Triple() = default;
-
-    Triple(Vertex v, double weight, unsigned int degree)
-        : vertex_(v), weight_(weight), degree_(degree)
-    {
-    }
-
-    Vertex vertex_;
-    double weight_;
-    unsigned int degree_;
-};
-
-//-----------------------------------------------------------------------------
-
-void SurfaceFairing::setup_matrix_row(const Vertex v,
-                                      VertexProperty<double> vweight,
-                                      EdgeProperty<double> eweight,
-                                      unsigned int laplace_degree,
-                                      std::map<Vertex, double>& row)
+void SurfaceFairing::fair(const std::vector<Vertex>& vertices, unsigned int k)
 {
-    Triple t(v, 1.0, laplace_degree);
-
-    // init
-    static std::vector<Triple> todo;
-    todo.reserve(50);
-    todo.push_back(t);
-    row.clear();
+    if (k == 0)
+        return;
 
-    while (!todo.empty())
+    // the free vertices, at least k boundary rings away as in fair(k)
+    const unsigned int rings = std::min(k, 3u) - 1;
+    std::vector<Vertex> boundary;
+    for (auto v : neighborhood_.rings(vertices, rings))
+        if (mesh_.is_boundary(v))
+            boundary.push_back(v);
+    neighborhood_.rings(boundary, rings);
+    std::vector<char> locked(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i)
+        locked[i] = mesh_.is_deleted(vertices[i]) ||
+                    mesh_.is_isolated(vertices[i]) ||
+                    neighborhood_.contains(vertices[i]);
+    std::vector<Vertex> free;
+    for (size_t i = 0; i < vertices.size(); ++i)
+        if (!locked[i])
+            free.push_back(vertices[i]);
+
+    // the rows of the free vertices of L (D L)^(k-1) reach k rings, the
+    // rows of L reaching up to k-1 rings are complete
+    const std::vector<Vertex>& local = neighborhood_.rings(free, k);
+    free.assign(local.begin(), local.begin() + neighborhood_.ring_end(0));
+    const size_t n = free.size(), m = local.size();
+    std::unordered_map<IndexType, int> index;
+    for (size_t i = 0; i < m; ++i)
+        index[local[i].idx()] = int(i);
+
+    const GeometryCache* cache = GeometryCache::get(mesh_);
+    std::vector<Eigen::Triplet<double>> triplets;
+    Eigen::VectorXd d = Eigen::VectorXd::Zero(m);
+    for (size_t i = 0; i < m; ++i)
     {
-        t = todo.back();
-        todo.pop_back();
-        auto v = t.vertex_;
-        auto d = t.degree_;
-
-        if (d == 0)
+        const Vertex v = local[i];
+        if (i < neighborhood_.ring_end(k - 1))
         {
-            row[v] += t.weight_;
-        }
-
-        // else if (d == 1 && mesh_.is_boundary(v))
-        // {
-        //     // ignore?
-        // }
-
-        else
-        {
-            auto ww = 0.0;
-
+            double sum = 0.0;
             for (auto h : mesh_.halfedges(v))
             {
-                auto e = mesh_.edge(h);
-                auto vv = mesh_.to_vertex(h);
-                auto w = eweight[e];
-
-                if (d < laplace_degree)
-                    w *= vweight[v];
-
-                w *= t.weight_;
-                ww -= w;
-
-                todo.emplace_back(vv, w, d - 1);
+                const Edge e = mesh_.edge(h);
+                const double w = std::max(
+                    0.0, cache ? cache->cotan_weight(e)
+                               : cotan_weight(mesh_, e));
+                triplets.emplace_back(
+                    int(i), index[mesh_.to_vertex(h).idx()], -w);
+                sum += w;
             }
-
-            todo.emplace_back(v, ww, d - 1);
+            triplets.emplace_back(int(i), int(i), sum);
+            d[i] = 0.5 / (cache ? cache->voronoi_area(v)
+                                : voronoi_area(mesh_, v));
         }
     }
+    RowMatrix L(m, m);
+    L.setFromTriplets(triplets.begin(), triplets.end());
+
+    RowMatrix Lk = L.topRows(n);
+    if (k > 1)
+    {
+        const RowMatrix DL = d.asDiagonal() * L;
+        for (unsigned int i = 1; i < k; ++i)
+            Lk = Lk * DL;
+    }
+    std::vector<int> local_index(m, -1);
+    std::iota(local_index.begin(), local_index.begin() + n, 0);
+    solve(Lk, local_index, free, local, points_, k);
 }
 
 //=============================================================================
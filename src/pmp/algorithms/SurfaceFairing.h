@@ -10,7 +10,11 @@
 //=============================================================================
 
 #include <pmp/SurfaceMesh.h>
-#include <map>
+#include <pmp/algorithms/SparseSolver.h>
+#include <pmp/algorithms/SurfaceNeighborhood.h>
+
+#include <memory>
+#include <vector>
 
 //=============================================================================
 
@@ -43,13 +47,33 @@ public:
     //! compute surface by solving k-harmonic equation
     void fair(unsigned int k = 2);
 
-private:
-    void setup_matrix_row(const Vertex v, VertexProperty<double> vweight,
-                          EdgeProperty<double> eweight,
-                          unsigned int laplace_degree,
-                          std::map<Vertex, double>& row);
+    //! \brief Fair like fair(), but keep the factorization for later calls.
+    //! \details The system is factored again only if the topology of the
+    //! mesh, the locked vertices or \p k have changed. Otherwise, e.g.,
+    //! after moving the handles of a deformation, only the right-hand side
+    //! is updated from the positions of the locked vertices, and solving is
+    //! a back-substitution. The weights remain those of the factorization.
+    void fair_persistent(unsigned int k = 2);
+
+    //! \brief Fair the region of \p vertices only.
+    //! \details Solves the k-harmonic equation for \p vertices, while all
+    //! other vertices and the boundary rings locked by fair() stay fixed.
+    //! The system is assembled over the k-ring of \p vertices only, which
+    //! makes the cost proportional to the region, e.g., for brush edits of
+    //! large meshes with one SurfaceFairing object kept between the edits.
+    //! Ignores the property "v:selected".
+    void fair(const std::vector<Vertex>& vertices, unsigned int k = 2);
 
 private:
+    //! \brief Lock the vertices kept fixed by fair(\p k).
+    //! \return the free vertices, \p index maps vertices to them or to -1
+    std::vector<Vertex> free_vertices(unsigned int k, std::vector<int>& index);
+
+    //! the system of fair(\p k) for the free vertices \p index: their
+    //! columns \p L and the columns of the locked ones \p F
+    void assemble(unsigned int k, const std::vector<int>& index,
+                  CompressedRowMatrix& L, CompressedRowMatrix& F);
+
     SurfaceMesh& mesh_; //!< the mesh
 
     // property handles
@@ -57,8 +81,13 @@ private:
     VertexProperty<bool> vselected_;
     VertexProperty<bool> vlocked_;
     VertexProperty<double> vweight_;
-    EdgeProperty<double> eweight_;
-    VertexProperty<int> idx_;
+
+    // the regions of local fairing, kept between calls
+    SurfaceNeighborhood neighborhood_;
+
+    // the factorization of fair_persistent(), kept between calls
+    struct System;
+    std::unique_ptr<System> system_;
 };
 
 //=============================================================================
@@ -9,6 +9,10 @@
 
 #include <pmp/algorithms/SurfaceFeatures.h>
 #include <pmp/algorithms/SurfaceNormals.h>
+#include <pmp/algorithms/GeometryCache.h>
+#include <pmp/Parallel.h>
+
+#include <algorithm>
 
 //=============================================================================
 
@@ -52,22 +56,90 @@ void SurfaceFeatures::detect_angle(Scalar angle)
 {
     const Scalar feature_cosine = cos(angle / 180.0 * M_PI);
 
-    for (auto e : mesh_.edges())
+    // compute each face normal once, unless they are cached
+    const GeometryCache* cache = GeometryCache::get(mesh_);
+    std::vector<Normal> normals;
+    if (!cache)
     {
+        normals.resize(mesh_.faces_size());
+        parallel_for(mesh_.faces(), [&](Face f) {
+            normals[f.idx()] = SurfaceNormals::compute_face_normal(mesh_, f);
+        });
+    }
+
+    // the bits of bool properties cannot be written in parallel
+    std::vector<char> feature(mesh_.edges_size(), false);
+    parallel_for(mesh_.edges(), [&](Edge e) {
         if (!mesh_.is_boundary(e))
         {
             const auto f0 = mesh_.face(mesh_.halfedge(e, 0));
             const auto f1 = mesh_.face(mesh_.halfedge(e, 1));
 
-            const Normal n0 = SurfaceNormals::compute_face_normal(mesh_, f0);
-            const Normal n1 = SurfaceNormals::compute_face_normal(mesh_, f1);
+            const Normal n0 = cache ? cache->face_normal(f0)
+                                    : normals[f0.idx()];
+            const Normal n1 = cache ? cache->face_normal(f1)
+                                    : normals[f1.idx()];
 
-            if (dot(n0, n1) < feature_cosine)
-            {
-                efeature_[e] = true;
-                vfeature_[mesh_.vertex(e, 0)] = true;
-                vfeature_[mesh_.vertex(e, 1)] = true;
-            }
+            feature[e.idx()] = dot(n0, n1) < feature_cosine;
+        }
+    });
+
+    for (auto e : mesh_.edges())
+    {
+        if (feature[e.idx()])
+        {
+            efeature_[e] = true;
+            vfeature_[mesh_.vertex(e, 0)] = true;
+            vfeature_[mesh_.vertex(e, 1)] = true;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceFeatures::detect_angle(Scalar angle,
+                                   const std::vector<Face>& faces)
+{
+    const Scalar feature_cosine = cos(angle / 180.0 * M_PI);
+    const GeometryCache* cache = GeometryCache::get(mesh_);
+
+    // the interior edges of the faces
+    std::vector<Edge> edges;
+    for (auto f : faces)
+        for (auto h : mesh_.halfedges(f))
+            if (!mesh_.is_boundary(mesh_.edge(h)))
+                edges.push_back(mesh_.edge(h));
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    for (auto e : edges)
+    {
+        const auto f0 = mesh_.face(mesh_.halfedge(e, 0));
+        const auto f1 = mesh_.face(mesh_.halfedge(e, 1));
+
+        const Normal n0 =
+            cache ? cache->face_normal(f0)
+                  : SurfaceNormals::compute_face_normal(mesh_, f0);
+        const Normal n1 =
+            cache ? cache->face_normal(f1)
+                  : SurfaceNormals::compute_face_normal(mesh_, f1);
+
+        efeature_[e] = dot(n0, n1) < feature_cosine;
+    }
+
+    // a vertex is a feature if one of its edges is
+    for (auto e : edges)
+    {
+        for (int i = 0; i < 2; ++i)
+        {
+            const Vertex v = mesh_.vertex(e, i);
+            vfeature_[v] = false;
+            for (auto h : mesh_.halfedges(v))
+                if (efeature_[mesh_.edge(h)])
+                {
+                    vfeature_[v] = true;
+                    break;
+                }
         }
     }
 }
@@ -11,6 +11,8 @@
 
 #include <pmp/SurfaceMesh.h>
 
+#include <vector>
+
 //=============================================================================
 
 namespace pmp {
@@ -35,9 +37,19 @@ public:
     //! Mark all boundary edges as features.
     void detect_boundary();
 
-    //! Mark edges with dihedral angle larger than \p angle as feature.
+    //! \brief Mark edges with dihedral angle larger than \p angle as feature.
+    //! \details Runs in parallel and uses the face normals of a valid
+    //! GeometryCache.
     void detect_angle(Scalar angle);
 
+    //! \brief Re-detect the dihedral angle features of the edges of the
+    //! modified \p faces.
+    //! \details Marks the interior edges of the faces with dihedral angle
+    //! larger than \p angle and unmarks the others, and updates the
+    //! vertex features of their end points. Boundary edges are left as
+    //! they are. Takes time proportional to the number of faces.
+    void detect_angle(Scalar angle, const std::vector<Face>& faces);
+
 private:
     SurfaceMesh& mesh_;
 
@@ -9,6 +9,7 @@
 
 #include <pmp/algorithms/SurfaceGeodesic.h>
 #include <pmp/MatVec.h>
+#include <pmp/Parallel.h>
 
 //=============================================================================
 
@@ -19,42 +20,75 @@ namespace pmp {
 SurfaceGeodesic::SurfaceGeodesic(SurfaceMesh& mesh, 
                                  bool use_virtual_edges)
     : mesh_(mesh),
-      use_virtual_edges_(use_virtual_edges)
+      use_virtual_edges_(use_virtual_edges),
+      own_virtual_edges_(false),
+      front_(nullptr),
+      heap_arity_(4),
+      bound_(nullptr)
 {
-    distance_  = mesh_.add_vertex_property<Scalar>("geodesic:distance");
-    processed_ = mesh_.add_vertex_property<bool>("geodesic:processed");
+    reset();
 
     if (use_virtual_edges_)
-        find_virtual_edges();
+    {
+        // reuse the virtual edges of the mesh, if any
+        virtual_vertex_ =
+            mesh_.get_halfedge_property<Vertex>("geodesic:virtual_vertex");
+        virtual_length_ =
+            mesh_.get_halfedge_property<Scalar>("geodesic:virtual_length");
+        if (!virtual_vertex_ || !virtual_length_)
+            find_virtual_edges();
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+SurfaceGeodesic::SurfaceGeodesic(const SurfaceGeodesic& other)
+    : mesh_(other.mesh_),
+      use_virtual_edges_(other.use_virtual_edges_),
+      own_virtual_edges_(false),
+      virtual_vertex_(other.virtual_vertex_),
+      virtual_length_(other.virtual_length_),
+      front_(nullptr),
+      heap_arity_(other.heap_arity_),
+      bound_(nullptr)
+{
+    reset();
 }
 
 //-----------------------------------------------------------------------------
 
 SurfaceGeodesic::~SurfaceGeodesic()
 {
-    mesh_.remove_vertex_property(distance_);
-    mesh_.remove_vertex_property(processed_);
+    if (own_virtual_edges_)
+    {
+        mesh_.remove_halfedge_property(virtual_vertex_);
+        mesh_.remove_halfedge_property(virtual_length_);
+    }
 }
 
 //-----------------------------------------------------------------------------
 
 void SurfaceGeodesic::find_virtual_edges()
 {
-    Halfedge hh, hhh;
-    Vertex vh0, vh1, vhn, start_vh0, start_vh1;
-    Point pp, p0, p1, pn, p, d0, d1;
-    Point X, Y;
-    vec2 v0, v1, vn, v, d;
-    Scalar f, alpha, beta, tan_beta;
+    virtual_vertex_ =
+        mesh_.halfedge_property<Vertex>("geodesic:virtual_vertex");
+    virtual_length_ =
+        mesh_.halfedge_property<Scalar>("geodesic:virtual_length", 0);
+    own_virtual_edges_ = true;
 
     const Scalar one(1.0), minus_one(-1.0);
     const Scalar max_angle = 90.0 / 180.0 * M_PI;
     const Scalar max_angle_cos = cos(max_angle);
 
-    virtual_edges_.clear();
+    // each vertex only writes its outgoing halfedges
+    parallel_for(mesh_.vertices(), [&](Vertex vv) {
+        Halfedge hh, hhh;
+        Vertex vh0, vh1, vhn, start_vh0, start_vh1;
+        Point pp, p0, p1, pn, p, d0, d1;
+        Point X, Y;
+        vec2 v0, v1, vn, v, d;
+        Scalar f, alpha, beta, tan_beta;
 
-    for (auto vv : mesh_.vertices())
-    {
         pp = mesh_.position(vv);
 
         for (auto h : mesh_.halfedges(vv))
@@ -114,9 +148,8 @@ void SurfaceGeodesic::find_virtual_edges()
                         // point in tolerance?
                         if ((fabs(vn[1]) / fabs(vn[0])) < tan_beta)
                         {
-                            virtual_edges_.insert(
-                                std::pair<Halfedge, VirtualEdge>(
-                                    h, VirtualEdge(vhn, norm(vn))));
+                            virtual_vertex_[h] = vhn;
+                            virtual_length_[h] = norm(vn);
                             break;
                         }
 
@@ -143,14 +176,40 @@ void SurfaceGeodesic::find_virtual_edges()
                 }
             }
         }
-    }
+    });
 
-    std::clog << "[Geodesic] Found " << virtual_edges_.size()
+    size_t n_virtual_edges = 0;
+    for (auto h : mesh_.halfedges())
+        if (virtual_vertex_[h].is_valid())
+            ++n_virtual_edges;
+    std::clog << "[Geodesic] Found " << n_virtual_edges
               << " virtual edges\n";
 }
 
 //-----------------------------------------------------------------------------
 
+void SurfaceGeodesic::reset()
+{
+    // vertices added to the mesh are not reached yet
+    const size_t n = mesh_.vertices_size();
+    if (distance_.size() < n)
+    {
+        distance_.resize(n, FLT_MAX);
+        processed_.resize(n, false);
+        heap_pos_.resize(n, -1);
+    }
+
+    for (auto v : touched_)
+    {
+        distance_[v.idx()] = FLT_MAX;
+        processed_[v.idx()] = false;
+        heap_pos_[v.idx()] = -1;
+    }
+    touched_.clear();
+}
+
+//-----------------------------------------------------------------------------
+
 unsigned int SurfaceGeodesic::compute(const std::vector<Vertex>& seed,
                                       Scalar maxdist,
                                       unsigned int maxnum,
@@ -159,7 +218,8 @@ unsigned int SurfaceGeodesic::compute(const std::vector<Vertex>& seed,
     unsigned int num(0);
 
     // generate front
-    front_   = new PriorityQueue(VertexCmp(distance_));
+    front_   = new PriorityQueue(HeapInterface(distance_, heap_pos_),
+                                 heap_arity_);
 
 
     // initialize front with given seed
@@ -192,6 +252,18 @@ unsigned int SurfaceGeodesic::compute(const std::vector<Vertex>& seed,
 
 //-----------------------------------------------------------------------------
 
+unsigned int SurfaceGeodesic::compute_below(const std::vector<Vertex>& seed,
+                                            const std::vector<Scalar>& bound,
+                                            std::vector<Vertex>* neighbors)
+{
+    bound_ = &bound;
+    const unsigned int num = compute(seed, FLT_MAX, INT_MAX, neighbors);
+    bound_ = nullptr;
+    return num;
+}
+
+//-----------------------------------------------------------------------------
+
 unsigned int SurfaceGeodesic::init_front(const std::vector<Vertex>& seed,
                                          std::vector<Vertex>* neighbors)
 {
@@ -200,12 +272,8 @@ unsigned int SurfaceGeodesic::init_front(const std::vector<Vertex>& seed,
     if (seed.empty())
         return num;
 
-    // reset all vertices
-    for (auto v : mesh_.vertices())
-    {
-        processed_[v] = false;
-        distance_[v]  = FLT_MAX;
-    }
+    // reset the vertices of the previous query
+    reset();
 
     // initialize neighbor array
     if (neighbors)
@@ -214,8 +282,9 @@ unsigned int SurfaceGeodesic::init_front(const std::vector<Vertex>& seed,
     // initialize seed vertices
     for (auto v : seed)
     {
-        processed_[v] = true;
-        distance_[v]  = 0.0;
+        processed_[v.idx()] = true;
+        distance_[v.idx()]  = 0.0;
+        touched_.push_back(v);
     }
 
     // initialize seed's one-ring
@@ -225,10 +294,12 @@ unsigned int SurfaceGeodesic::init_front(const std::vector<Vertex>& seed,
         {
             const Scalar dist =
                 pmp::distance(mesh_.position(v), mesh_.position(vv));
-            if (dist < distance_[vv])
+            if (dist < distance_[vv.idx()])
             {
-                distance_[vv]  = dist;
-                processed_[vv] = true;
+                if (distance_[vv.idx()] == FLT_MAX)
+                    touched_.push_back(vv);
+                distance_[vv.idx()]  = dist;
+                processed_[vv.idx()] = true;
                 ++num;
                 if (neighbors) neighbors->push_back(vv);
             }
@@ -243,7 +314,7 @@ unsigned int SurfaceGeodesic::init_front(const std::vector<Vertex>& seed,
         {
             for (auto vvv : mesh_.vertices(vv))
             {
-                if (!processed_[vvv])
+                if (!processed_[vvv.idx()])
                 {
                     heap_vertex(vvv);
                 }
@@ -264,26 +335,30 @@ unsigned int SurfaceGeodesic::propagate_front(Scalar maxdist, unsigned int maxnu
     while (!front_->empty())
     {
         // find minimum vertex, remove it from queue
-        auto v = *front_->begin();
-        front_->erase(front_->begin());
-        assert(!processed_[v]);
-        processed_[v] = true;
+        auto v = front_->front();
+        front_->pop_front();
+        assert(!processed_[v.idx()]);
+        processed_[v.idx()] = true;
         ++num;
         if (neighbors) neighbors->push_back(v);
 
 
         // did we reach maximum distance?
-        if (distance_[v] > maxdist)
+        if (distance_[v.idx()] > maxdist)
             break;
 
         // did we reach maximum number of neighbors
         if (num >= maxnum)
             break;
 
+        // do not propagate beyond the bound
+        if (bound_ && distance_[v.idx()] >= (*bound_)[v.idx()])
+            continue;
+
         // update front
         for (auto vv : mesh_.vertices(v))
         {
-            if (!processed_[vv])
+            if (!processed_[vv.idx()])
             {
                 heap_vertex(vv);
             }
@@ -297,26 +372,25 @@ unsigned int SurfaceGeodesic::propagate_front(Scalar maxdist, unsigned int maxnu
 
 void SurfaceGeodesic::heap_vertex(Vertex v)
 {
-    assert(!processed_[v]);
+    assert(!processed_[v.idx()]);
 
     Vertex v0, v1, vv, v0_min, v1_min;
     Scalar dist, dist_min(FLT_MAX), d;
-    typename VirtualEdges::const_iterator ve_it, ve_end(virtual_edges_.end());
     bool found(false);
 
     for (auto h : mesh_.halfedges(v))
     {
         if (!mesh_.is_boundary(h))
         {
-            ve_it = virtual_edges_.find(h);
+            vv = use_virtual_edges_ ? virtual_vertex_[h] : Vertex();
 
             // no virtual edge
-            if (ve_it == ve_end)
+            if (!vv.is_valid())
             {
                 v0 = mesh_.to_vertex(h);
                 v1 = mesh_.to_vertex(mesh_.next_halfedge(h));
 
-                if (processed_[v0] && processed_[v1])
+                if (processed_[v0.idx()] && processed_[v1.idx()])
                 {
                     dist = distance(v0, v1, v);
                     if (dist < dist_min)
@@ -332,10 +406,9 @@ void SurfaceGeodesic::heap_vertex(Vertex v)
             {
                 v0 = mesh_.to_vertex(h);
                 v1 = mesh_.to_vertex(mesh_.next_halfedge(h));
-                vv = ve_it->second.vertex;
-                d = ve_it->second.length;
+                d = virtual_length_[h];
 
-                if (processed_[v0] && processed_[vv])
+                if (processed_[v0.idx()] && processed_[vv.idx()])
                 {
                     dist = distance(v0, vv, v, FLT_MAX, d);
                     if (dist < dist_min)
@@ -345,7 +418,7 @@ void SurfaceGeodesic::heap_vertex(Vertex v)
                     }
                 }
 
-                if (processed_[v1] && processed_[vv])
+                if (processed_[v1.idx()] && processed_[vv.idx()])
                 {
                     dist = distance(vv, v1, v, d, FLT_MAX);
                     if (dist < dist_min)
@@ -361,22 +434,23 @@ void SurfaceGeodesic::heap_vertex(Vertex v)
     // update priority queue
     if (found)
     {
-        if (distance_[v] != FLT_MAX)
+        distance_[v.idx()] = dist_min;
+        if (front_->is_stored(v))
         {
-            auto it = front_->find(v);
-            assert(it != front_->end());
-            front_->erase(it);
+            front_->update(v);
+        }
+        else
+        {
+            front_->insert(v);
+            touched_.push_back(v);
         }
-
-        distance_[v] = dist_min;
-        front_->insert(v);
     }
     else
     {
-        if (distance_[v] != FLT_MAX)
+        if (front_->is_stored(v))
         {
-            front_->erase(v);
-            distance_[v] = FLT_MAX;
+            front_->remove(v);
+            distance_[v.idx()] = FLT_MAX;
         }
     }
 }
@@ -398,13 +472,13 @@ Scalar SurfaceGeodesic::distance(Vertex v0, Vertex v1, Vertex v2, Scalar r0,
     double a, b;
 
     // choose points such that TB>TA and hence u>0
-    if (distance_[v0] < distance_[v1])
+    if (distance_[v0.idx()] < distance_[v1.idx()])
     {
         A = mesh_.position(v0);
         B = mesh_.position(v1);
         C = mesh_.position(v2);
-        TA = distance_[v0];
-        TB = distance_[v1];
+        TA = distance_[v0.idx()];
+        TB = distance_[v1.idx()];
         a = r1 == FLT_MAX ? pmp::distance(B, C) : r1;
         b = r0 == FLT_MAX ? pmp::distance(A, C) : r0;
     }
@@ -413,8 +487,8 @@ Scalar SurfaceGeodesic::distance(Vertex v0, Vertex v1, Vertex v2, Scalar r0,
         A = mesh_.position(v1);
         B = mesh_.position(v0);
         C = mesh_.position(v2);
-        TA = distance_[v1];
-        TB = distance_[v0];
+        TA = distance_[v1.idx()];
+        TB = distance_[v0.idx()];
         a = r0 == FLT_MAX ? pmp::distance(B, C) : r0;
         b = r1 == FLT_MAX ? pmp::distance(A, C) : r1;
     }
@@ -457,18 +531,18 @@ void SurfaceGeodesic::distance_to_texture_coordinates()
     Scalar maxdist(0);
     for (auto v : mesh_.vertices())
     {
-        if (distance_[v] < FLT_MAX)
+        if (distance_[v.idx()] < FLT_MAX)
         {
-            maxdist = std::max(maxdist, distance_[v]);
+            maxdist = std::max(maxdist, distance_[v.idx()]);
         }
     }
 
     auto tex = mesh_.vertex_property<TexCoord>("v:tex");
     for (auto v : mesh_.vertices())
     {
-        if (distance_[v] < FLT_MAX)
+        if (distance_[v.idx()] < FLT_MAX)
         {
-            tex[v] = TexCoord(distance_[v] / maxdist, 0.0);
+            tex[v] = TexCoord(distance_[v.idx()] / maxdist, 0.0);
         }
         else
         {
@@ -10,8 +10,8 @@
 //=============================================================================
 
 #include <pmp/SurfaceMesh.h>
+#include <pmp/algorithms/Heap.h>
 #include <vector>
-#include <set>
 #include <float.h>
 #include <limits.h>
 
@@ -31,13 +31,38 @@ namespace pmp {
 //! The methods works by a Dykstra-like breadth first traversal from
 //! the seed vertices, implemented by a head structure.
 //! See \cite kimmel_1998_geodesic for details.
+//!
+//! Each call of compute() only resets the vertices reached by the previous
+//! call, such that a local query bounded by a maximum distance or number of
+//! neighbors costs time proportional to the vertices it reaches. The
+//! distances are stored by the object, not the mesh. Hence, several objects,
+//! e.g., one copy per thread, can compute distances on the same mesh
+//! concurrently:
+//! \code
+//! SurfaceGeodesic geodesic(mesh);
+//! #pragma omp parallel
+//! {
+//!     SurfaceGeodesic local(geodesic);
+//!     ...
+//!     local.compute(seed, 0.02);
+//! }
+//! \endcode
 class SurfaceGeodesic
 {
 public:
-    //! Construct with mesh. Computes virtual edges only (if set to true).
-    //! Call compute() to compute geodesic distances.
+    //! \brief Construct with mesh. Computes virtual edges only (if set to true).
+    //! \details Call compute() to compute geodesic distances. The virtual
+    //! edges are stored in the halfedge properties "geodesic:virtual_vertex"
+    //! and "geodesic:virtual_length". If the mesh already has them, e.g.,
+    //! read from a .pmp file written with IOFlags::use_custom_properties
+    //! while another SurfaceGeodesic existed, they are reused and kept on
+    //! destruction. Otherwise they are computed and removed on destruction.
     SurfaceGeodesic(SurfaceMesh& mesh, bool use_virtual_edges = true);
 
+    //! \brief Construct for the mesh of \p other, sharing its virtual edges.
+    //! \details \p other has to outlive the copy.
+    SurfaceGeodesic(const SurfaceGeodesic& other);
+
     // destructor
     ~SurfaceGeodesic();
 
@@ -50,12 +75,31 @@ public:
                          unsigned int maxnum = INT_MAX,
                          std::vector<Vertex>* neighbors = nullptr);
 
-    //! access computed geodesic distance
-    Scalar operator()(Vertex v) const { return distance_[v]; }
+    //! \brief Compute geodesic distances from \p seed where they are below
+    //! \p bound.
+    //! \details Vertices whose distance is not below their entry of
+    //! \p bound, indexed by Vertex::idx(), are not propagated further. The
+    //! query thus only reaches the region where \p seed is closer than
+    //! \p bound, e.g., the distances to previous seeds, and its cost is
+    //! proportional to that region. Returns the number of vertices reached
+    //! besides the seeds, which are stored in \p neighbors if not null.
+    unsigned int compute_below(const std::vector<Vertex>& seed,
+                               const std::vector<Scalar>& bound,
+                               std::vector<Vertex>* neighbors = nullptr);
+
+    //! access computed geodesic distance, FLT_MAX if not reached
+    Scalar operator()(Vertex v) const
+    {
+        return v.idx() < distance_.size() ? distance_[v.idx()] : FLT_MAX;
+    }
 
     //! use (normalized) distances as texture coordinates
     void distance_to_texture_coordinates();
 
+    //! \brief Set the number of children of each node of the front.
+    //! \details Has to be a power of two, the default is 4.
+    void set_heap_arity(unsigned int arity) { heap_arity_ = arity; }
+
 
 private: // private types
 
@@ -63,36 +107,46 @@ private: // private types
     class VertexCmp
     {
     public:
-        VertexCmp(const VertexProperty<Scalar>& dist) : dist_(dist) {}
+        VertexCmp(const std::vector<Scalar>& dist) : dist_(dist) {}
 
         bool operator()(Vertex v0, Vertex v1) const
         {
-            return ((dist_[v0] == dist_[v1]) ? (v0 < v1)
-                                             : (dist_[v0] < dist_[v1]));
+            const Scalar d0 = dist_[v0.idx()], d1 = dist_[v1.idx()];
+            return ((d0 == d1) ? (v0 < v1) : (d0 < d1));
         }
 
     private:
-        const VertexProperty<Scalar>& dist_;
+        const std::vector<Scalar>& dist_;
     };
 
-    // priority queue using geodesic distance as sorting criterion
-    typedef std::set<Vertex, VertexCmp> PriorityQueue;
-
-    // virtual edges for walking through obtuse triangles
-    struct VirtualEdge
+    // heap interface ordering vertices by their geodesic distance, ties are
+    // broken by the vertex index
+    class HeapInterface
     {
-        VirtualEdge(Vertex v, Scalar l) : vertex(v), length(l) {}
-        Vertex vertex;
-        Scalar length;
-    };
+    public:
+        HeapInterface(const std::vector<Scalar>& dist, std::vector<int>& pos)
+            : dist_(dist), pos_(pos)
+        {
+        }
+
+        Scalar key(Vertex v) { return dist_[v.idx()]; }
+        bool less(Vertex v0, Vertex v1) { return VertexCmp(dist_)(v0, v1); }
+        bool greater(Vertex v0, Vertex v1) { return VertexCmp(dist_)(v1, v0); }
+        int get_heap_position(Vertex v) { return pos_[v.idx()]; }
+        void set_heap_position(Vertex v, int pos) { pos_[v.idx()] = pos; }
 
-    // set for storing virtual edges
-    typedef std::map<Halfedge, VirtualEdge> VirtualEdges;
+    private:
+        const std::vector<Scalar>& dist_;
+        std::vector<int>& pos_;
+    };
 
+    // priority queue using geodesic distance as sorting criterion
+    typedef DaryHeap<Vertex, HeapInterface> PriorityQueue;
 
 private: // private methods
 
     void find_virtual_edges();
+    void reset();
     unsigned int init_front(const std::vector<Vertex>& seed,
                             std::vector<Vertex>* neighbors);
     unsigned int propagate_front(Scalar maxdist, unsigned int maxnum,
@@ -107,12 +161,24 @@ private: // private data
     SurfaceMesh& mesh_;
 
     bool use_virtual_edges_;
-    VirtualEdges virtual_edges_;
-    
+    bool own_virtual_edges_; // whether the destructor removes them
+
+    // virtual edges for walking through obtuse triangles: the vertex unfolded
+    // into the face of a halfedge and its distance to the halfedge's source
+    HalfedgeProperty<Vertex> virtual_vertex_;
+    HalfedgeProperty<Scalar> virtual_length_;
+
     PriorityQueue* front_;
+    unsigned int heap_arity_;
+
+    // vertices not below their bound are not propagated, see compute_below()
+    const std::vector<Scalar>* bound_;
 
-    VertexProperty<Scalar> distance_;
-    VertexProperty<bool> processed_;
+    // per-vertex state of the queries, indexed by Vertex::idx()
+    std::vector<Scalar> distance_;
+    std::vector<bool> processed_;
+    std::vector<int> heap_pos_;
+    std::vector<Vertex> touched_; // the vertices changed since reset()
 };
 
 //=============================================================================
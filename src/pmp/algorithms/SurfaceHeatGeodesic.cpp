@@ -0,0 +1,316 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/algorithms/SurfaceHeatGeodesic.h>
+#include <pmp/algorithms/DifferentialGeometry.h>
+#include <pmp/Parallel.h>
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+
+#include <cfloat>
+#include <limits>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+using SparseMatrix = Eigen::SparseMatrix<double>;
+using Triplet = Eigen::Triplet<double>;
+
+struct SurfaceHeatGeodesic::Solvers
+{
+    Eigen::SimplicialLDLT<SparseMatrix> heat;    // mass + t * Laplacian
+    Eigen::SimplicialLDLT<SparseMatrix> poisson; // Laplacian, pinned
+};
+
+//=============================================================================
+
+SurfaceHeatGeodesic::SurfaceHeatGeodesic(SurfaceMesh& mesh,
+                                         Scalar time_factor)
+    : mesh_(mesh), valid_(false), n_components_(0), solvers_(new Solvers)
+{
+    distance_ = mesh_.add_vertex_property<Scalar>("heat:distance", FLT_MAX);
+
+    if (!mesh_.is_triangle_mesh() || mesh_.n_vertices() == 0)
+    {
+        std::cerr << "SurfaceHeatGeodesic: Not a triangle mesh\n";
+        return;
+    }
+
+    // rows of the linear systems
+    index_.assign(mesh_.vertices_size(), PMP_MAX_INDEX);
+    for (auto v : mesh_.vertices())
+    {
+        index_[v.idx()] = IndexType(vertices_.size());
+        vertices_.push_back(v);
+        points_.push_back(dvec3(mesh_.position(v)));
+    }
+    const IndexType n = IndexType(vertices_.size());
+
+    // per-face gradients and cotangents
+    triangles_.reserve(mesh_.n_faces());
+    for (auto f : mesh_.faces())
+    {
+        Triangle t;
+        auto fv = mesh_.vertices(f);
+        for (int i = 0; i < 3; ++i, ++fv)
+            t.v[i] = index_[(*fv).idx()];
+
+        const dvec3& p0 = points_[t.v[0]];
+        const dvec3 normal =
+            cross(points_[t.v[1]] - p0, points_[t.v[2]] - p0);
+        const double sqr_area = sqrnorm(normal); // four times squared area
+
+        for (int i = 0; i < 3; ++i)
+        {
+            const dvec3& pi = points_[t.v[i]];
+            const dvec3& pj = points_[t.v[(i + 1) % 3]];
+            const dvec3& pk = points_[t.v[(i + 2) % 3]];
+            if (sqr_area > std::numeric_limits<double>::min())
+            {
+                t.gradient[i] = cross(normal, pk - pj) / sqr_area;
+                t.cot[i] = clamp_cot(dot(pj - pi, pk - pi) / sqrt(sqr_area));
+            }
+            else
+            {
+                t.gradient[i] = dvec3(0, 0, 0);
+                t.cot[i] = 0;
+            }
+        }
+        triangles_.push_back(t);
+    }
+
+    // lumped mass matrix, positive semi-definite cotan Laplacian, and the
+    // connected components
+    std::vector<double> mass(n, 0.0);
+    std::vector<Triplet> laplace;
+    std::vector<IndexType> parent(n);
+    for (IndexType i = 0; i < n; ++i)
+        parent[i] = i;
+    auto find = [&](IndexType i) {
+        while (parent[i] != i)
+            i = parent[i] = parent[parent[i]];
+        return i;
+    };
+
+    double edge_length = 0;
+    for (const auto& t : triangles_)
+    {
+        const dvec3& p0 = points_[t.v[0]];
+        const double area =
+            0.5 * norm(cross(points_[t.v[1]] - p0, points_[t.v[2]] - p0));
+        for (int i = 0; i < 3; ++i)
+        {
+            const IndexType j = t.v[(i + 1) % 3];
+            const IndexType k = t.v[(i + 2) % 3];
+            const double w = 0.5 * t.cot[i];
+            mass[t.v[i]] += area / 3.0;
+            laplace.emplace_back(j, j, w);
+            laplace.emplace_back(k, k, w);
+            laplace.emplace_back(j, k, -w);
+            laplace.emplace_back(k, j, -w);
+            edge_length += distance(points_[j], points_[k]);
+            parent[find(j)] = find(k);
+        }
+    }
+    edge_length /= 3.0 * std::max(triangles_.size(), size_t(1));
+    const double t = time_factor * edge_length * edge_length;
+
+    // heat flow: (M + t L) u = u0
+    std::vector<Triplet> heat;
+    heat.reserve(laplace.size() + n);
+    for (const auto& l : laplace)
+        heat.emplace_back(l.row(), l.col(), t * l.value());
+    for (IndexType i = 0; i < n; ++i)
+    {
+        // isolated vertices get a unit mass to keep the system regular
+        heat.emplace_back(i, i, mass[i] > 0 ? mass[i] : 1.0);
+    }
+    SparseMatrix A(n, n);
+    A.setFromTriplets(heat.begin(), heat.end());
+    solvers_->heat.compute(A);
+    if (solvers_->heat.info() != Eigen::Success)
+    {
+        std::cerr << "SurfaceHeatGeodesic: Could not factor heat flow\n";
+        return;
+    }
+
+    // Poisson equation: L phi = div X, pinned to zero at one vertex per
+    // connected component
+    component_.resize(n);
+    std::vector<IndexType> component_of_root(n, PMP_MAX_INDEX);
+    poisson_index_.resize(n);
+    IndexType n_free = 0;
+    for (IndexType i = 0; i < n; ++i)
+    {
+        const IndexType root = find(i);
+        if (component_of_root[root] == PMP_MAX_INDEX)
+        {
+            component_of_root[root] = n_components_++;
+            poisson_index_[i] = PMP_MAX_INDEX;
+        }
+        else
+        {
+            poisson_index_[i] = n_free++;
+        }
+        component_[i] = component_of_root[root];
+    }
+
+    std::vector<Triplet> poisson;
+    poisson.reserve(laplace.size());
+    for (const auto& l : laplace)
+    {
+        const IndexType r = poisson_index_[l.row()];
+        const IndexType c = poisson_index_[l.col()];
+        if (r != PMP_MAX_INDEX && c != PMP_MAX_INDEX)
+            poisson.emplace_back(r, c, l.value());
+    }
+    if (n_free > 0)
+    {
+        SparseMatrix L(n_free, n_free);
+        L.setFromTriplets(poisson.begin(), poisson.end());
+        solvers_->poisson.compute(L);
+        if (solvers_->poisson.info() != Eigen::Success)
+        {
+            std::cerr << "SurfaceHeatGeodesic: Could not factor Laplacian\n";
+            return;
+        }
+    }
+
+    valid_ = true;
+}
+
+//-----------------------------------------------------------------------------
+
+SurfaceHeatGeodesic::~SurfaceHeatGeodesic()
+{
+    mesh_.remove_vertex_property(distance_);
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceHeatGeodesic::compute(const std::vector<Vertex>& seed)
+{
+    std::vector<std::vector<Scalar>> distances;
+    if (!compute(std::vector<std::vector<Vertex>>(1, seed), distances))
+        return false;
+
+    for (auto v : mesh_.vertices())
+        distance_[v] = distances[0][v.idx()];
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceHeatGeodesic::compute(
+    const std::vector<std::vector<Vertex>>& seeds,
+    std::vector<std::vector<Scalar>>& distances) const
+{
+    distances.clear();
+    if (!valid_)
+        return false;
+    for (const auto& seed : seeds)
+    {
+        if (seed.empty())
+            return false;
+    }
+
+    const IndexType n = IndexType(vertices_.size());
+    const size_t k = seeds.size();
+
+    // diffuse heat from the seeds
+    Eigen::MatrixXd U = Eigen::MatrixXd::Zero(n, k);
+    for (size_t c = 0; c < k; ++c)
+    {
+        for (auto v : seeds[c])
+            U(index_[v.idx()], c) = 1.0;
+    }
+    U = solvers_->heat.solve(U);
+
+    // divergence of the normalized negative gradient
+    const IndexType n_free = n - n_components_;
+    Eigen::MatrixXd B = Eigen::MatrixXd::Zero(n_free, k);
+    parallel_for_chunks(
+        k,
+        [&](size_t begin, size_t end) {
+            std::vector<double> div(n);
+            for (size_t c = begin; c < end; ++c)
+            {
+                std::fill(div.begin(), div.end(), 0.0);
+                for (const auto& t : triangles_)
+                {
+                    dvec3 X = -(U(t.v[0], c) * t.gradient[0] +
+                                U(t.v[1], c) * t.gradient[1] +
+                                U(t.v[2], c) * t.gradient[2]);
+                    const double length = norm(X);
+                    if (length <= std::numeric_limits<double>::min())
+                        continue;
+                    X /= length;
+
+                    for (int i = 0; i < 3; ++i)
+                    {
+                        const int j = (i + 1) % 3, l = (i + 2) % 3;
+                        const dvec3& pi = points_[t.v[i]];
+                        div[t.v[i]] +=
+                            0.5 * (t.cot[l] * dot(points_[t.v[j]] - pi, X) +
+                                   t.cot[j] * dot(points_[t.v[l]] - pi, X));
+                    }
+                }
+
+                // the Laplacian is negated to be positive semi-definite
+                for (IndexType i = 0; i < n; ++i)
+                {
+                    if (poisson_index_[i] != PMP_MAX_INDEX)
+                        B(poisson_index_[i], c) = -div[i];
+                }
+            }
+        },
+        1);
+
+    Eigen::MatrixXd Phi;
+    if (n_free > 0)
+        Phi = solvers_->poisson.solve(B);
+
+    // shift each component to a minimum distance of zero, components without
+    // a seed are unreachable
+    distances.assign(k, std::vector<Scalar>(mesh_.vertices_size(), FLT_MAX));
+    std::vector<double> minimum(n_components_);
+    std::vector<bool> seeded(n_components_);
+    for (size_t c = 0; c < k; ++c)
+    {
+        auto phi = [&](IndexType i) {
+            return poisson_index_[i] == PMP_MAX_INDEX
+                       ? 0.0
+                       : Phi(poisson_index_[i], c);
+        };
+
+        std::fill(minimum.begin(), minimum.end(), DBL_MAX);
+        std::fill(seeded.begin(), seeded.end(), false);
+        for (auto v : seeds[c])
+            seeded[component_[index_[v.idx()]]] = true;
+        for (IndexType i = 0; i < n; ++i)
+            minimum[component_[i]] = std::min(minimum[component_[i]], phi(i));
+
+        for (IndexType i = 0; i < n; ++i)
+        {
+            if (seeded[component_[i]])
+                distances[c][vertices_[i].idx()] =
+                    Scalar(phi(i) - minimum[component_[i]]);
+        }
+    }
+
+    return true;
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
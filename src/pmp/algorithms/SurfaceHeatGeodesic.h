@@ -0,0 +1,102 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <pmp/SurfaceMesh.h>
+
+#include <memory>
+#include <vector>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \addtogroup algorithms algorithms
+//! @{
+
+//=============================================================================
+
+//! \brief Compute geodesic distances by the heat method.
+//! \details Diffuses heat from the seed vertices for a short time,
+//! normalizes its gradient and recovers the distance by solving a Poisson
+//! equation, see \cite crane_2013_geodesics. Both linear systems are
+//! factored once by the constructor, such that each set of seed vertices
+//! only costs two back-substitutions. Several seed sets are solved together
+//! as multiple right-hand sides. Compared to SurfaceGeodesic the distances
+//! are smoother but less accurate close to the seeds. Usage:
+//! \code
+//! SurfaceHeatGeodesic geodesic(mesh);
+//! geodesic.compute({Vertex(0)});
+//! Scalar d = geodesic(Vertex(42));
+//! \endcode
+class SurfaceHeatGeodesic
+{
+public:
+    //! \brief Construct with triangle mesh and factor the linear systems.
+    //! \details The diffusion time is \p time_factor times the squared mean
+    //! edge length. The mesh must not be changed while the object is used.
+    SurfaceHeatGeodesic(SurfaceMesh& mesh, Scalar time_factor = 1);
+
+    // destructor
+    ~SurfaceHeatGeodesic();
+
+    //! whether the mesh is a triangle mesh and both systems could be factored
+    bool is_valid() const { return valid_; }
+
+    //! \brief Compute the geodesic distances from the vertices \p seed.
+    //! \details Vertices not connected to a seed get the distance FLT_MAX.
+    //! \return false if is_valid() is false or \p seed is empty
+    bool compute(const std::vector<Vertex>& seed);
+
+    //! access the geodesic distance computed by compute()
+    Scalar operator()(Vertex v) const { return distance_[v]; }
+
+    //! \brief Compute the distances from several sets of seed vertices.
+    //! \details \p distances[i][v.idx()] is the distance of v to the vertices
+    //! \p seeds[i]. Solving the seed sets together is faster than solving
+    //! them one by one.
+    //! \return false if is_valid() is false or a seed set is empty
+    bool compute(const std::vector<std::vector<Vertex>>& seeds,
+                 std::vector<std::vector<Scalar>>& distances) const;
+
+private:
+    // the per-face data for the gradient and the divergence
+    struct Triangle
+    {
+        IndexType v[3];    // corners
+        dvec3 gradient[3]; // gradient of each corner's hat function
+        double cot[3];     // cotangent of the angle at each corner
+    };
+
+    // the factored systems, kept out of the header
+    struct Solvers;
+
+    SurfaceMesh& mesh_;
+    bool valid_;
+
+    std::vector<Vertex> vertices_;         // the vertex of each row
+    std::vector<IndexType> index_;         // the row of each vertex
+    std::vector<dvec3> points_;            // positions of the rows
+    std::vector<Triangle> triangles_;
+    std::vector<IndexType> component_;     // connected component of rows
+    std::vector<IndexType> poisson_index_; // row in the Poisson system
+    IndexType n_components_;
+    std::unique_ptr<Solvers> solvers_;
+
+    VertexProperty<Scalar> distance_;
+};
+
+//=============================================================================
+//! @}
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -0,0 +1,66 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/algorithms/SurfaceIntersection.h>
+#include <pmp/algorithms/TriangleKdTree.h>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+namespace {
+
+// reset the face property "f:intersecting" of mesh
+FaceProperty<bool> intersecting_faces(SurfaceMesh& mesh)
+{
+    auto intersecting = mesh.face_property<bool>("f:intersecting");
+    for (auto f : mesh.faces())
+        intersecting[f] = false;
+    return intersecting;
+}
+
+} // namespace
+
+//=============================================================================
+
+std::vector<std::pair<Face, Face>> self_intersections(SurfaceMesh& mesh)
+{
+    const TriangleKdTree tree(mesh);
+    const std::vector<std::pair<Face, Face>> pairs = tree.intersections(tree);
+
+    auto intersecting = intersecting_faces(mesh);
+    for (const auto& p : pairs)
+        intersecting[p.first] = intersecting[p.second] = true;
+    return pairs;
+}
+
+//-----------------------------------------------------------------------------
+
+std::vector<std::pair<Face, Face>> intersections(SurfaceMesh& a,
+                                                 SurfaceMesh& b)
+{
+    const TriangleKdTree tree_a(a), tree_b(b);
+    const std::vector<std::pair<Face, Face>> pairs =
+        tree_a.intersections(tree_b);
+
+    auto intersecting_a = intersecting_faces(a);
+    auto intersecting_b = intersecting_faces(b);
+    for (const auto& p : pairs)
+    {
+        intersecting_a[p.first] = true;
+        intersecting_b[p.second] = true;
+    }
+    return pairs;
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -0,0 +1,47 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <pmp/SurfaceMesh.h>
+
+#include <utility>
+#include <vector>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \addtogroup algorithms algorithms
+//! @{
+
+//=============================================================================
+
+//! \brief Find the self-intersections of the triangle mesh \p mesh.
+//! \details Marks the intersecting faces in the face property
+//! "f:intersecting" and returns the intersecting pairs, with the smaller
+//! face first. Faces sharing an edge are never reported, faces sharing a
+//! vertex only if they intersect away from it. See
+//! TriangleKdTree::intersections().
+std::vector<std::pair<Face, Face>> self_intersections(SurfaceMesh& mesh);
+
+//! \brief Find the intersections of the triangle meshes \p a and \p b.
+//! \details Marks the intersecting faces of both meshes in their face
+//! properties "f:intersecting" and returns the intersecting pairs, with the
+//! face of \p a first.
+std::vector<std::pair<Face, Face>> intersections(SurfaceMesh& a,
+                                                 SurfaceMesh& b);
+
+//=============================================================================
+//! @}
+//=============================================================================
+} // namespace pmp
+//=============================================================================
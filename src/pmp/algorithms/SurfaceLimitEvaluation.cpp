@@ -0,0 +1,807 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/algorithms/SurfaceLimitEvaluation.h>
+#include <pmp/algorithms/SurfaceNormals.h>
+#include <pmp/algorithms/DifferentialGeometry.h>
+#include <pmp/Parallel.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+namespace {
+
+// the number of local subdivision steps after which a parameter counts as
+// the extraordinary vertex itself
+const int max_levels = 32;
+
+// the control points of a patch, see LoopNet and CatmullClarkNet
+typedef std::vector<dvec3> Net;
+
+dvec3 position(const SurfaceMesh& mesh, Vertex v)
+{
+    return dvec3(mesh.position(v));
+}
+
+dvec3 normal(const dvec3& du, const dvec3& dv)
+{
+    dvec3 n = cross(du, dv);
+    const double l = norm(n);
+    return l > 0.0 ? n / l : n;
+}
+
+//== Loop =====================================================================
+
+// the basis functions of a regular patch times 12, in the coefficients of
+// the monomials u^i v^j of loop_monomials, see \cite stam_1998_exact
+const int loop_monomials[15][2] = {{0, 0}, {1, 0}, {0, 1}, {2, 0}, {1, 1},
+                                   {0, 2}, {3, 0}, {2, 1}, {1, 2}, {0, 3},
+                                   {4, 0}, {3, 1}, {2, 2}, {1, 3}, {0, 4}};
+
+// clang-format off
+const int loop_basis[12][15] = {
+    {6, 0, 0, -12, -12, -12, 8, 12, 12, 8, -1, -2, 0, -2, -1},
+    {1, 4, 2, 6, 6, 0, -4, -6, -12, -4, -1, -2, 0, 4, 2},
+    {1, 2, 4, 0, 6, 6, -4, -12, -6, -4, 2, 4, 0, -2, -1},
+    {1, -2, 2, 0, -6, 0, 2, 6, 0, -4, -1, -2, 0, 4, 2},
+    {1, -4, -2, 6, 6, 0, -4, -6, 0, 2, 1, 2, 0, -2, -1},
+    {1, -2, -4, 0, 6, 6, 2, 0, -6, -4, -1, -2, 0, 2, 1},
+    {1, 2, -2, 0, -6, 0, -4, 0, 6, 2, 2, 4, 0, -2, -1},
+    {0, 0, 0, 0, 0, 0, 2, 0, 0, 0, -1, -2, 0, 0, 0},
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 0, 0, 0},
+    {0, 0, 0, 0, 0, 0, 2, 6, 6, 2, -1, -2, 0, -2, -1},
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 1},
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0, 0, 0, -2, -1}};
+// clang-format on
+
+// the control points of a regular patch relative to its first vertex, in
+// the coordinates of the triangle (0, 0), (1, 0), (0, 1) of a lattice
+// whose triangles are (x, y), (x + 1, y), (x, y + 1) and (x + 1, y),
+// (x + 1, y + 1), (x, y + 1)
+const int loop_patch[12][2] = {{0, 0},  {1, 0},  {0, 1},  {-1, 1},
+                               {-1, 0}, {0, -1}, {1, -1}, {2, -1},
+                               {2, 0},  {1, 1},  {0, 2},  {-1, 2}};
+
+// the neighbors of a lattice vertex in counter-clockwise order
+const int loop_neighbors[6][2] = {{1, 0},  {0, 1},  {-1, 1},
+                                  {-1, 0}, {0, -1}, {1, -1}};
+
+// the points of a LoopNet behind the neighbors of its center
+const int loop_outer[5][2] = {{2, -1}, {2, 0}, {1, 1}, {0, 2}, {-1, 2}};
+
+double power(double x, int n)
+{
+    double p = 1.0;
+    for (int i = 0; i < n; ++i)
+        p *= x;
+    return p;
+}
+
+// position and partial derivatives of a regular patch with the control
+// points p at (u, v)
+void loop_regular(const dvec3* p, double u, double v, dvec3& s, dvec3& su,
+                  dvec3& sv)
+{
+    double m[15], mu[15], mv[15];
+    for (int k = 0; k < 15; ++k)
+    {
+        const int i = loop_monomials[k][0];
+        const int j = loop_monomials[k][1];
+        m[k] = power(u, i) * power(v, j);
+        mu[k] = i ? i * power(u, i - 1) * power(v, j) : 0.0;
+        mv[k] = j ? j * power(u, i) * power(v, j - 1) : 0.0;
+    }
+
+    s = su = sv = dvec3(0, 0, 0);
+    for (int c = 0; c < 12; ++c)
+    {
+        double w(0), wu(0), wv(0);
+        for (int k = 0; k < 15; ++k)
+        {
+            w += loop_basis[c][k] * m[k];
+            wu += loop_basis[c][k] * mu[k];
+            wv += loop_basis[c][k] * mv[k];
+        }
+        s += w * p[c];
+        su += wu * p[c];
+        sv += wv * p[c];
+    }
+    s /= 12.0;
+    su /= 12.0;
+    sv /= 12.0;
+}
+
+// the weight of the neighbors in the Loop rule of a vertex of valence n,
+// as in SurfaceSubdivision::loop()
+double loop_beta(int n)
+{
+    return 0.625 - std::pow(0.375 + 0.25 * std::cos(2.0 * M_PI / n), 2.0);
+}
+
+dvec3 loop_edge(const dvec3& a, const dvec3& b, const dvec3& c,
+                const dvec3& d)
+{
+    return 0.375 * (a + b) + 0.125 * (c + d);
+}
+
+// the Loop rule of the new vertex on the edge of h
+dvec3 loop_edge(const SurfaceMesh& mesh, Halfedge h)
+{
+    const Halfedge o = mesh.opposite_halfedge(h);
+    return loop_edge(position(mesh, mesh.from_vertex(h)),
+                     position(mesh, mesh.to_vertex(h)),
+                     position(mesh, mesh.to_vertex(mesh.next_halfedge(h))),
+                     position(mesh, mesh.to_vertex(mesh.next_halfedge(o))));
+}
+
+// the Loop rule of the vertex v
+dvec3 loop_vertex(const SurfaceMesh& mesh, Vertex v)
+{
+    dvec3 p(0, 0, 0);
+    int n = 0;
+    for (auto vv : mesh.vertices(v))
+    {
+        p += position(mesh, vv);
+        ++n;
+    }
+    const double beta = loop_beta(n);
+    return (1.0 - beta) * position(mesh, v) + beta / n * p;
+}
+
+// The control points around the extraordinary vertex a of valence n of the
+// triangle (a, b, c) with regular vertices b and c: a, its neighbors
+// r[0] = b, r[1] = c, ..., r[n-1] in counter-clockwise order, and the
+// points at loop_outer in the coordinates of loop_patch.
+struct LoopNet
+{
+    int n;
+    Net p;
+
+    const dvec3& ring(int i) const { return p[1 + (i % n + n) % n]; }
+
+    // the index of the point at (x, y), -1 if not in the net
+    int index(int x, int y) const
+    {
+        if (x == 0 && y == 0)
+            return 0;
+        for (int i : {0, 1, 2, -1})
+            if (x == loop_neighbors[(i + 6) % 6][0] &&
+                y == loop_neighbors[(i + 6) % 6][1])
+                return 1 + (i + n) % n;
+        for (int k = 0; k < 5; ++k)
+            if (x == loop_outer[k][0] && y == loop_outer[k][1])
+                return n + 1 + k;
+        return -1;
+    }
+
+    const dvec3& at(int x, int y) const
+    {
+        const int i = index(x, y);
+        assert(i >= 0);
+        return p[i];
+    }
+
+    // the new vertex on the edge from a to r[i]
+    dvec3 ring_edge(int i) const
+    {
+        return loop_edge(p[0], ring(i), ring(i - 1), ring(i + 1));
+    }
+
+    // the point at the lattice position (x, y) after one subdivision step,
+    // in coordinates of half the size
+    dvec3 refined(int x, int y) const
+    {
+        // new position of a vertex
+        if (x % 2 == 0 && y % 2 == 0)
+        {
+            x /= 2;
+            y /= 2;
+            if (x == 0 && y == 0)
+            {
+                dvec3 q(0, 0, 0);
+                for (int i = 0; i < n; ++i)
+                    q += ring(i);
+                const double beta = loop_beta(n);
+                return (1.0 - beta) * p[0] + beta / n * q;
+            }
+
+            dvec3 q(0, 0, 0);
+            for (auto& d : loop_neighbors)
+                q += at(x + d[0], y + d[1]);
+            return 0.625 * at(x, y) + 0.0625 * q;
+        }
+
+        // new vertex on an edge from a to b, c and d are opposite
+        int a[2], b[2], c[2], d[2];
+        if (y % 2 == 0)
+        {
+            a[0] = (x - 1) / 2, a[1] = y / 2;
+            b[0] = a[0] + 1, b[1] = a[1];
+            c[0] = a[0], c[1] = a[1] + 1;
+            d[0] = a[0] + 1, d[1] = a[1] - 1;
+        }
+        else if (x % 2 == 0)
+        {
+            a[0] = x / 2, a[1] = (y - 1) / 2;
+            b[0] = a[0], b[1] = a[1] + 1;
+            c[0] = a[0] + 1, c[1] = a[1];
+            d[0] = a[0] - 1, d[1] = a[1] + 1;
+        }
+        else
+        {
+            a[0] = (x - 1) / 2, a[1] = (y + 1) / 2;
+            b[0] = a[0] + 1, b[1] = a[1] - 1;
+            c[0] = a[0], c[1] = a[1] - 1;
+            d[0] = a[0] + 1, d[1] = a[1];
+        }
+
+        // edges of the center use its ring
+        if (a[0] == 0 && a[1] == 0)
+            return ring_edge(index(b[0], b[1]) - 1);
+        if (b[0] == 0 && b[1] == 0)
+            return ring_edge(index(a[0], a[1]) - 1);
+
+        return loop_edge(at(a[0], a[1]), at(b[0], b[1]), at(c[0], c[1]),
+                         at(d[0], d[1]));
+    }
+
+    // the net of the sub-triangle at a after one subdivision step
+    LoopNet subdivided() const
+    {
+        LoopNet net{n, Net(p.size())};
+        net.p[0] = refined(0, 0);
+        for (int i = 0; i < n; ++i)
+            net.p[1 + i] = ring_edge(i);
+        for (int k = 0; k < 5; ++k)
+            net.p[n + 1 + k] = refined(loop_outer[k][0], loop_outer[k][1]);
+        return net;
+    }
+
+    // the limit position and normal of a
+    void limit(dvec3& s, dvec3& normal) const
+    {
+        const double beta = loop_beta(n) / n;
+        const double chi = 1.0 / (3.0 / (8.0 * beta) + n);
+        dvec3 q(0, 0, 0), t0(0, 0, 0), t1(0, 0, 0);
+        for (int i = 0; i < n; ++i)
+        {
+            q += ring(i);
+            t0 += std::cos(2.0 * M_PI * i / n) * ring(i);
+            t1 += std::sin(2.0 * M_PI * i / n) * ring(i);
+        }
+        s = (1.0 - n * chi) * p[0] + chi * q;
+        normal = pmp::normal(t0, t1);
+    }
+
+    // the limit position and normal at (u, v)
+    void evaluate(double u, double v, dvec3& s, dvec3& normal) const
+    {
+        LoopNet net = *this;
+        for (int level = 0; level < max_levels; ++level)
+        {
+            dvec3 su, sv;
+            if (net.n == 6)
+            {
+                loop_regular(net.p.data(), u, v, s, su, sv);
+                normal = pmp::normal(su, sv);
+                return;
+            }
+
+            // the regular sub-triangles
+            if (u + v >= 0.5)
+            {
+                int origin[2], sign;
+                if (u >= 0.5)
+                {
+                    origin[0] = 1, origin[1] = 0, sign = 1;
+                    u = 2.0 * u - 1.0, v = 2.0 * v;
+                }
+                else if (v >= 0.5)
+                {
+                    origin[0] = 0, origin[1] = 1, sign = 1;
+                    u = 2.0 * u, v = 2.0 * v - 1.0;
+                }
+                else
+                {
+                    origin[0] = 1, origin[1] = 1, sign = -1;
+                    u = 1.0 - 2.0 * u, v = 1.0 - 2.0 * v;
+                }
+
+                dvec3 patch[12];
+                for (int k = 0; k < 12; ++k)
+                    patch[k] = net.refined(origin[0] + sign * loop_patch[k][0],
+                                           origin[1] + sign * loop_patch[k][1]);
+                loop_regular(patch, u, v, s, su, sv);
+                normal = pmp::normal(su, sv);
+                return;
+            }
+
+            if (u == 0.0 && v == 0.0)
+                break;
+            net = net.subdivided();
+            u *= 2.0;
+            v *= 2.0;
+        }
+        net.limit(s, normal);
+    }
+};
+
+// the net of the corner at the start of h after one subdivision step of the
+// face of h
+LoopNet loop_corner(const SurfaceMesh& mesh, Halfedge h)
+{
+    const Vertex a = mesh.from_vertex(h);
+    const int n = mesh.valence(a);
+
+    LoopNet net{n, Net(n + 6)};
+    net.p[0] = loop_vertex(mesh, a);
+    Halfedge hh = h;
+    for (int i = 0; i < n; ++i, hh = mesh.ccw_rotated_halfedge(hh))
+        net.p[1 + i] = loop_edge(mesh, hh);
+
+    const Halfedge h0 = mesh.next_halfedge(mesh.cw_rotated_halfedge(h));
+    const Halfedge h1 = mesh.next_halfedge(mesh.ccw_rotated_halfedge(h));
+    net.p[n + 1] = loop_edge(mesh, h0);
+    net.p[n + 2] = loop_vertex(mesh, mesh.to_vertex(h));
+    net.p[n + 3] = loop_edge(mesh, mesh.next_halfedge(h));
+    net.p[n + 4] = loop_vertex(mesh, mesh.to_vertex(mesh.next_halfedge(h)));
+    net.p[n + 5] = loop_edge(mesh, h1);
+    return net;
+}
+
+// the limit of the face of h at (u, v) for the vertices from(h), to(h), and
+// the third one
+void loop_limit(const SurfaceMesh& mesh, Halfedge h, double u, double v,
+                dvec3& s, dvec3& normal)
+{
+    const double w = 1.0 - u - v;
+    const Halfedge h1 = mesh.next_halfedge(h);
+    const Halfedge h2 = mesh.next_halfedge(h1);
+
+    if (u + v <= 0.5)
+        loop_corner(mesh, h).evaluate(2.0 * u, 2.0 * v, s, normal);
+    else if (u >= 0.5)
+        loop_corner(mesh, h1).evaluate(2.0 * v, 2.0 * w, s, normal);
+    else if (v >= 0.5)
+        loop_corner(mesh, h2).evaluate(2.0 * w, 2.0 * u, s, normal);
+    else
+    {
+        // the regular middle triangle, at the edge points of h1, h2, and h
+        auto edge = [&](Halfedge hh, bool next) {
+            hh = mesh.opposite_halfedge(hh);
+            return loop_edge(mesh, next ? mesh.next_halfedge(hh)
+                                        : mesh.prev_halfedge(hh));
+        };
+        const dvec3 patch[12] = {loop_edge(mesh, h1),
+                                 loop_edge(mesh, h2),
+                                 loop_edge(mesh, h),
+                                 loop_vertex(mesh, mesh.to_vertex(h)),
+                                 edge(h1, true),
+                                 edge(h1, false),
+                                 loop_vertex(mesh, mesh.to_vertex(h1)),
+                                 edge(h2, true),
+                                 edge(h2, false),
+                                 loop_vertex(mesh, mesh.from_vertex(h)),
+                                 edge(h, true),
+                                 edge(h, false)};
+        dvec3 su, sv;
+        loop_regular(patch, 1.0 - 2.0 * u, 1.0 - 2.0 * v, s, su, sv);
+        normal = pmp::normal(su, sv);
+    }
+}
+
+//== Catmull-Clark ============================================================
+
+// the uniform cubic B-spline basis functions and their derivatives at t
+void bspline(double t, double* b, double* db)
+{
+    const double s = 1.0 - t;
+    b[0] = s * s * s / 6.0;
+    b[1] = (3.0 * t * t * t - 6.0 * t * t + 4.0) / 6.0;
+    b[2] = (-3.0 * t * t * t + 3.0 * t * t + 3.0 * t + 1.0) / 6.0;
+    b[3] = t * t * t / 6.0;
+    db[0] = -0.5 * s * s;
+    db[1] = 0.5 * (3.0 * t * t - 4.0 * t);
+    db[2] = 0.5 * (-3.0 * t * t + 2.0 * t + 1.0);
+    db[3] = 0.5 * t * t;
+}
+
+// position and partial derivatives of the bicubic patch with the control
+// points p[j][i] at (i - 1, j - 1) of the unit square at (u, v)
+void cc_regular(const dvec3 p[4][4], double u, double v, dvec3& s, dvec3& su,
+                dvec3& sv)
+{
+    double bu[4], dbu[4], bv[4], dbv[4];
+    bspline(u, bu, dbu);
+    bspline(v, bv, dbv);
+
+    s = su = sv = dvec3(0, 0, 0);
+    for (int j = 0; j < 4; ++j)
+        for (int i = 0; i < 4; ++i)
+        {
+            s += bu[i] * bv[j] * p[j][i];
+            su += dbu[i] * bv[j] * p[j][i];
+            sv += bu[i] * dbv[j] * p[j][i];
+        }
+}
+
+// the centroid of a face
+dvec3 cc_face(const SurfaceMesh& mesh, Face f)
+{
+    dvec3 p(0, 0, 0);
+    int n = 0;
+    for (auto v : mesh.vertices(f))
+    {
+        p += position(mesh, v);
+        ++n;
+    }
+    return p / n;
+}
+
+// the Catmull-Clark rule of the new vertex on the edge of h
+dvec3 cc_edge(const SurfaceMesh& mesh, Halfedge h)
+{
+    const Halfedge o = mesh.opposite_halfedge(h);
+    return 0.25 * (position(mesh, mesh.from_vertex(h)) +
+                   position(mesh, mesh.to_vertex(h)) +
+                   cc_face(mesh, mesh.face(h)) + cc_face(mesh, mesh.face(o)));
+}
+
+// the Catmull-Clark rule of the vertex v, as in
+// SurfaceSubdivision::catmull_clark()
+dvec3 cc_vertex(const SurfaceMesh& mesh, Vertex v)
+{
+    const double n = mesh.valence(v);
+    dvec3 p(0, 0, 0);
+    for (auto vv : mesh.vertices(v))
+        p += position(mesh, vv);
+    for (auto f : mesh.faces(v))
+        p += cc_face(mesh, f);
+    return p / (n * n) + (n - 2.0) / n * position(mesh, v);
+}
+
+// the points of a CatmullClarkNet behind the neighbors of its center
+const int cc_outer[7][2] = {{2, -1}, {2, 0}, {2, 1}, {2, 2},
+                            {1, 2},  {0, 2}, {-1, 2}};
+
+// The control points around the extraordinary vertex a of valence n of the
+// quad (a, b, c, d) at (0, 0), (1, 0), (1, 1), (0, 1) with regular b, c,
+// and d: a, its neighbors e[0] = b, e[1] = d, ... and the opposite vertices
+// f[0] = c, f[1], ... of its quads in counter-clockwise order as e[0],
+// f[0], e[1], f[1], ..., and the points at cc_outer.
+struct CatmullClarkNet
+{
+    int n;
+    Net p;
+
+    const dvec3& e(int i) const { return p[1 + 2 * ((i % n + n) % n)]; }
+    const dvec3& f(int i) const { return p[2 + 2 * ((i % n + n) % n)]; }
+
+    // the index of the point at (x, y), -1 if not in the net
+    int index(int x, int y) const
+    {
+        // e and f in the directions of the first two and the last quad
+        const int ring[8][3] = {{0, 0, 0},       {1, 0, 1},
+                                {1, 1, 2},       {0, 1, 3},
+                                {-1, 1, 4},      {-1, 0, 5},
+                                {0, -1, 2 * n - 1}, {1, -1, 2 * n}};
+        for (auto& r : ring)
+            if (x == r[0] && y == r[1])
+                return r[2];
+        if (x == -1 && y == -1)
+            return n == 4 ? 6 : -1;
+        for (int k = 0; k < 7; ++k)
+            if (x == cc_outer[k][0] && y == cc_outer[k][1])
+                return 2 * n + 1 + k;
+        return -1;
+    }
+
+    const dvec3& at(int x, int y) const
+    {
+        const int i = index(x, y);
+        assert(i >= 0);
+        return p[i];
+    }
+
+    // the centroid of the quad (a, e[i], f[i], e[i+1])
+    dvec3 ring_face(int i) const
+    {
+        return 0.25 * (p[0] + e(i) + f(i) + e(i + 1));
+    }
+
+    // the new vertex on the edge from a to e[i]
+    dvec3 ring_edge(int i) const
+    {
+        return 0.25 * (p[0] + e(i) + ring_face(i - 1) + ring_face(i));
+    }
+
+    // the centroid of the quad at (x, y), (x + 1, y + 1)
+    dvec3 face(int x, int y) const
+    {
+        return 0.25 * (at(x, y) + at(x + 1, y) + at(x + 1, y + 1) +
+                       at(x, y + 1));
+    }
+
+    // the point at the lattice position (x, y) after one subdivision step,
+    // in coordinates of half the size
+    dvec3 refined(int x, int y) const
+    {
+        // new position of a vertex
+        if (x % 2 == 0 && y % 2 == 0)
+        {
+            x /= 2;
+            y /= 2;
+            dvec3 q(0, 0, 0);
+            if (x == 0 && y == 0)
+            {
+                for (int i = 0; i < n; ++i)
+                    q += e(i) + ring_face(i);
+                return q / double(n * n) + (n - 2.0) / n * p[0];
+            }
+
+            q = at(x + 1, y) + at(x, y + 1) + at(x - 1, y) + at(x, y - 1) +
+                face(x, y) + face(x - 1, y) + face(x - 1, y - 1) +
+                face(x, y - 1);
+            return 0.0625 * q + 0.5 * at(x, y);
+        }
+
+        // new vertex in a face
+        if (x % 2 != 0 && y % 2 != 0)
+            return face((x - 1) / 2, (y - 1) / 2);
+
+        // new vertex on an edge from (x0, y0) to (x1, y1), between the
+        // faces at (f0x, f0y) and (f1x, f1y)
+        int x0, y0, x1, y1, f0x, f0y, f1x, f1y;
+        if (y % 2 == 0)
+        {
+            x0 = (x - 1) / 2, y0 = y / 2, x1 = x0 + 1, y1 = y0;
+            f0x = x0, f0y = y0 - 1, f1x = x0, f1y = y0;
+        }
+        else
+        {
+            x0 = x / 2, y0 = (y - 1) / 2, x1 = x0, y1 = y0 + 1;
+            f0x = x0 - 1, f0y = y0, f1x = x0, f1y = y0;
+        }
+
+        // edges of the center use its ring
+        if (x0 == 0 && y0 == 0)
+            return ring_edge((index(x1, y1) - 1) / 2);
+        if (x1 == 0 && y1 == 0)
+            return ring_edge((index(x0, y0) - 1) / 2);
+
+        return 0.25 * (at(x0, y0) + at(x1, y1) + face(f0x, f0y) +
+                       face(f1x, f1y));
+    }
+
+    // the net of the sub-quad at a after one subdivision step
+    CatmullClarkNet subdivided() const
+    {
+        CatmullClarkNet net{n, Net(p.size())};
+        net.p[0] = refined(0, 0);
+        for (int i = 0; i < n; ++i)
+        {
+            net.p[1 + 2 * i] = ring_edge(i);
+            net.p[2 + 2 * i] = ring_face(i);
+        }
+        for (int k = 0; k < 7; ++k)
+            net.p[2 * n + 1 + k] = refined(cc_outer[k][0], cc_outer[k][1]);
+        return net;
+    }
+
+    // the limit position and normal of a
+    void limit(dvec3& s, dvec3& normal) const
+    {
+        const double c = std::cos(2.0 * M_PI / n);
+        const double an =
+            1.0 + c + std::cos(M_PI / n) * std::sqrt(2.0 * (9.0 + c));
+        dvec3 q(0, 0, 0), t0(0, 0, 0), t1(0, 0, 0);
+        for (int i = 0; i < n; ++i)
+        {
+            const double a0 = 2.0 * M_PI * i / n;
+            const double a1 = 2.0 * M_PI * (i + 1) / n;
+            q += 4.0 * e(i) + f(i);
+            t0 += an * std::cos(a0) * e(i) +
+                  (std::cos(a0) + std::cos(a1)) * f(i);
+            t1 += an * std::sin(a0) * e(i) +
+                  (std::sin(a0) + std::sin(a1)) * f(i);
+        }
+        s = (double(n * n) * p[0] + q) / double(n * (n + 5));
+        normal = pmp::normal(t0, t1);
+    }
+
+    // the limit position and normal at (u, v)
+    void evaluate(double u, double v, dvec3& s, dvec3& normal) const
+    {
+        CatmullClarkNet net = *this;
+        for (int level = 0; level < max_levels; ++level)
+        {
+            dvec3 su, sv, patch[4][4];
+            if (net.n == 4)
+            {
+                for (int j = 0; j < 4; ++j)
+                    for (int i = 0; i < 4; ++i)
+                        patch[j][i] = net.at(i - 1, j - 1);
+                cc_regular(patch, u, v, s, su, sv);
+                normal = pmp::normal(su, sv);
+                return;
+            }
+
+            // the regular sub-quads
+            if (u >= 0.5 || v >= 0.5)
+            {
+                const int x = u >= 0.5 ? 1 : 0;
+                const int y = v >= 0.5 ? 1 : 0;
+                for (int j = 0; j < 4; ++j)
+                    for (int i = 0; i < 4; ++i)
+                        patch[j][i] = net.refined(x + i - 1, y + j - 1);
+                cc_regular(patch, 2.0 * u - x, 2.0 * v - y, s, su, sv);
+                normal = pmp::normal(su, sv);
+                return;
+            }
+
+            if (u == 0.0 && v == 0.0)
+                break;
+            net = net.subdivided();
+            u *= 2.0;
+            v *= 2.0;
+        }
+        net.limit(s, normal);
+    }
+};
+
+// the net of the corner at the start of h after one subdivision step of the
+// face of h
+CatmullClarkNet cc_corner(const SurfaceMesh& mesh, Halfedge h)
+{
+    const Vertex a = mesh.from_vertex(h);
+    const int n = mesh.valence(a);
+
+    CatmullClarkNet net{n, Net(2 * n + 8)};
+    net.p[0] = cc_vertex(mesh, a);
+    Halfedge hh = h;
+    for (int i = 0; i < n; ++i, hh = mesh.ccw_rotated_halfedge(hh))
+    {
+        net.p[1 + 2 * i] = cc_edge(mesh, hh);
+        net.p[2 + 2 * i] = cc_face(mesh, mesh.face(hh));
+    }
+
+    const Halfedge h1 = mesh.next_halfedge(h);
+    const Halfedge h2 = mesh.next_halfedge(h1);
+    const Halfedge h3 = mesh.next_halfedge(h2);
+    net.p[2 * n + 1] = cc_edge(
+        mesh, mesh.next_halfedge(
+                  mesh.next_halfedge(mesh.cw_rotated_halfedge(h))));
+    net.p[2 * n + 2] = cc_vertex(mesh, mesh.from_vertex(h1));
+    net.p[2 * n + 3] = cc_edge(mesh, h1);
+    net.p[2 * n + 4] = cc_vertex(mesh, mesh.from_vertex(h2));
+    net.p[2 * n + 5] = cc_edge(mesh, h2);
+    net.p[2 * n + 6] = cc_vertex(mesh, mesh.from_vertex(h3));
+    net.p[2 * n + 7] = cc_edge(
+        mesh, mesh.next_halfedge(mesh.ccw_rotated_halfedge(h)));
+    return net;
+}
+
+// the limit of the quad of h at (u, v) for the vertices from(h), to(h), and
+// the two others
+void cc_limit(const SurfaceMesh& mesh, Halfedge h, double u, double v,
+              dvec3& s, dvec3& normal)
+{
+    const Halfedge h1 = mesh.next_halfedge(h);
+    const Halfedge h2 = mesh.next_halfedge(h1);
+    const Halfedge h3 = mesh.next_halfedge(h2);
+
+    if (u <= 0.5 && v <= 0.5)
+        cc_corner(mesh, h).evaluate(2.0 * u, 2.0 * v, s, normal);
+    else if (v <= 0.5)
+        cc_corner(mesh, h1).evaluate(2.0 * v, 2.0 * (1.0 - u), s, normal);
+    else if (u >= 0.5)
+        cc_corner(mesh, h2).evaluate(2.0 * (1.0 - u), 2.0 * (1.0 - v), s,
+                                     normal);
+    else
+        cc_corner(mesh, h3).evaluate(2.0 * (1.0 - v), 2.0 * u, s, normal);
+}
+
+} // namespace
+
+//=============================================================================
+
+SurfaceLimitEvaluation::SurfaceLimitEvaluation(const SurfaceMesh& mesh,
+                                               Scheme scheme)
+    : mesh_(mesh), scheme_(scheme)
+{
+    supported_ =
+        scheme_ == Loop ? mesh_.is_triangle_mesh() : mesh_.is_quad_mesh();
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceLimitEvaluation::evaluate(Face f, const TexCoord& uv,
+                                      Point& position, Normal& normal) const
+{
+    double u = std::min(std::max(double(uv[0]), 0.0), 1.0);
+    double v = std::min(std::max(double(uv[1]), 0.0), 1.0);
+    if (scheme_ == Loop && u + v > 1.0)
+    {
+        const double sum = u + v;
+        u /= sum;
+        v /= sum;
+    }
+
+    bool interior = supported_;
+    for (auto vv : mesh_.vertices(f))
+        interior = interior && !mesh_.is_boundary(vv);
+
+    // the point of the face
+    if (!interior)
+    {
+        std::vector<Point> corners;
+        for (auto vv : mesh_.vertices(f))
+            corners.push_back(mesh_.position(vv));
+        if (corners.size() == 3)
+            position = Scalar(1.0 - u - v) * corners[0] +
+                       Scalar(u) * corners[1] + Scalar(v) * corners[2];
+        else if (corners.size() == 4)
+            position = Scalar((1.0 - u) * (1.0 - v)) * corners[0] +
+                       Scalar(u * (1.0 - v)) * corners[1] +
+                       Scalar(u * v) * corners[2] +
+                       Scalar((1.0 - u) * v) * corners[3];
+        else
+            position = centroid(mesh_, f);
+        normal = SurfaceNormals::compute_face_normal(mesh_, f);
+        return false;
+    }
+
+    // the first corner of the face is the end of its halfedge
+    const Halfedge h = mesh_.next_halfedge(mesh_.halfedge(f));
+    dvec3 s, n;
+    if (scheme_ == Loop)
+        loop_limit(mesh_, h, u, v, s, n);
+    else
+        cc_limit(mesh_, h, u, v, s, n);
+
+    position = Point(s);
+    normal = Normal(n);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceLimitEvaluation::evaluate(const std::vector<Face>& faces,
+                                      const std::vector<TexCoord>& parameters,
+                                      std::vector<Point>& positions,
+                                      std::vector<Normal>& normals) const
+{
+    if (!supported_)
+    {
+        std::cerr << "SurfaceLimitEvaluation: Not a "
+                  << (scheme_ == Loop ? "triangle" : "quad") << " mesh\n";
+    }
+
+    const size_t n = std::min(faces.size(), parameters.size());
+    positions.resize(n);
+    normals.resize(n);
+    std::vector<char> ok(n);
+    parallel_for(0, n, [&](size_t i) {
+        ok[i] = evaluate(faces[i], parameters[i], positions[i], normals[i]);
+    });
+
+    return std::find(ok.begin(), ok.end(), 0) == ok.end();
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
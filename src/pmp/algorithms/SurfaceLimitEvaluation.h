@@ -0,0 +1,88 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <pmp/SurfaceMesh.h>
+
+#include <vector>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \addtogroup algorithms algorithms
+//! @{
+
+//! \brief Evaluate the limit surface of Loop or Catmull-Clark subdivision
+//! at arbitrary face parameters without subdividing the mesh.
+//! \details Follows \cite stam_1998_exact: regular patches are evaluated in
+//! closed form as quartic box splines or bicubic B-splines. The patch of an
+//! extraordinary vertex is subdivided locally until the parameter falls
+//! into a regular sub-patch, which takes a number of steps logarithmic in
+//! the distance to the vertex and a fixed amount of memory. The first step
+//! gathers the control points of the subdivided face from the mesh, such
+//! that faces with more than one extraordinary vertex need no preparation.
+//! The limit is the one of SurfaceSubdivision::loop() and
+//! SurfaceSubdivision::catmull_clark() away from boundaries and feature
+//! edges; faces with a boundary vertex are not supported, features are
+//! ignored. Usage:
+//! \code
+//! SurfaceLimitEvaluation limit(mesh);
+//! Point p;
+//! Normal n;
+//! limit.evaluate(face, TexCoord(0.2, 0.3), p, n);
+//! \endcode
+class SurfaceLimitEvaluation
+{
+public:
+    //! the subdivision scheme
+    enum Scheme
+    {
+        Loop,        //!< Loop subdivision of triangle meshes
+        CatmullClark //!< Catmull-Clark subdivision of quad meshes
+    };
+
+    //! construct for \p mesh, which has to outlive the object
+    SurfaceLimitEvaluation(const SurfaceMesh& mesh, Scheme scheme = Loop);
+
+    //! \brief Evaluate the limit position and normal at the parameters
+    //! \p uv of the face \p f.
+    //! \details For a triangle (1 - u - v, u, v) are the barycentric
+    //! coordinates of its vertices, for a quad (u, v) are the bilinear
+    //! coordinates of its vertices at (0, 0), (1, 0), (1, 1), and (0, 1),
+    //! the vertices in the order of SurfaceMesh::vertices(Face). Parameters
+    //! outside of the face are clamped to it.
+    //! \return false if \p f has a boundary vertex, or if the mesh is not a
+    //! triangle mesh for Loop or not a quad mesh for Catmull-Clark
+    //! subdivision. \p position and \p normal then are the ones of the face.
+    bool evaluate(Face f, const TexCoord& uv, Point& position,
+                  Normal& normal) const;
+
+    //! \brief Evaluate the limit at parameters[i] of faces[i] for all
+    //! samples i in parallel.
+    //! \return false if the evaluation of any sample failed
+    bool evaluate(const std::vector<Face>& faces,
+                  const std::vector<TexCoord>& parameters,
+                  std::vector<Point>& positions,
+                  std::vector<Normal>& normals) const;
+
+private:
+    const SurfaceMesh& mesh_;
+    Scheme scheme_;
+    bool supported_;
+};
+
+//=============================================================================
+//! @}
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -0,0 +1,293 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/algorithms/SurfaceMeshSoA.h>
+#include <pmp/Parallel.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+namespace {
+
+// Reductions are computed per block of fixed size and then summed in block
+// order, which makes the result independent of the number of threads.
+const size_t block_size = 4096;
+
+} // namespace
+
+//=============================================================================
+
+SurfaceMeshSoA::SurfaceMeshSoA(const SurfaceMesh& mesh)
+{
+    // array index for each (non-deleted) vertex
+    std::vector<IndexType> index(mesh.vertices_size(), PMP_MAX_INDEX);
+    vertices_.reserve(mesh.n_vertices());
+    for (auto v : mesh.vertices())
+    {
+        index[v.idx()] = vertices_.size();
+        vertices_.push_back(v);
+    }
+
+    update_positions(mesh);
+
+    // triangles
+    t0_.reserve(mesh.n_faces());
+    t1_.reserve(mesh.n_faces());
+    t2_.reserve(mesh.n_faces());
+    for (auto f : mesh.faces())
+    {
+        auto h = mesh.halfedge(f);
+        auto v0 = mesh.to_vertex(h);
+        h = mesh.next_halfedge(h);
+        auto v1 = mesh.to_vertex(h);
+        h = mesh.next_halfedge(h);
+        auto v2 = mesh.to_vertex(h);
+        if (mesh.next_halfedge(h) != mesh.halfedge(f))
+            continue; // not a triangle
+
+        t0_.push_back(index[v0.idx()]);
+        t1_.push_back(index[v1.idx()]);
+        t2_.push_back(index[v2.idx()]);
+    }
+
+    // one-rings
+    ring_offsets_.resize(vertices_.size() + 1);
+    ring_indices_.reserve(mesh.n_halfedges());
+    ring_offsets_[0] = 0;
+    for (size_t i = 0; i < vertices_.size(); ++i)
+    {
+        for (auto vv : mesh.vertices(vertices_[i]))
+            ring_indices_.push_back(index[vv.idx()]);
+        ring_offsets_[i + 1] = ring_indices_.size();
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMeshSoA::update_positions(const SurfaceMesh& mesh)
+{
+    const size_t n = vertices_.size();
+    x_.resize(n);
+    y_.resize(n);
+    z_.resize(n);
+
+    parallel_for(0, n, [&](size_t i) {
+        const Point& p = mesh.position(vertices_[i]);
+        x_[i] = p[0];
+        y_[i] = p[1];
+        z_[i] = p[2];
+    });
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMeshSoA::write_positions(SurfaceMesh& mesh) const
+{
+    parallel_for(0, vertices_.size(), [&](size_t i) {
+        mesh.position(vertices_[i]) = Point(x_[i], y_[i], z_[i]);
+    });
+}
+
+//-----------------------------------------------------------------------------
+
+BoundingBox SurfaceMeshSoA::bounds() const
+{
+    const size_t n = x_.size();
+    const size_t n_blocks = (n + block_size - 1) / block_size;
+    std::vector<BoundingBox> boxes(n_blocks);
+
+    parallel_for(0, n_blocks, [&](size_t b) {
+        const size_t begin = b * block_size;
+        const size_t end = std::min(n, begin + block_size);
+
+        const Scalar* x = x_.data();
+        const Scalar* y = y_.data();
+        const Scalar* z = z_.data();
+
+        Scalar xmin = x[begin], ymin = y[begin], zmin = z[begin];
+        Scalar xmax = xmin, ymax = ymin, zmax = zmin;
+
+#ifdef _OPENMP
+#pragma omp simd reduction(min : xmin, ymin, zmin) reduction(max : xmax, ymax, zmax)
+#endif
+        for (size_t i = begin; i < end; ++i)
+        {
+            xmin = std::min(xmin, x[i]);
+            ymin = std::min(ymin, y[i]);
+            zmin = std::min(zmin, z[i]);
+            xmax = std::max(xmax, x[i]);
+            ymax = std::max(ymax, y[i]);
+            zmax = std::max(zmax, z[i]);
+        }
+
+        boxes[b] = BoundingBox(Point(xmin, ymin, zmin), Point(xmax, ymax, zmax));
+    });
+
+    BoundingBox bb;
+    for (const auto& box : boxes)
+        bb += box;
+    return bb;
+}
+
+//-----------------------------------------------------------------------------
+
+Scalar SurfaceMeshSoA::surface_area() const
+{
+    const size_t n = t0_.size();
+    const size_t n_blocks = (n + block_size - 1) / block_size;
+    std::vector<double> areas(n_blocks, 0.0);
+
+    parallel_for(0, n_blocks, [&](size_t b) {
+        const size_t begin = b * block_size;
+        const size_t end = std::min(n, begin + block_size);
+
+        const Scalar* x = x_.data();
+        const Scalar* y = y_.data();
+        const Scalar* z = z_.data();
+
+        double area = 0.0;
+
+#ifdef _OPENMP
+#pragma omp simd reduction(+ : area)
+#endif
+        for (size_t i = begin; i < end; ++i)
+        {
+            const IndexType i0 = t0_[i], i1 = t1_[i], i2 = t2_[i];
+            const Scalar ax = x[i1] - x[i0], ay = y[i1] - y[i0],
+                         az = z[i1] - z[i0];
+            const Scalar bx = x[i2] - x[i0], by = y[i2] - y[i0],
+                         bz = z[i2] - z[i0];
+            const Scalar cx = ay * bz - az * by;
+            const Scalar cy = az * bx - ax * bz;
+            const Scalar cz = ax * by - ay * bx;
+            area += std::sqrt(cx * cx + cy * cy + cz * cz);
+        }
+
+        areas[b] = 0.5 * area;
+    });
+
+    double area = 0.0;
+    for (auto a : areas)
+        area += a;
+    return area;
+}
+
+//-----------------------------------------------------------------------------
+
+Point SurfaceMeshSoA::centroid() const
+{
+    const size_t n = t0_.size();
+    const size_t n_blocks = (n + block_size - 1) / block_size;
+    std::vector<double> sums(4 * n_blocks, 0.0);
+
+    parallel_for(0, n_blocks, [&](size_t b) {
+        const size_t begin = b * block_size;
+        const size_t end = std::min(n, begin + block_size);
+
+        const Scalar* x = x_.data();
+        const Scalar* y = y_.data();
+        const Scalar* z = z_.data();
+
+        double area = 0.0, cx = 0.0, cy = 0.0, cz = 0.0;
+
+#ifdef _OPENMP
+#pragma omp simd reduction(+ : area, cx, cy, cz)
+#endif
+        for (size_t i = begin; i < end; ++i)
+        {
+            const IndexType i0 = t0_[i], i1 = t1_[i], i2 = t2_[i];
+            const Scalar ax = x[i1] - x[i0], ay = y[i1] - y[i0],
+                         az = z[i1] - z[i0];
+            const Scalar bx = x[i2] - x[i0], by = y[i2] - y[i0],
+                         bz = z[i2] - z[i0];
+            const Scalar nx = ay * bz - az * by;
+            const Scalar ny = az * bx - ax * bz;
+            const Scalar nz = ax * by - ay * bx;
+            const Scalar a = std::sqrt(nx * nx + ny * ny + nz * nz);
+            area += a;
+            cx += a * (x[i0] + x[i1] + x[i2]);
+            cy += a * (y[i0] + y[i1] + y[i2]);
+            cz += a * (z[i0] + z[i1] + z[i2]);
+        }
+
+        sums[4 * b + 0] = area;
+        sums[4 * b + 1] = cx;
+        sums[4 * b + 2] = cy;
+        sums[4 * b + 3] = cz;
+    });
+
+    double area = 0.0, cx = 0.0, cy = 0.0, cz = 0.0;
+    for (size_t b = 0; b < n_blocks; ++b)
+    {
+        area += sums[4 * b + 0];
+        cx += sums[4 * b + 1];
+        cy += sums[4 * b + 2];
+        cz += sums[4 * b + 3];
+    }
+
+    if (area <= std::numeric_limits<double>::min())
+        return Point(0, 0, 0);
+
+    // the cross product norm is twice the area, the corner sum three times
+    // the triangle centroid; both factors cancel except for 1/3
+    area *= 3.0;
+    return Point(cx / area, cy / area, cz / area);
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMeshSoA::laplace(std::vector<Scalar>& lx, std::vector<Scalar>& ly,
+                             std::vector<Scalar>& lz) const
+{
+    const size_t n = x_.size();
+    lx.resize(n);
+    ly.resize(n);
+    lz.resize(n);
+
+    parallel_for(0, n, [&](size_t i) {
+        const IndexType begin = ring_offsets_[i];
+        const IndexType end = ring_offsets_[i + 1];
+
+        Scalar sx = 0, sy = 0, sz = 0;
+
+#ifdef _OPENMP
+#pragma omp simd reduction(+ : sx, sy, sz)
+#endif
+        for (IndexType j = begin; j < end; ++j)
+        {
+            const IndexType k = ring_indices_[j];
+            sx += x_[k];
+            sy += y_[k];
+            sz += z_[k];
+        }
+
+        if (end > begin)
+        {
+            const Scalar w = Scalar(1) / Scalar(end - begin);
+            lx[i] = w * sx - x_[i];
+            ly[i] = w * sy - y_[i];
+            lz[i] = w * sz - z_[i];
+        }
+        else
+        {
+            lx[i] = ly[i] = lz[i] = 0;
+        }
+    });
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -0,0 +1,99 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <pmp/SurfaceMesh.h>
+#include <pmp/BoundingBox.h>
+
+#include <vector>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \addtogroup algorithms algorithms
+//!@{
+
+//! \brief A structure-of-arrays view of the vertex positions of a mesh.
+//! \details Vertex positions are stored as separate x/y/z arrays, triangles
+//! as three index arrays, and the vertex one-rings in compressed-row form.
+//! The contiguous layout allows the compiler to vectorize the kernels
+//! bounds(), surface_area(), centroid() and laplace(). The view is a
+//! snapshot: call update_positions() after positions changed, or rebuild it
+//! after topological changes. Deleted vertices and faces are skipped. Only
+//! triangle faces enter the face-based kernels.
+class SurfaceMeshSoA
+{
+public:
+    //! construct from \p mesh, copies positions and connectivity
+    SurfaceMeshSoA(const SurfaceMesh& mesh);
+
+    //! re-read vertex positions of \p mesh (connectivity has to be unchanged)
+    void update_positions(const SurfaceMesh& mesh);
+
+    //! copy vertex positions back to \p mesh
+    void write_positions(SurfaceMesh& mesh) const;
+
+    //! number of vertices in the view
+    size_t n_vertices() const { return x_.size(); }
+
+    //! number of triangles in the view
+    size_t n_triangles() const { return t0_.size(); }
+
+    //! the vertex stored at position \p i of the arrays
+    Vertex vertex(size_t i) const { return vertices_[i]; }
+
+    //! x coordinates
+    std::vector<Scalar>& x() { return x_; }
+
+    //! y coordinates
+    std::vector<Scalar>& y() { return y_; }
+
+    //! z coordinates
+    std::vector<Scalar>& z() { return z_; }
+
+    //! bounding box of all vertices
+    BoundingBox bounds() const;
+
+    //! surface area of all triangles
+    Scalar surface_area() const;
+
+    //! area-weighted barycenter of all triangles
+    Point centroid() const;
+
+    //! \brief Compute the uniform Laplacian of each vertex.
+    //! \details Writes the average of the neighbors minus the vertex position
+    //! into \p lx, \p ly, \p lz, which are resized to n_vertices(). Isolated
+    //! vertices get a zero Laplacian.
+    void laplace(std::vector<Scalar>& lx, std::vector<Scalar>& ly,
+                 std::vector<Scalar>& lz) const;
+
+private:
+    // vertex positions
+    std::vector<Scalar> x_, y_, z_;
+
+    // array index -> mesh vertex
+    std::vector<Vertex> vertices_;
+
+    // triangle corners as array indices
+    std::vector<IndexType> t0_, t1_, t2_;
+
+    // one-ring neighbors in compressed-row form
+    std::vector<IndexType> ring_offsets_;
+    std::vector<IndexType> ring_indices_;
+};
+
+//=============================================================================
+//!@}
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -0,0 +1,108 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/algorithms/SurfaceNeighborhood.h>
+
+#include <algorithm>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+SurfaceNeighborhood::SurfaceNeighborhood(const SurfaceMesh& mesh)
+    : mesh_(mesh), epoch_(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceNeighborhood::begin_query()
+{
+    // vertices added to the mesh are not visited yet
+    if (stamps_.size() < mesh_.vertices_size())
+        stamps_.resize(mesh_.vertices_size(), epoch_);
+
+    // clear the marks only once the counter wraps around
+    if (++epoch_ == 0)
+    {
+        std::fill(stamps_.begin(), stamps_.end(), 0);
+        epoch_ = 1;
+    }
+
+    vertices_.clear();
+    ring_ends_.clear();
+}
+
+//-----------------------------------------------------------------------------
+
+const std::vector<Vertex>& SurfaceNeighborhood::rings(Vertex v,
+                                                      unsigned int k)
+{
+    return rings(std::vector<Vertex>{v}, k);
+}
+
+//-----------------------------------------------------------------------------
+
+const std::vector<Vertex>& SurfaceNeighborhood::rings(
+    const std::vector<Vertex>& seeds, unsigned int k)
+{
+    begin_query();
+    for (auto v : seeds)
+        visit(v);
+    ring_ends_.push_back(vertices_.size());
+
+    size_t ring_begin = 0;
+    for (unsigned int i = 0; i < k && ring_begin < vertices_.size(); ++i)
+    {
+        const size_t ring_end = vertices_.size();
+        for (size_t j = ring_begin; j < ring_end; ++j)
+            for (auto vv : mesh_.vertices(vertices_[j]))
+                visit(vv);
+        ring_ends_.push_back(vertices_.size());
+        ring_begin = ring_end;
+    }
+    return vertices_;
+}
+
+//-----------------------------------------------------------------------------
+
+const std::vector<Vertex>& SurfaceNeighborhood::within(Vertex v,
+                                                       Scalar radius)
+{
+    begin_query();
+    visit(v);
+    ring_ends_.push_back(vertices_.size());
+
+    const Point& center = mesh_.position(v);
+    const Scalar sqr_radius = radius * radius;
+    size_t ring_begin = 0;
+    while (ring_begin < vertices_.size())
+    {
+        const size_t ring_end = vertices_.size();
+        for (size_t j = ring_begin; j < ring_end; ++j)
+        {
+            for (auto vv : mesh_.vertices(vertices_[j]))
+            {
+                if (stamps_[vv.idx()] != epoch_ &&
+                    sqrnorm(mesh_.position(vv) - center) <= sqr_radius)
+                    visit(vv);
+            }
+        }
+        if (vertices_.size() > ring_end)
+            ring_ends_.push_back(vertices_.size());
+        ring_begin = ring_end;
+    }
+    return vertices_;
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -0,0 +1,109 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <pmp/SurfaceMesh.h>
+
+#include <vector>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \addtogroup algorithms algorithms
+//! @{
+
+//=============================================================================
+
+//! \brief Reusable k-ring and radius neighborhood queries.
+//! \details Collects the vertices around a vertex by a breadth-first search
+//! over the edges, bounded by a number of rings or a Euclidean radius. The
+//! visited vertices are marked by the number of the query instead of a
+//! boolean property, such that nothing has to be cleared between queries,
+//! and the result is stored in a buffer that is reused by the next query.
+//! A query thus costs time proportional to its result only:
+//! \code
+//! SurfaceNeighborhood neighborhood(mesh);
+//! for (auto v : mesh.vertices())
+//!     for (auto vv : neighborhood.rings(v, 3))
+//!         ...
+//! \endcode
+//! The results refer to the connectivity at query time. Vertices added to the
+//! mesh are handled, but the results are invalidated by the next query.
+class SurfaceNeighborhood
+{
+public:
+    //! construct with the \p mesh to query
+    SurfaceNeighborhood(const SurfaceMesh& mesh);
+
+    //! \brief The vertices within \p k rings of \p v.
+    //! \details \p v comes first, followed by its rings in increasing order,
+    //! see ring_end().
+    const std::vector<Vertex>& rings(Vertex v, unsigned int k);
+
+    //! \brief The vertices within \p k rings of any of the \p seeds.
+    //! \details The seeds come first, in the given order, without duplicates.
+    const std::vector<Vertex>& rings(const std::vector<Vertex>& seeds,
+                                     unsigned int k);
+
+    //! \brief The vertices connected to \p v within distance \p radius of
+    //! its position.
+    //! \details Only paths through vertices within the ball are followed,
+    //! such that close vertices of other parts of the surface are excluded.
+    const std::vector<Vertex>& within(Vertex v, Scalar radius);
+
+    //! the result of the last query
+    const std::vector<Vertex>& vertices() const { return vertices_; }
+
+    //! \brief The number of vertices within \p i rings in the last query.
+    //! \details The \c i'th ring is vertices()[ring_end(i-1), ring_end(i)).
+    //! Rings beyond the last one end at vertices().size().
+    size_t ring_end(unsigned int i) const
+    {
+        return i < ring_ends_.size() ? ring_ends_[i] : vertices_.size();
+    }
+
+    //! whether \p v is in the result of the last query, in constant time
+    bool contains(Vertex v) const
+    {
+        return v.idx() < stamps_.size() && stamps_[v.idx()] == epoch_;
+    }
+
+private:
+    // start a query with new marks
+    void begin_query();
+
+    // add v to the result if it is not marked yet
+    bool visit(Vertex v)
+    {
+        if (stamps_[v.idx()] == epoch_)
+            return false;
+        stamps_[v.idx()] = epoch_;
+        vertices_.push_back(v);
+        return true;
+    }
+
+    const SurfaceMesh& mesh_;
+
+    // the query that visited each vertex last, indexed by Vertex::idx()
+    std::vector<unsigned int> stamps_;
+    unsigned int epoch_;
+
+    std::vector<Vertex> vertices_;
+    std::vector<size_t> ring_ends_;
+};
+
+//=============================================================================
+//! @}
+//=============================================================================
+} // namespace pmp
+//=============================================================================
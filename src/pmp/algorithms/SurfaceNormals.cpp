@@ -8,6 +8,12 @@
 //=============================================================================
 
 #include "SurfaceNormals.h"
+#include <pmp/algorithms/PointKdTree.h>
+#include <pmp/Parallel.h>
+
+#include <Eigen/Dense>
+
+#include <algorithm>
 
 //=============================================================================
 
@@ -15,14 +21,37 @@ namespace pmp {
 
 //=============================================================================
 
-Normal SurfaceNormals::compute_vertex_normal(const SurfaceMesh& mesh, Vertex v)
+namespace {
+
+// resolved once, the functions below are called per element
+const PropertyKey<Point> point_key("v:point");
+
+// acos() to within 6.8e-5 radians by the polynomial 4.4.45 of Abramowitz
+// and Stegun, for x in [-1, 1]
+inline Scalar approximate_acos(Scalar x)
+{
+    const Scalar a = std::abs(x);
+    const Scalar r =
+        std::sqrt(1 - a) *
+        (Scalar(1.5707288) +
+         a * (Scalar(-0.2121144) + a * (Scalar(0.0742610) -
+                                        a * Scalar(0.0187293))));
+    return x < 0 ? Scalar(M_PI) - r : r;
+}
+
+} // namespace
+
+//=============================================================================
+
+Normal SurfaceNormals::compute_vertex_normal(const SurfaceMesh& mesh, Vertex v,
+                                             Weighting weighting)
 {
     Point nn(0, 0, 0);
     Halfedge h = mesh.halfedge(v);
 
     if (h.is_valid())
     {
-        auto vpoint = mesh.get_vertex_property<Point>("v:point");
+        auto vpoint = mesh.get_vertex_property(point_key);
 
         const Halfedge hend = h;
         const Point p0 = vpoint[v];
@@ -40,25 +69,36 @@ Normal SurfaceNormals::compute_vertex_normal(const SurfaceMesh& mesh, Vertex v)
                 p2 = vpoint[mesh.from_vertex(mesh.prev_halfedge(h))];
                 p2 -= p0;
 
-                // check whether we can robustly compute angle
-                denom = sqrt(dot(p1, p1) * dot(p2, p2));
-                if (denom > std::numeric_limits<Scalar>::min())
+                if (weighting == Area)
                 {
-                    cosine = dot(p1, p2) / denom;
-                    if (cosine < -1.0)
-                        cosine = -1.0;
-                    else if (cosine > 1.0)
-                        cosine = 1.0;
-                    angle = acos(cosine);
-
-                    n = cross(p1, p2);
-
-                    // check whether normal is != 0
-                    denom = norm(n);
+                    // twice the area of the corner triangle times its normal
+                    nn += cross(p1, p2);
+                }
+                else
+                {
+                    // check whether we can robustly compute angle
+                    denom = std::sqrt(dot(p1, p1) * dot(p2, p2));
                     if (denom > std::numeric_limits<Scalar>::min())
                     {
-                        n *= angle / denom;
-                        nn += n;
+                        cosine = dot(p1, p2) / denom;
+                        if (cosine < -1.0)
+                            cosine = -1.0;
+                        else if (cosine > 1.0)
+                            cosine = 1.0;
+                        // std:: selects the overload for Scalar, the global
+                        // function would compute in double precision
+                        angle = weighting == Angle ? std::acos(cosine)
+                                                   : approximate_acos(cosine);
+
+                        n = cross(p1, p2);
+
+                        // check whether normal is != 0
+                        denom = norm(n);
+                        if (denom > std::numeric_limits<Scalar>::min())
+                        {
+                            n *= angle / denom;
+                            nn += n;
+                        }
                     }
                 }
             }
@@ -79,7 +119,7 @@ Normal SurfaceNormals::compute_face_normal(const SurfaceMesh& mesh, Face f)
     Halfedge h = mesh.halfedge(f);
     Halfedge hend = h;
 
-    auto vpoint = mesh.get_vertex_property<Point>("v:point");
+    auto vpoint = mesh.get_vertex_property(point_key);
 
     Point p0 = vpoint[mesh.to_vertex(h)];
     h = mesh.next_halfedge(h);
@@ -113,6 +153,14 @@ Normal SurfaceNormals::compute_face_normal(const SurfaceMesh& mesh, Face f)
 
 //-----------------------------------------------------------------------------
 
+vec3a SurfaceNormals::compute_triangle_normal(const vec3a& p0, const vec3a& p1,
+                                              const vec3a& p2)
+{
+    return normalize(cross(p2 - p1, p0 - p1));
+}
+
+//-----------------------------------------------------------------------------
+
 Normal SurfaceNormals::compute_corner_normal(const SurfaceMesh& mesh,
                                              Halfedge h, Scalar crease_angle)
 {
@@ -131,7 +179,7 @@ Normal SurfaceNormals::compute_corner_normal(const SurfaceMesh& mesh,
 
     if (!mesh.is_boundary(h))
     {
-        auto vpoint = mesh.get_vertex_property<Point>("v:point");
+        auto vpoint = mesh.get_vertex_property(point_key);
 
         const Halfedge hend = h;
         const Vertex v0 = mesh.to_vertex(h);
@@ -169,7 +217,7 @@ Normal SurfaceNormals::compute_corner_normal(const SurfaceMesh& mesh,
                     if (dot(n, nf) >= cos_crease_angle)
                     {
                         // check whether we can robustly compute angle
-                        denom = sqrt(dot(p1, p1) * dot(p2, p2));
+                        denom = std::sqrt(dot(p1, p1) * dot(p2, p2));
                         if (denom > std::numeric_limits<Scalar>::min())
                         {
                             cosine = dot(p1, p2) / denom;
@@ -177,7 +225,7 @@ Normal SurfaceNormals::compute_corner_normal(const SurfaceMesh& mesh,
                                 cosine = -1.0;
                             else if (cosine > 1.0)
                                 cosine = 1.0;
-                            angle = acos(cosine);
+                            angle = std::acos(cosine);
 
                             n *= angle;
                             nn += n;
@@ -197,11 +245,13 @@ Normal SurfaceNormals::compute_corner_normal(const SurfaceMesh& mesh,
 
 //-----------------------------------------------------------------------------
 
-void SurfaceNormals::compute_vertex_normals(SurfaceMesh& mesh)
+void SurfaceNormals::compute_vertex_normals(SurfaceMesh& mesh,
+                                            Weighting weighting)
 {
     auto vnormal = mesh.vertex_property<Normal>("v:normal");
-    for (auto v : mesh.vertices())
-        vnormal[v] = compute_vertex_normal(mesh, v);
+    parallel_for(mesh.vertices(), [&](Vertex v) {
+        vnormal[v] = compute_vertex_normal(mesh, v, weighting);
+    });
 }
 
 //-----------------------------------------------------------------------------
@@ -209,8 +259,87 @@ void SurfaceNormals::compute_vertex_normals(SurfaceMesh& mesh)
 void SurfaceNormals::compute_face_normals(SurfaceMesh& mesh)
 {
     auto fnormal = mesh.face_property<Normal>("f:normal");
-    for (auto f : mesh.faces())
-        fnormal[f] = compute_face_normal(mesh, f);
+    parallel_for(mesh.faces(),
+                 [&](Face f) { fnormal[f] = compute_face_normal(mesh, f); });
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceNormals::update_normals(SurfaceMesh& mesh,
+                                    const std::vector<Face>& faces,
+                                    Weighting weighting)
+{
+    std::vector<Face> unique_faces(faces);
+    std::sort(unique_faces.begin(), unique_faces.end());
+    unique_faces.erase(std::unique(unique_faces.begin(), unique_faces.end()),
+                       unique_faces.end());
+
+    auto fnormal = mesh.get_face_property<Normal>("f:normal");
+    if (fnormal)
+    {
+        parallel_for(0, unique_faces.size(), [&](size_t i) {
+            const Face f = unique_faces[i];
+            fnormal[f] = compute_face_normal(mesh, f);
+        });
+    }
+
+    auto vnormal = mesh.get_vertex_property<Normal>("v:normal");
+    if (vnormal)
+    {
+        std::vector<Vertex> vertices;
+        for (auto f : unique_faces)
+            for (auto v : mesh.vertices(f))
+                vertices.push_back(v);
+        std::sort(vertices.begin(), vertices.end());
+        vertices.erase(std::unique(vertices.begin(), vertices.end()),
+                       vertices.end());
+
+        parallel_for(0, vertices.size(), [&](size_t i) {
+            const Vertex v = vertices[i];
+            vnormal[v] = compute_vertex_normal(mesh, v, weighting);
+        });
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceNormals::compute_point_normals(SurfaceMesh& mesh, unsigned int k)
+{
+    auto points = mesh.get_vertex_property<Point>("v:point");
+    auto vnormal = mesh.vertex_property<Normal>("v:normal", Normal(0, 0, 0));
+    const PointKdTree tree(mesh);
+
+    parallel_for(mesh.vertices(), [&](Vertex v) {
+        const auto neighbors = tree.k_nearest(points[v], std::max(k, 3u));
+
+        // covariance of the neighbors
+        Eigen::Vector3d mean(0, 0, 0);
+        for (const auto& n : neighbors)
+        {
+            const Point& p = points[n.vertex];
+            mean += Eigen::Vector3d(p[0], p[1], p[2]);
+        }
+        mean /= double(neighbors.size());
+
+        Eigen::Matrix3d covariance = Eigen::Matrix3d::Zero();
+        for (const auto& n : neighbors)
+        {
+            const Point& p = points[n.vertex];
+            const Eigen::Vector3d d = Eigen::Vector3d(p[0], p[1], p[2]) - mean;
+            covariance += d * d.transpose();
+        }
+
+        // the eigenvector of the smallest eigenvalue is the normal
+        Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> solver;
+        solver.computeDirect(covariance);
+        const Eigen::Vector3d e = solver.eigenvectors().col(0);
+        Normal n(e[0], e[1], e[2]);
+        if (neighbors.size() < 3 || !(sqrnorm(n) > 0))
+            n = Normal(0, 0, 0);
+        else if (dot(n, vnormal[v]) < 0)
+            n = -n;
+        vnormal[v] = n;
+    });
 }
 
 //=============================================================================
@@ -11,6 +11,8 @@
 
 #include <pmp/SurfaceMesh.h>
 
+#include <vector>
+
 //=============================================================================
 
 namespace pmp {
@@ -32,7 +34,10 @@ namespace pmp {
 //!
 //! The convenience functions compute_vertex_normals() and compute_face_normals()
 //! compute the normals for the whole mesh and add a corresponding vertex or
-//! face property.
+//! face property, update_normals() updates them after a local change.
+//! Each normal is accumulated by its own vertex or face in the order of its
+//! neighbors, such that the results are bitwise equal on any number of
+//! threads.
 class SurfaceNormals
 {
 public:
@@ -40,22 +45,64 @@ public:
     SurfaceNormals() = delete;
     SurfaceNormals(const SurfaceNormals&) = delete;
 
+    //! \brief The weights of the incident faces in a vertex normal.
+    enum Weighting
+    {
+        //! exact interior angles at the vertex
+        Angle,
+        //! polynomial approximation of the angles, accurate to about
+        //! 7e-5 radians and faster
+        ApproximateAngle,
+        //! face areas, the fastest, but depends on the tessellation
+        Area
+    };
+
     //! \brief Compute vertex normals for the whole \c mesh.
-    //! \details Calls compute_vertex_normal() for each vertex and adds a new
-    //! vertex property of type Normal named "v:normal".
-    static void compute_vertex_normals(SurfaceMesh& mesh);
+    //! \details Calls compute_vertex_normal() for each vertex (in parallel)
+    //! and adds a new vertex property of type Normal named "v:normal".
+    static void compute_vertex_normals(SurfaceMesh& mesh,
+                                       Weighting weighting = Angle);
 
     //! \brief Compute face normals for the whole \c mesh.
-    //! \details Calls compute_face_normal() for each face and adds a new face
-    //! property of type Normal named "f:normal".
+    //! \details Calls compute_face_normal() for each face (in parallel) and
+    //! adds a new face property of type Normal named "f:normal".
     static void compute_face_normals(SurfaceMesh& mesh);
 
+    //! \brief Update the normals after a local change of the \c mesh.
+    //! \details Recomputes the face normals in "f:normal" of the \p faces
+    //! and the vertex normals in "v:normal" of their vertices (in parallel),
+    //! for those of the two properties that exist. A vertex normal depends on
+    //! all incident faces, so after moving vertices pass all faces incident
+    //! to them.
+    static void update_normals(SurfaceMesh& mesh,
+                               const std::vector<Face>& faces,
+                               Weighting weighting = Angle);
+
+    //! \brief Estimate vertex normals of a point cloud.
+    //! \details Fits a plane to the \p k nearest neighbors of each vertex
+    //! (in parallel), using a PointKdTree, and stores its normal in the vertex
+    //! property "v:normal". Faces are ignored. A normal already stored in
+    //! "v:normal", e.g., by reading an XYZ file with normals, determines the
+    //! orientation of the new one, otherwise the orientation is arbitrary.
+    static void compute_point_normals(SurfaceMesh& mesh, unsigned int k = 10);
+
     //! \brief Compute the normal vector of vertex \c v.
-    static Normal compute_vertex_normal(const SurfaceMesh& mesh, Vertex v);
+    //! \details The normals of the incident faces are averaged with the
+    //! given \p weighting. Use one of the approximate weightings where
+    //! speed matters more than exactness, e.g., for rendering.
+    static Normal compute_vertex_normal(const SurfaceMesh& mesh, Vertex v,
+                                        Weighting weighting = Angle);
 
     //! \brief Compute the normal vector of face \c f.
     static Normal compute_face_normal(const SurfaceMesh& mesh, Face f);
 
+    //! \brief Compute the normal vector of the triangle (\p p0, \p p1,
+    //! \p p2) with SIMD vectors, see vec3a.
+    //! \details Gives the same result as compute_face_normal() for a
+    //! triangle in single precision.
+    static vec3a compute_triangle_normal(const vec3a& p0, const vec3a& p1,
+                                         const vec3a& p2);
+
     //! \brief Compute the normal vector of the polygon corner specified by the
     //! target vertex of halfedge \c h.
     //! \details Averages incident corner normals if they are within crease_angle
@@ -8,8 +8,17 @@
 //=============================================================================
 
 #include <pmp/algorithms/SurfaceParameterization.h>
+#include <pmp/algorithms/SurfaceSimplification.h>
+#include <pmp/algorithms/TriangleKdTree.h>
+#include <pmp/algorithms/SurfaceNormals.h>
+#include <pmp/algorithms/BarycentricCoordinates.h>
 #include <pmp/algorithms/DifferentialGeometry.h>
+#include <pmp/algorithms/LaplaceMatrix.h>
+#include <pmp/algorithms/SparseSolver.h>
+#include <pmp/Parallel.h>
+#include <algorithm>
 #include <cmath>
+#include <complex>
 #include <Eigen/Dense>
 #include <Eigen/Sparse>
 
@@ -19,42 +28,280 @@ namespace pmp {
 
 //=============================================================================
 
+namespace {
+
+// Call solve(chart) for each chart, concurrently for several charts. A
+// chart with most of the vertices is solved on its own first, such that
+// its assembly and iterative solver run in parallel.
+template <class Charts, class Function>
+void for_each_chart(const Charts& charts, Function solve)
+{
+    size_t n = 0;
+    for (const auto& chart : charts)
+        n += chart.vertices.size();
+
+    size_t first = 0;
+    if (!charts.empty() && 2 * charts[0].vertices.size() > n)
+    {
+        solve(charts[0]);
+        first = 1;
+    }
+
+    parallel_for_chunks(
+        charts.size() - first,
+        [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+                solve(charts[first + i]);
+        },
+        1);
+}
+
+// Whether the faces of chart c, connected along their edges, form a disk:
+// each vertex is surrounded by a single fan of them, and the Euler
+// characteristic is one. Vertices already counted are marked by stamp in
+// vertex_stamp.
+bool is_disk(const SurfaceMesh& mesh, const std::vector<Face>& faces,
+             const std::vector<int>& face_chart, int c, int stamp,
+             std::vector<int>& vertex_stamp)
+{
+    auto in_chart = [&](Halfedge h) {
+        const Face f = mesh.face(h);
+        return f.is_valid() && face_chart[f.idx()] == c;
+    };
+
+    int n_vertices = 0, n_halfedges = 0, n_boundary = 0;
+    for (auto f : faces)
+        for (auto h : mesh.halfedges(f))
+        {
+            ++n_halfedges;
+            if (!in_chart(mesh.opposite_halfedge(h)))
+                ++n_boundary;
+
+            const Vertex v = mesh.to_vertex(h);
+            if (vertex_stamp[v.idx()] == stamp)
+                continue;
+            vertex_stamp[v.idx()] = stamp;
+            ++n_vertices;
+
+            // count the fans of chart faces around v
+            int n_fans = 0;
+            for (auto hh : mesh.halfedges(v))
+                if (in_chart(hh) && !in_chart(mesh.opposite_halfedge(hh)))
+                    ++n_fans;
+            if (n_fans > 1)
+                return false;
+        }
+
+    // the interior edges are shared by two halfedges of the chart
+    const int n_edges = n_boundary + (n_halfedges - n_boundary) / 2;
+    return n_vertices - n_edges + int(faces.size()) == 1;
+}
+
+// Split the connected faces of chart c into two connected halves, grown from
+// its first face and the face farthest from it. The second half becomes
+// chart c2.
+void split_chart(const SurfaceMesh& mesh, std::vector<Face>& faces,
+                 std::vector<int>& face_chart, int c, int c2,
+                 std::vector<Face>& faces2)
+{
+    // breadth-first search from the seeds, marking faces by chart c2 and
+    // c2 + 1 for the seed of chart c
+    auto grow = [&](std::vector<Face> seeds) {
+        for (size_t i = 0; i < seeds.size(); ++i)
+            for (auto h : mesh.halfedges(seeds[i]))
+            {
+                const Face g = mesh.face(mesh.opposite_halfedge(h));
+                if (g.is_valid() && face_chart[g.idx()] == c)
+                {
+                    face_chart[g.idx()] = face_chart[seeds[i].idx()];
+                    seeds.push_back(g);
+                }
+            }
+        return seeds.back();
+    };
+
+    face_chart[faces[0].idx()] = c2 + 1;
+    const Face far = grow({faces[0]});
+    for (auto f : faces)
+        face_chart[f.idx()] = c;
+    face_chart[faces[0].idx()] = c2 + 1;
+    face_chart[far.idx()] = c2;
+    grow({faces[0], far});
+
+    std::vector<Face> faces1;
+    for (auto f : faces)
+    {
+        if (face_chart[f.idx()] == c2)
+        {
+            faces2.push_back(f);
+        }
+        else
+        {
+            face_chart[f.idx()] = c;
+            faces1.push_back(f);
+        }
+    }
+    faces.swap(faces1);
+}
+
+// Segment the mesh into disk-shaped charts of faces, grown from the first
+// free face while the face normals stay within the cone of cosine
+// min_cosine around its normal and no feature edge is crossed.
+std::vector<std::vector<Face>> segment_charts(const SurfaceMesh& mesh,
+                                              Scalar min_cosine,
+                                              std::vector<int>& face_chart)
+{
+    auto feature = mesh.get_edge_property<bool>("e:feature");
+    std::vector<Normal> normals(mesh.faces_size());
+    parallel_for(mesh.faces(), [&](Face f) {
+        normals[f.idx()] = SurfaceNormals::compute_face_normal(mesh, f);
+    });
+
+    std::vector<std::vector<Face>> charts;
+    face_chart.assign(mesh.faces_size(), -1);
+    for (auto seed : mesh.faces())
+    {
+        if (face_chart[seed.idx()] != -1)
+            continue;
+
+        const int c = charts.size();
+        charts.emplace_back(1, seed);
+        std::vector<Face>& faces = charts.back();
+        face_chart[seed.idx()] = c;
+        for (size_t i = 0; i < faces.size(); ++i)
+            for (auto h : mesh.halfedges(faces[i]))
+            {
+                const Face g = mesh.face(mesh.opposite_halfedge(h));
+                if (g.is_valid() && face_chart[g.idx()] == -1 &&
+                    !(feature && feature[mesh.edge(h)]) &&
+                    dot(normals[g.idx()], normals[seed.idx()]) >= min_cosine)
+                {
+                    face_chart[g.idx()] = c;
+                    faces.push_back(g);
+                }
+            }
+    }
+
+    // split charts until all of them are disks, single faces always are
+    std::vector<int> vertex_stamp(mesh.vertices_size(), -1);
+    int stamp = 0;
+    for (size_t c = 0; c < charts.size(); ++c)
+    {
+        while (charts[c].size() > 1 &&
+               !is_disk(mesh, charts[c], face_chart, c, stamp++, vertex_stamp))
+        {
+            const int c2 = charts.size();
+            std::vector<Face> faces2;
+            split_chart(mesh, charts[c], face_chart, c, c2, faces2);
+            charts.push_back(std::move(faces2));
+        }
+    }
+
+    return charts;
+}
+
+} // namespace
+
+//=============================================================================
+
+// the factorization of harmonic_persistent()
+struct SurfaceParameterization::HarmonicSystem
+{
+    unsigned long topology_version;
+    bool use_uniform_weights;
+    std::vector<Vertex> vertices; // the free vertices
+    CompressedRowMatrix boundary; // their entries in the boundary columns
+    SparseSolver solver;
+};
+
+//-----------------------------------------------------------------------------
+
 SurfaceParameterization::SurfaceParameterization(SurfaceMesh& mesh)
-    : mesh_(mesh)
+    : mesh_(mesh), coarse_vertices_(0)
 {
 }
 
 //-----------------------------------------------------------------------------
 
-bool SurfaceParameterization::setup_boundary_constraints()
+SurfaceParameterization::~SurfaceParameterization() = default;
+
+//-----------------------------------------------------------------------------
+
+std::vector<SurfaceParameterization::Chart>
+SurfaceParameterization::find_charts(const SurfaceMesh& mesh)
+{
+    std::vector<Chart> charts;
+    std::vector<int> component(mesh.vertices_size(), -1);
+    std::vector<Vertex> stack;
+    for (auto v : mesh.vertices())
+    {
+        if (component[v.idx()] != -1 || mesh.is_isolated(v))
+            continue;
+
+        const int c = charts.size();
+        charts.emplace_back();
+        component[v.idx()] = c;
+        stack.push_back(v);
+        while (!stack.empty())
+        {
+            const Vertex w = stack.back();
+            stack.pop_back();
+            charts[c].vertices.push_back(w);
+            for (auto vv : mesh.vertices(w))
+                if (component[vv.idx()] == -1)
+                {
+                    component[vv.idx()] = c;
+                    stack.push_back(vv);
+                }
+        }
+    }
+
+    for (auto f : mesh.faces())
+    {
+        const Vertex v = mesh.to_vertex(mesh.halfedge(f));
+        charts[component[v.idx()]].faces.push_back(f);
+    }
+
+    // vertices in index order, such that the linear systems keep the order
+    // of the mesh
+    for (auto& chart : charts)
+        std::sort(chart.vertices.begin(), chart.vertices.end());
+    std::stable_sort(charts.begin(), charts.end(),
+                     [](const Chart& a, const Chart& b) {
+                         return a.vertices.size() > b.vertices.size();
+                     });
+
+    return charts;
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceParameterization::setup_boundary_constraints(const Chart& chart)
 {
     // get properties
-    auto points = mesh_.vertex_property<Point>("v:point");
-    auto tex = mesh_.vertex_property<TexCoord>("v:tex");
+    auto points = mesh_.get_vertex_property<Point>("v:point");
+    auto tex = mesh_.get_vertex_property<TexCoord>("v:tex");
 
-    SurfaceMesh::VertexIterator vit, vend = mesh_.vertices_end();
     Vertex vh;
     Halfedge hh;
     std::vector<Vertex> loop;
 
-    // Initialize all texture coordinates to the origin.
-    for (auto v : mesh_.vertices())
-        tex[v] = TexCoord(0.5, 0.5);
-
     // find 1st boundary vertex
-    for (vit = mesh_.vertices_begin(); vit != vend; ++vit)
-        if (mesh_.is_boundary(*vit))
+    for (auto v : chart.vertices)
+        if (mesh_.is_boundary(v))
+        {
+            vh = v;
             break;
+        }
 
     // no boundary found ?
-    if (vit == vend)
+    if (!vh.is_valid())
     {
         std::cerr << "Mesh has no boundary." << std::endl;
         return false;
     }
 
     // collect boundary loop
-    vh = *vit;
     hh = mesh_.halfedge(vh);
     do
     {
@@ -94,120 +341,278 @@ bool SurfaceParameterization::setup_boundary_constraints()
 
 //-----------------------------------------------------------------------------
 
+bool SurfaceParameterization::coarse_solution(const Chart& chart, bool lscm,
+                                              bool use_uniform_weights,
+                                              std::vector<TexCoord>& tex) const
+{
+    if (!coarse_vertices_ || chart.vertices.size() < 2 * coarse_vertices_)
+        return false;
+
+    // copy the chart
+    SurfaceMesh coarse;
+    std::vector<Vertex> vertices(mesh_.vertices_size());
+    for (auto v : chart.vertices)
+        vertices[v.idx()] = coarse.add_vertex(mesh_.position(v));
+    std::vector<Vertex> face;
+    for (auto f : chart.faces)
+    {
+        if (mesh_.valence(f) != 3)
+            return false;
+        face.clear();
+        for (auto v : mesh_.vertices(f))
+            face.push_back(vertices[v.idx()]);
+        coarse.add_face(face);
+    }
+
+    // simplify and parameterize the copy
+    SurfaceSimplification simplification(coarse);
+    simplification.initialize(5.0); // aspect ratio
+    simplification.simplify(coarse_vertices_);
+    coarse.garbage_collection();
+    SurfaceParameterization parameterization(coarse);
+    if (lscm)
+        parameterization.lscm();
+    else
+        parameterization.harmonic(use_uniform_weights);
+
+    // interpolate at the nearest points of the copy
+    auto coarse_tex = coarse.get_vertex_property<TexCoord>("v:tex");
+    TriangleKdTree tree(coarse, 0);
+    tex.resize(chart.vertices.size());
+    for (size_t i = 0; i < chart.vertices.size(); ++i)
+    {
+        const auto nn = tree.nearest(mesh_.position(chart.vertices[i]));
+        auto fv = coarse.vertices(nn.face);
+        const Vertex a = *fv, b = *(++fv), c = *(++fv);
+        const Point w = barycentric_coordinates(
+            nn.nearest, coarse.position(a), coarse.position(b),
+            coarse.position(c));
+        tex[i] = w[0] * coarse_tex[a] + w[1] * coarse_tex[b] +
+                 w[2] * coarse_tex[c];
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
 void SurfaceParameterization::harmonic(bool use_uniform_weights)
 {
-    // map boundary to circle
-    if (!setup_boundary_constraints())
+    // Initialize all texture coordinates to the origin.
+    auto tex = mesh_.vertex_property<TexCoord>("v:tex");
+    for (auto v : mesh_.vertices())
+        tex[v] = TexCoord(0.5, 0.5);
+
+    // Laplace matrix with cotan or uniform weights
+    LaplaceMatrix laplace(mesh_);
+    laplace.assemble(use_uniform_weights);
+    const CompressedRowMatrix& L = laplace.matrix();
+
+    // the index of each vertex among the free vertices of its chart
+    std::vector<int> index(mesh_.vertices_size(), -1);
+    for_each_chart(find_charts(mesh_), [&](const Chart& chart) {
+        harmonic(chart, L, index, use_uniform_weights);
+    });
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceParameterization::harmonic_persistent(bool use_uniform_weights)
+{
+    // map the boundary to the unit circle if it has no texture coordinates
+    auto tex = mesh_.get_vertex_property<TexCoord>("v:tex");
+    if (!tex)
     {
-        std::cerr << "Could not perform setup of boundary constraints.\n";
+        tex = mesh_.add_vertex_property<TexCoord>("v:tex", TexCoord(0.5, 0.5));
+        for (const auto& chart : find_charts(mesh_))
+            setup_boundary_constraints(chart);
+    }
+
+    // factor the interior system again only if it has changed
+    HarmonicSystem* system = harmonic_system_.get();
+    if (!system || system->topology_version != mesh_.topology_version() ||
+        system->use_uniform_weights != use_uniform_weights)
+    {
+        system = new HarmonicSystem;
+        harmonic_system_.reset(system);
+        system->topology_version = mesh_.topology_version();
+        system->use_uniform_weights = use_uniform_weights;
+
+        // the free vertices are the interior ones of charts with a boundary
+        std::vector<char> is_free(mesh_.vertices_size(), false);
+        for (const auto& chart : find_charts(mesh_))
+        {
+            bool has_boundary = false;
+            for (auto v : chart.vertices)
+                if (mesh_.is_boundary(v))
+                    has_boundary = true;
+            if (!has_boundary)
+            {
+                std::cerr << "Mesh has no boundary." << std::endl;
+                continue;
+            }
+            for (auto v : chart.vertices)
+                is_free[v.idx()] = true;
+        }
+        std::vector<int> index(mesh_.vertices_size(), -1);
+        for (auto v : mesh_.vertices())
+            if (is_free[v.idx()] && !mesh_.is_boundary(v))
+            {
+                index[v.idx()] = system->vertices.size();
+                system->vertices.push_back(v);
+            }
+
+        LaplaceMatrix laplace(mesh_);
+        laplace.assemble(use_uniform_weights);
+        CompressedRowMatrix A;
+        extract(laplace.matrix(), index, index, A, system->boundary);
+        system->solver.compute(A);
+    }
+
+    // the columns of the boundary vertices go to the right hand side B,
+    // which stores the coordinates column by column
+    const std::vector<Vertex>& vertices = system->vertices;
+    const CompressedRowMatrix& F = system->boundary;
+    const unsigned int n = vertices.size();
+    if (n == 0)
         return;
+    std::vector<double> B(2 * n, 0.0), X(2 * n);
+    for (unsigned int i = 0; i < n; ++i)
+    {
+        X[i] = tex[vertices[i]][0];
+        X[n + i] = tex[vertices[i]][1];
+        for (int k = F.offsets[i]; k < F.offsets[i + 1]; ++k)
+        {
+            const TexCoord& t = tex[Vertex(F.columns[k])];
+            B[i] -= F.values[k] * t[0];
+            B[n + i] -= F.values[k] * t[1];
+        }
     }
 
-    // get properties
-    auto tex = mesh_.vertex_property<TexCoord>("v:tex");
-    auto eweight = mesh_.add_edge_property<Scalar>("e:param");
-    auto idx = mesh_.add_vertex_property<int>("v:idx", -1);
+    if (!system->solver.solve(B, X))
+    {
+        std::cerr << "SurfaceParameterization: Could not solve linear system\n";
+    }
+    else
+    {
+        for (unsigned int i = 0; i < n; ++i)
+        {
+            tex[vertices[i]][0] = X[i];
+            tex[vertices[i]][1] = X[n + i];
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
 
-    // compute Laplace weight per edge: cotan or uniform
-    for (auto e : mesh_.edges())
+void SurfaceParameterization::harmonic(const Chart& chart,
+                                       const CompressedRowMatrix& L,
+                                       std::vector<int>& index,
+                                       bool use_uniform_weights)
+{
+    // map boundary to circle
+    if (!setup_boundary_constraints(chart))
     {
-        eweight[e] =
-            use_uniform_weights ? 1.0 : std::max(0.0, cotan_weight(mesh_, e));
+        std::cerr << "Could not perform setup of boundary constraints.\n";
+        return;
     }
 
+    // get properties
+    auto tex = mesh_.get_vertex_property<TexCoord>("v:tex");
+
     // collect free (non-boundary) vertices in array free_vertices[]
-    // assign indices such that idx[ free_vertices[i] ] == i
-    unsigned i = 0;
+    // assign indices such that index[ free_vertices[i] ] == i
     std::vector<Vertex> free_vertices;
-    free_vertices.reserve(mesh_.n_vertices());
-    for (auto v : mesh_.vertices())
+    for (auto v : chart.vertices)
     {
         if (!mesh_.is_boundary(v))
         {
-            idx[v] = i++;
+            index[v.idx()] = free_vertices.size();
             free_vertices.push_back(v);
         }
     }
 
-    // setup matrix A and rhs B
+    // the rows of the free vertices, the columns of the boundary vertices
+    // go to the right hand side B, which stores the coordinates column by
+    // column
     const unsigned int n = free_vertices.size();
-    Eigen::SparseMatrix<double> A(n, n);
-    Eigen::MatrixXd B(n, 2);
-    std::vector<Eigen::Triplet<double>> triplets;
-    double w, ww;
-    Vertex v, vv;
-    Edge e;
-    for (i = 0; i < n; ++i)
+    CompressedRowMatrix A;
+    A.n_rows = A.n_columns = n;
+    A.offsets.push_back(0);
+    std::vector<double> B(2 * n, 0.0), X;
+    for (unsigned int i = 0; i < n; ++i)
     {
-        v = free_vertices[i];
-
-        // rhs row
-        B(i, 0) = 0.0;
-        B(i, 1) = 0.0;
-
-        // lhs row
-        ww = 0.0;
-        for (auto h : mesh_.halfedges(v))
+        const int r = free_vertices[i].idx();
+        for (int k = L.offsets[r]; k < L.offsets[r + 1]; ++k)
         {
-            vv = mesh_.to_vertex(h);
-            e = mesh_.edge(h);
-            w = eweight[e];
-            ww += w;
-
-            if (mesh_.is_boundary(vv))
+            const int j = index[L.columns[k]];
+            if (j >= 0)
             {
-                B(i, 0) -= -w * tex[vv][0];
-                B(i, 1) -= -w * tex[vv][1];
+                A.columns.push_back(j);
+                A.values.push_back(L.values[k]);
             }
             else
             {
-                triplets.emplace_back(i, idx[vv], -w);
+                const TexCoord& t = tex[Vertex(L.columns[k])];
+                B[i] -= L.values[k] * t[0];
+                B[n + i] -= L.values[k] * t[1];
             }
         }
-        triplets.emplace_back(i, i, ww);
+        A.offsets.push_back(A.columns.size());
     }
 
-    // build sparse matrix from triplets
-    A.setFromTriplets(triplets.begin(), triplets.end());
+    // start from the solution of a simplified copy
+    std::vector<TexCoord> guess;
+    const bool warm_start =
+        coarse_solution(chart, false, use_uniform_weights, guess);
+    if (warm_start)
+    {
+        X.resize(2 * n);
+        for (size_t i = 0, j = 0; i < chart.vertices.size(); ++i)
+            if (!mesh_.is_boundary(chart.vertices[i]))
+            {
+                X[j] = guess[i][0];
+                X[n + j] = guess[i][1];
+                ++j;
+            }
+    }
 
     // solve A*X = B
-    Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> solver(A);
-    Eigen::MatrixXd X = solver.solve(B);
-    if (solver.info() != Eigen::Success)
+    SparseSolver solver(warm_start ? SparseSolver::Multigrid
+                                   : SparseSolver::default_method());
+    if (warm_start)
+        solver.set_tolerance(1e-8);
+    if (!solver.compute(A) || !solver.solve(B, X))
     {
         std::cerr << "SurfaceParameterization: Could not solve linear system\n";
     }
     else
     {
         // copy solution
-        for (i = 0; i < n; ++i)
+        for (unsigned int i = 0; i < n; ++i)
         {
-            v = free_vertices[i];
-            tex[v][0] = X(i, 0);
-            tex[v][1] = X(i, 1);
+            const Vertex v = free_vertices[i];
+            tex[v][0] = X[i];
+            tex[v][1] = X[n + i];
         }
     }
-
-    // clean-up
-    mesh_.remove_vertex_property(idx);
-    mesh_.remove_edge_property(eweight);
 }
 
 //-----------------------------------------------------------------------------
 
-bool SurfaceParameterization::setup_lscm_boundary()
+bool SurfaceParameterization::setup_lscm_boundary(const Chart& chart,
+                                                  Vertex& v1, Vertex& v2)
 {
     // constrain the two boundary vertices farthest from each other to fix
     // the translation and rotation of the resulting parameterization
 
     // vertex properties
-    auto pos = mesh_.vertex_property<Point>("v:point");
-    auto tex = mesh_.vertex_property<TexCoord>("v:tex");
-    auto locked = mesh_.add_vertex_property<bool>("v:locked", false);
+    auto pos = mesh_.get_vertex_property<Point>("v:point");
+    auto tex = mesh_.get_vertex_property<TexCoord>("v:tex");
 
     // find boundary vertices and store handles in vector
     std::vector<Vertex> boundary;
-    for (auto v : mesh_.vertices())
+    for (auto v : chart.vertices)
         if (mesh_.is_boundary(v))
             boundary.push_back(v);
 
@@ -219,7 +624,6 @@ bool SurfaceParameterization::setup_lscm_boundary()
 
     // find boundary vertices with largest distance
     Scalar diam(0.0), d;
-    Vertex v1, v2;
     for (auto vv1 : boundary)
     {
         for (auto vv2 : boundary)
@@ -235,38 +639,25 @@ bool SurfaceParameterization::setup_lscm_boundary()
     }
 
     // pin these two boundary vertices
-    for (auto v : mesh_.vertices())
-    {
-        tex[v] = TexCoord(0.5, 0.5);
-        locked[v] = false;
-    }
     tex[v1] = TexCoord(0.0, 0.0);
     tex[v2] = TexCoord(1.0, 1.0);
-    locked[v1] = true;
-    locked[v2] = true;
 
-    return true;
+    return v1.is_valid();
 }
 
 //-----------------------------------------------------------------------------
 
 void SurfaceParameterization::lscm()
 {
-    // boundary constraints
-    if (!setup_lscm_boundary())
-        return;
-
     // properties
     auto pos = mesh_.vertex_property<Point>("v:point");
     auto tex = mesh_.vertex_property<TexCoord>("v:tex");
-    auto idx = mesh_.add_vertex_property<int>("v:idx", -1);
     auto weight = mesh_.add_halfedge_property<dvec2>("h:lscm");
-    auto locked = mesh_.get_vertex_property<bool>("v:locked");
-    assert(locked);
+    for (auto v : mesh_.vertices())
+        tex[v] = TexCoord(0.5, 0.5);
 
     // compute weights/gradients per face/halfedge
-    for (auto f : mesh_.faces())
-    {
+    parallel_for(mesh_.faces(), [&](Face f) {
         // collect face halfedge
         auto fh_it = mesh_.halfedges(f);
         auto ha = *fh_it;
@@ -307,40 +698,59 @@ void SurfaceParameterization::lscm()
         weight[ha] = dvec2(w_ar * area, w_ai * area);
         weight[hb] = dvec2(w_br * area, w_bi * area);
         weight[hc] = dvec2(w_cr * area, w_ci * area);
-    }
+    });
+
+    // the index of each vertex among the free vertices of its chart
+    std::vector<int> index(mesh_.vertices_size(), -1);
+    for_each_chart(find_charts(mesh_),
+                   [&](const Chart& chart) { lscm(chart, index); });
+
+    // clean-up
+    mesh_.remove_halfedge_property(weight);
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceParameterization::lscm(const Chart& chart,
+                                   std::vector<int>& index)
+{
+    // boundary constraints
+    Vertex pin1, pin2;
+    if (!setup_lscm_boundary(chart, pin1, pin2))
+        return;
+
+    // properties
+    auto tex = mesh_.get_vertex_property<TexCoord>("v:tex");
+    auto weight = mesh_.get_halfedge_property<dvec2>("h:lscm");
 
     // collect free (non-boundary) vertices in array free_vertices[]
-    // assign indices such that idx[ free_vertices[i] ] == i
-    unsigned i = 0;
+    // assign indices such that index[ free_vertices[i] ] == i
     std::vector<Vertex> free_vertices;
-    free_vertices.reserve(mesh_.n_vertices());
-    for (auto v : mesh_.vertices())
+    free_vertices.reserve(chart.vertices.size());
+    for (auto v : chart.vertices)
     {
-        if (!locked[v])
+        if (v != pin1 && v != pin2)
         {
-            idx[v] = i++;
+            index[v.idx()] = free_vertices.size();
             free_vertices.push_back(v);
         }
     }
 
     // build matrix and rhs
-    const unsigned int nv2 = 2 * mesh_.n_vertices();
-    const unsigned int nv = mesh_.n_vertices();
     const unsigned int n = free_vertices.size();
-    Vertex vi, vj;
-    Halfedge hh;
+    Vertex vj;
     double si, sj0, sj1, sign;
     int row(0), c0, c1;
 
     Eigen::SparseMatrix<double> A(2 * n, 2 * n);
-    Eigen::VectorXd b = Eigen::VectorXd::Zero(2 * n);
+    std::vector<double> b(2 * n, 0.0);
     std::vector<Eigen::Triplet<double>> triplets;
 
-    for (unsigned int i = 0; i < nv2; ++i)
+    for (unsigned int i = 0; i < 2 * n; ++i)
     {
-        vi = Vertex(i % nv);
+        const Vertex vi = free_vertices[i % n];
 
-        if (i < nv)
+        if (i < n)
         {
             sign = 1.0;
             c0 = 0;
@@ -353,68 +763,122 @@ void SurfaceParameterization::lscm()
             c1 = 0;
         }
 
-        if (!locked[vi])
+        si = 0;
+
+        for (auto h : mesh_.halfedges(vi))
         {
-            si = 0;
+            vj = mesh_.to_vertex(h);
+            sj0 = sj1 = 0;
 
-            for (auto h : mesh_.halfedges(vi))
+            if (!mesh_.is_boundary(h))
             {
-                vj = mesh_.to_vertex(h);
-                sj0 = sj1 = 0;
-
-                if (!mesh_.is_boundary(h))
-                {
-                    const dvec2& wj = weight[h];
-                    const dvec2& wi = weight[mesh_.prev_halfedge(h)];
+                const dvec2& wj = weight[h];
+                const dvec2& wi = weight[mesh_.prev_halfedge(h)];
 
-                    sj0 += sign * wi[c0] * wj[0] + wi[c1] * wj[1];
-                    sj1 += -sign * wi[c0] * wj[1] + wi[c1] * wj[0];
-                    si += wi[0] * wi[0] + wi[1] * wi[1];
-                }
+                sj0 += sign * wi[c0] * wj[0] + wi[c1] * wj[1];
+                sj1 += -sign * wi[c0] * wj[1] + wi[c1] * wj[0];
+                si += wi[0] * wi[0] + wi[1] * wi[1];
+            }
 
-                h = mesh_.opposite_halfedge(h);
-                if (!mesh_.is_boundary(h))
-                {
-                    const dvec2& wi = weight[h];
-                    const dvec2& wj = weight[mesh_.prev_halfedge(h)];
+            h = mesh_.opposite_halfedge(h);
+            if (!mesh_.is_boundary(h))
+            {
+                const dvec2& wi = weight[h];
+                const dvec2& wj = weight[mesh_.prev_halfedge(h)];
 
-                    sj0 += sign * wi[c0] * wj[0] + wi[c1] * wj[1];
-                    sj1 += -sign * wi[c0] * wj[1] + wi[c1] * wj[0];
-                    si += wi[0] * wi[0] + wi[1] * wi[1];
-                }
+                sj0 += sign * wi[c0] * wj[0] + wi[c1] * wj[1];
+                sj1 += -sign * wi[c0] * wj[1] + wi[c1] * wj[0];
+                si += wi[0] * wi[0] + wi[1] * wi[1];
+            }
 
-                if (!locked[vj])
-                {
-                    triplets.emplace_back(row, idx[vj], sj0);
-                    triplets.emplace_back(row, idx[vj] + n, sj1);
-                }
-                else
-                {
-                    b[row] -= sj0 * tex[vj][0];
-                    b[row] -= sj1 * tex[vj][1];
-                }
+            if (vj != pin1 && vj != pin2)
+            {
+                triplets.emplace_back(row, index[vj.idx()], sj0);
+                triplets.emplace_back(row, index[vj.idx()] + n, sj1);
             }
+            else
+            {
+                b[row] -= sj0 * tex[vj][0];
+                b[row] -= sj1 * tex[vj][1];
+            }
+        }
 
-            triplets.emplace_back(row, idx[vi] + (i < nv ? 0 : n), 0.5 * si);
+        triplets.emplace_back(row, index[vi.idx()] + (i < n ? 0 : n),
+                              0.5 * si);
 
-            ++row;
-        }
+        ++row;
     }
 
-    // build sparse matrix from triplets
+    // build sparse matrix from triplets, it is symmetric, hence its
+    // compressed columns are its compressed rows
     A.setFromTriplets(triplets.begin(), triplets.end());
+    CompressedRowMatrix M;
+    M.n_rows = M.n_columns = 2 * n;
+    M.offsets.assign(A.outerIndexPtr(), A.outerIndexPtr() + 2 * n + 1);
+    M.columns.assign(A.innerIndexPtr(), A.innerIndexPtr() + A.nonZeros());
+    M.values.assign(A.valuePtr(), A.valuePtr() + A.nonZeros());
+
+    // start from the solution of a simplified copy, moved by the
+    // similarity that maps it to the pinned vertices
+    std::vector<TexCoord> guess;
+    std::vector<double> x;
+    const bool warm_start = coarse_solution(chart, true, false, guess);
+    if (warm_start)
+    {
+        typedef std::complex<double> Complex;
+        Complex z1, z2;
+        for (size_t i = 0; i < chart.vertices.size(); ++i)
+        {
+            const Complex z(guess[i][0], guess[i][1]);
+            if (chart.vertices[i] == pin1)
+                z1 = z;
+            if (chart.vertices[i] == pin2)
+                z2 = z;
+        }
+        const Complex s =
+            z2 != z1 ? Complex(1.0, 1.0) / (z2 - z1) : Complex(1.0);
+
+        x.resize(2 * n);
+        for (size_t i = 0; i < chart.vertices.size(); ++i)
+        {
+            const int j = index[chart.vertices[i].idx()];
+            const Vertex v = chart.vertices[i];
+            if (v == pin1 || v == pin2)
+                continue;
+            const Complex z = s * (Complex(guess[i][0], guess[i][1]) - z1);
+            x[j] = z.real();
+            x[n + j] = z.imag();
+        }
+    }
 
     // solve A*X = B
-    Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> solver(A);
-    Eigen::VectorXd x = solver.solve(b);
-    if (solver.info() != Eigen::Success)
+    SparseSolver solver(warm_start ? SparseSolver::Multigrid
+                                   : SparseSolver::default_method());
+    if (warm_start)
+    {
+        // the translations and the similarities of the guess are close to
+        // the kernel of the conformal energy
+        std::vector<double> kernel(8 * n, 0.0);
+        for (unsigned int i = 0; i < n; ++i)
+        {
+            kernel[i] = 1.0;
+            kernel[3 * n + i] = 1.0;
+            kernel[4 * n + i] = x[i];
+            kernel[5 * n + i] = x[n + i];
+            kernel[6 * n + i] = -x[n + i];
+            kernel[7 * n + i] = x[i];
+        }
+        solver.set_near_kernel(kernel);
+        solver.set_tolerance(1e-8);
+    }
+    if (!solver.compute(M) || !solver.solve(b, x))
     {
         std::cerr << "SurfaceParameterization: Could not solve linear system\n";
     }
     else
     {
         // copy solution
-        for (i = 0; i < n; ++i)
+        for (unsigned int i = 0; i < n; ++i)
         {
             tex[free_vertices[i]] = TexCoord(x[i], x[i + n]);
         }
@@ -422,23 +886,154 @@ void SurfaceParameterization::lscm()
 
     // scale tex coordiantes to unit square
     TexCoord bbmin(1, 1), bbmax(0, 0);
-    for (auto v : mesh_.vertices())
+    for (auto v : chart.vertices)
     {
         bbmin = min(bbmin, tex[v]);
         bbmax = max(bbmax, tex[v]);
     }
     bbmax -= bbmin;
     Scalar s = std::max(bbmax[0], bbmax[1]);
-    for (auto v : mesh_.vertices())
+    for (auto v : chart.vertices)
     {
         tex[v] -= bbmin;
         tex[v] /= s;
     }
+}
 
-    // clean-up
-    mesh_.remove_vertex_property(idx);
-    mesh_.remove_vertex_property(locked);
-    mesh_.remove_halfedge_property(weight);
+//-----------------------------------------------------------------------------
+
+bool SurfaceParameterization::atlas(Scalar max_angle)
+{
+    if (!mesh_.is_triangle_mesh())
+    {
+        std::cerr << "SurfaceParameterization: Not a triangle mesh\n";
+        return false;
+    }
+
+    std::vector<int> face_chart;
+    const std::vector<std::vector<Face>> charts =
+        segment_charts(mesh_, std::cos(max_angle / 180.0 * M_PI), face_chart);
+
+    // parameterize a copy of each chart, scaled to its surface area, the
+    // texture coordinates of its sorted vertices start at the origin
+    std::vector<std::vector<IndexType>> chart_vertices(charts.size());
+    std::vector<std::vector<TexCoord>> chart_tex(charts.size());
+    std::vector<TexCoord> sizes(charts.size());
+    parallel_for_chunks(
+        charts.size(),
+        [&](size_t begin, size_t end) {
+            for (size_t c = begin; c < end; ++c)
+            {
+                const std::vector<Face>& faces = charts[c];
+                std::vector<IndexType>& vertices = chart_vertices[c];
+                for (auto f : faces)
+                    for (auto v : mesh_.vertices(f))
+                        vertices.push_back(v.idx());
+                std::sort(vertices.begin(), vertices.end());
+                vertices.erase(std::unique(vertices.begin(), vertices.end()),
+                               vertices.end());
+
+                SurfaceMesh chart;
+                for (auto v : vertices)
+                    chart.add_vertex(mesh_.position(Vertex(v)));
+                Scalar area = 0;
+                std::vector<Vertex> face;
+                for (auto f : faces)
+                {
+                    face.clear();
+                    for (auto v : mesh_.vertices(f))
+                        face.push_back(Vertex(
+                            std::lower_bound(vertices.begin(), vertices.end(),
+                                             v.idx()) -
+                            vertices.begin()));
+                    chart.add_face(face);
+                    area += triangle_area(mesh_, f);
+                }
+
+                SurfaceParameterization parameterization(chart);
+                parameterization.set_coarse_vertices(coarse_vertices_);
+                parameterization.lscm();
+                auto tex = chart.get_vertex_property<TexCoord>("v:tex");
+
+                Scalar tex_area = 0;
+                for (auto f : chart.faces())
+                {
+                    auto fv = chart.vertices(f);
+                    const TexCoord a = tex[*fv], b = tex[*(++fv)],
+                                   d = tex[*(++fv)];
+                    tex_area += 0.5 * std::abs((b[0] - a[0]) * (d[1] - a[1]) -
+                                               (b[1] - a[1]) * (d[0] - a[0]));
+                }
+                const Scalar s =
+                    tex_area > 0 ? std::sqrt(area / tex_area) : Scalar(1);
+
+                TexCoord bbmin(tex[Vertex(0)]), bbmax(bbmin);
+                for (auto v : chart.vertices())
+                {
+                    bbmin = min(bbmin, tex[v]);
+                    bbmax = max(bbmax, tex[v]);
+                }
+                for (auto v : chart.vertices())
+                    chart_tex[c].push_back(s * (tex[v] - bbmin));
+                sizes[c] = s * (bbmax - bbmin);
+            }
+        },
+        1);
+
+    // pack the charts into rows of decreasing height, separated by gaps
+    std::vector<size_t> order(charts.size());
+    Scalar total = 0, width = 0;
+    for (size_t c = 0; c < charts.size(); ++c)
+    {
+        order[c] = c;
+        total += sizes[c][0] * sizes[c][1];
+    }
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return sizes[a][1] > sizes[b][1];
+    });
+    const Scalar gap = 0.01 * std::sqrt(total);
+    for (size_t c = 0; c < charts.size(); ++c)
+        width = std::max(width, sizes[c][0] + 2 * gap);
+    width = std::max(width, Scalar(1.1) * std::sqrt(total));
+
+    std::vector<TexCoord> offsets(charts.size());
+    TexCoord position(gap, gap);
+    Scalar row_height = 0;
+    for (auto c : order)
+    {
+        if (position[0] + sizes[c][0] + gap > width)
+        {
+            position = TexCoord(gap, position[1] + row_height + gap);
+            row_height = 0;
+        }
+        offsets[c] = position;
+        position[0] += sizes[c][0] + gap;
+        row_height = std::max(row_height, sizes[c][1]);
+    }
+    const Scalar scale =
+        1.0 / std::max(width, position[1] + row_height + gap);
+
+    // texture coordinates per halfedge, such that seams cut the atlas
+    auto htex = mesh_.halfedge_property<TexCoord>("h:tex");
+    auto fchart = mesh_.face_property<int>("f:chart");
+    for (size_t c = 0; c < charts.size(); ++c)
+    {
+        const std::vector<IndexType>& vertices = chart_vertices[c];
+        for (auto f : charts[c])
+        {
+            fchart[f] = c;
+            for (auto h : mesh_.halfedges(f))
+            {
+                const size_t i =
+                    std::lower_bound(vertices.begin(), vertices.end(),
+                                     mesh_.to_vertex(h).idx()) -
+                    vertices.begin();
+                htex[h] = scale * (chart_tex[c][i] + offsets[c]);
+            }
+        }
+    }
+
+    return true;
 }
 
 //=============================================================================
@@ -10,6 +10,10 @@
 //=============================================================================
 
 #include <pmp/SurfaceMesh.h>
+#include <pmp/algorithms/SparseSolver.h>
+
+#include <memory>
+#include <vector>
 
 //=============================================================================
 
@@ -24,29 +28,104 @@ namespace pmp {
 
 //! \brief A class for surface parameterization.
 //! \details See \cite levy_2002_least and \cite desbrun_2002_intrinsic
-//! for more details.
+//! for more details. Each connected component of the mesh, e.g., a chart
+//! cut along seams, is parameterized on its own, several of them in
+//! parallel.
 class SurfaceParameterization
 {
 public:
     //! Construct with mesh to be parameterized.
     SurfaceParameterization(SurfaceMesh& mesh);
 
+    // destructor
+    ~SurfaceParameterization();
+
     //! Compute discrete harmonic parameterization.
     void harmonic(bool use_uniform_weights = false);
 
+    //! \brief Harmonic parameterization for the given boundary.
+    //! \details The boundary vertices keep their texture coordinates in
+    //! "v:tex", e.g., a boundary shape other than the circle of harmonic(),
+    //! which is used if "v:tex" does not exist. The factorization of the
+    //! interior system is kept while the topology of the mesh and
+    //! \p use_uniform_weights are unchanged, so later calls for other
+    //! boundary coordinates only update the right-hand side and solve by
+    //! back-substitution. The weights remain those of the factorization.
+    void harmonic_persistent(bool use_uniform_weights = false);
+
     //! Compute parameterization based on least squares conformal mapping.
     void lscm();
 
+    //! \brief Compute a texture atlas of charts, each parameterized by
+    //! lscm().
+    //! \details Segments the mesh into disk-shaped charts, which do not grow
+    //! across the feature edges "e:feature" of SurfaceFeatures and whose
+    //! face normals stay within \p max_angle degrees of the normal of their
+    //! first face. The charts are parameterized concurrently, scaled to
+    //! their surface area, and packed into rows of the unit square. Writes
+    //! the texture coordinates to "h:tex", which write_obj() exports, and
+    //! the index of the chart of each face to "f:chart".
+    //! \return false if the mesh is not a triangle mesh
+    bool atlas(Scalar max_angle = 60.0);
+
+    //! \brief Start the solvers from the parameterization of a copy
+    //! simplified to \p coarse_vertices.
+    //! \details Applies to triangle charts with at least twice as many
+    //! vertices, which are then solved by SparseSolver::Multigrid to a
+    //! relative residual of 1e-8, starting from the interpolated coarse
+    //! solution. Pays off for lscm() on charts of several 100k vertices,
+    //! where the fill-in of a direct solver grows fastest; simplification
+    //! dominates for harmonic(). The default 0 solves with
+    //! SparseSolver::default_method().
+    void set_coarse_vertices(unsigned int coarse_vertices)
+    {
+        coarse_vertices_ = coarse_vertices;
+    }
+
 private:
+    //! a connected component of the mesh
+    struct Chart
+    {
+        std::vector<Vertex> vertices; //!< in index order
+        std::vector<Face> faces;
+    };
+
+    //! the connected components of the mesh, largest first
+    static std::vector<Chart> find_charts(const SurfaceMesh& mesh);
+
+    //! harmonic parameterization of \p chart, with the Laplace matrix \p L
+    //! of the mesh, \p index maps vertices to rows
+    void harmonic(const Chart& chart, const CompressedRowMatrix& L,
+                  std::vector<int>& index, bool use_uniform_weights);
+
+    //! least squares conformal map of \p chart, \p index maps vertices to
+    //! rows
+    void lscm(const Chart& chart, std::vector<int>& index);
+
+    //! \brief Parameterize a simplified copy of \p chart.
+    //! \details Interpolates at the nearest points of the copy to \p tex,
+    //! one per vertex of the chart.
+    //! \return false if the chart is too small or not a triangle mesh
+    bool coarse_solution(const Chart& chart, bool lscm,
+                         bool use_uniform_weights,
+                         std::vector<TexCoord>& tex) const;
+
     //! setup boundary constraints: map surface boundary to unit circle
-    bool setup_boundary_constraints();
+    bool setup_boundary_constraints(const Chart& chart);
 
     //! setup boundary: pin the two farthest boundary vertices
-    bool setup_lscm_boundary();
+    bool setup_lscm_boundary(const Chart& chart, Vertex& v1, Vertex& v2);
 
 private:
     //! the mesh
     SurfaceMesh& mesh_;
+
+    //! the size of the simplified copies, 0 to solve directly
+    unsigned int coarse_vertices_;
+
+    // the factorization of harmonic_persistent(), kept between calls
+    struct HarmonicSystem;
+    std::unique_ptr<HarmonicSystem> harmonic_system_;
 };
 
 //=============================================================================
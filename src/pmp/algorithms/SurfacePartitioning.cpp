@@ -0,0 +1,389 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/algorithms/SurfacePartitioning.h>
+#include <pmp/algorithms/DifferentialGeometry.h>
+#include <pmp/BoundingBox.h>
+#include <pmp/Parallel.h>
+
+#include <algorithm>
+#include <unordered_map>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+SurfacePartitioning::SurfacePartitioning(SurfaceMesh& mesh)
+    : mesh_(mesh), n_parts_(1)
+{
+    fpart_ = mesh_.face_property<IndexType>("f:part", 0);
+    for (auto f : mesh_.faces())
+        n_parts_ = std::max(n_parts_, (unsigned int)fpart_[f] + 1);
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfacePartitioning::partition(unsigned int n_parts)
+{
+    n_parts_ = std::max(n_parts, 1u);
+
+    std::vector<Point> centroids(mesh_.faces_size());
+    parallel_for(mesh_.faces(), [&](Face f) {
+        centroids[f.idx()] = centroid(mesh_, f);
+    });
+
+    std::vector<Face> faces;
+    faces.reserve(mesh_.n_faces());
+    for (auto f : mesh_.faces())
+        faces.push_back(f);
+    bisect(faces, 0, faces.size(), centroids, 0, n_parts_);
+
+    for (int i = 0; i < 10 && make_contiguous(); ++i)
+        ;
+
+    refine(10);
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfacePartitioning::bisect(std::vector<Face>& faces, size_t begin,
+                                 size_t end,
+                                 const std::vector<Point>& centroids,
+                                 IndexType first_part, unsigned int n)
+{
+    if (n == 1 || begin == end)
+    {
+        for (size_t i = begin; i < end; ++i)
+            fpart_[faces[i]] = first_part;
+        return;
+    }
+
+    // split along the longest side of the centroids' bounding box
+    BoundingBox bb;
+    for (size_t i = begin; i < end; ++i)
+        bb += centroids[faces[i].idx()];
+    const Point extent = bb.max() - bb.min();
+    int axis = 0;
+    if (extent[1] > extent[axis])
+        axis = 1;
+    if (extent[2] > extent[axis])
+        axis = 2;
+
+    // the face counts are proportional to the numbers of parts
+    const unsigned int n0 = n / 2;
+    const size_t mid = begin + (end - begin) * n0 / n;
+    std::nth_element(faces.begin() + begin, faces.begin() + mid,
+                     faces.begin() + end, [&](Face a, Face b) {
+                         return centroids[a.idx()][axis] <
+                                centroids[b.idx()][axis];
+                     });
+
+    bisect(faces, begin, mid, centroids, first_part, n0);
+    bisect(faces, mid, end, centroids, first_part + n0, n - n0);
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfacePartitioning::make_contiguous()
+{
+    // label the pieces of the parts, connected by edges
+    std::vector<IndexType> piece(mesh_.faces_size(), PMP_MAX_INDEX);
+    std::vector<size_t> piece_size;
+    std::vector<IndexType> piece_part;
+    std::vector<Face> stack;
+    for (auto f : mesh_.faces())
+    {
+        if (piece[f.idx()] != PMP_MAX_INDEX)
+            continue;
+
+        const IndexType p = piece_size.size();
+        piece_size.push_back(0);
+        piece_part.push_back(fpart_[f]);
+        piece[f.idx()] = p;
+        stack.push_back(f);
+        while (!stack.empty())
+        {
+            const Face g = stack.back();
+            stack.pop_back();
+            ++piece_size[p];
+            for (auto h : mesh_.halfedges(g))
+            {
+                const Face n = mesh_.face(mesh_.opposite_halfedge(h));
+                if (n.is_valid() && piece[n.idx()] == PMP_MAX_INDEX &&
+                    fpart_[n] == fpart_[f])
+                {
+                    piece[n.idx()] = p;
+                    stack.push_back(n);
+                }
+            }
+        }
+    }
+
+    // the largest piece of each part stays
+    std::vector<IndexType> largest(n_parts_, PMP_MAX_INDEX);
+    for (IndexType p = 0; p < piece_size.size(); ++p)
+    {
+        IndexType& l = largest[piece_part[p]];
+        if (l == PMP_MAX_INDEX || piece_size[p] > piece_size[l])
+            l = p;
+    }
+
+    // the others go to the part they share most edges with
+    std::unordered_map<IndexType, std::unordered_map<IndexType, size_t>>
+        shared;
+    for (auto f : mesh_.faces())
+    {
+        const IndexType p = piece[f.idx()];
+        if (largest[piece_part[p]] == p)
+            continue;
+        for (auto h : mesh_.halfedges(f))
+        {
+            const Face n = mesh_.face(mesh_.opposite_halfedge(h));
+            if (n.is_valid() && fpart_[n] != fpart_[f])
+                ++shared[p][fpart_[n]];
+        }
+    }
+
+    std::unordered_map<IndexType, IndexType> target;
+    for (const auto& s : shared)
+    {
+        IndexType best = PMP_MAX_INDEX;
+        size_t best_count = 0;
+        for (const auto& c : s.second)
+        {
+            if (c.second > best_count ||
+                (c.second == best_count && c.first < best))
+            {
+                best = c.first;
+                best_count = c.second;
+            }
+        }
+        target[s.first] = best;
+    }
+    if (target.empty())
+        return false;
+
+    for (auto f : mesh_.faces())
+    {
+        const auto it = target.find(piece[f.idx()]);
+        if (it != target.end())
+            fpart_[f] = it->second;
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfacePartitioning::refine(unsigned int iterations)
+{
+    // allow a slight imbalance
+    std::vector<size_t> sizes = part_sizes();
+    const size_t average = mesh_.n_faces() / n_parts_;
+    const size_t max_size = average + average / 32 + 1;
+    const size_t min_size = average - average / 32;
+
+    std::vector<IndexType> neighbors;
+    for (unsigned int i = 0; i < iterations; ++i)
+    {
+        bool moved = false;
+        for (auto f : mesh_.faces())
+        {
+            const IndexType a = fpart_[f];
+            neighbors.clear();
+            for (auto h : mesh_.halfedges(f))
+            {
+                const Face n = mesh_.face(mesh_.opposite_halfedge(h));
+                if (n.is_valid())
+                    neighbors.push_back(fpart_[n]);
+            }
+            const auto count_a = std::count(neighbors.begin(),
+                                            neighbors.end(), a);
+
+            IndexType b = a;
+            long count_b = 0;
+            for (auto p : neighbors)
+            {
+                const long c = std::count(neighbors.begin(), neighbors.end(),
+                                          p);
+                if (p != a && c > count_b)
+                {
+                    b = p;
+                    count_b = c;
+                }
+            }
+
+            // a face with at most one neighbor in its part does not
+            // disconnect the part when it is moved
+            if (b != a && count_b > count_a && count_a <= 1 &&
+                sizes[b] < max_size && sizes[a] > min_size)
+            {
+                fpart_[f] = b;
+                --sizes[a];
+                ++sizes[b];
+                moved = true;
+            }
+        }
+        if (!moved)
+            break;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+std::vector<size_t> SurfacePartitioning::part_sizes() const
+{
+    std::vector<size_t> sizes(n_parts_, 0);
+    for (auto f : mesh_.faces())
+        ++sizes[fpart_[f]];
+    return sizes;
+}
+
+//-----------------------------------------------------------------------------
+
+size_t SurfacePartitioning::edge_cut() const
+{
+    size_t cut = 0;
+    for (auto e : mesh_.edges())
+    {
+        const Face f0 = mesh_.face(mesh_.halfedge(e, 0));
+        const Face f1 = mesh_.face(mesh_.halfedge(e, 1));
+        if (f0.is_valid() && f1.is_valid() && fpart_[f0] != fpart_[f1])
+            ++cut;
+    }
+    return cut;
+}
+
+//-----------------------------------------------------------------------------
+
+IndexType SurfacePartitioning::owner(Vertex v) const
+{
+    Face first;
+    for (auto f : mesh_.faces(v))
+        if (!first.is_valid() || f < first)
+            first = f;
+    return first.is_valid() ? fpart_[first] : PMP_MAX_INDEX;
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfacePartitioning::extract(unsigned int part, SurfaceMesh& result,
+                                  unsigned int halo) const
+{
+    // the faces of the part and the halo rings around them
+    std::vector<Face> faces;
+    std::vector<char> in_copy(mesh_.faces_size(), 0);
+    for (auto f : mesh_.faces())
+    {
+        if (fpart_[f] == part)
+        {
+            faces.push_back(f);
+            in_copy[f.idx()] = 1;
+        }
+    }
+    const size_t n_part_faces = faces.size();
+
+    size_t ring_begin = 0;
+    for (unsigned int i = 0; i < halo; ++i)
+    {
+        const size_t ring_end = faces.size();
+        for (size_t j = ring_begin; j < ring_end; ++j)
+        {
+            for (auto v : mesh_.vertices(faces[j]))
+            {
+                for (auto f : mesh_.faces(v))
+                {
+                    if (!in_copy[f.idx()])
+                    {
+                        in_copy[f.idx()] = 1;
+                        faces.push_back(f);
+                    }
+                }
+            }
+        }
+        ring_begin = ring_end;
+    }
+    std::sort(faces.begin() + n_part_faces, faces.end());
+
+    // number the vertices in the order of their first use
+    std::vector<IndexType> local(mesh_.vertices_size(), PMP_MAX_INDEX);
+    std::vector<Vertex> vertices;
+    std::vector<Point> positions;
+    std::vector<IndexType> indices, face_sizes;
+    for (auto f : faces)
+    {
+        IndexType size = 0;
+        for (auto v : mesh_.vertices(f))
+        {
+            if (local[v.idx()] == PMP_MAX_INDEX)
+            {
+                local[v.idx()] = vertices.size();
+                vertices.push_back(v);
+                positions.push_back(mesh_.position(v));
+            }
+            indices.push_back(local[v.idx()]);
+            ++size;
+        }
+        face_sizes.push_back(size);
+    }
+
+    if (!result.build_from_indices(positions, indices, face_sizes))
+    {
+        std::cerr << "SurfacePartitioning: part " << part
+                  << " is not manifold" << std::endl;
+        return false;
+    }
+    result.copy_properties(mesh_, vertices, faces);
+
+    auto vglobal = result.vertex_property<IndexType>("v:global");
+    auto vowner = result.vertex_property<IndexType>("v:owner");
+    auto vowned = result.vertex_property<bool>("v:owned");
+    for (IndexType i = 0; i < vertices.size(); ++i)
+    {
+        vglobal[Vertex(i)] = vertices[i].idx();
+        vowner[Vertex(i)] = owner(vertices[i]);
+        vowned[Vertex(i)] = vowner[Vertex(i)] == part;
+    }
+
+    auto fglobal = result.face_property<IndexType>("f:global");
+    auto fhalo = result.face_property<bool>("f:halo");
+    for (IndexType i = 0; i < faces.size(); ++i)
+    {
+        fglobal[Face(i)] = faces[i].idx();
+        fhalo[Face(i)] = i >= n_part_faces;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfacePartitioning::update_positions(const SurfaceMesh& part)
+{
+    auto vglobal = part.get_vertex_property<IndexType>("v:global");
+    auto vowned = part.get_vertex_property<bool>("v:owned");
+    if (!vglobal || !vowned)
+    {
+        std::cerr << "SurfacePartitioning: not an extracted part"
+                  << std::endl;
+        return;
+    }
+
+    auto points = mesh_.vertex_property<Point>("v:point");
+    for (auto v : part.vertices())
+    {
+        if (vowned[v])
+            points[Vertex(vglobal[v])] = part.position(v);
+    }
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
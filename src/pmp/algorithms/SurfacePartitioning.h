@@ -0,0 +1,107 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <pmp/SurfaceMesh.h>
+
+#include <vector>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \addtogroup algorithms algorithms
+//! @{
+
+//=============================================================================
+
+//! \brief Partition a mesh into face-contiguous parts of balanced size.
+//! \details The faces are split by recursive coordinate bisection of their
+//! centroids into parts of equal face count. Parts that fall apart are made
+//! contiguous, and faces on the borders of the parts are moved to reduce the
+//! number of cut edges. The part of each face is stored in the face property
+//! "f:part". Each part can be extracted as a separate mesh with rings of
+//! halo faces around it, e.g., to process the parts independently:
+//! \code
+//! SurfacePartitioning partitioning(mesh);
+//! partitioning.partition(8);
+//! for (unsigned int i = 0; i < 8; ++i)
+//! {
+//!     SurfaceMesh part;
+//!     partitioning.extract(i, part, 2);
+//!     SurfaceSmoothing(part).explicit_smoothing(10);
+//!     partitioning.update_positions(part);
+//! }
+//! \endcode
+class SurfacePartitioning
+{
+public:
+    //! Construct with the mesh to be partitioned.
+    SurfacePartitioning(SurfaceMesh& mesh);
+
+    //! \brief Partition the faces into \p n_parts parts.
+    //! \details Faces that are not connected to their part by an edge only
+    //! remain if the mesh itself has more components than parts.
+    void partition(unsigned int n_parts);
+
+    //! the number of parts of the last partition()
+    unsigned int n_parts() const { return n_parts_; }
+
+    //! the number of faces of each part
+    std::vector<size_t> part_sizes() const;
+
+    //! the number of edges between faces of different parts
+    size_t edge_cut() const;
+
+    //! \brief Extract the faces of \p part and \p halo rings around them.
+    //! \details Replaces \p result by the faces in the order of their
+    //! indices, first those of the part and then the halo rings. The
+    //! properties "v:global" and "f:global" of \p result store the index of
+    //! each element in the partitioned mesh, "f:halo" marks the halo faces,
+    //! "v:owner" stores the part owning each vertex, and "v:owned" marks the
+    //! vertices owned by this part. Each vertex is owned by exactly one
+    //! part, the one of its incident face with the smallest index. The other
+    //! vertex and face properties of the mesh are copied along.
+    //! \return whether all faces could be added
+    bool extract(unsigned int part, SurfaceMesh& result,
+                 unsigned int halo = 1) const;
+
+    //! \brief Copy the positions of the vertices owned by \p part back.
+    //! \details \p part has to be extracted by extract() and may be
+    //! modified geometrically, e.g., smoothed.
+    void update_positions(const SurfaceMesh& part);
+
+private:
+    // split faces [begin, end) into the parts [first_part, first_part + n)
+    void bisect(std::vector<Face>& faces, size_t begin, size_t end,
+                const std::vector<Point>& centroids, IndexType first_part,
+                unsigned int n);
+
+    // move the pieces of each part except the largest to a neighboring part
+    bool make_contiguous();
+
+    // move border faces to the part of most of their neighbors
+    void refine(unsigned int iterations);
+
+    // the part of the face with the smallest index incident to \p v
+    IndexType owner(Vertex v) const;
+
+    SurfaceMesh& mesh_;
+    FaceProperty<IndexType> fpart_;
+    unsigned int n_parts_;
+};
+
+//=============================================================================
+//! @}
+//=============================================================================
+} // namespace pmp
+//=============================================================================
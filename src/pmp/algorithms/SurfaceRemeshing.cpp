@@ -12,10 +12,17 @@
 #include <pmp/algorithms/SurfaceCurvature.h>
 #include <pmp/algorithms/SurfaceNormals.h>
 #include <pmp/algorithms/BarycentricCoordinates.h>
+#include <pmp/Parallel.h>
+#include <pmp/Profiler.h>
 
 #include <cfloat>
 #include <cmath>
 #include <algorithm>
+#include <atomic>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+#include <unordered_set>
 
 //=============================================================================
 
@@ -24,12 +31,15 @@ namespace pmp {
 //=============================================================================
 
 SurfaceRemeshing::SurfaceRemeshing(SurfaceMesh& mesh)
-    : mesh_(mesh), refmesh_(nullptr), kd_tree_(nullptr)
+    : mesh_(mesh),
+      refmesh_(nullptr),
+      kd_tree_(nullptr),
+      parallel_(false),
+      padding_(0),
+      keep_curvature_(false),
+      convergence_threshold_(0)
 {
     points_ = mesh_.vertex_property<Point>("v:point");
-
-    SurfaceNormals::compute_vertex_normals(mesh_);
-    vnormal_ = mesh_.vertex_property<Point>("v:normal");
 }
 
 //-----------------------------------------------------------------------------
@@ -42,16 +52,30 @@ void SurfaceRemeshing::uniform_remeshing(Scalar edge_length,
                                          unsigned int iterations,
                                          bool use_projection)
 {
+    PMP_PROFILE_ZONE("SurfaceRemeshing::uniform_remeshing");
+
     if (!mesh_.is_triangle_mesh())
     {
         std::cerr << "Not a triangle mesh!" << std::endl;
         return;
     }
 
+    if (!region_.empty())
+    {
+        remesh_region([&](SurfaceRemeshing& remeshing) {
+            remeshing.uniform_remeshing(edge_length, iterations,
+                                        use_projection);
+        });
+        return;
+    }
+
     uniform_ = true;
     use_projection_ = use_projection;
     target_edge_length_ = edge_length;
 
+    // serve the temporary properties of each iteration from recycled storage
+    PropertyRecyclingScope recycling(mesh_);
+
     preprocessing();
 
     for (unsigned int i = 0; i < iterations; ++i)
@@ -65,6 +89,9 @@ void SurfaceRemeshing::uniform_remeshing(Scalar edge_length,
         flip_edges();
 
         tangential_smoothing(5);
+
+        if (!update_active_set())
+            break;
     }
 
     remove_caps();
@@ -80,18 +107,33 @@ void SurfaceRemeshing::adaptive_remeshing(Scalar min_edge_length,
                                           unsigned int iterations,
                                           bool use_projection)
 {
+    PMP_PROFILE_ZONE("SurfaceRemeshing::adaptive_remeshing");
+
     if (!mesh_.is_triangle_mesh())
     {
         std::cerr << "Not a triangle mesh!" << std::endl;
         return;
     }
 
+    if (!region_.empty())
+    {
+        remesh_region([&](SurfaceRemeshing& remeshing) {
+            remeshing.adaptive_remeshing(min_edge_length, max_edge_length,
+                                         approx_error, iterations,
+                                         use_projection);
+        });
+        return;
+    }
+
     uniform_ = false;
     min_edge_length_ = min_edge_length;
     max_edge_length_ = max_edge_length;
     approx_error_ = approx_error;
     use_projection_ = use_projection;
 
+    // serve the temporary properties of each iteration from recycled storage
+    PropertyRecyclingScope recycling(mesh_);
+
     preprocessing();
 
     for (unsigned int i = 0; i < iterations; ++i)
@@ -105,6 +147,9 @@ void SurfaceRemeshing::adaptive_remeshing(Scalar min_edge_length,
         flip_edges();
 
         tangential_smoothing(5);
+
+        if (!update_active_set())
+            break;
     }
 
     remove_caps();
@@ -114,14 +159,220 @@ void SurfaceRemeshing::adaptive_remeshing(Scalar min_edge_length,
 
 //-----------------------------------------------------------------------------
 
+void SurfaceRemeshing::set_region(const std::vector<Face>& faces,
+                                  unsigned int padding)
+{
+    region_ = faces;
+    padding_ = padding;
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceRemeshing::set_region(const std::vector<Vertex>& vertices,
+                                  unsigned int padding)
+{
+    std::unordered_set<IndexType> visited;
+    region_.clear();
+    for (auto v : vertices)
+    {
+        for (auto f : mesh_.faces(v))
+        {
+            if (visited.insert(f.idx()).second)
+            {
+                region_.push_back(f);
+            }
+        }
+    }
+    padding_ = padding;
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceRemeshing::remesh_region(
+    const std::function<void(SurfaceRemeshing&)>& remesh)
+{
+    std::vector<Face> faces;
+    faces.swap(region_);
+
+    // collect the region and its padding rings
+    std::unordered_set<IndexType> in_region, in_copy;
+    for (auto f : faces)
+    {
+        if (!mesh_.is_deleted(f) && in_copy.insert(f.idx()).second)
+        {
+            in_region.insert(f.idx());
+        }
+    }
+    faces.clear();
+    for (auto idx : in_region)
+    {
+        faces.push_back(Face(idx));
+    }
+    std::sort(faces.begin(), faces.end());
+
+    size_t ring_begin = 0;
+    for (unsigned int i = 0; i < padding_; ++i)
+    {
+        const size_t ring_end = faces.size();
+        for (size_t j = ring_begin; j < ring_end; ++j)
+        {
+            for (auto v : mesh_.vertices(faces[j]))
+            {
+                for (auto f : mesh_.faces(v))
+                {
+                    if (in_copy.insert(f.idx()).second)
+                    {
+                        faces.push_back(f);
+                    }
+                }
+            }
+        }
+        ring_begin = ring_end;
+    }
+
+    // copy the faces, remembering the original vertex of each copy
+    SurfaceMesh copy;
+    auto original = copy.add_vertex_property<IndexType>("v:original",
+                                                        PMP_MAX_INDEX);
+    auto selected = copy.add_vertex_property<bool>("v:selected", false);
+    auto vfeature = mesh_.get_vertex_property<bool>("v:feature");
+    auto efeature = mesh_.get_edge_property<bool>("e:feature");
+    auto copy_vfeature = copy.vertex_property<bool>("v:feature", false);
+    auto copy_efeature = copy.edge_property<bool>("e:feature", false);
+
+    std::unordered_map<IndexType, Vertex> vertex_map;
+    std::vector<Vertex> vertices;
+    for (auto f : faces)
+    {
+        vertices.clear();
+        for (auto v : mesh_.vertices(f))
+        {
+            auto it = vertex_map.find(v.idx());
+            if (it == vertex_map.end())
+            {
+                const Vertex vv = copy.add_vertex(points_[v]);
+                original[vv] = v.idx();
+                if (vfeature)
+                    copy_vfeature[vv] = vfeature[v];
+                it = vertex_map.emplace(v.idx(), vv).first;
+            }
+            vertices.push_back(it->second);
+        }
+
+        if (!copy.add_face(vertices).is_valid())
+        {
+            std::cerr << "SurfaceRemeshing: region is not manifold"
+                      << std::endl;
+            return;
+        }
+    }
+
+    // vertices of the region are free unless they are incident to faces
+    // outside of the copy, since its border has to match the remaining mesh
+    bool has_selection = false;
+    for (auto f : faces)
+    {
+        if (!in_region.count(f.idx()))
+            continue;
+
+        for (auto v : mesh_.vertices(f))
+        {
+            bool inside = true;
+            for (auto ff : mesh_.faces(v))
+            {
+                if (!in_copy.count(ff.idx()))
+                {
+                    inside = false;
+                    break;
+                }
+            }
+            selected[vertex_map[v.idx()]] = inside;
+            has_selection |= inside;
+        }
+    }
+    if (!has_selection)
+    {
+        return;
+    }
+
+    if (efeature)
+    {
+        for (auto e : copy.edges())
+        {
+            const Vertex v0(original[copy.vertex(e, 0)]);
+            const Vertex v1(original[copy.vertex(e, 1)]);
+            const Halfedge h = mesh_.find_halfedge(v0, v1);
+            copy_efeature[e] = efeature[mesh_.edge(h)];
+        }
+    }
+
+    // remesh the copy
+    {
+        SurfaceRemeshing remeshing(copy);
+        remeshing.set_parallel(parallel_);
+        remeshing.set_convergence_threshold(convergence_threshold_);
+        remesh(remeshing);
+    }
+
+    // replace the faces by the remeshed copy
+    for (auto f : faces)
+    {
+        mesh_.delete_face(f);
+    }
+
+    vertex_map.clear();
+    for (auto v : copy.vertices())
+    {
+        // locked border vertices still exist in the mesh
+        Vertex vv(original[v]);
+        if (!vv.is_valid() || mesh_.is_deleted(vv))
+        {
+            vv = mesh_.add_vertex(copy.position(v));
+        }
+        if (vfeature)
+            vfeature[vv] = copy_vfeature[v];
+        vertex_map[v.idx()] = vv;
+    }
+
+    for (auto f : copy.faces())
+    {
+        vertices.clear();
+        for (auto v : copy.vertices(f))
+        {
+            vertices.push_back(vertex_map[v.idx()]);
+        }
+        mesh_.add_face(vertices);
+    }
+
+    if (efeature)
+    {
+        for (auto e : copy.edges())
+        {
+            const Halfedge h =
+                mesh_.find_halfedge(vertex_map[copy.vertex(e, 0).idx()],
+                                    vertex_map[copy.vertex(e, 1).idx()]);
+            if (h.is_valid())
+                efeature[mesh_.edge(h)] = copy_efeature[e];
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
 void SurfaceRemeshing::preprocessing()
 {
+    PMP_PROFILE_ZONE("SurfaceRemeshing::preprocessing");
+
+    SurfaceNormals::compute_vertex_normals(mesh_);
+    vnormal_ = mesh_.vertex_property<Point>("v:normal");
+
     // properties
     vfeature_ = mesh_.vertex_property<bool>("v:feature", false);
     efeature_ = mesh_.edge_property<bool>("e:feature", false);
-    vlocked_ = mesh_.add_vertex_property<bool>("v:locked", false);
-    elocked_ = mesh_.add_edge_property<bool>("e:locked", false);
+    vlocked_ = mesh_.add_vertex_property<Flag>("v:locked", false);
+    elocked_ = mesh_.add_edge_property<Flag>("e:locked", false);
     vsizing_ = mesh_.add_vertex_property<Scalar>("v:sizing");
+    vcurvature_ = VertexProperty<Scalar>();
 
     // lock unselected vertices if some vertices are selected
     auto vselected = mesh_.get_vertex_property<bool>("v:selected");
@@ -179,16 +430,29 @@ void SurfaceRemeshing::preprocessing()
     }
     else
     {
-        // compute curvature for all mesh vertices, using cotan or Cohen-Steiner
-        // do 2 post-smoothing steps to get a smoother sizing field
-        SurfaceCurvature curv(mesh_);
-        //curv.analyze(1);
-        curv.analyze_tensor(1, true);
+        // reuse the curvature of a previous run if available
+        vcurvature_ = mesh_.get_vertex_property<Scalar>("v:max_curvature");
+        if (!vcurvature_)
+        {
+            vcurvature_ = mesh_.add_vertex_property<Scalar>("v:max_curvature");
+
+            // compute curvature for all mesh vertices, using cotan or
+            // Cohen-Steiner do 2 post-smoothing steps to get a smoother
+            // sizing field
+            SurfaceCurvature curv(mesh_);
+            //curv.analyze(1);
+            curv.analyze_tensor(1, true);
+
+            for (auto v : mesh_.vertices())
+            {
+                vcurvature_[v] = curv.max_abs_curvature(v);
+            }
+        }
 
         for (auto v : mesh_.vertices())
         {
             // maximum absolute curvature
-            Scalar c = curv.max_abs_curvature(v);
+            Scalar c = vcurvature_[v];
 
             // curvature of feature vertices: average of non-feature neighbors
             if (vfeature_[v])
@@ -204,7 +468,7 @@ void SurfaceRemeshing::preprocessing()
                     {
                         w = std::max(0.0, cotan_weight(mesh_, mesh_.edge(h)));
                         ww += w;
-                        c += w * curv.max_abs_curvature(vv);
+                        c += w * vcurvature_[vv];
                     }
                 }
 
@@ -254,8 +518,36 @@ void SurfaceRemeshing::preprocessing()
             refsizing_[v] = vsizing_[v];
         }
 
+        // copy curvature to be interpolated as well
+        if (vcurvature_)
+        {
+            refcurvature_ =
+                refmesh_->add_vertex_property<Scalar>("v:max_curvature");
+            for (auto v : refmesh_->vertices())
+            {
+                refcurvature_[v] = vcurvature_[v];
+            }
+        }
+
         // build kd-tree
-        kd_tree_ = new TriangleKdTree(*refmesh_, 0);
+        kd_tree_ = tree_cache_.empty()
+                       ? new TriangleKdTree(*refmesh_, 0)
+                       : new TriangleKdTree(*refmesh_, tree_cache_, 0);
+    }
+
+    // the first iteration processes all vertices
+    if (convergence_threshold_ > 0)
+    {
+        vactive_ = mesh_.add_vertex_property<Flag>("v:active", true);
+        vchanged_ = mesh_.add_vertex_property<Flag>("v:changed", false);
+        vprevious_ = mesh_.add_vertex_property<Point>("v:previous");
+        vprevious_.vector() = points_.vector();
+    }
+    else
+    {
+        vactive_ = VertexProperty<Flag>();
+        vchanged_ = VertexProperty<Flag>();
+        vprevious_ = VertexProperty<Point>();
     }
 }
 
@@ -263,6 +555,8 @@ void SurfaceRemeshing::preprocessing()
 
 void SurfaceRemeshing::postprocessing()
 {
+    PMP_PROFILE_ZONE("SurfaceRemeshing::postprocessing");
+
     // delete kd-tree and reference mesh
     if (use_projection_)
     {
@@ -274,19 +568,89 @@ void SurfaceRemeshing::postprocessing()
     mesh_.remove_vertex_property(vlocked_);
     mesh_.remove_edge_property(elocked_);
     mesh_.remove_vertex_property(vsizing_);
+    if (vcurvature_ && !keep_curvature_)
+    {
+        mesh_.remove_vertex_property(vcurvature_);
+    }
+    if (vactive_)
+    {
+        mesh_.remove_vertex_property(vactive_);
+        mesh_.remove_vertex_property(vchanged_);
+        mesh_.remove_vertex_property(vprevious_);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceRemeshing::update_active_set()
+{
+    if (!vactive_)
+    {
+        return true;
+    }
+
+    // the changed vertices and the ones that moved too far
+    std::atomic<bool> any(false);
+    parallel_for(mesh_.vertices(), [&](Vertex v) {
+        const Scalar moved = distance(points_[v], vprevious_[v]);
+        vactive_[v] = vchanged_[v] ||
+                      moved > convergence_threshold_ * vsizing_[v];
+        vchanged_[v] = false;
+        if (vactive_[v])
+            any = true;
+    });
+
+    // their neighbors see the changes, too
+    for (auto v : mesh_.vertices())
+    {
+        if (vactive_[v])
+        {
+            for (auto vv : mesh_.vertices(v))
+                vchanged_[vv] = true;
+        }
+    }
+    parallel_for(mesh_.vertices(), [&](Vertex v) {
+        if (vchanged_[v])
+        {
+            vactive_[v] = true;
+            vchanged_[v] = false;
+        }
+        vprevious_[v] = points_[v];
+    });
+
+    return any;
 }
 
 //-----------------------------------------------------------------------------
 
-void SurfaceRemeshing::project_to_reference(Vertex v)
+void SurfaceRemeshing::project_to_reference(const std::vector<Vertex>& vertices)
 {
+    PMP_PROFILE_ZONE("SurfaceRemeshing::project_to_reference");
+
     if (!use_projection_)
     {
         return;
     }
 
-    // find closest triangle of reference mesh
-    TriangleKdTree::NearestNeighbor nn = kd_tree_->nearest(points_[v]);
+    // find closest triangles of reference mesh in one batch
+    std::vector<Point> points(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        points[i] = points_[vertices[i]];
+    }
+    const std::vector<TriangleKdTree::NearestNeighbor> nn =
+        kd_tree_->nearest(points);
+
+    parallel_for(size_t(0), vertices.size(), [&](size_t i) {
+        project_to_reference(vertices[i], nn[i]);
+    });
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceRemeshing::project_to_reference(
+    Vertex v, const TriangleKdTree::NearestNeighbor& nn)
+{
     const Point p = nn.nearest;
     const Face f = nn.face;
 
@@ -325,214 +689,412 @@ void SurfaceRemeshing::project_to_reference(Vertex v)
     points_[v] = p;
     vnormal_[v] = n;
     vsizing_[v] = s;
+
+    // interpolate curvature
+    if (vcurvature_)
+    {
+        fvIt = refmesh_->vertices(f);
+        Scalar c = refcurvature_[*fvIt] * b[0];
+        ++fvIt;
+        c += refcurvature_[*fvIt] * b[1];
+        ++fvIt;
+        c += refcurvature_[*fvIt] * b[2];
+        vcurvature_[v] = c;
+    }
 }
 
 //-----------------------------------------------------------------------------
 
 void SurfaceRemeshing::split_long_edges()
 {
+    PMP_PROFILE_ZONE("SurfaceRemeshing::split_long_edges");
+
     Vertex vnew, v0, v1;
-    Edge enew, e0, e1;
-    Face f0, f1, f2, f3;
-    bool ok, is_feature, is_boundary;
-    int i;
+    Edge enew;
+    bool is_feature, is_boundary;
+    std::vector<Vertex> new_vertices, split_vertices;
+
+    // the edges that may be too long, first all active ones, then the edges
+    // around the vertices inserted in the previous pass. no other edge
+    // changes its length or its sizing.
+    std::vector<Edge> candidates, long_edges;
+    std::vector<char> is_long;
+    for (auto e : mesh_.edges())
+        if (is_active(mesh_.vertex(e, 0)) || is_active(mesh_.vertex(e, 1)))
+            candidates.push_back(e);
 
-    for (ok = false, i = 0; !ok && i < 10; ++i)
+    for (int i = 0; !candidates.empty() && i < 10; ++i)
     {
-        ok = true;
-
-        for (auto e : mesh_.edges())
+        // test the candidates in parallel, keeping the order of indices
+        is_long.assign(candidates.size(), 0);
+        parallel_for(0, candidates.size(), [&](size_t j) {
+            const Edge e = candidates[j];
+            is_long[j] = !elocked_[e] &&
+                         is_too_long(mesh_.vertex(e, 0), mesh_.vertex(e, 1));
+        });
+        long_edges.clear();
+        for (size_t j = 0; j < candidates.size(); ++j)
+            if (is_long[j])
+                long_edges.push_back(candidates[j]);
+        if (long_edges.empty())
+            break;
+
+        // reserve for all edges split in this pass, such that the property
+        // arrays do not grow element by element
+        const size_t n_long = long_edges.size();
+        mesh_.reserve(mesh_.vertices_size() + n_long,
+                      mesh_.edges_size() + 3 * n_long,
+                      mesh_.faces_size() + 2 * n_long);
+
+        new_vertices.clear();
+        split_vertices.clear();
+        for (auto e : long_edges)
         {
             v0 = mesh_.vertex(e, 0);
             v1 = mesh_.vertex(e, 1);
 
-            if (!elocked_[e] && is_too_long(v0, v1))
+            const Point& p0 = points_[v0];
+            const Point& p1 = points_[v1];
+
+            is_feature = efeature_[e];
+            is_boundary = mesh_.is_boundary(e);
+
+            vnew = mesh_.add_vertex((p0 + p1) * 0.5f);
+            mesh_.split(e, vnew);
+            split_vertices.push_back(vnew);
+            set_changed(vnew);
+            for (auto vv : mesh_.vertices(vnew))
+                set_changed(vv);
+
+            // need normal or sizing for adaptive refinement
+            vnormal_[vnew] = SurfaceNormals::compute_vertex_normal(mesh_, vnew);
+            vsizing_[vnew] = 0.5f * (vsizing_[v0] + vsizing_[v1]);
+            if (vcurvature_)
+                vcurvature_[vnew] = 0.5f * (vcurvature_[v0] + vcurvature_[v1]);
+
+            if (is_feature)
             {
-                const Point& p0 = points_[v0];
-                const Point& p1 = points_[v1];
+                enew = is_boundary ? Edge(mesh_.n_edges() - 2)
+                                   : Edge(mesh_.n_edges() - 3);
+                efeature_[enew] = true;
+                vfeature_[vnew] = true;
+            }
+            else
+            {
+                new_vertices.push_back(vnew);
+            }
+        }
 
-                is_feature = efeature_[e];
-                is_boundary = mesh_.is_boundary(e);
+        // the new vertices are only adjacent to edges added in this pass,
+        // hence they can be projected afterwards in one batch
+        project_to_reference(new_vertices);
 
-                vnew = mesh_.add_vertex((p0 + p1) * 0.5f);
-                mesh_.split(e, vnew);
+        // the next pass tests the edges around the new vertices
+        candidates.clear();
+        for (auto v : split_vertices)
+            for (auto h : mesh_.halfedges(v))
+                candidates.push_back(mesh_.edge(h));
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()),
+                         candidates.end());
+    }
+}
 
-                // need normal or sizing for adaptive refinement
-                vnormal_[vnew] =
-                    SurfaceNormals::compute_vertex_normal(mesh_, vnew);
-                vsizing_[vnew] = 0.5f * (vsizing_[v0] + vsizing_[v1]);
+//-----------------------------------------------------------------------------
 
-                if (is_feature)
-                {
-                    enew = is_boundary ? Edge(mesh_.n_edges() - 2)
-                                       : Edge(mesh_.n_edges() - 3);
-                    efeature_[enew] = true;
-                    vfeature_[vnew] = true;
-                }
-                else
-                {
-                    project_to_reference(vnew);
-                }
+void SurfaceRemeshing::collapse_short_edges()
+{
+    PMP_PROFILE_ZONE("SurfaceRemeshing::collapse_short_edges");
+
+    if (parallel_)
+    {
+        collapse_short_edges_parallel();
+        return;
+    }
 
-                ok = false;
+    // A collapse into v changes the neighbors, valence, and boundary status
+    // only of v and its new neighbors, hence only the edges incident to
+    // them need to be tested again. As when sweeping over all edges, an
+    // edge is tested again in this pass if its index is larger than the one
+    // of the collapsed edge, and in the next pass otherwise.
+    enum
+    {
+        Unqueued,
+        Current,
+        Next
+    };
+    std::vector<char> queued(mesh_.edges_size(), Unqueued);
+    std::priority_queue<IndexType, std::vector<IndexType>,
+                        std::greater<IndexType>>
+        current;
+    std::vector<IndexType> next;
+    for (auto e : mesh_.edges())
+    {
+        if (is_active(mesh_.vertex(e, 0)) || is_active(mesh_.vertex(e, 1)))
+        {
+            current.push(e.idx());
+            queued[e.idx()] = Current;
+        }
+    }
+
+    // queue the edges around v that are not queued yet
+    auto enqueue = [&](Vertex v, Edge collapsed) {
+        for (auto h : mesh_.halfedges(v))
+        {
+            const IndexType j = mesh_.edge(h).idx();
+            if (queued[j] != Unqueued)
+                continue;
+            if (j > collapsed.idx())
+            {
+                current.push(j);
+                queued[j] = Current;
+            }
+            else
+            {
+                next.push_back(j);
+                queued[j] = Next;
+            }
+        }
+    };
+
+    for (int i = 0; !current.empty() && i < 10; ++i)
+    {
+        while (!current.empty())
+        {
+            const Edge e(current.top());
+            current.pop();
+            queued[e.idx()] = Unqueued;
+            if (mesh_.is_deleted(e))
+                continue;
+
+            const Halfedge h = collapse_halfedge(e);
+            if (!h.is_valid())
+                continue;
+
+            const Vertex v = mesh_.to_vertex(h);
+            mesh_.collapse(h);
+            set_changed(v);
+            enqueue(v, e);
+            for (auto vv : mesh_.vertices(v))
+            {
+                set_changed(vv);
+                enqueue(vv, e);
             }
         }
+
+        for (auto j : next)
+        {
+            current.push(j);
+            queued[j] = Current;
+        }
+        next.clear();
     }
+
+    mesh_.garbage_collection();
 }
 
 //-----------------------------------------------------------------------------
 
-void SurfaceRemeshing::collapse_short_edges()
+void SurfaceRemeshing::collapse_short_edges_parallel()
+{
+    PMP_PROFILE_ZONE("SurfaceRemeshing::collapse_short_edges_parallel");
+
+    std::vector<Halfedge> candidates(mesh_.edges_size());
+    std::vector<char> locked(mesh_.vertices_size(), 0);
+    std::vector<Vertex> region;
+
+    auto is_locked = [&](Vertex v) {
+        if (locked[v.idx()])
+            return true;
+        for (auto vv : mesh_.vertices(v))
+            if (locked[vv.idx()])
+                return true;
+        return false;
+    };
+
+    auto lock = [&](Vertex v) {
+        locked[v.idx()] = 1;
+        region.push_back(v);
+        for (auto vv : mesh_.vertices(v))
+        {
+            locked[vv.idx()] = 1;
+            region.push_back(vv);
+        }
+    };
+
+    for (int i = 0; i < 100; ++i)
+    {
+        // evaluate all edges, this only reads the mesh
+        parallel_for(mesh_.edges(), [&](Edge e) {
+            candidates[e.idx()] = is_active(mesh_.vertex(e, 0)) ||
+                                          is_active(mesh_.vertex(e, 1))
+                                      ? collapse_halfedge(e)
+                                      : Halfedge();
+        });
+
+        // collapse edges whose one-rings do not overlap, such that the
+        // evaluation of the others stays valid
+        bool collapsed = false;
+        for (auto e : mesh_.edges())
+        {
+            const Halfedge h = candidates[e.idx()];
+            if (!h.is_valid() || mesh_.is_deleted(e))
+                continue;
+
+            const Vertex v0 = mesh_.from_vertex(h);
+            const Vertex v1 = mesh_.to_vertex(h);
+            if (is_locked(v0) || is_locked(v1))
+                continue;
+
+            lock(v0);
+            lock(v1);
+            mesh_.collapse(h);
+            collapsed = true;
+
+            set_changed(v1);
+            for (auto vv : mesh_.vertices(v1))
+                set_changed(vv);
+        }
+
+        for (auto v : region)
+            locked[v.idx()] = 0;
+        region.clear();
+
+        if (!collapsed)
+            break;
+    }
+
+    mesh_.garbage_collection();
+}
+
+//-----------------------------------------------------------------------------
+
+Halfedge SurfaceRemeshing::collapse_halfedge(Edge e)
 {
     Vertex v0, v1;
     Halfedge h0, h1, h01, h10;
-    bool ok, b0, b1, l0, l1, f0, f1;
-    int i;
+    bool b0, b1, l0, l1, f0, f1;
     bool hcol01, hcol10;
 
-    for (ok = false, i = 0; !ok && i < 10; ++i)
-    {
-        ok = true;
+    if (elocked_[e])
+        return Halfedge();
 
-        for (auto e : mesh_.edges())
-        {
-            if (!mesh_.is_deleted(e) && !elocked_[e])
-            {
-                h10 = mesh_.halfedge(e, 0);
-                h01 = mesh_.halfedge(e, 1);
-                v0 = mesh_.to_vertex(h10);
-                v1 = mesh_.to_vertex(h01);
+    h10 = mesh_.halfedge(e, 0);
+    h01 = mesh_.halfedge(e, 1);
+    v0 = mesh_.to_vertex(h10);
+    v1 = mesh_.to_vertex(h01);
 
-                if (is_too_short(v0, v1))
-                {
-                    // get status
-                    b0 = mesh_.is_boundary(v0);
-                    b1 = mesh_.is_boundary(v1);
-                    l0 = vlocked_[v0];
-                    l1 = vlocked_[v1];
-                    f0 = vfeature_[v0];
-                    f1 = vfeature_[v1];
-                    hcol01 = hcol10 = true;
-
-                    // boundary rules
-                    if (b0 && b1)
-                    {
-                        if (!mesh_.is_boundary(e))
-                            continue;
-                    }
-                    else if (b0)
-                        hcol01 = false;
-                    else if (b1)
-                        hcol10 = false;
-
-                    // locked rules
-                    if (l0 && l1)
-                        continue;
-                    else if (l0)
-                        hcol01 = false;
-                    else if (l1)
-                        hcol10 = false;
-
-                    // feature rules
-                    if (f0 && f1)
-                    {
-                        // edge must be feature
-                        if (!efeature_[e])
-                            continue;
-
-                        // the other two edges removed by collapse must not be features
-                        h0 = mesh_.prev_halfedge(h01);
-                        h1 = mesh_.next_halfedge(h10);
-                        if (efeature_[mesh_.edge(h0)] ||
-                            efeature_[mesh_.edge(h1)])
-                            hcol01 = false;
-                        // the other two edges removed by collapse must not be features
-                        h0 = mesh_.prev_halfedge(h10);
-                        h1 = mesh_.next_halfedge(h01);
-                        if (efeature_[mesh_.edge(h0)] ||
-                            efeature_[mesh_.edge(h1)])
-                            hcol10 = false;
-                    }
-                    else if (f0)
-                        hcol01 = false;
-                    else if (f1)
-                        hcol10 = false;
+    if (!is_too_short(v0, v1))
+        return Halfedge();
 
-                    // topological rules
-                    bool collapse_ok = mesh_.is_collapse_ok(h01);
+    // get status
+    b0 = mesh_.is_boundary(v0);
+    b1 = mesh_.is_boundary(v1);
+    l0 = vlocked_[v0];
+    l1 = vlocked_[v1];
+    f0 = vfeature_[v0];
+    f1 = vfeature_[v1];
+    hcol01 = hcol10 = true;
+
+    // boundary rules
+    if (b0 && b1)
+    {
+        if (!mesh_.is_boundary(e))
+            return Halfedge();
+    }
+    else if (b0)
+        hcol01 = false;
+    else if (b1)
+        hcol10 = false;
+
+    // locked rules
+    if (l0 && l1)
+        return Halfedge();
+    else if (l0)
+        hcol01 = false;
+    else if (l1)
+        hcol10 = false;
+
+    // feature rules
+    if (f0 && f1)
+    {
+        // edge must be feature
+        if (!efeature_[e])
+            return Halfedge();
+
+        // the other two edges removed by collapse must not be features
+        h0 = mesh_.prev_halfedge(h01);
+        h1 = mesh_.next_halfedge(h10);
+        if (efeature_[mesh_.edge(h0)] || efeature_[mesh_.edge(h1)])
+            hcol01 = false;
+        // the other two edges removed by collapse must not be features
+        h0 = mesh_.prev_halfedge(h10);
+        h1 = mesh_.next_halfedge(h01);
+        if (efeature_[mesh_.edge(h0)] || efeature_[mesh_.edge(h1)])
+            hcol10 = false;
+    }
+    else if (f0)
+        hcol01 = false;
+    else if (f1)
+        hcol10 = false;
 
-                    if (hcol01)
-                        hcol01 = collapse_ok;
-                    if (hcol10)
-                        hcol10 = collapse_ok;
+    // topological rules
+    bool collapse_ok = mesh_.is_collapse_ok(h01);
 
-                    // both collapses possible: collapse into vertex w/ higher valence
-                    if (hcol01 && hcol10)
-                    {
-                        if (mesh_.valence(v0) < mesh_.valence(v1))
-                            hcol10 = false;
-                        else
-                            hcol01 = false;
-                    }
+    if (hcol01)
+        hcol01 = collapse_ok;
+    if (hcol10)
+        hcol10 = collapse_ok;
 
-                    // try v1 -> v0
-                    if (hcol10)
-                    {
-                        // don't create too long edges
-                        for (auto vv : mesh_.vertices(v1))
-                        {
-                            if (is_too_long(v0, vv))
-                            {
-                                hcol10 = false;
-                                break;
-                            }
-                        }
+    // both collapses possible: collapse into vertex w/ higher valence
+    if (hcol01 && hcol10)
+    {
+        if (mesh_.valence(v0) < mesh_.valence(v1))
+            hcol10 = false;
+        else
+            hcol01 = false;
+    }
 
-                        if (hcol10)
-                        {
-                            mesh_.collapse(h10);
-                            ok = false;
-                        }
-                    }
+    // try v1 -> v0
+    if (hcol10)
+    {
+        // don't create too long edges
+        for (auto vv : mesh_.vertices(v1))
+        {
+            if (is_too_long(v0, vv))
+                return Halfedge();
+        }
 
-                    // try v0 -> v1
-                    else if (hcol01)
-                    {
-                        // don't create too long edges
-                        for (auto vv : mesh_.vertices(v0))
-                        {
-                            if (is_too_long(v1, vv))
-                            {
-                                hcol01 = false;
-                                break;
-                            }
-                        }
+        return h10;
+    }
 
-                        if (hcol01)
-                        {
-                            mesh_.collapse(h01);
-                            ok = false;
-                        }
-                    }
-                }
-            }
+    // try v0 -> v1
+    else if (hcol01)
+    {
+        // don't create too long edges
+        for (auto vv : mesh_.vertices(v0))
+        {
+            if (is_too_long(v1, vv))
+                return Halfedge();
         }
+
+        return h01;
     }
 
-    mesh_.garbage_collection();
+    return Halfedge();
 }
 
 //-----------------------------------------------------------------------------
 
 void SurfaceRemeshing::flip_edges()
 {
-    Vertex v0, v1, v2, v3;
-    Halfedge h;
-    int val0, val1, val2, val3;
-    int val_opt0, val_opt1, val_opt2, val_opt3;
-    int ve0, ve1, ve2, ve3, ve_before, ve_after;
-    bool ok;
-    int i;
+    PMP_PROFILE_ZONE("SurfaceRemeshing::flip_edges");
+
+    if (parallel_)
+    {
+        flip_edges_parallel();
+        return;
+    }
 
     // precompute valences
     VertexProperty<int> valence = mesh_.add_vertex_property<int>("valence");
@@ -541,75 +1103,153 @@ void SurfaceRemeshing::flip_edges()
         valence[v] = mesh_.valence(v);
     }
 
-    for (ok = false, i = 0; !ok && i < 10; ++i)
+    // A flip changes the valences and neighbors only of the four vertices
+    // of its quad, hence only the edges incident to them and the edges
+    // opposite to them in their faces need to be tested again. As for the
+    // collapses, this reproduces the order of sweeping over all edges.
+    enum
+    {
+        Unqueued,
+        Current,
+        Next
+    };
+    std::vector<char> queued(mesh_.edges_size(), Unqueued);
+    std::priority_queue<IndexType, std::vector<IndexType>,
+                        std::greater<IndexType>>
+        current;
+    std::vector<IndexType> next;
+    for (auto e : mesh_.edges())
     {
-        ok = true;
+        if (is_active(mesh_.vertex(e, 0)) || is_active(mesh_.vertex(e, 1)))
+        {
+            current.push(e.idx());
+            queued[e.idx()] = Current;
+        }
+    }
 
-        for (auto e : mesh_.edges())
+    auto enqueue_edge = [&](Edge e, Edge flipped) {
+        const IndexType j = e.idx();
+        if (queued[j] != Unqueued)
+            return;
+        if (j > flipped.idx())
+        {
+            current.push(j);
+            queued[j] = Current;
+        }
+        else
         {
-            if (!elocked_[e] && !efeature_[e])
+            next.push_back(j);
+            queued[j] = Next;
+        }
+    };
+
+    // queue the edges incident and opposite to v
+    auto enqueue = [&](Vertex v, Edge flipped) {
+        for (auto h : mesh_.halfedges(v))
+        {
+            enqueue_edge(mesh_.edge(h), flipped);
+            if (!mesh_.is_boundary(h))
+                enqueue_edge(mesh_.edge(mesh_.next_halfedge(h)), flipped);
+        }
+    };
+
+    for (int i = 0; !current.empty() && i < 10; ++i)
+    {
+        while (!current.empty())
+        {
+            const Edge e(current.top());
+            current.pop();
+            queued[e.idx()] = Unqueued;
+            if (mesh_.is_deleted(e))
+                continue;
+
+            if (is_flip_improving(e, valence) && mesh_.is_flip_ok(e))
             {
-                h = mesh_.halfedge(e, 0);
-                v0 = mesh_.to_vertex(h);
-                v2 = mesh_.to_vertex(mesh_.next_halfedge(h));
-                h = mesh_.halfedge(e, 1);
-                v1 = mesh_.to_vertex(h);
-                v3 = mesh_.to_vertex(mesh_.next_halfedge(h));
-
-                if (!vlocked_[v0] && !vlocked_[v1] && !vlocked_[v2] &&
-                    !vlocked_[v3])
+                const Halfedge h0 = mesh_.halfedge(e, 0);
+                const Halfedge h1 = mesh_.halfedge(e, 1);
+                const Vertex quad[4] = {
+                    mesh_.to_vertex(h0), mesh_.to_vertex(h1),
+                    mesh_.to_vertex(mesh_.next_halfedge(h0)),
+                    mesh_.to_vertex(mesh_.next_halfedge(h1))};
+
+                flip(e, valence);
+                for (auto v : quad)
                 {
-                    val0 = valence[v0];
-                    val1 = valence[v1];
-                    val2 = valence[v2];
-                    val3 = valence[v3];
-
-                    val_opt0 = (mesh_.is_boundary(v0) ? 4 : 6);
-                    val_opt1 = (mesh_.is_boundary(v1) ? 4 : 6);
-                    val_opt2 = (mesh_.is_boundary(v2) ? 4 : 6);
-                    val_opt3 = (mesh_.is_boundary(v3) ? 4 : 6);
-
-                    ve0 = (val0 - val_opt0);
-                    ve1 = (val1 - val_opt1);
-                    ve2 = (val2 - val_opt2);
-                    ve3 = (val3 - val_opt3);
-
-                    ve0 *= ve0;
-                    ve1 *= ve1;
-                    ve2 *= ve2;
-                    ve3 *= ve3;
-
-                    ve_before = ve0 + ve1 + ve2 + ve3;
-
-                    --val0;
-                    --val1;
-                    ++val2;
-                    ++val3;
-
-                    ve0 = (val0 - val_opt0);
-                    ve1 = (val1 - val_opt1);
-                    ve2 = (val2 - val_opt2);
-                    ve3 = (val3 - val_opt3);
-
-                    ve0 *= ve0;
-                    ve1 *= ve1;
-                    ve2 *= ve2;
-                    ve3 *= ve3;
-
-                    ve_after = ve0 + ve1 + ve2 + ve3;
-
-                    if (ve_before > ve_after && mesh_.is_flip_ok(e))
-                    {
-                        mesh_.flip(e);
-                        --valence[v0];
-                        --valence[v1];
-                        ++valence[v2];
-                        ++valence[v3];
-                        ok = false;
-                    }
+                    set_changed(v);
+                    enqueue(v, e);
                 }
             }
         }
+
+        for (auto j : next)
+        {
+            current.push(j);
+            queued[j] = Current;
+        }
+        next.clear();
+    }
+
+    mesh_.remove_vertex_property(valence);
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceRemeshing::flip_edges_parallel()
+{
+    PMP_PROFILE_ZONE("SurfaceRemeshing::flip_edges_parallel");
+
+    std::vector<char> candidates(mesh_.edges_size(), 0);
+    std::vector<char> locked(mesh_.vertices_size(), 0);
+    std::vector<Edge> flips;
+
+    // precompute valences
+    VertexProperty<int> valence = mesh_.add_vertex_property<int>("valence");
+    parallel_for(mesh_.vertices(),
+                 [&](Vertex v) { valence[v] = mesh_.valence(v); });
+
+    for (int i = 0; i < 10; ++i)
+    {
+        // evaluate all edges, this only reads the mesh
+        parallel_for(mesh_.edges(), [&](Edge e) {
+            candidates[e.idx()] =
+                (is_active(mesh_.vertex(e, 0)) ||
+                 is_active(mesh_.vertex(e, 1))) &&
+                is_flip_improving(e, valence) && mesh_.is_flip_ok(e);
+        });
+
+        // select flips whose quads do not share vertices
+        flips.clear();
+        for (auto e : mesh_.edges())
+        {
+            if (!candidates[e.idx()])
+                continue;
+
+            const Halfedge h0 = mesh_.halfedge(e, 0);
+            const Halfedge h1 = mesh_.halfedge(e, 1);
+            const Vertex quad[4] = {mesh_.to_vertex(h0), mesh_.to_vertex(h1),
+                                    mesh_.to_vertex(mesh_.next_halfedge(h0)),
+                                    mesh_.to_vertex(mesh_.next_halfedge(h1))};
+            if (locked[quad[0].idx()] || locked[quad[1].idx()] ||
+                locked[quad[2].idx()] || locked[quad[3].idx()])
+                continue;
+
+            for (auto v : quad)
+            {
+                locked[v.idx()] = 1;
+                set_changed(v);
+            }
+            flips.push_back(e);
+        }
+
+        if (flips.empty())
+            break;
+
+        // the flips are cheap compared to their evaluation, and applying
+        // them in order keeps the mesh and its journal consistent
+        for (auto e : flips)
+            flip(e, valence);
+
+        std::fill(locked.begin(), locked.end(), 0);
     }
 
     mesh_.remove_vertex_property(valence);
@@ -617,140 +1257,217 @@ void SurfaceRemeshing::flip_edges()
 
 //-----------------------------------------------------------------------------
 
+bool SurfaceRemeshing::is_flip_improving(
+    Edge e, const VertexProperty<int>& valence) const
+{
+    if (elocked_[e] || efeature_[e])
+        return false;
+
+    Halfedge h = mesh_.halfedge(e, 0);
+    const Vertex v0 = mesh_.to_vertex(h);
+    const Vertex v2 = mesh_.to_vertex(mesh_.next_halfedge(h));
+    h = mesh_.halfedge(e, 1);
+    const Vertex v1 = mesh_.to_vertex(h);
+    const Vertex v3 = mesh_.to_vertex(mesh_.next_halfedge(h));
+
+    if (vlocked_[v0] || vlocked_[v1] || vlocked_[v2] || vlocked_[v3])
+        return false;
+
+    int val0 = valence[v0];
+    int val1 = valence[v1];
+    int val2 = valence[v2];
+    int val3 = valence[v3];
+
+    const int val_opt0 = (mesh_.is_boundary(v0) ? 4 : 6);
+    const int val_opt1 = (mesh_.is_boundary(v1) ? 4 : 6);
+    const int val_opt2 = (mesh_.is_boundary(v2) ? 4 : 6);
+    const int val_opt3 = (mesh_.is_boundary(v3) ? 4 : 6);
+
+    int ve0 = (val0 - val_opt0);
+    int ve1 = (val1 - val_opt1);
+    int ve2 = (val2 - val_opt2);
+    int ve3 = (val3 - val_opt3);
+
+    ve0 *= ve0;
+    ve1 *= ve1;
+    ve2 *= ve2;
+    ve3 *= ve3;
+
+    const int ve_before = ve0 + ve1 + ve2 + ve3;
+
+    --val0;
+    --val1;
+    ++val2;
+    ++val3;
+
+    ve0 = (val0 - val_opt0);
+    ve1 = (val1 - val_opt1);
+    ve2 = (val2 - val_opt2);
+    ve3 = (val3 - val_opt3);
+
+    ve0 *= ve0;
+    ve1 *= ve1;
+    ve2 *= ve2;
+    ve3 *= ve3;
+
+    const int ve_after = ve0 + ve1 + ve2 + ve3;
+
+    return ve_before > ve_after;
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceRemeshing::flip(Edge e, VertexProperty<int>& valence)
+{
+    Halfedge h = mesh_.halfedge(e, 0);
+    --valence[mesh_.to_vertex(h)];
+    ++valence[mesh_.to_vertex(mesh_.next_halfedge(h))];
+    h = mesh_.halfedge(e, 1);
+    --valence[mesh_.to_vertex(h)];
+    ++valence[mesh_.to_vertex(mesh_.next_halfedge(h))];
+
+    mesh_.flip(e);
+}
+
+//-----------------------------------------------------------------------------
+
 void SurfaceRemeshing::tangential_smoothing(unsigned int iterations)
 {
-    Vertex v1, v2, v3, vv;
-    Edge e;
-    Scalar w, ww, area;
-    Point u, n, t, b;
+    PMP_PROFILE_ZONE("SurfaceRemeshing::tangential_smoothing");
 
     // add property
     VertexProperty<Point> update = mesh_.add_vertex_property<Point>("v:update");
 
+    // the vertices to be smoothed and projected
+    std::vector<Vertex> interior;
+    for (auto v : mesh_.vertices())
+    {
+        if (!mesh_.is_boundary(v) && !vlocked_[v] && is_active(v))
+        {
+            interior.push_back(v);
+        }
+    }
+
     // project at the beginning to get valid sizing values and normal vectors
     // for vertices introduced by splitting
     if (use_projection_)
     {
-        for (auto v : mesh_.vertices())
-        {
-            if (!mesh_.is_boundary(v) && !vlocked_[v])
-            {
-                project_to_reference(v);
-            }
-        }
+        project_to_reference(interior);
     }
 
     for (unsigned int iters = 0; iters < iterations; ++iters)
     {
-        for (auto v : mesh_.vertices())
-        {
-            if (!mesh_.is_boundary(v) && !vlocked_[v])
+        parallel_for(size_t(0), interior.size(), [&](size_t j) {
+            const Vertex v = interior[j];
+            Vertex v1, v2, v3, vv;
+            Scalar w, ww, area;
+            Point u, n, t, b;
+
+            if (vfeature_[v])
             {
-                if (vfeature_[v])
-                {
-                    u = Point(0.0);
-                    t = Point(0.0);
-                    ww = 0;
-                    int c = 0;
+                u = Point(0.0);
+                t = Point(0.0);
+                ww = 0;
+                int c = 0;
 
-                    for (auto h : mesh_.halfedges(v))
+                for (auto h : mesh_.halfedges(v))
+                {
+                    if (efeature_[mesh_.edge(h)])
                     {
-                        if (efeature_[mesh_.edge(h)])
-                        {
-                            vv = mesh_.to_vertex(h);
-
-                            b = points_[v];
-                            b += points_[vv];
-                            b *= 0.5;
-
-                            w = distance(points_[v], points_[vv]) /
-                                (0.5 * (vsizing_[v] + vsizing_[vv]));
-                            ww += w;
-                            u += w * b;
-
-                            if (c == 0)
-                            {
-                                t += normalize(points_[vv] - points_[v]);
-                                ++c;
-                            }
-                            else
-                            {
-                                ++c;
-                                t -= normalize(points_[vv] - points_[v]);
-                            }
-                        }
-                    }
+                        vv = mesh_.to_vertex(h);
 
-                    assert(c == 2);
+                        b = points_[v];
+                        b += points_[vv];
+                        b *= 0.5;
 
-                    u *= (1.0 / ww);
-                    u -= points_[v];
-                    t = normalize(t);
-                    u = t * dot(u, t);
+                        w = distance(points_[v], points_[vv]) /
+                            (0.5 * (vsizing_[v] + vsizing_[vv]));
+                        ww += w;
+                        u += w * b;
 
-                    update[v] = u;
+                        if (c == 0)
+                        {
+                            t += normalize(points_[vv] - points_[v]);
+                            ++c;
+                        }
+                        else
+                        {
+                            ++c;
+                            t -= normalize(points_[vv] - points_[v]);
+                        }
+                    }
                 }
-                else
-                {
-                    u = Point(0.0);
-                    t = Point(0.0);
-                    ww = 0;
 
-                    for (auto h : mesh_.halfedges(v))
-                    {
-                        v1 = v;
-                        v2 = mesh_.to_vertex(h);
-                        v3 = mesh_.to_vertex(mesh_.next_halfedge(h));
-
-                        b = points_[v1];
-                        b += points_[v2];
-                        b += points_[v3];
-                        b *= (1.0 / 3.0);
-
-                        area = norm(cross(points_[v2] - points_[v1],
-                                          points_[v3] - points_[v1]));
-                        w = area /
-                            pow((vsizing_[v1] + vsizing_[v2] + vsizing_[v3]) /
-                                    3.0,
-                                2.0);
+                assert(c == 2);
 
-                        u += w * b;
-                        ww += w;
-                    }
+                u *= (1.0 / ww);
+                u -= points_[v];
+                t = normalize(t);
+                u = t * dot(u, t);
 
-                    u /= ww;
-                    u -= points_[v];
-                    n = vnormal_[v];
-                    u -= n * dot(u, n);
+                update[v] = u;
+            }
+            else
+            {
+                u = Point(0.0);
+                t = Point(0.0);
+                ww = 0;
 
-                    update[v] = u;
+                for (auto h : mesh_.halfedges(v))
+                {
+                    v1 = v;
+                    v2 = mesh_.to_vertex(h);
+                    v3 = mesh_.to_vertex(mesh_.next_halfedge(h));
+
+                    b = points_[v1];
+                    b += points_[v2];
+                    b += points_[v3];
+                    b *= (1.0 / 3.0);
+
+                    area = norm(cross(points_[v2] - points_[v1],
+                                      points_[v3] - points_[v1]));
+                    w = area /
+                        pow((vsizing_[v1] + vsizing_[v2] + vsizing_[v3]) /
+                                3.0,
+                            2.0);
+
+                    u += w * b;
+                    ww += w;
                 }
+
+                u /= ww;
+                u -= points_[v];
+                n = vnormal_[v];
+                u -= n * dot(u, n);
+
+                update[v] = u;
             }
-        }
+        });
 
         // update vertex positions
-        for (auto v : mesh_.vertices())
+        parallel_for(size_t(0), interior.size(), [&](size_t j) {
+            points_[interior[j]] += update[interior[j]];
+        });
+
+        // update normal vectors (if not done so through projection), only
+        // the smoothed vertices need them when restricted to the active set
+        if (vactive_)
         {
-            if (!mesh_.is_boundary(v) && !vlocked_[v])
-            {
-                points_[v] += update[v];
-            }
+            parallel_for(size_t(0), interior.size(), [&](size_t j) {
+                vnormal_[interior[j]] =
+                    SurfaceNormals::compute_vertex_normal(mesh_, interior[j]);
+            });
+        }
+        else
+        {
+            SurfaceNormals::compute_vertex_normals(mesh_);
         }
-
-        // update normal vectors (if not done so through projection)
-        SurfaceNormals::compute_vertex_normals(mesh_);
     }
 
     // project at the end
     if (use_projection_)
     {
-        for (auto v : mesh_.vertices())
-        {
-            if (!mesh_.is_boundary(v) && !vlocked_[v])
-            {
-                project_to_reference(v);
-            }
-        }
+        project_to_reference(interior);
     }
 
     // remove property
@@ -761,6 +1478,8 @@ void SurfaceRemeshing::tangential_smoothing(unsigned int iterations)
 
 void SurfaceRemeshing::remove_caps()
 {
+    PMP_PROFILE_ZONE("SurfaceRemeshing::remove_caps");
+
     Halfedge h;
     Vertex v, vb, vd;
     Face fb, fd;
@@ -12,6 +12,10 @@
 #include <pmp/SurfaceMesh.h>
 #include <pmp/algorithms/TriangleKdTree.h>
 
+#include <functional>
+#include <string>
+#include <vector>
+
 //=============================================================================
 
 namespace pmp {
@@ -46,17 +50,104 @@ public:
                             Scalar approx_error, unsigned int iterations = 10,
                             bool use_projection = true);
 
+    //! \brief Perform the collapse and flip phases in parallel.
+    //! \details Each pass evaluates all edges concurrently and then applies
+    //! a subset of the collapses or flips whose neighborhoods do not
+    //! overlap, one after the other. The result therefore differs from the
+    //! serial default. Smoothing and projection run in parallel in either
+    //! mode.
+    void set_parallel(bool parallel) { parallel_ = parallel; }
+
+    //! \brief Restrict the next remeshing to the region of interest \p faces.
+    //! \details The faces and \p padding rings of faces around them are copied
+    //! into a separate mesh. It is remeshed with the vertices outside of the
+    //! region being locked and then stitched back. The reference mesh and
+    //! kd-tree are only built for the copy, such that the cost scales with
+    //! the size of the region. The padding provides context for projection
+    //! and curvature estimation. Replaced elements are only marked deleted,
+    //! call SurfaceMesh::garbage_collection() when done. The region is reset
+    //! after remeshing.
+    void set_region(const std::vector<Face>& faces, unsigned int padding = 2);
+
+    //! restrict the next remeshing to the faces incident to \p vertices
+    void set_region(const std::vector<Vertex>& vertices,
+                    unsigned int padding = 2);
+
+    //! \brief Keep the curvature estimated by adaptive_remeshing().
+    //! \details The result then stores it in the vertex property
+    //! "v:max_curvature", interpolated from the input mesh. Adaptive
+    //! remeshing reuses this property whenever it is present, e.g., to remesh
+    //! the same model at a different tolerance, instead of estimating the
+    //! curvature again.
+    void set_keep_curvature(bool keep) { keep_curvature_ = keep; }
+
+    //! \brief Only revisit the parts of the mesh that still change.
+    //! \details After the first iteration, each iteration only processes
+    //! the vertices whose neighborhood was changed by a split, collapse, or
+    //! flip of the previous iteration, or that moved by more than
+    //! \p threshold times their target edge length, and their neighbors.
+    //! The remeshing stops early once no vertex is left, so the result
+    //! differs slightly from processing all vertices. A threshold of zero,
+    //! the default, processes all vertices in all iterations.
+    void set_convergence_threshold(Scalar threshold)
+    {
+        convergence_threshold_ = threshold;
+    }
+
+    //! \brief Reuse the kd-tree of the reference mesh stored in \p filename.
+    //! \details Remeshing with projection loads the tree from the file if it
+    //! was written for the same mesh, and otherwise builds and writes it, see
+    //! TriangleKdTree. Jobs remeshing the same input then skip building it.
+    //! An empty name, the default, disables the cache.
+    void set_tree_cache(const std::string& filename)
+    {
+        tree_cache_ = filename;
+    }
+
 private:
+    // remesh a copy of the region of interest by \p remesh and stitch it back
+    void remesh_region(const std::function<void(SurfaceRemeshing&)>& remesh);
+
     void preprocessing();
     void postprocessing();
 
     void split_long_edges();
     void collapse_short_edges();
+    void collapse_short_edges_parallel();
     void flip_edges();
+    void flip_edges_parallel();
     void tangential_smoothing(unsigned int iterations);
     void remove_caps();
 
-    void project_to_reference(Vertex v);
+    // is \p v processed in the current iteration?
+    bool is_active(Vertex v) const { return !vactive_ || vactive_[v]; }
+
+    // mark \p v as changed, to be processed again in the next iteration
+    void set_changed(Vertex v)
+    {
+        if (vchanged_)
+        {
+            vchanged_[v] = true;
+            vactive_[v] = true;
+        }
+    }
+
+    // select the vertices of the next iteration, false if there are none
+    bool update_active_set();
+
+    // project vertices to the reference mesh, interpolate normals and sizing
+    void project_to_reference(const std::vector<Vertex>& vertices);
+    void project_to_reference(Vertex v,
+                              const TriangleKdTree::NearestNeighbor& nn);
+
+    // the halfedge to collapse for a too short edge, invalid if none
+    Halfedge collapse_halfedge(Edge e);
+
+    // does flipping \p e reduce the valence deviation?
+    bool is_flip_improving(Edge e, const VertexProperty<int>& valence) const;
+
+    // flip \p e and update the valences of its quad
+    void flip(Edge e, VertexProperty<int>& valence);
 
     bool is_too_long(Vertex v0, Vertex v1) const
     {
@@ -76,6 +167,17 @@ private:
     bool use_projection_;
     TriangleKdTree* kd_tree_;
 
+    bool parallel_;
+
+    std::vector<Face> region_;
+    unsigned int padding_;
+
+    bool keep_curvature_;
+
+    Scalar convergence_threshold_;
+
+    std::string tree_cache_;
+
     bool uniform_;
     Scalar target_edge_length_;
     Scalar min_edge_length_;
@@ -86,13 +188,20 @@ private:
     VertexProperty<Point> vnormal_;
     VertexProperty<bool> vfeature_;
     EdgeProperty<bool> efeature_;
-    VertexProperty<bool> vlocked_;
-    EdgeProperty<bool> elocked_;
+    VertexProperty<Flag> vlocked_;
+    EdgeProperty<Flag> elocked_;
     VertexProperty<Scalar> vsizing_;
+    VertexProperty<Scalar> vcurvature_;
+
+    // the active set, invalid if all vertices are processed
+    VertexProperty<Flag> vactive_;
+    VertexProperty<Flag> vchanged_;
+    VertexProperty<Point> vprevious_;
 
     VertexProperty<Point> refpoints_;
     VertexProperty<Point> refnormals_;
     VertexProperty<Scalar> refsizing_;
+    VertexProperty<Scalar> refcurvature_;
 };
 
 //=============================================================================
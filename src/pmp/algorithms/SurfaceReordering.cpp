@@ -0,0 +1,364 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/algorithms/SurfaceReordering.h>
+#include <pmp/algorithms/DifferentialGeometry.h>
+#include <pmp/Parallel.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+namespace {
+
+// spread the lower 21 bits of x such that there are two zero bits between
+// each pair of consecutive bits
+uint64_t spread_bits(uint64_t x)
+{
+    x &= 0x1fffff;
+    x = (x | x << 32) & 0x1f00000000ffff;
+    x = (x | x << 16) & 0x1f0000ff0000ff;
+    x = (x | x << 8) & 0x100f00f00f00f00f;
+    x = (x | x << 4) & 0x10c30c30c30c30c3;
+    x = (x | x << 2) & 0x1249249249249249;
+    return x;
+}
+
+// largest quantized coordinate
+const uint64_t max_cell = (uint64_t(1) << 21) - 1;
+
+// computes 63-bit Morton codes of points within a bounding box
+class MortonCode
+{
+public:
+    MortonCode(BoundingBox bb) : min_(bb.min())
+    {
+        const Point d = bb.max() - bb.min();
+        const Scalar extent = std::max(d[0], std::max(d[1], d[2]));
+        scale_ = extent > 0 ? Scalar(max_cell) / extent : Scalar(0);
+    }
+
+    uint64_t operator()(const Point& p) const
+    {
+        return spread_bits(quantize(p[0] - min_[0])) |
+               spread_bits(quantize(p[1] - min_[1])) << 1 |
+               spread_bits(quantize(p[2] - min_[2])) << 2;
+    }
+
+private:
+    uint64_t quantize(Scalar x) const
+    {
+        const Scalar c = std::max(Scalar(0), x * scale_);
+        return std::min(static_cast<uint64_t>(c), max_cell);
+    }
+
+    Point min_;
+    Scalar scale_;
+};
+
+// sort elements by their code, ties are broken by the original index
+template <class HandleType>
+std::vector<HandleType> sorted_order(const std::vector<uint64_t>& codes)
+{
+    const size_t n = codes.size();
+    std::vector<std::pair<uint64_t, IndexType>> keys(n);
+    for (size_t i = 0; i < n; ++i)
+        keys[i] = std::make_pair(codes[i], IndexType(i));
+    std::sort(keys.begin(), keys.end());
+
+    std::vector<HandleType> order(n);
+    for (size_t i = 0; i < n; ++i)
+        order[i] = HandleType(keys[i].second);
+    return order;
+}
+
+} // namespace
+
+//=============================================================================
+
+void SurfaceReordering::morton_order(SurfaceMesh& mesh)
+{
+    mesh.garbage_collection();
+
+    if (mesh.is_empty())
+        return;
+
+    const MortonCode morton(mesh.bounds());
+    std::vector<uint64_t> codes;
+
+    // vertices
+    codes.resize(mesh.vertices_size());
+    parallel_for(mesh.vertices(),
+                 [&](Vertex v) { codes[v.idx()] = morton(mesh.position(v)); });
+    mesh.permute_vertices(sorted_order<Vertex>(codes));
+
+    // edges
+    codes.resize(mesh.edges_size());
+    parallel_for(mesh.edges(), [&](Edge e) {
+        const Point p = 0.5 * (mesh.position(mesh.vertex(e, 0)) +
+                               mesh.position(mesh.vertex(e, 1)));
+        codes[e.idx()] = morton(p);
+    });
+    mesh.permute_edges(sorted_order<Edge>(codes));
+
+    // faces
+    codes.resize(mesh.faces_size());
+    parallel_for(mesh.faces(),
+                 [&](Face f) { codes[f.idx()] = morton(centroid(mesh, f)); });
+    mesh.permute_faces(sorted_order<Face>(codes));
+}
+
+//-----------------------------------------------------------------------------
+
+SurfaceReordering::CacheMissRatios SurfaceReordering::vertex_cache_order(
+    SurfaceMesh& mesh, unsigned int cache_size, bool reduce_overdraw)
+{
+    mesh.garbage_collection();
+
+    CacheMissRatios ratios;
+    ratios.before = average_cache_miss_ratio(mesh, cache_size);
+    if (mesh.n_faces() == 0)
+    {
+        ratios.after = ratios.before;
+        return ratios;
+    }
+
+    mesh.permute_faces(
+        vertex_cache_face_order(mesh, cache_size, reduce_overdraw));
+
+    // vertices and edges by their first use, unused ones last
+    std::vector<Vertex> vorder;
+    std::vector<Edge> eorder;
+    std::vector<bool> vused(mesh.vertices_size(), false);
+    std::vector<bool> eused(mesh.edges_size(), false);
+    for (auto f : mesh.faces())
+    {
+        for (auto h : mesh.halfedges(f))
+        {
+            const Vertex v = mesh.to_vertex(h);
+            if (!vused[v.idx()])
+            {
+                vused[v.idx()] = true;
+                vorder.push_back(v);
+            }
+            const Edge e = mesh.edge(h);
+            if (!eused[e.idx()])
+            {
+                eused[e.idx()] = true;
+                eorder.push_back(e);
+            }
+        }
+    }
+    for (auto v : mesh.vertices())
+        if (!vused[v.idx()])
+            vorder.push_back(v);
+    for (auto e : mesh.edges())
+        if (!eused[e.idx()])
+            eorder.push_back(e);
+    mesh.permute_vertices(vorder);
+    mesh.permute_edges(eorder);
+
+    ratios.after = average_cache_miss_ratio(mesh, cache_size);
+    return ratios;
+}
+
+//-----------------------------------------------------------------------------
+
+std::vector<Face> SurfaceReordering::vertex_cache_face_order(
+    const SurfaceMesh& mesh, unsigned int cache_size, bool reduce_overdraw)
+{
+    const int k = int(cache_size);
+
+    // the number of faces left around each vertex
+    std::vector<int> live(mesh.vertices_size(), 0);
+    for (auto f : mesh.faces())
+        for (auto v : mesh.vertices(f))
+            ++live[v.idx()];
+
+    std::vector<int> cache_time(mesh.vertices_size(), 0);
+    std::vector<bool> emitted(mesh.faces_size(), false);
+    std::vector<Vertex> dead_end, candidates;
+    std::vector<Face> order;
+    std::vector<size_t> clusters; // where the clusters begin
+    order.reserve(mesh.n_faces());
+    int time = k + 1;
+    auto cursor = mesh.vertices_begin();
+
+    // a vertex with faces left, in the order it was last used
+    auto skip_dead_end = [&]() -> Vertex {
+        while (!dead_end.empty())
+        {
+            const Vertex v = dead_end.back();
+            dead_end.pop_back();
+            if (live[v.idx()] > 0)
+                return v;
+        }
+        for (; cursor != mesh.vertices_end(); ++cursor)
+            if (live[(*cursor).idx()] > 0)
+                return *cursor;
+        return Vertex();
+    };
+
+    Vertex fan = skip_dead_end();
+    clusters.push_back(0);
+    while (fan.is_valid())
+    {
+        // emit the faces around the fanning vertex
+        candidates.clear();
+        for (auto f : mesh.faces(fan))
+        {
+            if (emitted[f.idx()])
+                continue;
+            emitted[f.idx()] = true;
+            order.push_back(f);
+            for (auto v : mesh.vertices(f))
+            {
+                dead_end.push_back(v);
+                candidates.push_back(v);
+                --live[v.idx()];
+                if (time - cache_time[v.idx()] > k)
+                    cache_time[v.idx()] = time++;
+            }
+        }
+
+        // the next fan is the oldest vertex whose fan stays in the cache
+        Vertex next;
+        int best = -1;
+        for (auto v : candidates)
+        {
+            if (live[v.idx()] <= 0)
+                continue;
+            int priority = 0;
+            if (time - cache_time[v.idx()] + 2 * live[v.idx()] <= k)
+                priority = time - cache_time[v.idx()];
+            if (priority > best)
+            {
+                best = priority;
+                next = v;
+            }
+        }
+        if (!next.is_valid())
+        {
+            next = skip_dead_end();
+            clusters.push_back(order.size());
+        }
+        fan = next;
+    }
+
+    if (!reduce_overdraw)
+        return order;
+
+    // draw the clusters facing away from the center first
+    clusters.back() = order.size();
+    const size_t n_clusters = clusters.size() - 1;
+    Point center(0, 0, 0);
+    Scalar area = 0;
+    std::vector<Point> centers(n_clusters, Point(0, 0, 0));
+    std::vector<Normal> normals(n_clusters, Normal(0, 0, 0));
+    std::vector<Scalar> areas(n_clusters, 0);
+    for (size_t c = 0; c < n_clusters; ++c)
+    {
+        for (size_t i = clusters[c]; i < clusters[c + 1]; ++i)
+        {
+            const Face f = order[i];
+            Normal n(0, 0, 0);
+            auto h = mesh.halfedge(f);
+            const Point& p0 = mesh.position(mesh.to_vertex(h));
+            for (h = mesh.next_halfedge(h);
+                 mesh.next_halfedge(h) != mesh.halfedge(f);
+                 h = mesh.next_halfedge(h))
+            {
+                n += cross(mesh.position(mesh.to_vertex(h)) - p0,
+                           mesh.position(mesh.to_vertex(
+                               mesh.next_halfedge(h))) - p0);
+            }
+            const Scalar a = norm(n);
+            const Point p = centroid(mesh, f);
+            centers[c] += a * p;
+            normals[c] += n;
+            areas[c] += a;
+            center += a * p;
+            area += a;
+        }
+    }
+    if (area > 0)
+        center /= area;
+
+    std::vector<std::pair<Scalar, size_t>> occlusion(n_clusters);
+    for (size_t c = 0; c < n_clusters; ++c)
+    {
+        const Scalar n = norm(normals[c]);
+        Scalar key = 0;
+        if (n > 0 && areas[c] > 0)
+            key = dot(centers[c] / areas[c] - center, normals[c] / n);
+        occlusion[c] = std::make_pair(-key, c);
+    }
+    std::stable_sort(occlusion.begin(), occlusion.end());
+
+    std::vector<Face> sorted;
+    sorted.reserve(order.size());
+    for (const auto& o : occlusion)
+        sorted.insert(sorted.end(), order.begin() + clusters[o.second],
+                      order.begin() + clusters[o.second + 1]);
+    return sorted;
+}
+
+//-----------------------------------------------------------------------------
+
+double SurfaceReordering::average_cache_miss_ratio(
+    const SurfaceMesh& mesh, unsigned int cache_size,
+    const std::vector<Face>& faces)
+{
+    // a FIFO cache, stamped with the number of misses at insertion
+    std::vector<size_t> inserted(mesh.vertices_size(), 0);
+    size_t misses = 0, triangles = 0;
+    auto use = [&](Vertex v) {
+        const size_t t = inserted[v.idx()];
+        if (t == 0 || misses - t >= cache_size)
+            inserted[v.idx()] = ++misses;
+    };
+
+    std::vector<Vertex> corners;
+    auto process = [&](Face f) {
+        corners.clear();
+        for (auto v : mesh.vertices(f))
+            corners.push_back(v);
+        for (size_t i = 2; i < corners.size(); ++i)
+        {
+            use(corners[0]);
+            use(corners[i - 1]);
+            use(corners[i]);
+            ++triangles;
+        }
+    };
+    if (faces.empty())
+    {
+        for (auto f : mesh.faces())
+            process(f);
+    }
+    else
+    {
+        for (auto f : faces)
+            process(f);
+    }
+
+    return triangles ? double(misses) / triangles : 0.0;
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
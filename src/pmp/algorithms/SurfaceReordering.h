@@ -0,0 +1,91 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <pmp/SurfaceMesh.h>
+
+#include <vector>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \addtogroup algorithms algorithms
+//! @{
+
+//=============================================================================
+
+//! \brief Reorder mesh elements for better memory locality.
+//! \details Meshes read from files keep the element order of the file, such
+//! that neighboring elements may be scattered in memory. The functions of
+//! this class sort the elements along a space-filling curve, which improves
+//! cache efficiency of subsequent traversals. All properties are permuted
+//! along with the elements, see SurfaceMesh::permute_vertices().
+//! Deleted elements are removed by a garbage_collection() first. All element
+//! handles held outside the mesh are invalidated.
+class SurfaceReordering
+{
+public:
+    // delete default and copy constructor
+    SurfaceReordering() = delete;
+    SurfaceReordering(const SurfaceReordering&) = delete;
+
+    //! \brief Sort vertices, edges, and faces along a Morton (z-order) curve.
+    //! \details Vertices are sorted by the Morton code of their position,
+    //! faces by the code of their centroid, and edges by the code of their
+    //! midpoint.
+    static void morton_order(SurfaceMesh& mesh);
+
+    //! the average cache miss ratios before and after vertex_cache_order()
+    struct CacheMissRatios
+    {
+        double before; //!< the ratio of the original face order
+        double after;  //!< the ratio of the new face order
+    };
+
+    //! \brief Sort the faces for the post-transform vertex cache of GPUs.
+    //! \details Orders the faces by vertex_cache_face_order(), then the
+    //! vertices and edges by their first use in this order, such that
+    //! vertex fetches are sequential as well. Meant for meshes exported to
+    //! real-time renderers.
+    static CacheMissRatios vertex_cache_order(SurfaceMesh& mesh,
+                                              unsigned int cache_size = 16,
+                                              bool reduce_overdraw = false);
+
+    //! \brief Compute a face order for a vertex cache of \p cache_size
+    //! entries.
+    //! \details Uses Tipsify \cite sander_2007_fast : the faces around a
+    //! vertex are emitted as a fan, and the next fan is centered at a vertex
+    //! still in the cache that has faces left. With \p reduce_overdraw, the
+    //! order is split into clusters where no such vertex is left, and the
+    //! clusters facing outward are drawn first, such that they occlude the
+    //! others. Runs in linear time. Deleted faces are skipped.
+    static std::vector<Face> vertex_cache_face_order(
+        const SurfaceMesh& mesh, unsigned int cache_size = 16,
+        bool reduce_overdraw = false);
+
+    //! \brief The average cache miss ratio (ACMR) of the faces of \p mesh in
+    //! the order of \p faces, or of SurfaceMesh::faces() if it is empty.
+    //! \details The number of vertices transformed per triangle with a FIFO
+    //! cache of \p cache_size entries. Polygons count as fans of triangles.
+    //! The ratio is at least 0.5 for large closed triangle meshes and at most
+    //! 3.
+    static double average_cache_miss_ratio(
+        const SurfaceMesh& mesh, unsigned int cache_size = 16,
+        const std::vector<Face>& faces = std::vector<Face>());
+};
+
+//=============================================================================
+//! @}
+//=============================================================================
+} // namespace pmp
+//=============================================================================
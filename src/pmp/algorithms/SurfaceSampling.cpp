@@ -0,0 +1,308 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/algorithms/SurfaceSampling.h>
+#include <pmp/algorithms/DifferentialGeometry.h>
+#include <pmp/BoundingBox.h>
+#include <pmp/Parallel.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+namespace {
+
+// faces and samples are processed in blocks of this size, independently of
+// the number of threads
+const size_t block_size = 4096;
+
+// the triangles of a mesh and the prefix sums of their areas
+struct AreaDistribution
+{
+    std::vector<Face> faces;
+    std::vector<double> cdf;
+
+    double total() const { return cdf.empty() ? 0.0 : cdf.back(); }
+};
+
+// the corners of triangle f
+void corners(const SurfaceMesh& mesh, Face f, Point& p0, Point& p1,
+             Point& p2)
+{
+    auto vfit = mesh.vertices(f);
+    p0 = mesh.position(*vfit);
+    p1 = mesh.position(*(++vfit));
+    p2 = mesh.position(*(++vfit));
+}
+
+void area_distribution(const SurfaceMesh& mesh, AreaDistribution& areas)
+{
+    areas.faces.clear();
+    areas.faces.reserve(mesh.n_faces());
+    for (auto f : mesh.faces())
+        areas.faces.push_back(f);
+
+    const size_t n = areas.faces.size();
+    areas.cdf.resize(n);
+    parallel_for(size_t(0), n, [&](size_t i) {
+        Point p0, p1, p2;
+        corners(mesh, areas.faces[i], p0, p1, p2);
+        areas.cdf[i] = triangle_area(p0, p1, p2);
+    });
+
+    // prefix sums within the blocks, then of the blocks
+    const size_t n_blocks = (n + block_size - 1) / block_size;
+    std::vector<double> offsets(n_blocks + 1, 0.0);
+    parallel_for(size_t(0), n_blocks, [&](size_t b) {
+        const size_t end = std::min(n, (b + 1) * block_size);
+        double sum = 0;
+        for (size_t i = b * block_size; i < end; ++i)
+            areas.cdf[i] = (sum += areas.cdf[i]);
+        offsets[b + 1] = sum;
+    });
+    for (size_t b = 0; b < n_blocks; ++b)
+        offsets[b + 1] += offsets[b];
+    parallel_for(size_t(1), n_blocks, [&](size_t b) {
+        const size_t end = std::min(n, (b + 1) * block_size);
+        for (size_t i = b * block_size; i < end; ++i)
+            areas.cdf[i] += offsets[b];
+    });
+}
+
+// n stratified samples of the area distribution
+void sample(const SurfaceMesh& mesh, const AreaDistribution& areas, size_t n,
+            unsigned int seed, SurfaceSamples& samples)
+{
+    samples.points.resize(n);
+    samples.normals.resize(n);
+    samples.faces.resize(n);
+    if (areas.faces.empty())
+        n = 0;
+
+    const double total = areas.total();
+    const size_t n_blocks = (n + block_size - 1) / block_size;
+    parallel_for(size_t(0), n_blocks, [&](size_t b) {
+        std::seed_seq seq{seed, static_cast<unsigned int>(b),
+                          static_cast<unsigned int>(uint64_t(b) >> 32)};
+        std::mt19937 generator(seq);
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+        // the strata increase within a block
+        auto face = areas.cdf.begin();
+        const size_t end = std::min(n, (b + 1) * block_size);
+        for (size_t i = b * block_size; i < end; ++i)
+        {
+            const double a = (i + uniform(generator)) / n * total;
+            face = std::upper_bound(face, areas.cdf.end(), a);
+            if (face == areas.cdf.end())
+                --face;
+            const Face f = areas.faces[face - areas.cdf.begin()];
+
+            // uniform in the triangle
+            Point p0, p1, p2;
+            corners(mesh, f, p0, p1, p2);
+            const Scalar s = std::sqrt(Scalar(uniform(generator)));
+            const Scalar t = Scalar(uniform(generator));
+            samples.points[i] =
+                p0 * (1 - s) + p1 * (s * (1 - t)) + p2 * (s * t);
+            samples.normals[i] = normalize(cross(p1 - p0, p2 - p0));
+            samples.faces[i] = f;
+        }
+    });
+}
+
+// a random number per candidate, see splitmix64
+uint64_t mix(uint64_t x)
+{
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// cells are keyed by 19 bits per coordinate, prefixed by their phase
+const int cell_bits = 19;
+const uint64_t cell_mask = (uint64_t(1) << cell_bits) - 1;
+const int phase_shift = 3 * cell_bits;
+
+uint64_t cell_key(uint64_t x, uint64_t y, uint64_t z)
+{
+    return x | (y << cell_bits) | (z << (2 * cell_bits));
+}
+
+uint64_t phase(uint64_t x, uint64_t y, uint64_t z)
+{
+    return x % 3 + 3 * (y % 3) + 9 * (z % 3);
+}
+
+} // namespace
+
+//=============================================================================
+
+void SurfaceSamples::to_point_cloud(SurfaceMesh& mesh) const
+{
+    mesh.clear();
+    mesh.reserve(points.size(), 0, 0);
+    auto vnormal = mesh.vertex_property<Normal>("v:normal");
+    for (size_t i = 0; i < points.size(); ++i)
+        vnormal[mesh.add_vertex(points[i])] = normals[i];
+}
+
+//-----------------------------------------------------------------------------
+
+void sample_uniform(const SurfaceMesh& mesh, size_t n, SurfaceSamples& samples,
+                    unsigned int seed)
+{
+    AreaDistribution areas;
+    area_distribution(mesh, areas);
+    sample(mesh, areas, areas.faces.empty() ? 0 : n, seed, samples);
+}
+
+//-----------------------------------------------------------------------------
+
+bool sample_poisson_disk(const SurfaceMesh& mesh, Scalar radius,
+                         SurfaceSamples& samples, unsigned int seed,
+                         Scalar oversampling)
+{
+    samples.points.clear();
+    samples.normals.clear();
+    samples.faces.clear();
+    if (radius <= 0)
+        return false;
+
+    // cells three apart are at least a radius apart
+    BoundingBox bb;
+    for (auto v : mesh.vertices())
+        bb += mesh.position(v);
+    const Scalar cell_size = radius / 2;
+    const Point extents = (bb.max() - bb.min()) / cell_size;
+    for (int j = 0; j < 3; ++j)
+    {
+        if (!(extents[j] < Scalar(cell_mask)))
+        {
+            std::cerr << "sample_poisson_disk: radius too small" << std::endl;
+            return false;
+        }
+    }
+
+    AreaDistribution areas;
+    area_distribution(mesh, areas);
+    SurfaceSamples candidates;
+    const size_t n =
+        size_t(oversampling * areas.total() / (double(radius) * radius));
+    sample(mesh, areas, n, seed, candidates);
+
+    // sort the candidates by phase and cell, randomly within a cell
+    struct Candidate
+    {
+        uint64_t key;
+        uint64_t order;
+        IndexType index;
+        bool operator<(const Candidate& c) const
+        {
+            return key < c.key || (key == c.key && order < c.order);
+        }
+    };
+    std::vector<Candidate> sorted(n);
+    parallel_for(size_t(0), n, [&](size_t i) {
+        const Point c = (candidates.points[i] - bb.min()) / cell_size;
+        const uint64_t x = uint64_t(std::max(c[0], Scalar(0)));
+        const uint64_t y = uint64_t(std::max(c[1], Scalar(0)));
+        const uint64_t z = uint64_t(std::max(c[2], Scalar(0)));
+        sorted[i].key = cell_key(x, y, z) | (phase(x, y, z) << phase_shift);
+        sorted[i].order = mix(uint64_t(i) ^ (uint64_t(seed) << 32));
+        sorted[i].index = IndexType(i);
+    });
+    std::sort(sorted.begin(), sorted.end());
+
+    // the spatial hash of the non-empty cells, and where each phase begins
+    std::vector<IndexType> cell_begin;
+    std::unordered_map<uint64_t, IndexType> cells;
+    std::vector<IndexType> phase_begin(28, 0);
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (i == 0 || sorted[i].key != sorted[i - 1].key)
+        {
+            const uint64_t key = sorted[i].key;
+            cells[key & ((uint64_t(1) << phase_shift) - 1)] =
+                IndexType(cell_begin.size());
+            cell_begin.push_back(IndexType(i));
+            phase_begin[(key >> phase_shift) + 1] = cell_begin.size();
+        }
+    }
+    const size_t n_cells = cell_begin.size();
+    cell_begin.push_back(IndexType(n));
+    for (size_t p = 1; p < phase_begin.size(); ++p)
+        phase_begin[p] = std::max(phase_begin[p], phase_begin[p - 1]);
+
+    // accept the first candidate of each cell without a close neighbor.
+    // a cell holds at most one sample, since its diagonal is below radius.
+    std::vector<IndexType> accepted(n_cells, PMP_MAX_INDEX);
+    const Scalar sqr_radius = radius * radius;
+    for (size_t p = 0; p < 27; ++p)
+    {
+        parallel_for(phase_begin[p], phase_begin[p + 1], [&](size_t c) {
+            const uint64_t key = sorted[cell_begin[c]].key;
+            const int64_t x = int64_t(key & cell_mask);
+            const int64_t y = int64_t((key >> cell_bits) & cell_mask);
+            const int64_t z = int64_t((key >> (2 * cell_bits)) & cell_mask);
+
+            for (IndexType i = cell_begin[c]; i < cell_begin[c + 1]; ++i)
+            {
+                const Point& q = candidates.points[sorted[i].index];
+                bool free = true;
+                for (int64_t dz = -2; dz <= 2 && free; ++dz)
+                    for (int64_t dy = -2; dy <= 2 && free; ++dy)
+                        for (int64_t dx = -2; dx <= 2 && free; ++dx)
+                        {
+                            if (x + dx < 0 || y + dy < 0 || z + dz < 0)
+                                continue;
+                            auto it = cells.find(
+                                cell_key(x + dx, y + dy, z + dz));
+                            if (it == cells.end())
+                                continue;
+                            const IndexType a = accepted[it->second];
+                            free = a == PMP_MAX_INDEX ||
+                                   sqrnorm(candidates.points[a] - q) >=
+                                       sqr_radius;
+                        }
+                if (free)
+                {
+                    accepted[c] = sorted[i].index;
+                    break;
+                }
+            }
+        });
+    }
+
+    // keep the order of the candidates
+    accepted.erase(std::remove(accepted.begin(), accepted.end(),
+                               PMP_MAX_INDEX),
+                   accepted.end());
+    std::sort(accepted.begin(), accepted.end());
+    for (auto i : accepted)
+    {
+        samples.points.push_back(candidates.points[i]);
+        samples.normals.push_back(candidates.normals[i]);
+        samples.faces.push_back(candidates.faces[i]);
+    }
+    return true;
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -0,0 +1,71 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <pmp/SurfaceMesh.h>
+
+#include <vector>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \addtogroup algorithms algorithms
+//! @{
+
+//=============================================================================
+
+//! \brief Points sampled on a surface, stored as arrays.
+struct SurfaceSamples
+{
+    //! the number of samples
+    size_t size() const { return points.size(); }
+
+    std::vector<Point> points;   //!< the sample positions
+    std::vector<Normal> normals; //!< the normals of their triangles
+    std::vector<Face> faces;     //!< the triangles they lie in
+
+    //! \brief Replace \p mesh by a point cloud of the samples.
+    //! \details The normals are stored in the vertex property "v:normal",
+    //! such that SurfaceMeshIO writes them to XYZ files.
+    void to_point_cloud(SurfaceMesh& mesh) const;
+};
+
+//! \brief Sample the triangle mesh \p mesh uniformly by area.
+//! \details Replaces \p samples by \p n samples. The faces are chosen by a
+//! cumulative distribution of their areas, which is prefix-summed in
+//! parallel. The samples are stratified: sample \c i lies in the \c i'th of
+//! \p n equal parts of the total area, such that they cover the surface more
+//! evenly than independent samples. They are generated in parallel in
+//! blocks with their own random numbers, derived from \p seed, which makes
+//! the result independent of the number of threads.
+void sample_uniform(const SurfaceMesh& mesh, size_t n, SurfaceSamples& samples,
+                    unsigned int seed = 0);
+
+//! \brief Sample the triangle mesh \p mesh with Poisson-disk samples.
+//! \details Replaces \p samples by samples that are at least \p radius
+//! apart. Candidates are sampled by sample_uniform(), \p oversampling per
+//! area \p radius squared, and are accepted in random order if no accepted
+//! sample is closer. A spatial hash of cells with edge length \p radius / 2
+//! finds the neighbors. Cells three apart cannot conflict, so the cells are
+//! processed in 27 phases, each in parallel, with the same result for any
+//! number of threads. The samples keep the order of their candidates.
+//! \return false if there are more than 2^19 cells along an axis
+bool sample_poisson_disk(const SurfaceMesh& mesh, Scalar radius,
+                         SurfaceSamples& samples, unsigned int seed = 0,
+                         Scalar oversampling = 20);
+
+//=============================================================================
+//! @}
+//=============================================================================
+} // namespace pmp
+//=============================================================================
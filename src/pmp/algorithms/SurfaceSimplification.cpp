@@ -10,9 +10,12 @@
 #include <pmp/algorithms/SurfaceSimplification.h>
 #include <pmp/algorithms/DistancePointTriangle.h>
 #include <pmp/algorithms/SurfaceNormals.h>
+#include <pmp/Parallel.h>
+#include <pmp/Profiler.h>
 
+#include <algorithm>
 #include <cfloat>
-#include <iterator> // for back_inserter on Windows
+#include <chrono>
 
 //=============================================================================
 
@@ -21,7 +24,8 @@ namespace pmp {
 //=============================================================================
 
 SurfaceSimplification::SurfaceSimplification(SurfaceMesh& mesh)
-    : mesh_(mesh), initialized_(false), queue_(nullptr)
+    : mesh_(mesh), initialized_(false), queue_(nullptr),
+      progressive_mesh_(nullptr), heap_arity_(4), lean_(false)
 
 {
     aspect_ratio_ = 0;
@@ -30,15 +34,8 @@ SurfaceSimplification::SurfaceSimplification(SurfaceMesh& mesh)
     normal_deviation_ = 0;
     hausdorff_error_ = 0;
 
-    // add properties
-    vquadric_ = mesh_.add_vertex_property<Quadric>("v:quadric");
-
     // get properties
     vpoint_ = mesh_.vertex_property<Point>("v:point");
-
-    // compute face normals
-    SurfaceNormals::compute_face_normals(mesh_);
-    fnormal_ = mesh_.face_property<Normal>("f:normal");
 }
 
 //-----------------------------------------------------------------------------
@@ -47,8 +44,9 @@ SurfaceSimplification::~SurfaceSimplification()
 {
     // remove added properties
     mesh_.remove_vertex_property(vquadric_);
+    mesh_.remove_vertex_property(vfloat_quadric_);
     mesh_.remove_face_property(normal_cone_);
-    mesh_.remove_face_property(face_points_);
+    mesh_.remove_face_property(face_samples_);
 }
 
 //-----------------------------------------------------------------------------
@@ -68,15 +66,33 @@ void SurfaceSimplification::initialize(Scalar aspect_ratio, Scalar edge_length,
     normal_deviation_ = normal_deviation / 180.0 * M_PI;
     hausdorff_error_ = hausdorff_error;
 
+    // error quadrics, and face normals unless computed when needed
+    if (lean_)
+    {
+        mesh_.remove_vertex_property(vquadric_);
+        if (!vfloat_quadric_)
+            vfloat_quadric_ =
+                mesh_.add_vertex_property<FloatQuadric>("v:float_quadric");
+        fnormal_ = FaceProperty<Normal>();
+    }
+    else
+    {
+        mesh_.remove_vertex_property(vfloat_quadric_);
+        if (!vquadric_)
+            vquadric_ = mesh_.add_vertex_property<Quadric>("v:quadric");
+        SurfaceNormals::compute_face_normals(mesh_);
+        fnormal_ = mesh_.face_property<Normal>("f:normal");
+    }
+
     // properties
     if (normal_deviation_ > 0.0)
         normal_cone_ = mesh_.face_property<NormalCone>("f:normalCone");
     else
         mesh_.remove_face_property(normal_cone_);
     if (hausdorff_error > 0.0)
-        face_points_ = mesh_.face_property<Points>("f:points");
+        face_samples_ = mesh_.face_property<IndexType>("f:samples");
     else
-        mesh_.remove_face_property(face_points_);
+        mesh_.remove_face_property(face_samples_);
 
     // vertex selection
     has_selection_ = false;
@@ -109,35 +125,40 @@ void SurfaceSimplification::initialize(Scalar aspect_ratio, Scalar edge_length,
         }
     }
 
-    // initialize quadrics
-    for (auto v : mesh_.vertices())
-    {
-        vquadric_[v].clear();
-
+    // initialize quadrics: each vertex gathers the planes of its faces,
+    // which needs neither locks nor atomics
+    parallel_for(mesh_.vertices(), [&](Vertex v) {
+        Quadric q;
         if (!mesh_.is_isolated(v))
         {
+            const Point& p = vpoint_[v];
             for (auto f : mesh_.faces(v))
             {
-                vquadric_[v] += Quadric(fnormal_[f], vpoint_[v]);
+                const Normal n = face_normal(f);
+                q.add_plane(n[0], n[1], n[2], -dot(n, p));
             }
         }
-    }
+        if (vfloat_quadric_)
+            vfloat_quadric_[v] = FloatQuadric(q);
+        else
+            vquadric_[v] = q;
+    });
 
     // initialize normal cones
     if (normal_deviation_)
     {
-        for (auto f : mesh_.faces())
-        {
-            normal_cone_[f] = NormalCone(fnormal_[f]);
-        }
+        parallel_for(mesh_.faces(),
+                     [&](Face f) { normal_cone_[f] = NormalCone(face_normal(f)); });
     }
 
     // initialize faces' point list
+    samples_.clear();
+    next_sample_.clear();
     if (hausdorff_error_)
     {
         for (auto f : mesh_.faces())
         {
-            Points().swap(face_points_[f]); // free mem
+            face_samples_[f] = PMP_MAX_INDEX;
         }
     }
 
@@ -147,6 +168,16 @@ void SurfaceSimplification::initialize(Scalar aspect_ratio, Scalar edge_length,
 //-----------------------------------------------------------------------------
 
 void SurfaceSimplification::simplify(unsigned int n_vertices)
+{
+    StopCriteria criteria;
+    criteria.n_vertices = n_vertices;
+    simplify(criteria);
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceSimplification::simplify(const StopCriteria& criteria,
+                                     ProgressiveMesh& pm)
 {
     if (!mesh_.is_triangle_mesh())
     {
@@ -154,79 +185,358 @@ void SurfaceSimplification::simplify(unsigned int n_vertices)
         return;
     }
 
+    pm.begin(mesh_);
+    progressive_mesh_ = &pm;
+    simplify(criteria);
+    progressive_mesh_ = nullptr;
+    pm.end();
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceSimplification::simplify(const StopCriteria& criteria)
+{
+    PMP_PROFILE_ZONE("SurfaceSimplification::simplify");
+
+    if (!mesh_.is_triangle_mesh())
+    {
+        std::cerr << "Not a triangle mesh!" << std::endl;
+        return;
+    }
+
     // make sure the decimater is initialized
     if (!initialized_)
         initialize();
 
     unsigned int nv(mesh_.n_vertices());
+    unsigned int nf(mesh_.n_faces());
+    const auto start_time = std::chrono::steady_clock::now();
 
     std::vector<Vertex> one_ring;
     std::vector<Vertex>::iterator or_it, or_end;
     Halfedge h;
     Vertex v;
 
-    // add properties for priority queue
+    // add properties for priority queue, the lean mode finds the targets
+    // again when needed
+    const bool lean = vfloat_quadric_;
     vpriority_ = mesh_.add_vertex_property<float>("v:prio");
     heap_pos_ = mesh_.add_vertex_property<int>("v:heap");
-    vtarget_ = mesh_.add_vertex_property<Halfedge>("v:target");
+    if (!lean)
+        vtarget_ = mesh_.add_vertex_property<Halfedge>("v:target");
 
     // build priority queue
-    HeapInterface hi(vpriority_, heap_pos_);
-    queue_ = new PriorityQueue(hi);
-    queue_->reserve(mesh_.n_vertices());
-    for (auto v : mesh_.vertices())
     {
-        queue_->reset_heap_position(v);
-        enqueue_vertex(v);
+        PMP_PROFILE_ZONE("SurfaceSimplification::build_queue");
+
+        init_priorities();
+        HeapInterface hi(vpriority_, heap_pos_);
+        queue_ = new PriorityQueue(hi, heap_arity_);
+        queue_->reserve(mesh_.n_vertices());
+        for (auto v : mesh_.vertices())
+        {
+            queue_->reset_heap_position(v);
+            enqueue_vertex(v);
+        }
     }
 
-    while (nv > n_vertices && !queue_->empty())
+    // collapse the cheapest edges
     {
-        // get 1st element
-        v = queue_->front();
-        queue_->pop_front();
-        h = vtarget_[v];
-        CollapseData cd(mesh_, h);
-
-        // check this (again)
-        if (!mesh_.is_collapse_ok(h))
-            continue;
+        PMP_PROFILE_ZONE("SurfaceSimplification::heap_loop");
 
-        // store one-ring
-        one_ring.clear();
-        for (auto vv : mesh_.vertices(cd.v0))
+        while (nv > criteria.n_vertices && nf > criteria.n_faces &&
+               !queue_->empty())
         {
-            one_ring.push_back(vv);
-        }
+            // stop if the cheapest collapse is too expensive
+            if (criteria.max_error > 0 &&
+                vpriority_[queue_->front()] > criteria.max_error)
+                break;
 
-        // perform collapse
-        mesh_.collapse(h);
-        --nv;
-        //if (nv % 1000 == 0) std::cerr << nv << "\r";
+            // check the time budget every now and then
+            if (criteria.max_seconds > 0 && nv % 256 == 0 &&
+                std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - start_time)
+                        .count() > criteria.max_seconds)
+                break;
 
-        // postprocessing, e.g., update quadrics
-        postprocess_collapse(cd);
+            // get 1st element
+            v = queue_->front();
+            queue_->pop_front();
+            if (lean)
+            {
+                float prio;
+                h = best_collapse(v, prio);
+                if (!h.is_valid())
+                    continue;
+            }
+            else
+            {
+                h = vtarget_[v];
+            }
+            CollapseData cd(mesh_, h);
 
-        // update queue
-        for (or_it = one_ring.begin(), or_end = one_ring.end(); or_it != or_end;
-             ++or_it)
-            enqueue_vertex(*or_it);
+            // check this (again)
+            if (!mesh_.is_collapse_ok(h))
+                continue;
+
+            // store one-ring
+            one_ring.clear();
+            for (auto vv : mesh_.vertices(cd.v0))
+            {
+                one_ring.push_back(vv);
+            }
+
+            // perform collapse
+            mesh_.collapse(h);
+            --nv;
+            nf -= cd.fl.is_valid() + cd.fr.is_valid();
+            if (progressive_mesh_)
+                progressive_mesh_->add_collapse(cd.v0, cd.v1, cd.fl, cd.fr);
+            //if (nv % 1000 == 0) std::cerr << nv << "\r";
+
+            // postprocessing, e.g., update quadrics
+            postprocess_collapse(cd, add_sample(cd.v0));
+
+            // update queue
+            for (or_it = one_ring.begin(), or_end = one_ring.end();
+                 or_it != or_end; ++or_it)
+                enqueue_vertex(*or_it);
+
+            // release the memory of the removed elements
+            if (lean && !progressive_mesh_ && 2 * nv < mesh_.vertices_size())
+                release_memory();
+        }
     }
 
     // clean up
     delete queue_;
-    mesh_.garbage_collection();
+    mesh_.remove_halfedge_property(hpriority_);
     mesh_.remove_vertex_property(vpriority_);
     mesh_.remove_vertex_property(heap_pos_);
     mesh_.remove_vertex_property(vtarget_);
+    mesh_.stable_garbage_collection();
 }
 
 //-----------------------------------------------------------------------------
 
-void SurfaceSimplification::enqueue_vertex(Vertex v)
+void SurfaceSimplification::simplify_batched(unsigned int n_vertices)
+{
+    PMP_PROFILE_ZONE("SurfaceSimplification::simplify_batched");
+
+    if (!mesh_.is_triangle_mesh())
+    {
+        std::cerr << "Not a triangle mesh!" << std::endl;
+        return;
+    }
+
+    // make sure the decimater is initialized
+    if (!initialized_)
+        initialize();
+
+    unsigned int nv(mesh_.n_vertices());
+
+    // add properties for the best collapse of each vertex
+    vpriority_ = mesh_.add_vertex_property<float>("v:prio");
+    vtarget_ = mesh_.add_vertex_property<Halfedge>("v:target");
+    init_priorities();
+
+    std::vector<char> dirty(mesh_.vertices_size(), 1);
+    std::vector<char> locked(mesh_.vertices_size(), 0);
+    std::vector<std::pair<float, Vertex>> candidates;
+    std::vector<CollapseData> batch;
+    std::vector<Vertex> region;
+    std::vector<IndexType> samples;
+
+    auto is_locked = [&](Vertex v) {
+        if (locked[v.idx()])
+            return true;
+        for (auto vv : mesh_.vertices(v))
+            if (locked[vv.idx()])
+                return true;
+        return false;
+    };
+
+    auto lock = [&](Vertex v) {
+        locked[v.idx()] = 1;
+        region.push_back(v);
+        for (auto vv : mesh_.vertices(v))
+        {
+            locked[vv.idx()] = 1;
+            region.push_back(vv);
+        }
+    };
+
+    auto cheaper = [](const std::pair<float, Vertex>& a,
+                      const std::pair<float, Vertex>& b) {
+        return a.first < b.first;
+    };
+
+    while (nv > n_vertices)
+    {
+        // re-evaluate vertices whose neighborhood has changed, this only
+        // reads the mesh, and each vertex writes its own priority and target
+        parallel_for(mesh_.vertices(), [&](Vertex v) {
+            if (dirty[v.idx()])
+            {
+                vtarget_[v] = best_collapse(v, vpriority_[v]);
+                dirty[v.idx()] = 0;
+            }
+        });
+
+        candidates.clear();
+        for (auto v : mesh_.vertices())
+            if (vtarget_[v].is_valid())
+                candidates.emplace_back(vpriority_[v], v);
+        if (candidates.empty())
+            break;
+
+        // consider the cheapest collapses only, limiting the batch keeps the
+        // order of collapses close to the one of simplify()
+        const size_t max_batch =
+            std::max(size_t(1), std::min(size_t(nv - n_vertices),
+                                         size_t(nv / 16)));
+        if (candidates.size() > 4 * max_batch)
+        {
+            std::nth_element(candidates.begin(),
+                             candidates.begin() + 4 * max_batch,
+                             candidates.end(), cheaper);
+            candidates.resize(4 * max_batch);
+        }
+        std::sort(candidates.begin(), candidates.end(), cheaper);
+
+        // greedily select collapses whose one-rings do not overlap, such
+        // that they do not influence each other
+        batch.clear();
+        for (const auto& c : candidates)
+        {
+            if (batch.size() == max_batch)
+                break;
+
+            CollapseData cd(mesh_, vtarget_[c.second]);
+            if (is_locked(cd.v0) || is_locked(cd.v1))
+                continue;
+            if (!mesh_.is_collapse_ok(cd.v0v1))
+                continue;
+
+            lock(cd.v0);
+            lock(cd.v1);
+            batch.push_back(cd);
+        }
+
+        // perform collapses, they modify the mesh connectivity and are
+        // therefore done serially
+        for (const auto& cd : batch)
+            mesh_.collapse(cd.v0v1);
+        nv -= batch.size();
+
+        // postprocessing of the independent regions, the positions of the
+        // removed vertices are added to the samples beforehand
+        samples.clear();
+        for (const auto& cd : batch)
+            samples.push_back(add_sample(cd.v0));
+        parallel_for(size_t(0), batch.size(), [&](size_t i) {
+            postprocess_collapse(batch[i], samples[i]);
+        });
+
+        // update the one-rings like simplify() does, other outdated targets
+        // are caught by is_collapse_ok() above
+        for (const auto& cd : batch)
+        {
+            dirty[cd.v1.idx()] = 1;
+            for (auto v : mesh_.vertices(cd.v1))
+                dirty[v.idx()] = 1;
+        }
+
+        for (auto v : region)
+            locked[v.idx()] = 0;
+        region.clear();
+    }
+
+    // clean up
+    mesh_.remove_halfedge_property(hpriority_);
+    mesh_.remove_vertex_property(vpriority_);
+    mesh_.remove_vertex_property(vtarget_);
+    mesh_.stable_garbage_collection();
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceSimplification::release_memory()
+{
+    PMP_PROFILE_ZONE("SurfaceSimplification::release_memory");
+
+    // the queue stores vertex handles, which change by the compaction,
+    // while the vertices keep their priorities and whether they are queued
+    delete queue_;
+    mesh_.stable_garbage_collection();
+    mesh_.free_memory();
+
+    HeapInterface hi(vpriority_, heap_pos_);
+    queue_ = new PriorityQueue(hi, heap_arity_);
+    unsigned int n = 0;
+    for (auto v : mesh_.vertices())
+        if (queue_->is_stored(v))
+            ++n;
+    queue_->reserve(n);
+    for (auto v : mesh_.vertices())
+    {
+        if (queue_->is_stored(v))
+        {
+            queue_->reset_heap_position(v);
+            queue_->insert(v);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+Halfedge SurfaceSimplification::best_collapse(Vertex v, float& min_prio)
 {
-    float prio, min_prio(FLT_MAX);
+    // sort out-going halfedges by their priorities, keeping the order of
+    // equal ones
+    Halfedge halfedges[max_cached_valence];
+    float priorities[max_cached_valence];
+    size_t n = 0;
+    for (auto h : mesh_.halfedges(v))
+    {
+        if (n == max_cached_valence)
+            return best_collapse_uncached(v, min_prio);
+
+        const float prio = hpriority_ ? hpriority_[h] : priority(h);
+        size_t i = n++;
+        for (; i > 0 && priorities[i - 1] > prio; --i)
+        {
+            halfedges[i] = halfedges[i - 1];
+            priorities[i] = priorities[i - 1];
+        }
+        halfedges[i] = h;
+        priorities[i] = prio;
+    }
+
+    // the cheapest legal one is the best, the expensive legality tests of
+    // the more costly ones can be skipped
+    for (size_t i = 0; i < n; ++i)
+    {
+        CollapseData cd(mesh_, halfedges[i]);
+        if (is_collapse_legal(cd))
+        {
+            min_prio = priorities[i];
+            return halfedges[i];
+        }
+    }
+
+    min_prio = FLT_MAX;
+    return Halfedge();
+}
+
+//-----------------------------------------------------------------------------
+
+Halfedge SurfaceSimplification::best_collapse_uncached(Vertex v,
+                                                       float& min_prio)
+{
+    float prio;
     Halfedge min_h;
+    min_prio = FLT_MAX;
 
     // find best out-going halfedge
     for (auto h : mesh_.halfedges(v))
@@ -234,8 +544,8 @@ void SurfaceSimplification::enqueue_vertex(Vertex v)
         CollapseData cd(mesh_, h);
         if (is_collapse_legal(cd))
         {
-            prio = priority(cd);
-            if (prio != -1.0 && prio < min_prio)
+            prio = hpriority_ ? hpriority_[h] : priority(h);
+            if (prio < min_prio)
             {
                 min_prio = prio;
                 min_h = h;
@@ -243,11 +553,22 @@ void SurfaceSimplification::enqueue_vertex(Vertex v)
         }
     }
 
+    return min_h;
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceSimplification::enqueue_vertex(Vertex v)
+{
+    float min_prio;
+    Halfedge min_h = best_collapse(v, min_prio);
+
     // target found -> put vertex on heap
     if (min_h.is_valid())
     {
         vpriority_[v] = min_prio;
-        vtarget_[v] = min_h;
+        if (vtarget_)
+            vtarget_[v] = min_h;
 
         if (queue_->is_stored(v))
             queue_->update(v);
@@ -262,7 +583,8 @@ void SurfaceSimplification::enqueue_vertex(Vertex v)
             queue_->remove(v);
 
         vpriority_[v] = -1;
-        vtarget_[v] = min_h;
+        if (vtarget_)
+            vtarget_[v] = min_h;
     }
 }
 
@@ -317,7 +639,8 @@ bool SurfaceSimplification::is_collapse_legal(const CollapseData& cd)
             return false;
     }
 
-    // remember the positions of the endpoints
+    // the positions of the endpoints, the tests below evaluate the faces of
+    // v0 as if v0 was moved to p1 without modifying the mesh
     const Point p0 = vpoint_[cd.v0];
     const Point p1 = vpoint_[cd.v1];
 
@@ -337,28 +660,21 @@ bool SurfaceSimplification::is_collapse_legal(const CollapseData& cd)
     // check for flipping normals
     if (normal_deviation_ == 0.0)
     {
-        vpoint_[cd.v0] = p1;
         for (auto f : mesh_.faces(cd.v0))
         {
             if (f != cd.fl && f != cd.fr)
             {
-                Normal n0 = fnormal_[f];
-                Normal n1 = SurfaceNormals::compute_face_normal(mesh_, f);
+                Normal n0 = face_normal(f);
+                Normal n1 = face_normal(f, cd.v0, p1);
                 if (dot(n0, n1) < 0.0)
-                {
-                    vpoint_[cd.v0] = p0;
                     return false;
-                }
             }
         }
-        vpoint_[cd.v0] = p0;
     }
 
     // check normal cone
     else
     {
-        vpoint_[cd.v0] = p1;
-
         Face fll, frr;
         if (cd.vl.is_valid())
             fll = mesh_.face(
@@ -372,7 +688,7 @@ bool SurfaceSimplification::is_collapse_legal(const CollapseData& cd)
             if (f != cd.fl && f != cd.fr)
             {
                 NormalCone nc = normal_cone_[f];
-                nc.merge(SurfaceNormals::compute_face_normal(mesh_, f));
+                nc.merge(face_normal(f, cd.v0, p1));
 
                 if (f == fll)
                     nc.merge(normal_cone_[cd.fl]);
@@ -380,14 +696,9 @@ bool SurfaceSimplification::is_collapse_legal(const CollapseData& cd)
                     nc.merge(normal_cone_[cd.fr]);
 
                 if (nc.angle() > 0.5 * normal_deviation_)
-                {
-                    vpoint_[cd.v0] = p0;
                     return false;
-                }
             }
         }
-
-        vpoint_[cd.v0] = p0;
     }
 
     // check aspect ratio
@@ -400,10 +711,8 @@ bool SurfaceSimplification::is_collapse_legal(const CollapseData& cd)
             if (f != cd.fl && f != cd.fr)
             {
                 // worst aspect ratio after collapse
-                vpoint_[cd.v0] = p1;
-                ar1 = std::max(ar1, aspect_ratio(f));
+                ar1 = std::max(ar1, aspect_ratio(f, cd.v0, p1));
                 // worst aspect ratio before collapse
-                vpoint_[cd.v0] = p0;
                 ar0 = std::max(ar0, aspect_ratio(f));
             }
         }
@@ -416,42 +725,31 @@ bool SurfaceSimplification::is_collapse_legal(const CollapseData& cd)
     // check Hausdorff error
     if (hausdorff_error_)
     {
-        Points points;
-        bool ok;
-
-        // collect points to be tested
-        for (auto f : mesh_.faces(cd.v0))
-        {
-            std::copy(face_points_[f].begin(), face_points_[f].end(),
-                      std::back_inserter(points));
-        }
-        points.push_back(vpoint_[cd.v0]);
-
-        // test points against all faces
-        vpoint_[cd.v0] = p1;
-        for (auto point : points)
-        {
-            ok = false;
-
+        // is the point within the Hausdorff error of the new faces?
+        auto is_close = [&](const Point& point) {
             for (auto f : mesh_.faces(cd.v0))
             {
                 if (f != cd.fl && f != cd.fr)
                 {
-                    if (distance(f, point) < hausdorff_error_)
-                    {
-                        ok = true;
-                        break;
-                    }
+                    if (distance(f, point, cd.v0, p1) < hausdorff_error_)
+                        return true;
                 }
             }
+            return false;
+        };
 
-            if (!ok)
+        // test the points of all faces and the removed vertex
+        for (auto f : mesh_.faces(cd.v0))
+        {
+            for (IndexType i = face_samples_[f]; i != PMP_MAX_INDEX;
+                 i = next_sample_[i])
             {
-                vpoint_[cd.v0] = p0;
-                return false;
+                if (!is_close(samples_[i]))
+                    return false;
             }
         }
-        vpoint_[cd.v0] = p0;
+        if (!is_close(p0))
+            return false;
     }
 
     // collapse passed all tests -> ok
@@ -460,20 +758,56 @@ bool SurfaceSimplification::is_collapse_legal(const CollapseData& cd)
 
 //-----------------------------------------------------------------------------
 
-float SurfaceSimplification::priority(const CollapseData& cd)
+float SurfaceSimplification::priority(Halfedge h) const
 {
     // computer quadric error metric
-    Quadric Q = vquadric_[cd.v0];
-    Q += vquadric_[cd.v1];
-    return Q(vpoint_[cd.v1]);
+    const Vertex v0 = mesh_.from_vertex(h);
+    const Vertex v1 = mesh_.to_vertex(h);
+    if (vfloat_quadric_)
+    {
+        FloatQuadric Q = vfloat_quadric_[v0];
+        Q += vfloat_quadric_[v1];
+        return Q(vpoint_[v1]);
+    }
+    Quadric Q = vquadric_[v0];
+    Q += vquadric_[v1];
+    return Q(vpoint_[v1]);
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceSimplification::init_priorities()
+{
+    // the lean mode evaluates the priorities when needed
+    if (vfloat_quadric_)
+        return;
+
+    hpriority_ = mesh_.add_halfedge_property<float>("h:prio");
+    parallel_for(mesh_.halfedges(),
+                 [&](Halfedge h) { hpriority_[h] = priority(h); });
 }
 
 //-----------------------------------------------------------------------------
 
-void SurfaceSimplification::postprocess_collapse(const CollapseData& cd)
+void SurfaceSimplification::postprocess_collapse(const CollapseData& cd,
+                                                 IndexType sample)
 {
     // update error quadrics
-    vquadric_[cd.v1] += vquadric_[cd.v0];
+    if (vfloat_quadric_)
+        vfloat_quadric_[cd.v1] += vfloat_quadric_[cd.v0];
+    else
+        vquadric_[cd.v1] += vquadric_[cd.v0];
+
+    // only the priorities of the halfedges incident to v1 have changed
+    if (hpriority_)
+    {
+        for (auto h : mesh_.halfedges(cd.v1))
+        {
+            hpriority_[h] = priority(h);
+            const Halfedge o = mesh_.opposite_halfedge(h);
+            hpriority_[o] = priority(o);
+        }
+    }
 
     // update normal cones
     if (normal_deviation_)
@@ -502,46 +836,45 @@ void SurfaceSimplification::postprocess_collapse(const CollapseData& cd)
     // update Hausdorff error
     if (hausdorff_error_)
     {
-        Points points;
-
-        // collect points to be distributed
+        // collect points to be distributed into one list, starting with
+        // the removed vertex
+        IndexType points = sample;
+        auto take_samples = [&](Face f) {
+            IndexType i = face_samples_[f];
+            while (i != PMP_MAX_INDEX)
+            {
+                const IndexType next = next_sample_[i];
+                next_sample_[i] = points;
+                points = i;
+                i = next;
+            }
+            face_samples_[f] = PMP_MAX_INDEX;
+        };
 
         // points of v1's one-ring
         for (auto f : mesh_.faces(cd.v1))
-        {
-            std::copy(face_points_[f].begin(), face_points_[f].end(),
-                      std::back_inserter(points));
-            face_points_[f].clear();
-        }
+            take_samples(f);
 
         // points of the 2 removed triangles
         if (cd.fl.is_valid())
-        {
-            std::copy(face_points_[cd.fl].begin(), face_points_[cd.fl].end(),
-                      std::back_inserter(points));
-            Points().swap(face_points_[cd.fl]); // free mem
-        }
+            take_samples(cd.fl);
         if (cd.fr.is_valid())
-        {
-            std::copy(face_points_[cd.fr].begin(), face_points_[cd.fr].end(),
-                      std::back_inserter(points));
-            Points().swap(face_points_[cd.fr]); // free mem
-        }
+            take_samples(cd.fr);
 
-        // the removed vertex
-        points.push_back(vpoint_[cd.v0]);
-
-        // test points against all faces
+        // move each point to its closest face
         Scalar d, dd;
         Face ff;
 
-        for (auto point : points)
+        while (points != PMP_MAX_INDEX)
         {
+            const IndexType i = points;
+            points = next_sample_[i];
+
             dd = FLT_MAX;
 
             for (auto f : mesh_.faces(cd.v1))
             {
-                d = distance(f, point);
+                d = distance(f, samples_[i]);
                 if (d < dd)
                 {
                     ff = f;
@@ -549,24 +882,71 @@ void SurfaceSimplification::postprocess_collapse(const CollapseData& cd)
                 }
             }
 
-            face_points_[ff].push_back(point);
+            next_sample_[i] = face_samples_[ff];
+            face_samples_[ff] = i;
         }
     }
 }
 
 //-----------------------------------------------------------------------------
 
-Scalar SurfaceSimplification::aspect_ratio(Face f) const
+IndexType SurfaceSimplification::add_sample(Vertex v)
+{
+    if (!hausdorff_error_)
+        return PMP_MAX_INDEX;
+
+    samples_.push_back(vpoint_[v]);
+    next_sample_.push_back(PMP_MAX_INDEX);
+    return IndexType(samples_.size() - 1);
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceSimplification::triangle_points(Face f, Vertex v, const Point& p,
+                                            Point& p0, Point& p1,
+                                            Point& p2) const
+{
+    SurfaceMesh::VertexAroundFaceCirculator fvit = mesh_.vertices(f);
+
+    Vertex v0 = *fvit;
+    Vertex v1 = *(++fvit);
+    Vertex v2 = *(++fvit);
+
+    p0 = (v0 == v) ? p : vpoint_[v0];
+    p1 = (v1 == v) ? p : vpoint_[v1];
+    p2 = (v2 == v) ? p : vpoint_[v2];
+}
+
+//-----------------------------------------------------------------------------
+
+Normal SurfaceSimplification::face_normal(Face f, Vertex v,
+                                          const Point& p) const
+{
+    // same as SurfaceNormals::compute_face_normal() for triangles
+    Point p0, p1, p2;
+    triangle_points(f, v, p, p0, p1, p2);
+    return normalize(cross(p2 -= p1, p0 -= p1));
+}
+
+//-----------------------------------------------------------------------------
+
+Normal SurfaceSimplification::face_normal(Face f) const
+{
+    return fnormal_ ? fnormal_[f]
+                    : SurfaceNormals::compute_face_normal(mesh_, f);
+}
+
+//-----------------------------------------------------------------------------
+
+Scalar SurfaceSimplification::aspect_ratio(Face f, Vertex v,
+                                           const Point& p) const
 {
     // min height is area/maxLength
     // aspect ratio = length / height
     //              = length * length / area
 
-    SurfaceMesh::VertexAroundFaceCirculator fvit = mesh_.vertices(f);
-
-    const Point p0 = vpoint_[*fvit];
-    const Point p1 = vpoint_[*(++fvit)];
-    const Point p2 = vpoint_[*(++fvit)];
+    Point p0, p1, p2;
+    triangle_points(f, v, p, p0, p1, p2);
 
     const Point d0 = p0 - p1;
     const Point d1 = p1 - p2;
@@ -587,17 +967,15 @@ Scalar SurfaceSimplification::aspect_ratio(Face f) const
 
 //-----------------------------------------------------------------------------
 
-Scalar SurfaceSimplification::distance(Face f, const Point& p) const
+Scalar SurfaceSimplification::distance(Face f, const Point& q, Vertex v,
+                                       const Point& p) const
 {
-    SurfaceMesh::VertexAroundFaceCirculator fvit = mesh_.vertices(f);
-
-    const Point p0 = vpoint_[*fvit];
-    const Point p1 = vpoint_[*(++fvit)];
-    const Point p2 = vpoint_[*(++fvit)];
+    Point p0, p1, p2;
+    triangle_points(f, v, p, p0, p1, p2);
 
     Point n;
 
-    return dist_point_triangle(p, p0, p1, p2, n);
+    return dist_point_triangle(q, p0, p1, p2, n);
 }
 
 //-----------------------------------------------------------------------------
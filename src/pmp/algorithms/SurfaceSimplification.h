@@ -13,6 +13,7 @@
 
 #include <pmp/algorithms/Heap.h>
 #include <pmp/algorithms/NormalCone.h>
+#include <pmp/algorithms/ProgressiveMesh.h>
 #include <pmp/algorithms/Quadric.h>
 
 #include <set>
@@ -45,9 +46,66 @@ public:
                     unsigned int max_valence = 0, Scalar normal_deviation = 0.0,
                     Scalar hausdorff_error = 0.0);
 
+    //! \brief Criteria for stopping the simplification.
+    //! \details Simplification stops as soon as one of the enabled criteria
+    //! is met, or if no legal collapse is left. To simplify until the
+    //! Hausdorff error would exceed a threshold, pass it to initialize()
+    //! instead, which makes such collapses illegal.
+    struct StopCriteria
+    {
+        StopCriteria() {}
+        unsigned int n_vertices = 0; //!< stop at this number of vertices
+        unsigned int n_faces = 0;    //!< stop at this number of faces
+        Scalar max_error = 0;  //!< stop before a collapse whose quadric error
+                               //!< exceeds this, disabled if zero
+        double max_seconds = 0; //!< stop after this time, disabled if zero
+    };
+
     //! Simplify mesh to \p n vertices.
     void simplify(unsigned int n_vertices);
 
+    //! \brief Simplify mesh until one of the \p criteria is met.
+    //! \details The quadric error of a collapse is the sum of squared
+    //! distances of its new position to the planes of the faces merged
+    //! into it, so use the square of a distance for
+    //! StopCriteria::max_error.
+    void simplify(const StopCriteria& criteria);
+
+    //! \brief Simplify mesh until one of the \p criteria is met, and record
+    //! the collapses into the progressive mesh \p pm.
+    //! \details \p pm can reconstruct any level of detail between the
+    //! simplified and the current mesh, see ProgressiveMesh.
+    void simplify(const StopCriteria& criteria, ProgressiveMesh& pm);
+
+    //! \brief Simplify mesh to \p n vertices using parallel batches.
+    //! \details Instead of performing one collapse after the other, each
+    //! round selects a batch of the cheapest collapses whose one-rings do not
+    //! overlap. These are independent of each other, their costs and
+    //! legality are evaluated in parallel. Uses the same criteria as
+    //! simplify(), but the result differs slightly due to the different
+    //! order of collapses.
+    void simplify_batched(unsigned int n_vertices);
+
+    //! \brief Set the number of children of each node of the priority queue
+    //! used by simplify().
+    //! \details Has to be a power of two. The default of 4 is faster than
+    //! a binary heap on large meshes. The order of collapses with equal
+    //! priority, and hence the result, may depend on it.
+    void set_heap_arity(unsigned int arity) { heap_arity_ = arity; }
+
+    //! \brief Reduce the memory needed for simplifying large meshes.
+    //! \details Stores the error quadrics in single precision, evaluates
+    //! the priorities of collapses when needed instead of caching one per
+    //! halfedge, and computes face normals from the current positions
+    //! instead of storing them in "f:normal". simplify() finds the target
+    //! of a vertex again when taking it from the queue, and releases the
+    //! memory of the removed elements whenever the number of vertices has
+    //! halved, unless it records a ProgressiveMesh. Normal cones and
+    //! Hausdorff samples are allocated only if enabled in initialize(),
+    //! as in the default mode. Takes effect at the next initialize(). The
+    //! result may differ slightly from the default mode.
+    void set_lean_mode(bool lean) { lean_ = lean; }
+
 private: //------------------------------------------------------ private types
     //! Store data for an halfedge collapse
     /*
@@ -89,6 +147,7 @@ private: //------------------------------------------------------ private types
         {
         }
 
+        float key(Vertex v) { return prio_[v]; }
         bool less(Vertex v0, Vertex v1) { return prio_[v0] < prio_[v1]; }
         bool greater(Vertex v0, Vertex v1) { return prio_[v0] > prio_[v1]; }
         int get_heap_position(Vertex v) { return pos_[v]; }
@@ -99,28 +158,58 @@ private: //------------------------------------------------------ private types
         VertexProperty<int> pos_;
     };
 
-    typedef Heap<Vertex, HeapInterface> PriorityQueue;
-
-    typedef std::vector<Point> Points;
+    typedef DaryHeap<Vertex, HeapInterface> PriorityQueue;
 
 private: //-------------------------------------------------- private functions
     // put the vertex v in the priority queue
     void enqueue_vertex(Vertex v);
 
+    // find the legal out-going halfedge of v with minimal priority
+    Halfedge best_collapse(Vertex v, float& prio);
+
+    // best_collapse() for vertices of very high valence
+    Halfedge best_collapse_uncached(Vertex v, float& prio);
+
+    // the maximal valence best_collapse() sorts on the stack
+    static const size_t max_cached_valence = 32;
+
     // is collapsing the halfedge h allowed?
     bool is_collapse_legal(const CollapseData& cd);
 
     // what is the priority of collapsing the halfedge h
-    float priority(const CollapseData& cd);
+    float priority(Halfedge h) const;
+
+    // cache the priorities of all halfedges
+    void init_priorities();
+
+    // postprocess halfedge collapse, sample is the position of v0 added by
+    // add_sample()
+    void postprocess_collapse(const CollapseData& cd, IndexType sample);
+
+    // add the position of v to the samples of the Hausdorff error
+    IndexType add_sample(Vertex v);
 
-    // postprocess halfedge collapse
-    void postprocess_collapse(const CollapseData& cd);
+    // get the corners of triangle f, with the vertex v moved to p
+    void triangle_points(Face f, Vertex v, const Point& p, Point& p0,
+                         Point& p1, Point& p2) const;
 
-    // compute aspect ratio for face f
-    Scalar aspect_ratio(Face f) const;
+    // compute normal of triangle f, with the vertex v moved to p
+    Normal face_normal(Face f, Vertex v, const Point& p) const;
 
-    // compute distance from p to triagle f
-    Scalar distance(Face f, const Point& p) const;
+    // the normal of face f, stored or computed in lean mode
+    Normal face_normal(Face f) const;
+
+    // remove the deleted elements, release their memory, and rebuild the
+    // queue, for the lean mode of simplify()
+    void release_memory();
+
+    // compute aspect ratio for face f, with the vertex v moved to p
+    Scalar aspect_ratio(Face f, Vertex v = Vertex(),
+                        const Point& p = Point(0, 0, 0)) const;
+
+    // compute distance from q to triagle f, with the vertex v moved to p
+    Scalar distance(Face f, const Point& q, Vertex v = Vertex(),
+                    const Point& p = Point(0, 0, 0)) const;
 
 private: //------------------------------------------------------- private data
     SurfaceMesh& mesh_;
@@ -128,11 +217,17 @@ private: //------------------------------------------------------- private data
     bool initialized_;
 
     VertexProperty<float> vpriority_;
+    HalfedgeProperty<float> hpriority_; // cached priority of each collapse
     VertexProperty<Halfedge> vtarget_;
     VertexProperty<int> heap_pos_;
     VertexProperty<Quadric> vquadric_;
+    VertexProperty<FloatQuadric> vfloat_quadric_; // instead in lean mode
     FaceProperty<NormalCone> normal_cone_;
-    FaceProperty<Points> face_points_;
+
+    // the points tested for the Hausdorff error, in linked lists per face
+    std::vector<Point> samples_;
+    std::vector<IndexType> next_sample_;
+    FaceProperty<IndexType> face_samples_; // first sample of each face
 
     VertexProperty<Point> vpoint_;
     FaceProperty<Point> fnormal_;
@@ -142,6 +237,8 @@ private: //------------------------------------------------------- private data
 
     PriorityQueue* queue_;
 
+    ProgressiveMesh* progressive_mesh_;
+
     bool has_selection_;
     bool has_features_;
     Scalar normal_deviation_;
@@ -149,6 +246,8 @@ private: //------------------------------------------------------- private data
     Scalar aspect_ratio_;
     Scalar edge_length_;
     unsigned int max_valence_;
+    unsigned int heap_arity_;
+    bool lean_;
 };
 
 //=============================================================================
@@ -9,9 +9,12 @@
 
 #include <pmp/algorithms/SurfaceSmoothing.h>
 #include <pmp/algorithms/DifferentialGeometry.h>
+#include <pmp/algorithms/GeometryCache.h>
+#include <pmp/Parallel.h>
 
-#include <Eigen/Dense>
-#include <Eigen/Sparse>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
 
 //=============================================================================
 
@@ -19,13 +22,131 @@ namespace pmp {
 
 //=============================================================================
 
-using SparseMatrix = Eigen::SparseMatrix<double>;
-using Triplet = Eigen::Triplet<double>;
+namespace {
+
+// one step for the rows [begin,end): y = A x, for positions stored in
+// four floats per vertex, such that each term is a single vector operation
+void smooth_rows(const CompressedRowMatrix& pattern,
+                 const std::vector<float>& A, const float* x, float* y,
+                 size_t begin, size_t end)
+{
+    const int* offsets = pattern.offsets.data();
+    const int* columns = pattern.columns.data();
+    const float* a = A.data();
+
+    for (size_t i = begin; i < end; ++i)
+    {
+        float sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        for (int k = offsets[i]; k < offsets[i + 1]; ++k)
+        {
+            const float* p = x + 4 * size_t(columns[k]);
+            for (int j = 0; j < 4; ++j)
+                sum[j] += a[k] * p[j];
+        }
+        for (int j = 0; j < 4; ++j)
+            y[4 * i + j] = sum[j];
+    }
+}
+
+// The rows are split into blocks, and a block advances to its next step
+// as soon as its neighbor blocks completed the current one, such that up
+// to fused steps are taken while the data of a block is in cache. Neighbor
+// blocks are at most one step apart, hence iteration i reads x[i % 2]
+// and writes x[(i + 1) % 2] as in the sequence of full passes, which gives
+// identical results. Small blocks keep the data touched between two steps
+// of a block in cache, the schedule runs on one thread.
+void fused_smoothing(const CompressedRowMatrix& pattern,
+                     const std::vector<float>& A, std::vector<float> x[2],
+                     unsigned int iters, unsigned int fused)
+{
+    const size_t block_size = 256;
+    const size_t n = pattern.n_rows;
+    const size_t n_blocks = (n + block_size - 1) / block_size;
+
+    // the other blocks referenced by the rows of each block
+    std::vector<std::vector<size_t>> neighbors(n_blocks);
+    parallel_for_chunks(
+        n_blocks,
+        [&](size_t begin, size_t end) {
+            for (size_t b = begin; b < end; ++b)
+            {
+                std::vector<size_t>& blocks = neighbors[b];
+                const size_t last = std::min(n, (b + 1) * block_size);
+                for (int k = pattern.offsets[b * block_size];
+                     k < pattern.offsets[last]; ++k)
+                {
+                    const size_t c = pattern.columns[k] / block_size;
+                    if (c != b)
+                        blocks.push_back(c);
+                }
+                std::sort(blocks.begin(), blocks.end());
+                blocks.erase(std::unique(blocks.begin(), blocks.end()),
+                             blocks.end());
+            }
+        },
+        1);
+
+    std::vector<unsigned int> done(n_blocks, 0);
+    std::vector<size_t> stack;
+    for (unsigned int first = 0; first < iters; first += fused)
+    {
+        const unsigned int last = std::min(first + fused, iters);
+
+        bool complete = false;
+        while (!complete)
+        {
+            // advance the blocks in order, each as far as its neighbors
+            // permit, and revisit the visited neighbors it unblocks
+            for (size_t b = 0; b < n_blocks; ++b)
+            {
+                stack.push_back(b);
+                while (!stack.empty())
+                {
+                    const size_t c = stack.back();
+                    stack.pop_back();
+                    if (done[c] == last)
+                        continue;
+                    bool ready = true;
+                    for (size_t d : neighbors[c])
+                        if (done[d] < done[c])
+                        {
+                            ready = false;
+                            break;
+                        }
+                    if (!ready)
+                        continue;
+
+                    const size_t begin = c * block_size;
+                    smooth_rows(pattern, A, x[done[c] % 2].data(),
+                                x[(done[c] + 1) % 2].data(), begin,
+                                std::min(n, begin + block_size));
+                    ++done[c];
+
+                    stack.push_back(c);
+                    for (size_t d : neighbors[c])
+                        if (d <= b)
+                            stack.push_back(d);
+                }
+            }
+
+            complete = true;
+            for (auto d : done)
+                if (d != last)
+                    complete = false;
+        }
+    }
+}
+
+} // namespace
 
 //=============================================================================
 
 SurfaceSmoothing::SurfaceSmoothing(SurfaceMesh& mesh)
-    : mesh_(mesh)
+    : mesh_(mesh),
+      fused_iterations_(1),
+      laplace_(mesh),
+      local_topology_version_(0),
+      local_uniform_(false)
 {
     how_many_edge_weights_   = 0;
     how_many_vertex_weights_ = 0;
@@ -55,8 +176,10 @@ void SurfaceSmoothing::compute_edge_weights(bool use_uniform_laplace)
     }
     else
     {
+        const GeometryCache* cache = GeometryCache::get(mesh_);
         for (auto e : mesh_.edges())
-            eweight[e] = std::max(0.0, cotan_weight(mesh_, e));
+            eweight[e] = std::max(0.0, cache ? cache->cotan_weight(e)
+                                             : cotan_weight(mesh_, e));
     }
 
     how_many_edge_weights_ = mesh_.n_edges();
@@ -75,8 +198,10 @@ void SurfaceSmoothing::compute_vertex_weights(bool use_uniform_laplace)
     }
     else
     {
+        const GeometryCache* cache = GeometryCache::get(mesh_);
         for (auto v : mesh_.vertices())
-            vweight[v] = 0.5 / voronoi_area(mesh_, v);
+            vweight[v] = 0.5 / (cache ? cache->voronoi_area(v)
+                                      : voronoi_area(mesh_, v));
     }
 
     how_many_vertex_weights_ = mesh_.n_vertices();
@@ -98,46 +223,172 @@ void SurfaceSmoothing::explicit_smoothing(unsigned int iters,
 
     auto points  = mesh_.get_vertex_property<Point>("v:point");
     auto eweight = mesh_.get_edge_property<Scalar>("e:cotan");
-    auto laplace = mesh_.add_vertex_property<Point>("v:laplace");
 
+    // the pattern of the Laplace matrix, only its values are recomputed
+    // as long as the connectivity is unchanged
+    std::vector<double> weights(mesh_.edges_size(), 0.0);
+    for (auto e : mesh_.edges())
+        weights[e.idx()] = eweight[e];
+    laplace_.assemble(weights);
+    const CompressedRowMatrix& L = laplace_.matrix();
+
+    // a step moves each vertex halfway to the weighted mean of its
+    // neighbors, i.e., multiplies the positions with A = I - 0.5 D^-1 L,
+    // boundary vertices stay fixed
+    std::vector<float> A(L.values.size());
+    parallel_for(mesh_.vertices(), [&](Vertex v) {
+        const int i = v.idx();
+        int diagonal = L.offsets[i];
+        while (L.columns[diagonal] != i)
+            ++diagonal;
+        const double w = L.values[diagonal];
+        const bool fixed = mesh_.is_boundary(v) || w <= 0.0;
+        for (int k = L.offsets[i]; k < L.offsets[i + 1]; ++k)
+            A[k] = fixed ? 0.0f : float(-0.5 * L.values[k] / w);
+        A[diagonal] = fixed ? 1.0f : 0.5f;
+    });
+
+    // double-buffered positions, padded to four floats per vertex
+    const size_t n = mesh_.vertices_size();
+    std::vector<float> x[2];
+    x[0].assign(4 * n, 0.0f);
+    x[1].assign(4 * n, 0.0f);
+    for (auto v : mesh_.vertices())
+        for (int j = 0; j < 3; ++j)
+            x[0][4 * v.idx() + j] = points[v][j];
 
     // smoothing iterations
-    Vertex vv;
-    Edge e;
-    for (unsigned int i = 0; i < iters; ++i)
+    if (fused_iterations_ > 1)
     {
-        // step 1: compute Laplace for each vertex
-        for (auto v : mesh_.vertices())
+        fused_smoothing(L, A, x, iters, fused_iterations_);
+    }
+    else
+    {
+        for (unsigned int i = 0; i < iters; ++i)
         {
-            Point l(0, 0, 0);
+            const float* source = x[i % 2].data();
+            float* target = x[(i + 1) % 2].data();
+            parallel_for_chunks(n, [&](size_t begin, size_t end) {
+                smooth_rows(L, A, source, target, begin, end);
+            });
+        }
+    }
 
-            if (!mesh_.is_boundary(v))
-            {
-                Scalar w(0);
+    const std::vector<float>& result = x[iters % 2];
+    parallel_for(mesh_.vertices(), [&](Vertex v) {
+        for (int j = 0; j < 3; ++j)
+            points[v][j] = result[4 * v.idx() + j];
+    });
+}
 
-                for (auto h : mesh_.halfedges(v))
-                {
-                    vv = mesh_.to_vertex(h);
-                    e = mesh_.edge(h);
-                    l += eweight[e] * (points[vv] - points[v]);
-                    w += eweight[e];
-                }
+//-----------------------------------------------------------------------------
 
-                l /= w;
-            }
+void SurfaceSmoothing::explicit_smoothing(const std::vector<Vertex>& vertices,
+                                          unsigned int iters,
+                                          bool use_uniform_laplace)
+{
+    // forget the edge weights if the edges or their kind changed
+    if (local_weights_.size() != mesh_.edges_size() ||
+        local_topology_version_ != mesh_.topology_version() ||
+        local_uniform_ != use_uniform_laplace)
+    {
+        local_weights_.assign(mesh_.edges_size(), -1.0);
+        local_topology_version_ = mesh_.topology_version();
+        local_uniform_ = use_uniform_laplace;
+    }
+    if (local_index_.size() < mesh_.vertices_size())
+        local_index_.resize(mesh_.vertices_size(), -1);
 
-            laplace[v] = l;
+    // the smoothed vertices, followed by their fixed neighbors
+    std::vector<Vertex> local;
+    for (auto v : vertices)
+    {
+        if (!mesh_.is_deleted(v) && !mesh_.is_boundary(v) &&
+            !mesh_.is_isolated(v) && local_index_[v.idx()] < 0)
+        {
+            local_index_[v.idx()] = int(local.size());
+            local.push_back(v);
         }
-
-        // step 2: move each vertex by its (damped) Laplacian
-        for (auto v : mesh_.vertices())
+    }
+    const size_t n_free = local.size();
+    for (size_t i = 0; i < n_free; ++i)
+    {
+        for (auto vv : mesh_.vertices(local[i]))
+        {
+            if (local_index_[vv.idx()] < 0)
+            {
+                local_index_[vv.idx()] = int(local.size());
+                local.push_back(vv);
+            }
+        }
+    }
+    const size_t n = local.size();
+
+    // A = I - 0.5 D^-1 L as in explicit_smoothing() for the free rows, the
+    // rows of the fixed vertices are the identity
+    const GeometryCache* cache =
+        use_uniform_laplace ? nullptr : GeometryCache::get(mesh_);
+    CompressedRowMatrix pattern;
+    std::vector<float> A;
+    pattern.n_rows = pattern.n_columns = int(n);
+    pattern.offsets.push_back(0);
+    for (size_t i = 0; i < n; ++i)
+    {
+        const size_t diagonal = A.size();
+        pattern.columns.push_back(int(i));
+        A.push_back(1.0f);
+        if (i < n_free)
         {
-            points[v] += 0.5f * laplace[v];
+            double sum = 0.0;
+            std::vector<double> w;
+            for (auto h : mesh_.halfedges(local[i]))
+            {
+                const Edge e = mesh_.edge(h);
+                double& weight = local_weights_[e.idx()];
+                if (weight < 0.0 && use_uniform_laplace)
+                    weight = 1.0;
+                else if (weight < 0.0)
+                    weight = std::max(0.0, cache ? cache->cotan_weight(e)
+                                                 : cotan_weight(mesh_, e));
+                const Vertex vv = mesh_.to_vertex(h);
+                pattern.columns.push_back(local_index_[vv.idx()]);
+                w.push_back(weight);
+                sum += weight;
+            }
+            for (auto weight : w)
+                A.push_back(sum > 0.0 ? float(0.5 * weight / sum) : 0.0f);
+            if (sum > 0.0)
+                A[diagonal] = 0.5f;
         }
+        pattern.offsets.push_back(int(A.size()));
+    }
+
+    // double-buffered local positions, padded to four floats per vertex
+    auto points = mesh_.get_vertex_property<Point>("v:point");
+    std::vector<float> x[2];
+    x[0].assign(4 * n, 0.0f);
+    x[1].assign(4 * n, 0.0f);
+    for (size_t i = 0; i < n; ++i)
+        for (int j = 0; j < 3; ++j)
+            x[0][4 * i + j] = points[local[i]][j];
+
+    for (unsigned int i = 0; i < iters; ++i)
+    {
+        const float* source = x[i % 2].data();
+        float* target = x[(i + 1) % 2].data();
+        parallel_for_chunks(n, [&](size_t begin, size_t end) {
+            smooth_rows(pattern, A, source, target, begin, end);
+        });
     }
 
-    // clean-up custom properties
-    mesh_.remove_vertex_property(laplace);
+    const std::vector<float>& result = x[iters % 2];
+    for (size_t i = 0; i < n_free; ++i)
+        for (int j = 0; j < 3; ++j)
+            points[local[i]][j] = result[4 * i + j];
+
+    // reset only the touched indices
+    for (auto v : local)
+        local_index_[v.idx()] = -1;
 }
 
 //-----------------------------------------------------------------------------
@@ -165,76 +416,63 @@ void SurfaceSmoothing::implicit_smoothing(Scalar timestep,
     auto points  = mesh_.get_vertex_property<Point>("v:point");
     auto vweight = mesh_.get_vertex_property<Scalar>("v:area");
     auto eweight = mesh_.get_edge_property<Scalar>("e:cotan");
-    auto idx     = mesh_.add_vertex_property<int>("v:idx", -1);
 
     // collect free (non-boundary) vertices in array free_vertices[]
-    // assign indices such that idx[ free_vertices[i] ] == i
-    unsigned i = 0;
+    // assign indices such that index[ free_vertices[i] ] == i
+    std::vector<int> index(mesh_.vertices_size(), -1);
     std::vector<Vertex> free_vertices;
     free_vertices.reserve(mesh_.n_vertices());
     for (auto v : mesh_.vertices())
     {
         if (!mesh_.is_boundary(v))
         {
-            idx[v] = i++;
+            index[v.idx()] = free_vertices.size();
             free_vertices.push_back(v);
         }
     }
     const unsigned int n = free_vertices.size();
 
-    // A*X = B
-    SparseMatrix A(n, n);
-    Eigen::MatrixXd B(n, 3);
-
-    // nonzero elements of A as triplets: (row, column, value)
-    std::vector<Triplet> triplets;
-
-    // setup matrix A and rhs B
-    double ww;
-    Vertex v, vv;
-    Edge e;
+    // Laplace matrix with the edge weights, only its values are recomputed
+    // as long as the connectivity is unchanged
+    std::vector<double> weights(mesh_.edges_size(), 0.0);
+    for (auto e : mesh_.edges())
+        weights[e.idx()] = eweight[e];
+    laplace_.assemble(weights);
+
+    // A = M + timestep * L over the free vertices, fixed boundary
+    // vertices go to the right hand side B
+    CompressedRowMatrix L, F;
+    extract(laplace_.matrix(), index, index, L, F);
+
+    // B and X store the coordinates column by column, the current
+    // positions are the initial guess of iterative solvers
+    std::vector<double> B(3 * n), X(3 * n);
     for (unsigned int i = 0; i < n; ++i)
     {
-        v = free_vertices[i];
-
-        // rhs row
-        B(i, 0) = points[v][0] / vweight[v];
-        B(i, 1) = points[v][1] / vweight[v];
-        B(i, 2) = points[v][2] / vweight[v];
+        const Vertex v = free_vertices[i];
 
-        // lhs row
-        ww = 0.0;
-        for (auto h : mesh_.halfedges(v))
+        for (int j = 0; j < 3; ++j)
         {
-            vv = mesh_.to_vertex(h);
-            e = mesh_.edge(h);
-            ww += eweight[e];
-
-            // fixed boundary vertex -> right hand side
-            if (mesh_.is_boundary(vv))
-            {
-                B(i, 0) -= -timestep * eweight[e] * points[vv][0];
-                B(i, 1) -= -timestep * eweight[e] * points[vv][1];
-                B(i, 2) -= -timestep * eweight[e] * points[vv][2];
-            }
-            // free interior vertex -> matrix
-            else
-            {
-                triplets.emplace_back(i, idx[vv], -timestep * eweight[e]);
-            }
+            B[j * n + i] = points[v][j] / vweight[v];
+            X[j * n + i] = points[v][j];
+        }
+        for (int k = F.offsets[i]; k < F.offsets[i + 1]; ++k)
+        {
+            const Point& p = points[Vertex(F.columns[k])];
+            for (int j = 0; j < 3; ++j)
+                B[j * n + i] -= timestep * F.values[k] * p[j];
         }
 
-        // center vertex -> matrix
-        triplets.emplace_back(i, i, 1.0 / vweight[v] + timestep * ww);
+        for (int k = L.offsets[i]; k < L.offsets[i + 1]; ++k)
+        {
+            L.values[k] *= timestep;
+            if (L.columns[k] == int(i))
+                L.values[k] += 1.0 / vweight[v];
+        }
     }
 
-    // build sparse matrix from triplets
-    A.setFromTriplets(triplets.begin(), triplets.end());
-
-    // solve A*X = B
-    Eigen::SimplicialLDLT<SparseMatrix> solver(A);
-    Eigen::MatrixXd X = solver.solve(B);
-    if (solver.info() != Eigen::Success)
+    // solve A*X = B, the solver keeps its factorization if A is unchanged
+    if (!solver_.compute(L) || !solver_.solve(B, X))
     {
         std::cerr << "SurfaceSmoothing: Could not solve linear system\n";
     }
@@ -243,10 +481,10 @@ void SurfaceSmoothing::implicit_smoothing(Scalar timestep,
         // copy solution
         for (unsigned int i = 0; i < n; ++i)
         {
-            v = free_vertices[i];
-            points[v][0] = X(i, 0);
-            points[v][1] = X(i, 1);
-            points[v][2] = X(i, 2);
+            const Vertex v = free_vertices[i];
+            points[v][0] = X[i];
+            points[v][1] = X[n + i];
+            points[v][2] = X[2 * n + i];
         }
     }
 
@@ -265,10 +503,6 @@ void SurfaceSmoothing::implicit_smoothing(Scalar timestep,
         for (auto v: mesh_.vertices())
             mesh_.position(v) += trans;
     }
-
-
-    // clean-up
-    mesh_.remove_vertex_property(idx);
 }
 
 //=============================================================================
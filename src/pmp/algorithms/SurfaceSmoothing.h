@@ -10,6 +10,8 @@
 //=============================================================================
 
 #include <pmp/SurfaceMesh.h>
+#include <pmp/algorithms/LaplaceMatrix.h>
+#include <pmp/algorithms/SparseSolver.h>
 
 //=============================================================================
 
@@ -35,12 +37,43 @@ public:
 
     //! Perform \p iters iterations of explicit Laplacian smoothing.
     //! Decide whether to use uniform Laplacian or cotan Laplacian (default: cotan).
+    //! The iterations multiply double-buffered positions with a compressed
+    //! row matrix of the weights in parallel.
     void explicit_smoothing(unsigned int iters = 10,
                             bool use_uniform_laplace = false);
 
+    //! \brief Perform \p iters iterations of explicit Laplacian smoothing of
+    //! \p vertices only.
+    //! \details The other vertices and the boundary of the mesh stay fixed.
+    //! The matrix is assembled over \p vertices and their neighbors only, such
+    //! that the cost is proportional to the region instead of the mesh, e.g.,
+    //! for brush strokes on large meshes. The edge weights are computed when
+    //! an edge is first used and are kept for later calls as long as the
+    //! connectivity and \p use_uniform_laplace do not change.
+    void explicit_smoothing(const std::vector<Vertex>& vertices,
+                            unsigned int iters = 10,
+                            bool use_uniform_laplace = false);
+
+    //! \brief Set how many iterations of explicit_smoothing() are fused
+    //! into one pass over the mesh.
+    //! \details With \p iterations > 1, blocks of vertices take up to that
+    //! many iterations while their data is in cache, as far as neighboring
+    //! blocks permit. They run on one thread, which can pay off for many
+    //! iterations on meshes exceeding the cache, whose vertices are ordered
+    //! by locality, see SurfaceReordering. The result does not change. The
+    //! default is 1.
+    void set_fused_iterations(unsigned int iterations)
+    {
+        fused_iterations_ = iterations;
+    }
+
     //! Perform implicit Laplacian smoothing with \p timestep.
     //! Decide whether to use uniform Laplacian or cotan Laplacian (default: cotan).
     //! Decide whether to re-center and re-scale model after smoothing (default: true).
+    //! The factorization of the linear system is kept between calls: its
+    //! symbolic analysis is reused while the sparsity pattern is unchanged,
+    //! and the whole factorization while the matrix is unchanged, e.g., for
+    //! repeated steps with the uniform Laplacian and the same \p timestep.
     void implicit_smoothing(Scalar timestep = 0.001,
                             bool use_uniform_laplace = false,
                             bool rescale = true);
@@ -68,6 +101,23 @@ private:
     // recompute if numbers change (i.e. mesh has changed)
     unsigned int how_many_edge_weights_;
     unsigned int how_many_vertex_weights_;
+
+    // the iterations of explicit smoothing per pass
+    unsigned int fused_iterations_;
+
+    // the Laplace matrix of explicit and implicit smoothing, keeps its sparsity pattern
+    LaplaceMatrix laplace_;
+
+    // the factored system of implicit smoothing
+    SparseSolver solver_;
+
+    // the edge weights of local smoothing, negative until first used
+    std::vector<double> local_weights_;
+    unsigned long local_topology_version_;
+    bool local_uniform_;
+
+    // the local index of each vertex during local smoothing, -1 otherwise
+    std::vector<int> local_index_;
 };
 
 //=============================================================================
@@ -8,15 +8,35 @@
 //=============================================================================
 
 #include <pmp/algorithms/SurfaceSubdivision.h>
+#include <pmp/Parallel.h>
 #include <pmp/Timer.h>
 
+#include <algorithm>
+#include <utility>
+
 //=============================================================================
 
 namespace pmp {
 
 //=============================================================================
 
-SurfaceSubdivision::SurfaceSubdivision(SurfaceMesh& mesh) : mesh_(mesh)
+namespace {
+
+// remove deleted elements, such that the new indices follow from the old
+void collect_garbage(SurfaceMesh& mesh)
+{
+    if (mesh.n_vertices() != mesh.vertices_size() ||
+        mesh.n_edges() != mesh.edges_size() ||
+        mesh.n_faces() != mesh.faces_size())
+        mesh.garbage_collection();
+}
+
+} // namespace
+
+//=============================================================================
+
+SurfaceSubdivision::SurfaceSubdivision(SurfaceMesh& mesh)
+    : mesh_(mesh), bulk_refinement_(false)
 {
     points_ = mesh_.vertex_property<Point>("v:point");
     vfeature_ = mesh_.get_vertex_property<bool>("v:feature");
@@ -25,13 +45,40 @@ SurfaceSubdivision::SurfaceSubdivision(SurfaceMesh& mesh) : mesh_(mesh)
 
 //-----------------------------------------------------------------------------
 
+void SurfaceSubdivision::split_connectivity(bool quads)
+{
+    const IndexType nv = mesh_.vertices_size();
+    std::vector<bool> features;
+    if (efeature_)
+        for (auto e : mesh_.edges())
+            features.push_back(efeature_[e]);
+
+    if (!mesh_.subdivide_connectivity(quads))
+        return;
+
+    // features are split with their edges
+    for (IndexType e = 0; e < features.size(); ++e)
+        if (features[e])
+        {
+            efeature_[Edge(2 * e)] = efeature_[Edge(2 * e + 1)] = true;
+            if (vfeature_)
+                vfeature_[Vertex(nv + e)] = true;
+        }
+}
+
+//-----------------------------------------------------------------------------
+
 void SurfaceSubdivision::catmull_clark()
 {
+    if (bulk_refinement_)
+        collect_garbage(mesh_);
+
     // reserve memory
     size_t nv = mesh_.n_vertices();
     size_t ne = mesh_.n_edges();
     size_t nf = mesh_.n_faces();
-    mesh_.reserve(nv + ne + nf, 2 * ne + 4 * nf, 4 * nf);
+    if (!bulk_refinement_)
+        mesh_.reserve(nv + ne + nf, 2 * ne + 4 * nf, 4 * nf);
 
     // get properties
     auto vpoint = mesh_.add_vertex_property<Point>("catmull:vpoint");
@@ -39,8 +86,7 @@ void SurfaceSubdivision::catmull_clark()
     auto fpoint = mesh_.add_face_property<Point>("catmull:fpoint");
 
     // compute face vertices
-    for (auto f : mesh_.faces())
-    {
+    parallel_for(mesh_.faces(), [&](Face f) {
         Point p(0, 0, 0);
         Scalar c(0);
         for (auto v : mesh_.vertices(f))
@@ -50,11 +96,10 @@ void SurfaceSubdivision::catmull_clark()
         }
         p /= c;
         fpoint[f] = p;
-    }
+    });
 
     // compute edge vertices
-    for (auto e : mesh_.edges())
-    {
+    parallel_for(mesh_.edges(), [&](Edge e) {
         // boundary or feature edge?
         if (mesh_.is_boundary(e) || (efeature_ && efeature_[e]))
         {
@@ -73,11 +118,10 @@ void SurfaceSubdivision::catmull_clark()
             p *= 0.25f;
             epoint[e] = p;
         }
-    }
+    });
 
     // compute new positions for old vertices
-    for (auto v : mesh_.vertices())
-    {
+    parallel_for(mesh_.vertices(), [&](Vertex v) {
         // isolated vertex?
         if (mesh_.is_isolated(v))
         {
@@ -146,6 +190,26 @@ void SurfaceSubdivision::catmull_clark()
 
             vpoint[v] = p;
         }
+    });
+
+    if (bulk_refinement_)
+    {
+        std::vector<Point> positions(nv + ne + nf);
+        parallel_for(0, nv, [&](size_t i) {
+            positions[i] = vpoint[Vertex(i)];
+        });
+        parallel_for(0, ne, [&](size_t i) {
+            positions[nv + i] = epoint[Edge(i)];
+        });
+        parallel_for(0, nf, [&](size_t i) {
+            positions[nv + ne + i] = fpoint[Face(i)];
+        });
+        split_connectivity(true);
+        points_.vector().swap(positions);
+        mesh_.remove_vertex_property(vpoint);
+        mesh_.remove_edge_property(epoint);
+        mesh_.remove_face_property(fpoint);
+        return;
     }
 
     // assign new positions to old vertices
@@ -204,6 +268,103 @@ void SurfaceSubdivision::catmull_clark()
 
 //-----------------------------------------------------------------------------
 
+Point SurfaceSubdivision::loop_vertex_point(Vertex v) const
+{
+    // isolated vertex?
+    if (mesh_.is_isolated(v))
+    {
+        return points_[v];
+    }
+
+    // boundary vertex?
+    else if (mesh_.is_boundary(v))
+    {
+        auto h1 = mesh_.halfedge(v);
+        auto h0 = mesh_.prev_halfedge(h1);
+
+        Point p = points_[v];
+        p *= 6.0;
+        p += points_[mesh_.to_vertex(h1)];
+        p += points_[mesh_.from_vertex(h0)];
+        p *= 0.125;
+        return p;
+    }
+
+    // interior feature vertex?
+    else if (vfeature_ && vfeature_[v])
+    {
+        Point p = points_[v];
+        p *= 6.0;
+        int count(0);
+
+        for (auto h : mesh_.halfedges(v))
+        {
+            if (efeature_[mesh_.edge(h)])
+            {
+                p += points_[mesh_.to_vertex(h)];
+                ++count;
+            }
+        }
+
+        if (count == 2) // vertex is on feature edge
+        {
+            p *= 0.125;
+            return p;
+        }
+        else // keep fixed
+        {
+            return points_[v];
+        }
+    }
+
+    // interior vertex
+    else
+    {
+        Point p(0, 0, 0);
+        Scalar k(0);
+
+        for (auto vv : mesh_.vertices(v))
+        {
+            p += points_[vv];
+            ++k;
+        }
+        p /= k;
+
+        Scalar beta =
+            (0.625 - pow(0.375 + 0.25 * cos(2.0 * M_PI / k), 2.0));
+
+        return points_[v] * (Scalar)(1.0 - beta) + beta * p;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+Point SurfaceSubdivision::loop_edge_point(Edge e) const
+{
+    // boundary or feature edge?
+    if (mesh_.is_boundary(e) || (efeature_ && efeature_[e]))
+    {
+        return (points_[mesh_.vertex(e, 0)] + points_[mesh_.vertex(e, 1)]) *
+               Scalar(0.5);
+    }
+
+    // interior edge
+    else
+    {
+        auto h0 = mesh_.halfedge(e, 0);
+        auto h1 = mesh_.halfedge(e, 1);
+        Point p = points_[mesh_.to_vertex(h0)];
+        p += points_[mesh_.to_vertex(h1)];
+        p *= 3.0;
+        p += points_[mesh_.to_vertex(mesh_.next_halfedge(h0))];
+        p += points_[mesh_.to_vertex(mesh_.next_halfedge(h1))];
+        p *= 0.125;
+        return p;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
 void SurfaceSubdivision::loop()
 {
     Timer t;
@@ -211,126 +372,292 @@ void SurfaceSubdivision::loop()
 
     if (!mesh_.is_triangle_mesh())
         return;
+    if (bulk_refinement_)
+        collect_garbage(mesh_);
 
     // reserve memory
     size_t nv = mesh_.n_vertices();
     size_t ne = mesh_.n_edges();
     size_t nf = mesh_.n_faces();
-    mesh_.reserve(nv + ne, 2 * ne + 3 * nf, 4 * nf);
+    if (!bulk_refinement_)
+        mesh_.reserve(nv + ne, 2 * ne + 3 * nf, 4 * nf);
 
     // add properties
     auto vpoint = mesh_.add_vertex_property<Point>("loop:vpoint");
     auto epoint = mesh_.add_edge_property<Point>("loop:epoint");
 
     // compute vertex positions
-    for (auto v : mesh_.vertices())
-    {
-        // isolated vertex?
-        if (mesh_.is_isolated(v))
-        {
-            vpoint[v] = points_[v];
-        }
+    parallel_for(mesh_.vertices(),
+                 [&](Vertex v) { vpoint[v] = loop_vertex_point(v); });
 
-        // boundary vertex?
-        else if (mesh_.is_boundary(v))
-        {
-            auto h1 = mesh_.halfedge(v);
-            auto h0 = mesh_.prev_halfedge(h1);
+    // compute edge positions
+    parallel_for(mesh_.edges(),
+                 [&](Edge e) { epoint[e] = loop_edge_point(e); });
 
-            Point p = points_[v];
-            p *= 6.0;
-            p += points_[mesh_.to_vertex(h1)];
-            p += points_[mesh_.from_vertex(h0)];
-            p *= 0.125;
-            vpoint[v] = p;
+    if (bulk_refinement_)
+    {
+        std::vector<Point> positions(nv + ne);
+        parallel_for(0, nv, [&](size_t i) {
+            positions[i] = vpoint[Vertex(i)];
+        });
+        parallel_for(0, ne, [&](size_t i) {
+            positions[nv + i] = epoint[Edge(i)];
+        });
+        split_connectivity(false);
+        points_.vector().swap(positions);
+    }
+    else
+    {
+        // set new vertex positions
+        for (auto v : mesh_.vertices())
+        {
+            points_[v] = vpoint[v];
         }
 
-        // interior feature vertex?
-        else if (vfeature_ && vfeature_[v])
+        // insert new vertices on edges
+        for (auto e : mesh_.edges())
         {
-            Point p = points_[v];
-            p *= 6.0;
-            int count(0);
-
-            for (auto h : mesh_.halfedges(v))
+            // feature edge?
+            if (efeature_ && efeature_[e])
             {
-                if (efeature_[mesh_.edge(h)])
-                {
-                    p += points_[mesh_.to_vertex(h)];
-                    ++count;
-                }
+                auto h = mesh_.insert_vertex(e, epoint[e]);
+                auto v = mesh_.to_vertex(h);
+                auto e0 = mesh_.edge(h);
+                auto e1 = mesh_.edge(mesh_.next_halfedge(h));
+
+                vfeature_[v] = true;
+                efeature_[e0] = true;
+                efeature_[e1] = true;
             }
 
-            if (count == 2) // vertex is on feature edge
-            {
-                p *= 0.125;
-                vpoint[v] = p;
-            }
-            else // keep fixed
+            // normal edge
+            else
             {
-                vpoint[v] = points_[v];
+                mesh_.insert_vertex(e, epoint[e]);
             }
         }
 
-        // interior vertex
-        else
+        // split faces
+        Halfedge h;
+        for (auto f : mesh_.faces())
         {
-            Point p(0, 0, 0);
-            Scalar k(0);
+            h = mesh_.halfedge(f);
+            mesh_.insert_edge(h, mesh_.next_halfedge(mesh_.next_halfedge(h)));
+            h = mesh_.next_halfedge(h);
+            mesh_.insert_edge(h, mesh_.next_halfedge(mesh_.next_halfedge(h)));
+            h = mesh_.next_halfedge(h);
+            mesh_.insert_edge(h, mesh_.next_halfedge(mesh_.next_halfedge(h)));
+        }
+    }
 
-            for (auto vv : mesh_.vertices(v))
+    // clean-up properties
+    mesh_.remove_vertex_property(vpoint);
+    mesh_.remove_edge_property(epoint);
+
+    t.stop();
+    std::cout << "subdiv took " << t.elapsed() << std::endl;
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceSubdivision::adaptive_loop()
+{
+    auto selected = mesh_.get_face_property<bool>("f:selected");
+    if (!selected)
+    {
+        std::cerr << "SurfaceSubdivision: No faces selected\n";
+        return;
+    }
+    refine_adaptively(selected);
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceSubdivision::adaptive_loop(Scalar max_error)
+{
+    if (!mesh_.is_triangle_mesh())
+        return;
+
+    // select the faces around vertices and edge midpoints that a Loop step
+    // would move by more than max_error
+    auto selected = mesh_.add_face_property<bool>("subdivision:selected");
+    for (auto v : mesh_.vertices())
+        if (norm(loop_vertex_point(v) - points_[v]) > max_error)
+            for (auto f : mesh_.faces(v))
+                selected[f] = true;
+    for (auto e : mesh_.edges())
+    {
+        const Point midpoint =
+            (points_[mesh_.vertex(e, 0)] + points_[mesh_.vertex(e, 1)]) *
+            Scalar(0.5);
+        if (norm(loop_edge_point(e) - midpoint) > max_error)
+            for (int i = 0; i < 2; ++i)
             {
-                p += points_[vv];
-                ++k;
+                auto f = mesh_.face(mesh_.halfedge(e, i));
+                if (f.is_valid())
+                    selected[f] = true;
             }
-            p /= k;
+    }
+
+    refine_adaptively(selected);
+    mesh_.remove_face_property(selected);
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceSubdivision::refine_adaptively(FaceProperty<bool> selected)
+{
+    if (!mesh_.is_triangle_mesh())
+        return;
+
+    // the halfedge from the apex to the split vertex of the bisector of
+    // each pair of transition triangles
+    auto transition = mesh_.halfedge_property<bool>("h:transition", false);
+    auto transition_halfedge = [&](Face f) {
+        for (auto h : mesh_.halfedges(f))
+        {
+            if (transition[h])
+                return h;
+            if (transition[mesh_.opposite_halfedge(h)])
+                return mesh_.opposite_halfedge(h);
+        }
+        return Halfedge();
+    };
+
+    // mark the edges to split, starting from the selected faces
+    std::vector<char> marked(mesh_.edges_size(), 0);
+    std::vector<Face> queue;
+    auto mark = [&](Edge e) {
+        if (marked[e.idx()])
+            return;
+        marked[e.idx()] = 1;
+        for (int i = 0; i < 2; ++i)
+        {
+            auto f = mesh_.face(mesh_.halfedge(e, i));
+            if (f.is_valid())
+                queue.push_back(f);
+        }
+    };
+    for (auto f : mesh_.faces())
+        if (selected[f])
+            queue.push_back(f);
 
-            Scalar beta =
-                (0.625 - pow(0.375 + 0.25 * cos(2.0 * M_PI / k), 2.0));
+    // close the marks: faces with two marked edges get split into four,
+    // and a pair of transition triangles with a marked or selected member
+    // is split into four like the triangle it bisects
+    while (!queue.empty())
+    {
+        const Face f = queue.back();
+        queue.pop_back();
 
-            vpoint[v] = points_[v] * (Scalar)(1.0 - beta) + beta * p;
+        const Halfedge h = transition_halfedge(f);
+        if (h.is_valid())
+        {
+            const Halfedge o = mesh_.opposite_halfedge(h);
+            bool touched = selected[mesh_.face(h)] || selected[mesh_.face(o)];
+            for (auto hh : {mesh_.next_halfedge(h), mesh_.prev_halfedge(h),
+                            mesh_.next_halfedge(o), mesh_.prev_halfedge(o)})
+                touched = touched || marked[mesh_.edge(hh).idx()];
+            if (touched)
+            {
+                mark(mesh_.edge(mesh_.prev_halfedge(h)));
+                mark(mesh_.edge(mesh_.next_halfedge(o)));
+            }
+        }
+        else
+        {
+            int n_marked = 0;
+            for (auto fh : mesh_.halfedges(f))
+                n_marked += marked[mesh_.edge(fh).idx()];
+            if (selected[f] || n_marked >= 2)
+                for (auto fh : mesh_.halfedges(f))
+                    mark(mesh_.edge(fh));
         }
     }
 
-    // compute edge positions
-    for (auto e : mesh_.edges())
+    // split into four, bisected, and split transition pairs
+    std::vector<char> red(mesh_.faces_size(), 0);
+    std::vector<Face> reds, greens;
+    std::vector<Halfedge> pairs;
+    for (auto f : mesh_.faces())
     {
-        // boundary or feature edge?
-        if (mesh_.is_boundary(e) || (efeature_ && efeature_[e]))
+        const Halfedge h = transition_halfedge(f);
+        if (h.is_valid())
         {
-            epoint[e] =
-                (points_[mesh_.vertex(e, 0)] + points_[mesh_.vertex(e, 1)]) *
-                Scalar(0.5);
+            if (mesh_.face(h) == f &&
+                marked[mesh_.edge(mesh_.prev_halfedge(h)).idx()])
+                pairs.push_back(h);
+            continue;
         }
 
-        // interior edge
-        else
+        int n_marked = 0;
+        for (auto fh : mesh_.halfedges(f))
+            n_marked += marked[mesh_.edge(fh).idx()];
+        if (n_marked == 3)
         {
-            auto h0 = mesh_.halfedge(e, 0);
-            auto h1 = mesh_.halfedge(e, 1);
-            Point p = points_[mesh_.to_vertex(h0)];
-            p += points_[mesh_.to_vertex(h1)];
-            p *= 3.0;
-            p += points_[mesh_.to_vertex(mesh_.next_halfedge(h0))];
-            p += points_[mesh_.to_vertex(mesh_.next_halfedge(h1))];
-            p *= 0.125;
-            epoint[e] = p;
+            red[f.idx()] = 1;
+            reds.push_back(f);
+        }
+        else if (n_marked == 1)
+        {
+            greens.push_back(f);
         }
     }
 
-    // set new vertex positions
-    for (auto v : mesh_.vertices())
+    // Loop rules where the whole stencil gets split into four, edges next
+    // to transitions are split at their midpoints
+    std::vector<char> visited(mesh_.vertices_size(), 0);
+    std::vector<std::pair<Vertex, Point>> vpoints;
+    for (auto f : reds)
+        for (auto v : mesh_.vertices(f))
+        {
+            if (visited[v.idx()])
+                continue;
+            visited[v.idx()] = 1;
+
+            bool smooth = true;
+            for (auto vf : mesh_.faces(v))
+                smooth = smooth && red[vf.idx()];
+            if (smooth)
+                vpoints.emplace_back(v, loop_vertex_point(v));
+        }
+
+    std::vector<std::pair<Edge, Point>> epoints;
+    for (auto e : mesh_.edges())
     {
-        points_[v] = vpoint[v];
+        if (!marked[e.idx()])
+            continue;
+
+        bool smooth = true;
+        for (int i = 0; i < 2; ++i)
+        {
+            auto f = mesh_.face(mesh_.halfedge(e, i));
+            smooth = smooth && (!f.is_valid() || red[f.idx()]);
+        }
+        epoints.emplace_back(
+            e, smooth ? loop_edge_point(e)
+                      : (points_[mesh_.vertex(e, 0)] +
+                         points_[mesh_.vertex(e, 1)]) *
+                            Scalar(0.5));
     }
 
+    for (auto& vp : vpoints)
+        points_[vp.first] = vp.second;
+
+    // reserve memory: one vertex and edge per split edge, three edges and
+    // faces per red face, one per green face, and up to four per pair
+    const size_t n_cuts = 3 * reds.size() + greens.size() + 4 * pairs.size();
+    mesh_.reserve(mesh_.vertices_size() + epoints.size(),
+                  mesh_.edges_size() + epoints.size() + n_cuts,
+                  mesh_.faces_size() + n_cuts);
+
     // insert new vertices on edges
-    for (auto e : mesh_.edges())
+    const size_t nv = mesh_.vertices_size();
+    for (auto& ep : epoints)
     {
-        // feature edge?
-        if (efeature_ && efeature_[e])
+        auto h = mesh_.insert_vertex(ep.first, ep.second);
+        if (efeature_ && efeature_[ep.first])
         {
-            auto h = mesh_.insert_vertex(e, epoint[e]);
             auto v = mesh_.to_vertex(h);
             auto e0 = mesh_.edge(h);
             auto e1 = mesh_.edge(mesh_.next_halfedge(h));
@@ -339,43 +666,84 @@ void SurfaceSubdivision::loop()
             efeature_[e0] = true;
             efeature_[e1] = true;
         }
-
-        // normal edge
-        else
-        {
-            mesh_.insert_vertex(e, epoint[e]);
-        }
     }
 
-    // split faces
-    Halfedge h;
-    for (auto f : mesh_.faces())
+    // the first halfedge of f ending in a new vertex
+    auto split_halfedge = [&](Face f) {
+        for (auto h : mesh_.halfedges(f))
+            if (mesh_.to_vertex(h).idx() >= nv)
+                return h;
+        return Halfedge();
+    };
+
+    // cut off the corner after h, faces split from selected ones stay
+    // selected
+    auto cut = [&](Halfedge h, bool select) {
+        h = mesh_.insert_edge(h, mesh_.next_halfedge(mesh_.next_halfedge(h)));
+        if (select)
+            selected[mesh_.face(h)] =
+                selected[mesh_.face(mesh_.opposite_halfedge(h))] = true;
+        return h;
+    };
+
+    // bisect the quad after h from its new vertex to the opposite corner
+    auto bisect = [&](Halfedge h) {
+        h = mesh_.insert_edge(h, mesh_.next_halfedge(mesh_.next_halfedge(h)));
+        transition[mesh_.opposite_halfedge(h)] = true;
+    };
+
+    for (auto f : reds)
     {
-        h = mesh_.halfedge(f);
-        mesh_.insert_edge(h, mesh_.next_halfedge(mesh_.next_halfedge(h)));
-        h = mesh_.next_halfedge(h);
-        mesh_.insert_edge(h, mesh_.next_halfedge(mesh_.next_halfedge(h)));
-        h = mesh_.next_halfedge(h);
-        mesh_.insert_edge(h, mesh_.next_halfedge(mesh_.next_halfedge(h)));
+        Halfedge h = split_halfedge(f);
+        for (int i = 0; i < 3; ++i)
+            h = cut(h, selected[f]);
     }
 
-    // clean-up properties
-    mesh_.remove_vertex_property(vpoint);
-    mesh_.remove_edge_property(epoint);
+    for (auto f : greens)
+        bisect(split_halfedge(f));
 
-    t.stop();
-    std::cout << "subdiv took " << t.elapsed() << std::endl;
+    // split the triangle bisected by a pair into four: connect the split
+    // vertex to the new vertices and flip the bisector between them,
+    // which leaves quads behind if the halves got split as well
+    for (auto h : pairs)
+    {
+        const Halfedge o = mesh_.opposite_halfedge(h);
+        const bool select = selected[mesh_.face(h)] || selected[mesh_.face(o)];
+        transition[h] = transition[o] = false;
+
+        Halfedge h0 = mesh_.insert_edge(
+            h, mesh_.prev_halfedge(mesh_.prev_halfedge(h)));
+        Halfedge h1 = mesh_.insert_edge(mesh_.prev_halfedge(o),
+                                        mesh_.next_halfedge(o));
+        for (auto hh : {h0, h1})
+            if (select)
+                selected[mesh_.face(hh)] =
+                    selected[mesh_.face(mesh_.opposite_halfedge(hh))] = true;
+
+        h0 = mesh_.opposite_halfedge(h0);
+        if (mesh_.valence(mesh_.face(h0)) == 4)
+            bisect(mesh_.next_halfedge(h0));
+        if (mesh_.valence(mesh_.face(h1)) == 4)
+            bisect(mesh_.next_halfedge(mesh_.next_halfedge(h1)));
+
+        if (mesh_.is_flip_ok(mesh_.edge(h)))
+            mesh_.flip(mesh_.edge(h));
+    }
 }
 
 //-----------------------------------------------------------------------------
 
 void SurfaceSubdivision::sqrt3()
 {
+    if (bulk_refinement_)
+        collect_garbage(mesh_);
+
     // reserve memory
     int nv = mesh_.n_vertices();
     int ne = mesh_.n_edges();
     int nf = mesh_.n_faces();
-    mesh_.reserve(nv + nf, ne + 3 * nf, 3 * nf);
+    if (!bulk_refinement_)
+        mesh_.reserve(nv + nf, ne + 3 * nf, 3 * nf);
 
     auto points = mesh_.vertex_property<Point>("v:point");
 
@@ -385,8 +753,7 @@ void SurfaceSubdivision::sqrt3()
 
     // compute new positions of old vertices
     auto new_pos = mesh_.add_vertex_property<Point>("v:np");
-    for (auto v : mesh_.vertices())
-    {
+    parallel_for(mesh_.vertices(), [&](Vertex v) {
         if (!mesh_.is_boundary(v))
         {
             Scalar n = mesh_.valence(v);
@@ -399,6 +766,32 @@ void SurfaceSubdivision::sqrt3()
             p = (1.0f - alpha) * points_[v] + alpha / n * p;
             new_pos[v] = p;
         }
+    });
+
+    if (bulk_refinement_)
+    {
+        std::vector<Point> positions(nv + nf);
+        parallel_for(0, nv, [&](size_t i) {
+            const Vertex v(i);
+            positions[i] = mesh_.is_boundary(v) ? points_[v] : new_pos[v];
+        });
+        parallel_for(0, nf, [&](size_t i) {
+            Point p(0, 0, 0);
+            Scalar c(0);
+            for (auto fv : mesh_.vertices(Face(i)))
+            {
+                p += points_[fv];
+                ++c;
+            }
+            positions[nv + i] = p / c;
+        });
+
+        if (mesh_.sqrt3_connectivity())
+        {
+            points_.vector().swap(positions);
+            mesh_.remove_vertex_property(new_pos);
+            return;
+        }
     }
 
     // split faces
@@ -11,6 +11,8 @@
 
 #include <pmp/SurfaceMesh.h>
 
+#include <vector>
+
 //=============================================================================
 
 namespace pmp {
@@ -36,15 +38,57 @@ public:
     //! See \cite loop_1987_smooth for details.
     void loop();
 
+    //! \brief Perform one step of Loop subdivision on the faces in the
+    //! "f:selected" property only.
+    //! \details Neighboring faces are split into four as well where two of
+    //! their edges get split, or bisected where one edge gets split. The
+    //! bisectors are marked in "h:transition", and once a later step
+    //! touches a bisected pair, the original triangle is split into four
+    //! instead, such that the triangle quality does not degrade. The Loop
+    //! rules apply where all faces of a stencil get split into four.
+    //! Vertices at the border of the refined region stay fixed, and edges
+    //! next to transitions are split at their midpoints. Faces split from
+    //! selected faces stay selected. Does nothing for meshes which are not
+    //! triangle meshes. The connectivity changes of other algorithms
+    //! invalidate "h:transition", remove the property then.
+    void adaptive_loop();
+
+    //! \brief Perform one step of adaptive_loop() on the faces around
+    //! vertices and edge midpoints that a Loop step would move by more than
+    //! \p max_error.
+    void adaptive_loop(Scalar max_error);
+
     //! Perform one step of sqrt3 subdivision.
     //! See \cite kobbelt_2000_sqrt for details.
     void sqrt3();
 
+    //! \brief Compute the refined connectivity in bulk instead of
+    //! splitting edges and faces one by one.
+    //! \details The new halfedges, edges, and faces follow from the old
+    //! ones by index arithmetic, per face in parallel. The vertex properties
+    //! are kept for the old vertices, all other properties except
+    //! "e:feature" are reset to their default values. Both modes give the
+    //! same positions: the old vertices keep their indices, followed by one
+    //! vertex per edge or face in index order. Default is false.
+    void set_bulk_refinement(bool bulk) { bulk_refinement_ = bulk; }
+
 private:
+    // the Loop rules for the vertex v and the new vertex on the edge e
+    Point loop_vertex_point(Vertex v) const;
+    Point loop_edge_point(Edge e) const;
+
+    // adaptive_loop() on the faces in selected
+    void refine_adaptively(FaceProperty<bool> selected);
+
+    // SurfaceMesh::subdivide_connectivity(), splitting the features with
+    // their edges
+    void split_connectivity(bool quads);
+
     SurfaceMesh& mesh_;
     VertexProperty<Point> points_;
     VertexProperty<bool> vfeature_;
     EdgeProperty<bool> efeature_;
+    bool bulk_refinement_;
 };
 
 //=============================================================================
@@ -0,0 +1,251 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/algorithms/SurfaceTiles.h>
+#include <pmp/algorithms/SurfaceCurvature.h>
+#include <pmp/algorithms/SurfaceNormals.h>
+#include <pmp/BoundingBox.h>
+#include <pmp/TaskGraph.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <numeric>
+#include <unordered_map>
+#include <unordered_set>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+namespace {
+
+// seek to a 64-bit file offset
+bool seek(FILE* file, uint64_t offset)
+{
+#ifdef _WIN32
+    return _fseeki64(file, (__int64)offset, SEEK_SET) == 0;
+#else
+    return fseeko(file, (off_t)offset, SEEK_SET) == 0;
+#endif
+}
+
+} // namespace
+
+//=============================================================================
+
+SurfaceTiles::SurfaceTiles(const MappedSurfaceMesh& mesh,
+                           size_t tile_vertices)
+    : mesh_(mesh), max_in_flight_(0)
+{
+    vertices_.resize(mesh_.n_vertices());
+    std::iota(vertices_.begin(), vertices_.end(), 0);
+    tile_begin_.push_back(0);
+    if (!vertices_.empty())
+        split(0, vertices_.size(), std::max(tile_vertices, size_t(1)));
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceTiles::split(size_t begin, size_t end, size_t tile_vertices)
+{
+    auto first = vertices_.begin() + begin, last = vertices_.begin() + end;
+    if (end - begin <= tile_vertices)
+    {
+        // the vertices of a tile in index order, for writing runs of them
+        std::sort(first, last);
+        tile_begin_.push_back(end);
+        return;
+    }
+
+    // bisect at the median of the longest side of the bounding box
+    BoundingBox bb;
+    for (auto it = first; it != last; ++it)
+        bb += mesh_.position(Vertex(*it));
+    const Point size = bb.max() - bb.min();
+    const int axis = (size[0] >= size[1] && size[0] >= size[2])
+                         ? 0
+                         : (size[1] >= size[2] ? 1 : 2);
+    const size_t middle = begin + (end - begin) / 2;
+    std::nth_element(first, vertices_.begin() + middle, last,
+                     [&](IndexType a, IndexType b) {
+                         return mesh_.position(Vertex(a))[axis] <
+                                mesh_.position(Vertex(b))[axis];
+                     });
+    split(begin, middle, tile_vertices);
+    split(middle, end, tile_vertices);
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceTiles::extract(size_t i, unsigned int halo,
+                           SurfaceMesh& tile) const
+{
+    // number the vertices of the tile first
+    std::vector<IndexType> global(vertices_.begin() + tile_begin_[i],
+                                  vertices_.begin() + tile_begin_[i + 1]);
+    std::unordered_map<IndexType, IndexType> local;
+    local.reserve(2 * global.size());
+    for (IndexType j = 0; j < global.size(); ++j)
+        local[global[j]] = j;
+
+    // the faces of the tile's vertices, then the rings around them, with
+    // the vertices in the order of their first use
+    std::unordered_set<IndexType> in_copy;
+    std::vector<IndexType> indices, face_sizes;
+    size_t ring_begin = 0;
+    for (unsigned int ring = 0; ring <= halo; ++ring)
+    {
+        const size_t ring_end = global.size();
+        for (size_t j = ring_begin; j < ring_end; ++j)
+        {
+            const Halfedge h0 = mesh_.halfedge(Vertex(global[j]));
+            if (!h0.is_valid())
+                continue;
+
+            Halfedge h = h0;
+            do
+            {
+                const Face f = mesh_.face(h);
+                if (f.is_valid() && in_copy.insert(f.idx()).second)
+                {
+                    const Halfedge g0 = mesh_.halfedge(f);
+                    Halfedge g = g0;
+                    IndexType size = 0;
+                    do
+                    {
+                        const IndexType v = mesh_.to_vertex(g).idx();
+                        auto inserted = local.insert(
+                            std::make_pair(v, IndexType(global.size())));
+                        if (inserted.second)
+                            global.push_back(v);
+                        indices.push_back(inserted.first->second);
+                        ++size;
+                        g = mesh_.next_halfedge(g);
+                    } while (g != g0);
+                    face_sizes.push_back(size);
+                }
+                h = mesh_.next_halfedge(mesh_.opposite_halfedge(h));
+            } while (h != h0);
+        }
+        ring_begin = ring_end;
+    }
+
+    std::vector<Point> positions;
+    positions.reserve(global.size());
+    for (auto v : global)
+        positions.push_back(mesh_.position(Vertex(v)));
+    if (!tile.build_from_indices(positions, indices, face_sizes))
+    {
+        std::cerr << "SurfaceTiles: tile " << i << " is not manifold"
+                  << std::endl;
+        return false;
+    }
+
+    auto vglobal = tile.vertex_property<IndexType>("v:global");
+    for (IndexType j = 0; j < global.size(); ++j)
+        vglobal[Vertex(j)] = global[j];
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceTiles::process(
+    const std::string& filename, unsigned int halo, size_t value_size,
+    const std::function<void(SurfaceMesh&, size_t, char*)>& compute) const
+{
+    FILE* out = fopen(filename.c_str(), "wb");
+    if (!out)
+        return false;
+
+    // the values of the tiles in flight
+    std::vector<std::vector<char>> values(n_tiles());
+    std::atomic<bool> ok(true);
+
+    Pipeline pipeline;
+    auto tile_stage = pipeline.add_stage([&](size_t i) {
+        SurfaceMesh tile;
+        if (!extract(i, halo, tile))
+        {
+            ok = false;
+            return;
+        }
+        values[i].resize(tile_size(i) * value_size);
+        compute(tile, tile_size(i), values[i].data());
+    });
+
+    // write runs of consecutive vertices, on the IO thread
+    pipeline.add_stage(
+        [&](size_t i) {
+            const size_t begin = tile_begin_[i], end = tile_begin_[i + 1];
+            const char* data = values[i].data();
+            for (size_t j = begin; j < end && !values[i].empty();)
+            {
+                size_t k = j + 1;
+                while (k < end && vertices_[k] == vertices_[k - 1] + 1)
+                    ++k;
+                if (!seek(out, uint64_t(vertices_[j]) * value_size) ||
+                    fwrite(data + (j - begin) * value_size, value_size, k - j,
+                           out) != k - j)
+                    ok = false;
+                j = k;
+            }
+            std::vector<char>().swap(values[i]);
+        },
+        {tile_stage}, TaskKind::IO);
+
+    pipeline.run(n_tiles(), max_in_flight_);
+
+    if (fclose(out) != 0)
+        ok = false;
+    return ok;
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceTiles::vertex_normals(const std::string& filename) const
+{
+    return vertex_property<Normal>(filename, 0, [](SurfaceMesh& tile) {
+        SurfaceNormals::compute_vertex_normals(tile);
+        return tile.get_vertex_property<Normal>("v:normal");
+    });
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceTiles::curvature(const std::string& filename,
+                             unsigned int smoothing_steps, bool tensor) const
+{
+    // boundary vertices interpolate their neighbors, and the tensor
+    // averages over the edges of the one-ring
+    const unsigned int halo = smoothing_steps + (tensor ? 2 : 1);
+
+    typedef Vector<Scalar, 2> Curvature;
+    return vertex_property<Curvature>(
+        filename, halo, [&](SurfaceMesh& tile) {
+            SurfaceCurvature analyzer(tile);
+            if (tensor)
+                analyzer.analyze_tensor(smoothing_steps);
+            else
+                analyzer.analyze(smoothing_steps);
+
+            auto curvature = tile.vertex_property<Curvature>("v:curvature");
+            for (auto v : tile.vertices())
+                curvature[v] = Curvature(analyzer.min_curvature(v),
+                                         analyzer.max_curvature(v));
+            return curvature;
+        });
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
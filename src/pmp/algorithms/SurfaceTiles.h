@@ -0,0 +1,143 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <pmp/MappedSurfaceMesh.h>
+#include <pmp/SurfaceMesh.h>
+
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \addtogroup algorithms algorithms
+//! @{
+
+//=============================================================================
+
+//! \brief Compute per-vertex quantities of meshes that do not fit into
+//! memory, tile by tile.
+//! \details The mesh is a .pmp file mapped by MappedSurfaceMesh, whose pages
+//! are loaded from disk when touched and can be evicted again. Its vertices
+//! are split into spatial tiles by recursive coordinate bisection. Each tile
+//! is copied into a SurfaceMesh together with the faces of its vertices and
+//! rings of halo faces around them, such that the tile's vertices get the
+//! same values as in the whole mesh. The tiles are processed concurrently,
+//! at most set_max_in_flight() at a time, and the values of each tile are
+//! written to the output file as soon as it is done. The memory used is
+//! bounded by the tile size and four bytes per vertex for the tiling. The
+//! output files store one value per vertex in the order of the vertices,
+//! without a header, e.g., to be mapped. Usage:
+//! \code
+//! MappedSurfaceMesh mapped;
+//! mapped.open("large.pmp");
+//! SurfaceTiles tiles(mapped, 1000000);
+//! tiles.vertex_normals("normals.bin");
+//! tiles.curvature("curvature.bin", 2);
+//! \endcode
+class SurfaceTiles
+{
+public:
+    //! \brief Split the vertices of \p mesh into tiles of at most
+    //! \p tile_vertices vertices.
+    //! \details \p mesh has to stay open while the tiles are used.
+    SurfaceTiles(const MappedSurfaceMesh& mesh, size_t tile_vertices = 1000000);
+
+    //! the number of tiles
+    size_t n_tiles() const { return tile_begin_.size() - 1; }
+
+    //! the number of vertices of tile \p i
+    size_t tile_size(size_t i) const
+    {
+        return tile_begin_[i + 1] - tile_begin_[i];
+    }
+
+    //! \brief Set the maximal number of tiles in memory at the same time.
+    //! \details The default 0 uses twice the number of threads.
+    void set_max_in_flight(size_t max_in_flight)
+    {
+        max_in_flight_ = max_in_flight;
+    }
+
+    //! \brief Copy tile \p i into \p tile.
+    //! \details Copies the faces of the vertices of the tile and \p halo
+    //! rings of faces around them. The vertices of the tile come first, in
+    //! the order of their indices, followed by those of the halo. The
+    //! property "v:global" stores the index of each vertex in the mapped
+    //! mesh. Values of the tile's vertices that depend on their k-ring
+    //! equal those of the whole mesh for \p halo >= k - 1.
+    //! \return whether all faces could be added
+    bool extract(size_t i, unsigned int halo, SurfaceMesh& tile) const;
+
+    //! \brief Compute a vertex property tile by tile and write it to the
+    //! file \p filename.
+    //! \details \p compute is called for each tile extracted with \p halo
+    //! rings, concurrently for different tiles, and returns the property
+    //! whose values of the tile's vertices are written. \p T must be
+    //! trivially copyable and not bool.
+    //! \return false if a tile could not be extracted or the file could
+    //! not be written
+    template <class T>
+    bool vertex_property(
+        const std::string& filename, unsigned int halo,
+        const std::function<VertexProperty<T>(SurfaceMesh&)>& compute) const
+    {
+        return process(filename, halo, sizeof(T),
+                       [&](SurfaceMesh& tile, size_t n, char* values) {
+                           const VertexProperty<T> prop = compute(tile);
+                           std::memcpy(values, prop.data(), n * sizeof(T));
+                       });
+    }
+
+    //! \brief Write the vertex normals of SurfaceNormals to \p filename.
+    //! \details One Normal per vertex.
+    bool vertex_normals(const std::string& filename) const;
+
+    //! \brief Write the curvature of SurfaceCurvature to \p filename.
+    //! \details The minimal and maximal curvature as two Scalar values per
+    //! vertex. Computed by SurfaceCurvature::analyze_tensor() if
+    //! \p tensor is set, or by SurfaceCurvature::analyze() otherwise,
+    //! followed by \p smoothing_steps, which increase the halo.
+    bool curvature(const std::string& filename,
+                   unsigned int smoothing_steps = 0,
+                   bool tensor = false) const;
+
+private:
+    // process the tiles with halo rings, compute(tile, n, values) stores
+    // the values of the n vertices of the tile in values, which are written
+    // to filename
+    bool process(const std::string& filename, unsigned int halo,
+                 size_t value_size,
+                 const std::function<void(SurfaceMesh&, size_t, char*)>&
+                     compute) const;
+
+    // split the vertices_ [begin, end) into tiles
+    void split(size_t begin, size_t end, size_t tile_vertices);
+
+    const MappedSurfaceMesh& mesh_;
+
+    // the vertices sorted by tile, and the first one of each tile
+    std::vector<IndexType> vertices_;
+    std::vector<size_t> tile_begin_;
+
+    size_t max_in_flight_;
+};
+
+//=============================================================================
+//! @}
+//=============================================================================
+} // namespace pmp
+//=============================================================================
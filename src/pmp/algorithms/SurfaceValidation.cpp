@@ -0,0 +1,283 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/algorithms/SurfaceValidation.h>
+#include <pmp/Parallel.h>
+
+#include <algorithm>
+#include <limits>
+#include <mutex>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+namespace {
+
+// count a problem and list the handle if there is room
+template <class Handle>
+void add(std::vector<Handle>& list, size_t& count, Handle h,
+         size_t max_handles)
+{
+    ++count;
+    if (list.size() < max_handles)
+        list.push_back(h);
+}
+
+// merge the lists of the chunks, keeping the smallest indices
+template <class Handle>
+void merge(std::vector<Handle>& list, const std::vector<Handle>& chunk,
+           size_t max_handles)
+{
+    list.insert(list.end(), chunk.begin(), chunk.end());
+    std::sort(list.begin(), list.end());
+    if (list.size() > max_handles)
+        list.resize(max_handles);
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+ValidationReport validate(const SurfaceMesh& mesh, size_t max_handles)
+{
+    ValidationReport report;
+    std::mutex mutex;
+
+    // walks around broken faces or vertices may not return
+    const size_t n_halfedges = mesh.halfedges_size();
+    const size_t max_steps = n_halfedges + 1;
+    auto is_valid = [&](Halfedge h) {
+        return h.is_valid() && h.idx() < n_halfedges &&
+               !mesh.is_deleted(mesh.edge(h));
+    };
+
+    // halfedges: connectivity and orientation
+    std::vector<Halfedge> boundary;
+    parallel_for_chunks(n_halfedges, [&](size_t begin, size_t end) {
+        ValidationReport chunk;
+        std::vector<Halfedge> chunk_boundary;
+        for (size_t i = begin; i < end; ++i)
+        {
+            const Halfedge h(static_cast<IndexType>(i));
+            if (mesh.is_deleted(mesh.edge(h)))
+                continue;
+
+            const Halfedge n = mesh.next_halfedge(h);
+            bool ok = is_valid(n) && mesh.face(n) == mesh.face(h) &&
+                      mesh.from_vertex(n) == mesh.to_vertex(h) &&
+                      mesh.to_vertex(h) != mesh.from_vertex(h);
+#ifndef PMP_NO_PREV_HALFEDGE
+            const Halfedge p = mesh.prev_halfedge(h);
+            ok = ok && is_valid(p) && mesh.prev_halfedge(n) == h &&
+                 mesh.next_halfedge(p) == h;
+#endif
+            if (!ok)
+                add(chunk.invalid_halfedges, chunk.n_invalid_halfedges, h,
+                    max_handles);
+            else if (mesh.is_boundary(h))
+                chunk_boundary.push_back(h);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        report.n_invalid_halfedges += chunk.n_invalid_halfedges;
+        merge(report.invalid_halfedges, chunk.invalid_halfedges, max_handles);
+        boundary.insert(boundary.end(), chunk_boundary.begin(),
+                        chunk_boundary.end());
+    });
+
+    // vertices: manifoldness and outgoing halfedges
+    parallel_for_chunks(mesh.vertices_size(), [&](size_t begin, size_t end) {
+        ValidationReport chunk;
+        for (size_t i = begin; i < end; ++i)
+        {
+            const Vertex v(static_cast<IndexType>(i));
+            if (mesh.is_deleted(v))
+                continue;
+
+            const Halfedge h0 = mesh.halfedge(v);
+            if (!h0.is_valid())
+            {
+                ++chunk.n_isolated_vertices;
+                continue;
+            }
+
+            // count the outgoing boundary halfedges
+            size_t n_boundary = 0, steps = 0;
+            bool ok = true;
+            Halfedge h = h0;
+            do
+            {
+                if (!is_valid(h) || mesh.from_vertex(h) != v ||
+                    ++steps > max_steps)
+                {
+                    ok = false;
+                    break;
+                }
+                if (mesh.is_boundary(h))
+                    ++n_boundary;
+                h = mesh.next_halfedge(mesh.opposite_halfedge(h));
+            } while (h != h0);
+
+            // the halfedge of a boundary vertex has to be a boundary one
+            if (!ok || (n_boundary && !mesh.is_boundary(h0)))
+                add(chunk.invalid_halfedges, chunk.n_invalid_halfedges, h0,
+                    max_handles);
+            else if (n_boundary > 1)
+                add(chunk.non_manifold_vertices,
+                    chunk.n_non_manifold_vertices, v, max_handles);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        report.n_isolated_vertices += chunk.n_isolated_vertices;
+        report.n_non_manifold_vertices += chunk.n_non_manifold_vertices;
+        report.n_invalid_halfedges += chunk.n_invalid_halfedges;
+        merge(report.non_manifold_vertices, chunk.non_manifold_vertices,
+              max_handles);
+        merge(report.invalid_halfedges, chunk.invalid_halfedges, max_handles);
+    });
+
+    // faces: degeneracy and duplicates
+    parallel_for_chunks(mesh.faces_size(), [&](size_t begin, size_t end) {
+        ValidationReport chunk;
+        std::vector<Vertex> vertices, sorted, neighbor;
+        for (size_t i = begin; i < end; ++i)
+        {
+            const Face f(static_cast<IndexType>(i));
+            if (mesh.is_deleted(f))
+                continue;
+
+            // collect the vertices
+            const Halfedge h0 = mesh.halfedge(f);
+            vertices.clear();
+            bool ok = is_valid(h0) && mesh.face(h0) == f;
+            for (Halfedge h = h0; ok;)
+            {
+                vertices.push_back(mesh.to_vertex(h));
+                h = mesh.next_halfedge(h);
+                if (h == h0)
+                    break;
+                ok = is_valid(h) && vertices.size() < max_steps;
+            }
+            if (!ok)
+            {
+                add(chunk.invalid_halfedges, chunk.n_invalid_halfedges, h0,
+                    max_handles);
+                continue;
+            }
+
+            // vector area and longest edge, relative to the first vertex
+            const Point p0 = mesh.position(vertices[0]);
+            Normal area(0, 0, 0);
+            Scalar max_length2 = 0;
+            for (size_t j = 0; j < vertices.size(); ++j)
+            {
+                const Point& a = mesh.position(vertices[j]);
+                const Point& b =
+                    mesh.position(vertices[(j + 1) % vertices.size()]);
+                area += cross(a - p0, b - p0);
+                max_length2 = std::max(max_length2, sqrnorm(b - a));
+            }
+
+            // triangles are checked without sorting their vertices
+            bool repeated, duplicate = false;
+            if (vertices.size() == 3)
+            {
+                repeated = vertices[0] == vertices[1] ||
+                           vertices[1] == vertices[2] ||
+                           vertices[0] == vertices[2];
+
+                // the same triangle has to be across each edge
+                const Halfedge o = mesh.opposite_halfedge(h0);
+                const Face g = mesh.face(o);
+                if (g.is_valid() && g < f)
+                {
+                    const Halfedge n = mesh.next_halfedge(o);
+                    duplicate = is_valid(n) &&
+                                mesh.to_vertex(n) == vertices[1] &&
+                                mesh.next_halfedge(mesh.next_halfedge(n)) == o;
+                }
+            }
+            else
+            {
+                sorted = vertices;
+                std::sort(sorted.begin(), sorted.end());
+                repeated = std::adjacent_find(sorted.begin(), sorted.end()) !=
+                           sorted.end();
+
+                // a face with the same vertices shares an edge with f
+                Halfedge h = h0;
+                do
+                {
+                    const Face g = mesh.face(mesh.opposite_halfedge(h));
+                    if (g.is_valid() && g < f)
+                    {
+                        neighbor.clear();
+                        const Halfedge g0 = mesh.halfedge(g);
+                        Halfedge k = g0;
+                        do
+                        {
+                            neighbor.push_back(mesh.to_vertex(k));
+                            k = mesh.next_halfedge(k);
+                        } while (k != g0 && is_valid(k) &&
+                                 neighbor.size() <= sorted.size());
+                        std::sort(neighbor.begin(), neighbor.end());
+                        duplicate = neighbor == sorted;
+                    }
+                    h = mesh.next_halfedge(h);
+                } while (h != h0 && !duplicate);
+            }
+
+            if (vertices.size() < 3 || repeated ||
+                norm(area) <=
+                    std::numeric_limits<Scalar>::epsilon() * max_length2)
+            {
+                add(chunk.degenerate_faces, chunk.n_degenerate_faces, f,
+                    max_handles);
+            }
+            if (duplicate)
+                add(chunk.duplicate_faces, chunk.n_duplicate_faces, f,
+                    max_handles);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        report.n_degenerate_faces += chunk.n_degenerate_faces;
+        report.n_duplicate_faces += chunk.n_duplicate_faces;
+        report.n_invalid_halfedges += chunk.n_invalid_halfedges;
+        merge(report.degenerate_faces, chunk.degenerate_faces, max_handles);
+        merge(report.duplicate_faces, chunk.duplicate_faces, max_handles);
+        merge(report.invalid_halfedges, chunk.invalid_halfedges, max_handles);
+    });
+
+    // boundary loops, following valid next halfedges
+    if (report.n_invalid_halfedges == 0 && !boundary.empty())
+    {
+        std::vector<char> visited(n_halfedges, 0);
+        for (auto h0 : boundary)
+        {
+            if (visited[h0.idx()])
+                continue;
+            ++report.n_boundary_loops;
+            Halfedge h = h0;
+            do
+            {
+                visited[h.idx()] = 1;
+                h = mesh.next_halfedge(h);
+            } while (!visited[h.idx()]);
+        }
+    }
+
+    return report;
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -0,0 +1,70 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <pmp/SurfaceMesh.h>
+
+#include <vector>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \addtogroup algorithms algorithms
+//! @{
+
+//=============================================================================
+
+//! \brief The problems found by validate().
+//! \details The handle lists hold the offending elements with the smallest
+//! indices, at most as many as requested, while the counts are complete.
+struct ValidationReport
+{
+    size_t n_isolated_vertices = 0;     //!< vertices without edges
+    size_t n_non_manifold_vertices = 0; //!< vertices joining several fans
+    size_t n_boundary_loops = 0;        //!< the number of holes
+    size_t n_degenerate_faces = 0;      //!< zero area or repeated vertices
+    size_t n_duplicate_faces = 0;       //!< same vertices as a neighbor
+    size_t n_invalid_halfedges = 0;     //!< broken connectivity
+
+    std::vector<Vertex> non_manifold_vertices; //!< offending vertices
+    std::vector<Face> degenerate_faces;        //!< offending faces
+    std::vector<Face> duplicate_faces;         //!< the later of two faces
+    std::vector<Halfedge> invalid_halfedges;   //!< offending halfedges
+
+    //! \brief Whether no problems were found.
+    //! \details Isolated vertices and boundaries are allowed.
+    bool is_valid() const
+    {
+        return n_non_manifold_vertices == 0 && n_degenerate_faces == 0 &&
+               n_duplicate_faces == 0 && n_invalid_halfedges == 0;
+    }
+};
+
+//! \brief Check \p mesh for problems in a single parallel pass per element
+//! type.
+//! \details A halfedge is invalid if its next and previous halfedges do not
+//! match, if its next halfedge starts at another vertex or lies in another
+//! face, i.e., the orientation is inconsistent, or if it is the halfedge of
+//! a vertex or face that it does not belong to. A face is degenerate if a
+//! vertex repeats or its area is below machine precision relative to its
+//! longest edge. Faces with the same vertices as the face across one of
+//! their edges are duplicates. Boundary loops are only counted if the
+//! connectivity is valid. At most \p max_handles handles are listed per
+//! problem.
+ValidationReport validate(const SurfaceMesh& mesh, size_t max_handles = 100);
+
+//=============================================================================
+//! @}
+//=============================================================================
+} // namespace pmp
+//=============================================================================
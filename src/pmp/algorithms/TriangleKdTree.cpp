@@ -9,9 +9,16 @@
 
 #include <pmp/algorithms/TriangleKdTree.h>
 #include <pmp/algorithms/DifferentialGeometry.h>
-#include <pmp/algorithms/DistancePointTriangle.h>
-#include <pmp/BoundingBox.h>
+#include <pmp/Parallel.h>
+
+#include <algorithm>
 #include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
 
 //=============================================================================
 
@@ -19,151 +26,624 @@ namespace pmp {
 
 //=============================================================================
 
+namespace {
+
+// number of bins of the surface area heuristic
+const int n_bins = 16;
+
+// leaves are tested in batches of this many triangles
+const size_t batch_size = 64;
+
+// the cost of a batched triangle test relative to traversing a node
+const Scalar triangle_cost = 0.25;
+
+// the depth of trees is bounded by the traversal stacks of the queries
+const unsigned int max_tree_depth = 60;
+
+// Batched squared distances within this relative tolerance of the current
+// bound are evaluated exactly, since they can differ from the exact ones by
+// rounding.
+const Scalar tolerance = 1e-3;
+
+// half the surface area of the box [bmin,bmax]
+Scalar half_area(const Point& bmin, const Point& bmax)
+{
+    const Point e = bmax - bmin;
+    return e[0] * e[1] + e[1] * e[2] + e[2] * e[0];
+}
+
+// squared distance of p to the box [bmin,bmax]
+Scalar sqr_box_distance(const Point& p, const Point& bmin, const Point& bmax)
+{
+    Scalar d = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+        const Scalar e = std::max(std::max(bmin[i] - p[i], p[i] - bmax[i]),
+                                  Scalar(0));
+        d += e * e;
+    }
+    return d;
+}
+
+// an order of the points along a Morton curve of their bounding box, such
+// that consecutive queries traverse the same parts of the tree
+std::vector<IndexType> coherent_order(const std::vector<Point>& points)
+{
+    if (points.empty())
+        return std::vector<IndexType>();
+
+    Point bmin = points[0], bmax = points[0];
+    for (const auto& p : points)
+    {
+        bmin = min(bmin, p);
+        bmax = max(bmax, p);
+    }
+    const Point extent = bmax - bmin;
+    const Scalar scale =
+        1023.0 / std::max(std::max(extent[0], extent[1]),
+                          std::max(extent[2], Scalar(FLT_MIN)));
+
+    auto spread = [](uint32_t x) {
+        x = (x | (x << 16)) & 0x030000FF;
+        x = (x | (x << 8)) & 0x0300F00F;
+        x = (x | (x << 4)) & 0x030C30C3;
+        x = (x | (x << 2)) & 0x09249249;
+        return x;
+    };
+
+    std::vector<std::pair<uint32_t, IndexType>> codes(points.size());
+    parallel_for(size_t(0), points.size(), [&](size_t i) {
+        const Point q = (points[i] - bmin) * scale;
+        const uint32_t code = (spread(uint32_t(q[0])) << 2) |
+                              (spread(uint32_t(q[1])) << 1) |
+                              spread(uint32_t(q[2]));
+        codes[i] = std::make_pair(code, IndexType(i));
+    });
+    std::sort(codes.begin(), codes.end());
+
+    std::vector<IndexType> order(points.size());
+    for (size_t i = 0; i < points.size(); ++i)
+        order[i] = codes[i].second;
+    return order;
+}
+
+// first bytes of tree files, followed by the index and scalar widths
+const char tree_magic[4] = {'p', 'm', 't', '\xff'};
+
+// faces are hashed in blocks of this size, in parallel
+const size_t hash_block_size = 1 << 14;
+
+// FNV-1a hash of n bytes, continuing hash h
+uint64_t fnv1a(const void* data, size_t n, uint64_t h)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < n; ++i)
+        h = (h ^ bytes[i]) * 0x100000001B3ull;
+    return h;
+}
+
+// a hash of the triangles of mesh, i.e., of its faces and their corners
+uint64_t triangle_hash(const SurfaceMesh& mesh)
+{
+    std::vector<Face> faces;
+    faces.reserve(mesh.n_faces());
+    for (auto f : mesh.faces())
+        faces.push_back(f);
+
+    const size_t n_blocks = (faces.size() + hash_block_size - 1) /
+                            hash_block_size;
+    std::vector<uint64_t> hashes(n_blocks);
+    parallel_for(size_t(0), n_blocks, [&](size_t b) {
+        uint64_t h = 0xCBF29CE484222325ull;
+        const size_t end = std::min(faces.size(), (b + 1) * hash_block_size);
+        for (size_t i = b * hash_block_size; i < end; ++i)
+        {
+            const IndexType idx = faces[i].idx();
+            h = fnv1a(&idx, sizeof(idx), h);
+            for (auto v : mesh.vertices(faces[i]))
+                h = fnv1a(mesh.position(v).data(), sizeof(Point), h);
+        }
+        hashes[b] = h;
+    });
+    return fnv1a(hashes.data(), hashes.size() * sizeof(uint64_t),
+                 0xCBF29CE484222325ull);
+}
+
+// read n elements in chunks, such that a corrupt n does not allocate more
+// than the file holds
+template <class T>
+bool read_elements(FILE* in, uint64_t n, std::vector<T>& elements)
+{
+    const uint64_t chunk = (uint64_t(1) << 20) / sizeof(T) + 1;
+    elements.clear();
+    while (elements.size() < n)
+    {
+        const size_t offset = elements.size();
+        const size_t size = size_t(std::min(chunk, n - offset));
+        elements.resize(offset + size);
+        if (fread(elements.data() + offset, sizeof(T), size, in) != size)
+            return false;
+    }
+    return true;
+}
+
+// node pairs are split breadth-first until there are this many to be
+// traversed in parallel
+const size_t n_node_pairs = 1024;
+
+// whether the boxes [amin,amax] and [bmin,bmax] overlap
+bool boxes_overlap(const Point& amin, const Point& amax, const Point& bmin,
+                   const Point& bmax)
+{
+    for (int i = 0; i < 3; ++i)
+        if (amax[i] < bmin[i] || bmax[i] < amin[i])
+            return false;
+    return true;
+}
+
+// six times the signed volume of the tetrahedron (a,b,c,d)
+double orient3d(const dvec3& a, const dvec3& b, const dvec3& c,
+                const dvec3& d)
+{
+    return dot(cross(b - a, c - a), d - a);
+}
+
+// twice the signed area of the triangle (a,b,c)
+double orient2d(const dvec2& a, const dvec2& b, const dvec2& c)
+{
+    return (b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0]);
+}
+
+// whether the segments [p,q] and [a,b] in the plane intersect
+bool segments_intersect(const dvec2& p, const dvec2& q, const dvec2& a,
+                        const dvec2& b)
+{
+    const double s0 = orient2d(p, q, a), s1 = orient2d(p, q, b);
+    const double s2 = orient2d(a, b, p), s3 = orient2d(a, b, q);
+    if (s0 == 0 && s1 == 0)
+    {
+        // collinear: overlapping projections
+        for (int i = 0; i < 2; ++i)
+            if (std::max(p[i], q[i]) < std::min(a[i], b[i]) ||
+                std::max(a[i], b[i]) < std::min(p[i], q[i]))
+                return false;
+        return true;
+    }
+    return ((s0 <= 0 && s1 >= 0) || (s0 >= 0 && s1 <= 0)) &&
+           ((s2 <= 0 && s3 >= 0) || (s2 >= 0 && s3 <= 0));
+}
+
+// whether the point p in the plane lies in the triangle t
+bool point_in_triangle(const dvec2& p, const dvec2* t)
+{
+    const double s0 = orient2d(t[0], t[1], p), s1 = orient2d(t[1], t[2], p);
+    const double s2 = orient2d(t[2], t[0], p);
+    return (s0 >= 0 && s1 >= 0 && s2 >= 0) || (s0 <= 0 && s1 <= 0 && s2 <= 0);
+}
+
+// whether the segment [p,q] intersects the triangle t, which it must not be
+// coplanar with
+bool segment_intersects_triangle(const dvec3& p, const dvec3& q,
+                                 const dvec3* t)
+{
+    const double sp = orient3d(t[0], t[1], t[2], p);
+    const double sq = orient3d(t[0], t[1], t[2], q);
+    if ((sp > 0 && sq > 0) || (sp < 0 && sq < 0) || (sp == 0 && sq == 0))
+        return false;
+    const double e0 = orient3d(p, q, t[0], t[1]);
+    const double e1 = orient3d(p, q, t[1], t[2]);
+    const double e2 = orient3d(p, q, t[2], t[0]);
+    return (e0 >= 0 && e1 >= 0 && e2 >= 0) || (e0 <= 0 && e1 <= 0 && e2 <= 0);
+}
+
+// Whether the triangles a and b intersect. If they share corner sa of a and
+// sb of b, they have to intersect away from it, otherwise sa and sb are -1.
+// Edge j of a triangle is opposite to corner j.
+bool triangles_intersect(const dvec3* a, const dvec3* b, int sa, int sb)
+{
+    // all corners of one triangle on the same side of the other one
+    double oa[3], ob[3];
+    for (int j = 0; j < 3; ++j)
+    {
+        oa[j] = orient3d(b[0], b[1], b[2], a[j]);
+        ob[j] = orient3d(a[0], a[1], a[2], b[j]);
+    }
+    auto separated = [](const double* o) {
+        return (o[0] > 0 && o[1] > 0 && o[2] > 0) ||
+               (o[0] < 0 && o[1] < 0 && o[2] < 0);
+    };
+    if (separated(oa) || separated(ob))
+        return false;
+
+    if (ob[0] != 0 || ob[1] != 0 || ob[2] != 0)
+    {
+        // the intersection is a segment ending on an edge
+        for (int j = 0; j < 3; ++j)
+        {
+            if ((sa < 0 || sa == j) &&
+                segment_intersects_triangle(a[(j + 1) % 3], a[(j + 2) % 3],
+                                            b))
+                return true;
+            if ((sb < 0 || sb == j) &&
+                segment_intersects_triangle(b[(j + 1) % 3], b[(j + 2) % 3],
+                                            a))
+                return true;
+        }
+        return false;
+    }
+
+    // coplanar: project along the dominant axis of the normal
+    const dvec3 n = cross(a[1] - a[0], a[2] - a[0]);
+    int axis = 0;
+    for (int i = 1; i < 3; ++i)
+        if (std::fabs(n[i]) > std::fabs(n[axis]))
+            axis = i;
+    const int u = (axis + 1) % 3, v = (axis + 2) % 3;
+    dvec2 pa[3], pb[3];
+    for (int j = 0; j < 3; ++j)
+    {
+        pa[j] = dvec2(a[j][u], a[j][v]);
+        pb[j] = dvec2(b[j][u], b[j][v]);
+    }
+
+    // crossing edges, one of them not incident to a shared corner
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            if ((sa < 0 || sa == i || sb == j) &&
+                segments_intersect(pa[(i + 1) % 3], pa[(i + 2) % 3],
+                                   pb[(j + 1) % 3], pb[(j + 2) % 3]))
+                return true;
+
+    // a triangle inside the other one
+    for (int j = 0; j < 3; ++j)
+    {
+        if (j != sa && point_in_triangle(pa[j], pb))
+            return true;
+        if (j != sb && point_in_triangle(pb[j], pa))
+            return true;
+    }
+    return false;
+}
+
+} // namespace
+
+//=============================================================================
+
 TriangleKdTree::TriangleKdTree(const SurfaceMesh& mesh, unsigned int max_faces,
                                unsigned int max_depth)
+    : max_faces_(max_faces), max_depth_(max_depth)
 {
-    // init
-    root_ = new Node();
-    root_->faces = new Triangles();
     VertexProperty<Point> points = mesh.get_vertex_property<Point>("v:point");
 
-    // collect triangles
-    Triangle tri;
-    root_->faces->reserve(mesh.n_faces());
-    for (SurfaceMesh::FaceIterator fit = mesh.faces_begin();
-         fit != mesh.faces_end(); ++fit)
+    // collect triangle corners
+    std::vector<Face> faces;
+    faces.reserve(mesh.n_faces());
+    for (auto f : mesh.faces())
+        faces.push_back(f);
+    if (faces.empty())
+        return;
+
+    Build build;
+    build.corners.resize(3 * faces.size());
+    build.centroids.resize(faces.size());
+    build.faces.resize(faces.size());
+    parallel_for(size_t(0), faces.size(), [&](size_t i) {
+        SurfaceMesh::VertexAroundFaceCirculator vfit = mesh.vertices(faces[i]);
+        Point c(0, 0, 0);
+        for (int j = 0; j < 3; ++j, ++vfit)
+        {
+            build.corners[3 * i + j] = points[*vfit];
+            c += points[*vfit];
+        }
+        build.centroids[i] = c / 3.0;
+        build.faces[i] = IndexType(i);
+    });
+    build.max_faces = std::max(max_faces, 1u);
+    build.task_size =
+        std::max(faces.size() / (16 * num_threads()), size_t(4096));
+
+    // the depth is bounded by the traversal stack of nearest()
+    max_depth = std::min(max_depth, max_tree_depth);
+
+    // build the top of the tree and collect large subtrees
+    std::vector<Task> tasks;
+    nodes_.push_back(Node());
+    build_recurse(build, nodes_, 0, 0, IndexType(faces.size()), max_depth,
+                  &tasks);
+
+    // build the subtrees in parallel, each into its own nodes
+    std::vector<std::vector<Node>> subtrees(tasks.size());
+    parallel_for_chunks(
+        tasks.size(),
+        [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const Task& t = tasks[i];
+                subtrees[i].push_back(nodes_[t.node]);
+                build_recurse(build, subtrees[i], 0, t.begin, t.end, t.depth,
+                              nullptr);
+            }
+        },
+        1);
+
+    // append the subtrees, their inner nodes refer to local indices
+    for (size_t i = 0; i < tasks.size(); ++i)
     {
-        SurfaceMesh::VertexAroundFaceCirculator vfit = mesh.vertices(*fit);
-        tri.x[0] = points[*vfit];
-        ++vfit;
-        tri.x[1] = points[*vfit];
-        ++vfit;
-        tri.x[2] = points[*vfit];
-        tri.f = *fit;
-        root_->faces->push_back(tri);
+        const IndexType offset = IndexType(nodes_.size()) - 1;
+        for (auto& node : subtrees[i])
+        {
+            if (node.n_faces == 0)
+                node.index += offset;
+        }
+        nodes_[tasks[i].node] = subtrees[i][0];
+        nodes_.insert(nodes_.end(), subtrees[i].begin() + 1,
+                      subtrees[i].end());
+        std::vector<Node>().swap(subtrees[i]);
     }
 
-    // call recursive helper
-    build_recurse(root_, max_faces, max_depth);
+    // store the triangles in the order of the leaves
+    triangles_.resize(faces.size());
+    faces_.resize(faces.size());
+    parallel_for(size_t(0), faces.size(), [&](size_t i) {
+        const IndexType f = build.faces[i];
+        triangles_.set(i, build.corners[3 * f], build.corners[3 * f + 1],
+                       build.corners[3 * f + 2]);
+        faces_[i] = faces[f];
+    });
+}
+
+//-----------------------------------------------------------------------------
+
+TriangleKdTree::TriangleKdTree(const SurfaceMesh& mesh,
+                               const std::string& cache,
+                               unsigned int max_faces, unsigned int max_depth)
+    : max_faces_(max_faces), max_depth_(max_depth)
+{
+    if (read(cache, mesh) && max_faces_ == max_faces &&
+        max_depth_ == max_depth)
+        return;
+
+    *this = TriangleKdTree(mesh, max_faces, max_depth);
+    write(cache, mesh);
 }
 
 //-----------------------------------------------------------------------------
 
-unsigned int TriangleKdTree::build_recurse(Node* node, unsigned int max_faces,
-                                           unsigned int depth)
+bool TriangleKdTree::write(const std::string& filename,
+                           const SurfaceMesh& mesh) const
 {
-    // should we stop at this level ?
-    if ((depth == 0) || (node->faces->size() <= max_faces))
-        return depth;
+    // write to a temporary file that replaces the cache once it is complete,
+    // such that concurrent readers never see a partial file
+    std::random_device random;
+    const std::string tmp = filename + "." + std::to_string(random()) + ".tmp";
+    FILE* out = fopen(tmp.c_str(), "wb");
+    if (!out)
+        return false;
 
-    std::vector<Triangle>::const_iterator fit, fend = node->faces->end();
-    unsigned int i;
+    const unsigned char widths[2] = {sizeof(IndexType), sizeof(Scalar)};
+    const uint64_t header[5] = {nodes_.size(), faces_.size(),
+                                triangle_hash(mesh), max_faces_, max_depth_};
+    bool ok = fwrite(tree_magic, 1, 4, out) == 4 &&
+              fwrite(widths, 1, 2, out) == 2 &&
+              fwrite(header, sizeof(uint64_t), 5, out) == 5 &&
+              fwrite(nodes_.data(), sizeof(Node), nodes_.size(), out) ==
+                  nodes_.size() &&
+              fwrite(faces_.data(), sizeof(Face), faces_.size(), out) ==
+                  faces_.size();
+    ok = fclose(out) == 0 && ok;
 
-    // compute bounding box
-    BoundingBox bbox;
-    for (fit = node->faces->begin(); fit != fend; ++fit)
+#ifdef _WIN32
+    // rename() does not replace existing files on Windows
+    if (ok)
+        std::remove(filename.c_str());
+#endif
+    ok = ok && std::rename(tmp.c_str(), filename.c_str()) == 0;
+    if (!ok)
+        std::remove(tmp.c_str());
+    return ok;
+}
+
+//-----------------------------------------------------------------------------
+
+bool TriangleKdTree::read(const std::string& filename, const SurfaceMesh& mesh)
+{
+    FILE* in = fopen(filename.c_str(), "rb");
+    if (!in)
+        return false;
+
+    // the header has to match this build and the mesh
+    char magic[4];
+    unsigned char widths[2];
+    uint64_t header[5];
+    bool ok = fread(magic, 1, 4, in) == 4 &&
+              memcmp(magic, tree_magic, 4) == 0 &&
+              fread(widths, 1, 2, in) == 2 &&
+              widths[0] == sizeof(IndexType) && widths[1] == sizeof(Scalar) &&
+              fread(header, sizeof(uint64_t), 5, in) == 5 &&
+              header[1] == mesh.n_faces() && header[2] == triangle_hash(mesh);
+
+    std::vector<Node> nodes;
+    std::vector<Face> faces;
+    ok = ok && read_elements(in, header[0], nodes) &&
+         read_elements(in, header[1], faces) &&
+         nodes.empty() == faces.empty();
+    fclose(in);
+
+    // the hash does not cover the nodes and faces, check that they form a
+    // tree of bounded depth over faces of the mesh. children follow their
+    // parents, so the depths are known when the children are reached.
+    std::vector<unsigned int> depths(nodes.size(), 0);
+    for (size_t i = 0; ok && i < nodes.size(); ++i)
+    {
+        const Node& node = nodes[i];
+        if (node.n_faces == 0)
+        {
+            ok = node.index > i && size_t(node.index) + 1 < nodes.size() &&
+                 depths[i] < max_tree_depth;
+            for (size_t j = node.index; ok && j < size_t(node.index) + 2; ++j)
+                depths[j] = std::max(depths[j], depths[i] + 1);
+        }
+        else
+            ok = uint64_t(node.index) + node.n_faces <= faces.size();
+    }
+    for (size_t i = 0; ok && i < faces.size(); ++i)
+        ok = faces[i].idx() < mesh.faces_size() && !mesh.is_deleted(faces[i]);
+    if (!ok)
+        return false;
+
+    // gather the triangles in the order of the leaves
+    TriangleSoA triangles;
+    triangles.resize(faces.size());
+    parallel_for(size_t(0), faces.size(), [&](size_t i) {
+        auto vfit = mesh.vertices(faces[i]);
+        const Point& p0 = mesh.position(*vfit);
+        const Point& p1 = mesh.position(*(++vfit));
+        const Point& p2 = mesh.position(*(++vfit));
+        triangles.set(i, p0, p1, p2);
+    });
+
+    nodes_.swap(nodes);
+    faces_.swap(faces);
+    triangles_ = std::move(triangles);
+    max_faces_ = static_cast<unsigned int>(header[3]);
+    max_depth_ = static_cast<unsigned int>(header[4]);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void TriangleKdTree::build_recurse(Build& build, std::vector<Node>& nodes,
+                                   IndexType node, IndexType begin,
+                                   IndexType end, unsigned int depth,
+                                   std::vector<Task>* tasks) const
+{
+    // bounding boxes of the triangles and of their centroids
+    Point bmin = build.corners[3 * build.faces[begin]], bmax = bmin;
+    Point cmin = build.centroids[build.faces[begin]], cmax = cmin;
+    for (IndexType i = begin; i < end; ++i)
     {
-        for (i = 0; i < 3; ++i)
+        const IndexType f = build.faces[i];
+        for (int j = 0; j < 3; ++j)
         {
-            bbox += fit->x[i];
+            bmin = min(bmin, build.corners[3 * f + j]);
+            bmax = max(bmax, build.corners[3 * f + j]);
         }
+        cmin = min(cmin, build.centroids[f]);
+        cmax = max(cmax, build.centroids[f]);
+    }
+    nodes[node].bmin = bmin;
+    nodes[node].bmax = bmax;
+
+    // defer large subtrees
+    const IndexType n = end - begin;
+    if (tasks && n <= build.task_size)
+    {
+        tasks->push_back(Task{node, begin, end, depth});
+        return;
     }
 
-    // split longest side of bounding box
-    Point bb = bbox.max() - bbox.min();
-    Scalar length = bb[0];
+    // split the longest axis of the centroids
+    const Point extent = cmax - cmin;
     int axis = 0;
-    if (bb[1] > length)
-        length = bb[(axis = 1)];
-    if (bb[2] > length)
-        length = bb[(axis = 2)];
-
-#if 1
-    // split in the middle
-    Scalar split = bbox.center()[axis];
-#else
-    // find split position as median
-    std::vector<Scalar> v;
-    v.reserve(node->faces->size() * 3);
-    for (fit = node->faces->begin(); fit != fend; ++fit)
-        for (i = 0; i < 3; ++i)
-            v.push_back(fit->x[i][axis]]);
-    std::sort(v.begin(), v.end());
-    split = v[v.size() / 2];
-#endif
+    if (extent[1] > extent[axis])
+        axis = 1;
+    if (extent[2] > extent[axis])
+        axis = 2;
 
-    // create children
-    auto* left = new Node();
-    left->faces = new Triangles();
-    left->faces->reserve(node->faces->size() / 2);
-    auto* right = new Node();
-    right->faces = new Triangles;
-    right->faces->reserve(node->faces->size() / 2);
+    auto make_leaf = [&]() {
+        nodes[node].index = begin;
+        nodes[node].n_faces = n;
+    };
 
-    // partition for left and right child
-    for (fit = node->faces->begin(); fit != fend; ++fit)
+    if (depth == 0 || n <= build.max_faces || !(extent[axis] > 0))
     {
-        bool l = false, r = false;
+        make_leaf();
+        return;
+    }
 
-        const Triangle& t = *fit;
-        if (t.x[0][axis] <= split)
-            l = true;
-        else
-            r = true;
-        if (t.x[1][axis] <= split)
-            l = true;
-        else
-            r = true;
-        if (t.x[2][axis] <= split)
-            l = true;
-        else
-            r = true;
+    // bin the triangles by their centroids
+    const Scalar scale = n_bins / extent[axis] * Scalar(0.9999);
+    auto bin = [&](IndexType f) {
+        return int((build.centroids[f][axis] - cmin[axis]) * scale);
+    };
 
-        if (l)
+    IndexType counts[n_bins] = {0};
+    Point bin_min[n_bins], bin_max[n_bins];
+    for (IndexType i = begin; i < end; ++i)
+    {
+        const IndexType f = build.faces[i];
+        const int b = bin(f);
+        for (int j = 0; j < 3; ++j)
         {
-            left->faces->push_back(t);
+            const Point& x = build.corners[3 * f + j];
+            bin_min[b] = counts[b] || j ? min(bin_min[b], x) : x;
+            bin_max[b] = counts[b] || j ? max(bin_max[b], x) : x;
         }
+        ++counts[b];
+    }
 
-        if (r)
+    // sweep from the right, then find the cheapest split from the left
+    Scalar right_cost[n_bins];
+    IndexType count = 0;
+    Point rmin, rmax;
+    for (int b = n_bins - 1; b > 0; --b)
+    {
+        if (counts[b])
         {
-            right->faces->push_back(t);
+            rmin = count ? min(rmin, bin_min[b]) : bin_min[b];
+            rmax = count ? max(rmax, bin_max[b]) : bin_max[b];
+            count += counts[b];
         }
+        right_cost[b] = count ? count * half_area(rmin, rmax) : 0;
     }
 
-    // stop here?
-    if (left->faces->size() == node->faces->size() ||
-        right->faces->size() == node->faces->size())
+    Scalar best_cost = FLT_MAX;
+    int best_bin = 0;
+    count = 0;
+    Point lmin, lmax;
+    for (int b = 0; b < n_bins - 1; ++b)
     {
-        // compact my memory
-        node->faces->shrink_to_fit();
-
-        // delete new nodes
-        delete left;
-        delete right;
+        if (counts[b])
+        {
+            lmin = count ? min(lmin, bin_min[b]) : bin_min[b];
+            lmax = count ? max(lmax, bin_max[b]) : bin_max[b];
+            count += counts[b];
+        }
+        if (count == 0 || count == n)
+            continue;
 
-        // return tree depth
-        return depth;
+        const Scalar cost = count * half_area(lmin, lmax) + right_cost[b + 1];
+        if (cost < best_cost)
+        {
+            best_cost = cost;
+            best_bin = b + 1;
+        }
     }
 
-    // or recurse further?
-    else
+    // a leaf is cheaper than traversing two children and their triangles
+    const Scalar area = half_area(bmin, bmax);
+    if (best_bin == 0 ||
+        (area > 0 && triangle_cost * best_cost / area + 1 >= triangle_cost * n))
     {
-        // free my memory
-        delete node->faces;
-        node->faces = nullptr;
+        make_leaf();
+        return;
+    }
 
-        // store internal data
-        node->axis = axis;
-        node->split = split;
-        node->left_child = left;
-        node->right_child = right;
+    // partition in-place
+    auto* first = build.faces.data() + begin;
+    auto* mid = std::partition(first, build.faces.data() + end,
+                               [&](IndexType f) { return bin(f) < best_bin; });
+    const IndexType split = begin + IndexType(mid - first);
 
-        // recurse to childen
-        int depthLeft = build_recurse(node->left_child, max_faces, depth - 1);
-        int depthRight = build_recurse(node->right_child, max_faces, depth - 1);
+    // children are stored consecutively
+    const IndexType child = IndexType(nodes.size());
+    nodes[node].index = child;
+    nodes[node].n_faces = 0;
+    nodes.push_back(Node());
+    nodes.push_back(Node());
 
-        return std::min(depthLeft, depthRight);
-    }
+    build_recurse(build, nodes, child, begin, split, depth - 1, tasks);
+    build_recurse(build, nodes, child + 1, split, end, depth - 1, tasks);
 }
 
 //-----------------------------------------------------------------------------
@@ -173,51 +653,494 @@ TriangleKdTree::NearestNeighbor TriangleKdTree::nearest(const Point& p) const
     NearestNeighbor data;
     data.dist = FLT_MAX;
     data.tests = 0;
-    nearest_recurse(root_, p, data);
+    if (nodes_.empty())
+        return data;
+
+    // nodes still to visit and their squared distance
+    std::pair<IndexType, Scalar> stack[64];
+    int top = 0;
+    stack[top++] = std::make_pair(IndexType(0), Scalar(0));
+    Scalar sqr_dist = FLT_MAX;
+
+    while (top > 0)
+    {
+        // skip subtrees that cannot contain a closer triangle
+        const auto entry = stack[--top];
+        if (entry.second >= sqr_dist)
+            continue;
+
+        // descend towards the closer child, remember the other one
+        const Node* node = &nodes_[entry.first];
+        while (node && node->n_faces == 0)
+        {
+            const Node* left = &nodes_[node->index];
+            const Node* right = left + 1;
+            Scalar dl = sqr_box_distance(p, left->bmin, left->bmax);
+            Scalar dr = sqr_box_distance(p, right->bmin, right->bmax);
+            IndexType far = node->index + 1;
+            if (dr < dl)
+            {
+                std::swap(left, right);
+                std::swap(dl, dr);
+                far = node->index;
+            }
+
+            if (dr < sqr_dist)
+                stack[top++] = std::make_pair(far, dr);
+            node = (dl < sqr_dist) ? left : nullptr;
+        }
+        if (!node)
+            continue;
+
+        // test the triangles of the leaf in batches, and the closest
+        // candidates exactly
+        Scalar sqr_dists[batch_size];
+        const size_t end = node->index + node->n_faces;
+        for (size_t begin = node->index; begin < end; begin += batch_size)
+        {
+            const size_t n = std::min(batch_size, end - begin);
+            sqr_dist_point_triangles(p, triangles_, begin, begin + n,
+                                     sqr_dists);
+            data.tests += int(n);
+
+            for (size_t i = 0; i < n; ++i)
+            {
+                if (sqr_dists[i] > sqr_dist * (1 + tolerance))
+                    continue;
+
+                Point nearest;
+                const Scalar d = exact_distance(begin + i, p, nearest);
+                if (d < data.dist)
+                {
+                    data.dist = d;
+                    data.face = faces_[begin + i];
+                    data.nearest = nearest;
+                    sqr_dist = d * d;
+                }
+            }
+        }
+    }
+
     return data;
 }
 
 //-----------------------------------------------------------------------------
 
-void TriangleKdTree::nearest_recurse(Node* node, const Point& point,
-                                     NearestNeighbor& data) const
+std::vector<TriangleKdTree::NearestNeighbor>
+TriangleKdTree::nearest(const std::vector<Point>& points) const
 {
-    // terminal node?
-    if (!node->left_child)
+    std::vector<NearestNeighbor> result(points.size());
+    const std::vector<IndexType> order = coherent_order(points);
+    parallel_for(size_t(0), points.size(), [&](size_t i) {
+        const IndexType j = order[i];
+        result[j] = nearest(points[j]);
+    });
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+
+std::vector<TriangleKdTree::NearestNeighbor>
+TriangleKdTree::k_nearest(const Point& p, unsigned int k) const
+{
+    std::vector<NearestNeighbor> result;
+    if (nodes_.empty() || k == 0)
+        return result;
+
+    // max-heap of the k nearest triangles found so far
+    auto closer = [](const NearestNeighbor& a, const NearestNeighbor& b) {
+        return a.dist < b.dist;
+    };
+    result.reserve(k);
+    Scalar sqr_dist = FLT_MAX;
+    int tests = 0;
+
+    std::pair<IndexType, Scalar> stack[64];
+    int top = 0;
+    stack[top++] = std::make_pair(IndexType(0), Scalar(0));
+
+    while (top > 0)
     {
-        Scalar d;
-        Point n;
+        const auto entry = stack[--top];
+        if (entry.second >= sqr_dist)
+            continue;
 
-        auto fit = node->faces->begin(), fend = node->faces->end();
-        for (; fit != fend; ++fit)
+        const Node& node = nodes_[entry.first];
+        if (node.n_faces == 0)
         {
-            d = dist_point_triangle(point, fit->x[0], fit->x[1], fit->x[2], n);
-            ++data.tests;
-            if (d < data.dist)
+            // visit the closer child first
+            const Node* left = &nodes_[node.index];
+            const Node* right = left + 1;
+            const Scalar dl = sqr_box_distance(p, left->bmin, left->bmax);
+            const Scalar dr = sqr_box_distance(p, right->bmin, right->bmax);
+            const auto l = std::make_pair(node.index, dl);
+            const auto r = std::make_pair(node.index + 1, dr);
+            stack[top++] = (dl < dr) ? r : l;
+            stack[top++] = (dl < dr) ? l : r;
+            continue;
+        }
+
+        NearestNeighbor data;
+        Scalar sqr_dists[batch_size];
+        const size_t end = node.index + node.n_faces;
+        for (size_t begin = node.index; begin < end; begin += batch_size)
+        {
+            const size_t n = std::min(batch_size, end - begin);
+            sqr_dist_point_triangles(p, triangles_, begin, begin + n,
+                                     sqr_dists);
+            tests += int(n);
+
+            for (size_t i = 0; i < n; ++i)
+            {
+                if (sqr_dists[i] > sqr_dist * (1 + tolerance))
+                    continue;
+
+                data.dist = exact_distance(begin + i, p, data.nearest);
+                data.face = faces_[begin + i];
+
+                if (result.size() < k)
+                {
+                    result.push_back(data);
+                    std::push_heap(result.begin(), result.end(), closer);
+                }
+                else if (data.dist < result.front().dist)
+                {
+                    std::pop_heap(result.begin(), result.end(), closer);
+                    result.back() = data;
+                    std::push_heap(result.begin(), result.end(), closer);
+                }
+
+                if (result.size() == k)
+                    sqr_dist = result.front().dist * result.front().dist;
+            }
+        }
+    }
+
+    std::sort_heap(result.begin(), result.end(), closer);
+    for (auto& r : result)
+        r.tests = tests;
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+
+std::vector<std::vector<TriangleKdTree::NearestNeighbor>>
+TriangleKdTree::k_nearest(const std::vector<Point>& points,
+                          unsigned int k) const
+{
+    std::vector<std::vector<NearestNeighbor>> result(points.size());
+    const std::vector<IndexType> order = coherent_order(points);
+    parallel_for(size_t(0), points.size(), [&](size_t i) {
+        const IndexType j = order[i];
+        result[j] = k_nearest(points[j], k);
+    });
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+
+std::vector<TriangleKdTree::NearestNeighbor>
+TriangleKdTree::within_radius(const Point& p, Scalar radius) const
+{
+    std::vector<NearestNeighbor> result;
+    if (nodes_.empty() || radius < 0)
+        return result;
+
+    const Scalar sqr_radius = radius * radius;
+    int tests = 0;
+
+    std::vector<IndexType> stack(1, 0);
+    while (!stack.empty())
+    {
+        const Node& node = nodes_[stack.back()];
+        stack.pop_back();
+        if (sqr_box_distance(p, node.bmin, node.bmax) > sqr_radius)
+            continue;
+
+        if (node.n_faces == 0)
+        {
+            stack.push_back(node.index);
+            stack.push_back(node.index + 1);
+            continue;
+        }
+
+        NearestNeighbor data;
+        Scalar sqr_dists[batch_size];
+        const size_t end = node.index + node.n_faces;
+        for (size_t begin = node.index; begin < end; begin += batch_size)
+        {
+            const size_t n = std::min(batch_size, end - begin);
+            sqr_dist_point_triangles(p, triangles_, begin, begin + n,
+                                     sqr_dists);
+            tests += int(n);
+
+            for (size_t i = 0; i < n; ++i)
             {
-                data.dist = d;
-                data.face = fit->f;
-                data.nearest = n;
+                if (sqr_dists[i] > sqr_radius * (1 + tolerance))
+                    continue;
+
+                data.dist = exact_distance(begin + i, p, data.nearest);
+                if (data.dist <= radius)
+                {
+                    data.face = faces_[begin + i];
+                    result.push_back(data);
+                }
             }
         }
     }
 
-    // non-terminal node
-    else
+    for (auto& r : result)
+        r.tests = tests;
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+
+std::vector<std::vector<TriangleKdTree::NearestNeighbor>>
+TriangleKdTree::within_radius(const std::vector<Point>& points,
+                              Scalar radius) const
+{
+    std::vector<std::vector<NearestNeighbor>> result(points.size());
+    const std::vector<IndexType> order = coherent_order(points);
+    parallel_for(size_t(0), points.size(), [&](size_t i) {
+        const IndexType j = order[i];
+        result[j] = within_radius(points[j], radius);
+    });
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+
+TriangleKdTree::Intersection
+TriangleKdTree::intersect(const Point& origin, const Point& direction) const
+{
+    Intersection hit;
+    hit.t = FLT_MAX;
+    if (nodes_.empty())
+        return hit;
+
+    Point inv_dir;
+    for (int i = 0; i < 3; ++i)
+        inv_dir[i] = 1.0 / direction[i];
+
+    // the ray parameter where the ray enters the box, FLT_MAX if it misses
+    auto enter = [&](const Node& node) {
+        Scalar t0 = 0, t1 = hit.t;
+        for (int i = 0; i < 3; ++i)
+        {
+            Scalar ta = (node.bmin[i] - origin[i]) * inv_dir[i];
+            Scalar tb = (node.bmax[i] - origin[i]) * inv_dir[i];
+            if (ta > tb)
+                std::swap(ta, tb);
+            t0 = ta > t0 ? ta : t0;
+            t1 = tb < t1 ? tb : t1;
+        }
+        return t0 <= t1 ? t0 : Scalar(FLT_MAX);
+    };
+
+    std::pair<IndexType, Scalar> stack[64];
+    int top = 0;
+    stack[top++] = std::make_pair(IndexType(0), enter(nodes_[0]));
+
+    while (top > 0)
     {
-        Scalar dist = point[node->axis] - node->split;
+        const auto entry = stack[--top];
+        if (entry.second >= hit.t)
+            continue;
 
-        if (dist <= 0.0)
+        const Node& node = nodes_[entry.first];
+        if (node.n_faces == 0)
         {
-            nearest_recurse(node->left_child, point, data);
-            if (fabs(dist) < data.dist)
-                nearest_recurse(node->right_child, point, data);
+            // visit the child entered first before the other one
+            const Scalar tl = enter(nodes_[node.index]);
+            const Scalar tr = enter(nodes_[node.index + 1]);
+            const auto l = std::make_pair(node.index, tl);
+            const auto r = std::make_pair(node.index + 1, tr);
+            stack[top++] = (tl < tr) ? r : l;
+            stack[top++] = (tl < tr) ? l : r;
+            continue;
+        }
+
+        // Moeller-Trumbore test of the triangles of the leaf
+        const size_t end = node.index + node.n_faces;
+        for (size_t i = node.index; i < end; ++i)
+        {
+            const Point v0 = triangles_.corner(i, 0);
+            const Point v0v1 = triangles_.corner(i, 1) - v0;
+            const Point v0v2 = triangles_.corner(i, 2) - v0;
+            const Point pvec = cross(direction, v0v2);
+            const Scalar det = dot(v0v1, pvec);
+            if (det == 0)
+                continue;
+
+            const Scalar inv_det = 1.0 / det;
+            const Point tvec = origin - v0;
+            const Scalar u = dot(tvec, pvec) * inv_det;
+            if (u < 0 || u > 1)
+                continue;
+
+            const Point qvec = cross(tvec, v0v1);
+            const Scalar v = dot(direction, qvec) * inv_det;
+            if (v < 0 || u + v > 1)
+                continue;
+
+            const Scalar s = dot(v0v2, qvec) * inv_det;
+            if (s > 0 && s < hit.t)
+            {
+                hit.t = s;
+                hit.face = faces_[i];
+            }
+        }
+    }
+
+    if (hit.face.is_valid())
+        hit.point = origin + hit.t * direction;
+    return hit;
+}
+
+//-----------------------------------------------------------------------------
+
+std::vector<TriangleKdTree::Intersection>
+TriangleKdTree::intersect(const std::vector<Point>& origins,
+                          const std::vector<Point>& directions) const
+{
+    std::vector<Intersection> result(std::min(origins.size(),
+                                              directions.size()));
+    parallel_for(size_t(0), result.size(), [&](size_t i) {
+        result[i] = intersect(origins[i], directions[i]);
+    });
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+
+std::vector<std::pair<Face, Face>>
+TriangleKdTree::intersections(const TriangleKdTree& other) const
+{
+    std::vector<std::pair<Face, Face>> result;
+    if (nodes_.empty() || other.nodes_.empty())
+        return result;
+    const bool self = &other == this;
+
+    // the children of overlapping node pairs, and overlapping leaf pairs
+    auto split = [&](IndexType a, IndexType b,
+                     std::vector<std::pair<IndexType, IndexType>>& pairs) {
+        const Node& na = nodes_[a];
+        const Node& nb = other.nodes_[b];
+        if (!boxes_overlap(na.bmin, na.bmax, nb.bmin, nb.bmax))
+            return;
+        if (na.n_faces && nb.n_faces)
+            pairs.emplace_back(a, b);
+        else if (self && a == b)
+        {
+            pairs.emplace_back(na.index, na.index);
+            pairs.emplace_back(na.index, na.index + 1);
+            pairs.emplace_back(na.index + 1, na.index + 1);
+        }
+        else if (nb.n_faces ||
+                 (!na.n_faces && half_area(na.bmin, na.bmax) >=
+                                     half_area(nb.bmin, nb.bmax)))
+        {
+            pairs.emplace_back(na.index, b);
+            pairs.emplace_back(na.index + 1, b);
         }
         else
         {
-            nearest_recurse(node->right_child, point, data);
-            if (fabs(dist) < data.dist)
-                nearest_recurse(node->left_child, point, data);
+            pairs.emplace_back(a, nb.index);
+            pairs.emplace_back(a, nb.index + 1);
+        }
+    };
+
+    // split the roots into independent pairs
+    std::vector<std::pair<IndexType, IndexType>> pairs, next;
+    split(0, 0, pairs);
+    while (!pairs.empty() && pairs.size() < n_node_pairs)
+    {
+        next.clear();
+        for (const auto& p : pairs)
+            split(p.first, p.second, next);
+        if (next == pairs)
+            break;
+        pairs.swap(next);
+    }
+
+    // traverse them in parallel
+    std::vector<std::vector<std::pair<Face, Face>>> found(pairs.size());
+    parallel_for(size_t(0), pairs.size(), [&](size_t i) {
+        std::vector<std::pair<IndexType, IndexType>> stack(1, pairs[i]);
+        while (!stack.empty())
+        {
+            const auto p = stack.back();
+            stack.pop_back();
+            if (nodes_[p.first].n_faces && other.nodes_[p.second].n_faces)
+                intersect_nodes(other, p.first, p.second, found[i]);
+            else
+                split(p.first, p.second, stack);
+        }
+    });
+
+    for (const auto& f : found)
+        result.insert(result.end(), f.begin(), f.end());
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+
+void TriangleKdTree::intersect_nodes(
+    const TriangleKdTree& other, IndexType a, IndexType b,
+    std::vector<std::pair<Face, Face>>& pairs) const
+{
+    const bool self = &other == this;
+    const Node& na = nodes_[a];
+    const Node& nb = other.nodes_[b];
+    for (IndexType i = na.index; i < na.index + na.n_faces; ++i)
+    {
+        dvec3 ta[3];
+        Point amin, amax;
+        for (int j = 0; j < 3; ++j)
+        {
+            const Point c = triangles_.corner(i, j);
+            amin = j ? min(amin, c) : c;
+            amax = j ? max(amax, c) : c;
+            ta[j] = dvec3(c);
+        }
+
+        const IndexType first = (self && a == b) ? i + 1 : nb.index;
+        for (IndexType k = first; k < nb.index + nb.n_faces; ++k)
+        {
+            dvec3 tb[3];
+            Point bmin, bmax;
+            for (int j = 0; j < 3; ++j)
+            {
+                const Point c = other.triangles_.corner(k, j);
+                bmin = j ? min(bmin, c) : c;
+                bmax = j ? max(bmax, c) : c;
+                tb[j] = dvec3(c);
+            }
+            if (!boxes_overlap(amin, amax, bmin, bmax))
+                continue;
+
+            // corners shared by neighbors in the same mesh
+            int sa = -1, sb = -1, n_shared = 0;
+            if (self)
+            {
+                for (int j = 0; j < 3; ++j)
+                    for (int l = 0; l < 3; ++l)
+                        if (ta[j] == tb[l])
+                        {
+                            sa = j;
+                            sb = l;
+                            ++n_shared;
+                        }
+            }
+            if (n_shared > 1 || !triangles_intersect(ta, tb, sa, sb))
+                continue;
+
+            Face fa = faces_[i], fb = other.faces_[k];
+            if (self && fb < fa)
+                std::swap(fa, fb);
+            pairs.emplace_back(fa, fb);
         }
     }
 }
@@ -10,6 +10,10 @@
 //=============================================================================
 
 #include <pmp/SurfaceMesh.h>
+#include <pmp/algorithms/DistancePointTriangle.h>
+
+#include <string>
+#include <utility>
 #include <vector>
 
 //=============================================================================
@@ -21,16 +25,45 @@ namespace pmp {
 //! \addtogroup algorithms algorithms
 //!@{
 
-//! A k-d tree for triangles
+//! \brief A spatial search tree for the triangles of a mesh.
+//! \details Despite its name, this is a bounding volume hierarchy. It is
+//! built by binned surface area heuristic splits with in-place partitioning,
+//! and independent subtrees are built in parallel. Queries prune subtrees by
+//! the distance to their bounding boxes.
 class TriangleKdTree
 {
 public:
-    //! construct with mesh
+    //! \brief Construct with mesh.
+    //! \details Nodes with at most \p max_faces triangles, or at depth
+    //! \p max_depth, become leaves. Larger nodes become leaves only if
+    //! splitting them does not pay off.
     TriangleKdTree(const SurfaceMesh& mesh, unsigned int max_faces = 10,
                    unsigned int max_depth = 30);
 
-    //! destructur
-    ~TriangleKdTree() { delete root_; }
+    //! \brief Construct with mesh, reusing the tree stored in the file
+    //! \p cache.
+    //! \details The tree is read from \p cache if it was written for the
+    //! same triangles and parameters, see read(). Otherwise it is built and
+    //! written to \p cache, such that later runs on the same mesh, e.g., in
+    //! other processes, skip the construction.
+    TriangleKdTree(const SurfaceMesh& mesh, const std::string& cache,
+                   unsigned int max_faces = 10, unsigned int max_depth = 30);
+
+    //! \brief Write the tree of \p mesh to the binary file \p filename.
+    //! \details The file stores the nodes, the faces in the order of the
+    //! leaves, the construction parameters, and a hash of the triangles of
+    //! \p mesh, which has to be the mesh the tree was built for. The file
+    //! is replaced only once it is complete, such that it can be shared by
+    //! concurrent jobs.
+    bool write(const std::string& filename, const SurfaceMesh& mesh) const;
+
+    //! \brief Replace the tree by the one stored in \p filename for \p mesh.
+    //! \details The nodes and faces are read in bulk, and only the triangle
+    //! corners are gathered from \p mesh in parallel, which is much faster
+    //! than building the tree. Fails, keeping the tree, if the file cannot be
+    //! read, was written by a build with other index or scalar widths, or
+    //! for different triangles, or if it is corrupt.
+    bool read(const std::string& filename, const SurfaceMesh& mesh);
 
     //! nearest neighbor information
     struct NearestNeighbor
@@ -44,55 +77,124 @@ public:
     //! Return handle of the nearest neighbor
     NearestNeighbor nearest(const Point& p) const;
 
-private:
-    // triangle stores corners and face handle
-    struct Triangle
+    //! \brief Return the nearest neighbors of all \p points.
+    //! \details The queries are sorted along a space-filling curve and
+    //! processed in parallel. Consecutive queries then traverse the same
+    //! parts of the tree, which makes this considerably faster than
+    //! individual nearest() calls, even on a single thread.
+    std::vector<NearestNeighbor> nearest(
+        const std::vector<Point>& points) const;
+
+    //! \brief Return the \p k triangles nearest to \p p, sorted by distance.
+    //! \details The \c tests of each result are those of the whole query.
+    std::vector<NearestNeighbor> k_nearest(const Point& p,
+                                           unsigned int k) const;
+
+    //! the \p k nearest triangles of all \p points, see nearest(points)
+    std::vector<std::vector<NearestNeighbor>> k_nearest(
+        const std::vector<Point>& points, unsigned int k) const;
+
+    //! \brief Return all triangles within distance \p radius of \p p.
+    //! \details The triangles are returned in no particular order. The
+    //! \c tests of each result are those of the whole query.
+    std::vector<NearestNeighbor> within_radius(const Point& p,
+                                               Scalar radius) const;
+
+    //! the triangles within \p radius of all \p points, see nearest(points)
+    std::vector<std::vector<NearestNeighbor>> within_radius(
+        const std::vector<Point>& points, Scalar radius) const;
+
+    //! ray intersection information
+    struct Intersection
     {
-        Triangle() {}
-        Triangle(const Point& x0, const Point& x1, const Point& x2, Face ff)
-        {
-            x[0] = x0;
-            x[1] = x1;
-            x[2] = x2;
-            f = ff;
-        }
-
-        Point x[3];
-        Face f;
+        Scalar t;    //!< ray parameter of the hit, FLT_MAX if there is none
+        Face face;   //!< the face hit, invalid if there is none
+        Point point; //!< the hit point
     };
 
-    // vector of Triangle
-    typedef std::vector<Triangle> Triangles;
+    //! \brief Intersect the ray \p origin + t * \p direction, t > 0, with the
+    //! triangles.
+    //! \return the first hit, with an invalid face if there is none
+    Intersection intersect(const Point& origin, const Point& direction) const;
+
+    //! \brief Intersect the rays \p origins[i] + t * \p directions[i].
+    //! \details The rays are processed in parallel in their given order,
+    //! which should be coherent, e.g., the pixels of an image.
+    std::vector<Intersection> intersect(
+        const std::vector<Point>& origins,
+        const std::vector<Point>& directions) const;
+
+    //! \brief Return the pairs of intersecting triangles of this tree and
+    //! \p other, sorted.
+    //! \details Pairs of nodes with overlapping bounding boxes are traversed,
+    //! independent pairs in parallel, and their triangles are tested by
+    //! orientation predicates. Triangles touching each other intersect.
+    //! Pass this tree as \p other for self-intersections: each pair is then
+    //! reported once, triangles sharing an edge are never reported, and
+    //! triangles sharing a corner only if they intersect away from it.
+    std::vector<std::pair<Face, Face>> intersections(
+        const TriangleKdTree& other) const;
 
-    // Node of the tree: contains parent, children and splitting plane
+private:
+    // Node of the tree: inner nodes refer to their two consecutive children,
+    // leaves to a range of triangles
     struct Node
     {
-        Node() : faces(nullptr), left_child(nullptr), right_child(nullptr){};
-
-        ~Node()
-        {
-            delete faces;
-            delete left_child;
-            delete right_child;
-        }
-
-        unsigned char axis;
-        Scalar split;
-        Triangles* faces;
-        Node* left_child;
-        Node* right_child;
+        Point bmin;
+        IndexType index;   // first child of inner nodes, first leaf triangle
+        Point bmax;
+        IndexType n_faces; // number of triangles of leaves, 0 for inner nodes
     };
 
-    // Recursive part of build()
-    unsigned int build_recurse(Node* node, unsigned int max_handles,
-                               unsigned int depth);
+    // input triangles while building
+    struct Build
+    {
+        std::vector<Point> corners;
+        std::vector<Point> centroids;
+        std::vector<IndexType> faces; // the triangles, partitioned in-place
+        unsigned int max_faces;
+        size_t task_size; // subtrees of this size are built in parallel
+    };
 
-    // Recursive part of nearest()
-    void nearest_recurse(Node* node, const Point& point,
-                         NearestNeighbor& data) const;
+    // a subtree to be built in parallel
+    struct Task
+    {
+        IndexType node;
+        IndexType begin, end;
+        unsigned int depth;
+    };
+
+    // Recursive part of build(): sets up \p node for the triangles
+    // [begin,end) of \p build, appending its descendants to \p nodes. Large
+    // subtrees are deferred to \p tasks if not null.
+    void build_recurse(Build& build, std::vector<Node>& nodes, IndexType node,
+                       IndexType begin, IndexType end, unsigned int depth,
+                       std::vector<Task>* tasks) const;
+
+    // Appends the intersecting triangles of node \p a and node \p b of
+    // \p other to \p pairs, see intersections()
+    void intersect_nodes(const TriangleKdTree& other, IndexType a,
+                         IndexType b,
+                         std::vector<std::pair<Face, Face>>& pairs) const;
+
+    // exact distance of p to triangle i and its nearest point
+    Scalar exact_distance(size_t i, const Point& p, Point& nearest) const
+    {
+        return dist_point_triangle(p, triangles_.corner(i, 0),
+                                   triangles_.corner(i, 1),
+                                   triangles_.corner(i, 2), nearest);
+    }
 
 private:
-    Node* root_;
+    std::vector<Node> nodes_;
+
+    // the construction parameters, stored in files
+    unsigned int max_faces_;
+    unsigned int max_depth_;
+
+    // triangles and their faces in the order of the leaves
+    TriangleSoA triangles_;
+    std::vector<Face> faces_;
 };
 
 //=============================================================================
@@ -0,0 +1,405 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/distributed/DistributedSurfaceMesh.h>
+#include <pmp/algorithms/SurfaceCurvature.h>
+#include <pmp/algorithms/SurfaceNormals.h>
+#include <pmp/algorithms/SurfacePartitioning.h>
+#include <pmp/algorithms/SurfaceSmoothing.h>
+
+#include <cstring>
+#include <unordered_map>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+namespace {
+
+// parts are sent as byte arrays, prefixed by their number of elements
+template <class T>
+void send_vector(const std::vector<T>& v, int destination, MPI_Comm comm)
+{
+    unsigned long long n = v.size();
+    MPI_Send(&n, sizeof(n), MPI_BYTE, destination, 0, comm);
+    MPI_Send(v.data(), int(n * sizeof(T)), MPI_BYTE, destination, 0, comm);
+}
+
+template <class T>
+void receive_vector(std::vector<T>& v, MPI_Comm comm)
+{
+    unsigned long long n;
+    MPI_Recv(&n, sizeof(n), MPI_BYTE, 0, 0, comm, MPI_STATUS_IGNORE);
+    v.resize(n);
+    MPI_Recv(v.data(), int(n * sizeof(T)), MPI_BYTE, 0, 0, comm,
+             MPI_STATUS_IGNORE);
+}
+
+// the arrays of a part extracted by SurfacePartitioning
+struct PartData
+{
+    std::vector<Point> positions;
+    std::vector<IndexType> indices;
+    std::vector<IndexType> face_sizes;
+    std::vector<IndexType> vertex_global;
+    std::vector<IndexType> vertex_owner;
+    std::vector<IndexType> face_global;
+    std::vector<char> face_halo;
+};
+
+void pack(SurfaceMesh& part, PartData& data)
+{
+    auto vglobal = part.get_vertex_property<IndexType>("v:global");
+    auto vowner = part.get_vertex_property<IndexType>("v:owner");
+    auto fglobal = part.get_face_property<IndexType>("f:global");
+    auto fhalo = part.get_face_property<bool>("f:halo");
+
+    for (auto v : part.vertices())
+    {
+        data.positions.push_back(part.position(v));
+        data.vertex_global.push_back(vglobal[v]);
+        data.vertex_owner.push_back(vowner[v]);
+    }
+    for (auto f : part.faces())
+    {
+        IndexType size = 0;
+        for (auto v : part.vertices(f))
+        {
+            data.indices.push_back(v.idx());
+            ++size;
+        }
+        data.face_sizes.push_back(size);
+        data.face_global.push_back(fglobal[f]);
+        data.face_halo.push_back(fhalo[f]);
+    }
+}
+
+bool unpack(const PartData& data, int rank, SurfaceMesh& part)
+{
+    if (!part.build_from_indices(data.positions, data.indices,
+                                 data.face_sizes))
+        return false;
+
+    auto vglobal = part.vertex_property<IndexType>("v:global");
+    auto vowner = part.vertex_property<IndexType>("v:owner");
+    auto vowned = part.vertex_property<bool>("v:owned");
+    for (auto v : part.vertices())
+    {
+        vglobal[v] = data.vertex_global[v.idx()];
+        vowner[v] = data.vertex_owner[v.idx()];
+        vowned[v] = vowner[v] == IndexType(rank);
+    }
+
+    auto fglobal = part.face_property<IndexType>("f:global");
+    auto fhalo = part.face_property<bool>("f:halo");
+    for (auto f : part.faces())
+    {
+        fglobal[f] = data.face_global[f.idx()];
+        fhalo[f] = data.face_halo[f.idx()] != 0;
+    }
+    return true;
+}
+
+// exclusive prefix sum of \p counts
+std::vector<int> offsets(const std::vector<int>& counts)
+{
+    std::vector<int> result(counts.size(), 0);
+    for (size_t i = 1; i < counts.size(); ++i)
+        result[i] = result[i - 1] + counts[i - 1];
+    return result;
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+DistributedSurfaceMesh::DistributedSurfaceMesh(MPI_Comm comm)
+    : comm_(comm), n_global_vertices_(0)
+{
+    MPI_Comm_rank(comm_, &rank_);
+    MPI_Comm_size(comm_, &size_);
+}
+
+//-----------------------------------------------------------------------------
+
+bool DistributedSurfaceMesh::scatter(SurfaceMesh& mesh, unsigned int halo)
+{
+    PartData data;
+    if (rank_ == 0)
+    {
+        SurfacePartitioning partitioning(mesh);
+        partitioning.partition(size_);
+        n_global_vertices_ = mesh.vertices_size();
+
+        // an empty part tells a process that its extraction failed
+        for (int r = size_ - 1; r >= 0; --r)
+        {
+            SurfaceMesh part;
+            data = PartData();
+            if (partitioning.extract(r, part, halo))
+                pack(part, data);
+            if (r == 0)
+                break;
+
+            send_vector(data.positions, r, comm_);
+            send_vector(data.indices, r, comm_);
+            send_vector(data.face_sizes, r, comm_);
+            send_vector(data.vertex_global, r, comm_);
+            send_vector(data.vertex_owner, r, comm_);
+            send_vector(data.face_global, r, comm_);
+            send_vector(data.face_halo, r, comm_);
+        }
+    }
+    else
+    {
+        receive_vector(data.positions, comm_);
+        receive_vector(data.indices, comm_);
+        receive_vector(data.face_sizes, comm_);
+        receive_vector(data.vertex_global, comm_);
+        receive_vector(data.vertex_owner, comm_);
+        receive_vector(data.face_global, comm_);
+        receive_vector(data.face_halo, comm_);
+    }
+    MPI_Bcast(&n_global_vertices_, sizeof(IndexType), MPI_BYTE, 0, comm_);
+
+    part_.clear();
+    const bool ok = !data.face_sizes.empty() && unpack(data, rank_, part_);
+    if (!ok)
+    {
+        std::cerr << "DistributedSurfaceMesh: part " << rank_
+                  << " could not be built" << std::endl;
+        part_.clear();
+    }
+
+    build_exchange_lists();
+    return ok;
+}
+
+//-----------------------------------------------------------------------------
+
+void DistributedSurfaceMesh::build_exchange_lists()
+{
+    send_.assign(size_, std::vector<IndexType>());
+    receive_.assign(size_, std::vector<IndexType>());
+    owned_.clear();
+    owned_global_.clear();
+
+    // request the vertices owned by other processes by their global index
+    std::vector<std::vector<IndexType>> requests(size_);
+    std::unordered_map<IndexType, IndexType> local;
+    auto vglobal = part_.get_vertex_property<IndexType>("v:global");
+    auto vowner = part_.get_vertex_property<IndexType>("v:owner");
+    for (auto v : part_.vertices())
+    {
+        const IndexType owner = vowner[v];
+        if (owner == IndexType(rank_))
+        {
+            owned_.push_back(v.idx());
+            owned_global_.push_back(vglobal[v]);
+            local[vglobal[v]] = v.idx();
+        }
+        else
+        {
+            receive_[owner].push_back(v.idx());
+            requests[owner].push_back(vglobal[v]);
+        }
+    }
+
+    std::vector<int> request_counts(size_), requested_counts(size_);
+    std::vector<char> request_buffer;
+    for (int r = 0; r < size_; ++r)
+    {
+        request_counts[r] = int(requests[r].size() * sizeof(IndexType));
+        const char* begin = reinterpret_cast<const char*>(requests[r].data());
+        request_buffer.insert(request_buffer.end(), begin,
+                              begin + request_counts[r]);
+    }
+    MPI_Alltoall(request_counts.data(), 1, MPI_INT, requested_counts.data(),
+                 1, MPI_INT, comm_);
+
+    const std::vector<int> request_offsets = offsets(request_counts);
+    const std::vector<int> requested_offsets = offsets(requested_counts);
+    std::vector<char> requested_buffer(requested_offsets.back() +
+                                       requested_counts.back());
+    MPI_Alltoallv(request_buffer.data(), request_counts.data(),
+                  request_offsets.data(), MPI_BYTE, requested_buffer.data(),
+                  requested_counts.data(), requested_offsets.data(),
+                  MPI_BYTE, comm_);
+
+    // send the requested owned vertices in the order of the requests
+    for (int r = 0; r < size_; ++r)
+    {
+        const size_t n = requested_counts[r] / sizeof(IndexType);
+        for (size_t i = 0; i < n; ++i)
+        {
+            IndexType global;
+            std::memcpy(&global,
+                        requested_buffer.data() + requested_offsets[r] +
+                            i * sizeof(IndexType),
+                        sizeof(IndexType));
+            send_[r].push_back(local[global]);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void DistributedSurfaceMesh::exchange_bytes(char* data,
+                                            size_t bytes_per_vertex)
+{
+    std::vector<int> send_counts(size_), receive_counts(size_);
+    for (int r = 0; r < size_; ++r)
+    {
+        send_counts[r] = int(send_[r].size() * bytes_per_vertex);
+        receive_counts[r] = int(receive_[r].size() * bytes_per_vertex);
+    }
+    const std::vector<int> send_offsets = offsets(send_counts);
+    const std::vector<int> receive_offsets = offsets(receive_counts);
+
+    std::vector<char> send_buffer(send_offsets.back() + send_counts.back());
+    std::vector<char> receive_buffer(receive_offsets.back() +
+                                     receive_counts.back());
+    for (int r = 0; r < size_; ++r)
+    {
+        char* target = send_buffer.data() + send_offsets[r];
+        for (auto v : send_[r])
+        {
+            std::memcpy(target, data + v * bytes_per_vertex,
+                        bytes_per_vertex);
+            target += bytes_per_vertex;
+        }
+    }
+
+    MPI_Alltoallv(send_buffer.data(), send_counts.data(), send_offsets.data(),
+                  MPI_BYTE, receive_buffer.data(), receive_counts.data(),
+                  receive_offsets.data(), MPI_BYTE, comm_);
+
+    for (int r = 0; r < size_; ++r)
+    {
+        const char* source = receive_buffer.data() + receive_offsets[r];
+        for (auto v : receive_[r])
+        {
+            std::memcpy(data + v * bytes_per_vertex, source,
+                        bytes_per_vertex);
+            source += bytes_per_vertex;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void DistributedSurfaceMesh::gather_bytes(const char* data,
+                                          size_t bytes_per_vertex,
+                                          char* result)
+{
+    // the values and global indices of the owned vertices
+    const int n_owned = int(owned_.size());
+    std::vector<char> values(n_owned * bytes_per_vertex);
+    for (int i = 0; i < n_owned; ++i)
+        std::memcpy(values.data() + i * bytes_per_vertex,
+                    data + owned_[i] * bytes_per_vertex, bytes_per_vertex);
+
+    std::vector<int> counts(size_);
+    MPI_Gather(&n_owned, 1, MPI_INT, counts.data(), 1, MPI_INT, 0, comm_);
+
+    std::vector<int> value_counts(size_), index_counts(size_);
+    for (int r = 0; r < size_; ++r)
+    {
+        value_counts[r] = int(counts[r] * bytes_per_vertex);
+        index_counts[r] = int(counts[r] * sizeof(IndexType));
+    }
+    const std::vector<int> value_offsets = offsets(value_counts);
+    const std::vector<int> index_offsets = offsets(index_counts);
+
+    std::vector<char> all_values, all_indices;
+    if (rank_ == 0)
+    {
+        all_values.resize(value_offsets.back() + value_counts.back());
+        all_indices.resize(index_offsets.back() + index_counts.back());
+    }
+    MPI_Gatherv(values.data(), int(values.size()), MPI_BYTE,
+                all_values.data(), value_counts.data(), value_offsets.data(),
+                MPI_BYTE, 0, comm_);
+    MPI_Gatherv(owned_global_.data(), int(n_owned * sizeof(IndexType)),
+                MPI_BYTE, all_indices.data(), index_counts.data(),
+                index_offsets.data(), MPI_BYTE, 0, comm_);
+
+    if (rank_ == 0)
+    {
+        const size_t n = all_indices.size() / sizeof(IndexType);
+        for (size_t i = 0; i < n; ++i)
+        {
+            IndexType global;
+            std::memcpy(&global, all_indices.data() + i * sizeof(IndexType),
+                        sizeof(IndexType));
+            PMP_ASSERT(global < n_global_vertices_);
+            std::memcpy(result + global * bytes_per_vertex,
+                        all_values.data() + i * bytes_per_vertex,
+                        bytes_per_vertex);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void DistributedSurfaceMesh::exchange_positions()
+{
+    exchange(part_.vertex_property<Point>("v:point"));
+}
+
+//-----------------------------------------------------------------------------
+
+void DistributedSurfaceMesh::gather_positions(SurfaceMesh& mesh)
+{
+    VertexProperty<Point> result;
+    if (rank_ == 0)
+        result = mesh.vertex_property<Point>("v:point");
+    gather(part_.vertex_property<Point>("v:point"), result);
+}
+
+//-----------------------------------------------------------------------------
+
+void DistributedSurfaceMesh::explicit_smoothing(unsigned int iterations,
+                                                bool use_uniform_laplace)
+{
+    // the weights are computed once from the initial positions, as when
+    // smoothing the whole mesh
+    SurfaceSmoothing smoothing(part_);
+    for (unsigned int i = 0; i < iterations; ++i)
+    {
+        smoothing.explicit_smoothing(1, use_uniform_laplace);
+        exchange_positions();
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void DistributedSurfaceMesh::compute_vertex_normals()
+{
+    SurfaceNormals::compute_vertex_normals(part_);
+    exchange(part_.vertex_property<Normal>("v:normal"));
+}
+
+//-----------------------------------------------------------------------------
+
+void DistributedSurfaceMesh::compute_mean_curvature()
+{
+    SurfaceCurvature curvature(part_);
+    curvature.analyze();
+    auto mean = part_.vertex_property<Scalar>("v:mean_curvature");
+    for (auto v : part_.vertices())
+        mean[v] = curvature.mean_curvature(v);
+    exchange(mean);
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -0,0 +1,147 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <pmp/SurfaceMesh.h>
+
+#include <mpi.h>
+
+#include <vector>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \brief A mesh distributed over the processes of an MPI communicator.
+//! \details scatter() partitions a mesh given on rank 0 by
+//! SurfacePartitioning and sends one part with halo rings of faces to each
+//! process. Each vertex is owned by one process. After modifying the owned
+//! vertices of the local part, exchange() copies their values to the halo
+//! copies on the other processes, and gather() collects them on rank 0. With
+//! enough halo rings for the one-ring of the owned vertices, local
+//! operations on the part give the same result for the owned vertices as on
+//! the whole mesh. Usage, on all processes:
+//! \code
+//! DistributedSurfaceMesh distributed;
+//! SurfaceMesh mesh;
+//! if (distributed.rank() == 0)
+//!     mesh.read("input.off");
+//! distributed.scatter(mesh);
+//! distributed.explicit_smoothing(10);
+//! distributed.gather_positions(mesh);
+//! \endcode
+//! Built with the CMake option `PMP_BUILD_MPI`.
+class DistributedSurfaceMesh
+{
+public:
+    //! Construct for the processes of \p comm.
+    DistributedSurfaceMesh(MPI_Comm comm = MPI_COMM_WORLD);
+
+    //! the rank of this process
+    int rank() const { return rank_; }
+
+    //! the number of processes
+    int size() const { return size_; }
+
+    //! \brief Distribute \p mesh, given on rank 0, with \p halo rings.
+    //! \details Collective. \p mesh is only read on rank 0, where its
+    //! faces get the property "f:part" of their process. The local part has
+    //! the properties of SurfacePartitioning::extract().
+    //! \return whether the local part could be built
+    bool scatter(SurfaceMesh& mesh, unsigned int halo = 1);
+
+    //! the local part of the mesh
+    SurfaceMesh& part() { return part_; }
+
+    //! \brief Copy the values of the owned vertices to their halo copies.
+    //! \details Collective. \p T has to be trivially copyable and not
+    //! bool, whose properties are not stored as arrays.
+    template <class T>
+    void exchange(VertexProperty<T> prop);
+
+    //! exchange the vertex positions
+    void exchange_positions();
+
+    //! \brief Collect the values of the owned vertices on rank 0.
+    //! \details Collective. Writes them to \p result, a property of the
+    //! mesh passed to scatter() on rank 0, and ignores it on other ranks.
+    template <class T>
+    void gather(VertexProperty<T> prop, VertexProperty<T> result);
+
+    //! collect the vertex positions in \p mesh on rank 0
+    void gather_positions(SurfaceMesh& mesh);
+
+    //! \brief Explicit Laplacian smoothing of the distributed mesh.
+    //! \details Exchanges the positions after each iteration. The result
+    //! matches SurfaceSmoothing::explicit_smoothing() up to rounding.
+    void explicit_smoothing(unsigned int iterations,
+                            bool use_uniform_laplace = false);
+
+    //! compute the vertex normals "v:normal" of the part and exchange them
+    void compute_vertex_normals();
+
+    //! \brief Compute the mean curvature "v:mean_curvature" by
+    //! SurfaceCurvature::analyze() and exchange it.
+    //! \details Requires at least one halo ring.
+    void compute_mean_curvature();
+
+private:
+    // exchange \p bytes_per_vertex bytes per vertex, stored at \p data
+    void exchange_bytes(char* data, size_t bytes_per_vertex);
+
+    // collect the bytes of the owned vertices on rank 0, in global order
+    void gather_bytes(const char* data, size_t bytes_per_vertex,
+                      char* result);
+
+    // set up the lists of vertices sent to and received from each process
+    void build_exchange_lists();
+
+    MPI_Comm comm_;
+    int rank_;
+    int size_;
+
+    SurfaceMesh part_;
+
+    // the local vertices sent to and received from each process
+    std::vector<std::vector<IndexType>> send_;
+    std::vector<std::vector<IndexType>> receive_;
+
+    // the owned vertices and their global indices
+    std::vector<IndexType> owned_;
+    std::vector<IndexType> owned_global_;
+    IndexType n_global_vertices_;
+};
+
+//-----------------------------------------------------------------------------
+
+template <class T>
+void DistributedSurfaceMesh::exchange(VertexProperty<T> prop)
+{
+    exchange_bytes(reinterpret_cast<char*>(prop.vector().data()),
+                   sizeof(T));
+}
+
+//-----------------------------------------------------------------------------
+
+template <class T>
+void DistributedSurfaceMesh::gather(VertexProperty<T> prop,
+                                    VertexProperty<T> result)
+{
+    char* data = nullptr;
+    if (rank_ == 0)
+        data = reinterpret_cast<char*>(result.vector().data());
+    gather_bytes(reinterpret_cast<const char*>(prop.data()), sizeof(T), data);
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -0,0 +1,456 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+// Python bindings of SurfaceMesh and a few algorithms. Properties are exposed
+// as NumPy arrays viewing the property storage without copying. Like
+// iterators, these views are invalidated by adding elements and by
+// garbage_collection(), which may reallocate the storage:
+//
+//     import pmp
+//     mesh = pmp.SurfaceMesh()
+//     mesh.read("bunny.off")
+//     points = mesh.positions()        # (n, 3) view of "v:point"
+//     points *= 2                      # scales the mesh in place
+//     faces = mesh.face_indices()      # (n_faces, 3) array
+//     pmp.explicit_smoothing(mesh, 10) # releases the GIL
+
+#include <pmp/SurfaceMesh.h>
+#include <pmp/Parallel.h>
+#include <pmp/algorithms/SurfaceNormals.h>
+#include <pmp/algorithms/SurfaceRemeshing.h>
+#include <pmp/algorithms/SurfaceSimplification.h>
+#include <pmp/algorithms/SurfaceSmoothing.h>
+
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace py = pybind11;
+using namespace pmp;
+
+//=============================================================================
+
+namespace {
+
+static_assert(sizeof(Point) == 3 * sizeof(Scalar), "Point must be packed");
+static_assert(sizeof(TexCoord) == 2 * sizeof(Scalar),
+              "TexCoord must be packed");
+
+// the property functions of the element type HandleT
+template <class HandleT>
+struct Elements;
+
+template <>
+struct Elements<Vertex>
+{
+    template <class T>
+    static Property<T> get(SurfaceMesh& mesh, const std::string& name)
+    {
+        return mesh.get_vertex_property<T>(name);
+    }
+    template <class T>
+    static Property<T> add(SurfaceMesh& mesh, const std::string& name)
+    {
+        return mesh.add_vertex_property<T>(name);
+    }
+    static const std::type_info& type(SurfaceMesh& mesh,
+                                      const std::string& name)
+    {
+        return mesh.get_vertex_property_type(name);
+    }
+};
+
+template <>
+struct Elements<Halfedge>
+{
+    template <class T>
+    static Property<T> get(SurfaceMesh& mesh, const std::string& name)
+    {
+        return mesh.get_halfedge_property<T>(name);
+    }
+    template <class T>
+    static Property<T> add(SurfaceMesh& mesh, const std::string& name)
+    {
+        return mesh.add_halfedge_property<T>(name);
+    }
+    static const std::type_info& type(SurfaceMesh& mesh,
+                                      const std::string& name)
+    {
+        return mesh.get_halfedge_property_type(name);
+    }
+};
+
+template <>
+struct Elements<Edge>
+{
+    template <class T>
+    static Property<T> get(SurfaceMesh& mesh, const std::string& name)
+    {
+        return mesh.get_edge_property<T>(name);
+    }
+    template <class T>
+    static Property<T> add(SurfaceMesh& mesh, const std::string& name)
+    {
+        return mesh.add_edge_property<T>(name);
+    }
+    static const std::type_info& type(SurfaceMesh& mesh,
+                                      const std::string& name)
+    {
+        return mesh.get_edge_property_type(name);
+    }
+};
+
+template <>
+struct Elements<Face>
+{
+    template <class T>
+    static Property<T> get(SurfaceMesh& mesh, const std::string& name)
+    {
+        return mesh.get_face_property<T>(name);
+    }
+    template <class T>
+    static Property<T> add(SurfaceMesh& mesh, const std::string& name)
+    {
+        return mesh.add_face_property<T>(name);
+    }
+    static const std::type_info& type(SurfaceMesh& mesh,
+                                      const std::string& name)
+    {
+        return mesh.get_face_property_type(name);
+    }
+};
+
+// a view of the \p components values of type S per element of \p p, which
+// keeps \p owner alive
+template <class S, class T>
+py::array view(Property<T> p, size_t components, py::handle owner)
+{
+    std::vector<T>& values = p.vector();
+    S* data = reinterpret_cast<S*>(values.data());
+    std::vector<py::ssize_t> shape(1, py::ssize_t(values.size()));
+    std::vector<py::ssize_t> strides(1, py::ssize_t(sizeof(T)));
+    if (components > 1)
+    {
+        shape.push_back(py::ssize_t(components));
+        strides.push_back(py::ssize_t(sizeof(S)));
+    }
+    return py::array_t<S>(shape, strides, data, owner);
+}
+
+// the view of the property \p name of the elements HandleT
+template <class HandleT>
+py::array property_view(SurfaceMesh& mesh, const std::string& name,
+                        py::handle owner)
+{
+    typedef Elements<HandleT> E;
+    const std::type_info& type = E::type(mesh, name);
+    if (type == typeid(float))
+        return view<float>(E::template get<float>(mesh, name), 1, owner);
+    if (type == typeid(double))
+        return view<double>(E::template get<double>(mesh, name), 1, owner);
+    if (type == typeid(int))
+        return view<int>(E::template get<int>(mesh, name), 1, owner);
+    if (type == typeid(unsigned int))
+        return view<unsigned int>(E::template get<unsigned int>(mesh, name),
+                                  1, owner);
+    if (type == typeid(std::uint8_t))
+        return view<std::uint8_t>(E::template get<std::uint8_t>(mesh, name),
+                                  1, owner);
+    if (type == typeid(std::uint16_t))
+        return view<std::uint16_t>(
+            E::template get<std::uint16_t>(mesh, name), 1, owner);
+    if (type == typeid(Flag))
+        return view<bool>(E::template get<Flag>(mesh, name), 1, owner);
+    if (type == typeid(Point))
+        return view<Scalar>(E::template get<Point>(mesh, name), 3, owner);
+    if (type == typeid(TexCoord))
+        return view<Scalar>(E::template get<TexCoord>(mesh, name), 2, owner);
+    if (type == typeid(void))
+        throw py::key_error("no property named " + name);
+    throw py::type_error("the type of property " + name +
+                         " has no NumPy equivalent");
+}
+
+// add the property \p name with values of \p dtype and \p components
+template <class HandleT>
+py::array add_property(SurfaceMesh& mesh, const std::string& name,
+                       py::dtype dtype, size_t components, py::handle owner)
+{
+    typedef Elements<HandleT> E;
+    if (E::type(mesh, name) != typeid(void))
+        throw py::key_error("property " + name + " exists already");
+
+    const char kind = dtype.kind();
+    const size_t size = dtype.itemsize();
+    if (kind == 'f' && size == sizeof(Scalar) && components == 3)
+        E::template add<Point>(mesh, name);
+    else if (kind == 'f' && size == sizeof(Scalar) && components == 2)
+        E::template add<TexCoord>(mesh, name);
+    else if (components != 1)
+        throw py::type_error("vectors need the dtype of pmp.Scalar");
+    else if (kind == 'f' && size == 4)
+        E::template add<float>(mesh, name);
+    else if (kind == 'f' && size == 8)
+        E::template add<double>(mesh, name);
+    else if (kind == 'i' && size == sizeof(int))
+        E::template add<int>(mesh, name);
+    else if (kind == 'u' && size == sizeof(unsigned int))
+        E::template add<unsigned int>(mesh, name);
+    else if (kind == 'u' && size == 1)
+        E::template add<std::uint8_t>(mesh, name);
+    else if (kind == 'u' && size == 2)
+        E::template add<std::uint16_t>(mesh, name);
+    else if (kind == 'b')
+        E::template add<Flag>(mesh, name);
+    else
+        throw py::type_error("unsupported property dtype");
+    return property_view<HandleT>(mesh, name, owner);
+}
+
+// the vertex indices of the faces, concatenated, and the number of vertices
+// per face
+void face_indices(const SurfaceMesh& mesh, std::vector<IndexType>& indices,
+                  std::vector<IndexType>& sizes)
+{
+    // the first index of each face, deleted faces have none
+    std::vector<IndexType> offsets(mesh.faces_size() + 1, 0);
+    for (auto f : mesh.faces())
+        offsets[f.idx() + 1] = IndexType(mesh.valence(f));
+    for (size_t i = 1; i < offsets.size(); ++i)
+        offsets[i] += offsets[i - 1];
+
+    indices.resize(offsets.back());
+    sizes.resize(mesh.n_faces());
+    size_t i = 0;
+    for (auto f : mesh.faces())
+        sizes[i++] = offsets[f.idx() + 1] - offsets[f.idx()];
+    parallel_for(mesh.faces(), [&](Face f) {
+        IndexType* index = &indices[offsets[f.idx()]];
+        for (auto v : mesh.vertices(f))
+            *index++ = v.idx();
+    });
+}
+
+// the (n_faces, k) array of vertex indices of meshes whose faces all have k
+// vertices
+py::array_t<IndexType> face_index_array(const SurfaceMesh& mesh)
+{
+    std::vector<IndexType> indices, sizes;
+    {
+        py::gil_scoped_release release;
+        face_indices(mesh, indices, sizes);
+    }
+    const size_t k = sizes.empty() ? 3 : sizes[0];
+    for (auto s : sizes)
+        if (s != k)
+            throw py::value_error(
+                "the faces differ in size, use face_indices_flat()");
+
+    py::array_t<IndexType> result(std::vector<py::ssize_t>{
+        py::ssize_t(sizes.size()), py::ssize_t(k)});
+    std::copy(indices.begin(), indices.end(), result.mutable_data());
+    return result;
+}
+
+// build \p mesh from (n, 3) positions and (m, k) face indices
+void from_arrays(SurfaceMesh& mesh,
+                 py::array_t<Scalar, py::array::c_style | py::array::forcecast>
+                     positions,
+                 py::array_t<IndexType, py::array::c_style |
+                                            py::array::forcecast>
+                     faces)
+{
+    if (positions.ndim() != 2 || positions.shape(1) != 3)
+        throw py::value_error("positions must have shape (n, 3)");
+    if (faces.ndim() != 2 || faces.shape(1) < 3)
+        throw py::value_error("faces must have shape (m, k) with k >= 3");
+
+    std::vector<Point> points(positions.shape(0));
+    std::memcpy(points.data(), positions.data(),
+                points.size() * sizeof(Point));
+    std::vector<IndexType> indices(faces.data(), faces.data() + faces.size());
+    std::vector<IndexType> sizes;
+    if (faces.shape(1) != 3)
+        sizes.assign(faces.shape(0), IndexType(faces.shape(1)));
+
+    bool ok;
+    {
+        py::gil_scoped_release release;
+        ok = mesh.build_from_indices(points, indices, sizes);
+    }
+    if (!ok)
+        throw py::value_error("some faces could not be added");
+}
+
+} // namespace
+
+//=============================================================================
+
+PYBIND11_MODULE(pmp, m)
+{
+    m.doc() = "Polygon Mesh Processing Library";
+    m.attr("Scalar") = py::dtype::of<Scalar>();
+    m.attr("IndexType") = py::dtype::of<IndexType>();
+
+    m.def("set_num_threads", &set_num_threads,
+          "Set the number of threads of the parallel loops, 0 for all cores");
+
+    py::class_<SurfaceMesh>(m, "SurfaceMesh")
+        .def(py::init<>())
+        .def(
+            "read",
+            [](SurfaceMesh& mesh, const std::string& filename) {
+                return mesh.read(filename);
+            },
+            py::call_guard<py::gil_scoped_release>())
+        .def(
+            "write",
+            [](const SurfaceMesh& mesh, const std::string& filename) {
+                return mesh.write(filename);
+            },
+            py::call_guard<py::gil_scoped_release>())
+        .def("from_arrays", &from_arrays, py::arg("positions"),
+             py::arg("faces"),
+             "Replace the mesh by (n, 3) positions and (m, k) face indices")
+        .def("n_vertices", &SurfaceMesh::n_vertices)
+        .def("n_edges", &SurfaceMesh::n_edges)
+        .def("n_faces", &SurfaceMesh::n_faces)
+        .def("is_triangle_mesh", &SurfaceMesh::is_triangle_mesh)
+        .def("garbage_collection", &SurfaceMesh::garbage_collection,
+             "Remove deleted elements, which invalidates all views")
+        .def("positions",
+             [](py::object self) {
+                 SurfaceMesh& mesh = self.cast<SurfaceMesh&>();
+                 return property_view<Vertex>(mesh, "v:point", self);
+             },
+             "The (n, 3) vertex positions, without copy")
+        .def("face_indices", &face_index_array,
+             "The (n_faces, k) vertex indices of meshes with k-gons only")
+        .def("face_indices_flat",
+             [](const SurfaceMesh& mesh) {
+                 std::vector<IndexType> indices, sizes;
+                 {
+                     py::gil_scoped_release release;
+                     face_indices(mesh, indices, sizes);
+                 }
+                 return py::make_tuple(
+                     py::array_t<IndexType>(indices.size(), indices.data()),
+                     py::array_t<IndexType>(sizes.size(), sizes.data()));
+             },
+             "The concatenated vertex indices of all faces and the number "
+             "of vertices of each face")
+        .def("vertex_property",
+             [](py::object self, const std::string& name) {
+                 return property_view<Vertex>(self.cast<SurfaceMesh&>(),
+                                              name, self);
+             })
+        .def("halfedge_property",
+             [](py::object self, const std::string& name) {
+                 return property_view<Halfedge>(self.cast<SurfaceMesh&>(),
+                                                name, self);
+             })
+        .def("edge_property",
+             [](py::object self, const std::string& name) {
+                 return property_view<Edge>(self.cast<SurfaceMesh&>(), name,
+                                            self);
+             })
+        .def("face_property",
+             [](py::object self, const std::string& name) {
+                 return property_view<Face>(self.cast<SurfaceMesh&>(), name,
+                                            self);
+             })
+        .def(
+            "add_vertex_property",
+            [](py::object self, const std::string& name, py::dtype dtype,
+               size_t components) {
+                return add_property<Vertex>(self.cast<SurfaceMesh&>(), name,
+                                            dtype, components, self);
+            },
+            py::arg("name"), py::arg("dtype"), py::arg("components") = 1)
+        .def(
+            "add_halfedge_property",
+            [](py::object self, const std::string& name, py::dtype dtype,
+               size_t components) {
+                return add_property<Halfedge>(self.cast<SurfaceMesh&>(),
+                                              name, dtype, components, self);
+            },
+            py::arg("name"), py::arg("dtype"), py::arg("components") = 1)
+        .def(
+            "add_edge_property",
+            [](py::object self, const std::string& name, py::dtype dtype,
+               size_t components) {
+                return add_property<Edge>(self.cast<SurfaceMesh&>(), name,
+                                          dtype, components, self);
+            },
+            py::arg("name"), py::arg("dtype"), py::arg("components") = 1)
+        .def(
+            "add_face_property",
+            [](py::object self, const std::string& name, py::dtype dtype,
+               size_t components) {
+                return add_property<Face>(self.cast<SurfaceMesh&>(), name,
+                                          dtype, components, self);
+            },
+            py::arg("name"), py::arg("dtype"), py::arg("components") = 1)
+        .def("vertex_properties", &SurfaceMesh::vertex_properties)
+        .def("halfedge_properties", &SurfaceMesh::halfedge_properties)
+        .def("edge_properties", &SurfaceMesh::edge_properties)
+        .def("face_properties", &SurfaceMesh::face_properties);
+
+    // the algorithms run without the GIL, other Python threads continue
+    m.def(
+        "compute_vertex_normals",
+        [](SurfaceMesh& mesh) { SurfaceNormals::compute_vertex_normals(mesh); },
+        py::call_guard<py::gil_scoped_release>(),
+        "Compute the vertex property \"v:normal\"");
+    m.def(
+        "compute_face_normals",
+        [](SurfaceMesh& mesh) { SurfaceNormals::compute_face_normals(mesh); },
+        py::call_guard<py::gil_scoped_release>(),
+        "Compute the face property \"f:normal\"");
+    m.def(
+        "explicit_smoothing",
+        [](SurfaceMesh& mesh, unsigned int iterations, bool uniform) {
+            SurfaceSmoothing(mesh).explicit_smoothing(iterations, uniform);
+        },
+        py::arg("mesh"), py::arg("iterations") = 10,
+        py::arg("uniform_laplace") = false,
+        py::call_guard<py::gil_scoped_release>());
+    m.def(
+        "implicit_smoothing",
+        [](SurfaceMesh& mesh, Scalar timestep, bool uniform) {
+            SurfaceSmoothing(mesh).implicit_smoothing(timestep, uniform);
+        },
+        py::arg("mesh"), py::arg("timestep") = 0.001,
+        py::arg("uniform_laplace") = false,
+        py::call_guard<py::gil_scoped_release>());
+    m.def(
+        "simplify",
+        [](SurfaceMesh& mesh, unsigned int n_vertices) {
+            SurfaceSimplification simplification(mesh);
+            simplification.initialize();
+            simplification.simplify(n_vertices);
+        },
+        py::arg("mesh"), py::arg("n_vertices"),
+        py::call_guard<py::gil_scoped_release>(),
+        "Simplify to n_vertices, call garbage_collection() afterwards");
+    m.def(
+        "uniform_remeshing",
+        [](SurfaceMesh& mesh, Scalar edge_length, unsigned int iterations) {
+            SurfaceRemeshing(mesh).uniform_remeshing(edge_length,
+                                                     iterations);
+        },
+        py::arg("mesh"), py::arg("edge_length"), py::arg("iterations") = 10,
+        py::call_guard<py::gil_scoped_release>());
+}
@@ -0,0 +1,220 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+// clang-format off
+
+// The shaders of SurfaceMeshCompute, with one invocation per vertex. The
+// neighbors of vertex v are neighbors[offsets[v]] ... neighbors[offsets[v+1]-1]
+// in counter-clockwise order, faces[k] is 1 if the face between neighbor k
+// and the next one exists.
+
+#define PMP_COMPUTE_BUFFERS \
+    "layout (local_size_x = 256) in;\n" \
+    "\n" \
+    "layout (std430, binding = 0) readonly buffer Source\n" \
+    "{ vec4 source[]; };\n" \
+    "layout (std430, binding = 2) readonly buffer Offsets\n" \
+    "{ uint offsets[]; };\n" \
+    "layout (std430, binding = 3) readonly buffer Neighbors\n" \
+    "{ uint neighbors[]; };\n" \
+    "layout (std430, binding = 6) readonly buffer Faces { uint faces[]; };\n" \
+    "\n" \
+    "uniform int n_vertices;\n" \
+    "\n"
+
+// one step of explicit smoothing from source to target
+static const char* smoothing_cshader =
+    "#version 430\n"
+    "\n"
+    PMP_COMPUTE_BUFFERS
+    "layout (std430, binding = 1) writeonly buffer Target { vec4 target[]; };\n"
+    "layout (std430, binding = 4) readonly buffer Weights\n"
+    "{ float weights[]; };\n"
+    "layout (std430, binding = 5) readonly buffer Centers\n"
+    "{ float centers[]; };\n"
+    "\n"
+    "void main()\n"
+    "{\n"
+    "    uint v = gl_GlobalInvocationID.x;\n"
+    "    if (int(v) >= n_vertices) return;\n"
+    "\n"
+    "    vec4 p = centers[v] * source[v];\n"
+    "    for (uint k = offsets[v]; k < offsets[v + 1]; ++k)\n"
+    "        p += weights[k] * source[neighbors[k]];\n"
+    "    target[v] = p;\n"
+    "}";
+
+// angle-weighted vertex normals, as SurfaceNormals::compute_vertex_normal()
+static const char* normals_cshader =
+    "#version 430\n"
+    "\n"
+    PMP_COMPUTE_BUFFERS
+    "layout (std430, binding = 7) writeonly buffer Normals\n"
+    "{ vec4 normals[]; };\n"
+    "\n"
+    "const float min_float = 1.175494e-38;\n"
+    "\n"
+    "void main()\n"
+    "{\n"
+    "    uint v = gl_GlobalInvocationID.x;\n"
+    "    if (int(v) >= n_vertices) return;\n"
+    "\n"
+    "    vec3 p0 = source[v].xyz;\n"
+    "    vec3 nn = vec3(0.0);\n"
+    "    uint begin = offsets[v], end = offsets[v + 1];\n"
+    "    for (uint k = begin; k < end; ++k)\n"
+    "    {\n"
+    "        if (faces[k] == 0u) continue;\n"
+    "        uint l = (k + 1u == end) ? begin : k + 1u;\n"
+    "        vec3 p1 = source[neighbors[k]].xyz - p0;\n"
+    "        vec3 p2 = source[neighbors[l]].xyz - p0;\n"
+    "        float denom = sqrt(dot(p1, p1) * dot(p2, p2));\n"
+    "        if (denom > min_float)\n"
+    "        {\n"
+    "            float angle = acos(clamp(dot(p1, p2) / denom, -1.0, 1.0));\n"
+    "            vec3 n = cross(p1, p2);\n"
+    "            denom = length(n);\n"
+    "            if (denom > min_float) nn += n * (angle / denom);\n"
+    "        }\n"
+    "    }\n"
+    "    float l = length(nn);\n"
+    "    normals[v] = vec4(l > min_float ? nn / l : nn, 0.0);\n"
+    "}";
+
+// the cotan weight and Voronoi area terms of SurfaceCurvature::analyze()
+#define PMP_CURVATURE_FUNCTIONS \
+    "layout (std430, binding = 8) buffer Curvatures { vec2 curvatures[]; };\n" \
+    "\n" \
+    "const float min_float = 1.175494e-38;\n" \
+    "\n" \
+    "float cotan(vec3 d0, vec3 d1)\n" \
+    "{\n" \
+    "    float area = length(cross(d0, d1));\n" \
+    "    if (area <= min_float) return 0.0;\n" \
+    "    return clamp(dot(d0, d1) / area, -19.1, 19.1);\n" \
+    "}\n" \
+    "\n" \
+    "// the cotan weight of the edge from p0 to neighbor k\n" \
+    "float edge_weight(vec3 p0, uint begin, uint end, uint k)\n" \
+    "{\n" \
+    "    vec3 p1 = source[neighbors[k]].xyz;\n" \
+    "    uint next = (k + 1u == end) ? begin : k + 1u;\n" \
+    "    uint prev = (k == begin) ? end - 1u : k - 1u;\n" \
+    "    float weight = 0.0;\n" \
+    "    if (faces[k] != 0u)\n" \
+    "    {\n" \
+    "        vec3 p2 = source[neighbors[next]].xyz;\n" \
+    "        weight += cotan(p0 - p2, p1 - p2);\n" \
+    "    }\n" \
+    "    if (faces[prev] != 0u)\n" \
+    "    {\n" \
+    "        vec3 p2 = source[neighbors[prev]].xyz;\n" \
+    "        weight += cotan(p0 - p2, p1 - p2);\n" \
+    "    }\n" \
+    "    return weight;\n" \
+    "}\n" \
+    "\n" \
+    "bool is_boundary(uint v)\n" \
+    "{\n" \
+    "    for (uint k = offsets[v]; k < offsets[v + 1]; ++k)\n" \
+    "        if (faces[k] == 0u) return true;\n" \
+    "    return false;\n" \
+    "}\n" \
+    "\n"
+
+// minimum and maximum curvature of interior vertices
+static const char* curvature_cshader =
+    "#version 430\n"
+    "\n"
+    PMP_COMPUTE_BUFFERS
+    PMP_CURVATURE_FUNCTIONS
+    "void main()\n"
+    "{\n"
+    "    uint v = gl_GlobalInvocationID.x;\n"
+    "    if (int(v) >= n_vertices) return;\n"
+    "\n"
+    "    uint begin = offsets[v], end = offsets[v + 1];\n"
+    "    if (begin == end || is_boundary(v))\n"
+    "    {\n"
+    "        curvatures[v] = vec2(0.0);\n"
+    "        return;\n"
+    "    }\n"
+    "\n"
+    "    vec3 p0 = source[v].xyz;\n"
+    "    vec3 laplace = vec3(0.0);\n"
+    "    float sum_weights = 0.0, sum_angles = 0.0, area = 0.0;\n"
+    "    for (uint k = begin; k < end; ++k)\n"
+    "    {\n"
+    "        uint l = (k + 1u == end) ? begin : k + 1u;\n"
+    "        vec3 q = source[neighbors[k]].xyz;\n"
+    "        vec3 r = source[neighbors[l]].xyz;\n"
+    "\n"
+    "        float weight = edge_weight(p0, begin, end, k);\n"
+    "        sum_weights += weight;\n"
+    "        laplace += weight * q;\n"
+    "        float cosine = dot(normalize(q - p0), normalize(r - p0));\n"
+    "        sum_angles += acos(clamp(cosine, -0.9986, 0.9986));\n"
+    "\n"
+    "        // mixed Voronoi area of the triangle (p0, q, r)\n"
+    "        vec3 pq = q - p0, qr = r - q, pr = r - p0;\n"
+    "        float triangle_area = length(cross(pq, pr));\n"
+    "        if (triangle_area <= min_float) continue;\n"
+    "        float dotp = dot(pq, pr);\n"
+    "        float dotq = -dot(qr, pq);\n"
+    "        float dotr = dot(qr, pr);\n"
+    "        if (dotp < 0.0)\n"
+    "            area += 0.25 * triangle_area;\n"
+    "        else if (dotq < 0.0 || dotr < 0.0)\n"
+    "            area += 0.125 * triangle_area;\n"
+    "        else\n"
+    "            area += 0.125 * (dot(pr, pr) *\n"
+    "                             clamp(dotq / triangle_area, -19.1, 19.1) +\n"
+    "                             dot(pq, pq) *\n"
+    "                             clamp(dotr / triangle_area, -19.1, 19.1));\n"
+    "    }\n"
+    "    laplace -= sum_weights * p0;\n"
+    "    laplace /= 2.0 * area;\n"
+    "\n"
+    "    float mean = 0.5 * length(laplace);\n"
+    "    float gauss = (2.0 * 3.14159265 - sum_angles) / area;\n"
+    "    float s = sqrt(max(0.0, mean * mean - gauss));\n"
+    "    curvatures[v] = vec2(mean - s, mean + s);\n"
+    "}";
+
+// boundary vertices interpolate the curvature of their interior neighbors
+static const char* boundary_curvature_cshader =
+    "#version 430\n"
+    "\n"
+    PMP_COMPUTE_BUFFERS
+    PMP_CURVATURE_FUNCTIONS
+    "void main()\n"
+    "{\n"
+    "    uint v = gl_GlobalInvocationID.x;\n"
+    "    if (int(v) >= n_vertices || !is_boundary(v)) return;\n"
+    "\n"
+    "    vec3 p0 = source[v].xyz;\n"
+    "    vec2 curvature = vec2(0.0);\n"
+    "    float sum_weights = 0.0;\n"
+    "    uint begin = offsets[v], end = offsets[v + 1];\n"
+    "    for (uint k = begin; k < end; ++k)\n"
+    "    {\n"
+    "        uint vv = neighbors[k];\n"
+    "        if (is_boundary(vv)) continue;\n"
+    "        float weight = edge_weight(p0, begin, end, k);\n"
+    "        sum_weights += weight;\n"
+    "        curvature += weight * curvatures[vv];\n"
+    "    }\n"
+    "    if (sum_weights != 0.0) curvature /= sum_weights;\n"
+    "    curvatures[v] = curvature;\n"
+    "}";
+
+#undef PMP_CURVATURE_FUNCTIONS
+#undef PMP_COMPUTE_BUFFERS
+
+// clang-format on
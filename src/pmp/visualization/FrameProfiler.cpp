@@ -0,0 +1,382 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/visualization/FrameProfiler.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <fstream>
+
+#define IMGUI_DISABLE_OBSOLETE_FUNCTIONS
+#include <imgui.h>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+namespace {
+
+// number of frames in the histogram
+const size_t n_frames = 240;
+
+// number of uploads shown
+const size_t n_uploads = 8;
+
+// bound for the number of recorded trace events
+const size_t max_events = 1 << 20;
+
+// a string as JSON string literal
+std::string json_string(const std::string& s)
+{
+    std::string result = "\"";
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\')
+            result += '\\';
+        if (c >= ' ')
+            result += c;
+    }
+    return result + "\"";
+}
+
+} // namespace
+
+//=============================================================================
+
+FrameProfiler::FrameProfiler()
+    : start_time_(clock::now()),
+      frame_start_(0.0),
+      last_frame_start_(-1.0),
+      frame_(0),
+      frame_times_(n_frames, 0.0f),
+      frame_intervals_(n_frames, 0.0f),
+      frame_index_(0),
+      current_pass_(-1),
+      tracing_(false)
+{
+}
+
+//-----------------------------------------------------------------------------
+
+FrameProfiler::~FrameProfiler()
+{
+    clear();
+}
+
+//-----------------------------------------------------------------------------
+
+void FrameProfiler::clear()
+{
+#ifndef __EMSCRIPTEN__
+    for (auto& pass : passes_)
+        glDeleteQueries(n_query_frames, pass.queries);
+#endif
+    passes_.clear();
+    current_pass_ = -1;
+    uploads_.clear();
+    memory_.clear();
+    events_.clear();
+    std::fill(frame_times_.begin(), frame_times_.end(), 0.0f);
+    std::fill(frame_intervals_.begin(), frame_intervals_.end(), 0.0f);
+    last_frame_start_ = -1.0;
+}
+
+//-----------------------------------------------------------------------------
+
+double FrameProfiler::now() const
+{
+    return std::chrono::duration<double, std::micro>(clock::now() -
+                                                     start_time_)
+        .count();
+}
+
+//-----------------------------------------------------------------------------
+
+bool FrameProfiler::has_timer_queries() const
+{
+#ifndef __EMSCRIPTEN__
+    return GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+#else
+    return false;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+void FrameProfiler::begin_frame()
+{
+    ++frame_;
+    frame_start_ = now();
+    if (last_frame_start_ >= 0.0)
+        frame_intervals_[frame_index_] =
+            float(1e-3 * (frame_start_ - last_frame_start_));
+    last_frame_start_ = frame_start_;
+
+    // the queries of this slot were issued n_query_frames ago
+    read_queries(frame_ % n_query_frames, false);
+}
+
+//-----------------------------------------------------------------------------
+
+void FrameProfiler::end_frame()
+{
+    const double end = now();
+    frame_times_[frame_index_] = float(1e-3 * (end - frame_start_));
+    frame_index_ = (frame_index_ + 1) % n_frames;
+    record({"Frame", "cpu", frame_start_, end - frame_start_, 0});
+}
+
+//-----------------------------------------------------------------------------
+
+void FrameProfiler::begin_pass(const std::string& name)
+{
+    if (!has_timer_queries() || current_pass_ >= 0)
+        return;
+
+#ifndef __EMSCRIPTEN__
+    auto it = std::find_if(passes_.begin(), passes_.end(),
+                           [&](const Pass& p) { return p.name == name; });
+    if (it == passes_.end())
+    {
+        Pass pass;
+        pass.name = name;
+        glGenQueries(n_query_frames, pass.queries);
+        std::fill(pass.pending, pass.pending + n_query_frames, false);
+        pass.gpu_time = -1.0;
+        it = passes_.insert(passes_.end(), pass);
+    }
+    current_pass_ = int(it - passes_.begin());
+
+    // the query may still be pending if the pass was not drawn every frame
+    const int slot = frame_ % n_query_frames;
+    if (it->pending[slot])
+        read_queries(slot, true);
+
+    glBeginQuery(GL_TIME_ELAPSED, it->queries[slot]);
+    it->pending[slot] = true;
+    it->issued[slot] = frame_start_;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+void FrameProfiler::end_pass()
+{
+    if (current_pass_ < 0)
+        return;
+
+#ifndef __EMSCRIPTEN__
+    glEndQuery(GL_TIME_ELAPSED);
+#endif
+    current_pass_ = -1;
+}
+
+//-----------------------------------------------------------------------------
+
+void FrameProfiler::read_queries(int slot, bool wait)
+{
+#ifndef __EMSCRIPTEN__
+    for (auto& pass : passes_)
+    {
+        if (!pass.pending[slot])
+            continue;
+
+        GLuint available = GL_TRUE;
+        if (!wait)
+            glGetQueryObjectuiv(pass.queries[slot],
+                                GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            continue;
+
+        GLuint64 ns;
+        glGetQueryObjectui64v(pass.queries[slot], GL_QUERY_RESULT, &ns);
+        pass.pending[slot] = false;
+        pass.gpu_time = 1e-6 * double(ns);
+
+        // GPU durations start at their frame in the trace
+        record({pass.name, "gpu", pass.issued[slot], 1e-3 * double(ns), 0});
+    }
+#else
+    (void)slot;
+    (void)wait;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+void FrameProfiler::record_upload(const std::string& name, size_t bytes,
+                                  double ms)
+{
+    if (uploads_.size() == n_uploads)
+        uploads_.erase(uploads_.begin());
+    uploads_.push_back({name, bytes, ms});
+    record({name, "upload", now() - 1e3 * ms, 1e3 * ms, bytes});
+}
+
+//-----------------------------------------------------------------------------
+
+void FrameProfiler::set_memory(const std::string& name, size_t bytes)
+{
+    auto it = std::find_if(
+        memory_.begin(), memory_.end(),
+        [&](const std::pair<std::string, size_t>& m) { return m.first == name; });
+    if (it == memory_.end())
+        it = memory_.insert(memory_.end(), std::make_pair(name, size_t(0)));
+    else if (it->second == bytes)
+        return;
+    it->second = bytes;
+    record({name, "memory", now(), -1.0, bytes});
+}
+
+//-----------------------------------------------------------------------------
+
+std::vector<float> FrameProfiler::frame_times() const
+{
+    std::vector<float> times(frame_times_.begin() + frame_index_,
+                             frame_times_.end());
+    times.insert(times.end(), frame_times_.begin(),
+                 frame_times_.begin() + frame_index_);
+    return times;
+}
+
+//-----------------------------------------------------------------------------
+
+double FrameProfiler::gpu_time(const std::string& name) const
+{
+    for (const auto& pass : passes_)
+        if (pass.name == name)
+            return pass.gpu_time;
+    return -1.0;
+}
+
+//-----------------------------------------------------------------------------
+
+size_t FrameProfiler::memory() const
+{
+    size_t bytes = 0;
+    for (const auto& m : memory_)
+        bytes += m.second;
+    return bytes;
+}
+
+//-----------------------------------------------------------------------------
+
+void FrameProfiler::set_tracing(bool b)
+{
+    if (b && !tracing_)
+        events_.clear();
+    tracing_ = b;
+}
+
+//-----------------------------------------------------------------------------
+
+void FrameProfiler::record(const Event& event)
+{
+    if (tracing_ && events_.size() < max_events)
+        events_.push_back(event);
+}
+
+//-----------------------------------------------------------------------------
+
+bool FrameProfiler::write_trace(const char* filename) const
+{
+    std::ofstream ofs(filename);
+    if (!ofs)
+        return false;
+
+    // one thread each for the CPU frames, GPU passes, and uploads
+    ofs << "{\"traceEvents\":[\n";
+    for (size_t i = 0; i < events_.size(); ++i)
+    {
+        const Event& e = events_[i];
+        const std::string cat = e.category;
+        const int tid = cat == "cpu" ? 0 : (cat == "gpu" ? 1 : 2);
+
+        ofs << "{\"name\":" << json_string(e.name) << ",\"cat\":\"" << cat
+            << "\",\"pid\":0,\"tid\":" << tid << ",\"ts\":" << e.start;
+        if (e.duration < 0.0)
+            ofs << ",\"ph\":\"C\",\"args\":{\"bytes\":" << e.bytes << "}}";
+        else
+            ofs << ",\"ph\":\"X\",\"dur\":" << e.duration
+                << ",\"args\":{\"bytes\":" << e.bytes << "}}";
+        ofs << (i + 1 < events_.size() ? ",\n" : "\n");
+    }
+    ofs << "],\"displayTimeUnit\":\"ms\"}\n";
+
+    return bool(ofs);
+}
+
+//-----------------------------------------------------------------------------
+
+void FrameProfiler::process_imgui()
+{
+    ImGui::SetNextWindowPos(ImVec2(10, 300), ImGuiCond_Once);
+    ImGui::Begin("Performance", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
+
+    // CPU frame times of the last frames
+    const std::vector<float> times = frame_times();
+    float tmax = 0.0f, tsum = 0.0f, isum = 0.0f;
+    for (size_t i = 0; i < n_frames; ++i)
+    {
+        tmax = std::max(tmax, frame_times_[i]);
+        tsum += frame_times_[i];
+        isum += frame_intervals_[i];
+    }
+    char overlay[64];
+    snprintf(overlay, sizeof(overlay), "avg %.2f ms, max %.2f ms",
+             tsum / n_frames, tmax);
+    ImGui::PlotHistogram("CPU", times.data(), int(times.size()), 0, overlay,
+                         0.0f, std::max(tmax, 16.7f), ImVec2(240, 60));
+    if (isum > 0.0f)
+        ImGui::Text("%.1f fps", 1000.0f * n_frames / isum);
+
+    // GPU times of the draw passes
+    ImGui::Separator();
+    if (!has_timer_queries())
+        ImGui::Text("GPU timers not available");
+    for (const auto& pass : passes_)
+        ImGui::BulletText("GPU %s: %.3f ms", pass.name.c_str(),
+                          pass.gpu_time);
+
+    // latest buffer uploads
+    if (!uploads_.empty())
+    {
+        ImGui::Separator();
+        for (const auto& u : uploads_)
+            ImGui::BulletText("%s: %.2f MB in %.2f ms", u.name.c_str(),
+                              u.bytes / (1024.0 * 1024.0), u.time);
+    }
+
+    // GPU memory
+    if (!memory_.empty())
+    {
+        ImGui::Separator();
+        for (const auto& m : memory_)
+            ImGui::BulletText("%s: %.2f MB", m.first.c_str(),
+                              m.second / (1024.0 * 1024.0));
+    }
+
+    // record and export a trace
+    ImGui::Separator();
+    bool record = tracing_;
+    if (ImGui::Checkbox("Record Trace", &record))
+        set_tracing(record);
+    ImGui::SameLine();
+    if (ImGui::Button("Write 'trace.json'"))
+        write_trace("trace.json");
+    ImGui::Text("%d events", int(events_.size()));
+
+    ImGui::End();
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -0,0 +1,158 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <pmp/visualization/GL.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \addtogroup visualization visualization
+//! @{
+
+//=============================================================================
+
+//! \brief Frame time and GPU timer instrumentation of a Window.
+//! \details Measures the CPU time and interval of each frame, the GPU time of
+//! draw passes by GL_TIME_ELAPSED queries, and collects buffer uploads and
+//! the GPU memory reported by the viewer. The GPU times are read a few
+//! frames later to avoid stalls. All events can be recorded and written to a
+//! trace file in the Chrome trace event format, e.g., for chrome://tracing
+//! or Perfetto. GPU timers are not available for WebGL.
+class FrameProfiler
+{
+public:
+    //! constructor, does not require an OpenGL context
+    FrameProfiler();
+
+    //! destructor, call clear() before the OpenGL context is destroyed
+    ~FrameProfiler();
+
+    //! delete the GPU timer queries and all statistics
+    void clear();
+
+    //! start the measurement of a frame, collects finished GPU timers
+    void begin_frame();
+
+    //! stop the CPU time measurement of the current frame
+    void end_frame();
+
+    //! \brief Start the GPU time measurement of the draw pass \p name.
+    //! \details Passes cannot be nested, end each by end_pass().
+    void begin_pass(const std::string& name);
+
+    //! stop the GPU time measurement of the current draw pass
+    void end_pass();
+
+    //! record an upload of \p bytes to OpenGL buffers in \p ms milliseconds
+    void record_upload(const std::string& name, size_t bytes, double ms);
+
+    //! set the GPU memory in bytes currently used by \p name
+    void set_memory(const std::string& name, size_t bytes);
+
+    //! the CPU times of the last frames in ms, the oldest first
+    std::vector<float> frame_times() const;
+
+    //! the GPU time of the draw pass \p name in ms, -1 if not measured
+    double gpu_time(const std::string& name) const;
+
+    //! the total GPU memory in bytes set by set_memory()
+    size_t memory() const;
+
+    //! is recording of trace events enabled?
+    bool tracing() const { return tracing_; }
+
+    //! enable or disable recording of trace events, enabling clears them
+    void set_tracing(bool b);
+
+    //! \brief Write the recorded events to \p filename.
+    //! \details The file is in the JSON trace event format.
+    bool write_trace(const char* filename) const;
+
+    //! show the statistics in an ImGui window
+    void process_imgui();
+
+private:
+    typedef std::chrono::steady_clock clock;
+
+    //! number of frames the GPU timers are read later
+    static const int n_query_frames = 4;
+
+    //! the GPU timers of a draw pass, one per frame in flight
+    struct Pass
+    {
+        std::string name;
+        GLuint queries[n_query_frames];
+        bool pending[n_query_frames];
+        double issued[n_query_frames]; // CPU time of the frame in us
+        double gpu_time;               // last GPU time in ms
+    };
+
+    //! a buffer upload
+    struct Upload
+    {
+        std::string name;
+        size_t bytes;
+        double time; // ms
+    };
+
+    //! an entry of the trace, a duration or a memory counter
+    struct Event
+    {
+        std::string name;
+        const char* category;
+        double start;    // us
+        double duration; // us, negative for counters
+        size_t bytes;
+    };
+
+    //! microseconds since the construction
+    double now() const;
+
+    //! read the results of the pending queries of frame slot \p slot
+    void read_queries(int slot, bool wait);
+
+    //! add \p event to the trace, if enabled
+    void record(const Event& event);
+
+    bool has_timer_queries() const;
+
+    clock::time_point start_time_;
+    double frame_start_;
+    double last_frame_start_;
+    unsigned int frame_;
+
+    // CPU times and intervals of the last frames, a ring buffer
+    std::vector<float> frame_times_;
+    std::vector<float> frame_intervals_;
+    size_t frame_index_;
+
+    std::vector<Pass> passes_;
+    int current_pass_;
+
+    std::vector<Upload> uploads_;
+    std::vector<std::pair<std::string, size_t>> memory_;
+
+    bool tracing_;
+    std::vector<Event> events_;
+};
+
+//=============================================================================
+//! @}
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -0,0 +1,147 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+// clang-format off
+
+// The limit surface of SurfaceMeshGL, used with phong_fshader. Each patch
+// holds the Bezier control points of one face: 16 of a bicubic patch if
+// QUADS is defined, 15 of a quartic triangle otherwise, see
+// SurfaceMeshGL::update_limit_patches(). The control points of a triangle
+// are ordered by the exponent j of v and then by the exponent i of u, those
+// of a quad by the index j in v and then i in u. The sources are prefixed
+// by the version and the QUADS define. Requires OpenGL 4.0, not available
+// for WebGL.
+
+static const char* limit_vshader =
+    "layout (location=0) in vec3 v_position;\n"
+    "\n"
+    "void main()\n"
+    "{\n"
+    "    gl_Position = vec4(v_position, 1.0);\n"
+    "}\n";
+
+
+static const char* limit_tcshader =
+    "#ifdef QUADS\n"
+    "layout (vertices = 16) out;\n"
+    "#else\n"
+    "layout (vertices = 15) out;\n"
+    "#endif\n"
+    "\n"
+    "uniform float tessellation_level;\n"
+    "\n"
+    "void main()\n"
+    "{\n"
+    "    gl_out[gl_InvocationID].gl_Position = gl_in[gl_InvocationID].gl_Position;\n"
+    "\n"
+    "    // equal levels on all edges, such that neighbors match\n"
+    "    if (gl_InvocationID == 0)\n"
+    "    {\n"
+    "        gl_TessLevelOuter[0] = tessellation_level;\n"
+    "        gl_TessLevelOuter[1] = tessellation_level;\n"
+    "        gl_TessLevelOuter[2] = tessellation_level;\n"
+    "        gl_TessLevelOuter[3] = tessellation_level;\n"
+    "        gl_TessLevelInner[0] = tessellation_level;\n"
+    "        gl_TessLevelInner[1] = tessellation_level;\n"
+    "    }\n"
+    "}\n";
+
+
+static const char* limit_teshader =
+    "#ifdef QUADS\n"
+    "layout (quads, equal_spacing, ccw) in;\n"
+    "#else\n"
+    "layout (triangles, equal_spacing, ccw) in;\n"
+    "#endif\n"
+    "\n"
+    "out vec3 v2f_normal;\n"
+    "out vec2 v2f_tex;\n"
+    "out vec3 v2f_view;\n"
+    "\n"
+    "uniform mat4 modelview_projection_matrix;\n"
+    "uniform mat4 modelview_matrix;\n"
+    "uniform mat3 normal_matrix;\n"
+    "\n"
+    "// x^n, with x^0 = 1 also for x = 0\n"
+    "float power(float x, int n)\n"
+    "{\n"
+    "    float p = 1.0;\n"
+    "    for (int k = 0; k < n; ++k) p *= x;\n"
+    "    return p;\n"
+    "}\n"
+    "\n"
+    "// the cubic Bernstein polynomials at t and their derivatives\n"
+    "void bernstein(float t, out vec4 b, out vec4 d)\n"
+    "{\n"
+    "    float s = 1.0 - t;\n"
+    "    b = vec4(s * s * s, 3.0 * s * s * t, 3.0 * s * t * t, t * t * t);\n"
+    "    d = vec4(-3.0 * s * s, 3.0 * s * (s - 2.0 * t),\n"
+    "             3.0 * t * (2.0 * s - t), 3.0 * t * t);\n"
+    "}\n"
+    "\n"
+    "void main()\n"
+    "{\n"
+    "    vec3 p  = vec3(0.0);\n"
+    "    vec3 du = vec3(0.0);\n"
+    "    vec3 dv = vec3(0.0);\n"
+    "\n"
+    "#ifdef QUADS\n"
+    "    float u = gl_TessCoord.x;\n"
+    "    float v = gl_TessCoord.y;\n"
+    "    vec4 bu, bv, tu, tv;\n"
+    "    bernstein(u, bu, tu);\n"
+    "    bernstein(v, bv, tv);\n"
+    "    for (int j = 0; j < 4; ++j)\n"
+    "    {\n"
+    "        for (int i = 0; i < 4; ++i)\n"
+    "        {\n"
+    "            vec3 c = gl_in[i + 4 * j].gl_Position.xyz;\n"
+    "            p  += bu[i] * bv[j] * c;\n"
+    "            du += tu[i] * bv[j] * c;\n"
+    "            dv += bu[i] * tv[j] * c;\n"
+    "        }\n"
+    "    }\n"
+    "#else\n"
+    "    // barycentric coordinates (w, u, v) of the corners\n"
+    "    float w = gl_TessCoord.x;\n"
+    "    float u = gl_TessCoord.y;\n"
+    "    float v = gl_TessCoord.z;\n"
+    "    const float factorial[5] = float[5](1.0, 1.0, 2.0, 6.0, 24.0);\n"
+    "    int k = 0;\n"
+    "    for (int j = 0; j <= 4; ++j)\n"
+    "    {\n"
+    "        for (int i = 0; i <= 4 - j; ++i, ++k)\n"
+    "        {\n"
+    "            int l = 4 - i - j;\n"
+    "            float c = 24.0 / (factorial[i] * factorial[j] * factorial[l]);\n"
+    "            float ui = power(u, i), vj = power(v, j), wl = power(w, l);\n"
+    "\n"
+    "            // w = 1 - u - v depends on u and v\n"
+    "            float dui = (i > 0) ? float(i) * power(u, i - 1) : 0.0;\n"
+    "            float dvj = (j > 0) ? float(j) * power(v, j - 1) : 0.0;\n"
+    "            float dwl = (l > 0) ? float(l) * power(w, l - 1) : 0.0;\n"
+    "\n"
+    "            vec3 b = c * gl_in[k].gl_Position.xyz;\n"
+    "            p  += ui * vj * wl * b;\n"
+    "            du += (dui * wl - ui * dwl) * vj * b;\n"
+    "            dv += (dvj * wl - vj * dwl) * ui * b;\n"
+    "        }\n"
+    "    }\n"
+    "#endif\n"
+    "\n"
+    "    v2f_normal  = normal_matrix * cross(du, dv);\n"
+    "    v2f_tex     = vec2(u, v);\n"
+    "    v2f_view    = -(modelview_matrix * vec4(p, 1.0)).xyz;\n"
+    "    gl_Position = modelview_projection_matrix * vec4(p, 1.0);\n"
+    "}\n";
+
+
+//=============================================================================
+// clang-format on
+//=============================================================================
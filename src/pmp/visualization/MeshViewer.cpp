@@ -9,10 +9,14 @@
 
 #include "MeshViewer.h"
 
+#include <pmp/SurfaceMeshStream.h>
+
 #include <imgui.h>
 
+#include <algorithm>
 #include <cfloat>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 
 //=============================================================================
@@ -21,8 +25,91 @@ namespace pmp {
 
 //=============================================================================
 
+namespace {
+
+// bound for the number of points of the preview
+const size_t max_preview_points = 2000000;
+
+// seconds between updates of the preview
+const double preview_interval = 0.25;
+
+} // namespace
+
+//=============================================================================
+
+//! Collects every n-th vertex streamed from a file for the preview.
+class MeshViewer::PreviewSink : public SurfaceMeshSink
+{
+public:
+    PreviewSink()
+        : stride_(1),
+          counter_(0),
+          n_points_(0),
+          vertices_known_(false),
+          stopped_(false)
+    {
+    }
+
+    bool begin(size_t n_vertices, size_t n_faces) override
+    {
+        (void)n_faces;
+        std::lock_guard<std::mutex> lock(mutex_);
+        stride_ = std::max(size_t(1), (n_vertices + max_preview_points - 1) /
+                                          max_preview_points);
+        vertices_known_ = n_vertices > 0;
+        return !stopped_;
+    }
+
+    bool vertices(const std::vector<Point>& points) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& p : points)
+        {
+            if (counter_++ % stride_ == 0 && n_points_ < max_preview_points)
+            {
+                points_.push_back(p);
+                ++n_points_;
+            }
+        }
+        return !stopped_ && n_points_ < max_preview_points;
+    }
+
+    bool faces(const std::vector<IndexType>&,
+               const std::vector<IndexType>&) override
+    {
+        // OFF and PLY store all vertices before the faces, OBJ mixes them
+        std::lock_guard<std::mutex> lock(mutex_);
+        return !stopped_ && !vertices_known_;
+    }
+
+    //! stop reading at the next batch
+    void stop()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopped_ = true;
+    }
+
+    //! the points collected since the last call
+    std::vector<Point> take()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<Point> points;
+        points.swap(points_);
+        return points;
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<Point> points_;
+    size_t stride_, counter_, n_points_;
+    bool vertices_known_;
+    bool stopped_;
+};
+
+//=============================================================================
+
 MeshViewer::MeshViewer(const char* title, int width, int height, bool showgui)
-    : TrackballViewer(title, width, height, showgui)
+    : TrackballViewer(title, width, height, showgui), lod_valid_(false)
 {
     // setup draw modes
     clear_draw_modes();
@@ -30,6 +117,7 @@ MeshViewer::MeshViewer(const char* title, int width, int height, bool showgui)
     add_draw_mode("Hidden Line");
     add_draw_mode("Smooth Shading");
     add_draw_mode("Texture");
+    add_draw_mode("Level of Detail");
     set_draw_mode("Smooth Shading");
 
     crease_angle_ = 90.0;
@@ -43,7 +131,11 @@ MeshViewer::MeshViewer(const char* title, int width, int height, bool showgui)
 
 //-----------------------------------------------------------------------------
 
-MeshViewer::~MeshViewer() = default;
+MeshViewer::~MeshViewer()
+{
+    // the streams of the preview are waited for by their futures
+    stop_preview();
+}
 
 //-----------------------------------------------------------------------------
 
@@ -52,34 +144,148 @@ bool MeshViewer::load_mesh(const char* filename)
     // load mesh
     if (mesh_.read(filename))
     {
-        // update scene center and bounds
-        BoundingBox bb = mesh_.bounds();
+        mesh_loaded(filename);
+        return true;
+    }
+
+    std::cerr << "Failed to read mesh from " << filename << " !" << std::endl;
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+
+bool MeshViewer::load_mesh_async(const char* filename)
+{
+#ifdef __EMSCRIPTEN__
+    return load_mesh(filename);
+#else
+    if (loading_)
+        loading_->cancel();
+    stop_preview();
+    loading_ = read_async(filename);
+    loading_filename_ = filename;
+
+    // stream the vertices of the file in parallel to show them early
+    auto sink = std::make_shared<PreviewSink>();
+    std::string name = filename;
+    preview_sink_ = sink;
+    preview_jobs_.push_back(std::async(std::launch::async, [sink, name]() {
+        return read_stream(name, *sink);
+    }));
+    preview_time_ = std::chrono::steady_clock::now();
+    return true;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+void MeshViewer::update_preview()
+{
+    auto now = std::chrono::steady_clock::now();
+    if (std::chrono::duration<double>(now - preview_time_).count() <
+        preview_interval)
+        return;
+    preview_time_ = now;
+
+    auto points = preview_sink_->take();
+    if (points.empty())
+        return;
+
+    // frame the scene by the first points, the final mesh will adjust it
+    const bool first = preview_.n_vertices() == 0;
+    for (const auto& p : points)
+        preview_.add_vertex(p);
+    preview_.update_opengl_buffers();
+    if (first)
+    {
+        BoundingBox bb = preview_.bounds();
         set_scene((vec3)bb.center(), 0.5 * bb.size());
+    }
+}
 
-        // compute face & vertex normals, update face indices
-        update_mesh();
+//-----------------------------------------------------------------------------
 
-        // set draw mode
-        if (mesh_.n_faces())
-        {
-            set_draw_mode("Solid Smooth");
-        }
-        else if (mesh_.n_vertices())
-        {
-            set_draw_mode("Points");
-        }
+void MeshViewer::stop_preview()
+{
+    if (preview_sink_)
+    {
+        preview_sink_->stop();
+        preview_sink_.reset();
+    }
+    if (preview_.n_vertices())
+    {
+        preview_.clear();
+        preview_.update_opengl_buffers();
+    }
+}
 
-        // print mesh statistic
-        std::cout << "Load " << filename << ": " << mesh_.n_vertices()
-                  << " vertices, " << mesh_.n_faces() << " faces\n";
+//-----------------------------------------------------------------------------
 
-        filename_ = filename;
-        crease_angle_ = mesh_.crease_angle();
-        return true;
+void MeshViewer::do_processing()
+{
+    // release the streams of the preview that have stopped
+    for (auto it = preview_jobs_.begin(); it != preview_jobs_.end();)
+    {
+        if (it->wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+            it = preview_jobs_.erase(it);
+        else
+            ++it;
     }
 
-    std::cerr << "Failed to read mesh from " << filename << " !" << std::endl;
-    return false;
+    if (!loading_)
+        return;
+
+    if (!loading_->is_ready())
+    {
+        if (preview_sink_)
+            update_preview();
+        return;
+    }
+
+    auto job = loading_;
+    loading_.reset();
+    stop_preview();
+    if (job->wait())
+    {
+        static_cast<SurfaceMesh&>(mesh_) = std::move(job->mesh());
+        mesh_loaded(loading_filename_.c_str());
+    }
+    else
+        std::cerr << "Failed to read mesh from " << loading_filename_ << " !"
+                  << std::endl;
+}
+
+//-----------------------------------------------------------------------------
+
+void MeshViewer::mesh_loaded(const char* filename)
+{
+    // update scene center and bounds
+    BoundingBox bb = mesh_.bounds();
+    set_scene((vec3)bb.center(), 0.5 * bb.size());
+
+    // compute face & vertex normals, update face indices
+    update_mesh();
+
+    // set draw mode, huge meshes are drawn by level of detail
+    if (mesh_.n_faces() > 10000000)
+    {
+        set_draw_mode("Level of Detail");
+    }
+    else if (mesh_.n_faces())
+    {
+        set_draw_mode("Solid Smooth");
+    }
+    else if (mesh_.n_vertices())
+    {
+        set_draw_mode("Points");
+    }
+
+    // print mesh statistic
+    std::cout << "Load " << filename << ": " << mesh_.n_vertices()
+              << " vertices, " << mesh_.n_faces() << " faces\n";
+
+    filename_ = filename;
+    crease_angle_ = mesh_.crease_angle();
 }
 
 //-----------------------------------------------------------------------------
@@ -113,6 +319,25 @@ void MeshViewer::update_mesh()
 
     // re-compute face and vertex normals
     mesh_.update_opengl_buffers();
+    lod_valid_ = false;
+    profiler().record_upload("update_opengl_buffers", mesh_.uploaded_bytes(),
+                             mesh_.upload_time());
+}
+
+//-----------------------------------------------------------------------------
+
+void MeshViewer::update_mesh_positions()
+{
+    // update scene center and radius, but don't update camera view
+    BoundingBox bb = mesh_.bounds();
+    center_ = (vec3)bb.center();
+    radius_ = 0.5f * bb.size();
+
+    // re-compute normals, update positions in place
+    mesh_.update_opengl_positions();
+    lod_valid_ = false;
+    profiler().record_upload("update_opengl_positions",
+                             mesh_.uploaded_bytes(), mesh_.upload_time());
 }
 
 //-----------------------------------------------------------------------------
@@ -135,6 +360,42 @@ void MeshViewer::process_imgui()
         {
             mesh_.set_crease_angle(crease_angle_);
         }
+
+        // control the level of detail
+        if (draw_mode_names_[draw_mode_] == "Level of Detail")
+        {
+            float pixel_error = lod_.pixel_error();
+            ImGui::PushItemWidth(100);
+            ImGui::SliderFloat("Pixel Error", &pixel_error, 0.5f, 10.0f,
+                               "%.1f");
+            ImGui::PopItemWidth();
+            lod_.set_pixel_error(pixel_error);
+            ImGui::BulletText("%d triangles drawn",
+                              (int)lod_.n_drawn_triangles());
+        }
+    }
+
+    if (ImGui::CollapsingHeader("Memory"))
+    {
+        // memory of the property arrays in MB
+        const SurfaceMesh::MemoryStats stats = mesh_.memory_stats();
+        const double mb = 1.0 / (1024 * 1024);
+        ImGui::BulletText("%.2f MB used, %.2f MB allocated",
+                          mb * stats.size(), mb * stats.capacity());
+        ImGui::BulletText("%.2f MB connectivity", mb * stats.connectivity);
+        ImGui::BulletText("%.2f MB deleted elements", mb * stats.deleted);
+        for (const auto* props :
+             {&stats.object_properties, &stats.vertex_properties,
+              &stats.halfedge_properties, &stats.edge_properties,
+              &stats.face_properties})
+        {
+            for (const auto& p : *props)
+            {
+                ImGui::BulletText("%s: %.2f MB%s", p.name.c_str(),
+                                  mb * p.size,
+                                  p.recycled ? " (recycled)" : "");
+            }
+        }
     }
 }
 
@@ -142,6 +403,27 @@ void MeshViewer::process_imgui()
 
 void MeshViewer::draw(const std::string& drawMode)
 {
+    profiler().set_memory("SurfaceMeshGL", mesh_.gpu_memory());
+
+    // draw the points read so far instead of the previous mesh
+    if (loading_ && preview_.n_vertices())
+    {
+        preview_.draw(projection_matrix_, modelview_matrix_, "Points");
+        return;
+    }
+
+    // draw the visible regions of the mesh at their level of detail
+    if (drawMode == "Level of Detail")
+    {
+        if (!lod_valid_)
+        {
+            lod_.build(mesh_);
+            lod_valid_ = true;
+        }
+        lod_.draw(projection_matrix_, modelview_matrix_, height());
+        return;
+    }
+
     // draw mesh
     mesh_.draw(projection_matrix_, modelview_matrix_, drawMode);
 }
@@ -157,7 +439,7 @@ void MeshViewer::keyboard(int key, int scancode, int action, int mods)
     {
         case GLFW_KEY_BACKSPACE: // reload model
         {
-            load_mesh(filename_.c_str());
+            load_mesh_async(filename_.c_str());
             break;
         }
 
@@ -181,6 +463,16 @@ Vertex MeshViewer::pick_vertex(int x, int y)
 {
     Vertex vmin;
 
+#ifndef __EMSCRIPTEN__
+    // read the face under the cursor from the id buffer
+    if (mesh_.n_faces())
+    {
+        to_framebuffer(x, y);
+        return mesh_.pick_vertex(projection_matrix_, modelview_matrix_, x, y);
+    }
+#endif
+
+    // point clouds: search the vertex closest to the depth
     vec3 p;
     Scalar d, dmin(FLT_MAX);
 
@@ -200,6 +492,32 @@ Vertex MeshViewer::pick_vertex(int x, int y)
     return vmin;
 }
 
+//-----------------------------------------------------------------------------
+
+Face MeshViewer::pick_face(int x, int y)
+{
+#ifndef __EMSCRIPTEN__
+    to_framebuffer(x, y);
+    return mesh_.pick_face(projection_matrix_, modelview_matrix_, x, y);
+#else
+    return Face();
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+std::vector<Face> MeshViewer::pick_faces(int x0, int y0, int x1, int y1)
+{
+#ifndef __EMSCRIPTEN__
+    to_framebuffer(x0, y0);
+    to_framebuffer(x1, y1);
+    return mesh_.pick_faces(projection_matrix_, modelview_matrix_, x0, y0, x1,
+                            y1);
+#else
+    return std::vector<Face>();
+#endif
+}
+
 //=============================================================================
 } // namespace pmp
 //=============================================================================
@@ -10,7 +10,13 @@
 //=============================================================================
 
 #include <pmp/visualization/SurfaceMeshGL.h>
+#include <pmp/visualization/SurfaceMeshLOD.h>
 #include <pmp/visualization/TrackballViewer.h>
+#include <pmp/SurfaceMeshAsync.h>
+
+#include <chrono>
+#include <future>
+#include <list>
 
 //=============================================================================
 
@@ -36,6 +42,14 @@ public:
     //! load a mesh from file \c filename
     virtual bool load_mesh(const char* filename);
 
+    //! \brief Load a mesh from file \c filename in the background.
+    //! \details The viewer stays responsive and shows the current mesh until
+    //! the new one has been read, see read_async(). Meanwhile, the vertices
+    //! parsed so far are streamed from the file and shown as points, such
+    //! that large meshes appear before they have been read completely. A
+    //! load that is still running is cancelled.
+    bool load_mesh_async(const char* filename);
+
     //! load a texture from file \c filename
     bool load_texture(const char* filename, GLint format = GL_RGB,
                       GLint min_filter = GL_LINEAR_MIPMAP_LINEAR,
@@ -47,6 +61,11 @@ public:
     //! triangulation of the mesh
     virtual void update_mesh();
 
+    //! update mesh normals and the OpenGL buffers after only the vertex
+    //! positions changed, e.g., by smoothing or fairing. faster than
+    //! update_mesh(), which is required after changes of the triangulation
+    virtual void update_mesh_positions();
+
     //! draw the scene in different draw modes
     virtual void draw(const std::string& draw_mode) override;
 
@@ -56,13 +75,51 @@ public:
     //! this function handles keyboard events
     virtual void keyboard(int key, int code, int action, int mod) override;
 
+    //! take over a mesh loaded by load_mesh_async()
+    virtual void do_processing() override;
+
     //! get vertex closest to 3D position Distributed under the mouse cursor
     Vertex pick_vertex(int x, int y);
 
+    //! get the face under the mouse cursor, an invalid face for the
+    //! background. reads the id buffer of mesh_, not available for WebGL
+    Face pick_face(int x, int y);
+
+    //! get the faces visible in the rectangle with the corners (x0, y0) and
+    //! (x1, y1) in window coordinates, e.g., for selection tools
+    std::vector<Face> pick_faces(int x0, int y0, int x1, int y1);
+
 protected:
+    //! update the scene and buffers after \c filename was loaded
+    void mesh_loaded(const char* filename);
+
     SurfaceMeshGL mesh_;   //!< the mesh
     std::string filename_; //!< the current file
     float crease_angle_;
+
+    //! \brief The levels of detail for the draw mode "Level of Detail".
+    //! \details Built when first drawn after update_mesh() or
+    //! update_mesh_positions().
+    SurfaceMeshLOD lod_;
+
+private:
+    class PreviewSink;
+
+    //! show the points collected by preview_sink_ since the last update
+    void update_preview();
+
+    //! stop the preview of load_mesh_async() and release its points
+    void stop_preview();
+
+    std::shared_ptr<SurfaceMeshIOJob> loading_; // running load_mesh_async()
+    std::string loading_filename_;
+
+    // point preview while loading_ is running
+    std::shared_ptr<PreviewSink> preview_sink_;
+    std::list<std::future<bool>> preview_jobs_; // running or stopped streams
+    SurfaceMeshGL preview_;
+    std::chrono::steady_clock::time_point preview_time_;
+    bool lod_valid_; // lod_ matches mesh_
 };
 
 //=============================================================================
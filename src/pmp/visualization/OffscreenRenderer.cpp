@@ -0,0 +1,484 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/visualization/OffscreenRenderer.h>
+
+#ifndef __EMSCRIPTEN__
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+
+#ifdef PMP_HAS_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#else
+#include <GLFW/glfw3.h>
+#endif
+
+#ifdef PMP_HAS_ZLIB
+#include <zlib.h>
+#endif
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+namespace {
+
+// CRC-32 of the PNG chunks
+uint32_t crc32_update(uint32_t crc, const unsigned char* data, size_t n)
+{
+    static uint32_t table[256];
+    static bool initialized = false;
+    if (!initialized)
+    {
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k)
+                c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+        initialized = true;
+    }
+
+    crc = ~crc;
+    for (size_t i = 0; i < n; ++i)
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+void put_u32(std::vector<unsigned char>& out, uint32_t v)
+{
+    out.push_back(v >> 24);
+    out.push_back(v >> 16);
+    out.push_back(v >> 8);
+    out.push_back(v);
+}
+
+void write_chunk(std::ofstream& ofs, const char* type,
+                 const std::vector<unsigned char>& data)
+{
+    std::vector<unsigned char> chunk;
+    put_u32(chunk, uint32_t(data.size()));
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    put_u32(chunk, crc32_update(0, chunk.data() + 4, chunk.size() - 4));
+    ofs.write((const char*)chunk.data(), chunk.size());
+}
+
+// zlib stream of the filtered image, stored blocks without zlib
+std::vector<unsigned char> deflate(const std::vector<unsigned char>& data)
+{
+    std::vector<unsigned char> out;
+
+#ifdef PMP_HAS_ZLIB
+    uLongf size = compressBound(data.size());
+    out.resize(size);
+    if (compress2(out.data(), &size, data.data(), data.size(),
+                  Z_BEST_SPEED) == Z_OK)
+    {
+        out.resize(size);
+        return out;
+    }
+    out.clear();
+#endif
+
+    out.push_back(0x78);
+    out.push_back(0x01);
+    size_t pos = 0;
+    do
+    {
+        const size_t n = std::min(data.size() - pos, size_t(65535));
+        out.push_back(pos + n == data.size() ? 1 : 0);
+        out.push_back(n & 0xff);
+        out.push_back(n >> 8);
+        out.push_back(~n & 0xff);
+        out.push_back((~n >> 8) & 0xff);
+        out.insert(out.end(), data.begin() + pos, data.begin() + pos + n);
+        pos += n;
+    } while (pos < data.size());
+
+    // Adler-32 checksum
+    uint32_t a = 1, b = 0;
+    for (unsigned char c : data)
+    {
+        a = (a + c) % 65521;
+        b = (b + a) % 65521;
+    }
+    put_u32(out, (b << 16) | a);
+    return out;
+}
+
+} // namespace
+
+//=============================================================================
+
+OffscreenRenderer::OffscreenRenderer(int width, int height, int samples)
+    : width_(width),
+      height_(height),
+      samples_(samples),
+      display_(nullptr),
+      context_(nullptr),
+      framebuffer_(0),
+      color_buffer_(0),
+      depth_buffer_(0),
+      resolve_framebuffer_(0),
+      resolve_buffer_(0),
+      draw_mode_("Smooth Shading"),
+      background_(1.0, 1.0, 1.0),
+      view_direction_(0.0, 0.0, 1.0),
+      up_direction_(0.0, 1.0, 0.0)
+{
+    create_context();
+    if (!context_)
+        return;
+
+    // multisampled color and depth buffers
+    GLint max_samples;
+    glGetIntegerv(GL_MAX_SAMPLES, &max_samples);
+    samples_ = std::max(0, std::min(samples_, int(max_samples)));
+
+    glGenRenderbuffers(1, &color_buffer_);
+    glBindRenderbuffer(GL_RENDERBUFFER, color_buffer_);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples_, GL_RGBA8,
+                                     width_, height_);
+    glGenRenderbuffers(1, &depth_buffer_);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth_buffer_);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples_,
+                                     GL_DEPTH_COMPONENT24, width_, height_);
+    glGenFramebuffers(1, &framebuffer_);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                              GL_RENDERBUFFER, color_buffer_);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+                              GL_RENDERBUFFER, depth_buffer_);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cerr << "OffscreenRenderer: incomplete framebuffer!\n";
+
+    // the resolved image, read back to the CPU
+    glGenRenderbuffers(1, &resolve_buffer_);
+    glBindRenderbuffer(GL_RENDERBUFFER, resolve_buffer_);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width_, height_);
+    glGenFramebuffers(1, &resolve_framebuffer_);
+    glBindFramebuffer(GL_FRAMEBUFFER, resolve_framebuffer_);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                              GL_RENDERBUFFER, resolve_buffer_);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    glViewport(0, 0, width_, height_);
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_MULTISAMPLE);
+    glCheckError();
+
+    mesh_.reset(new SurfaceMeshGL);
+}
+
+//-----------------------------------------------------------------------------
+
+OffscreenRenderer::~OffscreenRenderer()
+{
+    if (!context_)
+        return;
+
+    // the buffers of the mesh need the context
+    make_current();
+    mesh_.reset();
+    glDeleteFramebuffers(1, &framebuffer_);
+    glDeleteFramebuffers(1, &resolve_framebuffer_);
+    glDeleteRenderbuffers(1, &color_buffer_);
+    glDeleteRenderbuffers(1, &depth_buffer_);
+    glDeleteRenderbuffers(1, &resolve_buffer_);
+    destroy_context();
+}
+
+//-----------------------------------------------------------------------------
+
+void OffscreenRenderer::create_context()
+{
+#ifdef PMP_HAS_EGL
+    // prefer the first GPU, which does not need a display server
+    EGLDisplay display = EGL_NO_DISPLAY;
+    auto query_devices = (PFNEGLQUERYDEVICESEXTPROC)eglGetProcAddress(
+        "eglQueryDevicesEXT");
+    auto get_platform_display =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress(
+            "eglGetPlatformDisplayEXT");
+    if (query_devices && get_platform_display)
+    {
+        EGLDeviceEXT devices[16];
+        EGLint n_devices = 0;
+        if (query_devices(16, devices, &n_devices) && n_devices > 0)
+            display = get_platform_display(EGL_PLATFORM_DEVICE_EXT,
+                                           devices[0], nullptr);
+    }
+    if (display == EGL_NO_DISPLAY)
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    EGLint major, minor;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+    {
+        std::cerr << "OffscreenRenderer: cannot initialize EGL!\n";
+        return;
+    }
+
+    const EGLint config_attribs[] = {EGL_SURFACE_TYPE,    EGL_PBUFFER_BIT,
+                                     EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+                                     EGL_RED_SIZE,        8,
+                                     EGL_GREEN_SIZE,      8,
+                                     EGL_BLUE_SIZE,       8,
+                                     EGL_DEPTH_SIZE,      24,
+                                     EGL_NONE};
+    EGLConfig config;
+    EGLint n_configs = 0;
+    if (!eglChooseConfig(display, config_attribs, &config, 1, &n_configs) ||
+        n_configs == 0 || !eglBindAPI(EGL_OPENGL_API))
+    {
+        std::cerr << "OffscreenRenderer: no EGL config for OpenGL!\n";
+        eglTerminate(display);
+        return;
+    }
+
+    const EGLint context_attribs[] = {EGL_CONTEXT_MAJOR_VERSION,
+                                      3,
+                                      EGL_CONTEXT_MINOR_VERSION,
+                                      3,
+                                      EGL_CONTEXT_OPENGL_PROFILE_MASK,
+                                      EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                                      EGL_NONE};
+    EGLContext context =
+        eglCreateContext(display, config, EGL_NO_CONTEXT, context_attribs);
+    if (context == EGL_NO_CONTEXT)
+    {
+        std::cerr << "OffscreenRenderer: cannot create EGL context!\n";
+        eglTerminate(display);
+        return;
+    }
+
+    // no surface, everything is rendered into our framebuffer
+    if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+    {
+        std::cerr << "OffscreenRenderer: surfaceless context required!\n";
+        eglDestroyContext(display, context);
+        eglTerminate(display);
+        return;
+    }
+
+    display_ = display;
+    context_ = context;
+#else
+    // a hidden window
+    if (!glfwInit())
+        return;
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    GLFWwindow* window =
+        glfwCreateWindow(16, 16, "OffscreenRenderer", nullptr, nullptr);
+    glfwDefaultWindowHints();
+    if (!window)
+    {
+        std::cerr << "OffscreenRenderer: cannot create GLFW window!\n";
+        return;
+    }
+    glfwMakeContextCurrent(window);
+    context_ = window;
+#endif
+
+    // GLEW reports a missing GLX display for EGL contexts, after it loaded
+    // the OpenGL functions
+    glewExperimental = GL_TRUE;
+    GLenum err = glewInit();
+    if (err != GLEW_OK && err != GLEW_ERROR_NO_GLX_DISPLAY)
+    {
+        std::cerr << "Error initializing GLEW: " << glewGetErrorString(err)
+                  << std::endl;
+        destroy_context();
+        return;
+    }
+
+    // call glGetError once to clear error queue
+    glGetError();
+}
+
+//-----------------------------------------------------------------------------
+
+void OffscreenRenderer::destroy_context()
+{
+#ifdef PMP_HAS_EGL
+    if (context_)
+    {
+        eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                       EGL_NO_CONTEXT);
+        eglDestroyContext(display_, context_);
+        eglTerminate(display_);
+    }
+#else
+    if (context_)
+        glfwDestroyWindow((GLFWwindow*)context_);
+#endif
+    display_ = context_ = nullptr;
+}
+
+//-----------------------------------------------------------------------------
+
+void OffscreenRenderer::make_current()
+{
+#ifdef PMP_HAS_EGL
+    if (context_)
+        eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, context_);
+#else
+    if (context_)
+        glfwMakeContextCurrent((GLFWwindow*)context_);
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+void OffscreenRenderer::render(const SurfaceMesh& mesh)
+{
+    if (!context_)
+        return;
+    make_current();
+
+    // keep the OpenGL buffers and shaders of mesh_
+    static_cast<SurfaceMesh&>(*mesh_) = mesh;
+    mesh_->update_opengl_buffers();
+    render();
+}
+
+//-----------------------------------------------------------------------------
+
+bool OffscreenRenderer::render(const char* filename)
+{
+    if (!context_)
+        return false;
+    make_current();
+
+    if (!mesh_->read(filename))
+        return false;
+    mesh_->update_opengl_buffers();
+    render();
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void OffscreenRenderer::render()
+{
+    if (!context_)
+        return;
+    make_current();
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    glViewport(0, 0, width_, height_);
+    glClearColor(background_[0], background_[1], background_[2], 1.0);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    if (!mesh_->is_empty())
+    {
+        // frame the bounding sphere like TrackballViewer::view_all()
+        BoundingBox bb = mesh_->bounds();
+        const vec3 center = (vec3)bb.center();
+        const float radius = std::max(0.5f * float(bb.size()), 1e-6f);
+        const vec3 eye = center + 2.5f * radius * normalize(view_direction_);
+        const mat4 projection_matrix =
+            perspective_matrix(45.0f, float(width_) / float(height_),
+                               1.5f * radius, 3.5f * radius);
+        const mat4 modelview_matrix =
+            look_at_matrix(eye, center, up_direction_);
+
+        mesh_->draw(projection_matrix, modelview_matrix, draw_mode_);
+    }
+
+    // resolve the samples
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer_);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, resolve_framebuffer_);
+    glBlitFramebuffer(0, 0, width_, height_, 0, 0, width_, height_,
+                      GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    glCheckError();
+}
+
+//-----------------------------------------------------------------------------
+
+std::vector<unsigned char> OffscreenRenderer::image()
+{
+    std::vector<unsigned char> rgb(size_t(width_) * height_ * 3);
+    if (!context_)
+        return rgb;
+    make_current();
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, resolve_framebuffer_);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width_, height_, GL_RGB, GL_UNSIGNED_BYTE, rgb.data());
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+
+    // in OpenGL y=0 is at the 'bottom'
+    const size_t row = size_t(width_) * 3;
+    for (int y = 0; y < height_ / 2; ++y)
+        std::swap_ranges(rgb.begin() + y * row, rgb.begin() + (y + 1) * row,
+                         rgb.begin() + (height_ - 1 - y) * row);
+    return rgb;
+}
+
+//-----------------------------------------------------------------------------
+
+bool OffscreenRenderer::write_png(const char* filename)
+{
+    const std::vector<unsigned char> rgb = image();
+
+    std::ofstream ofs(filename, std::ios::binary);
+    if (!ofs)
+        return false;
+
+    const unsigned char signature[8] = {0x89, 'P',  'N',  'G',
+                                        '\r', '\n', 0x1a, '\n'};
+    ofs.write((const char*)signature, 8);
+
+    // 8 bit RGB, no interlacing
+    std::vector<unsigned char> header;
+    put_u32(header, width_);
+    put_u32(header, height_);
+    header.push_back(8);
+    header.push_back(2);
+    header.push_back(0);
+    header.push_back(0);
+    header.push_back(0);
+    write_chunk(ofs, "IHDR", header);
+
+    // each row starts with filter type 0
+    const size_t row = size_t(width_) * 3;
+    std::vector<unsigned char> filtered;
+    filtered.reserve((row + 1) * height_);
+    for (int y = 0; y < height_; ++y)
+    {
+        filtered.push_back(0);
+        filtered.insert(filtered.end(), rgb.begin() + y * row,
+                        rgb.begin() + (y + 1) * row);
+    }
+    write_chunk(ofs, "IDAT", deflate(filtered));
+    write_chunk(ofs, "IEND", std::vector<unsigned char>());
+
+    return bool(ofs);
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
+
+#endif // __EMSCRIPTEN__
@@ -0,0 +1,128 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <pmp/visualization/SurfaceMeshGL.h>
+#include <pmp/MatVec.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \addtogroup visualization visualization
+//! @{
+
+//=============================================================================
+
+//! \brief Render meshes to images without a window, e.g., for thumbnails.
+//! \details Creates an OpenGL context of its own: a headless EGL context if
+//! pmp was built with EGL (PMP_HAS_EGL), which runs on render nodes without
+//! a display, otherwise a hidden GLFW window. The meshes are rendered by a
+//! single SurfaceMeshGL into a multisampled framebuffer, so its shaders and
+//! OpenGL buffers are reused from mesh to mesh. Not available for WebGL.
+//!
+//! \code
+//! OffscreenRenderer renderer(256, 256);
+//! for (auto& file : files)
+//!     if (renderer.is_valid() && renderer.render(file.c_str()))
+//!         renderer.write_png((file + ".png").c_str());
+//! \endcode
+class OffscreenRenderer
+{
+public:
+    //! \brief Create the context and a framebuffer of \p width x \p height
+    //! pixels with \p samples samples per pixel.
+    //! \details Check is_valid() whether this succeeded.
+    OffscreenRenderer(int width, int height, int samples = 4);
+
+    //! destroy the framebuffer, the mesh buffers, and the context
+    ~OffscreenRenderer();
+
+    OffscreenRenderer(const OffscreenRenderer&) = delete;
+    OffscreenRenderer& operator=(const OffscreenRenderer&) = delete;
+
+    //! was the OpenGL context created?
+    bool is_valid() const { return context_ != nullptr; }
+
+    //! make the context of this renderer current, e.g., after rendering
+    //! with another renderer on the same thread
+    void make_current();
+
+    //! the mesh used for rendering, e.g., to set its material
+    SurfaceMeshGL& mesh() { return *mesh_; }
+
+    //! set the draw mode, e.g., "Smooth Shading", see SurfaceMeshGL::draw()
+    void set_draw_mode(const std::string& mode) { draw_mode_ = mode; }
+
+    //! set the background color
+    void set_background(const vec3& color) { background_ = color; }
+
+    //! set the direction from the mesh center to the camera
+    void set_view_direction(const vec3& dir) { view_direction_ = dir; }
+
+    //! set the up direction of the camera
+    void set_up_direction(const vec3& up) { up_direction_ = up; }
+
+    //! render a copy of \p mesh, framed by its bounding sphere
+    void render(const SurfaceMesh& mesh);
+
+    //! read the mesh file \p filename and render it, see render()
+    bool render(const char* filename);
+
+    //! render the current mesh() again, e.g., after changing its material
+    void render();
+
+    //! the RGB pixels of the last image, row by row from the top
+    std::vector<unsigned char> image();
+
+    //! write the last image to the PNG file \p filename
+    bool write_png(const char* filename);
+
+    //! the width of the images in pixels
+    int width() const { return width_; }
+
+    //! the height of the images in pixels
+    int height() const { return height_; }
+
+private:
+    //! create the OpenGL context and load the OpenGL functions
+    void create_context();
+
+    //! destroy the OpenGL context
+    void destroy_context();
+
+    int width_, height_, samples_;
+
+    // the context, EGL display and context or GLFW window
+    void* display_;
+    void* context_;
+
+    // multisampled framebuffer, resolved into a single sampled one
+    GLuint framebuffer_, color_buffer_, depth_buffer_;
+    GLuint resolve_framebuffer_, resolve_buffer_;
+
+    std::unique_ptr<SurfaceMeshGL> mesh_;
+    std::string draw_mode_;
+    vec3 background_;
+    vec3 view_direction_;
+    vec3 up_direction_;
+};
+
+//=============================================================================
+//! @}
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -0,0 +1,41 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+// clang-format off
+
+// The id pass of SurfaceMeshGL for picking: writes the index of each
+// triangle plus one to an integer framebuffer, zero is the background.
+// Requires OpenGL 3.3, not available for WebGL.
+
+static const char* pick_vshader =
+    "#version 330\n"
+    "\n"
+    "layout (location=0) in vec4 v_position;\n"
+    "uniform mat4 modelview_projection_matrix;\n"
+    "\n"
+    "void main()\n"
+    "{\n"
+    "    gl_Position = modelview_projection_matrix * v_position;\n"
+    "}\n";
+
+
+static const char* pick_fshader =
+    "#version 330\n"
+    "\n"
+    "out uint f_id;\n"
+    "\n"
+    "void main()\n"
+    "{\n"
+    "    f_id = uint(gl_PrimitiveID) + 1u;\n"
+    "}";
+
+
+//=============================================================================
+// clang-format on
+//=============================================================================
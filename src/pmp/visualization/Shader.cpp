@@ -19,7 +19,10 @@ namespace pmp {
 
 //=============================================================================
 
-Shader::Shader() : pid_(0), vid_(0), fid_(0) {}
+Shader::Shader()
+    : pid_(0), vid_(0), fid_(0), gid_(0), cid_(0), tcid_(0), teid_(0)
+{
+}
 
 //-----------------------------------------------------------------------------
 
@@ -38,8 +41,16 @@ void Shader::cleanup()
         glDeleteShader(vid_);
     if (fid_)
         glDeleteShader(fid_);
-
-    pid_ = vid_ = fid_ = 0;
+    if (gid_)
+        glDeleteShader(gid_);
+    if (cid_)
+        glDeleteShader(cid_);
+    if (tcid_)
+        glDeleteShader(tcid_);
+    if (teid_)
+        glDeleteShader(teid_);
+
+    pid_ = vid_ = fid_ = gid_ = cid_ = tcid_ = teid_ = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -82,6 +93,142 @@ bool Shader::source(const char* vshader, const char* fshader)
 
 //-----------------------------------------------------------------------------
 
+#ifndef __EMSCRIPTEN__
+bool Shader::source(const char* vshader, const char* gshader,
+                    const char* fshader)
+{
+    // cleanup existing shaders first
+    cleanup();
+
+    // create program
+    pid_ = glCreateProgram();
+
+    // vertex shader
+    vid_ = compile(vshader, GL_VERTEX_SHADER);
+    if (!vid_)
+    {
+        std::cerr << "Cannot compile vertex shader!\n";
+        return false;
+    }
+    glAttachShader(pid_, vid_);
+
+    // geometry shader
+    gid_ = compile(gshader, GL_GEOMETRY_SHADER);
+    if (!gid_)
+    {
+        std::cerr << "Cannot compile geometry shader!\n";
+        return false;
+    }
+    glAttachShader(pid_, gid_);
+
+    // fragment shader
+    fid_ = compile(fshader, GL_FRAGMENT_SHADER);
+    if (!fid_)
+    {
+        std::cerr << "Cannot compile fragment shader!\n";
+        return false;
+    }
+    glAttachShader(pid_, fid_);
+
+    // link program
+    if (!link())
+    {
+        std::cerr << "Cannot link program!\n";
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool Shader::source(const char* vshader, const char* tcshader,
+                    const char* teshader, const char* fshader)
+{
+    // cleanup existing shaders first
+    cleanup();
+
+    // create program
+    pid_ = glCreateProgram();
+
+    // vertex shader
+    vid_ = compile(vshader, GL_VERTEX_SHADER);
+    if (!vid_)
+    {
+        std::cerr << "Cannot compile vertex shader!\n";
+        return false;
+    }
+    glAttachShader(pid_, vid_);
+
+    // tessellation control shader
+    tcid_ = compile(tcshader, GL_TESS_CONTROL_SHADER);
+    if (!tcid_)
+    {
+        std::cerr << "Cannot compile tessellation control shader!\n";
+        return false;
+    }
+    glAttachShader(pid_, tcid_);
+
+    // tessellation evaluation shader
+    teid_ = compile(teshader, GL_TESS_EVALUATION_SHADER);
+    if (!teid_)
+    {
+        std::cerr << "Cannot compile tessellation evaluation shader!\n";
+        return false;
+    }
+    glAttachShader(pid_, teid_);
+
+    // fragment shader
+    fid_ = compile(fshader, GL_FRAGMENT_SHADER);
+    if (!fid_)
+    {
+        std::cerr << "Cannot compile fragment shader!\n";
+        return false;
+    }
+    glAttachShader(pid_, fid_);
+
+    // link program
+    if (!link())
+    {
+        std::cerr << "Cannot link program!\n";
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool Shader::source(const char* cshader)
+{
+    // cleanup existing shaders first
+    cleanup();
+
+    // create program
+    pid_ = glCreateProgram();
+
+    // compute shader
+    cid_ = compile(cshader, GL_COMPUTE_SHADER);
+    if (!cid_)
+    {
+        std::cerr << "Cannot compile compute shader!\n";
+        return false;
+    }
+    glAttachShader(pid_, cid_);
+
+    // link program
+    if (!link())
+    {
+        std::cerr << "Cannot link program!\n";
+        return false;
+    }
+
+    return true;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+
 bool Shader::load(const char* vfile, const char* ffile)
 {
     // cleanup existing shaders first
@@ -270,6 +417,21 @@ void Shader::set_uniform(const char* name, int value)
 
 //-----------------------------------------------------------------------------
 
+void Shader::set_uniform(const char* name, const vec2& vec)
+{
+    if (!pid_)
+        return;
+    int location = glGetUniformLocation(pid_, name);
+    if (location == -1)
+    {
+        std::cerr << "Invalid uniform location for: " << name << std::endl;
+        return;
+    };
+    glUniform2f(location, vec[0], vec[1]);
+}
+
+//-----------------------------------------------------------------------------
+
 void Shader::set_uniform(const char* name, const vec3& vec)
 {
     if (!pid_)
@@ -46,6 +46,31 @@ public:
     //! \param ffile string with the adress to the fragment shader
     bool load(const char* vfile, const char* ffile);
 
+#ifndef __EMSCRIPTEN__
+    //! get source from strings, compile, and link vertex, geometry, and
+    //! fragment shader
+    //! \param vshader string with the vertex shader
+    //! \param gshader string with the geometry shader
+    //! \param fshader string with the fragment shader
+    bool source(const char* vshader, const char* gshader,
+                const char* fshader);
+
+    //! get source from strings, compile, and link vertex, tessellation
+    //! control, tessellation evaluation, and fragment shader, requires
+    //! OpenGL 4.0
+    //! \param vshader string with the vertex shader
+    //! \param tcshader string with the tessellation control shader
+    //! \param teshader string with the tessellation evaluation shader
+    //! \param fshader string with the fragment shader
+    bool source(const char* vshader, const char* tcshader,
+                const char* teshader, const char* fshader);
+
+    //! get source from string, compile, and link compute shader,
+    //! requires OpenGL 4.3
+    //! \param cshader string with the compute shader
+    bool source(const char* cshader);
+#endif
+
     //! enable/bind this shader program
     void use();
 
@@ -65,6 +90,11 @@ public:
     //! \param value the value for the uniform
     void set_uniform(const char* name, int value);
 
+    //! upload vec2 uniform
+    //! \param name string of the uniform name
+    //! \param vec the value for the uniform
+    void set_uniform(const char* name, const vec2& vec);
+
     //! upload vec3 uniform
     //! \param name string of the uniform name
     //! \param vec the value for the uniform
@@ -114,6 +144,16 @@ private:
 
     //! id of the fragmend shader
     GLint fid_;
+
+    //! id of the geometry shader
+    GLint gid_;
+
+    //! id of the compute shader
+    GLint cid_;
+
+    //! ids of the tessellation control and evaluation shaders
+    GLint tcid_;
+    GLint teid_;
 };
 
 //=============================================================================
@@ -0,0 +1,300 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/visualization/SurfaceMeshCompute.h>
+
+#ifndef __EMSCRIPTEN__
+
+#include <pmp/visualization/ComputeShaders.h>
+#include <pmp/algorithms/DifferentialGeometry.h>
+#include <pmp/algorithms/GeometryCache.h>
+
+#include <algorithm>
+#include <vector>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+namespace {
+
+// a shader storage buffer with data, at least one element to be bindable
+template <class T>
+GLuint create_buffer(std::vector<T> data)
+{
+    if (data.empty())
+        data.resize(1);
+
+    GLuint buffer;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, data.size() * sizeof(T),
+                 data.data(), GL_DYNAMIC_COPY);
+    return buffer;
+}
+
+// read back the data of buffer
+template <class T>
+void read_buffer(GLuint buffer, std::vector<T>& data)
+{
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+    glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, data.size() * sizeof(T),
+                       data.data());
+}
+
+} // namespace
+
+//=============================================================================
+
+SurfaceMeshCompute::SurfaceMeshCompute(SurfaceMesh& mesh)
+    : mesh_(mesh),
+      n_vertices_(0),
+      current_(0),
+      offset_buffer_(0),
+      neighbor_buffer_(0),
+      face_buffer_(0),
+      weight_buffer_(0),
+      center_buffer_(0),
+      normal_buffer_(0),
+      curvature_buffer_(0),
+      positions_changed_(false),
+      has_normals_(false),
+      has_curvature_(false)
+{
+    position_buffers_[0] = position_buffers_[1] = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+SurfaceMeshCompute::~SurfaceMeshCompute()
+{
+    cleanup();
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMeshCompute::is_supported()
+{
+    return GLEW_VERSION_4_3 ||
+           (GLEW_ARB_compute_shader && GLEW_ARB_shader_storage_buffer_object);
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMeshCompute::cleanup()
+{
+    GLuint buffers[] = {position_buffers_[0], position_buffers_[1],
+                        offset_buffer_,       neighbor_buffer_,
+                        face_buffer_,         weight_buffer_,
+                        center_buffer_,       normal_buffer_,
+                        curvature_buffer_};
+    for (GLuint buffer : buffers)
+        if (buffer)
+            glDeleteBuffers(1, &buffer);
+
+    position_buffers_[0] = position_buffers_[1] = 0;
+    offset_buffer_ = neighbor_buffer_ = face_buffer_ = 0;
+    weight_buffer_ = center_buffer_ = 0;
+    normal_buffer_ = curvature_buffer_ = 0;
+    n_vertices_ = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMeshCompute::upload(bool use_uniform_laplace)
+{
+    if (!is_supported())
+    {
+        std::cerr << "SurfaceMeshCompute: Compute shaders are not supported\n";
+        return false;
+    }
+
+    if (!smoothing_shader_.source(smoothing_cshader) ||
+        !normals_shader_.source(normals_cshader) ||
+        !curvature_shader_.source(curvature_cshader) ||
+        !boundary_curvature_shader_.source(boundary_curvature_cshader))
+        return false;
+
+    cleanup();
+    n_vertices_ = mesh_.vertices_size();
+
+    // the one-ring of each vertex in counter-clockwise order, and the
+    // weights of a smoothing step: halfway to the weighted mean of the
+    // neighbors, boundary vertices stay fixed
+    const GeometryCache* cache = GeometryCache::get(mesh_);
+    std::vector<GLfloat> positions(4 * n_vertices_, 0.0f);
+    std::vector<GLuint> offsets(1, 0), neighbors, faces;
+    std::vector<GLfloat> weights, centers(n_vertices_, 1.0f);
+    for (auto v : mesh_.vertices())
+    {
+        for (int j = 0; j < 3; ++j)
+            positions[4 * v.idx() + j] = mesh_.position(v)[j];
+
+        while (offsets.size() <= v.idx())
+            offsets.push_back(neighbors.size());
+
+        const size_t first = weights.size();
+        double sum = 0.0;
+        for (auto h : mesh_.halfedges(v))
+        {
+            const Edge e = mesh_.edge(h);
+            const double w =
+                use_uniform_laplace
+                    ? 1.0
+                    : std::max(0.0, cache ? cache->cotan_weight(e)
+                                          : cotan_weight(mesh_, e));
+            neighbors.push_back(mesh_.to_vertex(h).idx());
+            faces.push_back(mesh_.is_boundary(h) ? 0 : 1);
+            weights.push_back(w);
+            sum += w;
+        }
+        offsets.push_back(neighbors.size());
+
+        const bool fixed = mesh_.is_boundary(v) || sum <= 0.0;
+        for (size_t k = first; k < weights.size(); ++k)
+            weights[k] = fixed ? 0.0f : GLfloat(0.5 * weights[k] / sum);
+        centers[v.idx()] = fixed ? 1.0f : 0.5f;
+    }
+    while (offsets.size() <= size_t(n_vertices_))
+        offsets.push_back(neighbors.size());
+
+    position_buffers_[0] = create_buffer(positions);
+    position_buffers_[1] = create_buffer(positions);
+    offset_buffer_ = create_buffer(offsets);
+    neighbor_buffer_ = create_buffer(neighbors);
+    face_buffer_ = create_buffer(faces);
+    weight_buffer_ = create_buffer(weights);
+    center_buffer_ = create_buffer(centers);
+    normal_buffer_ = create_buffer(std::vector<GLfloat>(4 * n_vertices_));
+    curvature_buffer_ = create_buffer(std::vector<GLfloat>(2 * n_vertices_));
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    current_ = 0;
+    positions_changed_ = has_normals_ = has_curvature_ = false;
+    glCheckError();
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMeshCompute::dispatch(Shader& shader)
+{
+    const GLuint buffers[] = {position_buffers_[current_],
+                              position_buffers_[1 - current_],
+                              offset_buffer_,
+                              neighbor_buffer_,
+                              weight_buffer_,
+                              center_buffer_,
+                              face_buffer_,
+                              normal_buffer_,
+                              curvature_buffer_};
+    for (GLuint i = 0; i < 9; ++i)
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, i, buffers[i]);
+
+    shader.use();
+    shader.set_uniform("n_vertices", int(n_vertices_));
+    glDispatchCompute((n_vertices_ + 255) / 256, 1, 1);
+
+    // later dispatches and read-backs see the results
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT |
+                    GL_BUFFER_UPDATE_BARRIER_BIT);
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMeshCompute::explicit_smoothing(unsigned int iters)
+{
+    if (!n_vertices_)
+        return;
+
+    for (unsigned int i = 0; i < iters; ++i)
+    {
+        dispatch(smoothing_shader_);
+        current_ = 1 - current_;
+    }
+    positions_changed_ = true;
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMeshCompute::vertex_normals()
+{
+    if (!n_vertices_)
+        return;
+
+    dispatch(normals_shader_);
+    has_normals_ = true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMeshCompute::curvature()
+{
+    if (!mesh_.is_triangle_mesh())
+    {
+        std::cerr << "SurfaceMeshCompute: Not a triangle mesh\n";
+        return false;
+    }
+    if (!n_vertices_)
+        return true;
+
+    dispatch(curvature_shader_);
+    dispatch(boundary_curvature_shader_);
+    has_curvature_ = true;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMeshCompute::download()
+{
+    if (positions_changed_)
+    {
+        std::vector<GLfloat> positions(4 * n_vertices_);
+        read_buffer(position_buffers_[current_], positions);
+        for (auto v : mesh_.vertices())
+            for (int j = 0; j < 3; ++j)
+                mesh_.position(v)[j] = positions[4 * v.idx() + j];
+    }
+
+    if (has_normals_)
+    {
+        std::vector<GLfloat> normals(4 * n_vertices_);
+        read_buffer(normal_buffer_, normals);
+        auto vnormal = mesh_.vertex_property<Normal>("v:normal");
+        for (auto v : mesh_.vertices())
+            vnormal[v] = Normal(normals[4 * v.idx()], normals[4 * v.idx() + 1],
+                                normals[4 * v.idx() + 2]);
+    }
+
+    if (has_curvature_)
+    {
+        std::vector<GLfloat> curvatures(2 * n_vertices_);
+        read_buffer(curvature_buffer_, curvatures);
+        auto kmin = mesh_.vertex_property<Scalar>("v:min_curvature");
+        auto kmax = mesh_.vertex_property<Scalar>("v:max_curvature");
+        for (auto v : mesh_.vertices())
+        {
+            kmin[v] = curvatures[2 * v.idx()];
+            kmax[v] = curvatures[2 * v.idx() + 1];
+        }
+    }
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    glCheckError();
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
+
+#endif // __EMSCRIPTEN__
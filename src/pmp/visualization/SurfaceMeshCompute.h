@@ -0,0 +1,123 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <pmp/visualization/GL.h>
+#include <pmp/visualization/Shader.h>
+#include <pmp/SurfaceMesh.h>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \addtogroup visualization visualization
+//! @{
+
+//=============================================================================
+
+//! \brief Runs explicit smoothing, vertex normals, and curvature with
+//! OpenGL compute shaders.
+//! \details upload() copies the positions and the adjacency of the mesh
+//! to shader storage buffers once, the computations run on the GPU, and
+//! download() reads back only their results. Requires a current OpenGL 4.3
+//! context, see is_supported(); the viewers request 3.2 core profiles,
+//! which macOS and WebGL do not exceed. The results match SurfaceSmoothing,
+//! SurfaceNormals::compute_vertex_normal(), and SurfaceCurvature::analyze()
+//! without post-smoothing up to single-precision rounding. SurfaceMeshGL
+//! duplicates vertices at sharp edges and therefore keeps its own buffers,
+//! position_buffer() can be bound as vertex attribute of four floats for
+//! other views. Usage:
+//! \code
+//! SurfaceMeshCompute compute(mesh);
+//! if (compute.upload())
+//! {
+//!     compute.explicit_smoothing(100);
+//!     compute.vertex_normals();
+//!     compute.download();
+//! }
+//! \endcode
+class SurfaceMeshCompute
+{
+public:
+    //! construct for \p mesh, which has to outlive the object
+    SurfaceMeshCompute(SurfaceMesh& mesh);
+
+    //! default destructor, deletes the buffers
+    ~SurfaceMeshCompute();
+
+    //! whether the current OpenGL context supports compute shaders
+    static bool is_supported();
+
+    //! \brief Upload the positions and the adjacency of the mesh, and the
+    //! weights of explicit smoothing: cotan or uniform.
+    //! \details Has to be called again after the connectivity changed.
+    //! \return false if compute shaders are not supported
+    bool upload(bool use_uniform_laplace = false);
+
+    //! perform \p iters iterations of explicit Laplacian smoothing
+    void explicit_smoothing(unsigned int iters = 10);
+
+    //! compute angle-weighted vertex normals
+    void vertex_normals();
+
+    //! \brief Compute minimum and maximum curvature.
+    //! \return false if the mesh is not a triangle mesh
+    bool curvature();
+
+    //! \brief Read back the results computed since upload().
+    //! \details Writes the positions to "v:point", the normals to
+    //! "v:normal", and the curvatures to "v:min_curvature" and
+    //! "v:max_curvature".
+    void download();
+
+    //! the buffer of the current positions, four floats per vertex
+    GLuint position_buffer() const { return position_buffers_[current_]; }
+
+private:
+    // dispatch one invocation per vertex
+    void dispatch(Shader& shader);
+
+    // delete all buffers
+    void cleanup();
+
+    SurfaceMesh& mesh_;
+    GLsizei n_vertices_;
+
+    // double-buffered positions, current_ holds the latest ones
+    GLuint position_buffers_[2];
+    int current_;
+
+    // adjacency, smoothing weights, and results
+    GLuint offset_buffer_;
+    GLuint neighbor_buffer_;
+    GLuint face_buffer_;
+    GLuint weight_buffer_;
+    GLuint center_buffer_;
+    GLuint normal_buffer_;
+    GLuint curvature_buffer_;
+
+    // which results download() has to read
+    bool positions_changed_;
+    bool has_normals_;
+    bool has_curvature_;
+
+    Shader smoothing_shader_;
+    Shader normals_shader_;
+    Shader curvature_shader_;
+    Shader boundary_curvature_shader_;
+};
+
+//=============================================================================
+//! @}
+//=============================================================================
+} // namespace pmp
+//=============================================================================
@@ -9,11 +9,20 @@
 
 #include <pmp/visualization/SurfaceMeshGL.h>
 #include <pmp/visualization/PhongShader.h>
+#include <pmp/visualization/WireframeShader.h>
+#include <pmp/visualization/PickShader.h>
+#include <pmp/visualization/LimitShader.h>
 #include <pmp/visualization/ColdWarmTexture.h>
 #include <pmp/algorithms/SurfaceNormals.h>
+#include <pmp/Parallel.h>
+#include <pmp/Timer.h>
 
 #include <stb_image.h>
+#include <algorithm>
 #include <cfloat>
+#include <cmath>
+#include <numeric>
+#include <string>
 
 //=============================================================================
 
@@ -21,6 +30,118 @@ namespace pmp {
 
 //=============================================================================
 
+namespace {
+
+// a normal in the format of its vertex attribute: signed normalized shorts,
+// padded to four components for alignment
+struct PackedNormal
+{
+    GLshort x, y, z, w;
+
+    bool operator==(const PackedNormal& other) const
+    {
+        return x == other.x && y == other.y && z == other.z;
+    }
+};
+
+inline GLshort pack_component(Scalar c)
+{
+    return GLshort(std::round(std::max(Scalar(-1), std::min(Scalar(1), c)) *
+                              32767));
+}
+
+inline PackedNormal pack_normal(const Normal& n)
+{
+    return {pack_component(n[0]), pack_component(n[1]), pack_component(n[2]),
+            0};
+}
+
+#ifndef __EMSCRIPTEN__
+// the exponents (i, j) of u and v of the Bernstein polynomials of a limit
+// patch, in the order of the control points in LimitShader.h
+std::vector<std::pair<int, int>> patch_exponents(bool quads)
+{
+    std::vector<std::pair<int, int>> exponents;
+    for (int j = 0; j <= (quads ? 3 : 4); ++j)
+        for (int i = 0; i <= (quads ? 3 : 4 - j); ++i)
+            exponents.push_back(std::make_pair(i, j));
+    return exponents;
+}
+
+// the Bernstein polynomial with the exponents (i, j) at (u, v)
+double bernstein(bool quads, int i, int j, double u, double v)
+{
+    static const double factorial[] = {1, 1, 2, 6, 24};
+    if (quads)
+        return factorial[3] / (factorial[i] * factorial[3 - i]) *
+               std::pow(u, i) * std::pow(1 - u, 3 - i) * factorial[3] /
+               (factorial[j] * factorial[3 - j]) * std::pow(v, j) *
+               std::pow(1 - v, 3 - j);
+
+    const int l = 4 - i - j;
+    return factorial[4] / (factorial[i] * factorial[j] * factorial[l]) *
+           std::pow(u, i) * std::pow(v, j) * std::pow(1 - u - v, l);
+}
+
+// the matrix mapping the limit at the parameters (i, j) / degree of the
+// exponents to the control points interpolating it, in row-major order
+std::vector<double> patch_fit_matrix(bool quads)
+{
+    const auto exponents = patch_exponents(quads);
+    const size_t n = exponents.size();
+    const double degree = quads ? 3 : 4;
+
+    // invert the matrix of the polynomials at the parameters by Gauss-Jordan
+    // elimination with partial pivoting
+    std::vector<double> a(n * n), inverse(n * n, 0.0);
+    for (size_t r = 0; r < n; ++r)
+    {
+        for (size_t c = 0; c < n; ++c)
+            a[r * n + c] =
+                bernstein(quads, exponents[c].first, exponents[c].second,
+                          exponents[r].first / degree,
+                          exponents[r].second / degree);
+        inverse[r * n + r] = 1.0;
+    }
+    for (size_t c = 0; c < n; ++c)
+    {
+        size_t pivot = c;
+        for (size_t r = c + 1; r < n; ++r)
+            if (std::fabs(a[r * n + c]) > std::fabs(a[pivot * n + c]))
+                pivot = r;
+        for (size_t k = 0; k < n; ++k)
+        {
+            std::swap(a[c * n + k], a[pivot * n + k]);
+            std::swap(inverse[c * n + k], inverse[pivot * n + k]);
+        }
+
+        const double scale = 1.0 / a[c * n + c];
+        for (size_t k = 0; k < n; ++k)
+        {
+            a[c * n + k] *= scale;
+            inverse[c * n + k] *= scale;
+        }
+        for (size_t r = 0; r < n; ++r)
+        {
+            const double factor = a[r * n + c];
+            if (r == c || factor == 0.0)
+                continue;
+            for (size_t k = 0; k < n; ++k)
+            {
+                a[r * n + k] -= factor * a[c * n + k];
+                inverse[r * n + k] -= factor * inverse[c * n + k];
+            }
+        }
+    }
+    return inverse;
+}
+#endif
+
+
+} // namespace
+
+//=============================================================================
+
 SurfaceMeshGL::SurfaceMeshGL()
 {
     // initialize GL buffers to zero
@@ -28,15 +149,42 @@ SurfaceMeshGL::SurfaceMeshGL()
     vertex_buffer_       = 0;
     normal_buffer_       = 0;
     tex_coord_buffer_    = 0;
+#ifdef __EMSCRIPTEN__
     edge_buffer_         = 0;
     feature_buffer_      = 0;
+#else
+    edge_flag_buffer_    = 0;
+    edge_flag_texture_   = 0;
+#endif
+    triangle_buffer_     = 0;
+#ifndef __EMSCRIPTEN__
+    patch_array_object_  = 0;
+    patch_buffer_        = 0;
+    n_patch_vertices_    = 0;
+    patch_size_          = 0;
+    patch_memory_        = 0;
+    tessellation_level_  = 16;
+    id_framebuffer_      = 0;
+    id_texture_          = 0;
+    id_depth_buffer_     = 0;
+    id_valid_            = false;
+#endif
 
     // initialize buffer sizes
     n_vertices_     = 0;
+#ifdef __EMSCRIPTEN__
     n_edges_        = 0;
+#endif
     n_triangles_    = 0;
     n_features_     = 0;
     have_texcoords_ = false;
+    n_buffered_vertices_       = 0;
+    n_buffered_halfedges_      = 0;
+    buffered_topology_version_ = 0;
+    buffer_memory_             = 0;
+    texture_memory_            = 0;
+    uploaded_bytes_            = 0;
+    upload_time_               = 0.0;
 
     // material parameters
     front_color_  = vec3(0.6, 0.6, 0.6);
@@ -62,8 +210,21 @@ SurfaceMeshGL::~SurfaceMeshGL()
     glDeleteBuffers(1, &vertex_buffer_);
     glDeleteBuffers(1, &normal_buffer_);
     glDeleteBuffers(1, &tex_coord_buffer_);
+#ifdef __EMSCRIPTEN__
     glDeleteBuffers(1, &edge_buffer_);
     glDeleteBuffers(1, &feature_buffer_);
+#else
+    glDeleteBuffers(1, &edge_flag_buffer_);
+    glDeleteTextures(1, &edge_flag_texture_);
+#endif
+    glDeleteBuffers(1, &triangle_buffer_);
+#ifndef __EMSCRIPTEN__
+    glDeleteBuffers(1, &patch_buffer_);
+    glDeleteVertexArrays(1, &patch_array_object_);
+    glDeleteFramebuffers(1, &id_framebuffer_);
+    glDeleteTextures(1, &id_texture_);
+    glDeleteRenderbuffers(1, &id_depth_buffer_);
+#endif
     glDeleteVertexArrays(1, &vertex_array_object_);
     glDeleteTextures(1, &texture_);
 }
@@ -118,6 +279,11 @@ bool SurfaceMeshGL::load_texture(const char* filename, GLint format,
     // use SRGB rendering?
     srgb_ = (format == GL_SRGB8);
 
+    // RGB texels are padded to 32 bits, mipmaps add a third
+    texture_memory_ = size_t(width) * height * 4;
+    if (min_filter == GL_LINEAR_MIPMAP_LINEAR)
+        texture_memory_ += texture_memory_ / 3;
+
     // free memory
     stbi_image_free(img);
 
@@ -147,6 +313,7 @@ void SurfaceMeshGL::use_cold_warm_texture()
 
         srgb_ = false;
         texture_mode_ = ColdWarmTexture;
+        texture_memory_ = 256 * 4;
     }
 }
 
@@ -198,6 +365,7 @@ void SurfaceMeshGL::use_checkerboard_texture()
 
         srgb_ = false;
         texture_mode_ = CheckerboardTexture;
+        texture_memory_ = size_t(res) * res * 4;
     }
 }
 
@@ -216,6 +384,9 @@ void SurfaceMeshGL::set_crease_angle(Scalar ca)
 
 void SurfaceMeshGL::update_opengl_buffers()
 {
+    Timer timer;
+    timer.start();
+
     // are buffers already initialized?
     if (!vertex_array_object_)
     {
@@ -224,129 +395,213 @@ void SurfaceMeshGL::update_opengl_buffers()
         glGenBuffers(1, &vertex_buffer_);
         glGenBuffers(1, &normal_buffer_);
         glGenBuffers(1, &tex_coord_buffer_);
+#ifdef __EMSCRIPTEN__
         glGenBuffers(1, &edge_buffer_);
         glGenBuffers(1, &feature_buffer_);
+#else
+        glGenBuffers(1, &edge_flag_buffer_);
+        glGenTextures(1, &edge_flag_texture_);
+#endif
+        glGenBuffers(1, &triangle_buffer_);
     }
 
     // activate VAO
     glBindVertexArray(vertex_array_object_);
 
+    // the corners the OpenGL vertices are taken from
+    corners_.clear();
+
+#ifndef __EMSCRIPTEN__
+    // the triangles change, the id buffer has to be redrawn
+    triangle_offsets_.clear();
+    id_valid_ = false;
+#endif
+
     // get vertex properties
     auto vpos = get_vertex_property<Point>("v:point");
     auto vtex = get_vertex_property<TexCoord>("v:tex");
     auto htex = get_halfedge_property<TexCoord>("h:tex");
+    auto vtex16 = get_vertex_property<TexCoord16>("v:tex");
+    auto htex16 = get_halfedge_property<TexCoord16>("h:tex");
 
-    // index array for remapping vertex indices during duplication
-    auto vertex_indices = add_vertex_property<size_t>("v:index");
+    // index of the first OpenGL vertex of each mesh vertex
+    std::vector<unsigned int> vertex_indices(vertices_size() + 1, 0);
 
-    // produce arrays of points, normals, and texcoords
-    // (duplicate vertices to allow for flat shading)
+    // produce arrays of points, normals, and texcoords. a vertex is
+    // duplicated only for corners that differ in normal or texcoord, e.g.,
+    // at sharp edges or texture seams, the triangles index into the arrays.
     std::vector<vec3> positionArray;
-    std::vector<vec3> normalArray;
+    std::vector<PackedNormal> normalArray;
     std::vector<vec2> texArray;
+    std::vector<unsigned int> triangleArray;
+#ifndef __EMSCRIPTEN__
+    std::vector<GLubyte> edgeFlagArray;
+#endif
 
-    // we have a mesh: fill arrays by looping over faces
+    // feature edges
+    auto efeature = get_edge_property<bool>("e:feature");
+
+    // we have a mesh: count the arrays, then fill them in parallel
     if (n_faces())
     {
-        // reserve memory
-        positionArray.reserve(3 * n_faces());
-        normalArray.reserve(3 * n_faces());
-        if (htex || vtex) texArray.reserve(3 * n_faces());
+        // convert from degrees to radians
+        const Scalar creaseAngle = crease_angle_ / 180.0 * M_PI;
 
-        // precompute normals for easy cases
-        FaceProperty<Normal>    fnormals;
-        VertexProperty<Normal>  vnormals;
+        // precompute the normals of all corners in parallel, a corner is
+        // given by the halfedge pointing to its vertex
+        std::vector<PackedNormal> cornerNormals(halfedges_size());
         if (crease_angle_ < 1)
         {
-            fnormals = add_face_property<Normal>("gl:fnormal");
-            for (auto f: faces())
-                fnormals[f] = SurfaceNormals::compute_face_normal(*this, f);
+            parallel_for(faces(), [&](Face f) {
+                const PackedNormal n =
+                    pack_normal(SurfaceNormals::compute_face_normal(*this, f));
+                for (auto h : halfedges(f))
+                    cornerNormals[h.idx()] = n;
+            });
         }
         else if (crease_angle_ > 170)
         {
-            vnormals = add_vertex_property<Normal>("gl:vnormal");
-            for (auto v: vertices())
-                vnormals[v] = SurfaceNormals::compute_vertex_normal(*this, v);
+            // approximate angles are exact enough for shading
+            parallel_for(vertices(), [&](Vertex v) {
+                const PackedNormal n =
+                    pack_normal(SurfaceNormals::compute_vertex_normal(
+                        *this, v, SurfaceNormals::ApproximateAngle));
+                for (auto h : halfedges(v))
+                    cornerNormals[opposite_halfedge(h).idx()] = n;
+            });
         }
-
-        // data per face (for all corners)
-        std::vector<Halfedge> cornerHalfedges;
-        std::vector<Vertex> cornerVertices;
-        std::vector<vec3> cornerNormals;
-
-        // convert from degrees to radians
-        const Scalar creaseAngle = crease_angle_ / 180.0 * M_PI;
-
-        size_t vidx(0);
-
-        // loop over all faces
-        for (auto f : faces())
+        else
         {
-            // collect corner positions and normals
-            cornerHalfedges.clear();
-            cornerVertices.clear();
-            cornerNormals.clear();
-            Vertex v;
-            Normal n;
-
-            for (auto h : halfedges(f))
-            {
-                cornerHalfedges.push_back(h);
+            parallel_for(faces(), [&](Face f) {
+                for (auto h : halfedges(f))
+                    cornerNormals[h.idx()] =
+                        pack_normal(SurfaceNormals::compute_corner_normal(
+                            *this, h, creaseAngle));
+            });
+        }
 
-                v = to_vertex(h);
-                cornerVertices.push_back(v);
+        // the texture coordinate of a corner
+        auto cornerTexCoord = [&](Halfedge h) {
+            if (htex)
+                return (vec2)htex[h];
+            else if (htex16)
+                return (vec2)TexCoord(htex16[h]);
+            else if (vtex)
+                return (vec2)vtex[to_vertex(h)];
+            else if (vtex16)
+                return (vec2)TexCoord(vtex16[to_vertex(h)]);
+            else
+                return vec2(0, 0);
+        };
+        auto sameCorner = [&](Halfedge h0, Halfedge h1) {
+            return cornerNormals[h0.idx()] == cornerNormals[h1.idx()] &&
+                   cornerTexCoord(h0) == cornerTexCoord(h1);
+        };
+
+        // number the distinct corners of each vertex, the first corner
+        // with the same attributes gives the number
+        std::vector<unsigned int> cornerIndices(halfedges_size());
+        parallel_for(vertices(), [&](Vertex v) {
+            unsigned int n = 0;
+            for (auto h : halfedges(v))
+            {
+                const Halfedge c = opposite_halfedge(h);
+                if (is_boundary(c))
+                    continue;
 
-                if (crease_angle_ < 1)
+                unsigned int idx = n;
+                for (auto g : halfedges(v))
                 {
-                    n = fnormals[f];
+                    if (g == h)
+                        break;
+                    const Halfedge d = opposite_halfedge(g);
+                    if (!is_boundary(d) && sameCorner(c, d))
+                    {
+                        idx = cornerIndices[d.idx()];
+                        break;
+                    }
                 }
-                else if (crease_angle_ > 170)
-                {
-                    n = vnormals[v];
-                }
-                else
-                {
-                    n = SurfaceNormals::compute_corner_normal(*this, h, creaseAngle);
-                }
-                cornerNormals.push_back((vec3)n);
+                if (idx == n)
+                    ++n;
+                cornerIndices[c.idx()] = idx;
             }
-            assert(cornerVertices.size() >= 3);
-
-            // tessellate face into triangles
-            int i0, i1, i2, nc = cornerVertices.size();
-            for (i0 = 0, i1 = 1, i2 = 2; i2 < nc; ++i1, ++i2)
+            vertex_indices[v.idx() + 1] = n;
+        });
+        std::partial_sum(vertex_indices.begin(), vertex_indices.end(),
+                         vertex_indices.begin());
+
+        // fill the vertex arrays
+        const size_t nGLVertices = vertex_indices.back();
+        corners_.resize(nGLVertices);
+        positionArray.resize(nGLVertices);
+        normalArray.resize(nGLVertices);
+        if (htex || vtex || htex16 || vtex16) texArray.resize(nGLVertices);
+        parallel_for(vertices(), [&](Vertex v) {
+            for (auto h : halfedges(v))
             {
-                positionArray.push_back((vec3)vpos[cornerVertices[i0]]);
-                positionArray.push_back((vec3)vpos[cornerVertices[i1]]);
-                positionArray.push_back((vec3)vpos[cornerVertices[i2]]);
+                const Halfedge c = opposite_halfedge(h);
+                if (is_boundary(c))
+                    continue;
+
+                const unsigned int idx =
+                    vertex_indices[v.idx()] + cornerIndices[c.idx()];
+                cornerIndices[c.idx()] = idx;
+                corners_[idx] = c;
+                positionArray[idx] = (vec3)vpos[v];
+                normalArray[idx] = cornerNormals[c.idx()];
+                if (!texArray.empty())
+                    texArray[idx] = cornerTexCoord(c);
+            }
+        });
 
-                normalArray.push_back((vec3)cornerNormals[i0]);
-                normalArray.push_back((vec3)cornerNormals[i1]);
-                normalArray.push_back((vec3)cornerNormals[i2]);
+        // count the triangles of each face
+        std::vector<unsigned int> triangleOffsets(faces_size() + 1, 0);
+        parallel_for(faces(), [&](Face f) {
+            triangleOffsets[f.idx() + 1] = valence(f) - 2;
+        });
+        std::partial_sum(triangleOffsets.begin(), triangleOffsets.end(),
+                         triangleOffsets.begin());
 
-                if (htex)
-                {
-                    texArray.push_back((vec2)htex[cornerHalfedges[i0]]);
-                    texArray.push_back((vec2)htex[cornerHalfedges[i1]]);
-                    texArray.push_back((vec2)htex[cornerHalfedges[i2]]);
-                }
-                else if (vtex)
-                {
-                    texArray.push_back((vec2)vtex[cornerVertices[i0]]);
-                    texArray.push_back((vec2)vtex[cornerVertices[i1]]);
-                    texArray.push_back((vec2)vtex[cornerVertices[i2]]);
-                }
+#ifndef __EMSCRIPTEN__
+        // the flags of the edge of h as side i of a triangle
+        auto edgeFlags = [&](Halfedge h, int i) {
+            const bool feature = efeature && efeature[edge(h)];
+            return (1 << i) | (feature ? 8 << i : 0);
+        };
+        edgeFlagArray.resize(triangleOffsets.back());
+#endif
 
-                vertex_indices[cornerVertices[i0]] = vidx++;
-                vertex_indices[cornerVertices[i1]] = vidx++;
-                vertex_indices[cornerVertices[i2]] = vidx++;
+        // tessellate faces into triangle fans
+        triangleArray.resize(3 * triangleOffsets.back());
+        parallel_for(faces(), [&](Face f) {
+            unsigned int* t = &triangleArray[3 * triangleOffsets[f.idx()]];
+#ifndef __EMSCRIPTEN__
+            GLubyte* flags = &edgeFlagArray[triangleOffsets[f.idx()]];
+#endif
+            const Halfedge h0 = halfedge(f);
+            for (Halfedge h1 = next_halfedge(h0), h2 = next_halfedge(h1);
+                 h2 != h0; h1 = h2, h2 = next_halfedge(h2))
+            {
+                *t++ = cornerIndices[h0.idx()];
+                *t++ = cornerIndices[h1.idx()];
+                *t++ = cornerIndices[h2.idx()];
+#ifndef __EMSCRIPTEN__
+                // the sides to h0 are mesh edges for the first and last
+                // triangle only, the others are diagonals
+                int g = edgeFlags(h2, 1);
+                if (h1 == next_halfedge(h0))
+                    g |= edgeFlags(h1, 0);
+                if (next_halfedge(h2) == h0)
+                    g |= edgeFlags(h0, 2);
+                *flags++ = GLubyte(g);
+#endif
             }
-        }
-    
-       
-        // clean up
-        if (vnormals) remove_vertex_property(vnormals);
-        if (fnormals) remove_face_property(fnormals);
+        });
+
+#ifndef __EMSCRIPTEN__
+        // keep the offsets to map picked triangles to their faces
+        triangle_offsets_.swap(triangleOffsets);
+#endif
     }
 
     // we have a point cloud
@@ -361,11 +616,18 @@ void SurfaceMeshGL::update_opengl_buffers()
         }
 
         auto normals = get_vertex_property<Point>("v:normal");
+        auto normals16 = get_vertex_property<OctNormal>("v:normal");
         if (normals)
         {
             normalArray.reserve(n_vertices());
             for (auto v: vertices())
-                normalArray.push_back( (vec3) normals[v] );
+                normalArray.push_back(pack_normal(normals[v]));
+        }
+        else if (normals16)
+        {
+            normalArray.reserve(n_vertices());
+            for (auto v: vertices())
+                normalArray.push_back(pack_normal(Normal(normals16[v])));
         }
     }
 
@@ -384,13 +646,15 @@ void SurfaceMeshGL::update_opengl_buffers()
     else n_vertices_ = 0;
 
 
-    // upload normals
+    // upload normals as normalized shorts
     if (!normalArray.empty())
     {
         glBindBuffer(GL_ARRAY_BUFFER, normal_buffer_);
-        glBufferData(GL_ARRAY_BUFFER, normalArray.size() * 3 * sizeof(float),
-                normalArray.data(), GL_STATIC_DRAW);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+        glBufferData(GL_ARRAY_BUFFER,
+                     normalArray.size() * sizeof(PackedNormal),
+                     normalArray.data(), GL_STATIC_DRAW);
+        glVertexAttribPointer(1, 3, GL_SHORT, GL_TRUE, sizeof(PackedNormal),
+                              nullptr);
         glEnableVertexAttribArray(1);
     }
 
@@ -408,6 +672,19 @@ void SurfaceMeshGL::update_opengl_buffers()
     else have_texcoords_ = false;
 
 
+    // upload triangle indices
+    if (!triangleArray.empty())
+    {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, triangle_buffer_);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                     triangleArray.size() * sizeof(unsigned int),
+                     triangleArray.data(), GL_STATIC_DRAW);
+        n_triangles_ = triangleArray.size() / 3;
+    }
+    else n_triangles_ = 0;
+
+
+#ifdef __EMSCRIPTEN__
     // edge indices
     if (n_edges())
     {
@@ -415,8 +692,8 @@ void SurfaceMeshGL::update_opengl_buffers()
         edgeArray.reserve(n_edges());
         for (auto e : edges())
         {
-            edgeArray.push_back(vertex_indices[vertex(e, 0)]);
-            edgeArray.push_back(vertex_indices[vertex(e, 1)]);
+            edgeArray.push_back(vertex_indices[vertex(e, 0).idx()]);
+            edgeArray.push_back(vertex_indices[vertex(e, 1).idx()]);
         }
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, edge_buffer_);
         glBufferData(GL_ELEMENT_ARRAY_BUFFER,
@@ -428,7 +705,6 @@ void SurfaceMeshGL::update_opengl_buffers()
 
 
     // feature edges
-    auto efeature = get_edge_property<bool>("e:feature");
     if (efeature)
     {
         std::vector<unsigned int> features;
@@ -437,8 +713,8 @@ void SurfaceMeshGL::update_opengl_buffers()
         {
             if (efeature[e])
             {
-                features.push_back(vertex_indices[vertex(e, 0)]);
-                features.push_back(vertex_indices[vertex(e, 1)]);
+                features.push_back(vertex_indices[vertex(e, 0).idx()]);
+                features.push_back(vertex_indices[vertex(e, 1).idx()]);
             }
         }
 
@@ -451,11 +727,499 @@ void SurfaceMeshGL::update_opengl_buffers()
     else n_features_ = 0;
 
 
+#else
+    // edge flags of the triangles, read by the wireframe geometry shader
+    if (!edgeFlagArray.empty())
+    {
+        glBindBuffer(GL_TEXTURE_BUFFER, edge_flag_buffer_);
+        glBufferData(GL_TEXTURE_BUFFER, edgeFlagArray.size(),
+                     edgeFlagArray.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        glBindTexture(GL_TEXTURE_BUFFER, edge_flag_texture_);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_R8UI, edge_flag_buffer_);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+    }
+
+    // the wireframe shader draws feature edges if there are any
+    n_features_ = efeature ? GLsizei(std::count(efeature.vector().begin(),
+                                                efeature.vector().end(),
+                                                true))
+                           : 0;
+#endif
+
+
     // unbind vertex arry
     glBindVertexArray(0);
 
-    // remove vertex index property again
-    remove_vertex_property(vertex_indices);
+    // remember the sizes the buffers were built for
+    n_buffered_vertices_ = vertices_size();
+    n_buffered_halfedges_ = halfedges_size();
+    buffered_topology_version_ = topology_version();
+
+    // everything was uploaded
+    buffer_memory_ = positionArray.size() * 3 * sizeof(float) +
+                     normalArray.size() * sizeof(PackedNormal) +
+                     texArray.size() * 2 * sizeof(float) +
+                     triangleArray.size() * sizeof(unsigned int);
+#ifdef __EMSCRIPTEN__
+    buffer_memory_ += (n_edges_ + n_features_) * sizeof(unsigned int);
+#else
+    buffer_memory_ += edgeFlagArray.size();
+#endif
+    uploaded_bytes_ = buffer_memory_;
+    upload_time_ = timer.stop().elapsed();
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMeshGL::update_opengl_positions()
+{
+    // rebuild everything if the connectivity changed, also by flips that
+    // keep the numbers of elements
+    if (!vertex_array_object_ || corners_.empty() ||
+        corners_.size() != size_t(n_vertices_) ||
+        buffered_topology_version_ != topology_version() ||
+        n_buffered_vertices_ != vertices_size() ||
+        n_buffered_halfedges_ != halfedges_size() ||
+        n_vertices() != vertices_size() || n_faces() != faces_size())
+    {
+        update_opengl_buffers();
+        return;
+    }
+
+    Timer timer;
+    timer.start();
+
+    auto vpos = get_vertex_property<Point>("v:point");
+    const Scalar creaseAngle = crease_angle_ / 180.0 * M_PI;
+
+    // recompute the attributes of each OpenGL vertex from its corner
+    std::vector<vec3> positionArray(corners_.size());
+    std::vector<PackedNormal> normalArray(corners_.size());
+    parallel_for(0, corners_.size(), [&](size_t i) {
+        const Halfedge h = corners_[i];
+        const Vertex v = to_vertex(h);
+        Normal n;
+        if (crease_angle_ < 1)
+            n = SurfaceNormals::compute_face_normal(*this, face(h));
+        else if (crease_angle_ > 170)
+            n = SurfaceNormals::compute_vertex_normal(
+                *this, v, SurfaceNormals::ApproximateAngle);
+        else
+            n = SurfaceNormals::compute_corner_normal(*this, h, creaseAngle);
+        positionArray[i] = (vec3)vpos[v];
+        normalArray[i] = pack_normal(n);
+    });
+
+#ifndef __EMSCRIPTEN__
+    // the positions change, the id buffer has to be redrawn
+    id_valid_ = false;
+#endif
+
+    // overwrite the buffers in place
+    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer_);
+    glBufferSubData(GL_ARRAY_BUFFER, 0,
+                    positionArray.size() * 3 * sizeof(float),
+                    positionArray.data());
+    glBindBuffer(GL_ARRAY_BUFFER, normal_buffer_);
+    glBufferSubData(GL_ARRAY_BUFFER, 0,
+                    normalArray.size() * sizeof(PackedNormal),
+                    normalArray.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    uploaded_bytes_ = positionArray.size() * 3 * sizeof(float) +
+                      normalArray.size() * sizeof(PackedNormal);
+    upload_time_ = timer.stop().elapsed();
+}
+
+//-----------------------------------------------------------------------------
+
+size_t SurfaceMeshGL::gpu_memory() const
+{
+    size_t bytes = buffer_memory_ + texture_memory_;
+#ifndef __EMSCRIPTEN__
+    bytes += patch_memory_;
+
+    // 32-bit ids and 24-bit depth, padded to 32 bits
+    if (id_framebuffer_)
+        bytes += size_t(id_viewport_[2]) * id_viewport_[3] * 8;
+#endif
+    return bytes;
+}
+
+//-----------------------------------------------------------------------------
+
+#ifndef __EMSCRIPTEN__
+bool SurfaceMeshGL::is_tessellation_supported()
+{
+    return GLEW_VERSION_4_0 || GLEW_ARB_tessellation_shader;
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMeshGL::update_limit_patches(SurfaceLimitEvaluation::Scheme scheme)
+{
+    if (!is_tessellation_supported())
+    {
+        std::cerr << "SurfaceMeshGL: Tessellation shaders are not supported\n";
+        return false;
+    }
+
+    Timer timer;
+    timer.start();
+
+    const bool quads = (scheme == SurfaceLimitEvaluation::CatmullClark);
+    std::vector<Face> patch_faces;
+    patch_faces.reserve(n_faces());
+    for (auto f : faces())
+    {
+        if (valence(f) != (quads ? 4u : 3u))
+        {
+            std::cerr << "SurfaceMeshGL: Not a " << (quads ? "quad" : "triangle")
+                      << " mesh\n";
+            return false;
+        }
+        patch_faces.push_back(f);
+    }
+
+    // the control points interpolating the limit at the parameters of the
+    // exponents, where faces with a boundary vertex are flat
+    const auto exponents = patch_exponents(quads);
+    const auto fit = patch_fit_matrix(quads);
+    const size_t n = exponents.size();
+    const Scalar degree = quads ? 3 : 4;
+    const SurfaceLimitEvaluation limit(*this, scheme);
+    std::vector<vec3> points(patch_faces.size() * n);
+    parallel_for(0, patch_faces.size(), [&](size_t f) {
+        dvec3 samples[16];
+        for (size_t k = 0; k < n; ++k)
+        {
+            Point p;
+            Normal normal;
+            limit.evaluate(patch_faces[f],
+                           TexCoord(exponents[k].first / degree,
+                                    exponents[k].second / degree),
+                           p, normal);
+            samples[k] = (dvec3)p;
+        }
+        for (size_t r = 0; r < n; ++r)
+        {
+            dvec3 c(0, 0, 0);
+            for (size_t k = 0; k < n; ++k)
+                c += fit[r * n + k] * samples[k];
+            points[f * n + r] = (vec3)c;
+        }
+    });
+
+    if (!patch_array_object_)
+    {
+        glGenVertexArrays(1, &patch_array_object_);
+        glGenBuffers(1, &patch_buffer_);
+    }
+    glBindVertexArray(patch_array_object_);
+    glBindBuffer(GL_ARRAY_BUFFER, patch_buffer_);
+    patch_memory_ = points.size() * sizeof(vec3);
+    glBufferData(GL_ARRAY_BUFFER, patch_memory_, points.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+    glEnableVertexAttribArray(0);
+    glBindVertexArray(0);
+    n_patch_vertices_ = GLsizei(points.size());
+
+    // the shaders depend on the kind of patches
+    if (!limit_shader_.is_valid() || patch_size_ != GLint(n))
+    {
+        const std::string version =
+            std::string("#version 400\n") + (quads ? "#define QUADS\n" : "");
+        const std::string vshader = version + limit_vshader;
+        const std::string tcshader = version + limit_tcshader;
+        const std::string teshader = version + limit_teshader;
+        if (!limit_shader_.source(vshader.c_str(), tcshader.c_str(),
+                                  teshader.c_str(), phong_fshader))
+        {
+            n_patch_vertices_ = 0;
+            return false;
+        }
+    }
+    patch_size_ = GLint(n);
+
+    uploaded_bytes_ = patch_memory_;
+    upload_time_ = timer.stop().elapsed();
+    glCheckError();
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMeshGL::set_tessellation_level(unsigned int segments)
+{
+    tessellation_level_ = std::max(1u, std::min(segments, 64u));
+}
+#endif
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMeshGL::draw_triangles()
+{
+    // the edges and features bind their own element buffers to the VAO
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, triangle_buffer_);
+    glDrawElements(GL_TRIANGLES, 3 * n_triangles_, GL_UNSIGNED_INT, nullptr);
+}
+
+//-----------------------------------------------------------------------------
+
+#ifndef __EMSCRIPTEN__
+void SurfaceMeshGL::update_id_buffer(const mat4& projection_matrix,
+                                     const mat4& modelview_matrix)
+{
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    const mat4 mvp_matrix = projection_matrix * modelview_matrix;
+
+    // nothing changed since the last pick
+    if (id_valid_ && mvp_matrix == id_matrix_ &&
+        std::equal(viewport, viewport + 4, id_viewport_))
+        return;
+
+    if (!pick_shader_.is_valid())
+    {
+        if (!pick_shader_.source(pick_vshader, pick_fshader))
+            exit(1);
+    }
+
+    GLint framebuffer;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &framebuffer);
+
+    // (re-)allocate the id buffer for the size of the viewport
+    const GLsizei width = viewport[2];
+    const GLsizei height = viewport[3];
+    if (!id_framebuffer_ || width != id_viewport_[2] ||
+        height != id_viewport_[3])
+    {
+        if (!id_framebuffer_)
+        {
+            glGenFramebuffers(1, &id_framebuffer_);
+            glGenTextures(1, &id_texture_);
+            glGenRenderbuffers(1, &id_depth_buffer_);
+        }
+
+        glBindTexture(GL_TEXTURE_2D, id_texture_);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R32UI, width, height, 0,
+                     GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        glBindRenderbuffer(GL_RENDERBUFFER, id_depth_buffer_);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width,
+                              height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, id_framebuffer_);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                               GL_TEXTURE_2D, id_texture_, 0);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+                                  GL_RENDERBUFFER, id_depth_buffer_);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) !=
+            GL_FRAMEBUFFER_COMPLETE)
+            std::cerr << "Incomplete framebuffer for picking!\n";
+    }
+
+    // render the triangle ids, zero is the background
+    const GLuint background[4] = {0, 0, 0, 0};
+    glBindFramebuffer(GL_FRAMEBUFFER, id_framebuffer_);
+    glViewport(0, 0, width, height);
+    glClearBufferuiv(GL_COLOR, 0, background);
+    glClear(GL_DEPTH_BUFFER_BIT);
+
+    pick_shader_.use();
+    pick_shader_.set_uniform("modelview_projection_matrix", mvp_matrix);
+    glBindVertexArray(vertex_array_object_);
+    draw_triangles();
+    glBindVertexArray(0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    glCheckError();
+
+    std::copy(viewport, viewport + 4, id_viewport_);
+    id_matrix_ = mvp_matrix;
+    id_valid_ = true;
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMeshGL::read_id_buffer(int x, int y, int width, int height,
+                                   GLenum format, GLenum type, void* data)
+{
+    GLint framebuffer;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &framebuffer);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, id_framebuffer_);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(x - id_viewport_[0], y - id_viewport_[1], width, height,
+                 format, type, data);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+}
+
+//-----------------------------------------------------------------------------
+
+Face SurfaceMeshGL::id_to_face(GLuint id) const
+{
+    // the face whose triangles include triangle id-1
+    if (id == 0 || triangle_offsets_.empty() ||
+        id > triangle_offsets_.back())
+        return Face();
+    auto it = std::upper_bound(triangle_offsets_.begin(),
+                               triangle_offsets_.end(), id - 1);
+    return Face(IndexType(it - triangle_offsets_.begin() - 1));
+}
+
+//-----------------------------------------------------------------------------
+
+Face SurfaceMeshGL::pick_face(const mat4& projection_matrix,
+                              const mat4& modelview_matrix, int x, int y)
+{
+    if (!n_triangles_)
+        return Face();
+
+    update_id_buffer(projection_matrix, modelview_matrix);
+    if (x < id_viewport_[0] || x >= id_viewport_[0] + id_viewport_[2] ||
+        y < id_viewport_[1] || y >= id_viewport_[1] + id_viewport_[3])
+        return Face();
+
+    GLuint id = 0;
+    read_id_buffer(x, y, 1, 1, GL_RED_INTEGER, GL_UNSIGNED_INT, &id);
+    return id_to_face(id);
+}
+
+//-----------------------------------------------------------------------------
+
+Vertex SurfaceMeshGL::pick_vertex(const mat4& projection_matrix,
+                                  const mat4& modelview_matrix, int x, int y)
+{
+    const Face f = pick_face(projection_matrix, modelview_matrix, x, y);
+    if (!f.is_valid())
+        return Vertex();
+
+    // the surface point at the pixel from its depth
+    float zf;
+    read_id_buffer(x, y, 1, 1, GL_DEPTH_COMPONENT, GL_FLOAT, &zf);
+    const float xf =
+        (float(x - id_viewport_[0]) + 0.5f) / float(id_viewport_[2]) * 2.0f -
+        1.0f;
+    const float yf =
+        (float(y - id_viewport_[1]) + 0.5f) / float(id_viewport_[3]) * 2.0f -
+        1.0f;
+    vec4 p = inverse(id_matrix_) * vec4(xf, yf, zf * 2.0f - 1.0f, 1.0f);
+    const Point picked_position(p[0] / p[3], p[1] / p[3], p[2] / p[3]);
+
+    // the closest vertex of the face
+    Vertex vmin;
+    Scalar dmin(FLT_MAX);
+    for (auto v : vertices(f))
+    {
+        const Scalar d = distance(position(v), picked_position);
+        if (d < dmin)
+        {
+            dmin = d;
+            vmin = v;
+        }
+    }
+    return vmin;
+}
+
+//-----------------------------------------------------------------------------
+
+std::vector<Face> SurfaceMeshGL::pick_faces(const mat4& projection_matrix,
+                                            const mat4& modelview_matrix,
+                                            int x0, int y0, int x1, int y1)
+{
+    std::vector<Face> picked;
+    if (!n_triangles_)
+        return picked;
+
+    update_id_buffer(projection_matrix, modelview_matrix);
+
+    // clip the rectangle to the viewport
+    const int xmin = std::max(std::min(x0, x1), id_viewport_[0]);
+    const int ymin = std::max(std::min(y0, y1), id_viewport_[1]);
+    const int xmax =
+        std::min(std::max(x0, x1), id_viewport_[0] + id_viewport_[2] - 1);
+    const int ymax =
+        std::min(std::max(y0, y1), id_viewport_[1] + id_viewport_[3] - 1);
+    if (xmin > xmax || ymin > ymax)
+        return picked;
+
+    std::vector<GLuint> ids(size_t(xmax - xmin + 1) * (ymax - ymin + 1));
+    read_id_buffer(xmin, ymin, xmax - xmin + 1, ymax - ymin + 1,
+                   GL_RED_INTEGER, GL_UNSIGNED_INT, ids.data());
+
+    // sorted triangle ids map to sorted faces
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    for (auto id : ids)
+    {
+        const Face f = id_to_face(id);
+        if (f.is_valid() && (picked.empty() || picked.back() != f))
+            picked.push_back(f);
+    }
+    return picked;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMeshGL::setup_shader(Shader& shader, const mat4& projection_matrix,
+                                 const mat4& modelview_matrix)
+{
+    // setup matrices
+    mat4 mv_matrix = modelview_matrix;
+    mat4 mvp_matrix = projection_matrix * modelview_matrix;
+    mat3 n_matrix = inverse(transpose(linear_part(mv_matrix)));
+
+    // setup shader
+    shader.use();
+    shader.set_uniform("modelview_projection_matrix", mvp_matrix);
+    shader.set_uniform("modelview_matrix", mv_matrix);
+    shader.set_uniform("normal_matrix", n_matrix);
+    if (&shader != &limit_shader_)
+        shader.set_uniform("point_size", 5.0f);
+    shader.set_uniform("light1", vec3(1.0, 1.0, 1.0));
+    shader.set_uniform("light2", vec3(-1.0, 1.0, 1.0));
+    shader.set_uniform("front_color", front_color_);
+    shader.set_uniform("back_color", back_color_);
+    shader.set_uniform("ambient", ambient_);
+    shader.set_uniform("diffuse", diffuse_);
+    shader.set_uniform("specular", specular_);
+    shader.set_uniform("shininess", shininess_);
+    shader.set_uniform("alpha", alpha_);
+    shader.set_uniform("use_lighting", true);
+    shader.set_uniform("use_texture", false);
+    shader.set_uniform("use_srgb", false);
+    if (&shader != &limit_shader_)
+        shader.set_uniform("show_texture_layout", false);
+
+#ifndef __EMSCRIPTEN__
+    if (&shader == &wireframe_shader_)
+    {
+        // the edge distances are measured in pixels of the viewport
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        shader.set_uniform("viewport", vec2(viewport[2], viewport[3]));
+
+        // the edge flags are bound to texture unit 1
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_BUFFER, edge_flag_texture_);
+        glActiveTexture(GL_TEXTURE0);
+        shader.set_uniform("edge_flags", 1);
+
+        shader.set_uniform("show_edges", false);
+        shader.set_uniform("lines_only", false);
+        shader.set_uniform("edge_color", vec3(0.1, 0.1, 0.1));
+        shader.set_uniform("feature_color", vec3(0, 1, 0));
+        shader.set_uniform("line_width", 1.0f);
+    }
+#endif
 }
 
 //-----------------------------------------------------------------------------
@@ -476,6 +1240,14 @@ void SurfaceMeshGL::draw(const mat4& projection_matrix,
         if (!phong_shader_.source(phong_vshader, phong_fshader))
             exit(1);
     }
+#ifndef __EMSCRIPTEN__
+    if (!wireframe_shader_.is_valid())
+    {
+        if (!wireframe_shader_.source(phong_vshader, wireframe_gshader,
+                                      wireframe_fshader))
+            exit(1);
+    }
+#endif
 
     // we need some texture, otherwise WebGL complains
     if (!texture_)
@@ -487,30 +1259,37 @@ void SurfaceMeshGL::draw(const mat4& projection_matrix,
     if (is_empty())
         return;
 
-    // setup matrices
-    mat4 mv_matrix = modelview_matrix;
-    mat4 mvp_matrix = projection_matrix * modelview_matrix;
-    mat3 n_matrix = inverse(transpose(linear_part(mv_matrix)));
+#ifndef __EMSCRIPTEN__
+    // the limit patches have their own buffer and shaders
+    if (draw_mode == "Limit Surface")
+    {
+        if (n_patch_vertices_)
+        {
+            setup_shader(limit_shader_, projection_matrix, modelview_matrix);
+            limit_shader_.set_uniform("tessellation_level",
+                                      float(tessellation_level_));
+            glBindVertexArray(patch_array_object_);
+            glPatchParameteri(GL_PATCH_VERTICES, patch_size_);
+            glDrawArrays(GL_PATCHES, 0, n_patch_vertices_);
+            glBindVertexArray(0);
+            glCheckError();
+        }
+        return;
+    }
+#endif
 
-    // setup shader
-    phong_shader_.use();
-    phong_shader_.set_uniform("modelview_projection_matrix", mvp_matrix);
-    phong_shader_.set_uniform("modelview_matrix", mv_matrix);
-    phong_shader_.set_uniform("normal_matrix", n_matrix);
-    phong_shader_.set_uniform("point_size", 5.0f);
-    phong_shader_.set_uniform("light1", vec3(1.0, 1.0, 1.0));
-    phong_shader_.set_uniform("light2", vec3(-1.0, 1.0, 1.0));
-    phong_shader_.set_uniform("front_color", front_color_);
-    phong_shader_.set_uniform("back_color", back_color_);
-    phong_shader_.set_uniform("ambient", ambient_);
-    phong_shader_.set_uniform("diffuse", diffuse_);
-    phong_shader_.set_uniform("specular", specular_);
-    phong_shader_.set_uniform("shininess", shininess_);
-    phong_shader_.set_uniform("alpha", alpha_);
-    phong_shader_.set_uniform("use_lighting", true);
-    phong_shader_.set_uniform("use_texture", false);
-    phong_shader_.set_uniform("use_srgb", false);
-    phong_shader_.set_uniform("show_texture_layout", false);
+    // draw edges and feature edges of the triangles in the same pass
+#ifdef __EMSCRIPTEN__
+    const bool wireframe = false;
+#else
+    const bool wireframe =
+        n_faces() &&
+        (draw_mode == "Hidden Line" || draw_mode == "Texture Layout" ||
+         (n_features_ &&
+          (draw_mode == "Smooth Shading" || draw_mode == "Texture")));
+#endif
+    Shader& shader = wireframe ? wireframe_shader_ : phong_shader_;
+    setup_shader(shader, projection_matrix, modelview_matrix);
 
     glBindVertexArray(vertex_array_object_);
 
@@ -519,6 +1298,9 @@ void SurfaceMeshGL::draw(const mat4& projection_matrix,
 #ifndef __EMSCRIPTEN__
         glEnable(GL_PROGRAM_POINT_SIZE);
 #endif
+        // point clouds without normals cannot be shaded
+        if (!n_faces() && !has_vertex_property("v:normal"))
+            shader.set_uniform("use_lighting", false);
         glDrawArrays(GL_POINTS, 0, n_vertices_);
     }
 
@@ -526,19 +1308,25 @@ void SurfaceMeshGL::draw(const mat4& projection_matrix,
     {
         if (n_faces())
         {
+#ifdef __EMSCRIPTEN__
             // draw faces
             glDepthRange(0.01, 1.0);
-            glDrawArrays(GL_TRIANGLES, 0, n_vertices_);
+            draw_triangles();
 
             // overlay edges
             glDepthRange(0.0, 1.0);
             glDepthFunc(GL_LEQUAL);
-            phong_shader_.set_uniform("front_color", vec3(0.1, 0.1, 0.1));
-            phong_shader_.set_uniform("back_color", vec3(0.1, 0.1, 0.1));
-            phong_shader_.set_uniform("use_lighting", false);
+            shader.set_uniform("front_color", vec3(0.1, 0.1, 0.1));
+            shader.set_uniform("back_color", vec3(0.1, 0.1, 0.1));
+            shader.set_uniform("use_lighting", false);
             glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, edge_buffer_);
             glDrawElements(GL_LINES, n_edges_, GL_UNSIGNED_INT, nullptr);
             glDepthFunc(GL_LESS);
+#else
+            // draw faces with their edges
+            shader.set_uniform("show_edges", true);
+            draw_triangles();
+#endif
         }
     }
 
@@ -546,7 +1334,7 @@ void SurfaceMeshGL::draw(const mat4& projection_matrix,
     {
         if (n_faces())
         {
-            glDrawArrays(GL_TRIANGLES, 0, n_vertices_);
+            draw_triangles();
         }
     }
 
@@ -554,12 +1342,12 @@ void SurfaceMeshGL::draw(const mat4& projection_matrix,
     {
         if (n_faces())
         {
-            phong_shader_.set_uniform("front_color", vec3(0.9, 0.9, 0.9));
-            phong_shader_.set_uniform("back_color", vec3(0.3, 0.3, 0.3));
-            phong_shader_.set_uniform("use_texture", true);
-            phong_shader_.set_uniform("use_srgb", srgb_);
+            shader.set_uniform("front_color", vec3(0.9, 0.9, 0.9));
+            shader.set_uniform("back_color", vec3(0.3, 0.3, 0.3));
+            shader.set_uniform("use_texture", true);
+            shader.set_uniform("use_srgb", srgb_);
             glBindTexture(GL_TEXTURE_2D, texture_);
-            glDrawArrays(GL_TRIANGLES, 0, n_vertices_);
+            draw_triangles();
         }
     }
 
@@ -567,27 +1355,33 @@ void SurfaceMeshGL::draw(const mat4& projection_matrix,
     {
         if (n_faces() && have_texcoords_)
         {
-            phong_shader_.set_uniform("show_texture_layout", true);
-            phong_shader_.set_uniform("use_lighting", false);
+            shader.set_uniform("show_texture_layout", true);
+            shader.set_uniform("use_lighting", false);
 
             // draw faces
-            phong_shader_.set_uniform("front_color", vec3(0.8, 0.8, 0.8));
-            phong_shader_.set_uniform("back_color", vec3(0.9, 0.0, 0.0));
+            shader.set_uniform("front_color", vec3(0.8, 0.8, 0.8));
+            shader.set_uniform("back_color", vec3(0.9, 0.0, 0.0));
+#ifdef __EMSCRIPTEN__
             glDepthRange(0.01, 1.0);
-            glDrawArrays(GL_TRIANGLES, 0, n_vertices_);
+            draw_triangles();
 
             // overlay edges
             glDepthRange(0.0, 1.0);
             glDepthFunc(GL_LEQUAL);
-            phong_shader_.set_uniform("front_color", vec3(0.1, 0.1, 0.1));
-            phong_shader_.set_uniform("back_color", vec3(0.1, 0.1, 0.1));
+            shader.set_uniform("front_color", vec3(0.1, 0.1, 0.1));
+            shader.set_uniform("back_color", vec3(0.1, 0.1, 0.1));
             glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, edge_buffer_);
             glDrawElements(GL_LINES, n_edges_, GL_UNSIGNED_INT, nullptr);
             glDepthFunc(GL_LESS);
+#else
+            shader.set_uniform("show_edges", true);
+            draw_triangles();
+#endif
         }
     }
 
     // draw feature edges
+#ifdef __EMSCRIPTEN__
     if (n_features_)
     {
         phong_shader_.set_uniform("front_color", vec3(0, 1, 0));
@@ -600,6 +1394,18 @@ void SurfaceMeshGL::draw(const mat4& projection_matrix,
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
         glDepthFunc(GL_LESS);
     }
+#else
+    // in the other draw modes, e.g., points, by a pass of the triangles
+    // that discards all fragments off the feature edges
+    if (n_features_ && n_faces() && !wireframe)
+    {
+        setup_shader(wireframe_shader_, projection_matrix, modelview_matrix);
+        wireframe_shader_.set_uniform("lines_only", true);
+        glDepthFunc(GL_LEQUAL);
+        draw_triangles();
+        glDepthFunc(GL_LESS);
+    }
+#endif
 
     glBindVertexArray(0);
     glCheckError();
@@ -11,9 +11,12 @@
 
 #include <pmp/visualization/GL.h>
 #include <pmp/visualization/Shader.h>
+#include <pmp/algorithms/SurfaceLimitEvaluation.h>
 #include <pmp/MatVec.h>
 #include <pmp/SurfaceMesh.h>
 
+#include <vector>
+
 //=============================================================================
 
 namespace pmp {
@@ -82,6 +85,83 @@ public:
     //! update all opengl buffers for efficient core profile rendering
     void update_opengl_buffers();
 
+    //! \brief Update only the positions and normals in the opengl buffers.
+    //! \details Call this instead of update_opengl_buffers() after the
+    //! vertex positions changed but the connectivity did not, e.g., after
+    //! smoothing. Recomputes the normals in parallel and overwrites the
+    //! buffers in place, the vertex duplication at sharp edges and the index
+    //! buffers are kept. Falls back to update_opengl_buffers() if the buffers
+    //! were not built for the current connectivity, i.e., if elements were
+    //! added or removed or edges were flipped since, see topology_version().
+    void update_opengl_positions();
+
+#ifndef __EMSCRIPTEN__
+    //! \brief Get the face visible at the pixel (x, y) of the viewport.
+    //! \details Reads the face from an id buffer, into which the triangles
+    //! are rendered with the given matrices. The id buffer is rendered again
+    //! only if the matrices, the viewport, or the buffers changed. The pixel
+    //! is in framebuffer coordinates, y=0 at the bottom. Returns an invalid
+    //! face for the background and for point clouds.
+    Face pick_face(const mat4& projection_matrix,
+                   const mat4& modelview_matrix, int x, int y);
+
+    //! \brief Get the vertex closest to the surface point at pixel (x, y).
+    //! \details Only the vertices of the face under the pixel are tested,
+    //! see pick_face().
+    Vertex pick_vertex(const mat4& projection_matrix,
+                       const mat4& modelview_matrix, int x, int y);
+
+    //! \brief Get the faces visible in the pixel rectangle from (x0, y0) to
+    //! (x1, y1), including both corners.
+    //! \details The faces are sorted by index and unique, see pick_face().
+    std::vector<Face> pick_faces(const mat4& projection_matrix,
+                                 const mat4& modelview_matrix, int x0, int y0,
+                                 int x1, int y1);
+#endif
+
+#ifndef __EMSCRIPTEN__
+    //! whether the current OpenGL context supports tessellation shaders
+    static bool is_tessellation_supported();
+
+    //! \brief Upload the limit surface of Loop or Catmull-Clark subdivision,
+    //! drawn in the draw mode "Limit Surface".
+    //! \details Each face becomes a patch of Bezier control points, a
+    //! bicubic patch for Catmull-Clark and a quartic triangle for Loop
+    //! subdivision, which interpolates the limit of SurfaceLimitEvaluation
+    //! at a grid of parameters of the face. The patches of regular faces
+    //! are the exact limit, the others approximate it, and neighboring
+    //! patches share their edge curves. The tessellation shaders evaluate
+    //! the patches when drawn, such that the buffer holds a fixed number
+    //! of points per face of the control mesh, whatever the
+    //! tessellation_level(). Faces with a boundary vertex are drawn flat.
+    //! Has to be called again after the mesh changed. Requires OpenGL 4.0,
+    //! see is_tessellation_supported().
+    //! \return false if tessellation is not supported, or if the mesh is
+    //! not a triangle mesh for Loop or not a quad mesh for Catmull-Clark
+    //! subdivision
+    bool update_limit_patches(SurfaceLimitEvaluation::Scheme scheme);
+
+    //! the number of segments per edge of the limit patches
+    unsigned int tessellation_level() const { return tessellation_level_; }
+
+    //! \brief Set the number of segments per edge of the limit patches.
+    //! \details 2^k segments match k steps of subdivision. Clamped to
+    //! [1, 64], the maximum every OpenGL 4.0 implementation supports.
+    void set_tessellation_level(unsigned int segments);
+#endif
+
+    //! \brief The GPU memory used by the buffers and textures in bytes.
+    //! \details Estimated from the uploaded sizes, drivers may allocate more.
+    size_t gpu_memory() const;
+
+    //! the number of bytes uploaded by the last update_opengl_buffers() or
+    //! update_opengl_positions()
+    size_t uploaded_bytes() const { return uploaded_bytes_; }
+
+    //! the CPU time in ms of the last update_opengl_buffers() or
+    //! update_opengl_positions(), including the upload calls
+    double upload_time() const { return upload_time_; }
+
     //! use color map to visualize scalar fields
     void use_cold_warm_texture();
 
@@ -100,23 +180,92 @@ public:
                       GLint wrap = GL_CLAMP_TO_EDGE);
 
 private:
+    //! draw the indexed triangles, in a bound vertex array object
+    void draw_triangles();
+
+#ifndef __EMSCRIPTEN__
+    //! render the triangle ids into the id buffer, unless it is up to date
+    void update_id_buffer(const mat4& projection_matrix,
+                          const mat4& modelview_matrix);
+
+    //! read a rectangle of pixels from the id buffer
+    void read_id_buffer(int x, int y, int width, int height, GLenum format,
+                        GLenum type, void* data);
+
+    //! the face of the triangle id read from the id buffer
+    Face id_to_face(GLuint id) const;
+#endif
+
+    //! use \p shader and set the matrices, lights, and material
+    void setup_shader(Shader& shader, const mat4& projection_matrix,
+                      const mat4& modelview_matrix);
+
     //! OpenGL buffers
     GLuint vertex_array_object_;
     GLuint vertex_buffer_;
     GLuint normal_buffer_;
     GLuint tex_coord_buffer_;
+#ifdef __EMSCRIPTEN__
     GLuint edge_buffer_;
     GLuint feature_buffer_;
+#else
+    //! the mesh and feature edges of each triangle, see WireframeShader.h
+    GLuint edge_flag_buffer_;
+    GLuint edge_flag_texture_;
+#endif
+    GLuint triangle_buffer_;
 
     //! buffer sizes
     GLsizei n_vertices_;
+#ifdef __EMSCRIPTEN__
     GLsizei n_edges_;
+#endif
     GLsizei n_triangles_;
     GLsizei n_features_;
     bool    have_texcoords_;
 
+#ifndef __EMSCRIPTEN__
+    //! offscreen framebuffer for picking with the triangle ids and depth
+    GLuint id_framebuffer_;
+    GLuint id_texture_;
+    GLuint id_depth_buffer_;
+    GLint id_viewport_[4];
+    mat4 id_matrix_;
+    bool id_valid_;
+
+    //! the index of the first triangle of each face, and the total
+    std::vector<unsigned int> triangle_offsets_;
+#endif
+
+#ifndef __EMSCRIPTEN__
+    //! the control points of the limit patches, see update_limit_patches()
+    GLuint patch_array_object_;
+    GLuint patch_buffer_;
+    GLsizei n_patch_vertices_;
+    GLint patch_size_;
+    size_t patch_memory_;
+    unsigned int tessellation_level_;
+#endif
+
+    //! the corner each OpenGL vertex was created from
+    std::vector<Halfedge> corners_;
+
+    //! the mesh sizes and topology_version() the buffers were built for
+    size_t n_buffered_vertices_;
+    size_t n_buffered_halfedges_;
+    unsigned long buffered_topology_version_;
+
+    //! the sizes of the buffers and the texture, and of the last upload
+    size_t buffer_memory_;
+    size_t texture_memory_;
+    size_t uploaded_bytes_;
+    double upload_time_;
+
     //! shaders
     Shader phong_shader_;
+    Shader wireframe_shader_;
+    Shader pick_shader_;
+    Shader limit_shader_;
 
     //! material properties
     vec3 front_color_, back_color_;
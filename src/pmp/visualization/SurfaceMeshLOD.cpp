@@ -0,0 +1,482 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include <pmp/visualization/SurfaceMeshLOD.h>
+#include <pmp/visualization/PhongShader.h>
+#include <pmp/algorithms/SurfaceClustering.h>
+#include <pmp/algorithms/SurfaceNormals.h>
+#include <pmp/BoundingBox.h>
+#include <pmp/Parallel.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <numeric>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+namespace {
+
+// a normal component as signed normalized short, as in SurfaceMeshGL
+inline GLshort pack_component(Scalar c)
+{
+    return GLshort(std::round(std::max(Scalar(-1), std::min(Scalar(1), c)) *
+                              32767));
+}
+
+// the bounding box of the vertices of mesh
+BoundingBox bounds(const SurfaceMesh& mesh)
+{
+    auto points = mesh.get_vertex_property<Point>("v:point");
+    BoundingBox bb;
+    for (auto v : mesh.vertices())
+        bb += points[v];
+    return bb;
+}
+
+// the mean length of up to n edges, evenly spread over the mesh
+Scalar mean_edge_length(const SurfaceMesh& mesh, size_t n)
+{
+    const size_t step = std::max(mesh.n_edges() / n, size_t(1));
+    Scalar sum = 0;
+    size_t count = 0, i = 0;
+    for (auto e : mesh.edges())
+    {
+        if (i++ % step == 0)
+        {
+            sum += distance(mesh.position(mesh.vertex(e, 0)),
+                            mesh.position(mesh.vertex(e, 1)));
+            ++count;
+        }
+    }
+    return count ? sum / count : Scalar(0);
+}
+
+// simplify mesh by SurfaceClustering with resolution cells within bb
+void simplify(const SurfaceMesh& mesh, const BoundingBox& bb,
+              unsigned int resolution, SurfaceMesh& result)
+{
+    std::vector<Point> points(mesh.vertices_size(), Point(0, 0, 0));
+    for (auto v : mesh.vertices())
+        points[v.idx()] = mesh.position(v);
+
+    std::vector<IndexType> indices, sizes;
+    indices.reserve(3 * mesh.n_faces());
+    sizes.reserve(mesh.n_faces());
+    for (auto f : mesh.faces())
+    {
+        sizes.push_back(IndexType(mesh.valence(f)));
+        for (auto v : mesh.vertices(f))
+            indices.push_back(v.idx());
+    }
+
+    SurfaceClustering clustering(bb, resolution);
+    clustering.begin(points.size(), sizes.size());
+    clustering.vertices(points);
+    clustering.faces(indices, sizes);
+    clustering.end();
+    result = std::move(clustering.mesh());
+}
+
+} // namespace
+
+//=============================================================================
+
+size_t SurfaceMeshLOD::Patch::n_bytes() const
+{
+    return positions.size() * sizeof(vec3) + normals.size() * sizeof(GLshort) +
+           indices.size() * sizeof(GLuint);
+}
+
+//-----------------------------------------------------------------------------
+
+SurfaceMeshLOD::SurfaceMeshLOD()
+    : cell_size_(1),
+      pixel_error_(1),
+      gpu_budget_(size_t(512) << 20),
+      backface_culling_(true),
+      frame_(0),
+      n_drawn_triangles_(0),
+      n_uploaded_bytes_(0)
+{
+    resolution_[0] = resolution_[1] = resolution_[2] = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+SurfaceMeshLOD::~SurfaceMeshLOD()
+{
+    clear();
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMeshLOD::clear()
+{
+    for (auto& patch : patches_)
+        release(patch);
+    patches_.clear();
+    regions_.clear();
+    errors_.clear();
+    n_drawn_triangles_ = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMeshLOD::build(const SurfaceMesh& mesh, unsigned int n_levels,
+                           unsigned int resolution)
+{
+    clear();
+
+    BoundingBox bb = bounds(mesh);
+    if (bb.is_empty() || !mesh.n_faces())
+        return;
+
+    // the grid of regions
+    const Point extent = bb.max() - bb.min();
+    const Scalar length = std::max(extent[0], std::max(extent[1], extent[2]));
+    resolution = std::max(resolution, 1u);
+    origin_ = bb.min();
+    cell_size_ = length > 0 ? length / resolution : Scalar(1);
+    for (int i = 0; i < 3; ++i)
+        resolution_[i] =
+            std::min((unsigned int)(extent[i] / cell_size_) + 1, resolution);
+    regions_.resize(size_t(resolution_[0]) * resolution_[1] * resolution_[2]);
+    for (auto& region : regions_)
+    {
+        region.min = Point(FLT_MAX, FLT_MAX, FLT_MAX);
+        region.max = Point(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    }
+
+    // the input mesh
+    errors_.push_back(0);
+    add_level(mesh, 0);
+
+    // coarser levels, each simplifying the previous one
+    const Scalar edge = mean_edge_length(mesh, 10000);
+    unsigned int cells = length > 0 && edge > 0
+                             ? (unsigned int)std::min(length / (2 * edge),
+                                                      Scalar(1 << 20))
+                             : 0;
+    SurfaceMesh coarse, previous;
+    for (unsigned int level = 1; level <= n_levels && cells >= 2;
+         ++level, cells /= 2)
+    {
+        simplify(level == 1 ? mesh : previous, bb, cells, coarse);
+        if (!coarse.n_faces())
+            break;
+
+        errors_.push_back(length / cells);
+        add_level(coarse, level);
+        std::swap(coarse, previous);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMeshLOD::add_level(const SurfaceMesh& mesh, size_t level)
+{
+    for (auto& region : regions_)
+        region.patches.resize(level + 1, -1);
+
+    auto points = mesh.get_vertex_property<Point>("v:point");
+
+    // approximate angles are exact enough for shading
+    std::vector<Normal> normals(mesh.vertices_size());
+    parallel_for(mesh.vertices(), [&](Vertex v) {
+        normals[v.idx()] = SurfaceNormals::compute_vertex_normal(
+            mesh, v, SurfaceNormals::ApproximateAngle);
+    });
+
+    // the region of each face, by its centroid
+    std::vector<unsigned int> face_region(mesh.faces_size(), UINT_MAX);
+    parallel_for(mesh.faces(), [&](Face f) {
+        Point c(0, 0, 0);
+        Scalar n = 0;
+        for (auto v : mesh.vertices(f))
+        {
+            c += points[v];
+            n += 1;
+        }
+        c /= n;
+
+        unsigned int r = 0;
+        for (int i = 0; i < 3; ++i)
+        {
+            const Scalar x = std::floor((c[i] - origin_[i]) / cell_size_);
+            const unsigned int j =
+                x <= 0 ? 0 : std::min((unsigned int)x, resolution_[i] - 1);
+            r = r * resolution_[i] + j;
+        }
+        face_region[f.idx()] = r;
+    });
+
+    // sort the faces by region
+    std::vector<size_t> offsets(regions_.size() + 1, 0);
+    for (auto f : mesh.faces())
+        ++offsets[face_region[f.idx()] + 1];
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    std::vector<Face> faces(mesh.n_faces());
+    {
+        std::vector<size_t> next(offsets.begin(), offsets.end() - 1);
+        for (auto f : mesh.faces())
+            faces[next[face_region[f.idx()]]++] = f;
+    }
+
+    // one patch per non-empty region
+    std::vector<GLuint> local(mesh.vertices_size(), UINT_MAX);
+    std::vector<Vertex> corners;
+    for (size_t r = 0; r < regions_.size(); ++r)
+    {
+        if (offsets[r] == offsets[r + 1])
+            continue;
+
+        Region& region = regions_[r];
+        Patch patch;
+        for (size_t i = offsets[r]; i < offsets[r + 1]; ++i)
+        {
+            const Face f = faces[i];
+
+            corners.clear();
+            for (auto v : mesh.vertices(f))
+            {
+                if (local[v.idx()] == UINT_MAX)
+                {
+                    const Point& p = points[v];
+                    local[v.idx()] = GLuint(patch.positions.size());
+                    patch.positions.push_back((vec3)p);
+                    for (int j = 0; j < 3; ++j)
+                        patch.normals.push_back(
+                            pack_component(normals[v.idx()][j]));
+                    patch.normals.push_back(0);
+                    region.min = min(region.min, p);
+                    region.max = max(region.max, p);
+                }
+                corners.push_back(v);
+            }
+
+            // triangle fan
+            for (size_t j = 2; j < corners.size(); ++j)
+            {
+                patch.indices.push_back(local[corners[0].idx()]);
+                patch.indices.push_back(local[corners[j - 1].idx()]);
+                patch.indices.push_back(local[corners[j].idx()]);
+            }
+
+            // the cone of the face normals of all levels
+            const Normal n = SurfaceNormals::compute_face_normal(mesh, f);
+            if (region.has_cone)
+                region.cone.merge(n);
+            else
+                region.cone = NormalCone(n);
+            region.has_cone = true;
+        }
+
+        // reset the local indices of the patch's vertices
+        for (size_t i = offsets[r]; i < offsets[r + 1]; ++i)
+            for (auto v : mesh.vertices(faces[i]))
+                local[v.idx()] = UINT_MAX;
+
+        region.patches[level] = int(patches_.size());
+        patches_.push_back(std::move(patch));
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMeshLOD::upload(Patch& patch)
+{
+    glGenVertexArrays(1, &patch.vertex_array_object);
+    glBindVertexArray(patch.vertex_array_object);
+    glGenBuffers(3, patch.buffers);
+
+    glBindBuffer(GL_ARRAY_BUFFER, patch.buffers[0]);
+    glBufferData(GL_ARRAY_BUFFER, patch.positions.size() * sizeof(vec3),
+                 patch.positions.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+    glEnableVertexAttribArray(0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, patch.buffers[1]);
+    glBufferData(GL_ARRAY_BUFFER, patch.normals.size() * sizeof(GLshort),
+                 patch.normals.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(1, 3, GL_SHORT, GL_TRUE, 4 * sizeof(GLshort),
+                          nullptr);
+    glEnableVertexAttribArray(1);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, patch.buffers[2]);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, patch.indices.size() * sizeof(GLuint),
+                 patch.indices.data(), GL_STATIC_DRAW);
+
+    glBindVertexArray(0);
+    n_uploaded_bytes_ += patch.n_bytes();
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMeshLOD::release(Patch& patch)
+{
+    if (!patch.vertex_array_object)
+        return;
+
+    glDeleteBuffers(3, patch.buffers);
+    glDeleteVertexArrays(1, &patch.vertex_array_object);
+    patch.vertex_array_object = 0;
+    patch.buffers[0] = patch.buffers[1] = patch.buffers[2] = 0;
+    n_uploaded_bytes_ -= patch.n_bytes();
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMeshLOD::draw(const mat4& projection_matrix,
+                          const mat4& modelview_matrix, int viewport_height)
+{
+    n_drawn_triangles_ = 0;
+    if (patches_.empty())
+        return;
+
+    // load shader?
+    if (!phong_shader_.is_valid())
+    {
+        if (!phong_shader_.source(phong_vshader, phong_fshader))
+            exit(1);
+    }
+
+    ++frame_;
+
+    // the clipping planes a x + b y + c z + d >= 0 of the view frustum
+    const mat4 mvp_matrix = projection_matrix * modelview_matrix;
+    vec4 planes[6];
+    for (int i = 0; i < 3; ++i)
+    {
+        for (int j = 0; j < 4; ++j)
+        {
+            planes[2 * i][j] = mvp_matrix(3, j) + mvp_matrix(i, j);
+            planes[2 * i + 1][j] = mvp_matrix(3, j) - mvp_matrix(i, j);
+        }
+    }
+
+    // the eye in model coordinates, and the pixels per unit at distance 1
+    const mat4 inverse_modelview = inverse(modelview_matrix);
+    const Point eye(inverse_modelview(0, 3), inverse_modelview(1, 3),
+                    inverse_modelview(2, 3));
+    const Scalar pixels = 0.5 * projection_matrix(1, 1) * viewport_height;
+
+    // setup shader as for smooth shading in SurfaceMeshGL
+    const mat3 n_matrix = inverse(transpose(linear_part(modelview_matrix)));
+    phong_shader_.use();
+    phong_shader_.set_uniform("modelview_projection_matrix", mvp_matrix);
+    phong_shader_.set_uniform("modelview_matrix", modelview_matrix);
+    phong_shader_.set_uniform("normal_matrix", n_matrix);
+    phong_shader_.set_uniform("point_size", 5.0f);
+    phong_shader_.set_uniform("light1", vec3(1.0, 1.0, 1.0));
+    phong_shader_.set_uniform("light2", vec3(-1.0, 1.0, 1.0));
+    phong_shader_.set_uniform("front_color", vec3(0.6, 0.6, 0.6));
+    phong_shader_.set_uniform("back_color", vec3(0.5, 0.0, 0.0));
+    phong_shader_.set_uniform("ambient", 0.1f);
+    phong_shader_.set_uniform("diffuse", 0.8f);
+    phong_shader_.set_uniform("specular", 0.6f);
+    phong_shader_.set_uniform("shininess", 100.0f);
+    phong_shader_.set_uniform("alpha", 1.0f);
+    phong_shader_.set_uniform("use_lighting", true);
+    phong_shader_.set_uniform("use_texture", false);
+    phong_shader_.set_uniform("use_srgb", false);
+    phong_shader_.set_uniform("show_texture_layout", false);
+
+    for (auto& region : regions_)
+    {
+        if (!region.has_cone)
+            continue;
+
+        // bounding sphere
+        const Point center = 0.5 * (region.min + region.max);
+        const Scalar radius = 0.5 * distance(region.min, region.max);
+
+        // outside of the view frustum?
+        bool visible = true;
+        for (const auto& plane : planes)
+        {
+            const vec3 n(plane[0], plane[1], plane[2]);
+            if (dot(n, center) + plane[3] < -radius * norm(n))
+            {
+                visible = false;
+                break;
+            }
+        }
+        if (!visible)
+            continue;
+
+        const Point view = center - eye;
+        const Scalar d = norm(view);
+
+        // all faces facing away? the angles between the view rays and the
+        // normals are below 90 degrees
+        if (backface_culling_ && d > radius &&
+            region.cone.angle() < 0.5 * M_PI)
+        {
+            const Scalar c = dot(region.cone.center_normal(), view) / d;
+            const Scalar angle = std::acos(std::max(Scalar(-1),
+                                                    std::min(Scalar(1), c)));
+            if (angle + region.cone.angle() + std::asin(radius / d) <
+                0.5 * M_PI)
+                continue;
+        }
+
+        // the coarsest level with small enough cells on screen
+        const Scalar scale = pixels / std::max(d - radius, Scalar(1e-6) * d);
+        size_t level = 0;
+        while (level + 1 < errors_.size() &&
+               errors_[level + 1] * scale <= pixel_error_)
+            ++level;
+
+        const int p = region.patches[level];
+        if (p < 0)
+            continue;
+
+        Patch& patch = patches_[p];
+        if (!patch.vertex_array_object)
+            upload(patch);
+        patch.last_frame = frame_;
+
+        glBindVertexArray(patch.vertex_array_object);
+        glDrawElements(GL_TRIANGLES, GLsizei(patch.indices.size()),
+                       GL_UNSIGNED_INT, nullptr);
+        n_drawn_triangles_ += patch.indices.size() / 3;
+    }
+    glBindVertexArray(0);
+
+    // release the least recently drawn patches over budget
+    if (n_uploaded_bytes_ > gpu_budget_)
+    {
+        std::vector<Patch*> unused;
+        for (auto& patch : patches_)
+            if (patch.vertex_array_object && patch.last_frame < frame_)
+                unused.push_back(&patch);
+        std::sort(unused.begin(), unused.end(),
+                  [](const Patch* a, const Patch* b) {
+                      return a->last_frame < b->last_frame;
+                  });
+        for (auto patch : unused)
+        {
+            if (n_uploaded_bytes_ <= gpu_budget_)
+                break;
+            release(*patch);
+        }
+    }
+
+    glCheckError();
+}
+
+//=============================================================================
+} // namespace pmp
+//=============================================================================
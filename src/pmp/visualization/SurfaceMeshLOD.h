@@ -0,0 +1,166 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <pmp/visualization/GL.h>
+#include <pmp/visualization/Shader.h>
+#include <pmp/algorithms/NormalCone.h>
+#include <pmp/MatVec.h>
+#include <pmp/SurfaceMesh.h>
+
+#include <vector>
+
+//=============================================================================
+
+namespace pmp {
+
+//=============================================================================
+
+//! \addtogroup visualization visualization
+//! @{
+
+//=============================================================================
+
+//! \brief View-dependent level-of-detail rendering of large meshes.
+//! \details build() simplifies the mesh repeatedly by SurfaceClustering,
+//! halving the resolution of the grid each time, and splits the mesh and
+//! each of its simplifications into the same regular grid of regions. Each
+//! frame, draw() culls the regions outside of the view frustum and, using
+//! a NormalCone of their faces, the regions facing away from the viewer.
+//! It draws each remaining region at the coarsest level whose clustering
+//! cells do not exceed pixel_error() pixels on screen. The buffers of a
+//! region and level are uploaded when first drawn and released, least
+//! recently drawn first, when more than gpu_budget() bytes are uploaded.
+//! The rendering cost thus follows the detail on screen instead of the
+//! size of the mesh. Adjacent regions drawn at different levels may show
+//! small cracks along their border, of the size of the coarser cells, i.e.,
+//! at most about pixel_error() pixels. Usage:
+//! \code
+//! SurfaceMeshLOD lod;
+//! lod.build(mesh);
+//! lod.draw(projection_matrix, modelview_matrix, viewport_height);
+//! \endcode
+class SurfaceMeshLOD
+{
+public:
+    //! default constructor
+    SurfaceMeshLOD();
+
+    //! default destructor, deletes the buffers
+    ~SurfaceMeshLOD();
+
+    // the buffers cannot be copied
+    SurfaceMeshLOD(const SurfaceMeshLOD&) = delete;
+    SurfaceMeshLOD& operator=(const SurfaceMeshLOD&) = delete;
+
+    //! \brief Build the levels of detail of \p mesh, on the CPU.
+    //! \details The first coarse level clusters about two edge lengths per
+    //! cell, at most \p n_levels coarse levels are built. The bounding box
+    //! is divided into \p resolution regions along its longest side.
+    void build(const SurfaceMesh& mesh, unsigned int n_levels = 8,
+               unsigned int resolution = 16);
+
+    //! delete all levels and buffers
+    void clear();
+
+    //! whether build() has been called since the last clear()
+    bool is_built() const { return !patches_.empty(); }
+
+    //! \brief Draw the regions visible for the given matrices.
+    //! \details \p viewport_height is the height of the viewport in pixels.
+    void draw(const mat4& projection_matrix, const mat4& modelview_matrix,
+              int viewport_height);
+
+    //! the maximal size of clustering cells on screen, in pixels
+    float pixel_error() const { return pixel_error_; }
+
+    //! set the maximal size of clustering cells on screen, in pixels
+    void set_pixel_error(float e) { pixel_error_ = e; }
+
+    //! the maximal size of the uploaded buffers, in bytes
+    size_t gpu_budget() const { return gpu_budget_; }
+
+    //! set the maximal size of the uploaded buffers, in bytes
+    void set_gpu_budget(size_t bytes) { gpu_budget_ = bytes; }
+
+    //! \brief Enable or disable culling of regions facing away.
+    //! \details Enabled by default. Disable it to see the back faces of open
+    //! surfaces.
+    void set_backface_culling(bool b) { backface_culling_ = b; }
+
+    //! the number of levels, including the input mesh
+    size_t n_levels() const { return errors_.size(); }
+
+    //! the number of triangles drawn by the last draw()
+    size_t n_drawn_triangles() const { return n_drawn_triangles_; }
+
+    //! the size of the currently uploaded buffers, in bytes
+    size_t n_uploaded_bytes() const { return n_uploaded_bytes_; }
+
+private:
+    // the triangles of one region at one level
+    struct Patch
+    {
+        std::vector<vec3> positions;
+        std::vector<GLshort> normals; // four normalized shorts per vertex
+        std::vector<GLuint> indices;
+        GLuint vertex_array_object = 0;
+        GLuint buffers[3] = {0, 0, 0};
+        size_t last_frame = 0;
+
+        size_t n_bytes() const;
+    };
+
+    // a cell of the region grid with its patch at each level
+    struct Region
+    {
+        Point min, max;
+        NormalCone cone;
+        bool has_cone = false;
+        std::vector<int> patches; // index into patches_, -1 if empty
+    };
+
+    // split the faces of one level into the patches of the regions
+    void add_level(const SurfaceMesh& mesh, size_t level);
+
+    // upload the buffers of a patch
+    void upload(Patch& patch);
+
+    // delete the buffers of a patch
+    void release(Patch& patch);
+
+    // region grid
+    Point origin_;
+    Scalar cell_size_;
+    unsigned int resolution_[3];
+    std::vector<Region> regions_;
+
+    // patches and the geometric error of each level
+    std::vector<Patch> patches_;
+    std::vector<Scalar> errors_;
+
+    // settings
+    float pixel_error_;
+    size_t gpu_budget_;
+    bool backface_culling_;
+
+    // statistics and the frame counter for releasing buffers
+    size_t frame_;
+    size_t n_drawn_triangles_;
+    size_t n_uploaded_bytes_;
+
+    Shader phong_shader_;
+};
+
+//=============================================================================
+//! @}
+//=============================================================================
+} // namespace pmp
+//=============================================================================
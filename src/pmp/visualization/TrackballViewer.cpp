@@ -264,11 +264,8 @@ bool TrackballViewer::pick(vec3& result)
     return pick(x, y, result);
 }
 
-bool TrackballViewer::pick(int x, int y, vec3& result)
+void TrackballViewer::to_framebuffer(int& x, int& y) const
 {
-#ifndef __EMSCRIPTEN__ // WebGL cannot read depth buffer
-
-    // get viewport data
     GLint viewport[4];
     glGetIntegerv(GL_VIEWPORT, viewport);
 
@@ -277,7 +274,20 @@ bool TrackballViewer::pick(int x, int y, vec3& result)
     y *= high_dpi_scaling();
 
     // in OpenGL y=0 is at the 'bottom'
-    y = viewport[3] - y;
+    y = viewport[3] - 1 - y;
+}
+
+//-----------------------------------------------------------------------------
+
+bool TrackballViewer::pick(int x, int y, vec3& result)
+{
+#ifndef __EMSCRIPTEN__ // WebGL cannot read depth buffer
+
+    // get viewport data
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    to_framebuffer(x, y);
 
     // read depth buffer value at (x, y_new)
     float zf;
@@ -96,6 +96,10 @@ protected: //-------------------------------------------- trackball interaction
     //! get 3D position of 2D position (x,y)
     bool pick(int x, int y, vec3& result);
 
+    //! convert window coordinates, e.g., of the mouse cursor, to pixel
+    //! coordinates of the framebuffer with y=0 at the bottom
+    void to_framebuffer(int& x, int& y) const;
+
     //! fly toward the position Distributed under the mouse cursor and set rotation center to it
     void fly_to(int x, int y);
 
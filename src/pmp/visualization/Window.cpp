@@ -35,7 +35,7 @@ Window::Window(const char* title, int width, int height, bool showgui)
     : width_(width), height_(height),
       scaling_(1), pixel_ratio_(1),
       show_imgui_(showgui), imgui_scale_(1.0),
-      show_help_(false)
+      show_help_(false), show_profiler_(false)
 {
     // initialize glfw window
     if (!glfwInit())
@@ -115,6 +115,7 @@ Window::Window(const char* title, int width, int height, bool showgui)
     // add help items
     add_help_item("G", "Toggle GUI dialog");
     add_help_item("PageUp/Down", "Scale GUI dialogs");
+    add_help_item("P", "Toggle performance dialog");
 #ifndef __EMSCRIPTEN__
     add_help_item("Esc/Q", "Quit application");
 #endif
@@ -130,6 +131,7 @@ Window::Window(const char* title, int width, int height, bool showgui)
 
 Window::~Window()
 {
+    profiler_.clear();
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
@@ -356,6 +358,9 @@ void Window::render_frame()
     }
 #endif
 
+    FrameProfiler& profiler = instance_->profiler_;
+    profiler.begin_frame();
+
     // do some computations
     instance_->do_processing();
 
@@ -379,6 +384,10 @@ void Window::render_frame()
         instance_->process_imgui();
         ImGui::End();
 
+        // show performance statistics
+        if (instance_->show_profiler_)
+            profiler.process_imgui();
+
         // show imgui help
         instance_->show_help();
 
@@ -386,12 +395,16 @@ void Window::render_frame()
     }
 
     // draw scene
+    profiler.begin_pass("Scene");
     instance_->display();
+    profiler.end_pass();
 
     // draw GUI
     if (instance_->show_imgui())
     {
+        profiler.begin_pass("GUI");
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        profiler.end_pass();
     }
 
 #if __EMSCRIPTEN__
@@ -408,6 +421,8 @@ void Window::render_frame()
     glClearColor(rgba[0], rgba[1], rgba[2], rgba[3]);
 #endif
 
+    profiler.end_frame();
+
     // swap buffers
     glfwSwapBuffers(instance_->window_);
 
@@ -498,6 +513,12 @@ void Window::keyboard(int key, int /*code*/, int action, int /*mods*/)
             break;
         }
 
+        case GLFW_KEY_P:
+        {
+            show_profiler(!show_profiler());
+            break;
+        }
+
         case GLFW_KEY_PAGE_UP:
         {
             scale_imgui(1.25);
@@ -10,6 +10,7 @@
 //=============================================================================
 
 #include <pmp/visualization/GL.h>
+#include <pmp/visualization/FrameProfiler.h>
 #include <GLFW/glfw3.h>
 #include <vector>
 #include <utility>
@@ -106,6 +107,15 @@ protected:
     //! show ImGUI help dialog
     void show_help();
 
+    //! frame time and GPU timer instrumentation
+    FrameProfiler& profiler() { return profiler_; }
+
+    //! is the performance dialog visible or hidden?
+    bool show_profiler() const { return show_profiler_; }
+
+    //! show or hide the performance dialog
+    void show_profiler(bool b) { show_profiler_ = b; }
+
 protected: //------------------------------------------ GLFW related functions
 
     //! width of window
@@ -153,6 +163,11 @@ private:
     // items for ImGUI help dialog
     std::vector< std::pair<std::string, std::string> > help_items_;
 
+    // frame times, GPU timers, uploads, and memory
+    FrameProfiler profiler_;
+    // show the performance dialog
+    bool show_profiler_;
+
     // which mouse buttons and modifier keys are pressed down
     bool button_[7], ctrl_pressed_, alt_pressed_, shift_pressed_;
 };
@@ -0,0 +1,191 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+// clang-format off
+
+// The single-pass wireframe of SurfaceMeshGL, used with phong_vshader. The
+// geometry shader passes the distances of each fragment to the edges of its
+// triangle in pixels, and the flags of the triangle: bit i is set if the
+// edge from corner i to corner i+1 is a mesh edge and not a diagonal of a
+// tessellated polygon, bit 3+i is set if that edge is a feature edge.
+// Requires OpenGL 3.3, not available for WebGL.
+
+static const char* wireframe_gshader =
+    "#version 330\n"
+    "\n"
+    "layout (triangles) in;\n"
+    "layout (triangle_strip, max_vertices = 3) out;\n"
+    "\n"
+    "in vec3 v2f_normal[];\n"
+    "in vec2 v2f_tex[];\n"
+    "in vec3 v2f_view[];\n"
+    "\n"
+    "out vec3 g2f_normal;\n"
+    "out vec2 g2f_tex;\n"
+    "out vec3 g2f_view;\n"
+    "noperspective out vec3 g2f_distance;\n"
+    "flat out uint g2f_flags;\n"
+    "\n"
+    "uniform usamplerBuffer edge_flags;\n"
+    "uniform vec2 viewport;\n"
+    "\n"
+    "void main()\n"
+    "{\n"
+    "    // window coordinates of the corners\n"
+    "    vec2 p[3];\n"
+    "    bool in_front = true;\n"
+    "    for (int i = 0; i < 3; ++i)\n"
+    "    {\n"
+    "        vec4 q = gl_in[i].gl_Position;\n"
+    "        in_front = in_front && q.w > 0.0;\n"
+    "        p[i] = 0.5 * viewport * q.xy / q.w;\n"
+    "    }\n"
+    "\n"
+    "    // twice the area of the triangle in pixels\n"
+    "    vec2 a = p[1] - p[0];\n"
+    "    vec2 b = p[2] - p[0];\n"
+    "    float area = abs(a.x * b.y - a.y * b.x);\n"
+    "\n"
+    "    uint flags = texelFetch(edge_flags, gl_PrimitiveIDIn).r;\n"
+    "\n"
+    "    for (int i = 0; i < 3; ++i)\n"
+    "    {\n"
+    "        // the corner lies on two edges, its opposite edge j is at the\n"
+    "        // height of the triangle. no edges if clipped by the eye plane\n"
+    "        int j = (i + 1) % 3;\n"
+    "        vec3 d = vec3(0.0);\n"
+    "        d[j] = area / max(length(p[(i + 2) % 3] - p[j]), 1e-6);\n"
+    "        if (!in_front) d = vec3(1e6);\n"
+    "\n"
+    "        g2f_normal   = v2f_normal[i];\n"
+    "        g2f_tex      = v2f_tex[i];\n"
+    "        g2f_view     = v2f_view[i];\n"
+    "        g2f_distance = d;\n"
+    "        g2f_flags    = flags;\n"
+    "        gl_Position  = gl_in[i].gl_Position;\n"
+    "        EmitVertex();\n"
+    "    }\n"
+    "    EndPrimitive();\n"
+    "}\n";
+
+
+static const char* wireframe_fshader =
+    "#version 330\n"
+    "\n"
+    "in vec3  g2f_normal;\n"
+    "in vec2  g2f_tex;\n"
+    "in vec3  g2f_view;\n"
+    "noperspective in vec3 g2f_distance;\n"
+    "flat in uint g2f_flags;\n"
+    "\n"
+    "uniform bool   use_lighting;\n"
+    "uniform bool   use_texture;\n"
+    "uniform bool   use_srgb;\n"
+    "uniform vec3   front_color;\n"
+    "uniform vec3   back_color;\n"
+    "uniform float  ambient;\n"
+    "uniform float  diffuse;\n"
+    "uniform float  specular;\n"
+    "uniform float  shininess;\n"
+    "uniform float  alpha;\n"
+    "uniform vec3   light1;\n"
+    "uniform vec3   light2;\n"
+    "\n"
+    "uniform bool   show_edges;\n"
+    "uniform bool   lines_only;\n"
+    "uniform vec3   edge_color;\n"
+    "uniform vec3   feature_color;\n"
+    "uniform float  line_width;\n"
+    "\n"
+    "uniform sampler2D mytexture;\n"
+    "\n"
+    "out vec4 f_color;\n"
+    "\n"
+    "void main()\n"
+    "{\n"
+    "    // the distances to the nearest edge and feature edge\n"
+    "    float de = 1e6;\n"
+    "    float df = 1e6;\n"
+    "    for (int i = 0; i < 3; ++i)\n"
+    "    {\n"
+    "        if (show_edges && (g2f_flags & (1u << i)) != 0u)\n"
+    "            de = min(de, g2f_distance[i]);\n"
+    "        if ((g2f_flags & (8u << i)) != 0u)\n"
+    "            df = min(df, g2f_distance[i]);\n"
+    "    }\n"
+    "\n"
+    "    // coverage of the lines, antialiased over one pixel\n"
+    "    float e = 1.0 - clamp(de - 0.5 * line_width + 0.5, 0.0, 1.0);\n"
+    "    float f = 1.0 - clamp(df - 0.5 * line_width + 0.5, 0.0, 1.0);\n"
+    "    if (lines_only && max(e, f) == 0.0) discard;\n"
+    "\n"
+    "    vec3 color = gl_FrontFacing ? front_color : back_color;\n"
+    "    vec3 rgb;\n"
+    "\n"
+    "    if (use_lighting)\n"
+    "    {\n"
+    "       vec3 L1 = normalize(light1);\n"
+    "       vec3 L2 = normalize(light2);\n"
+    "       vec3 N  = normalize(g2f_normal);\n"
+    "       vec3 V  = normalize(g2f_view);\n"
+    "       \n"
+    "       if (!gl_FrontFacing) N = -N;\n"
+    "       \n"
+    "       vec3  R;\n"
+    "       float NL, RV;\n"
+    "       \n"
+    "       rgb = ambient * 0.1 * color;\n"
+    "       \n"
+    "       NL = dot(N, L1);\n"
+    "       if (NL > 0.0)\n"
+    "       {\n"
+    "           rgb += diffuse * NL * color;\n"
+    "           R  = normalize(-reflect(L1, N));\n"
+    "           RV = dot(R, V);\n"
+    "           if (RV > 0.0) \n"
+    "           {\n"
+    "               rgb += vec3( specular * pow(RV, shininess) );\n"
+    "           }\n"
+    "       }\n"
+    "       \n"
+    "       NL = dot(N, L2);\n"
+    "       if (NL > 0.0)\n"
+    "       {\n"
+    "            rgb += diffuse * NL * color;\n"
+    "            R  = normalize(-reflect(L2, N));\n"
+    "            RV = dot(R, V);\n"
+    "            if (RV > 0.0) \n"
+    "            {\n"
+    "                rgb += vec3( specular * pow(RV, shininess) );\n"
+    "            }\n"
+    "        }\n"
+    "    }\n"
+    "   \n"
+    "    // do not use lighting\n"
+    "    else\n"
+    "    {\n"
+    "        rgb = color;\n"
+    "    }\n"
+    "    \n"
+    "   if (use_texture) rgb *= texture(mytexture, g2f_tex).xyz;\n"
+    "   if (use_srgb)    rgb  = pow(clamp(rgb, 0.0, 1.0), vec3(0.45));\n"
+    "   \n"
+    "    // overlay the edges, feature edges on top\n"
+    "    rgb = mix(rgb, edge_color, e);\n"
+    "    rgb = mix(rgb, feature_color, f);\n"
+    "    \n"
+    "    f_color = vec4(rgb, lines_only ? 1.0 : alpha);\n"
+    "}";
+
+
+//=============================================================================
+
+//=============================================================================
+// clang-format on
+//=============================================================================
@@ -10,7 +10,9 @@
 #include "gtest/gtest.h"
 
 #include <pmp/SurfaceMesh.h>
+#include <pmp/Parallel.h>
 #include <pmp/algorithms/DifferentialGeometry.h>
+#include <pmp/algorithms/SurfaceFactory.h>
 #include <vector>
 
 using namespace pmp;
@@ -95,10 +97,29 @@ TEST_F(DifferentialGeometryTest, surface_area)
 #ifdef PMP_SCALAR_TYPE_64
     EXPECT_FLOAT_EQ(area, 12.563956);
 #else
-    EXPECT_FLOAT_EQ(area, 12.564044);
+    // the rounding depends on the order of the pairwise summation
+    EXPECT_NEAR(area, 12.564, 1e-4);
 #endif
 }
 
+TEST_F(DifferentialGeometryTest, reproducible_reductions)
+{
+    mesh = SurfaceFactory::icosphere(100000);
+    const Scalar area = surface_area(mesh);
+    const Point center = centroid(mesh);
+    EXPECT_NEAR(area, 4 * M_PI, 1e-2);
+    EXPECT_LT(norm(center), 1e-5);
+
+    // bitwise equal on any number of threads
+    for (unsigned int n : {1u, 2u, 3u, 7u})
+    {
+        set_num_threads(n);
+        EXPECT_EQ(surface_area(mesh), area);
+        EXPECT_EQ(centroid(mesh), center);
+    }
+    set_num_threads(0);
+}
+
 TEST_F(DifferentialGeometryTest, centroid)
 {
     unit_sphere();
@@ -41,3 +41,84 @@ TEST_F(DistancePointTriangleTest, distance_point_degenerate_triangle)
     EXPECT_FLOAT_EQ(dist, 1.0);
     EXPECT_EQ(nearest, Point(0, 0, 0));
 }
+
+TEST_F(DistancePointTriangleTest, distance_point_precomputed_triangle)
+{
+    const Point x0(0, 0, 0), x1(1, 0, 0), x2(0, 1, 0);
+    const PrecomputedTriangle t(x0, x1, x2);
+
+    // interior, edge and corner regions
+    const Point points[] = {Point(0.2, 0.2, 1), Point(0.5, -1, 0),
+                            Point(2, 2, 0), Point(-1, -1, 0)};
+    for (const auto& p : points)
+    {
+        Point n0, n1;
+        EXPECT_EQ(dist_point_triangle(p, t, n0),
+                  dist_point_triangle(p, x0, x1, x2, n1));
+        EXPECT_EQ(n0, n1);
+    }
+
+    Point nearest;
+    EXPECT_FLOAT_EQ(dist_point_triangle(Point(0.2, 0.2, 1), t, nearest), 1.0);
+    EXPECT_EQ(nearest, Point(0.2, 0.2, 0));
+}
+
+TEST_F(DistancePointTriangleTest, batched_distances)
+{
+    // a fan of triangles around the origin, the last one degenerate
+    TriangleSoA triangles;
+    triangles.resize(100);
+    for (size_t i = 0; i < 99; ++i)
+    {
+        const Scalar a = 0.1 * i;
+        const Point x1(std::cos(a), std::sin(a), 0.01 * i);
+        const Point x2(std::cos(a + 0.5), std::sin(a + 0.5), -0.02 * i);
+        triangles.set(i, Point(0, 0, 0), x1, x2);
+    }
+    triangles.set(99, Point(0, 0, 0), Point(1, 1, 1), Point(2, 2, 2));
+    EXPECT_EQ(triangles.corner(99, 1), Point(1, 1, 1));
+
+    const Point points[] = {Point(0.2, 0.2, 1), Point(0.5, -1, 0),
+                            Point(2, 2, 0), Point(-1, -1, 0), Point(0, 0, 0)};
+    for (const auto& p : points)
+    {
+        Scalar sqr_dists[100];
+        sqr_dist_point_triangles(p, triangles, 0, 100, sqr_dists);
+        for (size_t i = 0; i < 100; ++i)
+        {
+            Point nearest;
+            const Scalar d =
+                dist_point_triangle(p, triangles.corner(i, 0),
+                                    triangles.corner(i, 1),
+                                    triangles.corner(i, 2), nearest);
+            EXPECT_NEAR(std::sqrt(sqr_dists[i]), d, 1e-5);
+        }
+
+        // a sub-range gives the same results
+        Scalar sub[10];
+        sqr_dist_point_triangles(p, triangles, 90, 100, sub);
+        for (size_t i = 0; i < 10; ++i)
+            EXPECT_EQ(sub[i], sqr_dists[90 + i]);
+    }
+}
+
+TEST_F(DistancePointTriangleTest, simd_vectors)
+{
+    // interior, edge, and corner regions, and a degenerate triangle
+    const Point x0(0, 0, 0), x1(1, 0, 0), x2(0, 1, 0);
+    const Point points[] = {Point(0.2, 0.2, 1), Point(0.5, -1, 0),
+                            Point(2, 2, 0), Point(-1, -1, 0)};
+    for (const auto& p : points)
+    {
+        Point nearest;
+        vec3a nearest_a;
+        EXPECT_FLOAT_EQ(dist_point_triangle(vec3a(p), vec3a(x0), vec3a(x1),
+                                            vec3a(x2), nearest_a),
+                        dist_point_triangle(p, x0, x1, x2, nearest));
+        EXPECT_LT(norm(nearest_a.to_vector<Scalar>() - nearest), 1e-6);
+
+        EXPECT_FLOAT_EQ(dist_point_triangle(vec3a(p), vec3a(x0), vec3a(x1),
+                                            vec3a(x0), nearest_a),
+                        dist_point_line_segment(p, x0, x1, nearest));
+    }
+}
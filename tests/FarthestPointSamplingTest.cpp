@@ -0,0 +1,102 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include "SurfaceMeshTest.h"
+
+#include <pmp/algorithms/FarthestPointSampling.h>
+
+using namespace pmp;
+
+class FarthestPointSamplingTest : public SurfaceMeshTest
+{
+public:
+    // a triangulated 20 x 20 grid in the xy-plane
+    void add_square()
+    {
+        add_grid(20);
+        mesh.triangulate();
+    }
+};
+
+TEST_F(FarthestPointSamplingTest, sample)
+{
+    add_square();
+    FarthestPointSampling fps(mesh);
+    fps.sample(1);
+    ASSERT_EQ(fps.samples().size(), 1u);
+    EXPECT_EQ(fps.samples()[0], Vertex(0));
+
+    // the second sample is the opposite corner
+    fps.sample(1);
+    ASSERT_EQ(fps.samples().size(), 2u);
+    EXPECT_EQ(mesh.position(fps.samples()[1]), Point(20, 20, 0));
+
+    // the farthest distance does not increase
+    Scalar previous = FLT_MAX;
+    for (int i = 0; i < 20; ++i)
+    {
+        fps.sample(1);
+        Scalar farthest = 0;
+        for (auto v : mesh.vertices())
+            farthest = std::max(farthest, fps.distance(v));
+        EXPECT_LE(farthest, previous);
+        previous = farthest;
+    }
+    ASSERT_EQ(fps.samples().size(), 22u);
+
+    // the samples are distinct and label their own cells
+    for (size_t i = 0; i < fps.samples().size(); ++i)
+    {
+        EXPECT_EQ(fps.distance(fps.samples()[i]), 0);
+        EXPECT_EQ(fps.label(fps.samples()[i]), i);
+    }
+}
+
+TEST_F(FarthestPointSamplingTest, incremental_distances)
+{
+    add_square();
+    FarthestPointSampling fps(mesh);
+    fps.sample(10);
+
+    // the distances to the nearest sample, as separate queries
+    std::vector<Scalar> nearest(mesh.n_vertices(), FLT_MAX);
+    SurfaceGeodesic geodesic(mesh);
+    for (auto s : fps.samples())
+    {
+        geodesic.compute(std::vector<Vertex>{s});
+        for (auto v : mesh.vertices())
+            nearest[v.idx()] = std::min(nearest[v.idx()], geodesic(v));
+    }
+
+    for (auto v : mesh.vertices())
+    {
+        EXPECT_NEAR(fps.distance(v), nearest[v.idx()], 1e-4);
+        EXPECT_EQ(fps.label(v) == PMP_MAX_INDEX, false);
+    }
+}
+
+TEST_F(FarthestPointSamplingTest, components)
+{
+    // two separate triangles, each gets a sample first
+    add_triangle();
+    auto a = mesh.add_vertex(Point(5, 0, 0));
+    auto b = mesh.add_vertex(Point(6, 0, 0));
+    auto c = mesh.add_vertex(Point(5, 1, 0));
+    mesh.add_triangle(a, b, c);
+
+    FarthestPointSampling fps(mesh);
+    fps.sample(2);
+    ASSERT_EQ(fps.samples().size(), 2u);
+    EXPECT_LT(fps.samples()[0].idx(), 3u);
+    EXPECT_GE(fps.samples()[1].idx(), 3u);
+
+    // all vertices are samples
+    fps.sample(10);
+    EXPECT_EQ(fps.samples().size(), 6u);
+}
@@ -0,0 +1,101 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include "SurfaceMeshTest.h"
+
+#include <pmp/algorithms/GeometryCache.h>
+#include <pmp/algorithms/DifferentialGeometry.h>
+#include <pmp/algorithms/SurfaceCurvature.h>
+#include <pmp/algorithms/SurfaceNormals.h>
+
+#include <cmath>
+
+using namespace pmp;
+
+class GeometryCacheTest : public SurfaceMeshTest
+{
+public:
+    // a wavy n x n grid of triangles, with obtuse and boundary triangles
+    GeometryCacheTest()
+    {
+        add_triangle_grid(mesh, 12, [](unsigned int i, unsigned int j) {
+            return Point(i + 0.3 * j, j, std::sin(0.5 * i) * std::cos(j));
+        });
+    }
+
+    // whether cache matches the functions of DifferentialGeometry.h and
+    // SurfaceNormals
+    void expect_exact(const GeometryCache& cache)
+    {
+        for (auto e : mesh.edges())
+        {
+            EXPECT_EQ(cache.cotan_weight(e), cotan_weight(mesh, e));
+            EXPECT_EQ(cache.edge_length(e), mesh.edge_length(e));
+        }
+        for (auto f : mesh.faces())
+        {
+            EXPECT_EQ(cache.face_area(f), triangle_area(mesh, f));
+            EXPECT_EQ(cache.face_normal(f),
+                      SurfaceNormals::compute_face_normal(mesh, f));
+        }
+        for (auto v : mesh.vertices())
+        {
+            EXPECT_EQ(cache.voronoi_area(v), voronoi_area(mesh, v));
+            EXPECT_EQ(cache.voronoi_area_barycentric(v),
+                      voronoi_area_barycentric(mesh, v));
+        }
+    }
+
+};
+
+TEST_F(GeometryCacheTest, exact)
+{
+    GeometryCache cache(mesh);
+    EXPECT_TRUE(cache.is_valid());
+    expect_exact(cache);
+}
+
+TEST_F(GeometryCacheTest, invalidation)
+{
+    EXPECT_EQ(GeometryCache::get(mesh), nullptr);
+    {
+        GeometryCache cache(mesh);
+        EXPECT_EQ(GeometryCache::get(mesh), &cache);
+
+        // moving a vertex invalidates the cache
+        mesh.position(Vertex(20)) += Point(0, 0, 0.5);
+        EXPECT_FALSE(cache.is_valid());
+        EXPECT_EQ(GeometryCache::get(mesh), nullptr);
+        cache.update();
+        EXPECT_EQ(GeometryCache::get(mesh), &cache);
+        expect_exact(cache);
+
+        // and so does changing the connectivity
+        mesh.flip(mesh.find_edge(Vertex(0), Vertex(14)));
+        EXPECT_FALSE(cache.is_valid());
+        cache.update();
+        expect_exact(cache);
+    }
+    EXPECT_EQ(GeometryCache::get(mesh), nullptr);
+}
+
+TEST_F(GeometryCacheTest, consumers)
+{
+    SurfaceCurvature curvature(mesh);
+    curvature.analyze(1);
+    std::vector<Scalar> mean;
+    for (auto v : mesh.vertices())
+        mean.push_back(curvature.mean_curvature(v));
+
+    // the cached weights give the same curvatures
+    GeometryCache cache(mesh);
+    curvature.analyze(1);
+    for (auto v : mesh.vertices())
+        EXPECT_EQ(curvature.mean_curvature(v), mean[v.idx()]);
+}
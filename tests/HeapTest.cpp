@@ -0,0 +1,94 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include "gtest/gtest.h"
+
+#include <pmp/SurfaceMesh.h>
+#include <pmp/algorithms/Heap.h>
+
+#include <random>
+
+using namespace pmp;
+
+// orders vertices by keys, ties broken by index like DaryHeap
+class HeapInterface
+{
+public:
+    HeapInterface(std::vector<float>& keys, std::vector<int>& pos)
+        : keys_(keys), pos_(pos)
+    {
+    }
+
+    float key(Vertex v) { return keys_[v.idx()]; }
+    bool less(Vertex v0, Vertex v1)
+    {
+        const float k0 = keys_[v0.idx()], k1 = keys_[v1.idx()];
+        return k0 == k1 ? v0 < v1 : k0 < k1;
+    }
+    bool greater(Vertex v0, Vertex v1) { return less(v1, v0); }
+    int get_heap_position(Vertex v) { return pos_[v.idx()]; }
+    void set_heap_position(Vertex v, int pos) { pos_[v.idx()] = pos; }
+
+private:
+    std::vector<float>& keys_;
+    std::vector<int>& pos_;
+};
+
+class HeapTest : public ::testing::TestWithParam<unsigned int>
+{
+};
+
+// random inserts, updates and removals pop in the same order as Heap
+TEST_P(HeapTest, same_order_as_binary_heap)
+{
+    const int n = 1000;
+    std::vector<float> keys(n);
+    std::vector<int> pos(n, -1), binary_pos(n, -1);
+    DaryHeap<Vertex, HeapInterface> heap(HeapInterface(keys, pos), GetParam());
+    Heap<Vertex, HeapInterface> binary(HeapInterface(keys, binary_pos));
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> vertex(0, n - 1);
+    std::uniform_int_distribution<int> key(0, 99); // many ties
+    for (int i = 0; i < 10 * n; ++i)
+    {
+        const Vertex v(vertex(rng));
+        if (heap.is_stored(v) && i % 5 == 0)
+        {
+            heap.remove(v);
+            binary.remove(v);
+            continue;
+        }
+
+        keys[v.idx()] = float(key(rng));
+        if (heap.is_stored(v))
+        {
+            heap.update(v);
+            binary.update(v);
+        }
+        else
+        {
+            heap.insert(v);
+            binary.insert(v);
+        }
+    }
+    EXPECT_TRUE(heap.check());
+    ASSERT_EQ(heap.size(), binary.size());
+
+    while (!heap.empty())
+    {
+        EXPECT_EQ(heap.front(), binary.front());
+        heap.pop_front();
+        binary.pop_front();
+    }
+    for (int i = 0; i < n; ++i)
+        EXPECT_EQ(pos[i], -1);
+}
+
+INSTANTIATE_TEST_CASE_P(Arities, HeapTest, ::testing::Values(2u, 4u, 8u));
@@ -10,6 +10,7 @@
 #include "gtest/gtest.h"
 
 #include <pmp/algorithms/HoleFilling.h>
+#include <pmp/algorithms/SurfaceSubdivision.h>
 
 using namespace pmp;
 
@@ -47,3 +48,113 @@ TEST_F(HoleFillingTest, hemisphere)
     EXPECT_FALSE(h.is_valid());
 }
 
+
+// a unit sphere with holes around the given directions
+static SurfaceMesh sphere_with_holes(const std::vector<Point>& centers,
+                                     Scalar radius)
+{
+    SurfaceMesh mesh;
+    const Point points[6] = {Point(1, 0, 0),  Point(-1, 0, 0),
+                             Point(0, 1, 0),  Point(0, -1, 0),
+                             Point(0, 0, 1),  Point(0, 0, -1)};
+    const int faces[8][3] = {{0, 2, 4}, {2, 1, 4}, {1, 3, 4}, {3, 0, 4},
+                             {2, 0, 5}, {1, 2, 5}, {3, 1, 5}, {0, 3, 5}};
+    for (auto& p : points)
+        mesh.add_vertex(p);
+    for (auto& f : faces)
+        mesh.add_triangle(Vertex(f[0]), Vertex(f[1]), Vertex(f[2]));
+
+    for (int i = 0; i < 5; ++i)
+        SurfaceSubdivision(mesh).loop();
+    for (auto v : mesh.vertices())
+        mesh.position(v) = normalize(mesh.position(v));
+
+    std::vector<Face> selected;
+    for (auto f : mesh.faces())
+        for (auto v : mesh.vertices(f))
+            for (auto& c : centers)
+                if (distance(mesh.position(v), c) < radius)
+                    selected.push_back(f);
+    for (auto f : selected)
+        if (!mesh.is_deleted(f))
+            mesh.delete_face(f);
+    mesh.garbage_collection();
+    return mesh;
+}
+
+static size_t n_boundary_halfedges(const SurfaceMesh& mesh)
+{
+    size_t n = 0;
+    for (auto h : mesh.halfedges())
+        n += mesh.is_boundary(h);
+    return n;
+}
+
+// fast triangulation closes a large hole smoothly
+TEST(HoleFillingFastTest, large_hole)
+{
+    SurfaceMesh mesh = sphere_with_holes({Point(0, 0, 1)}, 1.2);
+    ASSERT_GT(n_boundary_halfedges(mesh), 2 * HoleFilling::max_window());
+
+    Halfedge h;
+    for (auto hh : mesh.halfedges())
+        if (mesh.is_boundary(hh))
+            h = hh;
+
+    HoleFilling hf(mesh);
+    hf.set_fast_triangulation(true);
+    EXPECT_TRUE(hf.fill_hole(h));
+    EXPECT_EQ(n_boundary_halfedges(mesh), 0u);
+    EXPECT_TRUE(mesh.is_triangle_mesh());
+    for (auto v : mesh.vertices())
+        EXPECT_TRUE(mesh.is_manifold(v));
+}
+
+// all holes are filled, smallest first
+TEST(HoleFillingFastTest, fill_all_holes)
+{
+    SurfaceMesh mesh = sphere_with_holes(
+        {Point(1, 0, 0), Point(-1, 0, 0), Point(0, 0, 1)}, 0.3);
+    const size_t n_faces = mesh.n_faces();
+
+    HoleFilling hf(mesh);
+    auto reports = hf.fill_all_holes();
+    ASSERT_EQ(reports.size(), 3u);
+    for (size_t i = 0; i < reports.size(); ++i)
+    {
+        EXPECT_TRUE(reports[i].filled);
+        EXPECT_GE(reports[i].triangulation_time, 0);
+        EXPECT_GE(reports[i].refinement_time, 0);
+        if (i > 0)
+        {
+            EXPECT_LE(reports[i - 1].n_edges, reports[i].n_edges);
+        }
+    }
+    EXPECT_EQ(n_boundary_halfedges(mesh), 0u);
+    EXPECT_GT(mesh.n_faces(), n_faces);
+
+    // faired onto the sphere
+    for (auto v : mesh.vertices())
+        EXPECT_NEAR(norm(mesh.position(v)), 1, 0.05);
+}
+
+// holes above the size limit are kept, small ones filled
+TEST(HoleFillingFastTest, max_size)
+{
+    SurfaceMesh mesh = sphere_with_holes(
+        {Point(1, 0, 0), Point(-1, 0, 0), Point(0, 0, 1)}, 0.3);
+    const size_t n_large = n_boundary_halfedges(mesh);
+
+    // and a small one
+    mesh.delete_vertex(Vertex(5));
+    mesh.garbage_collection();
+
+    HoleFilling hf(mesh);
+    auto reports = hf.fill_all_holes(10);
+    ASSERT_EQ(reports.size(), 4u);
+    EXPECT_EQ(reports[0].n_edges, 4u);
+    EXPECT_TRUE(reports[0].filled);
+    for (size_t i = 1; i < reports.size(); ++i)
+        EXPECT_FALSE(reports[i].filled);
+    EXPECT_EQ(n_boundary_halfedges(mesh), n_large);
+}
@@ -0,0 +1,150 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include "SurfaceMeshTest.h"
+
+#include <pmp/algorithms/LaplaceMatrix.h>
+#include <pmp/algorithms/DifferentialGeometry.h>
+
+#include <cmath>
+
+using namespace pmp;
+
+class LaplaceMatrixTest : public SurfaceMeshTest
+{
+public:
+    // a wavy n x n grid of triangles
+    LaplaceMatrixTest()
+    {
+        add_triangle_grid(mesh, 8, [](unsigned int i, unsigned int j) {
+            return Point(i, j, std::sin(0.5 * i) * std::cos(j));
+        });
+    }
+
+    // the entry (i, j) of matrix, zero if not stored
+    static double entry(const CompressedRowMatrix& matrix, int i, int j)
+    {
+        for (int k = matrix.offsets[i]; k < matrix.offsets[i + 1]; ++k)
+            if (matrix.columns[k] == j)
+                return matrix.values[k];
+        return 0.0;
+    }
+
+};
+
+TEST_F(LaplaceMatrixTest, cotan)
+{
+    LaplaceMatrix laplace(mesh);
+    laplace.assemble();
+    const CompressedRowMatrix& m = laplace.matrix();
+    EXPECT_EQ(m.n_rows, int(mesh.n_vertices()));
+    EXPECT_EQ(m.n_columns, int(mesh.n_vertices()));
+    EXPECT_EQ(m.values.size(), mesh.n_vertices() + 2 * mesh.n_edges());
+
+    // rows sum to zero, positive diagonal, symmetric
+    for (auto v : mesh.vertices())
+    {
+        const int i = v.idx();
+        double sum = 0.0;
+        for (int k = m.offsets[i]; k < m.offsets[i + 1]; ++k)
+        {
+            sum += m.values[k];
+            EXPECT_DOUBLE_EQ(m.values[k], entry(m, m.columns[k], i));
+            if (k > m.offsets[i])
+            {
+                EXPECT_LT(m.columns[k - 1], m.columns[k]);
+            }
+        }
+        EXPECT_NEAR(sum, 0.0, 1e-10);
+        EXPECT_GT(entry(m, i, i), 0.0);
+    }
+
+    for (auto e : mesh.edges())
+    {
+        const int i = mesh.vertex(e, 0).idx(), j = mesh.vertex(e, 1).idx();
+        EXPECT_NEAR(entry(m, i, j), -std::max(0.0, cotan_weight(mesh, e)),
+                    1e-12);
+    }
+
+    laplace.assemble_mass();
+    for (auto v : mesh.vertices())
+        EXPECT_EQ(laplace.mass()[v.idx()], voronoi_area(mesh, v));
+}
+
+TEST_F(LaplaceMatrixTest, uniform)
+{
+    LaplaceMatrix laplace(mesh);
+    laplace.assemble(true);
+    for (auto v : mesh.vertices())
+        EXPECT_EQ(entry(laplace.matrix(), v.idx(), v.idx()),
+                  double(mesh.valence(v)));
+}
+
+TEST_F(LaplaceMatrixTest, pattern)
+{
+    LaplaceMatrix laplace(mesh);
+    laplace.assemble();
+    const std::vector<int> columns = laplace.matrix().columns;
+    const std::vector<double> values = laplace.matrix().values;
+
+    // moving a vertex only changes the values
+    mesh.position(Vertex(40)) += Point(0.2, 0.1, 0.3);
+    laplace.assemble();
+    EXPECT_TRUE(laplace.matrix().columns == columns);
+    EXPECT_FALSE(laplace.matrix().values == values);
+
+    // a flip changes the pattern
+    Edge e = mesh.find_edge(Vertex(40), Vertex(50));
+    ASSERT_TRUE(e.is_valid());
+    ASSERT_TRUE(mesh.is_flip_ok(e));
+    mesh.flip(e);
+    laplace.assemble(true);
+    EXPECT_EQ(entry(laplace.matrix(), 40, 50), 0.0);
+    EXPECT_EQ(entry(laplace.matrix(), 41, 49), -1.0);
+}
+
+TEST_F(LaplaceMatrixTest, extract)
+{
+    LaplaceMatrix laplace(mesh);
+    laplace.assemble();
+    const CompressedRowMatrix& m = laplace.matrix();
+
+    // the interior vertices are free
+    std::vector<int> index(mesh.vertices_size(), -1);
+    std::vector<Vertex> free_vertices;
+    for (auto v : mesh.vertices())
+        if (!mesh.is_boundary(v))
+        {
+            index[v.idx()] = free_vertices.size();
+            free_vertices.push_back(v);
+        }
+
+    CompressedRowMatrix free, fixed;
+    extract(m, index, index, free, fixed);
+    const int n = free_vertices.size();
+    EXPECT_EQ(free.n_rows, n);
+    EXPECT_EQ(free.n_columns, n);
+    EXPECT_EQ(fixed.n_rows, n);
+    EXPECT_EQ(fixed.n_columns, m.n_columns);
+
+    for (int i = 0; i < n; ++i)
+    {
+        const int r = free_vertices[i].idx();
+        EXPECT_EQ(free.offsets[i + 1] - free.offsets[i] + fixed.offsets[i + 1] -
+                      fixed.offsets[i],
+                  m.offsets[r + 1] - m.offsets[r]);
+        for (int j = 0; j < n; ++j)
+            EXPECT_EQ(entry(free, i, j), entry(m, r, free_vertices[j].idx()));
+        for (int k = fixed.offsets[i]; k < fixed.offsets[i + 1]; ++k)
+        {
+            EXPECT_EQ(index[fixed.columns[k]], -1);
+            EXPECT_EQ(fixed.values[k], entry(m, r, fixed.columns[k]));
+        }
+    }
+}
@@ -0,0 +1,110 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include "SurfaceMeshTest.h"
+
+#include <pmp/MappedSurfaceMesh.h>
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+using namespace pmp;
+
+class MappedSurfaceMeshTest : public SurfaceMeshTest
+{
+};
+
+TEST_F(MappedSurfaceMeshTest, open)
+{
+    add_grid(8);
+    auto tex = mesh.add_halfedge_property<TexCoord>("h:tex");
+    for (auto h : mesh.halfedges())
+        tex[h] = TexCoord(h.idx(), 0);
+    mesh.write("test_mapped.pmp");
+
+    MappedSurfaceMesh mapped;
+    EXPECT_TRUE(mapped.open("test_mapped.pmp"));
+    EXPECT_TRUE(mapped.is_open());
+    EXPECT_EQ(mapped.n_vertices(), mesh.n_vertices());
+    EXPECT_EQ(mapped.n_edges(), mesh.n_edges());
+    EXPECT_EQ(mapped.n_faces(), mesh.n_faces());
+
+    for (auto v : mesh.vertices())
+    {
+        EXPECT_EQ(mapped.position(v), mesh.position(v));
+        EXPECT_EQ(mapped.halfedge(v), mesh.halfedge(v));
+    }
+    for (auto h : mesh.halfedges())
+    {
+        EXPECT_EQ(mapped.face(h), mesh.face(h));
+        EXPECT_EQ(mapped.to_vertex(h), mesh.to_vertex(h));
+        EXPECT_EQ(mapped.next_halfedge(h), mesh.next_halfedge(h));
+        EXPECT_EQ(mapped.prev_halfedge(h), mesh.prev_halfedge(h));
+        EXPECT_EQ(mapped.opposite_halfedge(h), mesh.opposite_halfedge(h));
+        EXPECT_EQ(mapped.texcoords()[h.idx()], tex[h]);
+    }
+    for (auto f : mesh.faces())
+    {
+        EXPECT_EQ(mapped.halfedge(f), mesh.halfedge(f));
+    }
+
+    mapped.close();
+    EXPECT_FALSE(mapped.is_open());
+}
+
+TEST_F(MappedSurfaceMeshTest, copy_to)
+{
+    add_grid(4);
+    mesh.write("test_mapped.pmp");
+
+    MappedSurfaceMesh mapped;
+    EXPECT_TRUE(mapped.open("test_mapped.pmp"));
+    SurfaceMesh copy;
+    mapped.copy_to(copy);
+    EXPECT_EQ(copy.n_vertices(), mesh.n_vertices());
+    EXPECT_EQ(copy.n_faces(), mesh.n_faces());
+    EXPECT_FALSE(copy.has_halfedge_property("h:tex"));
+
+    // the copy can be modified
+    copy.triangulate();
+    EXPECT_TRUE(copy.is_triangle_mesh());
+    EXPECT_EQ(mapped.n_faces(), mesh.n_faces());
+}
+
+TEST_F(MappedSurfaceMeshTest, invalid_file)
+{
+    add_triangle();
+    mesh.write("test_mapped.off");
+    MappedSurfaceMesh mapped;
+    EXPECT_FALSE(mapped.open("test_mapped.off"));
+    EXPECT_FALSE(mapped.open("does_not_exist.pmp"));
+    EXPECT_FALSE(mapped.is_open());
+}
+
+TEST_F(MappedSurfaceMeshTest, forged_header)
+{
+    add_triangle();
+    mesh.write("test_mapped.pmp");
+    std::ifstream ifs("test_mapped.pmp", std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(ifs)),
+                     std::istreambuf_iterator<char>());
+    ifs.close();
+
+    // 2^62 vertices, whose block sizes wrap to zero
+    const uint64_t nv = uint64_t(1) << 62;
+    memcpy(&data[8], &nv, sizeof(nv));
+    std::ofstream ofs("test_mapped.pmp", std::ios::binary);
+    ofs.write(data.data(), data.size());
+    ofs.close();
+
+    MappedSurfaceMesh mapped;
+    EXPECT_FALSE(mapped.open("test_mapped.pmp"));
+    EXPECT_FALSE(mapped.is_open());
+}
@@ -0,0 +1,203 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include "SurfaceMeshTest.h"
+
+#include <pmp/AtomicBitset.h>
+#include <pmp/Parallel.h>
+#include <algorithm>
+#include <vector>
+
+using namespace pmp;
+
+class ParallelTest : public SurfaceMeshTest
+{
+};
+
+TEST_F(ParallelTest, index_range)
+{
+    std::vector<int> values(10000, 0);
+    parallel_for(0, values.size(), [&](size_t i) { values[i] = int(i); });
+    for (size_t i = 0; i < values.size(); ++i)
+        EXPECT_EQ(values[i], int(i));
+}
+
+TEST_F(ParallelTest, vertices_and_faces)
+{
+    add_grid(40);
+    auto vcount = mesh.add_vertex_property<int>("v:count", 0);
+    auto fcount = mesh.add_face_property<int>("f:count", 0);
+    parallel_for(mesh.vertices(), [&](Vertex v) { vcount[v]++; });
+    parallel_for(mesh.faces(), [&](Face f) { fcount[f]++; });
+    for (auto v : mesh.vertices())
+        EXPECT_EQ(vcount[v], 1);
+    for (auto f : mesh.faces())
+        EXPECT_EQ(fcount[f], 1);
+}
+
+TEST_F(ParallelTest, skip_deleted)
+{
+    add_grid(10);
+    mesh.delete_face(Face(0));
+    auto fcount = mesh.add_face_property<int>("f:count", 0);
+    parallel_for(mesh.faces(), [&](Face f) { fcount[f]++; });
+    EXPECT_EQ(fcount[Face(0)], 0);
+    EXPECT_EQ(fcount[Face(1)], 1);
+}
+
+TEST_F(ParallelTest, serial_fallback)
+{
+    set_num_threads(1);
+    EXPECT_EQ(num_threads(), 1u);
+    std::vector<size_t> order;
+    parallel_for(0, 5000, [&](size_t i) { order.push_back(i); });
+    set_num_threads(0);
+    ASSERT_EQ(order.size(), size_t(5000));
+    for (size_t i = 0; i < order.size(); ++i)
+        EXPECT_EQ(order[i], i);
+}
+
+TEST_F(ParallelTest, atomic_bitset)
+{
+    AtomicBitset bits(1000);
+    EXPECT_EQ(bits.size(), size_t(1000));
+    EXPECT_EQ(bits.count(), size_t(0));
+
+    // neighboring bits share words, each bit is claimed exactly once
+    std::vector<int> claims(bits.size(), 0);
+    parallel_for(0, 4 * bits.size(), [&](size_t i) {
+        if (!bits.test_and_set(i % 1000))
+            claims[i % 1000]++;
+    });
+    EXPECT_EQ(bits.count(), size_t(1000));
+    for (auto c : claims)
+        EXPECT_EQ(c, 1);
+
+    parallel_for(0, bits.size(), [&](size_t i) {
+        if (i % 2)
+            bits.reset(i);
+    });
+    EXPECT_EQ(bits.count(), size_t(500));
+    EXPECT_TRUE(bits.test(0));
+    EXPECT_FALSE(bits.test(1));
+
+    bits.clear();
+    EXPECT_EQ(bits.count(), size_t(0));
+}
+
+TEST_F(ParallelTest, reserved_splits)
+{
+    // triangulated n x n grid
+    const int n = 30;
+    for (int j = 0; j <= n; ++j)
+        for (int i = 0; i <= n; ++i)
+            mesh.add_vertex(Point(i, j, 0));
+    for (int j = 0; j < n; ++j)
+        for (int i = 0; i < n; ++i)
+        {
+            const IndexType v = j * (n + 1) + i;
+            mesh.add_triangle(Vertex(v), Vertex(v + 1), Vertex(v + n + 2));
+            mesh.add_triangle(Vertex(v), Vertex(v + n + 2), Vertex(v + n + 1));
+        }
+
+    // select edges whose incident triangles do not share vertices
+    std::vector<char> locked(mesh.vertices_size(), 0);
+    std::vector<Edge> edges;
+    for (auto e : mesh.edges())
+    {
+        std::vector<Vertex> region = {mesh.vertex(e, 0), mesh.vertex(e, 1)};
+        for (int i = 0; i < 2; ++i)
+        {
+            auto h = mesh.halfedge(e, i);
+            if (!mesh.is_boundary(h))
+                region.push_back(mesh.to_vertex(mesh.next_halfedge(h)));
+        }
+        if (std::any_of(region.begin(), region.end(),
+                        [&](Vertex v) { return locked[v.idx()]; }))
+            continue;
+        for (auto v : region)
+            locked[v.idx()] = 1;
+        edges.push_back(e);
+    }
+    ASSERT_GT(edges.size(), size_t(100));
+
+    auto midpoint = [](const SurfaceMesh& m, Edge e) {
+        return Scalar(0.5) *
+               (m.position(m.vertex(e, 0)) + m.position(m.vertex(e, 1)));
+    };
+
+    SurfaceMesh serial = mesh;
+    for (auto e : edges)
+        serial.split(e, serial.add_vertex(midpoint(serial, e)));
+
+    {
+        // reserve more than needed, the rest is removed afterwards
+        const size_t k = edges.size();
+        ElementReservation reservation(mesh, k + 10, 3 * k + 10, 2 * k + 10);
+        ASSERT_TRUE(reservation);
+        parallel_for(size_t(0), k, [&](size_t i) {
+            mesh.split(edges[i], mesh.add_vertex(midpoint(mesh, edges[i])));
+        });
+    }
+
+    EXPECT_EQ(mesh.n_vertices(), serial.n_vertices());
+    EXPECT_EQ(mesh.n_edges(), serial.n_edges());
+    EXPECT_EQ(mesh.n_faces(), serial.n_faces());
+    EXPECT_EQ(mesh.vertices_size(), serial.vertices_size());
+    EXPECT_EQ(mesh.edges_size(), serial.edges_size());
+    EXPECT_EQ(mesh.faces_size(), serial.faces_size());
+    for (auto f : mesh.faces())
+        EXPECT_EQ(mesh.valence(f), size_t(3));
+    for (auto h : mesh.halfedges())
+    {
+        EXPECT_EQ(mesh.prev_halfedge(mesh.next_halfedge(h)), h);
+        EXPECT_EQ(mesh.from_vertex(mesh.next_halfedge(h)), mesh.to_vertex(h));
+    }
+    for (auto v : mesh.vertices())
+        EXPECT_FALSE(mesh.is_isolated(v));
+}
+
+TEST_F(ParallelTest, deterministic_reduce)
+{
+    // values of very different magnitude, whose sum depends on the order
+    std::vector<float> values(100000);
+    for (size_t i = 0; i < values.size(); ++i)
+        values[i] = (i % 7 == 0 ? 1e4f : 1e-3f) * float(i % 13 + 1);
+
+    auto sum = [&]() {
+        return parallel_reduce(values.size(), 0.0f, [&](size_t b, size_t e) {
+            float s = 0;
+            for (size_t i = b; i < e; ++i)
+                s += values[i];
+            return s;
+        });
+    };
+
+    EXPECT_EQ(reduction(), Reduction::Deterministic);
+    set_num_threads(1);
+    const float serial = sum();
+    for (unsigned int n : {2u, 3u, 8u})
+    {
+        set_num_threads(n);
+        EXPECT_EQ(sum(), serial);
+    }
+
+    set_reduction(Reduction::Fast);
+    EXPECT_NEAR(sum(), serial, 1e-5 * serial);
+    set_reduction(Reduction::Deterministic);
+    set_num_threads(0);
+
+    // over the mesh, skipping deleted elements
+    add_grid(10);
+    mesh.delete_face(Face(0));
+    EXPECT_EQ(parallel_reduce(mesh.faces(), 0, [](Face) { return 1; }),
+              int(mesh.n_faces()));
+    EXPECT_EQ(parallel_reduce(mesh.vertices(), 0, [](Vertex) { return 1; }),
+              int(mesh.n_vertices()));
+}
@@ -0,0 +1,65 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include "gtest/gtest.h"
+
+#include <pmp/PerfCounters.h>
+
+using namespace pmp;
+
+TEST(PerfCountersTest, read)
+{
+    PerfCounters counters;
+    const PerfCounters::Values start = counters.read();
+    volatile double sum = 0.0;
+    for (int i = 0; i < 100000; ++i)
+        sum = sum + i;
+    const PerfCounters::Values counts = counters.read() - start;
+
+    // hardware counters may not be permitted, e.g., in virtual machines
+    if (!counters.is_available())
+    {
+        EXPECT_EQ(counts.cycles, -1);
+        EXPECT_EQ(counts.instructions, -1);
+        EXPECT_EQ(counts.llc_misses, -1);
+        EXPECT_EQ(counts.branch_misses, -1);
+        EXPECT_EQ(counts.ipc(), 0.0);
+        return;
+    }
+    if (counts.instructions >= 0)
+    {
+        EXPECT_GT(counts.instructions, 100000);
+    }
+    if (counts.cycles >= 0)
+    {
+        EXPECT_GT(counts.cycles, 0);
+    }
+}
+
+TEST(PerfCountersTest, arithmetic)
+{
+    PerfCounters::Values a, b;
+    a.cycles = 10;
+    a.instructions = 20;
+    b.cycles = 4;
+    b.instructions = 5;
+    b.llc_misses = 1;
+
+    const PerfCounters::Values d = a - b;
+    EXPECT_EQ(d.cycles, 6);
+    EXPECT_EQ(d.instructions, 15);
+    EXPECT_EQ(d.llc_misses, -1);
+    EXPECT_EQ(d.branch_misses, -1);
+    EXPECT_DOUBLE_EQ(d.ipc(), 2.5);
+
+    a += b;
+    EXPECT_EQ(a.cycles, 14);
+    EXPECT_EQ(a.instructions, 25);
+    EXPECT_EQ(a.llc_misses, -1);
+}
@@ -0,0 +1,88 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include "SurfaceMeshTest.h"
+
+#include <pmp/algorithms/PointKdTree.h>
+#include <pmp/algorithms/SurfaceNormals.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace pmp;
+
+class PointKdTreeTest : public SurfaceMeshTest
+{
+public:
+    // a wavy point cloud of n x n vertices
+    void add_point_grid(unsigned int n) { add_grid_vertices(mesh, n - 1, wavy); }
+
+    // the squared distances of all vertices to p, sorted
+    std::vector<Scalar> distances(const Point& p)
+    {
+        std::vector<Scalar> result;
+        for (auto v : mesh.vertices())
+            result.push_back(norm(mesh.position(v) - p));
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+};
+
+TEST_F(PointKdTreeTest, nearest_neighbors)
+{
+    add_point_grid(50);
+    PointKdTree tree(mesh, 4);
+    EXPECT_EQ(tree.size(), size_t(2500));
+
+    const Point queries[] = {Point(10.3, 20.7, 0.5), Point(-5, 3, 1),
+                             Point(49, 49, 0), Point(25.5, 25.5, -2)};
+    for (const auto& p : queries)
+    {
+        const auto d = distances(p);
+
+        const auto nn = tree.nearest(p);
+        EXPECT_FLOAT_EQ(nn.dist, d[0]);
+        EXPECT_FLOAT_EQ(norm(mesh.position(nn.vertex) - p), nn.dist);
+
+        const auto knn = tree.k_nearest(p, 20);
+        ASSERT_EQ(knn.size(), size_t(20));
+        for (size_t i = 0; i < knn.size(); ++i)
+            EXPECT_FLOAT_EQ(knn[i].dist, d[i]);
+
+        const Scalar radius = 3.5;
+        const auto within = tree.within_radius(p, radius);
+        EXPECT_EQ(within.size(),
+                  size_t(std::upper_bound(d.begin(), d.end(), radius) -
+                         d.begin()));
+        for (const auto& n : within)
+            EXPECT_LE(n.dist, radius);
+    }
+
+    // more neighbors than vertices
+    EXPECT_EQ(tree.k_nearest(Point(0, 0, 0), 3000).size(), size_t(2500));
+}
+
+TEST_F(PointKdTreeTest, point_normals)
+{
+    // a plane with normals pointing up
+    for (unsigned int j = 0; j < 20; ++j)
+        for (unsigned int i = 0; i < 20; ++i)
+            mesh.add_vertex(Point(i, j, 0));
+    auto normals = mesh.vertex_property<Normal>("v:normal");
+    for (auto v : mesh.vertices())
+        normals[v] = Normal(0.1, 0, 1);
+
+    SurfaceNormals::compute_point_normals(mesh, 8);
+    for (auto v : mesh.vertices())
+    {
+        EXPECT_NEAR(normals[v][0], 0, 1e-5);
+        EXPECT_NEAR(normals[v][1], 0, 1e-5);
+        EXPECT_NEAR(normals[v][2], 1, 1e-5);
+    }
+}
@@ -0,0 +1,87 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include "SurfaceMeshTest.h"
+
+#include <pmp/algorithms/PointLocation.h>
+
+using namespace pmp;
+
+class PointLocationTest : public SurfaceMeshTest
+{
+public:
+    // a triangulated grid and points above and beside it
+    void add_points()
+    {
+        add_grid(4);
+        mesh.triangulate();
+        for (int i = 0; i < 50; ++i)
+            points.push_back(Point(0.08 * i, 0.07 * i + 0.1, 0.5));
+        points.push_back(Point(-1, 2, 0));
+    }
+
+    std::vector<Point> points;
+};
+
+TEST_F(PointLocationTest, locate)
+{
+    add_points();
+    PointLocator locator(mesh);
+    PointLocations locations;
+    locator.locate(points, locations);
+    ASSERT_EQ(locations.size(), points.size());
+    ASSERT_EQ(locations.vertices.size(), 3 * points.size());
+
+    for (size_t i = 0; i < points.size(); ++i)
+    {
+        // the vertices belong to the face, the weights sum to one
+        std::vector<Vertex> corners;
+        for (auto v : mesh.vertices(locations.faces[i]))
+            corners.push_back(v);
+        Scalar sum = 0;
+        for (int j = 0; j < 3; ++j)
+        {
+            EXPECT_EQ(locations.vertices[3 * i + j], corners[j]);
+            EXPECT_GE(locations.weights[3 * i + j], -1e-5);
+            sum += locations.weights[3 * i + j];
+        }
+        EXPECT_NEAR(sum, 1.0, 1e-5);
+    }
+    EXPECT_NEAR(locations.distances[0], 0.5, 1e-5);
+    EXPECT_NEAR(locations.distances.back(), 1.0, 1e-5);
+}
+
+TEST_F(PointLocationTest, interpolate)
+{
+    add_points();
+    auto vvalue = mesh.add_vertex_property<Scalar>("v:value");
+    for (auto v : mesh.vertices())
+        vvalue[v] = mesh.position(v)[0] + 2 * mesh.position(v)[1];
+
+    PointLocator locator(mesh);
+    PointLocations locations;
+    locator.locate(points, locations);
+
+    // positions interpolate to the nearest points, linear functions exactly
+    std::vector<Point> positions;
+    locator.interpolate(mesh.get_vertex_property<Point>("v:point"),
+                        locations, positions);
+    std::vector<Scalar> values;
+    locator.interpolate(vvalue, locations, values);
+    ASSERT_EQ(values.size(), points.size());
+    for (size_t i = 0; i + 1 < points.size(); ++i)
+    {
+        EXPECT_NEAR(positions[i][0], points[i][0], 1e-5);
+        EXPECT_NEAR(positions[i][1], points[i][1], 1e-5);
+        EXPECT_NEAR(positions[i][2], 0, 1e-5);
+        EXPECT_NEAR(values[i], points[i][0] + 2 * points[i][1], 1e-4);
+    }
+    EXPECT_NEAR(positions.back()[0], 0, 1e-5);
+    EXPECT_NEAR(positions.back()[1], 2, 1e-5);
+}
@@ -0,0 +1,146 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include "SurfaceMeshTest.h"
+
+#include <pmp/PointWelder.h>
+
+#include <cstdint>
+#include <cstdio>
+
+using namespace pmp;
+
+class PointWelderTest : public SurfaceMeshTest
+{
+public:
+    // replace mesh by a triangle soup with separate corners for each face
+    void make_soup()
+    {
+        std::vector<Point> points;
+        std::vector<IndexType> indices;
+        for (auto f : mesh.faces())
+            for (auto v : mesh.vertices(f))
+            {
+                indices.push_back(IndexType(points.size()));
+                points.push_back(mesh.position(v));
+            }
+        mesh.build_from_indices(points, indices);
+    }
+};
+
+TEST_F(PointWelderTest, exact)
+{
+    PointWelder welder;
+    EXPECT_EQ(welder.insert(Point(0, 0, 0)), 0u);
+    EXPECT_EQ(welder.insert(Point(1, 0, 0)), 1u);
+    EXPECT_EQ(welder.insert(Point(-0.0, 0, 0)), 0u);
+    EXPECT_EQ(welder.insert(Point(1, 0, 0)), 1u);
+    EXPECT_EQ(welder.insert(Point(1, 1e-6, 0)), 2u);
+    EXPECT_EQ(welder.size(), 3u);
+
+    // growing the table keeps all representatives
+    for (int i = 0; i < 1000; ++i)
+        welder.insert(Point(Scalar(i), 2, 3));
+    EXPECT_EQ(welder.size(), 1003u);
+    for (int i = 0; i < 1000; ++i)
+        EXPECT_EQ(welder.insert(Point(Scalar(i), 2, 3)), IndexType(3 + i));
+    EXPECT_EQ(welder.points()[2], Point(1, 1e-6, 0));
+
+    welder.clear();
+    EXPECT_EQ(welder.size(), 0u);
+    EXPECT_EQ(welder.insert(Point(5, 5, 5)), 0u);
+}
+
+TEST_F(PointWelderTest, tolerance)
+{
+    PointWelder welder(0.01);
+    EXPECT_EQ(welder.insert(Point(0, 0, 0)), 0u);
+    EXPECT_EQ(welder.insert(Point(0.005, -0.005, 0.009)), 0u);
+    EXPECT_EQ(welder.insert(Point(0.02, 0, 0)), 1u);
+    EXPECT_EQ(welder.insert(Point(0.011, 0, 0)), 1u);
+
+    // close points in neighboring cells
+    EXPECT_EQ(welder.insert(Point(1.0099, 1, 1)), 2u);
+    EXPECT_EQ(welder.insert(Point(1.0101, 1, 1)), 2u);
+    EXPECT_EQ(welder.size(), 3u);
+}
+
+TEST_F(PointWelderTest, weld_vertices)
+{
+    add_grid(8);
+    mesh.triangulate();
+    const size_t nv = mesh.n_vertices();
+    const size_t nf = mesh.n_faces();
+
+    make_soup();
+    EXPECT_EQ(mesh.n_vertices(), 3 * nf);
+
+    EXPECT_EQ(weld_vertices(mesh), 3 * nf - nv);
+    EXPECT_EQ(mesh.n_vertices(), nv);
+    EXPECT_EQ(mesh.n_faces(), nf);
+    EXPECT_EQ(mesh.n_edges(), 3 * 8 * 8 + 2 * 8);
+
+    // nothing left to weld
+    EXPECT_EQ(weld_vertices(mesh), 0u);
+}
+
+TEST_F(PointWelderTest, weld_vertices_degenerate)
+{
+    add_quad();
+    mesh.position(Vertex(1)) = mesh.position(Vertex(0)) + Point(1e-4, 0, 0);
+
+    // welding the short edge turns the quad into a triangle
+    EXPECT_EQ(weld_vertices(mesh, 1e-3), 1u);
+    EXPECT_EQ(mesh.n_vertices(), 3u);
+    EXPECT_EQ(mesh.n_faces(), 1u);
+    EXPECT_EQ(mesh.valence(Face(0)), 3u);
+
+    // a triangle collapsing to an edge is removed
+    mesh.clear();
+    add_triangle();
+    mesh.position(Vertex(2)) = mesh.position(Vertex(0));
+    EXPECT_EQ(weld_vertices(mesh), 1u);
+    EXPECT_EQ(mesh.n_faces(), 0u);
+}
+
+TEST_F(PointWelderTest, binary_stl)
+{
+    add_grid(4);
+    mesh.triangulate();
+    const size_t nv = mesh.n_vertices();
+    const size_t nf = mesh.n_faces();
+
+    // write a binary STL by hand, STL files store a triangle soup
+    FILE* out = fopen("welding.stl", "wb");
+    ASSERT_TRUE(out != nullptr);
+    char header[80] = {0};
+    fwrite(header, 1, 80, out);
+    const uint32_t n_triangles = uint32_t(nf);
+    fwrite(&n_triangles, sizeof(n_triangles), 1, out);
+    for (auto f : mesh.faces())
+    {
+        const float normal[3] = {0, 0, 1};
+        fwrite(normal, sizeof(float), 3, out);
+        for (auto v : mesh.vertices(f))
+        {
+            const Point& p = mesh.position(v);
+            const float corner[3] = {float(p[0]), float(p[1]), float(p[2])};
+            fwrite(corner, sizeof(float), 3, out);
+        }
+        const uint16_t attributes = 0;
+        fwrite(&attributes, sizeof(attributes), 1, out);
+    }
+    fclose(out);
+
+    SurfaceMesh stl;
+    EXPECT_TRUE(stl.read("welding.stl"));
+    EXPECT_EQ(stl.n_vertices(), nv);
+    EXPECT_EQ(stl.n_faces(), nf);
+    EXPECT_EQ(stl.n_edges(), mesh.n_edges());
+}
@@ -0,0 +1,117 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include "gtest/gtest.h"
+
+#include <pmp/Profiler.h>
+#include <pmp/PerfCounters.h>
+
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+using namespace pmp;
+
+class ProfilerTest : public ::testing::Test
+{
+public:
+    ProfilerTest()
+    {
+        Profiler::clear();
+        Profiler::set_enabled(true);
+    }
+
+    ~ProfilerTest()
+    {
+        Profiler::set_enabled(false);
+        Profiler::set_counters_enabled(false);
+    }
+
+    std::string summary()
+    {
+        std::ostringstream os;
+        Profiler::print_summary(os);
+        return os.str();
+    }
+};
+
+TEST_F(ProfilerTest, nested_zones)
+{
+    {
+        ProfileZone outer("outer");
+        for (int i = 0; i < 3; ++i)
+            ProfileZone inner("inner");
+    }
+    EXPECT_EQ(summary().find("outer: "), 0u);
+    EXPECT_NE(summary().find("\n  inner: "), std::string::npos);
+    EXPECT_NE(summary().find("3 calls"), std::string::npos);
+}
+
+TEST_F(ProfilerTest, disabled)
+{
+    Profiler::set_enabled(false);
+    {
+        ProfileZone zone("disabled");
+    }
+    EXPECT_TRUE(summary().empty());
+}
+
+TEST_F(ProfilerTest, threads)
+{
+    std::thread thread([] { ProfileZone zone("thread"); });
+    thread.join();
+    {
+        ProfileZone zone("main");
+    }
+    EXPECT_NE(summary().find("thread: "), std::string::npos);
+    EXPECT_NE(summary().find("main: "), std::string::npos);
+}
+
+TEST_F(ProfilerTest, write_trace)
+{
+    {
+        ProfileZone zone("traced");
+    }
+    EXPECT_TRUE(Profiler::write_trace("trace.json"));
+    std::ifstream ifs("trace.json");
+    std::string trace((std::istreambuf_iterator<char>(ifs)),
+                      std::istreambuf_iterator<char>());
+    EXPECT_NE(trace.find("\"name\":\"traced\""), std::string::npos);
+    EXPECT_NE(trace.find("\"ph\":\"X\""), std::string::npos);
+}
+
+TEST_F(ProfilerTest, counters)
+{
+    Profiler::set_counters_enabled(true);
+    {
+        ProfileZone zone("with_counters");
+    }
+    Profiler::set_counters_enabled(false);
+    {
+        ProfileZone zone("without_counters");
+    }
+
+    // hardware counters may not be permitted, e.g., in virtual machines
+    const std::string s = summary();
+    const size_t with = s.find("with_counters: ");
+    const size_t without = s.find("without_counters: ");
+    ASSERT_NE(with, std::string::npos);
+    ASSERT_NE(without, std::string::npos);
+    const std::string with_line = s.substr(with, s.find('\n', with) - with);
+    const std::string without_line = s.substr(without);
+    EXPECT_EQ(without_line.find(" RSS"), std::string::npos);
+    if (PerfCounters().is_available())
+    {
+        EXPECT_NE(with_line.find(" RSS"), std::string::npos);
+    }
+    else
+    {
+        EXPECT_EQ(with_line.find(" RSS"), std::string::npos);
+    }
+}
@@ -0,0 +1,118 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include "SurfaceMeshTest.h"
+
+#include <pmp/algorithms/ProgressiveMesh.h>
+#include <pmp/algorithms/SurfaceSimplification.h>
+
+#include <cmath>
+#include <fstream>
+#include <iterator>
+
+using namespace pmp;
+
+class ProgressiveMeshTest : public SurfaceMeshTest
+{
+public:
+    // simplify the grid to 50 vertices
+    void simplify(ProgressiveMesh& pm)
+    {
+        add_triangle_grid(20);
+        SurfaceSimplification ss(mesh);
+        ss.initialize(10); // aspect ratio
+        SurfaceSimplification::StopCriteria criteria;
+        criteria.n_vertices = 50;
+        ss.simplify(criteria, pm);
+    }
+
+    // the face corners as positions
+    static std::vector<std::vector<Point>> corners(const SurfaceMesh& m)
+    {
+        std::vector<std::vector<Point>> result;
+        for (auto f : m.faces())
+        {
+            std::vector<Point> c;
+            for (auto v : m.vertices(f))
+                c.push_back(m.position(v));
+            result.push_back(c);
+        }
+        return result;
+    }
+};
+
+TEST_F(ProgressiveMeshTest, levels_of_detail)
+{
+    ProgressiveMesh pm;
+    simplify(pm);
+    EXPECT_EQ(mesh.n_vertices(), size_t(50));
+    EXPECT_EQ(pm.min_vertices(), size_t(50));
+    EXPECT_EQ(pm.max_vertices(), size_t(441));
+
+    // the base mesh is the simplified mesh
+    SurfaceMesh lod;
+    pm.extract(lod);
+    EXPECT_EQ(lod.n_faces(), mesh.n_faces());
+    EXPECT_TRUE(corners(lod) == corners(mesh));
+    const std::vector<IndexType> base(pm.indices());
+
+    // refine to the input mesh
+    pm.set_n_vertices(1000);
+    EXPECT_EQ(pm.n_vertices(), size_t(441));
+    EXPECT_EQ(pm.n_faces(), size_t(800));
+    pm.extract(lod);
+    EXPECT_EQ(lod.n_faces(), size_t(800));
+    EXPECT_EQ(lod.n_edges(), size_t(1240));
+
+    // any level in between
+    pm.set_n_vertices(200);
+    pm.extract(lod);
+    EXPECT_EQ(lod.n_vertices(), size_t(200));
+    EXPECT_EQ(lod.n_faces(), pm.n_faces());
+    EXPECT_TRUE(lod.is_triangle_mesh());
+
+    // and back to the base mesh
+    pm.set_n_vertices(0);
+    EXPECT_EQ(pm.n_vertices(), size_t(50));
+    EXPECT_TRUE(pm.indices() == base);
+}
+
+TEST_F(ProgressiveMeshTest, write_and_read)
+{
+    ProgressiveMesh pm;
+    simplify(pm);
+    pm.set_n_vertices(300);
+    EXPECT_TRUE(pm.write("progressive.pmpp"));
+
+    ProgressiveMesh read;
+    EXPECT_TRUE(read.read("progressive.pmpp"));
+    EXPECT_EQ(read.n_vertices(), size_t(50));
+    EXPECT_EQ(read.max_vertices(), size_t(441));
+    read.set_n_vertices(300);
+    pm.set_n_vertices(300);
+    EXPECT_TRUE(read.indices() == pm.indices());
+
+    // a truncated file stops at the last complete split
+    std::ifstream in("progressive.pmpp", std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(in)),
+                     std::istreambuf_iterator<char>());
+    std::ofstream out("truncated.pmpp", std::ios::binary);
+    out.write(data.data(), data.size() / 2);
+    out.close();
+
+    EXPECT_TRUE(read.read("truncated.pmpp"));
+    EXPECT_GT(read.max_vertices(), size_t(50));
+    EXPECT_LT(read.max_vertices(), size_t(441));
+    read.set_n_vertices(read.max_vertices());
+    SurfaceMesh lod;
+    read.extract(lod);
+    EXPECT_EQ(lod.n_vertices(), read.max_vertices());
+
+    EXPECT_FALSE(read.read("does_not_exist.pmpp"));
+}
@@ -0,0 +1,88 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include "SurfaceMeshTest.h"
+
+#include <pmp/algorithms/SignedDistance.h>
+
+using namespace pmp;
+
+class SignedDistanceTest : public SurfaceMeshTest
+{
+public:
+    // the triangulated unit cube
+    void add_cube()
+    {
+        for (int i = 0; i < 8; ++i)
+            mesh.add_vertex(Point(i & 1, (i >> 1) & 1, (i >> 2) & 1));
+        const int faces[6][4] = {{0, 2, 3, 1}, {4, 5, 7, 6}, {0, 1, 5, 4},
+                                 {2, 6, 7, 3}, {0, 4, 6, 2}, {1, 3, 7, 5}};
+        for (auto& f : faces)
+            mesh.add_quad(Vertex(f[0]), Vertex(f[1]), Vertex(f[2]),
+                          Vertex(f[3]));
+        mesh.triangulate();
+    }
+
+    // the exact signed distance to the unit cube
+    static Scalar cube_distance(const Point& p)
+    {
+        Point d;
+        for (int a = 0; a < 3; ++a)
+            d[a] = std::fabs(p[a] - Scalar(0.5)) - Scalar(0.5);
+        const Scalar outside = norm(max(d, Point(0)));
+        const Scalar inside = std::min(std::max(d[0], std::max(d[1], d[2])),
+                                       Scalar(0));
+        return outside + inside;
+    }
+};
+
+TEST_F(SignedDistanceTest, cube)
+{
+    add_cube();
+    SparseDistanceGrid grid;
+    const Scalar spacing = 0.05, band = 0.1;
+    ASSERT_TRUE(signed_distance_field(mesh, spacing, band, grid));
+    EXPECT_EQ(grid.bricks.size(), size_t(grid.n_bricks[0]) *
+                                      grid.n_bricks[1] * grid.n_bricks[2]);
+
+    // exact within the band, +-band elsewhere
+    size_t n_stored = 0;
+    for (unsigned int k = 0; k < grid.resolution(2); ++k)
+        for (unsigned int j = 0; j < grid.resolution(1); ++j)
+            for (unsigned int i = 0; i < grid.resolution(0); ++i)
+            {
+                const Point p = grid.origin + spacing * Point(i, j, k);
+                const Scalar d = cube_distance(p);
+                const Scalar value = grid.value(i, j, k);
+                if (std::fabs(d) <= band)
+                {
+                    EXPECT_NEAR(value, d, 1e-5);
+                    ++n_stored;
+                }
+                else if (std::fabs(value) == band)
+                    EXPECT_EQ(value < 0, d < 0);
+                else
+                    EXPECT_NEAR(value, d, 1e-5);
+            }
+    EXPECT_GT(n_stored, 0u);
+
+    // the center of the cube is not in the band
+    EXPECT_EQ(grid.interpolate(Point(0.5)), -band);
+    EXPECT_NEAR(grid.interpolate(Point(0.5, 0.5, 1.03)), 0.03, 1e-5);
+    EXPECT_LT(grid.values.size(), grid.bricks.size() * 512);
+}
+
+TEST_F(SignedDistanceTest, invalid)
+{
+    SparseDistanceGrid grid;
+    EXPECT_FALSE(signed_distance_field(mesh, 0.1, 0.1, grid));
+    add_cube();
+    EXPECT_FALSE(signed_distance_field(mesh, 0, 0.1, grid));
+    EXPECT_FALSE(signed_distance_field(mesh, 1e-6, 0.1, grid));
+}
@@ -0,0 +1,198 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include "gtest/gtest.h"
+
+#include <pmp/algorithms/SparseSolver.h>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+using namespace pmp;
+
+class SparseSolverTest : public ::testing::Test
+{
+public:
+    // the 1D Laplacian plus identity, with n rows
+    SparseSolverTest()
+    {
+        const int n = 50;
+        A.n_rows = A.n_columns = n;
+        A.offsets.push_back(0);
+        for (int i = 0; i < n; ++i)
+        {
+            if (i > 0)
+            {
+                A.columns.push_back(i - 1);
+                A.values.push_back(-1.0);
+            }
+            A.columns.push_back(i);
+            A.values.push_back(3.0);
+            if (i + 1 < n)
+            {
+                A.columns.push_back(i + 1);
+                A.values.push_back(-1.0);
+            }
+            A.offsets.push_back(A.columns.size());
+        }
+
+        // two right-hand sides of known solutions
+        for (int j = 0; j < 2; ++j)
+            for (int i = 0; i < n; ++i)
+                solution.push_back(std::sin(0.1 * i + j));
+        b.assign(2 * n, 0.0);
+        for (int j = 0; j < 2; ++j)
+            for (int i = 0; i < n; ++i)
+                for (int k = A.offsets[i]; k < A.offsets[i + 1]; ++k)
+                    b[j * n + i] +=
+                        A.values[k] * solution[j * n + A.columns[k]];
+    }
+
+    void expect_solution(const std::vector<double>& x)
+    {
+        ASSERT_EQ(x.size(), solution.size());
+        for (size_t i = 0; i < x.size(); ++i)
+            EXPECT_NEAR(x[i], solution[i], 1e-6);
+    }
+
+    CompressedRowMatrix A;
+    std::vector<double> b, solution;
+};
+
+TEST_F(SparseSolverTest, methods)
+{
+    const SparseSolver::Method methods[] = {
+        SparseSolver::LDLT, SparseSolver::ConjugateGradient,
+        SparseSolver::IncompleteCholeskyCG, SparseSolver::BiCGSTAB,
+        SparseSolver::MixedPrecisionLDLT, SparseSolver::Multigrid};
+    for (auto method : methods)
+    {
+        SparseSolver solver(method);
+        EXPECT_EQ(solver.method(), method);
+        EXPECT_TRUE(solver.compute(A));
+        std::vector<double> x;
+        EXPECT_TRUE(solver.solve(b, x));
+        expect_solution(x);
+        EXPECT_GE(solver.setup_time(), 0.0);
+        EXPECT_GE(solver.solve_time(), 0.0);
+        if (method == SparseSolver::ConjugateGradient ||
+            method == SparseSolver::MixedPrecisionLDLT)
+        {
+            EXPECT_GT(solver.iterations(), 0u);
+        }
+    }
+}
+
+TEST_F(SparseSolverTest, reuse)
+{
+    SparseSolver solver;
+    EXPECT_TRUE(solver.compute(A));
+    EXPECT_TRUE(solver.compute(A));
+    EXPECT_EQ(solver.setup_time(), 0.0);
+
+    // new values with the same pattern
+    for (auto& v : A.values)
+        v *= 2.0;
+    for (auto& v : b)
+        v *= 2.0;
+    EXPECT_TRUE(solver.compute(A));
+    std::vector<double> x;
+    EXPECT_TRUE(solver.solve(b, x));
+    expect_solution(x);
+
+    // a right-hand side of the wrong size
+    b.pop_back();
+    EXPECT_FALSE(solver.solve(b, x));
+}
+
+TEST_F(SparseSolverTest, default_method)
+{
+    EXPECT_EQ(SparseSolver::default_method(), SparseSolver::LDLT);
+    SparseSolver::set_default_method(SparseSolver::ConjugateGradient);
+    SparseSolver solver;
+    EXPECT_EQ(solver.method(), SparseSolver::ConjugateGradient);
+    SparseSolver::set_default_method(SparseSolver::LDLT);
+}
+
+TEST_F(SparseSolverTest, multigrid)
+{
+    // the 2D Laplacian of a grid with fixed boundary and its square
+    const int m = 60;
+    CompressedRowMatrix laplace;
+    laplace.n_rows = laplace.n_columns = m * m;
+    laplace.offsets.push_back(0);
+    for (int i = 0; i < m; ++i)
+        for (int j = 0; j < m; ++j)
+        {
+            const int r = i * m + j;
+            const int neighbors[5] = {i > 0 ? r - m : -1, j > 0 ? r - 1 : -1,
+                                      r, j + 1 < m ? r + 1 : -1,
+                                      i + 1 < m ? r + m : -1};
+            for (int c : neighbors)
+                if (c >= 0)
+                {
+                    laplace.columns.push_back(c);
+                    laplace.values.push_back(c == r ? 4.0 : -1.0);
+                }
+            laplace.offsets.push_back(laplace.columns.size());
+        }
+
+    CompressedRowMatrix bilaplace = laplace;
+    bilaplace.offsets.assign(1, 0);
+    bilaplace.columns.clear();
+    bilaplace.values.clear();
+    for (int r = 0; r < laplace.n_rows; ++r)
+    {
+        std::map<int, double> row;
+        for (int k = laplace.offsets[r]; k < laplace.offsets[r + 1]; ++k)
+        {
+            const int c = laplace.columns[k];
+            for (int l = laplace.offsets[c]; l < laplace.offsets[c + 1]; ++l)
+                row[laplace.columns[l]] +=
+                    laplace.values[k] * laplace.values[l];
+        }
+        for (const auto& entry : row)
+        {
+            bilaplace.columns.push_back(entry.first);
+            bilaplace.values.push_back(entry.second);
+        }
+        bilaplace.offsets.push_back(bilaplace.columns.size());
+    }
+
+    // the linear functions are in the near kernel of the bi-Laplacian
+    std::vector<double> coordinates;
+    for (int r = 0; r < m * m; ++r)
+        coordinates.push_back(r % m);
+    for (int r = 0; r < m * m; ++r)
+        coordinates.push_back(r / m);
+
+    for (const auto* matrix : {&laplace, &bilaplace})
+    {
+        std::vector<double> x, b(matrix->n_rows, 1.0);
+        SparseSolver solver(SparseSolver::Multigrid);
+        if (matrix == &bilaplace)
+            solver.set_near_kernel(coordinates);
+        EXPECT_TRUE(solver.compute(*matrix));
+        EXPECT_TRUE(solver.solve(b, x));
+        EXPECT_LT(solver.iterations(), 100u);
+
+        SparseSolver ldlt(SparseSolver::LDLT);
+        std::vector<double> y;
+        EXPECT_TRUE(ldlt.compute(*matrix));
+        EXPECT_TRUE(ldlt.solve(b, y));
+        double error = 0.0, norm = 0.0;
+        for (size_t i = 0; i < x.size(); ++i)
+        {
+            error = std::max(error, std::abs(x[i] - y[i]));
+            norm = std::max(norm, std::abs(y[i]));
+        }
+        EXPECT_LT(error, 1e-6 * norm);
+    }
+}
@@ -0,0 +1,88 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include "SurfaceMeshTest.h"
+
+#include <pmp/algorithms/SurfaceAdjacency.h>
+#include <vector>
+
+using namespace pmp;
+
+class SurfaceAdjacencyTest : public SurfaceMeshTest
+{
+};
+
+TEST_F(SurfaceAdjacencyTest, matches_circulators)
+{
+    add_grid(10);
+    SurfaceAdjacency adjacency(mesh);
+
+    for (auto v : mesh.vertices())
+    {
+        std::vector<Vertex> vv;
+        std::vector<Edge> ve;
+        for (auto h : mesh.halfedges(v))
+        {
+            vv.push_back(mesh.to_vertex(h));
+            ve.push_back(mesh.edge(h));
+        }
+        std::vector<Face> vf;
+        for (auto f : mesh.faces(v))
+            vf.push_back(f);
+
+        EXPECT_EQ(adjacency.valence(v), mesh.valence(v));
+        EXPECT_EQ(std::vector<Vertex>(adjacency.vertices(v).begin(),
+                                      adjacency.vertices(v).end()),
+                  vv);
+        EXPECT_EQ(std::vector<Edge>(adjacency.edges(v).begin(),
+                                    adjacency.edges(v).end()),
+                  ve);
+        EXPECT_EQ(std::vector<Face>(adjacency.faces(v).begin(),
+                                    adjacency.faces(v).end()),
+                  vf);
+    }
+
+    for (auto f : mesh.faces())
+    {
+        std::vector<Vertex> fv;
+        for (auto v : mesh.vertices(f))
+            fv.push_back(v);
+        EXPECT_EQ(adjacency.valence(f), 4u);
+        EXPECT_EQ(std::vector<Vertex>(adjacency.vertices(f).begin(),
+                                      adjacency.vertices(f).end()),
+                  fv);
+    }
+}
+
+TEST_F(SurfaceAdjacencyTest, invalidation)
+{
+    add_grid(4);
+    SurfaceAdjacency adjacency(mesh);
+    EXPECT_TRUE(adjacency.is_valid());
+
+    // geometry changes keep the snapshot valid
+    mesh.position(Vertex(0)) = Point(1, 2, 3);
+    EXPECT_TRUE(adjacency.is_valid());
+
+    // topology changes invalidate it
+    mesh.triangulate();
+    EXPECT_FALSE(adjacency.is_valid());
+
+    adjacency.update();
+    EXPECT_TRUE(adjacency.is_valid());
+    EXPECT_EQ(adjacency.valence(Face(0)), 3u);
+
+    mesh.delete_vertex(Vertex(0));
+    EXPECT_FALSE(adjacency.is_valid());
+    adjacency.update();
+    EXPECT_TRUE(adjacency.vertices(Vertex(0)).empty());
+
+    mesh.garbage_collection();
+    EXPECT_FALSE(adjacency.is_valid());
+}
@@ -0,0 +1,83 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include "SurfaceMeshTest.h"
+
+#include <pmp/algorithms/SurfaceClustering.h>
+
+using namespace pmp;
+
+class SurfaceClusteringTest : public SurfaceMeshTest
+{
+};
+
+TEST_F(SurfaceClusteringTest, quadric_minimizer)
+{
+    Quadric q(Normal(1, 0, 0), Point(1, 0, 0));
+    Point p;
+    EXPECT_FALSE(q.minimizer(p));
+
+    q += Quadric(Normal(0, 1, 0), Point(0, 2, 0));
+    q += Quadric(Normal(0, 0, 1), Point(0, 0, 3));
+    EXPECT_TRUE(q.minimizer(p));
+    EXPECT_LT(norm(p - Point(1, 2, 3)), 1e-5);
+}
+
+TEST_F(SurfaceClusteringTest, quadric_add_plane)
+{
+    Quadric q(Normal(0, 0, 1), Point(0, 0, 1));
+    q.add_plane(1, 0, 0, -2);
+
+    Quadric r(Normal(0, 0, 1), Point(0, 0, 1));
+    r += Quadric(1, 0, 0, -2);
+    for (auto p : {Point(0, 0, 0), Point(1, 2, 3), Point(-1, 0.5, 2)})
+        EXPECT_DOUBLE_EQ(q(p), r(p));
+    EXPECT_DOUBLE_EQ(q(Point(2, 5, 1)), 0.0);
+}
+
+TEST_F(SurfaceClusteringTest, grid)
+{
+    add_grid(20);
+    EXPECT_TRUE(mesh.write("clustering.off"));
+
+    SurfaceMesh result;
+    EXPECT_TRUE(simplify_clustering("clustering.off", result, 5));
+
+    // one vertex per occupied cell, at the mean of its input vertices
+    EXPECT_EQ(result.n_vertices(), size_t(25));
+    EXPECT_GT(result.n_faces(), size_t(0));
+    EXPECT_TRUE(result.is_triangle_mesh());
+    for (auto v : result.vertices())
+    {
+        const Point& p = result.position(v);
+        EXPECT_GE(p[0], 0);
+        EXPECT_LE(p[0], 20);
+        EXPECT_EQ(p[2], 0);
+    }
+}
+
+TEST_F(SurfaceClusteringTest, sink)
+{
+    add_grid(10);
+    EXPECT_TRUE(mesh.write("clustering.obj"));
+
+    // a single cell collapses all triangles
+    SurfaceClustering clustering(
+        BoundingBox(Point(0, 0, 0), Point(10, 10, 0)), 1);
+    EXPECT_TRUE(read_stream("clustering.obj", clustering));
+    EXPECT_EQ(clustering.mesh().n_faces(), size_t(0));
+
+    // the full resolution keeps the triangulated grid
+    SurfaceClustering fine(BoundingBox(Point(-0.5, -0.5, 0),
+                                        Point(10.5, 10.5, 0)),
+                           11);
+    EXPECT_TRUE(read_stream("clustering.obj", fine));
+    EXPECT_EQ(fine.mesh().n_vertices(), size_t(121));
+    EXPECT_EQ(fine.mesh().n_faces(), size_t(200));
+}
@@ -0,0 +1,96 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include "SurfaceMeshTest.h"
+
+#include <pmp/algorithms/SurfaceComponents.h>
+#include <pmp/Parallel.h>
+
+using namespace pmp;
+
+class SurfaceComponentsTest : public SurfaceMeshTest
+{
+public:
+    // a grid, a separate triangle, an isolated vertex, and a quad
+    void add_pieces()
+    {
+        add_grid(10);
+        add_triangle();
+        mesh.add_vertex(Point(5, 5, 5));
+        add_quad();
+    }
+};
+
+TEST_F(SurfaceComponentsTest, label)
+{
+    add_pieces();
+    SurfaceComponents components(mesh);
+    EXPECT_EQ(components.label(), size_t(4));
+
+    // numbered in the order of the smallest vertex index
+    EXPECT_EQ(components.n_faces(0), size_t(100));
+    EXPECT_EQ(components.n_vertices(0), size_t(121));
+    EXPECT_EQ(components.n_faces(1), size_t(1));
+    EXPECT_EQ(components.n_faces(2), size_t(0));
+    EXPECT_EQ(components.n_vertices(2), size_t(1));
+    EXPECT_EQ(components.n_faces(3), size_t(1));
+
+    auto vcomponent = mesh.get_vertex_property<IndexType>("v:component");
+    auto fcomponent = mesh.get_face_property<IndexType>("f:component");
+    ASSERT_TRUE(vcomponent && fcomponent);
+    EXPECT_EQ(vcomponent[v3], 3u);
+    EXPECT_EQ(fcomponent[f0], 3u);
+    for (auto f : mesh.faces())
+        for (auto v : mesh.vertices(f))
+            EXPECT_EQ(vcomponent[v], fcomponent[f]);
+}
+
+TEST_F(SurfaceComponentsTest, deterministic)
+{
+    add_grid(40);
+    add_pieces();
+    set_num_threads(1);
+    SurfaceComponents components(mesh);
+    components.label();
+    auto serial = mesh.get_vertex_property<IndexType>("v:component").vector();
+
+    set_num_threads(0);
+    components.label();
+    EXPECT_EQ(mesh.get_vertex_property<IndexType>("v:component").vector(),
+              serial);
+}
+
+TEST_F(SurfaceComponentsTest, extract)
+{
+    add_pieces();
+    SurfaceComponents components(mesh);
+    components.label();
+
+    SurfaceMesh result;
+    EXPECT_TRUE(components.extract(3, result));
+    EXPECT_EQ(result.n_vertices(), size_t(4));
+    EXPECT_EQ(result.n_faces(), size_t(1));
+    EXPECT_EQ(result.position(Vertex(2)), mesh.position(v2));
+
+    EXPECT_TRUE(components.extract(0, result));
+    EXPECT_EQ(result.n_faces(), size_t(100));
+}
+
+TEST_F(SurfaceComponentsTest, delete_small_components)
+{
+    add_pieces();
+    SurfaceComponents components(mesh);
+    EXPECT_EQ(components.delete_small_components(2), size_t(3));
+    EXPECT_EQ(mesh.vertices_size(), mesh.n_vertices());
+    EXPECT_EQ(mesh.n_vertices(), size_t(121));
+    EXPECT_EQ(mesh.n_faces(), size_t(100));
+    EXPECT_EQ(components.n_components(), size_t(1));
+
+    EXPECT_EQ(components.delete_small_components(2), size_t(0));
+}
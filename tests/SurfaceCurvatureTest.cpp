@@ -10,6 +10,10 @@
 #include "gtest/gtest.h"
 
 #include <pmp/algorithms/SurfaceCurvature.h>
+#include <pmp/algorithms/SurfaceFactory.h>
+#include <pmp/Parallel.h>
+
+#include <vector>
 
 using namespace pmp;
 
@@ -88,3 +92,99 @@ TEST_F(SurfaceCurvatureTest, gauss_curvature_to_texture_coordinates)
     auto tex = mesh.vertex_property<TexCoord>("v:tex");
     EXPECT_TRUE(tex);
 }
+
+TEST(SurfaceCurvatureTensorTest, sphere)
+{
+    // a latitude-longitude sphere of radius 2
+    SurfaceMesh mesh;
+    const int n_lat = 40, n_lon = 80;
+    const Scalar r = 2;
+    auto north = mesh.add_vertex(Point(0, 0, r));
+    std::vector<Vertex> ring;
+    for (int i = 1; i < n_lat; ++i)
+    {
+        const Scalar theta = M_PI * i / n_lat;
+        for (int j = 0; j < n_lon; ++j)
+        {
+            const Scalar phi = 2 * M_PI * j / n_lon;
+            ring.push_back(mesh.add_vertex(
+                r * Point(sin(theta) * cos(phi), sin(theta) * sin(phi),
+                          cos(theta))));
+        }
+    }
+    auto south = mesh.add_vertex(Point(0, 0, -r));
+    auto at = [&](int i, int j) { return ring[i * n_lon + j % n_lon]; };
+    for (int j = 0; j < n_lon; ++j)
+    {
+        mesh.add_triangle(north, at(0, j), at(0, j + 1));
+        mesh.add_triangle(south, at(n_lat - 2, j + 1), at(n_lat - 2, j));
+        for (int i = 0; i + 2 < n_lat; ++i)
+        {
+            mesh.add_triangle(at(i, j), at(i + 1, j), at(i + 1, j + 1));
+            mesh.add_triangle(at(i, j), at(i + 1, j + 1), at(i, j + 1));
+        }
+    }
+
+    SurfaceCurvature curvature(mesh);
+    for (unsigned int steps : {0u, 2u})
+    {
+        curvature.analyze_tensor(steps, true);
+
+        // principal curvatures are 1/r away from the poles
+        for (int i = 5; i + 6 < n_lat; ++i)
+            for (int j = 0; j < n_lon; ++j)
+            {
+                EXPECT_NEAR(curvature.min_curvature(at(i, j)), 0.5, 0.02);
+                EXPECT_NEAR(curvature.max_curvature(at(i, j)), 0.5, 0.02);
+            }
+    }
+}
+
+TEST(SurfaceCurvatureLazyTest, lazy_equals_analyze)
+{
+    // with boundary, and features excluded from smoothing
+    SurfaceMesh mesh = SurfaceFactory::terrain(20000, 0.5, 3);
+    auto feature = mesh.add_vertex_property<bool>("v:feature", false);
+    for (auto v : mesh.vertices())
+        feature[v] = (v.idx() % 97 == 0);
+
+    SurfaceMesh copy = mesh;
+    SurfaceCurvature full(mesh), lazy(copy);
+    for (unsigned int steps : {0u, 2u})
+    {
+        for (int tensor = 0; tensor < 2; ++tensor)
+        {
+            if (tensor)
+            {
+                full.analyze_tensor(steps, true);
+                lazy.analyze_tensor_lazy(steps, true);
+            }
+            else
+            {
+                full.analyze(steps);
+                lazy.analyze_lazy(steps);
+            }
+
+            // queried concurrently, some vertices several times
+            const size_t n = mesh.n_vertices();
+            std::vector<Scalar> kmin(n), kmax(n), mean(n), gauss(n);
+            parallel_for(0, 2 * n, [&](size_t i) {
+                const Vertex v(IndexType((i * 7919) % n));
+                kmin[v.idx()] = lazy.min_curvature(v);
+                kmax[v.idx()] = lazy.max_curvature(v);
+                mean[v.idx()] = lazy.mean_curvature(v);
+                gauss[v.idx()] = lazy.gauss_curvature(v);
+            });
+
+            for (auto v : mesh.vertices())
+            {
+                const Scalar eps = 1e-4 * (1 + full.max_abs_curvature(v));
+                EXPECT_NEAR(kmin[v.idx()], full.min_curvature(v), eps);
+                EXPECT_NEAR(kmax[v.idx()], full.max_curvature(v), eps);
+                EXPECT_NEAR(mean[v.idx()], full.mean_curvature(v), eps);
+                EXPECT_NEAR(gauss[v.idx()], full.gauss_curvature(v),
+                            eps * eps + eps * full.max_abs_curvature(v));
+            }
+        }
+    }
+}
@@ -0,0 +1,95 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include "SurfaceMeshTest.h"
+
+#include <pmp/algorithms/SurfaceDelaunay.h>
+#include <pmp/algorithms/DifferentialGeometry.h>
+
+#include <random>
+
+using namespace pmp;
+
+class SurfaceDelaunayTest : public SurfaceMeshTest
+{
+public:
+    // a planar grid of n x n quads with jittered vertices, triangulated
+    void add_jittered_grid(unsigned int n)
+    {
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<Scalar> jitter(-0.3, 0.3);
+        add_triangle_grid(mesh, n, [&](unsigned int i, unsigned int j) {
+            const Scalar x = i + jitter(rng);
+            const Scalar y = j + jitter(rng);
+            return Point(x, y, 0);
+        });
+    }
+};
+
+TEST_F(SurfaceDelaunayTest, planar_grid)
+{
+    add_jittered_grid(10);
+    SurfaceDelaunay delaunay(mesh);
+
+    size_t n_violations = 0;
+    for (auto e : mesh.edges())
+        if (!delaunay.is_delaunay(e))
+            ++n_violations;
+    EXPECT_GT(n_violations, size_t(0));
+
+    const size_t n_edges = mesh.n_edges();
+    EXPECT_GT(delaunay.flip_edges(), 0u);
+    EXPECT_EQ(mesh.n_edges(), n_edges);
+    for (auto e : mesh.edges())
+    {
+        EXPECT_TRUE(delaunay.is_delaunay(e));
+        if (!mesh.is_boundary(e))
+        {
+            EXPECT_GT(cotan_weight(mesh, e), -1e-4);
+        }
+    }
+
+    // nothing left to flip
+    EXPECT_EQ(delaunay.flip_edges(), 0u);
+}
+
+TEST_F(SurfaceDelaunayTest, max_flips)
+{
+    add_jittered_grid(10);
+    EXPECT_EQ(SurfaceDelaunay(mesh).flip_edges(3), 3u);
+}
+
+TEST_F(SurfaceDelaunayTest, keep_surface)
+{
+    // two triangles folded along a non-Delaunay edge
+    const Vertex v0 = mesh.add_vertex(Point(0, 0, 0));
+    const Vertex v1 = mesh.add_vertex(Point(1, 0, 0));
+    const Vertex v2 = mesh.add_vertex(Point(0.5, 0.1, 0));
+    const Vertex v3 = mesh.add_vertex(Point(0.5, -0.1, 0.05));
+    mesh.add_triangle(v0, v1, v2);
+    mesh.add_triangle(v1, v0, v3);
+    const Edge e = mesh.edge(mesh.find_halfedge(v0, v1));
+
+    SurfaceDelaunay delaunay(mesh);
+    EXPECT_FALSE(delaunay.is_delaunay(e));
+    EXPECT_EQ(delaunay.flip_edges(), 0u);
+
+    delaunay.set_max_dihedral_angle(45.0);
+    EXPECT_EQ(delaunay.flip_edges(), 1u);
+    EXPECT_TRUE(mesh.find_halfedge(v2, v3).is_valid());
+}
+
+TEST_F(SurfaceDelaunayTest, keep_features)
+{
+    add_jittered_grid(10);
+    auto efeature = mesh.edge_property<bool>("e:feature", false);
+    for (auto e : mesh.edges())
+        efeature[e] = true;
+    EXPECT_EQ(SurfaceDelaunay(mesh).flip_edges(), 0u);
+}
@@ -0,0 +1,69 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include "SurfaceMeshTest.h"
+
+#include <pmp/algorithms/SurfaceDistance.h>
+
+using namespace pmp;
+
+class SurfaceDistanceTest : public SurfaceMeshTest
+{
+public:
+    // an n x n grid of triangles at height z
+    static void add_triangle_grid(SurfaceMesh& m, unsigned int n, Scalar z)
+    {
+        SurfaceMeshTest::add_triangle_grid(
+            m, n, [z](unsigned int i, unsigned int j) { return Point(i, j, z); });
+    }
+};
+
+TEST_F(SurfaceDistanceTest, parallel_planes)
+{
+    add_triangle_grid(mesh, 10, 0);
+    SurfaceMesh other;
+    add_triangle_grid(other, 10, 0.5);
+
+    const auto d = SurfaceDistance(other).distance(mesh, 0.25);
+    EXPECT_FLOAT_EQ(d.max, 0.5);
+    EXPECT_FLOAT_EQ(d.mean, 0.5);
+    EXPECT_FLOAT_EQ(d.rms, 0.5);
+
+    // the diagonals are split into 6 segments, giving 36 samples per
+    // triangle, and the vertices
+    EXPECT_EQ(d.n_samples, size_t(200 * 36 + 121));
+
+    auto distance = mesh.get_vertex_property<Scalar>("v:distance");
+    ASSERT_TRUE(distance);
+    for (auto v : mesh.vertices())
+        EXPECT_FLOAT_EQ(distance[v], 0.5);
+}
+
+TEST_F(SurfaceDistanceTest, hausdorff)
+{
+    add_triangle_grid(mesh, 10, 0);
+    SurfaceMesh bump(mesh);
+
+    // raise a single vertex, which only the vertex samples hit exactly
+    const Vertex top(5 * 11 + 5);
+    bump.position(top)[2] = 2;
+
+    const auto ab = SurfaceDistance(bump).distance(mesh);
+    const auto ba = SurfaceDistance(mesh).distance(bump);
+    EXPECT_LT(ab.max, 2);
+    EXPECT_FLOAT_EQ(ba.max, 2);
+    EXPECT_GT(ba.mean, 0);
+    EXPECT_LT(ba.mean, ba.rms);
+
+    const auto d = hausdorff_distance(mesh, bump, 0.1);
+    EXPECT_FLOAT_EQ(d.max, 2);
+    EXPECT_GT(d.n_samples, ab.n_samples + ba.n_samples);
+    auto distance = bump.get_vertex_property<Scalar>("v:distance");
+    EXPECT_FLOAT_EQ(distance[top], 2);
+}
@@ -0,0 +1,148 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include "gtest/gtest.h"
+
+#include <pmp/algorithms/SurfaceFactory.h>
+#include <pmp/PointWelder.h>
+#include <algorithm>
+#include <vector>
+
+using namespace pmp;
+
+namespace {
+
+// the Euler characteristic of mesh
+int euler(const SurfaceMesh& mesh)
+{
+    return int(mesh.n_vertices()) - int(mesh.n_edges()) +
+           int(mesh.n_faces());
+}
+
+bool is_closed(const SurfaceMesh& mesh)
+{
+    for (auto v : mesh.vertices())
+        if (mesh.is_boundary(v))
+            return false;
+    return true;
+}
+
+} // namespace
+
+TEST(SurfaceFactoryTest, icosphere)
+{
+    SurfaceMesh mesh = SurfaceFactory::icosphere(20);
+    EXPECT_EQ(mesh.n_vertices(), size_t(12));
+    EXPECT_EQ(mesh.n_faces(), size_t(20));
+
+    // 5 x 5 triangles per face of the icosahedron
+    mesh = SurfaceFactory::icosphere(500);
+    EXPECT_EQ(mesh.n_faces(), size_t(500));
+    EXPECT_EQ(mesh.n_vertices(), size_t(252));
+    EXPECT_EQ(euler(mesh), 2);
+    EXPECT_TRUE(is_closed(mesh));
+    for (auto v : mesh.vertices())
+        EXPECT_NEAR(norm(mesh.position(v)), 1, 1e-5);
+
+    // the faces point outwards
+    for (auto f : mesh.faces())
+    {
+        auto h = mesh.halfedge(f);
+        const Point a = mesh.position(mesh.from_vertex(h));
+        const Point b = mesh.position(mesh.to_vertex(h));
+        const Point c = mesh.position(mesh.to_vertex(mesh.next_halfedge(h)));
+        EXPECT_GT(dot(cross(b - a, c - a), a + b + c), 0);
+    }
+}
+
+TEST(SurfaceFactoryTest, torus)
+{
+    SurfaceMesh mesh = SurfaceFactory::torus(10000);
+    EXPECT_NEAR(double(mesh.n_faces()), 10000, 500);
+    EXPECT_EQ(mesh.n_faces(), 2 * mesh.n_vertices());
+    EXPECT_EQ(euler(mesh), 0);
+    EXPECT_TRUE(is_closed(mesh));
+}
+
+TEST(SurfaceFactoryTest, grid)
+{
+    SurfaceMesh mesh = SurfaceFactory::grid(3, 2);
+    EXPECT_EQ(mesh.n_vertices(), size_t(12));
+    EXPECT_EQ(mesh.n_faces(), size_t(6));
+    EXPECT_TRUE(mesh.is_quad_mesh());
+
+    mesh = SurfaceFactory::grid(3, 2, true);
+    EXPECT_EQ(mesh.n_faces(), size_t(12));
+    EXPECT_TRUE(mesh.is_triangle_mesh());
+    EXPECT_EQ(mesh.position(Vertex(11)), Point(1, 1, 0));
+}
+
+TEST(SurfaceFactoryTest, terrain)
+{
+    SurfaceMesh a = SurfaceFactory::terrain(20000, 0.5, 1);
+    SurfaceMesh b = SurfaceFactory::terrain(20000, 0.5, 1);
+    SurfaceMesh c = SurfaceFactory::terrain(20000, 0.5, 2);
+    EXPECT_EQ(a.n_faces(), size_t(20000));
+    EXPECT_EQ(euler(a), 1);
+
+    // equal seeds give equal heights
+    bool differs = false;
+    Scalar zmin = 1, zmax = -1;
+    for (auto v : a.vertices())
+    {
+        EXPECT_EQ(a.position(v), b.position(v));
+        differs |= a.position(v)[2] != c.position(v)[2];
+        zmin = std::min(zmin, a.position(v)[2]);
+        zmax = std::max(zmax, a.position(v)[2]);
+    }
+    EXPECT_TRUE(differs);
+    EXPECT_GT(zmax - zmin, 0.05);
+    EXPECT_LT(zmax - zmin, 1);
+}
+
+TEST(SurfaceFactoryTest, polygon_soup)
+{
+    std::vector<Point> points;
+    std::vector<IndexType> indices;
+    SurfaceMesh mesh;
+
+    // without defects the soup is a closed manifold
+    SurfaceFactory::SoupDefects defects;
+    SurfaceFactory::polygon_soup(2000, defects, points, indices);
+    EXPECT_TRUE(mesh.build_from_indices(points, indices));
+    EXPECT_TRUE(is_closed(mesh));
+    const size_t n_faces = mesh.n_faces();
+
+    // split vertices open cracks, which welding closes again
+    defects.split_vertices = 0.1;
+    SurfaceFactory::polygon_soup(2000, defects, points, indices);
+    EXPECT_GT(points.size(), mesh.n_vertices());
+    EXPECT_TRUE(mesh.build_from_indices(points, indices));
+    EXPECT_FALSE(is_closed(mesh));
+    PointWelder welder;
+    std::vector<IndexType> welded;
+    for (auto i : indices)
+        welded.push_back(welder.insert(points[i]));
+    EXPECT_TRUE(mesh.build_from_indices(welder.points(), welded));
+    EXPECT_TRUE(is_closed(mesh));
+
+    // fins cannot be added
+    defects = SurfaceFactory::SoupDefects();
+    defects.non_manifold_edges = 0.01;
+    SurfaceFactory::polygon_soup(2000, defects, points, indices);
+    EXPECT_GT(indices.size(), 3 * n_faces);
+    EXPECT_FALSE(mesh.build_from_indices(points, indices));
+    EXPECT_GE(mesh.n_faces(), n_faces);
+    EXPECT_LT(mesh.n_faces(), indices.size() / 3);
+
+    // the same seed gives the same soup
+    std::vector<IndexType> again;
+    SurfaceFactory::polygon_soup(2000, defects, points, again);
+    EXPECT_EQ(again, indices);
+}
@@ -7,10 +7,13 @@
 // SPDX-License-Identifier: MIT
 //=============================================================================
 
-#include "gtest/gtest.h"
+#include "SurfaceMeshTest.h"
 
 #include <pmp/algorithms/SurfaceFairing.h>
 
+#include <algorithm>
+#include <cmath>
+
 using namespace pmp;
 
 class SurfaceFairingTest : public ::testing::Test
@@ -61,3 +64,95 @@ TEST_F(SurfaceFairingTest, fairing_selected)
     auto bb2 = mesh.bounds();
     EXPECT_LT(bb2.size(),bb.size());
 }
+
+class SurfaceFairingGridTest : public SurfaceMeshTest
+{
+};
+
+TEST_F(SurfaceFairingGridTest, local_fairing)
+{
+    add_grid(10);
+    mesh.triangulate();
+    for (auto v : mesh.vertices())
+    {
+        Point& p = mesh.position(v);
+        p[2] = std::sin(p[0] * p[1]);
+    }
+
+    // fairing all vertices matches fair()
+    SurfaceMesh copy = mesh;
+    std::vector<Vertex> all;
+    for (auto v : mesh.vertices())
+        all.push_back(v);
+    SurfaceFairing(mesh).fair(all, 2);
+    SurfaceFairing(copy).fair(2);
+    for (auto v : mesh.vertices())
+        EXPECT_LT(distance(mesh.position(v), copy.position(v)), 1e-4);
+
+    // the other vertices stay fixed
+    for (auto v : mesh.vertices())
+    {
+        Point& p = mesh.position(v);
+        p[2] = std::sin(p[0] * p[1]);
+    }
+    copy = mesh;
+    std::vector<Vertex> region;
+    for (auto v : mesh.vertices())
+        if (distance(mesh.position(v), Point(5, 5, 0)) < 3)
+            region.push_back(v);
+    SurfaceFairing(mesh).fair(region, 2);
+    Scalar change = 0;
+    for (auto v : mesh.vertices())
+    {
+        const Scalar d = distance(mesh.position(v), copy.position(v));
+        if (std::find(region.begin(), region.end(), v) == region.end())
+        {
+            EXPECT_EQ(d, 0);
+        }
+        change += d;
+    }
+    EXPECT_GT(change, 0);
+}
+
+TEST_F(SurfaceFairingGridTest, persistent_fairing)
+{
+    add_grid(10);
+    mesh.triangulate();
+    for (auto v : mesh.vertices())
+    {
+        Point& p = mesh.position(v);
+        p[2] = std::sin(p[0] * p[1]);
+    }
+
+    // the first call matches fair()
+    SurfaceMesh copy = mesh;
+    SurfaceFairing fairing(mesh);
+    fairing.fair_persistent(2);
+    SurfaceFairing(copy).fair(2);
+    for (auto v : mesh.vertices())
+        EXPECT_LT(distance(mesh.position(v), copy.position(v)), 1e-4);
+
+    // translating the locked boundary rings translates the solution
+    const Point t(0, 0, 1);
+    for (auto v : mesh.vertices())
+    {
+        bool locked = mesh.is_boundary(v);
+        for (auto w : mesh.vertices(v))
+            locked = locked || mesh.is_boundary(w);
+        if (locked)
+            mesh.position(v) += t;
+    }
+    fairing.fair_persistent(2);
+    for (auto v : mesh.vertices())
+        EXPECT_LT(distance(mesh.position(v), copy.position(v) + t), 1e-4);
+
+    // a changed topology is factored again
+    for (auto v : mesh.vertices())
+        copy.position(v) = mesh.position(v);
+    mesh.split(Face(0), Point(0.3, 0.3, 1.0));
+    copy.split(Face(0), Point(0.3, 0.3, 1.0));
+    fairing.fair_persistent(2);
+    SurfaceFairing(copy).fair(2);
+    for (auto v : mesh.vertices())
+        EXPECT_LT(distance(mesh.position(v), copy.position(v)), 1e-4);
+}
@@ -7,9 +7,10 @@
 // SPDX-License-Identifier: MIT
 //=============================================================================
 
-#include "gtest/gtest.h"
+#include "SurfaceMeshTest.h"
 
 #include <pmp/algorithms/SurfaceFeatures.h>
+#include <pmp/algorithms/GeometryCache.h>
 
 using namespace pmp;
 
@@ -67,3 +68,71 @@ TEST_F(SurfaceFeaturesTest, detect_boundary)
         }
     EXPECT_TRUE(found);
 }
+
+// a flat n x n grid of triangles
+static SurfaceMesh grid(unsigned int n)
+{
+    SurfaceMesh mesh;
+    SurfaceMeshTest::add_triangle_grid(
+        mesh, n, [](unsigned int i, unsigned int j) { return Point(i, j, 0); });
+    return mesh;
+}
+
+static size_t n_features(const SurfaceMesh& mesh)
+{
+    auto efeature = mesh.get_edge_property<bool>("e:feature");
+    size_t n = 0;
+    for (auto e : mesh.edges())
+        n += efeature[e];
+    return n;
+}
+
+// the same features with and without cached normals
+TEST(SurfaceFeaturesAngleTest, geometry_cache)
+{
+    SurfaceMesh mesh = grid(8);
+    mesh.position(Vertex(40))[2] = 1;
+    SurfaceFeatures(mesh).detect_angle(25);
+    const size_t n = n_features(mesh);
+    // the six spokes of the raised vertex and its hexagonal link
+    EXPECT_EQ(n, 12u);
+
+    auto efeature = mesh.get_edge_property<bool>("e:feature");
+    std::vector<bool> features(efeature.vector());
+    SurfaceFeatures(mesh).clear();
+    GeometryCache cache(mesh);
+    SurfaceFeatures(mesh).detect_angle(25);
+    EXPECT_EQ(efeature.vector(), features);
+}
+
+// re-detection on modified faces matches a full detection
+TEST(SurfaceFeaturesAngleTest, incremental)
+{
+    SurfaceMesh mesh = grid(8);
+    SurfaceFeatures features(mesh);
+    features.detect_boundary();
+    features.detect_angle(25);
+    const size_t n_boundary = n_features(mesh);
+
+    auto vfeature = mesh.get_vertex_property<bool>("v:feature");
+    for (Scalar z : {1.0, 0.1, 0.0})
+    {
+        const Vertex v(40);
+        mesh.position(v)[2] = z;
+        std::vector<Face> faces;
+        for (auto f : mesh.faces(v))
+            faces.push_back(f);
+        features.detect_angle(25, faces);
+
+        SurfaceMesh full = grid(8);
+        full.position(v)[2] = z;
+        SurfaceFeatures(full).detect_boundary();
+        SurfaceFeatures(full).detect_angle(25);
+        auto full_vfeature = full.get_vertex_property<bool>("v:feature");
+
+        EXPECT_EQ(mesh.get_edge_property<bool>("e:feature").vector(),
+                  full.get_edge_property<bool>("e:feature").vector());
+        EXPECT_EQ(vfeature.vector(), full_vfeature.vector());
+        EXPECT_EQ(n_features(mesh) > n_boundary, z > 0.5);
+    }
+}
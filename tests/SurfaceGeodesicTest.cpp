@@ -10,6 +10,7 @@
 #include "gtest/gtest.h"
 
 #include <pmp/algorithms/SurfaceGeodesic.h>
+#include <pmp/Parallel.h>
 
 using namespace pmp;
 
@@ -96,3 +97,157 @@ TEST(SurfaceGeodesicTest, geodesic_maxnum)
     }
 }
 
+
+TEST(SurfaceGeodesicTest, geodesic_grid)
+{
+    // a flat 30 x 30 grid of triangles
+    SurfaceMesh mesh;
+    const unsigned int n = 30;
+    std::vector<Vertex> vertices;
+    for (unsigned int j = 0; j <= n; ++j)
+        for (unsigned int i = 0; i <= n; ++i)
+            vertices.push_back(mesh.add_vertex(Point(i, j, 0)));
+    for (unsigned int j = 0; j < n; ++j)
+        for (unsigned int i = 0; i < n; ++i)
+        {
+            auto v = j * (n + 1) + i;
+            mesh.add_triangle(vertices[v], vertices[v + 1],
+                              vertices[v + n + 2]);
+            mesh.add_triangle(vertices[v], vertices[v + n + 2],
+                              vertices[v + n + 1]);
+        }
+
+    // the front is processed in order of increasing distance
+    const Vertex seed = vertices[15 * (n + 1) + 15];
+    SurfaceGeodesic geodist(mesh);
+    std::vector<Vertex> neighbors;
+    unsigned int num = geodist.compute(std::vector<Vertex>{seed}, 10, INT_MAX,
+                                       &neighbors);
+    EXPECT_EQ(num, neighbors.size());
+    EXPECT_GT(num, 250u);
+    for (unsigned int i = 0; i + 1 < neighbors.size(); ++i)
+        EXPECT_LE(geodist(neighbors[i]), geodist(neighbors[i + 1]));
+
+    // distances in the plane are close to euclidean ones, but not exact
+    num = geodist.compute(std::vector<Vertex>{seed});
+    EXPECT_EQ(num, mesh.n_vertices() - 1);
+    for (auto v : mesh.vertices())
+    {
+        const Scalar d = distance(mesh.position(v), mesh.position(seed));
+        EXPECT_GE(geodist(v), d - 1e-4);
+        EXPECT_LE(geodist(v), 1.15 * d + 0.5);
+    }
+}
+
+TEST(SurfaceGeodesicTest, virtual_edges)
+{
+    // the obtuse triangle abc is unfolded into the triangle adb
+    SurfaceMesh mesh;
+    auto a = mesh.add_vertex(Point(-1, 0, 0));
+    auto b = mesh.add_vertex(Point(1, 0, 0));
+    auto c = mesh.add_vertex(Point(0, 0.1, 0));
+    auto d = mesh.add_vertex(Point(0, -1, 0));
+    mesh.add_triangle(a, b, c);
+    mesh.add_triangle(a, d, b);
+
+    std::vector<Scalar> distances;
+    {
+        SurfaceGeodesic geodist(mesh);
+        auto virtual_vertex =
+            mesh.get_halfedge_property<Vertex>("geodesic:virtual_vertex");
+        ASSERT_TRUE(virtual_vertex);
+        size_t n_virtual_edges = 0;
+        for (auto h : mesh.halfedges())
+            if (virtual_vertex[h].is_valid())
+                ++n_virtual_edges;
+        EXPECT_EQ(n_virtual_edges, size_t(1));
+
+        // the virtual edge cd is a straight path
+        geodist.compute(std::vector<Vertex>{d});
+        EXPECT_NEAR(geodist(c), 1.1, 1e-5);
+        for (auto v : mesh.vertices())
+            distances.push_back(geodist(v));
+
+        // the virtual edges are written with the mesh
+        EXPECT_TRUE(mesh.write("geodesic.pmp"));
+    }
+    EXPECT_FALSE(mesh.has_halfedge_property("geodesic:virtual_vertex"));
+
+    // and reused after reading them
+    IOFlags flags;
+    flags.custom_properties = {"geodesic:virtual_vertex",
+                               "geodesic:virtual_length"};
+    SurfaceMesh copy;
+    EXPECT_TRUE(copy.read("geodesic.pmp", flags));
+    EXPECT_TRUE(copy.has_halfedge_property("geodesic:virtual_vertex"));
+    {
+        SurfaceGeodesic geodist(copy);
+        geodist.compute(std::vector<Vertex>{d});
+        for (auto v : copy.vertices())
+            EXPECT_EQ(geodist(v), distances[v.idx()]);
+    }
+    EXPECT_TRUE(copy.has_halfedge_property("geodesic:virtual_vertex"));
+}
+
+TEST(SurfaceGeodesicTest, local_queries)
+{
+    SurfaceMesh mesh;
+    const unsigned int n = 30;
+    for (unsigned int j = 0; j <= n; ++j)
+        for (unsigned int i = 0; i <= n; ++i)
+            mesh.add_vertex(Point(i, j, 0));
+    for (unsigned int j = 0; j < n; ++j)
+        for (unsigned int i = 0; i < n; ++i)
+        {
+            const IndexType v = j * (n + 1) + i;
+            mesh.add_triangle(Vertex(v), Vertex(v + 1), Vertex(v + n + 2));
+            mesh.add_triangle(Vertex(v), Vertex(v + n + 2), Vertex(v + n + 1));
+        }
+
+    // a query only reaches the vertices within the maximum distance
+    SurfaceGeodesic geodist(mesh);
+    geodist.compute(std::vector<Vertex>{Vertex(0)}, 3);
+    size_t n_reached = 0;
+    for (auto v : mesh.vertices())
+        if (geodist(v) < FLT_MAX)
+            ++n_reached;
+    EXPECT_LT(n_reached, size_t(30));
+
+    // and the next query does not see them
+    const Vertex seed(15 * (n + 1) + 15);
+    geodist.compute(std::vector<Vertex>{seed}, 2);
+    EXPECT_EQ(geodist(Vertex(0)), FLT_MAX);
+
+    SurfaceGeodesic fresh(mesh);
+    fresh.compute(std::vector<Vertex>{seed}, 2);
+    for (auto v : mesh.vertices())
+        EXPECT_EQ(geodist(v), fresh(v));
+
+    // copies compute concurrently on the same mesh
+    const size_t n_queries = 64;
+    std::vector<Scalar> reached(n_queries);
+    parallel_for_chunks(
+        n_queries,
+        [&](size_t begin, size_t end) {
+            SurfaceGeodesic local(geodist);
+            for (size_t i = begin; i < end; ++i)
+            {
+                const Vertex v(IndexType(i * 11));
+                local.compute(std::vector<Vertex>{v}, 4);
+                reached[i] = 0;
+                for (auto vv : mesh.vertices())
+                    if (local(vv) < FLT_MAX)
+                        reached[i] += local(vv);
+            }
+        },
+        1);
+    for (size_t i = 0; i < n_queries; ++i)
+    {
+        fresh.compute(std::vector<Vertex>{Vertex(IndexType(i * 11))}, 4);
+        Scalar sum = 0;
+        for (auto v : mesh.vertices())
+            if (fresh(v) < FLT_MAX)
+                sum += fresh(v);
+        EXPECT_EQ(reached[i], sum);
+    }
+}
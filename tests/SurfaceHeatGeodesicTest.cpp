@@ -0,0 +1,95 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include "SurfaceMeshTest.h"
+
+#include <pmp/algorithms/SurfaceHeatGeodesic.h>
+
+#include <cfloat>
+
+using namespace pmp;
+
+class SurfaceHeatGeodesicTest : public SurfaceMeshTest
+{
+public:
+    // a flat n x n grid of triangles with its lower left corner at origin
+    std::vector<Vertex> add_triangle_grid(unsigned int n, const Point& origin)
+    {
+        return SurfaceMeshTest::add_triangle_grid(
+            mesh, n, [&](unsigned int i, unsigned int j) {
+                return origin + Point(i, j, 0);
+            });
+    }
+
+};
+
+TEST_F(SurfaceHeatGeodesicTest, grid)
+{
+    auto vertices = add_triangle_grid(30, Point(0, 0, 0));
+    const Vertex seed = vertices[15 * 31 + 15];
+
+    SurfaceHeatGeodesic geodist(mesh);
+    EXPECT_TRUE(geodist.is_valid());
+    EXPECT_TRUE(geodist.compute(std::vector<Vertex>{seed}));
+    EXPECT_EQ(geodist(seed), 0);
+
+    // distances in the plane are close to euclidean ones
+    for (auto v : mesh.vertices())
+    {
+        const Scalar d = distance(mesh.position(v), mesh.position(seed));
+        EXPECT_NEAR(geodist(v), d, 0.1 * d + 1.0);
+    }
+
+    EXPECT_FALSE(geodist.compute(std::vector<Vertex>()));
+}
+
+TEST_F(SurfaceHeatGeodesicTest, batched)
+{
+    auto vertices = add_triangle_grid(20, Point(0, 0, 0));
+
+    SurfaceHeatGeodesic geodist(mesh);
+    std::vector<std::vector<Vertex>> seeds = {
+        {vertices[0]}, {vertices[220]}, {vertices[20], vertices[420]}};
+    std::vector<std::vector<Scalar>> distances;
+    EXPECT_TRUE(geodist.compute(seeds, distances));
+    EXPECT_EQ(distances.size(), seeds.size());
+
+    // the same as solving one seed set at a time
+    for (size_t i = 0; i < seeds.size(); ++i)
+    {
+        EXPECT_TRUE(geodist.compute(seeds[i]));
+        for (auto v : mesh.vertices())
+            EXPECT_NEAR(distances[i][v.idx()], geodist(v), 1e-4);
+    }
+}
+
+TEST_F(SurfaceHeatGeodesicTest, components)
+{
+    auto first = add_triangle_grid(10, Point(0, 0, 0));
+    auto second = add_triangle_grid(10, Point(20, 0, 0));
+
+    SurfaceHeatGeodesic geodist(mesh);
+    EXPECT_TRUE(geodist.compute(std::vector<Vertex>{first[0]}));
+    for (auto v : first)
+        EXPECT_LT(geodist(v), FLT_MAX);
+    for (auto v : second)
+        EXPECT_EQ(geodist(v), FLT_MAX);
+    EXPECT_EQ(geodist(first[0]), 0);
+}
+
+TEST_F(SurfaceHeatGeodesicTest, polygon_mesh)
+{
+    mesh.add_quad(mesh.add_vertex(Point(0, 0, 0)),
+                  mesh.add_vertex(Point(1, 0, 0)),
+                  mesh.add_vertex(Point(1, 1, 0)),
+                  mesh.add_vertex(Point(0, 1, 0)));
+    SurfaceHeatGeodesic geodist(mesh);
+    EXPECT_FALSE(geodist.is_valid());
+    EXPECT_FALSE(geodist.compute(std::vector<Vertex>{Vertex(0)}));
+}
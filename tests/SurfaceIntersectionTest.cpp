@@ -0,0 +1,90 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include "SurfaceMeshTest.h"
+
+#include <pmp/algorithms/SurfaceIntersection.h>
+
+using namespace pmp;
+
+class SurfaceIntersectionTest : public SurfaceMeshTest
+{
+public:
+    // a triangulated 4 x 4 grid in the xy-plane
+    void add_triangle_grid()
+    {
+        add_grid(4);
+        mesh.triangulate();
+    }
+
+    // a triangle through the grid at (x,y)
+    static void add_spike(SurfaceMesh& m, Scalar x, Scalar y)
+    {
+        m.add_triangle(m.add_vertex(Point(x, y, -1)),
+                       m.add_vertex(Point(x + 0.3, y, 1)),
+                       m.add_vertex(Point(x, y + 0.3, 1)));
+    }
+};
+
+TEST_F(SurfaceIntersectionTest, self_intersections)
+{
+    add_triangle_grid();
+    EXPECT_TRUE(self_intersections(mesh).empty());
+
+    add_spike(mesh, 1.5, 2.5);
+    const auto pairs = self_intersections(mesh);
+    ASSERT_FALSE(pairs.empty());
+    const Face spike(mesh.n_faces() - 1);
+    auto intersecting = mesh.get_face_property<bool>("f:intersecting");
+    ASSERT_TRUE(intersecting);
+    size_t n_intersecting = 0;
+    for (auto f : mesh.faces())
+        n_intersecting += intersecting[f];
+    EXPECT_EQ(n_intersecting, pairs.size() + 1);
+    for (const auto& p : pairs)
+        EXPECT_EQ(p.second, spike);
+}
+
+TEST_F(SurfaceIntersectionTest, folded_neighbors)
+{
+    // a triangle folded over its neighbor sharing a vertex
+    const Vertex v0 = mesh.add_vertex(Point(0, 0, 0));
+    const Vertex v1 = mesh.add_vertex(Point(1, 0, 0));
+    const Vertex v2 = mesh.add_vertex(Point(0, 1, 0));
+    const Vertex v3 = mesh.add_vertex(Point(0.2, 0.2, -0.5));
+    const Vertex v4 = mesh.add_vertex(Point(0.3, 0.4, 0.5));
+    mesh.add_triangle(v0, v1, v2);
+    mesh.add_triangle(v0, v3, v4);
+    EXPECT_EQ(self_intersections(mesh).size(), 1u);
+
+    // touching only in the shared vertex
+    mesh.position(v3) = Point(-1, 0, 0.5);
+    mesh.position(v4) = Point(-1, -1, 0.5);
+    EXPECT_TRUE(self_intersections(mesh).empty());
+}
+
+TEST_F(SurfaceIntersectionTest, two_meshes)
+{
+    add_triangle_grid();
+    SurfaceMesh other;
+    add_spike(other, 10, 10);
+    EXPECT_TRUE(intersections(mesh, other).empty());
+
+    add_spike(other, 2.5, 0.5);
+    const auto pairs = intersections(mesh, other);
+    ASSERT_FALSE(pairs.empty());
+    auto intersecting = other.get_face_property<bool>("f:intersecting");
+    EXPECT_FALSE(intersecting[Face(0)]);
+    EXPECT_TRUE(intersecting[Face(1)]);
+    for (const auto& p : pairs)
+    {
+        EXPECT_EQ(p.second, Face(1));
+        EXPECT_TRUE(mesh.get_face_property<bool>("f:intersecting")[p.first]);
+    }
+}
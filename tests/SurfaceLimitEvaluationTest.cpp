@@ -0,0 +1,321 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include "gtest/gtest.h"
+
+#include <pmp/algorithms/SurfaceLimitEvaluation.h>
+#include <pmp/algorithms/SurfaceSubdivision.h>
+
+#include <algorithm>
+
+using namespace pmp;
+
+typedef SurfaceLimitEvaluation::Scheme Scheme;
+
+// a torus of n x m quads, split into triangles if requested
+static SurfaceMesh torus(int n, int m, bool triangles)
+{
+    SurfaceMesh mesh;
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < m; ++j)
+        {
+            const Scalar a = 2 * M_PI * i / n, b = 2 * M_PI * j / m;
+            mesh.add_vertex(Point((3 + cos(b)) * cos(a),
+                                  (3 + cos(b)) * sin(a), sin(b)));
+        }
+
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < m; ++j)
+        {
+            const Vertex v0(i * m + j), v1(((i + 1) % n) * m + j),
+                v2(((i + 1) % n) * m + (j + 1) % m), v3(i * m + (j + 1) % m);
+            if (triangles)
+            {
+                mesh.add_triangle(v0, v1, v2);
+                mesh.add_triangle(v0, v2, v3);
+            }
+            else
+                mesh.add_quad(v0, v1, v2, v3);
+        }
+    return mesh;
+}
+
+static SurfaceMesh icosahedron()
+{
+    SurfaceMesh mesh;
+    const Scalar t = (1 + sqrt(5.0)) / 2;
+    const Scalar points[12][3] = {
+        {-1, t, 0}, {1, t, 0},  {-1, -t, 0}, {1, -t, 0},
+        {0, -1, t}, {0, 1, t},  {0, -1, -t}, {0, 1, -t},
+        {t, 0, -1}, {t, 0, 1},  {-t, 0, -1}, {-t, 0, 1}};
+    const int faces[20][3] = {
+        {0, 11, 5}, {0, 5, 1},  {0, 1, 7},   {0, 7, 10}, {0, 10, 11},
+        {1, 5, 9},  {5, 11, 4}, {11, 10, 2}, {10, 7, 6}, {7, 1, 8},
+        {3, 9, 4},  {3, 4, 2},  {3, 2, 6},   {3, 6, 8},  {3, 8, 9},
+        {4, 9, 5},  {2, 4, 11}, {6, 2, 10},  {8, 6, 7},  {9, 8, 1}};
+    for (auto& p : points)
+        mesh.add_vertex(Point(p[0], p[1], p[2]));
+    for (auto& f : faces)
+        mesh.add_triangle(Vertex(f[0]), Vertex(f[1]), Vertex(f[2]));
+    return mesh;
+}
+
+static SurfaceMesh octahedron()
+{
+    SurfaceMesh mesh;
+    const Scalar points[6][3] = {{1, 0, 0},  {-1, 0, 0}, {0, 1, 0},
+                                 {0, -1, 0}, {0, 0, 1},  {0, 0, -1}};
+    const int faces[8][3] = {{0, 2, 4}, {2, 1, 4}, {1, 3, 4}, {3, 0, 4},
+                             {2, 0, 5}, {1, 2, 5}, {3, 1, 5}, {0, 3, 5}};
+    for (auto& p : points)
+        mesh.add_vertex(Point(p[0], p[1], p[2]));
+    for (auto& f : faces)
+        mesh.add_triangle(Vertex(f[0]), Vertex(f[1]), Vertex(f[2]));
+    return mesh;
+}
+
+static SurfaceMesh hexahedron()
+{
+    SurfaceMesh mesh;
+    for (int i = 0; i < 8; ++i)
+        mesh.add_vertex(Point(i & 1, (i >> 1) & 1, (i >> 2) & 1));
+    const int faces[6][4] = {{0, 2, 3, 1}, {4, 5, 7, 6}, {0, 1, 5, 4},
+                             {2, 6, 7, 3}, {0, 4, 6, 2}, {1, 3, 7, 5}};
+    for (auto& f : faces)
+        mesh.add_quad(Vertex(f[0]), Vertex(f[1]), Vertex(f[2]), Vertex(f[3]));
+    return mesh;
+}
+
+// closed test meshes with regular and extraordinary vertices
+static std::vector<SurfaceMesh> meshes(Scheme scheme)
+{
+    std::vector<SurfaceMesh> result;
+    if (scheme == SurfaceLimitEvaluation::Loop)
+    {
+        result.push_back(octahedron());
+        result.push_back(icosahedron());
+        result.push_back(torus(8, 6, true));
+        SurfaceMesh mesh = octahedron();
+        SurfaceSubdivision(mesh).loop();
+        result.push_back(mesh);
+    }
+    else
+    {
+        result.push_back(hexahedron());
+        result.push_back(torus(8, 6, false));
+        // valences 3, 4, and 5
+        SurfaceMesh mesh = icosahedron();
+        SurfaceSubdivision(mesh).catmull_clark();
+        result.push_back(mesh);
+    }
+    return result;
+}
+
+// the parameters of the i-th vertex of a face
+static TexCoord corner(const SurfaceMesh& mesh, Face f, Vertex v)
+{
+    const TexCoord corners[4] = {TexCoord(0, 0), TexCoord(1, 0),
+                                 TexCoord(mesh.valence(f) == 3 ? 0 : 1, 1),
+                                 TexCoord(0, 1)};
+    int i = 0;
+    for (auto vv : mesh.vertices(f))
+    {
+        if (vv == v)
+            return corners[i];
+        ++i;
+    }
+    return TexCoord(-1, -1);
+}
+
+static void subdivide(SurfaceMesh& mesh, Scheme scheme)
+{
+    if (scheme == SurfaceLimitEvaluation::Loop)
+        SurfaceSubdivision(mesh).loop();
+    else
+        SurfaceSubdivision(mesh).catmull_clark();
+}
+
+const Scheme schemes[2] = {SurfaceLimitEvaluation::Loop,
+                           SurfaceLimitEvaluation::CatmullClark};
+
+// both faces of an edge evaluate to the same limit on it
+TEST(SurfaceLimitEvaluationTest, continuity)
+{
+    for (auto scheme : schemes)
+        for (auto& mesh : meshes(scheme))
+        {
+            SurfaceLimitEvaluation limit(mesh, scheme);
+            for (auto h : mesh.halfedges())
+            {
+                const Face f = mesh.face(h);
+                const Face g = mesh.face(mesh.opposite_halfedge(h));
+                const Vertex v0 = mesh.from_vertex(h);
+                const Vertex v1 = mesh.to_vertex(h);
+                for (Scalar t : {0.0, 0.1, 0.37, 0.5, 0.8, 1.0})
+                {
+                    Point p, q;
+                    Normal m, n;
+                    EXPECT_TRUE(limit.evaluate(
+                        f, (1 - t) * corner(mesh, f, v0) +
+                               t * corner(mesh, f, v1), p, m));
+                    EXPECT_TRUE(limit.evaluate(
+                        g, (1 - t) * corner(mesh, g, v0) +
+                               t * corner(mesh, g, v1), q, n));
+                    EXPECT_LT(norm(p - q), 1e-5);
+                    EXPECT_GT(dot(m, n), 0.9999);
+                }
+            }
+        }
+}
+
+// the limit does not change under subdivision
+TEST(SurfaceLimitEvaluationTest, subdivision_invariance)
+{
+    for (auto scheme : schemes)
+        for (auto& mesh : meshes(scheme))
+        {
+            SurfaceMesh refined = mesh;
+            subdivide(refined, scheme);
+            SurfaceLimitEvaluation coarse_limit(mesh, scheme);
+            SurfaceLimitEvaluation fine_limit(refined, scheme);
+
+            // the old vertices keep their indices, the new vertices on the
+            // edges are connected to the old end points
+            for (auto v : refined.vertices())
+            {
+                std::vector<Vertex> old;
+                for (auto vv : refined.vertices(v))
+                    if (vv.idx() < mesh.n_vertices())
+                        old.push_back(vv);
+
+                Face f;
+                TexCoord uv;
+                if (v.idx() < mesh.n_vertices())
+                {
+                    f = mesh.face(mesh.halfedge(v));
+                    uv = corner(mesh, f, v);
+                }
+                else if (old.size() == 2)
+                {
+                    auto h = mesh.find_halfedge(old[0], old[1]);
+                    ASSERT_TRUE(h.is_valid());
+                    f = mesh.face(h);
+                    uv = 0.5 * (corner(mesh, f, old[0]) +
+                                corner(mesh, f, old[1]));
+                }
+                else
+                    continue;
+
+                const Face g = refined.face(refined.halfedge(v));
+                Point p, q;
+                Normal m, n;
+                EXPECT_TRUE(coarse_limit.evaluate(f, uv, p, m));
+                EXPECT_TRUE(fine_limit.evaluate(
+                    g, corner(refined, g, v), q, n));
+                EXPECT_LT(norm(p - q), 1e-5);
+                EXPECT_GT(dot(m, n), 0.9999);
+            }
+        }
+}
+
+// the vertices of repeated subdivision converge to the limit
+TEST(SurfaceLimitEvaluationTest, convergence)
+{
+    for (auto scheme : schemes)
+        for (auto& mesh : meshes(scheme))
+        {
+            SurfaceMesh refined = mesh;
+            for (int i = 0; i < 5; ++i)
+                subdivide(refined, scheme);
+
+            std::vector<Face> faces;
+            std::vector<TexCoord> parameters;
+            for (auto v : mesh.vertices())
+            {
+                faces.push_back(mesh.face(mesh.halfedge(v)));
+                parameters.push_back(corner(mesh, faces.back(), v));
+            }
+
+            std::vector<Point> positions;
+            std::vector<Normal> normals;
+            SurfaceLimitEvaluation limit(mesh, scheme);
+            EXPECT_TRUE(limit.evaluate(faces, parameters, positions, normals));
+            ASSERT_EQ(positions.size(), mesh.n_vertices());
+
+            const Scalar length = distance(mesh.position(Vertex(0)),
+                                           mesh.position(Vertex(1)));
+            for (auto v : mesh.vertices())
+            {
+                const Point& p = refined.position(v);
+                EXPECT_LT(norm(positions[v.idx()] - p), 0.02 * length);
+
+                // orthogonal to the refined edges
+                for (auto vv : refined.vertices(v))
+                {
+                    const Point d = normalize(refined.position(vv) - p);
+                    EXPECT_LT(std::abs(dot(normals[v.idx()], d)), 0.05);
+                }
+            }
+        }
+}
+
+// normals are orthogonal to the surface and point outwards
+TEST(SurfaceLimitEvaluationTest, normals)
+{
+    for (auto scheme : schemes)
+    {
+        SurfaceMesh mesh = meshes(scheme)[0];
+        SurfaceLimitEvaluation limit(mesh, scheme);
+        const Scalar eps = 1e-3;
+        for (auto f : mesh.faces())
+            for (Scalar u : {0.0, 0.1, 0.3, 0.45})
+                for (Scalar v : {0.0, 0.05, 0.3, 0.5})
+                {
+                    Point p, pu, pv;
+                    Normal n, nn;
+                    limit.evaluate(f, TexCoord(u, v), p, n);
+                    limit.evaluate(f, TexCoord(u + eps, v), pu, nn);
+                    limit.evaluate(f, TexCoord(u, v + eps), pv, nn);
+                    EXPECT_NEAR(norm(n), 1, 1e-5);
+                    EXPECT_LT(std::abs(dot(n, normalize(pu - p))), 1e-2);
+                    EXPECT_LT(std::abs(dot(n, normalize(pv - p))), 1e-2);
+                    EXPECT_GT(dot(n, normalize(cross(pu - p, pv - p))),
+                              0.99);
+
+                    // convex and centered at (0.5, 0.5, 0.5) or the origin
+                    const Point center = scheme == SurfaceLimitEvaluation::Loop
+                                             ? Point(0, 0, 0)
+                                             : Point(0.5, 0.5, 0.5);
+                    EXPECT_GT(dot(n, p - center), 0);
+                }
+    }
+}
+
+// faces at the boundary give the face point, the wrong face type nothing
+TEST(SurfaceLimitEvaluationTest, unsupported)
+{
+    SurfaceMesh mesh = octahedron();
+    mesh.delete_vertex(Vertex(5));
+    mesh.garbage_collection();
+
+    SurfaceLimitEvaluation limit(mesh);
+    const Face f(0);
+    Point p;
+    Normal n;
+    EXPECT_FALSE(limit.evaluate(f, TexCoord(0.25, 0.5), p, n));
+    auto vertices = mesh.vertices(f);
+    auto v = vertices.begin();
+    const Point a = mesh.position(*v), b = mesh.position(*++v),
+                c = mesh.position(*++v);
+    EXPECT_LT(norm(p - (0.25 * a + 0.25 * b + 0.5 * c)), 1e-6);
+    EXPECT_LT(norm(n - normalize(cross(b - a, c - a))), 1e-6);
+
+    SurfaceLimitEvaluation quads(mesh, SurfaceLimitEvaluation::CatmullClark);
+    EXPECT_FALSE(quads.evaluate(f, TexCoord(0.25, 0.5), p, n));
+}
@@ -0,0 +1,63 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include "SurfaceMeshTest.h"
+
+#include <pmp/SurfaceMeshAsync.h>
+
+using namespace pmp;
+
+class SurfaceMeshAsyncTest : public SurfaceMeshTest
+{
+};
+
+TEST_F(SurfaceMeshAsyncTest, write_then_read)
+{
+    add_grid(20);
+    auto write = write_async(mesh, "async.off");
+
+    // the job wrote a snapshot
+    mesh.clear();
+    add_triangle();
+
+    // jobs run in order, so the file is complete when it is read
+    auto read = read_async("async.off");
+    EXPECT_TRUE(read->wait());
+    EXPECT_TRUE(write->is_ready());
+    EXPECT_TRUE(write->wait());
+    EXPECT_EQ(read->mesh().n_vertices(), size_t(441));
+    EXPECT_EQ(read->mesh().n_faces(), size_t(400));
+
+    SurfaceMesh result = std::move(read->mesh());
+    EXPECT_EQ(result.n_faces(), size_t(400));
+}
+
+TEST_F(SurfaceMeshAsyncTest, failure)
+{
+    auto read = read_async("does_not_exist.off");
+    EXPECT_FALSE(read->wait());
+    EXPECT_FALSE(read->wait());
+
+    add_triangle();
+    auto write = write_async(mesh, "async.unknown");
+    EXPECT_FALSE(write->wait());
+}
+
+TEST_F(SurfaceMeshAsyncTest, cancel)
+{
+    add_grid(20);
+    mesh.write("cancel.off");
+
+    auto read = read_async("cancel.off");
+    read->cancel();
+    EXPECT_TRUE(read->is_cancelled());
+    EXPECT_FALSE(read->wait());
+    EXPECT_TRUE(read->is_ready());
+    EXPECT_EQ(read->mesh().n_vertices(), size_t(0));
+}
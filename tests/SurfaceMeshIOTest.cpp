@@ -9,9 +9,23 @@
 
 #include "SurfaceMeshTest.h"
 
+#include <pmp/SurfaceMeshIO.h>
 #include <pmp/algorithms/SurfaceNormals.h>
+#include <pmp/Parallel.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
 #include <vector>
 
+#ifdef PMP_HAS_ZLIB
+#include <zlib.h>
+#endif
+
 using namespace pmp;
 
 class SurfaceMeshIOTest : public SurfaceMeshTest
@@ -32,6 +46,271 @@ TEST_F(SurfaceMeshIOTest, poly_io)
     EXPECT_FALSE(mesh.write("testpolyly"));
 }
 
+// write mesh to a .pmp file using index type I and scalar type S, or
+// without the header recording them
+template <class I, class S>
+void write_pmp_with(const SurfaceMesh& mesh, const char* filename,
+                    bool legacy = false)
+{
+    std::ofstream out(filename, std::ios::binary);
+    if (legacy)
+    {
+        const unsigned int n[3] = {(unsigned int)mesh.n_vertices(),
+                                   (unsigned int)mesh.n_edges(),
+                                   (unsigned int)mesh.n_faces()};
+        const bool has_htex = false;
+        out.write((const char*)n, sizeof(n));
+        out.write((const char*)&has_htex, sizeof(bool));
+    }
+    else
+    {
+        const unsigned char header[8] = {'p', 'm', 'p', 0xff, sizeof(I),
+                                         sizeof(S),  0,   0};
+        out.write((const char*)header, 8);
+        const uint64_t n[3] = {mesh.n_vertices(), mesh.n_edges(),
+                               mesh.n_faces()};
+        out.write((const char*)n, sizeof(n));
+    }
+
+    auto index = [&](Handle h) {
+        const I i = h.is_valid() ? I(h.idx()) : std::numeric_limits<I>::max();
+        out.write((const char*)&i, sizeof(I));
+    };
+    for (auto v : mesh.vertices())
+        index(mesh.halfedge(v));
+    for (auto h : mesh.halfedges())
+    {
+        index(mesh.face(h));
+        index(mesh.to_vertex(h));
+        index(mesh.next_halfedge(h));
+        index(mesh.prev_halfedge(h));
+    }
+    for (auto f : mesh.faces())
+        index(mesh.halfedge(f));
+    for (auto v : mesh.vertices())
+        for (int i = 0; i < 3; ++i)
+        {
+            const S s = S(mesh.position(v)[i]);
+            out.write((const char*)&s, sizeof(S));
+        }
+}
+
+TEST_F(SurfaceMeshIOTest, pmp_widths)
+{
+    add_triangle();
+    SurfaceMesh reference = mesh;
+
+    // files written with other index and scalar widths are converted
+    write_pmp_with<uint32_t, float>(reference, "test32.pmp");
+    write_pmp_with<uint64_t, double>(reference, "test64.pmp");
+
+    // files without header use the widths of this build
+    write_pmp_with<IndexType, Scalar>(reference, "test_legacy.pmp", true);
+
+    for (auto filename : {"test32.pmp", "test64.pmp", "test_legacy.pmp"})
+    {
+        mesh.clear();
+        EXPECT_TRUE(mesh.read(filename));
+        EXPECT_EQ(mesh.n_vertices(), size_t(3));
+        EXPECT_EQ(mesh.n_faces(), size_t(1));
+        for (auto v : mesh.vertices())
+        {
+            EXPECT_EQ(mesh.position(v), reference.position(v));
+            EXPECT_EQ(mesh.halfedge(v), reference.halfedge(v));
+        }
+        for (auto h : mesh.halfedges())
+        {
+            EXPECT_EQ(mesh.face(h), reference.face(h));
+            EXPECT_EQ(mesh.next_halfedge(h), reference.next_halfedge(h));
+        }
+        EXPECT_TRUE(mesh.is_boundary(Halfedge(1)));
+    }
+}
+
+TEST_F(SurfaceMeshIOTest, pmp_properties)
+{
+    add_quad();
+    auto curv = mesh.add_vertex_property<Scalar>("v:curv");
+    auto feature = mesh.add_edge_property<bool>("e:feature");
+    auto uv = mesh.add_halfedge_property<TexCoord>("h:uv");
+    auto parent = mesh.add_face_property<Face>("f:parent");
+    auto id = mesh.add_object_property<int>("g:id");
+    auto unsupported = mesh.add_vertex_property<std::string>("v:name");
+    for (auto v : mesh.vertices())
+        curv[v] = Scalar(0.5) * v.idx();
+    for (auto e : mesh.edges())
+        feature[e] = e.idx() % 2;
+    for (auto h : mesh.halfedges())
+        uv[h] = TexCoord(h.idx(), 1);
+    parent[Face(0)] = Face(0);
+    id[0] = 42;
+    unsupported[v0] = "v0";
+    mesh.write("test_properties.pmp");
+
+    // all supported properties are restored
+    SurfaceMesh copy;
+    EXPECT_TRUE(copy.read("test_properties.pmp"));
+    auto curv2 = copy.get_vertex_property<Scalar>("v:curv");
+    auto feature2 = copy.get_edge_property<bool>("e:feature");
+    auto uv2 = copy.get_halfedge_property<TexCoord>("h:uv");
+    auto parent2 = copy.get_face_property<Face>("f:parent");
+    auto id2 = copy.get_object_property<int>("g:id");
+    ASSERT_TRUE(curv2 && feature2 && uv2 && parent2 && id2);
+    for (auto v : mesh.vertices())
+    {
+        EXPECT_EQ(curv2[v], curv[v]);
+    }
+    for (auto e : mesh.edges())
+    {
+        EXPECT_EQ(feature2[e], feature[e]);
+    }
+    for (auto h : mesh.halfedges())
+    {
+        EXPECT_EQ(uv2[h], uv[h]);
+    }
+    EXPECT_EQ(parent2[Face(0)], Face(0));
+    EXPECT_EQ(id2[0], 42);
+    EXPECT_FALSE(copy.has_vertex_property("v:name"));
+
+    // only the requested properties are loaded
+    IOFlags flags;
+    flags.custom_properties.push_back("v:curv");
+    EXPECT_TRUE(copy.read("test_properties.pmp", flags));
+    EXPECT_TRUE(copy.has_vertex_property("v:curv"));
+    EXPECT_FALSE(copy.has_edge_property("e:feature"));
+    EXPECT_FALSE(copy.has_halfedge_property("h:uv"));
+    EXPECT_EQ(copy.n_faces(), size_t(1));
+
+    flags = IOFlags();
+    flags.use_custom_properties = false;
+    EXPECT_TRUE(copy.read("test_properties.pmp", flags));
+    EXPECT_FALSE(copy.has_vertex_property("v:curv"));
+}
+
+TEST_F(SurfaceMeshIOTest, pmp_compact_properties)
+{
+    add_quad();
+    auto flag = mesh.add_vertex_property<Flag>("v:flag");
+    auto quality = mesh.add_face_property<std::uint8_t>("f:quality");
+    auto curv = mesh.add_vertex_property<std::uint16_t>("v:curv16");
+    flag[v1] = true;
+    quality[f0] = 200;
+    curv[v2] = 60000;
+    mesh.write("test_compact.pmp");
+
+    SurfaceMesh copy;
+    EXPECT_TRUE(copy.read("test_compact.pmp"));
+    auto flag2 = copy.get_vertex_property<Flag>("v:flag");
+    auto quality2 = copy.get_face_property<std::uint8_t>("f:quality");
+    auto curv2 = copy.get_vertex_property<std::uint16_t>("v:curv16");
+    ASSERT_TRUE(flag2 && quality2 && curv2);
+    EXPECT_FALSE(flag2[v0]);
+    EXPECT_TRUE(flag2[v1]);
+    EXPECT_EQ(quality2[f0], 200);
+    EXPECT_EQ(curv2[v2], 60000);
+
+    // octahedral normals and 16-bit texture coordinates are stored as is
+    auto normals = mesh.add_vertex_property<OctNormal>("v:normal");
+    auto tex = mesh.add_halfedge_property<TexCoord16>("h:tex");
+    for (auto v : mesh.vertices())
+        normals[v] = Normal(v.idx(), 1, -1);
+    for (auto h : mesh.halfedges())
+        tex[h] = TexCoord(Scalar(h.idx()) / 8, 0.5);
+    mesh.write("test_compact.pmp");
+
+    EXPECT_TRUE(copy.read("test_compact.pmp"));
+    auto normals2 = copy.get_vertex_property<OctNormal>("v:normal");
+    auto tex2 = copy.get_halfedge_property<TexCoord16>("h:tex");
+    ASSERT_TRUE(normals2 && tex2);
+    for (auto v : mesh.vertices())
+    {
+        EXPECT_EQ(normals2[v][0], normals[v][0]);
+        EXPECT_EQ(normals2[v][1], normals[v][1]);
+    }
+    for (auto h : mesh.halfedges())
+    {
+        EXPECT_EQ(TexCoord(tex2[h]), TexCoord(tex[h]));
+    }
+}
+
+TEST_F(SurfaceMeshIOTest, obj_parser)
+{
+    // comments, CRLF line endings, relative indices, long lines
+    std::ofstream("test_parser.obj")
+        << "# comment\r\n"
+        << "v 0 0 0\r\n"
+        << "v 1.5e0 0 0\r\n"
+        << "  v 1 1 -0.0  \r\n"
+        << "v  0 1 0 " << std::string(300, ' ') << "\r\n"
+        << "vt 0 0\nvt 1.5 0\nvt 1 1\nvt 0 1\n"
+        << "vn 0 0 1\n"
+        << "o object\n"
+        << "f -4/-4/1 -3/-3/1 -2/-2/1 -1/-1/1\n";
+    EXPECT_TRUE(mesh.read("test_parser.obj"));
+    EXPECT_EQ(mesh.n_vertices(), size_t(4));
+    EXPECT_EQ(mesh.n_faces(), size_t(1));
+    EXPECT_EQ(mesh.position(Vertex(1)), Point(1.5, 0, 0));
+    auto tex = mesh.get_halfedge_property<TexCoord>("h:tex");
+    ASSERT_TRUE(tex);
+    for (auto h : mesh.halfedges(Face(0)))
+    {
+        EXPECT_EQ(tex[h], TexCoord(mesh.position(mesh.to_vertex(h))[0],
+                                   mesh.position(mesh.to_vertex(h))[1]));
+    }
+}
+
+TEST_F(SurfaceMeshIOTest, off_parser)
+{
+    std::ofstream("test_parser.off") << "COFF\n"
+                                     << "# comment\n"
+                                     << "3 1 0\n"
+                                     << "0 0 0 255 0 0\n"
+                                     << "\n"
+                                     << "1e0 0 0 0 1 0\n"
+                                     << "0 .1E1 0 0 0 1\n"
+                                     << "3 0 1 2\n";
+    EXPECT_TRUE(mesh.read("test_parser.off"));
+    EXPECT_EQ(mesh.n_vertices(), size_t(3));
+    EXPECT_EQ(mesh.n_faces(), size_t(1));
+    EXPECT_EQ(mesh.position(Vertex(2)), Point(0, 1, 0));
+    auto colors = mesh.get_vertex_property<Color>("v:color");
+    ASSERT_TRUE(colors);
+    EXPECT_EQ(colors[Vertex(0)], Color(1, 0, 0));
+    EXPECT_EQ(colors[Vertex(1)], Color(0, 1, 0));
+}
+
+TEST_F(SurfaceMeshIOTest, parallel_parser)
+{
+    // large enough to be split into several parts
+    add_grid(250);
+    for (auto v : mesh.vertices())
+        mesh.position(v) += Point(0.1234567, 1e-3, 0);
+    mesh.write("test_parallel.obj");
+    mesh.write("test_parallel.off");
+
+    for (auto filename : {"test_parallel.obj", "test_parallel.off"})
+    {
+        SurfaceMesh serial, parallel;
+        set_num_threads(1);
+        EXPECT_TRUE(serial.read(filename));
+        set_num_threads(4);
+        EXPECT_TRUE(parallel.read(filename));
+        set_num_threads(0);
+
+        EXPECT_EQ(serial.n_vertices(), mesh.n_vertices());
+        EXPECT_EQ(parallel.n_vertices(), mesh.n_vertices());
+        EXPECT_EQ(parallel.n_faces(), mesh.n_faces());
+        for (auto v : mesh.vertices())
+        {
+            EXPECT_EQ(parallel.position(v), serial.position(v));
+        }
+        for (auto f : mesh.faces())
+        {
+            EXPECT_EQ(parallel.halfedge(f), serial.halfedge(f));
+        }
+    }
+}
+
 TEST_F(SurfaceMeshIOTest, obj_io)
 {
     add_triangle();
@@ -132,6 +411,503 @@ TEST_F(SurfaceMeshIOTest, ply_io_binary)
     EXPECT_EQ(mesh.n_faces(), size_t(1));
 }
 
+TEST_F(SurfaceMeshIOTest, ply_attributes)
+{
+    add_quad();
+    mesh.add_vertex(Point(2, 0, 0));
+    mesh.add_triangle(v1, Vertex(4), v2);
+    auto normals = mesh.vertex_property<Normal>("v:normal");
+    auto colors = mesh.vertex_property<Color>("v:color");
+    auto quality = mesh.vertex_property<Scalar>("v:quality");
+    auto texcoords = mesh.vertex_property<TexCoord>("v:tex");
+    auto face_colors = mesh.face_property<Color>("f:color");
+    for (auto v : mesh.vertices())
+    {
+        normals[v] = Normal(0, 0, 1);
+        colors[v] = Color(1, 0, 0.2 * v.idx());
+        quality[v] = 0.5 * v.idx();
+        texcoords[v] = TexCoord(mesh.position(v)[0], mesh.position(v)[1]);
+    }
+    face_colors[Face(0)] = Color(0, 1, 0);
+    face_colors[Face(1)] = Color(0, 0, 1);
+
+    IOFlags flags;
+    flags.use_vertex_normals = true;
+    flags.use_vertex_colors = true;
+    flags.use_vertex_quality = true;
+    flags.use_vertex_texcoords = true;
+    flags.use_face_colors = true;
+
+    for (int binary = 0; binary < 2; ++binary)
+    {
+        flags.use_binary = binary;
+        EXPECT_TRUE(mesh.write("attributes.ply", flags));
+
+        SurfaceMesh ply;
+        EXPECT_TRUE(ply.read("attributes.ply"));
+        ASSERT_EQ(ply.n_vertices(), size_t(5));
+        ASSERT_EQ(ply.n_faces(), size_t(2));
+        EXPECT_EQ(ply.valence(Face(0)), size_t(4));
+
+        auto n = ply.get_vertex_property<Normal>("v:normal");
+        auto c = ply.get_vertex_property<Color>("v:color");
+        auto q = ply.get_vertex_property<Scalar>("v:quality");
+        auto t = ply.get_vertex_property<TexCoord>("v:tex");
+        auto fc = ply.get_face_property<Color>("f:color");
+        ASSERT_TRUE(n && c && q && t && fc);
+        for (auto v : ply.vertices())
+        {
+            EXPECT_EQ(ply.position(v), mesh.position(v));
+            EXPECT_EQ(n[v], normals[v]);
+            EXPECT_NEAR(c[v][2], colors[v][2], 1.0 / 255);
+            EXPECT_EQ(q[v], quality[v]);
+            EXPECT_EQ(t[v], texcoords[v]);
+        }
+        EXPECT_EQ(fc[Face(0)], Color(0, 1, 0));
+        EXPECT_EQ(fc[Face(1)], Color(0, 0, 1));
+    }
+}
+
+TEST_F(SurfaceMeshIOTest, ply_big_endian)
+{
+    // a triangle with double coordinates, a skipped vertex property, and
+    // an extra element, stored in big-endian byte order
+    std::ofstream ofs("big_endian.ply", std::ios::binary);
+    ofs << "ply\r\nformat binary_big_endian 1.0\r\n"
+           "comment written by hand\r\n"
+           "element vertex 3\r\nproperty double x\r\nproperty double y\r\n"
+           "property double z\r\nproperty ushort flags\r\n"
+           "element face 1\r\n"
+           "property list uchar uint vertex_indices\r\n"
+           "element edge 1\r\nproperty int vertex1\r\nproperty int vertex2\r\n"
+           "end_header\r\n";
+    auto write_big_endian = [&](const void* data, size_t size) {
+        for (size_t i = 0; i < size; ++i)
+            ofs.put(((const char*)data)[size - 1 - i]);
+    };
+    const double coordinates[] = {0, 0, 0, 1, 0, 0, 0, 1, 0};
+    for (int i = 0; i < 3; ++i)
+    {
+        for (int j = 0; j < 3; ++j)
+            write_big_endian(&coordinates[3 * i + j], sizeof(double));
+        const uint16_t flags = 7;
+        write_big_endian(&flags, sizeof(flags));
+    }
+    ofs.put(3);
+    for (uint32_t i = 0; i < 3; ++i)
+        write_big_endian(&i, sizeof(i));
+    for (int32_t i = 0; i < 2; ++i)
+        write_big_endian(&i, sizeof(i));
+    ofs.close();
+
+    EXPECT_TRUE(mesh.read("big_endian.ply"));
+    ASSERT_EQ(mesh.n_vertices(), size_t(3));
+    ASSERT_EQ(mesh.n_faces(), size_t(1));
+    EXPECT_EQ(mesh.position(Vertex(1)), Point(1, 0, 0));
+    EXPECT_EQ(mesh.position(Vertex(2)), Point(0, 1, 0));
+
+    // truncated data is reported
+    std::ofstream truncated("truncated.ply", std::ios::binary);
+    truncated << "ply\nformat binary_little_endian 1.0\nelement vertex 3\n"
+                 "property float x\nproperty float y\nproperty float z\n"
+                 "end_header\n";
+    truncated.write("abcd", 4);
+    truncated.close();
+    EXPECT_FALSE(mesh.read("truncated.ply"));
+}
+
+TEST_F(SurfaceMeshIOTest, pmpz_io)
+{
+    add_grid(8);
+    mesh.add_vertex(Point(-1, 2, 3));
+    SurfaceNormals::compute_vertex_normals(mesh);
+
+    IOFlags flags;
+    flags.use_vertex_normals = true;
+    EXPECT_TRUE(mesh.write("test.pmpz", flags));
+
+    SurfaceMesh decoded;
+    EXPECT_TRUE(decoded.read("test.pmpz"));
+    EXPECT_EQ(decoded.n_vertices(), mesh.n_vertices());
+    EXPECT_EQ(decoded.n_faces(), mesh.n_faces());
+    EXPECT_EQ(decoded.n_edges(), mesh.n_edges());
+    auto dnormals = decoded.get_vertex_property<Normal>("v:normal");
+    ASSERT_TRUE(dnormals);
+
+    // the vertex order is not preserved, compare sorted attributes
+    auto sorted = [](const SurfaceMesh& m) {
+        auto normals = m.get_vertex_property<Normal>("v:normal");
+        std::vector<std::vector<Scalar>> values;
+        for (auto v : m.vertices())
+        {
+            const Point& p = m.position(v);
+            const Normal& n = normals[v];
+            values.push_back({p[0], p[1], p[2], n[0], n[1], n[2],
+                              Scalar(m.valence(v))});
+        }
+        std::sort(values.begin(), values.end());
+        return values;
+    };
+    EXPECT_EQ(sorted(decoded), sorted(mesh));
+
+    // truncated files are rejected
+    std::ifstream ifs("test.pmpz", std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(ifs)),
+                     std::istreambuf_iterator<char>());
+    std::ofstream ofs("test_truncated.pmpz", std::ios::binary);
+    ofs.write(data.data(), data.size() / 2);
+    ofs.close();
+    EXPECT_FALSE(decoded.read("test_truncated.pmpz"));
+}
+
+TEST_F(SurfaceMeshIOTest, pmpz_corrupt)
+{
+    add_grid(8);
+    EXPECT_TRUE(mesh.write("test.pmpz"));
+    std::ifstream ifs("test.pmpz", std::ios::binary);
+    const std::string data((std::istreambuf_iterator<char>(ifs)),
+                           std::istreambuf_iterator<char>());
+    const size_t header_size = 64;
+    ASSERT_GT(data.size(), header_size);
+
+    auto read = [](const std::string& corrupt) {
+        std::ofstream ofs("test_corrupt.pmpz", std::ios::binary);
+        ofs.write(corrupt.data(), corrupt.size());
+        ofs.close();
+        SurfaceMesh decoded;
+        return decoded.read("test_corrupt.pmpz");
+    };
+
+    // implausible counts and payload sizes of the header are rejected
+    // without allocating them
+    for (size_t offset : {8, 16, 24})
+    {
+        std::string corrupt = data;
+        corrupt[offset + 5] = char(0xde);
+        EXPECT_FALSE(read(corrupt));
+    }
+
+    // corrupt payloads fail or decode some mesh, but never read out of
+    // bounds
+    for (size_t i = header_size; i < data.size(); ++i)
+    {
+        std::string corrupt = data;
+        corrupt[i] = char(corrupt[i] ^ 0x5a);
+        EXPECT_NO_THROW(read(corrupt));
+    }
+}
+
+TEST_F(SurfaceMeshIOTest, pmpz_quantized)
+{
+    add_grid(40);
+    mesh.triangulate();
+    for (auto v : mesh.vertices())
+        mesh.position(v)[2] = std::sin(mesh.position(v)[0]);
+    SurfaceNormals::compute_vertex_normals(mesh);
+
+    IOFlags flags;
+    flags.use_vertex_normals = true;
+    EXPECT_TRUE(mesh.write("lossless.pmpz", flags));
+    flags.quantization_bits = 12;
+    EXPECT_TRUE(mesh.write("quantized.pmpz", flags));
+    EXPECT_TRUE(mesh.write("reference.pmp"));
+
+    auto file_size = [](const char* filename) {
+        std::ifstream ifs(filename, std::ios::binary | std::ios::ate);
+        return size_t(ifs.tellg());
+    };
+    EXPECT_LT(file_size("quantized.pmpz"), file_size("lossless.pmpz"));
+    EXPECT_LT(file_size("lossless.pmpz"), file_size("reference.pmp"));
+
+    // both files use the same element order
+    SurfaceMesh lossless, quantized;
+    EXPECT_TRUE(lossless.read("lossless.pmpz"));
+    EXPECT_TRUE(quantized.read("quantized.pmpz"));
+    ASSERT_EQ(quantized.n_vertices(), lossless.n_vertices());
+    EXPECT_EQ(quantized.n_faces(), lossless.n_faces());
+
+    auto lnormals = lossless.get_vertex_property<Normal>("v:normal");
+    auto qnormals = quantized.get_vertex_property<Normal>("v:normal");
+    const Scalar max_error = Scalar(40.0 / 4095);
+    for (auto v : lossless.vertices())
+    {
+        EXPECT_LE(norm(quantized.position(v) - lossless.position(v)),
+                  max_error);
+        EXPECT_GT(dot(qnormals[v], lnormals[v]), 0.999);
+    }
+    for (auto f : lossless.faces())
+        for (auto h : lossless.halfedges(f))
+            EXPECT_EQ(quantized.to_vertex(h), lossless.to_vertex(h));
+}
+
+namespace {
+
+// the JSON chunk of a GLB file, and the vertex count of its POSITION
+// accessor
+std::string glb_json(const std::vector<char>& glb, size_t& n_vertices)
+{
+    uint32_t header[5];
+    memcpy(header, glb.data(), sizeof(header));
+    EXPECT_EQ(header[0], 0x46546C67u);
+    EXPECT_EQ(header[1], 2u);
+    EXPECT_EQ(header[2], glb.size());
+    EXPECT_EQ(header[3] % 4, 0u);
+    const std::string json(glb.data() + 20, header[3]);
+    const auto accessors = json.find("\"accessors\"");
+    const auto count = json.find("\"count\":", accessors);
+    n_vertices = std::stoul(json.substr(count + 8));
+    return json;
+}
+
+} // namespace
+
+TEST_F(SurfaceMeshIOTest, glb_io)
+{
+    // a tetrahedron
+    auto v0 = mesh.add_vertex(Point(0, 0, 0));
+    auto v1 = mesh.add_vertex(Point(1, 0, 0));
+    auto v2 = mesh.add_vertex(Point(0, 1, 0));
+    auto v3 = mesh.add_vertex(Point(0, 0, 1));
+    mesh.add_triangle(v0, v2, v1);
+    mesh.add_triangle(v0, v1, v3);
+    mesh.add_triangle(v1, v2, v3);
+    mesh.add_triangle(v2, v0, v3);
+
+    // smooth normals share vertices, flat ones split them
+    IOFlags flags;
+    std::vector<char> glb;
+    size_t n_vertices;
+    EXPECT_TRUE(mesh.write(glb, "glb", flags));
+    std::string json = glb_json(glb, n_vertices);
+    EXPECT_EQ(n_vertices, size_t(4));
+    EXPECT_NE(json.find("\"NORMAL\""), std::string::npos);
+    EXPECT_NE(json.find("\"componentType\":5123,\"count\":12"),
+              std::string::npos);
+
+    flags.crease_angle = 0;
+    EXPECT_TRUE(mesh.write(glb, "glb", flags));
+    glb_json(glb, n_vertices);
+    EXPECT_EQ(n_vertices, size_t(12));
+
+    // halfedge texture coordinates split vertices as well
+    auto htex = mesh.halfedge_property<TexCoord>("h:tex");
+    for (auto h : mesh.halfedges())
+        htex[h] = TexCoord(h.idx(), 0);
+    flags.crease_angle = 180;
+    flags.use_halfedge_texcoords = true;
+    EXPECT_TRUE(mesh.write("test.glb", flags));
+    std::ifstream ifs("test.glb", std::ios::binary);
+    glb.assign(std::istreambuf_iterator<char>(ifs),
+               std::istreambuf_iterator<char>());
+    json = glb_json(glb, n_vertices);
+    EXPECT_EQ(n_vertices, size_t(12));
+    EXPECT_NE(json.find("\"TEXCOORD_0\""), std::string::npos);
+
+    // reordered triangles keep their vertices
+    flags.optimize_vertex_cache = true;
+    EXPECT_TRUE(mesh.write(glb, "glb", flags));
+    json = glb_json(glb, n_vertices);
+    EXPECT_EQ(n_vertices, size_t(12));
+    EXPECT_NE(json.find("\"componentType\":5123,\"count\":12"),
+              std::string::npos);
+
+    // compact texture coordinates are written as well
+    flags.optimize_vertex_cache = false;
+    mesh.remove_halfedge_property(htex);
+    auto htex16 = mesh.halfedge_property<TexCoord16>("h:tex");
+    for (auto h : mesh.halfedges())
+        htex16[h] = TexCoord(Scalar(h.idx()) / 12, 0);
+    EXPECT_TRUE(mesh.write(glb, "glb", flags));
+    json = glb_json(glb, n_vertices);
+    EXPECT_EQ(n_vertices, size_t(12));
+    EXPECT_NE(json.find("\"TEXCOORD_0\""), std::string::npos);
+
+    // point clouds with octahedral normals
+    SurfaceMesh points;
+    auto onormals = points.add_vertex_property<OctNormal>("v:normal");
+    for (int i = 0; i < 3; ++i)
+        onormals[points.add_vertex(Point(i, 0, 0))] = Normal(0, 0, -1);
+    flags = IOFlags();
+    flags.use_vertex_normals = true;
+    EXPECT_TRUE(points.write(glb, "glb", flags));
+    json = glb_json(glb, n_vertices);
+    EXPECT_EQ(n_vertices, size_t(3));
+    EXPECT_NE(json.find("\"NORMAL\""), std::string::npos);
+
+    SurfaceMesh empty;
+    EXPECT_FALSE(empty.write(glb, "glb"));
+}
+
+TEST_F(SurfaceMeshIOTest, memory_io)
+{
+    add_grid(10);
+    mesh.triangulate();
+    SurfaceNormals::compute_face_normals(mesh);
+
+    IOFlags binary;
+    binary.use_binary = true;
+    const std::vector<std::pair<std::string, bool>> formats = {
+        {"off", false}, {"off", true}, {"obj", false}, {"ply", false},
+        {"ply", true},  {"stl", false}, {"pmp", true}, {"pmpz", true}};
+
+    for (const auto& format : formats)
+    {
+        const IOFlags flags = format.second ? binary : IOFlags();
+        const std::string filename = "memory_io." + format.first;
+
+        // the data in memory equals the file
+        std::vector<char> data;
+        EXPECT_TRUE(mesh.write(data, format.first, flags)) << filename;
+        EXPECT_TRUE(mesh.write(filename, flags));
+        std::ifstream ifs(filename, std::ios::binary);
+        const std::string file((std::istreambuf_iterator<char>(ifs)),
+                               std::istreambuf_iterator<char>());
+        EXPECT_EQ(std::string(data.begin(), data.end()), file) << filename;
+
+        SurfaceMesh from_data;
+        EXPECT_TRUE(from_data.read(data.data(), data.size(), format.first))
+            << filename;
+        EXPECT_EQ(from_data.n_vertices(), mesh.n_vertices()) << filename;
+        EXPECT_EQ(from_data.n_faces(), mesh.n_faces()) << filename;
+
+        // streams
+        std::stringstream stream;
+        EXPECT_TRUE(mesh.write(stream, format.first, flags));
+        SurfaceMesh from_stream;
+        EXPECT_TRUE(from_stream.read(stream, format.first)) << filename;
+        EXPECT_EQ(from_stream.n_faces(), mesh.n_faces()) << filename;
+    }
+
+    // callbacks passing small blocks
+    std::vector<char> data;
+    mesh.write(data, "obj");
+    size_t pos = 0;
+    auto read_function = [&](char* buffer, size_t size) {
+        const size_t n = std::min(std::min(size, size_t(100)), data.size() - pos);
+        memcpy(buffer, data.data() + pos, n);
+        pos += n;
+        return n;
+    };
+    SurfaceMesh from_callback;
+    EXPECT_TRUE(SurfaceMeshIO::read(from_callback, read_function, "obj",
+                                    IOFlags()));
+    EXPECT_EQ(from_callback.n_faces(), mesh.n_faces());
+
+    auto failing_write = [](const char*, size_t) { return false; };
+    EXPECT_FALSE(SurfaceMeshIO::write(mesh, failing_write, "obj", IOFlags()));
+    EXPECT_FALSE(from_callback.read(data.data(), data.size(), "unknown"));
+}
+
+#ifdef PMP_HAS_ZLIB
+
+namespace {
+
+std::string file_contents(const std::string& filename)
+{
+    std::ifstream ifs(filename, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(ifs)),
+                       std::istreambuf_iterator<char>());
+}
+
+// write data as gzip members of at most block_size bytes, in the BGZF
+// layout if bgzf is set
+void write_gzip(const std::string& filename, const std::string& data,
+                size_t block_size, bool bgzf)
+{
+    std::ofstream ofs(filename, std::ios::binary);
+    for (size_t pos = 0; pos < data.size(); pos += block_size)
+    {
+        const size_t n = std::min(block_size, data.size() - pos);
+        std::vector<unsigned char> deflated(compressBound(uLong(n)) + 64);
+        z_stream stream = {};
+        deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8,
+                     Z_DEFAULT_STRATEGY);
+        stream.next_in = (Bytef*)data.data() + pos;
+        stream.avail_in = uInt(n);
+        stream.next_out = deflated.data();
+        stream.avail_out = uInt(deflated.size());
+        deflate(&stream, Z_FINISH);
+        const size_t size = stream.total_out;
+        deflateEnd(&stream);
+
+        std::vector<unsigned char> header = {0x1f, 0x8b, 8, 0, 0, 0,
+                                             0,    0,    0, 0xff};
+        if (bgzf)
+        {
+            const size_t bsize = size + 25;
+            header[3] = 4;
+            header.insert(header.end(),
+                          {6, 0, 'B', 'C', 2, 0, (unsigned char)(bsize & 0xff),
+                           (unsigned char)(bsize >> 8)});
+        }
+        const uLong crc = crc32(crc32(0, Z_NULL, 0),
+                                (const Bytef*)data.data() + pos, uInt(n));
+        unsigned char trailer[8];
+        for (int i = 0; i < 4; ++i)
+        {
+            trailer[i] = (unsigned char)(crc >> (8 * i));
+            trailer[4 + i] = (unsigned char)(n >> (8 * i));
+        }
+        ofs.write((const char*)header.data(), header.size());
+        ofs.write((const char*)deflated.data(), size);
+        ofs.write((const char*)trailer, 8);
+    }
+}
+
+} // namespace
+
+TEST_F(SurfaceMeshIOTest, gzip_input)
+{
+    add_grid(30);
+    mesh.triangulate();
+    SurfaceNormals::compute_face_normals(mesh);
+    IOFlags binary;
+    binary.use_binary = true;
+    mesh.write("gzip.obj");
+    mesh.write("gzip.ply", binary);
+    mesh.write("gzip.stl", binary);
+
+    for (auto name : {"gzip.obj", "gzip.ply", "gzip.stl"})
+    {
+        const std::string data = file_contents(name);
+        const std::string gz = std::string(name) + ".gz";
+
+        // a single member, several members, and BGZF blocks
+        for (int layout = 0; layout < 3; ++layout)
+        {
+            write_gzip(gz, data, layout ? 4000 : data.size(), layout == 2);
+            SurfaceMesh decompressed;
+            EXPECT_TRUE(decompressed.read(gz)) << gz << " " << layout;
+            EXPECT_EQ(decompressed.n_vertices(), mesh.n_vertices()) << gz;
+            EXPECT_EQ(decompressed.n_faces(), mesh.n_faces()) << gz;
+        }
+
+        // BGZF members with implausible sizes are rejected without
+        // allocating them
+        std::string forged = file_contents(gz);
+        const size_t block_size =
+            size_t((unsigned char)forged[16] | (unsigned char)forged[17] << 8);
+        std::fill(forged.begin() + block_size - 3,
+                  forged.begin() + block_size + 1, char(0xff));
+        const std::string forged_gz = "forged_" + gz;
+        std::ofstream forged_ofs(forged_gz, std::ios::binary);
+        forged_ofs.write(forged.data(), forged.size());
+        forged_ofs.close();
+        SurfaceMesh rejected;
+        EXPECT_FALSE(rejected.read(forged_gz)) << gz;
+
+        // truncated files are rejected
+        const std::string compressed = file_contents(gz);
+        std::ofstream ofs(gz, std::ios::binary);
+        ofs.write(compressed.data(), compressed.size() / 2);
+        ofs.close();
+        SurfaceMesh truncated;
+        EXPECT_FALSE(truncated.read(gz)) << gz;
+    }
+}
+
+#endif
+
 TEST_F(SurfaceMeshIOTest, xyz_io)
 {
     add_triangle();
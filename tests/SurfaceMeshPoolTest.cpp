@@ -0,0 +1,65 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include "gtest/gtest.h"
+
+#include <pmp/SurfaceMeshPool.h>
+
+using namespace pmp;
+
+// a triangle with a temporary property, as added by algorithms
+static void process(SurfaceMesh& mesh)
+{
+    auto v0 = mesh.add_vertex(Point(0, 0, 0));
+    auto v1 = mesh.add_vertex(Point(1, 0, 0));
+    auto v2 = mesh.add_vertex(Point(0, 1, 0));
+    mesh.add_triangle(v0, v1, v2);
+    auto tmp = mesh.add_vertex_property<Scalar>("v:tmp");
+    EXPECT_TRUE(tmp);
+    mesh.remove_vertex_property(tmp);
+}
+
+TEST(SurfaceMeshPoolTest, reuse)
+{
+    SurfaceMeshPool pool(1);
+    auto mesh = pool.acquire();
+    process(*mesh);
+    const SurfaceMesh* address = mesh.get();
+    pool.release(std::move(mesh));
+    EXPECT_EQ(pool.size(), size_t(1));
+
+    // the released mesh comes back empty
+    mesh = pool.acquire();
+    EXPECT_EQ(mesh.get(), address);
+    EXPECT_EQ(pool.size(), size_t(0));
+    EXPECT_TRUE(mesh->is_empty());
+    EXPECT_EQ(mesh->faces_size(), size_t(0));
+
+    // the removed property is recycled
+    size_t n_recycled = 0;
+    for (const auto& memory : mesh->memory_stats().vertex_properties)
+        if (memory.recycled)
+            ++n_recycled;
+    EXPECT_EQ(n_recycled, size_t(1));
+    process(*mesh);
+    EXPECT_EQ(mesh->n_faces(), size_t(1));
+}
+
+TEST(SurfaceMeshPoolTest, max_meshes)
+{
+    SurfaceMeshPool pool(1);
+    auto a = pool.acquire();
+    auto b = pool.acquire();
+    EXPECT_NE(a.get(), b.get());
+    pool.release(std::move(a));
+    pool.release(std::move(b));
+    EXPECT_EQ(pool.size(), size_t(1));
+    pool.clear();
+    EXPECT_EQ(pool.size(), size_t(0));
+}
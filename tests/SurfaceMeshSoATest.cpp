@@ -0,0 +1,79 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include "SurfaceMeshTest.h"
+
+#include <pmp/algorithms/SurfaceMeshSoA.h>
+#include <pmp/algorithms/DifferentialGeometry.h>
+
+using namespace pmp;
+
+class SurfaceMeshSoATest : public SurfaceMeshTest
+{
+public:
+    void lifted_grid()
+    {
+        add_grid(20);
+        mesh.triangulate();
+        for (auto v : mesh.vertices())
+        {
+            auto& p = mesh.position(v);
+            p[2] = 0.1 * p[0] * p[1];
+        }
+    }
+};
+
+TEST_F(SurfaceMeshSoATest, bounds)
+{
+    lifted_grid();
+    SurfaceMeshSoA soa(mesh);
+    auto bb = soa.bounds();
+    EXPECT_FLOAT_EQ(bb.min()[0], 0.0);
+    EXPECT_FLOAT_EQ(bb.max()[0], 20.0);
+    EXPECT_FLOAT_EQ(bb.max()[2], 40.0);
+}
+
+TEST_F(SurfaceMeshSoATest, area_and_centroid)
+{
+    lifted_grid();
+    SurfaceMeshSoA soa(mesh);
+    EXPECT_EQ(soa.n_triangles(), mesh.n_faces());
+    EXPECT_NEAR(soa.surface_area(), surface_area(mesh), 1e-2);
+    auto c0 = soa.centroid();
+    auto c1 = centroid(mesh);
+    EXPECT_NEAR(c0[0], c1[0], 1e-3);
+    EXPECT_NEAR(c0[1], c1[1], 1e-3);
+    EXPECT_NEAR(c0[2], c1[2], 1e-3);
+}
+
+TEST_F(SurfaceMeshSoATest, laplace)
+{
+    add_grid(4);
+    SurfaceMeshSoA soa(mesh);
+    std::vector<Scalar> lx, ly, lz;
+    soa.laplace(lx, ly, lz);
+    ASSERT_EQ(lx.size(), mesh.n_vertices());
+
+    // interior vertices of a regular grid have zero uniform Laplacian
+    EXPECT_FLOAT_EQ(lx[6], 0.0);
+    EXPECT_FLOAT_EQ(ly[6], 0.0);
+
+    // corner vertex is pulled towards the interior
+    EXPECT_GT(lx[0], 0.0);
+    EXPECT_GT(ly[0], 0.0);
+}
+
+TEST_F(SurfaceMeshSoATest, write_positions)
+{
+    add_triangle();
+    SurfaceMeshSoA soa(mesh);
+    soa.x()[1] = 2.0;
+    soa.write_positions(mesh);
+    EXPECT_FLOAT_EQ(mesh.position(v1)[0], 2.0);
+}
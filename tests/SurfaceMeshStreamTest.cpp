@@ -0,0 +1,165 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include "SurfaceMeshTest.h"
+
+#include <pmp/SurfaceMeshStream.h>
+#include <pmp/PointWelder.h>
+#include <pmp/algorithms/SurfaceNormals.h>
+
+#include <fstream>
+
+using namespace pmp;
+
+class SurfaceMeshStreamTest : public SurfaceMeshTest
+{
+};
+
+namespace {
+
+// collects all batches and counts them
+class CollectingSink : public SurfaceMeshSink
+{
+public:
+    CollectingSink() : n_batches(0), ended(false), max_faces(0) {}
+
+    bool vertices(const std::vector<Point>& p) override
+    {
+        points.insert(points.end(), p.begin(), p.end());
+        ++n_batches;
+        return true;
+    }
+
+    bool faces(const std::vector<IndexType>& i,
+               const std::vector<IndexType>& s) override
+    {
+        // faces only refer to vertices passed before
+        for (auto idx : i)
+            EXPECT_LT(idx, points.size());
+        indices.insert(indices.end(), i.begin(), i.end());
+        face_sizes.insert(face_sizes.end(), s.begin(), s.end());
+        ++n_batches;
+        return max_faces == 0 || face_sizes.size() < max_faces;
+    }
+
+    bool end() override
+    {
+        ended = true;
+        return true;
+    }
+
+    std::vector<Point> points;
+    std::vector<IndexType> indices, face_sizes;
+    size_t n_batches;
+    bool ended;
+    size_t max_faces; // stop reading after this many faces
+};
+
+} // namespace
+
+TEST_F(SurfaceMeshStreamTest, read_formats)
+{
+    add_grid(10);
+    mesh.triangulate();
+    SurfaceNormals::compute_face_normals(mesh);
+
+    IOFlags binary;
+    binary.use_binary = true;
+    const std::vector<std::pair<std::string, bool>> files = {
+        {"stream.off", false}, {"stream_binary.off", true},
+        {"stream.obj", false}, {"stream.ply", false},
+        {"stream_binary.ply", true}};
+
+    for (const auto& file : files)
+    {
+        ASSERT_TRUE(mesh.write(file.first, file.second ? binary : IOFlags()));
+
+        CollectingSink sink;
+        EXPECT_TRUE(read_stream(file.first, sink, 50)) << file.first;
+        EXPECT_TRUE(sink.ended);
+        EXPECT_GT(sink.n_batches, size_t(4));
+
+        SurfaceMesh streamed;
+        streamed.build_from_indices(sink.points, sink.indices,
+                                    sink.face_sizes);
+        EXPECT_EQ(streamed.n_vertices(), mesh.n_vertices()) << file.first;
+        EXPECT_EQ(streamed.n_faces(), mesh.n_faces()) << file.first;
+        EXPECT_EQ(streamed.n_edges(), mesh.n_edges()) << file.first;
+    }
+
+    // STL files are streamed as triangle soup
+    ASSERT_TRUE(mesh.write("stream.stl"));
+    CollectingSink sink;
+    EXPECT_TRUE(read_stream("stream.stl", sink));
+    EXPECT_EQ(sink.points.size(), 3 * mesh.n_faces());
+    EXPECT_EQ(sink.face_sizes.size(), mesh.n_faces());
+
+    SurfaceMesh soup;
+    soup.build_from_indices(sink.points, sink.indices, sink.face_sizes);
+    weld_vertices(soup);
+    EXPECT_EQ(soup.n_vertices(), mesh.n_vertices());
+}
+
+TEST_F(SurfaceMeshStreamTest, interleaved_obj)
+{
+    std::ofstream ofs("interleaved.obj");
+    ofs << "# vertices and faces alternate\n"
+           "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n"
+           "v 1 1 0\nf -3/1/1 -1/2/2 -2/3/3\n"
+           "vt 0 0\nvn 0 0 1\n";
+    ofs.close();
+
+    CollectingSink sink;
+    EXPECT_TRUE(read_stream("interleaved.obj", sink, 1));
+    ASSERT_EQ(sink.points.size(), size_t(4));
+    const std::vector<IndexType> indices = {0, 1, 2, 1, 3, 2};
+    EXPECT_EQ(sink.indices, indices);
+}
+
+TEST_F(SurfaceMeshStreamTest, stop_reading)
+{
+    add_grid(10);
+    mesh.write("stop.off");
+
+    CollectingSink sink;
+    sink.max_faces = 20;
+    EXPECT_FALSE(read_stream("stop.off", sink, 10));
+    EXPECT_EQ(sink.face_sizes.size(), size_t(20));
+    EXPECT_FALSE(sink.ended);
+
+    EXPECT_FALSE(read_stream("stop.xyz", sink));
+}
+
+TEST_F(SurfaceMeshStreamTest, convert)
+{
+    add_grid(6);
+    mesh.add_vertex(Point(-1, -1, 0.5));
+    mesh.write("convert.off");
+
+    const std::vector<std::string> outputs = {"converted.obj", "converted.ply",
+                                              "converted.off"};
+    for (int binary = 0; binary < 2; ++binary)
+        for (const auto& output : outputs)
+        {
+            IOFlags flags;
+            flags.use_binary = binary;
+            SurfaceMeshStreamWriter writer(output, flags);
+            EXPECT_TRUE(read_stream("convert.off", writer, 7)) << output;
+
+            SurfaceMesh converted;
+            EXPECT_TRUE(converted.read(output)) << output;
+            EXPECT_EQ(converted.n_vertices(), mesh.n_vertices()) << output;
+            EXPECT_EQ(converted.n_faces(), mesh.n_faces()) << output;
+            for (auto v : mesh.vertices())
+                EXPECT_EQ(converted.position(v), mesh.position(v)) << output;
+        }
+
+    SurfaceMeshStreamWriter writer("converted.stl");
+    EXPECT_FALSE(read_stream("convert.off", writer));
+}
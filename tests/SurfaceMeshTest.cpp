@@ -10,6 +10,8 @@
 #include "SurfaceMeshTest.h"
 
 #include <pmp/algorithms/SurfaceNormals.h>
+#include <pmp/Parallel.h>
+#include <algorithm>
 #include <vector>
 
 using namespace pmp;
@@ -82,6 +84,60 @@ TEST_F(SurfaceMeshTest, insert_remove_single_polygonal_face)
     EXPECT_EQ(mesh.n_faces(), size_t(0));
 }
 
+TEST_F(SurfaceMeshTest, stable_garbage_collection)
+{
+    add_grid(3);
+    mesh.triangulate();
+    auto vidx = mesh.add_vertex_property<int>("v:idx");
+    for (auto v : mesh.vertices())
+        vidx[v] = int(v.idx());
+
+    // delete an interior vertex and a corner face
+    mesh.delete_vertex(Vertex(5));
+    mesh.delete_face(Face(0));
+    const size_t nv = mesh.n_vertices();
+    const size_t ne = mesh.n_edges();
+    const size_t nf = mesh.n_faces();
+
+    mesh.stable_garbage_collection();
+    EXPECT_EQ(mesh.vertices_size(), nv);
+    EXPECT_EQ(mesh.edges_size(), ne);
+    EXPECT_EQ(mesh.faces_size(), nf);
+
+    // remaining vertices keep their order
+    const auto& vmap = mesh.vertex_index_map();
+    EXPECT_EQ(vmap[5], PMP_MAX_INDEX);
+    for (size_t i = 0; i < vmap.size(); ++i)
+    {
+        if (vmap[i] != PMP_MAX_INDEX)
+        {
+            EXPECT_EQ(vidx[Vertex(vmap[i])], int(i));
+        }
+    }
+    for (size_t i = 1; i < mesh.vertices_size(); ++i)
+        EXPECT_LT(vidx[Vertex(i - 1)], vidx[Vertex(i)]);
+
+    for (auto h : mesh.halfedges())
+    {
+        EXPECT_EQ(mesh.prev_halfedge(mesh.next_halfedge(h)), h);
+        EXPECT_EQ(mesh.to_vertex(h), mesh.from_vertex(mesh.next_halfedge(h)));
+    }
+    for (auto f : mesh.faces())
+        EXPECT_EQ(mesh.face(mesh.halfedge(f)), f);
+    for (auto v : mesh.vertices())
+    {
+        if (!mesh.is_isolated(v))
+        {
+            EXPECT_EQ(mesh.from_vertex(mesh.halfedge(v)), v);
+        }
+    }
+
+    // nothing to collect
+    mesh.stable_garbage_collection();
+    EXPECT_EQ(mesh.vertices_size(), nv);
+    EXPECT_EQ(mesh.faces_size(), nf);
+}
+
 TEST_F(SurfaceMeshTest, delete_center_vertex)
 {
     ASSERT_TRUE(mesh.read("pmp-data/off/vertex_onering.off"));
@@ -174,6 +230,63 @@ TEST_F(SurfaceMeshTest, vertex_properties)
     EXPECT_EQ(mesh.vertex_properties().size(), osize);
 }
 
+TEST_F(SurfaceMeshTest, property_keys)
+{
+    add_triangle();
+    const PropertyKey<Scalar> weight_key("v:weight");
+    const PropertyKey<int> wrong_type("v:weight");
+    EXPECT_EQ(weight_key.index(), wrong_type.index());
+
+    EXPECT_FALSE(mesh.get_vertex_property(weight_key));
+    auto weight = mesh.vertex_property(weight_key, Scalar(1));
+    EXPECT_TRUE(weight);
+    EXPECT_EQ(weight[v0], Scalar(1));
+    EXPECT_EQ(mesh.get_vertex_property(weight_key).data(), weight.data());
+    EXPECT_FALSE(mesh.get_vertex_property(wrong_type));
+
+    // lookups stay valid when other properties are removed
+    auto vidx = mesh.add_vertex_property<int>("v:idx");
+    mesh.add_vertex_property<int>("v:before");
+    mesh.remove_vertex_property(vidx);
+    EXPECT_EQ(mesh.get_vertex_property(weight_key).data(), weight.data());
+
+    // and across garbage collection
+    mesh.add_vertex(Point(0, 0, 1));
+    mesh.delete_vertex(v0);
+    mesh.garbage_collection();
+    EXPECT_EQ(mesh.n_vertices(), size_t(1));
+    weight[Vertex(0)] = 2;
+    EXPECT_EQ(mesh.get_vertex_property(weight_key)[Vertex(0)], Scalar(2));
+
+    // keys work with copies of the mesh
+    SurfaceMesh copy = mesh;
+    EXPECT_TRUE(copy.get_vertex_property(weight_key));
+    mesh.remove_vertex_property(weight);
+    EXPECT_FALSE(mesh.get_vertex_property(weight_key));
+    EXPECT_TRUE(mesh.get_vertex_property<int>("v:before"));
+}
+
+TEST_F(SurfaceMeshTest, property_key_after_property)
+{
+    add_triangle();
+
+    // names of properties are interned only by keys
+    auto unkeyed = mesh.add_vertex_property<int>("v:unkeyed_property");
+    EXPECT_EQ(find_property_name_index("v:unkeyed_property"), size_t(-1));
+
+    // keys find properties added before them, also in copies
+    const PropertyKey<int> key("v:unkeyed_property");
+    EXPECT_EQ(find_property_name_index("v:unkeyed_property"), key.index());
+    EXPECT_EQ(mesh.get_vertex_property(key).data(), unkeyed.data());
+    SurfaceMesh copy = mesh;
+    EXPECT_TRUE(copy.get_vertex_property(key));
+
+    // and index them once the table of the container is rebuilt
+    auto other = copy.add_vertex_property<int>("v:other");
+    copy.remove_vertex_property(other);
+    EXPECT_TRUE(copy.get_vertex_property(key));
+}
+
 TEST_F(SurfaceMeshTest, halfedge_properties)
 {
     add_triangle();
@@ -306,6 +419,64 @@ TEST_F(SurfaceMeshTest, poly_mesh)
     EXPECT_TRUE(mesh.is_triangle_mesh());
 }
 
+TEST_F(SurfaceMeshTest, triangulate_shortest_diagonal)
+{
+    // non-planar quads, the first with the shorter diagonal v1-v3, the
+    // second with the shorter diagonal v0-v2
+    for (int i = 0; i < 2; ++i)
+    {
+        const Scalar a = i ? 2 : 1, b = i ? 1 : 2;
+        v0 = mesh.add_vertex(Point(3*i,0,0));
+        v1 = mesh.add_vertex(Point(3*i+a,0,0.5));
+        v2 = mesh.add_vertex(Point(3*i+b,b,0));
+        v3 = mesh.add_vertex(Point(3*i,a,0.5));
+        mesh.add_quad(v0,v1,v2,v3);
+    }
+
+    mesh.triangulate(SurfaceMesh::ShortestDiagonal);
+    EXPECT_TRUE(mesh.is_triangle_mesh());
+    EXPECT_EQ(mesh.n_faces(), size_t(4));
+    EXPECT_TRUE(mesh.find_halfedge(Vertex(1),Vertex(3)).is_valid());
+    EXPECT_TRUE(mesh.find_halfedge(Vertex(4),Vertex(6)).is_valid());
+}
+
+TEST_F(SurfaceMeshTest, triangulate_grid)
+{
+    // parallel bulk triangulation matches triangulating face by face
+    add_grid(40);
+    mesh.delete_face(Face(7));
+    SurfaceMesh single = mesh;
+    for (auto f : single.faces())
+        single.triangulate(f);
+    mesh.triangulate();
+
+    EXPECT_TRUE(mesh.is_triangle_mesh());
+    EXPECT_EQ(mesh.n_faces(), size_t(2 * 40 * 40 - 2));
+    ASSERT_EQ(mesh.halfedges_size(), single.halfedges_size());
+    for (auto h : mesh.halfedges())
+    {
+        EXPECT_EQ(mesh.to_vertex(h), single.to_vertex(h));
+        EXPECT_EQ(mesh.next_halfedge(h), single.next_halfedge(h));
+        EXPECT_EQ(mesh.face(h), single.face(h));
+    }
+}
+
+TEST_F(SurfaceMeshTest, subdivide_connectivity)
+{
+    // triangle splits reject quads, quad splits take them
+    add_grid(4);
+    EXPECT_FALSE(mesh.subdivide_connectivity(false));
+    EXPECT_EQ(mesh.n_faces(), size_t(16));
+    EXPECT_TRUE(mesh.subdivide_connectivity(true));
+    EXPECT_EQ(mesh.n_faces(), size_t(64));
+    EXPECT_EQ(mesh.n_vertices(), size_t(81));
+
+    mesh.triangulate();
+    EXPECT_TRUE(mesh.subdivide_connectivity(false));
+    EXPECT_EQ(mesh.n_faces(), size_t(4 * 128));
+    EXPECT_TRUE(mesh.is_triangle_mesh());
+}
+
 TEST_F(SurfaceMeshTest, valence)
 {
     add_triangle();
@@ -387,9 +558,616 @@ TEST_F(SurfaceMeshTest, edge_length)
     std::cerr << "sum: " << sum << std::endl;
 }
 
+TEST_F(SurfaceMeshTest, permute_vertices)
+{
+    add_quad();
+    auto vidx = mesh.add_vertex_property<int>("v:idx");
+    for (auto v : mesh.vertices())
+        vidx[v] = int(v.idx());
+
+    std::vector<Vertex> order = {v2, v0, v3, v1};
+    mesh.permute_vertices(order);
+
+    for (size_t i = 0; i < order.size(); ++i)
+        EXPECT_EQ(vidx[Vertex(i)], int(order[i].idx()));
+
+    // connectivity follows the vertices
+    for (auto h : mesh.halfedges())
+        EXPECT_EQ(mesh.from_vertex(mesh.halfedge(mesh.from_vertex(h))),
+                  mesh.from_vertex(h));
+    std::vector<int> corners;
+    for (auto v : mesh.vertices(f0))
+        corners.push_back(vidx[v]);
+    EXPECT_EQ(corners, std::vector<int>({0, 1, 2, 3}));
+
+    // invalid permutations are rejected
+    order.pop_back();
+    mesh.permute_vertices(order);
+    EXPECT_EQ(vidx[Vertex(0)], 2);
+}
+
+TEST_F(SurfaceMeshTest, permute_edges_and_faces)
+{
+    add_grid(2);
+    mesh.triangulate();
+    std::vector<Edge> eorder;
+    for (auto e : mesh.edges())
+        eorder.push_back(e);
+    std::reverse(eorder.begin(), eorder.end());
+    mesh.permute_edges(eorder);
+
+    std::vector<Face> forder;
+    for (auto f : mesh.faces())
+        forder.push_back(f);
+    std::reverse(forder.begin(), forder.end());
+    mesh.permute_faces(forder);
+
+    for (auto h : mesh.halfedges())
+    {
+        EXPECT_EQ(mesh.prev_halfedge(mesh.next_halfedge(h)), h);
+        EXPECT_EQ(mesh.to_vertex(h), mesh.from_vertex(mesh.next_halfedge(h)));
+        if (!mesh.is_boundary(h))
+        {
+            EXPECT_EQ(mesh.face(mesh.next_halfedge(h)), mesh.face(h));
+        }
+    }
+    for (auto f : mesh.faces())
+    {
+        EXPECT_EQ(mesh.face(mesh.halfedge(f)), f);
+        EXPECT_EQ(mesh.valence(f), 3u);
+    }
+    for (auto v : mesh.vertices())
+        EXPECT_EQ(mesh.from_vertex(mesh.halfedge(v)), v);
+    EXPECT_EQ(mesh.n_faces(), size_t(8));
+}
+
+TEST_F(SurfaceMeshTest, copy_properties)
+{
+    add_quad();
+    auto vtex = mesh.add_vertex_property<TexCoord>("v:tex");
+    auto vname = mesh.add_vertex_property<std::string>("v:name");
+    for (auto v : mesh.vertices())
+    {
+        vtex[v] = TexCoord(Scalar(v.idx()), 0);
+        vname[v] = std::to_string(v.idx());
+    }
+    auto fflag = mesh.add_face_property<bool>("f:flag", true);
+
+    SurfaceMesh copy;
+    const std::vector<Vertex> vertices = {v3, v1};
+    copy.add_vertex(Point(0, 0, 0));
+    copy.add_vertex(Point(1, 0, 0));
+    EXPECT_FALSE(copy.copy_properties(mesh, vertices, {f0}));
+    EXPECT_TRUE(copy.copy_properties(mesh, vertices, {}));
+
+    auto ctex = copy.get_vertex_property<TexCoord>("v:tex");
+    auto cname = copy.get_vertex_property<std::string>("v:name");
+    ASSERT_TRUE(ctex && cname);
+    EXPECT_EQ(ctex[Vertex(0)], TexCoord(3, 0));
+    EXPECT_EQ(cname[Vertex(1)], "1");
+    EXPECT_TRUE(copy.get_face_property<bool>("f:flag"));
+    EXPECT_EQ(copy.position(Vertex(1)), Point(1, 0, 0));
+    EXPECT_TRUE(fflag[f0]);
+}
+
+TEST_F(SurfaceMeshTest, property_recycling)
+{
+    add_triangle();
+    const auto osize = mesh.vertex_properties().size();
+    const Point* storage;
+    {
+        PropertyRecyclingScope recycling(mesh);
+        auto p = mesh.add_vertex_property<Point>("v:first", Point(1, 0, 0));
+        storage = p.data();
+        mesh.remove_vertex_property(p);
+        EXPECT_FALSE(mesh.has_vertex_property("v:first"));
+
+        // re-uses the storage, but gets its own name and default value
+        auto q = mesh.add_vertex_property<Point>("v:second", Point(0, 1, 0));
+        EXPECT_EQ(q.data(), storage);
+        EXPECT_TRUE(mesh.has_vertex_property("v:second"));
+        for (auto v : mesh.vertices())
+            EXPECT_EQ(q[v], Point(0, 1, 0));
+
+        // different types are not mixed
+        auto r = mesh.add_vertex_property<int>("v:int", 3);
+        EXPECT_EQ(r[v0], 3);
+        mesh.remove_vertex_property(r);
+        mesh.remove_vertex_property(q);
+    }
+    EXPECT_EQ(mesh.vertex_properties().size(), osize);
+}
+
+TEST_F(SurfaceMeshTest, move)
+{
+    add_grid(2);
+    auto vidx = mesh.add_vertex_property<int>("v:idx", 7);
+    const Point* points = mesh.positions().data();
+
+    SurfaceMesh moved(std::move(mesh));
+    EXPECT_EQ(moved.n_vertices(), size_t(9));
+    EXPECT_EQ(moved.n_faces(), size_t(4));
+    EXPECT_EQ(moved.positions().data(), points);
+
+    // handles stay valid, the source is left empty
+    EXPECT_EQ(vidx[Vertex(0)], 7);
+    EXPECT_TRUE(mesh.is_empty());
+    EXPECT_FALSE(mesh.has_vertex_property("v:idx"));
+
+    mesh = std::move(moved);
+    EXPECT_EQ(mesh.n_faces(), size_t(4));
+    EXPECT_TRUE(moved.is_empty());
+    add_triangle();
+    EXPECT_EQ(mesh.n_faces(), size_t(5));
+}
+
+TEST_F(SurfaceMeshTest, assign_shared)
+{
+    add_grid(2);
+    SurfaceMesh clone;
+    clone.assign_shared(mesh);
+    EXPECT_TRUE(mesh.has_shared_connectivity());
+    EXPECT_TRUE(clone.has_shared_connectivity());
+
+    // positions are private
+    clone.position(Vertex(0)) = Point(5, 5, 5);
+    EXPECT_EQ(mesh.position(Vertex(0)), Point(0, 0, 0));
+    EXPECT_TRUE(clone.has_shared_connectivity());
+
+    // changing the connectivity detaches the clone
+    clone.triangulate();
+    EXPECT_FALSE(clone.has_shared_connectivity());
+    EXPECT_FALSE(mesh.has_shared_connectivity());
+    EXPECT_EQ(clone.n_faces(), size_t(8));
+    EXPECT_EQ(mesh.n_faces(), size_t(4));
+    for (auto f : mesh.faces())
+        EXPECT_EQ(mesh.valence(f), 4u);
+
+    // the original detaches as well
+    SurfaceMesh clone2;
+    clone2.assign_shared(mesh);
+    mesh.delete_face(Face(0));
+    EXPECT_TRUE(mesh.is_deleted(Face(0)));
+    EXPECT_FALSE(clone2.is_deleted(Face(0)));
+    EXPECT_EQ(clone2.n_faces(), size_t(4));
+}
+
+TEST_F(SurfaceMeshTest, concurrent_reads)
+{
+    add_grid(20);
+    const SurfaceMesh& shared = mesh;
+
+    // many threads query and clone the same const mesh
+    std::vector<size_t> valences(shared.n_faces());
+    std::vector<SurfaceMesh> clones(8);
+    parallel_for(size_t(0), shared.n_faces() + clones.size(), [&](size_t i) {
+        if (i < shared.n_faces())
+        {
+            const Face f(static_cast<IndexType>(i));
+            for (auto h : shared.halfedges(f))
+                valences[i] += shared.valence(shared.to_vertex(h));
+            valences[i] += shared.bounds().is_empty();
+        }
+        else
+            clones[i - shared.n_faces()].assign_shared(shared);
+    });
+
+    for (auto f : mesh.faces())
+    {
+        size_t valence = 0;
+        for (auto v : mesh.vertices(f))
+            valence += mesh.valence(v);
+        EXPECT_EQ(valences[f.idx()], valence);
+    }
+    for (auto& clone : clones)
+        EXPECT_EQ(clone.n_faces(), mesh.n_faces());
+
+    // the source detaches before changing its connectivity
+    mesh.triangulate();
+    EXPECT_EQ(clones[0].n_faces(), size_t(400));
+    EXPECT_EQ(mesh.n_faces(), size_t(800));
+}
+
+TEST_F(SurfaceMeshTest, add_faces)
+{
+    // a triangulated 4x4 grid, once face by face and once in bulk
+    const unsigned int n = 4;
+    std::vector<Point> points;
+    for (unsigned int j = 0; j <= n; ++j)
+        for (unsigned int i = 0; i <= n; ++i)
+            points.emplace_back(i, j, 0);
+
+    std::vector<IndexType> indices;
+    for (unsigned int j = 0; j < n; ++j)
+        for (unsigned int i = 0; i < n; ++i)
+        {
+            const IndexType v = j * (n + 1) + i;
+            const IndexType tris[6] = {v, v + 1, v + n + 2, v, v + n + 2,
+                                       v + n + 1};
+            indices.insert(indices.end(), tris, tris + 6);
+        }
+
+    SurfaceMesh reference;
+    for (auto p : points)
+        reference.add_vertex(p);
+    for (size_t i = 0; i < indices.size(); i += 3)
+        reference.add_triangle(Vertex(indices[i]), Vertex(indices[i + 1]),
+                               Vertex(indices[i + 2]));
+
+    EXPECT_TRUE(mesh.build_from_indices(points, indices));
+    EXPECT_EQ(mesh.n_vertices(), reference.n_vertices());
+    EXPECT_EQ(mesh.n_edges(), reference.n_edges());
+    EXPECT_EQ(mesh.n_faces(), reference.n_faces());
+
+    // same edge numbering and face vertices as the sequential construction
+    for (auto e : mesh.edges())
+    {
+        EXPECT_EQ(mesh.vertex(e, 0), reference.vertex(e, 0));
+        EXPECT_EQ(mesh.vertex(e, 1), reference.vertex(e, 1));
+    }
+    for (auto f : mesh.faces())
+    {
+        std::vector<Vertex> fv, rv;
+        for (auto v : mesh.vertices(f))
+            fv.push_back(v);
+        for (auto v : reference.vertices(f))
+            rv.push_back(v);
+        EXPECT_EQ(fv, rv);
+    }
+
+    // consistent connectivity
+    for (auto v : mesh.vertices())
+    {
+        EXPECT_EQ(mesh.valence(v), reference.valence(v));
+        EXPECT_EQ(mesh.is_boundary(v), reference.is_boundary(v));
+        for (auto h : mesh.halfedges(v))
+        {
+            EXPECT_EQ(mesh.from_vertex(h), v);
+            EXPECT_EQ(mesh.next_halfedge(mesh.prev_halfedge(h)), h);
+        }
+    }
+}
+
+TEST_F(SurfaceMeshTest, add_faces_polygons)
+{
+    // a quad and a triangle sharing an edge
+    std::vector<Point> points = {Point(0, 0, 0), Point(1, 0, 0),
+                                 Point(1, 1, 0), Point(0, 1, 0),
+                                 Point(2, 0, 0)};
+    std::vector<IndexType> indices = {0, 1, 2, 3, 1, 4, 2};
+    std::vector<IndexType> sizes = {4, 3};
+    EXPECT_TRUE(mesh.build_from_indices(points, indices, sizes));
+    EXPECT_EQ(mesh.n_faces(), size_t(2));
+    EXPECT_EQ(mesh.n_edges(), size_t(6));
+    EXPECT_EQ(mesh.valence(Face(0)), 4u);
+    EXPECT_EQ(mesh.valence(Face(1)), 3u);
+    EXPECT_EQ(mesh.position(Vertex(4)), Point(2, 0, 0));
+}
+
+TEST_F(SurfaceMeshTest, add_faces_invalid)
+{
+    for (int i = 0; i < 3; ++i)
+        mesh.add_vertex(Point(i, 0, 0));
+
+    // out-of-range index and repeated vertex are skipped
+    std::vector<IndexType> indices = {0, 1, 2, 0, 1, 7, 0, 0, 1};
+    EXPECT_FALSE(mesh.add_faces(indices));
+    EXPECT_EQ(mesh.n_faces(), size_t(1));
+}
+
+TEST_F(SurfaceMeshTest, add_faces_non_manifold)
+{
+    // three triangles sharing edge (0,1) fall back to add_face()
+    std::vector<Point> points = {Point(0, 0, 0), Point(1, 0, 0),
+                                 Point(0, 1, 0), Point(0, -1, 0),
+                                 Point(0, 0, 1)};
+    std::vector<IndexType> indices = {0, 1, 2, 1, 0, 3, 0, 1, 4};
+    EXPECT_FALSE(mesh.build_from_indices(points, indices));
+    EXPECT_EQ(mesh.n_vertices(), size_t(5));
+    EXPECT_EQ(mesh.n_faces(), size_t(2));
+}
+
 TEST_F(SurfaceMeshTest, property_stats)
 {
     mesh.property_stats();
 }
 
+TEST_F(SurfaceMeshTest, flag_property)
+{
+    add_grid(4);
+    auto flag = mesh.add_vertex_property<Flag>("v:flag");
+    EXPECT_FALSE(flag[Vertex(0)]);
+    flag[Vertex(0)] = true;
+    EXPECT_TRUE(flag[Vertex(0)]);
+    EXPECT_FALSE(!flag[Vertex(0)]);
+
+    // one byte per element, and the storage is accessible
+    EXPECT_EQ(sizeof(Flag), size_t(1));
+    EXPECT_TRUE(flag.data()[0]);
+}
+
+TEST_F(SurfaceMeshTest, quantized_property)
+{
+    add_grid(4);
+    QuantizedProperty<Vertex, std::uint8_t> q8(
+        mesh.add_vertex_property<std::uint8_t>("v:q8"), -1, 1);
+    QuantizedProperty<Vertex, std::uint16_t> q16(
+        mesh.add_vertex_property<std::uint16_t>("v:q16"), -1, 1);
+    EXPECT_TRUE(q8 && q16);
+    EXPECT_FLOAT_EQ(q8.min(), -1);
+    EXPECT_FLOAT_EQ(q8.max(), 1);
+
+    for (auto v : mesh.vertices())
+    {
+        const Scalar s = -1 + Scalar(2 * v.idx()) / mesh.n_vertices();
+        q8.set(v, s);
+        q16.set(v, s);
+        EXPECT_NEAR(q8[v], s, 0.5 * q8.step() + 1e-6);
+        EXPECT_NEAR(q16[v], s, 0.5 * q16.step() + 1e-6);
+    }
+    EXPECT_LT(q16.step(), q8.step());
+
+    // values outside of the range are clamped
+    q8.set(Vertex(0), -5);
+    q8.set(Vertex(1), 5);
+    EXPECT_FLOAT_EQ(q8[Vertex(0)], -1);
+    EXPECT_FLOAT_EQ(q8[Vertex(1)], 1);
+}
+
+TEST_F(SurfaceMeshTest, oct_normal_property)
+{
+    add_grid(4);
+    auto normals = mesh.add_vertex_property<OctNormal>("v:normal");
+    EXPECT_EQ(sizeof(OctNormal), size_t(4));
+    EXPECT_EQ(Normal(normals[Vertex(0)]), Normal(0, 0, 1));
+
+    // the axes and a spiral of directions over the sphere
+    std::vector<Normal> directions = {Normal(1, 0, 0), Normal(-1, 0, 0),
+                                      Normal(0, 1, 0), Normal(0, -1, 0),
+                                      Normal(0, 0, 1), Normal(0, 0, -1)};
+    for (int i = 0; i < 1000; ++i)
+    {
+        const Scalar z = 1 - Scalar(2 * i + 1) / 1000;
+        const Scalar r = std::sqrt(1 - z * z);
+        const Scalar phi = Scalar(2.39996) * i;
+        directions.push_back(Normal(r * std::cos(phi), r * std::sin(phi), z));
+    }
+    for (const Normal& n : directions)
+    {
+        normals[Vertex(1)] = n;
+        const Normal m = normals[Vertex(1)];
+        EXPECT_NEAR(norm(m), 1, 1e-5);
+        EXPECT_LT(norm(m - n), 1e-4);
+    }
+
+    // the input does not need to be normalized
+    normals[Vertex(2)] = Normal(0, 0, -3);
+    EXPECT_LT(norm(Normal(normals[Vertex(2)]) - Normal(0, 0, -1)), 1e-6);
+}
+
+TEST_F(SurfaceMeshTest, texcoord16_property)
+{
+    add_grid(4);
+    auto tex = mesh.add_halfedge_property<TexCoord16>("h:tex");
+    EXPECT_EQ(sizeof(TexCoord16), size_t(4));
+    for (auto h : mesh.halfedges())
+    {
+        const TexCoord t(Scalar(h.idx()) / mesh.n_halfedges(), 0.3);
+        tex[h] = t;
+        const TexCoord s = tex[h];
+        EXPECT_NEAR(s[0], t[0], 0.5 / 65535 + 1e-7);
+        EXPECT_NEAR(s[1], t[1], 0.5 / 65535 + 1e-7);
+    }
+
+    // coordinates outside of [0, 1] are clamped
+    tex[Halfedge(0)] = TexCoord(-1, 2);
+    EXPECT_EQ(TexCoord(tex[Halfedge(0)]), TexCoord(0, 1));
+    EXPECT_EQ(tex[Halfedge(0)][1], 65535);
+}
+
+TEST_F(SurfaceMeshTest, memory_stats)
+{
+    add_grid(4);
+    auto stats = mesh.memory_stats();
+    EXPECT_GT(stats.connectivity, size_t(0));
+    EXPECT_LT(stats.connectivity, stats.size());
+    EXPECT_LE(stats.size(), stats.capacity());
+    EXPECT_EQ(stats.deleted, size_t(0));
+
+    const size_t size = stats.size();
+    auto weights = mesh.add_vertex_property<double>("v:weight");
+    EXPECT_EQ(mesh.memory_stats().size(), size + 25 * sizeof(double));
+
+    mesh.remove_vertex_property(weights);
+    EXPECT_EQ(mesh.memory_stats().size(), size);
+
+    mesh.delete_face(Face(0));
+    EXPECT_GT(mesh.memory_stats().deleted, size_t(0));
+    mesh.garbage_collection();
+    EXPECT_EQ(mesh.memory_stats().deleted, size_t(0));
+    EXPECT_LT(mesh.memory_stats().size(), size);
+}
+
+TEST_F(SurfaceMeshTest, reserve_growth)
+{
+    auto capacity = [&](const std::string& name) {
+        for (const auto& p : mesh.memory_stats().vertex_properties)
+            if (p.name == name)
+                return p.capacity;
+        return size_t(0);
+    };
+
+    EXPECT_EQ(mesh.growth_factor(), 2.0f);
+    mesh.reserve(100, 0, 0);
+    EXPECT_EQ(capacity("v:point"), 100 * sizeof(Point));
+
+    // exceeding the capacity grows by the growth factor
+    mesh.reserve(101, 0, 0);
+    EXPECT_EQ(capacity("v:point"), 200 * sizeof(Point));
+    mesh.set_growth_factor(1.5f);
+    for (int i = 0; i < 201; ++i)
+        mesh.add_vertex(Point(0, 0, 0));
+    EXPECT_EQ(capacity("v:point"), 300 * sizeof(Point));
+
+    // new properties get the same capacity
+    mesh.add_vertex_property<double>("v:weight");
+    EXPECT_EQ(capacity("v:weight"), 300 * sizeof(double));
+
+    mesh.free_memory();
+    EXPECT_EQ(capacity("v:point"), 201 * sizeof(Point));
+}
+
+TEST_F(SurfaceMeshTest, prev_halfedge_property)
+{
+    // quads and triangles around a hole and a deleted corner
+    add_grid(3);
+    mesh.triangulate(Face(1));
+    mesh.delete_face(Face(4));
+    mesh.delete_face(Face(0));
+
+    auto prev = mesh.add_prev_halfedge_property();
+    for (auto h : mesh.halfedges())
+    {
+        EXPECT_EQ(prev[h], mesh.prev_halfedge(h));
+        EXPECT_EQ(mesh.next_halfedge(prev[h]), h);
+    }
+    mesh.remove_halfedge_property(prev);
+}
+
+// the changes of an element in a journal list, zero if not listed
+template <class Handle>
+int changes(const std::vector<std::pair<Handle, unsigned char>>& list,
+            Handle handle)
+{
+    for (auto entry : list)
+        if (entry.first == handle)
+            return entry.second;
+    return 0;
+}
+
+TEST_F(SurfaceMeshTest, change_journal)
+{
+    add_quad();
+    mesh.triangulate();
+    mesh.begin_journal();
+    EXPECT_TRUE(mesh.journal().vertices.empty());
+
+    // the new vertex of a face split
+    auto v = mesh.split(f0, Point(0.5, 0.5, 0));
+    const auto& journal = mesh.journal();
+    EXPECT_EQ(changes(journal.vertices, v),
+              SurfaceMesh::ChangeJournal::Created |
+                  SurfaceMesh::ChangeJournal::Modified);
+    EXPECT_EQ(changes(journal.faces, f0), SurfaceMesh::ChangeJournal::Modified);
+    EXPECT_EQ(journal.vertices.size(), size_t(4));
+    EXPECT_EQ(journal.edges.size(), size_t(6));
+    EXPECT_EQ(journal.faces.size(), size_t(3));
+
+    // collapsing the new vertex restores the two triangles
+    mesh.clear_journal();
+    EXPECT_TRUE(mesh.journal().faces.empty());
+    auto h = mesh.halfedge(v);
+    ASSERT_TRUE(mesh.is_collapse_ok(h));
+    mesh.collapse(h);
+    EXPECT_TRUE(changes(journal.vertices, v) &
+                SurfaceMesh::ChangeJournal::Deleted);
+    EXPECT_TRUE(changes(journal.vertices, mesh.to_vertex(h)) &
+                SurfaceMesh::ChangeJournal::Modified);
+    size_t n_deleted = 0;
+    for (auto entry : journal.faces)
+        if (entry.second & SurfaceMesh::ChangeJournal::Deleted)
+            ++n_deleted;
+    EXPECT_EQ(n_deleted, size_t(2));
+
+    // positions are only recorded by set_position()
+    mesh.clear_journal();
+    mesh.position(v1) = Point(2, 0, 0);
+    EXPECT_TRUE(journal.vertices.empty());
+    mesh.set_position(v1, Point(1, 0, 0));
+    ASSERT_EQ(journal.vertices.size(), size_t(1));
+    EXPECT_EQ(journal.vertices[0].second, SurfaceMesh::ChangeJournal::Moved);
+
+    // renumbering invalidates all handles
+    EXPECT_FALSE(journal.reset);
+    mesh.garbage_collection();
+    EXPECT_TRUE(journal.reset);
+    EXPECT_TRUE(journal.vertices.empty());
+
+    mesh.end_journal();
+    EXPECT_FALSE(mesh.has_journal());
+}
+
+TEST_F(SurfaceMeshTest, reset)
+{
+    add_grid(4);
+    auto points = mesh.get_vertex_property<Point>("v:point");
+    const Point* data = points.data();
+    mesh.add_vertex_property<int>("v:value");
+    mesh.delete_face(Face(0));
+
+    mesh.reset();
+    EXPECT_TRUE(mesh.is_empty());
+    EXPECT_EQ(mesh.vertices_size(), size_t(0));
+    EXPECT_EQ(mesh.halfedges_size(), size_t(0));
+    EXPECT_EQ(mesh.faces_size(), size_t(0));
+    EXPECT_FALSE(mesh.has_vertex_property("v:value"));
+
+    // the standard properties keep their memory
+    add_grid(4);
+    EXPECT_EQ(points.data(), data);
+    EXPECT_EQ(mesh.n_faces(), size_t(16));
+    EXPECT_EQ(mesh.n_vertices(), size_t(25));
+}
+
+TEST_F(SurfaceMeshTest, element_recycling)
+{
+    add_grid(4);
+    mesh.triangulate();
+    mesh.set_element_recycling(true);
+    auto value = mesh.add_vertex_property<int>("v:value", -1);
+    for (auto v : mesh.vertices())
+        value[v] = 1;
+
+    // collapsing the center vertex and splitting a face keeps the sizes
+    const size_t nv = mesh.vertices_size();
+    const size_t ne = mesh.edges_size();
+    const size_t nf = mesh.faces_size();
+    const Vertex center(12);
+    for (int i = 0; i < 3; ++i)
+    {
+        const Halfedge h = mesh.halfedge(center);
+        const Vertex target = mesh.to_vertex(h);
+        const Point p = mesh.position(center);
+        ASSERT_TRUE(mesh.is_collapse_ok(h));
+        mesh.collapse(h);
+        EXPECT_TRUE(mesh.is_deleted(center));
+
+        const Vertex v = mesh.split(mesh.face(mesh.halfedge(target)), p);
+        EXPECT_EQ(v, center);
+        EXPECT_EQ(value[v], -1);
+        value[v] = 1;
+
+        EXPECT_EQ(mesh.vertices_size(), nv);
+        EXPECT_EQ(mesh.edges_size(), ne);
+        EXPECT_EQ(mesh.faces_size(), nf);
+        EXPECT_EQ(mesh.n_faces(), nf);
+    }
+
+    // deleted faces and edges are re-used by add_face()
+    const Face f = mesh.face(mesh.find_halfedge(Vertex(1), Vertex(2)));
+    std::vector<Vertex> vertices;
+    for (auto v : mesh.vertices(f))
+        vertices.push_back(v);
+    mesh.delete_face(f);
+    EXPECT_EQ(mesh.n_edges(), ne - 1);
+    EXPECT_EQ(mesh.add_face(vertices), f);
+    EXPECT_EQ(mesh.edges_size(), ne);
+    EXPECT_EQ(mesh.faces_size(), nf);
+
+    // garbage collection renumbers the free elements
+    mesh.delete_vertex(center);
+    mesh.garbage_collection();
+    EXPECT_EQ(mesh.add_vertex(Point(0, 0, 0)), Vertex(nv - 1));
+}
+
 //=============================================================================
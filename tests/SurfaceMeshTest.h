@@ -12,6 +12,9 @@
 #include "gtest/gtest.h"
 
 #include <pmp/SurfaceMesh.h>
+
+#include <cmath>
+#include <functional>
 #include <vector>
 
 class SurfaceMeshTest : public ::testing::Test
@@ -38,4 +41,67 @@ public:
         v3 = mesh.add_vertex(Point(0,1,0));
         f0 = mesh.add_quad(v0,v1,v2,v3);
     }
+
+    // regular n x n grid of quads in the xy-plane
+    void add_grid(unsigned int n)
+    {
+        add_quad_grid(mesh, n, [](unsigned int i, unsigned int j) {
+            return Point(i, j, 0);
+        });
+    }
+
+    // the position of vertex (i, j) of a grid
+    typedef std::function<Point(unsigned int, unsigned int)> GridPosition;
+
+    // the wavy height field z = sin(i / 2) cos(3 j / 10) over the grid
+    static Point wavy(unsigned int i, unsigned int j)
+    {
+        return Point(i, j, std::sin(0.5 * i) * std::cos(0.3 * j));
+    }
+
+    // (n + 1) x (n + 1) grid vertices added to m, returned row by row
+    static std::vector<pmp::Vertex> add_grid_vertices(
+        pmp::SurfaceMesh& m, unsigned int n, const GridPosition& position)
+    {
+        std::vector<pmp::Vertex> vertices;
+        for (unsigned int j = 0; j <= n; ++j)
+            for (unsigned int i = 0; i <= n; ++i)
+                vertices.push_back(m.add_vertex(position(i, j)));
+        return vertices;
+    }
+
+    // n x n grid of quads added to m, returns the vertices row by row
+    static std::vector<pmp::Vertex> add_quad_grid(
+        pmp::SurfaceMesh& m, unsigned int n, const GridPosition& position)
+    {
+        auto vertices = add_grid_vertices(m, n, position);
+        for (unsigned int j = 0; j < n; ++j)
+            for (unsigned int i = 0; i < n; ++i)
+            {
+                auto v = j * (n + 1) + i;
+                m.add_quad(vertices[v], vertices[v + 1], vertices[v + n + 2],
+                           vertices[v + n + 1]);
+            }
+        return vertices;
+    }
+
+    // n x n grid of triangles added to m, returns the vertices row by row
+    static std::vector<pmp::Vertex> add_triangle_grid(
+        pmp::SurfaceMesh& m, unsigned int n, const GridPosition& position)
+    {
+        auto vertices = add_grid_vertices(m, n, position);
+        for (unsigned int j = 0; j < n; ++j)
+            for (unsigned int i = 0; i < n; ++i)
+            {
+                auto v = j * (n + 1) + i;
+                m.add_triangle(vertices[v], vertices[v + 1],
+                               vertices[v + n + 2]);
+                m.add_triangle(vertices[v], vertices[v + n + 2],
+                               vertices[v + n + 1]);
+            }
+        return vertices;
+    }
+
+    // a wavy n x n grid of triangles
+    void add_triangle_grid(unsigned int n) { add_triangle_grid(mesh, n, wavy); }
 };
@@ -0,0 +1,115 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include "SurfaceMeshTest.h"
+
+#include <pmp/algorithms/SurfaceNeighborhood.h>
+
+#include <cmath>
+
+using namespace pmp;
+
+class SurfaceNeighborhoodTest : public SurfaceMeshTest
+{
+public:
+    // the vertex at (i, j) of a grid added by add_grid(n)
+    Vertex grid_vertex(unsigned int n, unsigned int i, unsigned int j)
+    {
+        return Vertex(j * (n + 1) + i);
+    }
+};
+
+TEST_F(SurfaceNeighborhoodTest, rings)
+{
+    // on a quad grid, the k-rings are diamonds of 2k^2 + 2k + 1 vertices
+    add_grid(10);
+    SurfaceNeighborhood neighborhood(mesh);
+    const Vertex center = grid_vertex(10, 5, 5);
+    for (unsigned int k = 0; k <= 5; ++k)
+    {
+        const std::vector<Vertex>& rings = neighborhood.rings(center, k);
+        ASSERT_EQ(rings.size(), 2 * k * k + 2 * k + 1);
+        EXPECT_EQ(rings[0], center);
+        for (unsigned int i = 0; i <= k; ++i)
+            EXPECT_EQ(neighborhood.ring_end(i), 2 * i * i + 2 * i + 1);
+        for (auto v : mesh.vertices())
+        {
+            const Point d = mesh.position(v) - mesh.position(center);
+            const bool inside = std::abs(d[0]) + std::abs(d[1]) <= k;
+            EXPECT_EQ(neighborhood.contains(v), inside);
+        }
+    }
+
+    // rings beyond the mesh stop at its boundary
+    EXPECT_EQ(neighborhood.rings(center, 100).size(), mesh.n_vertices());
+}
+
+TEST_F(SurfaceNeighborhoodTest, seeds)
+{
+    add_grid(10);
+    SurfaceNeighborhood neighborhood(mesh);
+    std::vector<Vertex> seeds;
+    for (unsigned int i = 0; i <= 10; ++i)
+        seeds.push_back(grid_vertex(10, i, 0));
+    seeds.push_back(seeds[0]);
+
+    // the seeds without duplicates, then the rows above them
+    const std::vector<Vertex>& rings = neighborhood.rings(seeds, 2);
+    EXPECT_EQ(rings.size(), 33u);
+    EXPECT_EQ(neighborhood.ring_end(0), 11u);
+    EXPECT_EQ(neighborhood.ring_end(1), 22u);
+    for (size_t i = 0; i < rings.size(); ++i)
+        EXPECT_EQ(mesh.position(rings[i])[1], Scalar(i / 11));
+}
+
+TEST_F(SurfaceNeighborhoodTest, within)
+{
+    add_grid(10);
+    SurfaceNeighborhood neighborhood(mesh);
+    const Vertex center = grid_vertex(10, 5, 5);
+    const Scalar radius = 2.5;
+    const std::vector<Vertex>& ball = neighborhood.within(center, radius);
+    size_t n = 0;
+    for (auto v : mesh.vertices())
+    {
+        const bool inside =
+            norm(mesh.position(v) - mesh.position(center)) <= radius;
+        EXPECT_EQ(neighborhood.contains(v), inside);
+        n += inside;
+    }
+    EXPECT_EQ(ball.size(), n);
+}
+
+TEST_F(SurfaceNeighborhoodTest, within_connected)
+{
+    // the vertices of another triangle in the ball are not connected
+    add_triangle();
+    auto a = mesh.add_vertex(Point(0, 0, 0.1));
+    auto b = mesh.add_vertex(Point(1, 0, 0.1));
+    auto c = mesh.add_vertex(Point(0, 1, 0.1));
+    mesh.add_triangle(a, b, c);
+
+    SurfaceNeighborhood neighborhood(mesh);
+    EXPECT_EQ(neighborhood.within(v0, 10).size(), 3u);
+    EXPECT_FALSE(neighborhood.contains(a));
+}
+
+TEST_F(SurfaceNeighborhoodTest, growing_mesh)
+{
+    add_triangle();
+    SurfaceNeighborhood neighborhood(mesh);
+    EXPECT_EQ(neighborhood.rings(v0, 1).size(), 3u);
+
+    // vertices added between queries are found
+    auto v3 = mesh.add_vertex(Point(1, 1, 0));
+    mesh.add_triangle(v1, v3, v2);
+    EXPECT_EQ(neighborhood.rings(v0, 2).size(), 4u);
+    EXPECT_EQ(neighborhood.rings(v3, 0).size(), 1u);
+    EXPECT_FALSE(neighborhood.contains(v0));
+}
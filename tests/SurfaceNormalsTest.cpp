@@ -58,3 +58,59 @@ TEST_F(SurfaceNormalsTest, polygonal_face_normal)
     auto n0 = SurfaceNormals::compute_face_normal(mesh,f0);
     EXPECT_GT(norm(n0), 0);
 }
+
+TEST_F(SurfaceNormalsTest, update_normals)
+{
+    // a 4 x 4 grid of triangles
+    for (int j = 0; j < 5; ++j)
+        for (int i = 0; i < 5; ++i)
+            mesh.add_vertex(Point(i, j, 0));
+    for (int j = 0; j < 4; ++j)
+        for (int i = 0; i < 4; ++i)
+        {
+            const int v = 5 * j + i;
+            mesh.add_triangle(Vertex(v), Vertex(v + 1), Vertex(v + 6));
+            mesh.add_triangle(Vertex(v), Vertex(v + 6), Vertex(v + 5));
+        }
+    SurfaceNormals::compute_vertex_normals(mesh);
+    SurfaceNormals::compute_face_normals(mesh);
+
+    // move the center and update its faces
+    const Vertex v(12);
+    mesh.position(v) = Point(2.2, 1.9, 0.5);
+    std::vector<Face> faces;
+    for (auto f : mesh.faces(v))
+        faces.push_back(f);
+    SurfaceNormals::update_normals(mesh, faces);
+
+    auto vnormals = mesh.get_vertex_property<Normal>("v:normal");
+    auto fnormals = mesh.get_face_property<Normal>("f:normal");
+    for (auto w : mesh.vertices())
+        EXPECT_EQ(vnormals[w], SurfaceNormals::compute_vertex_normal(mesh, w));
+    for (auto f : mesh.faces())
+        EXPECT_EQ(fnormals[f], SurfaceNormals::compute_face_normal(mesh, f));
+    EXPECT_LT(vnormals[v][2], 1);
+}
+
+TEST_F(SurfaceNormalsTest, vertex_normal_weighting)
+{
+    // an irregular fan around a vertex
+    const Vertex center = mesh.add_vertex(Point(0, 0, 0.3));
+    std::vector<Vertex> ring;
+    const Scalar angles[] = {0, 0.4, 1.9, 2.2, 3.5, 5.1};
+    for (Scalar a : angles)
+        ring.push_back(mesh.add_vertex(Point(cos(a), sin(a), 0.2 * a - 0.5)));
+    for (size_t i = 0; i < ring.size(); ++i)
+        mesh.add_triangle(center, ring[i], ring[(i + 1) % ring.size()]);
+
+    const Normal angle = SurfaceNormals::compute_vertex_normal(mesh, center);
+    const Normal approximate = SurfaceNormals::compute_vertex_normal(
+        mesh, center, SurfaceNormals::ApproximateAngle);
+    const Normal area = SurfaceNormals::compute_vertex_normal(
+        mesh, center, SurfaceNormals::Area);
+
+    EXPECT_LT(norm(approximate - angle), 1e-4);
+    EXPECT_NEAR(norm(area), 1, 1e-5);
+    EXPECT_GT(dot(area, angle), 0.9);
+    EXPECT_GT(norm(area - angle), 1e-3);
+}
@@ -7,10 +7,13 @@
 // SPDX-License-Identifier: MIT
 //=============================================================================
 
-#include "gtest/gtest.h"
+#include "SurfaceMeshTest.h"
 
 #include <pmp/algorithms/SurfaceParameterization.h>
 
+#include <algorithm>
+#include <cmath>
+
 using namespace pmp;
 
 class SurfaceParameterizationTest : public ::testing::Test
@@ -39,3 +42,208 @@ TEST_F(SurfaceParameterizationTest, lscm)
     auto tex = mesh.vertex_property<TexCoord>("v:tex");
     EXPECT_TRUE(tex);
 }
+
+// a triangulated, curved grid of n x n quads, shifted by offset
+static void add_curved_grid(SurfaceMesh& mesh, unsigned int n, Scalar offset)
+{
+    SurfaceMeshTest::add_triangle_grid(
+        mesh, n, [=](unsigned int i, unsigned int j) {
+            const Scalar x = Scalar(i) / n, y = Scalar(j) / n;
+            return Point(x + offset, y,
+                         0.3 * std::sin(3 * x) * std::cos(2 * y));
+        });
+}
+
+TEST(SurfaceParameterizationChartTest, charts)
+{
+    SurfaceMesh mesh;
+    add_curved_grid(mesh, 10, 0);
+    add_curved_grid(mesh, 6, 2);
+    const unsigned int n_first = 11 * 11;
+
+    SurfaceParameterization param(mesh);
+    param.harmonic();
+    auto tex = mesh.vertex_property<TexCoord>("v:tex");
+
+    // each boundary is mapped to the circle of the unit square
+    for (auto v : mesh.vertices())
+    {
+        if (mesh.is_boundary(v))
+        {
+            EXPECT_NEAR(norm(tex[v] - TexCoord(0.5, 0.5)), 0.5, 1e-5);
+        }
+    }
+
+    // each chart is scaled to the unit square
+    param.lscm();
+    for (int chart = 0; chart < 2; ++chart)
+    {
+        TexCoord bbmin(1, 1), bbmax(0, 0);
+        for (auto v : mesh.vertices())
+        {
+            if ((v.idx() < n_first) == (chart == 0))
+            {
+                bbmin = min(bbmin, tex[v]);
+                bbmax = max(bbmax, tex[v]);
+            }
+        }
+        EXPECT_NEAR(std::min(bbmin[0], bbmin[1]), 0.0, 1e-5);
+        EXPECT_NEAR(std::max(bbmax[0], bbmax[1]), 1.0, 1e-5);
+    }
+}
+
+TEST(SurfaceParameterizationChartTest, coarse_vertices)
+{
+    for (bool lscm : {false, true})
+    {
+        SurfaceMesh direct, warm;
+        add_curved_grid(direct, 30, 0);
+        add_curved_grid(warm, 30, 0);
+
+        SurfaceParameterization param(direct);
+        SurfaceParameterization coarse_param(warm);
+        coarse_param.set_coarse_vertices(200);
+        if (lscm)
+        {
+            param.lscm();
+            coarse_param.lscm();
+        }
+        else
+        {
+            param.harmonic();
+            coarse_param.harmonic();
+        }
+
+        auto tex = direct.vertex_property<TexCoord>("v:tex");
+        auto coarse_tex = warm.vertex_property<TexCoord>("v:tex");
+        for (auto v : direct.vertices())
+            EXPECT_NEAR(norm(tex[v] - coarse_tex[v]), 0.0, 1e-4);
+    }
+}
+
+TEST(SurfaceParameterizationChartTest, harmonic_persistent)
+{
+    SurfaceMesh mesh, reference;
+    add_curved_grid(mesh, 10, 0);
+    add_curved_grid(reference, 10, 0);
+
+    // the first call maps the boundary to the circle as harmonic()
+    SurfaceParameterization param(mesh);
+    param.harmonic_persistent();
+    SurfaceParameterization(reference).harmonic();
+    auto tex = mesh.vertex_property<TexCoord>("v:tex");
+    auto reference_tex = reference.vertex_property<TexCoord>("v:tex");
+    for (auto v : mesh.vertices())
+        EXPECT_NEAR(norm(tex[v] - reference_tex[v]), 0.0, 1e-5);
+
+    // another boundary reuses the factorization
+    for (auto v : mesh.vertices())
+        if (mesh.is_boundary(v))
+        {
+            const Point& p = mesh.position(v);
+            tex[v] = reference_tex[v] = TexCoord(p[0], p[1]);
+        }
+    param.harmonic_persistent();
+    SurfaceParameterization(reference).harmonic_persistent();
+    for (auto v : mesh.vertices())
+        EXPECT_NEAR(norm(tex[v] - reference_tex[v]), 0.0, 1e-5);
+
+    // a changed topology is factored again
+    add_curved_grid(mesh, 5, 2);
+    add_curved_grid(reference, 5, 2);
+    for (auto v : mesh.vertices())
+        if (mesh.is_boundary(v) && v.idx() >= 121)
+        {
+            const Point& p = mesh.position(v);
+            tex[v] = reference_tex[v] = TexCoord(p[0], p[1]);
+        }
+    param.harmonic_persistent();
+    SurfaceParameterization(reference).harmonic_persistent();
+    for (auto v : mesh.vertices())
+        EXPECT_NEAR(norm(tex[v] - reference_tex[v]), 0.0, 1e-5);
+    EXPECT_GT(tex[Vertex(121 + 3 * 6 + 3)][0], 2);
+}
+
+TEST(SurfaceParameterizationChartTest, atlas)
+{
+    // a cube of six charts
+    SurfaceMesh mesh;
+    for (int i = 0; i < 8; ++i)
+        mesh.add_vertex(Point(i & 1, (i >> 1) & 1, (i >> 2) & 1));
+    const int quads[6][4] = {{0, 2, 3, 1}, {4, 5, 7, 6}, {0, 1, 5, 4},
+                             {2, 6, 7, 3}, {0, 4, 6, 2}, {1, 3, 7, 5}};
+    for (auto q : quads)
+    {
+        mesh.add_triangle(Vertex(q[0]), Vertex(q[1]), Vertex(q[2]));
+        mesh.add_triangle(Vertex(q[0]), Vertex(q[2]), Vertex(q[3]));
+    }
+
+    SurfaceParameterization param(mesh);
+    EXPECT_TRUE(param.atlas());
+    auto htex = mesh.get_halfedge_property<TexCoord>("h:tex");
+    auto fchart = mesh.get_face_property<int>("f:chart");
+    ASSERT_TRUE(htex && fchart);
+
+    // the charts are scaled alike and do not overlap
+    std::vector<TexCoord> bbmin(6, TexCoord(1, 1)), bbmax(6, TexCoord(0, 0));
+    std::vector<Scalar> ratios;
+    for (auto f : mesh.faces())
+    {
+        ASSERT_GE(fchart[f], 0);
+        ASSERT_LT(fchart[f], 6);
+        std::vector<TexCoord> t;
+        for (auto h : mesh.halfedges(f))
+        {
+            t.push_back(htex[h]);
+            bbmin[fchart[f]] = min(bbmin[fchart[f]], htex[h]);
+            bbmax[fchart[f]] = max(bbmax[fchart[f]], htex[h]);
+        }
+        const Scalar area = (t[1][0] - t[0][0]) * (t[2][1] - t[0][1]) -
+                            (t[1][1] - t[0][1]) * (t[2][0] - t[0][0]);
+        EXPECT_GT(area, 0);
+        ratios.push_back(area);
+    }
+    for (auto ratio : ratios)
+        EXPECT_NEAR(ratio, ratios[0], 1e-4);
+    for (int i = 0; i < 6; ++i)
+    {
+        EXPECT_GE(std::min(bbmin[i][0], bbmin[i][1]), 0.0);
+        EXPECT_LE(std::max(bbmax[i][0], bbmax[i][1]), 1.0);
+        for (int j = 0; j < i; ++j)
+            EXPECT_TRUE(bbmax[i][0] <= bbmin[j][0] ||
+                        bbmax[j][0] <= bbmin[i][0] ||
+                        bbmax[i][1] <= bbmin[j][1] ||
+                        bbmax[j][1] <= bbmin[i][1]);
+    }
+
+    // a curved grid, split into charts where the normals vary too much,
+    // is continuous inside its charts
+    SurfaceMesh grid;
+    add_curved_grid(grid, 20, 0);
+    SurfaceParameterization grid_param(grid);
+    EXPECT_TRUE(grid_param.atlas(10.0));
+    htex = grid.get_halfedge_property<TexCoord>("h:tex");
+    fchart = grid.get_face_property<int>("f:chart");
+    int n_charts = 0;
+    for (auto f : grid.faces())
+        n_charts = std::max(n_charts, fchart[f] + 1);
+    EXPECT_GT(n_charts, 1);
+    for (auto h : grid.halfedges())
+    {
+        const Halfedge o = grid.opposite_halfedge(h);
+        if (!grid.is_boundary(h) && !grid.is_boundary(o) &&
+            fchart[grid.face(h)] == fchart[grid.face(o)])
+        {
+            EXPECT_NEAR(norm(htex[h] - htex[grid.prev_halfedge(o)]), 0.0,
+                        1e-5);
+        }
+    }
+
+    // polygons are not supported
+    SurfaceMesh quad;
+    quad.add_quad(quad.add_vertex(Point(0, 0, 0)),
+                  quad.add_vertex(Point(1, 0, 0)),
+                  quad.add_vertex(Point(1, 1, 0)),
+                  quad.add_vertex(Point(0, 1, 0)));
+    EXPECT_FALSE(SurfaceParameterization(quad).atlas());
+}
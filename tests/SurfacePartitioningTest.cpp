@@ -0,0 +1,139 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include "SurfaceMeshTest.h"
+
+#include <pmp/algorithms/SurfacePartitioning.h>
+
+using namespace pmp;
+
+class SurfacePartitioningTest : public SurfaceMeshTest
+{
+public:
+    // are the faces of each part connected by edges?
+    bool is_contiguous(unsigned int n_parts)
+    {
+        auto fpart = mesh.get_face_property<IndexType>("f:part");
+        for (unsigned int part = 0; part < n_parts; ++part)
+        {
+            std::vector<char> visited(mesh.faces_size(), 0);
+            std::vector<Face> stack;
+            size_t n_faces = 0, n_visited = 0;
+            for (auto f : mesh.faces())
+            {
+                if (fpart[f] != part)
+                    continue;
+                ++n_faces;
+                if (stack.empty() && !n_visited)
+                {
+                    stack.push_back(f);
+                    visited[f.idx()] = 1;
+                }
+                while (!stack.empty())
+                {
+                    const Face g = stack.back();
+                    stack.pop_back();
+                    ++n_visited;
+                    for (auto h : mesh.halfedges(g))
+                    {
+                        const Face n = mesh.face(mesh.opposite_halfedge(h));
+                        if (n.is_valid() && fpart[n] == part &&
+                            !visited[n.idx()])
+                        {
+                            visited[n.idx()] = 1;
+                            stack.push_back(n);
+                        }
+                    }
+                }
+            }
+            if (n_visited != n_faces)
+                return false;
+        }
+        return true;
+    }
+};
+
+TEST_F(SurfacePartitioningTest, partition)
+{
+    add_grid(30);
+    SurfacePartitioning partitioning(mesh);
+    partitioning.partition(5);
+    EXPECT_EQ(partitioning.n_parts(), 5u);
+
+    for (auto size : partitioning.part_sizes())
+        EXPECT_NEAR(double(size), 900.0 / 5, 10.0);
+    EXPECT_TRUE(is_contiguous(5));
+
+    // compact parts, the cut is close to the one of five stripes
+    EXPECT_LE(partitioning.edge_cut(), size_t(4 * 30));
+}
+
+TEST_F(SurfacePartitioningTest, extract)
+{
+    add_grid(10);
+    SurfacePartitioning partitioning(mesh);
+    partitioning.partition(4);
+
+    std::vector<int> owners(mesh.vertices_size(), 0);
+    size_t n_faces = 0;
+    for (unsigned int part = 0; part < 4; ++part)
+    {
+        SurfaceMesh result;
+        EXPECT_TRUE(partitioning.extract(part, result, 1));
+        auto vglobal = result.get_vertex_property<IndexType>("v:global");
+        auto vowned = result.get_vertex_property<bool>("v:owned");
+        auto fglobal = result.get_face_property<IndexType>("f:global");
+        auto fhalo = result.get_face_property<bool>("f:halo");
+        ASSERT_TRUE(vglobal && vowned && fglobal && fhalo);
+
+        size_t n_halo = 0;
+        for (auto f : result.faces())
+        {
+            if (fhalo[f])
+            {
+                ++n_halo;
+                continue;
+            }
+            ++n_faces;
+        }
+        EXPECT_GT(n_halo, size_t(0));
+        EXPECT_EQ(result.n_faces() - n_halo, partitioning.part_sizes()[part]);
+
+        for (auto v : result.vertices())
+        {
+            EXPECT_EQ(result.position(v),
+                      mesh.position(Vertex(vglobal[v])));
+            if (vowned[v])
+                ++owners[vglobal[v]];
+        }
+    }
+    EXPECT_EQ(n_faces, mesh.n_faces());
+
+    // each vertex is owned by exactly one part
+    for (auto v : mesh.vertices())
+        EXPECT_EQ(owners[v.idx()], 1);
+}
+
+TEST_F(SurfacePartitioningTest, update_positions)
+{
+    add_grid(10);
+    SurfacePartitioning partitioning(mesh);
+    partitioning.partition(3);
+
+    for (unsigned int part = 0; part < 3; ++part)
+    {
+        SurfaceMesh result;
+        partitioning.extract(part, result, 0);
+        for (auto v : result.vertices())
+            result.position(v)[2] = 1;
+        partitioning.update_positions(result);
+    }
+    for (auto v : mesh.vertices())
+        EXPECT_EQ(mesh.position(v)[2], 1);
+}
@@ -11,6 +11,11 @@
 
 #include <pmp/algorithms/SurfaceRemeshing.h>
 #include <pmp/algorithms/SurfaceFeatures.h>
+#include <pmp/algorithms/DifferentialGeometry.h>
+#include <pmp/algorithms/SurfaceFactory.h>
+
+#include <algorithm>
+#include <cfloat>
 
 using namespace pmp;
 
@@ -87,3 +92,125 @@ TEST_F(SurfaceRemeshingTest, uniform_remeshing)
     SurfaceRemeshing(mesh).uniform_remeshing(l);
     EXPECT_EQ(mesh.n_vertices(),size_t(642));
 }
+
+TEST_F(SurfaceRemeshingTest, parallel_uniform_remeshing)
+{
+    Scalar l(0);
+    for (auto eit : mesh.edges())
+        l += distance(mesh.position(mesh.vertex(eit, 0)),
+                      mesh.position(mesh.vertex(eit, 1)));
+    l /= (Scalar)mesh.n_edges();
+
+    SurfaceMesh serial = mesh;
+    SurfaceRemeshing(serial).uniform_remeshing(2 * l);
+
+    SurfaceRemeshing remeshing(mesh);
+    remeshing.set_parallel(true);
+    remeshing.uniform_remeshing(2 * l);
+
+    // coarsened by the same amount, but not necessarily identically
+    EXPECT_TRUE(mesh.is_triangle_mesh());
+    EXPECT_LT(mesh.n_vertices(), size_t(642));
+    EXPECT_NEAR(Scalar(mesh.n_vertices()), Scalar(serial.n_vertices()),
+                0.1 * serial.n_vertices());
+}
+
+TEST_F(SurfaceRemeshingTest, convergence_threshold)
+{
+    Scalar l(0);
+    for (auto eit : mesh.edges())
+        l += distance(mesh.position(mesh.vertex(eit, 0)),
+                      mesh.position(mesh.vertex(eit, 1)));
+    l /= (Scalar)mesh.n_edges();
+
+    SurfaceMesh all = mesh;
+    SurfaceRemeshing(all).uniform_remeshing(2 * l);
+
+    SurfaceRemeshing remeshing(mesh);
+    remeshing.set_convergence_threshold(0.01);
+    remeshing.uniform_remeshing(2 * l);
+
+    // only revisits the changing vertices, similar result
+    EXPECT_TRUE(mesh.is_triangle_mesh());
+    EXPECT_FALSE(mesh.has_vertex_property("v:active"));
+    EXPECT_NEAR(Scalar(mesh.n_vertices()), Scalar(all.n_vertices()),
+                0.1 * all.n_vertices());
+}
+
+TEST_F(SurfaceRemeshingTest, region_remeshing)
+{
+    Scalar l(0);
+    for (auto eit : mesh.edges())
+        l += distance(mesh.position(mesh.vertex(eit, 0)),
+                      mesh.position(mesh.vertex(eit, 1)));
+    l /= (Scalar)mesh.n_edges();
+
+    // refine a cap of the sphere
+    std::vector<Face> region;
+    for (auto f : mesh.faces())
+        if (centroid(mesh, f)[0] > 0.5)
+            region.push_back(f);
+
+    std::vector<Point> outside;
+    for (auto v : mesh.vertices())
+        if (mesh.position(v)[0] < 0.0)
+            outside.push_back(mesh.position(v));
+
+    SurfaceRemeshing remeshing(mesh);
+    remeshing.set_region(region);
+    remeshing.uniform_remeshing(0.5 * l);
+    mesh.garbage_collection();
+
+    EXPECT_GT(mesh.n_vertices(), size_t(642));
+    EXPECT_TRUE(mesh.is_triangle_mesh());
+    for (auto v : mesh.vertices())
+        EXPECT_FALSE(mesh.is_boundary(v));
+    EXPECT_EQ(mesh.n_vertices() - mesh.n_edges() + mesh.n_faces(), size_t(2));
+
+    // the remaining mesh is untouched
+    std::vector<Point> remaining;
+    for (auto v : mesh.vertices())
+        if (mesh.position(v)[0] < 0.0)
+            remaining.push_back(mesh.position(v));
+    EXPECT_TRUE(remaining == outside);
+}
+
+TEST_F(SurfaceRemeshingTest, adaptive_remeshing_keeps_curvature)
+{
+    auto bb = mesh.bounds().size();
+    SurfaceRemeshing remeshing(mesh);
+    remeshing.set_keep_curvature(true);
+    remeshing.adaptive_remeshing(0.001 * bb, 1.0 * bb, 0.001 * bb);
+
+    // the curvature of a sphere is constant
+    auto curvature = mesh.get_vertex_property<Scalar>("v:max_curvature");
+    ASSERT_TRUE(curvature);
+    Scalar cmin = FLT_MAX, cmax = 0;
+    for (auto v : mesh.vertices())
+    {
+        cmin = std::min(cmin, curvature[v]);
+        cmax = std::max(cmax, curvature[v]);
+    }
+    EXPECT_GT(cmin, 0.8 * cmax);
+
+    // a flat curvature is reused and leads to the maximum edge length
+    for (auto v : mesh.vertices())
+        curvature[v] = 0;
+    SurfaceRemeshing(mesh).adaptive_remeshing(0.001 * bb, 0.2 * bb,
+                                              0.001 * bb);
+    EXPECT_FALSE(mesh.get_vertex_property<Scalar>("v:max_curvature"));
+    EXPECT_LT(mesh.n_vertices(), size_t(642));
+}
+
+// the parallel phases keep the journal intact
+TEST(SurfaceRemeshingJournalTest, parallel_remeshing_with_journal)
+{
+    SurfaceMesh mesh = SurfaceFactory::icosphere(5000);
+    mesh.begin_journal();
+    SurfaceRemeshing remeshing(mesh);
+    remeshing.set_parallel(true);
+    remeshing.uniform_remeshing(0.1, 3, false);
+    EXPECT_TRUE(mesh.is_triangle_mesh());
+    EXPECT_TRUE(mesh.journal().reset || !mesh.journal().edges.empty());
+    mesh.end_journal();
+}
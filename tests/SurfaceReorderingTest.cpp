@@ -0,0 +1,155 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include "SurfaceMeshTest.h"
+
+#include <pmp/algorithms/SurfaceReordering.h>
+#include <pmp/algorithms/DifferentialGeometry.h>
+
+#include <algorithm>
+#include <random>
+
+using namespace pmp;
+
+class SurfaceReorderingTest : public SurfaceMeshTest
+{
+};
+
+TEST_F(SurfaceReorderingTest, morton_order)
+{
+    add_grid(16);
+    mesh.triangulate();
+    mesh.delete_face(Face(3));
+
+    // scramble the element order
+    std::vector<Vertex> vorder;
+    for (auto v : mesh.vertices())
+        vorder.push_back(v);
+    std::reverse(vorder.begin(), vorder.end());
+    mesh.permute_vertices(vorder);
+
+    auto vpos = mesh.add_vertex_property<Point>("v:original");
+    for (auto v : mesh.vertices())
+        vpos[v] = mesh.position(v);
+
+    const Scalar area = surface_area(mesh);
+    const size_t nv = mesh.n_vertices();
+    const size_t nf = mesh.n_faces();
+
+    SurfaceReordering::morton_order(mesh);
+
+    EXPECT_EQ(mesh.faces_size(), nf);
+    EXPECT_EQ(mesh.n_vertices(), nv);
+    EXPECT_EQ(mesh.n_faces(), nf);
+    EXPECT_NEAR(surface_area(mesh), area, 1e-5);
+
+    // properties moved with the vertices
+    for (auto v : mesh.vertices())
+        EXPECT_EQ(vpos[v], mesh.position(v));
+
+    // the first vertex is the corner at the origin
+    EXPECT_EQ(mesh.position(Vertex(0)), Point(0, 0, 0));
+
+    for (auto h : mesh.halfedges())
+    {
+        EXPECT_EQ(mesh.prev_halfedge(mesh.next_halfedge(h)), h);
+        if (!mesh.is_boundary(h))
+        {
+            EXPECT_EQ(mesh.face(mesh.next_halfedge(h)), mesh.face(h));
+        }
+    }
+    for (auto f : mesh.faces())
+        EXPECT_EQ(mesh.face(mesh.halfedge(f)), f);
+}
+
+TEST_F(SurfaceReorderingTest, vertex_cache_order)
+{
+    add_grid(30);
+    mesh.triangulate();
+
+    // scramble the faces
+    std::vector<Face> forder;
+    for (auto f : mesh.faces())
+        forder.push_back(f);
+    std::shuffle(forder.begin(), forder.end(), std::mt19937(42));
+    mesh.permute_faces(forder);
+
+    auto fpos = mesh.add_face_property<Point>("f:original");
+    for (auto f : mesh.faces())
+        fpos[f] = centroid(mesh, f);
+    const Scalar area = surface_area(mesh);
+    const size_t nf = mesh.n_faces();
+
+    // a scrambled order misses almost every vertex, a grid needs little
+    // more than one vertex per two triangles
+    const auto ratios = SurfaceReordering::vertex_cache_order(mesh);
+    EXPECT_GT(ratios.before, 2.5);
+    EXPECT_LT(ratios.after, 0.8);
+    EXPECT_DOUBLE_EQ(ratios.after,
+                     SurfaceReordering::average_cache_miss_ratio(mesh));
+
+    EXPECT_EQ(mesh.n_faces(), nf);
+    EXPECT_NEAR(surface_area(mesh), area, 1e-3);
+    for (auto f : mesh.faces())
+        EXPECT_LT(distance(fpos[f], centroid(mesh, f)), 1e-5);
+
+    // the vertices are in the order of their first use
+    IndexType next = 0;
+    for (auto f : mesh.faces())
+        for (auto v : mesh.vertices(f))
+        {
+            EXPECT_LE(v.idx(), next);
+            next = std::max(next, v.idx() + 1);
+        }
+}
+
+TEST_F(SurfaceReorderingTest, overdraw_order)
+{
+    // the six sides of a cube, facing outward
+    add_grid(6);
+    mesh.triangulate();
+    SurfaceMesh box;
+    for (int side = 0; side < 6; ++side)
+    {
+        const int axis = side / 2;
+        const Scalar offset = side % 2 ? 6 : 0;
+        std::vector<Vertex> vertices;
+        for (auto v : mesh.vertices())
+        {
+            const Point& p = mesh.position(v);
+            Point q;
+            q[axis] = offset;
+            q[(axis + 1) % 3] = p[0];
+            q[(axis + 2) % 3] = p[1];
+            vertices.push_back(box.add_vertex(q));
+        }
+        for (auto f : mesh.faces())
+        {
+            std::vector<Vertex> corners;
+            for (auto v : mesh.vertices(f))
+                corners.push_back(vertices[v.idx()]);
+            if (side % 2 == 0)
+                std::reverse(corners.begin(), corners.end());
+            box.add_face(corners);
+        }
+    }
+
+    // every face appears once
+    const std::vector<Face> order =
+        SurfaceReordering::vertex_cache_face_order(box, 16, true);
+    ASSERT_EQ(order.size(), box.n_faces());
+    std::vector<bool> seen(box.faces_size(), false);
+    for (auto f : order)
+    {
+        EXPECT_FALSE(seen[f.idx()]);
+        seen[f.idx()] = true;
+    }
+    EXPECT_LT(SurfaceReordering::average_cache_miss_ratio(box, 16, order),
+              SurfaceReordering::average_cache_miss_ratio(box));
+}
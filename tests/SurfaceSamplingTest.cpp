@@ -0,0 +1,99 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include "SurfaceMeshTest.h"
+
+#include <pmp/algorithms/SurfaceSampling.h>
+#include <pmp/Parallel.h>
+
+using namespace pmp;
+
+class SurfaceSamplingTest : public SurfaceMeshTest
+{
+public:
+    // a triangulated 2 x 2 square in the xy-plane
+    void add_square()
+    {
+        add_grid(2);
+        mesh.triangulate();
+    }
+};
+
+TEST_F(SurfaceSamplingTest, uniform)
+{
+    add_square();
+    SurfaceSamples samples;
+    sample_uniform(mesh, 10000, samples);
+    ASSERT_EQ(samples.size(), 10000u);
+    ASSERT_EQ(samples.normals.size(), 10000u);
+    ASSERT_EQ(samples.faces.size(), 10000u);
+
+    // the samples lie on the square and cover its quarters equally
+    size_t lower_left = 0;
+    for (size_t i = 0; i < samples.size(); ++i)
+    {
+        const Point& p = samples.points[i];
+        EXPECT_NEAR(p[2], 0, 1e-5);
+        EXPECT_GE(p[0], -1e-5);
+        EXPECT_LE(p[0], 2 + 1e-5);
+        EXPECT_NEAR(std::fabs(samples.normals[i][2]), 1, 1e-5);
+        EXPECT_TRUE(mesh.is_valid(samples.faces[i]));
+        if (p[0] < 1 && p[1] < 1)
+            ++lower_left;
+    }
+    EXPECT_NEAR(lower_left, 2500, 100);
+}
+
+TEST_F(SurfaceSamplingTest, uniform_threads)
+{
+    add_square();
+    SurfaceSamples samples, serial;
+    sample_uniform(mesh, 20000, samples, 7);
+    set_num_threads(1);
+    sample_uniform(mesh, 20000, serial, 7);
+    set_num_threads(0);
+    EXPECT_EQ(samples.points, serial.points);
+    EXPECT_EQ(samples.faces, serial.faces);
+}
+
+TEST_F(SurfaceSamplingTest, poisson_disk)
+{
+    add_square();
+    SurfaceSamples samples, serial;
+    const Scalar radius = 0.1;
+    ASSERT_TRUE(sample_poisson_disk(mesh, radius, samples));
+
+    // about one sample per disk of half the radius
+    EXPECT_GT(samples.size(), 200u);
+    for (size_t i = 0; i < samples.size(); ++i)
+        for (size_t j = i + 1; j < samples.size(); ++j)
+            EXPECT_GE(distance(samples.points[i], samples.points[j]), radius);
+
+    set_num_threads(1);
+    sample_poisson_disk(mesh, radius, serial);
+    set_num_threads(0);
+    EXPECT_EQ(samples.points, serial.points);
+
+    EXPECT_FALSE(sample_poisson_disk(mesh, 0, samples));
+    EXPECT_EQ(samples.size(), 0u);
+}
+
+TEST_F(SurfaceSamplingTest, point_cloud)
+{
+    add_square();
+    SurfaceSamples samples;
+    sample_uniform(mesh, 100, samples);
+    SurfaceMesh cloud;
+    samples.to_point_cloud(cloud);
+    EXPECT_EQ(cloud.n_vertices(), 100u);
+    EXPECT_EQ(cloud.n_faces(), 0u);
+    auto vnormal = cloud.get_vertex_property<Normal>("v:normal");
+    ASSERT_TRUE(vnormal);
+    EXPECT_EQ(vnormal[Vertex(42)], samples.normals[42]);
+}
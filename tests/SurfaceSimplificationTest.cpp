@@ -10,8 +10,12 @@
 #include "gtest/gtest.h"
 
 #include <pmp/algorithms/SurfaceSimplification.h>
+#include <pmp/algorithms/SurfaceFactory.h>
 #include <pmp/algorithms/SurfaceFeatures.h>
 
+#include <algorithm>
+#include <cmath>
+
 using namespace pmp;
 
 class SurfaceSimplificationTest : public ::testing::Test
@@ -51,3 +55,62 @@ TEST_F(SurfaceSimplificationTest, simplification_with_features)
     ss.simplify(mesh.n_vertices() * 0.1);
     EXPECT_EQ(mesh.n_vertices(),size_t(64));
 }
+
+// batched simplification reaches the target complexity
+TEST_F(SurfaceSimplificationTest, batched_simplification)
+{
+    SurfaceSimplification ss(mesh);
+    ss.initialize(5); // aspect ratio
+    ss.simplify_batched(mesh.n_vertices() * 0.1);
+    EXPECT_EQ(mesh.n_vertices(),size_t(64));
+    EXPECT_EQ(mesh.n_faces(),size_t(124));
+    EXPECT_TRUE(mesh.is_triangle_mesh());
+}
+
+// stop at a face count or at a quadric error
+TEST_F(SurfaceSimplificationTest, stop_criteria)
+{
+    SurfaceSimplification ss(mesh);
+    ss.initialize(5); // aspect ratio
+
+    SurfaceSimplification::StopCriteria criteria;
+    criteria.n_faces = 1000;
+    ss.simplify(criteria);
+    EXPECT_EQ(mesh.n_faces(),size_t(1000));
+
+    criteria.n_faces = 0;
+    criteria.max_error = 1e-3;
+    ss.simplify(criteria);
+    EXPECT_LT(mesh.n_faces(),size_t(1000));
+    EXPECT_GT(mesh.n_faces(),size_t(124));
+}
+
+// the lean mode simplifies to the same size with a similar error
+TEST(SurfaceSimplificationLeanTest, lean_mode)
+{
+    SurfaceMesh lean = SurfaceFactory::icosphere(20000);
+    SurfaceMesh reference = lean;
+    const size_t n_vertices = lean.n_vertices();
+
+    SurfaceSimplification ss(lean);
+    ss.set_lean_mode(true);
+    ss.initialize(5, 0, 0, 10); // aspect ratio, normal deviation
+    ss.simplify(n_vertices / 10);
+    EXPECT_EQ(lean.n_vertices(), n_vertices / 10);
+    EXPECT_EQ(lean.vertices_size(), lean.n_vertices());
+    EXPECT_TRUE(lean.is_triangle_mesh());
+    EXPECT_FALSE(lean.has_face_property("f:normal"));
+    EXPECT_FALSE(lean.has_halfedge_property("h:prio"));
+
+    SurfaceSimplification(reference).simplify(n_vertices / 10);
+    auto max_error = [](const SurfaceMesh& mesh) {
+        Scalar error = 0;
+        for (auto v : mesh.vertices())
+            error = std::max(error, std::fabs(norm(mesh.position(v)) - 1));
+        return error;
+    };
+    EXPECT_LT(max_error(lean), 2 * max_error(reference) + 1e-5);
+    for (auto f : lean.faces())
+        for (auto h : lean.halfedges(f))
+            EXPECT_FALSE(lean.is_boundary(lean.opposite_halfedge(h)));
+}
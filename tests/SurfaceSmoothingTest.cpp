@@ -7,11 +7,13 @@
 // SPDX-License-Identifier: MIT
 //=============================================================================
 
-#include "gtest/gtest.h"
+#include "SurfaceMeshTest.h"
 
 #include <pmp/algorithms/SurfaceSmoothing.h>
 #include <pmp/algorithms/DifferentialGeometry.h>
 
+#include <cmath>
+
 using namespace pmp;
 
 class SurfaceSmoothingTest : public ::testing::Test
@@ -42,3 +44,123 @@ TEST_F(SurfaceSmoothingTest, explicit_smoothing)
     auto area_after = surface_area(mesh);
     EXPECT_LT(area_after, area_before);
 }
+
+class SurfaceSmoothingGridTest : public SurfaceMeshTest
+{
+};
+
+TEST_F(SurfaceSmoothingGridTest, implicit_smoothing_reuse)
+{
+    // implicit smoothing requires triangles
+    add_grid(10);
+    mesh.triangulate();
+    for (auto v : mesh.vertices())
+    {
+        Point& p = mesh.position(v);
+        p[2] = std::sin(p[0] * p[1]);
+    }
+
+    // repeated steps with a kept factorization match fresh smoothers
+    const Scalar area_before = surface_area(mesh);
+    SurfaceMesh copy = mesh;
+    SurfaceSmoothing ss(mesh);
+    for (int i = 0; i < 3; ++i)
+    {
+        ss.implicit_smoothing(0.01, true, false);
+        SurfaceSmoothing fresh(copy);
+        fresh.implicit_smoothing(0.01, true, false);
+    }
+    ss.implicit_smoothing(0.001, true, false);
+    SurfaceSmoothing(copy).implicit_smoothing(0.001, true, false);
+
+    for (auto v : mesh.vertices())
+        EXPECT_LT(distance(mesh.position(v), copy.position(v)), 1e-5);
+    EXPECT_LT(surface_area(mesh), area_before);
+}
+
+TEST_F(SurfaceSmoothingGridTest, explicit_smoothing_step)
+{
+    add_grid(4);
+    mesh.position(Vertex(12)) = Point(2, 2, 1);
+    SurfaceMesh copy = mesh;
+    SurfaceSmoothing(mesh).explicit_smoothing(1, true);
+
+    // halfway to the mean of the neighbors, fixed boundary
+    for (auto v : mesh.vertices())
+    {
+        Point expected = copy.position(v);
+        if (!copy.is_boundary(v))
+        {
+            Point mean(0, 0, 0);
+            for (auto vv : copy.vertices(v))
+                mean += copy.position(vv);
+            mean /= copy.valence(v);
+            expected = 0.5f * (expected + mean);
+        }
+        EXPECT_LT(distance(mesh.position(v), expected), 1e-6);
+    }
+}
+
+TEST_F(SurfaceSmoothingGridTest, fused_explicit_smoothing)
+{
+    add_grid(40);
+    for (auto v : mesh.vertices())
+    {
+        Point& p = mesh.position(v);
+        p[2] = std::sin(p[0] * p[1]);
+    }
+
+    // fused iterations give the result of separate passes
+    SurfaceMesh copy = mesh;
+    SurfaceSmoothing ss(mesh);
+    ss.set_fused_iterations(3);
+    ss.explicit_smoothing(10, true);
+    SurfaceSmoothing(copy).explicit_smoothing(10, true);
+
+    for (auto v : mesh.vertices())
+        EXPECT_EQ(mesh.position(v), copy.position(v));
+}
+
+TEST_F(SurfaceSmoothingGridTest, local_explicit_smoothing)
+{
+    add_grid(10);
+    mesh.triangulate();
+    for (auto v : mesh.vertices())
+    {
+        Point& p = mesh.position(v);
+        p[2] = std::sin(p[0] * p[1]);
+    }
+
+    // smoothing all vertices matches explicit_smoothing()
+    SurfaceMesh copy = mesh;
+    std::vector<Vertex> all;
+    for (auto v : mesh.vertices())
+        all.push_back(v);
+    SurfaceSmoothing ss(mesh);
+    ss.explicit_smoothing(all, 10, true);
+    SurfaceSmoothing(copy).explicit_smoothing(10, true);
+    for (auto v : mesh.vertices())
+        EXPECT_LT(distance(mesh.position(v), copy.position(v)), 1e-5);
+
+    // the other vertices stay fixed, also in repeated strokes
+    copy = mesh;
+    std::vector<Vertex> region;
+    for (auto v : mesh.vertices())
+        if (mesh.position(v)[0] < 5)
+            region.push_back(v);
+    ss.explicit_smoothing(region, 5);
+    ss.explicit_smoothing(region, 5);
+    bool moved = false;
+    for (auto v : mesh.vertices())
+    {
+        if (mesh.position(v)[0] < 5)
+        {
+            moved = moved || mesh.position(v) != copy.position(v);
+        }
+        else
+        {
+            EXPECT_EQ(mesh.position(v), copy.position(v));
+        }
+    }
+    EXPECT_TRUE(moved);
+}
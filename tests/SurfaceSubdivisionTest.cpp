@@ -7,10 +7,13 @@
 // SPDX-License-Identifier: MIT
 //=============================================================================
 
-#include "gtest/gtest.h"
+#include "SurfaceMeshTest.h"
 
 #include <pmp/algorithms/SurfaceSubdivision.h>
 #include <pmp/algorithms/SurfaceFeatures.h>
+#include <pmp/algorithms/DifferentialGeometry.h>
+
+#include <algorithm>
 
 using namespace pmp;
 
@@ -79,3 +82,173 @@ TEST_F(SurfaceSubdivisionTest, sqrt3Subdivision)
     SurfaceSubdivision(mesh).sqrt3();
     EXPECT_EQ(mesh.n_vertices(),size_t(1922));
 }
+
+// a curved grid of n x n quads, split into triangles if requested
+static void add_curved_grid(SurfaceMesh& mesh, unsigned int n, bool triangles)
+{
+    auto position = [=](unsigned int i, unsigned int j) {
+        return Point(i, j, (i % 3 == 0 && j > n / 2) ? 1.0 : 0.0);
+    };
+    if (triangles)
+        SurfaceMeshTest::add_triangle_grid(mesh, n, position);
+    else
+        SurfaceMeshTest::add_quad_grid(mesh, n, position);
+}
+
+// bulk refinement gives the same vertices and features
+TEST(SurfaceSubdivisionBulkTest, bulk_refinement)
+{
+    for (int scheme = 0; scheme < 3; ++scheme)
+    {
+        SurfaceMesh meshes[2];
+        std::vector<Point> points[2];
+        for (int bulk = 0; bulk < 2; ++bulk)
+        {
+            SurfaceMesh& m = meshes[bulk];
+            add_curved_grid(m, 8, scheme != 1);
+            if (scheme != 2)
+                SurfaceFeatures(m).detect_angle(25);
+
+            SurfaceSubdivision subdivision(m);
+            subdivision.set_bulk_refinement(bulk);
+            for (int i = 0; i < 2; ++i)
+            {
+                if (scheme == 0)
+                    subdivision.loop();
+                else if (scheme == 1)
+                    subdivision.catmull_clark();
+                else
+                    subdivision.sqrt3();
+
+                // the same indices after one step
+                if (i == 0)
+                    points[bulk] = m.positions();
+            }
+        }
+
+        ASSERT_EQ(points[0].size(), points[1].size());
+        for (size_t i = 0; i < points[0].size(); ++i)
+            EXPECT_LT(norm(points[0][i] - points[1][i]), 1e-5);
+
+        // the same vertices after two steps, in another order since the
+        // edges are numbered differently
+        SurfaceMesh& a = meshes[0];
+        SurfaceMesh& b = meshes[1];
+        ASSERT_EQ(a.n_vertices(), b.n_vertices());
+        EXPECT_EQ(a.n_edges(), b.n_edges());
+        EXPECT_EQ(a.n_faces(), b.n_faces());
+        for (auto v : a.vertices())
+        {
+            Scalar d = norm(a.position(v) - b.position(Vertex(0)));
+            for (auto w : b.vertices())
+                d = std::min(d, norm(a.position(v) - b.position(w)));
+            EXPECT_LT(d, 1e-4);
+        }
+
+        if (scheme != 2)
+        {
+            auto afeature = a.get_edge_property<bool>("e:feature");
+            auto bfeature = b.get_edge_property<bool>("e:feature");
+            ASSERT_TRUE(afeature && bfeature);
+            size_t na = 0, nb = 0;
+            for (auto e : a.edges())
+                na += afeature[e];
+            for (auto e : b.edges())
+                nb += bfeature[e];
+            EXPECT_GT(na, 0u);
+            EXPECT_EQ(na, nb);
+        }
+    }
+}
+
+// the smallest interior angle of the triangles in degrees
+static Scalar min_angle(const SurfaceMesh& mesh)
+{
+    Scalar angle = 180;
+    for (auto h : mesh.halfedges())
+        if (!mesh.is_boundary(h))
+        {
+            auto p = mesh.position(mesh.to_vertex(h));
+            auto d0 = mesh.position(mesh.from_vertex(h)) - p;
+            auto d1 = mesh.position(mesh.to_vertex(mesh.next_halfedge(h))) - p;
+            Scalar c = dot(d0, d1) / (norm(d0) * norm(d1));
+            angle = std::min(angle, Scalar(acos(c) * 180.0 / M_PI));
+        }
+    return angle;
+}
+
+// adaptive refinement of all faces is a Loop step
+TEST(SurfaceSubdivisionAdaptiveTest, all_selected)
+{
+    SurfaceMesh a, b;
+    add_curved_grid(a, 8, true);
+    add_curved_grid(b, 8, true);
+    SurfaceFeatures(a).detect_angle(25);
+    SurfaceFeatures(b).detect_angle(25);
+
+    auto selected = a.add_face_property<bool>("f:selected", true);
+    SurfaceSubdivision(a).adaptive_loop();
+    SurfaceSubdivision(b).loop();
+
+    ASSERT_EQ(a.n_vertices(), b.n_vertices());
+    EXPECT_EQ(a.n_faces(), b.n_faces());
+    for (auto v : a.vertices())
+        EXPECT_LT(norm(a.position(v) - b.position(v)), 1e-5);
+    for (auto f : a.faces())
+        EXPECT_TRUE(selected[f]);
+}
+
+// refining a region repeatedly keeps the rest and the triangle quality
+TEST(SurfaceSubdivisionAdaptiveTest, selected_region)
+{
+    SurfaceMesh mesh;
+    add_curved_grid(mesh, 8, true);
+    for (auto v : mesh.vertices())
+        mesh.position(v)[2] = 0;
+
+    auto selected = mesh.add_face_property<bool>("f:selected");
+    for (auto f : mesh.faces())
+    {
+        auto c = centroid(mesh, f);
+        selected[f] = c[0] > 2 && c[0] < 4 && c[1] > 2 && c[1] < 6;
+    }
+
+    SurfaceSubdivision subdivision(mesh);
+    for (int i = 0; i < 3; ++i)
+    {
+        subdivision.adaptive_loop();
+
+        EXPECT_TRUE(mesh.is_triangle_mesh());
+        // not below the bisections of the initial triangles
+        EXPECT_GT(min_angle(mesh), Scalar(0.99 * atan(1.0 / 3.0) * 180 / M_PI));
+
+        size_t n_far = 0;
+        for (auto v : mesh.vertices())
+            n_far += mesh.position(v)[0] > 6.5;
+        EXPECT_EQ(n_far, size_t(18));
+    }
+    EXPECT_LT(mesh.n_faces(), size_t(128 * 16));
+}
+
+// error-driven refinement stays away from the flat parts
+TEST(SurfaceSubdivisionAdaptiveTest, max_error)
+{
+    SurfaceMesh mesh;
+    add_curved_grid(mesh, 8, true);
+    const size_t n_faces = mesh.n_faces();
+
+    SurfaceSubdivision subdivision(mesh);
+    subdivision.adaptive_loop(0.01);
+    subdivision.adaptive_loop(0.01);
+
+    EXPECT_TRUE(mesh.is_triangle_mesh());
+    EXPECT_GT(mesh.n_faces(), n_faces);
+    EXPECT_LT(mesh.n_faces(), 16 * n_faces);
+    for (auto v : mesh.vertices())
+    {
+        if (mesh.position(v)[1] < 2.5)
+        {
+            EXPECT_EQ(mesh.position(v)[2], 0);
+        }
+    }
+}
@@ -0,0 +1,113 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include "gtest/gtest.h"
+
+#include <pmp/algorithms/SurfaceTiles.h>
+#include <pmp/algorithms/SurfaceCurvature.h>
+#include <pmp/algorithms/SurfaceFactory.h>
+#include <pmp/algorithms/SurfaceNormals.h>
+
+#include <cstdio>
+
+using namespace pmp;
+
+namespace {
+
+// read n values of type T written by SurfaceTiles
+template <class T>
+std::vector<T> read_values(const std::string& filename, size_t n)
+{
+    std::vector<T> values(n);
+    FILE* in = fopen(filename.c_str(), "rb");
+    EXPECT_TRUE(in != nullptr);
+    if (in)
+    {
+        EXPECT_EQ(fread(values.data(), sizeof(T), n, in), n);
+        fclose(in);
+    }
+    return values;
+}
+
+} // namespace
+
+TEST(SurfaceTilesTest, extract)
+{
+    SurfaceMesh mesh = SurfaceFactory::grid(20, 20, true);
+    mesh.write("test_tiles.pmp");
+    MappedSurfaceMesh mapped;
+    ASSERT_TRUE(mapped.open("test_tiles.pmp"));
+
+    SurfaceTiles tiles(mapped, 100);
+    EXPECT_EQ(tiles.n_tiles(), size_t(8));
+    size_t n_vertices = 0;
+    for (size_t i = 0; i < tiles.n_tiles(); ++i)
+    {
+        EXPECT_LE(tiles.tile_size(i), size_t(100));
+        n_vertices += tiles.tile_size(i);
+
+        SurfaceMesh tile;
+        EXPECT_TRUE(tiles.extract(i, 1, tile));
+        auto global = tile.get_vertex_property<IndexType>("v:global");
+        ASSERT_TRUE(global);
+        for (auto v : tile.vertices())
+            EXPECT_EQ(tile.position(v), mesh.position(Vertex(global[v])));
+
+        // the one-rings of the tile's vertices are complete
+        for (IndexType j = 0; j < tiles.tile_size(i); ++j)
+            EXPECT_EQ(tile.valence(Vertex(j)),
+                      mesh.valence(Vertex(global[Vertex(j)])));
+    }
+    EXPECT_EQ(n_vertices, mesh.n_vertices());
+    mapped.close();
+}
+
+TEST(SurfaceTilesTest, normals_and_curvature)
+{
+    SurfaceMesh mesh = SurfaceFactory::terrain(20000, 0.5, 1);
+    mesh.write("test_tiles.pmp");
+    MappedSurfaceMesh mapped;
+    ASSERT_TRUE(mapped.open("test_tiles.pmp"));
+    SurfaceTiles tiles(mapped, 1000);
+    tiles.set_max_in_flight(3);
+    EXPECT_GT(tiles.n_tiles(), size_t(8));
+
+    // normals
+    SurfaceNormals::compute_vertex_normals(mesh);
+    auto normals = mesh.get_vertex_property<Normal>("v:normal");
+    EXPECT_TRUE(tiles.vertex_normals("test_normals.bin"));
+    const auto tiled_normals =
+        read_values<Normal>("test_normals.bin", mesh.n_vertices());
+    for (auto v : mesh.vertices())
+        EXPECT_LT(distance(tiled_normals[v.idx()], normals[v]), 1e-5);
+
+    // curvature, with smoothing and boundary interpolation
+    for (bool tensor : {false, true})
+    {
+        SurfaceCurvature curvature(mesh);
+        if (tensor)
+            curvature.analyze_tensor(2);
+        else
+            curvature.analyze(2);
+        EXPECT_TRUE(tiles.curvature("test_curvature.bin", 2, tensor));
+        const auto tiled = read_values<Vector<Scalar, 2>>(
+            "test_curvature.bin", mesh.n_vertices());
+        for (auto v : mesh.vertices())
+        {
+            const Scalar scale = 1e-3 * (1 + curvature.max_abs_curvature(v));
+            EXPECT_NEAR(tiled[v.idx()][0], curvature.min_curvature(v), scale);
+            EXPECT_NEAR(tiled[v.idx()][1], curvature.max_curvature(v), scale);
+        }
+    }
+
+    mapped.close();
+    std::remove("test_tiles.pmp");
+    std::remove("test_normals.bin");
+    std::remove("test_curvature.bin");
+}
@@ -0,0 +1,107 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include "SurfaceMeshTest.h"
+
+#include <pmp/algorithms/SurfaceValidation.h>
+
+using namespace pmp;
+
+class SurfaceValidationTest : public SurfaceMeshTest
+{
+};
+
+TEST_F(SurfaceValidationTest, valid)
+{
+    add_grid(10);
+    mesh.add_vertex(Point(5, 5, 5));
+    const ValidationReport report = validate(mesh);
+    EXPECT_TRUE(report.is_valid());
+    EXPECT_EQ(report.n_isolated_vertices, size_t(1));
+    EXPECT_EQ(report.n_boundary_loops, size_t(1));
+}
+
+TEST_F(SurfaceValidationTest, non_manifold_vertex)
+{
+    // two triangles touching in v0
+    add_triangle();
+    const Vertex a = mesh.add_vertex(Point(-1, 0, 0));
+    const Vertex b = mesh.add_vertex(Point(0, -1, 0));
+    mesh.add_triangle(v0, a, b);
+
+    const ValidationReport report = validate(mesh);
+    EXPECT_FALSE(report.is_valid());
+    EXPECT_EQ(report.n_non_manifold_vertices, size_t(1));
+    ASSERT_EQ(report.non_manifold_vertices.size(), size_t(1));
+    EXPECT_EQ(report.non_manifold_vertices[0], v0);
+
+    // one loop passing through v0 twice
+    EXPECT_EQ(report.n_boundary_loops, size_t(1));
+}
+
+TEST_F(SurfaceValidationTest, degenerate_faces)
+{
+    add_grid(3);
+    const Vertex a = mesh.add_vertex(Point(10, 0, 0));
+    const Vertex b = mesh.add_vertex(Point(11, 0, 0));
+    const Vertex c = mesh.add_vertex(Point(12, 0, 0));
+    const Face f = mesh.add_triangle(a, b, c);
+
+    const ValidationReport report = validate(mesh);
+    EXPECT_EQ(report.n_degenerate_faces, size_t(1));
+    ASSERT_EQ(report.degenerate_faces.size(), size_t(1));
+    EXPECT_EQ(report.degenerate_faces[0], f);
+}
+
+TEST_F(SurfaceValidationTest, duplicate_faces)
+{
+    add_triangle();
+    const Face f = mesh.add_triangle(v0, v2, v1);
+
+    const ValidationReport report = validate(mesh);
+    EXPECT_EQ(report.n_duplicate_faces, size_t(1));
+    ASSERT_EQ(report.duplicate_faces.size(), size_t(1));
+    EXPECT_EQ(report.duplicate_faces[0], f);
+    EXPECT_EQ(report.n_boundary_loops, size_t(0));
+}
+
+TEST_F(SurfaceValidationTest, duplicate_quads)
+{
+    add_quad();
+    const Face f = mesh.add_quad(v0, v3, v2, v1);
+
+    const ValidationReport report = validate(mesh);
+    EXPECT_EQ(report.n_duplicate_faces, size_t(1));
+    ASSERT_EQ(report.duplicate_faces.size(), size_t(1));
+    EXPECT_EQ(report.duplicate_faces[0], f);
+}
+
+TEST_F(SurfaceValidationTest, invalid_halfedges)
+{
+    add_grid(3);
+    const Halfedge h = mesh.halfedge(Face(4));
+    mesh.set_next_halfedge(h, mesh.opposite_halfedge(h));
+
+    const ValidationReport report = validate(mesh);
+    EXPECT_FALSE(report.is_valid());
+    EXPECT_GT(report.n_invalid_halfedges, size_t(0));
+    EXPECT_EQ(report.n_boundary_loops, size_t(0));
+}
+
+TEST_F(SurfaceValidationTest, max_handles)
+{
+    add_grid(10);
+    for (auto v : mesh.vertices())
+        mesh.position(v) = Point(0, 0, 0);
+
+    const ValidationReport report = validate(mesh, 5);
+    EXPECT_EQ(report.n_degenerate_faces, size_t(100));
+    ASSERT_EQ(report.degenerate_faces.size(), size_t(5));
+    EXPECT_EQ(report.degenerate_faces[4], Face(4));
+}
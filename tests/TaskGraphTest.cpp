@@ -0,0 +1,135 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include "gtest/gtest.h"
+
+#include <pmp/TaskGraph.h>
+#include <pmp/Parallel.h>
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace pmp;
+
+TEST(TaskGraphTest, dependencies)
+{
+    // a diamond: a before b and c, both before d
+    std::atomic<int> clock(0);
+    int a = -1, b = -1, c = -1, d = -1;
+    TaskGraph graph;
+    auto ta = graph.add([&] { a = clock++; });
+    auto tb = graph.add([&] { b = clock++; }, {ta});
+    auto tc = graph.add([&] { c = clock++; }, {ta}, TaskKind::IO);
+    graph.add([&] { d = clock++; }, {tb, tc});
+    EXPECT_EQ(graph.size(), size_t(4));
+    graph.run();
+    EXPECT_EQ(a, 0);
+    EXPECT_LT(a, b);
+    EXPECT_LT(a, c);
+    EXPECT_EQ(d, 3);
+
+    // graphs can be run again
+    clock = 0;
+    graph.run();
+    EXPECT_EQ(d, 3);
+}
+
+TEST(TaskGraphTest, nested_parallel_for)
+{
+    // loops within tasks use the threads of the scheduler
+    std::vector<std::vector<int>> values(8, std::vector<int>(100000, 0));
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+    TaskGraph graph;
+    for (auto& v : values)
+        graph.add([&] {
+            parallel_for(0, v.size(), [&](size_t i) {
+                v[i] = int(i);
+                if (i % 1000 == 0)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    threads.insert(std::this_thread::get_id());
+                }
+            });
+        });
+    graph.run();
+    for (auto& v : values)
+        for (size_t i = 0; i < v.size(); ++i)
+            ASSERT_EQ(v[i], int(i));
+    EXPECT_LE(threads.size(), size_t(num_threads()));
+}
+
+TEST(TaskGraphTest, pipeline)
+{
+    const size_t n_items = 50, max_in_flight = 3;
+    std::vector<std::vector<int>> log(n_items);
+    std::vector<std::mutex> mutexes(n_items);
+    std::atomic<size_t> in_flight(0), max_seen(0);
+    auto record = [&](size_t i, int stage) {
+        std::lock_guard<std::mutex> lock(mutexes[i]);
+        log[i].push_back(stage);
+    };
+
+    Pipeline pipeline;
+    auto load = pipeline.add_stage(
+        [&](size_t i) {
+            const size_t n = ++in_flight;
+            size_t m = max_seen;
+            while (n > m && !max_seen.compare_exchange_weak(m, n))
+            {
+            }
+            record(i, 0);
+        },
+        {}, TaskKind::IO);
+    auto curvature =
+        pipeline.add_stage([&](size_t i) { record(i, 1); }, {load});
+    auto features =
+        pipeline.add_stage([&](size_t i) { record(i, 1); }, {load});
+    pipeline.add_stage(
+        [&](size_t i) {
+            record(i, 2);
+            --in_flight;
+        },
+        {curvature, features}, TaskKind::IO);
+    pipeline.run(n_items, max_in_flight);
+
+    for (auto& l : log)
+        EXPECT_EQ(l, std::vector<int>({0, 1, 1, 2}));
+    EXPECT_LE(max_seen, max_in_flight);
+    EXPECT_EQ(in_flight, size_t(0));
+}
+
+TEST(TaskGraphTest, exceptions)
+{
+    bool ran = false;
+    TaskGraph graph;
+    auto t = graph.add([] { throw std::runtime_error("failed"); });
+    graph.add([&] { ran = true; }, {t});
+    EXPECT_THROW(graph.run(), std::runtime_error);
+    EXPECT_TRUE(ran);
+}
+
+TEST(TaskGraphTest, serial)
+{
+    set_num_threads(1);
+    std::vector<int> order;
+    Pipeline pipeline;
+    auto first = pipeline.add_stage(
+        [&](size_t i) { order.push_back(int(2 * i)); }, {}, TaskKind::IO);
+    pipeline.add_stage([&](size_t i) { order.push_back(int(2 * i + 1)); },
+                       {first});
+    pipeline.run(10, 1);
+    set_num_threads(0);
+    ASSERT_EQ(order.size(), size_t(20));
+    for (size_t i = 0; i < order.size(); ++i)
+        EXPECT_EQ(order[i], int(i));
+}
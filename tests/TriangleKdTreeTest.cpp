@@ -0,0 +1,271 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include "SurfaceMeshTest.h"
+
+#include <pmp/algorithms/TriangleKdTree.h>
+#include <pmp/algorithms/DistancePointTriangle.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+using namespace pmp;
+
+class TriangleKdTreeTest : public SurfaceMeshTest
+{
+};
+
+TEST_F(TriangleKdTreeTest, nearest)
+{
+    add_triangle_grid(10);
+    TriangleKdTree tree(mesh);
+
+    for (auto v : mesh.vertices())
+    {
+        auto nn = tree.nearest(mesh.position(v) + Point(0.1, 0.2, 0));
+        EXPECT_TRUE(nn.face.is_valid());
+        EXPECT_LT(nn.dist, 0.3);
+    }
+}
+
+TEST_F(TriangleKdTreeTest, batched_nearest)
+{
+    add_triangle_grid(40);
+    TriangleKdTree tree(mesh);
+
+    // noisy samples around the grid
+    std::srand(42);
+    std::vector<Point> points;
+    for (int i = 0; i < 5000; ++i)
+        points.push_back(Point(40.0 * std::rand() / RAND_MAX,
+                               40.0 * std::rand() / RAND_MAX,
+                               2.0 * std::rand() / RAND_MAX - 1.0));
+
+    auto batch = tree.nearest(points);
+    ASSERT_EQ(batch.size(), points.size());
+
+    // identical to individual queries
+    for (size_t i = 0; i < points.size(); ++i)
+    {
+        auto nn = tree.nearest(points[i]);
+        EXPECT_EQ(batch[i].face, nn.face);
+        EXPECT_EQ(batch[i].dist, nn.dist);
+    }
+
+    EXPECT_TRUE(tree.nearest(std::vector<Point>()).empty());
+}
+
+TEST_F(TriangleKdTreeTest, parallel_construction)
+{
+    // large enough for subtrees built in parallel
+    add_triangle_grid(100);
+    TriangleKdTree tree(mesh);
+
+    std::srand(7);
+    for (int i = 0; i < 100; ++i)
+    {
+        const Point p(100.0 * std::rand() / RAND_MAX,
+                      100.0 * std::rand() / RAND_MAX,
+                      4.0 * std::rand() / RAND_MAX - 2.0);
+
+        // brute force
+        Scalar dist = FLT_MAX;
+        for (auto f : mesh.faces())
+        {
+            auto fv = mesh.vertices(f);
+            const Point& x0 = mesh.position(*fv);
+            const Point& x1 = mesh.position(*(++fv));
+            const Point& x2 = mesh.position(*(++fv));
+            Point nearest;
+            dist = std::min(dist, dist_point_triangle(p, x0, x1, x2, nearest));
+        }
+
+        auto nn = tree.nearest(p);
+        EXPECT_EQ(nn.dist, dist);
+        EXPECT_LT(nn.tests, 1000);
+    }
+}
+
+TEST_F(TriangleKdTreeTest, k_nearest_and_radius)
+{
+    add_triangle_grid(20);
+    TriangleKdTree tree(mesh);
+    const Point p(5.3, 7.6, 3);
+
+    // brute force distances
+    std::vector<Scalar> dists;
+    for (auto f : mesh.faces())
+    {
+        auto fv = mesh.vertices(f);
+        const Point& x0 = mesh.position(*fv);
+        const Point& x1 = mesh.position(*(++fv));
+        const Point& x2 = mesh.position(*(++fv));
+        Point nearest;
+        dists.push_back(dist_point_triangle(p, x0, x1, x2, nearest));
+    }
+    std::sort(dists.begin(), dists.end());
+
+    auto knn = tree.k_nearest(p, 10);
+    ASSERT_EQ(knn.size(), size_t(10));
+    for (size_t i = 0; i < knn.size(); ++i)
+        EXPECT_EQ(knn[i].dist, dists[i]);
+    EXPECT_EQ(knn[0].face, tree.nearest(p).face);
+    EXPECT_EQ(tree.k_nearest(p, 1000).size(), mesh.n_faces());
+
+    const Scalar radius = 0.5 * (dists[20] + dists[21]);
+    auto inside = tree.within_radius(p, radius);
+    EXPECT_EQ(inside.size(), size_t(21));
+    for (const auto& nn : inside)
+        EXPECT_LE(nn.dist, radius);
+
+    // batched queries give the same results
+    std::vector<Point> points(3, p);
+    auto batch = tree.k_nearest(points, 10);
+    ASSERT_EQ(batch.size(), size_t(3));
+    EXPECT_EQ(batch[2][9].face, knn[9].face);
+    EXPECT_EQ(tree.within_radius(points, radius)[1].size(), size_t(21));
+}
+
+TEST_F(TriangleKdTreeTest, ray_intersection)
+{
+    add_triangle_grid(20);
+    TriangleKdTree tree(mesh);
+
+    // vertical rays hit the height field above their origin
+    std::vector<Point> origins, directions;
+    for (int i = 0; i < 19; ++i)
+    {
+        origins.push_back(Point(i + 0.5, 0.3 * i + 0.7, 10));
+        directions.push_back(Point(0, 0, -2));
+    }
+    auto hits = tree.intersect(origins, directions);
+    ASSERT_EQ(hits.size(), origins.size());
+    for (size_t i = 0; i < hits.size(); ++i)
+    {
+        EXPECT_TRUE(hits[i].face.is_valid());
+        EXPECT_FLOAT_EQ(hits[i].point[0], origins[i][0]);
+        auto nn = tree.nearest(hits[i].point);
+        EXPECT_LT(nn.dist, 1e-5);
+        EXPECT_FLOAT_EQ(hits[i].t, (10 - hits[i].point[2]) / 2);
+    }
+
+    // rays pointing away or missing the grid
+    EXPECT_FALSE(
+        tree.intersect(Point(5, 5, 10), Point(0, 0, 1)).face.is_valid());
+    EXPECT_FALSE(
+        tree.intersect(Point(-5, 5, 10), Point(0, 0, -1)).face.is_valid());
+
+    // the first of several hits along a slanted ray
+    auto hit = tree.intersect(Point(-1, 10.5, 0.1), Point(1, 0, 0));
+    EXPECT_TRUE(hit.face.is_valid());
+    EXPECT_LT(tree.nearest(hit.point).dist, 1e-5);
+}
+
+TEST_F(TriangleKdTreeTest, triangle_intersections)
+{
+    // a grid without self-intersections
+    add_triangle_grid(30);
+    TriangleKdTree grid_tree(mesh);
+    EXPECT_TRUE(grid_tree.intersections(grid_tree).empty());
+
+    // and small random triangles crossing it
+    std::srand(3);
+    auto random = [](Scalar scale) { return scale * std::rand() / RAND_MAX; };
+    for (int i = 0; i < 300; ++i)
+    {
+        const Point p(random(30), random(30), random(2) - 1);
+        const Vertex v0 = mesh.add_vertex(p);
+        const Vertex v1 = mesh.add_vertex(p + Point(random(1), 0, random(1)));
+        const Vertex v2 = mesh.add_vertex(p + Point(0, random(1), random(1)));
+        mesh.add_triangle(v0, v1, v2);
+    }
+
+    // the same pairs as testing all triangles in a single leaf
+    TriangleKdTree tree(mesh), leaf(mesh, mesh.n_faces());
+    const auto pairs = tree.intersections(tree);
+    EXPECT_FALSE(pairs.empty());
+    EXPECT_EQ(pairs, leaf.intersections(leaf));
+    for (const auto& p : pairs)
+        EXPECT_LT(p.first, p.second);
+
+    // between two trees, a triangle of the grid is first
+    const auto grid_pairs = grid_tree.intersections(tree);
+    EXPECT_GT(grid_pairs.size(), pairs.size());
+    for (const auto& p : grid_pairs)
+        EXPECT_LT(p.first.idx(), 1800u);
+}
+
+TEST_F(TriangleKdTreeTest, cache)
+{
+    add_triangle_grid(40);
+    std::remove("test.tree");
+
+    // the first tree is built and written, the second one read
+    TriangleKdTree built(mesh, "test.tree");
+    TriangleKdTree cached(mesh, "test.tree");
+    std::srand(5);
+    for (int i = 0; i < 100; ++i)
+    {
+        const Point p(40.0 * std::rand() / RAND_MAX,
+                      40.0 * std::rand() / RAND_MAX, 1);
+        const auto a = built.nearest(p), b = cached.nearest(p);
+        EXPECT_EQ(a.face, b.face);
+        EXPECT_EQ(a.dist, b.dist);
+        EXPECT_EQ(a.tests, b.tests);
+    }
+
+    // other triangles do not match
+    TriangleKdTree tree(mesh);
+    EXPECT_TRUE(tree.read("test.tree", mesh));
+    mesh.position(Vertex(7))[2] += 0.5;
+    EXPECT_FALSE(tree.read("test.tree", mesh));
+    EXPECT_FALSE(tree.read("missing.tree", mesh));
+}
+
+TEST_F(TriangleKdTreeTest, corrupt_cache)
+{
+    add_triangle_grid(10);
+    TriangleKdTree tree(mesh);
+    EXPECT_TRUE(tree.write("test.tree", mesh));
+    std::ifstream ifs("test.tree", std::ios::binary);
+    const std::string data((std::istreambuf_iterator<char>(ifs)),
+                           std::istreambuf_iterator<char>());
+
+    auto read = [&](const std::string& corrupt) {
+        std::ofstream ofs("test_corrupt.tree", std::ios::binary);
+        ofs.write(corrupt.data(), corrupt.size());
+        ofs.close();
+        return tree.read("test_corrupt.tree", mesh);
+    };
+    EXPECT_TRUE(read(data));
+
+    // truncated files and forged node counts
+    EXPECT_FALSE(read(data.substr(0, data.size() - 1)));
+    std::string corrupt = data;
+    corrupt[6 + 5] = char(0x7f);
+    EXPECT_FALSE(read(corrupt));
+
+    // corrupt bytes in the nodes and faces are rejected if they break the
+    // tree, and queries stay within bounds on the trees that are accepted
+    const size_t header_size = 6 + 5 * sizeof(uint64_t);
+    for (size_t i = header_size; i < data.size(); ++i)
+    {
+        corrupt = data;
+        corrupt[i] = char(0xff);
+        if (read(corrupt))
+        {
+            EXPECT_TRUE(tree.nearest(Point(3, 4, 1)).face.is_valid());
+        }
+    }
+}
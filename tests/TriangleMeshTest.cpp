@@ -0,0 +1,159 @@
+//=============================================================================
+// Copyright (C) 2019 The pmp-library developers
+//
+// This file is part of the Polygon Mesh Processing Library.
+// Distributed under the terms of the MIT license, see LICENSE.txt for details.
+//
+// SPDX-License-Identifier: MIT
+//=============================================================================
+
+#include "SurfaceMeshTest.h"
+
+#include <pmp/TriangleMesh.h>
+
+#include <algorithm>
+
+using namespace pmp;
+
+class TriangleMeshTest : public SurfaceMeshTest
+{
+public:
+    // triangulated grid with a deleted corner
+    void add_triangle_grid()
+    {
+        add_grid(4);
+        mesh.triangulate();
+        mesh.delete_vertex(Vertex(0));
+    }
+
+    template <class Range>
+    static std::vector<IndexType> sorted(Range range)
+    {
+        std::vector<IndexType> indices;
+        for (auto h : range)
+            indices.push_back(h.idx());
+        std::sort(indices.begin(), indices.end());
+        return indices;
+    }
+};
+
+TEST_F(TriangleMeshTest, assign)
+{
+    add_triangle_grid();
+    TriangleMesh tm;
+    EXPECT_TRUE(tm.assign(mesh));
+    EXPECT_EQ(tm.n_vertices(), mesh.n_vertices());
+    EXPECT_EQ(tm.n_faces(), mesh.n_faces());
+    EXPECT_EQ(tm.n_halfedges(), 3 * mesh.n_faces());
+
+    // compare elements by index
+    mesh.garbage_collection();
+    tm.assign(mesh);
+
+    for (auto v : mesh.vertices())
+    {
+        const Vertex tv(v.idx());
+        EXPECT_EQ(tm.position(tv), mesh.position(v));
+        EXPECT_EQ(tm.is_boundary(tv), mesh.is_boundary(v));
+        EXPECT_EQ(tm.valence(tv), sorted(mesh.faces(v)).size());
+        EXPECT_EQ(sorted(tm.vertices(tv)), sorted(mesh.vertices(v)));
+        EXPECT_EQ(sorted(tm.faces(tv)), sorted(mesh.faces(v)));
+        for (auto h : tm.halfedges(tv))
+            EXPECT_EQ(tm.from_vertex(h), tv);
+    }
+    for (auto f : mesh.faces())
+        EXPECT_EQ(sorted(tm.vertices(Face(f.idx()))), sorted(mesh.vertices(f)));
+    for (auto h : tm.halfedges())
+    {
+        EXPECT_EQ(tm.next_halfedge(tm.prev_halfedge(h)), h);
+        EXPECT_EQ(tm.face(tm.next_halfedge(h)), tm.face(h));
+        const Halfedge o = tm.opposite_halfedge(h);
+        if (o.is_valid())
+        {
+            EXPECT_EQ(tm.opposite_halfedge(o), h);
+            EXPECT_EQ(tm.to_vertex(o), tm.from_vertex(h));
+        }
+    }
+
+    mesh.add_quad(mesh.add_vertex(Point(0, 0, 1)),
+                  mesh.add_vertex(Point(1, 0, 1)),
+                  mesh.add_vertex(Point(1, 1, 1)),
+                  mesh.add_vertex(Point(0, 1, 1)));
+    EXPECT_FALSE(tm.assign(mesh));
+    EXPECT_TRUE(tm.is_empty());
+}
+
+TEST_F(TriangleMeshTest, round_trip)
+{
+    add_triangle_grid();
+    mesh.garbage_collection();
+    TriangleMesh tm;
+    tm.assign(mesh);
+    SurfaceMesh result;
+    EXPECT_TRUE(tm.to_surface_mesh(result));
+    EXPECT_EQ(result.n_vertices(), mesh.n_vertices());
+    EXPECT_EQ(result.n_edges(), mesh.n_edges());
+    for (auto f : mesh.faces())
+    {
+        std::vector<Vertex> expected, vertices;
+        for (auto v : mesh.vertices(f))
+            expected.push_back(v);
+        for (auto v : result.vertices(f))
+            vertices.push_back(v);
+        EXPECT_EQ(vertices, expected);
+    }
+}
+
+TEST_F(TriangleMeshTest, build_from_indices)
+{
+    const std::vector<Point> points{Point(0, 0, 0), Point(1, 0, 0),
+                                    Point(0, 1, 0), Point(1, 1, 0)};
+    TriangleMesh tm;
+    EXPECT_TRUE(tm.build_from_indices(points, {0, 1, 2, 2, 1, 3}));
+    EXPECT_EQ(tm.to_vertex(tm.halfedge(Face(1))), Vertex(2));
+    EXPECT_EQ(tm.opposite_halfedge(Halfedge(2)), Halfedge(4));
+    EXPECT_TRUE(tm.is_boundary(Vertex(1)));
+    EXPECT_EQ(tm.valence(Vertex(1)), 2u);
+    EXPECT_EQ(sorted(tm.vertices(Vertex(1))),
+              std::vector<IndexType>({0, 2, 3}));
+
+    EXPECT_FALSE(tm.build_from_indices(points, {0, 1, 4}));
+    EXPECT_FALSE(tm.build_from_indices(points, {0, 1, 1}));
+    EXPECT_FALSE(tm.build_from_indices(points, {0, 1}));
+    EXPECT_TRUE(tm.is_empty());
+}
+
+TEST_F(TriangleMeshTest, properties)
+{
+    add_triangle_grid();
+    TriangleMesh tm;
+    tm.assign(mesh);
+    auto valence = tm.add_vertex_property<int>("v:valence");
+    for (auto f : tm.faces())
+        for (auto v : tm.vertices(f))
+            ++valence[v];
+    for (auto v : tm.vertices())
+        EXPECT_EQ(valence[v], int(tm.valence(v)));
+    EXPECT_TRUE(tm.has_vertex_property("v:valence"));
+
+    TriangleMesh copy(tm);
+    EXPECT_TRUE(copy.get_vertex_property<int>("v:valence"));
+    EXPECT_EQ(copy.bounds().max(), tm.bounds().max());
+
+    tm.remove_vertex_property(valence);
+    EXPECT_FALSE(tm.has_vertex_property("v:valence"));
+}
+
+TEST_F(TriangleMeshTest, connectivity_memory)
+{
+    add_grid(16);
+    mesh.triangulate();
+    mesh.free_memory();
+    TriangleMesh tm;
+    tm.assign(mesh);
+#ifdef PMP_NO_PREV_HALFEDGE
+    EXPECT_LT(tm.connectivity_memory(), mesh.memory_stats().connectivity);
+#else
+    EXPECT_LT(2 * tm.connectivity_memory(), mesh.memory_stats().connectivity);
+#endif
+}